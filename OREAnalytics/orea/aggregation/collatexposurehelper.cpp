@@ -19,11 +19,96 @@
 #include <orea/aggregation/collatexposurehelper.hpp>
 #include <ql/errors.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <list>
+
 using namespace std;
 using namespace QuantLib;
 
 #define FLAT_INTERPOLATION 1
 
+namespace {
+
+/* Scenario independent description of CollateralExposureHelper::estimateUncollatValue() for a simulation date: the
+   value is either today's value, the profile value at pos2 or the interpolation between the values at pos1 (today's
+   value if pos1 is null) and pos2 with the given weight. */
+struct ValueStencil {
+    enum Type { Today, Profile, Interpolation };
+    Type type;
+    QuantLib::Size pos1, pos2;
+    QuantLib::Real weight;
+};
+
+ValueStencil valueStencil(const QuantLib::Date& simulationDate, const QuantLib::Date& date_t0,
+                          const std::vector<QuantLib::Date>& dateGrid) {
+
+    using QuantLib::Null;
+    using QuantLib::Size;
+
+    QL_REQUIRE(simulationDate >= date_t0, "CollatExposureHelper error: simulation date < start date");
+    QL_REQUIRE(dateGrid[0] >= date_t0, "CollatExposureHelper error: cube dateGrid starts before t0");
+
+    if (simulationDate >= dateGrid.back())
+        return {ValueStencil::Profile, Null<Size>(), dateGrid.size() - 1, 0.0};
+    if (simulationDate == date_t0)
+        return {ValueStencil::Today, Null<Size>(), Null<Size>(), 0.0};
+    for (Size i = 0; i < dateGrid.size(); i++) {
+        if (dateGrid[i] == simulationDate)
+            return {ValueStencil::Profile, Null<Size>(), i, 0.0};
+#ifdef FLAT_INTERPOLATION
+        else if (simulationDate < dateGrid.front())
+            return {ValueStencil::Profile, Null<Size>(), 0, 0.0};
+        else if (i < dateGrid.size() - 1 && simulationDate > dateGrid[i] && simulationDate < dateGrid[i + 1])
+            return {ValueStencil::Profile, Null<Size>(), i + 1, 0.0};
+#endif
+    }
+
+    QuantLib::Date t1, t2;
+    Size pos1, pos2;
+    if (simulationDate <= dateGrid[0]) {
+        t1 = date_t0;
+        t2 = dateGrid[0];
+        pos1 = Null<Size>();
+        pos2 = 0;
+    } else {
+        auto it = std::lower_bound(dateGrid.begin(), dateGrid.end(), simulationDate);
+        QL_REQUIRE(it != dateGrid.end(), "CollatExposureHelper error; "
+                                             << "date interpolation points not found (it.end())");
+        QL_REQUIRE(it != dateGrid.begin(), "CollatExposureHelper error; "
+                                               << "date interpolation points not found (it.begin())");
+        pos1 = (it - 1) - dateGrid.begin();
+        pos2 = it - dateGrid.begin();
+        t1 = dateGrid[pos1];
+        t2 = dateGrid[pos2];
+    }
+    return {ValueStencil::Interpolation, pos1, pos2, double(simulationDate - t1) / double(t2 - t1)};
+}
+
+// evaluates the stencil for all scenarios, this reproduces CollateralExposureHelper::estimateUncollatValue()
+void applyValueStencil(const ValueStencil& stencil, const QuantLib::Real npv_t0,
+                       const std::vector<std::vector<QuantLib::Real>>& scenPvProfiles,
+                       std::vector<QuantLib::Real>& result) {
+    if (stencil.type == ValueStencil::Today) {
+        std::fill(result.begin(), result.end(), npv_t0);
+    } else if (stencil.type == ValueStencil::Profile) {
+        std::copy(scenPvProfiles[stencil.pos2].begin(), scenPvProfiles[stencil.pos2].end(), result.begin());
+    } else {
+        for (QuantLib::Size k = 0; k < result.size(); ++k) {
+            QuantLib::Real npv1 = stencil.pos1 == QuantLib::Null<QuantLib::Size>() ? npv_t0
+                                                                                  : scenPvProfiles[stencil.pos1][k];
+            QuantLib::Real npv2 = scenPvProfiles[stencil.pos2][k];
+            QuantLib::Real newPv = npv1 + ((npv2 - npv1) * stencil.weight);
+            QL_REQUIRE((npv1 <= newPv && newPv <= npv2) || (npv1 >= newPv && newPv >= npv2),
+                       "CollatExposureHelper error; "
+                           << "interpolated Pv value " << newPv << " out of range (" << npv1 << " " << npv2 << ")");
+            result[k] = newPv;
+        }
+    }
+}
+
+} // namespace
+
 namespace ore {
 using namespace data;
 namespace analytics {
@@ -264,5 +349,199 @@ QuantLib::ext::shared_ptr<vector<QuantLib::ext::shared_ptr<CollateralAccount>>>
         QL_FAIL("CollateralExposureHelper - unknown error when generating collateralBalancePaths");
     }
 }
+vector<vector<Real>> CollateralExposureHelper::collateralBalances(
+    const QuantLib::ext::shared_ptr<NettingSetDefinition>& csaDef, const Real& nettingSetPv, const Date& date_t0,
+    const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
+    const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
+    const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType,
+    const QuantLib::ext::shared_ptr<CollateralBalance>& balance) {
+
+    try {
+        // step 1; calculate the t0 balance as in collateralBalancePaths()
+
+        Real initialBalance = 0.0;
+        if (balance && balance->variationMargin() != Null<Real>()) {
+            initialBalance = balance->variationMargin();
+            DLOG("initial collateral balance: " << initialBalance);
+        } else {
+            DLOG("initial collateral balance not found");
+        }
+        QuantLib::ext::shared_ptr<CollateralAccount> tmpAcc(new CollateralAccount(csaDef, initialBalance, date_t0));
+        Real bal_t0 = marginRequirementCalc(tmpAcc, nettingSetPv, date_t0);
+        DLOG("base current collateral balance: " << bal_t0);
+
+        Size numScenarios = nettingSetValues.front().size();
+        QL_REQUIRE(numScenarios == csaFxScenarioRates.front().size(), "netting values -v- scenario FX rate mismatch");
+
+        const QuantLib::ext::shared_ptr<CSA>& csa = csaDef->csaDetails();
+        const Real ia = csa->independentAmountHeld();
+        const Real thresholdRcv = csa->thresholdRcv(), thresholdPay = csa->thresholdPay();
+        const Real mtaRcv = csa->mtaRcv(), mtaPay = csa->mtaPay();
+        const Real spreadRcv = csa->collatSpreadRcv(), spreadPay = csa->collatSpreadPay();
+        const Period lag = (calcType == NoLag ? 0 * Days : csa->marginPeriodOfRisk());
+
+        // step 2; the margin dates and eligibilities are the same for all scenarios
+
+        Date simEndDate = std::min(nettingSet_maturity, dateGrid.back()) + csa->marginPeriodOfRisk();
+        vector<Date> marginDates;
+        vector<bool> eligMarginReqDateUs, eligMarginReqDateCtp;
+        Date tmpDate = date_t0;
+        Date nextMarginReqDateUs = date_t0;
+        Date nextMarginReqDateCtp = date_t0;
+        while (tmpDate <= simEndDate) {
+            QL_REQUIRE(tmpDate <= nextMarginReqDateUs && tmpDate <= nextMarginReqDateCtp &&
+                           (tmpDate == nextMarginReqDateUs || tmpDate == nextMarginReqDateCtp),
+                       "collateral balance path generation error; invalid time stepping");
+            marginDates.push_back(tmpDate);
+            eligMarginReqDateUs.push_back(tmpDate == nextMarginReqDateUs);
+            eligMarginReqDateCtp.push_back(tmpDate == nextMarginReqDateCtp);
+            if (nextMarginReqDateUs == tmpDate)
+                nextMarginReqDateUs = tmpDate + csa->marginCallFrequency();
+            if (nextMarginReqDateCtp == tmpDate)
+                nextMarginReqDateCtp = tmpDate + csa->marginPostFrequency();
+            tmpDate = std::min(nextMarginReqDateUs, nextMarginReqDateCtp);
+        }
+
+        // step 3; scenario state: the most recent account balance and its date, the next dateGrid index to be
+        //         filled and the open margin calls. A margin call issued on a margin date is paid either on that date
+        //         or after the lag, the open calls of all scenarios issued on the same date with the same pay date
+        //         share an array of amounts (zero if a scenario has no such call) and a flag per scenario. The open
+        //         calls are kept sorted by pay date and issue date, which is the order in which CollateralAccount
+        //         settles and sums them. The arrays are recycled once the calls are settled.
+
+        struct OpenMarginCalls {
+            Date payDate;
+            vector<Real> amounts;
+            vector<char> open;
+        };
+
+        vector<Real> accountBalance(numScenarios, bal_t0);
+        vector<Date> accountDate(numScenarios, date_t0);
+        vector<Size> nextBalanceDate(numScenarios, 0);
+        vector<vector<Real>> result(dateGrid.size(), vector<Real>(numScenarios, 0.0));
+        std::list<OpenMarginCalls> openCalls, recycledCalls;
+
+        auto newAccountEntry = [&accountBalance, &accountDate, &nextBalanceDate, &result,
+                                &dateGrid](const Size k, const Date& d, const Real newBalance) {
+            while (nextBalanceDate[k] < dateGrid.size() && dateGrid[nextBalanceDate[k]] < d)
+                result[nextBalanceDate[k]++][k] = accountBalance[k];
+            accountBalance[k] = newBalance;
+            accountDate[k] = d;
+        };
+
+        vector<Real> uncollatVal(numScenarios), fxValue(numScenarios), annualisedZeroRate(numScenarios);
+        vector<Real> margin(numScenarios);
+
+        // step 4; loop over the margin dates
+
+        for (Size n = 0; n < marginDates.size(); ++n) {
+            const Date& simulationDate = marginDates[n];
+
+            ValueStencil stencil = valueStencil(simulationDate, date_t0, dateGrid);
+            applyValueStencil(stencil, nettingSetPv, nettingSetValues, uncollatVal);
+            applyValueStencil(stencil, csaFxTodayRate, csaFxScenarioRates, fxValue);
+            applyValueStencil(stencil, csaTodayCollatCurve, csaScenCollatCurves, annualisedZeroRate);
+            for (Size k = 0; k < numScenarios; ++k)
+                uncollatVal[k] /= fxValue[k];
+
+            // settle the margin calls due, see CollateralAccount::updateAccountBalance()
+
+            while (!openCalls.empty() && openCalls.front().payDate <= simulationDate) {
+                OpenMarginCalls& calls = openCalls.front();
+                for (Size k = 0; k < numScenarios; ++k) {
+                    if (!calls.open[k])
+                        continue;
+                    if (calls.payDate == accountDate[k]) {
+                        accountBalance[k] += calls.amounts[k];
+                    } else {
+                        int accrualDays = calls.payDate - accountDate[k];
+                        Real accrualRate = (accountBalance[k] >= 0.0) ? (annualisedZeroRate[k] - spreadRcv)
+                                                                      : (annualisedZeroRate[k] - spreadPay);
+                        newAccountEntry(k, calls.payDate,
+                                        accountBalance[k] * std::pow(1.0 + accrualRate / 365.0, accrualDays) +
+                                            calls.amounts[k]);
+                    }
+                }
+                recycledCalls.splice(recycledCalls.end(), openCalls, openCalls.begin());
+            }
+            for (Size k = 0; k < numScenarios; ++k) {
+                if (simulationDate > accountDate[k]) {
+                    int accrualDays = simulationDate - accountDate[k];
+                    Real accrualRate = (accountBalance[k] >= 0.0) ? (annualisedZeroRate[k] - spreadRcv)
+                                                                  : (annualisedZeroRate[k] - spreadPay);
+                    newAccountEntry(k, simulationDate,
+                                    accountBalance[k] * std::pow(1.0 + accrualRate / 365.0, accrualDays));
+                }
+            }
+
+            // margin requirement, see marginRequirementCalc() and creditSupportAmount()
+
+            for (Size k = 0; k < numScenarios; ++k) {
+                Real openMargins = 0.0;
+                for (auto const& calls : openCalls) {
+                    if (calls.open[k])
+                        openMargins += calls.amounts[k];
+                }
+                Real csaAmount;
+                if (uncollatVal[k] + ia >= 0)
+                    csaAmount = max(uncollatVal[k] + ia - thresholdRcv, 0.0);
+                else
+                    csaAmount = min(uncollatVal[k] + ia + thresholdPay, 0.0);
+                Real collatShortfall = csaAmount - accountBalance[k] - openMargins;
+                Real mta = collatShortfall >= 0.0 ? mtaRcv : mtaPay;
+                margin[k] = fabs(collatShortfall) >= mta ? (collatShortfall) : 0.0;
+            }
+
+            // issue the new margin calls, see updateMarginCall()
+
+            Date payDateDelayed = simulationDate + lag;
+            for (const Date& payDate : {simulationDate, payDateDelayed}) {
+                if (recycledCalls.empty()) {
+                    recycledCalls.push_back(
+                        {Date(), vector<Real>(numScenarios, 0.0), vector<char>(numScenarios, false)});
+                }
+                OpenMarginCalls& calls = recycledCalls.front();
+                calls.payDate = payDate;
+                bool hasCalls = false;
+                for (Size k = 0; k < numScenarios; ++k) {
+                    bool open = false;
+                    if (margin[k] > 0.0 && eligMarginReqDateUs[n])
+                        open = (calcType == AsymmetricDVA ? simulationDate : payDateDelayed) == payDate;
+                    else if (margin[k] < 0.0 && eligMarginReqDateCtp[n])
+                        open = (calcType == AsymmetricCVA ? simulationDate : payDateDelayed) == payDate;
+                    calls.open[k] = open;
+                    calls.amounts[k] = open ? margin[k] : 0.0;
+                    hasCalls = hasCalls || open;
+                }
+                if (hasCalls) {
+                    auto pos = std::find_if(openCalls.begin(), openCalls.end(),
+                                            [&payDate](const OpenMarginCalls& c) { return c.payDate > payDate; });
+                    openCalls.splice(pos, recycledCalls, recycledCalls.begin());
+                }
+                // a single margin call is issued per scenario, if the pay dates coincide it is in the first group
+                if (payDateDelayed == simulationDate)
+                    break;
+            }
+        }
+
+        // step 5; set account balance to zero after maturity of portfolio, see CollateralAccount::closeAccount()
+
+        Date closeDate = simEndDate + Period(1, Days);
+        for (Size k = 0; k < numScenarios; ++k) {
+            QL_REQUIRE(closeDate > accountDate[k], "CollateralAccount error, invalid date "
+                                                       << " for closure of Collateral Account");
+            newAccountEntry(k, closeDate, 0.0);
+            while (nextBalanceDate[k] < dateGrid.size())
+                result[nextBalanceDate[k]++][k] = accountBalance[k];
+        }
+
+        return result;
+    } catch (const std::exception& e) {
+        QL_FAIL(e.what());
+    } catch (...) {
+        QL_FAIL("CollateralExposureHelper - unknown error when generating collateralBalances");
+    }
+}
+
 } // namespace analytics
 } // namespace ore
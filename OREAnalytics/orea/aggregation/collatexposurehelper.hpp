@@ -110,6 +110,20 @@ public:
         const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
         const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType = Symmetric,
         const QuantLib::ext::shared_ptr<CollateralBalance>& balance = QuantLib::ext::shared_ptr<CollateralBalance>());
+
+    /*!
+      Vectorised version of collateralBalancePaths() returning the collateral balances on the dateGrid by date and
+      scenario. The margin dates, interpolation weights and margin call pay dates do not depend on the scenario and
+      are set up once. The account balances and open margin calls are held in arrays over all scenarios, so that each
+      margin date is processed as a sequence of passes over the scenarios. The results are identical to
+      collateralBalancePaths()->at(k)->accountBalance(dateGrid[j]).
+    */
+    static vector<vector<Real>> collateralBalances(
+        const QuantLib::ext::shared_ptr<NettingSetDefinition>& csaDef, const Real& nettingSetPv, const Date& date_t0,
+        const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
+        const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
+        const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType = Symmetric,
+        const QuantLib::ext::shared_ptr<CollateralBalance>& balance = QuantLib::ext::shared_ptr<CollateralBalance>());
 };
 
 //! Convert text representation to CollateralExposureHelper::CalculationType
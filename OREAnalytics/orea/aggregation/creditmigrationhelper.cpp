@@ -32,6 +32,9 @@
 #include <ql/math/distributions/normaldistribution.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
+#include <exception>
+#include <thread>
+
 using namespace QuantLib;
 using namespace QuantExt;
 
@@ -472,11 +475,11 @@ Array CreditMigrationHelper::pnlDistribution(const Size date) {
     Size numPaths = cube_->samples();
     Real avgCash = 0.0;
 
-    HullWhiteBucketing hwBucketing(bucketing_.upperBucketBound().begin(), bucketing_.upperBucketBound().end());
-
     MersenneTwisterUniformRng mt(parameters_->seed());
 
-    for (Size path = 0; path < numPaths; ++path) {
+    // adds the weighted pnl distribution and market pnl of a path to resultDist, resultCash; the bucketing is
+    // passed in so that different paths can be processed in parallel
+    auto processPath = [&](const Size path, HullWhiteBucketing& hwBucketing, Array& resultDist, Real& resultCash) {
 
         // 2a market pnl (t0 to horizon date, over whole cube)
 
@@ -523,8 +526,8 @@ Array CreditMigrationHelper::pnlDistribution(const Size date) {
             // if we just add scalar market pnl realisations, we don't really need
             // the bucketing algorithm to do that, we just update the result
             // distribution directly
-            res[hwBucketing.index(cash)] += 1.0 / static_cast<Real>(numPaths);
-            continue;
+            resultDist[hwBucketing.index(cash)] += 1.0 / static_cast<Real>(numPaths);
+            return;
         }
 
         // 2b credit migration pnl (at horizon date, over entities specified in credit simulation parameters)
@@ -571,11 +574,58 @@ Array CreditMigrationHelper::pnlDistribution(const Size date) {
         hwBucketing.computeMultiState(condProbs.begin(), condProbs.end(), pnl.begin());
 
         // 2d add pnl contribution of path to result distribution
-        res += hwBucketing.probability() / static_cast<Real>(numPaths);
+        resultDist += hwBucketing.probability() / static_cast<Real>(numPaths);
         // average market risk pnl
-        avgCash += cash / static_cast<Real>(numPaths);
+        resultCash += cash / static_cast<Real>(numPaths);
+    };
+
+    /* The simulation of the idiosyncratic factors uses a single rng and shared storage for the entity states, so
+       the paths are processed sequentially in this case. Otherwise the paths are split into contiguous blocks
+       which are processed in parallel, each with its own bucketing and result distribution. The block results are
+       added in block order, so that the result is deterministic for a given number of threads. */
+
+    Size nThreads = parameters_->creditRisk() && evaluation_ != Evaluation::Analytic
+                        ? 1
+                        : std::max<Size>(1, std::min(parameters_->threads(), numPaths));
+
+    std::vector<HullWhiteBucketing> hwBucketings(
+        nThreads, HullWhiteBucketing(bucketing_.upperBucketBound().begin(), bucketing_.upperBucketBound().end()));
+    std::vector<Array> blockRes(nThreads, Array(bucketing_.buckets(), 0.0));
+    std::vector<Real> blockCash(nThreads, 0.0);
+
+    auto processBlock = [&](const Size b) {
+        Size start = b * numPaths / nThreads, end = (b + 1) * numPaths / nThreads;
+        for (Size path = start; path < end; ++path)
+            processPath(path, hwBucketings[b], blockRes[b], blockCash[b]);
+    };
+
+    if (nThreads == 1) {
+        processBlock(0);
+    } else {
+        DLOG("Process " << numPaths << " paths using " << nThreads << " threads");
+        std::vector<std::exception_ptr> errors(nThreads);
+        std::vector<std::thread> threads;
+        for (Size b = 0; b < nThreads; ++b) {
+            threads.emplace_back([&processBlock, &errors, b]() {
+                try {
+                    processBlock(b);
+                } catch (...) {
+                    errors[b] = std::current_exception();
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        for (auto const& e : errors) {
+            if (e)
+                std::rethrow_exception(e);
+        }
+    }
 
-    } // for path
+    for (Size b = 0; b < nThreads; ++b) {
+        res += blockRes[b];
+        avgCash += blockCash[b];
+    }
 
     DLOG("Expected Market Risk PnL at date " << date << ": " << avgCash);
     return res;
@@ -16,8 +16,8 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
-/*! \file orea/aggregation/dimcalculator.hpp
-    \brief Dynamic Initial Margin calculator base class
+/*! \file orea/aggregation/cvaspreadsensitivitycalculator.cpp
+    \brief CVA spread sensitivity calculator
     \ingroup analytics
 */
 
@@ -31,100 +31,132 @@ CVASpreadSensitivityCalculator::CVASpreadSensitivityCalculator(const string& key
                                                                const Handle<DefaultProbabilityTermStructure>& dts,
                                                                const Real& recovery,
                                                                const Handle<YieldTermStructure>& yts,
-                                                               const vector<Period>& shiftTenors, Real shiftSize)
+                                                               const vector<Period>& shiftTenors, Real shiftSize,
+                                                               const Matrix& jacobi)
     : key_(key), asof_(asof), epe_(epe), dates_(dates), dts_(dts), recovery_(recovery), yts_(yts),
       shiftTenors_(shiftTenors), shiftSize_(shiftSize) {
-    shiftTimes_ = vector<Real>(shiftTenors.size(), 0.0);
-    hazardRateSensitivities_ = vector<Real>(shiftTenors.size(), 0.0);
-    cdsSpreadSensitivities_ = vector<Real>(shiftTenors.size(), 0.0);
-    for (Size i = 0; i < shiftTenors_.size(); ++i)
-        shiftTimes_[i] = dts_->timeFromReference(asof_ + shiftTenors_[i]);
-
-    Real cvaBase = cva();
-    Array input(shiftTenors_.size(), 0.0);
-    for (Size i = 0; i < shiftTenors_.size(); ++i) {
-        Real cvaShifted = cva(true, i);
-        hazardRateSensitivities_[i] = cvaShifted - cvaBase;
-        input[i] = hazardRateSensitivities_[i];
+    Size n = shiftTenors_.size();
+    shiftTimes_ = shiftTimes(asof_, dts_, shiftTenors_);
+    hazardRateSensitivities_ = vector<Real>(n, 0.0);
+    cdsSpreadSensitivities_ = vector<Real>(n, 0.0);
+    QL_REQUIRE(epe_.size() > dates_.size(),
+               "CVA Calculator key=" << key_ << ": epe size " << epe_.size() << " does not match dates size "
+                                     << dates_.size());
+
+    // one pass over the exposure profile yields the CVA changes for shifts in all hazard rate buckets
+    Real cvaBase = 0.0;
+    vector<Real> f0(n), f1(n);
+    Real s0 = dts_->survivalProbability(dts_->timeFromReference(asof_));
+    shiftFactors(dts_->timeFromReference(asof_), shiftTimes_, shiftSize_, f0);
+    for (Size j = 0; j < dates_.size(); ++j) {
+        Time t1 = dts_->timeFromReference(dates_[j]);
+        Real s1 = dts_->survivalProbability(t1);
+        shiftFactors(t1, shiftTimes_, shiftSize_, f1);
+        Real lgdEpe = (1.0 - recovery_) * epe_[j + 1];
+        cvaBase += lgdEpe * (s0 - s1);
+        for (Size i = 0; i < n; ++i)
+            hazardRateSensitivities_[i] += lgdEpe * (s0 * (f0[i] - 1.0) - s1 * (f1[i] - 1.0));
+        s0 = s1;
+        std::swap(f0, f1);
     }
     DLOG("CVA Calculator key=" << key_ << " cvaBase=" << cvaBase);
 
-    jacobi_ = Matrix(shiftTenors_.size(), shiftTenors_.size(), 0.0);
-    for (Size i = 0; i < shiftTenors_.size(); ++i) {
-        Real cdsSpreadBase = fairCdsSpread(i);
-        DLOG("CVA Calculator key=" << key_ << " fairSpread[" << i << "]=" << cdsSpreadBase);
-        Real row = 0.0;
-        for (Size j = 0; j <= i; ++j) {
-            Real cdsSpread = fairCdsSpread(i, true, j);
-            jacobi_[j][i] = (cdsSpread - cdsSpreadBase) / shiftSize_;
-            row += jacobi_[j][i];
-            DLOG("CVA Calculator key=" << key_ << " jacobi[" << j << "][" << i << "]=" << jacobi_[j][i]);
-        }
-        DLOG("CVA Calculator key=" << key_ << " jacobi column[" << i << "]=" << row);
+    if (jacobi.rows() == 0) {
+        jacobi_ = cdsSpreadJacobian(asof_, dts_, recovery_, yts_, shiftTenors_, shiftSize_);
+    } else {
+        QL_REQUIRE(jacobi.rows() == n && jacobi.columns() == n, "CVA Calculator key="
+                                                                    << key_ << ": jacobi is " << jacobi.rows() << "x"
+                                                                    << jacobi.columns() << ", expected " << n << "x"
+                                                                    << n);
+        jacobi_ = jacobi;
     }
 
+    Array input(hazardRateSensitivities_.begin(), hazardRateSensitivities_.end());
     Array output = inverse(jacobi_) * input;
-    for (Size i = 0; i < shiftTenors_.size(); ++i)
+    for (Size i = 0; i < n; ++i)
         cdsSpreadSensitivities_[i] = output[i];
 }
 
-Real CVASpreadSensitivityCalculator::survivalProbability(Time t, bool shift, Size index) {
-    if (shift == false)
-        return dts_->survivalProbability(t);
-
-    QL_REQUIRE(index < shiftTimes_.size(), "index " << index << " out of range");
-    Real t2 = shiftTimes_[index];
-    Real t1 = index == 0 ? 0.0 : shiftTimes_[index - 1];
-    bool lastBucket = index == shiftTimes_.size() - 1 ? true : false;
-    if (t < t1)
-        return dts_->survivalProbability(t);
-    else if (t < t2) {
-        return dts_->survivalProbability(t) * exp(-shiftSize_ * (t - t1));
-    } else { // t >= t2
-        if (!lastBucket)
-            return dts_->survivalProbability(t) * exp(-shiftSize_ * (t2 - t1));
+vector<Real> CVASpreadSensitivityCalculator::shiftTimes(const Date& asof,
+                                                        const Handle<DefaultProbabilityTermStructure>& dts,
+                                                        const vector<Period>& shiftTenors) {
+    vector<Real> times(shiftTenors.size(), 0.0);
+    for (Size i = 0; i < shiftTenors.size(); ++i)
+        times[i] = dts->timeFromReference(asof + shiftTenors[i]);
+    return times;
+}
+
+void CVASpreadSensitivityCalculator::shiftFactors(Time t, const vector<Real>& shiftTimes, Real shiftSize,
+                                                  vector<Real>& factors) {
+    factors.resize(shiftTimes.size());
+    for (Size i = 0; i < shiftTimes.size(); ++i) {
+        Real t1 = i == 0 ? 0.0 : shiftTimes[i - 1];
+        Real t2 = shiftTimes[i];
+        bool lastBucket = i == shiftTimes.size() - 1;
+        if (t < t1)
+            factors[i] = 1.0;
+        else if (t < t2 || lastBucket)
+            factors[i] = exp(-shiftSize * (t - t1));
         else
-            return dts_->survivalProbability(t) * exp(-shiftSize_ * (t - t1));
+            factors[i] = exp(-shiftSize * (t2 - t1));
     }
 }
 
-Real CVASpreadSensitivityCalculator::survivalProbability(Date d, bool shift, Size index) {
-    Real t = dts_->timeFromReference(d);
-    return survivalProbability(t, shift, index);
-}
+Matrix CVASpreadSensitivityCalculator::cdsSpreadJacobian(const Date& asof,
+                                                         const Handle<DefaultProbabilityTermStructure>& dts,
+                                                         const Real& recovery, const Handle<YieldTermStructure>& yts,
+                                                         const vector<Period>& shiftTenors, Real shiftSize) {
+    // not following the CDS2015 date rule, but CDS with 6m periods, paying at period ends, no rebate
+    vector<Real> times = shiftTimes(asof, dts, shiftTenors);
+    Size n = times.size();
+    Real dt = 0.5;
+    vector<Size> periods(n);
+    Size maxPeriods = 0;
+    for (Size i = 0; i < n; ++i) {
+        periods[i] = Size(floor(times[i] / dt + 0.5));
+        QL_REQUIRE(fabs(times[i] - dt * periods[i]) < 0.1 * dt, "shift term is not a multiple of 6M");
+        maxPeriods = std::max(maxPeriods, periods[i]);
+    }
 
-Real CVASpreadSensitivityCalculator::cva(bool shift, Size index) {
-    Real sum = 0.0;
-    for (Size j = 0; j < dates_.size(); ++j) {
-        Date d0 = j == 0 ? asof_ : dates_[j - 1];
-        Date d1 = dates_[j];
-        Real s0 = survivalProbability(d0, shift, index);
-        Real s1 = survivalProbability(d1, shift, index);
-        Real increment = (1.0 - recovery_) * (s0 - s1) * epe_[j + 1];
-        sum += increment;
+    /* One pass over the premium periods of the longest CDS yields the fair spreads of all terms, unshifted (index 0)
+       and with shifted hazard rates in bucket j (index j + 1) */
+    vector<Real> enumerator(n + 1, 0.0), denominator(n + 1, 0.0), f0(n), f1(n);
+    Matrix spreads(n + 1, n, 0.0);
+    Real s0 = dts->survivalProbability(0.0);
+    shiftFactors(0.0, times, shiftSize, f0);
+    for (Size k = 1; k <= maxPeriods; ++k) {
+        Real t1 = dt * k;
+        Real s1 = dts->survivalProbability(t1);
+        Real dis = yts->discount(t1);
+        shiftFactors(t1, times, shiftSize, f1);
+        enumerator[0] += (s0 - s1) * dis;
+        denominator[0] += dt * s1 * dis;
+        for (Size j = 0; j < n; ++j) {
+            enumerator[j + 1] += (s0 * f0[j] - s1 * f1[j]) * dis;
+            denominator[j + 1] += dt * s1 * f1[j] * dis;
+        }
+        for (Size i = 0; i < n; ++i) {
+            if (periods[i] == k) {
+                for (Size j = 0; j <= n; ++j)
+                    spreads[j][i] = (1.0 - recovery) * enumerator[j] / denominator[j];
+            }
+        }
+        s0 = s1;
+        std::swap(f0, f1);
     }
-    DLOG("CVA Calculator key=" << key_ << " shift=" << shift << " index=" << index << " cva=" << sum);
-    return sum;
-}
 
-Real CVASpreadSensitivityCalculator::fairCdsSpread(Size term, bool shift, Size index) {
-    // not following the CDS2015 date rule, but a CDS with 6m periods, paying at period ends, no rebate
-    QL_REQUIRE(term < shiftTimes_.size(), "term " << term << " out of range");
-    Real T = shiftTimes_[term];
-    Real dt = 0.5;
-    Size n = Size(floor(T / dt + 0.5));
-    QL_REQUIRE(fabs(T - dt * n) < 0.1 * dt, "shift term is not a multiple of 6M");
-    Real enumerator = 0.0, denominator = 0.0;
-    for (Size i = 1; i <= n; ++i) {
-        Real t0 = dt * (i - 1);
-        Real t1 = dt * i;
-        Real s0 = survivalProbability(t0, shift, index);
-        Real s1 = survivalProbability(t1, shift, index);
-        Real dis = yts_->discount(t1);
-        enumerator += (s0 - s1) * dis;
-        denominator += dt * s1 * dis;
+    Matrix jacobi(n, n, 0.0);
+    for (Size i = 0; i < n; ++i) {
+        DLOG("CVA Calculator fairSpread[" << i << "]=" << spreads[0][i]);
+        Real row = 0.0;
+        for (Size j = 0; j <= i; ++j) {
+            jacobi[j][i] = (spreads[j + 1][i] - spreads[0][i]) / shiftSize;
+            row += jacobi[j][i];
+            DLOG("CVA Calculator jacobi[" << j << "][" << i << "]=" << jacobi[j][i]);
+        }
+        DLOG("CVA Calculator jacobi column[" << i << "]=" << row);
     }
-    return (1.0 - recovery_) * enumerator / denominator;
+    return jacobi;
 }
 
 } // namespace analytics
@@ -16,8 +16,8 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
-/*! \file orea/aggregation/dimcalculator.hpp
-    \brief Dynamic Initial Margin calculator base class
+/*! \file orea/aggregation/cvaspreadsensitivitycalculator.hpp
+    \brief CVA spread sensitivity calculator
     \ingroup analytics
 */
 
@@ -45,8 +45,13 @@ using namespace std;
 
 //! CVA Spread Sensitivity Calculator
 /*!
-  Compute hazard rate and CDS spread sensitivities for a given exposure profile 
+  Compute hazard rate and CDS spread sensitivities for a given exposure profile
   on an externally provided sensitivity grid.
+
+  The hazard rate sensitivities w.r.t. all grid buckets are computed in one pass over the exposure profile, applying
+  the hazard rate shifts to the survival probabilities in closed form. The Jacobian of the fair CDS spreads w.r.t.
+  the hazard rates only depends on the credit curve, so that it can be computed once with cdsSpreadJacobian() and
+  passed to the calculators of all netting sets sharing the curve.
 */
 class CVASpreadSensitivityCalculator {
 public:
@@ -67,7 +72,14 @@ public:
 				   //! Shift grid
 				   const vector<Period>& shiftTenors,
 				   //! Shift size
-				   Real shiftSize = 0.0001);  
+				   Real shiftSize = 0.0001,
+				   //! Jacobian from cdsSpreadJacobian(), computed if empty
+				   const Matrix& jacobi = Matrix());
+
+    //! Jacobian of the fair CDS spreads w.r.t. the hazard rates, jacobi[j][i] = d spread_i / d hazard rate_j
+    static Matrix cdsSpreadJacobian(const Date& asof, const Handle<DefaultProbabilityTermStructure>& dts,
+                                    const Real& recovery, const Handle<YieldTermStructure>& yts,
+                                    const vector<Period>& shiftTenors, Real shiftSize = 0.0001);
   
     //! Inspectors
     // @{
@@ -91,14 +103,13 @@ public:
     // @}
 
 private:
-    // survival probability with shifted hazard rates in the specified bucket 
-    Real survivalProbability(Date d, bool shift, Size index);
-    Real survivalProbability(Time t, bool shift, Size index);
-    // CVA calculation with and without shifted hazard rates
-    Real cva(bool shift = false, Size index = 0);
-    //! Fair CDS Spread calculation with and without shifted hazard rates
-    Real fairCdsSpread(Size term, bool shift = false, Size index = 0);
-		     
+    // time of the shift grid tenors
+    static vector<Real> shiftTimes(const Date& asof, const Handle<DefaultProbabilityTermStructure>& dts,
+                                   const vector<Period>& shiftTenors);
+    /* factors exp(-shiftSize * overlap) applied to the survival probability at time t by a shift of the hazard rate in
+       each bucket [t_{i-1}, t_i], the last bucket is extended to infinity */
+    static void shiftFactors(Time t, const vector<Real>& shiftTimes, Real shiftSize, vector<Real>& factors);
+
     string key_;
     Date asof_;
     vector<Real> epe_;
@@ -28,6 +28,7 @@
 #include <ql/methods/montecarlo/lsmbasissystem.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
+#include <qle/math/chunkworkers.hpp>
 #include <qle/math/nadarayawatson.hpp>
 #include <qle/math/stabilisedglls.hpp>
 
@@ -116,6 +117,11 @@ void RegressionDynamicInitialMarginCalculator::build() {
     Size simple_dim_index_h = Size(floor(quantile_ * (samples - 1) + 0.5));
     Size simple_dim_index_p = Size(floor((1.0 - quantile_) * (samples - 1) + 0.5));
 
+    // netting sets to be processed by regression below, their index in the dim cube and their DIM scaling
+    vector<string> nettingSets;
+    vector<Size> nettingSetIndex;
+    vector<Real> nettingSetDimScaling;
+
     Size nettingSetCount = 0;
     for (auto n : nettingSetIds_) {
         LOG("Process netting set " << n);
@@ -152,6 +158,7 @@ void RegressionDynamicInitialMarginCalculator::build() {
                 }
                 WLOG("Overriding DIM for netting set " << n << " succeeded");
                 // continue to the next netting set
+                nettingSetCount++;
                 continue;
             }
         }
@@ -166,140 +173,193 @@ void RegressionDynamicInitialMarginCalculator::build() {
             nettingSetScaling_[n] = t0scaling;
         }
 
-        Real nettingSetDimScaling =
-            nettingSetScaling_.find(n) == nettingSetScaling_.end() ? 1.0 : nettingSetScaling_[n];
-        LOG("Netting set DIM scaling factor: " << nettingSetDimScaling);
+        Real dimScaling = nettingSetScaling_.find(n) == nettingSetScaling_.end() ? 1.0 : nettingSetScaling_[n];
+        LOG("Netting set DIM scaling factor: " << dimScaling);
 
-        for (Size j = 0; j < stopDatesLoop; ++j) {
-            accumulator_set<double, stats<boost::accumulators::tag::mean, boost::accumulators::tag::variance>> accDiff;
-            accumulator_set<double, stats<boost::accumulators::tag::mean>> accOneOverNumeraire;
-            for (Size k = 0; k < samples; ++k) {
-                Real numDefault =
-                    cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real numCloseOut =
-                    cubeInterpretation_->getCloseOutAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real npvDefault = nettingSetNPV_[n][j][k];
-                Real flow = nettingSetFLOW_[n][j][k];
-                Real npvCloseOut = nettingSetCloseOutNPV_[n][j][k];
-                accDiff((npvCloseOut * numCloseOut) + (flow * numDefault) - (npvDefault * numDefault));
-                accOneOverNumeraire(1.0 / numDefault);
-            }
+        nettingSets.push_back(n);
+        nettingSetIndex.push_back(nettingSetCount);
+        nettingSetDimScaling.push_back(dimScaling);
+        nettingSetCount++;
+    }
 
-            Size mporCalendarDays = cubeInterpretation_->getMporCalendarDays(cube_, j);
-            Real horizonScaling = sqrt(1.0 * horizonCalendarDays_ / mporCalendarDays);
+    /* The regressors other than the netting set NPV and the numeraires are the same for all netting sets, they are
+       evaluated once per date and sample. If the netting set NPV is not among the regressors, the regressions of all
+       netting sets at a date share the design matrix, which is then decomposed only once. The dates are processed in
+       parallel, each date only writes to its own slots of the results. */
+
+    vector<Size> npvRegressors;
+    for (Size i = 0; i < regressors_.size(); ++i)
+        if (boost::to_upper_copy(regressors_[i]) == "NPV")
+            npvRegressors.push_back(i);
+    bool sharedRegressors = !regressors_.empty() && npvRegressors.empty();
+    LOG("DIM regressors shared across netting sets: " << std::boolalpha << sharedRegressors);
+
+    QuantExt::ChunkWorkers workers(inputs_ ? inputs_->nThreads() : 1);
+    LOG("DIM regression over " << stopDatesLoop << " dates using " << workers.nThreads() << " threads");
+
+    workers.run(stopDatesLoop, [&](const Size j) {
+        vector<Real> numDefault(samples), numCloseOut(samples);
+        accumulator_set<double, stats<boost::accumulators::tag::mean>> accOneOverNumeraire;
+        for (Size k = 0; k < samples; ++k) {
+            numDefault[k] =
+                cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
+            numCloseOut[k] =
+                cubeInterpretation_->getCloseOutAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
+            accOneOverNumeraire(1.0 / numDefault[k]);
+        }
+        // "re-discount" (the stdev is calculated on non-discounted deltaNPVs)
+        Real E_OneOverNumeraire = mean(accOneOverNumeraire);
 
-            Real stdevDiff = sqrt(boost::accumulators::variance(accDiff));
-            Real E_OneOverNumeraire =
-                mean(accOneOverNumeraire); // "re-discount" (the stdev is calculated on non-discounted deltaNPVs)
+        vector<Array> scenarioRegressors(regressors_.empty() ? 0 : samples);
+        for (Size k = 0; k < scenarioRegressors.size(); ++k)
+            scenarioRegressors[k] = scenarioRegressorArray(j, k);
 
-            nettingSetZeroOrderDIM_[n][j] = stdevDiff * horizonScaling * confidenceLevel;
-            nettingSetZeroOrderDIM_[n][j] *= E_OneOverNumeraire;
+        Size mporCalendarDays = cubeInterpretation_->getMporCalendarDays(cube_, j);
+        Real horizonScaling = sqrt(1.0 * horizonCalendarDays_ / mporCalendarDays);
 
-            vector<Real> rx0(samples, 0.0);
-            vector<Array> rx(samples, Array());
-            vector<Real> ry1(samples, 0.0);
-            vector<Real> ry2(samples, 0.0);
+        // regressor values and regressands of the netting sets with non-zero std dev at this date
+        vector<Size> regressed;
+        vector<const vector<Array>*> rx;
+        vector<vector<Real>> ry2;
+
+        for (Size i = 0; i < nettingSets.size(); ++i) {
+            const string& n = nettingSets[i];
+            const vector<Real>& npv = nettingSetNPV_.at(n)[j];
+            const vector<Real>& flow = nettingSetFLOW_.at(n)[j];
+            const vector<Real>& closeOutNpv = nettingSetCloseOutNPV_.at(n)[j];
+            vector<Real>& deltaNpv = nettingSetDeltaNPV_.at(n)[j];
+            vector<Array>& regressors = regressorArray_.at(n)[j];
+
+            accumulator_set<double, stats<boost::accumulators::tag::mean, boost::accumulators::tag::variance>> accDiff;
             for (Size k = 0; k < samples; ++k) {
-                Real numDefault =
-                    cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real numCloseOut =
-                    cubeInterpretation_->getCloseOutAggregationScenarioData(AggregationScenarioDataType::Numeraire, j, k);
-                Real x = nettingSetNPV_[n][j][k] * numDefault;
-                Real f = nettingSetFLOW_[n][j][k] * numDefault;
-                Real y = nettingSetCloseOutNPV_[n][j][k] * numCloseOut;
-                Real z = (y + f - x);
-                rx[k] = regressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
-                rx0[k] = rx[k][0];
-                ry1[k] = z;     // for local regression
-                ry2[k] = z * z; // for least squares regression
-                nettingSetDeltaNPV_[n][j][k] = z;
-                regressorArray_[n][j][k] = rx[k];
+                Real x = npv[k] * numDefault[k];
+                Real f = flow[k] * numDefault[k];
+                Real y = closeOutNpv[k] * numCloseOut[k];
+                deltaNpv[k] = y + f - x;
+                accDiff(deltaNpv[k]);
+                if (regressors_.empty()) {
+                    regressors[k] = Array(1, npv[k]);
+                } else {
+                    regressors[k] = scenarioRegressors[k];
+                    for (auto r : npvRegressors)
+                        regressors[k][r] = npv[k];
+                }
             }
-            vector<Real> delNpvVec_copy = nettingSetDeltaNPV_[n][j];
+
+            Real stdevDiff = sqrt(boost::accumulators::variance(accDiff));
+            nettingSetZeroOrderDIM_.at(n)[j] = stdevDiff * horizonScaling * confidenceLevel * E_OneOverNumeraire;
+
+            vector<Real> delNpvVec_copy = deltaNpv;
             sort(delNpvVec_copy.begin(), delNpvVec_copy.end());
             Real simpleDim_h = delNpvVec_copy[simple_dim_index_h];
             Real simpleDim_p = delNpvVec_copy[simple_dim_index_p];
-            simpleDim_h *= horizonScaling;                                  // the usual scaling factors
-            simpleDim_p *= horizonScaling;                                  // the usual scaling factors
-            nettingSetSimpleDIMh_[n][j] = simpleDim_h * E_OneOverNumeraire; // discounted DIM
-            nettingSetSimpleDIMp_[n][j] = simpleDim_p * E_OneOverNumeraire; // discounted DIM
+            simpleDim_h *= horizonScaling;                                       // the usual scaling factors
+            simpleDim_p *= horizonScaling;                                       // the usual scaling factors
+            nettingSetSimpleDIMh_.at(n)[j] = simpleDim_h * E_OneOverNumeraire; // discounted DIM
+            nettingSetSimpleDIMp_.at(n)[j] = simpleDim_p * E_OneOverNumeraire; // discounted DIM
 
-            QL_REQUIRE(rx.size() > v.size(), "not enough points for regression with polynom order " << polynomOrder);
+            QL_REQUIRE(samples > v.size(), "not enough points for regression with polynom order " << polynomOrder);
             if (close_enough(stdevDiff, 0.0)) {
-                LOG("DIM: Zero std dev estimation at step " << j);
+                LOG("DIM: Zero std dev estimation at step " << j << " for netting set " << n);
                 // Skip IM calculation if all samples have zero NPV (e.g. after latest maturity)
                 for (Size k = 0; k < samples; ++k) {
-                    nettingSetDIM_[n][j][k] = 0.0;
-                    nettingSetLocalDIM_[n][j][k] = 0.0;
-                }
-            } else {
-                // Least squares polynomial regression with specified polynom order
-                QuantExt::StabilisedGLLS ls(rx, ry2, v, QuantExt::StabilisedGLLS::MeanStdDev);
-                LOG("DIM data normalisation at time step "
-                    << j << ": " << scientific << setprecision(6) << " x-shift = " << ls.xShift() << " x-multiplier = "
-                    << ls.xMultiplier() << " y-shift = " << ls.yShift() << " y-multiplier = " << ls.yMultiplier());
-                LOG("DIM regression coefficients at time step " << j << ": " << fixed << setprecision(6)
-                                                                << ls.transformedCoefficients());
-
-                // Local regression versus first regression variable (i.e. we do not perform a
-                // multidimensional local regression):
-                // We evaluate this at a limited number of samples only for validation purposes.
-                // Note that computational effort scales quadratically with number of samples.
-                // NadarayaWatson needs a large number of samples for good results.
-                QuantExt::NadarayaWatson lr(rx0.begin(), rx0.end(), ry1.begin(),
-                                            GaussianKernel(0.0, localRegressionBandWidth_));
-                Size localRegressionSamples = samples;
-                if (localRegressionEvaluations_ > 0)
-                    localRegressionSamples = Size(floor(1.0 * samples / localRegressionEvaluations_ + .5));
-
-                // Evaluate regression function to compute DIM for each scenario
-                for (Size k = 0; k < samples; ++k) {
-                    // Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                    Real numDefault = cubeInterpretation_->getDefaultAggregationScenarioData(
-                        AggregationScenarioDataType::Numeraire, j, k);
-                    Array regressor = regressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
-                    Real e = ls.eval(regressor, v);
-                    if (e < 0.0)
-                        LOG("Negative variance regression for date " << j << ", sample " << k
-                                                                     << ", regressor = " << regressor);
-
-                    // Note:
-                    // 1) We assume vanishing mean of "z", because the drift over a MPOR is usually small,
-                    //    and to avoid a second regression for the conditional mean
-                    // 2) In particular the linear regression function can yield negative variance values in
-                    //    extreme scenarios where an exact analytical or delta VaR calculation would yield a
-                    //    variance approaching zero. We correct this here by taking the positive part.
-                    Real std = sqrt(std::max(e, 0.0));
-                    Real scalingFactor = horizonScaling * confidenceLevel * nettingSetDimScaling;
-                    // Real dim = std * scalingFactor / num1;
-                    Real dim = std * scalingFactor / numDefault;
-                    dimCube_->set(dim, nettingSetCount, j, k);
-                    nettingSetDIM_[n][j][k] = dim;
-                    nettingSetExpectedDIM_[n][j] += dim / samples;
-
-                    // Evaluate the Kernel regression for a subset of the samples only (performance)
-                    if (localRegressionEvaluations_ > 0 && (k % localRegressionSamples == 0))
-                        // nettingSetLocalDIM_[n][j][k] = lr.standardDeviation(regressor[0]) * scalingFactor / num1;
-                        nettingSetLocalDIM_[n][j][k] = lr.standardDeviation(regressor[0]) * scalingFactor / numDefault;
-                    else
-                        nettingSetLocalDIM_[n][j][k] = 0.0;
+                    nettingSetDIM_.at(n)[j][k] = 0.0;
+                    nettingSetLocalDIM_.at(n)[j][k] = 0.0;
                 }
+                continue;
             }
+
+            regressed.push_back(i);
+            rx.push_back(&regressors);
+            ry2.push_back(deltaNpv); // for least squares regression
+            for (auto& z : ry2.back())
+                z *= z;
         }
 
-        nettingSetCount++;
-    }
+        if (regressed.empty())
+            return;
+
+        // Least squares polynomial regression with specified polynom order, one decomposition for all netting sets
+        // if the regressors are shared, otherwise one per netting set
+        vector<QuantLib::ext::shared_ptr<QuantExt::StabilisedMultiGLLS>> ls;
+        if (sharedRegressors) {
+            ls.push_back(QuantLib::ext::make_shared<QuantExt::StabilisedMultiGLLS>(
+                *rx.front(), ry2, v, QuantExt::StabilisedGLLS::MeanStdDev));
+        } else {
+            for (Size l = 0; l < regressed.size(); ++l)
+                ls.push_back(QuantLib::ext::make_shared<QuantExt::StabilisedMultiGLLS>(
+                    *rx[l], vector<vector<Real>>(1, ry2[l]), v, QuantExt::StabilisedGLLS::MeanStdDev));
+        }
+
+        for (Size l = 0; l < regressed.size(); ++l) {
+            Size i = regressed[l];
+            const string& n = nettingSets[i];
+            const QuantExt::StabilisedMultiGLLS& fit = sharedRegressors ? *ls.front() : *ls[l];
+            Size fitIndex = sharedRegressors ? l : 0;
+            const vector<Array>& regressors = *rx[l];
+
+            LOG("DIM data normalisation at time step "
+                << j << " for netting set " << n << ": " << scientific << setprecision(6)
+                << " x-shift = " << fit.xShift() << " x-multiplier = " << fit.xMultiplier()
+                << " y-shift = " << fit.yShift(fitIndex) << " y-multiplier = " << fit.yMultiplier(fitIndex));
+            LOG("DIM regression coefficients at time step " << j << " for netting set " << n << ": " << fixed
+                                                            << setprecision(6)
+                                                            << fit.transformedCoefficients(fitIndex));
+
+            // Local regression versus first regression variable (i.e. we do not perform a
+            // multidimensional local regression):
+            // We evaluate this at a limited number of samples only for validation purposes.
+            // Note that computational effort scales quadratically with number of samples.
+            // NadarayaWatson needs a large number of samples for good results.
+            vector<Real> rx0(samples);
+            for (Size k = 0; k < samples; ++k)
+                rx0[k] = regressors[k][0];
+            QuantExt::NadarayaWatson lr(rx0.begin(), rx0.end(), nettingSetDeltaNPV_.at(n)[j].begin(),
+                                        GaussianKernel(0.0, localRegressionBandWidth_));
+            Size localRegressionSamples = samples;
+            if (localRegressionEvaluations_ > 0)
+                localRegressionSamples = Size(floor(1.0 * samples / localRegressionEvaluations_ + .5));
+
+            // Evaluate regression function to compute DIM for each scenario
+            Real scalingFactor = horizonScaling * confidenceLevel * nettingSetDimScaling[i];
+            for (Size k = 0; k < samples; ++k) {
+                const Array& regressor = regressors[k];
+                Real e = fit.eval(fitIndex, regressor, v);
+                if (e < 0.0)
+                    LOG("Negative variance regression for date " << j << ", sample " << k
+                                                                 << ", regressor = " << regressor);
+
+                // Note:
+                // 1) We assume vanishing mean of "z", because the drift over a MPOR is usually small,
+                //    and to avoid a second regression for the conditional mean
+                // 2) In particular the linear regression function can yield negative variance values in
+                //    extreme scenarios where an exact analytical or delta VaR calculation would yield a
+                //    variance approaching zero. We correct this here by taking the positive part.
+                Real std = sqrt(std::max(e, 0.0));
+                Real dim = std * scalingFactor / numDefault[k];
+                dimCube_->set(dim, nettingSetIndex[i], j, k);
+                nettingSetDIM_.at(n)[j][k] = dim;
+                nettingSetExpectedDIM_.at(n)[j] += dim / samples;
+
+                // Evaluate the Kernel regression for a subset of the samples only (performance)
+                if (localRegressionEvaluations_ > 0 && (k % localRegressionSamples == 0))
+                    nettingSetLocalDIM_.at(n)[j][k] =
+                        lr.standardDeviation(regressor[0]) * scalingFactor / numDefault[k];
+                else
+                    nettingSetLocalDIM_.at(n)[j][k] = 0.0;
+            }
+        }
+    });
+
     LOG("DIM by polynomial regression done");
 }
 
-Array RegressionDynamicInitialMarginCalculator::regressorArray(string nettingSet, Size dateIndex,
-                                                                           Size sampleIndex) {
-    Array a(regressors_.size());
+Array RegressionDynamicInitialMarginCalculator::scenarioRegressorArray(Size dateIndex, Size sampleIndex) const {
+    Array a(regressors_.size(), 0.0);
     for (Size i = 0; i < regressors_.size(); ++i) {
-        string variable = regressors_[i];
-        if (boost::to_upper_copy(variable) ==
-            "NPV") // this allows possibility to include NPV as a regressor alongside more fundamental risk factors
-            a[i] = nettingSetNPV_[nettingSet][dateIndex][sampleIndex];
+        const string& variable = regressors_[i];
+        if (boost::to_upper_copy(variable) == "NPV") // filled in per netting set
+            continue;
         else if (scenarioData_->has(AggregationScenarioDataType::IndexFixing, variable))
             a[i] = cubeInterpretation_->getDefaultAggregationScenarioData(AggregationScenarioDataType::IndexFixing,
                                                                       dateIndex, sampleIndex, variable);
@@ -78,8 +78,9 @@ public:
     const vector<Real>& simpleResultsLower(const string& nettingSet);
 
 private:
-    //! Compile the array of DIM regressors for the specified netting set, date and sample index
-    Array regressorArray(string nettingSet, Size dateIndex, Size sampleIndex);
+    /*! Compile the array of DIM regressors for the specified date and sample index, the entries for the netting set
+        NPV regressors are left zero */
+    Array scenarioRegressorArray(Size dateIndex, Size sampleIndex) const;
 
     Size regressionOrder_;
     vector<string> regressors_;
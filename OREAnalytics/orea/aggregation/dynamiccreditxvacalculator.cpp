@@ -43,12 +43,13 @@ DynamicCreditXvaCalculator::DynamicCreditXvaCalculator(
     const QuantLib::ext::shared_ptr<NPVCube>& cptyCube,
     const Size tradeEpeIndex, const Size tradeEneIndex,
     const Size nettingSetEpeIndex, const Size nettingSetEneIndex, const Size cptySpIndex,
-    const bool flipViewXVA, const string& flipViewBorrowingCurvePostfix, const string& flipViewLendingCurvePostfix)
+    const bool flipViewXVA, const string& flipViewBorrowingCurvePostfix, const string& flipViewLendingCurvePostfix,
+    const Size nThreads)
     : ValueAdjustmentCalculator(portfolio, market, configuration, baseCurrency, dvaName,
                                 fvaBorrowingCurve, fvaLendingCurve, applyDynamicInitialMargin,
                                 dimCalculator, tradeExposureCube, nettingSetExposureCube, tradeEpeIndex, tradeEneIndex, 
                                 nettingSetEpeIndex, nettingSetEneIndex, 
-                                flipViewXVA, flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix),
+                                flipViewXVA, flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix, nThreads),
       cptyCube_(cptyCube), cptySpIndex_(cptySpIndex) {
     // check consistency of input
 
@@ -59,6 +60,12 @@ DynamicCreditXvaCalculator::DynamicCreditXvaCalculator(
     QL_REQUIRE(cptySpIndex < cptyCube->depth(), "cptySpIndex("
         << cptySpIndex << ") exceeds depth of cptyCube("
         << cptyCube->depth() << ")");
+
+    QL_REQUIRE(tradeExposureCube_->samples() == nettingSetExposureCube_->samples() &&
+                   tradeExposureCube_->samples() == cptyCube->samples(),
+               "number of samples in tradeExposureCube, nettingSetExposureCube and cptyCube mismatch ("
+                   << tradeExposureCube_->samples() << ", " << nettingSetExposureCube_->samples() << ", "
+                   << cptyCube->samples() << ")");
     
     for (Size i = 0; i < tradeExposureCube_->numDates(); i++) {
         QL_REQUIRE(tradeExposureCube_->dates()[i] == cptyCube->dates()[i],
@@ -68,117 +75,28 @@ DynamicCreditXvaCalculator::DynamicCreditXvaCalculator(
 }
 
 
-const Real DynamicCreditXvaCalculator::calculateCvaIncrement(
-    const string& tid, const string& cid, const Date& d0, const Date& d1, const Real& rr) {
-    Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(cid, d1, k, cptySpIndex_);
-        Real epe = tradeExposureCube_->get(tid, d1, k, tradeEpeIndex_);
-        increment += (s0 - s1) * epe;
-    }
-    return (1.0 - rr) * increment / tradeExposureCube_->samples();
+vector<Real> DynamicCreditXvaCalculator::survivalProbabilities(const string& name) {
+    auto idx = cptyCube_->idsAndIndexes().find(name);
+    QL_REQUIRE(idx != cptyCube_->idsAndIndexes().end(), "name " << name << " not found in cptyCube");
+    const Size n = samples();
+    // the survival probability as of today is 1 on all paths
+    vector<Real> sp((dates().size() + 1) * n, 1.0);
+    for (Size j = 0; j < dates().size(); ++j)
+        for (Size k = 0; k < n; ++k)
+            sp[(j + 1) * n + k] = cptyCube_->get(idx->second, j, k, cptySpIndex_);
+    return sp;
 }
 
-const Real DynamicCreditXvaCalculator::calculateDvaIncrement(
-    const string& tid, const Date& d0, const Date& d1, const Real& rr) {
-    Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(dvaName_, d1, k, cptySpIndex_);
-        Real ene = tradeExposureCube_->get(tid, d1, k, tradeEneIndex_);
-        increment += (s0 - s1) * ene;
-    }
-    return (1.0 - rr) * increment / tradeExposureCube_->samples();
-}
-
-const Real DynamicCreditXvaCalculator::calculateNettingSetCvaIncrement(
-    const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& rr) {
-    Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(cid, d1, k, cptySpIndex_);
-        Real epe = nettingSetExposureCube_->get(nid, d1, k, nettingSetEpeIndex_);
-        increment += (s0 - s1) * epe;
-    }
-    return (1.0 - rr) * increment / nettingSetExposureCube_->samples();
-}
-
-const Real DynamicCreditXvaCalculator::calculateNettingSetDvaIncrement(
-    const string& nid, const Date& d0, const Date& d1, const Real& rr) {
-    Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = d0 == asof() ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real s1 = cptyCube_->get(dvaName_, d1, k, cptySpIndex_);
-        Real ene = nettingSetExposureCube_->get(nid, d1, k, nettingSetEneIndex_);
-        increment += (s0 - s1) * ene;
-    }
-    return (1.0 - rr) * increment / nettingSetExposureCube_->samples();
-}
-
-const Real DynamicCreditXvaCalculator::calculateFbaIncrement(
-    const string& tid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real ene = tradeExposureCube_->get(tid, d1, k, tradeEneIndex_);
-        increment += s0 * s1 * ene;
-    }
-    return increment * dcf / tradeExposureCube_->samples();
-}
-
-const Real DynamicCreditXvaCalculator::calculateFcaIncrement(
-    const string& tid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Real increment = 0.0;
-    for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real epe = tradeExposureCube_->get(tid, d1, k, tradeEpeIndex_);
-        increment += s0 * s1 * epe;
-    }
-    return increment * dcf / tradeExposureCube_->samples();
-}
-
-const Real DynamicCreditXvaCalculator::calculateNettingSetFbaIncrement(
-    const string& nid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real ene = nettingSetExposureCube_->get(nid, d1, k, nettingSetEneIndex_);
-        increment += s0 * s1 * ene;
-    }
-    return increment * dcf / nettingSetExposureCube_->samples();
-}
-
-const Real DynamicCreditXvaCalculator::calculateNettingSetFcaIncrement(
-    const string& nid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real epe = nettingSetExposureCube_->get(nid, d1, k, nettingSetEpeIndex_);
-        increment += s0 * s1 * epe;
-    }
-    return increment * dcf / nettingSetExposureCube_->samples();
-}
-
-const Real DynamicCreditXvaCalculator::calculateNettingSetMvaIncrement(
-    const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& dcf) {
-
-    Real increment = 0.0;
-    for (Size k = 0; k < nettingSetExposureCube_->samples(); ++k) {
-        Real s0 = (d0 == asof() || cid == "") ? 1.0 : cptyCube_->get(cid, d0, k, cptySpIndex_);
-        Real s1 = (d0 == asof() || dvaName_ == "") ? 1.0 : cptyCube_->get(dvaName_, d0, k, cptySpIndex_);
-        Real im = dimCalculator_->dimCube()->get(nid, d1, k);
-        increment += s0 * s1 * im;
-    }
-    return increment * dcf / nettingSetExposureCube_->samples();
+vector<Real> DynamicCreditXvaCalculator::initialMargin(const string& nid) {
+    const auto& dimCube = dimCalculator_->dimCube();
+    auto idx = dimCube->idsAndIndexes().find(nid);
+    QL_REQUIRE(idx != dimCube->idsAndIndexes().end(), "netting set " << nid << " not found in dimCube");
+    const Size n = samples();
+    vector<Real> im(dates().size() * n);
+    for (Size j = 0; j < dates().size(); ++j)
+        for (Size k = 0; k < n; ++k)
+            im[j * n + k] = dimCube->get(idx->second, dimCube->index(dates()[j]), k);
+    return im;
 }
 
 } // namespace analytics
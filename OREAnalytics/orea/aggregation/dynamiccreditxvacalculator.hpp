@@ -78,28 +78,15 @@ public:
 	//! Postfix for flipView borrowing curves for fva
 	const string& flipViewBorrowingCurvePostfix = "_BORROW",
 	//! Postfix for flipView lending curves for fva
-	const string& flipViewLendingCurvePostfix = "_LEND");
-
-    virtual const Real calculateCvaIncrement(const string& tid, const string& cid,
-                                             const Date& d0, const Date& d1, const Real& rr) override;
-    virtual const Real calculateDvaIncrement(const string& tid,
-                                             const Date& d0, const Date& d1, const Real& rr) override;
-    virtual const Real calculateNettingSetCvaIncrement(
-        const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& rr) override;
-    virtual const Real calculateNettingSetDvaIncrement(
-        const string& nid, const Date& d0, const Date& d1, const Real& rr) override;
-    virtual const Real calculateFbaIncrement(const string& tid, const string& cid, const string& dvaName,
-                                             const Date& d0, const Date& d1, const Real& dcf) override;
-    virtual const Real calculateFcaIncrement(const string& tid, const string& cid, const string& dvaName,
-                                             const Date& d0, const Date& d1, const Real& dcf) override;
-    virtual const Real calculateNettingSetFbaIncrement(const string& nid, const string& cid, const string& dvaName,
-                                                       const Date& d0, const Date& d1, const Real& dcf) override;
-    virtual const Real calculateNettingSetFcaIncrement(const string& nid, const string& cid, const string& dvaName,
-                                                       const Date& d0, const Date& d1, const Real& dcf) override;
-    virtual const Real calculateNettingSetMvaIncrement(const string& nid, const string& cid,
-                                                       const Date& d0, const Date& d1, const Real& dcf) override;
+	const string& flipViewLendingCurvePostfix = "_LEND",
+        //! Number of threads
+        const Size nThreads = 1);
 
 protected:
+    Size samples() const override { return tradeExposureCube_->samples(); }
+    vector<Real> survivalProbabilities(const string& name) override;
+    vector<Real> initialMargin(const string& nid) override;
+
     const QuantLib::ext::shared_ptr<NPVCube>& cptyCube_;
     Size cptySpIndex_;
 };
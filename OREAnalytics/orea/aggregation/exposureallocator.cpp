@@ -21,6 +21,8 @@
 
 #include <ored/portfolio/trade.hpp>
 
+#include <qle/math/chunkworkers.hpp>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -33,34 +35,66 @@ ExposureAllocator::ExposureAllocator(
         const QuantLib::ext::shared_ptr<NPVCube>& nettedExposureCube,
         const Size allocatedTradeEpeIndex, const Size allocatedTradeEneIndex,
         const Size tradeEpeIndex, const Size tradeEneIndex,
-        const Size nettingSetEpeIndex, const Size nettingSetEneIndex)
+        const Size nettingSetEpeIndex, const Size nettingSetEneIndex, const Size nThreads)
     : portfolio_(portfolio), tradeExposureCube_(tradeExposureCube),
       nettedExposureCube_(nettedExposureCube),
       tradeEpeIndex_(tradeEpeIndex), tradeEneIndex_(tradeEneIndex),
       allocatedTradeEpeIndex_(allocatedTradeEpeIndex), allocatedTradeEneIndex_(allocatedTradeEneIndex),
-      nettingSetEpeIndex_(nettingSetEpeIndex), nettingSetEneIndex_(nettingSetEneIndex) {}
+      nettingSetEpeIndex_(nettingSetEpeIndex), nettingSetEneIndex_(nettingSetEneIndex), nThreads_(nThreads) {}
 
 void ExposureAllocator::build() {
     LOG("Compute allocated trade exposures");
 
-    for (const auto& [nettingSetId, idx] : nettedExposureCube_->idsAndIndexes()) {
-
-        for (const auto & [tid, trade] : portfolio_->trades()) {
-            string nid = trade->envelope().nettingSetId();
-            if (nid != nettingSetId)
-                continue;
-            
+    // the trades of each netting set with their cube index and allocation weights, all map lookups are done here
+    struct AllocatedTrade {
+        Size index;
+        Real epeWeight, eneWeight;
+    };
+    const auto& nettingSetIndexes = nettedExposureCube_->idsAndIndexes();
+    const auto& tradeIndexes = tradeExposureCube_->idsAndIndexes();
+    vector<Size> nettingSetIndex;
+    vector<vector<AllocatedTrade>> nettingSetTrades;
+    map<string, Size> nettingSetPosition;
+    for (const auto& [nettingSetId, idx] : nettingSetIndexes) {
+        nettingSetPosition[nettingSetId] = nettingSetIndex.size();
+        nettingSetIndex.push_back(idx);
+    }
+    nettingSetTrades.resize(nettingSetIndex.size());
+    for (const auto& [tid, trade] : portfolio_->trades()) {
+        string nid = trade->envelope().nettingSetId();
+        auto n = nettingSetPosition.find(nid);
+        if (n == nettingSetPosition.end())
+            continue;
+        auto t = tradeIndexes.find(tid);
+        QL_REQUIRE(t != tradeIndexes.end(), "ExposureAllocator: trade " << tid << " not found in exposure cube");
+        nettingSetTrades[n->second].push_back({t->second, allocatedEpeWeight(tid, nid), allocatedEneWeight(tid, nid)});
+    }
 
-            for (Date date : tradeExposureCube_->dates()) {
-                for (Size k = 0; k < tradeExposureCube_->samples(); ++k) {
-                    tradeExposureCube_->set(calculateAllocatedEpe(tid, nid, date, k),
-                                            tid, date, k, allocatedTradeEpeIndex_);
-                    tradeExposureCube_->set(calculateAllocatedEne(tid, nid, date, k),
-                                            tid, date, k, allocatedTradeEneIndex_);
+    // allocate the netted exposure slices to the trades, the netting sets are processed in parallel
+    Size numDates = tradeExposureCube_->numDates();
+    Size samples = tradeExposureCube_->samples();
+    QuantExt::ChunkWorkers workers(nThreads_);
+    workers.run(nettingSetIndex.size(), [this, &nettingSetIndex, &nettingSetTrades, numDates, samples](const Size n) {
+        if (nettingSetTrades[n].empty())
+            return;
+        vector<Real> epe(numDates * samples), ene(numDates * samples);
+        for (Size j = 0; j < numDates; ++j) {
+            for (Size k = 0; k < samples; ++k) {
+                epe[j * samples + k] = nettedExposureCube_->get(nettingSetIndex[n], j, k, nettingSetEpeIndex_);
+                ene[j * samples + k] = nettedExposureCube_->get(nettingSetIndex[n], j, k, nettingSetEneIndex_);
+            }
+        }
+        for (auto const& t : nettingSetTrades[n]) {
+            for (Size j = 0; j < numDates; ++j) {
+                for (Size k = 0; k < samples; ++k) {
+                    tradeExposureCube_->set(epe[j * samples + k] * t.epeWeight, t.index, j, k,
+                                            allocatedTradeEpeIndex_);
+                    tradeExposureCube_->set(ene[j * samples + k] * t.eneWeight, t.index, j, k,
+                                            allocatedTradeEneIndex_);
                 }
             }
         }
-    }
+    });
     LOG("Completed calculating allocated trade exposures");
 }
 
@@ -71,11 +105,11 @@ RelativeFairValueNetExposureAllocator::RelativeFairValueNetExposureAllocator(
     const QuantLib::ext::shared_ptr<NPVCube>& npvCube,
     const Size allocatedTradeEpeIndex, const Size allocatedTradeEneIndex,
     const Size tradeEpeIndex, const Size tradeEneIndex,
-    const Size nettingSetEpeIndex, const Size nettingSetEneIndex)
+    const Size nettingSetEpeIndex, const Size nettingSetEneIndex, const Size nThreads)
     : ExposureAllocator(portfolio, tradeExposureCube, nettedExposureCube,
                         allocatedTradeEpeIndex, allocatedTradeEneIndex,
                         tradeEpeIndex, tradeEneIndex,
-                        nettingSetEpeIndex, nettingSetEneIndex) {
+                        nettingSetEpeIndex, nettingSetEneIndex, nThreads) {
     size_t i = 0;
     for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt, ++i) {
         auto trade = tradeIt->second;
@@ -94,20 +128,16 @@ RelativeFairValueNetExposureAllocator::RelativeFairValueNetExposureAllocator(
     }
 }
 
-Real RelativeFairValueNetExposureAllocator::calculateAllocatedEpe(const string& tid, const string& nid,
-                                                                    const Date& date, const Size sample) {
+Real RelativeFairValueNetExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) {
     // FIXME: What to do when either the pos. or neg. netting set value is zero?
     QL_REQUIRE(nettingSetPositiveValueToday_[nid] > 0.0, "non-zero positive NPV expected");
-    Real netEPE = nettedExposureCube_->get(nid, date, sample, nettingSetEpeIndex_);
-    return netEPE * std::max(tradeValueToday_[tid], 0.0) / nettingSetPositiveValueToday_[nid];
+    return std::max(tradeValueToday_[tid], 0.0) / nettingSetPositiveValueToday_[nid];
 }
 
-Real RelativeFairValueNetExposureAllocator::calculateAllocatedEne(const string& tid, const string& nid,
-                                                                    const Date& date, const Size sample) {
+Real RelativeFairValueNetExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) {
     // FIXME: What to do when either the pos. or neg. netting set value is zero?
     QL_REQUIRE(nettingSetNegativeValueToday_[nid] > 0.0, "non-zero negative NPV expected");
-    Real netENE = nettedExposureCube_->get(nid, date, sample, nettingSetEneIndex_);
-    return netENE * -std::max(-tradeValueToday_[tid], 0.0) / nettingSetPositiveValueToday_[nid];
+    return -std::max(-tradeValueToday_[tid], 0.0) / nettingSetPositiveValueToday_[nid];
 }
 
 RelativeFairValueGrossExposureAllocator::RelativeFairValueGrossExposureAllocator(
@@ -117,11 +147,11 @@ RelativeFairValueGrossExposureAllocator::RelativeFairValueGrossExposureAllocator
     const QuantLib::ext::shared_ptr<NPVCube>& npvCube,
     const Size allocatedTradeEpeIndex, const Size allocatedTradeEneIndex,
     const Size tradeEpeIndex, const Size tradeEneIndex,
-    const Size nettingSetEpeIndex, const Size nettingSetEneIndex)
+    const Size nettingSetEpeIndex, const Size nettingSetEneIndex, const Size nThreads)
     : ExposureAllocator(portfolio, tradeExposureCube, nettedExposureCube,
                         allocatedTradeEpeIndex, allocatedTradeEneIndex,
                         tradeEpeIndex, tradeEneIndex,
-                        nettingSetEpeIndex, nettingSetEneIndex) {
+                        nettingSetEpeIndex, nettingSetEneIndex, nThreads) {
     size_t i = 0;
     for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt, ++i) {
         auto trade = tradeIt->second;
@@ -135,20 +165,16 @@ RelativeFairValueGrossExposureAllocator::RelativeFairValueGrossExposureAllocator
     }
 }
 
-Real RelativeFairValueGrossExposureAllocator::calculateAllocatedEpe(const string& tid, const string& nid,
-                                                                    const Date& date, const Size sample) {
+Real RelativeFairValueGrossExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) {
     // FIXME: What to do when the netting set value is zero?
     QL_REQUIRE(nettingSetValueToday_[nid] != 0.0, "non-zero netting set value expected");
-    Real netEPE = nettedExposureCube_->get(nid, date, sample, nettingSetEpeIndex_);
-    return netEPE * tradeValueToday_[tid] / nettingSetValueToday_[nid];
+    return tradeValueToday_[tid] / nettingSetValueToday_[nid];
 }
 
-Real RelativeFairValueGrossExposureAllocator::calculateAllocatedEne(const string& tid, const string& nid,
-                                                                    const Date& date, const Size sample) {
+Real RelativeFairValueGrossExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) {
     // FIXME: What to do when the netting set value is zero?
     QL_REQUIRE(nettingSetValueToday_[nid] != 0.0, "non-zero netting set value expected");
-    Real netENE = nettedExposureCube_->get(nid, date, sample, nettingSetEneIndex_);
-    return netENE * tradeValueToday_[tid] / nettingSetValueToday_[nid];
+    return tradeValueToday_[tid] / nettingSetValueToday_[nid];
 }
 
 RelativeXvaExposureAllocator::RelativeXvaExposureAllocator(
@@ -162,39 +188,29 @@ RelativeXvaExposureAllocator::RelativeXvaExposureAllocator(
     const map<string, Real>& nettingSetSumDva,
     const Size allocatedTradeEpeIndex, const Size allocatedTradeEneIndex,
     const Size tradeEpeIndex, const Size tradeEneIndex,
-    const Size nettingSetEpeIndex, const Size nettingSetEneIndex)
+    const Size nettingSetEpeIndex, const Size nettingSetEneIndex, const Size nThreads)
     : ExposureAllocator(portfolio, tradeExposureCube, nettedExposureCube,
                         allocatedTradeEpeIndex, allocatedTradeEneIndex,
                         tradeEpeIndex, tradeEneIndex,
-                        nettingSetEpeIndex, nettingSetEneIndex),
+                        nettingSetEpeIndex, nettingSetEneIndex, nThreads),
       tradeCva_(tradeCva), tradeDva_(tradeDva),
       nettingSetSumCva_(nettingSetSumCva), nettingSetSumDva_(nettingSetSumDva) {}
 
-Real RelativeXvaExposureAllocator::calculateAllocatedEpe(const string& tid, const string& nid,
-                                                         const Date& date, const Size sample) {
-    Real netEPE = nettedExposureCube_->get(nid, date, sample, nettingSetEpeIndex_);
-    return netEPE * tradeCva_[tid] / nettingSetSumCva_[nid];
+Real RelativeXvaExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) {
+    return tradeCva_[tid] / nettingSetSumCva_[nid];
 }
-Real RelativeXvaExposureAllocator::calculateAllocatedEne(const string& tid, const string& nid,
-                                                         const Date& date, const Size sample) {
-    Real netENE = nettedExposureCube_->get(nid, date, sample, nettingSetEneIndex_);
-    return netENE * tradeDva_[tid] / nettingSetSumDva_[nid];
+Real RelativeXvaExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) {
+    return tradeDva_[tid] / nettingSetSumDva_[nid];
 }
 
 NoneExposureAllocator::NoneExposureAllocator(
     const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
     const QuantLib::ext::shared_ptr<NPVCube>& tradeExposureCube,
-    const QuantLib::ext::shared_ptr<NPVCube>& nettedExposureCube)
-    : ExposureAllocator(portfolio, tradeExposureCube, nettedExposureCube) {}
+    const QuantLib::ext::shared_ptr<NPVCube>& nettedExposureCube, const Size nThreads)
+    : ExposureAllocator(portfolio, tradeExposureCube, nettedExposureCube, 2, 3, 0, 1, 1, 2, nThreads) {}
 
-Real NoneExposureAllocator::calculateAllocatedEpe(const string& tid, const string& nid,
-                                                  const Date& date, const Size sample) {
-    return 0;
-}
-Real NoneExposureAllocator::calculateAllocatedEne(const string& tid, const string& nid,
-                                                  const Date& date, const Size sample) {
-    return 0;
-}
+Real NoneExposureAllocator::allocatedEpeWeight(const string& tid, const string& nid) { return 0; }
+Real NoneExposureAllocator::allocatedEneWeight(const string& tid, const string& nid) { return 0; }
 
 ExposureAllocator::AllocationMethod parseAllocationMethod(const string& s) {
     static map<string, ExposureAllocator::AllocationMethod> m = {
@@ -36,8 +36,9 @@ using namespace std;
 //! Exposure allocator base class
 /*!
   Derived classes implement a constructor with the relevant additional input data
-  and a build function that performs the XVA calculations for all netting sets and
-  along all paths.
+  and the weights of the trades in their netting sets. The build function allocates
+  the netted exposures of all netting sets along all paths, the netting sets are
+  processed in parallel.
 */
 class ExposureAllocator {
 public:
@@ -56,7 +57,8 @@ public:
         const QuantLib::ext::shared_ptr<NPVCube>& nettedExposureCube,
         const Size allocatedTradeEpeIndex = 2, const Size allocatedTradeEneIndex = 3,
         const Size tradeEpeIndex = 0, const Size tradeEneIndex = 1,
-        const Size nettingSetEpeIndex = 1, const Size nettingSetEneIndex = 2);
+        const Size nettingSetEpeIndex = 1, const Size nettingSetEneIndex = 2,
+        const Size nThreads = 1);
 
     virtual ~ExposureAllocator() {}
     const QuantLib::ext::shared_ptr<NPVCube>& exposureCube() { return tradeExposureCube_; }
@@ -65,8 +67,10 @@ public:
 
 
 protected:
-    virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) = 0;
-    virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) = 0;
+    /*! Weight of the trade's allocated EPE (ENE) in the netted EPE (ENE) of its netting set, the allocated exposure
+        is the netted exposure times this weight on all dates and samples */
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) = 0;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) = 0;
     QuantLib::ext::shared_ptr<Portfolio> portfolio_;
     QuantLib::ext::shared_ptr<NPVCube> tradeExposureCube_;
     QuantLib::ext::shared_ptr<NPVCube> nettedExposureCube_;
@@ -76,6 +80,7 @@ protected:
     Size allocatedTradeEneIndex_;
     Size nettingSetEpeIndex_;
     Size nettingSetEneIndex_;
+    Size nThreads_;
     map<string, Real> nettingSetValueToday_, nettingSetPositiveValueToday_, nettingSetNegativeValueToday_;
 };
 
@@ -88,11 +93,12 @@ public:
         const QuantLib::ext::shared_ptr<NPVCube>& npvCube,
         const Size allocatedTradeEpeIndex = 2, const Size allocatedTradeEneIndex = 3,
         const Size tradeEpeIndex = 0, const Size tradeEneIndex = 1,
-        const Size nettingSetEpeIndex = 1, const Size nettingSetEneIndex = 2);
+        const Size nettingSetEpeIndex = 1, const Size nettingSetEneIndex = 2,
+        const Size nThreads = 1);
 
 protected:
-    virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
-    virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
     map<string, Real> tradeValueToday_;
     map<string, Real> nettingSetPositiveValueToday_;
     map<string, Real> nettingSetNegativeValueToday_;
@@ -107,11 +113,12 @@ public:
         const QuantLib::ext::shared_ptr<NPVCube>& npvCube,
         const Size allocatedTradeEpeIndex = 2, const Size allocatedTradeEneIndex = 3,
         const Size tradeEpeIndex = 0, const Size tradeEneIndex = 1,
-        const Size nettingSetEpeIndex = 1, const Size nettingSetEneIndex = 2);
+        const Size nettingSetEpeIndex = 1, const Size nettingSetEneIndex = 2,
+        const Size nThreads = 1);
 
 protected:
-    virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
-    virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
     map<string, Real> tradeValueToday_;
     map<string, Real> nettingSetValueToday_;
 };
@@ -129,11 +136,12 @@ public:
         const map<string, Real>& nettingSetSumDva,
         const Size allocatedTradeEpeIndex = 2, const Size allocatedTradeEneIndex = 3,
         const Size tradeEpeIndex = 0, const Size tradeEneIndex = 1,
-        const Size nettingSetEpeIndex = 0, const Size nettingSetEneIndex = 1);
+        const Size nettingSetEpeIndex = 0, const Size nettingSetEneIndex = 1,
+        const Size nThreads = 1);
 
 protected:
-    virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
-    virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
     map<string, Real> tradeCva_;
     map<string, Real> tradeDva_;
     map<string, Real> nettingSetSumCva_;
@@ -146,11 +154,12 @@ public:
     NoneExposureAllocator(
         const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
         const QuantLib::ext::shared_ptr<NPVCube>& tradeExposureCube,
-        const QuantLib::ext::shared_ptr<NPVCube>& nettedExposureCube);
+        const QuantLib::ext::shared_ptr<NPVCube>& nettedExposureCube,
+        const Size nThreads = 1);
 
 protected:
-    virtual Real calculateAllocatedEpe(const string& tid, const string& nid, const Date& date, const Size sample) override;
-    virtual Real calculateAllocatedEne(const string& tid, const string& nid, const Date& date, const Size sample) override;
+    virtual Real allocatedEpeWeight(const string& tid, const string& nid) override;
+    virtual Real allocatedEneWeight(const string& tid, const string& nid) override;
 };
 
 //! Convert text representation to ExposureAllocator::AllocationMethod
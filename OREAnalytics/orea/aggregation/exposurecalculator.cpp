@@ -21,9 +21,15 @@
 
 #include <ored/portfolio/trade.hpp>
 
+#include <qle/math/chunkworkers.hpp>
+#include <qle/math/tdigest.hpp>
+
 #include <ql/time/date.hpp>
+#include <ql/settings.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
 
+#include <optional>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -36,15 +42,17 @@ ExposureCalculator::ExposureCalculator(
     const QuantLib::ext::shared_ptr<Market>& market,
     bool exerciseNextBreak, const string& baseCurrency, const string& configuration,
     const Real quantile, const CollateralExposureHelper::CalculationType calcType, const bool multiPath,
-    const bool flipViewXVA)
+    const bool flipViewXVA, const Size nThreads, const Real pfeCompression)
     : portfolio_(portfolio), cube_(cube), cubeInterpretation_(cubeInterpretation),
        market_(market), exerciseNextBreak_(exerciseNextBreak),
       baseCurrency_(baseCurrency), configuration_(configuration),
       quantile_(quantile), calcType_(calcType),
       multiPath_(multiPath), dates_(cube->dates()),
-      today_(market_->asofDate()), dc_(ActualActual(ActualActual::ISDA)), flipViewXVA_(flipViewXVA) {
+      today_(market_->asofDate()), dc_(ActualActual(ActualActual::ISDA)), flipViewXVA_(flipViewXVA),
+      nThreads_(nThreads), pfeCompression_(pfeCompression) {
 
     QL_REQUIRE(portfolio_, "portfolio is null");
+    QL_REQUIRE(nThreads_ > 0, "ExposureCalculator: nThreads must be positive");
 
     if (multiPath) {
         exposureCube_ = QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(
@@ -70,149 +78,205 @@ ExposureCalculator::ExposureCalculator(
 
 void ExposureCalculator::build() {
     LOG("Compute trade exposure profiles, " << (flipViewXVA_ ? "inverted (flipViewXVA = Y)" : "regular (flipViewXVA = N)"));
-    size_t i = 0;
-    for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt, ++i) {
-        auto trade = tradeIt->second;
-        string tradeId = tradeIt->first;
-        string nettingSetId = trade->envelope().nettingSetId();
-        LOG("Aggregate exposure for trade " << tradeId);
+
+    // Group the trades by netting set. Each netting set is processed by a single task which accumulates the netting
+    // set values over its trades in portfolio order, so that the results do not depend on the number of threads.
+    // The trade index coincides with the index in the cube and the exposure cube.
+
+    vector<std::pair<string, QuantLib::ext::shared_ptr<Trade>>> trades(portfolio_->trades().begin(),
+                                                                        portfolio_->trades().end());
+    map<string, Size> nettingSetIndex;
+    for (Size n = 0; n < nettingSetIds_.size(); ++n)
+        nettingSetIndex[nettingSetIds_[n]] = n;
+    vector<vector<Size>> nettingSetTrades(nettingSetIds_.size());
+    for (Size i = 0; i < trades.size(); ++i)
+        nettingSetTrades[nettingSetIndex.at(trades[i].second->envelope().nettingSetId())].push_back(i);
+
+    // The result containers are set up before the parallel processing, the tasks only write to existing elements
+
+    for (const auto& nettingSetId : nettingSetIds_) {
         if (nettingSetDefaultValue_.find(nettingSetId) == nettingSetDefaultValue_.end()) {
             nettingSetDefaultValue_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
             nettingSetCloseOutValue_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
             nettingSetMporPositiveFlow_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
             nettingSetMporNegativeFlow_[nettingSetId] = vector<vector<Real>>(dates_.size(), vector<Real>(cube_->samples(), 0.0));
         }
+    }
+    for (const auto& [tradeId, _] : trades) {
+        ee_b_[tradeId];
+        eee_b_[tradeId];
+        pfe_[tradeId];
+        epe_b_[tradeId];
+        eepe_b_[tradeId];
+    }
 
-        // Identify the next break date if provided, default is trade maturity.
-        Date nextBreakDate = trade->maturity();
-        TradeActions ta = trade->tradeActions();
-        if (exerciseNextBreak_ && !ta.empty()) {
-            // loop over actions and pick next mutual break, if available
-            vector<TradeAction> actions = ta.actions();
-            for (Size j = 0; j < actions.size(); ++j) {
-                DLOG("TradeAction for " << tradeId << ", actionType " << actions[j].type() << ", actionOwner "
-                                        << actions[j].owner());
-                // FIXME: Introduce enumeration and parse text when building trade
-                if (actions[j].type() == "Break" && actions[j].owner() == "Mutual") {
-                    QuantLib::Schedule schedule = ore::data::makeSchedule(actions[j].schedule());
-                    vector<Date> dates = schedule.dates();
-                    std::sort(dates.begin(), dates.end());
-                    Date today = Settings::instance().evaluationDate();
-                    for (Size k = 0; k < dates.size(); ++k) {
-                        if (dates[k] > today && dates[k] < nextBreakDate) {
-                            nextBreakDate = dates[k];
-                            DLOG("Next break date for trade " << tradeId << ": "
-                                                              << QuantLib::io::iso_date(nextBreakDate));
-                            break;
+    // The market is not accessed from the worker threads, the discount factors are retrieved upfront
+
+    vector<Real> discounts(dates_.size(), 1.0);
+    if (!trades.empty()) {
+        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
+        for (Size j = 0; j < dates_.size(); ++j)
+            discounts[j] = curve->discount(cube_->dates()[j]);
+    }
+
+    Date evaluationDate = Settings::instance().evaluationDate();
+    QuantExt::ChunkWorkers workers(nThreads_);
+
+    workers.run(nettingSetIds_.size(), [this, &trades, &nettingSetTrades, &discounts, &evaluationDate](const Size n) {
+        if (Settings::instance().evaluationDate() != evaluationDate)
+            Settings::instance().evaluationDate() = evaluationDate;
+        const string& nettingSetId = nettingSetIds_[n];
+        vector<vector<Real>>& nettingSetDefaultValue = nettingSetDefaultValue_.at(nettingSetId);
+        vector<vector<Real>>& nettingSetCloseOutValue = nettingSetCloseOutValue_.at(nettingSetId);
+        vector<vector<Real>>& nettingSetMporPositiveFlow = nettingSetMporPositiveFlow_.at(nettingSetId);
+        vector<vector<Real>>& nettingSetMporNegativeFlow = nettingSetMporNegativeFlow_.at(nettingSetId);
+        for (Size i : nettingSetTrades[n]) {
+            const string& tradeId = trades[i].first;
+            const auto& trade = trades[i].second;
+            LOG("Aggregate exposure for trade " << tradeId);
+
+            // Identify the next break date if provided, default is trade maturity.
+            Date nextBreakDate = trade->maturity();
+            TradeActions ta = trade->tradeActions();
+            if (exerciseNextBreak_ && !ta.empty()) {
+                // loop over actions and pick next mutual break, if available
+                vector<TradeAction> actions = ta.actions();
+                for (Size j = 0; j < actions.size(); ++j) {
+                    DLOG("TradeAction for " << tradeId << ", actionType " << actions[j].type() << ", actionOwner "
+                                            << actions[j].owner());
+                    // FIXME: Introduce enumeration and parse text when building trade
+                    if (actions[j].type() == "Break" && actions[j].owner() == "Mutual") {
+                        QuantLib::Schedule schedule = ore::data::makeSchedule(actions[j].schedule());
+                        vector<Date> dates = schedule.dates();
+                        std::sort(dates.begin(), dates.end());
+                        Date today = Settings::instance().evaluationDate();
+                        for (Size k = 0; k < dates.size(); ++k) {
+                            if (dates[k] > today && dates[k] < nextBreakDate) {
+                                nextBreakDate = dates[k];
+                                DLOG("Next break date for trade " << tradeId << ": "
+                                                                  << QuantLib::io::iso_date(nextBreakDate));
+                                break;
+                            }
                         }
                     }
                 }
             }
-        }
 
-        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
-        Real npv0;
-        if (flipViewXVA_) {
-            npv0 = -cube_->getT0(i);
-        } else {
-            npv0 = cube_->getT0(i);
-        }
-        vector<Real> epe(dates_.size() + 1, 0.0);
-        vector<Real> ene(dates_.size() + 1, 0.0);
-        vector<Real> ee_b(dates_.size() + 1, 0.0);
-        vector<Real> eee_b(dates_.size() + 1, 0.0);
-        vector<Real> pfe(dates_.size() + 1, 0.0);
-        epe[0] = std::max(npv0, 0.0);
-        ene[0] = std::max(-npv0, 0.0);
-        ee_b[0] = epe[0];
-        eee_b[0] = ee_b[0];
-        pfe[0] = std::max(npv0, 0.0);
-        exposureCube_->setT0(epe[0], tradeId, ExposureIndex::EPE);
-        exposureCube_->setT0(ene[0], tradeId, ExposureIndex::ENE);
-        for (Size j = 0; j < dates_.size(); ++j) {
-            Date d = cube_->dates()[j];
-            vector<Real> distribution(cube_->samples(), 0.0);
-            for (Size k = 0; k < cube_->samples(); ++k) {
-                // RL 2020-07-17
-                // 1) If the calculation type is set to NoLag:
-                //    Collateral balances are NOT delayed by the MPoR, but we use the close-out NPV.
-                // 2) Otherwise:
-                //    Collateral balances are delayed by the MPoR (if possible, i.e. the valuation
-                //    grid has MPoR spacing), and we use the default date NPV.
-                //    This is the treatment in the ORE releases up to June 2020).
-                Real defaultValue =
-                    d > nextBreakDate && exerciseNextBreak_ ? 0.0 : cubeInterpretation_->getDefaultNpv(cube_, i, j, k);
-                Real closeOutValue;
-                if (isRegularCubeStorage_ && j == dates_.size() - 1)
-                    closeOutValue = defaultValue;
-                else
-                    closeOutValue = d > nextBreakDate && exerciseNextBreak_
-                                        ? 0.0
-                                        : cubeInterpretation_->getCloseOutNpv(cube_, i, j, k);
-
-                Real positiveCashFlow = cubeInterpretation_->getMporPositiveFlows(cube_, i, j, k);
-                Real negativeCashFlow = cubeInterpretation_->getMporNegativeFlows(cube_, i, j, k);
-                //for single trade exposures, always default value is relevant
-                Real npv = defaultValue;
-                epe[j + 1] += max(npv, 0.0) / cube_->samples();
-                ene[j + 1] += max(-npv, 0.0) / cube_->samples();
-                nettingSetDefaultValue_[nettingSetId][j][k] += defaultValue;
-                nettingSetCloseOutValue_[nettingSetId][j][k] += closeOutValue;
-                nettingSetMporPositiveFlow_[nettingSetId][j][k] += positiveCashFlow;
-                nettingSetMporNegativeFlow_[nettingSetId][j][k] += negativeCashFlow;
-                distribution[k] = npv;
-                if (multiPath_) {
-                    exposureCube_->set(max(npv, 0.0), tradeId, d, k, ExposureIndex::EPE);
-                    exposureCube_->set(max(-npv, 0.0), tradeId, d, k, ExposureIndex::ENE);
-                }
+            Real npv0;
+            if (flipViewXVA_) {
+                npv0 = -cube_->getT0(i);
+            } else {
+                npv0 = cube_->getT0(i);
             }
-            if (!multiPath_) {
-                exposureCube_->set(epe[j + 1], tradeId, d, 0, ExposureIndex::EPE);
-                exposureCube_->set(ene[j + 1], tradeId, d, 0, ExposureIndex::ENE);
+            vector<Real> epe(dates_.size() + 1, 0.0);
+            vector<Real> ene(dates_.size() + 1, 0.0);
+            vector<Real> ee_b(dates_.size() + 1, 0.0);
+            vector<Real> eee_b(dates_.size() + 1, 0.0);
+            vector<Real> pfe(dates_.size() + 1, 0.0);
+            epe[0] = std::max(npv0, 0.0);
+            ene[0] = std::max(-npv0, 0.0);
+            ee_b[0] = epe[0];
+            eee_b[0] = ee_b[0];
+            pfe[0] = std::max(npv0, 0.0);
+            exposureCube_->setT0(epe[0], i, ExposureIndex::EPE);
+            exposureCube_->setT0(ene[0], i, ExposureIndex::ENE);
+            for (Size j = 0; j < dates_.size(); ++j) {
+                Date d = cube_->dates()[j];
+                // the PFE is either read from the sorted samples or estimated from a t-digest
+                std::optional<QuantExt::TDigest> pfeDigest;
+                if (pfeCompression_ != Null<Real>())
+                    pfeDigest.emplace(pfeCompression_);
+                vector<Real> distribution(pfeDigest ? 0 : cube_->samples(), 0.0);
+                for (Size k = 0; k < cube_->samples(); ++k) {
+                    // RL 2020-07-17
+                    // 1) If the calculation type is set to NoLag:
+                    //    Collateral balances are NOT delayed by the MPoR, but we use the close-out NPV.
+                    // 2) Otherwise:
+                    //    Collateral balances are delayed by the MPoR (if possible, i.e. the valuation
+                    //    grid has MPoR spacing), and we use the default date NPV.
+                    //    This is the treatment in the ORE releases up to June 2020).
+                    Real defaultValue = d > nextBreakDate && exerciseNextBreak_
+                                            ? 0.0
+                                            : cubeInterpretation_->getDefaultNpv(cube_, i, j, k);
+                    Real closeOutValue;
+                    if (isRegularCubeStorage_ && j == dates_.size() - 1)
+                        closeOutValue = defaultValue;
+                    else
+                        closeOutValue = d > nextBreakDate && exerciseNextBreak_
+                                            ? 0.0
+                                            : cubeInterpretation_->getCloseOutNpv(cube_, i, j, k);
+
+                    Real positiveCashFlow = cubeInterpretation_->getMporPositiveFlows(cube_, i, j, k);
+                    Real negativeCashFlow = cubeInterpretation_->getMporNegativeFlows(cube_, i, j, k);
+                    //for single trade exposures, always default value is relevant
+                    Real npv = defaultValue;
+                    epe[j + 1] += max(npv, 0.0) / cube_->samples();
+                    ene[j + 1] += max(-npv, 0.0) / cube_->samples();
+                    nettingSetDefaultValue[j][k] += defaultValue;
+                    nettingSetCloseOutValue[j][k] += closeOutValue;
+                    nettingSetMporPositiveFlow[j][k] += positiveCashFlow;
+                    nettingSetMporNegativeFlow[j][k] += negativeCashFlow;
+                    if (pfeDigest)
+                        pfeDigest->add(npv);
+                    else
+                        distribution[k] = npv;
+                    if (multiPath_) {
+                        exposureCube_->set(max(npv, 0.0), i, j, k, ExposureIndex::EPE);
+                        exposureCube_->set(max(-npv, 0.0), i, j, k, ExposureIndex::ENE);
+                    }
+                }
+                if (!multiPath_) {
+                    exposureCube_->set(epe[j + 1], i, j, 0, ExposureIndex::EPE);
+                    exposureCube_->set(ene[j + 1], i, j, 0, ExposureIndex::ENE);
+                }
+                ee_b[j + 1] = epe[j + 1] / discounts[j];
+                eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
+                if (pfeDigest) {
+                    pfe[j + 1] = std::max(pfeDigest->quantile(quantile_), 0.0);
+                } else {
+                    std::sort(distribution.begin(), distribution.end());
+                    Size index = Size(floor(quantile_ * (cube_->samples() - 1) + 0.5));
+                    pfe[j + 1] = std::max(distribution[index], 0.0);
+                }
             }
-            ee_b[j + 1] = epe[j + 1] / curve->discount(cube_->dates()[j]);
-            eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
-            std::sort(distribution.begin(), distribution.end());
-            Size index = Size(floor(quantile_ * (cube_->samples() - 1) + 0.5));
-            pfe[j + 1] = std::max(distribution[index], 0.0);
-        }
-        ee_b_[tradeId] = ee_b;
-        eee_b_[tradeId] = eee_b;
-        pfe_[tradeId] = pfe;
-
-        Real epe_b = 0.0;
-        Real eepe_b = 0.0;
-
-        Size t = 0;
-        Calendar cal = WeekendsOnly();
-        /*The time average in the EEPE calculation is taken over the first year of the exposure evolution
-        (or until maturity if all positions of the netting set mature before one year).
-        This one year point is actually taken to be today+1Y+4D, so that the 1Y point on the dateGrid is always
-        included.
-        This may effect DateGrids with daily data points*/
-        Date maturity = std::min(cal.adjust(today_ + 1 * Years + 4 * Days), trade->maturity());
-        QuantLib::Real maturityTime = dc_.yearFraction(today_, maturity);
-
-        while (t < dates_.size() && times_[t] <= maturityTime)
-            ++t;
-
-        if (t > 0) {
-            vector<double> weights(t);
-            weights[0] = times_[0];
-            for (Size k = 1; k < t; k++)
-                weights[k] = times_[k] - times_[k - 1];
-            double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
-            for (Size k = 0; k < t; k++)
-                weights[k] /= totalWeights;
-
-            for (Size k = 0; k < t; k++) {
-                epe_b += ee_b[k] * weights[k];
-                eepe_b += eee_b[k] * weights[k];
+            ee_b_.at(tradeId) = ee_b;
+            eee_b_.at(tradeId) = eee_b;
+            pfe_.at(tradeId) = pfe;
+
+            Real epe_b = 0.0;
+            Real eepe_b = 0.0;
+
+            Size t = 0;
+            Calendar cal = WeekendsOnly();
+            /*The time average in the EEPE calculation is taken over the first year of the exposure evolution
+            (or until maturity if all positions of the netting set mature before one year).
+            This one year point is actually taken to be today+1Y+4D, so that the 1Y point on the dateGrid is always
+            included.
+            This may effect DateGrids with daily data points*/
+            Date maturity = std::min(cal.adjust(today_ + 1 * Years + 4 * Days), trade->maturity());
+            QuantLib::Real maturityTime = dc_.yearFraction(today_, maturity);
+
+            while (t < dates_.size() && times_[t] <= maturityTime)
+                ++t;
+
+            if (t > 0) {
+                vector<double> weights(t);
+                weights[0] = times_[0];
+                for (Size k = 1; k < t; k++)
+                    weights[k] = times_[k] - times_[k - 1];
+                double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+                for (Size k = 0; k < t; k++)
+                    weights[k] /= totalWeights;
+
+                for (Size k = 0; k < t; k++) {
+                    epe_b += ee_b[k] * weights[k];
+                    eepe_b += eee_b[k] * weights[k];
+                }
             }
+            epe_b_.at(tradeId) = epe_b;
+            eepe_b_.at(tradeId) = eepe_b;
         }
-        epe_b_[tradeId] = epe_b;
-        eepe_b_[tradeId] = eepe_b;
-    }
+    });
 }
 
 vector<Real> ExposureCalculator::getMeanExposure(const string& tid, ExposureIndex index) {
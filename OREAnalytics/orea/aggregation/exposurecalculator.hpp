@@ -67,7 +67,11 @@ public:
 	    //! Flag to indicate exposure evaluation with dynamic credit
         const bool multiPath,
         //! Flag to indicate flipped xva calculation
-        const bool flipViewXVA
+        const bool flipViewXVA,
+        //! Number of threads used to process the netting sets in parallel
+        const Size nThreads = 1,
+        //! If given, the PFE is estimated by a t-digest with this compression instead of sorting the samples
+        const Real pfeCompression = Null<Real>()
     );
 
     virtual ~ExposureCalculator() {}
@@ -94,6 +98,7 @@ public:
     CollateralExposureHelper::CalculationType calcType() { return calcType_; }
     bool isRegularCubeStorage() { return isRegularCubeStorage_; }
     bool multiPath() { return multiPath_; }
+    Size nThreads() { return nThreads_; }
 
     vector<Date> dates() { return dates_; }
     Date today() { return today_; }
@@ -151,6 +156,8 @@ protected:
     map<string, Real> eepe_b_;
     vector<Real> getMeanExposure(const string& tid, ExposureIndex index);
     bool flipViewXVA_;
+    Size nThreads_;
+    Real pfeCompression_;
 };
 
 } // namespace analytics
@@ -20,9 +20,15 @@
 
 #include <ored/portfolio/trade.hpp>
 
+#include <qle/math/chunkworkers.hpp>
+#include <qle/math/tdigest.hpp>
+
+#include <ql/settings.hpp>
 #include <ql/time/date.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
 
+#include <optional>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -44,7 +50,8 @@ NettedExposureCalculator::NettedExposureCalculator(
     const QuantLib::ext::shared_ptr<DynamicInitialMarginCalculator>& dimCalculator, const bool fullInitialCollateralisation,
     const bool marginalAllocation, const Real marginalAllocationLimit,
     const QuantLib::ext::shared_ptr<NPVCube>& tradeExposureCube, const Size allocatedEpeIndex, const Size allocatedEneIndex,
-    const bool flipViewXVA, const bool withMporStickyDate, const MporCashFlowMode mporCashFlowMode)
+    const bool flipViewXVA, const bool withMporStickyDate, const MporCashFlowMode mporCashFlowMode,
+    const Size nThreads, const Real pfeCompression)
     : portfolio_(portfolio), market_(market), cube_(cube), baseCurrency_(baseCurrency), configuration_(configuration),
       quantile_(quantile), calcType_(calcType), multiPath_(multiPath), nettingSetManager_(nettingSetManager),
       collateralBalances_(collateralBalances),
@@ -55,7 +62,9 @@ NettedExposureCalculator::NettedExposureCalculator(
       marginalAllocation_(marginalAllocation), marginalAllocationLimit_(marginalAllocationLimit),
       tradeExposureCube_(tradeExposureCube), allocatedEpeIndex_(allocatedEpeIndex),
       allocatedEneIndex_(allocatedEneIndex), flipViewXVA_(flipViewXVA), withMporStickyDate_(withMporStickyDate),
-      mporCashFlowMode_(mporCashFlowMode) {
+      mporCashFlowMode_(mporCashFlowMode), nThreads_(nThreads), pfeCompression_(pfeCompression) {
+
+    QL_REQUIRE(nThreads_ > 0, "NettedExposureCalculator: nThreads must be positive");
 
     set<string> nettingSetIds;
     for (auto nettingSet : nettingSetDefaultValue) {
@@ -94,6 +103,7 @@ void NettedExposureCalculator::build() {
     map<string, Real> nettingSetValueToday;
     map<string, Date> nettingSetMaturity;
     map<string, Size> nettingSetSize;
+    map<string, vector<Size>> nettingSetTrades;
     Size cubeIndex = 0;
     for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end(); ++tradeIt, ++cubeIndex) {
         const auto& trade = tradeIt->second;
@@ -123,16 +133,43 @@ void NettedExposureCalculator::build() {
         if (trade->maturity() > nettingSetMaturity[nettingSetId])
             nettingSetMaturity[nettingSetId] = trade->maturity();
         nettingSetSize[nettingSetId]++;
+        nettingSetTrades[nettingSetId].push_back(cubeIndex);
     }
 
     vector<vector<Real>> averagePositiveAllocation(portfolio_->size(), vector<Real>(cube_->dates().size(), 0.0));
     vector<vector<Real>> averageNegativeAllocation(portfolio_->size(), vector<Real>(cube_->dates().size(), 0.0));
 
-    Size nettingSetCount = 0;
-    for (auto n : nettingSetDefaultValue_) {
-        string nettingSetId = n.first;
-        vector<vector<Real>> data = n.second;
+    // The market data is retrieved before the netting sets are processed in parallel. The tasks only read the market
+    // data retrieved here, the cubes and the scenario data, and write to their own netting set index in the netted
+    // and exposure cubes, to the trades of their netting set in the trade exposure cube and to the result map entries
+    // set up below.
+
+    vector<Real> discounts(cube_->dates().size(), 1.0);
+    if (!nettingSetDefaultValue_.empty()) {
+        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
+        for (Size j = 0; j < cube_->dates().size(); ++j)
+            discounts[j] = curve->discount(cube_->dates()[j]);
+    }
+
+    struct NettingSetData {
+        string nettingSetId;
+        QuantLib::ext::shared_ptr<NettingSetDefinition> netting;
+        string csaIndexName;
+        DayCounter csaDayCounter = ActualActual(ActualActual::ISDA);
+        bool applyInitialMargin = false;
+        CSA::Type initialMarginType = CSA::Bilateral;
+        Real initialVMbase = 0.0, initialIMbase = 0.0;
+        Real csaFxRateToday = 1.0, csaRateToday = 0.0;
+        const vector<vector<Real>>* dynamicIM = nullptr;
+    };
+    vector<NettingSetData> nettingSets;
+
+    for (const auto& n : nettingSetDefaultValue_) {
+        NettingSetData ns;
+        ns.nettingSetId = n.first;
+        const string& nettingSetId = ns.nettingSetId;
         QuantLib::ext::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetId);
+        ns.netting = netting;
 
         // retrieve collateral balances object, if possible
         QuantLib::ext::shared_ptr<CollateralBalance> balance = nullptr;
@@ -140,73 +177,101 @@ void NettedExposureCalculator::build() {
             balance = collateralBalances_->get(nettingSetId);
             DLOG("got collateral balances for netting set " << nettingSetId);
         }
-        
-        //only for active CSA and calcType == NoLag close-out value is relevant
-        if (netting->activeCsaFlag() && calcType_ == CollateralExposureHelper::CalculationType::NoLag) 
-            data = nettingSetCloseOutValue_[nettingSetId];
-        
-        vector<vector<Real>> nettingSetMporPositiveFlow = nettingSetMporPositiveFlow_[nettingSetId];
-        vector<vector<Real>> nettingSetMporNegativeFlow = nettingSetMporNegativeFlow_[nettingSetId];
-
-        LOG("Aggregate exposure for netting set " << nettingSetId);
-        // Get the collateral account balance paths for the netting set.
-        // The pointer may remain empty if there is no CSA or if it is inactive.
-        QuantLib::ext::shared_ptr<vector<QuantLib::ext::shared_ptr<CollateralAccount>>> collateral =
-            collateralPaths(nettingSetId,
-                            nettingSetValueToday[nettingSetId],
-                            nettingSetDefaultValue_[nettingSetId],
-                            nettingSetMaturity[nettingSetId]);
 
 	// Get the CSA index for Eonia Floor calculation below
-        colva_[nettingSetId] = 0.0;
-        collateralFloor_[nettingSetId] = 0.0;
-        string csaIndexName;
-        Handle<IborIndex> csaIndex;
-        bool applyInitialMargin = false;
-        CSA::Type initialMarginType = CSA::Bilateral;
         if (netting->activeCsaFlag()) {
-            csaIndexName = netting->csaDetails()->index();
-            if (csaIndexName != "") {
-                csaIndex = market_->iborIndex(csaIndexName);
-                QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
-                           "scenario data does not provide index values for " << csaIndexName);
+            ns.csaIndexName = netting->csaDetails()->index();
+            if (ns.csaIndexName != "") {
+                ns.csaDayCounter = market_->iborIndex(ns.csaIndexName)->dayCounter();
+                QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::IndexFixing, ns.csaIndexName),
+                           "scenario data does not provide index values for " << ns.csaIndexName);
             }
             QL_REQUIRE(netting->csaDetails(), "active CSA for netting set " << nettingSetId
                     << ", but CSA details not initialised");
-            applyInitialMargin = netting->csaDetails()->applyInitialMargin() && applyInitialMargin_;
-            initialMarginType = netting->csaDetails()->initialMarginType();
-            LOG("ApplyInitialMargin=" << applyInitialMargin << " for netting set " << nettingSetId 
+            ns.applyInitialMargin = netting->csaDetails()->applyInitialMargin() && applyInitialMargin_;
+            ns.initialMarginType = netting->csaDetails()->initialMarginType();
+            LOG("ApplyInitialMargin=" << ns.applyInitialMargin << " for netting set " << nettingSetId
                 << ", CSA IM=" << netting->csaDetails()->applyInitialMargin()
-                << ", CSA IM Type=" << initialMarginType
+                << ", CSA IM Type=" << ns.initialMarginType
                 << ", Analytics DIM=" << applyInitialMargin_);
             if (applyInitialMargin_ && !netting->csaDetails()->applyInitialMargin())
                 ALOG("ApplyInitialMargin deactivated at netting set level " << nettingSetId);
             if (!applyInitialMargin_ && netting->csaDetails()->applyInitialMargin())
                 ALOG("ApplyInitialMargin deactivated in analytics, but active at netting set level " << nettingSetId);
+            if (ns.applyInitialMargin)
+                ns.dynamicIM = &dimCalculator_->dynamicIM(nettingSetId);
+            std::pair<Real, Real> rates = csaRatesToday(nettingSetId);
+            ns.csaFxRateToday = rates.first;
+            ns.csaRateToday = rates.second;
         }
 
         // Retrieve the constant independent amount from the CSA data and the VM balance
         // This is used below to reduce the exposure across all paths and time steps.
         // See below for the conversion to base currency.
-        Real initialVM = 0, initialVMbase = 0;
-        Real initialIM = 0, initialIMbase = 0;
-        string csaCurrency = "";
         if (netting->activeCsaFlag() && balance) {
-            initialVM = balance->variationMargin();
-            initialIM = balance->initialMargin();
+            Real initialVM = balance->variationMargin();
+            Real initialIM = balance->initialMargin();
             double fx = 1.0;
             if (baseCurrency_ != balance->currency())
                 fx = market_->fxSpot(balance->currency() + baseCurrency_)->value();
-            initialVMbase = fx * initialVM;
-            initialIMbase = fx * initialIM;
-            DLOG("Netting set " << nettingSetId << ", initial VM: " << initialVMbase << " " << baseCurrency_);
-            DLOG("Netting set " << nettingSetId << ", initial IM: " << initialIMbase << " " << baseCurrency_);
+            ns.initialVMbase = fx * initialVM;
+            ns.initialIMbase = fx * initialIM;
+            DLOG("Netting set " << nettingSetId << ", initial VM: " << ns.initialVMbase << " " << baseCurrency_);
+            DLOG("Netting set " << nettingSetId << ", initial IM: " << ns.initialIMbase << " " << baseCurrency_);
         }
         else {
             DLOG("Netting set " << nettingSetId << ", IA base = VM base = 0");
         }
-        
-        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
+
+        colva_[nettingSetId] = 0.0;
+        collateralFloor_[nettingSetId] = 0.0;
+        ee_b_[nettingSetId];
+        eee_b_[nettingSetId];
+        pfe_[nettingSetId];
+        expectedCollateral_[nettingSetId];
+        colvaInc_[nettingSetId];
+        eoniaFloorInc_[nettingSetId];
+        epe_b_[nettingSetId];
+        eepe_b_[nettingSetId];
+
+        nettingSets.push_back(ns);
+    }
+
+    // The worker threads use the evaluation date of the calling thread
+
+    Date evaluationDate = Settings::instance().evaluationDate();
+    QuantExt::ChunkWorkers workers(nThreads_);
+
+    workers.run(nettingSets.size(), [&](const Size nettingSetCount) {
+        if (Settings::instance().evaluationDate() != evaluationDate)
+            Settings::instance().evaluationDate() = evaluationDate;
+        const NettingSetData& ns = nettingSets[nettingSetCount];
+        const string& nettingSetId = ns.nettingSetId;
+        const QuantLib::ext::shared_ptr<NettingSetDefinition>& netting = ns.netting;
+
+        //only for active CSA and calcType == NoLag close-out value is relevant
+        const vector<vector<Real>>& data =
+            netting->activeCsaFlag() && calcType_ == CollateralExposureHelper::CalculationType::NoLag
+                ? nettingSetCloseOutValue_.at(nettingSetId)
+                : nettingSetDefaultValue_.at(nettingSetId);
+
+        const vector<vector<Real>>& nettingSetMporPositiveFlow = nettingSetMporPositiveFlow_.at(nettingSetId);
+        const vector<vector<Real>>& nettingSetMporNegativeFlow = nettingSetMporNegativeFlow_.at(nettingSetId);
+
+        LOG("Aggregate exposure for netting set " << nettingSetId);
+        // Get the collateral account balances by date and sample for the netting set.
+        // The pointer may remain empty if there is no CSA or if it is inactive.
+        QuantLib::ext::shared_ptr<vector<vector<Real>>> collateral =
+            collateralPaths(nettingSetId,
+                            nettingSetValueToday.at(nettingSetId),
+                            nettingSetDefaultValue_.at(nettingSetId),
+                            nettingSetMaturity.at(nettingSetId),
+                            ns.csaFxRateToday,
+                            ns.csaRateToday);
+
+        Real& colva = colva_.at(nettingSetId);
+        Real& collateralFloor = collateralFloor_.at(nettingSetId);
+
         vector<Real> epe(cube_->dates().size() + 1, 0.0);
         vector<Real> ene(cube_->dates().size() + 1, 0.0);
         vector<Real> ee_b(cube_->dates().size() + 1, 0.0);
@@ -219,16 +284,16 @@ void NettedExposureCalculator::build() {
         vector<Real> pfe(cube_->dates().size() + 1, 0.0);
         vector<Real> colvaInc(cube_->dates().size() + 1, 0.0);
         vector<Real> eoniaFloorInc(cube_->dates().size() + 1, 0.0);
-        Real npv = nettingSetValueToday[nettingSetId];
+        Real npv = nettingSetValueToday.at(nettingSetId);
         if ((fullInitialCollateralisation_) & (netting->activeCsaFlag())) {
             // This assumes that the collateral at t=0 is the same as the npv at t=0.
             epe[0] = 0;
             ene[0] = 0;
             pfe[0] = 0;
         } else {
-            epe[0] = std::max(npv - initialVMbase - initialIMbase, 0.0);
-            ene[0] = std::max(-npv + initialVMbase, 0.0);
-            pfe[0] = std::max(npv - initialVMbase - initialIMbase, 0.0);
+            epe[0] = std::max(npv - ns.initialVMbase - ns.initialIMbase, 0.0);
+            ene[0] = std::max(-npv + ns.initialVMbase, 0.0);
+            pfe[0] = std::max(npv - ns.initialVMbase - ns.initialIMbase, 0.0);
         }
         // The fullInitialCollateralisation flag doesn't affect the eab, which feeds into the "ExpectedCollateral"
         // column of the 'exposure_nettingset_*' reports.  We always assume the full collateral here.
@@ -243,11 +308,15 @@ void NettedExposureCalculator::build() {
 
             Date date = cube_->dates()[j];
             Date prevDate = j > 0 ? cube_->dates()[j - 1] : today;
-            vector<Real> distribution(cube_->samples(), 0.0);
+            // the PFE is either read from the sorted samples or estimated from a t-digest
+            std::optional<QuantExt::TDigest> pfeDigest;
+            if (pfeCompression_ != Null<Real>())
+                pfeDigest.emplace(pfeCompression_);
+            vector<Real> distribution(pfeDigest ? 0 : cube_->samples(), 0.0);
             for (Size k = 0; k < cube_->samples(); ++k) {
                 Real balance = 0.0;
                 if (collateral) {
-                    balance = collateral->at(k)->accountBalance(date);
+                    balance = (*collateral)[j][k];
                     if (netting->csaDetails()->csaCurrency() != baseCurrency_) {
                         // Convert from CSACurrency to baseCurrency
                         double fxRate = scenarioData_->get(j, k, AggregationScenarioDataType::FXSpot,
@@ -284,34 +353,38 @@ void NettedExposureCalculator::build() {
                 }
                 Real exposure = data[j][k] - balance + mporCashFlow;
                 Real dim = 0.0;
-                if (applyInitialMargin && collateral) { // don't apply initial margin without VM, i.e. inactive CSA
+                if (ns.applyInitialMargin && collateral) { // don't apply initial margin without VM, i.e. inactive CSA
                     // Initial Margin
                     // Use IM to reduce exposure
                     // Size dimIndex = j == 0 ? 0 : j - 1;
                     Size dimIndex = j;
-                    dim = dimCalculator_->dynamicIM(nettingSetId)[dimIndex][k];
+                    dim = (*ns.dynamicIM)[dimIndex][k];
                     QL_REQUIRE(dim >= 0, "negative DIM for set " << nettingSetId << ", date " << j << ", sample " << k
                                                                  << ": " << dim);
                 }
                 Real dim_epe = 0;
                 Real dim_ene = 0;
-                if (initialMarginType != CSA::Type::PostOnly)
+                if (ns.initialMarginType != CSA::Type::PostOnly)
                     dim_epe = dim;
-                if (initialMarginType != CSA::Type::CallOnly)
+                if (ns.initialMarginType != CSA::Type::CallOnly)
                     dim_ene = dim;
                 
                 // dim here represents the held IM, and is expressed as a positive number
                 epe[j + 1] += std::max(exposure - dim_epe, 0.0) / cube_->samples(); 
                 // dim here represents the posted IM, and is expressed as a positive number
                 ene[j + 1] += std::max(-exposure - dim_ene, 0.0) / cube_->samples(); 
-                distribution[k] = exposure - dim_epe;
+                Real collateralisedExposure = exposure - dim_epe;
+                if (pfeDigest)
+                    pfeDigest->add(collateralisedExposure);
+                else
+                    distribution[k] = collateralisedExposure;
                 nettedCube_->set(exposure, nettingSetCount, j, k);
                 
                 Real epeIncrement = std::max(exposure - dim_epe, 0.0) / cube_->samples();
                 DLOG("sample " << k << " date " << j << fixed << showpos << setprecision(2)
                      << ": VM "  << setw(15) << balance
                      << ": NPV " << setw(15) << data[j][k]
-                     << ": NPV-C " << setw(15) << distribution[k]
+                     << ": NPV-C " << setw(15) << collateralisedExposure
                      << ": EPE " << setw(15) << epeIncrement);
                 
                 if (multiPath_) {
@@ -321,12 +394,10 @@ void NettedExposureCalculator::build() {
  
                 if (netting->activeCsaFlag()) {
                     Real indexValue = 0.0;
-                    DayCounter dc = ActualActual(ActualActual::ISDA);
-                    if (csaIndexName != "") {
-                        indexValue = scenarioData_->get(j, k, AggregationScenarioDataType::IndexFixing, csaIndexName);
-                        dc = csaIndex->dayCounter();
-                    }
-                    Real dcf = dc.yearFraction(prevDate, date);
+                    if (ns.csaIndexName != "")
+                        indexValue =
+                            scenarioData_->get(j, k, AggregationScenarioDataType::IndexFixing, ns.csaIndexName);
+                    Real dcf = ns.csaDayCounter.yearFraction(prevDate, date);
                     Real collateralSpread = (balance >= 0.0 ? netting->csaDetails()->collatSpreadRcv() : netting->csaDetails()->collatSpreadPay());
                     Real numeraire = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
                     Real colvaDelta = -balance * collateralSpread * dcf / numeraire / cube_->samples();
@@ -335,26 +406,19 @@ void NettedExposureCalculator::build() {
                     // samples
                     Real floorDelta = -balance * std::max(-(indexValue - collateralSpread), 0.0) * dcf / numeraire / cube_->samples();
                     colvaInc[j + 1] += colvaDelta;
-                    colva_[nettingSetId] += colvaDelta;
+                    colva += colvaDelta;
                     eoniaFloorInc[j + 1] += floorDelta;
-                    collateralFloor_[nettingSetId] += floorDelta;
+                    collateralFloor += floorDelta;
                 }
 
                 if (marginalAllocation_) {
-                    Size i = 0;
-                    for (auto tradeIt = portfolio_->trades().begin(); tradeIt != portfolio_->trades().end();
-                         ++tradeIt, ++i) {
-                        const auto& trade = tradeIt->second;
-                        string nid = trade->envelope().nettingSetId();
-                        if (nid != nettingSetId)
-                            continue;
-                        
+                    for (Size i : nettingSetTrades.at(nettingSetId)) {
                         Real allocation = 0.0;
                         if (balance == 0.0)
                             allocation = cubeInterpretation_->getDefaultNpv(cube_, i, j, k);
                         // else if (data[j][k] == 0.0)
                         else if (fabs(data[j][k]) <= marginalAllocationLimit_)
-                            allocation = exposure / nettingSetSize[nid];
+                            allocation = exposure / nettingSetSize.at(nettingSetId);
                         else
                             allocation = exposure * cubeInterpretation_->getDefaultNpv(cube_, i, j, k) / data[j][k];
 
@@ -376,27 +440,29 @@ void NettedExposureCalculator::build() {
                 exposureCube_->set(epe[j + 1], nettingSetCount, j, 0, ExposureIndex::EPE);
                 exposureCube_->set(ene[j + 1], nettingSetCount, j, 0, ExposureIndex::ENE);
             }
-            ee_b[j + 1] = epe[j + 1] / curve->discount(cube_->dates()[j]);
+            ee_b[j + 1] = epe[j + 1] / discounts[j];
             eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
-            std::sort(distribution.begin(), distribution.end());
-            Size index = Size(floor(quantile_ * (cube_->samples() - 1) + 0.5));
-            pfe[j + 1] = std::max(distribution[index], 0.0);
+            if (pfeDigest) {
+                pfe[j + 1] = std::max(pfeDigest->quantile(quantile_), 0.0);
+            } else {
+                std::sort(distribution.begin(), distribution.end());
+                Size index = Size(floor(quantile_ * (cube_->samples() - 1) + 0.5));
+                pfe[j + 1] = std::max(distribution[index], 0.0);
+            }
         }
-        ee_b_[nettingSetId] = ee_b;
-        eee_b_[nettingSetId] = eee_b;
-        pfe_[nettingSetId] = pfe;
-        expectedCollateral_[nettingSetId] = eab;
-        colvaInc_[nettingSetId] = colvaInc;
-        eoniaFloorInc_[nettingSetId] = eoniaFloorInc;
-
-        nettingSetCount++;
+        ee_b_.at(nettingSetId) = ee_b;
+        eee_b_.at(nettingSetId) = eee_b;
+        pfe_.at(nettingSetId) = pfe;
+        expectedCollateral_.at(nettingSetId) = eab;
+        colvaInc_.at(nettingSetId) = colvaInc;
+        eoniaFloorInc_.at(nettingSetId) = eoniaFloorInc;
 
         Real epe_b = 0;
         Real eepe_b = 0;
 
         Size t = 0;
         Calendar cal = WeekendsOnly();
-        Date maturity = std::min(cal.adjust(today + 1 * Years + 4 * Days), nettingSetMaturity[nettingSetId]);
+        Date maturity = std::min(cal.adjust(today + 1 * Years + 4 * Days), nettingSetMaturity.at(nettingSetId));
         QuantLib::Real maturityTime = dc.yearFraction(today, maturity);
 
         while (t < cube_->dates().size() && times[t] <= maturityTime)
@@ -416,9 +482,9 @@ void NettedExposureCalculator::build() {
                 eepe_b += eee_b[k] * weights[k];
             }
         }
-        epe_b_[nettingSetId] = epe_b;
-        eepe_b_[nettingSetId] = eepe_b;
-    }
+        epe_b_.at(nettingSetId) = epe_b;
+        eepe_b_.at(nettingSetId) = eepe_b;
+    });
                 
     if (marginalAllocation_ && !multiPath_) {
         for (Size i = 0; i < portfolio_->trades().size(); ++i) {
@@ -430,14 +496,39 @@ void NettedExposureCalculator::build() {
     }
 }
 
-QuantLib::ext::shared_ptr<vector<QuantLib::ext::shared_ptr<CollateralAccount>>>
+std::pair<Real, Real> NettedExposureCalculator::csaRatesToday(const string& nettingSetId) {
+
+    QuantLib::ext::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetId);
+    string csaFxPair = netting->csaDetails()->csaCurrency() + baseCurrency_;
+    Real csaFxRateToday = 1.0;
+    if (netting->csaDetails()->csaCurrency() != baseCurrency_)
+        csaFxRateToday = market_->fxRate(csaFxPair, configuration_)->value();
+    LOG("CSA FX rate for pair " << csaFxPair << " = " << csaFxRateToday);
+
+    // Don't use Settings::instance().evaluationDate() here, this has moved to simulation end date.
+    Date today = market_->asofDate();
+    string csaIndexName = netting->csaDetails()->index();
+    // avoid thrown errors of the index fixing here on holidays of the index, instead take the preceding date then.
+    if (!market_->iborIndex(csaIndexName, configuration_)->isValidFixingDate(today)) {
+        today = market_->iborIndex(csaIndexName, configuration_)->fixingCalendar().adjust(today, Preceding);
+    }
+    Real csaRateToday = market_->iborIndex(csaIndexName, configuration_)->fixing(today);
+    LOG("CSA compounding rate for index " << csaIndexName << " = " << setprecision(8) << csaRateToday << " as of "
+                                          << today);
+
+    return std::make_pair(csaFxRateToday, csaRateToday);
+}
+
+QuantLib::ext::shared_ptr<vector<vector<Real>>>
 NettedExposureCalculator::collateralPaths(
     const string& nettingSetId,
     const Real& nettingSetValueToday,
     const vector<vector<Real>>& nettingSetValue,
-    const Date& nettingSetMaturity) {
+    const Date& nettingSetMaturity,
+    const Real csaFxRateToday,
+    const Real csaRateToday) {
 
-    QuantLib::ext::shared_ptr<vector<QuantLib::ext::shared_ptr<CollateralAccount>>> collateral;
+    QuantLib::ext::shared_ptr<vector<vector<Real>>> collateral;
 
     if (!nettingSetManager_->has(nettingSetId) || !nettingSetManager_->get(nettingSetId)->activeCsaFlag()) {
         LOG("CSA missing or inactive for netting set " << nettingSetId);
@@ -454,20 +545,7 @@ NettedExposureCalculator::collateralPaths(
     LOG("Build collateral account balance paths for netting set " << nettingSetId);
     QuantLib::ext::shared_ptr<NettingSetDefinition> netting = nettingSetManager_->get(nettingSetId);
     string csaFxPair = netting->csaDetails()->csaCurrency() + baseCurrency_;
-    Real csaFxRateToday = 1.0;
-    if (netting->csaDetails()->csaCurrency() != baseCurrency_)
-        csaFxRateToday = market_->fxRate(csaFxPair, configuration_)->value();
-    LOG("CSA FX rate for pair " << csaFxPair << " = " << csaFxRateToday);
-
-    // Don't use Settings::instance().evaluationDate() here, this has moved to simulation end date.
-    Date today = market_->asofDate();
     string csaIndexName = netting->csaDetails()->index();
-    // avoid thrown errors of the index fixing here on holidays of the index, instead take the preceding date then.
-    if (!market_->iborIndex(csaIndexName, configuration_)->isValidFixingDate(today)) {
-        today = market_->iborIndex(csaIndexName, configuration_)->fixingCalendar().adjust(today, Preceding);
-    }
-    Real csaRateToday = market_->iborIndex(csaIndexName, configuration_)->fixing(today);
-    LOG("CSA compounding rate for index " << csaIndexName << " = " << setprecision(8) << csaRateToday << " as of " << today);
 
     // Copy scenario data to keep the collateral exposure helper unchanged
     vector<vector<Real>> csaScenFxRates(cube_->dates().size(), vector<Real>(cube_->samples(), 0.0));
@@ -494,7 +572,7 @@ NettedExposureCalculator::collateralPaths(
         }
     }
 
-    collateral = CollateralExposureHelper::collateralBalancePaths(
+    collateral = QuantLib::ext::make_shared<vector<vector<Real>>>(CollateralExposureHelper::collateralBalances(
         netting,              // this netting set's definition
         nettingSetValueToday, // today's netting set NPV
         market_->asofDate(),  // original evaluation date
@@ -506,7 +584,7 @@ NettedExposureCalculator::collateralPaths(
         csaRateToday,         // today's collateral compounding rate in CSA currency
         csaScenRates,         // matrix of CSA ccy short rates by date and sample
         calcType_,
-        balance);             // initial collateral balances (VM, IM, IA) for the netting set
+        balance));            // initial collateral balances (VM, IM, IA) for the netting set
     LOG("Collateral account balance paths for netting set " << nettingSetId << " done");
 
     return collateral;
@@ -60,7 +60,11 @@ public:
         // Marginal Allocation
         const bool marginalAllocation, const Real marginalAllocationLimit,
         const QuantLib::ext::shared_ptr<NPVCube>& tradeExposureCube, const Size allocatedEpeIndex, const Size allocatedEneIndex,
-        const bool flipViewXVA, const bool withMporStickyDate, const MporCashFlowMode mporCashFlowMode);
+        const bool flipViewXVA, const bool withMporStickyDate, const MporCashFlowMode mporCashFlowMode,
+        // Number of threads used to process the netting sets in parallel
+        const Size nThreads = 1,
+        // If given, the PFE is estimated by a t-digest with this compression instead of sorting the samples
+        const Real pfeCompression = Null<Real>());
 
     virtual ~NettedExposureCalculator() {}
     const QuantLib::ext::shared_ptr<NPVCube>& exposureCube() { return exposureCube_; }
@@ -137,14 +141,22 @@ protected:
     map<string, Real> collateralFloor_;
     vector<Real> getMeanExposure(const string& tid, ExposureIndex index);
 
-    QuantLib::ext::shared_ptr<vector<QuantLib::ext::shared_ptr<CollateralAccount>>>
+    //! Today's CSA currency FX rate against the base currency and CSA compounding rate, read from the market
+    std::pair<Real, Real> csaRatesToday(const string& nettingSetId);
+
+    //! Collateral balances by date and sample, does not access the market and can be called from several threads
+    QuantLib::ext::shared_ptr<vector<vector<Real>>>
     collateralPaths(const string& nettingSetId,
         const Real& nettingSetValueToday,
         const vector<vector<Real>>& nettingSetValue,
-        const Date& nettingSetMaturity);
+        const Date& nettingSetMaturity,
+        const Real csaFxRateToday,
+        const Real csaRateToday);
 
     bool withMporStickyDate_;
     MporCashFlowMode mporCashFlowMode_;
+    Size nThreads_;
+    Real pfeCompression_;
 };
 
 } // namespace analytics
@@ -24,7 +24,9 @@
 #include <orea/aggregation/xvacalculator.hpp>
 #include <orea/aggregation/staticcreditxvacalculator.hpp>
 #include <orea/aggregation/cvaspreadsensitivitycalculator.hpp>
+#include <orea/cube/jointnpvcube.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/trace.hpp>
 #include <ored/utilities/vectorutils.hpp>
 #include <ql/errors.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
@@ -35,6 +37,7 @@
 #include <ql/methods/montecarlo/lsmbasissystem.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
+#include <qle/math/chunkworkers.hpp>
 #include <qle/math/nadarayawatson.hpp>
 #include <qle/math/stabilisedglls.hpp>
 
@@ -67,7 +70,8 @@ PostProcess::PostProcess(
     const string& flipViewLendingCurvePostfix,
     const QuantLib::ext::shared_ptr<CreditSimulationParameters>& creditSimulationParameters,
     const std::vector<Real>& creditMigrationDistributionGrid, const std::vector<Size>& creditMigrationTimeSteps,
-    const Matrix& creditStateCorrelationMatrix, bool withMporStickyDate, MporCashFlowMode mporCashFlowMode)
+    const Matrix& creditStateCorrelationMatrix, bool withMporStickyDate, MporCashFlowMode mporCashFlowMode,
+    Size nThreads, Real pfeQuantileCompression)
 : portfolio_(portfolio), nettingSetManager_(nettingSetManager), collateralBalances_(collateralBalances),
       market_(market), configuration_(configuration),
       cube_(cube), cptyCube_(cptyCube), scenarioData_(scenarioData), analytics_(analytics), baseCurrency_(baseCurrency),
@@ -81,7 +85,9 @@ PostProcess::PostProcess(
       creditSimulationParameters_(creditSimulationParameters),
       creditMigrationDistributionGrid_(creditMigrationDistributionGrid),
       creditMigrationTimeSteps_(creditMigrationTimeSteps), creditStateCorrelationMatrix_(creditStateCorrelationMatrix),
-      withMporStickyDate_(withMporStickyDate), mporCashFlowMode_(mporCashFlowMode) {
+      withMporStickyDate_(withMporStickyDate), mporCashFlowMode_(mporCashFlowMode), nThreads_(nThreads) {
+
+    ORE_TRACE_SCOPE("PostProcess");
 
     QL_REQUIRE(cubeInterpretation_ != nullptr, "PostProcess: cubeInterpretation is not given.");
 
@@ -175,7 +181,8 @@ PostProcess::PostProcess(
         QuantLib::ext::make_shared<ExposureCalculator>(
             portfolio, cube_, cubeInterpretation_,
             market_, analytics_["exerciseNextBreak"], baseCurrency_, configuration_,
-            quantile_, calcType_, analytics_["dynamicCredit"], analytics_["flipViewXVA"]
+            quantile_, calcType_, analytics_["dynamicCredit"], analytics_["flipViewXVA"], nThreads,
+            pfeQuantileCompression
         );
     exposureCalculator_->build();
 
@@ -200,7 +207,7 @@ PostProcess::PostProcess(
         dimCalculator_, fullInitialCollateralisation_,
         allocationMethod == ExposureAllocator::AllocationMethod::Marginal, marginalAllocationLimit,
         exposureCalculator_->exposureCube(), ExposureCalculator::allocatedEPE, ExposureCalculator::allocatedENE,
-        analytics_["flipViewXVA"], withMporStickyDate_, mporCashFlowMode_);
+        analytics_["flipViewXVA"], withMporStickyDate_, mporCashFlowMode_, nThreads, pfeQuantileCompression);
     nettedExposureCalculator_->build();
 
     /********************************************************
@@ -217,7 +224,7 @@ PostProcess::PostProcess(
             ExposureCalculator::ExposureIndex::ENE,
             NettedExposureCalculator::ExposureIndex::EPE,
             NettedExposureCalculator::ExposureIndex::ENE, 0, analytics_["flipViewXVA"], 
-            flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix);
+            flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix, nThreads_);
     } else {
         cvaCalculator_ = QuantLib::ext::make_shared<StaticCreditXvaCalculator>(
             portfolio_, market_, configuration_,baseCurrency_, dvaName_,
@@ -228,7 +235,7 @@ PostProcess::PostProcess(
             ExposureCalculator::ExposureIndex::ENE,
             NettedExposureCalculator::ExposureIndex::EPE,
             NettedExposureCalculator::ExposureIndex::ENE, analytics_["flipViewXVA"], 
-            flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix);
+            flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix, nThreads_);
     }
     cvaCalculator_->build();
 
@@ -245,14 +252,14 @@ PostProcess::PostProcess(
             nettedExposureCalculator_->exposureCube(), cube_,
             ExposureCalculator::allocatedEPE, ExposureCalculator::allocatedENE,
             ExposureCalculator::EPE, ExposureCalculator::ENE,
-            NettedExposureCalculator::EPE, NettedExposureCalculator::ENE);
+            NettedExposureCalculator::EPE, NettedExposureCalculator::ENE, nThreads_);
     else if (allocationMethod == ExposureAllocator::AllocationMethod::RelativeFairValueGross)
         exposureAllocator = QuantLib::ext::make_shared<RelativeFairValueGrossExposureAllocator>(
             portfolio, exposureCalculator_->exposureCube(),
             nettedExposureCalculator_->exposureCube(), cube_,
             ExposureCalculator::allocatedEPE, ExposureCalculator::allocatedENE,
             ExposureCalculator::EPE, ExposureCalculator::ENE,
-            NettedExposureCalculator::EPE, NettedExposureCalculator::ENE);
+            NettedExposureCalculator::EPE, NettedExposureCalculator::ENE, nThreads_);
     else if (allocationMethod == ExposureAllocator::AllocationMethod::RelativeXVA)
         exposureAllocator = QuantLib::ext::make_shared<RelativeXvaExposureAllocator>(
             portfolio, exposureCalculator_->exposureCube(),
@@ -261,11 +268,11 @@ PostProcess::PostProcess(
             cvaCalculator_->nettingSetSumCva(), cvaCalculator_->nettingSetSumDva(),
             ExposureCalculator::allocatedEPE, ExposureCalculator::allocatedENE,
             ExposureCalculator::EPE, ExposureCalculator::ENE,
-            NettedExposureCalculator::EPE, NettedExposureCalculator::ENE);
+            NettedExposureCalculator::EPE, NettedExposureCalculator::ENE, nThreads_);
     else if (allocationMethod == ExposureAllocator::AllocationMethod::None)
         exposureAllocator = QuantLib::ext::make_shared<NoneExposureAllocator>(
             portfolio, exposureCalculator_->exposureCube(),
-            nettedExposureCalculator_->exposureCube());
+            nettedExposureCalculator_->exposureCube(), nThreads_);
     else
         QL_FAIL("allocationMethod " << allocationMethod << " not available");
     if(exposureAllocator)
@@ -281,7 +288,7 @@ PostProcess::PostProcess(
             nettedExposureCalculator_->exposureCube(), cptyCube_, ExposureCalculator::ExposureIndex::allocatedEPE,
             ExposureCalculator::ExposureIndex::allocatedENE, NettedExposureCalculator::ExposureIndex::EPE,
             NettedExposureCalculator::ExposureIndex::ENE, 0, analytics_["flipViewXVA"], flipViewBorrowingCurvePostfix,
-            flipViewLendingCurvePostfix);
+            flipViewLendingCurvePostfix, nThreads_);
     } else {
         allocatedCvaCalculator_ = QuantLib::ext::make_shared<StaticCreditXvaCalculator>(
             portfolio_, market_, configuration_, baseCurrency_, dvaName_, fvaBorrowingCurve_, fvaLendingCurve_,
@@ -289,7 +296,7 @@ PostProcess::PostProcess(
             nettedExposureCalculator_->exposureCube(), ExposureCalculator::ExposureIndex::allocatedEPE,
             ExposureCalculator::ExposureIndex::allocatedENE, NettedExposureCalculator::ExposureIndex::EPE,
             NettedExposureCalculator::ExposureIndex::ENE, analytics_["flipViewXVA"], flipViewBorrowingCurvePostfix,
-            flipViewLendingCurvePostfix);
+            flipViewLendingCurvePostfix, nThreads_);
     }
     allocatedCvaCalculator_->build();
 
@@ -551,41 +558,54 @@ void PostProcess::updateNettingSetCvaSensitivity() {
 
     Handle<YieldTermStructure> discountCurve = market_->discountCurve(baseCurrency_, configuration_);
 
-    for (auto n : netEPE_) {
+    // the spread to hazard rate Jacobian depends on the credit curve only, compute it once per counterparty
+    vector<string> nettingSetIds;
+    vector<string> cids;
+    map<string, tuple<Handle<DefaultProbabilityTermStructure>, Real, Matrix>> curves;
+    for (auto const& n : netEPE_) {
         string nettingSetId = n.first;
-        vector<Real> epe = netEPE_[nettingSetId];
         string cid;
-        Handle<DefaultProbabilityTermStructure> cvaDts;
-        Real cvaRR;
         if (analytics_["flipViewXVA"]) {
             cid = dvaName_;
         } else {
             cid = nettedExposureCalculator_->counterparty(nettingSetId);
         }
-        cvaDts = market_->defaultCurve(cid)->curve();
+        nettingSetIds.push_back(nettingSetId);
+        cids.push_back(cid);
+        if (curves.find(cid) != curves.end())
+            continue;
+        Handle<DefaultProbabilityTermStructure> cvaDts = market_->defaultCurve(cid)->curve();
         QL_REQUIRE(!cvaDts.empty(), "Default curve missing for counterparty " << cid);
-        cvaRR = market_->recoveryRate(cid, configuration_)->value();
-
-	    bool cvaSensi = analytics_["cvaSensi"];
-	    LOG("CVA Sensitivity: " << cvaSensi);
-	    if (cvaSensi) {
-	        QuantLib::ext::shared_ptr<CVASpreadSensitivityCalculator> cvaSensiCalculator = QuantLib::ext::make_shared<CVASpreadSensitivityCalculator>(
-	             nettingSetId, market_->asofDate(), epe, cube_->dates(), cvaDts, cvaRR, discountCurve, cvaSpreadSensiGrid_, cvaSpreadSensiShiftSize_);
-
-	        for (Size i = 0; i < cvaSensiCalculator->shiftTimes().size(); ++i) {
-	            DLOG("CVA Sensi Calculator: t=" << cvaSensiCalculator->shiftTimes()[i]
-		         << " h=" << cvaSensiCalculator->hazardRateSensitivities()[i] 
-		         << " s=" << cvaSensiCalculator->cdsSpreadSensitivities()[i]); 
-	        }
-
-	        netCvaHazardRateSensi_[nettingSetId] = cvaSensiCalculator->hazardRateSensitivities();
-	        netCvaSpreadSensi_[nettingSetId] = cvaSensiCalculator->cdsSpreadSensitivities();
-	        cvaSpreadSensiTimes_ = cvaSensiCalculator->shiftTimes();
-	    } else {
-	        cvaSpreadSensiTimes_ = vector<Real>();
-	        netCvaHazardRateSensi_[nettingSetId] = vector<Real>();
-	        netCvaSpreadSensi_[nettingSetId] = vector<Real>();
-	    }
+        Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
+        Matrix jacobi = CVASpreadSensitivityCalculator::cdsSpreadJacobian(
+            market_->asofDate(), cvaDts, cvaRR, discountCurve, cvaSpreadSensiGrid_, cvaSpreadSensiShiftSize_);
+        curves[cid] = std::make_tuple(cvaDts, cvaRR, jacobi);
+    }
+
+    // the netting sets are processed in parallel, the market curves are not modified here
+    vector<QuantLib::ext::shared_ptr<CVASpreadSensitivityCalculator>> calculators(nettingSetIds.size());
+    Date evaluationDate = Settings::instance().evaluationDate();
+    QuantExt::ChunkWorkers workers(nThreads_);
+    workers.run(nettingSetIds.size(),
+                [this, &nettingSetIds, &cids, &curves, &calculators, &discountCurve, &evaluationDate](const Size i) {
+                    if (Settings::instance().evaluationDate() != evaluationDate)
+                        Settings::instance().evaluationDate() = evaluationDate;
+                    const auto& [cvaDts, cvaRR, jacobi] = curves.at(cids[i]);
+                    calculators[i] = QuantLib::ext::make_shared<CVASpreadSensitivityCalculator>(
+                        nettingSetIds[i], market_->asofDate(), netEPE_.at(nettingSetIds[i]), cube_->dates(), cvaDts,
+                        cvaRR, discountCurve, cvaSpreadSensiGrid_, cvaSpreadSensiShiftSize_, jacobi);
+                });
+
+    for (Size n = 0; n < nettingSetIds.size(); ++n) {
+        const auto& cvaSensiCalculator = calculators[n];
+        for (Size i = 0; i < cvaSensiCalculator->shiftTimes().size(); ++i) {
+            DLOG("CVA Sensi Calculator: t=" << cvaSensiCalculator->shiftTimes()[i]
+                                            << " h=" << cvaSensiCalculator->hazardRateSensitivities()[i]
+                                            << " s=" << cvaSensiCalculator->cdsSpreadSensitivities()[i]);
+        }
+        netCvaHazardRateSensi_[nettingSetIds[n]] = cvaSensiCalculator->hazardRateSensitivities();
+        netCvaSpreadSensi_[nettingSetIds[n]] = cvaSensiCalculator->cdsSpreadSensitivities();
+        cvaSpreadSensiTimes_ = cvaSensiCalculator->shiftTimes();
     }
 
     LOG("Update netting set CVA sensitivities done");
@@ -820,5 +840,32 @@ void PostProcess::exportDimRegression(const std::string& nettingSet, const std::
         regCalc->exportDimRegression(nettingSet, timeSteps, dimRegReports);
 }
 
+NettingSetSubset restrictToNettingSets(const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
+                                       const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                                       const std::set<std::string>& nettingSetIds,
+                                       const QuantLib::ext::shared_ptr<NPVCube>& cptyCube, const std::string& dvaName) {
+    QL_REQUIRE(portfolio, "restrictToNettingSets(): no portfolio given");
+    QL_REQUIRE(cube, "restrictToNettingSets(): no cube given");
+    NettingSetSubset result;
+    result.portfolio = QuantLib::ext::make_shared<Portfolio>(portfolio->buildFailedTrades());
+    for (auto const& [tradeId, trade] : portfolio->trades()) {
+        if (nettingSetIds.find(trade->envelope().nettingSetId()) != nettingSetIds.end())
+            result.portfolio->add(trade);
+    }
+    LOG("restrictToNettingSets(): " << result.portfolio->size() << " out of " << portfolio->size() << " trades in "
+                                    << nettingSetIds.size() << " netting sets");
+    // the joint cube would contain all ids of the input cube for an empty id set
+    QL_REQUIRE(!result.portfolio->empty(), "restrictToNettingSets(): no trades in the given netting sets");
+    result.cube = QuantLib::ext::make_shared<JointNPVCube>(std::vector<QuantLib::ext::shared_ptr<NPVCube>>{cube},
+                                                           result.portfolio->ids());
+    if (cptyCube) {
+        auto cptyIds = result.portfolio->counterparties();
+        cptyIds.insert(dvaName);
+        result.cptyCube = QuantLib::ext::make_shared<JointNPVCube>(
+            std::vector<QuantLib::ext::shared_ptr<NPVCube>>{cptyCube}, cptyIds);
+    }
+    return result;
+}
+
 } // namespace analytics
 } // namespace ore
@@ -169,7 +169,11 @@ public:
         //! If set to true, cash flows in the margin period of risk are ignored in the collateral modelling
         bool withMporStickyDate = false,
         //! Treatment of cash flows over the margin period of risk
-        const MporCashFlowMode mporCashFlowMode = MporCashFlowMode::Unspecified);
+        const MporCashFlowMode mporCashFlowMode = MporCashFlowMode::Unspecified,
+        //! Number of threads used to process the netting sets in the exposure calculations
+        const Size nThreads = 1,
+        //! If given, the PFE is estimated by a t-digest with this compression instead of sorting the samples
+        const Real pfeQuantileCompression = Null<Real>());
 
     void setDimCalculator(QuantLib::ext::shared_ptr<DynamicInitialMarginCalculator> dimCalculator) {
         dimCalculator_ = dimCalculator;
@@ -381,7 +385,27 @@ protected:
     std::vector<std::vector<Real>> creditMigrationPdf_;
     bool withMporStickyDate_;
     MporCashFlowMode mporCashFlowMode_;
+    Size nThreads_;
 };
 
+//! Input of a PostProcess restricted to some netting sets, see restrictToNettingSets()
+struct NettingSetSubset {
+    QuantLib::ext::shared_ptr<Portfolio> portfolio;
+    QuantLib::ext::shared_ptr<NPVCube> cube, cptyCube;
+};
+
+/*! Restrict the portfolio, the cube and, if given, the counterparty cube of a PostProcess to the trades of the given
+    netting sets, the cubes are views on the given ones. The trade and netting set level results of a PostProcess only
+    depend on the trades of the same netting set, so a PostProcess on the restricted input reproduces the results of a
+    PostProcess on the full input for these netting sets. This allows to process only the netting sets affected by an
+    incremental cube update, see ValuationEngine::updateCube(), the netting sets of the changed trades can be looked up
+    in Portfolio::nettingSetMap() of the portfolio before the change. Portfolio level results such as the credit
+    migration distributions are not reproduced. */
+NettingSetSubset restrictToNettingSets(const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
+                                       const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                                       const std::set<std::string>& nettingSetIds,
+                                       const QuantLib::ext::shared_ptr<NPVCube>& cptyCube = nullptr,
+                                       const std::string& dvaName = "");
+
 } // namespace analytics
 } // namespace ore
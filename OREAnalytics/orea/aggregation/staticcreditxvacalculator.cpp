@@ -41,167 +41,26 @@ StaticCreditXvaCalculator::StaticCreditXvaCalculator(
     const QuantLib::ext::shared_ptr<NPVCube> nettingSetExposureCube,
     const Size tradeEpeIndex, const Size tradeEneIndex, 
     const Size nettingSetEpeIndex, const Size nettingSetEneIndex,
-    const bool flipViewXVA, const string& flipViewBorrowingCurvePostfix, const string& flipViewLendingCurvePostfix)
+    const bool flipViewXVA, const string& flipViewBorrowingCurvePostfix, const string& flipViewLendingCurvePostfix,
+    const Size nThreads)
     : ValueAdjustmentCalculator(portfolio, market, configuration, baseCurrency, dvaName,
                                 fvaBorrowingCurve, fvaLendingCurve, applyDynamicInitialMargin,
                                 dimCalculator, tradeExposureCube, nettingSetExposureCube, tradeEpeIndex, tradeEneIndex, 
                                 nettingSetEpeIndex, nettingSetEneIndex, 
-                                flipViewXVA, flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix) {
-    for (Size i = 0; i < dates().size(); i++) {
-        dateIndexMap_.emplace(dates()[i], i);
-    }
-}
-
-
-const Real StaticCreditXvaCalculator::calculateCvaIncrement(
-    const string& tid, const string& cid, const Date& d0, const Date& d1, const Real& rr) {
-    Handle<DefaultProbabilityTermStructure> dts = market_->defaultCurve(cid, configuration_)->curve();
-    QL_REQUIRE(!dts.empty(), "Default curve missing for counterparty " << cid);
-    Real increment = 0.0;
-    Real s0 = dts->survivalProbability(d0);
-    Real s1 = dts->survivalProbability(d1);
-    Real epe = tradeExposureCube_->get(tid, d1, 0, tradeEpeIndex_);
-    increment = (1.0 - rr) * (s0 - s1) * epe;
-    return increment;
-}
+                                flipViewXVA, flipViewBorrowingCurvePostfix, flipViewLendingCurvePostfix, nThreads) {}
 
-const Real StaticCreditXvaCalculator::calculateDvaIncrement(
-    const string& tid, const Date& d0, const Date& d1, const Real& rr) {
-    Handle<DefaultProbabilityTermStructure> dts = market_->defaultCurve(dvaName_, configuration_)->curve();
-    QL_REQUIRE(!dts.empty(), "Default curve missing for dvaName " << dvaName_);
-    Real increment = 0.0;
-    Real s0 = dts->survivalProbability(d0);
-    Real s1 = dts->survivalProbability(d1);
-    Real ene = tradeExposureCube_->get(tid, d1, 0, tradeEneIndex_);
-    increment = (1.0 - rr) * (s0 - s1) * ene;
-    return increment;
-}
 
-const Real StaticCreditXvaCalculator::calculateNettingSetCvaIncrement(
-    const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& rr) {
-    Handle<DefaultProbabilityTermStructure> dts = market_->defaultCurve(cid, configuration_)->curve();
-    QL_REQUIRE(!dts.empty(), "Default curve missing for counterparty " << cid);
-    Real increment = 0.0;
-    Real s0 = dts->survivalProbability(d0);
-    Real s1 = dts->survivalProbability(d1);
-    Real epe = nettingSetExposureCube_->get(nid, d1, 0, nettingSetEpeIndex_);
-    increment = (1.0 - rr) * (s0 - s1) * epe;
-    return increment;
+vector<Real> StaticCreditXvaCalculator::survivalProbabilities(const string& name) {
+    Handle<DefaultProbabilityTermStructure> dts = market_->defaultCurve(name, configuration_)->curve();
+    QL_REQUIRE(!dts.empty(), "Default curve missing for " << name);
+    vector<Real> sp(dates().size() + 1);
+    sp[0] = dts->survivalProbability(asof());
+    for (Size j = 0; j < dates().size(); ++j)
+        sp[j + 1] = dts->survivalProbability(dates()[j]);
+    return sp;
 }
 
-const Real StaticCreditXvaCalculator::calculateNettingSetDvaIncrement(
-    const string& nid, const Date& d0, const Date& d1, const Real& rr) {
-    Handle<DefaultProbabilityTermStructure> dts = market_->defaultCurve(dvaName_, configuration_)->curve();
-    QL_REQUIRE(!dts.empty(), "Default curve missing for dvaName " << dvaName_);
-    Real increment = 0.0;
-    Real s0 = dts->survivalProbability(d0);
-    Real s1 = dts->survivalProbability(d1);
-    Real ene = nettingSetExposureCube_->get(nid, d1, 0, nettingSetEneIndex_);
-    increment = (1.0 - rr) * (s0 - s1) * ene;
-    return increment;
-}
-
-const Real StaticCreditXvaCalculator::calculateFbaIncrement(
-    const string& tid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Handle<DefaultProbabilityTermStructure> dts_cid;
-    Handle<DefaultProbabilityTermStructure> dts_dvaName;
-    if (cid != "") {
-        dts_cid = market_->defaultCurve(cid, configuration_)->curve();
-        QL_REQUIRE(!dts_cid.empty(), "Default curve missing for counterparty " << cid);
-    }
-    if (dvaName != "") {
-        dts_dvaName = market_->defaultCurve(dvaName, configuration_)->curve();
-        QL_REQUIRE(!dts_dvaName.empty(), "Default curve missing for dvaName " << dvaName);
-    }
-
-    Real increment = 0.0;
-    Real s0 = cid == "" ? 1.0 : dts_cid->survivalProbability(d0);
-    Real s1 = dvaName == "" ? 1.0 : dts_dvaName->survivalProbability(d0);
-    Real ene = tradeExposureCube_->get(tid, d1, 0, tradeEneIndex_);
-    increment = s0 * s1 * ene * dcf;
-    return increment;
-}
-
-const Real StaticCreditXvaCalculator::calculateFcaIncrement(
-    const string& tid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Handle<DefaultProbabilityTermStructure> dts_cid;
-    Handle<DefaultProbabilityTermStructure> dts_dvaName;
-    if (cid != "") {
-        dts_cid = market_->defaultCurve(cid, configuration_)->curve();
-        QL_REQUIRE(!dts_cid.empty(), "Default curve missing for counterparty " << cid);
-    }
-    if (dvaName != "") {
-        dts_dvaName = market_->defaultCurve(dvaName, configuration_)->curve();
-        QL_REQUIRE(!dts_dvaName.empty(), "Default curve missing for dvaName " << dvaName);
-    }
-
-    Real increment = 0.0;
-    Real s0 = cid == "" ? 1.0 : dts_cid->survivalProbability(d0);
-    Real s1 = dvaName == "" ? 1.0 : dts_dvaName->survivalProbability(d0);
-    Real epe = tradeExposureCube_->get(tid, d1, 0, tradeEpeIndex_);
-    increment = s0 * s1 * epe * dcf;
-    return increment;
-}
-
-const Real StaticCreditXvaCalculator::calculateNettingSetFbaIncrement(
-    const string& nid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Handle<DefaultProbabilityTermStructure> dts_cid;
-    Handle<DefaultProbabilityTermStructure> dts_dvaName;
-    if (cid != "") {
-        dts_cid = market_->defaultCurve(cid, configuration_)->curve();
-        QL_REQUIRE(!dts_cid.empty(), "Default curve missing for counterparty " << cid);
-    }
-    if (dvaName != "") {
-        dts_dvaName = market_->defaultCurve(dvaName, configuration_)->curve();
-        QL_REQUIRE(!dts_dvaName.empty(), "Default curve missing for dvaName " << dvaName);
-    }
-
-    Real increment = 0.0;
-    Real s0 = cid == "" ? 1.0 : dts_cid->survivalProbability(d0);
-    Real s1 = dvaName == "" ? 1.0 : dts_dvaName->survivalProbability(d0);
-    Real ene = nettingSetExposureCube_->get(nid, d1, 0, nettingSetEneIndex_);
-    increment = s0 * s1 * ene * dcf;
-    return increment;
-}
-
-const Real StaticCreditXvaCalculator::calculateNettingSetFcaIncrement(
-    const string& nid, const string& cid, const string& dvaName,
-    const Date& d0, const Date& d1, const Real& dcf) {
-    Handle<DefaultProbabilityTermStructure> dts_cid;
-    Handle<DefaultProbabilityTermStructure> dts_dvaName;
-    if (cid != "") {
-        dts_cid = market_->defaultCurve(cid, configuration_)->curve();
-        QL_REQUIRE(!dts_cid.empty(), "Default curve missing for counterparty " << cid);
-    }
-    if (dvaName != "") {
-        dts_dvaName = market_->defaultCurve(dvaName, configuration_)->curve();
-        QL_REQUIRE(!dts_dvaName.empty(), "Default curve missing for dvaName " << dvaName);
-    }
-
-    Real increment = 0.0;
-    Real s0 = cid == "" ? 1.0 : dts_cid->survivalProbability(d0);
-    Real s1 = dvaName == "" ? 1.0 : dts_dvaName->survivalProbability(d0);
-    Real epe = nettingSetExposureCube_->get(nid, d1, 0, nettingSetEpeIndex_);
-    increment = s0 * s1 * epe * dcf;
-    return increment;
-}
-
-const Real StaticCreditXvaCalculator::calculateNettingSetMvaIncrement(
-    const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& dcf) {
-    Handle<DefaultProbabilityTermStructure> dts_cid = market_->defaultCurve(cid, configuration_)->curve();
-    QL_REQUIRE(cid == "" || !dts_cid.empty(), "Default curve missing for counterparty " << cid);
-    Handle<DefaultProbabilityTermStructure> dts_dvaName = market_->defaultCurve(dvaName_, configuration_)->curve();
-    QL_REQUIRE(dvaName_ == "" || !dts_dvaName.empty(), "Default curve missing for dvaName " << dvaName_);
-
-    Real increment = 0.0;
-    Real s0 = cid == "" ? 1.0 : dts_cid->survivalProbability(d0);
-    Real s1 = dvaName_ == "" ? 1.0 : dts_dvaName->survivalProbability(d0);
-    increment = s0 * s1 * dimCalculator_->expectedIM(nid)[dateIndexMap_[d1]] * dcf;
-    return increment;
-}
+vector<Real> StaticCreditXvaCalculator::initialMargin(const string& nid) { return dimCalculator_->expectedIM(nid); }
 
 } // namespace analytics
 } // namespace ore
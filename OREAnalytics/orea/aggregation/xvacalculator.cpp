@@ -23,6 +23,8 @@
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/vectorutils.hpp>
 
+#include <qle/math/chunkworkers.hpp>
+
 #include <ql/errors.hpp>
 
 using namespace std;
@@ -47,7 +49,8 @@ ValueAdjustmentCalculator::ValueAdjustmentCalculator(
     const QuantLib::ext::shared_ptr<NPVCube> nettingSetExposureCube,
     const Size tradeEpeIndex, const Size tradeEneIndex,
     const Size nettingSetEpeIndex, const Size nettingSetEneIndex, 
-    const bool flipViewXVA, const string& flipViewBorrowingCurvePostfix, const string& flipViewLendingCurvePostfix)
+    const bool flipViewXVA, const string& flipViewBorrowingCurvePostfix, const string& flipViewLendingCurvePostfix,
+    const Size nThreads)
     : portfolio_(portfolio), market_(market), configuration_(configuration),
       baseCurrency_(baseCurrency), dvaName_(dvaName),
       fvaBorrowingCurve_(fvaBorrowingCurve), fvaLendingCurve_(fvaLendingCurve),
@@ -57,9 +60,11 @@ ValueAdjustmentCalculator::ValueAdjustmentCalculator(
       nettingSetExposureCube_(nettingSetExposureCube),
       tradeEpeIndex_(tradeEpeIndex), tradeEneIndex_(tradeEneIndex), nettingSetEpeIndex_(nettingSetEpeIndex),
       nettingSetEneIndex_(nettingSetEneIndex), flipViewXVA_(flipViewXVA),
-      flipViewBorrowingCurvePostfix_(flipViewBorrowingCurvePostfix), flipViewLendingCurvePostfix_(flipViewLendingCurvePostfix) {
+      flipViewBorrowingCurvePostfix_(flipViewBorrowingCurvePostfix),
+      flipViewLendingCurvePostfix_(flipViewLendingCurvePostfix), nThreads_(nThreads) {
 
     QL_REQUIRE(portfolio_, "portfolio is null");
+    QL_REQUIRE(nThreads_ > 0, "ValueAdjustmentCalculator: nThreads must be positive");
 
     for (const auto& [tradeId, trade] : portfolio_->trades()) {
         string nettingSetId = trade->envelope().nettingSetId();
@@ -270,179 +275,271 @@ const Real& ValueAdjustmentCalculator::nettingSetMva(const std::string& nettingS
         QL_FAIL("netting set " << nettingSet << " not found in expected MVA results");
 }
 
+namespace {
+
+// inputs and results of the XVA calculation for a trade or a netting set
+struct XvaItem {
+    string id;
+    Size cubeIndex = 0;
+    Real cvaRR = 0.0, dvaRR = 0.0;
+    // survival probabilities of the counterparty and own name (if any)
+    const vector<Real>* cptySp = nullptr;
+    const vector<Real>* ownSp = nullptr;
+    // funding spreads (discount factor ratios minus ois discount factor ratios) on the cube dates, if any
+    const vector<Real>* borrowingSpread = nullptr;
+    const vector<Real>* lendingSpread = nullptr;
+    vector<Real> initialMargin;
+    // true if the results are written to the result maps, this is the case once the recovery rates are known
+    bool initialised = false;
+    string error;
+    Real cva = 0.0, dva = 0.0, fca = 0.0, fcaExOwnSp = 0.0, fcaExAllSp = 0.0, fba = 0.0, fbaExOwnSp = 0.0,
+         fbaExAllSp = 0.0, mva = 0.0;
+};
+
+// the exposures of an id on the cube dates, stored row-wise with n samples per row
+vector<Real> exposureProfile(const NPVCube& cube, const Size id, const Size depth, const Size numDates, const Size n) {
+    vector<Real> x(numDates * n);
+    for (Size j = 0; j < numDates; ++j)
+        for (Size k = 0; k < n; ++k)
+            x[j * n + k] = cube.get(id, j, k, depth);
+    return x;
+}
+
+// sum over the date intervals [d0, d1] of (1 - rr) E[ (S(d0) - S(d1)) X(d1) ]
+Real defaultIntegral(const vector<Real>& sp, const vector<Real>& x, const Real rr, const Size numDates,
+                     const Size n) {
+    Real result = 0.0;
+    for (Size j = 0; j < numDates; ++j) {
+        const Real* s0 = &sp[j * n];
+        const Real* s1 = s0 + n;
+        const Real* e = &x[j * n];
+        Real increment = 0.0;
+        for (Size k = 0; k < n; ++k)
+            increment += (s0[k] - s1[k]) * e[k];
+        result += (1.0 - rr) * increment / static_cast<Real>(n);
+    }
+    return result;
+}
+
+// sum over the date intervals [d0, d1] of dcf E[ S1(d0) S2(d0) X(d1) ], a null survival probability stands for 1
+Real fundingIntegral(const vector<Real>& dcf, const vector<Real>* sp1, const vector<Real>* sp2, const vector<Real>& x,
+                     const Size numDates, const Size n) {
+    Real result = 0.0;
+    for (Size j = 0; j < numDates; ++j) {
+        const Real* s1 = sp1 == nullptr ? nullptr : &(*sp1)[j * n];
+        const Real* s2 = sp2 == nullptr ? nullptr : &(*sp2)[j * n];
+        const Real* e = &x[j * n];
+        Real increment = 0.0;
+        for (Size k = 0; k < n; ++k)
+            increment += (s1 == nullptr ? 1.0 : s1[k]) * (s2 == nullptr ? 1.0 : s2[k]) * e[k];
+        result += increment * dcf[j] / static_cast<Real>(n);
+    }
+    return result;
+}
+
+} // namespace
+
 void ValueAdjustmentCalculator::build() {
-    const auto& numDates = dates().size();
-    const auto& today = asof();
+    const Size numDates = dates().size();
+    const Size n = samples();
+    const Date today = asof();
 
-    Handle<YieldTermStructure> borrowingCurve, lendingCurve, oisCurve;
+    Handle<YieldTermStructure> oisCurve;
     if (baseCurrency_ != "")
         oisCurve = market_->discountCurve(baseCurrency_, configuration_);
 
-    string origDvaName = dvaName_;
-    // Trade XVA
-    for (const auto& [tid, trade] : portfolio_->trades()) {
-        try {
-            LOG("Update XVA for trade " << tid
-                                        << (flipViewXVA_ ? ", inverted (flipViewXVA = Y)"
-                                                         : ", regular (flipViewXVA = N)"));
-            string cid;
-            if (flipViewXVA_) {
-                cid = origDvaName;
-                dvaName_ = trade->envelope().counterparty();
-                fvaBorrowingCurve_ = dvaName_ + flipViewBorrowingCurvePostfix_;
-                fvaLendingCurve_ = dvaName_ + flipViewLendingCurvePostfix_;
-            } else {
-                cid = trade->envelope().counterparty();
-            }
-            if (fvaBorrowingCurve_ != "")
-                borrowingCurve = market_->yieldCurve(fvaBorrowingCurve_, configuration_);
-            if (fvaLendingCurve_ != "")
-                lendingCurve = market_->yieldCurve(fvaLendingCurve_, configuration_);
+    // survival probabilities per name and funding spreads per curve, each computed once
 
-            if (!borrowingCurve.empty() || !lendingCurve.empty()) {
-                QL_REQUIRE(baseCurrency_ != "", "baseCurrency required for FVA calculation");
-            }
-            string nid = trade->envelope().nettingSetId();
-            Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
-            Real dvaRR = 0.0;
-            if (dvaName_ != "")
-                dvaRR = market_->recoveryRate(dvaName_, configuration_)->value();
-
-            tradeCva_[tid] = 0.0;
-            tradeDva_[tid] = 0.0;
-            tradeFca_[tid] = 0.0;
-            tradeFca_exOwnSp_[tid] = 0.0;
-            tradeFca_exAllSp_[tid] = 0.0;
-            tradeFba_[tid] = 0.0;
-            tradeFba_exOwnSp_[tid] = 0.0;
-            tradeFba_exAllSp_[tid] = 0.0;
-            tradeMva_[tid] = 0.0;
-            for (Size j = 0; j < numDates; ++j) {
+    map<string, vector<Real>> survivalProbs, fundingSpreads;
 
-                // CVA / DVA
+    auto survivalProbsOf = [this, &survivalProbs](const string& name) {
+        auto it = survivalProbs.find(name);
+        if (it == survivalProbs.end()) {
+            vector<Real> sp = survivalProbabilities(name);
+            QL_REQUIRE(sp.size() == (dates().size() + 1) * samples(),
+                       "survival probabilities for " << name << " have size " << sp.size() << ", expected "
+                                                     << (dates().size() + 1) * samples());
+            it = survivalProbs.emplace(name, std::move(sp)).first;
+        }
+        return &it->second;
+    };
+
+    auto fundingSpreadOf = [this, &fundingSpreads, &oisCurve, &today, numDates](const string& curveName) {
+        const vector<Real>* result = nullptr;
+        if (curveName == "")
+            return result;
+        auto it = fundingSpreads.find(curveName);
+        if (it == fundingSpreads.end()) {
+            Handle<YieldTermStructure> curve = market_->yieldCurve(curveName, configuration_);
+            if (curve.empty())
+                return result;
+            QL_REQUIRE(baseCurrency_ != "", "baseCurrency required for FVA calculation");
+            vector<Real> dcf(numDates);
+            for (Size j = 0; j < numDates; ++j) {
                 Date d0 = j == 0 ? today : dates()[j - 1];
                 Date d1 = dates()[j];
-                Real cvaIncrement = calculateCvaIncrement(tid, cid, d0, d1, cvaRR);
-                Real dvaIncrement = dvaName_ != "" ? calculateDvaIncrement(tid, d0, d1, dvaRR) : 0;
-                tradeCva_[tid] += cvaIncrement;
-                tradeDva_[tid] += dvaIncrement;
-
-                // FCA
-                if (!borrowingCurve.empty()) {
-                    Real dcf = borrowingCurve->discount(d0) / borrowingCurve->discount(d1) -
-                               oisCurve->discount(d0) / oisCurve->discount(d1);
-                    Real fcaIncrement = calculateFcaIncrement(tid, cid, dvaName_, d0, d1, dcf);
-                    Real fcaIncrement_exOwnSP = calculateFcaIncrement(tid, cid, "", d0, d1, dcf);
-                    Real fcaIncrement_exAllSP = calculateFcaIncrement(tid, "", "", d0, d1, dcf);
-                    tradeFca_[tid] += fcaIncrement;
-                    tradeFca_exOwnSp_[tid] += fcaIncrement_exOwnSP;
-                    tradeFca_exAllSp_[tid] += fcaIncrement_exAllSP;
-                }
-
-                // FBA
-                if (!lendingCurve.empty()) {
-                    Real dcf = lendingCurve->discount(d0) / lendingCurve->discount(d1) -
-                               oisCurve->discount(d0) / oisCurve->discount(d1);
-                    Real fbaIncrement = calculateFbaIncrement(tid, cid, dvaName_, d0, d1, dcf);
-                    Real fbaIncrement_exOwnSP = calculateFbaIncrement(tid, cid, "", d0, d1, dcf);
-                    Real fbaIncrement_exAllSP = calculateFbaIncrement(tid, "", "", d0, d1, dcf);
-                    tradeFba_[tid] += fbaIncrement;
-                    tradeFba_exOwnSp_[tid] += fbaIncrement_exOwnSP;
-                    tradeFba_exAllSp_[tid] += fbaIncrement_exAllSP;
-                }
+                dcf[j] = curve->discount(d0) / curve->discount(d1) - oisCurve->discount(d0) / oisCurve->discount(d1);
             }
-            if (nettingSetSumCva_.find(nid) == nettingSetSumCva_.end()) {
-                nettingSetSumCva_[nid] = 0.0;
-                nettingSetSumDva_[nid] = 0.0;
+            it = fundingSpreads.emplace(curveName, std::move(dcf)).first;
+        }
+        result = &it->second;
+        return result;
+    };
+
+    // set up the credit and funding inputs for a trade or netting set with the given counterparty
+
+    auto setup = [&](XvaItem& item, const string& counterparty, const bool nettingSet) {
+        string cid = counterparty, dvaName = dvaName_, borrowingCurve = fvaBorrowingCurve_,
+               lendingCurve = fvaLendingCurve_;
+        if (flipViewXVA_) {
+            cid = dvaName_;
+            dvaName = counterparty;
+            borrowingCurve = dvaName + flipViewBorrowingCurvePostfix_;
+            lendingCurve = dvaName + flipViewLendingCurvePostfix_;
+        }
+        item.borrowingSpread = fundingSpreadOf(borrowingCurve);
+        item.lendingSpread = fundingSpreadOf(lendingCurve);
+        item.cvaRR = market_->recoveryRate(cid, configuration_)->value();
+        if (dvaName != "")
+            item.dvaRR = market_->recoveryRate(dvaName, configuration_)->value();
+        item.initialised = true;
+        item.cptySp = survivalProbsOf(cid);
+        if (dvaName != "")
+            item.ownSp = survivalProbsOf(dvaName);
+        if (nettingSet && dimCalculator_ && item.borrowingSpread != nullptr) {
+            item.initialMargin = initialMargin(item.id);
+            QL_REQUIRE(item.initialMargin.size() == numDates * n,
+                       "initial margin for netting set " << item.id << " has size " << item.initialMargin.size()
+                                                         << ", expected " << numDates * n);
+        }
+    };
+
+    // compute the XVAs of a trade or netting set from its exposures on the cube
+
+    auto compute = [numDates, n](XvaItem& item, const NPVCube& cube, const Size epeIndex, const Size eneIndex) {
+        if (!item.initialised || !item.error.empty())
+            return;
+        try {
+            vector<Real> epe = exposureProfile(cube, item.cubeIndex, epeIndex, numDates, n);
+            vector<Real> ene = exposureProfile(cube, item.cubeIndex, eneIndex, numDates, n);
+            item.cva = defaultIntegral(*item.cptySp, epe, item.cvaRR, numDates, n);
+            if (item.ownSp != nullptr)
+                item.dva = defaultIntegral(*item.ownSp, ene, item.dvaRR, numDates, n);
+            if (item.borrowingSpread != nullptr) {
+                item.fca = fundingIntegral(*item.borrowingSpread, item.cptySp, item.ownSp, epe, numDates, n);
+                item.fcaExOwnSp = fundingIntegral(*item.borrowingSpread, item.cptySp, nullptr, epe, numDates, n);
+                item.fcaExAllSp = fundingIntegral(*item.borrowingSpread, nullptr, nullptr, epe, numDates, n);
+                if (!item.initialMargin.empty())
+                    item.mva = fundingIntegral(*item.borrowingSpread, item.cptySp, item.ownSp, item.initialMargin,
+                                               numDates, n);
+            }
+            if (item.lendingSpread != nullptr) {
+                item.fba = fundingIntegral(*item.lendingSpread, item.cptySp, item.ownSp, ene, numDates, n);
+                item.fbaExOwnSp = fundingIntegral(*item.lendingSpread, item.cptySp, nullptr, ene, numDates, n);
+                item.fbaExAllSp = fundingIntegral(*item.lendingSpread, nullptr, nullptr, ene, numDates, n);
             }
-            nettingSetSumCva_[nid] += tradeCva_[tid];
-            nettingSetSumDva_[nid] += tradeDva_[tid];
         } catch (const std::exception& e) {
-            StructuredAnalyticsErrorMessage("ValueAdjustmentCalculator", "Error processing trade.", e.what(),
-                                            {{"tradeId", tid}})
-                .log();
+            item.error = e.what();
         }
-    }
+    };
 
-    // Netting Set XVA
-    for (const auto& pair : nettingSetCpty_) {
-        string nid = pair.first;
+    // set up the netting sets and trades, this accesses the market and is done sequentially
+
+    vector<XvaItem> nettingSets, trades;
+    map<string, Size> nettingSetPos;
+    for (const auto& [nid, cpty] : nettingSetCpty_) {
         LOG("Update XVA for netting set "
             << nid << (flipViewXVA_ ? ", inverted (flipViewXVA = Y)" : ", regular (flipViewXVA = N)"));
+        nettingSetPos[nid] = nettingSets.size();
+        XvaItem& item = nettingSets.emplace_back();
+        item.id = nid;
         try {
-            string cid;
-            if (flipViewXVA_) {
-                cid = origDvaName;
-                dvaName_ = pair.second;
-                fvaBorrowingCurve_ = dvaName_ + flipViewBorrowingCurvePostfix_;
-                fvaLendingCurve_ = dvaName_ + flipViewLendingCurvePostfix_;
-            } else {
-                cid = pair.second;
-            }
-            Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
-            Real dvaRR = 0.0;
-            if (dvaName_ != "") {
-                dvaRR = market_->recoveryRate(dvaName_, configuration_)->value();
-            }
-            if (fvaBorrowingCurve_ != "")
-                borrowingCurve = market_->yieldCurve(fvaBorrowingCurve_, configuration_);
-            if (fvaLendingCurve_ != "")
-                lendingCurve = market_->yieldCurve(fvaLendingCurve_, configuration_);
+            auto idx = nettingSetExposureCube_->idsAndIndexes().find(nid);
+            QL_REQUIRE(idx != nettingSetExposureCube_->idsAndIndexes().end(),
+                       "netting set " << nid << " not found in netting set exposure cube");
+            item.cubeIndex = idx->second;
+            setup(item, cpty, true);
+        } catch (const std::exception& e) {
+            item.error = e.what();
+        }
+    }
 
-            if (!borrowingCurve.empty() || !lendingCurve.empty()) {
-                QL_REQUIRE(baseCurrency_ != "", "baseCurrency required for FVA calculation");
-            }
+    vector<vector<Size>> nettingSetTrades(nettingSets.size());
+    vector<string> tradeNettingSet;
+    for (const auto& [tid, trade] : portfolio_->trades()) {
+        LOG("Update XVA for trade " << tid
+                                    << (flipViewXVA_ ? ", inverted (flipViewXVA = Y)" : ", regular (flipViewXVA = N)"));
+        const string& nid = trade->envelope().nettingSetId();
+        nettingSetTrades[nettingSetPos.at(nid)].push_back(trades.size());
+        tradeNettingSet.push_back(nid);
+        XvaItem& item = trades.emplace_back();
+        item.id = tid;
+        try {
+            auto idx = tradeExposureCube_->idsAndIndexes().find(tid);
+            QL_REQUIRE(idx != tradeExposureCube_->idsAndIndexes().end(),
+                       "trade " << tid << " not found in trade exposure cube");
+            item.cubeIndex = idx->second;
+            setup(item, trade->envelope().counterparty(), false);
+        } catch (const std::exception& e) {
+            item.error = e.what();
+        }
+    }
 
-            nettingSetCva_[nid] = 0.0;
-            nettingSetDva_[nid] = 0.0;
-            nettingSetFca_[nid] = 0.0;
-            nettingSetFca_exOwnSp_[nid] = 0.0;
-            nettingSetFca_exAllSp_[nid] = 0.0;
-            nettingSetFba_[nid] = 0.0;
-            nettingSetFba_exOwnSp_[nid] = 0.0;
-            nettingSetFba_exAllSp_[nid] = 0.0;
-            nettingSetMva_[nid] = 0.0;
-            for (Size j = 0; j < numDates; ++j) {
-                // CVA / DVA
-                Date d0 = j == 0 ? today : dates()[j - 1];
-                Date d1 = dates()[j];
-                Real cvaIncrement = calculateNettingSetCvaIncrement(nid, cid, d0, d1, cvaRR);
-                Real dvaIncrement = dvaName_ != "" ? calculateNettingSetDvaIncrement(nid, d0, d1, dvaRR) : 0;
-                nettingSetCva_[nid] += cvaIncrement;
-                nettingSetDva_[nid] += dvaIncrement;
-
-                // FCA
-                if (!borrowingCurve.empty()) {
-                    Real dcf = borrowingCurve->discount(d0) / borrowingCurve->discount(d1) -
-                               oisCurve->discount(d0) / oisCurve->discount(d1);
-                    Real fcaIncrement = calculateNettingSetFcaIncrement(nid, cid, dvaName_, d0, d1, dcf);
-                    Real fcaIncrement_exOwnSP = calculateNettingSetFcaIncrement(nid, cid, "", d0, d1, dcf);
-                    Real fcaIncrement_exAllSP = calculateNettingSetFcaIncrement(nid, "", "", d0, d1, dcf);
-                    nettingSetFca_[nid] += fcaIncrement;
-                    nettingSetFca_exOwnSp_[nid] += fcaIncrement_exOwnSP;
-                    nettingSetFca_exAllSp_[nid] += fcaIncrement_exAllSP;
-
-                    // MVA
-                    if (dimCalculator_) {
-                        Real mvaIncrement = calculateNettingSetMvaIncrement(nid, cid, d0, d1, dcf);
-                        nettingSetMva_[nid] += mvaIncrement;
-                    }
-                }
-
-                // FBA
-                if (!lendingCurve.empty()) {
-                    Real dcf = lendingCurve->discount(d0) / lendingCurve->discount(d1) -
-                               oisCurve->discount(d0) / oisCurve->discount(d1);
-                    Real fbaIncrement = calculateNettingSetFbaIncrement(nid, cid, dvaName_, d0, d1, dcf);
-                    Real fbaIncrement_exOwnSP = calculateNettingSetFbaIncrement(nid, cid, "", d0, d1, dcf);
-                    Real fbaIncrement_exAllSP = calculateNettingSetFbaIncrement(nid, "", "", d0, d1, dcf);
-                    nettingSetFba_[nid] += fbaIncrement;
-                    nettingSetFba_exOwnSp_[nid] += fbaIncrement_exOwnSP;
-                    nettingSetFba_exAllSp_[nid] += fbaIncrement_exAllSP;
-                }
+    // compute the XVAs, in parallel over the netting sets
+
+    QuantExt::ChunkWorkers workers(nThreads_);
+    workers.run(nettingSets.size(), [&](const Size i) {
+        for (auto t : nettingSetTrades[i])
+            compute(trades[t], *tradeExposureCube_, tradeEpeIndex_, tradeEneIndex_);
+        compute(nettingSets[i], *nettingSetExposureCube_, nettingSetEpeIndex_, nettingSetEneIndex_);
+    });
+
+    // store the results, in the order of the sequential calculation
+
+    for (Size t = 0; t < trades.size(); ++t) {
+        const XvaItem& item = trades[t];
+        const string& tid = item.id;
+        if (item.initialised) {
+            tradeCva_[tid] = item.cva;
+            tradeDva_[tid] = item.dva;
+            tradeFca_[tid] = item.fca;
+            tradeFca_exOwnSp_[tid] = item.fcaExOwnSp;
+            tradeFca_exAllSp_[tid] = item.fcaExAllSp;
+            tradeFba_[tid] = item.fba;
+            tradeFba_exOwnSp_[tid] = item.fbaExOwnSp;
+            tradeFba_exAllSp_[tid] = item.fbaExAllSp;
+            tradeMva_[tid] = 0.0;
+        }
+        if (item.error.empty()) {
+            const string& nid = tradeNettingSet[t];
+            if (nettingSetSumCva_.find(nid) == nettingSetSumCva_.end()) {
+                nettingSetSumCva_[nid] = 0.0;
+                nettingSetSumDva_[nid] = 0.0;
             }
-        } catch (const std::exception& e) {
-            StructuredAnalyticsErrorMessage("ValueAdjustmentCalculator", "Error processing netting set.", e.what(),
+            nettingSetSumCva_[nid] += item.cva;
+            nettingSetSumDva_[nid] += item.dva;
+        } else {
+            StructuredAnalyticsErrorMessage("ValueAdjustmentCalculator", "Error processing trade.", item.error,
+                                            {{"tradeId", tid}})
+                .log();
+        }
+    }
+
+    for (const auto& item : nettingSets) {
+        const string& nid = item.id;
+        if (item.initialised) {
+            nettingSetCva_[nid] = item.cva;
+            nettingSetDva_[nid] = item.dva;
+            nettingSetFca_[nid] = item.fca;
+            nettingSetFca_exOwnSp_[nid] = item.fcaExOwnSp;
+            nettingSetFca_exAllSp_[nid] = item.fcaExAllSp;
+            nettingSetFba_[nid] = item.fba;
+            nettingSetFba_exOwnSp_[nid] = item.fbaExOwnSp;
+            nettingSetFba_exAllSp_[nid] = item.fbaExAllSp;
+            nettingSetMva_[nid] = item.mva;
+        }
+        if (!item.error.empty()) {
+            StructuredAnalyticsErrorMessage("ValueAdjustmentCalculator", "Error processing netting set.", item.error,
                                             {{"nettingSetId", nid}})
                 .log();
         }
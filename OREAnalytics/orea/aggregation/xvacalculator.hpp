@@ -84,36 +84,20 @@ public:
         //! Postfix for flipView borrowing curve for fva
         const string& flipViewBorrowingCurvePostfix = "_BORROW",
 	//! Postfix for flipView lending curve for fva
-	const string& flipViewLendingCurvePostfix = "_LEND");
+	const string& flipViewLendingCurvePostfix = "_LEND",
+        //! Number of threads, the netting sets are processed in parallel
+        const Size nThreads = 1);
 
     virtual ~ValueAdjustmentCalculator() {}
 
-    //! Compute cva along all paths and fill result structures
+    /*! Compute cva along all paths and fill result structures. The survival probabilities and funding spreads on the
+        cube dates are computed once per name, the netting sets and their trades are then processed in parallel. */
     virtual void build();
 
     virtual const vector<Date>& dates() { return tradeExposureCube_->dates(); };
 
     virtual const Date asof() { return market_->asofDate(); };
 
-    virtual const Real calculateCvaIncrement(const string& tid, const string& cid,
-                                             const Date& d0, const Date& d1, const Real& rr) = 0;
-    virtual const Real calculateDvaIncrement(const string& tid,
-                                             const Date& d0, const Date& d1, const Real& rr) = 0;
-    virtual const Real calculateNettingSetCvaIncrement(
-        const string& nid, const string& cid, const Date& d0, const Date& d1, const Real& rr) = 0;
-    virtual const Real calculateNettingSetDvaIncrement(
-        const string& nid, const Date& d0, const Date& d1, const Real& rr) = 0;
-    virtual const Real calculateFbaIncrement(const string& tid, const string& cid, const string& dvaName,
-                                             const Date& d0, const Date& d1, const Real& dcf) = 0;
-    virtual const Real calculateFcaIncrement(const string& tid, const string& cid, const string& dvaName,
-                                             const Date& d0, const Date& d1, const Real& dcf) = 0;
-    virtual const Real calculateNettingSetFbaIncrement(const string& nid, const string& cid, const string& dvaName,
-                                                       const Date& d0, const Date& d1, const Real& dcf) = 0;
-    virtual const Real calculateNettingSetFcaIncrement(const string& nid, const string& cid, const string& dvaName,
-                                                       const Date& d0, const Date& d1, const Real& dcf) = 0;
-    virtual const Real calculateNettingSetMvaIncrement(const string& nid, const string& cid,
-                                                       const Date& d0, const Date& d1, const Real& dcf) = 0;
-
     //! CVA map for all the trades
     const map<string, Real>& tradeCva();
 
@@ -193,6 +177,19 @@ public:
     const Real& nettingSetMva(const string& nettingSet);
 
 protected:
+    /*! Number of samples per date in the arrays below: 1 if the XVA is computed from the expected exposures and
+        deterministic credit, the number of paths if it is computed from the pathwise exposures and survival
+        probabilities. */
+    virtual Size samples() const = 0;
+
+    /*! Survival probabilities of the given name as of today (row 0) and on the cube dates (rows 1, 2, ...), stored
+        row-wise with samples() entries per row. This is called once per name in build(). */
+    virtual vector<Real> survivalProbabilities(const string& name) = 0;
+
+    /*! Initial margin of the netting set on the cube dates, stored row-wise with samples() entries per row. This is
+        called once per netting set in build() if there is a dynamic initial margin calculator. */
+    virtual vector<Real> initialMargin(const string& nid) = 0;
+
     QuantLib::ext::shared_ptr<Portfolio> portfolio_;
     QuantLib::ext::shared_ptr<Market> market_;
     string configuration_;
@@ -211,6 +208,7 @@ protected:
     bool flipViewXVA_;
     string flipViewBorrowingCurvePostfix_;
     string flipViewLendingCurvePostfix_;
+    Size nThreads_;
 
     map<string, string> nettingSetCpty_;
     // For each trade: values
@@ -0,0 +1,129 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/aggregation/xvaconvergence.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ore {
+namespace analytics {
+
+using QuantLib::Real;
+using QuantLib::Size;
+
+XvaConvergenceMonitor::XvaConvergenceMonitor(const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                                             const QuantLib::ext::shared_ptr<CubeInterpretation>& cubeInterpretation,
+                                             const std::map<std::string, NettingSet>& nettingSets,
+                                             const Real confidenceLevel, const Real relativeTolerance,
+                                             const Real absoluteTolerance)
+    : cube_(cube), cubeInterpretation_(cubeInterpretation), nettingSets_(nettingSets),
+      relativeTolerance_(relativeTolerance), absoluteTolerance_(absoluteTolerance) {
+    QL_REQUIRE(cube_, "XvaConvergenceMonitor: no cube given");
+    QL_REQUIRE(cubeInterpretation_, "XvaConvergenceMonitor: no cube interpretation given");
+    QL_REQUIRE(confidenceLevel > 0.0 && confidenceLevel < 1.0,
+               "XvaConvergenceMonitor: confidence level (" << confidenceLevel << ") must be in (0, 1)");
+    QL_REQUIRE(relativeTolerance_ >= 0.0 && absoluteTolerance_ >= 0.0,
+               "XvaConvergenceMonitor: tolerances must be non-negative");
+    quantile_ = QuantLib::InverseCumulativeNormal()(0.5 + 0.5 * confidenceLevel);
+    for (auto const& [id, n] : nettingSets_) {
+        for (auto const* w : {&n.cvaWeights, &n.dvaWeights, &n.epeWeights}) {
+            QL_REQUIRE(w->empty() || w->size() == cube_->numDates(),
+                       "XvaConvergenceMonitor: netting set " << id << " has " << w->size() << " weights, expected "
+                                                             << cube_->numDates());
+        }
+        for (auto i : n.tradeIndices)
+            QL_REQUIRE(i < cube_->numIds(), "XvaConvergenceMonitor: trade index " << i << " of netting set " << id
+                                                                                  << " out of range");
+        statistics_[id] = NettingSetStatistics();
+    }
+}
+
+void XvaConvergenceMonitor::update(const Size firstSample, const Size endSample) {
+    QL_REQUIRE(firstSample <= endSample && endSample <= cube_->samples(),
+               "XvaConvergenceMonitor::update(): invalid sample range [" << firstSample << ", " << endSample
+                                                                        << ") for a cube with " << cube_->samples()
+                                                                        << " samples");
+    std::vector<Real> value(cube_->numDates());
+    for (auto const& [id, n] : nettingSets_) {
+        Moments& cva = cva_[id];
+        Moments& dva = dva_[id];
+        Moments& epe = epe_[id];
+        for (Size k = firstSample; k < endSample; ++k) {
+            std::fill(value.begin(), value.end(), 0.0);
+            for (auto i : n.tradeIndices) {
+                for (Size j = 0; j < value.size(); ++j)
+                    value[j] += cubeInterpretation_->getDefaultNpv(cube_, i, j, k);
+            }
+            Real c = 0.0, d = 0.0, e = 0.0;
+            for (Size j = 0; j < value.size(); ++j) {
+                Real pos = std::max(value[j], 0.0), neg = std::max(-value[j], 0.0);
+                if (!n.cvaWeights.empty())
+                    c += n.cvaWeights[j] * pos;
+                if (!n.dvaWeights.empty())
+                    d += n.dvaWeights[j] * neg;
+                if (!n.epeWeights.empty())
+                    e += n.epeWeights[j] * pos;
+            }
+            cva.sum += c;
+            cva.sumSquares += c * c;
+            dva.sum += d;
+            dva.sumSquares += d * d;
+            epe.sum += e;
+            epe.sumSquares += e * e;
+        }
+    }
+    samples_ += endSample - firstSample;
+    for (auto const& [id, n] : nettingSets_) {
+        auto& s = statistics_[id];
+        s.cva = statistic(cva_[id], !n.cvaWeights.empty());
+        s.dva = statistic(dva_[id], !n.dvaWeights.empty());
+        s.epe = statistic(epe_[id], !n.epeWeights.empty());
+    }
+}
+
+XvaConvergenceMonitor::Statistic XvaConvergenceMonitor::statistic(const Moments& m, const bool tracked) const {
+    Statistic s;
+    s.tracked = tracked;
+    if (!tracked) {
+        s.converged = true;
+        return s;
+    }
+    if (samples_ == 0)
+        return s;
+    Real n = static_cast<Real>(samples_);
+    s.estimate = m.sum / n;
+    if (samples_ > 1) {
+        Real variance = std::max((m.sumSquares - n * s.estimate * s.estimate) / (n - 1.0), 0.0);
+        s.standardError = std::sqrt(variance / n);
+        s.halfWidth = quantile_ * s.standardError;
+        s.converged = s.halfWidth <= std::max(relativeTolerance_ * std::abs(s.estimate), absoluteTolerance_);
+    }
+    return s;
+}
+
+bool XvaConvergenceMonitor::converged() const {
+    return std::all_of(statistics_.begin(), statistics_.end(),
+                       [](const auto& s) { return s.second.converged(); });
+}
+
+} // namespace analytics
+} // namespace ore
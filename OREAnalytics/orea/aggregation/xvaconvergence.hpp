@@ -0,0 +1,109 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/aggregation/xvaconvergence.hpp
+    \brief Monte Carlo errors of netting set xva estimates on a partially built cube
+    \ingroup analytics
+*/
+
+#pragma once
+
+#include <orea/cube/cubeinterpretation.hpp>
+#include <orea/cube/npvcube.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Convergence monitor for an adaptive number of samples in the exposure simulation
+/*! Tracks the Monte Carlo estimates and standard errors of the netting set CVA, DVA and EPE on the samples of an NPV
+    cube built so far. With \f$ V_k(t_j) \f$ the sum of the default NPVs of the netting set trades on sample \f$ k \f$
+    and date \f$ t_j \f$ the pathwise values are
+    \f[ CVA_k = \sum_j w^{cva}_j V_k(t_j)^+, \quad DVA_k = \sum_j w^{dva}_j V_k(t_j)^-, \quad
+        EPE_k = \sum_j w^{epe}_j V_k(t_j)^+ \f]
+    With \f$ w^{cva}_j \f$ the loss given default times the counterparty default probability in \f$ (t_{j-1}, t_j] \f$
+    the CVA estimate is the uncollateralised static credit CVA of the post processor, collateral and initial margin
+    are not taken into account.
+
+    A statistic has converged if the half width of its confidence interval is not greater than
+    max(relativeTolerance * |estimate|, absoluteTolerance). Statistics with empty weights are not tracked.
+*/
+class XvaConvergenceMonitor {
+public:
+    //! netting set trades and weights per cube date, empty weights switch off the statistic
+    struct NettingSet {
+        std::vector<QuantLib::Size> tradeIndices;
+        std::vector<QuantLib::Real> cvaWeights;
+        std::vector<QuantLib::Real> dvaWeights;
+        std::vector<QuantLib::Real> epeWeights;
+    };
+
+    struct Statistic {
+        bool tracked = false;
+        QuantLib::Real estimate = 0.0;
+        QuantLib::Real standardError = 0.0;
+        //! half width of the confidence interval
+        QuantLib::Real halfWidth = 0.0;
+        bool converged = false;
+    };
+
+    struct NettingSetStatistics {
+        Statistic cva;
+        Statistic dva;
+        Statistic epe;
+        bool converged() const { return cva.converged && dva.converged && epe.converged; }
+    };
+
+    XvaConvergenceMonitor(const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                          const QuantLib::ext::shared_ptr<CubeInterpretation>& cubeInterpretation,
+                          const std::map<std::string, NettingSet>& nettingSets, const QuantLib::Real confidenceLevel,
+                          const QuantLib::Real relativeTolerance, const QuantLib::Real absoluteTolerance);
+
+    //! add the samples firstSample, ..., endSample - 1 of the cube to the statistics
+    void update(const QuantLib::Size firstSample, const QuantLib::Size endSample);
+
+    //! number of samples added so far
+    QuantLib::Size samples() const { return samples_; }
+    //! true if all netting set statistics have converged
+    bool converged() const;
+    //! statistics on the samples added so far
+    const std::map<std::string, NettingSetStatistics>& statistics() const { return statistics_; }
+
+private:
+    struct Moments {
+        QuantLib::Real sum = 0.0;
+        QuantLib::Real sumSquares = 0.0;
+    };
+    Statistic statistic(const Moments& m, const bool tracked) const;
+
+    QuantLib::ext::shared_ptr<NPVCube> cube_;
+    QuantLib::ext::shared_ptr<CubeInterpretation> cubeInterpretation_;
+    std::map<std::string, NettingSet> nettingSets_;
+    QuantLib::Real quantile_;
+    QuantLib::Real relativeTolerance_;
+    QuantLib::Real absoluteTolerance_;
+    QuantLib::Size samples_ = 0;
+    std::map<std::string, Moments> cva_, dva_, epe_;
+    std::map<std::string, NettingSetStatistics> statistics_;
+};
+
+} // namespace analytics
+} // namespace ore
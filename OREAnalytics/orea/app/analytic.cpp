@@ -83,10 +83,33 @@ Analytic::Analytic(std::unique_ptr<Impl> impl,
 void Analytic::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader,
                            const std::set<std::string>& runTypes) {
     MEM_LOG_USING_LEVEL(ORE_WARNING)
-    if (impl_) {
+    if (!impl_)
+        return;
+    if (!shared_) {
         impl_->runAnalytic(loader, runTypes);
         MEM_LOG_USING_LEVEL(ORE_WARNING)
+        return;
+    }
+    // a shared analytic only runs the requested types that it has not run before
+    std::lock_guard<std::mutex> lock(runMutex_);
+    std::set<std::string> pending;
+    for (auto const& t : types_) {
+        bool requested = runTypes.empty() || runTypes.find(t) != runTypes.end();
+        if (requested && completedTypes_.find(t) == completedTypes_.end())
+            pending.insert(t);
+    }
+    if (pending.empty()) {
+        LOG("Analytic " << label() << ": reuse results of shared analytic for " << to_string(runTypes));
+        return;
     }
+    impl_->runAnalytic(loader, runTypes.empty() ? runTypes : pending);
+    completedTypes_.insert(pending.begin(), pending.end());
+    MEM_LOG_USING_LEVEL(ORE_WARNING)
+}
+
+bool Analytic::hasRun(const std::string& type) const {
+    std::lock_guard<std::mutex> lock(runMutex_);
+    return completedTypes_.find(type) != completedTypes_.end();
 }
 
 void Analytic::setUpConfigurations() {
@@ -39,6 +39,7 @@
 
 #include <boost/any.hpp>
 #include <iostream>
+#include <mutex>
 
 namespace ore {
 namespace analytics {
@@ -147,6 +148,13 @@ public:
 
     std::vector<QuantLib::ext::shared_ptr<Analytic>> allDependentAnalytics() const;
 
+    /*! A shared analytic is requested from the AnalyticsManager and used as a dependent analytic of other analytics
+        at the same time. It runs each of its analytic types once only, later requests of a type reuse the results. */
+    void setShared(const bool shared) { shared_ = shared; }
+    bool shared() const { return shared_; }
+    //! Whether a shared analytic has run the given analytic type already
+    bool hasRun(const std::string& type) const;
+
 protected:
     std::unique_ptr<Impl> impl_;
 
@@ -169,6 +177,11 @@ protected:
     //! This would typically be used when the analytic is being called by another analytic
     //! and that parent/calling analytic will be writing its own set of intermediate reports
     bool writeIntermediateReports_ = true;
+
+private:
+    bool shared_ = false;
+    std::set<std::string> completedTypes_;
+    mutable std::mutex runMutex_;
 };
 
 class Analytic::Impl {
@@ -212,6 +225,16 @@ public:
     std::vector<QuantLib::ext::shared_ptr<Analytic>> allDependentAnalytics() const;
     virtual std::vector<QuantLib::Date> additionalMarketDates() const { return {}; }
 
+    /*! Whether the analytic can be run concurrently with other analytics by the AnalyticsManager. This requires that
+        the analytic works on its own portfolio (Analytic::portfolio()) only, i.e. it does not use the trades of the
+        input portfolio directly, and that it does not modify the inputs. */
+    virtual bool parallelRunSupported() const { return false; }
+
+    /*! Whether the dependent analytic with the given key may be replaced by an analytic of the same types requested
+        from the AnalyticsManager, so that their results are computed once, see Analytic::setShared(). This requires
+        that the analytic does not depend on a configuration of the dependent analytic other than the inputs. */
+    virtual bool shareDependentAnalytic(const std::string& key) const { return false; }
+
 protected:
     QuantLib::ext::shared_ptr<InputParameters> inputs_;
 
@@ -38,6 +38,9 @@ public:
     void runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader,
                      const std::set<std::string>& runTypes = {}) override;
     void setUpConfigurations() override {}
+    /*! the analytic builds its own market and fills the amounts USD of its own copy of the input CRIF from it, it
+        does not modify the inputs and can therefore run concurrently with other analytics, e.g. the SIMM analytic */
+    bool parallelRunSupported() const override { return true; }
 };
 
 class IMScheduleAnalytic : public Analytic {
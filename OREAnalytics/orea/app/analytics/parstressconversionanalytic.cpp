@@ -57,7 +57,8 @@ void ParStressConversionAnalyticImpl::runAnalytic(const QuantLib::ext::shared_pt
         ParStressTestConverter converter(
             inputs_->asof(), analytic()->configurations().todaysMarketParams,
             analytic()->configurations().simMarketParams, analytic()->configurations().sensiScenarioData,
-            analytic()->configurations().curveConfig, analytic()->market(), inputs_->iborFallbackConfig());
+            analytic()->configurations().curveConfig, analytic()->market(), inputs_->iborFallbackConfig(),
+            inputs_->nThreads());
         scenarioData = converter.convertStressScenarioData(scenarioData);
         analytic()->stressTests()[label()]["parStress_ZeroStressData"] = scenarioData;
         LOG("Finished par to zero scenarios conversion");
@@ -21,6 +21,7 @@
 #include <orea/engine/pnlexplainreport.hpp>
 #include <orea/engine/sensitivityreportstream.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
+#include <orea/engine/sensitivityinmemorystream.hpp>
 #include <orea/scenario/scenarioshiftcalculator.hpp>
 #include <orea/scenario/simplescenario.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
@@ -31,6 +32,23 @@ using namespace ore::data;
 namespace ore {
 namespace analytics {
 
+namespace {
+/* Copy of the pnl report, left in the state after writing its last row, so that the explain columns can be added
+   without modifying a pnl report that is shared with the PNL analytic */
+QuantLib::ext::shared_ptr<InMemoryReport> copyPnlReport(const InMemoryReport& report) {
+    auto copy = QuantLib::ext::make_shared<InMemoryReport>();
+    for (QuantLib::Size i = 0; i < report.columns(); ++i)
+        copy->addColumn(report.header(i), report.columnType(i), report.columnPrecision(i));
+    for (QuantLib::Size r = 0; r < report.rows(); ++r) {
+        copy->next();
+        for (QuantLib::Size i = 0; i < report.columns(); ++i)
+            copy->add(report.data(i)[r]);
+    }
+    copy->end();
+    return copy;
+}
+} // namespace
+
 void PnlExplainAnalyticImpl::setUpConfigurations() {
     analytic()->configurations().simulationConfigRequired = true;
     analytic()->configurations().sensitivityConfigRequired = true;
@@ -53,11 +71,23 @@ void PnlExplainAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::da
     auto pnlexplainAnalytic = static_cast<PnlExplainAnalytic*>(analytic());
     QL_REQUIRE(pnlexplainAnalytic, "Analytic must be of type PnlExplainAnalytic");
 
+    // the t0 and t1 valuations are reused if the PNL analytic is run in the same run already, see
+    // shareDependentAnalytic()
     auto pnlAnalytic = dependentAnalytic(pnlLookupKey);
     pnlAnalytic->runAnalytic(loader);
-    auto pnlReport = pnlAnalytic->reports().at("PNL").at("pnl");
+    auto pnlReport = copyPnlReport(*pnlAnalytic->reports().at("PNL").at("pnl"));
 
+    // sensitivities of a shared SENSITIVITY analytic can be reused unless they were filtered by an output threshold
+    // above the one applied below, in which case they are recomputed
+    const QuantLib::Real sensiThreshold = 1e-6;
     auto sensiAnalytic = dependentAnalytic(sensiLookupKey);
+    if (sensiAnalytic->hasRun("SENSITIVITY") && inputs_->sensiThreshold() != QuantLib::Null<QuantLib::Real>() &&
+        inputs_->sensiThreshold() > sensiThreshold) {
+        DLOG("PNL Explain: sensitivity output threshold " << inputs_->sensiThreshold()
+                                                          << " too large to reuse sensitivities, recompute them");
+        sensiAnalytic = AnalyticFactory::instance().build("SENSITIVITY", inputs_).second;
+        QL_REQUIRE(sensiAnalytic, "PNL Explain: could not build SENSITIVITY analytic");
+    }
 
     // Explicitily set the sensi threshold to 0.0 for sensi analysis, this ensures we get a felta entry for each gamma
     // TODO: Pass the threshold into the sensi analytic
@@ -66,8 +96,16 @@ void PnlExplainAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::da
 
     auto sensireport = sensiAnalytic->reports().at("SENSITIVITY").at("sensitivity");
     analytic()->reports()[label_]["sensitivity"] = sensireport;
-    ext::shared_ptr<SensitivityStream> ss = ext::make_shared<SensitivityReportStream>(sensiAnalytic->reports().at("SENSITIVITY").at("sensitivity"));
-    ss = ext::make_shared<FilteredSensitivityStream>(ss, 1e-6);
+
+    /* The explain runs over all risk classes and types, each of which aggregates the sensitivities again. They are
+       therefore parsed from the report and filtered once here, the risk groups then stream them from memory. */
+    FilteredSensitivityStream filtered(ext::make_shared<SensitivityReportStream>(sensireport), sensiThreshold);
+    std::vector<SensitivityRecord> records, batch;
+    filtered.reset();
+    while (filtered.nextBatch(batch) > 0)
+        records.insert(records.end(), batch.begin(), batch.end());
+    auto ss = ext::make_shared<SensitivityInMemoryStream>(records.begin(), records.end());
+    ss->reset();
 
     auto sensiReports = sensiAnalytic->reports();
 
@@ -101,9 +139,9 @@ void PnlExplainAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::da
             scenarioLoader, QuantLib::ext::make_shared<SimpleScenarioFactory>(), adjFactors,
             ReturnConfiguration(), "hs_");
     } else {
-        auto scenarios = buildHistoricalScenarioGenerator(inputs_->historicalScenarioReader(), adjFactors, pnlDates,
-                                                          analytic()->configurations().simMarketParams,
-                                                          analytic()->configurations().todaysMarketParams);
+        scenarios = buildHistoricalScenarioGenerator(inputs_->historicalScenarioReader(), adjFactors, pnlDates,
+                                                     analytic()->configurations().simMarketParams,
+                                                     analytic()->configurations().todaysMarketParams);
     }
 
     auto simMarket = QuantLib::ext::make_shared<ScenarioSimMarket>(
@@ -51,6 +51,10 @@ public:
     virtual void runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader,
                              const std::set<std::string>& runTypes = {}) override;
     virtual void setUpConfigurations() override;
+    //! the sensitivities and the pnl are taken from the SENSITIVITY and PNL analytics if run in the same run
+    bool shareDependentAnalytic(const std::string& key) const override {
+        return key == sensiLookupKey || key == pnlLookupKey;
+    }
 };
 
 class PnlExplainAnalytic : public Analytic {
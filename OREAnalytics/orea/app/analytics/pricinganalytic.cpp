@@ -152,6 +152,8 @@ void PricingAnalyticImpl::runAnalytic(
                     recalibrateModels, analytic()->configurations().curveConfig,
                     analytic()->configurations().todaysMarketParams, ccyConv, inputs_->refDataManager(),
                     *inputs_->iborFallbackConfig(), true, inputs_->dryRun());
+                sensiAnalysis->skipUnaffectedTrades(inputs_->sensiSkipUnaffectedTrades());
+                sensiAnalysis->analyticLinearSensitivities(inputs_->sensiAnalyticLinearTrades());
                 LOG("Single-threaded sensi analysis created");
             }
             else {
@@ -181,22 +183,46 @@ void PricingAnalyticImpl::runAnalytic(
                 }
             }
 
+            // in incremental mode the sensitivity and scenario reports are written block by block while the
+            // sensitivities are generated, this is not possible if the par conversion needs the full cubes
+            auto baseCurrency = sensiAnalysis->simMarketData()->baseCcy();
+            QuantLib::ext::shared_ptr<InMemoryReport> scenarioReport = QuantLib::ext::make_shared<InMemoryReport>();
+            ReportWriter reportWriter(inputs_->reportNaString());
+            bool incremental = inputs_->sensiTradeBlockSize() > 0 && !inputs_->parSensi();
+            if (incremental) {
+                LOG("Sensi analysis - incremental mode with trade block size " << inputs_->sensiTradeBlockSize());
+                reportWriter.addSensitivityReportColumns(*report);
+                reportWriter.addScenarioReportColumns(*scenarioReport);
+                sensiAnalysis->setSensiCubeHandler(
+                    inputs_->sensiTradeBlockSize(),
+                    [this, &reportWriter, &report, &scenarioReport,
+                     &baseCurrency](const QuantLib::ext::shared_ptr<SensitivityCube>& cube) {
+                        reportWriter.writeSensitivityReportRecords(
+                            *report, QuantLib::ext::make_shared<SensitivityCubeStream>(cube, baseCurrency),
+                            inputs_->sensiThreshold());
+                        reportWriter.writeScenarioReportRecords(*scenarioReport, {cube}, inputs_->sensiThreshold());
+                    });
+            } else if (inputs_->sensiTradeBlockSize() > 0) {
+                WLOG("Sensi analysis - trade block size is ignored, since par conversion is enabled");
+            }
+
             LOG("Sensi analysis - generate");
             sensiAnalysis->registerProgressIndicator(QuantLib::ext::make_shared<ProgressLog>("sensitivities", 100, oreSeverity::notice));
             sensiAnalysis->generateSensitivities();
 
-            LOG("Sensi analysis - write sensitivity report in memory");
-            auto baseCurrency = sensiAnalysis->simMarketData()->baseCcy();
-            auto ss = QuantLib::ext::make_shared<SensitivityCubeStream>(sensiAnalysis->sensiCubes(), baseCurrency);
-            ReportWriter(inputs_->reportNaString())
-                .writeSensitivityReport(*report, ss, inputs_->sensiThreshold());
-            analytic()->reports()[type]["sensitivity"] = report;
+            if (incremental) {
+                report->end();
+                scenarioReport->end();
+            } else {
+                LOG("Sensi analysis - write sensitivity report in memory");
+                auto ss = QuantLib::ext::make_shared<SensitivityCubeStream>(sensiAnalysis->sensiCubes(), baseCurrency);
+                reportWriter.writeSensitivityReport(*report, ss, inputs_->sensiThreshold());
 
-            LOG("Sensi analysis - write sensitivity scenario report in memory");
-            QuantLib::ext::shared_ptr<InMemoryReport> scenarioReport = QuantLib::ext::make_shared<InMemoryReport>();
-            ReportWriter(inputs_->reportNaString())
-                .writeScenarioReport(*scenarioReport, sensiAnalysis->sensiCubes(),
-                                     inputs_->sensiThreshold());
+                LOG("Sensi analysis - write sensitivity scenario report in memory");
+                reportWriter.writeScenarioReport(*scenarioReport, sensiAnalysis->sensiCubes(),
+                                                 inputs_->sensiThreshold());
+            }
+            analytic()->reports()[type]["sensitivity"] = report;
             analytic()->reports()[type]["sensitivity_scenario"] = scenarioReport;
 
             auto simmSensitivityConfigReport = QuantLib::ext::make_shared<InMemoryReport>();
@@ -227,7 +253,7 @@ void PricingAnalyticImpl::runAnalytic(
                 auto parCube = QuantLib::ext::make_shared<ZeroToParCube>(sensiAnalysis->sensiCubes(), parConverter, typesDisabled, true);
                 LOG("Sensi analysis - write par sensitivity report in memory");
                 QuantLib::ext::shared_ptr<ParSensitivityCubeStream> pss =
-                    QuantLib::ext::make_shared<ParSensitivityCubeStream>(parCube, baseCurrency);
+                    QuantLib::ext::make_shared<ParSensitivityCubeStream>(parCube, baseCurrency, inputs_->nThreads());
                 // If the stream is going to be reused - wrap it into a buffered stream to gain some
                 // performance. The cost for this is the memory footpring of the buffer.
                 QuantLib::ext::shared_ptr<InMemoryReport> parSensiReport = QuantLib::ext::make_shared<InMemoryReport>();
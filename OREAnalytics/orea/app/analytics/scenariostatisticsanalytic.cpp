@@ -24,6 +24,7 @@
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
 #include <orea/scenario/scenariogeneratortransform.hpp>
+#include <orea/scenario/scenariostatistics.hpp>
 
 #include <ored/model/crossassetmodelbuilder.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
@@ -134,15 +135,22 @@ void ScenarioStatisticsAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr
                                                             analytic()->configurations().simMarketParams)
         : scenarioGenerator_;
 
-        auto statsReport = QuantLib::ext::make_shared<InMemoryReport>();
-    scenarioGenerator->reset();
-        ReportWriter().writeScenarioStatistics(scenarioGenerator, keys, samples_, grid_->valuationDates(),
-                                               *statsReport);
+    /* The statistics are collected on the fly in a single pass over the scenarios, the ranges found there define
+       the buckets of the distributions, which are counted in a second pass, so that no scenario values are stored */
+    auto statistics = QuantLib::ext::make_shared<ScenarioStatisticsGenerator>(
+        scenarioGenerator, keys, grid_->valuationDates(), inputs_->scenarioStatisticsQuantiles());
+    statistics->reset();
+    for (Size i = 0; i < samples_; ++i) {
+        for (auto const& d : grid_->valuationDates())
+            std::ignore = statistics->next(d);
+    }
+    auto statsReport = QuantLib::ext::make_shared<InMemoryReport>();
+    ReportWriter().writeScenarioStatistics(*statistics, *statsReport);
     analytic()->reports()["SCENARIO_STATISTICS"]["scenario_statistics"] = statsReport;
 
     auto distributionReport = QuantLib::ext::make_shared<InMemoryReport>();
     scenarioGenerator->reset();
-    ReportWriter().writeScenarioDistributions(scenarioGenerator, keys, samples_, grid_->valuationDates(),
+    ReportWriter().writeScenarioDistributions(scenarioGenerator, *statistics, samples_,
                                               inputs_->scenarioDistributionSteps(), *distributionReport);
     analytic()->reports()["SCENARIO_STATISTICS"]["scenario_distribution"] = distributionReport;
 }
@@ -37,6 +37,8 @@ public:
     void runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader,
                      const std::set<std::string>& runTypes = {}) override;
     void setUpConfigurations() override;
+    //! not run concurrently with other analytics, the run updates the bucket mapper of the inputs from the CRIF
+    bool parallelRunSupported() const override { return false; }
 };
 
 class SimmAnalytic : public Analytic {
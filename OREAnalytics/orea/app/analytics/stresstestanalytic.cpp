@@ -75,7 +75,8 @@ void StressTestAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::da
             ParStressTestConverter converter(
             inputs_->asof(), analytic()->configurations().todaysMarketParams,
             analytic()->configurations().simMarketParams, analytic()->configurations().sensiScenarioData,
-            analytic()->configurations().curveConfig, analytic()->market(), inputs_->iborFallbackConfig());
+            analytic()->configurations().curveConfig, analytic()->market(), inputs_->iborFallbackConfig(),
+            inputs_->nThreads());
             scenarioData = converter.convertStressScenarioData(scenarioData);
             analytic()->stressTests()[label()]["stress_ZeroStressData"] = scenarioData;
         } catch(const std::exception& e){
@@ -88,11 +89,22 @@ void StressTestAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::da
     std::string marketConfig = inputs_->marketConfig("pricing");
     std::vector<QuantLib::ext::shared_ptr<ore::data::EngineBuilder>> extraEngineBuilders;
     std::vector<QuantLib::ext::shared_ptr<ore::data::LegBuilder>> extraLegBuilders;
-    QuantLib::ext::shared_ptr<StressTest> stressTest = QuantLib::ext::make_shared<StressTest>(
-        analytic()->portfolio(), analytic()->market(), marketConfig, inputs_->pricingEngine(),
-        analytic()->configurations().simMarketParams, scenarioData, *analytic()->configurations().curveConfig,
-        *analytic()->configurations().todaysMarketParams, nullptr, inputs_->refDataManager(),
-        *inputs_->iborFallbackConfig(), inputs_->continueOnError());
+    QuantLib::ext::shared_ptr<StressTest> stressTest;
+    if (inputs_->nThreads() == 1) {
+        stressTest = QuantLib::ext::make_shared<StressTest>(
+            analytic()->portfolio(), analytic()->market(), marketConfig, inputs_->pricingEngine(),
+            analytic()->configurations().simMarketParams, scenarioData, *analytic()->configurations().curveConfig,
+            *analytic()->configurations().todaysMarketParams, nullptr, inputs_->refDataManager(),
+            *inputs_->iborFallbackConfig(), inputs_->continueOnError(), inputs_->stressSkipUnaffectedTrades());
+    } else {
+        LOG("Multi-threaded stress test with " << inputs_->nThreads() << " threads");
+        stressTest = QuantLib::ext::make_shared<StressTest>(
+            inputs_->nThreads(), inputs_->asof(), loader, analytic()->portfolio(), marketConfig,
+            inputs_->pricingEngine(), analytic()->configurations().simMarketParams, scenarioData,
+            analytic()->configurations().curveConfig, analytic()->configurations().todaysMarketParams,
+            inputs_->refDataManager(), *inputs_->iborFallbackConfig(), inputs_->continueOnError(),
+            inputs_->stressSkipUnaffectedTrades());
+    }
     stressTest->writeReport(report, inputs_->stressThreshold());
     analytic()->reports()[label()]["stress"] = report;
     CONSOLE("OK");
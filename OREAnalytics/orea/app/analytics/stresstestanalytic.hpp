@@ -38,6 +38,7 @@ public:
                      const std::set<std::string>& runTypes = {}) override;
 
     void setUpConfigurations() override;
+    bool parallelRunSupported() const override { return true; }
 };
 
 class StressTestAnalytic : public Analytic {
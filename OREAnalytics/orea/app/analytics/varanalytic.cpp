@@ -173,9 +173,21 @@ void HistoricalSimulationVarAnalyticImpl::setVarReport(
     std::unique_ptr<MarketRiskReport::FullRevalArgs> fullRevalArgs = std::make_unique<MarketRiskReport::FullRevalArgs>(
         simMarket, inputs_->pricingEngine(), inputs_->refDataManager(), *inputs_->iborFallbackConfig());
 
+    // revalue the portfolio under the historical scenarios on several threads, if requested
+    std::unique_ptr<MarketRiskReport::MultiThreadArgs> multiThreadArgs;
+    if (inputs_->nThreads() > 1) {
+        LOG("Use " << inputs_->nThreads() << " threads for the full revaluation");
+        multiThreadArgs = std::make_unique<MarketRiskReport::MultiThreadArgs>(
+            inputs_->nThreads(), inputs_->asof(), loader, inputs_->curveConfigs().get(),
+            analytic()->configurations().todaysMarketParams, Market::defaultConfiguration,
+            analytic()->configurations().simMarketParams, "historical pnl generation", inputs_->mtTradeBlockSize(),
+            inputs_->mtSampleBlockSize());
+    }
+
     varReport_ = ext::make_shared<HistoricalSimulationVarReport>(
         inputs_->baseCurrency(), analytic()->portfolio(), inputs_->portfolioFilter(), 
-        inputs_->varQuantiles(), benchmarkVarPeriod, scenarios, std::move(fullRevalArgs), inputs_->varBreakDown());
+        inputs_->varQuantiles(), benchmarkVarPeriod, scenarios, std::move(fullRevalArgs), inputs_->varBreakDown(),
+        std::move(multiThreadArgs));
 
 }
 
@@ -22,19 +22,29 @@
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
+#include <orea/cube/cubelayout.hpp>
 #include <orea/cube/jointnpvcube.hpp>
 #include <orea/engine/amcvaluationengine.hpp>
 #include <orea/engine/cptycalculator.hpp>
+#include <orea/engine/cubecostestimator.hpp>
 #include <orea/engine/mporcalculator.hpp>
 #include <orea/engine/multistatenpvcalculator.hpp>
 #include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/observationmode.hpp>
+#include <orea/engine/observationmodecalibration.hpp>
 #include <orea/engine/xvaenginecg.hpp>
+#include <orea/scenario/pipelinedscenariogenerator.hpp>
 #include <orea/scenario/scenariowriter.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 
 #include <ored/model/crossassetmodelbuilder.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
+#include <ql/time/daycounters/actualactual.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
+
+#include <boost/timer/timer.hpp>
+
+#include <thread>
 
 using namespace ore::data;
 using namespace boost::filesystem;
@@ -127,6 +137,22 @@ QuantLib::ext::shared_ptr<EngineFactory> XvaAnalyticImpl::engineFactory() {
     return engineFactory_;
 }
 
+void XvaAnalyticImpl::buildOffsetSimMarket() {
+    // Create a third market used for AMC and Postprocessor, holds a larger simmarket, e.g. default curves
+    offsetSimMarket_ = QuantLib::ext::make_shared<ScenarioSimMarket>(
+        analytic()->market(), offsetSimMarketParams_, QuantLib::ext::make_shared<FixingManager>(inputs_->asof()),
+        inputs_->marketConfig("simulation"), *inputs_->curveConfigs().get(),
+        *analytic()->configurations().todaysMarketParams, inputs_->continueOnError(), true, true, false,
+        *inputs_->iborFallbackConfig(), false, offsetScenario_);
+
+    TLOG("XvaAnalytic: Offset Scenario used in building SimMarket");
+    TLOG("XvaAnalytic: Offset scenario is absolute = " << offsetScenario_->isAbsolute());
+    TLOG("RfKey,OffsetScenarioValue");
+    for (const auto& key : offsetScenario_->keys()) {
+        TLOG(key << " : " << offsetScenario_->get(key));
+    }
+}
+
 void XvaAnalyticImpl::buildScenarioSimMarket() {
 
     std::string configuration = inputs_->marketConfig("simulation");
@@ -147,18 +173,7 @@ void XvaAnalyticImpl::buildScenarioSimMarket() {
             *analytic()->configurations().todaysMarketParams, inputs_->continueOnError(), true, true, false,
             *inputs_->iborFallbackConfig(), false, offsetScenario_);
 
-        // Create a third market used for AMC and Postprocessor, holds a larger simmarket, e.g. default curves
-        offsetSimMarket_ = QuantLib::ext::make_shared<ScenarioSimMarket>(
-            analytic()->market(), offsetSimMarketParams_, QuantLib::ext::make_shared<FixingManager>(inputs_->asof()),
-            configuration, *inputs_->curveConfigs().get(), *analytic()->configurations().todaysMarketParams,
-            inputs_->continueOnError(), true, true, false, *inputs_->iborFallbackConfig(), false, offsetScenario_);
-
-        TLOG("XvaAnalytic: Offset Scenario used in building SimMarket");
-        TLOG("XvaAnalytic: Offset scenario is absolute = " << offsetScenario_->isAbsolute());
-        TLOG("RfKey,OffsetScenarioValue");
-        for (const auto& key : offsetScenario_->keys()) {
-            TLOG(key << " : " << offsetScenario_->get(key));
-        }
+        buildOffsetSimMarket();
     }
 
     TLOG("XvaAnalytic:Finished building Scenario SimMarket");
@@ -177,20 +192,50 @@ void XvaAnalyticImpl::buildScenarioSimMarket() {
 void XvaAnalyticImpl::buildScenarioGenerator(const bool continueOnCalibrationError) {
     if (!model_)
         buildCrossAssetModel(continueOnCalibrationError);
-    ScenarioGeneratorBuilder sgb(analytic()->configurations().scenarioGeneratorData);
-    QuantLib::ext::shared_ptr<ScenarioFactory> sf = QuantLib::ext::make_shared<SimpleScenarioFactory>(true);
-    string config = inputs_->marketConfig("simulation");
-    auto market = offsetScenario_ == nullptr ? analytic()->market() : simMarketCalibration_;
-    scenarioGenerator_ =
-        sgb.build(model_, sf, analytic()->configurations().simMarketParams, inputs_->asof(), market, config);
-    QL_REQUIRE(scenarioGenerator_, "failed to build the scenario generator");
     samples_ = analytic()->configurations().scenarioGeneratorData->samples();
+    if (!inputs_->scenarioReplayFile().empty()) {
+        // replay the paths of a previous run instead of simulating the model, the model is still needed for AMC
+        LOG("replay scenarios from store " << inputs_->scenarioReplayFile());
+        auto replay = QuantLib::ext::make_shared<MappedScenarioStoreGenerator>(inputs_->scenarioReplayFile());
+        QL_REQUIRE(replay->asof() == inputs_->asof(), "scenario store asof " << io::iso_date(replay->asof())
+                                                                            << " does not match the run's asof "
+                                                                            << io::iso_date(inputs_->asof()));
+        QL_REQUIRE(replay->dates() == grid_->dates(), "scenario store dates do not match the simulation grid");
+        QL_REQUIRE(replay->samples() >= samples_, "scenario store holds " << replay->samples() << " samples, "
+                                                                          << samples_ << " required");
+        scenarioGenerator_ = replay;
+    } else {
+        ScenarioGeneratorBuilder sgb(analytic()->configurations().scenarioGeneratorData);
+        QuantLib::ext::shared_ptr<ScenarioFactory> sf = QuantLib::ext::make_shared<SimpleScenarioFactory>(true);
+        string config = inputs_->marketConfig("simulation");
+        auto market = offsetScenario_ == nullptr ? analytic()->market() : simMarketCalibration_;
+        scenarioGenerator_ =
+            sgb.build(model_, sf, analytic()->configurations().simMarketParams, inputs_->asof(), market, config);
+    }
+    QL_REQUIRE(scenarioGenerator_, "failed to build the scenario generator");
     LOG("simulation grid size " << grid_->size());
     LOG("simulation grid valuation dates " << grid_->valuationDates().size());
     LOG("simulation grid close-out dates " << grid_->closeOutDates().size());
     LOG("simulation grid front date " << io::iso_date(grid_->dates().front()));
     LOG("simulation grid back date " << io::iso_date(grid_->dates().back()));
 
+    if (inputs_->scenarioPipelineDepth() > 0 && inputs_->scenarioReplayFile().empty()) {
+        LOG("generate scenarios ahead on a separate thread, pipeline depth " << inputs_->scenarioPipelineDepth());
+        scenarioGenerator_ = QuantLib::ext::make_shared<PipelinedScenarioGenerator>(
+            scenarioGenerator_, grid_->dates(), inputs_->scenarioPipelineDepth(), samples_);
+    }
+
+    if (!inputs_->scenarioStoreFile().empty()) {
+        QL_REQUIRE(inputs_->scenarioStoreFile() != inputs_->scenarioReplayFile(),
+                   "scenario store file must differ from the scenario replay file");
+        LOG("write scenarios to store " << inputs_->scenarioStoreFile() << ", double precision " << std::boolalpha
+                                        << inputs_->scenarioStoreDoublePrecision());
+        scenarioStoreWriter_ = QuantLib::ext::make_shared<MappedScenarioStoreWriter>(
+            scenarioGenerator_, inputs_->asof(), grid_->dates(), inputs_->scenarioStoreFile(),
+            inputs_->scenarioStoreDoublePrecision());
+        scenarioGenerator_ = scenarioStoreWriter_;
+    }
+
     if (inputs_->writeScenarios()) {
         auto report = QuantLib::ext::make_shared<InMemoryReport>();
         analytic()->reports()["XVA"]["scenario"] = report;
@@ -209,8 +254,9 @@ void XvaAnalyticImpl::buildCrossAssetModel(const bool continueOnCalibrationError
         inputs_->marketConfig("infcalibration"), inputs_->marketConfig("crcalibration"),
         inputs_->marketConfig("simulation"), false, continueOnCalibrationError, "",
         inputs_->salvageCorrelationMatrix() ? SalvagingAlgorithm::Spectral : SalvagingAlgorithm::None,
-        "xva cam building");
+        "xva cam building", inputs_->nThreads(), lgmStartParams_);
     model_ = *modelBuilder.model();
+    lgmCalibratedParams_ = modelBuilder.lgmCalibratedParams();
 }
 
 void XvaAnalyticImpl::initCubeDepth() {
@@ -229,12 +275,8 @@ void XvaAnalyticImpl::initCube(QuantLib::ext::shared_ptr<NPVCube>& cube, const s
     for (Size i = 0; i < grid_->valuationDates().size(); ++i)
         DLOG("initCube: grid[" << i << "]=" << io::iso_date(grid_->valuationDates()[i]));
 
-    if (cubeDepth == 1)
-        cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(inputs_->asof(), ids, grid_->valuationDates(),
-                                                                       samples_, 0.0f);
-    else
-        cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(inputs_->asof(), ids, grid_->valuationDates(),
-                                                                        samples_, cubeDepth, 0.0f);
+    cube = createSinglePrecisionCube(inputs_->asof(), ids, grid_->valuationDates(), samples_, cubeDepth,
+                                     sparseCubeIds_);
 }
 
 void XvaAnalyticImpl::initClassicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) {
@@ -243,11 +285,21 @@ void XvaAnalyticImpl::initClassicRun(const QuantLib::ext::shared_ptr<Portfolio>&
 
     initCubeDepth();
 
+    if (inputs_->cubeLayout() == "Auto") {
+        LOG("XVA: Select the trades stored in a sparse cube");
+        sparseCubeIds_ = selectSparseCubeIds(*portfolio, *grid_, *cubeInterpreter_, cubeDepth_,
+                                             inputs_->sparseCubeMaxOccupancy());
+    } else {
+        QL_REQUIRE(inputs_->cubeLayout() == "Dense",
+                   "invalid cube layout '" << inputs_->cubeLayout() << "', expected Dense or Auto");
+    }
+
     // May have been set already
     if (scenarioData_.empty()) {
         LOG("XVA: Create asd " << grid_->valuationDates().size() << " x " << samples_);
         scenarioData_.linkTo(
-            QuantLib::ext::make_shared<InMemoryAggregationScenarioData>(grid_->valuationDates().size(), samples_));
+            QuantLib::ext::make_shared<DoublePrecisionAggregationScenarioData>(grid_->valuationDates().size(),
+                                                                               samples_));
         simMarket_->aggregationScenarioData() = *scenarioData_;
     }
 
@@ -308,42 +360,347 @@ XvaAnalyticImpl::classicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfoli
     return classicPortfolio_;
 }
 
-void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) {
+void XvaAnalyticImpl::estimateClassicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) {
+    LOG("XVA: estimateClassicRun");
 
-    LOG("XVA::buildCube");
+    const string msg = "XVA: Cost Estimation";
+    CONSOLEW(msg);
+    ProgressMessage(msg, 0, 1).log();
 
-    // set up valuation calculator factory
-    auto calculators = [this]() {
-        vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
-        if (analytic()->configurations().scenarioGeneratorData->withCloseOutLag()) {
-            QuantLib::ext::shared_ptr<NPVCalculator> npvCalc =
-                QuantLib::ext::make_shared<NPVCalculator>(inputs_->exposureBaseCurrency());
-            calculators.push_back(QuantLib::ext::make_shared<MPORCalculator>(
-                npvCalc, cubeInterpreter_->defaultDateNpvIndex(), cubeInterpreter_->closeOutDateNpvIndex()));
-        } else
-            calculators.push_back(QuantLib::ext::make_shared<NPVCalculator>(inputs_->exposureBaseCurrency()));
-        if (inputs_->storeFlows())
-            calculators.push_back(QuantLib::ext::make_shared<CashflowCalculator>(
-                inputs_->exposureBaseCurrency(), inputs_->asof(), grid_, cubeInterpreter_->mporFlowsIndex()));
-        if (inputs_->storeCreditStateNPVs() > 0) {
-            calculators.push_back(QuantLib::ext::make_shared<MultiStateNPVCalculator>(
-                inputs_->exposureBaseCurrency(), cubeInterpreter_->creditStateNPVsIndex(),
-                inputs_->storeCreditStateNPVs()));
+    // build the full portfolio, the build time is part of the setup cost of each engine thread
+    boost::timer::cpu_timer timer;
+    classicPortfolio_ = QuantLib::ext::make_shared<Portfolio>(inputs_->buildFailedTrades());
+    portfolio->reset();
+    for (const auto& [tradeId, trade] : portfolio->trades())
+        classicPortfolio_->add(trade);
+    QL_REQUIRE(analytic()->market(), "today's market not set");
+    classicPortfolio_->build(engineFactory(), "analytic/" + label());
+    Date maturityDate = inputs_->asof();
+    if (inputs_->portfolioFilterDate() != Null<Date>())
+        maturityDate = inputs_->portfolioFilterDate();
+    classicPortfolio_->removeMatured(maturityDate);
+    double portfolioBuildTime = static_cast<double>(timer.elapsed().wall) * 1E-9;
+
+    CubeCostEstimate estimate;
+    estimate.dates = grid_->valuationDates().size();
+    estimate.samples = samples_;
+    initCubeDepth();
+    estimate.depth = cubeDepth_;
+    estimate.threads = inputs_->nThreads();
+    estimate.maxThreads = std::max<Size>(std::thread::hardware_concurrency(), inputs_->nThreads());
+    estimate.timeBudget = inputs_->xvaCostEstimationTimeBudget();
+    estimate.estimationSamples = std::min(samples_, inputs_->xvaCostEstimationSamples());
+    estimate.setupTime = simMarketBuildTime_ + portfolioBuildTime;
+
+    QuantLib::ext::shared_ptr<Portfolio> sample;
+    if (!classicPortfolio_->trades().empty()) {
+        // price the stratified sample on the first few samples with the single-threaded engine
+        CubeCostEstimator estimator(classicPortfolio_, inputs_->xvaCostEstimationTradesPerType());
+        sample = estimator.samplePortfolio();
+        for (auto const& [tradeId, trade] : sample->trades())
+            trade->resetPricingStats();
+
+        auto scenarioData =
+            QuantLib::ext::make_shared<InMemoryAggregationScenarioData>(estimate.dates, estimate.estimationSamples);
+        simMarket_->aggregationScenarioData() = scenarioData;
+        QuantLib::ext::shared_ptr<NPVCube> cube;
+        Size samples = samples_;
+        samples_ = estimate.estimationSamples;
+        initCube(cube, sample->ids(), cubeDepth_);
+        samples_ = samples;
+
+        ValuationEngine engine(inputs_->asof(), grid_, simMarket_);
+        timer.start();
+        engine.buildCube(sample, cube, classicCalculators(),
+                         analytic()->configurations().scenarioGeneratorData->withMporStickyDate());
+        estimate.estimationTime = static_cast<double>(timer.elapsed().wall) * 1E-9;
+        estimate.estimationScenarioDataBytes =
+            scenarioData->keys().size() * estimate.dates * estimate.estimationSamples * sizeof(Real);
+
+        estimator.estimate(estimate);
+        Settings::instance().evaluationDate() = inputs_->asof();
+    } else {
+        WLOG("XVA: no trades for the cost estimation");
+    }
+
+    auto report = QuantLib::ext::make_shared<InMemoryReport>();
+    auto summary = QuantLib::ext::make_shared<InMemoryReport>();
+    ReportWriter(inputs_->reportNaString()).writeCubeCostEstimate(*report, *summary, estimate);
+    analytic()->reports()["XVA"]["xva_cost_estimate"] = report;
+    analytic()->reports()["XVA"]["xva_cost_estimate_summary"] = summary;
+
+    CONSOLE("OK");
+    ProgressMessage(msg, 1, 1).log();
+    LOG("XVA: estimateClassicRun completed");
+}
+
+void XvaAnalyticImpl::calibrateObservationMode(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) {
+    LOG("XVA: calibrateObservationMode");
+
+    const string msg = "XVA: Observation Mode Calibration";
+    CONSOLEW(msg);
+    ProgressMessage(msg, 0, 1).log();
+
+    CubeCostEstimator sampler(portfolio, inputs_->observationModelCalibrationTradesPerType());
+    auto sample = sampler.samplePortfolio();
+    Size dates = grid_->valuationDates().size();
+    Size samples = std::min(samples_, inputs_->observationModelCalibrationSamples());
+    QL_REQUIRE(samples > 0, "XVA: observation mode calibration requires a positive number of samples");
+    initCubeDepth();
+    Date maturityDate = inputs_->asof();
+    if (inputs_->portfolioFilterDate() != Null<Date>())
+        maturityDate = inputs_->portfolioFilterDate();
+
+    // scale factors from the calibration run to the full run
+    Real tradeScale = sample->size() > 0 ? static_cast<Real>(portfolio->size()) / sample->size() : 1.0;
+    Real sampleScale = static_cast<Real>(samples_) / samples;
+
+    // the first run under the mode None is the reference for the values of the other modes
+    std::vector<ObservationModeCalibrationRun> runs;
+    QuantLib::ext::shared_ptr<NPVCube> referenceCube;
+    for (auto mode : {ObservationMode::Mode::None, ObservationMode::Mode::Disable, ObservationMode::Mode::Defer,
+                      ObservationMode::Mode::Unregister}) {
+        ObservationModeCalibrationRun run;
+        run.mode = mode;
+        ObservationMode::instance().setMode(mode);
+        try {
+            // the sim market depends on the mode, so we build it and the sample portfolio for each run
+            boost::timer::cpu_timer timer;
+            buildScenarioSimMarket();
+            simMarket_->scenarioGenerator() = scenarioGenerator_;
+            scenarioGenerator_->reset();
+            simMarket_->aggregationScenarioData() =
+                QuantLib::ext::make_shared<InMemoryAggregationScenarioData>(dates, samples);
+            run.simMarketBuildTime = static_cast<double>(timer.elapsed().wall) * 1E-9;
+
+            timer.start();
+            auto calibrationPortfolio = QuantLib::ext::make_shared<Portfolio>(inputs_->buildFailedTrades());
+            sample->reset();
+            for (auto const& [tradeId, trade] : sample->trades())
+                calibrationPortfolio->add(trade);
+            calibrationPortfolio->build(engineFactory(), "analytic/" + label());
+            calibrationPortfolio->removeMatured(maturityDate);
+            run.portfolioBuildTime = static_cast<double>(timer.elapsed().wall) * 1E-9;
+
+            if (!calibrationPortfolio->trades().empty()) {
+                QuantLib::ext::shared_ptr<NPVCube> cube;
+                Size fullSamples = samples_;
+                samples_ = samples;
+                initCube(cube, calibrationPortfolio->ids(), cubeDepth_);
+                samples_ = fullSamples;
+                ValuationEngine engine(inputs_->asof(), grid_, simMarket_);
+                timer.start();
+                engine.buildCube(calibrationPortfolio, cube, classicCalculators(),
+                                 analytic()->configurations().scenarioGeneratorData->withMporStickyDate());
+                run.pricingTime = static_cast<double>(timer.elapsed().wall) * 1E-9;
+                if (referenceCube)
+                    run.maxDifference = maxRelativeDifference(*referenceCube, *cube);
+                else
+                    referenceCube = cube;
+            }
+            run.consistent = run.maxDifference <= inputs_->observationModelCalibrationTolerance();
+        } catch (const std::exception& e) {
+            // a failure of the reference run is a failure of the full run as well
+            if (mode == ObservationMode::Mode::None)
+                throw;
+            WLOG("XVA: observation mode calibration failed for mode " << mode << ": " << e.what());
+            run.consistent = false;
         }
-        return calculators;
-    };
+        Settings::instance().evaluationDate() = inputs_->asof();
+        run.estimatedTime =
+            run.simMarketBuildTime + tradeScale * (run.portfolioBuildTime + sampleScale * run.pricingTime);
+        LOG("XVA: observation mode " << mode << " estimated time " << run.estimatedTime << " max difference "
+                                     << run.maxDifference << (run.consistent ? "" : " (inconsistent)"));
+        if (!run.consistent)
+            WLOG("XVA: observation mode " << mode << " does not reproduce the values of the mode None");
+        runs.push_back(run);
+    }
 
-    // set up cpty calculator factory
+    Size selected = fastestConsistentRun(runs);
+    LOG("XVA: selected observation mode " << runs[selected].mode << " from a calibration on " << sample->size()
+                                          << " trades and " << samples << " samples");
+
+    auto report = QuantLib::ext::make_shared<InMemoryReport>();
+    report->addColumn("ObservationMode", string())
+        .addColumn("SimMarketBuildTime", double(), 6)
+        .addColumn("PortfolioBuildTime", double(), 6)
+        .addColumn("PricingTime", double(), 6)
+        .addColumn("EstimatedTime", double(), 6)
+        .addColumn("MaxRelativeDifference", double(), 12)
+        .addColumn("Consistent", string())
+        .addColumn("Selected", string());
+    for (Size i = 0; i < runs.size(); ++i) {
+        std::ostringstream mode;
+        mode << runs[i].mode;
+        report->next()
+            .add(mode.str())
+            .add(runs[i].simMarketBuildTime)
+            .add(runs[i].portfolioBuildTime)
+            .add(runs[i].pricingTime)
+            .add(runs[i].estimatedTime)
+            .add(runs[i].maxDifference)
+            .add(string(runs[i].consistent ? "true" : "false"))
+            .add(string(i == selected ? "true" : "false"));
+    }
+    report->end();
+    analytic()->reports()["XVA"]["observation_mode_calibration"] = report;
 
-    auto cptyCalculators = [this]() {
-        vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>> cptyCalculators;
-        if (inputs_->storeSurvivalProbabilities()) {
-            string configuration = inputs_->marketConfig("simulation");
-            cptyCalculators.push_back(QuantLib::ext::make_shared<SurvivalProbabilityCalculator>(configuration));
+    // rebuild the sim market under the selected mode for the full run, the trades are rebuilt there as well
+    ObservationMode::instance().setMode(runs[selected].mode);
+    boost::timer::cpu_timer timer;
+    buildScenarioSimMarket();
+    simMarketBuildTime_ = static_cast<double>(timer.elapsed().wall) * 1E-9;
+    scenarioGenerator_->reset();
+    sample->reset();
+
+    CONSOLE("OK");
+    ProgressMessage(msg, 1, 1).log();
+    LOG("XVA: calibrateObservationMode completed");
+}
+
+vector<QuantLib::ext::shared_ptr<ValuationCalculator>> XvaAnalyticImpl::classicCalculators() const {
+    vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
+    if (analytic()->configurations().scenarioGeneratorData->withCloseOutLag()) {
+        QuantLib::ext::shared_ptr<NPVCalculator> npvCalc =
+            QuantLib::ext::make_shared<NPVCalculator>(inputs_->exposureBaseCurrency());
+        calculators.push_back(QuantLib::ext::make_shared<MPORCalculator>(
+            npvCalc, cubeInterpreter_->defaultDateNpvIndex(), cubeInterpreter_->closeOutDateNpvIndex()));
+    } else
+        calculators.push_back(QuantLib::ext::make_shared<NPVCalculator>(inputs_->exposureBaseCurrency()));
+    if (inputs_->storeFlows())
+        calculators.push_back(QuantLib::ext::make_shared<CashflowCalculator>(
+            inputs_->exposureBaseCurrency(), inputs_->asof(), grid_, cubeInterpreter_->mporFlowsIndex()));
+    if (inputs_->storeCreditStateNPVs() > 0) {
+        calculators.push_back(QuantLib::ext::make_shared<MultiStateNPVCalculator>(
+            inputs_->exposureBaseCurrency(), cubeInterpreter_->creditStateNPVsIndex(),
+            inputs_->storeCreditStateNPVs()));
+    }
+    return calculators;
+}
+
+vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>> XvaAnalyticImpl::classicCptyCalculators() const {
+    vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>> cptyCalculators;
+    if (inputs_->storeSurvivalProbabilities()) {
+        string configuration = inputs_->marketConfig("simulation");
+        cptyCalculators.push_back(QuantLib::ext::make_shared<SurvivalProbabilityCalculator>(configuration));
+    }
+    return cptyCalculators;
+}
+
+std::map<std::string, XvaConvergenceMonitor::NettingSet>
+XvaAnalyticImpl::convergenceNettingSets(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) const {
+    auto market = offsetScenario_ == nullptr ? analytic()->market() : offsetSimMarket_;
+    string configuration = inputs_->marketConfig("simulation");
+    const vector<Date>& dates = cube_->dates();
+    Date asof = inputs_->asof();
+
+    // loss given default times the default probability between two cube dates, empty if the curve is not available
+    auto defaultWeights = [&market, &configuration, &dates, &asof](const string& name) {
+        vector<Real> weights;
+        try {
+            auto dts = market->defaultCurve(name, configuration)->curve();
+            Real lgd = 1.0 - market->recoveryRate(name, configuration)->value();
+            Real s0 = dts->survivalProbability(asof);
+            for (auto const& d : dates) {
+                Real s1 = dts->survivalProbability(d);
+                weights.push_back(lgd * (s0 - s1));
+                s0 = s1;
+            }
+        } catch (const std::exception& e) {
+            WLOG("XVA: adaptive samples do not track the value adjustment for " << name << ": " << e.what());
+            weights.clear();
         }
-        return cptyCalculators;
+        return weights;
     };
 
+    // time weights of the EPE averaged over the simulation horizon
+    vector<Real> epeWeights;
+    ActualActual dc(ActualActual::ISDA);
+    Real horizon = dates.empty() ? 0.0 : dc.yearFraction(asof, dates.back());
+    for (Size j = 0; j < dates.size(); ++j)
+        epeWeights.push_back(horizon > 0.0 ? dc.yearFraction(j == 0 ? asof : dates[j - 1], dates[j]) / horizon
+                                           : 1.0 / dates.size());
+
+    vector<Real> dvaWeights;
+    if (inputs_->dvaAnalytic() && !inputs_->dvaName().empty())
+        dvaWeights = defaultWeights(inputs_->dvaName());
+
+    std::map<std::string, XvaConvergenceMonitor::NettingSet> nettingSets;
+    std::map<std::string, vector<Real>> cvaWeights;
+    for (auto const& [tradeId, trade] : portfolio->trades()) {
+        const string& nettingSetId = trade->envelope().nettingSetId();
+        const string& cpty = trade->envelope().counterparty();
+        auto n = nettingSets.find(nettingSetId);
+        if (n == nettingSets.end()) {
+            n = nettingSets.insert(std::make_pair(nettingSetId, XvaConvergenceMonitor::NettingSet())).first;
+            if (inputs_->cvaAnalytic()) {
+                auto w = cvaWeights.find(cpty);
+                if (w == cvaWeights.end())
+                    w = cvaWeights.insert(std::make_pair(cpty, defaultWeights(cpty))).first;
+                n->second.cvaWeights = w->second;
+            }
+            n->second.dvaWeights = dvaWeights;
+            n->second.epeWeights = epeWeights;
+        }
+        n->second.tradeIndices.push_back(cube_->index(tradeId));
+    }
+    return nettingSets;
+}
+
+namespace {
+// copy of the first n samples of a cube, values that are zero are not set to keep sparse cubes sparse
+QuantLib::ext::shared_ptr<NPVCube> truncatedCube(const NPVCube& cube, const Size n,
+                                                 const std::set<std::string>& sparseIds) {
+    std::set<std::string> ids;
+    for (auto const& [id, _] : cube.idsAndIndexes())
+        ids.insert(id);
+    auto result = createSinglePrecisionCube(cube.asof(), ids, cube.dates(), n, cube.depth(), sparseIds);
+    for (auto const& [id, i] : cube.idsAndIndexes()) {
+        Size r = result->index(id);
+        for (Size d = 0; d < cube.depth(); ++d) {
+            result->setT0(cube.getT0(i, d), r, d);
+            for (Size j = 0; j < cube.numDates(); ++j) {
+                for (Size k = 0; k < n; ++k) {
+                    Real v = cube.get(i, j, k, d);
+                    if (v != 0.0)
+                        result->set(v, r, j, k, d);
+                }
+            }
+        }
+    }
+    return result;
+}
+} // namespace
+
+void XvaAnalyticImpl::truncateSamples(const Size n) {
+    QL_REQUIRE(n > 0 && n <= samples_, "XvaAnalyticImpl::truncateSamples(): invalid number of samples " << n);
+    cube_ = truncatedCube(*cube_, n, sparseCubeIds_);
+    if (nettingSetCube_)
+        nettingSetCube_ = truncatedCube(*nettingSetCube_, n, {});
+    if (cptyCube_)
+        cptyCube_ = truncatedCube(*cptyCube_, n, {});
+    if (!scenarioData_.empty()) {
+        auto data = QuantLib::ext::make_shared<DoublePrecisionAggregationScenarioData>(scenarioData_->dimDates(), n);
+        for (auto const& [type, qualifier] : scenarioData_->keys()) {
+            for (Size j = 0; j < scenarioData_->dimDates(); ++j) {
+                for (Size k = 0; k < n; ++k)
+                    data->set(j, k, scenarioData_->get(j, k, type, qualifier), type, qualifier);
+            }
+        }
+        scenarioData_.linkTo(data);
+        simMarket_->aggregationScenarioData() = data;
+    }
+    samples_ = n;
+}
+
+void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) {
+
+    LOG("XVA::buildCube");
+
+    // set up valuation and cpty calculator factories
+    auto calculators = [this]() { return classicCalculators(); };
+    auto cptyCalculators = [this]() { return classicCptyCalculators(); };
+
     // log message
 
     ostringstream o;
@@ -357,16 +714,96 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
                                                                      ConsoleLog::instance().progressBarWidth());
     auto progressLog = QuantLib::ext::make_shared<ProgressLog>("XVA: Building cube", 100, oreSeverity::notice);
 
-    if (inputs_->nThreads() == 1) {
+    // number of trade calculations and pricing time per valuation date
+    std::vector<Size> datePricings;
+    std::vector<double> datePricingTimes;
+
+    // the adaptive run fills the cube in batches, which is supported by the single-threaded engine only
+    bool adaptive = inputs_->xvaAdaptiveSamples() && portfolio->size() > 0;
+    if (adaptive && inputs_->nThreads() != 1) {
+        WLOG("XVA: adaptive samples require nThreads = 1, the cube is built with " << samples_ << " samples");
+        adaptive = false;
+    }
+    if (adaptive && amcPortfolio_ && !amcPortfolio_->trades().empty()) {
+        WLOG("XVA: adaptive samples are not supported with an AMC cube, the cube is built with " << samples_
+                                                                                                << " samples");
+        adaptive = false;
+    }
+
+    if (inputs_->nThreads() == 1 && adaptive) {
+
+        // single-threaded engine run in batches of samples, until the netting set statistics have converged
+
+        QL_REQUIRE(inputs_->xvaAdaptiveSamplesBatchSize() > 0, "XVA: adaptive samples batch size must be positive");
+        XvaConvergenceMonitor monitor(cube_, cubeInterpreter_, convergenceNettingSets(portfolio),
+                                      inputs_->xvaAdaptiveSamplesConfidenceLevel(),
+                                      inputs_->xvaAdaptiveSamplesRelativeTolerance(),
+                                      inputs_->xvaAdaptiveSamplesAbsoluteTolerance());
+        ValuationEngine engine(inputs_->asof(), grid_, simMarket_);
+        engine.registerProgressIndicator(progressBar);
+        engine.registerProgressIndicator(progressLog);
+        engine.groupTradesByPricingEngine(inputs_->xvaGroupTradesByPricingEngine());
+        engine.skipExpiredTrades(inputs_->xvaSkipExpiredTrades());
+        datePricings.assign(cube_->numDates(), 0);
+        datePricingTimes.assign(cube_->numDates(), 0.0);
+        /* The scenario generator and the aggregation scenario data are not reset between the batches, so that each
+           batch continues with the paths of the samples it fills. A run stopping after n samples therefore gives the
+           same results as a run with n samples. */
+        while (monitor.samples() < samples_ && (monitor.samples() == 0 || !monitor.converged())) {
+            Size firstSample = monitor.samples();
+            Size endSample = std::min(firstSample + inputs_->xvaAdaptiveSamplesBatchSize(), samples_);
+            engine.setSampleRange(firstSample, endSample);
+            engine.buildCube(portfolio, cube_, calculators(),
+                             analytic()->configurations().scenarioGeneratorData->withMporStickyDate(), nettingSetCube_,
+                             cptyCube_, cptyCalculators());
+            for (Size j = 0; j < datePricings.size(); ++j) {
+                datePricings[j] += engine.datePricings()[j];
+                datePricingTimes[j] += engine.datePricingTimes()[j];
+            }
+            monitor.update(firstSample, endSample);
+            LOG("XVA: adaptive samples, " << monitor.samples() << " of " << samples_ << " samples done, "
+                                          << (monitor.converged() ? "converged" : "not converged"));
+        }
+
+        auto report = QuantLib::ext::make_shared<InMemoryReport>();
+        report->addColumn("NettingSetId", string()).addColumn("Samples", Size());
+        for (auto const& name : {"CVA", "DVA", "EPE"}) {
+            report->addColumn(string(name), double(), 2)
+                .addColumn(string(name) + "_StdError", double(), 2)
+                .addColumn(string(name) + "_HalfWidth", double(), 2)
+                .addColumn(string(name) + "_Converged", string());
+        }
+        report->addColumn("Converged", string());
+        auto flag = [](const bool b) { return string(b ? "true" : "false"); };
+        for (auto const& [nettingSetId, stats] : monitor.statistics()) {
+            report->next().add(nettingSetId).add(monitor.samples());
+            for (auto const* s : {&stats.cva, &stats.dva, &stats.epe})
+                report->add(s->estimate).add(s->standardError).add(s->halfWidth).add(flag(s->converged));
+            report->add(flag(stats.converged()));
+        }
+        report->end();
+        analytic()->reports()["XVA"]["xva_convergence"] = report;
+
+        if (monitor.converged() && monitor.samples() < samples_) {
+            LOG("XVA: adaptive samples converged after " << monitor.samples() << " of " << samples_ << " samples");
+            truncateSamples(monitor.samples());
+        } else if (!monitor.converged()) {
+            WLOG("XVA: adaptive samples did not converge within " << samples_ << " samples");
+        }
+    } else if (inputs_->nThreads() == 1) {
 
         // single-threaded engine run
 
         ValuationEngine engine(inputs_->asof(), grid_, simMarket_);
         engine.registerProgressIndicator(progressBar);
         engine.registerProgressIndicator(progressLog);
+        engine.groupTradesByPricingEngine(inputs_->xvaGroupTradesByPricingEngine());
+        engine.skipExpiredTrades(inputs_->xvaSkipExpiredTrades());
         engine.buildCube(portfolio, cube_, calculators(),
                          analytic()->configurations().scenarioGeneratorData->withMporStickyDate(), nettingSetCube_,
                          cptyCube_, cptyCalculators());
+        datePricings = engine.datePricings();
+        datePricingTimes = engine.datePricingTimes();
     } else {
 
         // multi-threaded engine run
@@ -377,11 +814,7 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
         auto cubeFactory = [this](const QuantLib::Date& asof, const std::set<std::string>& ids,
                                   const std::vector<QuantLib::Date>& dates,
                                   const Size samples) -> QuantLib::ext::shared_ptr<NPVCube> {
-            if (cubeDepth_ == 1)
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
-            else
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, cubeDepth_,
-                                                                                0.0f);
+            return createSinglePrecisionCube(asof, ids, dates, samples, cubeDepth_, sparseCubeIds_);
         };
 
         std::function<QuantLib::ext::shared_ptr<NPVCube>(const QuantLib::Date&, const std::set<std::string>&,
@@ -408,6 +841,13 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
             cptyCubeFactory, "xva-simulation", offsetScenario_);
 
         engine.setAggregationScenarioData(*scenarioData_);
+        if (inputs_->mtTradeBlockSize() > 0)
+            engine.setWorkStealing(inputs_->mtTradeBlockSize(), inputs_->mtSampleBlockSize());
+        engine.setShareInitMarket(inputs_->mtShareInitMarket());
+        engine.setNumaAware(inputs_->mtNumaAware(), inputs_->mtNumaNodes());
+        engine.setMultiProcess(inputs_->mtMultiProcess());
+        engine.groupTradesByPricingEngine(inputs_->xvaGroupTradesByPricingEngine());
+        engine.skipExpiredTrades(inputs_->xvaSkipExpiredTrades());
         engine.registerProgressIndicator(progressBar);
         engine.registerProgressIndicator(progressLog);
 
@@ -415,6 +855,8 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
                          analytic()->configurations().scenarioGeneratorData->withMporStickyDate());
 
         cube_ = QuantLib::ext::make_shared<JointNPVCube>(engine.outputCubes(), portfolio->ids());
+        datePricings = engine.datePricings();
+        datePricingTimes = engine.datePricingTimes();
 
         if (inputs_->storeSurvivalProbabilities())
             cptyCube_ = QuantLib::ext::make_shared<JointNPVCube>(
@@ -422,6 +864,11 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
                 [](Real a, Real x) { return std::max(a, x); }, 0.0);
     }
 
+    auto pricingStatsReport = QuantLib::ext::make_shared<InMemoryReport>();
+    ReportWriter(inputs_->reportNaString())
+        .writePricingStatsByDate(*pricingStatsReport, grid_->valuationDates(), datePricings, datePricingTimes);
+    analytic()->reports()["XVA"]["pricingstats_dates"] = pricingStatsReport;
+
     CONSOLE("OK");
 
     LOG("XVA::buildCube done");
@@ -494,7 +941,8 @@ void XvaAnalyticImpl::amcRun(bool doClassicRun) {
     if (scenarioData_.empty()) {
         LOG("XVA: Create asd " << grid_->valuationDates().size() << " x " << samples_);
         scenarioData_.linkTo(
-            QuantLib::ext::make_shared<InMemoryAggregationScenarioData>(grid_->valuationDates().size(), samples_));
+            QuantLib::ext::make_shared<DoublePrecisionAggregationScenarioData>(grid_->valuationDates().size(),
+                                                                               samples_));
         simMarket_->aggregationScenarioData() = *scenarioData_;
     }
 
@@ -514,7 +962,8 @@ void XvaAnalyticImpl::amcRun(bool doClassicRun) {
         AMCValuationEngine amcEngine(model_, inputs_->scenarioGeneratorData(), market,
                                      inputs_->exposureSimMarketParams()->additionalScenarioDataIndices(),
                                      inputs_->exposureSimMarketParams()->additionalScenarioDataCcys(),
-                                     inputs_->exposureSimMarketParams()->additionalScenarioDataNumberOfCreditStates());
+                                     inputs_->exposureSimMarketParams()->additionalScenarioDataNumberOfCreditStates(),
+                                     inputs_->amcSinglePrecisionPaths(), inputs_->amcProjectModel());
         amcEngine.registerProgressIndicator(progressBar);
         amcEngine.registerProgressIndicator(progressLog);
         if (!scenarioData_.empty())
@@ -524,11 +973,7 @@ void XvaAnalyticImpl::amcRun(bool doClassicRun) {
         auto cubeFactory = [this](const QuantLib::Date& asof, const std::set<std::string>& ids,
                                   const std::vector<QuantLib::Date>& dates,
                                   const Size samples) -> QuantLib::ext::shared_ptr<NPVCube> {
-            if (cubeDepth_ == 1)
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
-            else
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, cubeDepth_,
-                                                                                0.0f);
+            return createSinglePrecisionCube(asof, ids, dates, samples, cubeDepth_, sparseCubeIds_);
         };
 
         auto simMarketParams =
@@ -544,7 +989,8 @@ void XvaAnalyticImpl::amcRun(bool doClassicRun) {
             inputs_->marketConfig("fxcalibration"), inputs_->marketConfig("eqcalibration"),
             inputs_->marketConfig("infcalibration"), inputs_->marketConfig("crcalibration"),
             inputs_->marketConfig("simulation"), inputs_->refDataManager(), *inputs_->iborFallbackConfig(), true,
-            cubeFactory, offsetScenario_, simMarketParams);
+            cubeFactory, offsetScenario_, simMarketParams, inputs_->amcSinglePrecisionPaths(),
+            inputs_->amcProjectModel());
 
         amcEngine.registerProgressIndicator(progressBar);
         amcEngine.registerProgressIndicator(progressLog);
@@ -652,7 +1098,8 @@ void XvaAnalyticImpl::runPostProcessor() {
         kvaTheirPdFloor, kvaOurCvaRiskWeight, kvaTheirCvaRiskWeight, cptyCube_, flipViewBorrowingCurvePostfix,
         flipViewLendingCurvePostfix, inputs_->creditSimulationParameters(), inputs_->creditMigrationDistributionGrid(),
         inputs_->creditMigrationTimeSteps(), creditStateCorrelationMatrix(),
-        analytic()->configurations().scenarioGeneratorData->withMporStickyDate(), inputs_->mporCashFlowMode());
+        analytic()->configurations().scenarioGeneratorData->withMporStickyDate(), inputs_->mporCashFlowMode(),
+        inputs_->nThreads(), inputs_->pfeQuantileCompression());
     LOG("post done");
 }
 
@@ -671,9 +1118,14 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
             inputs_->xvaCgSensiScenarioData(), inputs_->refDataManager(), *inputs_->iborFallbackConfig(),
             inputs_->xvaCgBumpSensis(), inputs_->xvaCgUseExternalComputeDevice(),
             inputs_->xvaCgExternalDeviceCompatibilityMode(), inputs_->xvaCgUseDoublePrecisionForExternalCalculation(),
-            inputs_->xvaCgExternalComputeDevice(), true, true);
+            inputs_->xvaCgExternalComputeDevice(), true, true, "xva engine cg", inputs_->xvaCgCheckpointInterval(),
+            inputs_->xvaCgExternalValidationTolerance(), inputs_->xvaCgRegressionOnExternalDevice(),
+            inputs_->nettingSetManager(), inputs_->dvaAnalytic() ? inputs_->dvaName() : std::string(),
+            inputs_->fvaAnalytic() ? inputs_->fvaBorrowingCurve() : std::string(),
+            inputs_->fvaAnalytic() ? inputs_->fvaLendingCurve() : std::string());
 
         analytic()->reports()["XVA"]["xvacg-exposure"] = engine.exposureReport();
+        analytic()->reports()["XVA"]["xvacg-xva"] = engine.xvaReport();
         if (inputs_->xvaCgSensiScenarioData())
             analytic()->reports()["XVA"]["xvacg-cva-sensi-scenario"] = engine.sensiReport();
         return;
@@ -689,7 +1141,9 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
         runXva_ = true;
 
     Settings::instance().evaluationDate() = inputs_->asof();
-    ObservationMode::instance().setMode(inputs_->exposureObservationModel());
+    // the mode "Auto" is resolved by a calibration run once the scenario generator is available
+    bool calibrateMode = inputs_->exposureObservationModel() == "Auto";
+    ObservationMode::instance().setMode(calibrateMode ? "Disable" : inputs_->exposureObservationModel());
 
     const string msg = "XVA: Build Today's Market";
     LOG(msg);
@@ -705,14 +1159,33 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
         grid_, inputs_->storeCreditStateNPVs(), inputs_->flipViewXVA());
 
     if (runSimulation_) {
-        LOG("XVA: Build simulation market");
-        buildScenarioSimMarket();
+        {
+            QuantExt::MemoryStage memoryStage("XVA: Simulation Market");
+            LOG("XVA: Build simulation market");
+            boost::timer::cpu_timer timer;
+            buildScenarioSimMarket();
+            simMarketBuildTime_ = static_cast<double>(timer.elapsed().wall) * 1E-9;
+
+            LOG("XVA: Build Scenario Generator");
+            auto globalParams = inputs_->simulationPricingEngine()->globalParameters();
+            auto continueOnCalErr = globalParams.find("ContinueOnCalibrationError");
+            bool continueOnErr = (continueOnCalErr != globalParams.end()) && parseBool(continueOnCalErr->second);
+            buildScenarioGenerator(continueOnErr);
+        }
 
-        LOG("XVA: Build Scenario Generator");
-        auto globalParams = inputs_->simulationPricingEngine()->globalParameters();
-        auto continueOnCalErr = globalParams.find("ContinueOnCalibrationError");
-        bool continueOnErr = (continueOnCalErr != globalParams.end()) && parseBool(continueOnCalErr->second);
-        buildScenarioGenerator(continueOnErr);
+        if (calibrateMode) {
+            // the AMC trades are priced against the model, not the sim market, so we calibrate on the other trades
+            auto classicTrades = QuantLib::ext::make_shared<Portfolio>(inputs_->buildFailedTrades());
+            for (auto const& [tradeId, trade] : inputs_->portfolio()->trades()) {
+                if (!inputs_->amc() ||
+                    inputs_->amcTradeTypes().find(trade->tradeType()) == inputs_->amcTradeTypes().end())
+                    classicTrades->add(trade);
+            }
+            if (!classicTrades->trades().empty()) {
+                QuantExt::MemoryStage memoryStage("XVA: Observation Mode Calibration");
+                calibrateObservationMode(classicTrades);
+            }
+        }
 
         LOG("XVA: Attach Scenario Generator to ScenarioSimMarket");
         simMarket_->scenarioGenerator() = scenarioGenerator_;
@@ -744,19 +1217,35 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
                 residualPortfolio->add(trade);
         }
 
+        if (inputs_->xvaCostEstimation()) {
+            if (doAmcRun)
+                WLOG("XVA: the cost estimation covers the classic run only, the "
+                     << amcPortfolio_->size() << " AMC trades are not included");
+            {
+                QuantExt::MemoryStage memoryStage("XVA: Cost Estimation");
+                estimateClassicRun(residualPortfolio);
+            }
+            LOG("XVA: cost estimation completed, cube generation and aggregation are skipped");
+            ObservationMode::instance().setMode(inputs_->observationModel());
+            ProgressMessage("Running XVA Analytic", 1, 1).log();
+            return;
+        }
+
         /********************************************************************************
          * This is where we build cubes and the "classic" valuation work is done
          * The bulk of the AMC work is done before in the AMC portfolio building/training
          ********************************************************************************/
 
-        if (doAmcRun)
+        if (doAmcRun) {
+            QuantExt::MemoryStage memoryStage("XVA: AMC Cube");
             amcRun(doClassicRun);
-        else
+        } else
             amcPortfolio_ = QuantLib::ext::make_shared<Portfolio>(inputs_->buildFailedTrades());
 
-        if (doClassicRun)
+        if (doClassicRun) {
+            QuantExt::MemoryStage memoryStage("XVA: Classic Cube");
             classicPortfolio_ = classicRun(residualPortfolio);
-        else
+        } else
             classicPortfolio_ = QuantLib::ext::make_shared<Portfolio>(inputs_->buildFailedTrades());
 
         /***************************************************
@@ -775,6 +1264,13 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
 
         LOG("NPV cube generation completed");
 
+        if (scenarioStoreWriter_) {
+            scenarioStoreWriter_->close();
+            if (scenarioStoreWriter_->samples() < samples_)
+                WLOG("scenario store " << inputs_->scenarioStoreFile() << " holds " << scenarioStoreWriter_->samples()
+                                       << " samples only, " << samples_ << " expected");
+        }
+
         /***********************************************************************
          * We may have two non-empty portfolios to be merged for post processing
          ***********************************************************************/
@@ -797,20 +1293,33 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
         // build the portfolio linked to today's market
         analytic()->buildPortfolio();
 
+        // the post processor runs against the market holding the offset scenario
+        if (offsetScenario_ != nullptr)
+            buildOffsetSimMarket();
+
         // ... and load a pre-built cube for post-processing
 
         LOG("Skip cube generation, load input cubes for XVA");
         const string msg = "XVA: Load Cubes";
         CONSOLEW(msg);
         ProgressMessage(msg, 0, 1).log();
-        QL_REQUIRE(inputs_->cube(), "XVA without EXPOSURE requires an NPV cube as input");
-        cube_ = inputs_->cube();
-        QL_REQUIRE(inputs_->mktCube(), "XVA without EXPOSURE requires a market cube as input");
-        scenarioData_.linkTo(inputs_->mktCube());
-        if (inputs_->nettingSetCube())
-            nettingSetCube_ = inputs_->nettingSetCube();
-        if (inputs_->cptyCube())
-            cptyCube_ = inputs_->cptyCube();
+        if (inputCube_) {
+            LOG("XVA: use the given cubes");
+            QL_REQUIRE(inputScenarioData_, "XVA without EXPOSURE requires a market cube with the given NPV cube");
+            cube_ = inputCube_;
+            scenarioData_.linkTo(inputScenarioData_);
+            nettingSetCube_ = inputNettingSetCube_;
+            cptyCube_ = inputCptyCube_;
+        } else {
+            QL_REQUIRE(inputs_->cube(), "XVA without EXPOSURE requires an NPV cube as input");
+            cube_ = inputs_->cube();
+            QL_REQUIRE(inputs_->mktCube(), "XVA without EXPOSURE requires a market cube as input");
+            scenarioData_.linkTo(inputs_->mktCube());
+            if (inputs_->nettingSetCube())
+                nettingSetCube_ = inputs_->nettingSetCube();
+            if (inputs_->cptyCube())
+                cptyCube_ = inputs_->cptyCube();
+        }
         CONSOLE("OK");
         ProgressMessage(msg, 1, 1).log();
     }
@@ -846,7 +1355,10 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
         string msg = "XVA: Aggregation";
         CONSOLEW(msg);
         ProgressMessage(msg, 0, 1).log();
-        runPostProcessor();
+        {
+            QuantExt::MemoryStage memoryStage("XVA: Aggregation");
+            runPostProcessor();
+        }
         CONSOLE("OK");
         ProgressMessage(msg, 1, 1).log();
 
@@ -22,7 +22,11 @@
 
 #pragma once
 
+#include <orea/aggregation/xvaconvergence.hpp>
 #include <orea/app/analytic.hpp>
+#include <orea/engine/cptycalculator.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/scenario/mappedscenariostore.hpp>
 
 namespace ore {
 namespace analytics {
@@ -46,9 +50,35 @@ public:
 
     void checkConfigurations(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
 
+    /*! start values for the calibration of the IR LGM components of the simulation model, e.g. the calibrated
+        parameters of a base scenario run, see lgmCalibratedParams() */
+    void setLgmStartParams(const std::map<std::string, Array>& params) { lgmStartParams_ = params; }
+    //! calibrated parameters of the IR LGM components of the simulation model, available after the model is built
+    const std::map<std::string, Array>& lgmCalibratedParams() const { return lgmCalibratedParams_; }
+
+    /*! cubes for a run without EXPOSURE, e.g. the cubes of a base scenario run, used instead of the input cubes. If
+        an offset scenario is given, the post processor runs against the sim market holding the offset scenario. */
+    void setInputCubes(const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                       const QuantLib::ext::shared_ptr<AggregationScenarioData>& scenarioData,
+                       const QuantLib::ext::shared_ptr<NPVCube>& nettingSetCube = nullptr,
+                       const QuantLib::ext::shared_ptr<NPVCube>& cptyCube = nullptr) {
+        inputCube_ = cube;
+        inputScenarioData_ = scenarioData;
+        inputNettingSetCube_ = nettingSetCube;
+        inputCptyCube_ = cptyCube;
+    }
+    //! cubes generated resp. loaded by the last run
+    const QuantLib::ext::shared_ptr<NPVCube>& cube() const { return cube_; }
+    QuantLib::ext::shared_ptr<AggregationScenarioData> scenarioData() const {
+        return scenarioData_.empty() ? nullptr : *scenarioData_;
+    }
+    const QuantLib::ext::shared_ptr<NPVCube>& nettingSetCube() const { return nettingSetCube_; }
+    const QuantLib::ext::shared_ptr<NPVCube>& cptyCube() const { return cptyCube_; }
+
 protected:
     QuantLib::ext::shared_ptr<ore::data::EngineFactory> engineFactory() override;
     void buildScenarioSimMarket();
+    void buildOffsetSimMarket();
     void buildCrossAssetModel(bool continueOnError);
     void buildScenarioGenerator(bool continueOnError);
 
@@ -57,7 +87,21 @@ protected:
 
     void initClassicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
     void buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
+    /*! netting set trades of the classic cube and the weights of their pathwise CVA, DVA and EPE, used to monitor
+        the convergence of an adaptive run, see XvaConvergenceMonitor */
+    std::map<std::string, XvaConvergenceMonitor::NettingSet>
+    convergenceNettingSets(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) const;
+    //! truncate the classic run cubes and the scenario data to the first n samples
+    void truncateSamples(const Size n);
     QuantLib::ext::shared_ptr<Portfolio> classicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
+    /*! estimate the runtime and memory of the classic run from a run on a sample of the portfolio and write the
+        estimate to the reports xva_cost_estimate and xva_cost_estimate_summary instead of building the cube */
+    void estimateClassicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
+    /*! price a sample of the portfolio under each observation mode, select the fastest mode reproducing the values
+        of the mode None for the full run and write the timings to the report observation_mode_calibration */
+    void calibrateObservationMode(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
+    std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>> classicCalculators() const;
+    std::vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>> classicCptyCalculators() const;
 
     QuantLib::ext::shared_ptr<EngineFactory>
     amcEngineFactory(const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& cam, const std::vector<Date>& grid);
@@ -74,8 +118,11 @@ protected:
     QuantLib::ext::shared_ptr<EngineFactory> engineFactory_;
     QuantLib::ext::shared_ptr<CrossAssetModel> model_;
     QuantLib::ext::shared_ptr<ScenarioGenerator> scenarioGenerator_;
+    QuantLib::ext::shared_ptr<MappedScenarioStoreWriter> scenarioStoreWriter_;
     QuantLib::ext::shared_ptr<Portfolio> amcPortfolio_, classicPortfolio_;
     QuantLib::ext::shared_ptr<NPVCube> cube_, nettingSetCube_, cptyCube_, amcCube_;
+    // trades stored in a sparse cube in the classic run, see selectSparseCubeIds()
+    std::set<std::string> sparseCubeIds_;
     QuantLib::RelinkableHandle<AggregationScenarioData> scenarioData_;
     QuantLib::ext::shared_ptr<CubeInterpretation> cubeInterpreter_;
     QuantLib::ext::shared_ptr<DynamicInitialMarginCalculator> dimCalculator_;
@@ -85,6 +132,11 @@ protected:
     Size cubeDepth_ = 0;
     QuantLib::ext::shared_ptr<DateGrid> grid_;
     Size samples_ = 0;
+    // build time of the simulation market in seconds
+    double simMarketBuildTime_ = 0.0;
+    std::map<std::string, Array> lgmStartParams_, lgmCalibratedParams_;
+    QuantLib::ext::shared_ptr<NPVCube> inputCube_, inputNettingSetCube_, inputCptyCube_;
+    QuantLib::ext::shared_ptr<AggregationScenarioData> inputScenarioData_;
 
     bool runSimulation_ = false;
     bool runXva_ = false;
@@ -21,6 +21,7 @@
 #include <orea/app/structuredanalyticserror.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
 #include <orea/cube/cube_io.hpp>
+#include <orea/engine/xvaenginecg.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/sensitivityscenariogenerator.hpp>
@@ -48,6 +49,15 @@ void XvaSensitivityAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore
     Settings::instance().evaluationDate() = inputs_->asof();
     std::string marketConfig = inputs_->marketConfig("pricing"); // FIXME
 
+    if (inputs_->xvaSensiMethod() == "AdjointCG") {
+        runAdjointSensitivity(loader);
+        LOG("Running XVA Sensitivity analytic finished.");
+        return;
+    }
+    QL_REQUIRE(inputs_->xvaSensiMethod() == "BumpAndRevalue", "XvaSensitivityAnalytic: invalid method '"
+                                                                   << inputs_->xvaSensiMethod()
+                                                                   << "', expected BumpAndRevalue or AdjointCG");
+
     auto xvaAnalytic = dependentAnalytic<XvaAnalytic>("XVA");
 
     // build t0, sim market, stress scenario generator
@@ -90,6 +100,8 @@ void XvaSensitivityAnalyticImpl::runSensitivity(
     const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader) {
 
     std::map<std::string, std::vector<QuantLib::ext::shared_ptr<ore::data::InMemoryReport>>> xvaReports;
+    // calibrated lgm parameters of the base scenario, used as start values in the other scenarios if requested
+    std::map<std::string, Array> baseLgmParams;
     for (size_t i = 0; i < scenarioGenerator->samples(); ++i) {
         auto scenario = scenarioGenerator->next(inputs_->asof());
         auto desc = scenarioGenerator->scenarioDescriptions()[i];
@@ -130,8 +142,13 @@ void XvaSensitivityAnalyticImpl::runSensitivity(
             auto newAnalytic = ext::make_shared<XvaAnalytic>(
                 inputs_, (label == "BASE" ? nullptr : scenario),
                 (label == "BASE" ? nullptr : analytic()->configurations().simMarketParams));
+            auto xvaImpl = static_cast<XvaAnalyticImpl*>(newAnalytic->impl().get());
+            if (inputs_->xvaSensiWarmStartCalibration() && label != "BASE")
+                xvaImpl->setLgmStartParams(baseLgmParams);
             CONSOLE("XVA_SENSITIVITY: Calculate Exposure and XVA")
             newAnalytic->runAnalytic(loader, {"EXPOSURE", "XVA"});
+            if (label == "BASE")
+                baseLgmParams = xvaImpl->lgmCalibratedParams();
             // Collect exposure and xva reports
             for (auto& [name, rpt] : newAnalytic->reports()["XVA"]) {
                 // add scenario column to report and copy it, concat it later
@@ -156,6 +173,38 @@ void XvaSensitivityAnalyticImpl::runSensitivity(
     }
 }
 
+void XvaSensitivityAnalyticImpl::runAdjointSensitivity(
+    const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader) {
+
+    // one forward evaluation and one backward derivatives run per xva on the computation graph, the portfolio must
+    // be priceable with the amc cg engines, see the amcCg parameter of the XVA analytic
+
+    QL_REQUIRE(analytic()->configurations().sensiScenarioData,
+               "XvaSensitivityAnalytic: sensitivity scenario data required for method AdjointCG");
+
+    CONSOLEW("XVA_SENSI: Run XVA and adjoint sensitivities with XvaEngineCG");
+    LOG("XvaSensitivityAnalytic: Run XvaEngineCG");
+    XvaEngineCG engine(
+        inputs_->nThreads(), inputs_->asof(), loader, inputs_->curveConfigs().get(),
+        analytic()->configurations().todaysMarketParams, analytic()->configurations().simMarketParams,
+        inputs_->amcPricingEngine(), inputs_->crossAssetModelData(), inputs_->scenarioGeneratorData(),
+        inputs_->portfolio(), inputs_->marketConfig("simulation"), inputs_->marketConfig("simulation"),
+        analytic()->configurations().sensiScenarioData, inputs_->refDataManager(), *inputs_->iborFallbackConfig(),
+        false, inputs_->xvaCgUseExternalComputeDevice(), inputs_->xvaCgExternalDeviceCompatibilityMode(),
+        inputs_->xvaCgUseDoublePrecisionForExternalCalculation(), inputs_->xvaCgExternalComputeDevice(),
+        inputs_->continueOnError(), inputs_->continueOnError(), "xva sensitivity cg",
+        inputs_->xvaCgCheckpointInterval(), inputs_->xvaCgExternalValidationTolerance(),
+        inputs_->xvaCgRegressionOnExternalDevice(), inputs_->nettingSetManager(),
+        inputs_->dvaAnalytic() ? inputs_->dvaName() : std::string(),
+        inputs_->fvaAnalytic() ? inputs_->fvaBorrowingCurve() : std::string(),
+        inputs_->fvaAnalytic() ? inputs_->fvaLendingCurve() : std::string());
+    CONSOLE("OK");
+
+    analytic()->reports()[label()]["xvacg-exposure"] = engine.exposureReport();
+    analytic()->reports()[label()]["xvacg-xva"] = engine.xvaReport();
+    analytic()->reports()[label()]["xvacg-sensi-scenario"] = engine.sensiReport();
+}
+
 void XvaSensitivityAnalyticImpl::setUpConfigurations() {
     analytic()->configurations().todaysMarketParams = inputs_->todaysMarketParams();
     analytic()->configurations().simMarketParams = inputs_->xvaSensiSimMarketParams();
@@ -40,6 +40,8 @@ public:
 private:
     void runSensitivity(const QuantLib::ext::shared_ptr<SensitivityScenarioGenerator>& scenarioGenerator,
                         const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader);
+    //! computes the xva sensitivities by a backward derivatives run in the XvaEngineCG, see method AdjointCG
+    void runAdjointSensitivity(const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader);
 };
 
 class XvaSensitivityAnalytic : public Analytic {
@@ -108,7 +108,8 @@ void XvaStressAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::dat
             ParStressTestConverter converter(
                 inputs_->asof(), analytic()->configurations().todaysMarketParams,
                 analytic()->configurations().simMarketParams, analytic()->configurations().sensiScenarioData,
-                analytic()->configurations().curveConfig, analytic()->market(), inputs_->iborFallbackConfig());
+                analytic()->configurations().curveConfig, analytic()->market(), inputs_->iborFallbackConfig(),
+                inputs_->nThreads());
             scenarioData = converter.convertStressScenarioData(scenarioData);
             analytic()->stressTests()[label()]["stress_ZeroStressData"] = scenarioData;
         } catch (const std::exception& e) {
@@ -139,14 +140,41 @@ void XvaStressAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::dat
 
     // run stress test
     LOG("Run XVA Stresstest")
-    runStressTest(scenarioGenerator, loader);
+    runStressTest(scenarioGenerator, scenarioData, loader);
 
     LOG("Running XVA Stress analytic finished.");
 }
 
+bool XvaStressAnalyticImpl::isCreditOnlyScenario(const StressTestScenarioData::StressTestData& data,
+                                                 const std::set<std::string>& baseCreditNames) const {
+    auto keys = data.riskFactors();
+    if (keys.empty())
+        return false;
+    for (auto const& k : keys) {
+        if (k.keytype != RiskFactorKey::KeyType::SurvivalProbability &&
+            k.keytype != RiskFactorKey::KeyType::RecoveryRate)
+            return false;
+        if (baseCreditNames.find(k.name) != baseCreditNames.end())
+            return false;
+    }
+    return true;
+}
+
 void XvaStressAnalyticImpl::runStressTest(const QuantLib::ext::shared_ptr<StressScenarioGenerator>& scenarioGenerator,
+                                          const QuantLib::ext::shared_ptr<StressTestScenarioData>& scenarioData,
                                           const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader) {
 
+    std::map<std::string, const StressTestScenarioData::StressTestData*> stressData;
+    if (scenarioData != nullptr) {
+        for (auto const& d : scenarioData->data())
+            stressData[d.label] = &d;
+    }
+
+    // cubes of the base scenario and the credit names entering the simulation or the pricing of the portfolio
+    QuantLib::ext::shared_ptr<NPVCube> baseCube, baseNettingSetCube;
+    QuantLib::ext::shared_ptr<AggregationScenarioData> baseScenarioData;
+    std::set<std::string> baseCreditNames;
+
     std::map<std::string, std::vector<QuantLib::ext::shared_ptr<ore::data::InMemoryReport>>> xvaReports;
     for (size_t i = 0; i < scenarioGenerator->samples(); ++i) {
         auto scenario = scenarioGenerator->next(inputs_->asof());
@@ -157,8 +185,32 @@ void XvaStressAnalyticImpl::runStressTest(const QuantLib::ext::shared_ptr<Stress
             auto newAnalytic = ext::make_shared<XvaAnalytic>(
                 inputs_, (label == "BASE" ? nullptr : scenario),
                 (label == "BASE" ? nullptr : analytic()->configurations().simMarketParams));
-            CONSOLE("XVA_STRESS: Calculate Exposure and XVA")
-            newAnalytic->runAnalytic(loader, {"EXPOSURE", "XVA"});
+            auto d = stressData.find(label);
+            if (baseCube != nullptr && d != stressData.end() && isCreditOnlyScenario(*d->second, baseCreditNames)) {
+                LOG("Scenario " << label << " shifts credit curves only, skip the simulation and reuse the base cube");
+                newAnalytic->setInputCubes(baseCube, baseScenarioData, baseNettingSetCube);
+                CONSOLE("XVA_STRESS: Calculate XVA from the base cube")
+                newAnalytic->runAnalytic(loader, {"XVA"});
+            } else {
+                CONSOLE("XVA_STRESS: Calculate Exposure and XVA")
+                newAnalytic->runAnalytic(loader, {"EXPOSURE", "XVA"});
+            }
+            if (label == "BASE" && inputs_->xvaStressReuseBaseCube()) {
+                auto xvaImpl = static_cast<XvaAnalyticImpl*>(newAnalytic->impl().get());
+                // a cpty cube holds credit state dependent NPVs, which we can not reuse under shifted credit curves
+                if (xvaImpl->cube() != nullptr && xvaImpl->scenarioData() != nullptr &&
+                    xvaImpl->cptyCube() == nullptr) {
+                    baseCube = xvaImpl->cube();
+                    baseScenarioData = xvaImpl->scenarioData();
+                    baseNettingSetCube = xvaImpl->nettingSetCube();
+                    baseCreditNames = newAnalytic->portfolio()->underlyingIndices(ore::data::AssetClass::CR,
+                                                                                  inputs_->refDataManager());
+                    if (inputs_->crossAssetModelData() != nullptr) {
+                        for (auto const& n : inputs_->crossAssetModelData()->creditNames())
+                            baseCreditNames.insert(n);
+                    }
+                }
+            }
             // Collect exposure and xva reports
             for (auto& [name, rpt] : newAnalytic->reports()["XVA"]) {
                 // add scenario column to report and copy it, concat it later
@@ -39,7 +39,12 @@ public:
 
 private:
     void runStressTest(const QuantLib::ext::shared_ptr<ore::analytics::StressScenarioGenerator>& scenarioGenerator,
+                       const QuantLib::ext::shared_ptr<StressTestScenarioData>& scenarioData,
                        const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader);
+    /*! true if the scenario shifts credit curves only, all of which are neither simulated nor used in the pricing of
+        the portfolio, so that the exposure cubes of the base scenario are valid under the scenario */
+    bool isCreditOnlyScenario(const StressTestScenarioData::StressTestData& data,
+                              const std::set<std::string>& baseCreditNames) const;
     void writeCubes(const std::string& label, const QuantLib::ext::shared_ptr<XvaAnalytic>& xvaAnalytic);
     void concatReports(const std::map<std::string, std::vector<QuantLib::ext::shared_ptr<ore::data::InMemoryReport>>>& xvaReports);
 };
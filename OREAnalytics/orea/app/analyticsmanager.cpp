@@ -34,10 +34,22 @@
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
 
+#include <orea/engine/observationmode.hpp>
+
+#include <ored/marketdata/fixings.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/trace.hpp>
+
+#include <qle/indexes/dividendmanager.hpp>
+#include <qle/math/chunkworkers.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
 
 #include <ql/errors.hpp>
+#include <ql/settings.hpp>
+
+#include <exception>
+#include <thread>
 
 using namespace std;
 using namespace boost::filesystem;
@@ -113,6 +125,8 @@ void AnalyticsManager::runAnalytics(const QuantLib::ext::shared_ptr<MarketCalibr
     if (analytics_.size() == 0)
         return;
 
+    QuantExt::MemoryAccounting::instance().reset();
+
     std::vector<QuantLib::ext::shared_ptr<ore::data::TodaysMarketParameters>> tmps = todaysMarketParams();
     std::set<Date> marketDates;
     for (const auto& a : analytics_) {
@@ -155,12 +169,11 @@ void AnalyticsManager::runAnalytics(const QuantLib::ext::shared_ptr<MarketCalibr
     }
 
     // run requested analytics
-    for (auto a : analytics_) {
-        LOG("run analytic with label '" << a.first << "'");
-        a.second->runAnalytic(marketDataLoader_->loader(), inputs_->analytics());
-        LOG("run analytic with label '" << a.first << "' finished.");
-        // then populate the market calibration report if required
-        if (marketCalibrationReport)
+    runRequestedAnalytics();
+
+    // then populate the market calibration report if required
+    if (marketCalibrationReport) {
+        for (auto a : analytics_)
             a.second->marketCalibration(marketCalibrationReport);
     }
 
@@ -169,8 +182,17 @@ void AnalyticsManager::runAnalytics(const QuantLib::ext::shared_ptr<MarketCalibr
         ReportWriter(inputs_->reportNaString())
             .writePricingStats(*pricingStatsReport, inputs_->portfolio());
         reports_["STATS"]["pricingstats"] = pricingStatsReport;
+        auto pricingStatsByEngineReport = QuantLib::ext::make_shared<InMemoryReport>();
+        ReportWriter(inputs_->reportNaString())
+            .writePricingStatsByEngine(*pricingStatsByEngineReport, inputs_->portfolio());
+        reports_["STATS"]["pricingstats_engines"] = pricingStatsByEngineReport;
     }
 
+    auto memoryStatsReport = QuantLib::ext::make_shared<InMemoryReport>();
+    ReportWriter(inputs_->reportNaString())
+        .writeMemoryStats(*memoryStatsReport, QuantExt::MemoryAccounting::instance().stages());
+    reports_["STATS"]["memorystats"] = memoryStatsReport;
+
     if (marketCalibrationReport) {
         auto report = marketCalibrationReport->outputCalibrationReport();
         if (report) {
@@ -182,6 +204,129 @@ void AnalyticsManager::runAnalytics(const QuantLib::ext::shared_ptr<MarketCalibr
     inputs_->writeOutParameters();
 }
 
+void AnalyticsManager::shareDependentAnalytics() {
+    // replace dependent analytics by requested analytics of the same types where allowed, so that their results are
+    // computed once and shared
+    for (auto const& [label, a] : analytics_) {
+        auto dependents = a->impl()->dependentAnalytics();
+        for (auto const& [key, d] : dependents) {
+            if (!a->impl()->shareDependentAnalytic(key))
+                continue;
+            for (auto const& [l, b] : analytics_) {
+                if (b != a && b != d && b->analyticTypes() == d->analyticTypes()) {
+                    LOG("AnalyticsManager: analytic '" << label << "' shares the results of analytic '" << l
+                                                       << "' as dependent analytic " << key);
+                    b->setShared(true);
+                    a->impl()->addDependentAnalytic(key, b);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void AnalyticsManager::runRequestedAnalytics() {
+
+    shareDependentAnalytics();
+
+    auto run = [this](const std::pair<const std::string, QuantLib::ext::shared_ptr<Analytic>>& a) {
+        LOG("run analytic with label '" << a.first << "'");
+        ORE_TRACE_SCOPE("Analytic " + a.first);
+        a.second->runAnalytic(marketDataLoader_->loader(), inputs_->analytics());
+        LOG("run analytic with label '" << a.first << "' finished.");
+    };
+
+    // Analytics supporting parallel runs are run concurrently on their own copy of the portfolio, if several analytics
+    // threads are configured. All other analytics share the input portfolio and are run sequentially in this thread.
+
+    Size analyticsThreads = inputs_->analyticsThreads();
+#ifndef QL_ENABLE_SESSIONS
+    if (analyticsThreads > 1) {
+        WLOG("AnalyticsManager::runAnalytics: analyticsThreads = "
+             << analyticsThreads << " requires a build with QL_ENABLE_SESSIONS = ON, analytics are run sequentially.");
+        analyticsThreads = 1;
+    }
+#endif
+
+    // shared analytics and the analytics using them are run sequentially, since they share their portfolio
+    auto usesShared = [](const QuantLib::ext::shared_ptr<Analytic>& a) {
+        for (auto const& d : a->allDependentAnalytics()) {
+            if (d->shared())
+                return true;
+        }
+        return a->shared();
+    };
+
+    std::vector<std::pair<const std::string, QuantLib::ext::shared_ptr<Analytic>>*> sequential, parallel;
+    for (auto& a : analytics_) {
+        if (analyticsThreads > 1 && a.second->impl()->parallelRunSupported() && !usesShared(a.second))
+            parallel.push_back(&a);
+        else
+            sequential.push_back(&a);
+    }
+
+    if (parallel.size() + (sequential.empty() ? 0 : 1) < 2) {
+        for (auto& a : analytics_) {
+            QuantExt::MemoryStage memoryStage("Analytic " + a.first);
+            run(a);
+        }
+        return;
+    }
+
+    // the analytics run concurrently, so their memory usage is accounted to a common stage
+    std::string names;
+    for (auto const& a : analytics_)
+        names += (names.empty() ? "" : ",") + a.first;
+    QuantExt::MemoryStage memoryStage("Analytics " + names);
+
+    Size nThreads = std::min(parallel.size(), analyticsThreads - (sequential.empty() ? 0 : 1));
+    LOG("AnalyticsManager::runAnalytics: run " << parallel.size() << " analytics on " << nThreads << " threads and "
+                                               << sequential.size() << " analytics sequentially");
+
+    // each parallel analytic gets its own copy of the input portfolio, parsed here since trade parsing uses
+    // singletons such as the conventions and the reference data
+    if (inputs_->portfolio()) {
+        std::string portfolioXml = inputs_->portfolio()->toXMLString();
+        for (auto a : parallel) {
+            auto portfolio = QuantLib::ext::make_shared<ore::data::Portfolio>(inputs_->buildFailedTrades());
+            portfolio->fromXMLString(portfolioXml);
+            a->second->setPortfolio(portfolio);
+        }
+    }
+
+    Date evaluationDate = QuantLib::Settings::instance().evaluationDate();
+    ObservationMode::Mode obsMode = ObservationMode::instance().mode();
+
+    std::exception_ptr parallelException;
+    std::thread parallelRuns([&]() {
+        try {
+            QuantExt::ChunkWorkers workers(nThreads);
+            workers.run(parallel.size(), [&](const Size i) {
+                // set the thread local singletons
+                QuantLib::Settings::instance().evaluationDate() = evaluationDate;
+                ObservationMode::instance().setMode(obsMode);
+                ore::data::applyFixings(marketDataLoader_->loader()->loadFixings());
+                QuantExt::applyDividends(marketDataLoader_->loader()->loadDividends());
+                run(*parallel[i]);
+            });
+        } catch (...) {
+            parallelException = std::current_exception();
+        }
+    });
+
+    try {
+        for (auto a : sequential)
+            run(*a);
+    } catch (...) {
+        parallelRuns.join();
+        throw;
+    }
+
+    parallelRuns.join();
+    if (parallelException)
+        std::rethrow_exception(parallelException);
+}
+
 Analytic::analytic_reports const AnalyticsManager::reports() {
     Analytic::analytic_reports reports = reports_;
     for (auto a : analytics_) {
@@ -273,7 +418,8 @@ void AnalyticsManager::toFile(const ore::analytics::Analytic::analytic_reports&
             std::string fullFileName = outputPath + "/" + fileName + suffix;
 
             report->toFile(fullFileName, sep, commentCharacter, quoteChar, nullString,
-                           lowerHeaderReportNames.find(reportName) != lowerHeaderReportNames.end());
+                           lowerHeaderReportNames.find(reportName) != lowerHeaderReportNames.end(),
+                           inputs_->nThreads());
             LOG("report " << reportName << " written to " << fullFileName); 
         }
     }
@@ -68,6 +68,11 @@ public:
                 const std::set<std::string>& lowerHeaderReportNames = {});
 
 private:
+    /*! Run the analytics, analytics supporting parallel runs are run concurrently on analyticsThreads() threads if
+        several threads are configured */
+    void runRequestedAnalytics();
+    void shareDependentAnalytics();
+
     std::map<std::string, QuantLib::ext::shared_ptr<Analytic>> analytics_;
     QuantLib::ext::shared_ptr<InputParameters> inputs_;
     QuantLib::ext::shared_ptr<MarketDataLoader> marketDataLoader_;
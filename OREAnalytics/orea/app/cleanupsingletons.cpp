@@ -19,6 +19,7 @@
 #include <orea/app/cleanupsingletons.hpp>
 #include <orea/engine/observationmode.hpp>
 
+#include <ored/marketdata/bootstrapwarmstarts.hpp>
 #include <ored/portfolio/scriptedtrade.hpp>
 #include <ored/utilities/calendarparser.hpp>
 #include <ored/utilities/currencyparser.hpp>
@@ -27,6 +28,8 @@
 
 #include <qle/math/computeenvironment.hpp>
 #include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/randomvariable_pool.hpp>
 #include <qle/pricingengines/mcmultilegbaseengine.hpp>
 #include <qle/utilities/savedobservablesettings.hpp>
 
@@ -38,6 +41,8 @@ CleanUpThreadLocalSingletons::~CleanUpThreadLocalSingletons() {
     ore::analytics::ObservationMode::instance().setMode(ore::analytics::ObservationMode::Mode::None);
     QuantExt::ComputeEnvironment::instance().reset();
     QuantExt::RandomVariableStats::instance().reset();
+    QuantExt::RandomVariablePool::instance().clear();
+    QuantExt::RandomVariablePool::instance().resetStats();
     QuantExt::McEngineStats::instance().reset();
 }
 
@@ -47,6 +52,8 @@ CleanUpThreadGlobalSingletons::~CleanUpThreadGlobalSingletons() {
     ore::data::CalendarParser::instance().reset();
     ore::data::CurrencyParser::instance().reset();
     ore::data::ScriptLibraryStorage::instance().clear();
+    ore::data::BootstrapWarmStarts::instance().enable(false);
+    QuantExt::RandomVariableKernels::instance().reset();
 }
 
 CleanUpLogSingleton::CleanUpLogSingleton(const bool removeLoggers, const bool clearIndependentLoggers)
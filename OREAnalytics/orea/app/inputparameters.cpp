@@ -22,6 +22,7 @@
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/sensitivityfilestream.hpp>
 #include <orea/scenario/historicalscenariofilereader.hpp>
+#include <orea/scenario/historicalscenariostore.hpp>
 #include <orea/scenario/shiftscenariogenerator.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <orea/simm/simmbucketmapperbase.hpp>
@@ -382,8 +383,13 @@ void InputParameters::setCollateralBalancesFromFile(const std::string& fileName)
     collateralBalances_->fromFile(fileName);
 }
 
-void InputParameters::setCubeFromFile(const std::string& file) {
-    auto r = ore::analytics::loadCube(file);
+void InputParameters::setCubeFromFile(const std::string& file) { setCubeFromFiles({file}); }
+
+void InputParameters::setCubeFromFiles(const std::vector<std::string>& files) {
+    std::vector<NPVCubeWithMetaData> cubes;
+    for (auto const& f : files)
+        cubes.push_back(ore::analytics::loadCube(f));
+    auto r = mergeCubes(cubes);
     cube_ = r.cube;
     if(r.scenarioGeneratorData)
         scenarioGeneratorData_ = r.scenarioGeneratorData;
@@ -397,15 +403,32 @@ void InputParameters::setCube(const ext::shared_ptr<NPVCube>& cube) {
     cube_ = cube;
 }
 
-void InputParameters::setNettingSetCubeFromFile(const std::string& file) {
-    nettingSetCube_ = ore::analytics::loadCube(file).cube;
+void InputParameters::setNettingSetCubeFromFile(const std::string& file) { setNettingSetCubeFromFiles({file}); }
+
+void InputParameters::setNettingSetCubeFromFiles(const std::vector<std::string>& files) {
+    std::vector<NPVCubeWithMetaData> cubes;
+    for (auto const& f : files)
+        cubes.push_back({ore::analytics::loadCube(f).cube});
+    nettingSetCube_ = mergeCubes(cubes).cube;
 }
 
-void InputParameters::setCptyCubeFromFile(const std::string& file) {
-    cptyCube_ = ore::analytics::loadCube(file).cube;
+void InputParameters::setCptyCubeFromFile(const std::string& file) { setCptyCubeFromFiles({file}); }
+
+void InputParameters::setCptyCubeFromFiles(const std::vector<std::string>& files) {
+    std::vector<NPVCubeWithMetaData> cubes;
+    for (auto const& f : files)
+        cubes.push_back({ore::analytics::loadCube(f).cube});
+    cptyCube_ = mergeCubes(cubes).cube;
 }
 
-void InputParameters::setMarketCubeFromFile(const std::string& file) { mktCube_ = loadAggregationScenarioData(file); }
+void InputParameters::setMarketCubeFromFile(const std::string& file) { setMarketCubeFromFiles({file}); }
+
+void InputParameters::setMarketCubeFromFiles(const std::vector<std::string>& files) {
+    std::vector<QuantLib::ext::shared_ptr<AggregationScenarioData>> data;
+    for (auto const& f : files)
+        data.push_back(loadAggregationScenarioData(f));
+    mktCube_ = mergeAggregationScenarioData(data);
+}
 
 void InputParameters::setMarketCube(const QuantLib::ext::shared_ptr<AggregationScenarioData>& cube) { mktCube_ = cube; }
 
@@ -457,8 +480,12 @@ void InputParameters::setHistoricalScenarioReader(const std::string& fileName) {
     QL_REQUIRE(exists(baseScenarioPath), "The provided base scenario file, " << baseScenarioPath << ", does not exist");
     QL_REQUIRE(is_regular_file(baseScenarioPath),
                "The provided base scenario file, " << baseScenarioPath << ", is not a file");
-    historicalScenarioReader_ = QuantLib::ext::make_shared<HistoricalScenarioFileReader>(
-        fileName, QuantLib::ext::make_shared<SimpleScenarioFactory>(false));
+    if (isHistoricalScenarioStore(fileName))
+        historicalScenarioReader_ = QuantLib::ext::make_shared<HistoricalScenarioStoreReader>(
+            fileName, QuantLib::ext::make_shared<SimpleScenarioFactory>(false));
+    else
+        historicalScenarioReader_ = QuantLib::ext::make_shared<HistoricalScenarioFileReader>(
+            fileName, QuantLib::ext::make_shared<SimpleScenarioFactory>(false));
 }
 
 void InputParameters::setAmcTradeTypes(const std::string& s) {
@@ -539,8 +566,9 @@ void InputParameters::setCreditSimulationParametersFromBuffer(const std::string&
 void InputParameters::setCrifFromFile(const std::string& fileName, char eol, char delim, char quoteChar, char escapeChar) {
     bool updateMappings = true;
     bool aggregateTrades = false;
-    auto crifLoader = CsvFileCrifLoader(fileName, getSimmConfiguration(), CrifRecord::additionalHeaders, updateMappings,
-                                        aggregateTrades, eol, delim, quoteChar, escapeChar, reportNaString());
+    auto crifLoader =
+        MemoryMappedCsvFileCrifLoader(fileName, getSimmConfiguration(), CrifRecord::additionalHeaders, updateMappings,
+                                      aggregateTrades, eol, delim, quoteChar, escapeChar, reportNaString(), nThreads());
     crif_ = crifLoader.loadCrif();
 }
 
@@ -77,7 +77,10 @@ public:
     void setLazyMarketBuilding(bool b) { lazyMarketBuilding_ = b; }
     void setBuildFailedTrades(bool b) { buildFailedTrades_ = b; }
     void setObservationModel(const std::string& s) { observationModel_ = s; }
+    void setRandomVariableKernels(const std::string& s) { randomVariableKernels_ = s; }
+    void setOpenClProgramCacheDirectory(const std::string& s) { openClProgramCacheDirectory_ = s; }
     void setImplyTodaysFixings(bool b) { implyTodaysFixings_ = b; }
+    void setBootstrapWarmStart(bool b) { bootstrapWarmStart_ = b; }
     void setMarketConfig(const std::string& config, const std::string& context);
     void setRefDataManager(const std::string& xml);
     void setRefDataManagerFromFile(const std::string& fileName);
@@ -97,6 +100,13 @@ public:
     void setPortfolioFromFile(const std::string& fileNameString, const std::filesystem::path& inputPath); 
     void setMarketConfigs(const std::map<std::string, std::string>& m);
     void setThreads(int i) { nThreads_ = i; }
+    void setAnalyticsThreads(QuantLib::Size s) { analyticsThreads_ = s; }
+    void setMtTradeBlockSize(QuantLib::Size s) { mtTradeBlockSize_ = s; }
+    void setMtSampleBlockSize(QuantLib::Size s) { mtSampleBlockSize_ = s; }
+    void setMtShareInitMarket(bool b) { mtShareInitMarket_ = b; }
+    void setMtNumaAware(bool b) { mtNumaAware_ = b; }
+    void setMtNumaNodes(QuantLib::Size n) { mtNumaNodes_ = n; }
+    void setMtMultiProcess(bool b) { mtMultiProcess_ = b; }
     void setEntireMarket(bool b) { entireMarket_ = b; }
     void setAllFixings(bool b) { allFixings_ = b; }
     void setEomInflationFixings(bool b) { eomInflationFixings_ = b; }
@@ -134,6 +144,9 @@ public:
     void setUseSensiSpreadedTermStructures(bool b) { useSensiSpreadedTermStructures_ = b; }
     void setSensiThreshold(Real r) { sensiThreshold_ = r; }
     void setSensiRecalibrateModels(bool b) { sensiRecalibrateModels_ = b; }
+    void setSensiSkipUnaffectedTrades(bool b) { sensiSkipUnaffectedTrades_ = b; }
+    void setSensiAnalyticLinearTrades(bool b) { sensiAnalyticLinearTrades_ = b; }
+    void setSensiTradeBlockSize(Size n) { sensiTradeBlockSize_ = n; }
     void setSensiSimMarketParams(const std::string& xml);
     void setSensiSimMarketParamsFromFile(const std::string& fileName);
     void setSensiScenarioData(const std::string& xml);
@@ -151,6 +164,7 @@ public:
 
     // Setters for stress testing
     void setStressThreshold(Real r) { stressThreshold_ = r; }
+    void setStressSkipUnaffectedTrades(bool b) { stressSkipUnaffectedTrades_ = b; }
     void setStressOptimiseRiskFactors(bool optimise) { stressOptimiseRiskFactors_ = optimise; }
     void setStressSimMarketParams(const std::string& xml); 
     void setStressSimMarketParamsFromFile(const std::string& fileName); 
@@ -193,16 +207,43 @@ public:
     void setSalvageCorrelationMatrix(bool b) { salvageCorrelationMatrix_ = b; }
     void setAmc(bool b) { amc_ = b; }
     void setAmcCg(bool b) { amcCg_ = b; }
+    void setAmcSinglePrecisionPaths(bool b) { amcSinglePrecisionPaths_ = b; }
+    void setAmcProjectModel(bool b) { amcProjectModel_ = b; }
+    void setScenarioPipelineDepth(Size n) { scenarioPipelineDepth_ = n; }
+    void setScenarioStoreFile(const std::string& s) { scenarioStoreFile_ = s; }
+    void setScenarioStoreDoublePrecision(bool b) { scenarioStoreDoublePrecision_ = b; }
+    void setScenarioReplayFile(const std::string& s) { scenarioReplayFile_ = s; }
+    void setAggregationScenarioDataBinary(bool b) { aggregationScenarioDataBinary_ = b; }
+    void setAggregationScenarioDataDoublePrecision(bool b) { aggregationScenarioDataDoublePrecision_ = b; }
+    void setCubeLayout(const std::string& s) { cubeLayout_ = s; }
+    void setSparseCubeMaxOccupancy(Real r) { sparseCubeMaxOccupancy_ = r; }
+    void setXvaCostEstimation(bool b) { xvaCostEstimation_ = b; }
+    void setXvaCostEstimationSamples(Size n) { xvaCostEstimationSamples_ = n; }
+    void setXvaCostEstimationTradesPerType(Size n) { xvaCostEstimationTradesPerType_ = n; }
+    void setXvaCostEstimationTimeBudget(Real t) { xvaCostEstimationTimeBudget_ = t; }
+    void setXvaAdaptiveSamples(bool b) { xvaAdaptiveSamples_ = b; }
+    void setXvaGroupTradesByPricingEngine(bool b) { xvaGroupTradesByPricingEngine_ = b; }
+    void setXvaSkipExpiredTrades(bool b) { xvaSkipExpiredTrades_ = b; }
+    void setXvaAdaptiveSamplesBatchSize(Size n) { xvaAdaptiveSamplesBatchSize_ = n; }
+    void setXvaAdaptiveSamplesConfidenceLevel(Real r) { xvaAdaptiveSamplesConfidenceLevel_ = r; }
+    void setXvaAdaptiveSamplesRelativeTolerance(Real r) { xvaAdaptiveSamplesRelativeTolerance_ = r; }
+    void setXvaAdaptiveSamplesAbsoluteTolerance(Real r) { xvaAdaptiveSamplesAbsoluteTolerance_ = r; }
     void setXvaCgBumpSensis(bool b) { xvaCgBumpSensis_ = b; }
     void setXvaCgUseExternalComputeDevice(bool b) { xvaCgUseExternalComputeDevice_ = b; }
     void setXvaCgExternalDeviceCompatibilityMode(bool b) { xvaCgExternalDeviceCompatibilityMode_ = b; }
     void setXvaCgUseDoublePrecisionForExternalCalculation(bool b) { xvaCgUseDoublePrecisionForExternalCalculation_ = b; }
     void setXvaCgExternalComputeDevice(string s) { xvaCgExternalComputeDevice_ = std::move(s); }
+    void setXvaCgCheckpointInterval(Size n) { xvaCgCheckpointInterval_ = n; }
+    void setXvaCgExternalValidationTolerance(Real tol) { xvaCgExternalValidationTolerance_ = tol; }
+    void setXvaCgRegressionOnExternalDevice(bool b) { xvaCgRegressionOnExternalDevice_ = b; }
     void setXvaCgSensiScenarioData(const std::string& xml);
     void setXvaCgSensiScenarioDataFromFile(const std::string& fileName);
     void setAmcTradeTypes(const std::string& s); // parse to set<string>
     void setExposureBaseCurrency(const std::string& s) { exposureBaseCurrency_ = s; } 
     void setExposureObservationModel(const std::string& s) { exposureObservationModel_ = s; }
+    void setObservationModelCalibrationSamples(Size n) { observationModelCalibrationSamples_ = n; }
+    void setObservationModelCalibrationTradesPerType(Size n) { observationModelCalibrationTradesPerType_ = n; }
+    void setObservationModelCalibrationTolerance(Real tol) { observationModelCalibrationTolerance_ = tol; }
     void setNettingSetId(const std::string& s) { nettingSetId_ = s; }
     void setScenarioGenType(const std::string& s) { scenarioGenType_ = s; }
     void setStoreFlows(bool b) { storeFlows_ = b; }
@@ -245,6 +286,12 @@ public:
     void setNettingSetCubeFromFile(const std::string& file);
     void setCptyCubeFromFile(const std::string& file);
     void setMarketCubeFromFile(const std::string& file);
+    /* The same as above, but for partial cubes of consecutive sample ranges that are merged into one cube, see
+       mergeCubes() and mergeAggregationScenarioData(). The files must be given in the order of the sample ranges. */
+    void setCubeFromFiles(const std::vector<std::string>& files);
+    void setNettingSetCubeFromFiles(const std::vector<std::string>& files);
+    void setCptyCubeFromFiles(const std::vector<std::string>& files);
+    void setMarketCubeFromFiles(const std::vector<std::string>& files);
     void setMarketCube(const QuantLib::ext::shared_ptr<AggregationScenarioData>& cube);
     // QuantLib::ext::shared_ptr<AggregationScenarioData> mktCube();
     void setFlipViewXVA(bool b) { flipViewXVA_ = b; }
@@ -253,6 +300,7 @@ public:
     void setExposureProfiles(bool b) { exposureProfiles_ = b; }
     void setExposureProfilesByTrade(bool b) { exposureProfilesByTrade_ = b; }
     void setPfeQuantile(Real r) { pfeQuantile_ = r; }
+    void setPfeQuantileCompression(Real r) { pfeQuantileCompression_ = r; }
     void setCollateralCalculationType(const std::string& s) { collateralCalculationType_ = s; }
     void setExposureAllocationMethod(const std::string& s) { exposureAllocationMethod_ = s; }
     void setMarginalAllocationLimit(Real r) { marginalAllocationLimit_ = r; }
@@ -324,6 +372,7 @@ public:
     void setXvaStressSensitivityScenarioData(const std::string& xml);
     void setXvaStressSensitivityScenarioDataFromFile(const std::string& fileName);
     void setXvaStressWriteCubes(const bool writeCubes) { xvaStressWriteCubes_ = writeCubes; }
+    void setXvaStressReuseBaseCube(const bool b) { xvaStressReuseBaseCube_ = b; }
 
     // Setters for xvaStress
     void setXvaSensiSimMarketParams(const std::string& xml);
@@ -335,6 +384,8 @@ public:
     void setXvaSensiPricingEngine(const QuantLib::ext::shared_ptr<EngineData>& engineData) {
         sensiPricingEngine_ = engineData;
     }
+    void setXvaSensiWarmStartCalibration(const bool b) { xvaSensiWarmStartCalibration_ = b; }
+    void setXvaSensiMethod(const std::string& s) { xvaSensiMethod_ = s; }
 
     // Setters for SIMM
     void setSimmVersion(const std::string& s) { simmVersion_ = s; }
@@ -385,6 +436,7 @@ public:
     // Setters for ScenarioStatistics
     void setScenarioDistributionSteps(const Size s) { scenarioDistributionSteps_ = s; }
     void setScenarioOutputZeroRate(const bool b) { scenarioOutputZeroRate_ = b; }
+    void setScenarioStatisticsQuantiles(const std::vector<Real>& q) { scenarioStatisticsQuantiles_ = q; }
     // Setters for par stress conversion
     void setParStressSimMarketParams(const std::string& xml);
     void setParStressSimMarketParamsFromFile(const std::string& fileName);
@@ -435,7 +487,10 @@ public:
     bool lazyMarketBuilding() const { return lazyMarketBuilding_; }
     bool buildFailedTrades() const { return buildFailedTrades_; }
     const std::string& observationModel() const { return observationModel_; }
+    const std::string& randomVariableKernels() const { return randomVariableKernels_; }
+    const std::string& openClProgramCacheDirectory() const { return openClProgramCacheDirectory_; }
     bool implyTodaysFixings() const { return implyTodaysFixings_; }
+    bool bootstrapWarmStart() const { return bootstrapWarmStart_; }
     const std::map<std::string, std::string>&  marketConfigs() const { return marketConfigs_; }
     const std::string& marketConfig(const std::string& context);
     const QuantLib::ext::shared_ptr<ore::data::BasicReferenceDataManager>& refDataManager() const { return refDataManager_; }
@@ -451,6 +506,13 @@ public:
 
     QuantLib::Size maxRetries() const { return maxRetries_; }
     QuantLib::Size nThreads() const { return nThreads_; }
+    QuantLib::Size analyticsThreads() const { return analyticsThreads_; }
+    QuantLib::Size mtTradeBlockSize() const { return mtTradeBlockSize_; }
+    QuantLib::Size mtSampleBlockSize() const { return mtSampleBlockSize_; }
+    bool mtShareInitMarket() const { return mtShareInitMarket_; }
+    bool mtNumaAware() const { return mtNumaAware_; }
+    QuantLib::Size mtNumaNodes() const { return mtNumaNodes_; }
+    bool mtMultiProcess() const { return mtMultiProcess_; }
     bool entireMarket() const { return entireMarket_; }
     bool allFixings() const { return allFixings_; }
     bool eomInflationFixings() const { return eomInflationFixings_; }
@@ -505,6 +567,9 @@ public:
     bool useSensiSpreadedTermStructures() const { return useSensiSpreadedTermStructures_; }
     QuantLib::Real sensiThreshold() const { return sensiThreshold_; }
     bool sensiRecalibrateModels() const { return sensiRecalibrateModels_; }
+    bool sensiSkipUnaffectedTrades() const { return sensiSkipUnaffectedTrades_; }
+    bool sensiAnalyticLinearTrades() const { return sensiAnalyticLinearTrades_; }
+    Size sensiTradeBlockSize() const { return sensiTradeBlockSize_; }
     const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& sensiSimMarketParams() const { return sensiSimMarketParams_; }
     const QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData>& sensiScenarioData() const { return sensiScenarioData_; }
     const QuantLib::ext::shared_ptr<ore::data::EngineData>& sensiPricingEngine() const { return sensiPricingEngine_; }
@@ -520,6 +585,7 @@ public:
      * Getters for stress testing
      ****************************/
     QuantLib::Real stressThreshold() const { return stressThreshold_; }
+    bool stressSkipUnaffectedTrades() const { return stressSkipUnaffectedTrades_; }
     const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& stressSimMarketParams() const { return stressSimMarketParams_; }
     const QuantLib::ext::shared_ptr<ore::analytics::StressTestScenarioData>& stressScenarioData() const { return stressScenarioData_; }
     const QuantLib::ext::shared_ptr<ore::data::EngineData>& stressPricingEngine() const { return stressPricingEngine_; }
@@ -565,6 +631,8 @@ public:
     bool salvageCorrelationMatrix() const { return salvageCorrelationMatrix_; }
     bool amc() const { return amc_; }
     bool amcCg() const { return amcCg_; }
+    bool amcSinglePrecisionPaths() const { return amcSinglePrecisionPaths_; }
+    bool amcProjectModel() const { return amcProjectModel_; }
     bool xvaCgBumpSensis() const { return xvaCgBumpSensis_; }
     bool xvaCgUseExternalComputeDevice() const { return xvaCgUseExternalComputeDevice_; }
     bool xvaCgExternalDeviceCompatibilityMode() const { return xvaCgExternalDeviceCompatibilityMode_; }
@@ -572,12 +640,37 @@ public:
         return xvaCgUseDoublePrecisionForExternalCalculation_;
     }
     const std::string& xvaCgExternalComputeDevice() const { return xvaCgExternalComputeDevice_; }
+    Size xvaCgCheckpointInterval() const { return xvaCgCheckpointInterval_; }
+    Real xvaCgExternalValidationTolerance() const { return xvaCgExternalValidationTolerance_; }
+    bool xvaCgRegressionOnExternalDevice() const { return xvaCgRegressionOnExternalDevice_; }
     const QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData>& xvaCgSensiScenarioData() const { return xvaCgSensiScenarioData_; }
     const std::set<std::string>& amcTradeTypes() const { return amcTradeTypes_; }
     const std::string& exposureBaseCurrency() const { return exposureBaseCurrency_; }
     const std::string& exposureObservationModel() const { return exposureObservationModel_; }
+    Size observationModelCalibrationSamples() const { return observationModelCalibrationSamples_; }
+    Size observationModelCalibrationTradesPerType() const { return observationModelCalibrationTradesPerType_; }
+    Real observationModelCalibrationTolerance() const { return observationModelCalibrationTolerance_; }
     const std::string& nettingSetId() const { return nettingSetId_; }
     const std::string& scenarioGenType() const { return scenarioGenType_; }
+    Size scenarioPipelineDepth() const { return scenarioPipelineDepth_; }
+    const std::string& scenarioStoreFile() const { return scenarioStoreFile_; }
+    bool scenarioStoreDoublePrecision() const { return scenarioStoreDoublePrecision_; }
+    const std::string& scenarioReplayFile() const { return scenarioReplayFile_; }
+    bool aggregationScenarioDataBinary() const { return aggregationScenarioDataBinary_; }
+    bool aggregationScenarioDataDoublePrecision() const { return aggregationScenarioDataDoublePrecision_; }
+    const std::string& cubeLayout() const { return cubeLayout_; }
+    Real sparseCubeMaxOccupancy() const { return sparseCubeMaxOccupancy_; }
+    bool xvaCostEstimation() const { return xvaCostEstimation_; }
+    Size xvaCostEstimationSamples() const { return xvaCostEstimationSamples_; }
+    Size xvaCostEstimationTradesPerType() const { return xvaCostEstimationTradesPerType_; }
+    Real xvaCostEstimationTimeBudget() const { return xvaCostEstimationTimeBudget_; }
+    bool xvaAdaptiveSamples() const { return xvaAdaptiveSamples_; }
+    bool xvaGroupTradesByPricingEngine() const { return xvaGroupTradesByPricingEngine_; }
+    bool xvaSkipExpiredTrades() const { return xvaSkipExpiredTrades_; }
+    Size xvaAdaptiveSamplesBatchSize() const { return xvaAdaptiveSamplesBatchSize_; }
+    Real xvaAdaptiveSamplesConfidenceLevel() const { return xvaAdaptiveSamplesConfidenceLevel_; }
+    Real xvaAdaptiveSamplesRelativeTolerance() const { return xvaAdaptiveSamplesRelativeTolerance_; }
+    Real xvaAdaptiveSamplesAbsoluteTolerance() const { return xvaAdaptiveSamplesAbsoluteTolerance_; }
     bool storeFlows() const { return storeFlows_; }
     Size storeCreditStateNPVs() const { return storeCreditStateNPVs_; }
     bool storeSurvivalProbabilities() const { return storeSurvivalProbabilities_; }
@@ -608,6 +701,7 @@ public:
     bool exposureProfiles() const { return exposureProfiles_; }
     bool exposureProfilesByTrade() const { return exposureProfilesByTrade_; }
     Real pfeQuantile() const { return pfeQuantile_; }
+    Real pfeQuantileCompression() const { return pfeQuantileCompression_; }
     const std::string&  collateralCalculationType() const { return collateralCalculationType_; }
     const std::string& exposureAllocationMethod() const { return exposureAllocationMethod_; }
     Real marginalAllocationLimit() const { return marginalAllocationLimit_; }
@@ -672,6 +766,7 @@ public:
         return xvaStressSensitivityScenarioData_;
     }
     bool xvaStressWriteCubes() const { return xvaStressWriteCubes_; }
+    bool xvaStressReuseBaseCube() const { return xvaStressReuseBaseCube_; }
     /**************************************************
      * Getters for cashflow npv and dynamic backtesting
      **************************************************/
@@ -721,6 +816,7 @@ public:
     // Getters for ScenarioStatistics
     const Size& scenarioDistributionSteps() const { return scenarioDistributionSteps_; }
     const bool& scenarioOutputZeroRate() const { return scenarioOutputZeroRate_; }
+    const std::vector<Real>& scenarioStatisticsQuantiles() const { return scenarioStatisticsQuantiles_; }
 
     // Getters for ParStressConversion
     const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& parStressSimMarketParams() const {
@@ -755,6 +851,8 @@ public:
         return xvaSensiScenarioData_;
     }
     const QuantLib::ext::shared_ptr<ore::data::EngineData>& xvaSensiPricingEngine() const { return xvaSensiPricingEngine_; }
+    bool xvaSensiWarmStartCalibration() const { return xvaSensiWarmStartCalibration_; }
+    const std::string& xvaSensiMethod() const { return xvaSensiMethod_; }
 
     /****************************
      * Getters for zero to par shift
@@ -799,7 +897,10 @@ protected:
     bool lazyMarketBuilding_ = true;
     bool buildFailedTrades_ = true;
     std::string observationModel_ = "None";
+    std::string randomVariableKernels_ = "Scalar";
+    std::string openClProgramCacheDirectory_;
     bool implyTodaysFixings_ = false;
+    bool bootstrapWarmStart_ = false;
     std::map<std::string, std::string> marketConfigs_;
     QuantLib::ext::shared_ptr<ore::data::BasicReferenceDataManager> refDataManager_;
     QuantLib::ext::shared_ptr<ore::data::Conventions> conventions_;
@@ -810,6 +911,15 @@ protected:
     QuantLib::ext::shared_ptr<ore::data::Portfolio> portfolio_, useCounterpartyOriginalPortfolio_;
     QuantLib::Size maxRetries_ = 7;
     QuantLib::Size nThreads_ = 1;
+    // number of analytics run concurrently by the analytics manager
+    QuantLib::Size analyticsThreads_ = 1;
+    // 0 = static split of the portfolio in multi-threaded valuation engine runs
+    QuantLib::Size mtTradeBlockSize_ = 0;
+    QuantLib::Size mtSampleBlockSize_ = 0;
+    bool mtShareInitMarket_ = false;
+    bool mtNumaAware_ = false;
+    QuantLib::Size mtNumaNodes_ = 0;
+    bool mtMultiProcess_ = false;
    
     bool entireMarket_ = false; 
     bool allFixings_ = false; 
@@ -857,6 +967,9 @@ protected:
     bool useSensiSpreadedTermStructures_ = true;
     QuantLib::Real sensiThreshold_ = 1e-6;
     bool sensiRecalibrateModels_ = true;
+    bool sensiSkipUnaffectedTrades_ = false;
+    bool sensiAnalyticLinearTrades_ = false;
+    Size sensiTradeBlockSize_ = 0;
     QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters> sensiSimMarketParams_;
     QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData> sensiScenarioData_;
     QuantLib::ext::shared_ptr<ore::data::EngineData> sensiPricingEngine_;
@@ -872,6 +985,7 @@ protected:
      * STRESS analytic
      *****************/
     QuantLib::Real stressThreshold_ = 0.0;
+    bool stressSkipUnaffectedTrades_ = false;
     QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters> stressSimMarketParams_;
     QuantLib::ext::shared_ptr<ore::analytics::StressTestScenarioData> stressScenarioData_;
     QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData> stressSensitivityScenarioData_;
@@ -910,17 +1024,52 @@ protected:
     bool salvageCorrelationMatrix_ = false;
     bool amc_ = false;
     bool amcCg_ = false;
+    bool amcSinglePrecisionPaths_ = false;
+    bool amcProjectModel_ = false;
     bool xvaCgBumpSensis_ = false;
     bool xvaCgUseExternalComputeDevice_ = false;
     bool xvaCgExternalDeviceCompatibilityMode_ = false;
     bool xvaCgUseDoublePrecisionForExternalCalculation_ = false;
     string xvaCgExternalComputeDevice_;
+    Size xvaCgCheckpointInterval_ = 0;
+    Real xvaCgExternalValidationTolerance_ = Null<Real>();
+    bool xvaCgRegressionOnExternalDevice_ = false;
     QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData> xvaCgSensiScenarioData_;
     std::set<std::string> amcTradeTypes_;
     std::string exposureBaseCurrency_ = "";
     std::string exposureObservationModel_ = "Disable";
+    // calibration run on a sample of the portfolio selecting the exposure observation model "Auto"
+    Size observationModelCalibrationSamples_ = 10;
+    Size observationModelCalibrationTradesPerType_ = 5;
+    Real observationModelCalibrationTolerance_ = 1E-8;
     std::string nettingSetId_ = "";
     std::string scenarioGenType_ = "";
+    Size scenarioPipelineDepth_ = 0;
+    // binary scenario store written during the simulation resp. replayed instead of simulating the model
+    std::string scenarioStoreFile_ = "";
+    bool scenarioStoreDoublePrecision_ = false;
+    std::string scenarioReplayFile_ = "";
+    // write the aggregation scenario data in the binary format, see saveAggregationScenarioDataBinary()
+    bool aggregationScenarioDataBinary_ = false;
+    bool aggregationScenarioDataDoublePrecision_ = false;
+    // Dense or Auto, the latter stores trades with an estimated cube occupancy below the threshold in a sparse cube
+    std::string cubeLayout_ = "Dense";
+    Real sparseCubeMaxOccupancy_ = 0.5;
+    // estimate the cost of the classic exposure run on a sample instead of running it, time budget in seconds
+    bool xvaCostEstimation_ = false;
+    Size xvaCostEstimationSamples_ = 10;
+    Size xvaCostEstimationTradesPerType_ = 5;
+    Real xvaCostEstimationTimeBudget_ = 0.0;
+    // price the trades of the classic exposure run grouped by pricing engine, see ValuationEngine
+    bool xvaGroupTradesByPricingEngine_ = false;
+    // do not price trades after their maturity in the classic exposure run, see ValuationEngine
+    bool xvaSkipExpiredTrades_ = false;
+    // stop the classic exposure run once the netting set CVA, DVA and EPE have converged, see XvaConvergenceMonitor
+    bool xvaAdaptiveSamples_ = false;
+    Size xvaAdaptiveSamplesBatchSize_ = 1000;
+    Real xvaAdaptiveSamplesConfidenceLevel_ = 0.95;
+    Real xvaAdaptiveSamplesRelativeTolerance_ = 0.01;
+    Real xvaAdaptiveSamplesAbsoluteTolerance_ = 0.0;
     bool storeFlows_ = false;
     Size storeCreditStateNPVs_ = 0;
     bool storeSurvivalProbabilities_ = false;
@@ -936,6 +1085,7 @@ protected:
     bool exposureProfiles_ = true;
     bool exposureProfilesByTrade_ = true;
     Real pfeQuantile_ = 0.95;
+    Real pfeQuantileCompression_ = Null<Real>();
     bool fullInitialCollateralisation_ = false;
     std::string collateralCalculationType_ = "NoLag";
     std::string exposureAllocationMethod_ = "None";
@@ -1006,6 +1156,8 @@ protected:
     QuantLib::ext::shared_ptr<ore::analytics::StressTestScenarioData> xvaStressScenarioData_;
     QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData> xvaStressSensitivityScenarioData_;
     bool xvaStressWriteCubes_ = false;
+    // re-aggregate scenarios shifting credit curves only from the cubes of the base scenario
+    bool xvaStressReuseBaseCube_ = false;
     /***************
      * SIMM analytic
      ***************/
@@ -1045,6 +1197,7 @@ protected:
      ***************/
     Size scenarioDistributionSteps_ = 20;
     bool scenarioOutputZeroRate_ = false;
+    std::vector<Real> scenarioStatisticsQuantiles_;
 
     /*****************
      * PAR STRESS CONVERSION analytic
@@ -1075,6 +1228,9 @@ protected:
     QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters> xvaSensiSimMarketParams_;
     QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData> xvaSensiScenarioData_;
     QuantLib::ext::shared_ptr<ore::data::EngineData> xvaSensiPricingEngine_;
+    bool xvaSensiWarmStartCalibration_ = false;
+    // BumpAndRevalue or AdjointCG, the latter runs the XvaEngineCG instead of one xva simulation per scenario
+    std::string xvaSensiMethod_ = "BumpAndRevalue";
 };
 
 inline const std::string& InputParameters::marketConfig(const std::string& context) {
@@ -83,23 +83,16 @@ void MarketDataCsvLoaderImpl::retrieveFixings(const QuantLib::ext::shared_ptr<or
             //DLOG("add fixing for " << f.name << " fixing date " << io::iso_date(f.date));
         }
     } else {
-        // Filter by required fixing data
-        
-        // Loop over the relevant fixings and add only them to the InMemoryLoader
+        // Filter by required fixing data, the csv loader looks up the required dates per index resp. reads only
+        // the required fixings from the files if it loads its fixings on demand
+        std::map<std::string, std::set<Date>> requiredFixings;
         for (const auto& [name, fixingDates] : fixings) {
-            // LOG("fixings are required for index " << kv.first << " and " << kv.second.size() << " dates"); 
-            // map<string, set<Date>>
-            for (const auto& [date, mandatory] : fixingDates) {
-                // lazy loop over all of them...
-                for (const auto& fix : csvLoader_->loadFixings()) {
-                    if (fix.name == name && fix.date == date) {
-                        // add it to the inMemory
-                        loader->addFixing(fix.date, fix.name, fix.fixing);
-                        //DLOG("add fixing for " << fix.name << " as of " << io::iso_date(fix.date));
-                    }
-                }
-            }
+            auto& dates = requiredFixings[name];
+            for (const auto& [date, mandatory] : fixingDates)
+                dates.insert(dates.end(), date);
         }
+        for (const auto& fix : csvLoader_->loadFixings(requiredFixings))
+            loader->addFixing(fix.date, fix.name, fix.fixing);
     }
 
     for (const auto& fp : lastAvailableFixingLookupMap) {
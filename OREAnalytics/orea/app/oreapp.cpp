@@ -36,9 +36,13 @@
 
 #include <ored/report/inmemoryreport.hpp>
 #include <ored/utilities/calendaradjustmentconfig.hpp>
+#include <ored/utilities/trace.hpp>
 #include <ored/configuration/currencyconfig.hpp>
+#include <ored/marketdata/bootstrapwarmstarts.hpp>
 #include <ored/portfolio/collateralbalance.hpp>
 
+#include <qle/math/openclenvironment.hpp>
+#include <qle/math/randomvariable_kernels.hpp>
 #include <qle/version.hpp>
 
 
@@ -61,6 +65,28 @@ using boost::timer::default_places;
 namespace ore {
 namespace analytics {
 
+namespace {
+// enables the tracing of a run if a trace file is given and writes the trace on destruction
+struct RunTracer {
+    explicit RunTracer(const std::string& fileName) : fileName_(fileName) {
+        if (!fileName_.empty())
+            Trace::instance().enable();
+    }
+    ~RunTracer() {
+        if (fileName_.empty())
+            return;
+        Trace::instance().disable();
+        try {
+            Trace::instance().writeChromeTrace(fileName_);
+            LOG("Trace with " << Trace::instance().size() << " spans written to " << fileName_);
+        } catch (const std::exception& e) {
+            ALOG("Error writing trace: " << e.what());
+        }
+    }
+    std::string fileName_;
+};
+} // namespace
+
 std::set<std::string> OREApp::getAnalyticTypes() {
     QL_REQUIRE(analyticsManager_, "analyticsManager_ not set yet, call analytics first");
     return analyticsManager_->requestedAnalytics();
@@ -210,13 +236,17 @@ QuantLib::ext::shared_ptr<CSVLoader> OREApp::buildCsvLoader(const QuantLib::ext:
         WLOG("fixing cutoff date not set");
     }
     
-    auto loader = boost::make_shared<CSVLoader>(marketFiles, fixingFiles, dividendFiles, implyTodaysFixings, cutoff);
+    // if only the required fixings are loaded, the fixing files are read when the required fixings are known
+    auto loader = boost::make_shared<CSVLoader>(marketFiles, fixingFiles, dividendFiles, implyTodaysFixings, cutoff,
+                                                inputs_->nThreads(), !inputs_->allFixings());
 
     return loader;
 }
 
 void OREApp::analytics() {
 
+    ORE_TRACE_SCOPE("OREApp::analytics");
+
     try {
         LOG("ORE analytics starting");
         MEM_LOG_USING_LEVEL(ORE_WARNING)
@@ -251,6 +281,7 @@ void OREApp::analytics() {
         analyticsManager_->runAnalytics(mcr);
 
         // Write reports to files in the results path
+        ORE_TRACE_SCOPE("OREApp::write reports");
         Analytic::analytic_reports reports = analyticsManager_->reports();
         analyticsManager_->toFile(reports,
                                   inputs_->resultsPath().string(), outputs_->fileNameMap(),
@@ -282,7 +313,11 @@ void OREApp::analytics() {
                 string reportName = b.first;
                 std::string fileName = inputs_->resultsPath().string() + "/" + outputs_->outputFileName(reportName, "csv.gz");
                 LOG("write market cube " << reportName << " to file " << fileName);
-                saveAggregationScenarioData(fileName, *b.second);
+                if (inputs_->aggregationScenarioDataBinary())
+                    saveAggregationScenarioDataBinary(fileName, *b.second,
+                                                      inputs_->aggregationScenarioDataDoublePrecision());
+                else
+                    saveAggregationScenarioData(fileName, *b.second);
             }
         }
 
@@ -357,6 +392,22 @@ void OREApp::initFromParams() {
         if (!tmp.empty()) {
             structuredLogRotationSize_ = static_cast<Size>(parseInteger(tmp));
         }
+        tmp = params_->get("logging", "asyncLog", false);
+        if (!tmp.empty()) {
+            asyncLog_ = ore::data::parseBool(tmp);
+        }
+        tmp = params_->get("logging", "asyncLogBufferSize", false);
+        if (!tmp.empty()) {
+            asyncLogBufferSize_ = static_cast<Size>(parseInteger(tmp));
+        }
+        tmp = params_->get("logging", "asyncLogOverflowPolicy", false);
+        if (!tmp.empty()) {
+            asyncLogOverflowPolicy_ = parseAsyncLoggerOverflowPolicy(tmp);
+        }
+        tmp = params_->get("logging", "traceFile", false);
+        if (!tmp.empty()) {
+            traceFile_ = outputPath_ + '/' + tmp;
+        }
     }
     
     setupLog(outputPath_, logFile_, logMask_, logRootPath_, progressLogFile_, progressLogRotationSize_, progressLogToConsole_,
@@ -419,7 +470,8 @@ void OREApp::run() {
     }
 
     runTimer_.start();
-    
+    RunTracer tracer(traceFile_);
+
     try {
         structuredLogger_->clear();
         analytics();
@@ -464,8 +516,10 @@ void OREApp::run(const std::vector<std::string>& marketData,
     }
 
     runTimer_.start();
+    RunTracer tracer(traceFile_);
 
     try {
+        ORE_TRACE_SCOPE("OREApp::run");
         LOG("ORE analytics starting");
         structuredLogger_->clear();
         MEM_LOG_USING_LEVEL(ORE_WARNING)
@@ -532,7 +586,10 @@ void OREApp::setupLog(const std::string& path, const std::string& file, Size mas
     }
     QL_REQUIRE(boost::filesystem::is_directory(p), "output path '" << path << "' is not a directory.");
 
-    Log::instance().registerLogger(QuantLib::ext::make_shared<FileLogger>(file));
+    QuantLib::ext::shared_ptr<Logger> fileLogger = QuantLib::ext::make_shared<FileLogger>(file);
+    if (asyncLog_)
+        fileLogger = QuantLib::ext::make_shared<AsyncLogger>(fileLogger, asyncLogBufferSize_, asyncLogOverflowPolicy_);
+    Log::instance().registerLogger(fileLogger);
     boost::filesystem::path oreRootPath =
         logRootPath.empty() ? boost::filesystem::path(__FILE__).parent_path().parent_path().parent_path().parent_path()
                             : logRootPath;
@@ -629,6 +686,10 @@ void OREAppInputParameters::loadParameters() {
     if (tmp != "")
         setReportNaString(tmp);
 
+    tmp = params_->get("setup", "allFixings", false);
+    if (tmp != "")
+        setAllFixings(parseBool(tmp));
+
     tmp = params_->get("setup", "eomInflationFixings", false);
     if (tmp != "")
         setEomInflationFixings(parseBool(tmp));
@@ -637,6 +698,34 @@ void OREAppInputParameters::loadParameters() {
     if (tmp != "")
         setThreads(parseInteger(tmp));
 
+    tmp = params_->get("setup", "analyticsThreads", false);
+    if (tmp != "")
+        setAnalyticsThreads(parseInteger(tmp));
+
+    tmp = params_->get("setup", "mtTradeBlockSize", false);
+    if (tmp != "")
+        setMtTradeBlockSize(parseInteger(tmp));
+
+    tmp = params_->get("setup", "mtSampleBlockSize", false);
+    if (tmp != "")
+        setMtSampleBlockSize(parseInteger(tmp));
+
+    tmp = params_->get("setup", "mtShareInitMarket", false);
+    if (tmp != "")
+        setMtShareInitMarket(parseBool(tmp));
+
+    tmp = params_->get("setup", "mtNumaAware", false);
+    if (tmp != "")
+        setMtNumaAware(parseBool(tmp));
+
+    tmp = params_->get("setup", "mtNumaNodes", false);
+    if (tmp != "")
+        setMtNumaNodes(parseInteger(tmp));
+
+    tmp = params_->get("setup", "mtMultiProcess", false);
+    if (tmp != "")
+        setMtMultiProcess(parseBool(tmp));
+
     tmp = params_->get("setup", "entireMarket", false);
     if (tmp != "")
         setEntireMarket(parseBool(tmp));
@@ -664,6 +753,27 @@ void OREAppInputParameters::loadParameters() {
         LOG("Observation Mode is " << observationModel());
     }
 
+    tmp = params_->get("setup", "randomVariableKernels", false);
+    if (tmp != "") {
+        setRandomVariableKernels(tmp);
+        QuantExt::RandomVariableKernels::instance().selectKernels(randomVariableKernels());
+        LOG("Random variable kernels are " << QuantExt::RandomVariableKernels::instance().selectedKernels());
+    }
+
+    tmp = params_->get("setup", "openClProgramCacheDirectory", false);
+    if (tmp != "") {
+        setOpenClProgramCacheDirectory(tmp);
+        QuantExt::OpenClFramework::setProgramCacheDirectory(openClProgramCacheDirectory());
+        LOG("OpenCL program cache directory is " << openClProgramCacheDirectory());
+    }
+
+    tmp = params_->get("setup", "bootstrapWarmStart", false);
+    if (tmp != "") {
+        setBootstrapWarmStart(parseBool(tmp));
+        ore::data::BootstrapWarmStarts::instance().enable(bootstrapWarmStart());
+        LOG("Bootstrap warm start is " << (bootstrapWarmStart() ? "enabled" : "disabled"));
+    }
+
     tmp = params_->get("setup", "implyTodaysFixings", false);
     if (tmp != "")
         setImplyTodaysFixings(ore::data::parseBool(tmp));
@@ -902,6 +1012,18 @@ void OREAppInputParameters::loadParameters() {
         tmp = params_->get("sensitivity", "recalibrateModels", false);
         if (tmp != "")
             setSensiRecalibrateModels(parseBool(tmp));
+
+        tmp = params_->get("sensitivity", "skipUnaffectedTrades", false);
+        if (tmp != "")
+            setSensiSkipUnaffectedTrades(parseBool(tmp));
+
+        tmp = params_->get("sensitivity", "analyticLinearTrades", false);
+        if (tmp != "")
+            setSensiAnalyticLinearTrades(parseBool(tmp));
+
+        tmp = params_->get("sensitivity", "tradeBlockSize", false);
+        if (tmp != "")
+            setSensiTradeBlockSize(parseInteger(tmp));
     }
 
     /************
@@ -965,6 +1087,10 @@ void OREAppInputParameters::loadParameters() {
         if (tmp != "")
             setStressThreshold(parseReal(tmp));
 
+        tmp = params_->get("stress", "skipUnaffectedTrades", false);
+        if (tmp != "")
+            setStressSkipUnaffectedTrades(parseBool(tmp));
+
         tmp = params_->get("stress", "optimiseRiskFactors", false);
         if (tmp != "")
             setStressOptimiseRiskFactors(parseBool(tmp));
@@ -1440,6 +1566,90 @@ void OREAppInputParameters::loadParameters() {
     if (tmp != "")
         setAmcCg(parseBool(tmp));
 
+    tmp = params_->get("simulation", "amcSinglePrecisionPaths", false);
+    if (tmp != "")
+        setAmcSinglePrecisionPaths(parseBool(tmp));
+
+    tmp = params_->get("simulation", "amcProjectModel", false);
+    if (tmp != "")
+        setAmcProjectModel(parseBool(tmp));
+
+    tmp = params_->get("simulation", "scenarioPipelineDepth", false);
+    if (tmp != "")
+        setScenarioPipelineDepth(static_cast<Size>(parseInteger(tmp)));
+
+    tmp = params_->get("simulation", "scenarioStoreFile", false);
+    if (tmp != "")
+        setScenarioStoreFile((resultsPath() / tmp).generic_string());
+
+    tmp = params_->get("simulation", "scenarioStoreDoublePrecision", false);
+    if (tmp != "")
+        setScenarioStoreDoublePrecision(parseBool(tmp));
+
+    tmp = params_->get("simulation", "scenarioReplayFile", false);
+    if (tmp != "")
+        setScenarioReplayFile((resultsPath() / tmp).generic_string());
+
+    tmp = params_->get("simulation", "aggregationScenarioDataBinary", false);
+    if (tmp != "")
+        setAggregationScenarioDataBinary(parseBool(tmp));
+
+    tmp = params_->get("simulation", "aggregationScenarioDataDoublePrecision", false);
+    if (tmp != "")
+        setAggregationScenarioDataDoublePrecision(parseBool(tmp));
+
+    tmp = params_->get("simulation", "cubeLayout", false);
+    if (tmp != "")
+        setCubeLayout(tmp);
+
+    tmp = params_->get("simulation", "sparseCubeMaxOccupancy", false);
+    if (tmp != "")
+        setSparseCubeMaxOccupancy(parseReal(tmp));
+
+    tmp = params_->get("simulation", "costEstimation", false);
+    if (tmp != "")
+        setXvaCostEstimation(parseBool(tmp));
+
+    tmp = params_->get("simulation", "costEstimationSamples", false);
+    if (tmp != "")
+        setXvaCostEstimationSamples(static_cast<Size>(parseInteger(tmp)));
+
+    tmp = params_->get("simulation", "costEstimationTradesPerType", false);
+    if (tmp != "")
+        setXvaCostEstimationTradesPerType(static_cast<Size>(parseInteger(tmp)));
+
+    tmp = params_->get("simulation", "costEstimationTimeBudget", false);
+    if (tmp != "")
+        setXvaCostEstimationTimeBudget(parseReal(tmp));
+
+    tmp = params_->get("simulation", "groupTradesByPricingEngine", false);
+    if (tmp != "")
+        setXvaGroupTradesByPricingEngine(parseBool(tmp));
+
+    tmp = params_->get("simulation", "skipExpiredTrades", false);
+    if (tmp != "")
+        setXvaSkipExpiredTrades(parseBool(tmp));
+
+    tmp = params_->get("simulation", "adaptiveSamples", false);
+    if (tmp != "")
+        setXvaAdaptiveSamples(parseBool(tmp));
+
+    tmp = params_->get("simulation", "adaptiveSamplesBatchSize", false);
+    if (tmp != "")
+        setXvaAdaptiveSamplesBatchSize(static_cast<Size>(parseInteger(tmp)));
+
+    tmp = params_->get("simulation", "adaptiveSamplesConfidenceLevel", false);
+    if (tmp != "")
+        setXvaAdaptiveSamplesConfidenceLevel(parseReal(tmp));
+
+    tmp = params_->get("simulation", "adaptiveSamplesRelativeTolerance", false);
+    if (tmp != "")
+        setXvaAdaptiveSamplesRelativeTolerance(parseReal(tmp));
+
+    tmp = params_->get("simulation", "adaptiveSamplesAbsoluteTolerance", false);
+    if (tmp != "")
+        setXvaAdaptiveSamplesAbsoluteTolerance(parseReal(tmp));
+
     tmp = params_->get("simulation", "xvaCgSensitivityConfigFile", false);
     if (tmp != "") {
         string file = (inputPath / tmp).generic_string();
@@ -1468,6 +1678,16 @@ void OREAppInputParameters::loadParameters() {
             auto grid = scenarioGeneratorData()->getGrid();
             DLOG("grid size=" << grid->size() << ", dates=" << grid->dates().size() << ", valuationDates="
                               << grid->valuationDates().size() << ", closeOutDates=" << grid->closeOutDates().size());
+            // sample range k0,k1 of a sharded simulation, overwrites the first sample and samples in simulation.xml
+            tmp = params_->get("simulation", "sampleRange", false);
+            if (tmp != "") {
+                std::vector<Size> range = parseListOfValues<Size>(tmp, &parseInteger);
+                QL_REQUIRE(range.size() == 2 && range[0] < range[1],
+                           "simulation/sampleRange '" << tmp << "' invalid, expected k0,k1 with k0 < k1");
+                scenarioGeneratorData()->firstSample() = range[0];
+                scenarioGeneratorData()->samples() = range[1] - range[0];
+                LOG("Simulate sample range [" << range[0] << ", " << range[1] << ")");
+            }
         } else {
             ALOG("Simulation market, model and scenario generator data not loaded");
         }
@@ -1502,6 +1722,18 @@ void OREAppInputParameters::loadParameters() {
         else
             setExposureObservationModel(observationModel());
 
+        tmp = params_->get("simulation", "observationModelCalibrationSamples", false);
+        if (tmp != "")
+            setObservationModelCalibrationSamples(static_cast<Size>(parseInteger(tmp)));
+
+        tmp = params_->get("simulation", "observationModelCalibrationTradesPerType", false);
+        if (tmp != "")
+            setObservationModelCalibrationTradesPerType(static_cast<Size>(parseInteger(tmp)));
+
+        tmp = params_->get("simulation", "observationModelCalibrationTolerance", false);
+        if (tmp != "")
+            setObservationModelCalibrationTolerance(parseReal(tmp));
+
         tmp = params_->get("simulation", "storeFlows", false);
         if (tmp == "Y")
             setStoreFlows(true);
@@ -1544,6 +1776,18 @@ void OREAppInputParameters::loadParameters() {
 
         setXvaCgExternalComputeDevice(params_->get("simulation", "xvaCgExternalComputeDevice", false));
 
+        tmp = params_->get("simulation", "xvaCgCheckpointInterval", false);
+        if (!tmp.empty())
+            setXvaCgCheckpointInterval(static_cast<Size>(parseInteger(tmp)));
+
+        tmp = params_->get("simulation", "xvaCgExternalValidationTolerance", false);
+        if (!tmp.empty())
+            setXvaCgExternalValidationTolerance(parseReal(tmp));
+
+        tmp = params_->get("simulation", "xvaCgRegressionOnExternalDevice", false);
+        if (!tmp.empty())
+            setXvaCgRegressionOnExternalDevice(parseBool(tmp));
+
         tmp = params_->get("simulation", "xvaCgBumpSensis", false);
 	if (!tmp.empty())
 	    setXvaCgBumpSensis(parseBool(tmp));
@@ -1562,11 +1806,14 @@ void OREAppInputParameters::loadParameters() {
 
     if (analytics().find("XVA") != analytics().end() && analytics().find("EXPOSURE") == analytics().end()) {
         setLoadCube(true);
+        // a list of cube files is interpreted as partial cubes of consecutive sample ranges which are merged
         tmp = params_->get("xva", "cubeFile", false);
         if (tmp != "") {
-            string cubeFile = (resultsPath() / tmp).generic_string();
-            LOG("Load cube from file " << cubeFile);
-            setCubeFromFile(cubeFile);
+            std::vector<std::string> cubeFiles;
+            for (auto const& f : parseListOfValues(tmp))
+                cubeFiles.push_back((resultsPath() / f).generic_string());
+            LOG("Load cube from file(s) " << tmp);
+            setCubeFromFiles(cubeFiles);
             LOG("Cube loading done: ids=" << cube()->numIds() << " dates=" << cube()->numDates()
                                           << " samples=" << cube()->samples() << " depth=" << cube()->depth());
         } else {
@@ -1592,9 +1839,11 @@ void OREAppInputParameters::loadParameters() {
 
     tmp = params_->get("xva", "nettingSetCubeFile", false);
     if (loadCube() && tmp != "") {
-        string cubeFile = (resultsPath() / tmp).generic_string();
-        LOG("Load nettingset cube from file " << cubeFile);
-        setNettingSetCubeFromFile(cubeFile);
+        std::vector<std::string> cubeFiles;
+        for (auto const& f : parseListOfValues(tmp))
+            cubeFiles.push_back((resultsPath() / f).generic_string());
+        LOG("Load nettingset cube from file(s) " << tmp);
+        setNettingSetCubeFromFiles(cubeFiles);
         DLOG("NettingSetCube loading done: ids="
              << nettingSetCube()->numIds() << " dates=" << nettingSetCube()->numDates()
              << " samples=" << nettingSetCube()->samples() << " depth=" << nettingSetCube()->depth());
@@ -1602,18 +1851,22 @@ void OREAppInputParameters::loadParameters() {
 
     tmp = params_->get("xva", "cptyCubeFile", false);
     if (loadCube() && tmp != "") {
-        string cubeFile = resultsPath().string() + "/" + tmp;
-        LOG("Load cpty cube from file " << cubeFile);
-        setCptyCubeFromFile(cubeFile);
+        std::vector<std::string> cubeFiles;
+        for (auto const& f : parseListOfValues(tmp))
+            cubeFiles.push_back(resultsPath().string() + "/" + f);
+        LOG("Load cpty cube from file(s) " << tmp);
+        setCptyCubeFromFiles(cubeFiles);
         DLOG("CptyCube loading done: ids=" << cptyCube()->numIds() << " dates=" << cptyCube()->numDates()
                                            << " samples=" << cptyCube()->samples() << " depth=" << cptyCube()->depth());
     }
 
     tmp = params_->get("xva", "scenarioFile", false);
     if (loadCube() && tmp != "") {
-        string cubeFile = resultsPath().string() + "/" + tmp;
-        LOG("Load agg scen data from file " << cubeFile);
-        setMarketCubeFromFile(cubeFile);
+        std::vector<std::string> cubeFiles;
+        for (auto const& f : parseListOfValues(tmp))
+            cubeFiles.push_back(resultsPath().string() + "/" + f);
+        LOG("Load agg scen data from file(s) " << tmp);
+        setMarketCubeFromFiles(cubeFiles);
         LOG("MktCube loading done");
     }
 
@@ -1641,6 +1894,10 @@ void OREAppInputParameters::loadParameters() {
     if (tmp != "")
         setPfeQuantile(parseReal(tmp));
 
+    tmp = params_->get("xva", "quantileCompression", false);
+    if (tmp != "")
+        setPfeQuantileCompression(parseReal(tmp));
+
     tmp = params_->get("xva", "calculationType", false);
     if (tmp != "")
         setCollateralCalculationType(tmp);
@@ -1878,6 +2135,10 @@ void OREAppInputParameters::loadParameters() {
             }
         }
 
+        tmp = params_->get("xvaStress", "reuseBaseCube", false);
+        if (!tmp.empty())
+            setXvaStressReuseBaseCube(parseBool(tmp));
+
         tmp = params_->get("xvaStress", "sensitivityConfigFile", false);
         if (tmp != "") {
             string file = (inputPath / tmp).generic_string();
@@ -1910,6 +2171,14 @@ void OREAppInputParameters::loadParameters() {
         } else {
             WLOG("Xva sensitivity scenario data not loaded");
         }
+
+        tmp = params_->get("xvaSensitivity", "warmStartCalibration", false);
+        if (!tmp.empty())
+            setXvaSensiWarmStartCalibration(parseBool(tmp));
+
+        tmp = params_->get("xvaSensitivity", "method", false);
+        if (!tmp.empty())
+            setXvaSensiMethod(tmp);
     }
 
     /*************
@@ -2018,6 +2287,10 @@ void OREAppInputParameters::loadParameters() {
         if (tmp != "")
             setScenarioOutputZeroRate(parseBool(tmp));
 
+        tmp = params_->get("scenarioStatistics", "quantiles", false);
+        if (tmp != "")
+            setScenarioStatisticsQuantiles(parseListOfValues<Real>(tmp, &parseReal));
+
         tmp = params_->get("scenarioStatistics", "simulationConfigFile", false);
         if (tmp != "") {
             string simulationConfigFile = (inputPath / tmp).generic_string();
@@ -120,6 +120,12 @@ protected:
     bool progressLogToConsole_ = false;
     string structuredLogFile_ = "";
     QuantLib::Size structuredLogRotationSize_ = 100 * 1024 * 1024;
+    //! if true, the log file is written by an AsyncLogger
+    bool asyncLog_ = false;
+    QuantLib::Size asyncLogBufferSize_ = 65536;
+    AsyncLogger::OverflowPolicy asyncLogOverflowPolicy_ = AsyncLogger::OverflowPolicy::Block;
+    //! if not empty, a trace of the run is written to this file in the Chrome trace event format
+    string traceFile_ = "";
 
     // Cached error messages of a run
     std::vector<std::string> errorMessages_;
@@ -0,0 +1,185 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/app/pricingservice.hpp>
+
+#include <ored/marketdata/fixings.hpp>
+#include <ored/marketdata/todaysmarket.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/to_string.hpp>
+
+#include <ql/quotes/simplequote.hpp>
+#include <ql/settings.hpp>
+
+#include <boost/timer/timer.hpp>
+
+using namespace ore::data;
+using QuantLib::Date;
+using QuantLib::Real;
+
+namespace ore {
+namespace analytics {
+
+PricingService::PricingService(const QuantLib::ext::shared_ptr<InputParameters>& inputs,
+                               const QuantLib::ext::shared_ptr<InMemoryLoader>& loader)
+    : inputs_(inputs), loader_(loader) {
+    QL_REQUIRE(inputs_, "PricingService: no inputs given");
+    QL_REQUIRE(loader_, "PricingService: no loader given");
+    portfolio_ = QuantLib::ext::make_shared<Portfolio>(inputs_->buildFailedTrades());
+    if (inputs_->portfolio()) {
+        for (auto const& [tradeId, trade] : inputs_->portfolio()->trades())
+            portfolio_->add(trade);
+    }
+}
+
+bool PricingService::updateQuote(const std::string& name, const Real value) {
+    Date asof = inputs_->asof();
+    if (loader_->has(name, asof)) {
+        auto q = QuantLib::ext::dynamic_pointer_cast<QuantLib::SimpleQuote>(
+            loader_->get(name, asof)->quote().currentLink());
+        QL_REQUIRE(q, "PricingService: quote " << name << " is not a SimpleQuote, can not update it");
+        q->setValue(value);
+        TLOG("PricingService: updated quote " << name << " to " << value);
+        return true;
+    }
+    loader_->add(asof, name, value);
+    DLOG("PricingService: added quote " << name << ", the market will be rebuilt");
+    rebuildRequired_ = true;
+    return false;
+}
+
+bool PricingService::updateQuotes(const std::map<std::string, Real>& quotes) {
+    bool inPlace = true;
+    for (auto const& [name, value] : quotes)
+        inPlace = updateQuote(name, value) && inPlace;
+    return inPlace;
+}
+
+void PricingService::updateFixing(const std::string& name, const Date& date, const Real value) {
+    applyFixings({Fixing(date, name, value)});
+}
+
+void PricingService::addTrade(const QuantLib::ext::shared_ptr<Trade>& trade) {
+    QL_REQUIRE(trade, "PricingService: trade is null");
+    if (portfolio_->has(trade->id())) {
+        DLOG("PricingService: replace trade " << trade->id());
+        portfolio_->remove(trade->id());
+    }
+    portfolio_->add(trade);
+    pendingTrades_.insert(trade->id());
+}
+
+bool PricingService::removeTrade(const std::string& tradeId) {
+    pendingTrades_.erase(tradeId);
+    return portfolio_->remove(tradeId);
+}
+
+Real PricingService::npv(const std::string& tradeId) {
+    update();
+    auto trade = portfolio_->get(tradeId);
+    QL_REQUIRE(trade, "PricingService: trade " << tradeId << " not found");
+    try {
+        return trade->instrument()->NPV();
+    } catch (const std::exception& e) {
+        QL_FAIL("PricingService: failed to price trade " << tradeId << ": " << e.what());
+    }
+}
+
+std::map<std::string, Real> PricingService::npvs() {
+    update();
+    std::map<std::string, Real> result;
+    for (auto const& [tradeId, trade] : portfolio_->trades()) {
+        try {
+            result[tradeId] = trade->instrument()->NPV();
+        } catch (const std::exception& e) {
+            ALOG("PricingService: failed to price trade " << tradeId << ": " << e.what());
+        }
+    }
+    return result;
+}
+
+const QuantLib::ext::shared_ptr<Market>& PricingService::market() {
+    update();
+    return market_;
+}
+
+const QuantLib::ext::shared_ptr<EngineFactory>& PricingService::engineFactory() {
+    update();
+    return engineFactory_;
+}
+
+const QuantLib::ext::shared_ptr<Portfolio>& PricingService::portfolio() {
+    update();
+    return portfolio_;
+}
+
+void PricingService::update() {
+    QuantLib::Settings::instance().evaluationDate() = inputs_->asof();
+    if (rebuildRequired_) {
+        build();
+    } else if (!pendingTrades_.empty()) {
+        buildTrades(pendingTrades_);
+    }
+    pendingTrades_.clear();
+}
+
+void PricingService::build() {
+    boost::timer::cpu_timer timer;
+    LOG("PricingService: build market, engine factory and portfolio");
+
+    market_ = QuantLib::ext::make_shared<TodaysMarket>(
+        inputs_->asof(), inputs_->todaysMarketParams(), loader_, inputs_->curveConfigs().get(),
+        inputs_->continueOnError(), true, inputs_->lazyMarketBuilding(), inputs_->refDataManager(), false,
+        *inputs_->iborFallbackConfig());
+
+    auto engineData = QuantLib::ext::make_shared<EngineData>(*inputs_->pricingEngine());
+    engineData->globalParameters()["RunType"] = "NPV";
+    std::map<MarketContext, std::string> configurations;
+    configurations[MarketContext::irCalibration] = inputs_->marketConfig("lgmcalibration");
+    configurations[MarketContext::fxCalibration] = inputs_->marketConfig("fxcalibration");
+    configurations[MarketContext::pricing] = inputs_->marketConfig("pricing");
+    engineFactory_ = QuantLib::ext::make_shared<EngineFactory>(engineData, market_, configurations,
+                                                               inputs_->refDataManager(),
+                                                               *inputs_->iborFallbackConfig());
+
+    portfolio_->reset();
+    portfolio_->build(engineFactory_, "pricing service");
+    rebuildRequired_ = false;
+
+    timer.stop();
+    LOG("PricingService: built " << portfolio_->size() << " trades in "
+                                 << timer.format(boost::timer::default_places, "%w") << " seconds");
+}
+
+void PricingService::buildTrades(const std::set<std::string>& tradeIds) {
+    // build the trades in a separate portfolio, so that the other trades are not reset
+    Portfolio tmp(portfolio_->buildFailedTrades(), portfolio_->ignoreTradeBuildFail());
+    for (auto const& id : tradeIds) {
+        if (auto trade = portfolio_->get(id)) {
+            portfolio_->remove(id);
+            tmp.add(trade);
+        }
+    }
+    tmp.build(engineFactory_, "pricing service");
+    for (auto const& [tradeId, trade] : tmp.trades())
+        portfolio_->add(trade);
+    DLOG("PricingService: built " << tmp.size() << " of " << tradeIds.size() << " new trades");
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,100 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/app/pricingservice.hpp
+    \brief resident pricing of a portfolio under incremental market data and trade updates
+    \ingroup app
+*/
+
+#pragma once
+
+#include <orea/app/inputparameters.hpp>
+
+#include <ored/marketdata/inmemoryloader.hpp>
+#include <ored/marketdata/market.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+/*! The pricing service holds today's market, the engine factory and the built portfolio in memory, so that repeated
+    pricing requests after incremental market data, fixing and trade updates do not rebuild everything from scratch.
+
+    - A market data update of a quote that is already known to the loader is applied in place to its SimpleQuote.
+      The term structures and instruments observing the quote are recalculated on the next request, all other objects
+      keep their cached results. Term structures copying quote values on construction instead of linking to the quote
+      handle do not see such updates, call rebuild() to force a full rebuild in this case.
+    - New quotes are added to the loader and trigger a rebuild of the market and the portfolio on the next request.
+    - Fixing updates are applied to the IndexManager, which notifies the observing instruments.
+    - Added or amended trades are built against the existing engine factory, removed trades are dropped from the
+      portfolio, the other trades are not touched.
+
+    The market and the portfolio are configured by the inputs, the portfolio is initialised with the trades of
+    inputs->portfolio(). The service is not thread-safe, requests have to be serialised by the caller.
+*/
+class PricingService {
+public:
+    PricingService(const QuantLib::ext::shared_ptr<InputParameters>& inputs,
+                   const QuantLib::ext::shared_ptr<ore::data::InMemoryLoader>& loader);
+
+    //! Update the quote \p name for the asof date, returns false if the quote was new and requires a market rebuild
+    bool updateQuote(const std::string& name, const QuantLib::Real value);
+    //! Update several quotes, returns false if at least one of them requires a market rebuild
+    bool updateQuotes(const std::map<std::string, QuantLib::Real>& quotes);
+    //! Add or replace the fixing of index \p name on \p date
+    void updateFixing(const std::string& name, const QuantLib::Date& date, const QuantLib::Real value);
+
+    //! Add a trade, an existing trade with the same id is replaced
+    void addTrade(const QuantLib::ext::shared_ptr<ore::data::Trade>& trade);
+    //! Remove a trade, returns false if the trade is not in the portfolio
+    bool removeTrade(const std::string& tradeId);
+
+    //! NPV of a trade in its npv currency
+    QuantLib::Real npv(const std::string& tradeId);
+    //! NPVs of all trades in their npv currencies
+    std::map<std::string, QuantLib::Real> npvs();
+
+    //! Rebuild the market, the engine factory and the portfolio on the next request
+    void rebuild() { rebuildRequired_ = true; }
+
+    //! Inspectors, the market and the portfolio are built if required
+    const QuantLib::ext::shared_ptr<ore::data::Market>& market();
+    const QuantLib::ext::shared_ptr<ore::data::EngineFactory>& engineFactory();
+    const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio();
+
+private:
+    void update();
+    void build();
+    void buildTrades(const std::set<std::string>& tradeIds);
+
+    QuantLib::ext::shared_ptr<InputParameters> inputs_;
+    QuantLib::ext::shared_ptr<ore::data::InMemoryLoader> loader_;
+    QuantLib::ext::shared_ptr<ore::data::Market> market_;
+    QuantLib::ext::shared_ptr<ore::data::EngineFactory> engineFactory_;
+    QuantLib::ext::shared_ptr<ore::data::Portfolio> portfolio_;
+    bool rebuildRequired_ = true;
+    std::set<std::string> pendingTrades_;
+};
+
+} // namespace analytics
+} // namespace ore
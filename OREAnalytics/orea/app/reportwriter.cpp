@@ -1126,7 +1126,13 @@ void ReportWriter::writeScenarioReport(ore::data::Report& report,
                                        Real outputThreshold) {
 
     LOG("Writing Scenario report");
+    addScenarioReportColumns(report);
+    writeScenarioReportRecords(report, sensitivityCubes, outputThreshold);
+    report.end();
+    LOG("Scenario report finished");
+}
 
+void ReportWriter::addScenarioReportColumns(ore::data::Report& report) {
     report.addColumn("TradeId", string());
     report.addColumn("Factor", string());
     report.addColumn("Up/Down", string());
@@ -1135,7 +1141,11 @@ void ReportWriter::writeScenarioReport(ore::data::Report& report,
     report.addColumn("ShiftSize_2", double(), 6);
     report.addColumn("Scenario NPV", double(), 2);
     report.addColumn("Difference", double(), 2);
+}
 
+void ReportWriter::writeScenarioReportRecords(
+    ore::data::Report& report, const std::vector<QuantLib::ext::shared_ptr<SensitivityCube>>& sensitivityCubes,
+    Real outputThreshold) {
     for (auto const& sensitivityCube : sensitivityCubes) {
 
         auto scenarioDescriptions = sensitivityCube->scenarioDescriptions();
@@ -1172,16 +1182,19 @@ void ReportWriter::writeScenarioReport(ore::data::Report& report,
             }
         }
     }
-
-    report.end();
-    LOG("Scenario report finished");
 }
 
 void ReportWriter::writeSensitivityReport(Report& report, const QuantLib::ext::shared_ptr<SensitivityStream>& ss,
                                           Real outputThreshold, Size outputPrecision) {
 
     LOG("Writing Sensitivity report");
+    addSensitivityReportColumns(report, outputPrecision);
+    writeSensitivityReportRecords(report, ss, outputThreshold);
+    report.end();
+    LOG("Sensitivity report finished");
+}
 
+void ReportWriter::addSensitivityReportColumns(Report& report, Size outputPrecision) {
     Size shiftSizePrecision = outputPrecision < 6 ? 6 : outputPrecision;
     Size amountPrecision = outputPrecision < 2 ? 2 : outputPrecision;
 
@@ -1195,7 +1208,10 @@ void ReportWriter::writeSensitivityReport(Report& report, const QuantLib::ext::s
     report.addColumn("Base NPV", double(), amountPrecision);
     report.addColumn("Delta", double(), amountPrecision);
     report.addColumn("Gamma", double(), amountPrecision);
+}
 
+void ReportWriter::writeSensitivityReportRecords(Report& report, const QuantLib::ext::shared_ptr<SensitivityStream>& ss,
+                                                 Real outputThreshold) {
     // Make sure that we are starting from the start
     ss->reset();
     while (SensitivityRecord sr = ss->next()) {
@@ -1217,9 +1233,6 @@ void ReportWriter::writeSensitivityReport(Report& report, const QuantLib::ext::s
             ALOG("sensitivity record has infinite values: " << sr);
         }
     }
-
-    report.end();
-    LOG("Sensitivity report finished");
 }
 
 void ReportWriter::writeSensitivityConfigReport(ore::data::Report& report,
@@ -1478,19 +1491,144 @@ void ReportWriter::writePricingStats(ore::data::Report& report, const QuantLib::
         .addColumn("TradeType", string())
         .addColumn("NumberOfPricings", Size())
         .addColumn("CumulativeTiming", Size())
-        .addColumn("AverageTiming", Size());
+        .addColumn("AverageTiming", Size())
+        .addColumn("PricingEngine", string());
 
     for (auto const& [tid, trade] : portfolio->trades()) {
         std::size_t num = trade->getNumberOfPricings();
         Size cumulative = trade->getCumulativePricingTime() / 1000;
         Size average = num > 0 ? cumulative / num : 0;
-        report.next().add(tid).add(trade->tradeType()).add(num).add(cumulative).add(average);
+        report.next().add(tid).add(trade->tradeType()).add(num).add(cumulative).add(average).add(
+            trade->pricingEngine());
     }
 
     report.end();
     LOG("Pricing stats report written");
 }
 
+void ReportWriter::writePricingStatsByEngine(ore::data::Report& report,
+                                             const QuantLib::ext::shared_ptr<Portfolio>& portfolio) {
+
+    LOG("Writing Pricing stats by engine report");
+
+    report.addColumn("TradeType", string())
+        .addColumn("PricingEngine", string())
+        .addColumn("NumberOfTrades", Size())
+        .addColumn("NumberOfPricings", Size())
+        .addColumn("CumulativeTiming", Size())
+        .addColumn("AverageTiming", Size());
+
+    // trades, pricings and cumulative time per trade type and engine
+    std::map<std::pair<string, string>, std::tuple<Size, Size, boost::timer::nanosecond_type>> stats;
+    for (auto const& [tid, trade] : portfolio->trades()) {
+        auto& [trades, num, timing] = stats[std::make_pair(trade->tradeType(), trade->pricingEngine())];
+        ++trades;
+        num += trade->getNumberOfPricings();
+        timing += trade->getCumulativePricingTime();
+    }
+
+    for (auto const& [key, s] : stats) {
+        auto const& [trades, num, timing] = s;
+        Size cumulative = timing / 1000;
+        Size average = num > 0 ? cumulative / num : 0;
+        report.next().add(key.first).add(key.second).add(trades).add(num).add(cumulative).add(average);
+    }
+
+    report.end();
+    LOG("Pricing stats by engine report written");
+}
+
+void ReportWriter::writePricingStatsByDate(ore::data::Report& report, const std::vector<Date>& dates,
+                                           const std::vector<Size>& pricings, const std::vector<double>& pricingTimes) {
+
+    LOG("Writing Pricing stats by date report");
+
+    QL_REQUIRE(dates.size() == pricings.size() && dates.size() == pricingTimes.size(),
+               "writePricingStatsByDate(): dates (" << dates.size() << "), pricings (" << pricings.size()
+                                                    << ") and pricing times (" << pricingTimes.size()
+                                                    << ") must have the same size");
+
+    report.addColumn("DateIndex", Size())
+        .addColumn("Date", Date())
+        .addColumn("NumberOfPricings", Size())
+        .addColumn("PricingTime", double(), 6);
+
+    for (Size i = 0; i < dates.size(); ++i)
+        report.next().add(i).add(dates[i]).add(pricings[i]).add(pricingTimes[i]);
+
+    report.end();
+    LOG("Pricing stats by date report written");
+}
+
+void ReportWriter::writeMemoryStats(ore::data::Report& report,
+                                    const std::vector<QuantExt::MemoryAccounting::StageStats>& stages) {
+
+    LOG("Writing memory stats report");
+
+    report.addColumn("Stage", string())
+        .addColumn("Category", string())
+        .addColumn("CurrentBytes", Size())
+        .addColumn("PeakBytes", Size());
+
+    for (auto const& s : stages) {
+        Size total = 0;
+        for (Size i = 0; i < QuantExt::MemoryAccounting::numberOfCategories; ++i) {
+            report.next()
+                .add(s.name)
+                .add(ore::data::to_string(static_cast<QuantExt::MemoryAccounting::Category>(i)))
+                .add(s.current[i])
+                .add(s.peak[i]);
+            total += s.current[i];
+        }
+        report.next().add(s.name).add(string("Total")).add(total).add(s.totalPeak);
+        LOG("Memory stage '" << s.name << "': accounted " << total << " bytes, peak " << s.totalPeak << " bytes");
+    }
+
+    report.end();
+    LOG("Memory stats report written");
+}
+
+void ReportWriter::writeCubeCostEstimate(ore::data::Report& report, ore::data::Report& summary,
+                                         const CubeCostEstimate& estimate) {
+
+    LOG("Writing cube cost estimate reports");
+
+    report.addColumn("TradeType", string())
+        .addColumn("NumberOfTrades", Size())
+        .addColumn("SampledTrades", Size())
+        .addColumn("TimePerTradeAndSample", double(), 9)
+        .addColumn("EstimatedPricingTime", double(), 3);
+    for (auto const& [type, c] : estimate.tradeTypes)
+        report.next().add(type).add(c.trades).add(c.sampledTrades).add(c.timePerTradeAndSample).add(c.pricingTime);
+    report.end();
+
+    summary.addColumn("Key", string()).addColumn("Value", string());
+    auto add = [&summary](const string& key, const string& value) { summary.next().add(key).add(value); };
+    add("Trades", to_string(estimate.trades));
+    add("Dates", to_string(estimate.dates));
+    add("Samples", to_string(estimate.samples));
+    add("Depth", to_string(estimate.depth));
+    add("Threads", to_string(estimate.threads));
+    add("EstimationSamples", to_string(estimate.estimationSamples));
+    add("EstimationTime", to_string(estimate.estimationTime));
+    add("SetupTime", to_string(estimate.setupTime));
+    add("OverheadPerSample", to_string(estimate.overheadPerSample));
+    add("EstimatedCpuTime", to_string(estimate.cpuTime));
+    add("EstimatedWallTime", to_string(estimate.wallTime));
+    add("EstimatedCubeBytes", to_string(estimate.cubeBytes));
+    add("EstimatedScenarioDataBytes", to_string(estimate.scenarioDataBytes));
+    if (estimate.timeBudget > 0.0) {
+        add("TimeBudget", to_string(estimate.timeBudget));
+        add("SuggestedThreads", to_string(estimate.suggestedThreads));
+        add("SuggestedSampleChunks", to_string(estimate.suggestedSampleChunks));
+        add("SamplesPerChunk", to_string((estimate.samples + estimate.suggestedSampleChunks - 1) /
+                                         std::max<Size>(1, estimate.suggestedSampleChunks)));
+    }
+    summary.end();
+
+    LOG("Cube cost estimate reports written");
+}
+
 void ReportWriter::writeCube(ore::data::Report& report, const QuantLib::ext::shared_ptr<NPVCube>& cube,
                              const std::map<std::string, std::string>& nettingSetMap) {
     LOG("Writing cube report");
@@ -1958,6 +2096,16 @@ void ReportWriter::writeCrifReport(const QuantLib::ext::shared_ptr<Report>& repo
 void ReportWriter::writeScenarioStatistics(const QuantLib::ext::shared_ptr<ScenarioGenerator>& generator,
     const std::vector<RiskFactorKey>& keys, const Size numPaths,
     const std::vector<Date>& dates, ore::data::Report& report) {
+    ScenarioStatisticsGenerator statistics(generator, keys, dates);
+    for (Size i = 0; i < numPaths; ++i) {
+        for (Size d = 0; d < dates.size(); ++d) {
+            std::ignore = statistics.next(dates[d]);
+        }
+    }
+    writeScenarioStatistics(statistics, report);
+}
+
+void ReportWriter::writeScenarioStatistics(const ScenarioStatisticsGenerator& statistics, ore::data::Report& report) {
     report.addColumn("Date", Date())
         .addColumn("Key", string())
         .addColumn("min", double(), 8)
@@ -1966,38 +2114,30 @@ void ReportWriter::writeScenarioStatistics(const QuantLib::ext::shared_ptr<Scena
         .addColumn("stddev", double(), 8)
         .addColumn("skewness", double(), 8)
         .addColumn("kurtosis", double(), 8);
+    for (auto const& p : statistics.quantiles())
+        report.addColumn("quantile_" + ore::data::to_string(p), double(), 8);
 
-    std::vector<boost::accumulators::accumulator_set<
-        double, boost::accumulators::stats<boost::accumulators::tag::min, boost::accumulators::tag::max,
-        boost::accumulators::tag::mean, boost::accumulators::tag::variance,
-        boost::accumulators::tag::skewness, boost::accumulators::tag::kurtosis>>>
-        acc(keys.size() * dates.size());
-
-    for (Size i = 0; i < numPaths; ++i) {
-        for (Size d = 0; d < dates.size(); ++d) {
-            QuantLib::ext::shared_ptr<Scenario> currentScenario = generator->next(dates[d]);
-            for (Size k = 0; k < keys.size(); ++k) {
-                acc[d * keys.size() + k](currentScenario->get(keys[k]));
-            }
-        }
-    }
+    const std::vector<Date>& dates = statistics.dates();
+    const std::vector<RiskFactorKey>& keys = statistics.keys();
     for (Size d = 0; d < dates.size(); ++d) {
         for (Size k = 0; k < keys.size(); ++k) {
-            Size idx = d * keys.size() + k;
+            const OnlineMoments& m = statistics.moments(d, k);
             report.next()
                 .add(dates[d])
                 .add(ore::data::to_string(keys[k]))
-                .add(boost::accumulators::min(acc[idx]))
-                .add(boost::accumulators::mean(acc[idx]))
-                .add(boost::accumulators::max(acc[idx]))
-                .add(std::sqrt(boost::accumulators::variance(acc[idx])));
-            if (!close_enough(boost::accumulators::variance(acc[idx]), 0.0)) {
-                report.add(boost::accumulators::skewness(acc[idx])).add(boost::accumulators::kurtosis(acc[idx]));
+                .add(m.min())
+                .add(m.mean())
+                .add(m.max())
+                .add(std::sqrt(m.variance()));
+            if (!close_enough(m.variance(), 0.0)) {
+                report.add(m.skewness()).add(m.kurtosis());
             }
             else {
                 // avoid ReportWriter::non-sensical output
                 report.add(0.0).add(0.0);
             }
+            for (Size q = 0; q < statistics.quantiles().size(); ++q)
+                report.add(statistics.quantile(d, k, q));
         }
     }
     report.end();
@@ -2060,6 +2200,67 @@ void ReportWriter::writeScenarioDistributions(const QuantLib::ext::shared_ptr<Sc
     report.end();
 }
 
+void ReportWriter::writeScenarioDistributions(const QuantLib::ext::shared_ptr<ScenarioGenerator>& generator,
+                                              const ScenarioStatisticsGenerator& statistics, const Size numPaths,
+                                              const Size distSteps, ore::data::Report& report) {
+    report.addColumn("Date", Date())
+        .addColumn("Key", string())
+        .addColumn("Bound", double(), 8)
+        .addColumn("Count", Size());
+
+    QL_REQUIRE(distSteps > 0, "writeScenarioDistributions(): number of buckets must be positive");
+    const std::vector<Date>& dates = statistics.dates();
+    const std::vector<RiskFactorKey>& keys = statistics.keys();
+    std::vector<Real> xmin(dates.size() * keys.size()), h(dates.size() * keys.size());
+    for (Size d = 0; d < dates.size(); ++d) {
+        for (Size k = 0; k < keys.size(); ++k) {
+            const OnlineMoments& m = statistics.moments(d, k);
+            QL_REQUIRE(m.count() > 0, "writeScenarioDistributions(): no statistics for "
+                                          << QuantLib::io::iso_date(dates[d]) << ", " << keys[k]);
+            xmin[d * keys.size() + k] = m.min();
+            h[d * keys.size() + k] = (m.max() - m.min()) / static_cast<Real>(distSteps);
+        }
+    }
+
+    /* Count the values per bucket as they are generated. A value x goes to the first bucket i with
+       x <= xmin + (i + 1) * h, the last bucket takes the remaining values, as in distributionCount() above. The
+       bucket is estimated from (x - xmin) / h and then corrected so that the comparison is the same. */
+    std::vector<Size> counts(dates.size() * keys.size() * distSteps, 0);
+    for (Size i = 0; i < numPaths; ++i) {
+        for (Size d = 0; d < dates.size(); ++d) {
+            QuantLib::ext::shared_ptr<Scenario> currentScenario = generator->next(dates[d]);
+            for (Size k = 0; k < keys.size(); ++k) {
+                Size idx = d * keys.size() + k;
+                Real x = currentScenario->get(keys[k]);
+                Size b = 0;
+                if (h[idx] > 0.0) {
+                    Real e = std::ceil((x - xmin[idx]) / h[idx]) - 1.0;
+                    b = e <= 0.0 ? 0 : std::min<Size>(static_cast<Size>(e), distSteps - 1);
+                    while (b > 0 && x <= xmin[idx] + static_cast<Real>(b) * h[idx])
+                        --b;
+                    while (b < distSteps - 1 && x > xmin[idx] + static_cast<Real>(b + 1) * h[idx])
+                        ++b;
+                }
+                ++counts[idx * distSteps + b];
+            }
+        }
+    }
+
+    for (Size d = 0; d < dates.size(); ++d) {
+        for (Size k = 0; k < keys.size(); ++k) {
+            Size idx = d * keys.size() + k;
+            for (Size i = 0; i < distSteps; ++i) {
+                report.next()
+                    .add(dates[d])
+                    .add(ore::data::to_string(keys[k]))
+                    .add(xmin[idx] + static_cast<Real>(i + 1) * h[idx])
+                    .add(counts[idx * distSteps + i]);
+            }
+        }
+    }
+    report.end();
+}
+
 void ReportWriter::writeHistoricalScenarioDetails(
     const QuantLib::ext::shared_ptr<ore::analytics::HistoricalScenarioGenerator>& generator, ore::data::Report& report) {
 
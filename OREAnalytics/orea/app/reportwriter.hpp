@@ -29,12 +29,14 @@
 #include <orea/app/parameters.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/sensitivitycube.hpp>
+#include <orea/engine/cubecostestimator.hpp>
 #include <orea/engine/sensitivitystream.hpp>
 #include <orea/simm/crifrecord.hpp>
 #include <orea/simm/simmresults.hpp>
 #include <orea/simm/crif.hpp>
 #include <orea/simm/imschedulecalculator.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
+#include <orea/scenario/scenariostatistics.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/marketdata/todaysmarketparameters.hpp>
 #include <ored/marketdata/todaysmarketcalibrationinfo.hpp>
@@ -44,6 +46,7 @@
 #include <ored/report/inmemoryreport.hpp>
 #include <ored/utilities/dategrid.hpp>
 #include <ored/utilities/xmlutils.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
 #include <string>
 
 namespace ore {
@@ -107,6 +110,19 @@ public:
     virtual void writeSensitivityReport(ore::data::Report& report, const QuantLib::ext::shared_ptr<SensitivityStream>& ss,
                                         QuantLib::Real outputThreshold = 0.0, QuantLib::Size outputPrecision = 2);
 
+    //! the parts of writeScenarioReport() and writeSensitivityReport(), to write the reports incrementally
+    //@{
+    virtual void addScenarioReportColumns(ore::data::Report& report);
+    virtual void
+    writeScenarioReportRecords(ore::data::Report& report,
+                               const std::vector<QuantLib::ext::shared_ptr<SensitivityCube>>& sensitivityCubes,
+                               QuantLib::Real outputThreshold = 0.0);
+    virtual void addSensitivityReportColumns(ore::data::Report& report, QuantLib::Size outputPrecision = 2);
+    virtual void writeSensitivityReportRecords(ore::data::Report& report,
+                                               const QuantLib::ext::shared_ptr<SensitivityStream>& ss,
+                                               QuantLib::Real outputThreshold = 0.0);
+    //@}
+
     virtual void writeSensitivityConfigReport(ore::data::Report& report,
                                               const std::map<RiskFactorKey, QuantLib::Real>& shiftSizes,
                                               const std::map<RiskFactorKey, QuantLib::Real>& baseValues,
@@ -126,6 +142,24 @@ public:
 
     virtual void writePricingStats(ore::data::Report& report, const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
 
+    //! pricing stats aggregated by trade type and pricing engine
+    virtual void writePricingStatsByEngine(ore::data::Report& report,
+                                           const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
+
+    //! number of trade calculations and pricing time (in seconds) per simulation date
+    virtual void writePricingStatsByDate(ore::data::Report& report, const std::vector<QuantLib::Date>& dates,
+                                         const std::vector<QuantLib::Size>& pricings,
+                                         const std::vector<double>& pricingTimes);
+
+    /*! accounted memory (in bytes) at the end and high water mark during each stage per category, the row with
+        category Total gives the sum over all categories */
+    virtual void writeMemoryStats(ore::data::Report& report,
+                                  const std::vector<QuantExt::MemoryAccounting::StageStats>& stages);
+
+    //! cube cost estimate per trade type (times in seconds) and the summary as key value pairs
+    virtual void writeCubeCostEstimate(ore::data::Report& report, ore::data::Report& summary,
+                                       const CubeCostEstimate& estimate);
+
     virtual void writeCube(ore::data::Report& report, const QuantLib::ext::shared_ptr<NPVCube>& cube,
                            const std::map<std::string, std::string>& nettingSetMap = std::map<std::string, std::string>());
 
@@ -171,6 +205,18 @@ public:
                                             QuantLib::Size numPaths, const std::vector<QuantLib::Date>& dates,
                                             QuantLib::Size distSteps, ore::data::Report& report);
 
+    //! Write the statistics collected by a ScenarioStatisticsGenerator, with one column per quantile estimate
+    virtual void writeScenarioStatistics(const ore::analytics::ScenarioStatisticsGenerator& statistics,
+                                         ore::data::Report& report);
+
+    /*! Write the distributions of the scenarios on the dates and keys of the given statistics, the buckets are
+        determined by the ranges collected there. The counts are accumulated as the numPaths paths are generated,
+        so that, other than in the overload above, no scenario values are stored. */
+    virtual void
+    writeScenarioDistributions(const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGenerator>& generator,
+                               const ore::analytics::ScenarioStatisticsGenerator& statistics, QuantLib::Size numPaths,
+                               QuantLib::Size distSteps, ore::data::Report& report);
+
     virtual void
     writeHistoricalScenarioDetails(const QuantLib::ext::shared_ptr<ore::analytics::HistoricalScenarioGenerator>& generator,
                                    ore::data::Report& report);
@@ -18,6 +18,7 @@
 
 #include <orea/cube/cube_io.hpp>
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/mappedfilecube.hpp>
 
 #include <ored/utilities/to_string.hpp>
 
@@ -28,6 +29,16 @@
 #endif
 #include <boost/iostreams/filtering_stream.hpp>
 
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#ifdef ORE_USE_ZLIB
+#include <boost/iostreams/filter/zlib.hpp>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <future>
 #include <iomanip>
 #include <regex>
 
@@ -58,12 +69,141 @@ std::string getMetaData(const std::string& line, const std::string& tag, const b
     return line.substr(0, 1) == "#" && line.substr(2, tag.size()) == tag ? line.substr(15) : std::string();
 }
 
+QuantLib::ext::shared_ptr<NPVCube> createInMemoryCube(const QuantLib::Date& asof, const std::set<std::string>& ids,
+                                                      const std::vector<QuantLib::Date>& dates, const Size samples,
+                                                      const Size depth, const bool doublePrecision) {
+    if (doublePrecision && depth <= 1) {
+        return QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0);
+    } else if (doublePrecision && depth > 1) {
+        return QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0);
+    } else if (!doublePrecision && depth <= 1) {
+        return QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
+    } else {
+        return QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0f);
+    }
+}
+
+// binary format: magic (8 bytes), version, flags, value size (uint32 each), asof serial (int64), numIds, numDates,
+// samples, depth (uint64 each), dates (int64 serials), ids (uint64 length + characters), scenario generator data
+// xml (uint64 length + characters, empty if not given), storeFlows (int64, -1 if not given), storeCreditStateNPVs
+// (int64, -1 if not given), block index (numDates + 1 entries of offset, stored size, raw size, uint64 each),
+// blocks (T0 block with values [id][depth], then one block per date with values [id][sample][depth])
+
+constexpr char binaryCubeMagic[8] = {'O', 'R', 'E', 'C', 'U', 'B', 'E', 'B'};
+constexpr std::uint32_t binaryCubeVersion = 1;
+constexpr std::uint32_t binaryCubeCompressed = 1;
+
+bool isBinaryCube(const std::string& filename) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    char magic[8];
+    return in.read(magic, 8) && std::memcmp(magic, binaryCubeMagic, 8) == 0;
+}
+
+// binary aggregation scenario data format: magic (8 bytes), version, flags, value size (uint32 each), dimDates,
+// dimSamples, numKeys (uint64 each), keys (type as uint32, qualifier as uint64 length + characters), block index
+// (numKeys entries of offset, stored size, raw size, uint64 each), blocks (one per key with values [date][sample])
+
+constexpr char binaryAsdMagic[8] = {'O', 'R', 'E', 'A', 'S', 'D', 'A', 'B'};
+constexpr std::uint32_t binaryAsdVersion = 1;
+
+bool isBinaryAggregationScenarioData(const std::string& filename) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    char magic[8];
+    return in.read(magic, 8) && std::memcmp(magic, binaryAsdMagic, 8) == 0;
+}
+
+struct BinaryCubeBlock {
+    std::uint64_t offset, storedSize, rawSize;
+};
+
+template <typename V> void writeBinary(std::ostream& out, const V& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(V));
+}
+
+void writeBinary(std::ostream& out, const std::string& v) {
+    writeBinary(out, static_cast<std::uint64_t>(v.size()));
+    out.write(v.data(), v.size());
+}
+
+template <typename V>
+V readBinary(std::istream& in, const std::string& filename, const char* context = "loadCubeBinary()") {
+    V v;
+    in.read(reinterpret_cast<char*>(&v), sizeof(V));
+    QL_REQUIRE(in, context << ": unexpected end of file '" << filename << "'");
+    return v;
+}
+
+std::string readBinaryString(std::istream& in, const std::string& filename, const char* context = "loadCubeBinary()") {
+    std::string v(readBinary<std::uint64_t>(in, filename, context), ' ');
+    if (!v.empty())
+        in.read(&v[0], v.size());
+    QL_REQUIRE(in, context << ": unexpected end of file '" << filename << "'");
+    return v;
+}
+
+std::string compressBlock(const std::string& raw, const char* context = "saveCubeBinary()") {
+#ifdef ORE_USE_ZLIB
+    std::string result;
+    boost::iostreams::filtering_ostream out;
+    out.push(boost::iostreams::zlib_compressor());
+    out.push(boost::iostreams::back_inserter(result));
+    out.write(raw.data(), raw.size());
+    out.reset();
+    return result;
+#else
+    QL_FAIL(context << ": compression requires a build with ORE_USE_ZLIB");
+#endif
+}
+
+std::string decompressBlock(const std::string& stored, const std::uint64_t rawSize,
+                            const char* context = "loadCubeBinary()") {
+#ifdef ORE_USE_ZLIB
+    std::string result;
+    result.reserve(rawSize);
+    boost::iostreams::filtering_istream in;
+    in.push(boost::iostreams::zlib_decompressor());
+    in.push(boost::iostreams::array_source(stored.data(), stored.size()));
+    boost::iostreams::copy(in, boost::iostreams::back_inserter(result));
+    QL_REQUIRE(result.size() == rawSize,
+               context << ": decompressed block has size " << result.size() << ", expected " << rawSize);
+    return result;
+#else
+    QL_FAIL(context << ": file is compressed, this requires a build with ORE_USE_ZLIB");
+#endif
+}
+
+template <typename T> void appendValue(std::string& block, const Real value) {
+    T v = static_cast<T>(value);
+    block.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T> Real extractValue(const std::string& block, const Size pos) {
+    T v;
+    std::memcpy(&v, block.data() + pos * sizeof(T), sizeof(T));
+    return static_cast<Real>(v);
+}
+
 } // namespace
 
 NPVCubeWithMetaData loadCube(const std::string& filename, const bool doublePrecision) {
 
     NPVCubeWithMetaData result;
 
+    // memory-mapped cube files are not parsed, but opened read-only and paged in on access
+
+    if (isMappedFileCube(filename)) {
+        result.cube = QuantLib::ext::make_shared<MappedFileNPVCube>(filename);
+        LOG("opened mapped file cube " << filename << ": asof = " << result.cube->asof() << ", dim = "
+                                       << result.cube->numIds() << " x " << result.cube->numDates() << " x "
+                                       << result.cube->samples() << " x " << result.cube->depth());
+        return result;
+    }
+
+    // binary cube files are read block-wise
+
+    if (isBinaryCube(filename))
+        return loadCubeBinary(filename, doublePrecision);
+
     // open file
 
     bool gzip = use_compression(filename);
@@ -126,16 +266,7 @@ NPVCubeWithMetaData loadCube(const std::string& filename, const bool doublePreci
         DLOG("overwrite storeCreditStateNPVs with meta data from cube: " << md);
     }
 
-    QuantLib::ext::shared_ptr<NPVCube> cube;
-    if (doublePrecision && depth <= 1) {
-        cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0);
-    } else if (doublePrecision && depth > 1) {
-        cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0);
-    } else if (!doublePrecision && depth <= 1) {
-        cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
-    } else if (!doublePrecision && depth > 1) {
-        cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, depth, 0.0f);
-    }
+    QuantLib::ext::shared_ptr<NPVCube> cube = createInMemoryCube(asof, ids, dates, samples, depth, doublePrecision);
     result.cube = cube;
 
     vector<string> tokens;
@@ -231,8 +362,241 @@ void saveCube(const std::string& filename, const NPVCubeWithMetaData& cube, cons
     }
 }
 
+void saveCubeBinary(const std::string& filename, const NPVCubeWithMetaData& cube, const bool doublePrecision,
+                    const bool compress) {
+
+    const auto& c = *cube.cube;
+
+#ifndef ORE_USE_ZLIB
+    if (compress)
+        WLOG("saveCubeBinary(): compression requested, but this requires a build with ORE_USE_ZLIB, will write "
+             "uncompressed blocks to '"
+             << filename << "'");
+    const bool doCompress = false;
+#else
+    const bool doCompress = compress;
+#endif
+
+    std::uint32_t valueSize = doublePrecision ? sizeof(double) : sizeof(float);
+
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(out, "saveCubeBinary(): can not open '" << filename << "' for writing");
+
+    // header
+
+    out.write(binaryCubeMagic, 8);
+    writeBinary(out, binaryCubeVersion);
+    writeBinary(out, doCompress ? binaryCubeCompressed : std::uint32_t(0));
+    writeBinary(out, valueSize);
+    writeBinary(out, static_cast<std::int64_t>(c.asof().serialNumber()));
+    writeBinary(out, static_cast<std::uint64_t>(c.numIds()));
+    writeBinary(out, static_cast<std::uint64_t>(c.numDates()));
+    writeBinary(out, static_cast<std::uint64_t>(c.samples()));
+    writeBinary(out, static_cast<std::uint64_t>(c.depth()));
+    for (auto const& d : c.dates())
+        writeBinary(out, static_cast<std::int64_t>(d.serialNumber()));
+    std::vector<std::string> ids(c.numIds());
+    for (auto const& [id, pos] : c.idsAndIndexes())
+        ids[pos] = id;
+    for (auto const& id : ids)
+        writeBinary(out, id);
+    writeBinary(out, cube.scenarioGeneratorData ? cube.scenarioGeneratorData->toXMLString() : std::string());
+    writeBinary(out, static_cast<std::int64_t>(cube.storeFlows ? (*cube.storeFlows ? 1 : 0) : -1));
+    writeBinary(out, static_cast<std::int64_t>(cube.storeCreditStateNPVs ? *cube.storeCreditStateNPVs : -1));
+
+    // placeholder for the block index, which is written once the block sizes are known
+
+    std::vector<BinaryCubeBlock> index(c.numDates() + 1);
+    auto indexPos = out.tellp();
+    for (auto const& b : index) {
+        writeBinary(out, b.offset);
+        writeBinary(out, b.storedSize);
+        writeBinary(out, b.rawSize);
+    }
+
+    // blocks
+
+    std::string block;
+    for (Size j = 0; j <= c.numDates(); ++j) {
+        block.clear();
+        for (Size i = 0; i < c.numIds(); ++i) {
+            for (Size k = 0; k < (j == 0 ? 1 : c.samples()); ++k) {
+                for (Size d = 0; d < c.depth(); ++d) {
+                    Real v = j == 0 ? c.getT0(i, d) : c.get(i, j - 1, k, d);
+                    if (doublePrecision)
+                        appendValue<double>(block, v);
+                    else
+                        appendValue<float>(block, v);
+                }
+            }
+        }
+        index[j].offset = static_cast<std::uint64_t>(out.tellp());
+        index[j].rawSize = block.size();
+        if (doCompress) {
+            std::string stored = compressBlock(block);
+            index[j].storedSize = stored.size();
+            out.write(stored.data(), stored.size());
+        } else {
+            index[j].storedSize = block.size();
+            out.write(block.data(), block.size());
+        }
+    }
+
+    out.seekp(indexPos);
+    for (auto const& b : index) {
+        writeBinary(out, b.offset);
+        writeBinary(out, b.storedSize);
+        writeBinary(out, b.rawSize);
+    }
+    out.close();
+    QL_REQUIRE(out, "saveCubeBinary(): error while writing '" << filename << "'");
+
+    LOG("saved binary cube to " << filename << ": asof = " << c.asof() << ", dim = " << c.numIds() << " x "
+                                << c.numDates() << " x " << c.samples() << " x " << c.depth()
+                                << ", compressed = " << std::boolalpha << doCompress);
+}
+
+NPVCubeWithMetaData loadCubeBinary(const std::string& filename, const bool doublePrecision,
+                                   const std::set<std::string>& ids, const std::set<QuantLib::Date>& dates,
+                                   const Size nThreads) {
+
+    NPVCubeWithMetaData result;
+
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    QL_REQUIRE(in, "loadCubeBinary(): can not open '" << filename << "'");
+
+    // read header
+
+    char magic[8];
+    in.read(magic, 8);
+    QL_REQUIRE(in && std::memcmp(magic, binaryCubeMagic, 8) == 0,
+               "loadCubeBinary(): '" << filename << "' is not a binary cube file");
+    auto version = readBinary<std::uint32_t>(in, filename);
+    QL_REQUIRE(version == binaryCubeVersion, "loadCubeBinary(): unsupported version "
+                                                 << version << " in '" << filename << "', expected "
+                                                 << binaryCubeVersion);
+    bool compressed = (readBinary<std::uint32_t>(in, filename) & binaryCubeCompressed) != 0;
+    auto valueSize = readBinary<std::uint32_t>(in, filename);
+    QL_REQUIRE(valueSize == sizeof(float) || valueSize == sizeof(double),
+               "loadCubeBinary(): invalid value size " << valueSize << " in '" << filename << "'");
+    QuantLib::Date asof(static_cast<QuantLib::Date::serial_type>(readBinary<std::int64_t>(in, filename)));
+    Size numIds = readBinary<std::uint64_t>(in, filename);
+    Size numDates = readBinary<std::uint64_t>(in, filename);
+    Size samples = readBinary<std::uint64_t>(in, filename);
+    Size depth = readBinary<std::uint64_t>(in, filename);
+    std::vector<QuantLib::Date> fileDates;
+    for (Size j = 0; j < numDates; ++j)
+        fileDates.push_back(
+            QuantLib::Date(static_cast<QuantLib::Date::serial_type>(readBinary<std::int64_t>(in, filename))));
+    std::vector<std::string> fileIds;
+    for (Size i = 0; i < numIds; ++i)
+        fileIds.push_back(readBinaryString(in, filename));
+    if (std::string md = readBinaryString(in, filename); !md.empty()) {
+        result.scenarioGeneratorData = QuantLib::ext::make_shared<ScenarioGeneratorData>();
+        result.scenarioGeneratorData->fromXMLString(md);
+    }
+    if (auto v = readBinary<std::int64_t>(in, filename); v >= 0)
+        result.storeFlows = v == 1;
+    if (auto v = readBinary<std::int64_t>(in, filename); v >= 0)
+        result.storeCreditStateNPVs = static_cast<Size>(v);
+    std::vector<BinaryCubeBlock> index(numDates + 1);
+    for (auto& b : index) {
+        b.offset = readBinary<std::uint64_t>(in, filename);
+        b.storedSize = readBinary<std::uint64_t>(in, filename);
+        b.rawSize = readBinary<std::uint64_t>(in, filename);
+    }
+    in.close();
+
+    // determine the ids and dates to load, and their position in the file
+
+    std::set<std::string> cubeIds;
+    for (auto const& id : fileIds) {
+        if (ids.empty() || ids.find(id) != ids.end())
+            cubeIds.insert(id);
+    }
+    QL_REQUIRE(ids.empty() || cubeIds.size() == ids.size(),
+               "loadCubeBinary(): not all requested ids found in '" << filename << "'");
+
+    std::vector<QuantLib::Date> cubeDates;
+    std::vector<Size> fileBlocks(1, 0);
+    for (Size j = 0; j < numDates; ++j) {
+        if (dates.empty() || dates.find(fileDates[j]) != dates.end()) {
+            cubeDates.push_back(fileDates[j]);
+            fileBlocks.push_back(j + 1);
+        }
+    }
+    QL_REQUIRE(dates.empty() || cubeDates.size() == dates.size(),
+               "loadCubeBinary(): not all requested dates found in '" << filename << "'");
+
+    auto cube = createInMemoryCube(asof, cubeIds, cubeDates, samples, depth, doublePrecision);
+    result.cube = cube;
+
+    std::vector<std::pair<Size, Size>> idMap; // (position in file, position in cube)
+    for (Size i = 0; i < numIds; ++i) {
+        if (cubeIds.find(fileIds[i]) != cubeIds.end())
+            idMap.push_back(std::make_pair(i, cube->idsAndIndexes().at(fileIds[i])));
+    }
+
+    // read the blocks, each thread uses its own stream and writes to distinct dates of the cube
+
+    auto readBlocks = [&](const Size first, const Size step) {
+        std::ifstream blockIn(filename, std::ios::in | std::ios::binary);
+        QL_REQUIRE(blockIn, "loadCubeBinary(): can not open '" << filename << "'");
+        std::string stored, block;
+        for (Size b = first; b < fileBlocks.size(); b += step) {
+            const auto& entry = index[fileBlocks[b]];
+            stored.resize(entry.storedSize);
+            blockIn.seekg(entry.offset);
+            if (!stored.empty())
+                blockIn.read(&stored[0], stored.size());
+            QL_REQUIRE(blockIn, "loadCubeBinary(): error reading block " << fileBlocks[b] << " from '" << filename
+                                                                         << "'");
+            block = compressed ? decompressBlock(stored, entry.rawSize) : stored;
+            Size nSamples = b == 0 ? 1 : samples;
+            QL_REQUIRE(block.size() == numIds * nSamples * depth * valueSize,
+                       "loadCubeBinary(): block " << fileBlocks[b] << " in '" << filename << "' has invalid size "
+                                                  << block.size());
+            for (auto const& [fi, ci] : idMap) {
+                for (Size k = 0; k < nSamples; ++k) {
+                    for (Size d = 0; d < depth; ++d) {
+                        Size pos = (fi * nSamples + k) * depth + d;
+                        Real v = valueSize == sizeof(double) ? extractValue<double>(block, pos)
+                                                             : extractValue<float>(block, pos);
+                        if (b == 0)
+                            cube->setT0(v, ci, d);
+                        else
+                            cube->set(v, ci, b - 1, k, d);
+                    }
+                }
+            }
+        }
+    };
+
+    Size effThreads = std::max<Size>(1, std::min(nThreads, fileBlocks.size()));
+    if (effThreads == 1) {
+        readBlocks(0, 1);
+    } else {
+        std::vector<std::future<void>> jobs;
+        for (Size t = 0; t < effThreads; ++t)
+            jobs.push_back(std::async(std::launch::async, readBlocks, t, effThreads));
+        for (auto& j : jobs)
+            j.get();
+    }
+
+    LOG("loaded binary cube from " << filename << ": asof = " << asof << ", dim = " << cube->numIds() << " x "
+                                   << cube->numDates() << " x " << samples << " x " << depth << " (file dim "
+                                   << numIds << " x " << numDates << "), " << effThreads << " threads used.");
+
+    return result;
+}
+
 QuantLib::ext::shared_ptr<AggregationScenarioData> loadAggregationScenarioData(const std::string& filename) {
 
+    // binary files are read lazily, key by key
+
+    if (isBinaryAggregationScenarioData(filename))
+        return loadAggregationScenarioDataBinary(filename);
+
     // open file
 
     bool gzip = use_compression(filename);
@@ -340,5 +704,325 @@ void saveAggregationScenarioData(const std::string& filename, const AggregationS
     }
 }
 
+void saveAggregationScenarioDataBinary(const std::string& filename, const AggregationScenarioData& data,
+                                       const bool doublePrecision, const bool compress) {
+
+#ifndef ORE_USE_ZLIB
+    if (compress)
+        WLOG("saveAggregationScenarioDataBinary(): compression requested, but this requires a build with "
+             "ORE_USE_ZLIB, will write uncompressed blocks to '"
+             << filename << "'");
+    const bool doCompress = false;
+#else
+    const bool doCompress = compress;
+#endif
+
+    std::uint32_t valueSize = doublePrecision ? sizeof(double) : sizeof(float);
+    auto keys = data.keys();
+
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(out, "saveAggregationScenarioDataBinary(): can not open '" << filename << "' for writing");
+
+    // header
+
+    out.write(binaryAsdMagic, 8);
+    writeBinary(out, binaryAsdVersion);
+    writeBinary(out, doCompress ? binaryCubeCompressed : std::uint32_t(0));
+    writeBinary(out, valueSize);
+    writeBinary(out, static_cast<std::uint64_t>(data.dimDates()));
+    writeBinary(out, static_cast<std::uint64_t>(data.dimSamples()));
+    writeBinary(out, static_cast<std::uint64_t>(keys.size()));
+    for (auto const& k : keys) {
+        writeBinary(out, static_cast<std::uint32_t>(k.first));
+        writeBinary(out, k.second);
+    }
+
+    // placeholder for the block index, which is written once the block sizes are known
+
+    std::vector<BinaryCubeBlock> index(keys.size());
+    auto indexPos = out.tellp();
+    for (auto const& b : index) {
+        writeBinary(out, b.offset);
+        writeBinary(out, b.storedSize);
+        writeBinary(out, b.rawSize);
+    }
+
+    // blocks
+
+    std::string block;
+    for (Size k = 0; k < keys.size(); ++k) {
+        block.clear();
+        for (Size i = 0; i < data.dimDates(); ++i) {
+            for (Size j = 0; j < data.dimSamples(); ++j) {
+                Real v = data.get(i, j, keys[k].first, keys[k].second);
+                if (doublePrecision)
+                    appendValue<double>(block, v);
+                else
+                    appendValue<float>(block, v);
+            }
+        }
+        index[k].offset = static_cast<std::uint64_t>(out.tellp());
+        index[k].rawSize = block.size();
+        if (doCompress) {
+            std::string stored = compressBlock(block, "saveAggregationScenarioDataBinary()");
+            index[k].storedSize = stored.size();
+            out.write(stored.data(), stored.size());
+        } else {
+            index[k].storedSize = block.size();
+            out.write(block.data(), block.size());
+        }
+    }
+
+    out.seekp(indexPos);
+    for (auto const& b : index) {
+        writeBinary(out, b.offset);
+        writeBinary(out, b.storedSize);
+        writeBinary(out, b.rawSize);
+    }
+    out.close();
+    QL_REQUIRE(out, "saveAggregationScenarioDataBinary(): error while writing '" << filename << "'");
+
+    LOG("saved binary aggregation scenario data to " << filename << ": dimDates = " << data.dimDates()
+                                                     << ", dimSamples = " << data.dimSamples() << ", keys = "
+                                                     << keys.size() << ", compressed = " << std::boolalpha
+                                                     << doCompress);
+}
+
+BinaryFileAggregationScenarioData::BinaryFileAggregationScenarioData(const std::string& filename)
+    : filename_(filename) {
+
+    const char* context = "BinaryFileAggregationScenarioData";
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    QL_REQUIRE(in, context << ": can not open '" << filename << "'");
+
+    char magic[8];
+    in.read(magic, 8);
+    QL_REQUIRE(in && std::memcmp(magic, binaryAsdMagic, 8) == 0,
+               context << ": '" << filename << "' is not a binary aggregation scenario data file");
+    auto version = readBinary<std::uint32_t>(in, filename, context);
+    QL_REQUIRE(version == binaryAsdVersion, context << ": unsupported version " << version << " in '" << filename
+                                                    << "', expected " << binaryAsdVersion);
+    compressed_ = (readBinary<std::uint32_t>(in, filename, context) & binaryCubeCompressed) != 0;
+    valueSize_ = readBinary<std::uint32_t>(in, filename, context);
+    QL_REQUIRE(valueSize_ == sizeof(float) || valueSize_ == sizeof(double),
+               context << ": invalid value size " << valueSize_ << " in '" << filename << "'");
+    dimDates_ = readBinary<std::uint64_t>(in, filename, context);
+    dimSamples_ = readBinary<std::uint64_t>(in, filename, context);
+    Size numKeys = readBinary<std::uint64_t>(in, filename, context);
+    for (Size k = 0; k < numKeys; ++k) {
+        auto type = AggregationScenarioDataType(readBinary<std::uint32_t>(in, filename, context));
+        keys_.push_back(std::make_pair(type, readBinaryString(in, filename, context)));
+        keyIndex_[keys_.back()] = k;
+    }
+    index_.resize(numKeys);
+    for (auto& b : index_) {
+        b.offset = readBinary<std::uint64_t>(in, filename, context);
+        b.storedSize = readBinary<std::uint64_t>(in, filename, context);
+        b.rawSize = readBinary<std::uint64_t>(in, filename, context);
+    }
+    blocks_.resize(numKeys);
+    loaded_.reset(new std::once_flag[numKeys]);
+
+    LOG("opened binary aggregation scenario data " << filename << ": dimDates = " << dimDates_ << ", dimSamples = "
+                                                   << dimSamples_ << ", keys = " << numKeys);
+}
+
+const std::string& BinaryFileAggregationScenarioData::block(const Size k) const {
+    std::call_once(loaded_[k], [this, k]() {
+        const char* context = "BinaryFileAggregationScenarioData";
+        const auto& entry = index_[k];
+        std::ifstream in(filename_, std::ios::in | std::ios::binary);
+        QL_REQUIRE(in, context << ": can not open '" << filename_ << "'");
+        std::string stored(entry.storedSize, ' ');
+        in.seekg(entry.offset);
+        if (!stored.empty())
+            in.read(&stored[0], stored.size());
+        QL_REQUIRE(in, context << ": error reading block " << k << " from '" << filename_ << "'");
+        std::string b = compressed_ ? decompressBlock(stored, entry.rawSize, context) : std::move(stored);
+        QL_REQUIRE(b.size() == dimDates_ * dimSamples_ * valueSize_,
+                   context << ": block " << k << " in '" << filename_ << "' has invalid size " << b.size());
+        blocks_[k] = std::move(b);
+        ++loadedKeys_;
+        std::lock_guard<std::mutex> lock(memoryMutex_);
+        memory_.resize(memory_.bytes() + blocks_[k].size());
+        DLOG(context << ": read block for key (" << keys_[k].first << "," << keys_[k].second << ") from "
+                     << filename_);
+    });
+    return blocks_[k];
+}
+
+Real BinaryFileAggregationScenarioData::get(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
+                                            const string& qualifier) const {
+    QL_REQUIRE(dateIndex < dimDates_, "dateIndex (" << dateIndex << ") out of range 0..." << dimDates_ - 1);
+    QL_REQUIRE(sampleIndex < dimSamples_, "sampleIndex (" << sampleIndex << ") out of range 0..." << dimSamples_ - 1);
+    auto k = keyIndex_.find(std::make_pair(type, qualifier));
+    QL_REQUIRE(k != keyIndex_.end(), "BinaryFileAggregationScenarioData: no data for key ("
+                                         << type << "," << qualifier << ") in '" << filename_ << "'");
+    Size pos = dateIndex * dimSamples_ + sampleIndex;
+    return valueSize_ == sizeof(double) ? extractValue<double>(block(k->second), pos)
+                                        : extractValue<float>(block(k->second), pos);
+}
+
+void BinaryFileAggregationScenarioData::set(Size dateIndex, Size sampleIndex, Real value,
+                                            const AggregationScenarioDataType& type, const string& qualifier) {
+    QL_FAIL("BinaryFileAggregationScenarioData: can not set value, '" << filename_ << "' is read only");
+}
+
+QuantLib::ext::shared_ptr<AggregationScenarioData> loadAggregationScenarioDataBinary(const std::string& filename,
+                                                                                    const bool lazy) {
+    auto fileData = QuantLib::ext::make_shared<BinaryFileAggregationScenarioData>(filename);
+    if (lazy)
+        return fileData;
+
+    // the full data is held in the precision of the file
+    QuantLib::ext::shared_ptr<AggregationScenarioData> result;
+    if (fileData->doublePrecision())
+        result = QuantLib::ext::make_shared<DoublePrecisionAggregationScenarioData>(fileData->dimDates(),
+                                                                                   fileData->dimSamples());
+    else
+        result = QuantLib::ext::make_shared<SinglePrecisionAggregationScenarioData>(fileData->dimDates(),
+                                                                                   fileData->dimSamples());
+    for (auto const& [type, qualifier] : fileData->keys())
+        for (Size i = 0; i < fileData->dimDates(); ++i)
+            for (Size j = 0; j < fileData->dimSamples(); ++j)
+                result->set(i, j, fileData->get(i, j, type, qualifier), type, qualifier);
+    LOG("loaded binary aggregation scenario data from " << filename);
+    return result;
+}
+
+NPVCubeWithMetaData mergeCubes(const std::vector<NPVCubeWithMetaData>& cubes, const bool doublePrecision) {
+
+    QL_REQUIRE(!cubes.empty(), "mergeCubes(): no cubes given");
+    for (auto const& c : cubes) {
+        QL_REQUIRE(c.cube, "mergeCubes(): cube is null");
+    }
+
+    if (cubes.size() == 1)
+        return cubes.front();
+
+    // check consistency of the partial cubes
+
+    auto const& first = cubes.front();
+    Size samples = 0;
+    for (Size c = 0; c < cubes.size(); ++c) {
+        auto const& cube = cubes[c];
+        QL_REQUIRE(cube.cube->asof() == first.cube->asof(), "mergeCubes(): asof of cube #"
+                                                                << c << " (" << cube.cube->asof()
+                                                                << ") does not match asof of first cube ("
+                                                                << first.cube->asof() << ")");
+        QL_REQUIRE(cube.cube->dates() == first.cube->dates(),
+                   "mergeCubes(): dates of cube #" << c << " do not match dates of first cube");
+        QL_REQUIRE(cube.cube->depth() == first.cube->depth(), "mergeCubes(): depth of cube #"
+                                                                  << c << " (" << cube.cube->depth()
+                                                                  << ") does not match depth of first cube ("
+                                                                  << first.cube->depth() << ")");
+        QL_REQUIRE(cube.cube->ids() == first.cube->ids(),
+                   "mergeCubes(): ids of cube #" << c << " do not match ids of first cube");
+        QL_REQUIRE(static_cast<bool>(cube.scenarioGeneratorData) == static_cast<bool>(first.scenarioGeneratorData),
+                   "mergeCubes(): scenario generator meta data must be given for all or none of the cubes");
+        if (cube.scenarioGeneratorData) {
+            auto const& sgd = *cube.scenarioGeneratorData;
+            auto const& sgd0 = *first.scenarioGeneratorData;
+            QL_REQUIRE(sgd.sequenceType() == sgd0.sequenceType() && sgd.seed() == sgd0.seed(),
+                       "mergeCubes(): sequence type and seed of cube #" << c << " (" << sgd.sequenceType() << ", "
+                                                                        << sgd.seed() << ") do not match first cube ("
+                                                                        << sgd0.sequenceType() << ", " << sgd0.seed()
+                                                                        << ")");
+            QL_REQUIRE(sgd.firstSample() == sgd0.firstSample() + samples,
+                       "mergeCubes(): cube #" << c << " starts at sample " << sgd.firstSample() << ", expected "
+                                              << sgd0.firstSample() + samples
+                                              << ", the cubes must cover consecutive sample ranges");
+            QL_REQUIRE(sgd.samples() == cube.cube->samples(), "mergeCubes(): cube #"
+                                                                  << c << " has " << cube.cube->samples()
+                                                                  << " samples, but meta data says "
+                                                                  << sgd.samples());
+        }
+        samples += cube.cube->samples();
+    }
+
+    // build the merged cube
+
+    NPVCubeWithMetaData result;
+    result.storeFlows = first.storeFlows;
+    result.storeCreditStateNPVs = first.storeCreditStateNPVs;
+    if (first.scenarioGeneratorData) {
+        result.scenarioGeneratorData = QuantLib::ext::make_shared<ScenarioGeneratorData>(*first.scenarioGeneratorData);
+        result.scenarioGeneratorData->samples() = samples;
+    }
+
+    result.cube = createInMemoryCube(first.cube->asof(), first.cube->ids(), first.cube->dates(), samples,
+                                     first.cube->depth(), doublePrecision);
+
+    Size offset = 0;
+    for (Size c = 0; c < cubes.size(); ++c) {
+        auto const& cube = *cubes[c].cube;
+        for (auto const& [id, index] : cube.idsAndIndexes()) {
+            Size target = result.cube->index(id);
+            if (c == 0) {
+                for (Size d = 0; d < cube.depth(); ++d)
+                    result.cube->setT0(cube.getT0(index, d), target, d);
+            }
+            for (Size j = 0; j < cube.numDates(); ++j) {
+                for (Size k = 0; k < cube.samples(); ++k) {
+                    for (Size d = 0; d < cube.depth(); ++d) {
+                        result.cube->set(cube.get(index, j, k, d), target, j, offset + k, d);
+                    }
+                }
+            }
+        }
+        offset += cube.samples();
+    }
+
+    LOG("merged " << cubes.size() << " cubes: asof = " << result.cube->asof() << ", dim = " << result.cube->numIds()
+                  << " x " << result.cube->numDates() << " x " << result.cube->samples() << " x "
+                  << result.cube->depth());
+
+    return result;
+}
+
+QuantLib::ext::shared_ptr<AggregationScenarioData>
+mergeAggregationScenarioData(const std::vector<QuantLib::ext::shared_ptr<AggregationScenarioData>>& data) {
+
+    QL_REQUIRE(!data.empty(), "mergeAggregationScenarioData(): no data given");
+    for (auto const& d : data) {
+        QL_REQUIRE(d, "mergeAggregationScenarioData(): data is null");
+    }
+
+    if (data.size() == 1)
+        return data.front();
+
+    auto keys = data.front()->keys();
+    Size dimDates = data.front()->dimDates();
+    Size dimSamples = 0;
+    for (Size c = 0; c < data.size(); ++c) {
+        QL_REQUIRE(data[c]->dimDates() == dimDates, "mergeAggregationScenarioData(): number of dates of data #"
+                                                        << c << " (" << data[c]->dimDates()
+                                                        << ") does not match number of dates of first data ("
+                                                        << dimDates << ")");
+        QL_REQUIRE(data[c]->keys() == keys,
+                   "mergeAggregationScenarioData(): keys of data #" << c << " do not match keys of first data");
+        dimSamples += data[c]->dimSamples();
+    }
+
+    auto result = QuantLib::ext::make_shared<InMemoryAggregationScenarioData>(dimDates, dimSamples);
+
+    Size offset = 0;
+    for (auto const& d : data) {
+        for (Size i = 0; i < dimDates; ++i) {
+            for (Size j = 0; j < d->dimSamples(); ++j) {
+                for (auto const& k : keys) {
+                    result->set(i, offset + j, d->get(i, j, k.first, k.second), k.first, k.second);
+                }
+            }
+        }
+        offset += d->dimSamples();
+    }
+
+    LOG("merged " << data.size() << " aggregation scenario data: dimDates = " << dimDates
+                  << ", dimSamples = " << dimSamples << ", keys = " << keys.size());
+
+    return result;
+}
+
 } // namespace analytics
 } // namespace ore
@@ -27,6 +27,11 @@
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <orea/scenario/scenariogeneratordata.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
 namespace ore {
 namespace analytics {
 
@@ -43,11 +48,100 @@ struct NPVCubeWithMetaData {
     boost::optional<Size> storeCreditStateNPVs;
 };
 
+/*! If the file is a MappedFileNPVCube file (see createMappedFileCube(), saveMappedFileCube()), the cube is not read
+    into memory, but returned as a read-only MappedFileNPVCube, the parameter doublePrecision is ignored in this case
+    and no meta data is returned. */
 NPVCubeWithMetaData loadCube(const std::string& filename, const bool doublePrecision = false);
 void saveCube(const std::string& filename, const NPVCubeWithMetaData& cube, const bool doublePrecision = false);
 
+/*! Binary columnar cube format: the payload is organised in one block per date (plus one block for the T0 values),
+    each block holding the values for all ids, samples and depths. The blocks are optionally compressed (this
+    requires a build with ORE_USE_ZLIB) and are indexed in the file header, so that loadCubeBinary() can read a
+    subset of dates without touching the other blocks, and read the blocks in parallel using nThreads threads.
+
+    If ids and / or dates are given, the loaded cube contains only these ids / dates, all of which must be present in
+    the file. The T0 values are always loaded.
+
+    loadCube() recognises binary cube files and forwards them to loadCubeBinary(). */
+void saveCubeBinary(const std::string& filename, const NPVCubeWithMetaData& cube, const bool doublePrecision = false,
+                    const bool compress = true);
+NPVCubeWithMetaData loadCubeBinary(const std::string& filename, const bool doublePrecision = false,
+                                   const std::set<std::string>& ids = {}, const std::set<QuantLib::Date>& dates = {},
+                                   const Size nThreads = 1);
+
+/*! loadAggregationScenarioData() recognises binary aggregation scenario data files and forwards them to
+    loadAggregationScenarioDataBinary(), i.e. the data is loaded lazily in this case. */
 QuantLib::ext::shared_ptr<AggregationScenarioData> loadAggregationScenarioData(const std::string& filename);
 void saveAggregationScenarioData(const std::string& filename, const AggregationScenarioData& cube);
 
+/*! Binary aggregation scenario data format: the payload is organised in one block per key, each block holding the
+    values for all dates and samples (date-major) as floats or doubles. As for the binary cube format, the blocks are
+    optionally compressed (this requires a build with ORE_USE_ZLIB) and are indexed in the file header.
+
+    If lazy is true, loadAggregationScenarioDataBinary() only reads the header and returns a
+    BinaryFileAggregationScenarioData, which reads the block of a key on its first access. Since the post processor
+    only needs the numeraire and the fx spots and index fixings of the netting sets' collateral currencies, the
+    aggregation can start without deserialising the full data. Otherwise all blocks are read into a
+    CompactAggregationScenarioData with the precision of the file. */
+void saveAggregationScenarioDataBinary(const std::string& filename, const AggregationScenarioData& data,
+                                       const bool doublePrecision = false, const bool compress = true);
+QuantLib::ext::shared_ptr<AggregationScenarioData> loadAggregationScenarioDataBinary(const std::string& filename,
+                                                                                    const bool lazy = true);
+
+//! Read-only aggregation scenario data backed by a binary file, the block of a key is read on its first access
+class BinaryFileAggregationScenarioData : public AggregationScenarioData {
+public:
+    explicit BinaryFileAggregationScenarioData(const std::string& filename);
+
+    Size dimDates() const override { return dimDates_; }
+    Size dimSamples() const override { return dimSamples_; }
+    bool has(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
+        return keyIndex_.find(std::make_pair(type, qualifier)) != keyIndex_.end();
+    }
+    Real get(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
+             const string& qualifier = "") const override;
+    //! Throws, the data is read only
+    void set(Size dateIndex, Size sampleIndex, Real value, const AggregationScenarioDataType& type,
+             const string& qualifier = "") override;
+    std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const override { return keys_; }
+
+    //! True if values are stored in double precision in the file
+    bool doublePrecision() const { return valueSize_ == sizeof(double); }
+    //! The number of keys whose block has been read from the file
+    Size loadedKeys() const { return loadedKeys_; }
+
+private:
+    struct Block {
+        std::uint64_t offset, storedSize, rawSize;
+    };
+    const std::string& block(const Size k) const;
+
+    std::string filename_;
+    bool compressed_;
+    std::uint32_t valueSize_;
+    Size dimDates_, dimSamples_;
+    std::vector<std::pair<AggregationScenarioDataType, std::string>> keys_;
+    std::map<std::pair<AggregationScenarioDataType, std::string>, Size> keyIndex_;
+    std::vector<Block> index_;
+    mutable std::vector<std::string> blocks_;
+    mutable std::unique_ptr<std::once_flag[]> loaded_;
+    mutable std::atomic<Size> loadedKeys_{0};
+    mutable std::mutex memoryMutex_;
+    mutable QuantExt::AccountedMemory memory_{QuantExt::MemoryAccounting::Category::ScenarioData};
+};
+
+/*! Merge partial cubes covering consecutive sample ranges of the same simulation into one in-memory cube. This allows
+    to shard the cube generation by sample ranges (see ScenarioGeneratorData::firstSample()) and to assemble the
+    results for the post processing. The cubes must be given in the order of their sample ranges and must coincide
+    in asof, ids, dates and depth. If scenario generator meta data is present, it must be present for all cubes, the
+    sample ranges must be contiguous and the sequence type and seed must coincide, the merged meta data then covers
+    the union of the sample ranges. The T0 values are taken from the first cube. */
+NPVCubeWithMetaData mergeCubes(const std::vector<NPVCubeWithMetaData>& cubes, const bool doublePrecision = false);
+
+/*! Merge aggregation scenario data of consecutive sample ranges, the data must be given in the order of the sample
+    ranges and must coincide in the dates and keys. */
+QuantLib::ext::shared_ptr<AggregationScenarioData>
+mergeAggregationScenarioData(const std::vector<QuantLib::ext::shared_ptr<AggregationScenarioData>>& data);
+
 } // namespace analytics
 } // namespace ore
@@ -16,14 +16,23 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
-#include <boost/algorithm/string.hpp>
-#include <fstream>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/cubecsvreader.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
+
+#include <qle/math/chunkworkers.hpp>
+
 #include <ql/errors.hpp>
-#include <stdio.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <set>
 
 using QuantLib::Date;
 using std::string;
@@ -33,7 +42,67 @@ using namespace ore::analytics;
 namespace ore {
 namespace analytics {
 
-CubeCsvReader::CubeCsvReader(const std::string& filename) : filename_(filename) {}
+namespace {
+
+// call f for each line in [begin, end), with leading and trailing whitespace removed
+template <class F> void forEachLine(const char* begin, const char* end, F f) {
+    while (begin < end) {
+        const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        const char* lineEnd = eol == nullptr ? end : eol;
+        const char* lineBegin = begin;
+        begin = eol == nullptr ? end : eol + 1;
+        while (lineBegin != lineEnd && std::isspace(static_cast<unsigned char>(*lineBegin)))
+            ++lineBegin;
+        while (lineEnd != lineBegin && std::isspace(static_cast<unsigned char>(*(lineEnd - 1))))
+            --lineEnd;
+        f(lineBegin, lineEnd);
+    }
+}
+
+// split [begin, end) like boost::split(tokens, line, is_any_of(",;\t"), token_compress_on), reusing the strings
+void tokenize(const char* begin, const char* end, vector<string>& tokens) {
+    auto isSeparator = [](const char c) { return c == ',' || c == ';' || c == '\t'; };
+    Size n = 0;
+    const char* tokenBegin = begin;
+    const char* p = begin;
+    while (true) {
+        if (p == end || isSeparator(*p)) {
+            if (n == tokens.size())
+                tokens.emplace_back();
+            tokens[n++].assign(tokenBegin, p);
+            if (p == end)
+                break;
+            while (p != end && isSeparator(*p))
+                ++p;
+            tokenBegin = p;
+        } else {
+            ++p;
+        }
+    }
+    tokens.resize(n);
+}
+
+// tokenize a data line and check the number of tokens
+void tokenizeLine(const char* begin, const char* end, vector<string>& tokens) {
+    tokenize(begin, end, tokens);
+    QL_REQUIRE(tokens.size() == 7, "Invalid CubeCsvReader line, 7 tokens expected " << string(begin, end));
+}
+
+// the cube dimensions found in a chunk of the file
+struct ChunkInfo {
+    // trade id => first netting set id in the chunk
+    std::map<string, string> nettingSets;
+    // grid dates in the order of their first appearance in the chunk
+    vector<Date> dates;
+    std::set<Size> sampleIdx, depthIdx;
+    // the last asof date in the chunk, if any
+    Date asof;
+};
+
+} // namespace
+
+CubeCsvReader::CubeCsvReader(const std::string& filename, const Size nThreads)
+    : filename_(filename), nThreads_(nThreads) {}
 
 void CubeCsvReader::read(QuantLib::ext::shared_ptr<NPVCube>& cube, std::map<std::string, std::string>& nettingSetMap) {
 
@@ -42,43 +111,97 @@ void CubeCsvReader::read(QuantLib::ext::shared_ptr<NPVCube>& cube, std::map<std:
     std::set<Size> sampleIdxSet, depthIdxSet;
     Date asof;
 
-    std::ifstream file;
-    file.open(filename_.c_str());
-    QL_REQUIRE(file.is_open(), "error opening file " << filename_);
-    bool headerAlreadyLoaded1 = false;
-    while (!file.eof()) {
-        string line;
-        getline(file, line);
-        // skip blank and comment lines
-        if (line.size() > 0 && line[0] != '#') {
-            if (!headerAlreadyLoaded1) {
-                headerAlreadyLoaded1 = true;
-                continue;
-            }
-            vector<string> tokens;
-            boost::trim(line);
-            boost::split(tokens, line, boost::is_any_of(",;\t"), boost::token_compress_on);
-            QL_REQUIRE(tokens.size() == 7, "Invalid CubeCsvReader line, 7 tokens expected " << line);
-            string tradeId = tokens[0];
-            string nettingId = tokens[1];
+    // map the file and split the data lines following the header into chunks ending at line boundaries
+
+    QL_REQUIRE(boost::filesystem::exists(filename_), "error opening file " << filename_);
+    boost::iostreams::mapped_file_source file;
+    const char* data = nullptr;
+    const char* dataEnd = nullptr;
+    if (boost::filesystem::file_size(filename_) > 0) {
+        try {
+            file.open(filename_);
+        } catch (const std::exception& e) {
+            QL_FAIL("error opening file " << filename_ << ": " << e.what());
+        }
+        data = file.data();
+        dataEnd = data + file.size();
+    }
+
+    // skip blank and comment lines and the header
+    while (data < dataEnd) {
+        const char* eol = static_cast<const char*>(std::memchr(data, '\n', dataEnd - data));
+        const char* next = eol == nullptr ? dataEnd : eol + 1;
+        bool isHeader = false;
+        forEachLine(data, eol == nullptr ? dataEnd : eol,
+                    [&isHeader](const char* b, const char* e) { isHeader = b != e && *b != '#'; });
+        data = next;
+        if (isHeader)
+            break;
+    }
+
+    QuantExt::ChunkWorkers workers(nThreads_);
+    Size nChunks = std::min<Size>(4 * workers.nThreads(), std::max<Size>(1, (dataEnd - data) / (1 << 16)));
+    vector<const char*> bounds(1, data);
+    for (Size i = 1; i < nChunks; ++i) {
+        const char* b = std::max(bounds.back(), data + (dataEnd - data) * i / nChunks);
+        const char* eol = static_cast<const char*>(std::memchr(b, '\n', dataEnd - b));
+        if (eol == nullptr)
+            break;
+        if (eol + 1 > bounds.back())
+            bounds.push_back(eol + 1);
+    }
+    if (bounds.back() != dataEnd)
+        bounds.push_back(dataEnd);
+    nChunks = bounds.size() - 1;
+
+    // first pass: determine the cube dimensions, the chunk results are merged in file order
+
+    vector<ChunkInfo> info(nChunks);
+    workers.run(nChunks, [&bounds, &info](const Size c) {
+        ChunkInfo& ci = info[c];
+        std::set<Date> dates;
+        vector<string> tokens;
+        string lastDateToken;
+        Date gridDate;
+        forEachLine(bounds[c], bounds[c + 1], [&](const char* b, const char* e) {
+            // skip blank and comment lines
+            if (b == e || *b == '#')
+                return;
+            tokenizeLine(b, e, tokens);
             Size dateIdx = ore::data::parseInteger(tokens[2]);
-            Date gridDate = ore::data::parseDate(tokens[3]);
+            if (lastDateToken.empty() || tokens[3] != lastDateToken) {
+                gridDate = ore::data::parseDate(tokens[3]);
+                lastDateToken = tokens[3];
+            }
             Size sampleIdx = ore::data::parseInteger(tokens[4]);
             Size depthIdx = ore::data::parseInteger(tokens[5]);
-
             if (dateIdx == 0) {
-                asof = gridDate;
-            } else if (std::find(dateVec.begin(), dateVec.end(), gridDate) == dateVec.end()) {
-                dateVec.push_back(gridDate);
+                ci.asof = gridDate;
+            } else if (dates.insert(gridDate).second) {
+                ci.dates.push_back(gridDate);
             }
+            ci.nettingSets.emplace(tokens[0], tokens[1]);
+            ci.sampleIdx.insert(sampleIdx);
+            ci.depthIdx.insert(depthIdx);
+        });
+    });
+
+    std::set<Date> dates;
+    for (auto& ci : info) {
+        if (ci.asof != Date())
+            asof = ci.asof;
+        for (auto const& d : ci.dates) {
+            if (dates.insert(d).second)
+                dateVec.push_back(d);
+        }
+        for (auto const& [tradeId, nettingId] : ci.nettingSets) {
             tradeIds.insert(tradeId);
-            if (nettingSetMap.find(tradeId) == nettingSetMap.end())
-                nettingSetMap[tradeId] = nettingId;
-            sampleIdxSet.insert(sampleIdx);
-            depthIdxSet.insert(depthIdx);
+            nettingSetMap.emplace(tradeId, nettingId);
         }
+        sampleIdxSet.insert(ci.sampleIdx.begin(), ci.sampleIdx.end());
+        depthIdxSet.insert(ci.depthIdx.begin(), ci.depthIdx.end());
     }
-    file.close();
+    info.clear();
 
     QL_REQUIRE(dateVec.size() > 0, "CubeCsvReader - no simulation dates found");
     QL_REQUIRE(tradeIds.size() > 0, "CubeCsvReader - no trades found");
@@ -101,33 +224,26 @@ void CubeCsvReader::read(QuantLib::ext::shared_ptr<NPVCube>& cube, std::map<std:
     else if (cubeDepth > 1)
         cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, tradeIds, dateVec, numSamples, cubeDepth);
 
-    // Now re-open the file and loop through its contents AGAIN
-    std::ifstream file2;
-    file2.open(filename_.c_str());
-    QL_REQUIRE(file2.is_open(), "error opening file " << filename_);
-    bool headerAlreadyLoaded = false;
-    while (!file2.eof()) {
-        string line;
-        getline(file2, line);
-        // skip blank and comment lines
-        if (line.size() > 0 && line[0] != '#') {
-            if (!headerAlreadyLoaded) {
-                headerAlreadyLoaded = true;
-                continue;
-            }
-            vector<string> tokens;
-            boost::trim(line);
-            boost::split(tokens, line, boost::is_any_of(",;\t"), boost::token_compress_on);
-            QL_REQUIRE(tokens.size() == 7, "Invalid CubeCsvReader line, 7 tokens expected " << line);
-            string tradeId = tokens[0];
-            string nettingId = tokens[1];
+    /* Second pass: set the values, each line addresses its own cube cell, so that the chunks can be processed in
+       parallel (if a cell is given several times in the file, it is unspecified which value is kept) */
+    workers.run(nChunks, [&bounds, &cube](const Size c) {
+        vector<string> tokens;
+        string lastTradeId;
+        Size pos_trade = 0;
+        forEachLine(bounds[c], bounds[c + 1], [&](const char* b, const char* e) {
+            // skip blank and comment lines
+            if (b == e || *b == '#')
+                return;
+            tokenizeLine(b, e, tokens);
             Size dateIdx = ore::data::parseInteger(tokens[2]);
-            // Date gridDate = ore::data::parseDate(tokens[3]); Not needed
             Size sampleIdx = ore::data::parseInteger(tokens[4]);
             Size depthIdx = ore::data::parseInteger(tokens[5]);
             Real value = ore::data::parseReal(tokens[6]);
 
-            auto pos_trade = cube->getTradeIndex(tradeId);
+            if (lastTradeId.empty() || tokens[0] != lastTradeId) {
+                pos_trade = cube->getTradeIndex(tokens[0]);
+                lastTradeId = tokens[0];
+            }
 
             if (dateIdx == 0) {
                 cube->setT0(value, pos_trade, depthIdx);
@@ -135,9 +251,8 @@ void CubeCsvReader::read(QuantLib::ext::shared_ptr<NPVCube>& cube, std::map<std:
                 QL_REQUIRE(sampleIdx > 0, "CubeCsvReader - input sampleIdx should be > 0");
                 cube->set(value, pos_trade, dateIdx - 1, sampleIdx - 1, depthIdx);
             }
-        }
-    }
-    file2.close();
+        });
+    });
 }
 } // namespace analytics
 } // namespace ore
@@ -36,8 +36,8 @@ namespace analytics {
  */
 class CubeCsvReader {
 public:
-    //! ctor
-    CubeCsvReader(const std::string& filename);
+    //! ctor, the file is parsed in nThreads threads
+    CubeCsvReader(const std::string& filename, const Size nThreads = 1);
 
     //! Return the filename this reader is reader from
     const std::string& filename() const { return filename_; }
@@ -47,6 +47,7 @@ public:
 
 private:
     std::string filename_;
+    Size nThreads_;
 };
 } // namespace analytics
 } // namespace ore
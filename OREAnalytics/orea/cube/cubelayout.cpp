@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/cubelayout.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/jointnpvcube.hpp>
+#include <orea/cube/sparsenpvcube.hpp>
+
+#include <ored/utilities/log.hpp>
+
+#include <algorithm>
+
+namespace ore {
+namespace analytics {
+
+Real estimateCubeOccupancy(const ore::data::Trade& trade, const DateGrid& grid, const CubeInterpretation& ci,
+                           const Size depth) {
+    std::vector<Date> dates = grid.valuationDates();
+    if (dates.empty() || depth == 0)
+        return 1.0;
+    const Date& maturity = trade.maturity();
+    if (maturity == Date())
+        return 1.0;
+
+    std::vector<Date> flowDates;
+    for (auto const& leg : trade.legs())
+        for (auto const& cf : leg)
+            flowDates.push_back(cf->date());
+    std::sort(flowDates.begin(), flowDates.end());
+    bool flowsKnown = !trade.legs().empty();
+
+    Size nonZero = 0;
+    for (auto const& d : dates) {
+        if (d >= maturity)
+            continue;
+        for (Size k = 0; k < depth; ++k) {
+            if (k == ci.mporFlowsIndex() && flowsKnown) {
+                Date closeOut = ci.withCloseOutLag() ? grid.closeOutDateFromValuationDate(d) : d;
+                auto f = std::upper_bound(flowDates.begin(), flowDates.end(), d);
+                if (f != flowDates.end() && *f <= closeOut)
+                    ++nonZero;
+            } else {
+                ++nonZero;
+            }
+        }
+    }
+    return static_cast<Real>(nonZero) / static_cast<Real>(dates.size() * depth);
+}
+
+std::set<std::string> selectSparseCubeIds(const ore::data::Portfolio& portfolio, const DateGrid& grid,
+                                          const CubeInterpretation& ci, const Size depth, const Real maxOccupancy) {
+    std::set<std::string> result;
+    Real denseSlices = 0.0, occupiedSlices = 0.0;
+    for (auto const& [id, trade] : portfolio.trades()) {
+        Real occupancy = estimateCubeOccupancy(*trade, grid, ci, depth);
+        TLOG("cube occupancy of trade " << id << " estimated as " << occupancy);
+        if (occupancy <= maxOccupancy) {
+            result.insert(id);
+            occupiedSlices += occupancy;
+        } else {
+            occupiedSlices += 1.0;
+        }
+        denseSlices += 1.0;
+    }
+    LOG("selected " << result.size() << " out of " << portfolio.size() << " trades for the sparse cube (max occupancy "
+                    << maxOccupancy << "), estimated cube size relative to a dense cube "
+                    << (denseSlices > 0.0 ? occupiedSlices / denseSlices : 1.0));
+    return result;
+}
+
+QuantLib::ext::shared_ptr<NPVCube> createSinglePrecisionCube(const Date& asof, const std::set<std::string>& ids,
+                                                             const std::vector<Date>& dates, const Size samples,
+                                                             const Size depth,
+                                                             const std::set<std::string>& sparseIds) {
+    std::set<std::string> dense, sparse;
+    for (auto const& id : ids) {
+        if (sparseIds.find(id) != sparseIds.end())
+            sparse.insert(id);
+        else
+            dense.insert(id);
+    }
+
+    QuantLib::ext::shared_ptr<NPVCube> denseCube, sparseCube;
+    if (!dense.empty() || sparse.empty()) {
+        if (depth == 1)
+            denseCube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, dense, dates, samples, 0.0f);
+        else
+            denseCube =
+                QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, dense, dates, samples, depth, 0.0f);
+    }
+    if (!sparse.empty())
+        sparseCube = QuantLib::ext::make_shared<SinglePrecisionSparseNpvCube>(asof, sparse, dates, samples, depth);
+
+    if (denseCube && sparseCube)
+        return QuantLib::ext::make_shared<JointNPVCube>(denseCube, sparseCube, ids);
+    return denseCube ? denseCube : sparseCube;
+}
+
+} // namespace analytics
+} // namespace ore
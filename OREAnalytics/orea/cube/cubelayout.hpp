@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/cubelayout.hpp
+    \brief selection of dense or sparse npv cube storage per trade
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/cubeinterpretation.hpp>
+#include <orea/cube/npvcube.hpp>
+
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/dategrid.hpp>
+
+#include <set>
+
+namespace ore {
+namespace analytics {
+
+/*! Estimate the fraction of the (valuation date, depth) slices of the cube for the given trade which hold non-zero
+    values. NPV slices (default date, close-out date, credit state NPVs) are assumed to be non-zero before the trade's
+    maturity, the MPOR flows slice (see CubeInterpretation::mporFlowsIndex()) only on valuation dates followed by a
+    cashflow of the trade's legs up to the close-out date. If the trade has no legs, the flows are assumed to be
+    non-zero before maturity, if the trade has no maturity, all slices are assumed to be non-zero. */
+Real estimateCubeOccupancy(const ore::data::Trade& trade, const DateGrid& grid, const CubeInterpretation& ci,
+                           const Size depth);
+
+/*! Returns the ids of the trades that are stored in a sparse cube, i.e. with an estimated occupancy of at most
+    maxOccupancy. A SparseNpvCube only stores the (date, depth) slices holding non-zero values, so expired trades and
+    the mostly empty MPOR flows slices do not take up memory. */
+std::set<std::string> selectSparseCubeIds(const ore::data::Portfolio& portfolio, const DateGrid& grid,
+                                          const CubeInterpretation& ci, const Size depth,
+                                          const Real maxOccupancy = 0.5);
+
+/*! Create a single precision cube for the given ids, the ids in sparseIds are stored in a SinglePrecisionSparseNpvCube,
+    the others in a SinglePrecisionInMemoryCube(N). If both kinds of ids are present, the result is a JointNPVCube on
+    the two cubes. A cube with sparse ids must not be written concurrently, the multi-threaded valuation engine
+    writes each of its cubes from one thread at a time, also with work stealing. */
+QuantLib::ext::shared_ptr<NPVCube> createSinglePrecisionCube(const Date& asof, const std::set<std::string>& ids,
+                                                             const std::vector<Date>& dates, const Size samples,
+                                                             const Size depth,
+                                                             const std::set<std::string>& sparseIds = {});
+
+} // namespace analytics
+} // namespace ore
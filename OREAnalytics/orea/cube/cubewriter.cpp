@@ -17,8 +17,14 @@
 */
 
 #include <orea/cube/cubewriter.hpp>
-#include <ostream>
+
+#include <qle/math/chunkworkers.hpp>
+
 #include <ql/errors.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <ostream>
 #include <stdio.h>
 
 using QuantLib::Date;
@@ -28,7 +34,53 @@ using std::vector;
 namespace ore {
 namespace analytics {
 
-CubeWriter::CubeWriter(const std::string& filename) : filename_(filename) {}
+namespace {
+
+void appendSize(string& out, const Size i) {
+    char buf[24];
+    auto r = std::to_chars(buf, buf + sizeof(buf), i);
+    out.append(buf, r.ptr);
+}
+
+// appends the value with 4 decimal places, the result is identical to printf("%.4f")
+void appendValue(string& out, const Real v) {
+#ifdef __cpp_lib_to_chars
+    char buf[64];
+    auto r = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, 4);
+    if (r.ec == std::errc()) {
+        out.append(buf, r.ptr);
+        return;
+    }
+#endif
+    int n = std::snprintf(nullptr, 0, "%.4f", v);
+    Size size = out.size();
+    out.resize(size + n + 1);
+    std::snprintf(&out[size], n + 1, "%.4f", v);
+    out.resize(size + n);
+}
+
+// appends a line "Id,NettingSet,DateIndex,Date,Sample,Depth,Value"
+void appendLine(string& out, const string& id, const char* nettingSetId, const Size dateIndex, const string& date,
+                const Size sample, const Size depth, const Real value) {
+    out.append(id);
+    out.push_back(',');
+    out.append(nettingSetId);
+    out.push_back(',');
+    appendSize(out, dateIndex);
+    out.push_back(',');
+    out.append(date);
+    out.push_back(',');
+    appendSize(out, sample);
+    out.push_back(',');
+    appendSize(out, depth);
+    out.push_back(',');
+    appendValue(out, value);
+    out.push_back('\n');
+}
+
+} // namespace
+
+CubeWriter::CubeWriter(const std::string& filename, const Size nThreads) : filename_(filename), nThreads_(nThreads) {}
 
 void CubeWriter::write(const QuantLib::ext::shared_ptr<NPVCube>& cube, const std::map<std::string, std::string>& nettingSetMap,
                        bool append) {
@@ -50,32 +102,53 @@ void CubeWriter::write(const QuantLib::ext::shared_ptr<NPVCube>& cube, const std
     QL_REQUIRE(fp, "error opening file " << filename_);
     if (!append)
         fprintf(fp, "Id,NettingSet,DateIndex,Date,Sample,Depth,Value\n");
-    const char* fmt = "%s,%s,%lu,%s,%lu,%lu,%.4f\n";
 
     // Get netting Set Ids (or "" if not there)
     vector<const char*> nettingSetIds(ids.size());
+    vector<std::pair<const string*, Size>> idsInOrder;
     // T0
 
+    string text;
     for (const auto& [id,idx] : ids) {
         if (nettingSetMap.find(id) != nettingSetMap.end())
             nettingSetIds[idx] = nettingSetMap.at(id).c_str();
         else
             nettingSetIds[idx] = "";
-
-        fprintf(fp, fmt, id.c_str(), nettingSetIds[idx], static_cast<Size>(0), asofString.c_str(),
-                static_cast<Size>(0), static_cast<Size>(0), cube->getT0(idx));        
+        idsInOrder.push_back(std::make_pair(&id, idx));
+        appendLine(text, id, nettingSetIds[idx], 0, asofString, 0, 0, cube->getT0(idx));
     }
+    fwrite(text.data(), 1, text.size(), fp);
+
     // Cube
-    
-    for (const auto& [id, idx] : ids) {
-        for (Size j = 0; j < cube->numDates(); j++) {
-            for (Size k = 0; k < cube->samples(); k++) {
-                for (Size l = 0; l < cube->depth(); l++) {
-                    fprintf(fp, fmt, id.c_str(), nettingSetIds[idx], j + 1, dateStrings[j].c_str(), k + 1, l,
-                            cube->get(idx, j, k, l));
+
+    /* The lines are formatted in chunks of (id, date) pairs, which are processed in batches of several chunks in
+       parallel and then written to the file in order */
+    const Size numDates = cube->numDates(), samples = cube->samples(), depth = cube->depth();
+    const Size nItems = idsInOrder.size() * numDates;
+    const Size itemsPerChunk = std::max<Size>(1, 10000 / std::max<Size>(1, samples * depth));
+    const Size nChunks = (nItems + itemsPerChunk - 1) / itemsPerChunk;
+    QuantExt::ChunkWorkers workers(nThreads_);
+    const Size batchSize = 4 * workers.nThreads();
+    vector<string> chunks(std::min(nChunks, batchSize));
+    for (Size b = 0; b < nChunks; b += batchSize) {
+        Size n = std::min(batchSize, nChunks - b);
+        workers.run(n, [&, b](const Size c) {
+            string& out = chunks[c];
+            out.clear();
+            for (Size item = (b + c) * itemsPerChunk; item < std::min((b + c + 1) * itemsPerChunk, nItems); ++item) {
+                const string& id = *idsInOrder[item / numDates].first;
+                Size idx = idsInOrder[item / numDates].second;
+                Size j = item % numDates;
+                for (Size k = 0; k < samples; k++) {
+                    for (Size l = 0; l < depth; l++) {
+                        appendLine(out, id, nettingSetIds[idx], j + 1, dateStrings[j], k + 1, l,
+                                   cube->get(idx, j, k, l));
+                    }
                 }
             }
-        }
+        });
+        for (Size c = 0; c < n; ++c)
+            fwrite(chunks[c].data(), 1, chunks[c].size(), fp);
     }
     fclose(fp);
 }
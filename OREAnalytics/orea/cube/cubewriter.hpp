@@ -36,8 +36,8 @@ namespace analytics {
  */
 class CubeWriter {
 public:
-    //! ctor
-    CubeWriter(const std::string& filename);
+    //! ctor, the lines are formatted in nThreads threads
+    CubeWriter(const std::string& filename, const Size nThreads = 1);
 
     //! Return the filename this writer is writing too
     const std::string& filename() { return filename_; }
@@ -48,6 +48,7 @@ public:
 
 private:
     std::string filename_;
+    Size nThreads_;
 };
 } // namespace analytics
 } // namespace ore
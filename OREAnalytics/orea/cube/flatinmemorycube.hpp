@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/flatinmemorycube.hpp
+    \brief A cube implementation that stores the cube in a single contiguous, aligned block of memory
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
+#include <set>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+using std::vector;
+
+//! Memory layout of a FlatInMemoryCube
+/*! - TradeMajor:  all (date, sample, depth) values of one id are contiguous, index = ((i * D + j) * S + k) * N + d
+    - SampleMajor: all (id, depth) values of one (date, sample) are contiguous, index = ((j * S + k) * I + i) * N + d
+
+    TradeMajor is the natural layout for the valuation engine, which fills the cube trade by trade, SampleMajor
+    suits the aggregation which nets all trades of a netting set for a given date and sample.
+
+    \ingroup cube
+*/
+enum class FlatCubeLayout { TradeMajor, SampleMajor };
+
+//! FlatInMemoryCube stores the cube in one contiguous block of memory
+/*! In contrast to InMemoryCubeBase, which uses nested STL vectors (one allocation per (id, date) pair), this
+    implementation allocates the full cube once. The block is aligned to a cache line (64 bytes) so that it can
+    be processed efficiently by vectorised code.
+
+    The class is a template to allow both single and double precision implementations.
+
+    \ingroup cube
+*/
+template <typename T> class FlatInMemoryCube : public NPVCube {
+public:
+    //! alignment of the data block in bytes
+    static constexpr std::size_t alignment = 64;
+
+    //! ctor
+    FlatInMemoryCube(const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates, Size samples,
+                     Size depth = 1, const T& t = T(), FlatCubeLayout layout = FlatCubeLayout::TradeMajor)
+        : asof_(asof), dates_(dates), samples_(samples), depth_(depth), layout_(layout),
+          t0Data_(ids.size() * depth, t) {
+        QL_REQUIRE(ids.size() > 0, "FlatInMemoryCube::FlatInMemoryCube no ids specified");
+        QL_REQUIRE(dates.size() > 0, "FlatInMemoryCube::FlatInMemoryCube no dates specified");
+        QL_REQUIRE(samples > 0, "FlatInMemoryCube::FlatInMemoryCube samples must be > 0");
+        QL_REQUIRE(depth > 0, "FlatInMemoryCube::FlatInMemoryCube depth must be > 0");
+        size_t pos = 0;
+        for (const auto& id : ids) {
+            idIdx_[id] = pos++;
+        }
+        size_ = ids.size() * dates.size() * samples * depth;
+        data_ = std::unique_ptr<T[], AlignedDeleter>(
+            static_cast<T*>(::operator new[](size_ * sizeof(T), std::align_val_t(alignment))));
+        std::fill(data_.get(), data_.get() + size_, t);
+        memory_.resize((size_ + t0Data_.size()) * sizeof(T));
+    }
+
+    //! Return the length of each dimension
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+
+    //! Return a map of all ids and their position in the cube
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    //! Get the vector of dates for this cube
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+
+    //! Return the asof date (T0 date)
+    QuantLib::Date asof() const override { return asof_; }
+
+    //! Get a T0 value from the cube
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return t0Data_[i * depth_ + d];
+    }
+
+    //! Set a T0 value in the cube
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        t0Data_[i * depth_ + d] = static_cast<T>(value);
+    }
+
+    //! Get a value from the cube
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        return data_[index(i, j, k, d)];
+    }
+
+    //! Set a value in the cube
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        data_[index(i, j, k, d)] = static_cast<T>(value);
+    }
+
+    //! The layout of the data block
+    FlatCubeLayout layout() const { return layout_; }
+
+    /*! Raw access to the data block of size numIds() x numDates() x samples() x depth(), the position of a
+        value is given by index() */
+    const T* data() const { return data_.get(); }
+    T* data() { return data_.get(); }
+
+    //! Position of the value (i, j, k, d) in the data block, no bounds checks are performed
+    Size index(Size i, Size j, Size k, Size d) const {
+        if (layout_ == FlatCubeLayout::TradeMajor)
+            return ((i * dates_.size() + j) * samples_ + k) * depth_ + d;
+        else
+            return ((j * samples_ + k) * idIdx_.size() + i) * depth_ + d;
+    }
+
+private:
+    struct AlignedDeleter {
+        void operator()(T* p) const { ::operator delete[](p, std::align_val_t(alignment)); }
+    };
+
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+    }
+
+    QuantLib::Date asof_;
+    vector<QuantLib::Date> dates_;
+    Size samples_;
+    Size depth_;
+    FlatCubeLayout layout_;
+    vector<T> t0Data_;
+    Size size_;
+    std::unique_ptr<T[], AlignedDeleter> data_;
+    std::map<std::string, Size> idIdx_;
+    QuantExt::AccountedMemory memory_{QuantExt::MemoryAccounting::Category::Cube};
+};
+
+//! FlatInMemoryCube with single precision floating point numbers.
+using SinglePrecisionFlatInMemoryCube = FlatInMemoryCube<float>;
+
+//! FlatInMemoryCube with double precision floating point numbers.
+using DoublePrecisionFlatInMemoryCube = FlatInMemoryCube<double>;
+
+/*! Returns a cube factory creating flat cubes of the given depth and layout, which can be passed as cubeFactory or
+    cptyCubeFactory to the MultiThreadedValuationEngine */
+template <typename T>
+std::function<QuantLib::ext::shared_ptr<NPVCube>(const Date&, const std::set<std::string>&, const vector<Date>&,
+                                                 const Size)>
+flatInMemoryCubeFactory(const Size depth = 1, const FlatCubeLayout layout = FlatCubeLayout::TradeMajor) {
+    return [depth, layout](const Date& asof, const std::set<std::string>& ids, const vector<Date>& dates,
+                           const Size samples) -> QuantLib::ext::shared_ptr<NPVCube> {
+        return QuantLib::ext::make_shared<FlatInMemoryCube<T>>(asof, ids, dates, samples, depth, T(), layout);
+    };
+}
+
+} // namespace analytics
+} // namespace ore
@@ -30,6 +30,7 @@
 
 #include <boost/make_shared.hpp>
 #include <orea/cube/npvcube.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
 #include <set>
 
 namespace ore {
@@ -39,6 +40,14 @@ using QuantLib::Real;
 using QuantLib::Size;
 using std::vector;
 
+namespace detail {
+// memory held by a cube cell
+template <typename T> std::size_t inMemoryCubeCellBytes(const T&) { return sizeof(T); }
+template <typename T> std::size_t inMemoryCubeCellBytes(const vector<T>& t) {
+    return sizeof(vector<T>) + t.capacity() * sizeof(T);
+}
+} // namespace detail
+
 //! InMemoryCube stores the cube in memory using nested STL vectors
 /*! InMemoryCube stores the cube in memory using nested STL vectors, this class is a template
  *  to allow both single and double precision implementations.
@@ -61,7 +70,8 @@ public:
         for (const auto& id : ids) {
             idIdx_[id] = pos++;
         }
-        
+        memory_.resize((ids.size() * (dates.size() * samples + 1)) * detail::inMemoryCubeCellBytes(t) +
+                       ids.size() * (dates.size() + 1) * sizeof(vector<T>));
     }
 
     //! default constructor
@@ -95,6 +105,8 @@ protected:
     vector<vector<vector<T>>> data_;
 
     std::map<std::string, Size> idIdx_;
+
+    QuantExt::AccountedMemory memory_{QuantExt::MemoryAccounting::Category::Cube};
 };
 
 //! InMemoryCube of fixed depth 1
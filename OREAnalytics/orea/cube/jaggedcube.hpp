@@ -32,6 +32,7 @@
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/portfolio/trade.hpp>
 #include <ored/utilities/serializationdate.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
 
 namespace ore {
 namespace analytics {
@@ -64,6 +65,9 @@ public:
 
     Size indexT0(Size dep) const { return dep; }
 
+    //! number of values stored in this block
+    Size size() const { return data_.size(); }
+
     bool isValid(Size date, Size dep, Size sample) const {
         // return true if this is valid
         return date < dateLen_ && sample < samples_ && dep < depth_;
@@ -174,6 +178,7 @@ public:
                 dateLen++;
             blocks_.push_back(TradeBlock<T>(dateLen, depth, samples));
         }
+        accountMemory();
     }
 
     //! Return the length of each dimension
@@ -255,6 +260,14 @@ private:
         ar& samples_;
         ar& maxDepth_;
         ar& blocks_;
+        accountMemory();
+    }
+
+    void accountMemory() {
+        Size n = 0;
+        for (auto const& b : blocks_)
+            n += b.size();
+        memory_.resize(n * sizeof(T) + blocks_.size() * sizeof(TradeBlock<T>));
     }
 
     QuantLib::Date asof_;
@@ -263,6 +276,7 @@ private:
     Size samples_;
     Size maxDepth_;
     vector<TradeBlock<T>> blocks_;
+    QuantExt::AccountedMemory memory_{QuantExt::MemoryAccounting::Category::Cube};
 };
 
 //! Jagged cube with single precision floating point numbers.
@@ -107,14 +107,14 @@ const std::vector<QuantLib::Date>& JointNPVCube::dates() const { return cubes_[0
 
 QuantLib::Date JointNPVCube::asof() const { return cubes_[0]->asof(); }
 
-std::set<std::pair<QuantLib::ext::shared_ptr<NPVCube>, Size>> JointNPVCube::cubeAndId(Size id) const {
+const std::set<std::pair<QuantLib::ext::shared_ptr<NPVCube>, Size>>& JointNPVCube::cubeAndId(Size id) const {
     QL_REQUIRE(id < cubeAndId_.size(),
                "JointNPVCube: id (" << id << ") out of range, have " << cubeAndId_.size() << " ids");
     return cubeAndId_[id];
 }
 
 Real JointNPVCube::getT0(Size id, Size depth) const {
-    auto cids = cubeAndId(id);
+    const auto& cids = cubeAndId(id);
     if (cids.size() == 1)
         return cids.begin()->first->getT0(cids.begin()->second, depth);
     Real tmp = accumulatorInit_;
@@ -124,14 +124,14 @@ Real JointNPVCube::getT0(Size id, Size depth) const {
 }
 
 void JointNPVCube::setT0(Real value, Size id, Size depth) {
-    auto c = cubeAndId(id);
+    const auto& c = cubeAndId(id);
     QL_REQUIRE(c.size() == 1,
                "JointNPVCube::setT0(): not allowed, because id '" << id << "' occurs in more than one input cube");
     (*c.begin()).first->setT0(value, (*c.begin()).second, depth);
 }
 
 Real JointNPVCube::get(Size id, Size date, Size sample, Size depth) const {
-    auto cids = cubeAndId(id);
+    const auto& cids = cubeAndId(id);
     if (cids.size() == 1)
         return cids.begin()->first->get(cids.begin()->second, date, sample, depth);
     Real tmp = accumulatorInit_;
@@ -141,7 +141,7 @@ Real JointNPVCube::get(Size id, Size date, Size sample, Size depth) const {
 }
 
 void JointNPVCube::set(Real value, Size id, Size date, Size sample, Size depth) {
-    auto c = cubeAndId(id);
+    const auto& c = cubeAndId(id);
     QL_REQUIRE(c.size() == 1,
                "JointNPVCube::set(): not allowed, because id '" << id << "' occurs in more than one input cube");
     (*c.begin()).first->set(value, (*c.begin()).second, date, sample, depth);
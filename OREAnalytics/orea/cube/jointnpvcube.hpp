@@ -76,7 +76,7 @@ public:
     void set(Real value, Size id, Size date, Size sample, Size depth = 0) override;
 
 private:
-    std::set<std::pair<QuantLib::ext::shared_ptr<NPVCube>, Size>> cubeAndId(Size id) const;
+    const std::set<std::pair<QuantLib::ext::shared_ptr<NPVCube>, Size>>& cubeAndId(Size id) const;
 
     const std::vector<QuantLib::ext::shared_ptr<NPVCube>> cubes_;
     const std::function<Real(Real a, Real x)> accumulator_;
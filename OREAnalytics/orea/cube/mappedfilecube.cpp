@@ -0,0 +1,240 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/mappedfilecube.hpp>
+
+#include <ored/utilities/log.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+// file layout, all integers in native byte order
+// magic (8 bytes), version (uint32), value size (uint32), asof serial (int64),
+// numIds, numDates, samples, depth, payload offset (uint64 each), dates (int64 serials),
+// ids (uint64 length followed by the characters), padding up to the payload offset,
+// t0 values (numIds x depth), future values (numIds x numDates x samples x depth)
+
+constexpr char magic[8] = {'O', 'R', 'E', 'M', 'C', 'U', 'B', 'E'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint64_t pageSize = 4096;
+
+struct Header {
+    std::uint32_t valueSize;
+    QuantLib::Date asof;
+    std::vector<QuantLib::Date> dates;
+    std::vector<std::string> ids;
+    std::uint64_t samples, depth, payloadOffset;
+};
+
+template <typename V> void write(std::ofstream& out, const V& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(V));
+}
+
+template <typename V> V read(std::ifstream& in, const std::string& filename) {
+    V v;
+    in.read(reinterpret_cast<char*>(&v), sizeof(V));
+    QL_REQUIRE(in, "MappedFileNPVCube: unexpected end of header in '" << filename << "'");
+    return v;
+}
+
+Header readHeader(const std::string& filename) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    QL_REQUIRE(in, "MappedFileNPVCube: can not open '" << filename << "'");
+    char m[8];
+    in.read(m, 8);
+    QL_REQUIRE(in && std::memcmp(m, magic, 8) == 0, "MappedFileNPVCube: '" << filename << "' is not a cube file");
+    auto v = read<std::uint32_t>(in, filename);
+    QL_REQUIRE(v == version, "MappedFileNPVCube: unsupported version " << v << " in '" << filename << "', expected "
+                                                                         << version);
+    Header h;
+    h.valueSize = read<std::uint32_t>(in, filename);
+    QL_REQUIRE(h.valueSize == sizeof(float) || h.valueSize == sizeof(double),
+               "MappedFileNPVCube: invalid value size " << h.valueSize << " in '" << filename << "'");
+    h.asof = QuantLib::Date(static_cast<QuantLib::Date::serial_type>(read<std::int64_t>(in, filename)));
+    auto numIds = read<std::uint64_t>(in, filename);
+    auto numDates = read<std::uint64_t>(in, filename);
+    h.samples = read<std::uint64_t>(in, filename);
+    h.depth = read<std::uint64_t>(in, filename);
+    h.payloadOffset = read<std::uint64_t>(in, filename);
+    for (std::uint64_t i = 0; i < numDates; ++i)
+        h.dates.push_back(QuantLib::Date(static_cast<QuantLib::Date::serial_type>(read<std::int64_t>(in, filename))));
+    for (std::uint64_t i = 0; i < numIds; ++i) {
+        auto len = read<std::uint64_t>(in, filename);
+        std::string id(len, ' ');
+        in.read(&id[0], len);
+        QL_REQUIRE(in, "MappedFileNPVCube: unexpected end of header in '" << filename << "'");
+        h.ids.push_back(id);
+    }
+    return h;
+}
+
+} // namespace
+
+void createMappedFileCube(const std::string& filename, const Date& asof, const std::set<std::string>& ids,
+                          const std::vector<Date>& dates, const Size samples, const Size depth,
+                          const bool doublePrecision) {
+    QL_REQUIRE(ids.size() > 0, "createMappedFileCube(): no ids specified");
+    QL_REQUIRE(dates.size() > 0, "createMappedFileCube(): no dates specified");
+    QL_REQUIRE(samples > 0, "createMappedFileCube(): samples must be > 0");
+    QL_REQUIRE(depth > 0, "createMappedFileCube(): depth must be > 0");
+
+    std::uint32_t valueSize = doublePrecision ? sizeof(double) : sizeof(float);
+
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(out, "createMappedFileCube(): can not open '" << filename << "' for writing");
+
+    std::uint64_t headerSize = 8 + 2 * sizeof(std::uint32_t) + sizeof(std::int64_t) + 5 * sizeof(std::uint64_t) +
+                               dates.size() * sizeof(std::int64_t);
+    for (auto const& id : ids)
+        headerSize += sizeof(std::uint64_t) + id.size();
+    std::uint64_t payloadOffset = ((headerSize + pageSize - 1) / pageSize) * pageSize;
+
+    out.write(magic, 8);
+    write(out, version);
+    write(out, valueSize);
+    write(out, static_cast<std::int64_t>(asof.serialNumber()));
+    write(out, static_cast<std::uint64_t>(ids.size()));
+    write(out, static_cast<std::uint64_t>(dates.size()));
+    write(out, static_cast<std::uint64_t>(samples));
+    write(out, static_cast<std::uint64_t>(depth));
+    write(out, payloadOffset);
+    for (auto const& d : dates)
+        write(out, static_cast<std::int64_t>(d.serialNumber()));
+    for (auto const& id : ids) {
+        write(out, static_cast<std::uint64_t>(id.size()));
+        out.write(id.data(), id.size());
+    }
+    out.close();
+    QL_REQUIRE(out, "createMappedFileCube(): error while writing header to '" << filename << "'");
+
+    // the payload is created as a sparse, zero-initialised region
+    std::uint64_t payloadSize = ids.size() * depth * (1 + dates.size() * samples) * valueSize;
+    boost::filesystem::resize_file(filename, payloadOffset + payloadSize);
+
+    DLOG("created mapped file cube " << filename << ": " << ids.size() << " x " << dates.size() << " x " << samples
+                                     << " x " << depth << ", value size " << valueSize << ", total size "
+                                     << payloadOffset + payloadSize << " bytes");
+}
+
+bool isMappedFileCube(const std::string& filename) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    char m[8];
+    return in.read(m, 8) && std::memcmp(m, magic, 8) == 0;
+}
+
+MappedFileNPVCube::MappedFileNPVCube(const std::string& filename, const bool readOnly,
+                                     const std::set<std::string>& ids)
+    : filename_(filename), readOnly_(readOnly) {
+
+    Header h = readHeader(filename);
+    doublePrecision_ = h.valueSize == sizeof(double);
+    asof_ = h.asof;
+    dates_ = h.dates;
+    samples_ = h.samples;
+    depth_ = h.depth;
+
+    std::map<std::string, Size> fileIds;
+    for (Size i = 0; i < h.ids.size(); ++i)
+        fileIds[h.ids[i]] = i;
+    if (ids.empty()) {
+        for (auto const& [id, pos] : fileIds) {
+            idIdx_[id] = fileIdx_.size();
+            fileIdx_.push_back(pos);
+        }
+    } else {
+        for (auto const& id : ids) {
+            auto f = fileIds.find(id);
+            QL_REQUIRE(f != fileIds.end(), "MappedFileNPVCube: id '" << id << "' not found in '" << filename << "'");
+            idIdx_[id] = fileIdx_.size();
+            fileIdx_.push_back(f->second);
+        }
+    }
+
+    auto mode = readOnly ? boost::interprocess::read_only : boost::interprocess::read_write;
+    file_ = std::make_unique<boost::interprocess::file_mapping>(filename.c_str(), mode);
+    region_ = std::make_unique<boost::interprocess::mapped_region>(*file_, mode, h.payloadOffset);
+
+    Size expectedSize = h.ids.size() * depth_ * (1 + dates_.size() * samples_) * h.valueSize;
+    QL_REQUIRE(region_->get_size() >= expectedSize, "MappedFileNPVCube: payload in '"
+                                                        << filename << "' is too small (" << region_->get_size()
+                                                        << " bytes), expected " << expectedSize << " bytes");
+
+    // the aggregation typically reads the cube trade by trade, i.e. sequentially
+    if (readOnly)
+        region_->advise(boost::interprocess::mapped_region::advice_sequential);
+
+    t0Data_ = static_cast<char*>(region_->get_address());
+    data_ = t0Data_ + h.ids.size() * depth_ * h.valueSize;
+}
+
+MappedFileNPVCube::~MappedFileNPVCube() {}
+
+void MappedFileNPVCube::flush() {
+    if (!readOnly_)
+        region_->flush();
+}
+
+void saveMappedFileCube(const std::string& filename, const NPVCube& cube, const bool doublePrecision) {
+    createMappedFileCube(filename, cube.asof(), cube.ids(), cube.dates(), cube.samples(), cube.depth(),
+                         doublePrecision);
+    MappedFileNPVCube out(filename, false);
+    for (auto const& [id, i] : cube.idsAndIndexes()) {
+        Size o = out.idsAndIndexes().at(id);
+        for (Size d = 0; d < cube.depth(); ++d) {
+            out.setT0(cube.getT0(i, d), o, d);
+            for (Size j = 0; j < cube.numDates(); ++j)
+                for (Size k = 0; k < cube.samples(); ++k)
+                    out.set(cube.get(i, j, k, d), o, j, k, d);
+        }
+    }
+    out.flush();
+}
+
+std::function<QuantLib::ext::shared_ptr<NPVCube>(const Date&, const std::set<std::string>&, const std::vector<Date>&,
+                                                 const Size)>
+mappedFileCubeFactory(const std::string& filename, const std::set<std::string>& ids, const Size depth,
+                      const bool doublePrecision) {
+    auto created = QuantLib::ext::make_shared<bool>(false);
+    auto mutex = QuantLib::ext::make_shared<std::mutex>();
+    return [filename, ids, depth, doublePrecision, created,
+            mutex](const Date& asof, const std::set<std::string>& cubeIds, const std::vector<Date>& dates,
+                   const Size samples) -> QuantLib::ext::shared_ptr<NPVCube> {
+        {
+            std::lock_guard<std::mutex> lock(*mutex);
+            if (!*created) {
+                createMappedFileCube(filename, asof, ids, dates, samples, depth, doublePrecision);
+                *created = true;
+            }
+        }
+        return QuantLib::ext::make_shared<MappedFileNPVCube>(filename, false, cubeIds);
+    };
+}
+
+} // namespace analytics
+} // namespace ore
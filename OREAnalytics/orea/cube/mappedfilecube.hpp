@@ -0,0 +1,152 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/mappedfilecube.hpp
+    \brief npv cube backed by a memory-mapped file
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <functional>
+#include <memory>
+#include <set>
+
+namespace boost {
+namespace interprocess {
+class file_mapping;
+class mapped_region;
+} // namespace interprocess
+} // namespace boost
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! NPV cube backed by a memory-mapped file
+/*! The file consists of a fixed header holding the asof date, the dimensions, the dates and the ids, followed by the
+    raw T0 and future values (float or double) in trade-major order, i.e. all values of one id are stored in one
+    contiguous region. The payload starts on a page boundary.
+
+    The file has to be created with createMappedFileCube() before it can be opened. A cube opened on a subset of the
+    ids in the file is a view on the regions belonging to these ids. This allows the MultiThreadedValuationEngine
+    mini-cubes to write into disjoint regions of the same file, see mappedFileCubeFactory().
+
+    Since the payload is mapped, values are paged in by the operating system only when they are accessed, so that
+    an aggregation run reading the cube never needs to hold the full cube in memory.
+
+    \ingroup cube
+*/
+class MappedFileNPVCube : public NPVCube {
+public:
+    /*! Open an existing cube file. If ids is empty, all ids in the file are exposed, otherwise only the given ids,
+        which must all exist in the file. */
+    MappedFileNPVCube(const std::string& filename, const bool readOnly = true, const std::set<std::string>& ids = {});
+    ~MappedFileNPVCube() override;
+
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+    QuantLib::Date asof() const override { return asof_; }
+
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return value(t0Data_, fileIdx_[i] * depth_ + d);
+    }
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        setValue(t0Data_, fileIdx_[i] * depth_ + d, value);
+    }
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        return value(data_, ((fileIdx_[i] * dates_.size() + j) * samples_ + k) * depth_ + d);
+    }
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        setValue(data_, ((fileIdx_[i] * dates_.size() + j) * samples_ + k) * depth_ + d, value);
+    }
+
+    //! The file backing this cube
+    const std::string& filename() const { return filename_; }
+    //! True if values are stored in double precision in the file
+    bool doublePrecision() const { return doublePrecision_; }
+    //! Write all modified pages back to the file
+    void flush();
+
+private:
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+    }
+    Real value(const char* block, const Size pos) const {
+        return doublePrecision_ ? reinterpret_cast<const double*>(block)[pos]
+                                : static_cast<Real>(reinterpret_cast<const float*>(block)[pos]);
+    }
+    void setValue(char* block, const Size pos, const Real value) {
+        QL_REQUIRE(!readOnly_, "MappedFileNPVCube: can not set value, cube '" << filename_ << "' is read only");
+        if (doublePrecision_)
+            reinterpret_cast<double*>(block)[pos] = value;
+        else
+            reinterpret_cast<float*>(block)[pos] = static_cast<float>(value);
+    }
+
+    std::string filename_;
+    bool readOnly_;
+    bool doublePrecision_;
+    QuantLib::Date asof_;
+    std::vector<QuantLib::Date> dates_;
+    Size samples_, depth_;
+    std::map<std::string, Size> idIdx_;
+    std::vector<Size> fileIdx_;
+    std::unique_ptr<boost::interprocess::file_mapping> file_;
+    std::unique_ptr<boost::interprocess::mapped_region> region_;
+    char* t0Data_;
+    char* data_;
+};
+
+//! Create a cube file with all values set to zero which can subsequently be opened as a MappedFileNPVCube
+void createMappedFileCube(const std::string& filename, const Date& asof, const std::set<std::string>& ids,
+                          const std::vector<Date>& dates, const Size samples, const Size depth = 1,
+                          const bool doublePrecision = false);
+
+//! Returns true if the given file starts with the MappedFileNPVCube header
+bool isMappedFileCube(const std::string& filename);
+
+//! Write an arbitrary cube to a file in the MappedFileNPVCube format
+void saveMappedFileCube(const std::string& filename, const NPVCube& cube, const bool doublePrecision = false);
+
+/*! Returns a cube factory to be used as cubeFactory or cptyCubeFactory in the MultiThreadedValuationEngine. The
+    first invocation creates the file for the given set of ids (which must contain the ids of all mini-cubes), each
+    invocation returns a writable view on the requested ids. After the run, the file can be opened as one cube
+    holding the results of all mini-cubes, i.e. there is no need to join them. */
+std::function<QuantLib::ext::shared_ptr<NPVCube>(const Date&, const std::set<std::string>&, const std::vector<Date>&,
+                                                 const Size)>
+mappedFileCubeFactory(const std::string& filename, const std::set<std::string>& ids, const Size depth = 1,
+                      const bool doublePrecision = false);
+
+} // namespace analytics
+} // namespace ore
@@ -76,8 +76,11 @@ template <typename T> Real SparseNpvCube<T>::getT0(Size i, Size d) const {
 
 template <typename T> void SparseNpvCube<T>::setT0(Real value, Size i, Size d) {
     this->check(i, 0, 0, d);
-    if (QuantLib::close_enough(value, 0.0))
+    // zero values are not stored, but must overwrite a previously stored value
+    if (QuantLib::close_enough(value, 0.0)) {
+        data_.erase(pos(i, 0, d));
         return;
+    }
     data_[pos(i, 0, d)] = std::vector<T>(1, static_cast<T>(value));
 }
 
@@ -92,9 +95,13 @@ template <typename T> Real SparseNpvCube<T>::get(Size i, Size j, Size k, Size d)
 
 template <typename T> void SparseNpvCube<T>::set(Real value, Size i, Size j, Size k, Size d) {
     this->check(i, j, k, d);
-    if (QuantLib::close_enough(value, 0.0))
-        return;
     auto v = data_.find(pos(i, j + 1, d));
+    // zero values are not stored, but must overwrite a previously stored value
+    if (QuantLib::close_enough(value, 0.0)) {
+        if (v != data_.end())
+            v->second[k] = static_cast<T>(0.0);
+        return;
+    }
     if (v != data_.end()) {
         v->second[k] = static_cast<T>(value);
     } else {
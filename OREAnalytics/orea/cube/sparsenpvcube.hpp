@@ -33,6 +33,8 @@ using QuantLib::Date;
 using QuantLib::Real;
 using QuantLib::Size;
 
+/*! Stores only the (date, depth) slices of an id holding non-zero values, in a map. The cube is not safe for
+    concurrent writes, not even to disjoint samples, since setting a value may insert a slice into the map. */
 template <typename T> class SparseNpvCube : public ore::analytics::NPVCube {
 public:
     SparseNpvCube();
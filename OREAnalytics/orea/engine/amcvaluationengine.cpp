@@ -31,9 +31,11 @@
 
 #include <qle/indexes/fallbackiborindex.hpp>
 #include <qle/instruments/payment.hpp>
+#include <qle/math/randomvariable_pool.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
 #include <qle/methods/multipathvariategenerator.hpp>
 #include <qle/models/lgmimpliedyieldtermstructure.hpp>
+#include <qle/models/projectedcrossassetmodel.hpp>
 #include <qle/pricingengines/mcmultilegbaseengine.hpp>
 
 #include <ql/instruments/compositeinstrument.hpp>
@@ -43,6 +45,7 @@
 #include <boost/timer/timer.hpp>
 
 #include <future>
+#include <numeric>
 
 using namespace ore::data;
 using namespace ore::analytics;
@@ -52,21 +55,53 @@ namespace analytics {
 
 namespace {
 
-Real fx(const std::vector<std::vector<std::vector<Real>>>& fxBuffer, const Size ccyIndex, const Size timeIndex,
-        const Size sample) {
+/* buffer for fx rates or ir states indexed by component, time index and sample, the values are stored either in double
+   or in single precision, the latter halves the memory footprint of the buffer */
+class StateBuffer {
+public:
+    StateBuffer() = default;
+    StateBuffer(const Size components, const Size times, const Size samples, const bool singlePrecision)
+        : components_(components), times_(times), samples_(samples), singlePrecision_(singlePrecision) {
+        if (singlePrecision_)
+            floatData_.resize(components_ * times_ * samples_);
+        else
+            doubleData_.resize(components_ * times_ * samples_);
+    }
+    Size size() const { return components_; }
+    Real operator()(const Size component, const Size timeIndex, const Size sample) const {
+        Size i = index(component, timeIndex, sample);
+        return singlePrecision_ ? static_cast<Real>(floatData_[i]) : doubleData_[i];
+    }
+    void set(const Size component, const Size timeIndex, const Size sample, const Real value) {
+        Size i = index(component, timeIndex, sample);
+        if (singlePrecision_)
+            floatData_[i] = static_cast<float>(value);
+        else
+            doubleData_[i] = value;
+    }
+
+private:
+    Size index(const Size component, const Size timeIndex, const Size sample) const {
+        return (component * times_ + timeIndex) * samples_ + sample;
+    }
+    Size components_ = 0, times_ = 0, samples_ = 0;
+    bool singlePrecision_ = false;
+    std::vector<Real> doubleData_;
+    std::vector<float> floatData_;
+};
+
+Real fx(const StateBuffer& fxBuffer, const Size ccyIndex, const Size timeIndex, const Size sample) {
     if (ccyIndex == 0)
         return 1.0;
-    return fxBuffer[ccyIndex - 1][timeIndex][sample];
+    return fxBuffer(ccyIndex - 1, timeIndex, sample);
 }
 
-Real state(const std::vector<std::vector<std::vector<Real>>>& irStateBuffer, const Size ccyIndex, const Size timeIndex,
-           const Size sample) {
-    return irStateBuffer[ccyIndex][timeIndex][sample];
+Real state(const StateBuffer& irStateBuffer, const Size ccyIndex, const Size timeIndex, const Size sample) {
+    return irStateBuffer(ccyIndex, timeIndex, sample);
 }
 
-Real numRatio(const QuantLib::ext::shared_ptr<CrossAssetModel>& model,
-              const std::vector<std::vector<std::vector<Real>>>& irStateBuffer, const Size ccyIndex,
-              const Size timeIndex, const Real time, const Size sample) {
+Real numRatio(const QuantLib::ext::shared_ptr<CrossAssetModel>& model, const StateBuffer& irStateBuffer,
+              const Size ccyIndex, const Size timeIndex, const Real time, const Size sample) {
     if (ccyIndex == 0)
         return 1.0;
     Real state_base = state(irStateBuffer, 0, timeIndex, sample);
@@ -74,23 +109,21 @@ Real numRatio(const QuantLib::ext::shared_ptr<CrossAssetModel>& model,
     return model->numeraire(ccyIndex, time, state_curr) / model->numeraire(0, time, state_base);
 }
 
-Real num(const QuantLib::ext::shared_ptr<CrossAssetModel>& model,
-         const std::vector<std::vector<std::vector<Real>>>& irStateBuffer, const Size ccyIndex, const Size timeIndex,
-         const Real time, const Size sample) {
+Real num(const QuantLib::ext::shared_ptr<CrossAssetModel>& model, const StateBuffer& irStateBuffer,
+         const Size ccyIndex, const Size timeIndex, const Real time, const Size sample) {
     Real state_curr = state(irStateBuffer, ccyIndex, timeIndex, sample);
     return model->numeraire(ccyIndex, time, state_curr);
 }
 
-Real discount(const QuantLib::ext::shared_ptr<CrossAssetModel>& model,
-              const std::vector<std::vector<std::vector<Real>>>& irStateBuffer, const Size ccyIndex,
-              const Size timeIndex, const Real t, const Real T, const Size sample) {
+Real discount(const QuantLib::ext::shared_ptr<CrossAssetModel>& model, const StateBuffer& irStateBuffer,
+              const Size ccyIndex, const Size timeIndex, const Real t, const Real T, const Size sample) {
     Real state_curr = state(irStateBuffer, ccyIndex, timeIndex, sample);
     return model->discountBond(ccyIndex, t, T, state_curr);
 }
 
 std::vector<QuantExt::RandomVariable>
 simulatePathInterface2(const QuantLib::ext::shared_ptr<AmcCalculator>& amcCalc, const std::vector<Real>& pathTimes,
-                       std::vector<std::vector<RandomVariable>>& paths, const std::vector<size_t>& pathIdx,
+                       const std::vector<std::vector<RandomVariable>>& paths, const std::vector<size_t>& pathIdx,
                        const std::vector<size_t>& timeIdx,
                        const std::string& tradeLabel,
                        const std::string& tradeType) {
@@ -110,8 +143,7 @@ std::vector<QuantExt::RandomVariable>
 feeContributions(const Size j, const QuantLib::ext::shared_ptr<ScenarioGeneratorData>& sgd, const Date& asof,
                  const Size samples, const std::vector<std::vector<std::tuple<Size, Real, QuantLib::Date>>>& tradeFees,
                  const QuantLib::ext::shared_ptr<CrossAssetModel>& model,
-                 const std::vector<std::vector<std::vector<Real>>>& fxBuffer,
-                 const std::vector<std::vector<std::vector<Real>>>& irStateBuffer) {
+                 const StateBuffer& fxBuffer, const StateBuffer& irStateBuffer) {
     std::vector<QuantExt::RandomVariable> result;
     for (Size k = 0; k < sgd->getGrid()->timeGrid().size(); ++k) {
         Date simDate = k == 0 ? asof : sgd->getGrid()->dates()[k - 1];
@@ -140,17 +172,127 @@ feeContributions(const Size j, const QuantLib::ext::shared_ptr<ScenarioGenerator
     return result;
 }
 
-void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
-                   const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
-                   const QuantLib::ext::shared_ptr<ore::data::Market>& market,
-                   const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
-                   const std::vector<string>& aggDataIndices, const std::vector<string>& aggDataCurrencies,
-                   const Size aggDataNumberCreditStates, QuantLib::ext::shared_ptr<ore::analytics::AggregationScenarioData> asd,
-                   QuantLib::ext::shared_ptr<NPVCube> outputCube, QuantLib::ext::shared_ptr<ProgressIndicator> progressIndicator) {
+// add the state indices of the ir and fx components of the currency with the given index to states
 
-    std::ostringstream detail;
-    detail << portfolio->size() << " trade" << (portfolio->size() == 1 ? "" : "s");
-    progressIndicator->updateProgress(0, portfolio->size(), detail.str());
+void addCurrencyStates(const QuantLib::ext::shared_ptr<CrossAssetModel>& model, const Size ccyIndex,
+                       std::set<Size>& states) {
+    for (Size p = 0; p < model->stateVariables(CrossAssetModel::AssetType::IR, ccyIndex); ++p)
+        states.insert(model->pIdx(CrossAssetModel::AssetType::IR, ccyIndex, p));
+    if (ccyIndex > 0) {
+        for (Size p = 0; p < model->stateVariables(CrossAssetModel::AssetType::FX, ccyIndex - 1); ++p)
+            states.insert(model->pIdx(CrossAssetModel::AssetType::FX, ccyIndex - 1, p));
+    }
+}
+
+/* projection of the model on the components owning the required states, completed by the ir and fx components of the
+   base currency and of the currencies of these components. For each state of the model, stateIndex is set to the
+   corresponding state of the projected model or to Null<Size>() if the state is not simulated. If requiredStates is
+   empty, the projection is not supported (commodity and credit components) or does not reduce the number of states,
+   the model itself is returned. */
+
+QuantLib::ext::shared_ptr<CrossAssetModel> projectedModel(const QuantLib::ext::shared_ptr<CrossAssetModel>& model,
+                                                          const std::set<Size>& requiredStates,
+                                                          std::vector<Size>& stateIndex) {
+    using AssetType = CrossAssetModel::AssetType;
+
+    Size nStates = model->stateProcess()->size();
+    stateIndex.resize(nStates);
+    std::iota(stateIndex.begin(), stateIndex.end(), 0);
+    if (requiredStates.empty())
+        return model;
+
+    // determine the required components
+
+    std::set<Size> covered, ccys = {0}, inf, eq;
+    auto isRequired = [&model, &requiredStates, &covered](const AssetType t, const Size c) {
+        bool required = false;
+        for (Size p = 0; p < model->stateVariables(t, c); ++p) {
+            covered.insert(model->pIdx(t, c, p));
+            required = required || requiredStates.count(model->pIdx(t, c, p)) > 0;
+        }
+        return required;
+    };
+
+    for (Size c = 0; c < model->components(AssetType::IR); ++c) {
+        if (isRequired(AssetType::IR, c))
+            ccys.insert(c);
+    }
+    for (Size c = 0; c < model->components(AssetType::FX); ++c) {
+        if (isRequired(AssetType::FX, c))
+            ccys.insert(c + 1);
+    }
+    for (Size c = 0; c < model->components(AssetType::INF); ++c) {
+        if (isRequired(AssetType::INF, c)) {
+            inf.insert(c);
+            ccys.insert(model->ccyIndex(model->inf(c)->currency()));
+        }
+    }
+    for (Size c = 0; c < model->components(AssetType::EQ); ++c) {
+        if (isRequired(AssetType::EQ, c)) {
+            eq.insert(c);
+            ccys.insert(model->ccyIndex(model->eq(c)->currency()));
+        }
+    }
+    for (auto t : {AssetType::CR, AssetType::COM, AssetType::CrState}) {
+        for (Size c = 0; c < model->components(t); ++c) {
+            if (isRequired(t, c)) {
+                LOG("AMCValuationEngine: cr, com or crstate components required, simulate the full model");
+                return model;
+            }
+        }
+    }
+    QL_REQUIRE(std::includes(covered.begin(), covered.end(), requiredStates.begin(), requiredStates.end()),
+               "AMCValuationEngine: required states are not covered by the model components, internal error");
+
+    // collect the components in the order of the model, skip the projection if it does not reduce the states
+
+    std::vector<std::pair<AssetType, Size>> selectedComponents;
+    for (auto c : ccys)
+        selectedComponents.push_back(std::make_pair(AssetType::IR, c));
+    for (auto c : ccys) {
+        if (c > 0)
+            selectedComponents.push_back(std::make_pair(AssetType::FX, c - 1));
+    }
+    for (auto c : inf)
+        selectedComponents.push_back(std::make_pair(AssetType::INF, c));
+    for (auto c : eq)
+        selectedComponents.push_back(std::make_pair(AssetType::EQ, c));
+
+    Size nProjectedStates = 0;
+    for (auto const& c : selectedComponents)
+        nProjectedStates += model->stateVariables(c.first, c.second);
+    if (nProjectedStates >= nStates) {
+        LOG("AMCValuationEngine: all " << nStates << " model states required, simulate the full model");
+        return model;
+    }
+
+    std::vector<Size> projectedStateProcessIndices;
+    auto result = getProjectedCrossAssetModel(model, selectedComponents, projectedStateProcessIndices);
+    std::fill(stateIndex.begin(), stateIndex.end(), Null<Size>());
+    for (Size i = 0; i < projectedStateProcessIndices.size(); ++i)
+        stateIndex[projectedStateProcessIndices[i]] = i;
+    LOG("AMCValuationEngine: simulate projected model with " << nProjectedStates << " instead of " << nStates
+                                                             << " states");
+    return result;
+}
+
+/* simulated paths and buffers derived from them, these are shared between the runs of the core engine; the paths are
+   passed to the amc calculators and are therefore always stored in double precision */
+struct SimulatedPaths {
+    StateBuffer fxBuffer;
+    StateBuffer irStateBuffer;
+    std::vector<Real> pathTimes;
+    std::vector<std::vector<RandomVariable>> paths;
+};
+
+QuantLib::ext::shared_ptr<const SimulatedPaths>
+simulatePaths(const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+              const QuantLib::ext::shared_ptr<ore::data::Market>& market,
+              const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
+              const std::vector<string>& aggDataIndices, const std::vector<string>& aggDataCurrencies,
+              const Size aggDataNumberCreditStates,
+              QuantLib::ext::shared_ptr<ore::analytics::AggregationScenarioData> asd, const Size samples,
+              const bool singlePrecisionPaths, const std::set<Size>& requiredStates) {
 
     // base currency is the base currency of the cam
 
@@ -158,13 +300,12 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
 
     // timings
 
-    boost::timer::cpu_timer timer, timerTotal;
-    Real calibrationTime = 0.0, valuationTime = 0.0, asdTime = 0.0, bufferTime = 0.0, pathGenTime = 0.0, residualTime,
-         totalTime;
-    timerTotal.start();
+    boost::timer::cpu_timer timer;
+    Real asdTime = 0.0, bufferTime = 0.0, pathGenTime = 0.0;
 
-    // prepare for asd writing
+    // prepare for asd writing, the asd currencies are added to the required states (if these are given)
 
+    std::set<Size> states = requiredStates;
     std::vector<Size> asdCurrencyIndex; // FX Spots
     std::vector<string> asdCurrencyCode;
     std::vector<QuantLib::ext::shared_ptr<LgmImpliedYtsFwdFwdCorrected>> asdIndexCurve; // Ibor Indices
@@ -181,6 +322,8 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
             Size ccyIndex = model->ccyIndex(cur);
             asdCurrencyIndex.push_back(ccyIndex);
             asdCurrencyCode.push_back(c);
+            if (!states.empty())
+                addCurrencyStates(model, ccyIndex, states);
         }
         // ibor indices
         for (auto const& i : aggDataIndices) {
@@ -196,11 +339,162 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
             asdIndex.push_back(tmp->clone(Handle<YieldTermStructure>(asdIndexCurve.back())));
             asdIndexIndex.push_back(ccyIndex);
             asdIndexName.push_back(i);
+            if (!states.empty())
+                addCurrencyStates(model, ccyIndex, states);
         }
     } else {
         LOG("No asd object set, won't write aggregation scenario data...");
     }
 
+    // set up buffers for fx rates and ir states that we need below for the runs against interface 1 and 2
+    // we set these buffers up on the full grid (i.e. valuation + close-out dates, also including the T0 date)
+
+    auto result = QuantLib::ext::make_shared<SimulatedPaths>();
+    auto& fxBuffer = result->fxBuffer;
+    auto& irStateBuffer = result->irStateBuffer;
+    auto& pathTimes = result->pathTimes;
+    auto& paths = result->paths;
+
+    fxBuffer = StateBuffer(model->components(CrossAssetModel::AssetType::FX), sgd->getGrid()->dates().size() + 1,
+                           samples, singlePrecisionPaths);
+    irStateBuffer = StateBuffer(model->components(CrossAssetModel::AssetType::IR),
+                                sgd->getGrid()->dates().size() + 1, samples, singlePrecisionPaths);
+
+    // determine the simulated model, this is a projection of the model if only a part of the states is required
+
+    for (Size j = 0; j < aggDataNumberCreditStates && !states.empty(); ++j)
+        states.insert(model->pIdx(CrossAssetModel::AssetType::CrState, j));
+    std::vector<Size> stateIndex;
+    auto simulatedModel = projectedModel(model, states, stateIndex);
+
+    // set up cache for paths, states which are not simulated are held at their initial value
+
+    auto process = simulatedModel->stateProcess();
+    if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
+        tmp->resetCache(sgd->getGrid()->timeGrid().size() - 1);
+    }
+    Array initialState = model->stateProcess()->initialValues();
+    Size nStates = initialState.size();
+    QL_REQUIRE(sgd->getGrid()->timeGrid().size() > 0, "AMCValuationEngine: empty time grid given");
+    pathTimes = std::vector<Real>(std::next(sgd->getGrid()->timeGrid().begin(), 1), sgd->getGrid()->timeGrid().end());
+    paths = std::vector<std::vector<RandomVariable>>(pathTimes.size(), std::vector<RandomVariable>(nStates));
+    for (Size j = 0; j < pathTimes.size(); ++j) {
+        for (Size k = 0; k < nStates; ++k) {
+            paths[j][k] = stateIndex[k] == Null<Size>() ? RandomVariable(samples, initialState[k])
+                                                        : RandomVariable(samples);
+        }
+    }
+
+    // fill fx buffer, ir state buffer and write ASD
+
+    auto pathGenerator = makeMultiPathGenerator(sgd->sequenceType(), process, sgd->getGrid()->timeGrid(), sgd->seed(),
+                                                sgd->ordering(), sgd->directionIntegers());
+    if (sgd->firstSample() > 0)
+        pathGenerator->skipTo(sgd->firstSample());
+
+    LOG("Write ASD, fill internal fx and irState buffers...");
+
+    for (Size i = 0; i < samples; ++i) {
+        timer.start();
+        const auto& path = pathGenerator->next().value;
+        timer.stop();
+        pathGenTime += timer.elapsed().wall * 1e-9;
+
+        // the value of the model state k at time index j on the simulated path
+        auto pathValue = [&path, &stateIndex, &initialState](const Size k, const Size j) {
+            return stateIndex[k] == Null<Size>() ? initialState[k] : path[stateIndex[k]][j];
+        };
+
+        // populate fx and ir state buffers, populate cached paths for interface 2
+
+        timer.start();
+        for (Size k = 0; k < fxBuffer.size(); ++k) {
+            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
+                fxBuffer.set(k, j, i, std::exp(pathValue(model->pIdx(CrossAssetModel::AssetType::FX, k), j)));
+            }
+        }
+        for (Size k = 0; k < irStateBuffer.size(); ++k) {
+            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
+                irStateBuffer.set(k, j, i, pathValue(model->pIdx(CrossAssetModel::AssetType::IR, k), j));
+            }
+        }
+
+        for (Size k = 0; k < nStates; ++k) {
+            if (stateIndex[k] == Null<Size>())
+                continue;
+            for (Size j = 0; j < pathTimes.size(); ++j) {
+                paths[j][k].set(i, path[stateIndex[k]][j + 1]);
+            }
+        }
+        timer.stop();
+        bufferTime += timer.elapsed().wall * 1e-9;
+
+        // write aggregation scenario data, TODO this seems relatively slow, can we speed it up using LgmVectorised
+
+        if (asd != nullptr) {
+            timer.start();
+            Size dateIndex = 0;
+            for (Size k = 1; k < sgd->getGrid()->timeGrid().size(); ++k) {
+                // only write asd on valuation dates
+                if (!sgd->getGrid()->isValuationDate()[k - 1])
+                    continue;
+                // set numeraire
+                asd->set(dateIndex, i, model->numeraire(0, path[0].time(k), pathValue(0, k)),
+                         AggregationScenarioDataType::Numeraire);
+                // set fx spots
+                for (Size j = 0; j < asdCurrencyIndex.size(); ++j) {
+                    asd->set(dateIndex, i, fx(fxBuffer, asdCurrencyIndex[j], k, i), AggregationScenarioDataType::FXSpot,
+                             asdCurrencyCode[j]);
+                }
+                // set index fixings
+                Date d = sgd->getGrid()->dates()[k - 1];
+                for (Size j = 0; j < asdIndex.size(); ++j) {
+                    asdIndexCurve[j]->move(d, state(irStateBuffer, asdIndexIndex[j], k, i));
+                    auto index = asdIndex[j];
+                    if (auto fb = QuantLib::ext::dynamic_pointer_cast<FallbackIborIndex>(asdIndex[j])) {
+                        // proxy fallback ibor index by its rfr index's fixing
+                        index = fb->rfrIndex();
+                    }
+                    asd->set(dateIndex, i, index->fixing(index->fixingCalendar().adjust(d)),
+                             AggregationScenarioDataType::IndexFixing, asdIndexName[j]);
+                }
+                // set credit states
+                for (Size j = 0; j < aggDataNumberCreditStates; ++j) {
+                    asd->set(dateIndex, i, pathValue(model->pIdx(CrossAssetModel::AssetType::CrState, j), k),
+                             AggregationScenarioDataType::CreditState, std::to_string(j));
+                }
+                ++dateIndex;
+            }
+            timer.stop();
+            asdTime += timer.elapsed().wall * 1e-9;
+        }
+    }
+
+    LOG("asd time             : " << asdTime << " sec");
+    LOG("buffer time          : " << bufferTime << " sec");
+    LOG("path generation time : " << pathGenTime << " sec");
+
+    return result;
+}
+
+void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+                   const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+                   const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
+                   QuantLib::ext::shared_ptr<NPVCube> outputCube,
+                   QuantLib::ext::shared_ptr<ProgressIndicator> progressIndicator,
+                   const std::function<QuantLib::ext::shared_ptr<const SimulatedPaths>(const std::set<Size>&)>&
+                       getPaths) {
+
+    std::ostringstream detail;
+    detail << portfolio->size() << " trade" << (portfolio->size() == 1 ? "" : "s");
+    progressIndicator->updateProgress(0, portfolio->size(), detail.str());
+
+    // timings
+
+    boost::timer::cpu_timer timer, timerTotal;
+    Real calibrationTime = 0.0, pathTime = 0.0, valuationTime = 0.0, residualTime, totalTime;
+    timerTotal.start();
+
     // extract AMC calculators, fees and some other infos we need from the ore wrapper
 
     LOG("Extract AMC Calculators...");
@@ -221,6 +515,7 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     RandomVariableStats::instance().data_timer.stop();
     RandomVariableStats::instance().calc_timer.start();
     RandomVariableStats::instance().calc_timer.stop();
+    RandomVariablePool::instance().resetStats();
     McEngineStats::instance().other_timer.start();
     McEngineStats::instance().other_timer.stop();
     McEngineStats::instance().path_timer.start();
@@ -308,103 +603,34 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     calibrationTime += timer.elapsed().wall * 1e-9;
     LOG("Extracted " << amcCalculators.size() << " AMCCalculators for " << portfolio->size() << " source trades");
 
-    // set up buffers for fx rates and ir states that we need below for the runs against interface 1 and 2
-    // we set these buffers up on the full grid (i.e. valuation + close-out dates, also including the T0 date)
-
-    std::vector<std::vector<std::vector<Real>>> fxBuffer(
-        model->components(CrossAssetModel::AssetType::FX),
-        std::vector<std::vector<Real>>(sgd->getGrid()->dates().size() + 1, std::vector<Real>(outputCube->samples())));
-    std::vector<std::vector<std::vector<Real>>> irStateBuffer(
-        model->components(CrossAssetModel::AssetType::IR),
-        std::vector<std::vector<Real>>(sgd->getGrid()->dates().size() + 1, std::vector<Real>(outputCube->samples())));
-
-    // set up cache for paths
-
-    auto process = model->stateProcess();
-    if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
-        tmp->resetCache(sgd->getGrid()->timeGrid().size() - 1);
+    /* collect the model states read by the amc calculators and required to convert their results and fees to the
+       base currency, this is left empty if a calculator does not provide its required states */
+
+    std::set<Size> requiredStates;
+    bool allStatesRequired = false;
+    for (Size j = 0; j < amcCalculators.size() && !allStatesRequired; ++j) {
+        auto states = amcCalculators[j]->requiredStateIndices();
+        allStatesRequired = states.empty();
+        requiredStates.insert(states.begin(), states.end());
+        addCurrencyStates(model, currencyIndex[j], requiredStates);
+        for (auto const& f : tradeFees[j])
+            addCurrencyStates(model, std::get<0>(f), requiredStates);
     }
-    Size nStates = process->size();
-    QL_REQUIRE(sgd->getGrid()->timeGrid().size() > 0, "AMCValuationEngine: empty time grid given");
-    std::vector<Real> pathTimes(std::next(sgd->getGrid()->timeGrid().begin(), 1), sgd->getGrid()->timeGrid().end());
-    std::vector<std::vector<RandomVariable>> paths(
-        pathTimes.size(), std::vector<RandomVariable>(nStates, RandomVariable(outputCube->samples())));
-
-    // fill fx buffer, ir state buffer and write ASD
-
-    auto pathGenerator = makeMultiPathGenerator(sgd->sequenceType(), process, sgd->getGrid()->timeGrid(), sgd->seed(),
-                                                sgd->ordering(), sgd->directionIntegers());
-
-    LOG("Write ASD, fill internal fx and irState buffers...");
-
-    for (Size i = 0; i < outputCube->samples(); ++i) {
-        timer.start();
-        const auto& path = pathGenerator->next().value;
-        timer.stop();
-        pathGenTime += timer.elapsed().wall * 1e-9;
+    if (allStatesRequired)
+        requiredStates.clear();
 
-        // populate fx and ir state buffers, populate cached paths for interface 2
+    // get the simulated paths, these are either generated here or by another thread running the core engine
 
-        timer.start();
-        for (Size k = 0; k < fxBuffer.size(); ++k) {
-            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
-                fxBuffer[k][j][i] = std::exp(path[model->pIdx(CrossAssetModel::AssetType::FX, k)][j]);
-            }
-        }
-        for (Size k = 0; k < irStateBuffer.size(); ++k) {
-            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
-                irStateBuffer[k][j][i] = path[model->pIdx(CrossAssetModel::AssetType::IR, k)][j];
-            }
-        }
-
-        for (Size k = 0; k < nStates; ++k) {
-            for (Size j = 0; j < pathTimes.size(); ++j) {
-                paths[j][k].set(i, path[k][j + 1]);
-            }
-        }
-        timer.stop();
-        bufferTime += timer.elapsed().wall * 1e-9;
+    timer.start();
+    auto simulatedPaths = getPaths(requiredStates);
+    timer.stop();
+    pathTime += timer.elapsed().wall * 1e-9;
 
-        // write aggregation scenario data, TODO this seems relatively slow, can we speed it up using LgmVectorised
+    const auto& fxBuffer = simulatedPaths->fxBuffer;
+    const auto& irStateBuffer = simulatedPaths->irStateBuffer;
+    const auto& pathTimes = simulatedPaths->pathTimes;
+    const auto& paths = simulatedPaths->paths;
 
-        if (asd != nullptr) {
-            timer.start();
-            Size dateIndex = 0;
-            for (Size k = 1; k < sgd->getGrid()->timeGrid().size(); ++k) {
-                // only write asd on valuation dates
-                if (!sgd->getGrid()->isValuationDate()[k - 1])
-                    continue;
-                // set numeraire
-                asd->set(dateIndex, i, model->numeraire(0, path[0].time(k), path[0][k]),
-                         AggregationScenarioDataType::Numeraire);
-                // set fx spots
-                for (Size j = 0; j < asdCurrencyIndex.size(); ++j) {
-                    asd->set(dateIndex, i, fx(fxBuffer, asdCurrencyIndex[j], k, i), AggregationScenarioDataType::FXSpot,
-                             asdCurrencyCode[j]);
-                }
-                // set index fixings
-                Date d = sgd->getGrid()->dates()[k - 1];
-                for (Size j = 0; j < asdIndex.size(); ++j) {
-                    asdIndexCurve[j]->move(d, state(irStateBuffer, asdIndexIndex[j], k, i));
-                    auto index = asdIndex[j];
-                    if (auto fb = QuantLib::ext::dynamic_pointer_cast<FallbackIborIndex>(asdIndex[j])) {
-                        // proxy fallback ibor index by its rfr index's fixing
-                        index = fb->rfrIndex();
-                    }
-                    asd->set(dateIndex, i, index->fixing(index->fixingCalendar().adjust(d)),
-                             AggregationScenarioDataType::IndexFixing, asdIndexName[j]);
-                }
-                // set credit states
-                for (Size j = 0; j < aggDataNumberCreditStates; ++j) {
-                    asd->set(dateIndex, i, path[model->pIdx(CrossAssetModel::AssetType::CrState, j)][k],
-                             AggregationScenarioDataType::CreditState, std::to_string(j));
-                }
-                ++dateIndex;
-            }
-            timer.stop();
-            asdTime += timer.elapsed().wall * 1e-9;
-        }
-    }
 
     // Run AmcCalculators
 
@@ -573,11 +799,9 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     valuationTime += timer.elapsed().wall * 1e-9;
 
     totalTime = timerTotal.elapsed().wall * 1e-9;
-    residualTime = totalTime - (calibrationTime + pathGenTime + valuationTime + asdTime + bufferTime);
+    residualTime = totalTime - (calibrationTime + pathTime + valuationTime);
     LOG("calibration time     : " << calibrationTime << " sec");
-    LOG("asd time             : " << asdTime << " sec");
-    LOG("buffer time          : " << bufferTime << " sec");
-    LOG("path generation time : " << pathGenTime << " sec");
+    LOG("path time            : " << pathTime << " sec");
     LOG("valuation time       : " << valuationTime << " sec");
     LOG("residual time        : " << residualTime << " sec");
     LOG("total time           : " << totalTime << " sec");
@@ -593,6 +817,9 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     LOG("Calc Performace      : " << RandomVariableStats::instance().calc_ops * 1E3 /
                                          RandomVariableStats::instance().calc_timer.elapsed().wall
                                   << " MFLOPS");
+    LOG("RV Pool Allocations  : " << RandomVariablePool::instance().stats().poolAllocations);
+    LOG("RV Fresh Allocations : " << RandomVariablePool::instance().stats().freshAllocations);
+    LOG("RV Pool Peak Size    : " << RandomVariablePool::instance().stats().peakPooledBytes / 1E6 << " MB");
     LOG("MC Other Timer       : " << McEngineStats::instance().other_timer.elapsed().wall / 1E9 << " sec");
     LOG("MC Path Timer        : " << McEngineStats::instance().path_timer.elapsed().wall / 1E9 << " sec");
     LOG("MC Calc Timer        : " << McEngineStats::instance().calc_timer.elapsed().wall / 1E9 << " sec");
@@ -619,7 +846,8 @@ AMCValuationEngine::AMCValuationEngine(
         const QuantLib::Date&, const std::set<std::string>&, const std::vector<QuantLib::Date>&, const QuantLib::Size)>&
         cubeFactory,
     const QuantLib::ext::shared_ptr<Scenario>& offSetScenario,
-    const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& simMarketParams)
+    const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& simMarketParams,
+    const bool singlePrecisionPaths, const bool projectModel)
     : useMultithreading_(true), aggDataIndices_(aggDataIndices), aggDataCurrencies_(aggDataCurrencies),
       aggDataNumberCreditStates_(aggDataNumberCreditStates), scenarioGeneratorData_(scenarioGeneratorData),
       nThreads_(nThreads), today_(today), nSamples_(nSamples), loader_(loader),
@@ -630,7 +858,8 @@ AMCValuationEngine::AMCValuationEngine(
       configurationCrCalibration_(configurationCrCalibration), configurationFinalModel_(configurationFinalModel),
       referenceData_(referenceData), iborFallbackConfig_(iborFallbackConfig),
       handlePseudoCurrenciesTodaysMarket_(handlePseudoCurrenciesTodaysMarket), cubeFactory_(cubeFactory),
-      offsetScenario_(offSetScenario), simMarketParams_(simMarketParams) {
+      offsetScenario_(offSetScenario), simMarketParams_(simMarketParams), singlePrecisionPaths_(singlePrecisionPaths),
+      projectModel_(projectModel) {
 #ifndef QL_ENABLE_SESSIONS
     QL_FAIL(
         "AMCValuationEngine requires a build with QL_ENABLE_SESSIONS = ON when ctor multi-threaded runs is called.");
@@ -650,10 +879,11 @@ AMCValuationEngine::AMCValuationEngine(const QuantLib::ext::shared_ptr<QuantExt:
                                        const QuantLib::ext::shared_ptr<Market>& market,
                                        const std::vector<string>& aggDataIndices,
                                        const std::vector<string>& aggDataCurrencies,
-                                       const Size aggDataNumberCreditStates)
+                                       const Size aggDataNumberCreditStates, const bool singlePrecisionPaths,
+                                       const bool projectModel)
     : useMultithreading_(false), aggDataIndices_(aggDataIndices), aggDataCurrencies_(aggDataCurrencies),
       aggDataNumberCreditStates_(aggDataNumberCreditStates), scenarioGeneratorData_(scenarioGeneratorData),
-      model_(model), market_(market) {
+      model_(model), market_(market), singlePrecisionPaths_(singlePrecisionPaths), projectModel_(projectModel) {
 
     QL_REQUIRE((aggDataIndices.empty() && aggDataCurrencies.empty()) || market != nullptr,
                "AMCValuationEngine: market is required for asd generation");
@@ -691,9 +921,14 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<Portfolio>& p
 
     try {
         // we can use the mt progress indicator here although we are running on a single thread
-        runCoreEngine(portfolio, model_, market_, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_,
-                      aggDataNumberCreditStates_, asd_, outputCube,
-                      QuantLib::ext::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators()));
+        runCoreEngine(portfolio, model_, scenarioGeneratorData_, outputCube,
+                      QuantLib::ext::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators()),
+                      [this, &outputCube](const std::set<Size>& requiredStates) {
+                          return simulatePaths(model_, market_, scenarioGeneratorData_, aggDataIndices_,
+                                               aggDataCurrencies_, aggDataNumberCreditStates_, asd_,
+                                               outputCube->samples(), singlePrecisionPaths_,
+                                               projectModel_ ? requiredStates : std::set<Size>());
+                      });
     } catch (const std::exception& e) {
         QL_FAIL("Error during amc val engine run: " << e.what());
     }
@@ -791,9 +1026,21 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
 
     ore::analytics::ObservationMode::Mode obsMode = ore::analytics::ObservationMode::instance().mode();
 
+    /* the paths are generated once by thread 0 (which also writes the asd) and shared read-only with the other
+       threads, all threads build identical models, since they use the same market data and calibration */
+
+    std::promise<QuantLib::ext::shared_ptr<const SimulatedPaths>> pathsPromise;
+    std::shared_future<QuantLib::ext::shared_ptr<const SimulatedPaths>> sharedPaths = pathsPromise.get_future().share();
+
+    /* if the model is projected, thread 0 waits for the model states required by the portfolios of all threads before
+       it generates the paths */
+
+    std::vector<std::promise<std::set<Size>>> statesPromises(projectModel_ ? eff_nThreads : 0);
+
     for (Size i = 0; i < eff_nThreads; ++i) {
 
-        auto job = [this, obsMode, &portfoliosAsString, &loaders, &simDates, &progressIndicator](int id) -> resultType {
+        auto job = [this, obsMode, &portfoliosAsString, &loaders, &simDates, &progressIndicator, &pathsPromise,
+                    &sharedPaths, &statesPromises](int id) -> resultType {
             // set thread local singletons
 
             QuantLib::Settings::instance().evaluationDate() = today_;
@@ -850,10 +1097,32 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
 
                 portfolio->build(engineFactory, "amc-val-engine", true);
 
-                // run core engine code (asd is written for thread id 0 only)
-
-                runCoreEngine(portfolio, cam, market, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_,
-                              aggDataNumberCreditStates_, id == 0 ? asd_ : nullptr, miniCubes_[id], progressIndicator);
+                // run core engine code (paths are generated and asd is written by thread id 0 only)
+
+                runCoreEngine(portfolio, cam, scenarioGeneratorData_, miniCubes_[id], progressIndicator,
+                              [this, id, &cam, &market, &pathsPromise, &sharedPaths,
+                               &statesPromises](const std::set<Size>& requiredStates) {
+                                  if (projectModel_)
+                                      statesPromises[id].set_value(requiredStates);
+                                  if (id != 0)
+                                      return sharedPaths.get();
+                                  // the union of the required states, empty if one of the threads requires all
+                                  std::set<Size> states;
+                                  for (Size t = 0; t < statesPromises.size(); ++t) {
+                                      auto threadStates = statesPromises[t].get_future().get();
+                                      if (threadStates.empty()) {
+                                          states.clear();
+                                          break;
+                                      }
+                                      states.insert(threadStates.begin(), threadStates.end());
+                                  }
+                                  auto paths =
+                                      simulatePaths(cam, market, scenarioGeneratorData_, aggDataIndices_,
+                                                    aggDataCurrencies_, aggDataNumberCreditStates_, asd_, nSamples_,
+                                                    singlePrecisionPaths_, states);
+                                  pathsPromise.set_value(paths);
+                                  return paths;
+                              });
 
                 // return code 0 = ok
 
@@ -869,6 +1138,26 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
                                                                 e.what())
                     .log();
                 rc = 1;
+
+                // if the thread fails before providing its required states, propagate the error to thread 0
+
+                if (projectModel_) {
+                    try {
+                        statesPromises[id].set_exception(std::current_exception());
+                    } catch (const std::future_error&) {
+                        // states were provided already
+                    }
+                }
+
+                // if thread 0 fails before providing the paths, propagate the error to the waiting threads
+
+                if (id == 0) {
+                    try {
+                        pathsPromise.set_exception(std::current_exception());
+                    } catch (const std::future_error&) {
+                        // paths were provided already
+                    }
+                }
             }
 
             // exit
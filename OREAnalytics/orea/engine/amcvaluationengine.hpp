@@ -39,13 +39,24 @@ namespace analytics {
 using std::string;
 
 //! AMC Valuation Engine
+/*! If singlePrecisionPaths is true, the buffers of simulated fx rates and ir states used to convert the amc
+    calculator results to the base currency and to deflate them are stored in single precision, the conversion
+    itself is done in double precision.
+
+    If projectModel is true, the state process components read by the amc calculators of the portfolio and required
+    for the conversion of their results to the base currency and for the aggregation scenario data are determined.
+    If these cover only a part of the model (e.g. a single currency portfolio in a multi currency model), a projection
+    of the model on the required components is simulated instead of the full model and the simulated paths are mapped
+    back to the full model's state layout, the remaining components are held at their initial values. The paths are
+    different from, but have the same distribution as the paths of the full model then. */
 class AMCValuationEngine : public ore::data::ProgressReporter {
 public:
     //! Constructor for single-threaded runs
     AMCValuationEngine(const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
                        const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& scenarioGeneratorData,
                        const QuantLib::ext::shared_ptr<ore::data::Market>& market, const std::vector<string>& aggDataIndices,
-                       const std::vector<string>& aggDataCurrencies, const Size aggDataNumberCreditStates);
+                       const std::vector<string>& aggDataCurrencies, const Size aggDataNumberCreditStates,
+                       const bool singlePrecisionPaths = false, const bool projectModel = false);
 
     //! Constructor for multi threaded runs
     AMCValuationEngine(
@@ -67,7 +78,8 @@ public:
             const QuantLib::Date&, const std::set<std::string>&, const std::vector<QuantLib::Date>&,
             const QuantLib::Size)>& cubeFactory = {},
         const QuantLib::ext::shared_ptr<Scenario>& offSetScenario = nullptr,
-        const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& simMarketParams = nullptr);
+        const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& simMarketParams = nullptr,
+        const bool singlePrecisionPaths = false, const bool projectModel = false);
 
     //! build cube in single threaded run
     void buildCube(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
@@ -124,6 +136,10 @@ private:
         cubeFactory_;
     QuantLib::ext::shared_ptr<Scenario> offsetScenario_;
     QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters> simMarketParams_;
+    // store the fx and ir state buffers in single precision
+    bool singlePrecisionPaths_ = false;
+    // simulate a projection of the model on the components required by the portfolio
+    bool projectModel_ = false;
     // result cubes for multi-threaded run
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> miniCubes_;
 };
@@ -0,0 +1,304 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/analyticlinearsensitivities.hpp>
+#include <orea/scenario/deltascenario.hpp>
+
+#include <ored/portfolio/instrumentwrapper.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <qle/pricingengines/discountingswapenginedeltagamma.hpp>
+
+#include <ql/cashflows/fixedratecoupon.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/cashflows/simplecashflow.hpp>
+#include <ql/instruments/swap.hpp>
+
+#include <algorithm>
+#include <typeinfo>
+
+using namespace QuantLib;
+using namespace ore::data;
+
+namespace ore {
+namespace analytics {
+
+AnalyticLinearSensitivities::AnalyticLinearSensitivities(
+    const QuantLib::ext::shared_ptr<ScenarioSimMarket>& simMarket,
+    const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& simMarketData, const std::string& marketConfiguration,
+    const QuantLib::ext::shared_ptr<ore::data::Market>& t0Market)
+    : simMarket_(simMarket), marketConfiguration_(marketConfiguration), t0Market_(t0Market),
+      baseCcy_(simMarketData->baseCcy()), flatZero_(simMarketData->extrapolation() == "FlatZero"),
+      linearInZero_(simMarketData->interpolation() == "LinearZero") {
+
+    Date asof = simMarket_->asofDate();
+    auto baseScenario = simMarket_->baseScenarioAbsolute();
+
+    // collect the simulated discount and index curves with their pillar keys and times
+
+    auto addCurve = [this, &asof, &baseScenario](const RiskFactorKey::KeyType keyType, const std::string& name,
+                                                 const Handle<YieldTermStructure>& ts,
+                                                 const std::vector<Period>& tenors) {
+        if (ts.empty() || tenors.empty())
+            return;
+        Curve curve;
+        curve.lastDate = asof + tenors.back();
+        for (Size j = 0; j < tenors.size(); ++j) {
+            RiskFactorKey key(keyType, name, j);
+            if (!baseScenario->has(key))
+                return;
+            curve.keys.push_back(key);
+            curve.times.push_back(ts->dayCounter().yearFraction(asof, asof + tenors[j]));
+        }
+        for (Size j = 0; j < curve.keys.size(); ++j)
+            curveKeys_[curve.keys[j]] = std::make_pair(curve.times[j], baseScenario->get(curve.keys[j]));
+        curves_[ts.currentLink().get()] = curve;
+    };
+
+    for (auto const& ccy : simMarketData->ccys()) {
+        try {
+            addCurve(RiskFactorKey::KeyType::DiscountCurve, ccy,
+                     simMarket_->discountCurve(ccy, marketConfiguration_), simMarketData->yieldCurveTenors(ccy));
+        } catch (const std::exception& e) {
+            DLOG("AnalyticLinearSensitivities: skip discount curve " << ccy << ": " << e.what());
+        }
+    }
+
+    for (auto const& name : simMarketData->indices()) {
+        try {
+            addCurve(RiskFactorKey::KeyType::IndexCurve, name,
+                     simMarket_->iborIndex(name, marketConfiguration_)->forwardingTermStructure(),
+                     simMarketData->yieldCurveTenors(name));
+        } catch (const std::exception& e) {
+            DLOG("AnalyticLinearSensitivities: skip index curve " << name << ": " << e.what());
+        }
+    }
+
+    for (auto const& key : baseScenario->keys()) {
+        if (key.keytype == RiskFactorKey::KeyType::FXSpot)
+            fxKeys_[key] = baseScenario->get(key);
+    }
+}
+
+bool AnalyticLinearSensitivities::add(const QuantLib::ext::shared_ptr<Trade>& trade) {
+    // the trade must be a vanilla single currency swap
+
+    auto wrapper = QuantLib::ext::dynamic_pointer_cast<VanillaInstrument>(trade->instrument());
+    if (wrapper == nullptr || !wrapper->additionalInstruments().empty() ||
+        QuantLib::ext::dynamic_pointer_cast<QuantLib::Swap>(wrapper->qlInstrument()) == nullptr ||
+        trade->legs().empty() || trade->legs().size() != trade->legPayers().size())
+        return false;
+
+    const std::string& ccy = trade->npvCurrency();
+    for (auto const& c : trade->legCurrencies()) {
+        if (c != ccy)
+            return false;
+    }
+
+    // check the cashflow types, the Ibor coupons must all be projected on the same curve
+
+    Date asof = simMarket_->asofDate();
+    const YieldTermStructure* forwardCurve = nullptr;
+    Date lastDate = asof;
+    for (auto const& leg : trade->legs()) {
+        for (auto const& cf : leg) {
+            if (cf->date() <= asof)
+                continue;
+            lastDate = std::max(lastDate, cf->date());
+            const CashFlow& flow = *cf;
+            if (typeid(flow) == typeid(IborCoupon)) {
+                auto c = QuantLib::ext::static_pointer_cast<IborCoupon>(cf);
+                if (c->isInArrears())
+                    return false;
+                auto f = c->iborIndex()->forwardingTermStructure().currentLink().get();
+                if (forwardCurve != nullptr && f != forwardCurve)
+                    return false;
+                forwardCurve = f;
+                lastDate = std::max({lastDate, c->accrualEndDate(),
+                                     c->iborIndex()->maturityDate(c->iborIndex()->valueDate(c->fixingDate()))});
+            } else if (QuantLib::ext::dynamic_pointer_cast<FixedRateCoupon>(cf) == nullptr &&
+                       QuantLib::ext::dynamic_pointer_cast<SimpleCashFlow>(cf) == nullptr) {
+                return false;
+            }
+        }
+    }
+
+    // the curves must be sim market curves on the same pillars
+
+    Handle<YieldTermStructure> discountCurve = simMarket_->discountCurve(ccy, marketConfiguration_);
+    auto dsc = curves_.find(discountCurve.currentLink().get());
+    if (dsc == curves_.end())
+        return false;
+    auto fwd = curves_.end();
+    if (forwardCurve != nullptr) {
+        fwd = curves_.find(forwardCurve);
+        if (fwd == curves_.end() || fwd->second.times != dsc->second.times)
+            return false;
+    }
+    if (!flatZero_ && lastDate > dsc->second.lastDate)
+        return false;
+
+    // the conversion to base ccy
+
+    TradeData data;
+    data.id = trade->id();
+    data.fxInverted = false;
+    data.fxRate = 1.0;
+    if (ccy != baseCcy_) {
+        data.fxRate = t0Market_ ? t0Market_->fxRate(ccy + baseCcy_)->value()
+                                : simMarket_->fxRate(ccy + baseCcy_, marketConfiguration_)->value();
+        if (!t0Market_) {
+            RiskFactorKey direct(RiskFactorKey::KeyType::FXSpot, ccy + baseCcy_);
+            RiskFactorKey inverse(RiskFactorKey::KeyType::FXSpot, baseCcy_ + ccy);
+            if (fxKeys_.find(direct) != fxKeys_.end()) {
+                data.fxKey = direct;
+            } else if (fxKeys_.find(inverse) != fxKeys_.end()) {
+                data.fxKey = inverse;
+                data.fxInverted = true;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    // compute the analytic npv, deltas and gammas on a copy of the swap
+
+    const Curve& dscCurve = dsc->second;
+    QuantLib::Swap swap(trade->legs(), trade->legPayers());
+    swap.setPricingEngine(QuantLib::ext::make_shared<QuantExt::DiscountingSwapEngineDeltaGamma>(
+        discountCurve, dscCurve.times, true, true, false, linearInZero_));
+    Real npv, tradeNpv, legNpvs = 0.0;
+    std::vector<Real> deltaDiscount, deltaForward;
+    Matrix gamma;
+    try {
+        npv = swap.NPV();
+        deltaDiscount = swap.result<std::vector<Real>>("deltaDiscount");
+        deltaForward = swap.result<std::vector<Real>>("deltaForward");
+        gamma = swap.result<Matrix>("gamma");
+        for (Size i = 0; i < trade->legs().size(); ++i)
+            legNpvs += std::abs(swap.legNPV(i));
+        tradeNpv = wrapper->NPV();
+    } catch (const std::exception& e) {
+        DLOG("AnalyticLinearSensitivities: trade " << trade->id() << " is repriced under the scenarios, analytic "
+                                                   << "deltas and gammas failed: " << e.what());
+        return false;
+    }
+
+    Real multiplier = wrapper->multiplier();
+    if (std::abs(multiplier * npv - tradeNpv) > 1E-10 * std::max(1.0, std::abs(multiplier) * legNpvs)) {
+        DLOG("AnalyticLinearSensitivities: trade " << trade->id() << " is repriced under the scenarios, analytic npv "
+                                                   << multiplier * npv << " does not match trade npv " << tradeNpv);
+        return false;
+    }
+
+    Size n = dscCurve.times.size();
+    Size m = fwd == curves_.end() ? n : 2 * n;
+    data.keys = dscCurve.keys;
+    data.delta.assign(deltaDiscount.begin(), deltaDiscount.end());
+    if (fwd != curves_.end()) {
+        data.keys.insert(data.keys.end(), fwd->second.keys.begin(), fwd->second.keys.end());
+        data.delta.insert(data.delta.end(), deltaForward.begin(), deltaForward.end());
+    }
+    data.gamma = Matrix(m, m);
+    for (Size i = 0; i < m; ++i) {
+        data.delta[i] *= multiplier;
+        for (Size j = 0; j < m; ++j)
+            data.gamma[i][j] = multiplier * gamma[i][j];
+    }
+    data.npv = tradeNpv;
+
+    trades_.push_back(data);
+    tradeIds_.insert(data.id);
+    return true;
+}
+
+void AnalyticLinearSensitivities::buildCube(const QuantLib::ext::shared_ptr<ShiftScenarioGenerator>& scenarioGenerator,
+                                            const QuantLib::ext::shared_ptr<NPVSensiCube>& cube) const {
+    QL_REQUIRE(cube->samples() == scenarioGenerator->samples(),
+               "AnalyticLinearSensitivities::buildCube(): cube samples ("
+                   << cube->samples() << ") do not match the number of scenarios (" << scenarioGenerator->samples()
+                   << ")");
+
+    std::vector<Size> cubeIndex(trades_.size());
+    for (Size i = 0; i < trades_.size(); ++i) {
+        auto c = cube->idsAndIndexes().find(trades_[i].id);
+        QL_REQUIRE(c != cube->idsAndIndexes().end(),
+                   "AnalyticLinearSensitivities::buildCube(): trade " << trades_[i].id << " not in cube");
+        cubeIndex[i] = c->second;
+        cube->setT0(trades_[i].fxRate * trades_[i].npv, cubeIndex[i]);
+    }
+
+    // zero rate changes at the curve pillars resp. fx spot ratios of a scenario, keys without change are skipped
+
+    std::map<RiskFactorKey, Real> changes;
+    std::vector<Real> x;
+    std::vector<Size> nonZero;
+    for (Size k = 0; k < scenarioGenerator->samples(); ++k) {
+        const auto& scenario = scenarioGenerator->scenarios()[k];
+        auto ds = QuantLib::ext::dynamic_pointer_cast<DeltaScenario>(scenario);
+        const auto& keys = ds ? ds->delta()->keys() : scenario->keys();
+        changes.clear();
+        for (auto const& key : keys) {
+            if (auto c = curveKeys_.find(key); c != curveKeys_.end()) {
+                Real v = scenario->get(key);
+                Real ratio = scenario->isAbsolute() ? v / c->second.second : v;
+                if (ratio != 1.0)
+                    changes[key] = -std::log(ratio) / c->second.first;
+            } else if (auto f = fxKeys_.find(key); f != fxKeys_.end()) {
+                Real v = scenario->get(key);
+                Real ratio = scenario->isAbsolute() ? v / f->second : v;
+                if (ratio != 1.0)
+                    changes[key] = ratio;
+            }
+        }
+        if (changes.empty())
+            continue;
+
+        for (Size i = 0; i < trades_.size(); ++i) {
+            const TradeData& t = trades_[i];
+            Real fx = t.fxRate;
+            bool changed = false;
+            if (t.fxKey.keytype != RiskFactorKey::KeyType::None) {
+                if (auto f = changes.find(t.fxKey); f != changes.end()) {
+                    fx *= t.fxInverted ? 1.0 / f->second : f->second;
+                    changed = true;
+                }
+            }
+            x.assign(t.keys.size(), 0.0);
+            nonZero.clear();
+            for (Size j = 0; j < t.keys.size(); ++j) {
+                if (auto c = changes.find(t.keys[j]); c != changes.end()) {
+                    x[j] = c->second;
+                    nonZero.push_back(j);
+                }
+            }
+            if (!changed && nonZero.empty())
+                continue;
+            Real npv = t.npv;
+            for (auto j : nonZero) {
+                npv += t.delta[j] * x[j];
+                for (auto l : nonZero)
+                    npv += 0.5 * t.gamma[j][l] * x[j] * x[l];
+            }
+            cube->set(fx * npv, cubeIndex[i], 0, k);
+        }
+    }
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,118 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/analyticlinearsensitivities.hpp
+    \brief sensitivity cube entries for linear trades from analytic zero rate deltas and gammas
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <orea/cube/npvsensicube.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/shiftscenariogenerator.hpp>
+
+#include <ored/marketdata/market.hpp>
+#include <ored/portfolio/trade.hpp>
+
+#include <ql/math/matrix.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Sensitivity cube entries for linear trades from analytic zero rate deltas and gammas
+/*! Single currency swaps consisting of fixed rate coupons, simple cashflows and vanilla (not in arrears) Ibor coupons
+    on one index are priced once with QuantExt::DiscountingSwapEngineDeltaGamma on the sim market, using the pillars
+    of the sim market curves as bucket times. The NPV under a sensitivity scenario is then given by the second order
+    expansion in the zero rate changes of the scenario at the pillars of the discount and forwarding curve, converted
+    to the base currency with the scenario fx rate, so that these trades do not need to be repriced under each
+    scenario. For linear trades and the usual shift sizes the difference to a full revaluation is of third order in
+    the shift size.
+
+    A trade is only accepted if
+    - its analytic NPV matches the NPV from its own pricing engine on the sim market, i.e. the configured engine
+      discounts on the sim market discount curve of the trade currency
+    - the discount and forwarding curves are sim market curves with identical pillar times
+    - its npv currency is the base currency or there is an fx spot risk factor against the base currency
+
+    The rebucketing of the engine's deltas and gammas assumes FlatZero extrapolation of the curves. If the sim market
+    uses a different extrapolation, only trades without cashflows or forward periods beyond the last curve pillar are
+    accepted.
+
+    \ingroup simulation
+*/
+class AnalyticLinearSensitivities {
+public:
+    /*! If t0Market is given, the NPVs are converted to base currency with its fx rates rather than with the scenario
+        fx rates, like NPVCalculatorFXT0 does. */
+    AnalyticLinearSensitivities(const QuantLib::ext::shared_ptr<ScenarioSimMarket>& simMarket,
+                                const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                                const std::string& marketConfiguration = ore::data::Market::defaultConfiguration,
+                                const QuantLib::ext::shared_ptr<ore::data::Market>& t0Market = nullptr);
+
+    /*! Computes the analytic deltas and gammas of a built trade and returns true, if the trade is eligible. The sim
+        market must be in its base state. */
+    bool add(const QuantLib::ext::shared_ptr<ore::data::Trade>& trade);
+
+    //! The ids of the accepted trades
+    const std::set<std::string>& tradeIds() const { return tradeIds_; }
+
+    //! Sets the T0 and scenario NPVs in base currency of the accepted trades in the given cube
+    void buildCube(const QuantLib::ext::shared_ptr<ShiftScenarioGenerator>& scenarioGenerator,
+                   const QuantLib::ext::shared_ptr<NPVSensiCube>& cube) const;
+
+private:
+    struct Curve {
+        std::vector<RiskFactorKey> keys;
+        std::vector<QuantLib::Time> times;
+        QuantLib::Date lastDate;
+    };
+    struct TradeData {
+        std::string id;
+        // pillar keys of the discount curve, followed by the pillar keys of the forwarding curve, if any
+        std::vector<RiskFactorKey> keys;
+        std::vector<QuantLib::Real> delta;
+        QuantLib::Matrix gamma;
+        QuantLib::Real npv;
+        // conversion to base ccy, the key is None if the fx rate is not shifted
+        RiskFactorKey fxKey;
+        bool fxInverted;
+        QuantLib::Real fxRate;
+    };
+
+    QuantLib::ext::shared_ptr<ScenarioSimMarket> simMarket_;
+    std::string marketConfiguration_;
+    QuantLib::ext::shared_ptr<ore::data::Market> t0Market_;
+    std::string baseCcy_;
+    bool flatZero_, linearInZero_;
+    std::map<const QuantLib::YieldTermStructure*, Curve> curves_;
+    // pillar time and absolute base value per curve key, absolute base value per fx key
+    std::map<RiskFactorKey, std::pair<QuantLib::Time, QuantLib::Real>> curveKeys_;
+    std::map<RiskFactorKey, QuantLib::Real> fxKeys_;
+    std::vector<TradeData> trades_;
+    std::set<std::string> tradeIds_;
+};
+
+} // namespace analytics
+} // namespace ore
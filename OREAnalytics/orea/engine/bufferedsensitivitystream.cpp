@@ -35,6 +35,26 @@ SensitivityRecord BufferedSensitivityStream::next() {
     return {};
 }
 
+QuantLib::Size BufferedSensitivityStream::nextBatch(std::vector<SensitivityRecord>& records,
+                                                   const QuantLib::Size maxSize) {
+    if (index_ == QuantLib::Null<Size>()) {
+        Size n = stream_->nextBatch(records, maxSize);
+        buffer_.insert(buffer_.end(), records.begin(), records.begin() + n);
+        return n;
+    }
+    // the buffer might end with the empty record marking the end of the stream, if it was filled by next()
+    Size end = buffer_.size();
+    if (end > 0 && !buffer_.back())
+        --end;
+    Size n = index_ < end ? std::min(maxSize, end - index_) : 0;
+    if (records.size() < n)
+        records.resize(n);
+    for (Size i = 0; i < n; ++i)
+        records[i] = buffer_[index_++];
+    records.resize(n);
+    return n;
+}
+
 void BufferedSensitivityStream::reset() {
     // if next() was never called, we do not switch to the buffered mode
     if (!buffer_.empty())
@@ -31,6 +31,7 @@ class BufferedSensitivityStream : public SensitivityStream {
 public:
     explicit BufferedSensitivityStream(const QuantLib::ext::shared_ptr<SensitivityStream>& stream);
     SensitivityRecord next() override;
+    QuantLib::Size nextBatch(std::vector<SensitivityRecord>& records, const QuantLib::Size maxSize = 1024) override;
     void reset() override;
 
 private:
@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/cubecostestimator.hpp>
+
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using QuantLib::Real;
+using QuantLib::Size;
+
+namespace ore {
+namespace analytics {
+
+CubeCostEstimator::CubeCostEstimator(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+                                     const Size tradesPerType)
+    : portfolio_(portfolio) {
+    QL_REQUIRE(portfolio_, "CubeCostEstimator: no portfolio given");
+    QL_REQUIRE(tradesPerType > 0, "CubeCostEstimator: tradesPerType must be positive");
+    std::map<std::string, std::vector<QuantLib::ext::shared_ptr<ore::data::Trade>>> byType;
+    for (auto const& [id, t] : portfolio_->trades())
+        byType[t->tradeType()].push_back(t);
+    samplePortfolio_ = QuantLib::ext::make_shared<ore::data::Portfolio>(portfolio_->buildFailedTrades());
+    for (auto const& [type, trades] : byType) {
+        Size n = trades.size(), k = std::min(n, tradesPerType);
+        for (Size i = 0; i < k; ++i)
+            samplePortfolio_->add(trades[(2 * i + 1) * n / (2 * k)]);
+    }
+    LOG("CubeCostEstimator: sampled " << samplePortfolio_->size() << " out of " << portfolio_->size() << " trades of "
+                                      << byType.size() << " trade types");
+}
+
+void CubeCostEstimator::estimate(CubeCostEstimate& e) const {
+    QL_REQUIRE(e.estimationSamples > 0, "CubeCostEstimator::estimate(): estimationSamples must be positive");
+    QL_REQUIRE(e.samples > 0, "CubeCostEstimator::estimate(): samples must be positive");
+
+    e.tradeTypes.clear();
+    for (auto const& [id, t] : portfolio_->trades())
+        ++e.tradeTypes[t->tradeType()].trades;
+
+    Real samplePricingTime = 0.0;
+    for (auto const& [id, t] : samplePortfolio_->trades()) {
+        auto& c = e.tradeTypes[t->tradeType()];
+        ++c.sampledTrades;
+        Real time = static_cast<Real>(t->getCumulativePricingTime()) * 1E-9;
+        c.timePerTradeAndSample += time;
+        samplePricingTime += time;
+    }
+
+    e.trades = portfolio_->size();
+    Real pricingTime = 0.0;
+    for (auto& [type, c] : e.tradeTypes) {
+        if (c.sampledTrades > 0)
+            c.timePerTradeAndSample /= static_cast<Real>(c.sampledTrades * e.estimationSamples);
+        c.pricingTime = c.timePerTradeAndSample * static_cast<Real>(c.trades * e.samples);
+        pricingTime += c.pricingTime;
+    }
+
+    e.overheadPerSample =
+        std::max(0.0, e.estimationTime - samplePricingTime) / static_cast<Real>(e.estimationSamples);
+    e.cpuTime = pricingTime + e.overheadPerSample * static_cast<Real>(e.samples);
+    auto wallTime = [&e](const Size threads) {
+        return e.setupTime + e.cpuTime / static_cast<Real>(std::max<Size>(1, std::min(threads, e.samples)));
+    };
+    e.wallTime = wallTime(e.threads);
+
+    e.cubeBytes = e.trades * (e.dates * e.samples + 1) * e.depth * e.cellBytes;
+    e.scenarioDataBytes = e.estimationScenarioDataBytes * e.samples / e.estimationSamples;
+
+    e.suggestedThreads = e.suggestedSampleChunks = 0;
+    if (e.timeBudget > 0.0) {
+        Size maxThreads = std::max<Size>(1, e.maxThreads);
+        for (Size t = 1; t <= maxThreads && e.suggestedThreads == 0; ++t) {
+            if (wallTime(t) <= e.timeBudget) {
+                e.suggestedThreads = t;
+                e.suggestedSampleChunks = 1;
+            }
+        }
+        if (e.suggestedThreads == 0) {
+            e.suggestedThreads = maxThreads;
+            Real available = e.timeBudget - e.setupTime;
+            e.suggestedSampleChunks =
+                available > 0.0 ? static_cast<Size>(std::ceil(e.cpuTime / (static_cast<Real>(maxThreads) * available)))
+                                : e.samples;
+            e.suggestedSampleChunks = std::min(std::max<Size>(e.suggestedSampleChunks, 1), e.samples);
+        }
+    }
+
+    LOG("CubeCostEstimator: estimated cpu time " << e.cpuTime << "s, wall time " << e.wallTime << "s on " << e.threads
+                                                 << " threads, cube " << e.cubeBytes << " bytes, scenario data "
+                                                 << e.scenarioDataBytes << " bytes");
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/cubecostestimator.hpp
+    \brief estimate of the runtime and memory of a cube generation from a run on a sample
+    \ingroup engine
+*/
+
+#pragma once
+
+#include <ored/portfolio/portfolio.hpp>
+
+#include <ql/types.hpp>
+
+#include <map>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Runtime and memory estimate of a classic cube generation
+struct CubeCostEstimate {
+    //! the configured run, set by the caller
+    QuantLib::Size dates = 0, samples = 0, depth = 1, threads = 1;
+    //! bytes per cube cell
+    QuantLib::Size cellBytes = sizeof(float);
+    //! maximum number of threads to be suggested and time budget in seconds (0 = no suggestion)
+    QuantLib::Size maxThreads = 1;
+    QuantLib::Real timeBudget = 0.0;
+
+    //! the estimation run on the sample portfolio, set by the caller
+    QuantLib::Size estimationSamples = 0;
+    //! wall time of the single threaded estimation run and the setup time of one thread in seconds
+    QuantLib::Real estimationTime = 0.0, setupTime = 0.0;
+    //! scenario data held after the estimation run
+    QuantLib::Size estimationScenarioDataBytes = 0;
+
+    //! results per trade type
+    struct TradeTypeCost {
+        QuantLib::Size trades = 0, sampledTrades = 0;
+        //! average pricing time per trade and sample and extrapolated single threaded pricing time, in seconds
+        QuantLib::Real timePerTradeAndSample = 0.0, pricingTime = 0.0;
+    };
+    std::map<std::string, TradeTypeCost> tradeTypes;
+
+    //! results in seconds resp. bytes
+    QuantLib::Size trades = 0;
+    //! time per sample not spent in trade pricing (scenario generation, simulation market update, calculators)
+    QuantLib::Real overheadPerSample = 0.0;
+    //! single threaded time and wall time on the configured number of threads
+    QuantLib::Real cpuTime = 0.0, wallTime = 0.0;
+    QuantLib::Size cubeBytes = 0, scenarioDataBytes = 0;
+    /*! smallest number of threads <= maxThreads meeting the time budget, if no number of threads does, maxThreads
+        and the number of chunks the samples must be split into so that each chunk meets the budget */
+    QuantLib::Size suggestedThreads = 0, suggestedSampleChunks = 0;
+};
+
+//! Estimates the cost of a cube generation by a run on a stratified sample of the portfolio
+/*! The sample portfolio contains up to tradesPerType trades of each trade type, chosen evenly spaced in the order of
+    the trade ids. After a single threaded cube generation for the sample portfolio over a few samples, estimate()
+    extrapolates the unit cost per trade type, i.e. the pricing time per trade and sample, to all trades and samples.
+    The multi threaded time assumes that the samples are split evenly over the threads, each of which pays the setup
+    cost. The pricing stats of the trades of the sample portfolio must be reset before the estimation run.
+
+    \ingroup engine
+*/
+class CubeCostEstimator {
+public:
+    CubeCostEstimator(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+                      const QuantLib::Size tradesPerType = 5);
+
+    //! the trades to be priced in the estimation run, a subset of the trades of the portfolio
+    const QuantLib::ext::shared_ptr<ore::data::Portfolio>& samplePortfolio() const { return samplePortfolio_; }
+
+    //! fill the results of the given estimate, the run and the estimation run must be set
+    void estimate(CubeCostEstimate& e) const;
+
+private:
+    QuantLib::ext::shared_ptr<ore::data::Portfolio> portfolio_, samplePortfolio_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -56,6 +56,13 @@ SensitivityRecord DecomposedSensitivityStream::next() {
     return *(itCurrent_++);
 }
 
+QuantLib::Size DecomposedSensitivityStream::nextBatch(std::vector<SensitivityRecord>& records,
+                                                      const QuantLib::Size maxSize) {
+    if (!decompose_)
+        return ss_->nextBatch(records, maxSize);
+    return SensitivityStream::nextBatch(records, maxSize);
+}
+
 std::vector<SensitivityRecord> DecomposedSensitivityStream::decompose(const SensitivityRecord& record) const {
     std::vector<SensitivityRecord> results;
 
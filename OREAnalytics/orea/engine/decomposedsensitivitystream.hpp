@@ -50,6 +50,8 @@ public:
         const QuantLib::ext::shared_ptr<ore::data::Market>& todaysMarket = nullptr);
     //! Returns the next SensitivityRecord in the stream after filtering
     SensitivityRecord next() override;
+    //! Returns the next batch of SensitivityRecords, passed through from the underlying stream if nothing is decomposed
+    QuantLib::Size nextBatch(std::vector<SensitivityRecord>& records, const QuantLib::Size maxSize = 1024) override;
     //! Resets the stream so that SensitivityRecord objects can be streamed again
     void reset() override;
 
@@ -47,8 +47,7 @@ SensitivityRecord FilteredSensitivityStream::next() {
     // Return the next sensitivity record in the underlying stream that satisfies
     // the threshold conditions
     while (SensitivityRecord sr = ss_->next()) {
-        if (fabs(sr.delta) > deltaThreshold_ || fabs(sr.gamma) > gammaThreshold_ ||
-            (!sr.isCrossGamma() && deltaKeys_.find(sr.key_1) != deltaKeys_.end())) {
+        if (keep(sr)) {
             return sr;
         }
     }
@@ -57,6 +56,33 @@ SensitivityRecord FilteredSensitivityStream::next() {
     return SensitivityRecord();
 }
 
+QuantLib::Size FilteredSensitivityStream::nextBatch(std::vector<SensitivityRecord>& records,
+                                                    const QuantLib::Size maxSize) {
+    // Pull batches from the underlying stream until at least one record satisfies the threshold conditions, the
+    // records to keep are swapped to the front of the batch
+    while (QuantLib::Size n = ss_->nextBatch(records, maxSize)) {
+        QuantLib::Size m = 0;
+        for (QuantLib::Size i = 0; i < n; ++i) {
+            if (keep(records[i])) {
+                if (m != i)
+                    std::swap(records[m], records[i]);
+                ++m;
+            }
+        }
+        if (m > 0) {
+            records.resize(m);
+            return m;
+        }
+    }
+    records.clear();
+    return 0;
+}
+
+bool FilteredSensitivityStream::keep(const SensitivityRecord& sr) const {
+    return fabs(sr.delta) > deltaThreshold_ || fabs(sr.gamma) > gammaThreshold_ ||
+           (!sr.isCrossGamma() && deltaKeys_.find(sr.key_1) != deltaKeys_.end());
+}
+
 void FilteredSensitivityStream::reset() {
     // Reset the underlying stream
     ss_->reset();
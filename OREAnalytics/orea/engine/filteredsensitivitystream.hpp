@@ -44,10 +44,14 @@ public:
     FilteredSensitivityStream(const QuantLib::ext::shared_ptr<SensitivityStream>& ss, QuantLib::Real threshold);
     //! Returns the next SensitivityRecord in the stream after filtering
     SensitivityRecord next() override;
+    //! Returns the next batch of SensitivityRecords in the stream after filtering, filtered in place
+    QuantLib::Size nextBatch(std::vector<SensitivityRecord>& records, const QuantLib::Size maxSize = 1024) override;
     //! Resets the stream so that SensitivityRecord objects can be streamed again
     void reset() override;
 
 private:
+    //! True if the record satisfies the threshold conditions
+    bool keep(const SensitivityRecord& sr) const;
     //! The underlying sensitivity stream that has been wrapped
     QuantLib::ext::shared_ptr<SensitivityStream> ss_;
     //! The delta threshold
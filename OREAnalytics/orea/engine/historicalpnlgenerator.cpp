@@ -93,6 +93,13 @@ HistoricalPnlGenerator::HistoricalPnlGenerator(
           return {QuantLib::ext::make_shared<NPVCalculator>(baseCurrency)};
       }) {}
 
+void HistoricalPnlGenerator::setWorkStealing(const Size tradeBlockSize, const Size sampleBlockSize) {
+    QL_REQUIRE(!useSingleThreadedEngine_ || tradeBlockSize == 0,
+               "HistoricalPnlGenerator::setWorkStealing(): requires the multi-threaded ctor");
+    tradeBlockSize_ = tradeBlockSize;
+    sampleBlockSize_ = sampleBlockSize;
+}
+
 void HistoricalPnlGenerator::generateCube(const QuantLib::ext::shared_ptr<ScenarioFilter>& filter) {
 
     DLOG("Filling historical P&L cube for " << portfolio_->size() << " trades and " << hisScenGen_->numScenarios()
@@ -118,6 +125,8 @@ void HistoricalPnlGenerator::generateCube(const QuantLib::ext::shared_ptr<Scenar
             nThreads_, today_, QuantLib::ext::make_shared<ore::analytics::DateGrid>(), hisScenGen_->numScenarios(), loader_,
             hisScenGen_, engineData_, curveConfigs_, todaysMarketParams_, configuration_, simMarketData_, false, false,
             filter, referenceData_, iborFallbackConfig_, true, true, true, {}, {}, {}, context_);
+        if (tradeBlockSize_ > 0)
+            engine.setWorkStealing(tradeBlockSize_, sampleBlockSize_);
         for (auto const& i : this->progressIndicators()) {
             i->reset();
             engine.registerProgressIndicator(i);
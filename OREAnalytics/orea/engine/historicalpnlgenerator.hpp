@@ -80,6 +80,14 @@ public:
                            const IborFallbackConfig& iborFallbackConfig = IborFallbackConfig::defaultConfig(),
                            bool dryRun = false, const std::string& context = "historical pnl generation");
 
+    /*! Only relevant for the multi-threaded ctor: split the portfolio into blocks of \p tradeBlockSize trades and
+        the historical scenarios into ranges of \p sampleBlockSize scenarios (0 = all scenarios) and distribute the
+        resulting units dynamically over the threads, see MultiThreadedValuationEngine::setWorkStealing(). The
+        generated P&Ls do not depend on this setting. A trade block size of 0 restores the static split of the
+        portfolio into nThreads parts.
+    */
+    void setWorkStealing(const QuantLib::Size tradeBlockSize, const QuantLib::Size sampleBlockSize = 0);
+
     /*! Generate a "cube" of P&L values for the trades in the portfolio on each of
         the scenarios provided by the historical scenario generator. The historical
         scenarios will have the given \p filter applied.
@@ -158,6 +166,8 @@ private:
     // additional parameters needed for multi-threaded ctor
     QuantLib::ext::shared_ptr<ore::data::EngineData> engineData_;
     Size nThreads_;
+    Size tradeBlockSize_ = 0;
+    Size sampleBlockSize_ = 0;
     Date today_;
     QuantLib::ext::shared_ptr<ore::data::Loader> loader_;
     QuantLib::ext::shared_ptr<ore::data::CurveConfigurations> curveConfigs_;
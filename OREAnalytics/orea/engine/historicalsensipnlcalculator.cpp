@@ -83,47 +83,81 @@ namespace ore {
 namespace analytics {
 
 void CovarianceCalculator::initialise(const set<pair<RiskFactorKey, Size>>& keys) {
-    // Set up the boost accumulators that will calculate the covariance between the time series of historical shifts for
-    // each relevant risk factor key i.e. the risk factor keys in the set keys over the benchmark period
-    
-    for (auto ito = keys.begin(); ito != keys.end(); ito++) {
-        accCov_[make_pair(ito->second, ito->second)] = accumulator();
-        for (auto iti = keys.begin(); iti != ito; iti++) {
-            accCov_[make_pair(iti->second, ito->second)] = accumulator();
-        }
-    }
+    // Set up the statistics of the time series of historical shifts for each relevant risk factor key i.e. the risk
+    // factor keys in the set keys over the benchmark period
+    cubeIndex_.clear();
+    for (const auto& k : keys)
+        cubeIndex_.push_back(k.second);
+    n_ = 0;
+    mean_ = Array(keys.size(), 0.0);
+    comoment_ = Matrix(keys.size(), keys.size(), 0.0);
+    shifts_.resize(keys.size());
+    diff_.resize(keys.size());
 }
 
 void CovarianceCalculator::updateAccumulators(const ext::shared_ptr<NPVCube>& shiftCube, Date startDate, Date endDate, Size index) {
     TLOG("Updating Covariance accumlators for sensitivity record " << index);
     if (covariancePeriod_.contains(startDate) &&
         covariancePeriod_.contains(endDate)) {
-        // Update the covariance accumulators if in benchmark period
-        for (auto it = accCov_.begin(); it != accCov_.end(); it++) {
-            Real oShift = shiftCube->get(it->first.first, 0, index);
-            if (it->first.first == it->first.second) {
-                it->second(oShift, covariate1 = oShift);
-            } else {
-                Real iShift = shiftCube->get(it->first.second, 0, index);
-                it->second(oShift, covariate1 = iShift);
-            }
-        }
+        // Update the covariance statistics if in benchmark period
+        for (Size i = 0; i < cubeIndex_.size(); i++)
+            shifts_[i] = shiftCube->get(cubeIndex_[i], 0, index);
+        addShifts(shifts_);
+    }
+}
+
+void CovarianceCalculator::addShifts(const vector<Real>& shifts) {
+    QL_REQUIRE(shifts.size() == mean_.size(), "CovarianceCalculator::addShifts(): got " << shifts.size()
+                                                  << " shifts, expected " << mean_.size());
+    // Welford update of the mean and the co-moment, only the lower triangle of the co-moment is updated
+    ++n_;
+    Size m = mean_.size();
+    Real w = static_cast<Real>(n_ - 1) / static_cast<Real>(n_);
+    for (Size i = 0; i < m; i++)
+        diff_[i] = shifts[i] - mean_[i];
+    for (Size i = 0; i < m; i++) {
+        mean_[i] += diff_[i] / static_cast<Real>(n_);
+        Real wd = w * diff_[i];
+        for (Size j = 0; j <= i; j++)
+            comoment_[i][j] += wd * diff_[j];
+    }
+}
+
+void CovarianceCalculator::removeShifts(const vector<Real>& shifts) {
+    QL_REQUIRE(shifts.size() == mean_.size(), "CovarianceCalculator::removeShifts(): got " << shifts.size()
+                                                  << " shifts, expected " << mean_.size());
+    QL_REQUIRE(n_ > 0, "CovarianceCalculator::removeShifts(): no scenarios to remove");
+    Size m = mean_.size();
+    if (n_ == 1) {
+        n_ = 0;
+        std::fill(mean_.begin(), mean_.end(), 0.0);
+        std::fill(comoment_.begin(), comoment_.end(), 0.0);
+        return;
     }
+    // inverse of the update in addShifts(), with d = x - mean(n): mean(n-1) = mean(n) - d / (n-1) and
+    // comoment(n-1) = comoment(n) - n / (n-1) * d * d^T
+    Real w = static_cast<Real>(n_) / static_cast<Real>(n_ - 1);
+    for (Size i = 0; i < m; i++)
+        diff_[i] = shifts[i] - mean_[i];
+    for (Size i = 0; i < m; i++) {
+        mean_[i] -= diff_[i] / static_cast<Real>(n_ - 1);
+        Real wd = w * diff_[i];
+        for (Size j = 0; j <= i; j++)
+            comoment_[i][j] -= wd * diff_[j];
+    }
+    --n_;
 }
 
 void CovarianceCalculator::populateCovariance(const std::set<std::pair<RiskFactorKey, QuantLib::Size>>& keys) {
     LOG("Populate the covariance matrix with the calculated covariances");
-    covariance_ = Matrix(keys.size(), keys.size());
-    Size i = 0;
-    for (auto ito = keys.begin(); ito != keys.end(); ito++) {
-        covariance_[i][i] = boost::accumulators::covariance(accCov_.at(make_pair(ito->second, ito->second)));
-        Size j = 0;
-        for (auto iti = keys.begin(); iti != ito; iti++) {
-            covariance_[i][j] = covariance_[j][i] =
-                boost::accumulators::covariance(accCov_.at(make_pair(iti->second, ito->second)));
-            j++;
-        }
-        i++;
+    QL_REQUIRE(keys.size() == mean_.size(), "CovarianceCalculator::populateCovariance(): got "
+                                                << keys.size() << " keys, expected " << mean_.size());
+    covariance_ = Matrix(keys.size(), keys.size(), 0.0);
+    if (n_ == 0)
+        return;
+    for (Size i = 0; i < keys.size(); i++) {
+        for (Size j = 0; j <= i; j++)
+            covariance_[i][j] = covariance_[j][i] = comoment_[i][j] / static_cast<Real>(n_);
     }
 }
 
@@ -157,7 +191,7 @@ void PNLCalculator::populateTradePNLs(const TradePnLStore& allPnls, const TradeP
 }
 
 void HistoricalSensiPnlCalculator::populateSensiShifts(QuantLib::ext::shared_ptr<NPVCube>& cube, const vector<RiskFactorKey>& keys,
-    ext::shared_ptr<ScenarioShiftCalculator> shiftCalculator) {
+    ext::shared_ptr<ScenarioShiftCalculator> shiftCalculator, const Size nThreads) {
 
     hisScenGen_->reset();
     QuantLib::ext::shared_ptr<Scenario> baseScenario = hisScenGen_->baseScenario();
@@ -172,24 +206,34 @@ void HistoricalSensiPnlCalculator::populateSensiShifts(QuantLib::ext::shared_ptr
     cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(
         baseScenario->asof(), keyNames, vector<Date>(1, baseScenario->asof()), hisScenGen_->numScenarios());
 
+    vector<RiskFactorKey> cubeKeys;
+    for (const auto& [_, key] : keyNameMapping)
+        cubeKeys.push_back(key);
+
     // Loop over each historical scenario which represents the market move from t_i to
-    // t_i + mpor applied to the base scenario for all i in historical period of scenario generator
-    for (Size i = 0; i < hisScenGen_->numScenarios(); i++) {
-        QuantLib::ext::shared_ptr<Scenario> scenario = hisScenGen_->next(baseScenario->asof());
-
-        Size j = 0;
-        for (const auto& [_, key] : keyNameMapping) {
-            try {
-                Real shift = shiftCalculator->shift(key, *baseScenario, *scenario);
-                cube->set(shift, j, 0, i);
-            } catch (const std::exception& e) {
-                StructuredAnalyticsErrorMessage(
-                    "HistocialSensiPnlCalculator",
-                    "Shift calcuation failed. Check consistency of simulation and sensi config.",
-                    "Error retrieving sensi key '" + ore::data::to_string(key) + "' from ssm scenario: '" + e.what())
-                    .log();
+    // t_i + mpor applied to the base scenario for all i in historical period of scenario generator.
+    // The scenarios are generated in blocks, the shifts within a block are computed in parallel.
+    Size blockSize = std::max<Size>(1, 16 * nThreads);
+    for (Size i = 0; i < hisScenGen_->numScenarios(); i += blockSize) {
+        vector<QuantLib::ext::shared_ptr<Scenario>> scenarios;
+        for (Size k = i; k < std::min(i + blockSize, hisScenGen_->numScenarios()); ++k)
+            scenarios.push_back(hisScenGen_->next(baseScenario->asof()));
+
+        auto shifts = shiftCalculator->shifts(cubeKeys, *baseScenario, scenarios, nThreads);
+
+        for (Size k = 0; k < scenarios.size(); ++k) {
+            for (Size j = 0; j < cubeKeys.size(); ++j) {
+                if (shifts[k][j] != Null<Real>()) {
+                    cube->set(shifts[k][j], j, 0, i + k);
+                } else {
+                    StructuredAnalyticsErrorMessage(
+                        "HistocialSensiPnlCalculator",
+                        "Shift calcuation failed. Check consistency of simulation and sensi config.",
+                        "Error retrieving sensi key '" + ore::data::to_string(cubeKeys[j]) + "' from ssm scenario '" +
+                            scenarios[k]->label() + "'")
+                        .log();
+                }
             }
-            j++;
         }
     }
 }
@@ -235,6 +279,13 @@ void HistoricalSensiPnlCalculator::calculateSensiPnl(
     // we require a sensitivity stream to run at trade level
     bool runTradeLevel = tradeLevel && sensitivityStream_;
 
+    // the calculators for which writePNL() is called per sensitivity record and scenario
+    vector<Size> writingCalculators;
+    for (Size k = 0; k < pnlCalculators.size(); k++) {
+        if (pnlCalculators[k]->writesPNL())
+            writingCalculators.push_back(k);
+    }
+
     // Local P&L vectors to hold _all_ historical P&Ls
     Size nScenarios = hisScenGen_->numScenarios();
     Size nCalculators = pnlCalculators.size();
@@ -269,108 +320,152 @@ void HistoricalSensiPnlCalculator::calculateSensiPnl(
         cacheTradeSensitivities(tradeSensiCache, *sensitivityStream_, srs, tradeIds);
     }
 
-    // Loop over each historical scenario
-    for (Size i = 0; i < hisScenGen_->numScenarios(); i++) {
-
-        // Add trade level P&L vector if needed.
-        if (runTradeLevel) {
-            for (Size j = 0; j < pnlCalculators.size(); j++) {
-                bool inPeriod =
-                    pnlCalculators.at(j)->isInTimePeriod(hisScenGen_->startDates()[i], hisScenGen_->endDates()[i]);
-                if (inPeriod) {
-                    tradePnls.at(j).push_back(vector<Real>(tradeIds.size(), 0.0));
-                    foTradePnls.at(j).push_back(vector<Real>(tradeIds.size(), 0.0));
+    /* Compile the sensitivity records into dense arrays once. The shifts of the keys referenced by the records are
+       copied block wise from the shift cube into a buffer with one row per key and one column per scenario in the
+       block, row[j] (row2[j] for cross gammas) is the buffer row of the record's key. The trade level sensitivities
+       of record j are stored at positions tradeOffset[j], ..., tradeOffset[j + 1] - 1 of the trade arrays. */
+    Size nRecords = srs.size();
+    vector<Size> cubeIndex, bufferRow(shiftCube->numIds(), Null<Size>());
+    auto getBufferRow = [&cubeIndex, &bufferRow](const Size idx) {
+        if (bufferRow[idx] == Null<Size>()) {
+            bufferRow[idx] = cubeIndex.size();
+            cubeIndex.push_back(idx);
+        }
+        return bufferRow[idx];
+    };
+    vector<Size> row(nRecords), row2(nRecords, Null<Size>());
+    vector<Real> delta(nRecords), gamma(nRecords);
+    vector<Size> tradeOffset(nRecords + 1, 0), tradeIndex;
+    vector<Real> tradeDelta, tradeGamma;
+    for (const auto elem : srs | boost::adaptors::indexed(0)) {
+        const auto& sr = elem.value();
+        auto j = elem.index();
+        row[j] = getBufferRow(srsIndex[j].first);
+        if (sr.isCrossGamma())
+            row2[j] = getBufferRow(srsIndex[j].second);
+        delta[j] = sr.delta;
+        gamma[j] = sr.gamma;
+        if (auto itSr = tradeSensiCache.find(j); itSr != tradeSensiCache.end()) {
+            for (const auto& [t, sensis] : itSr->second) {
+                tradeIndex.push_back(t);
+                tradeDelta.push_back(sensis.first);
+                tradeGamma.push_back(sensis.second);
+            }
+        }
+        tradeOffset[j + 1] = tradeIndex.size();
+    }
+    bool haveTradeSensis = !tradeIndex.empty();
+
+    constexpr Size scenarioBlockSize = 256;
+    vector<Real> shifts(cubeIndex.size() * scenarioBlockSize);
+    vector<Real> tradePnl(tradeIds.size()), tradeFoPnl(tradeIds.size());
+
+    for (Size b = 0; b < nScenarios; b += scenarioBlockSize) {
+
+        Size blockSize = std::min(scenarioBlockSize, nScenarios - b);
+        for (Size r = 0; r < cubeIndex.size(); r++)
+            for (Size s = 0; s < blockSize; s++)
+                shifts[r * scenarioBlockSize + s] = shiftCube->get(cubeIndex[r], 0, b + s);
+
+        // Portfolio level P&Ls of the block, the contributions are added in the order of the records
+        Real* pnl = &allPnls[b];
+        Real* foPnl = &allFoPnls[b];
+        for (Size j = 0; j < nRecords; j++) {
+            const Real* shift = &shifts[row[j] * scenarioBlockSize];
+            if (row2[j] == Null<Size>()) {
+                for (Size s = 0; s < blockSize; s++) {
+                    Real deltaPnl = shift[s] * delta[j];
+                    Real gammaPnl = 0.5 * shift[s] * shift[s] * gamma[j];
+                    // Update the first order P&L
+                    foPnl[s] += deltaPnl;
+                    // If backtesting curvature margin, we exclude deltas i.e. 1st order effects from the sensi P&L
+                    if (includeDeltaMargin)
+                        pnl[s] += deltaPnl;
+                    // If backtesting delta margin, we exclude gammas i.e. second order effects from the sensi P&L
+                    if (includeGammaMargin)
+                        pnl[s] += gammaPnl;
                 }
+            } else if (includeGammaMargin) {
+                const Real* shift_2 = &shifts[row2[j] * scenarioBlockSize];
+                for (Size s = 0; s < blockSize; s++)
+                    pnl[s] += shift[s] * shift_2[s] * gamma[j];
             }
         }
 
-        for (const auto elem : srs | boost::adaptors::indexed(0)) {
-
-            const auto& sr = elem.value();
-            auto j = elem.index();
-
-            if (!sr.isCrossGamma()) {
-
-                Real shift = shiftCube->get(srsIndex[j].first, 0, i);
-                Real deltaPnl = shift * sr.delta;
-                Real gammaPnl = 0.5 * shift * shift * sr.gamma;
-                // Update the first order P&L
-                allFoPnls[i] += deltaPnl;
-                // If backtesting curvature margin, we exclude deltas i.e. 1st order effects from the sensi P&L
-                if (includeDeltaMargin)
-                    allPnls[i] += deltaPnl;
-                // If backtesting delta margin, we exclude gammas i.e. second order effects from the sensi P&L
-                if (includeGammaMargin)
-                    allPnls[i] += gammaPnl;
-
-                for (Size k = 0; k < pnlCalculators.size(); k++) {
-                    if (pnlCalculators.at(k)->isInTimePeriod(hisScenGen_->startDates()[i],
-                                                             hisScenGen_->endDates()[i])) {
-                        pnlCalculators.at(k)->writePNL(i, true, sr.key_1, shift, sr.delta, sr.gamma, deltaPnl,
-                                                       gammaPnl);
-                        if (!tradeSensiCache.empty()) {
-                            auto itSr = tradeSensiCache.find(j);
-                            if (itSr != tradeSensiCache.end()) {
-                                for (const auto& kv : itSr->second) {
-                                    const auto& tradeId = tradeIds[kv.first];
-                                    Real tradeDelta = kv.second.first;
-                                    Real tradeDeltaPnl = shift * tradeDelta;
-                                    Real tradeGamma = kv.second.second;
-                                    Real tradeGammaPnl = 0.5 * shift * shift * tradeGamma;
-                                    // Attempt to write trade level P&L contribution row.
-                                    pnlCalculators.at(k)->writePNL(i, true, sr.key_1, shift, tradeDelta, tradeGamma,
-                                                                   tradeDeltaPnl, tradeGammaPnl, RiskFactorKey(), 0.0,
-                                                                   tradeId);
-                                    // Update the sensitivity based trade level P&Ls
-                                    if (runTradeLevel) {
-                                        foTradePnls.at(k).back()[kv.first] += tradeDeltaPnl;
-                                        if (includeDeltaMargin)
-                                            tradePnls.at(k).back()[kv.first] += tradeDeltaPnl;
-                                        if (includeGammaMargin)
-                                            tradePnls.at(k).back()[kv.first] += tradeGammaPnl;
-                                    }
-                                }
-                            }
+        for (Size s = 0; s < blockSize; s++) {
+
+            Size i = b + s;
+            const Date& startDate = hisScenGen_->startDates()[i];
+            const Date& endDate = hisScenGen_->endDates()[i];
+
+            // Trade level P&Ls, scatter-add the contributions of the records to the trades
+            if (runTradeLevel) {
+                std::fill(tradePnl.begin(), tradePnl.end(), 0.0);
+                std::fill(tradeFoPnl.begin(), tradeFoPnl.end(), 0.0);
+                for (Size j = 0; haveTradeSensis && j < nRecords; j++) {
+                    Real shift = shifts[row[j] * scenarioBlockSize + s];
+                    if (row2[j] == Null<Size>()) {
+                        for (Size l = tradeOffset[j]; l < tradeOffset[j + 1]; l++) {
+                            Real tradeDeltaPnl = shift * tradeDelta[l];
+                            Real tradeGammaPnl = 0.5 * shift * shift * tradeGamma[l];
+                            tradeFoPnl[tradeIndex[l]] += tradeDeltaPnl;
+                            if (includeDeltaMargin)
+                                tradePnl[tradeIndex[l]] += tradeDeltaPnl;
+                            if (includeGammaMargin)
+                                tradePnl[tradeIndex[l]] += tradeGammaPnl;
                         }
+                    } else if (includeGammaMargin) {
+                        Real shift_2 = shifts[row2[j] * scenarioBlockSize + s];
+                        for (Size l = tradeOffset[j]; l < tradeOffset[j + 1]; l++)
+                            tradePnl[tradeIndex[l]] += shift * shift_2 * tradeGamma[l];
                     }
                 }
-            } else {
-                Real shift_1 = shiftCube->get(srsIndex[j].first, 0, i);
-                Real shift_2 = shiftCube->get(srsIndex[j].second, 0, i);
-                Real gammaPnl = shift_1 * shift_2 * sr.gamma;
-
-                // If backtesting delta margin, we exclude gammas i.e. second order effects from the sensi P&L
-                if (includeGammaMargin)
-                    allPnls[i] += gammaPnl;
-                                
-                for (Size j = 0; j < pnlCalculators.size(); j++) {
-                    const auto& c = pnlCalculators[j];
-                    if (c->isInTimePeriod(hisScenGen_->startDates()[i], hisScenGen_->endDates()[i])) {
-                        c->writePNL(i, true, sr.key_1, shift_1, sr.delta, sr.gamma, 0.0, gammaPnl, sr.key_2, shift_2);
-                        if (!tradeSensiCache.empty()) {
-                            auto itSr = tradeSensiCache.find(j);
-                            if (itSr != tradeSensiCache.end()) {
-                                for (const auto& kv : itSr->second) {
-                                    const auto& tradeId = tradeIds[kv.first];
-                                    Real tradeGamma = kv.second.second;
-                                    Real tradeGammaPnl = shift_1 * shift_2 * tradeGamma;
-                                    // Attempt to write trade level P&L contribution row.
-                                    c->writePNL(i, true, sr.key_1, shift_1, 0.0, tradeGamma, 0.0, tradeGammaPnl,
-                                                  sr.key_2, shift_2, tradeId);
-                                    // Update the sensitivity based trade level P&Ls
-                                    if (runTradeLevel && includeGammaMargin) {
-                                        tradePnls.at(j).back()[kv.first] += tradeGammaPnl;
-                                    }
-                                }
+                for (Size k = 0; k < nCalculators; k++) {
+                    if (pnlCalculators[k]->isInTimePeriod(startDate, endDate)) {
+                        tradePnls[k].push_back(tradePnl);
+                        foTradePnls[k].push_back(tradeFoPnl);
+                    }
+                }
+            }
+
+            // Detail rows per sensitivity record (and trade), only for calculators that write them
+            if (!writingCalculators.empty()) {
+                for (const auto elem : srs | boost::adaptors::indexed(0)) {
+                    const auto& sr = elem.value();
+                    auto j = elem.index();
+                    Real shift_1 = shifts[row[j] * scenarioBlockSize + s];
+                    Real shift_2 = sr.isCrossGamma() ? shifts[row2[j] * scenarioBlockSize + s] : 0.0;
+                    for (Size k : writingCalculators) {
+                        const auto& c = pnlCalculators[k];
+                        if (!c->isInTimePeriod(startDate, endDate))
+                            continue;
+                        if (!sr.isCrossGamma()) {
+                            Real deltaPnl = shift_1 * sr.delta;
+                            Real gammaPnl = 0.5 * shift_1 * shift_1 * sr.gamma;
+                            c->writePNL(i, true, sr.key_1, shift_1, sr.delta, sr.gamma, deltaPnl, gammaPnl);
+                            for (Size l = tradeOffset[j]; l < tradeOffset[j + 1]; l++) {
+                                // Attempt to write trade level P&L contribution row.
+                                c->writePNL(i, true, sr.key_1, shift_1, tradeDelta[l], tradeGamma[l],
+                                            shift_1 * tradeDelta[l], 0.5 * shift_1 * shift_1 * tradeGamma[l],
+                                            RiskFactorKey(), 0.0, tradeIds[tradeIndex[l]]);
+                            }
+                        } else {
+                            c->writePNL(i, true, sr.key_1, shift_1, sr.delta, sr.gamma, 0.0,
+                                        shift_1 * shift_2 * sr.gamma, sr.key_2, shift_2);
+                            for (Size l = tradeOffset[j]; l < tradeOffset[j + 1]; l++) {
+                                // Attempt to write trade level P&L contribution row.
+                                c->writePNL(i, true, sr.key_1, shift_1, 0.0, tradeGamma[l], 0.0,
+                                            shift_1 * shift_2 * tradeGamma[l], sr.key_2, shift_2,
+                                            tradeIds[tradeIndex[l]]);
                             }
                         }
                     }
-
                 }
             }
+
+            if (covarianceCalculator)
+                covarianceCalculator->updateAccumulators(shiftCube, startDate, endDate, i);
         }
-        if (covarianceCalculator)
-            covarianceCalculator->updateAccumulators(shiftCube, hisScenGen_->startDates()[i], hisScenGen_->endDates()[i], i);
     }
     if (covarianceCalculator)
         covarianceCalculator->populateCovariance(keys);
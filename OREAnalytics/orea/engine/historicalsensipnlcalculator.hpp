@@ -29,6 +29,7 @@
 #include <orea/engine/sensitivitystream.hpp>
 #include <orea/scenario/scenario.hpp>
 
+#include <ql/math/array.hpp>
 #include <ql/math/matrix.hpp>
 #include <ql/shared_ptr.hpp>
 
@@ -55,6 +56,9 @@ public:
                           QuantLib::Real gamma, QuantLib::Real deltaPnl, Real gammaPnl,
                           const RiskFactorKey& key_2 = RiskFactorKey(),
                           QuantLib::Real shift_2 = 0.0, const std::string& tradeId = "") {}
+    /*! True if writePNL() should be called for each sensitivity record and scenario. Derived classes overriding
+        writePNL() must override this as well, otherwise the (costly) per record calls are skipped. */
+    virtual bool writesPNL() const { return false; }
     const bool isInTimePeriod(QuantLib::Date startDate, QuantLib::Date endDate);
 
     void populatePNLs(const std::vector<QuantLib::Real>& allPnls, const std::vector<QuantLib::Real>& foPnls,
@@ -83,6 +87,10 @@ protected:
     TradePnLStore tradePnls_, foTradePnls_;
 };
 
+/*! Covariance of the historical shifts of a set of risk factor keys over a covariance period. The underlying
+    statistics (number of scenarios, mean and co-moment of the shifts) are updated one scenario at a time and can be
+    downdated again, so that a rolling window can be maintained by adding the new and removing the expired scenario
+    instead of recomputing the statistics over the whole window. The result is the population covariance. */
 class CovarianceCalculator {
 public:
     CovarianceCalculator(ore::data::TimePeriod covariancePeriod) : covariancePeriod_(covariancePeriod) {}
@@ -91,14 +99,22 @@ public:
     void populateCovariance(const std::set<std::pair<RiskFactorKey, QuantLib::Size>>& keys);
     const Matrix& covariance() const { return covariance_; }
 
+    /*! Add resp. remove the shifts of one scenario, given in the order of the keys passed to initialise(). A
+        removed scenario must have been added before. */
+    void addShifts(const std::vector<QuantLib::Real>& shifts);
+    void removeShifts(const std::vector<QuantLib::Real>& shifts);
+    //! number of scenarios in the statistics
+    QuantLib::Size numScenarios() const { return n_; }
+
 private:
-    typedef boost::accumulators::accumulator_set<
-        QuantLib::Real,
-        boost::accumulators::stats<boost::accumulators::tag::covariance<QuantLib::Real, boost::accumulators::tag::covariate1>>>
-        accumulator;
-    std::map<std::pair<QuantLib::Size, QuantLib::Size>, accumulator> accCov_;
     ore::data::TimePeriod covariancePeriod_;
+    // index of the keys in the shift cube, in the order of the keys passed to initialise()
+    std::vector<QuantLib::Size> cubeIndex_;
+    QuantLib::Size n_ = 0;
+    QuantLib::Array mean_;
+    QuantLib::Matrix comoment_;
     QuantLib::Matrix covariance_;
+    std::vector<QuantLib::Real> shifts_, diff_;
 };
 
 class HistoricalSensiPnlCalculator {
@@ -107,8 +123,10 @@ public:
                                  const QuantLib::ext::shared_ptr<SensitivityStream>& ss)
         : hisScenGen_(hisScenGen), sensitivityStream_(ss) {}
     
+    //! the shifts of the historical scenarios are computed in parallel on \p nThreads threads
     void populateSensiShifts(QuantLib::ext::shared_ptr<NPVCube>& cube, const vector<RiskFactorKey>& keys,
-                             QuantLib::ext::shared_ptr<ScenarioShiftCalculator> shiftCalculator);
+                             QuantLib::ext::shared_ptr<ScenarioShiftCalculator> shiftCalculator,
+                             const QuantLib::Size nThreads = 1);
 
     void calculateSensiPnl(const std::set<SensitivityRecord>& srs,
         const std::vector<RiskFactorKey>& rfKeys,
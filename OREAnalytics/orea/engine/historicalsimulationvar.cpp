@@ -21,11 +21,10 @@
 #include <orea/cube/inmemorycube.hpp>
 #include <ored/utilities/to_string.hpp>
 
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics.hpp>
-#include <boost/accumulators/statistics/tail_quantile.hpp>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
-using namespace boost::accumulators;
 using namespace ore::data;
 using namespace QuantLib;
 
@@ -36,8 +35,9 @@ HistoricalSimulationVarReport::HistoricalSimulationVarReport(
     const std::string& baseCurrency, const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
     const string& portfolioFilter, const vector<Real>& p, boost::optional<TimePeriod> period,
     const ext::shared_ptr<HistoricalScenarioGenerator>& hisScenGen, std::unique_ptr<FullRevalArgs> fullRevalArgs,
-    const bool breakdown)
-    : VarReport(baseCurrency, portfolio, portfolioFilter, p, period, hisScenGen, nullptr, std::move(fullRevalArgs)) {
+    const bool breakdown, std::unique_ptr<MultiThreadArgs> multiThreadArgs)
+    : VarReport(baseCurrency, portfolio, portfolioFilter, p, period, hisScenGen, nullptr, std::move(fullRevalArgs),
+                false, std::move(multiThreadArgs)) {
     fullReval_ = true;
 }
 
@@ -53,18 +53,70 @@ void HistoricalSimulationVarReport::handleFullRevalResults(const ext::shared_ptr
 
 Real HistoricalSimulationVarCalculator::var(Real confidence, const bool isCall, 
     const set<pair<string, Size>>& tradeIds) {
+    return vars({confidence}, isCall, tradeIds).front();
+}
 
-    // Use boost to calculate the quantile based on confidence_
-    Size c = static_cast<Size>(std::floor(pnls_.size() * (1.0 - confidence) + 0.5)) + 2;
-    typedef accumulator_set<double, stats<boost::accumulators::tag::tail_quantile<boost::accumulators::right>>>
-        accumulator;
-    accumulator acc(boost::accumulators::tag::tail<boost::accumulators::right>::cache_size = c);
+vector<Real> HistoricalSimulationVarCalculator::vars(const vector<Real>& confidences, const bool isCall,
+                                                     const set<pair<string, Size>>& tradeIds) {
+    vector<Real> result;
+    tailStatistics(confidences, isCall, &result, nullptr);
+    return result;
+}
 
-    for (const auto& pnl : pnls_) {
-        acc(isCall ? pnl : -pnl);
+Real HistoricalSimulationVarCalculator::expectedShortfall(Real confidence, const bool isCall) {
+    return expectedShortfalls({confidence}, isCall).front();
+}
+
+vector<Real> HistoricalSimulationVarCalculator::expectedShortfalls(const vector<Real>& confidences,
+                                                                   const bool isCall) {
+    vector<Real> result;
+    tailStatistics(confidences, isCall, nullptr, &result);
+    return result;
+}
+
+void HistoricalSimulationVarCalculator::tailStatistics(const vector<Real>& confidences, const bool isCall,
+                                                       vector<Real>* var, vector<Real>* es) {
+    Size n = pnls_.size();
+    if (var)
+        var->assign(confidences.size(), std::numeric_limits<Real>::quiet_NaN());
+    if (es)
+        es->assign(confidences.size(), std::numeric_limits<Real>::quiet_NaN());
+
+    // the rank of the quantile in the descending order of the P&Ls, as in boost's right tail_quantile
+    vector<pair<Size, Size>> ranks;
+    for (Size i = 0; i < confidences.size(); ++i) {
+        Size r = static_cast<Size>(std::ceil(static_cast<Real>(n) * (1.0 - confidences[i])));
+        // the tail quantile is not defined if the rank reaches the number of P&Ls
+        if (r < n)
+            ranks.push_back(std::make_pair(std::max<Size>(r, 1), i));
     }
+    if (ranks.empty())
+        return;
+    std::sort(ranks.begin(), ranks.end(), std::greater<pair<Size, Size>>());
 
-    return quantile(acc, quantile_probability = confidence);
+    buffer_.resize(n);
+    std::transform(pnls_.begin(), pnls_.end(), buffer_.begin(), [isCall](Real p) { return isCall ? p : -p; });
+
+    // after the selection of rank r the first r - 1 elements are the r - 1 largest P&Ls, so the next (smaller)
+    // rank can be selected within these
+    auto end = buffer_.end();
+    Size lastRank = 0;
+    Real lastVar = 0.0, lastEs = 0.0;
+    for (auto const& [r, i] : ranks) {
+        if (r != lastRank) {
+            auto nth = buffer_.begin() + (r - 1);
+            std::nth_element(buffer_.begin(), nth, end, std::greater<Real>());
+            lastVar = *nth;
+            if (es)
+                lastEs = std::accumulate(buffer_.begin(), nth + 1, 0.0) / static_cast<Real>(r);
+            lastRank = r;
+            end = nth;
+        }
+        if (var)
+            (*var)[i] = lastVar;
+        if (es)
+            (*es)[i] = lastEs;
+    }
 }
 
 } // namespace analytics
@@ -47,15 +47,32 @@ namespace analytics {
 using QuantLib::Array;
 using QuantLib::Matrix;
 
+/*! The VaR at confidence level p is the n-th largest P&L with n = ceil(N (1 - p)), N being the number of P&Ls, i.e.
+    the same value as a boost right tail_quantile accumulator would give. The expected shortfall is the average of the
+    n largest P&Ls. Both are computed by selection (nth_element) on a buffer that is reused across confidence levels:
+    the levels are processed in decreasing order of n, so that each selection only needs to look at the elements
+    above the previous one. */
 class HistoricalSimulationVarCalculator : public VarCalculator {
 public:
     HistoricalSimulationVarCalculator(const std::vector<QuantLib::Real>& pnls) : pnls_(pnls) {}
 
     QuantLib::Real var(QuantLib::Real confidence, const bool isCall = true,
         const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
+    std::vector<QuantLib::Real> vars(const std::vector<QuantLib::Real>& confidences, const bool isCall = true,
+                                     const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
+
+    QuantLib::Real expectedShortfall(QuantLib::Real confidence, const bool isCall = true);
+    std::vector<QuantLib::Real> expectedShortfalls(const std::vector<QuantLib::Real>& confidences,
+                                                   const bool isCall = true);
 
 private:
+    /*! sets var[i] and es[i] for the confidence level confidences[i], either output vector can be null, NaN is
+        returned for levels that are not supported by the number of P&Ls */
+    void tailStatistics(const std::vector<QuantLib::Real>& confidences, const bool isCall,
+                        std::vector<QuantLib::Real>* var, std::vector<QuantLib::Real>* es);
+
     const std::vector<QuantLib::Real>& pnls_;
+    std::vector<QuantLib::Real> buffer_;
 };
 
 //! HistoricalSimulation VaR Calculator
@@ -70,7 +87,8 @@ public:
                                   const std::string& portfolioFilter, 
         const vector<Real>& p, boost::optional<ore::data::TimePeriod> period,
         const QuantLib::ext::shared_ptr<HistoricalScenarioGenerator>& hisScenGen = nullptr, 
-        std::unique_ptr<FullRevalArgs> fullRevalArgs = nullptr, const bool breakdown = false);
+        std::unique_ptr<FullRevalArgs> fullRevalArgs = nullptr, const bool breakdown = false,
+        std::unique_ptr<MultiThreadArgs> multiThreadArgs = nullptr);
 
 protected:
     void createVarCalculator() override;
@@ -166,6 +166,8 @@ void MarketRiskReport::initialise() {
                 multiThreadArgs_->curveConfigs_, multiThreadArgs_->todaysMarketParams_,
                 multiThreadArgs_->configuration_, multiThreadArgs_->simMarketData_, fullRevalArgs_->referenceData_,
                 fullRevalArgs_->iborFallbackConfig_, fullRevalArgs_->dryRun_, multiThreadArgs_->context_);
+            if (multiThreadArgs_->tradeBlockSize_ > 0)
+                histPnlGen_->setWorkStealing(multiThreadArgs_->tradeBlockSize_, multiThreadArgs_->sampleBlockSize_);
         }
     }
 
@@ -257,9 +259,12 @@ void MarketRiskReport::calculate(const ext::shared_ptr<MarketRiskReport::Reports
     // Cube to store Sensi Shifts and vector of keys used in cube, per portfolio
     map<string, QuantLib::ext::shared_ptr<NPVCube>> sensiShiftCube;
     ext::shared_ptr<SensitivityAggregator> sensiAgg;
-    if (sensiBased_)
-        // Create a sensitivity aggregator. Will be used if running sensi-based backtest.
+    if (sensiBased_) {
+        // Create a sensitivity aggregator. Will be used if running sensi-based backtest. The stream is aggregated
+        // once, the sensitivities of each risk group are selected from the aggregated records below.
         sensiAgg = ext::make_shared<SensitivityAggregator>(tradeIdGroups_);
+        sensiAgg->aggregate(*sensiArgs_->sensitivityStream_);
+    }
     
     bool runDetailTrd = runTradeDetail(reports);
     addPnlCalculators(reports);
@@ -280,7 +285,7 @@ void MarketRiskReport::calculate(const ext::shared_ptr<MarketRiskReport::Reports
         updateFilter(riskGroup, filter);
 
         if (sensiBased_)
-            sensiAgg->aggregate(*sensiArgs_->sensitivityStream_, filter);
+            sensiAgg->applyFilter(filter);
 
         // If doing a full revaluation backtest, generate the cube under this filter
         if (fullReval_) {
@@ -349,8 +354,9 @@ void MarketRiskReport::calculate(const ext::shared_ptr<MarketRiskReport::Reports
                             vector<RiskFactorKey> riskFactorKeys;
                             transform(deltas_.begin(), deltas_.end(), back_inserter(riskFactorKeys),
                                       [](const pair<RiskFactorKey, Real>& kv) { return kv.first; });
-                            sensiPnlCalculator_->populateSensiShifts(scube->second, riskFactorKeys,
-                                                                     sensiArgs_->shiftCalculator_);
+                            sensiPnlCalculator_->populateSensiShifts(
+                                scube->second, riskFactorKeys, sensiArgs_->shiftCalculator_,
+                                multiThreadArgs_ ? multiThreadArgs_->nThreads_ : 1);
                         }
                     }
                 }
@@ -408,7 +414,8 @@ void MarketRiskReport::calculate(const ext::shared_ptr<MarketRiskReport::Reports
                                                                 covCalculator, tradeIds_, includeGammaMargin_,
                                                                 includeDeltaMargin_, runDetailTrd);
 
-                        covarianceMatrix_ = covCalculator->covariance();
+                        if (covCalculator)
+                            covarianceMatrix_ = covCalculator->covariance();
                     }
                     handleSensiResults(reports, riskGroup, tradeGroup);
                 }
@@ -419,9 +426,6 @@ void MarketRiskReport::calculate(const ext::shared_ptr<MarketRiskReport::Reports
 
             writeReports(reports, riskGroup, tradeGroup);
         }
-        if (sensiBased_)
-            // Reset the sensitivity aggregator before changing the risk filter
-            sensiAgg->reset();
     }
     closeReports(reports);
 }
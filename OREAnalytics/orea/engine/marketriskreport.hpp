@@ -202,14 +202,19 @@ public:
         std::string configuration_;
         QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters> simMarketData_;
         std::string context_;
+        //! if > 0 the work stealing scheduling of the valuation engine is used, see MultiThreadedValuationEngine
+        QuantLib::Size tradeBlockSize_;
+        QuantLib::Size sampleBlockSize_;
 
         MultiThreadArgs(QuantLib::Size n, QuantLib::Date t, const QuantLib::ext::shared_ptr<ore::data::Loader>& l,
                         const QuantLib::ext::shared_ptr<ore::data::CurveConfigurations>& cc,
                         const QuantLib::ext::shared_ptr<ore::data::TodaysMarketParameters>& tmp, std::string conf,
                         const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& smd,
-                        const std::string& context)
+                        const std::string& context, const QuantLib::Size tradeBlockSize = 0,
+                        const QuantLib::Size sampleBlockSize = 0)
             : nThreads_(n), today_(t), loader_(l), curveConfigs_(cc), todaysMarketParams_(tmp), configuration_(conf),
-              simMarketData_(smd), context_(context) {}
+              simMarketData_(smd), context_(context), tradeBlockSize_(tradeBlockSize),
+              sampleBlockSize_(sampleBlockSize) {}
     };
 
     class Reports {
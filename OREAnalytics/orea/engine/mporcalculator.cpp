@@ -31,6 +31,7 @@ void MPORCalculator::init(const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
                           const QuantLib::ext::shared_ptr<SimMarket>& simMarket) {
     DLOG("init MPORCalculator")
     npvCalc_->init(portfolio, simMarket);
+    valuationNpvs_.assign(portfolio->size(), 0.0);
 }
 
 void MPORCalculator::initScenario() { npvCalc_->initScenario(); }
@@ -41,9 +42,20 @@ void MPORCalculator::calculate(const QuantLib::ext::shared_ptr<Trade>& trade, Si
                                Size sample, bool isCloseOut) {
     Size index = isCloseOut ? closeOutIndex_ : defaultIndex_;
     Real npv = npvCalc_->npv(tradeIndex, trade, simMarket);
+    if (!isCloseOut)
+        valuationNpvs_[tradeIndex] = npv * simMarket->numeraire() / npvCalc_->fxRate(tradeIndex);
     outputCube->set(npv * (isCloseOut ? simMarket->numeraire() : 1.0), tradeIndex, dateIndex, sample, index);
 }
 
+void MPORCalculator::reuseValuation(const QuantLib::ext::shared_ptr<Trade>& trade, Size tradeIndex,
+                                    const QuantLib::ext::shared_ptr<SimMarket>& simMarket,
+                                    QuantLib::ext::shared_ptr<NPVCube>& outputCube,
+                                    QuantLib::ext::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date,
+                                    Size dateIndex, Size sample) {
+    outputCube->set(valuationNpvs_[tradeIndex] * npvCalc_->fxRate(tradeIndex), tradeIndex, dateIndex, sample,
+                    closeOutIndex_);
+}
+
 void MPORCalculator::calculateT0(const QuantLib::ext::shared_ptr<Trade>& trade, Size tradeIndex,
                                  const QuantLib::ext::shared_ptr<SimMarket>& simMarket, QuantLib::ext::shared_ptr<NPVCube>& outputCube,
                                  QuantLib::ext::shared_ptr<NPVCube>& outputCubeNettingSet) {
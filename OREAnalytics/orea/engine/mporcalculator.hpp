@@ -49,12 +49,21 @@ public:
                      const QuantLib::ext::shared_ptr<SimMarket>& simMarket, QuantLib::ext::shared_ptr<NPVCube>& outputCube,
                      QuantLib::ext::shared_ptr<NPVCube>& outputCubeNettingSet) override;
 
+    //! converts the valuation date npv of the trade in trade ccy with the fx rate of the close-out scenario
+    void reuseValuation(const QuantLib::ext::shared_ptr<Trade>& trade, Size tradeIndex,
+                        const QuantLib::ext::shared_ptr<SimMarket>& simMarket,
+                        QuantLib::ext::shared_ptr<NPVCube>& outputCube,
+                        QuantLib::ext::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date, Size dateIndex,
+                        Size sample) override;
+
     void init(const QuantLib::ext::shared_ptr<Portfolio>& portfolio, const QuantLib::ext::shared_ptr<SimMarket>& simMarket) override;
     void initScenario() override;
 
 private:
     QuantLib::ext::shared_ptr<NPVCalculator> npvCalc_;
     Size defaultIndex_, closeOutIndex_;
+    // npv in trade ccy of the last valuation date calculation, per trade
+    std::vector<Real> valuationNpvs_;
 };
 
 } // namespace analytics
@@ -27,10 +27,17 @@
 #include <ored/portfolio/enginefactory.hpp>
 #include <ored/portfolio/trade.hpp>
 #include <ored/utilities/dategrid.hpp>
+#include <ored/utilities/osutils.hpp>
+#include <ored/utilities/trace.hpp>
 
 #include <boost/timer/timer.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <set>
 
 // #include <ctpl_stl.h>
 
@@ -39,6 +46,225 @@ namespace analytics {
 
 using QuantLib::Size;
 
+namespace {
+
+using PricingStats = std::map<std::string, std::pair<std::size_t, boost::timer::nanosecond_type>>;
+
+// sets the pricing stats in the original portfolio from the initial stats and the stats accumulated in the workers
+void updatePricingStats(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio, PricingStats& pricingStats,
+                        const std::vector<PricingStats>& workerPricingStats) {
+    for (auto const& [tid, t] : portfolio->trades()) {
+        auto p = pricingStats[tid];
+        std::size_t n = p.first;
+        boost::timer::nanosecond_type d = p.second;
+        for (auto const& w : workerPricingStats) {
+            auto p = w.find(tid);
+            if (p != w.end()) {
+                n += p->second.first;
+                d += p->second.second;
+            }
+        }
+        t->resetPricingStats(n, d);
+    }
+}
+
+// a unit of work for the task based engine: a trade block and a range of samples
+struct WorkUnit {
+    Size block, firstSample, endSample;
+};
+
+/* one queue per worker, a worker takes units from the front of its own queue and, if that is empty, steals units from
+   the back of the longest queue of the other workers. Pinned units are processed by their worker only. Units are
+   coarse (a trade block priced over a range of samples), so that a single mutex guarding all queues is sufficient. */
+class WorkStealingQueues {
+public:
+    explicit WorkStealingQueues(const Size nWorkers) : pinned_(nWorkers), queues_(nWorkers) {}
+
+    void push(const Size worker, const WorkUnit& unit, const bool pinned) {
+        (pinned ? pinned_ : queues_)[worker].push_back(unit);
+    }
+
+    bool pop(const Size worker, WorkUnit& unit, bool& stolen) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stolen = false;
+        for (auto* q : {&pinned_[worker], &queues_[worker]}) {
+            if (!q->empty()) {
+                unit = q->front();
+                q->pop_front();
+                return true;
+            }
+        }
+        Size victim = worker;
+        for (Size i = 0; i < queues_.size(); ++i) {
+            if (i != worker && queues_[i].size() > (victim == worker ? 0 : queues_[victim].size()))
+                victim = i;
+        }
+        if (victim == worker)
+            return false;
+        unit = queues_[victim].back();
+        queues_[victim].pop_back();
+        stolen = true;
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::deque<WorkUnit>> pinned_, queues_;
+};
+
+/* the cube a work unit is valued into: holds a copy of the values of the samples firstSample, ..., endSample - 1 of a
+   block cube, addressed by the sample indices of the block cube, so that the units of a block do not write to the
+   block cube concurrently. Ids removed by the valuation engine (trades with errors) are recorded and removed from the
+   block cube on merge. The copy and the merge must be synchronised with the other units of the block. */
+class SampleRangeCube : public NPVCube {
+public:
+    SampleRangeCube(const QuantLib::ext::shared_ptr<NPVCube>& cube, const Size firstSample, const Size endSample)
+        : cube_(cube), firstSample_(firstSample),
+          data_(cube->asof(), cube->ids(), cube->dates(), endSample - firstSample, cube->depth()) {
+        for (Size i = 0; i < data_.numIds(); ++i) {
+            for (Size d = 0; d < data_.depth(); ++d) {
+                data_.setT0(cube->getT0(i, d), i, d);
+                for (Size k = 0; k < data_.numDates(); ++k) {
+                    for (Size l = 0; l < data_.samples(); ++l)
+                        data_.set(cube->get(i, k, firstSample_ + l, d), i, k, l, d);
+                }
+            }
+        }
+    }
+
+    Size numIds() const override { return data_.numIds(); }
+    Size numDates() const override { return data_.numDates(); }
+    Size samples() const override { return cube_->samples(); }
+    Size depth() const override { return data_.depth(); }
+    const std::map<std::string, Size>& idsAndIndexes() const override { return data_.idsAndIndexes(); }
+    const std::vector<QuantLib::Date>& dates() const override { return data_.dates(); }
+    QuantLib::Date asof() const override { return data_.asof(); }
+
+    Real getT0(Size id, Size depth) const override { return data_.getT0(id, depth); }
+    void setT0(Real value, Size id, Size depth) override { data_.setT0(value, id, depth); }
+    Real get(Size id, Size date, Size sample, Size depth) const override {
+        return data_.get(id, date, localSample(sample), depth);
+    }
+    void set(Real value, Size id, Size date, Size sample, Size depth) override {
+        data_.set(value, id, date, localSample(sample), depth);
+    }
+    void remove(Size id) override { removedIds_.insert(id); }
+    void remove(Size id, Size sample) override { data_.remove(id, localSample(sample)); }
+
+    /* copy the values back into the block cube, the t0 values are only taken from the unit starting at sample 0, the
+       removedIds of the block are updated and skipped */
+    void merge(std::set<Size>& removedIds) const {
+        for (auto i : removedIds_) {
+            if (removedIds.insert(i).second)
+                cube_->remove(i);
+        }
+        for (Size i = 0; i < data_.numIds(); ++i) {
+            if (removedIds.find(i) != removedIds.end())
+                continue;
+            for (Size d = 0; d < data_.depth(); ++d) {
+                if (firstSample_ == 0)
+                    cube_->setT0(data_.getT0(i, d), i, d);
+                for (Size k = 0; k < data_.numDates(); ++k) {
+                    for (Size l = 0; l < data_.samples(); ++l)
+                        cube_->set(data_.get(i, k, l, d), i, k, firstSample_ + l, d);
+                }
+            }
+        }
+    }
+
+private:
+    Size localSample(const Size sample) const {
+        QL_REQUIRE(sample >= firstSample_ && sample < firstSample_ + data_.samples(),
+                   "SampleRangeCube: sample " << sample << " outside range [" << firstSample_ << ", "
+                                              << firstSample_ + data_.samples() << ")");
+        return sample - firstSample_;
+    }
+
+    QuantLib::ext::shared_ptr<NPVCube> cube_;
+    Size firstSample_;
+    DoublePrecisionInMemoryCubeN data_;
+    std::set<Size> removedIds_;
+};
+
+// the synchronisation of the units of a trade block, see SampleRangeCube
+struct BlockState {
+    std::mutex mutex;
+    std::set<Size> removedIds, removedNettingSetIds, removedCptyIds;
+};
+
+// anonymous memory shared with forked worker processes, holding n doubles
+class SharedBuffer {
+public:
+    explicit SharedBuffer(const Size n)
+        : n_(n), data_(static_cast<double*>(ore::data::os::allocateSharedMemory(n * sizeof(double)))) {
+        QL_REQUIRE(n == 0 || data_ != nullptr, "MultiThreadedValuationEngine: could not allocate "
+                                                   << n * sizeof(double) << " bytes of shared memory");
+    }
+    ~SharedBuffer() { ore::data::os::freeSharedMemory(data_, n_ * sizeof(double)); }
+    SharedBuffer(const SharedBuffer&) = delete;
+    SharedBuffer& operator=(const SharedBuffer&) = delete;
+    double* data() const { return data_; }
+
+private:
+    Size n_;
+    double* data_;
+};
+
+// number of doubles needed to store the t0 and the future values of a cube, zero for a null cube
+Size cubeBufferSize(const QuantLib::ext::shared_ptr<NPVCube>& cube) {
+    return cube ? cube->numIds() * cube->depth() * (1 + cube->numDates() * cube->samples()) : 0;
+}
+
+void writeCube(const QuantLib::ext::shared_ptr<NPVCube>& cube, double*& p) {
+    if (!cube)
+        return;
+    for (Size i = 0; i < cube->numIds(); ++i) {
+        for (Size d = 0; d < cube->depth(); ++d) {
+            *p++ = cube->getT0(i, d);
+            for (Size k = 0; k < cube->numDates(); ++k) {
+                for (Size l = 0; l < cube->samples(); ++l)
+                    *p++ = cube->get(i, k, l, d);
+            }
+        }
+    }
+}
+
+void readCube(const QuantLib::ext::shared_ptr<NPVCube>& cube, const double*& p) {
+    if (!cube)
+        return;
+    for (Size i = 0; i < cube->numIds(); ++i) {
+        for (Size d = 0; d < cube->depth(); ++d) {
+            cube->setT0(*p++, i, d);
+            for (Size k = 0; k < cube->numDates(); ++k) {
+                for (Size l = 0; l < cube->samples(); ++l)
+                    cube->set(*p++, i, k, l, d);
+            }
+        }
+    }
+}
+
+// the keys a sim market with the given parameters can write to the aggregation scenario data
+std::vector<std::pair<AggregationScenarioDataType, std::string>>
+aggregationScenarioDataKeys(const ScenarioSimMarketParameters& parameters) {
+    std::vector<std::pair<AggregationScenarioDataType, std::string>> keys;
+    for (auto const& i : parameters.additionalScenarioDataIndices())
+        keys.push_back(std::make_pair(AggregationScenarioDataType::IndexFixing, i));
+    for (auto const& c : parameters.additionalScenarioDataCcys()) {
+        if (c != parameters.baseCcy())
+            keys.push_back(std::make_pair(AggregationScenarioDataType::FXSpot, c));
+    }
+    for (Size i = 0; i < parameters.additionalScenarioDataNumberOfCreditStates(); ++i)
+        keys.push_back(std::make_pair(AggregationScenarioDataType::CreditState, std::to_string(i)));
+    for (auto const& n : parameters.additionalScenarioDataSurvivalWeights()) {
+        keys.push_back(std::make_pair(AggregationScenarioDataType::SurvivalWeight, n));
+        keys.push_back(std::make_pair(AggregationScenarioDataType::RecoveryRate, n));
+    }
+    keys.push_back(std::make_pair(AggregationScenarioDataType::Numeraire, std::string()));
+    return keys;
+}
+
+} // namespace
+
 MultiThreadedValuationEngine::MultiThreadedValuationEngine(
     const Size nThreads, const QuantLib::Date& today, const QuantLib::ext::shared_ptr<ore::data::DateGrid>& dateGrid,
     const Size nSamples, const QuantLib::ext::shared_ptr<ore::data::Loader>& loader,
@@ -73,12 +299,6 @@ MultiThreadedValuationEngine::MultiThreadedValuationEngine(
 
     QL_REQUIRE(nThreads_ != 0, "MultiThreadedValuationEngine: nThreads must be > 0");
 
-    // check whether sessions are enabled, if not exit with an error
-
-#ifndef QL_ENABLE_SESSIONS
-    QL_FAIL("MultiThreadedValuationEngine requires a build with QL_ENABLE_SESSIONS = ON.");
-#endif
-
     // if no cube factory is given, create a default one
 
     if (!cubeFactory_)
@@ -101,16 +321,159 @@ void MultiThreadedValuationEngine::setAggregationScenarioData(
     aggregationScenarioData_ = aggregationScenarioData;
 }
 
+void MultiThreadedValuationEngine::setWorkStealing(const Size tradeBlockSize, const Size sampleBlockSize) {
+    QL_REQUIRE(tradeBlockSize > 0, "MultiThreadedValuationEngine::setWorkStealing(): tradeBlockSize must be > 0");
+    tradeBlockSize_ = tradeBlockSize;
+    sampleBlockSize_ = sampleBlockSize;
+}
+
+void MultiThreadedValuationEngine::setShareInitMarket(const bool shareInitMarket) {
+    QL_REQUIRE(!shareInitMarket || !useSpreadedTermStructures_,
+               "MultiThreadedValuationEngine::setShareInitMarket(): a shared init market can not be used with "
+               "spreaded term structures");
+    shareInitMarket_ = shareInitMarket;
+}
+
+void MultiThreadedValuationEngine::setNumaAware(const bool numaAware, const Size numaNodes) {
+    numaAware_ = numaAware;
+    numaNodes_ = numaNodes;
+}
+
+void MultiThreadedValuationEngine::setMultiProcess(const bool multiProcess) {
+    QL_REQUIRE(!multiProcess || ore::data::os::forkSupported(),
+               "MultiThreadedValuationEngine::setMultiProcess(): worker processes are not supported on this platform");
+    multiProcess_ = multiProcess;
+}
+
+std::vector<std::vector<unsigned int>> MultiThreadedValuationEngine::numaWorkerCpus(const Size nWorkers) const {
+    if (!numaAware_)
+        return {};
+    auto nodes = ore::data::os::getNumaNodeCpus();
+    if (numaNodes_ > 0 && numaNodes_ < nodes.size())
+        nodes.resize(numaNodes_);
+    LOG("NUMA-aware placement of " << nWorkers << " workers on " << nodes.size() << " node(s)");
+    std::vector<std::vector<unsigned int>> result(nWorkers);
+    for (Size i = 0; i < nWorkers; ++i) {
+        Size node = i * nodes.size() / nWorkers;
+        result[i] = nodes[node];
+        DLOG("Worker #" << i << " placed on node #" << node << " (" << nodes[node].size() << " cpus)");
+    }
+    return result;
+}
+
+void MultiThreadedValuationEngine::setDatePricingStats(const std::vector<std::vector<Size>>& workerDatePricings,
+                                                       const std::vector<std::vector<double>>& workerDatePricingTimes) {
+    datePricings_.assign(dateGrid_->valuationDates().size(), 0);
+    datePricingTimes_.assign(dateGrid_->valuationDates().size(), 0.0);
+    for (Size i = 0; i < workerDatePricings.size(); ++i) {
+        for (Size j = 0; j < std::min(workerDatePricings[i].size(), datePricings_.size()); ++j) {
+            datePricings_[j] += workerDatePricings[i][j];
+            datePricingTimes_[j] += workerDatePricingTimes[i][j];
+        }
+    }
+}
+
+QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket>
+MultiThreadedValuationEngine::buildWorkerSimMarket(
+    const QuantLib::ext::shared_ptr<ore::data::Loader>& loader,
+    const QuantLib::ext::shared_ptr<ore::data::Market>& initMarket) const {
+    auto build = [this](const QuantLib::ext::shared_ptr<ore::data::Market>& market) {
+        return QuantLib::ext::make_shared<ore::analytics::ScenarioSimMarket>(
+            market, simMarketData_, configuration_, *curveConfigs_, *todaysMarketParams_, true,
+            useSpreadedTermStructures_, cacheSimData_, false, iborFallbackConfig_, handlePseudoCurrenciesSimMarket_,
+            offsetScenario_);
+    };
+
+    // a worker process has its own copy of the init market, including the fixings applied in the calling thread
+
+    if (shareInitMarket_ && multiProcess_)
+        return build(initMarket);
+
+    // build todays market using cloned market data
+
+    return build(QuantLib::ext::make_shared<ore::data::TodaysMarket>(
+        today_, todaysMarketParams_, loader, curveConfigs_, true, true, true, referenceData_, false,
+        iborFallbackConfig_, false, handlePseudoCurrenciesTodaysMarket_));
+}
+
+void MultiThreadedValuationEngine::updateCube(
+    const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio, const std::set<std::string>& tradeIds,
+    const QuantLib::ext::shared_ptr<ore::analytics::NPVCube>& outputCube,
+    const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::ValuationCalculator>>()>& calculators,
+    bool mporStickyDate) {
+
+    QL_REQUIRE(outputCube, "MultiThreadedValuationEngine::updateCube(): no output cube given");
+
+    auto subPortfolio = QuantLib::ext::make_shared<ore::data::Portfolio>(portfolio->buildFailedTrades());
+    for (auto const& id : tradeIds) {
+        auto c = outputCube->idsAndIndexes().find(id);
+        QL_REQUIRE(c != outputCube->idsAndIndexes().end(),
+                   "MultiThreadedValuationEngine::updateCube(): trade " << id << " not in output cube");
+        outputCube->remove(c->second);
+        auto t = portfolio->trades().find(id);
+        if (t != portfolio->trades().end())
+            subPortfolio->add(t->second);
+    }
+
+    LOG("MultiThreadedValuationEngine: update " << subPortfolio->size() << " trades and remove "
+                                                << tradeIds.size() - subPortfolio->size()
+                                                << " trades in output cube of " << outputCube->numIds() << " trades");
+    if (subPortfolio->empty())
+        return;
+
+    buildCube(subPortfolio, calculators, {}, mporStickyDate);
+
+    // copy the values of the mini-cubes into the output cube
+    for (auto const& miniCube : miniCubes_) {
+        QL_REQUIRE(miniCube->numDates() == outputCube->numDates() && miniCube->samples() == outputCube->samples() &&
+                       miniCube->depth() == outputCube->depth(),
+                   "MultiThreadedValuationEngine::updateCube(): mini-cube dimensions ("
+                       << miniCube->numDates() << " x " << miniCube->samples() << " x " << miniCube->depth()
+                       << ") do not match output cube dimensions (" << outputCube->numDates() << " x "
+                       << outputCube->samples() << " x " << outputCube->depth() << ")");
+        for (auto const& [id, i] : miniCube->idsAndIndexes()) {
+            Size j = outputCube->idsAndIndexes().at(id);
+            for (Size d = 0; d < miniCube->depth(); ++d) {
+                outputCube->setT0(miniCube->getT0(i, d), j, d);
+                for (Size k = 0; k < miniCube->numDates(); ++k) {
+                    for (Size l = 0; l < miniCube->samples(); ++l)
+                        outputCube->set(miniCube->get(i, k, l, d), j, k, l, d);
+                }
+            }
+        }
+    }
+}
+
 void MultiThreadedValuationEngine::buildCube(
     const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
     const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::ValuationCalculator>>()>& calculators,
     const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::CounterpartyCalculator>>()>& cptyCalculators,
     bool mporStickyDate, bool dryRun) {
 
+    ORE_TRACE_SCOPE("MultiThreadedValuationEngine::buildCube");
+
     boost::timer::cpu_timer timer;
 
     LOG("MultiThreadedValuationEngine::buildCube() was called");
 
+    // check whether sessions are enabled, if not exit with an error, worker processes do not share singletons
+
+#ifndef QL_ENABLE_SESSIONS
+    QL_REQUIRE(multiProcess_, "MultiThreadedValuationEngine requires a build with QL_ENABLE_SESSIONS = ON or the "
+                              "multi-process mode, see setMultiProcess().");
+#endif
+
+    // the worker processes are forked from this thread, other threads would hold their locks in the children forever
+
+    if (multiProcess_) {
+        Size nProcessThreads = ore::data::os::getNumberOfThreads();
+        QL_REQUIRE(nProcessThreads <= 1,
+                   "MultiThreadedValuationEngine: the multi-process mode requires that no other threads are running, "
+                   "found "
+                       << nProcessThreads
+                       << " threads (e.g. of an asynchronous file logger or a thread pool), see setMultiProcess().");
+    }
+
     // extract pricing stats accumulated so far and clear them
 
     LOG("Extract pricing stats and clear them in the current portfolio");
@@ -178,6 +541,26 @@ void MultiThreadedValuationEngine::buildCube(
                       return p1.second > p2.second;
               });
 
+    // use the task based engine, if configured
+
+    if (tradeBlockSize_ > 0 && multiProcess_)
+        WLOG("MultiThreadedValuationEngine: work stealing is not supported with worker processes, using the static "
+             "split of the portfolio");
+
+    if (tradeBlockSize_ > 0 && !dryRun && !multiProcess_) {
+        auto workerPricingStats =
+            buildCubeWorkStealing(portfolio, initMarket, timings, calculators, cptyCalculators, mporStickyDate);
+        LOG("Update pricing stats of trades.");
+        updatePricingStats(portfolio, pricingStats, workerPricingStats);
+        LOG("MultiThreadedValuationEngine::buildCube() successfully finished, timings: "
+            << static_cast<double>(timer.elapsed().wall) / 1.0E9 << "s Wall, "
+            << static_cast<double>(timer.elapsed().user) / 1.0E9 << "s User, "
+            << static_cast<double>(timer.elapsed().system) / 1.0E9 << "s System.");
+        return;
+    }
+
+    workerStats_.clear();
+
     std::vector<double> portfolioTotalAvgPricingTime(portfolios.size());
     Size portfolioIndex = 0;
     for (auto const& t : timings) {
@@ -215,24 +598,42 @@ void MultiThreadedValuationEngine::buildCube(
         DLOG("generator for thread " << (i + 1) << " cloned.");
     }
 
-    // build loaders for each thread as clones of the original one
-
-    LOG("Cloning loaders for " << eff_nThreads << " threads...");
-    std::vector<QuantLib::ext::shared_ptr<ore::data::ClonedLoader>> loaders;
-    for (Size i = 0; i < eff_nThreads; ++i)
-        loaders.push_back(QuantLib::ext::make_shared<ore::data::ClonedLoader>(today_, loader_));
-
-    // build nThreads mini-cubes to which each thread writes its results
+    /* build loaders for each thread as clones of the original one, not needed if the init market is shared with
+       worker processes. Worker threads always build their own todays market: the fixings are applied to the index
+       manager of the session building the market, and the lazy t0 objects would be calculated concurrently. */
+
+    std::vector<QuantLib::ext::shared_ptr<ore::data::ClonedLoader>> loaders(eff_nThreads);
+    if (shareInitMarket_ && !multiProcess_)
+        WLOG("MultiThreadedValuationEngine: the init market is only shared with worker processes, each worker thread "
+             "builds its own todays market");
+    if (shareInitMarket_ && multiProcess_) {
+        LOG("Sharing init market between " << eff_nThreads << " worker processes.");
+    } else {
+        LOG("Cloning loaders for " << eff_nThreads << " threads...");
+        for (Size i = 0; i < eff_nThreads; ++i)
+            loaders[i] = QuantLib::ext::make_shared<ore::data::ClonedLoader>(today_, loader_);
+    }
 
-    LOG("Build " << eff_nThreads << " mini result cubes...");
-    miniCubes_.clear();
-    miniNettingSetCubes_.clear();
-    miniCptyCubes_.clear();
-    for (Size i = 0; i < eff_nThreads; ++i) {
-        miniCubes_.push_back(cubeFactory_(today_, portfolios[i]->ids(), dateGrid_->valuationDates(), nSamples_));
-        miniNettingSetCubes_.push_back(nettingSetCubeFactory_(today_, dateGrid_->valuationDates(), nSamples_));
-        miniCptyCubes_.push_back(
-            cptyCubeFactory_(today_, portfolios[i]->counterparties(), dateGrid_->valuationDates(), nSamples_));
+    // build nThreads mini-cubes to which each thread writes its results, in the NUMA-aware mode this is done in the
+    // worker threads after they are pinned to their node, worker processes write to copies of cubes built here
+
+    std::vector<std::vector<unsigned int>> workerCpus = numaWorkerCpus(eff_nThreads);
+    auto buildMiniCubes = [this, &portfolios](const Size i) {
+        miniCubes_[i] = cubeFactory_(today_, portfolios[i]->ids(), dateGrid_->valuationDates(), nSamples_);
+        miniNettingSetCubes_[i] = nettingSetCubeFactory_(today_, dateGrid_->valuationDates(), nSamples_);
+        miniCptyCubes_[i] =
+            cptyCubeFactory_(today_, portfolios[i]->counterparties(), dateGrid_->valuationDates(), nSamples_);
+    };
+
+    bool buildCubesInWorkers = !workerCpus.empty() && !multiProcess_;
+    LOG("Build " << eff_nThreads << " mini result cubes" << (buildCubesInWorkers ? " in the worker threads" : "")
+                 << "...");
+    miniCubes_.assign(eff_nThreads, nullptr);
+    miniNettingSetCubes_.assign(eff_nThreads, nullptr);
+    miniCptyCubes_.assign(eff_nThreads, nullptr);
+    if (!buildCubesInWorkers) {
+        for (Size i = 0; i < eff_nThreads; ++i)
+            buildMiniCubes(i);
     }
 
     // build progress indicator consolidating the results from the threads
@@ -252,17 +653,28 @@ void MultiThreadedValuationEngine::buildCube(
 
     std::vector<std::thread> jobs; // not needed if thread pool is used
 
+    // jobs to be run in worker processes
+    std::vector<std::function<resultType(int)>> processJobs;
+
     // pricing stats accumulated in worker threads
     std::vector<std::map<std::string, std::pair<std::size_t, boost::timer::nanosecond_type>>> workerPricingStats(
         eff_nThreads);
 
+    // sample times and per date pricing stats accumulated in worker threads
+    std::vector<std::vector<double>> workerSampleTimes(eff_nThreads);
+    std::vector<std::vector<Size>> workerDatePricings(eff_nThreads);
+    std::vector<std::vector<double>> workerDatePricingTimes(eff_nThreads);
+
     // get obs mode of main thread, so that we can set this mode in the worker threads below
     ore::analytics::ObservationMode::Mode obsMode = ore::analytics::ObservationMode::instance().mode();
 
     for (Size i = 0; i < eff_nThreads; ++i) {
 
         auto job = [this, obsMode, dryRun, &calculators, &cptyCalculators, mporStickyDate, &portfoliosAsString,
-                    &scenarioGenerators, &loaders, &workerPricingStats, &progressIndicator](int id) -> resultType {
+                    &scenarioGenerators, &loaders, &initMarket, &workerPricingStats, &workerSampleTimes,
+                    &workerDatePricings, &workerDatePricingTimes, &progressIndicator, &workerCpus, buildCubesInWorkers,
+                    &buildMiniCubes](int id) -> resultType {
+            ORE_TRACE_SCOPE("MultiThreadedValuationEngine::worker " + std::to_string(id));
             // set thread local singletons
 
             QuantLib::Settings::instance().evaluationDate() = today_;
@@ -274,19 +686,19 @@ void MultiThreadedValuationEngine::buildCube(
 
             try {
 
-                // build todays market using cloned market data
+                // pin the thread to its NUMA node and build the mini-cubes there (first touch)
 
-                QuantLib::ext::shared_ptr<ore::data::Market> initMarket = QuantLib::ext::make_shared<ore::data::TodaysMarket>(
-                    today_, todaysMarketParams_, loaders[id], curveConfigs_, true, true, true, referenceData_, false,
-                    iborFallbackConfig_, false, handlePseudoCurrenciesTodaysMarket_);
+                if (!workerCpus.empty()) {
+                    if (!ore::data::os::setThreadAffinity(workerCpus[id]))
+                        WLOG("Could not set the cpu affinity of thread " << id);
+                    if (buildCubesInWorkers)
+                        buildMiniCubes(id);
+                }
 
                 // build sim market
 
                 QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket> simMarket =
-                    QuantLib::ext::make_shared<ore::analytics::ScenarioSimMarket>(
-                        initMarket, simMarketData_, configuration_, *curveConfigs_, *todaysMarketParams_, true,
-                        useSpreadedTermStructures_, cacheSimData_, false, iborFallbackConfig_,
-                        handlePseudoCurrenciesSimMarket_, offsetScenario_);
+                    buildWorkerSimMarket(loaders[id], initMarket);
 
                 // set aggregation scenario data, but only in one of the sim markets, that's sufficient to populate it
 
@@ -318,7 +730,12 @@ void MultiThreadedValuationEngine::buildCube(
                     today_, dateGrid_, simMarket,
                     recalibrateModels_ ? engineFactory->modelBuilders()
                                        : std::set<std::pair<std::string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>>());
-                valEngine->registerProgressIndicator(progressIndicator);
+                // worker processes do not report progress, their copies of the indicators would write concurrently
+                if (!multiProcess_)
+                    valEngine->registerProgressIndicator(progressIndicator);
+                valEngine->skipUnaffectedTrades(skipUnaffectedTrades_);
+                valEngine->groupTradesByPricingEngine(groupTradesByPricingEngine_);
+                valEngine->skipExpiredTrades(skipExpiredTrades_);
 
                 // build mini-cube
 
@@ -334,6 +751,10 @@ void MultiThreadedValuationEngine::buildCube(
                     workerPricingStats[id][tid] =
                         std::make_pair(t->getNumberOfPricings(), t->getCumulativePricingTime());
 
+                workerSampleTimes[id] = valEngine->sampleTimes();
+                workerDatePricings[id] = valEngine->datePricings();
+                workerDatePricingTimes[id] = valEngine->datePricingTimes();
+
                 // return code 0 = ok
 
                 LOG("Thread " << id << " successfully finished.");
@@ -353,6 +774,11 @@ void MultiThreadedValuationEngine::buildCube(
             return rc;
         };
 
+        if (multiProcess_) {
+            processJobs.push_back(job);
+            continue;
+        }
+
         // results[i] = threadPool.push(job);
 
         // not needed if thread pool is used
@@ -362,21 +788,32 @@ void MultiThreadedValuationEngine::buildCube(
         jobs.emplace_back(std::move(thread));
     }
 
+    // run the jobs in worker processes, which write their results to shared memory, from where they are read back
+
+    std::vector<int> rcs(eff_nThreads, 0);
+    if (multiProcess_)
+        rcs = runWorkerProcesses(processJobs, portfolios, workerPricingStats, workerSampleTimes, workerDatePricings,
+                                 workerDatePricingTimes);
+
     // check return codes from jobs
 
     // not needed if thread pool is used
     for (auto& t : jobs)
         t.join();
 
-    for (Size i = 0; i < results.size(); ++i) {
+    for (Size i = 0; i < results.size() && !multiProcess_; ++i) {
         results[i].wait();
     }
 
-    for (Size i = 0; i < results.size(); ++i) {
+    for (Size i = 0; i < results.size() && !multiProcess_; ++i) {
         QL_REQUIRE(results[i].valid(), "internal error: did not get a valid result");
-        int rc = results[i].get();
-        QL_REQUIRE(rc == 0, "error: thread " << i << " exited with return code " << rc
-                                             << ". Check for structured errors from 'MultiThreaded Valuation Engine'.");
+        rcs[i] = results[i].get();
+    }
+
+    for (Size i = 0; i < rcs.size(); ++i) {
+        QL_REQUIRE(rcs[i] == 0, "error: " << (multiProcess_ ? "process " : "thread ") << i
+                                          << " exited with return code " << rcs[i]
+                                          << ". Check for structured errors from 'MultiThreaded Valuation Engine'.");
     }
 
     // stop the thread pool, wait for unfinished jobs
@@ -388,20 +825,16 @@ void MultiThreadedValuationEngine::buildCube(
 
     LOG("Update pricing stats of trades.");
 
-    for (auto const& [tid, t] : portfolio->trades()) {
-        auto p = pricingStats[tid];
-        std::size_t n = p.first;
-        boost::timer::nanosecond_type d = p.second;
-        for (auto const& w : workerPricingStats) {
-            auto p = w.find(tid);
-            if (p != w.end()) {
-                n += p->second.first;
-                d += p->second.second;
-            }
-        }
-        t->resetPricingStats(n, d);
+    updatePricingStats(portfolio, pricingStats, workerPricingStats);
+
+    sampleTimes_.assign(nSamples_, 0.0);
+    for (auto const& w : workerSampleTimes) {
+        for (Size j = 0; j < std::min(w.size(), sampleTimes_.size()); ++j)
+            sampleTimes_[j] += w[j];
     }
 
+    setDatePricingStats(workerDatePricings, workerDatePricingTimes);
+
     // log timings and return the result mini-cubes
 
     LOG("MultiThreadedValuationEngine::buildCube() successfully finished, timings: "
@@ -410,5 +843,437 @@ void MultiThreadedValuationEngine::buildCube(
         << static_cast<double>(timer.elapsed().system) / 1.0E9 << "s System.");
 }
 
+std::vector<int> MultiThreadedValuationEngine::runWorkerProcesses(
+    const std::vector<std::function<int(int)>>& jobs,
+    const std::vector<QuantLib::ext::shared_ptr<ore::data::Portfolio>>& portfolios,
+    std::vector<PricingStats>& workerPricingStats, std::vector<std::vector<double>>& workerSampleTimes,
+    std::vector<std::vector<Size>>& workerDatePricings, std::vector<std::vector<double>>& workerDatePricingTimes) {
+
+    // the aggregation scenario data is populated by worker 0, its values are transferred for all keys it can write
+
+    std::vector<std::pair<AggregationScenarioDataType, std::string>> asdKeys;
+    Size asdSize = 0;
+    if (aggregationScenarioData_) {
+        asdKeys = aggregationScenarioDataKeys(*simMarketData_);
+        asdSize = aggregationScenarioData_->dimDates() * aggregationScenarioData_->dimSamples();
+    }
+
+    /* layout of the results of worker i: mini-cube, netting set cube, cpty cube, (number of pricings, pricing time)
+       per trade, sample times, (pricings, pricing time) per valuation date, (flag, values) per asd key for worker 0 */
+
+    Size nDates = dateGrid_->valuationDates().size();
+    std::vector<std::unique_ptr<SharedBuffer>> buffers;
+    Size totalSize = 0;
+    for (Size i = 0; i < jobs.size(); ++i) {
+        Size n = cubeBufferSize(miniCubes_[i]) + cubeBufferSize(miniNettingSetCubes_[i]) +
+                 cubeBufferSize(miniCptyCubes_[i]) + 2 * portfolios[i]->size() + nSamples_ + 2 * nDates;
+        if (i == 0)
+            n += asdKeys.size() * (1 + asdSize);
+        buffers.push_back(std::make_unique<SharedBuffer>(n));
+        totalSize += n;
+    }
+
+    LOG("Run " << jobs.size() << " workers in forked processes, shared result memory "
+               << static_cast<double>(totalSize * sizeof(double)) / 1024.0 / 1024.0 << " MB");
+
+    auto rcs = ore::data::os::runForkedProcesses(jobs.size(), [&](const std::size_t i) {
+        int rc = jobs[i](static_cast<int>(i));
+        if (rc != 0)
+            return rc;
+        double* p = buffers[i]->data();
+        writeCube(miniCubes_[i], p);
+        writeCube(miniNettingSetCubes_[i], p);
+        writeCube(miniCptyCubes_[i], p);
+        for (auto const& id : portfolios[i]->ids()) {
+            auto s = workerPricingStats[i].find(id);
+            *p++ = s == workerPricingStats[i].end() ? 0.0 : static_cast<double>(s->second.first);
+            *p++ = s == workerPricingStats[i].end() ? 0.0 : static_cast<double>(s->second.second);
+        }
+        for (Size j = 0; j < nSamples_; ++j)
+            *p++ = j < workerSampleTimes[i].size() ? workerSampleTimes[i][j] : 0.0;
+        for (Size j = 0; j < nDates; ++j) {
+            *p++ = j < workerDatePricings[i].size() ? static_cast<double>(workerDatePricings[i][j]) : 0.0;
+            *p++ = j < workerDatePricingTimes[i].size() ? workerDatePricingTimes[i][j] : 0.0;
+        }
+        if (i == 0) {
+            for (auto const& [type, qualifier] : asdKeys) {
+                bool has = aggregationScenarioData_->has(type, qualifier);
+                *p++ = has ? 1.0 : 0.0;
+                for (Size d = 0; d < aggregationScenarioData_->dimDates(); ++d) {
+                    for (Size s = 0; s < aggregationScenarioData_->dimSamples(); ++s)
+                        *p++ = has ? aggregationScenarioData_->get(d, s, type, qualifier) : 0.0;
+                }
+            }
+        }
+        return 0;
+    });
+
+    // read back the results of the successful workers
+
+    for (Size i = 0; i < jobs.size(); ++i) {
+        if (rcs[i] != 0)
+            continue;
+        const double* p = buffers[i]->data();
+        readCube(miniCubes_[i], p);
+        readCube(miniNettingSetCubes_[i], p);
+        readCube(miniCptyCubes_[i], p);
+        for (auto const& id : portfolios[i]->ids()) {
+            std::size_t n = static_cast<std::size_t>(*p++);
+            boost::timer::nanosecond_type t = static_cast<boost::timer::nanosecond_type>(*p++);
+            workerPricingStats[i][id] = std::make_pair(n, t);
+        }
+        workerSampleTimes[i].assign(p, p + nSamples_);
+        p += nSamples_;
+        workerDatePricings[i].resize(nDates);
+        workerDatePricingTimes[i].resize(nDates);
+        for (Size j = 0; j < nDates; ++j) {
+            workerDatePricings[i][j] = static_cast<Size>(*p++);
+            workerDatePricingTimes[i][j] = *p++;
+        }
+        if (i == 0) {
+            for (auto const& [type, qualifier] : asdKeys) {
+                bool has = *p++ != 0.0;
+                for (Size d = 0; d < aggregationScenarioData_->dimDates(); ++d) {
+                    for (Size s = 0; s < aggregationScenarioData_->dimSamples(); ++s, ++p) {
+                        if (has)
+                            aggregationScenarioData_->set(d, s, *p, type, qualifier);
+                    }
+                }
+            }
+        }
+    }
+
+    return rcs;
+}
+
+std::vector<PricingStats> MultiThreadedValuationEngine::buildCubeWorkStealing(
+    const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+    const QuantLib::ext::shared_ptr<ore::data::Market>& initMarket,
+    const std::vector<std::pair<std::string, double>>& timings,
+    const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::ValuationCalculator>>()>& calculators,
+    const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::CounterpartyCalculator>>()>&
+        cptyCalculators,
+    bool mporStickyDate) {
+
+    boost::timer::cpu_timer timer;
+
+    // split the portfolio into trade blocks, the timings are sorted by decreasing avg pricing time
+
+    std::vector<QuantLib::ext::shared_ptr<ore::data::Portfolio>> blocks;
+    std::vector<double> blockAvgPricingTime;
+    for (Size i = 0; i < timings.size(); ++i) {
+        if (i % tradeBlockSize_ == 0) {
+            blocks.push_back(QuantLib::ext::make_shared<ore::data::Portfolio>());
+            blockAvgPricingTime.push_back(0.0);
+        }
+        blocks.back()->add(portfolio->get(timings[i].first));
+        blockAvgPricingTime.back() += timings[i].second;
+    }
+
+    std::vector<std::string> blocksAsString;
+    for (auto const& p : blocks)
+        blocksAsString.emplace_back(p->toXMLString());
+
+    // split the samples into ranges
+
+    Size sampleBlockSize = sampleBlockSize_ == 0 ? nSamples_ : std::min(sampleBlockSize_, nSamples_);
+    Size nSampleRanges = (nSamples_ + sampleBlockSize - 1) / sampleBlockSize;
+    Size nUnits = blocks.size() * nSampleRanges;
+    Size eff_nThreads = std::min(nUnits, nThreads_);
+
+    LOG("Work stealing: " << blocks.size() << " trade blocks of (at most) " << tradeBlockSize_ << " trades, "
+                          << nSampleRanges << " sample ranges of (at most) " << sampleBlockSize << " samples, "
+                          << nUnits << " units, " << eff_nThreads << " workers.");
+    for (Size b = 0; b < blocks.size(); ++b)
+        DLOG("Block #" << b << ": " << blocks[b]->size() << " trades, total avg pricing time "
+                       << blockAvgPricingTime[b] / 1E6 << " ms");
+
+    /* distribute the units over the worker queues: all units of a block go to the same worker, so that a block is
+       built against as few sim markets as possible, the blocks are assigned round robin in order of decreasing
+       pricing time. The agg scen data is populated assuming a sequential traversal of the samples, therefore the units
+       of the first block are pinned to the first worker, which populates the agg scen data only while valuing them. */
+
+    WorkStealingQueues queues(eff_nThreads);
+    for (Size b = 0; b < blocks.size(); ++b) {
+        for (Size r = 0; r < nSampleRanges; ++r) {
+            queues.push(b % eff_nThreads,
+                        WorkUnit{b, r * sampleBlockSize, std::min((r + 1) * sampleBlockSize, nSamples_)},
+                        b == 0 && aggregationScenarioData_ != nullptr);
+        }
+    }
+
+    // build scenario generators and loaders for each worker, the init market is not shared between worker threads
+
+    if (shareInitMarket_)
+        WLOG("MultiThreadedValuationEngine: the init market is only shared with worker processes, each worker thread "
+             "builds its own todays market");
+    LOG("Cloning scenario generators and loaders for " << eff_nThreads << " workers...");
+    std::vector<QuantLib::ext::shared_ptr<ore::analytics::ClonedScenarioGenerator>> scenarioGenerators;
+    scenarioGenerators.push_back(QuantLib::ext::make_shared<ore::analytics::ClonedScenarioGenerator>(
+        scenarioGenerator_, dateGrid_->dates(), nSamples_));
+    for (Size i = 1; i < eff_nThreads; ++i)
+        scenarioGenerators.push_back(
+            QuantLib::ext::make_shared<ore::analytics::ClonedScenarioGenerator>(*scenarioGenerators.front()));
+    std::vector<QuantLib::ext::shared_ptr<ore::data::ClonedLoader>> loaders(eff_nThreads);
+    for (Size i = 0; i < eff_nThreads; ++i)
+        loaders[i] = QuantLib::ext::make_shared<ore::data::ClonedLoader>(today_, loader_);
+
+    // build one result cube per trade block, each unit of a block is valued into a copy of its samples, which is
+    // merged back into the block cube under the lock of the block; in the NUMA-aware mode the cubes of a block are
+    // built by the worker whose queue holds the block, after it is pinned to its node, the workers only start to
+    // process units once all cubes are built
+
+    std::vector<std::vector<unsigned int>> workerCpus = numaWorkerCpus(eff_nThreads);
+    auto buildBlockCubes = [this, &blocks](const Size b) {
+        miniCubes_[b] = cubeFactory_(today_, blocks[b]->ids(), dateGrid_->valuationDates(), nSamples_);
+        miniNettingSetCubes_[b] = nettingSetCubeFactory_(today_, dateGrid_->valuationDates(), nSamples_);
+        miniCptyCubes_[b] =
+            cptyCubeFactory_(today_, blocks[b]->counterparties(), dateGrid_->valuationDates(), nSamples_);
+    };
+
+    LOG("Build " << blocks.size() << " result cubes" << (workerCpus.empty() ? "" : " in the worker threads")
+                 << "...");
+    miniCubes_.assign(blocks.size(), nullptr);
+    miniNettingSetCubes_.assign(blocks.size(), nullptr);
+    miniCptyCubes_.assign(blocks.size(), nullptr);
+    if (workerCpus.empty()) {
+        for (Size b = 0; b < blocks.size(); ++b)
+            buildBlockCubes(b);
+    }
+    std::vector<BlockState> blockStates(blocks.size());
+    std::mutex cubesMutex;
+    std::condition_variable cubesBuilt;
+    Size workersWithCubes = 0;
+    bool cubesFailed = false;
+
+    // run the workers
+
+    workerStats_ = std::vector<WorkerStats>(eff_nThreads);
+    std::vector<PricingStats> workerPricingStats(eff_nThreads);
+    std::vector<std::vector<double>> workerSampleTimes(eff_nThreads, std::vector<double>(nSamples_, 0.0));
+    std::vector<std::vector<Size>> workerDatePricings(eff_nThreads,
+                                                      std::vector<Size>(dateGrid_->valuationDates().size(), 0));
+    std::vector<std::vector<double>> workerDatePricingTimes(
+        eff_nThreads, std::vector<double>(dateGrid_->valuationDates().size(), 0.0));
+    ore::analytics::ObservationMode::Mode obsMode = ore::analytics::ObservationMode::instance().mode();
+
+    std::mutex progressMutex;
+    Size unitsDone = 0;
+
+    auto job = [this, obsMode, &calculators, &cptyCalculators, mporStickyDate, &blocksAsString, &queues,
+                &scenarioGenerators, &loaders, &initMarket, &workerPricingStats, &workerSampleTimes,
+                &workerDatePricings, &workerDatePricingTimes, &progressMutex, &unitsDone, nUnits, &workerCpus,
+                &buildBlockCubes, &blockStates, &cubesMutex, &cubesBuilt, &workersWithCubes, &cubesFailed,
+                nBlocks = blocks.size(), eff_nThreads](Size id) -> int {
+        ORE_TRACE_SCOPE("MultiThreadedValuationEngine::worker " + std::to_string(id));
+        QuantLib::Settings::instance().evaluationDate() = today_;
+        ore::analytics::ObservationMode::instance().setMode(obsMode);
+
+        LOG("Start worker " << id);
+
+        boost::timer::cpu_timer workerTimer;
+        boost::timer::cpu_timer unitTimer;
+        auto& stats = workerStats_[id];
+
+        // pin the worker to its NUMA node and build the cubes of the blocks in its queue there (first touch), all
+        // workers wait until all cubes are built, since units may be stolen by other workers
+
+        if (!workerCpus.empty()) {
+            if (!ore::data::os::setThreadAffinity(workerCpus[id]))
+                WLOG("Could not set the cpu affinity of worker " << id);
+            bool failed = false;
+            try {
+                for (Size b = id; b < nBlocks; b += eff_nThreads)
+                    buildBlockCubes(b);
+            } catch (const std::exception& e) {
+                ore::analytics::StructuredAnalyticsErrorMessage("Multithreaded Valuation Engine", "", e.what()).log();
+                failed = true;
+            }
+            std::unique_lock<std::mutex> lock(cubesMutex);
+            cubesFailed = cubesFailed || failed;
+            if (++workersWithCubes == eff_nThreads)
+                cubesBuilt.notify_all();
+            else
+                cubesBuilt.wait(lock, [&workersWithCubes, eff_nThreads] { return workersWithCubes == eff_nThreads; });
+            if (cubesFailed) {
+                stats.wallTime = static_cast<double>(workerTimer.elapsed().wall) / 1.0E9;
+                return 1;
+            }
+        }
+
+        int rc;
+
+        try {
+
+            // build the sim market
+
+            unitTimer.start();
+
+            auto simMarket = buildWorkerSimMarket(loaders[id], initMarket);
+
+            simMarket->scenarioGenerator() = scenarioGenerators[id];
+
+            if (scenarioFilter_)
+                simMarket->filter() = scenarioFilter_;
+
+            stats.setupTime += static_cast<double>(unitTimer.elapsed().wall) / 1.0E9;
+
+            // trade blocks built against the sim market of this worker, with their engine factories
+
+            std::map<Size, std::pair<QuantLib::ext::shared_ptr<ore::data::Portfolio>,
+                                     QuantLib::ext::shared_ptr<ore::data::EngineFactory>>>
+                builtBlocks;
+
+            WorkUnit unit;
+            bool stolen;
+            while (queues.pop(id, unit, stolen)) {
+
+                TLOG("Worker " << id << " processes block " << unit.block << ", samples " << unit.firstSample
+                               << " to " << unit.endSample << (stolen ? " (stolen)" : ""));
+
+                // build the trade block, if not done yet
+
+                auto b = builtBlocks.find(unit.block);
+                if (b == builtBlocks.end()) {
+                    unitTimer.start();
+                    auto blockPortfolio = QuantLib::ext::make_shared<ore::data::Portfolio>();
+                    blockPortfolio->fromXMLString(blocksAsString[unit.block]);
+                    auto engineFactory = QuantLib::ext::make_shared<ore::data::EngineFactory>(
+                        engineData_, simMarket, std::map<ore::data::MarketContext, string>(), referenceData_,
+                        iborFallbackConfig_);
+                    blockPortfolio->build(engineFactory, context_, true);
+                    b = builtBlocks.insert(std::make_pair(unit.block, std::make_pair(blockPortfolio, engineFactory)))
+                            .first;
+                    ++stats.builtBlocks;
+                    stats.setupTime += static_cast<double>(unitTimer.elapsed().wall) / 1.0E9;
+                }
+
+                // value the unit into copies of the samples of the block cubes
+
+                unitTimer.start();
+
+                auto& blockState = blockStates[unit.block];
+                QuantLib::ext::shared_ptr<SampleRangeCube> unitCube, unitNettingSetCube, unitCptyCube;
+                {
+                    std::lock_guard<std::mutex> lock(blockState.mutex);
+                    unitCube = QuantLib::ext::make_shared<SampleRangeCube>(miniCubes_[unit.block], unit.firstSample,
+                                                                           unit.endSample);
+                    if (miniNettingSetCubes_[unit.block])
+                        unitNettingSetCube = QuantLib::ext::make_shared<SampleRangeCube>(
+                            miniNettingSetCubes_[unit.block], unit.firstSample, unit.endSample);
+                    if (miniCptyCubes_[unit.block])
+                        unitCptyCube = QuantLib::ext::make_shared<SampleRangeCube>(miniCptyCubes_[unit.block],
+                                                                                   unit.firstSample, unit.endSample);
+                }
+
+                // the pricing stats of the block trades before the unit, the stats are merged per unit
+
+                std::vector<std::pair<std::size_t, boost::timer::nanosecond_type>> statsBefore;
+                for (auto const& [tid, t] : b->second.first->trades())
+                    statsBefore.push_back(std::make_pair(t->getNumberOfPricings(), t->getCumulativePricingTime()));
+
+                simMarket->aggregationScenarioData() =
+                    unit.block == 0 ? aggregationScenarioData_ : QuantLib::ext::shared_ptr<AggregationScenarioData>();
+                scenarioGenerators[id]->setNextSample(unit.firstSample);
+
+                auto valEngine = QuantLib::ext::make_shared<ore::analytics::ValuationEngine>(
+                    today_, dateGrid_, simMarket,
+                    recalibrateModels_
+                        ? b->second.second->modelBuilders()
+                        : std::set<std::pair<std::string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>>());
+                valEngine->setSampleRange(unit.firstSample, unit.endSample);
+                valEngine->skipUnaffectedTrades(skipUnaffectedTrades_);
+                valEngine->groupTradesByPricingEngine(groupTradesByPricingEngine_);
+                valEngine->skipExpiredTrades(skipExpiredTrades_);
+                valEngine->buildCube(b->second.first, unitCube, calculators(), mporStickyDate, unitNettingSetCube,
+                                     unitCptyCube,
+                                     cptyCalculators ? cptyCalculators()
+                                                     : std::vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>>(),
+                                     false);
+
+                {
+                    std::lock_guard<std::mutex> lock(blockState.mutex);
+                    unitCube->merge(blockState.removedIds);
+                    if (unitNettingSetCube)
+                        unitNettingSetCube->merge(blockState.removedNettingSetIds);
+                    if (unitCptyCube)
+                        unitCptyCube->merge(blockState.removedCptyIds);
+                }
+
+                Size tradeIndex = 0;
+                for (auto const& [tid, t] : b->second.first->trades()) {
+                    auto& s = workerPricingStats[id][tid];
+                    s.first += t->getNumberOfPricings() - statsBefore[tradeIndex].first;
+                    s.second += t->getCumulativePricingTime() - statsBefore[tradeIndex].second;
+                    ++tradeIndex;
+                }
+
+                stats.busyTime += static_cast<double>(unitTimer.elapsed().wall) / 1.0E9;
+                ++stats.units;
+                for (Size j = unit.firstSample; j < std::min(unit.endSample, valEngine->sampleTimes().size()); ++j)
+                    workerSampleTimes[id][j] += valEngine->sampleTimes()[j];
+                for (Size j = 0; j < std::min(workerDatePricings[id].size(), valEngine->datePricings().size()); ++j) {
+                    workerDatePricings[id][j] += valEngine->datePricings()[j];
+                    workerDatePricingTimes[id][j] += valEngine->datePricingTimes()[j];
+                }
+                if (stolen)
+                    ++stats.stolenUnits;
+
+                // report progress on the level of units
+
+                {
+                    std::lock_guard<std::mutex> lock(progressMutex);
+                    updateProgress(++unitsDone, nUnits);
+                }
+            }
+
+            simMarket->aggregationScenarioData() = QuantLib::ext::shared_ptr<AggregationScenarioData>();
+
+            LOG("Worker " << id << " successfully finished.");
+
+            rc = 0;
+
+        } catch (const std::exception& e) {
+
+            ore::analytics::StructuredAnalyticsErrorMessage("Multithreaded Valuation Engine", "", e.what()).log();
+            rc = 1;
+        }
+
+        stats.wallTime = static_cast<double>(workerTimer.elapsed().wall) / 1.0E9;
+        return rc;
+    };
+
+    std::vector<std::future<int>> results;
+    for (Size i = 0; i < eff_nThreads; ++i)
+        results.push_back(std::async(std::launch::async, job, i));
+
+    for (Size i = 0; i < results.size(); ++i) {
+        int rc = results[i].get();
+        QL_REQUIRE(rc == 0, "error: worker " << i << " exited with return code " << rc
+                                             << ". Check for structured errors from 'MultiThreaded Valuation Engine'.");
+    }
+
+    sampleTimes_.assign(nSamples_, 0.0);
+    for (auto const& w : workerSampleTimes) {
+        for (Size j = 0; j < nSamples_; ++j)
+            sampleTimes_[j] += w[j];
+    }
+
+    setDatePricingStats(workerDatePricings, workerDatePricingTimes);
+
+    // log utilisation of the workers
+
+    double wall = static_cast<double>(timer.elapsed().wall) / 1.0E9;
+    for (Size i = 0; i < workerStats_.size(); ++i) {
+        auto const& w = workerStats_[i];
+        LOG("Worker #" << i << ": units " << w.units << " (stolen " << w.stolenUnits << "), blocks built "
+                       << w.builtBlocks << ", setup " << w.setupTime << "s, busy " << w.busyTime << "s, wall "
+                       << w.wallTime << "s, utilisation "
+                       << (wall > 0.0 ? 100.0 * (w.setupTime + w.busyTime) / wall : 0.0) << "%");
+    }
+
+    return workerPricingStats;
+}
+
 } // namespace analytics
 } // namespace ore
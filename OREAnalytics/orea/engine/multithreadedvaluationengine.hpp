@@ -31,11 +31,32 @@
 #include <ored/configuration/curveconfigurations.hpp>
 #include <ored/marketdata/loader.hpp>
 
+#include <boost/timer/timer.hpp>
+
+#include <functional>
+#include <mutex>
+
 namespace ore {
 namespace analytics {
 
 class MultiThreadedValuationEngine : public ore::data::ProgressReporter {
 public:
+    //! statistics on one worker thread of a buildCube() run using work stealing
+    struct WorkerStats {
+        //! number of (trade block, sample range) units processed by this worker
+        QuantLib::Size units = 0;
+        //! number of units stolen from the queues of other workers
+        QuantLib::Size stolenUnits = 0;
+        //! number of trade blocks built against the sim market of this worker
+        QuantLib::Size builtBlocks = 0;
+        //! time spent building the markets and the trade blocks (seconds)
+        double setupTime = 0.0;
+        //! time spent valuing units (seconds)
+        double busyTime = 0.0;
+        //! total wall time of the worker (seconds)
+        double wallTime = 0.0;
+    };
+
     /* if no cube factories are given, we create default ones as follows
        - cubeFactory          : creates DoublePrecisionInMemoryCube
        - nettingSetCubeFactory: creates nullptr
@@ -72,6 +93,74 @@ public:
     // can be optionally called to set the agg scen data (which is done in the ssm for single-threaded runs)
     void setAggregationScenarioData(const QuantLib::ext::shared_ptr<AggregationScenarioData>& aggregationScenarioData);
 
+    /* can be optionally called to replace the static split of the portfolio into nThreads parts by a task based
+       scheduling: the portfolio is split into blocks of tradeBlockSize trades (in order of decreasing pricing time)
+       and the samples into ranges of sampleBlockSize samples (0 = all samples). The resulting (trade block, sample
+       range) units are distributed over the worker queues, idle workers steal units from the queues of the other
+       workers. There is one output cube per trade block: each unit is valued into a copy of its samples, which is
+       merged into the block cube under a lock of the block, the t0 values are taken from the unit starting at the
+       first sample. The block cubes are thus never written concurrently, so that cubes which are not safe for
+       concurrent writes, e.g. a SparseNpvCube or a JointNPVCube on one (see createSinglePrecisionCube()), can be
+       used. The pricing stats are accumulated per unit. Dry runs always use the static split. */
+    void setWorkStealing(const QuantLib::Size tradeBlockSize, const QuantLib::Size sampleBlockSize = 0);
+
+    /* can be optionally called to build the todays market once and share it with the worker processes: by default
+       each worker clones the loader and builds its own todays market, from which its sim market is built. If the init
+       market is shared, the todays market built in buildCube() for the pricing stats is used as the init market of
+       the sim markets of the worker processes instead, see setMultiProcess(). The children are copy-on-write copies
+       of the calling process, so the market data, the t0 curves and the fixings applied to the index manager of the
+       calling thread are built once, and each child calculates and modifies its own copy only.
+
+       Worker threads always build their own todays market, a warning is logged if this flag is set without the
+       multi-process mode. A market shared between threads would apply the loader fixings to the index manager of
+       the session building it only, and its lazy t0 objects would be calculated by the threads concurrently. This
+       mode can not be combined with spreaded term structures. */
+    void setShareInitMarket(const bool shareInitMarket);
+
+    /* can be optionally called to place the workers NUMA-aware: each worker is pinned to the cpus of one NUMA node
+       (socket), consecutive workers being placed on the same node, and allocates its result cubes itself after being
+       pinned, so that their memory is first touched and therefore placed on the node of the worker. The sim market
+       and the portfolio of a worker are built in the worker thread in any case. If work stealing is used, the cubes
+       of a trade block are allocated by the worker whose queue initially holds the block. If numaNodes > 0, only the
+       first numaNodes nodes are used, which allows to compare the scaling over a growing number of sockets. Pinning
+       is only supported on Linux, on other platforms the workers are not restricted. */
+    void setNumaAware(const bool numaAware, const QuantLib::Size numaNodes = 0);
+
+    /* can be optionally called to run the workers in forked child processes instead of threads: the children are
+       copy-on-write copies of the calling process, i.e. they see the todays market built for the pricing stats, the
+       portfolio split and the cloned scenario generators without serialising them, and do not share any singletons
+       or caches with each other, so that no session support is required in the build. Each child writes its
+       mini-cubes, pricing stats and (worker 0) aggregation scenario data into shared memory, from where they are
+       read back into the result cubes of this engine. The mini-cubes are allocated in the calling process. Work
+       stealing is not supported in this mode, the static split is used instead, and the progress of the workers is
+       not reported. Since only the calling thread is copied into the children, buildCube() throws if other threads
+       are running (e.g. an asynchronous logger). Only supported on platforms providing fork(). */
+    void setMultiProcess(const bool multiProcess);
+
+    // statistics per worker on the last buildCube() run, only populated if work stealing is used
+    const std::vector<WorkerStats>& workerStats() const { return workerStats_; }
+
+    /* can be optionally called to reprice only the trades affected by a scenario in the worker threads, see
+       ValuationEngine::skipUnaffectedTrades() */
+    void skipUnaffectedTrades(const bool b) { skipUnaffectedTrades_ = b; }
+
+    /* can be optionally called to group the trades by pricing engine in the worker threads, see
+       ValuationEngine::groupTradesByPricingEngine() */
+    void groupTradesByPricingEngine(const bool b) { groupTradesByPricingEngine_ = b; }
+
+    /* can be optionally called to skip the valuation of expired trades in the worker threads, see
+       ValuationEngine::skipExpiredTrades() */
+    void skipExpiredTrades(const bool b) { skipExpiredTrades_ = b; }
+
+    /* time in seconds spent on each sample in the last buildCube() run, summed over the threads, i.e. over the
+       parts of the portfolio processed in parallel */
+    const std::vector<double>& sampleTimes() const { return sampleTimes_; }
+
+    /* number of trade calculations and pricing time in seconds per valuation date in the last buildCube() run,
+       summed over the threads, see ValuationEngine::datePricings() and ValuationEngine::datePricingTimes() */
+    const std::vector<QuantLib::Size>& datePricings() const { return datePricings_; }
+    const std::vector<double>& datePricingTimes() const { return datePricingTimes_; }
+
     /* analoguous to buildCube() in the single-threaded engine, results are retrieved using below constructors
        if no cptyCalculators is given a function returning an empty vector of calculators will be returned */
     void
@@ -81,7 +170,18 @@ public:
                   cptyCalculators = {},
               bool mporStickyDate = true, bool dryRun = false);
 
-    // result output cubes (mini-cubes, one per thread)
+    /* analoguous to updateCube() in the single-threaded engine: the given trades are priced by buildCube() into
+       new mini-cubes, their values are then copied into the given output cube, which must contain all of the ids,
+       after the removal of the previous values. The ids of trades not in the portfolio are only removed. The
+       scenario generator must reproduce the scenarios of the original run. */
+    void
+    updateCube(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio, const std::set<std::string>& tradeIds,
+               const QuantLib::ext::shared_ptr<ore::analytics::NPVCube>& outputCube,
+               const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::ValuationCalculator>>()>&
+                   calculators,
+               bool mporStickyDate = true);
+
+    // result output cubes (mini-cubes, one per thread or one per trade block if work stealing is used)
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> outputCubes() const { return miniCubes_; }
 
     // result netting cubes (might be null, if nettingSetCubeFactory is returning null)
@@ -93,6 +193,38 @@ public:
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> outputCptyCubes() const { return miniCptyCubes_; }
 
 private:
+    /* build the sim market of a worker, on the todays market built from the given loader or, if the init market is
+       shared with worker processes, on the copy of the given init market in the worker process */
+    QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket>
+    buildWorkerSimMarket(const QuantLib::ext::shared_ptr<ore::data::Loader>& loader,
+                         const QuantLib::ext::shared_ptr<ore::data::Market>& initMarket) const;
+
+    std::vector<std::map<std::string, std::pair<std::size_t, boost::timer::nanosecond_type>>> buildCubeWorkStealing(
+        const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+        const QuantLib::ext::shared_ptr<ore::data::Market>& initMarket,
+        const std::vector<std::pair<std::string, double>>& timings,
+        const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::ValuationCalculator>>()>& calculators,
+        const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::CounterpartyCalculator>>()>&
+            cptyCalculators,
+        bool mporStickyDate);
+
+    /* run the jobs (one per portfolio part) in forked processes and read their results back from shared memory
+       into the mini-cubes, the worker stats and the aggregation scenario data, returns the exit codes of the jobs */
+    std::vector<int> runWorkerProcesses(
+        const std::vector<std::function<int(int)>>& jobs,
+        const std::vector<QuantLib::ext::shared_ptr<ore::data::Portfolio>>& portfolios,
+        std::vector<std::map<std::string, std::pair<std::size_t, boost::timer::nanosecond_type>>>& workerPricingStats,
+        std::vector<std::vector<double>>& workerSampleTimes,
+        std::vector<std::vector<QuantLib::Size>>& workerDatePricings,
+        std::vector<std::vector<double>>& workerDatePricingTimes);
+
+    /* the cpus of the NUMA node each of nWorkers workers is pinned to, empty if the engine is not NUMA-aware,
+       consecutive workers are placed on the same node */
+    std::vector<std::vector<unsigned int>> numaWorkerCpus(const QuantLib::Size nWorkers) const;
+
+    void setDatePricingStats(const std::vector<std::vector<QuantLib::Size>>& workerDatePricings,
+                             const std::vector<std::vector<double>>& workerDatePricingTimes);
+
     QuantLib::Size nThreads_;
     QuantLib::Date today_;
     QuantLib::ext::shared_ptr<ore::data::DateGrid> dateGrid_;
@@ -128,6 +260,19 @@ private:
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> miniCubes_;
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> miniNettingSetCubes_;
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> miniCptyCubes_;
+    QuantLib::Size tradeBlockSize_ = 0;
+    QuantLib::Size sampleBlockSize_ = 0;
+    bool shareInitMarket_ = false;
+    bool numaAware_ = false;
+    QuantLib::Size numaNodes_ = 0;
+    bool multiProcess_ = false;
+    std::vector<WorkerStats> workerStats_;
+    bool skipUnaffectedTrades_ = false;
+    bool groupTradesByPricingEngine_ = false;
+    bool skipExpiredTrades_ = false;
+    std::vector<double> sampleTimes_;
+    std::vector<QuantLib::Size> datePricings_;
+    std::vector<double> datePricingTimes_;
 };
 
 } // namespace analytics
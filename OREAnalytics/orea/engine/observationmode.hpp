@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <ored/utilities/log.hpp>
+
 #include <ql/patterns/observable.hpp>
 
 namespace ore {
@@ -64,5 +66,61 @@ public:
 private:
     Mode mode_;
 };
+
+inline std::ostream& operator<<(std::ostream& out, const ObservationMode::Mode m) {
+    switch (m) {
+    case ObservationMode::Mode::None:
+        return out << "None";
+    case ObservationMode::Mode::Disable:
+        return out << "Disable";
+    case ObservationMode::Mode::Defer:
+        return out << "Defer";
+    case ObservationMode::Mode::Unregister:
+        return out << "Unregister";
+    default:
+        QL_FAIL("Invalid ObservationMode " << static_cast<int>(m));
+    }
+}
+
+//! Scoped deferral of observer notifications
+/*! While an instance is alive, notifications are deferred by the QuantLib::ObservableSettings. release() enables the
+    updates again and updates each observer that was notified in the meantime exactly once, errors thrown by these
+    updates are rethrown. It should be called at the end of the scope. If it was not called, e.g. because the scope
+    is left by an exception, the destructor enables the updates and only logs errors of the deferred observers,
+    since it can not throw. If updates are already disabled or deferred on construction (e.g. under the Disable or
+    Defer observation mode), the instance does nothing, so that scopes can be nested.
+  \ingroup utilities
+ */
+class DeferredNotificationsScope {
+public:
+    DeferredNotificationsScope() : active_(QuantLib::ObservableSettings::instance().updatesEnabled()) {
+        if (active_)
+            QuantLib::ObservableSettings::instance().disableUpdates(true);
+    }
+    ~DeferredNotificationsScope() {
+        if (!active_)
+            return;
+        try {
+            release();
+        } catch (const std::exception& e) {
+            ALOG("DeferredNotificationsScope: error while notifying deferred observers: " << e.what());
+        }
+    }
+    //! enable the updates and notify the deferred observers, throws if one of them throws
+    void release() {
+        if (!active_)
+            return;
+        active_ = false;
+        QuantLib::ObservableSettings::instance().enableUpdates();
+    }
+    DeferredNotificationsScope(const DeferredNotificationsScope&) = delete;
+    DeferredNotificationsScope& operator=(const DeferredNotificationsScope&) = delete;
+
+    //! true if this instance deferred the notifications and release() was not called yet
+    bool active() const { return active_; }
+
+private:
+    bool active_;
+};
 } // namespace analytics
 } // namespace ore
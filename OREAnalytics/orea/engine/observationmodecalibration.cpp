@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/observationmodecalibration.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using QuantLib::Real;
+using QuantLib::Size;
+
+namespace ore {
+namespace analytics {
+
+Real maxRelativeDifference(const NPVCube& reference, const NPVCube& cube) {
+    if (reference.idsAndIndexes() != cube.idsAndIndexes() || reference.numDates() != cube.numDates() ||
+        reference.samples() != cube.samples() || reference.depth() != cube.depth())
+        return QL_MAX_REAL;
+    auto diff = [](const Real x, const Real y) { return std::abs(x - y) / std::max(1.0, std::abs(x)); };
+    Real result = 0.0;
+    for (Size i = 0; i < reference.numIds(); ++i) {
+        for (Size d = 0; d < reference.depth(); ++d) {
+            result = std::max(result, diff(reference.getT0(i, d), cube.getT0(i, d)));
+            for (Size j = 0; j < reference.numDates(); ++j) {
+                for (Size k = 0; k < reference.samples(); ++k)
+                    result = std::max(result, diff(reference.get(i, j, k, d), cube.get(i, j, k, d)));
+            }
+        }
+    }
+    return result;
+}
+
+Size fastestConsistentRun(const std::vector<ObservationModeCalibrationRun>& runs) {
+    QL_REQUIRE(!runs.empty(), "fastestConsistentRun(): no runs given");
+    Size result = 0;
+    for (Size i = 1; i < runs.size(); ++i) {
+        if (runs[i].consistent && (!runs[result].consistent || runs[i].estimatedTime < runs[result].estimatedTime))
+            result = i;
+    }
+    return result;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,58 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/observationmodecalibration.hpp
+    \brief comparison of valuation engine runs under the different observation modes
+    \ingroup engine
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <orea/engine/observationmode.hpp>
+
+#include <ql/types.hpp>
+
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Result of a calibration run of the valuation engine on a sample portfolio under one observation mode
+struct ObservationModeCalibrationRun {
+    ObservationMode::Mode mode = ObservationMode::Mode::None;
+    //! build time of the simulation market and the sample portfolio and pricing time of the samples in seconds
+    QuantLib::Real simMarketBuildTime = 0.0, portfolioBuildTime = 0.0, pricingTime = 0.0;
+    //! the above times extrapolated to the full run in seconds, set by the caller
+    QuantLib::Real estimatedTime = 0.0;
+    //! largest relative difference to the values of the reference run, see maxRelativeDifference()
+    QuantLib::Real maxDifference = 0.0;
+    //! false if the run failed or its values differ from the reference run
+    bool consistent = true;
+};
+
+/*! largest difference between the T0 and future values of two cubes, relative to max(1, |reference value|), or
+    QL_MAX_REAL if the cubes differ in their ids or dimensions */
+QuantLib::Real maxRelativeDifference(const NPVCube& reference, const NPVCube& cube);
+
+/*! index of the consistent run with the smallest estimated time, the first run is the reference run, which is used
+    if there is no consistent run */
+QuantLib::Size fastestConsistentRun(const std::vector<ObservationModeCalibrationRun>& runs);
+
+} // namespace analytics
+} // namespace ore
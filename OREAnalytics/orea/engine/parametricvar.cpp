@@ -75,12 +75,11 @@ ostream& operator<<(ostream& out, const ParametricVarCalculator::ParametricVarPa
     }
 }
 
-Real ParametricVarCalculator::var(Real confidence, const bool isCall, 
-    const set<pair<string, Size>>& tradeIds) {
+void ParametricVarCalculator::sensitivities(const bool isCall, Array& delta, Matrix& gamma) const {
     Real factor = isCall ? 1.0 : -1.0;
 
-    Array delta(deltas_.size(), 0.0);
-    Matrix gamma(deltas_.size(), deltas_.size(), 0.0);
+    delta = Array(deltas_.size(), 0.0);
+    gamma = Matrix(deltas_.size(), deltas_.size(), 0.0);
 
     if (includeDeltaMargin_) {
         Size counter = 0;
@@ -105,36 +104,68 @@ Real ParametricVarCalculator::var(Real confidence, const bool isCall,
             outerIdx++;
         }
     }
+}
+
+const QuantExt::CovarianceSalvage& ParametricVarCalculator::salvage() {
+    if (!cachedSalvage_ || cachedSalvage_->underlying() != covarianceSalvage_)
+        cachedSalvage_ = QuantLib::ext::make_shared<QuantExt::CachedCovarianceSalvage>(covarianceSalvage_);
+    return *cachedSalvage_;
+}
+
+Real ParametricVarCalculator::var(Real confidence, const bool isCall, 
+    const set<pair<string, Size>>& tradeIds) {
+    Array delta;
+    Matrix gamma;
+    sensitivities(isCall, delta, gamma);
+    const QuantExt::CovarianceSalvage& sal = salvage();
 
     if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::Delta)
-        return QuantExt::deltaVar(omega_, delta, confidence, *covarianceSalvage_);
+        return QuantExt::deltaVar(omega_, delta, confidence, sal);
     else if (parametricVarParams_.method ==
                 ParametricVarCalculator::ParametricVarParams::Method::DeltaGammaNormal)
-        return QuantExt::deltaGammaVarNormal(omega_, delta, gamma, confidence, *covarianceSalvage_);
+        return QuantExt::deltaGammaVarNormal(omega_, delta, gamma, confidence, sal);
     else if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::MonteCarlo) {
         QL_REQUIRE(parametricVarParams_.samples != Null<Size>(),
                     "ParametricVarCalculator::computeVar(): method MonteCarlo requires mcSamples");
         QL_REQUIRE(parametricVarParams_.seed != Null<Size>(),
                     "ParametricVarCalculator::computeVar(): method MonteCarlo requires mcSamples");
         return QuantExt::deltaGammaVarMc<PseudoRandom>(omega_, delta, gamma, confidence, parametricVarParams_.samples,
-                                                        parametricVarParams_.seed, *covarianceSalvage_);
+                                                        parametricVarParams_.seed, sal);
     } else if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::CornishFisher)
-        return QuantExt::deltaGammaVarCornishFisher(omega_, delta, gamma, confidence, *covarianceSalvage_);
+        return QuantExt::deltaGammaVarCornishFisher(omega_, delta, gamma, confidence, sal);
     else if (parametricVarParams_.method == ParametricVarCalculator::ParametricVarParams::Method::Saddlepoint) {
         Real res;
         try {
-            res = QuantExt::deltaGammaVarSaddlepoint(omega_, delta, gamma, confidence, *covarianceSalvage_);
+            res = QuantExt::deltaGammaVarSaddlepoint(omega_, delta, gamma, confidence, sal);
         } catch (const std::exception& e) {
             ALOG("Saddlepoint VaR computation exited with an error: " << e.what()
                                                                         << ", falling back on Monte-Carlo");
             res = QuantExt::deltaGammaVarMc<PseudoRandom>(omega_, delta, gamma, confidence,
-                parametricVarParams_.samples, parametricVarParams_.seed, *covarianceSalvage_);
+                parametricVarParams_.samples, parametricVarParams_.seed, sal);
         }        
         return res;
     } else
         QL_FAIL("ParametricVarCalculator::computeVar(): method " << parametricVarParams_.method << " not known.");
 }
 
+vector<Real> ParametricVarCalculator::vars(const vector<Real>& confidences, const bool isCall,
+                                           const set<pair<string, Size>>& tradeIds) {
+    if (parametricVarParams_.method != ParametricVarCalculator::ParametricVarParams::Method::MonteCarlo ||
+        confidences.empty())
+        return VarCalculator::vars(confidences, isCall, tradeIds);
+
+    // one simulation for all confidence levels, this gives the same result as separate simulations with the same seed
+    QL_REQUIRE(parametricVarParams_.samples != Null<Size>(),
+               "ParametricVarCalculator::computeVar(): method MonteCarlo requires mcSamples");
+    QL_REQUIRE(parametricVarParams_.seed != Null<Size>(),
+               "ParametricVarCalculator::computeVar(): method MonteCarlo requires mcSamples");
+    Array delta;
+    Matrix gamma;
+    sensitivities(isCall, delta, gamma);
+    return QuantExt::deltaGammaVarMc<PseudoRandom>(omega_, delta, gamma, confidences, parametricVarParams_.samples,
+                                                   parametricVarParams_.seed, salvage());
+}
+
 ParametricVarReport::ParametricVarReport(const std::string& baseCurrency, const ext::shared_ptr<Portfolio>& portfolio,
                                          const string& portfolioFilter,
                                          const vector<Real>& p,
@@ -79,7 +79,18 @@ public:
     QuantLib::Real var(QuantLib::Real confidence, const bool isCall = true, 
         const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
 
+    /*! for the MonteCarlo method the P&L is simulated once for all confidence levels, for the other methods var() is
+        called for each level */
+    std::vector<QuantLib::Real> vars(const std::vector<QuantLib::Real>& confidences, const bool isCall = true,
+                                     const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) override;
+
 private:
+    //! delta vector and gamma matrix, with the sign depending on isCall
+    void sensitivities(const bool isCall, QuantLib::Array& delta, QuantLib::Matrix& gamma) const;
+    /*! the covariance salvage, cached for the last covariance matrix, so that the matrix is only salvaged once if it
+        is shared by several confidence levels or breakdowns */
+    const QuantExt::CovarianceSalvage& salvage();
+
     const ParametricVarParams& parametricVarParams_;
     const QuantLib::Matrix& omega_;
     const std::map<RiskFactorKey, QuantLib::Real>& deltas_;
@@ -87,6 +98,7 @@ private:
     const QuantLib::ext::shared_ptr<QuantExt::CovarianceSalvage>& covarianceSalvage_;
     const bool& includeGammaMargin_;
     const bool& includeDeltaMargin_;
+    QuantLib::ext::shared_ptr<QuantExt::CachedCovarianceSalvage> cachedSalvage_;
 };
 
 //! Parametric VaR Calculator
@@ -100,6 +100,12 @@ ParSensitivityAnalysis::ParSensitivityAnalysis(const Date& asof,
                                                            continueOnError_, marketConfiguration_, nullptr);
 }
 
+void ParSensitivityAnalysis::createParInstruments(const QuantLib::ext::shared_ptr<ScenarioSimMarket>& simMarket) {
+    ParSensitivityInstrumentBuilder().createParInstruments(instruments_, asof_, simMarketParams_, sensitivityData_,
+                                                           typesDisabled_, parTypes_, relevantRiskFactors_,
+                                                           continueOnError_, marketConfiguration_, simMarket);
+}
+
 void ParSensitivityAnalysis::augmentRelevantRiskFactors() {
     LOG("Augment relevant risk factors, starting with " << relevantRiskFactors_.size() << " risk factors.");
     std::set<ore::analytics::RiskFactorKey> addFactors1 = relevantRiskFactors_, addFactors2, tmp;
@@ -300,17 +306,25 @@ void ParSensitivityAnalysis::computeParInstrumentSensitivities(const QuantLib::e
         parKeysCheck.insert(p.first);
     }
 
-    for (Size i = 1; i < scenarioGenerator->samples(); ++i) {
+    Size appliedScenarios = 0, parInstrumentValuations = 0;
 
-        simMarket->update(asof_);
+    for (Size i = 1; i < scenarioGenerator->samples(); ++i) {
 
         // use single "UP" shift scenarios only, use only scenarios relevant for par instruments,
         // use relevant scenarios only, if specified
         // ignore risk factor types that have been disabled
+        // the other scenarios are skipped without applying them to the sim market, which saves the market updates
+        // for the down and cross gamma scenarios, that make up the majority of the scenarios
         if (desc[i].type() != ShiftScenarioGenerator::ScenarioDescription::Type::Up ||
             !isParType(desc[i].key1().keytype) || typesDisabled_.count(desc[i].key1().keytype) == 1 ||
-            !(relevantRiskFactors_.empty() || relevantRiskFactors_.find(desc[i].key1()) != relevantRiskFactors_.end()))
+            !(relevantRiskFactors_.empty() ||
+              relevantRiskFactors_.find(desc[i].key1()) != relevantRiskFactors_.end())) {
+            scenarioGenerator->next(asof_);
             continue;
+        }
+
+        simMarket->update(asof_);
+        ++appliedScenarios;
 
         // Since we are not using ValuationEngine we need to manually perform the trade updates here
         // TODO - explore means of utilising valuation engine
@@ -353,6 +367,7 @@ void ParSensitivityAnalysis::computeParInstrumentSensitivities(const QuantLib::e
             // compute fair and base quotes
 
             Real fair = impliedQuote(p.second);
+            ++parInstrumentValuations;
             auto base = parRatesBase.find(p.first);
             QL_REQUIRE(base != parRatesBase.end(), "internal error: did not find parRatesBase[" << p.first << "]");
 
@@ -391,6 +406,7 @@ void ParSensitivityAnalysis::computeParInstrumentSensitivities(const QuantLib::e
                 continue;
 
             auto fair = impliedVolatility(p.first, instruments_);
+            ++parInstrumentValuations;
             auto base = parCapVols.find(p.first);
             QL_REQUIRE(base != parCapVols.end(), "internal error: did not find parCapVols[" << p.first << "]");
 
@@ -419,6 +435,7 @@ void ParSensitivityAnalysis::computeParInstrumentSensitivities(const QuantLib::e
                 continue;
 
             auto fair = impliedVolatility(p.first, instruments_);
+            ++parInstrumentValuations;
             auto base = parCapVols.find(p.first);
             QL_REQUIRE(base != parCapVols.end(), "internal error: did not find parCapVols[" << p.first << "]");
 
@@ -441,6 +458,10 @@ void ParSensitivityAnalysis::computeParInstrumentSensitivities(const QuantLib::e
 
     } // end of loop over samples
 
+    LOG("Applied " << appliedScenarios << " of " << scenarioGenerator->samples() - 1
+                   << " shift scenarios, computed " << parInstrumentValuations << " par instrument valuations for "
+                   << parKeysCheck.size() << " par instruments");
+
     // check for
     // a) par instruments which have no sensitivity to any of the risk factors
     // b) risk factors w.r.t. which no par instrument has a sensitivity
@@ -805,6 +826,17 @@ ParSensitivityConverter::convertSensitivity(const boost::numeric::ublas::vector<
     return parSensitivities;
 }
 
+std::vector<std::vector<std::pair<Size, Real>>> ParSensitivityConverter::conversionMatrixColumns() const {
+    std::vector<std::vector<std::pair<Size, Real>>> columns(jacobi_transp_inv_.size2());
+    for (auto i1 = jacobi_transp_inv_.begin1(); i1 != jacobi_transp_inv_.end1(); ++i1) {
+        for (auto i2 = i1.begin(); i2 != i1.end(); ++i2) {
+            if (*i2 != 0.0)
+                columns[i2.index2()].push_back(std::make_pair(i2.index1(), *i2));
+        }
+    }
+    return columns;
+}
+
 void ParSensitivityConverter::writeConversionMatrix(Report& report) const {
 
     // Report headers
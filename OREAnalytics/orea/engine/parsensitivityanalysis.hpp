@@ -68,9 +68,17 @@ public:
 
     virtual ~ParSensitivityAnalysis() {}
 
-    //! Compute par instrument sensitivities
+    /*! Compute par instrument sensitivities
+
+        The Jacobian of the par rates w.r.t. the zero risk factors is computed by finite differences from the
+        single up shift scenarios, i.e. with the same shifts as the zero sensitivities it is combined with.
+        Down, cross gamma and irrelevant scenarios are skipped without applying them to the sim market. */
     void computeParInstrumentSensitivities(const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket>& simMarket);
 
+    /*! Create the par instruments on the given sim market without computing the par sensitivities, e.g. to
+        evaluate the par rates on a second sim market built from the same parameters */
+    void createParInstruments(const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket>& simMarket);
+
     //! Return computed par sensitivities. Empty if they have not been computed yet.
     const ParContainer& parSensitivities() const { return parSensi_; }
 
@@ -203,6 +211,14 @@ public:
     //! Write the inverse of the transposed Jacobian to the \p reportOut
     void writeConversionMatrix(ore::data::Report& reportOut) const;
 
+    /*! The non-zero entries (par index, value) of the inverse of the transposed Jacobian by column, i.e. by raw index.
+        Due to the block structure of the Jacobian a column only has entries for the par keys of the same curve. */
+    std::vector<std::vector<std::pair<QuantLib::Size, QuantLib::Real>>> conversionMatrixColumns() const;
+    //! Absolute zero shift sizes ordered according to rawKeys()
+    const boost::numeric::ublas::vector<QuantLib::Real>& zeroShifts() const { return zeroShifts_; }
+    //! Absolute par shift sizes ordered according to parKeys()
+    const boost::numeric::ublas::vector<QuantLib::Real>& parShifts() const { return parShifts_; }
+
     ParSensitivityAnalysis::ParContainer inverseJacobian() const { ParSensitivityAnalysis::ParContainer results;
         Size parIdx = 0;
         for (const auto& parKey : parKeys_) {
@@ -29,8 +29,9 @@ namespace analytics {
 
 // Note: iterator initialisation below works because currentDeltas_ is
 //       (empty) initialised before itCurrent_
-ParSensitivityCubeStream::ParSensitivityCubeStream(const QuantLib::ext::shared_ptr<ZeroToParCube>& cube, const string& currency)
-    : zeroCubeIdx_(0), cube_(cube), currency_(currency), itCurrent_(currentDeltas_.begin()) {
+ParSensitivityCubeStream::ParSensitivityCubeStream(const QuantLib::ext::shared_ptr<ZeroToParCube>& cube,
+                                                   const string& currency, const QuantLib::Size nThreads)
+    : zeroCubeIdx_(0), cube_(cube), currency_(currency), nThreads_(nThreads), itCurrent_(currentDeltas_.begin()) {
     QL_REQUIRE(!cube_->zeroCubes().empty(), "ParSensitivityCubeStream: cube contains no zero cubes");
     tradeIdx_ = cube_->zeroCubes().front()->tradeIdx().begin();
     init();
@@ -46,7 +47,7 @@ SensitivityRecord ParSensitivityCubeStream::next() {
         // update par deltas
         if (tradeIdx_ != cube_->zeroCubes()[zeroCubeIdx_]->tradeIdx().end()) {
             DLOG("Retrieving par deltas for trade " << tradeIdx_->first);
-            currentDeltas_ = cube_->parDeltas(zeroCubeIdx_, tradeIdx_->second);
+            currentDeltas_ = parDeltas_[tradeIdx_->second];
             itCurrent_ = currentDeltas_.begin();
             DLOG("There are " << currentDeltas_.size() << " par deltas for trade " << tradeIdx_->first);
         }
@@ -91,9 +92,14 @@ void ParSensitivityCubeStream::reset() {
 void ParSensitivityCubeStream::init() {
     // If we have trade IDs in the underlying cube
     if (!cube_->zeroCubes()[zeroCubeIdx_]->tradeIdx().empty()) {
+        // Convert all trades of the current zero cube at once
+        if (parDeltasCubeIdx_ != zeroCubeIdx_) {
+            parDeltas_ = cube_->allParDeltas(zeroCubeIdx_, nThreads_);
+            parDeltasCubeIdx_ = zeroCubeIdx_;
+        }
         tradeIdx_ = cube_->zeroCubes()[zeroCubeIdx_]->tradeIdx().begin();
         DLOG("Retrieving par deltas for trade " << tradeIdx_->first);
-        currentDeltas_ = cube_->parDeltas(zeroCubeIdx_, tradeIdx_->second);
+        currentDeltas_ = parDeltas_[tradeIdx_->second];
         itCurrent_ = currentDeltas_.begin();
         DLOG("There are " << currentDeltas_.size() << " par deltas for trade " << tradeIdx_->first);
     }
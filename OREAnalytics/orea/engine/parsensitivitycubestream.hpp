@@ -34,8 +34,10 @@ namespace analytics {
  */
 class ParSensitivityCubeStream : public ore::analytics::SensitivityStream {
 public:
-    /*! Constructor providing the sensitivity \p cube and currency of the sensitivities */
-    ParSensitivityCubeStream(const QuantLib::ext::shared_ptr<ZeroToParCube>& cube, const std::string& currency);
+    /*! Constructor providing the sensitivity \p cube and currency of the sensitivities, the par deltas of all trades of
+        a zero cube are converted at once using \p nThreads threads */
+    ParSensitivityCubeStream(const QuantLib::ext::shared_ptr<ZeroToParCube>& cube, const std::string& currency,
+                             const QuantLib::Size nThreads = 1);
 
     /*! Returns the next SensitivityRecord in the stream
 
@@ -55,6 +57,11 @@ private:
     std::string currency_;
     //! TradeId and index of current trade ID in the underlying cube
     std::map<std::string, QuantLib::Size>::const_iterator tradeIdx_;
+    //! Number of threads for the par conversion
+    QuantLib::Size nThreads_;
+    //! Par deltas for all trades of the zero cube with index parDeltasCubeIdx_, by trade index
+    std::vector<std::map<ore::analytics::RiskFactorKey, QuantLib::Real>> parDeltas_;
+    QuantLib::Size parDeltasCubeIdx_ = QuantLib::Null<QuantLib::Size>();
     //! Par deltas for current trade ID
     std::map<ore::analytics::RiskFactorKey, QuantLib::Real> currentDeltas_;
     //! Iterator to current delta
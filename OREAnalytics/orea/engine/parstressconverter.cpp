@@ -23,6 +23,13 @@
 #include <orea/engine/parstressscenarioconverter.hpp>
 #include <orea/scenario/deltascenariofactory.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
+#include <orea/engine/observationmode.hpp>
+#include <qle/math/chunkworkers.hpp>
+
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <mutex>
 
 namespace ore {
 namespace analytics {
@@ -80,10 +87,10 @@ ParStressTestConverter::ParStressTestConverter(
     const QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData>& sensiScenarioData,
     const QuantLib::ext::shared_ptr<ore::data::CurveConfigurations>& curveConfigs,
     const QuantLib::ext::shared_ptr<ore::data::Market>& todaysMarket,
-    const QuantLib::ext::shared_ptr<ore::data::IborFallbackConfig>& iborFallbackConfig)
+    const QuantLib::ext::shared_ptr<ore::data::IborFallbackConfig>& iborFallbackConfig, const QuantLib::Size nThreads)
     : asof_(asof), todaysMarketParams_(todaysMarketParams), simMarketParams_(simMarketParams),
       sensiScenarioData_(sensiScenarioData), curveConfigs_(curveConfigs), todaysMarket_(todaysMarket),
-      iborFallbackConfig_(iborFallbackConfig) {}
+      iborFallbackConfig_(iborFallbackConfig), nThreads_(nThreads) {}
 
 QuantLib::ext::shared_ptr<ore::analytics::StressTestScenarioData> ParStressTestConverter::convertStressScenarioData(
     const QuantLib::ext::shared_ptr<ore::analytics::StressTestScenarioData>& stressTestData) const {
@@ -109,28 +116,91 @@ QuantLib::ext::shared_ptr<ore::analytics::StressTestScenarioData> ParStressTestC
         DLOG(keyType);
     }
     LOG("ParStressConverter: Compute Par Sensitivities")
-    auto [simMarket, parAnalysis] = computeParSensitivity(disabledRiskFactors);
+    auto parSensitivity = computeParSensitivity(disabledRiskFactors);
+    auto simMarket = parSensitivity.first;
+    auto parAnalysis = parSensitivity.second;
     // Loop over scenarios
     LOG("ParStressConverter: Build dependency graph of par instruments")
     auto dependencyGraph = sortParRiskFactorByDependency(parAnalysis->parSensitivities());
-    ParStressScenarioConverter converter(asof_, dependencyGraph, simMarketParams_, sensiScenarioData_, simMarket,
-                                         parAnalysis->parInstruments(), stressTestData->useSpreadedTermStructures());
-
-    for (const auto& scenario : stressTestData->data()) {
-        DLOG("ParStressConverter: Scenario" << scenario.label);
-        if (scenario.containsParShifts()) {
-            try {
-                LOG("ParStressConverter: Scenario " << scenario.label << " Convert par shifts to zero shifts");
-                auto convertedScenario = converter.convertScenario(scenario);
-                results->data().push_back(std::move(convertedScenario));
-            } catch (const std::exception& e) {
-                StructuredAnalyticsWarningMessage("ParStressConversion", "ScenarioConversionFailed",
-                                                  "Skip Scenario " + scenario.label + ", got :" + e.what())
-                    .log();
-            }
-        } else {
-            LOG("ParStressConverter: Skip scenario " << scenario.label << ", it contains only zero shifts");
-            results->data().push_back(scenario);
+
+    const auto& scenarios = stressTestData->data();
+    std::vector<Size> parScenarios;
+    for (Size i = 0; i < scenarios.size(); ++i) {
+        if (scenarios[i].containsParShifts())
+            parScenarios.push_back(i);
+    }
+
+    // converted scenarios by index in the stress test data, not set if the conversion failed
+    std::vector<boost::optional<StressTestScenarioData::StressTestData>> converted(scenarios.size());
+    auto convert = [&scenarios, &converted](const ParStressScenarioConverter& converter, const Size i) {
+        const auto& scenario = scenarios[i];
+        try {
+            LOG("ParStressConverter: Scenario " << scenario.label << " Convert par shifts to zero shifts");
+            converted[i] = converter.convertScenario(scenario);
+        } catch (const std::exception& e) {
+            StructuredAnalyticsWarningMessage("ParStressConversion", "ScenarioConversionFailed",
+                                              "Skip Scenario " + scenario.label + ", got :" + e.what())
+                .log();
+        }
+    };
+
+    Size nThreads = std::min(nThreads_, parScenarios.size());
+#ifndef QL_ENABLE_SESSIONS
+    if (nThreads > 1) {
+        WLOG("ParStressConverter: nThreads = " << nThreads_
+                                               << " requires a build with QL_ENABLE_SESSIONS = ON, scenarios are "
+                                                  "converted sequentially.");
+        nThreads = 1;
+    }
+#endif
+
+    if (nThreads <= 1) {
+        ParStressScenarioConverter converter(asof_, dependencyGraph, simMarketParams_, sensiScenarioData_, simMarket,
+                                             parAnalysis->parInstruments(),
+                                             stressTestData->useSpreadedTermStructures(),
+                                             parAnalysis->parSensitivities());
+        for (auto i : parScenarios)
+            convert(converter, i);
+    } else {
+        // each thread converts scenarios on its own sim market and par instruments, the par sensitivities and the
+        // aligned sim market parameters are shared, the thread local singletons are initialised from this thread
+        LOG("ParStressConverter: Convert " << parScenarios.size() << " scenarios on " << nThreads << " threads");
+        Date evaluationDate = Settings::instance().evaluationDate();
+        ObservationMode::Mode obsMode = ObservationMode::instance().mode();
+        std::map<std::string, TimeSeries<Real>> fixings;
+        for (auto const& name : IndexManager::instance().histories())
+            fixings[name] = IndexManager::instance().getHistory(name);
+        std::atomic<Size> next{0};
+        std::mutex setupMutex;
+        QuantExt::ChunkWorkers workers(nThreads);
+        workers.run(nThreads, [&](const Size) {
+            Settings::instance().evaluationDate() = evaluationDate;
+            ObservationMode::instance().setMode(obsMode);
+            for (auto const& [name, history] : fixings)
+                IndexManager::instance().setHistory(name, history);
+            // the sim market and par instruments are built one thread at a time, since they share the parameters
+            std::unique_lock<std::mutex> setupLock(setupMutex);
+            auto threadSimMarket = buildSimMarket();
+            ParSensitivityAnalysis threadParAnalysis(asof_, simMarketParams_, *sensiScenarioData_,
+                                                     Market::defaultConfiguration, true, disabledRiskFactors);
+            threadParAnalysis.createParInstruments(threadSimMarket);
+            setupLock.unlock();
+            ParStressScenarioConverter converter(asof_, dependencyGraph, simMarketParams_, sensiScenarioData_,
+                                                 threadSimMarket, threadParAnalysis.parInstruments(),
+                                                 stressTestData->useSpreadedTermStructures(),
+                                                 parAnalysis->parSensitivities());
+            for (Size k = next++; k < parScenarios.size(); k = next++)
+                convert(converter, parScenarios[k]);
+        });
+    }
+
+    for (Size i = 0; i < scenarios.size(); ++i) {
+        DLOG("ParStressConverter: Scenario" << scenarios[i].label);
+        if (!scenarios[i].containsParShifts()) {
+            LOG("ParStressConverter: Skip scenario " << scenarios[i].label << ", it contains only zero shifts");
+            results->data().push_back(scenarios[i]);
+        } else if (converted[i]) {
+            results->data().push_back(std::move(*converted[i]));
         }
     }
     return results;
@@ -158,12 +228,7 @@ ParStressTestConverter::computeParSensitivity(const std::set<RiskFactorKey::KeyT
             simMarketParams_->setCapFloorVolAdjustOptionletPillars(true);
         }
     }
-    LOG("ParStressConverter: Build SimMarket");
-    auto simMarket = QuantLib::ext::make_shared<ScenarioSimMarket>(
-        todaysMarket_, simMarketParams_, Market::defaultConfiguration,
-        curveConfigs_ ? *curveConfigs_ : ore::data::CurveConfigurations(),
-        todaysMarketParams_ ? *todaysMarketParams_ : ore::data::TodaysMarketParameters(), false,
-        sensiScenarioData_->useSpreadedTermStructures(), false, true, *iborFallbackConfig_);
+    auto simMarket = buildSimMarket();
     LOG("ParStressConverter: Build ScenarioGenerator");
     auto scnearioFactory = QuantLib::ext::make_shared<ore::analytics::DeltaScenarioFactory>(simMarket->baseScenario());
     auto scenarioGenerator = QuantLib::ext::make_shared<SensitivityScenarioGenerator>(
@@ -175,6 +240,15 @@ ParStressTestConverter::computeParSensitivity(const std::set<RiskFactorKey::KeyT
     return {simMarket, parAnalysis};
 }
 
+QuantLib::ext::shared_ptr<ScenarioSimMarket> ParStressTestConverter::buildSimMarket() const {
+    LOG("ParStressConverter: Build SimMarket");
+    return QuantLib::ext::make_shared<ScenarioSimMarket>(
+        todaysMarket_, simMarketParams_, Market::defaultConfiguration,
+        curveConfigs_ ? *curveConfigs_ : ore::data::CurveConfigurations(),
+        todaysMarketParams_ ? *todaysMarketParams_ : ore::data::TodaysMarketParameters(), false,
+        sensiScenarioData_->useSpreadedTermStructures(), false, true, *iborFallbackConfig_);
+}
+
 } // namespace analytics
 
 } // namespace ore
\ No newline at end of file
@@ -36,6 +36,9 @@
 namespace ore {
 namespace analytics {
 
+/*! Converts the par shifts of all scenarios of a stress test to zero shifts. If nThreads > 1, the scenarios are
+    converted in parallel, each thread using its own sim market and par instruments. This requires a build with
+    QL_ENABLE_SESSIONS = ON, otherwise the scenarios are converted sequentially. */
 class ParStressTestConverter {
 public:
     ParStressTestConverter(
@@ -44,7 +47,8 @@ public:
         const QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData>& sensiScenarioData,
         const QuantLib::ext::shared_ptr<ore::data::CurveConfigurations>& curveConfigs,
         const QuantLib::ext::shared_ptr<ore::data::Market>& todaysMarket,
-        const QuantLib::ext::shared_ptr<ore::data::IborFallbackConfig>& iborFallbackConfig);
+        const QuantLib::ext::shared_ptr<ore::data::IborFallbackConfig>& iborFallbackConfig,
+        const QuantLib::Size nThreads = 1);
 
     //! Convert all par shifts to zero shifts for all scenarios defined in the stresstest
     QuantLib::ext::shared_ptr<ore::analytics::StressTestScenarioData> convertStressScenarioData(
@@ -56,6 +60,9 @@ public:
     computeParSensitivity(const std::set<RiskFactorKey::KeyType>& typesDisabled) const;
 
 private:
+    //! Creates a SimMarket on the aligned sim market parameters
+    QuantLib::ext::shared_ptr<ScenarioSimMarket> buildSimMarket() const;
+
     //! get a set of risk factors which will be interpreted as zero rate shifts
     std::set<RiskFactorKey::KeyType> zeroRateRiskFactors(bool irCurveParRates, bool irCapFloorParRates,
                                                          bool creditParRates) const;
@@ -67,6 +74,7 @@ private:
     QuantLib::ext::shared_ptr<ore::data::CurveConfigurations> curveConfigs_;
     QuantLib::ext::shared_ptr<ore::data::Market> todaysMarket_;
     QuantLib::ext::shared_ptr<ore::data::IborFallbackConfig> iborFallbackConfig_;
+    QuantLib::Size nThreads_;
 };
 
 } // namespace analytics
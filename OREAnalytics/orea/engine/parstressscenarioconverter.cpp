@@ -24,6 +24,8 @@
 #include <ql/instruments/capfloor.hpp>
 #include <ored/portfolio/structuredconfigurationwarning.hpp>
 
+#include <cmath>
+
 namespace ore {
 namespace analytics {
 
@@ -315,10 +317,16 @@ ParStressScenarioConverter::ParStressScenarioConverter(
     const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& simMarketParams,
     const QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData>& sensiScenarioData,
     const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket>& simMarket,
-    const ore::analytics::ParSensitivityInstrumentBuilder::Instruments& parInstruments, bool useSpreadedTermStructure)
+    const ore::analytics::ParSensitivityInstrumentBuilder::Instruments& parInstruments, bool useSpreadedTermStructure,
+    const ore::analytics::ParSensitivityAnalysis::ParContainer& parSensitivities)
     : asof_(asof), sortedParInstrumentRiskFactorKeys_(sortedParInstrumentRiskFactorKeys),
       simMarketParams_(simMarketParams), sensiScenarioData_(sensiScenarioData), simMarket_(simMarket),
-      parInstruments_(parInstruments), useSpreadedTermStructure_(useSpreadedTermStructure) {}
+      parInstruments_(parInstruments), useSpreadedTermStructure_(useSpreadedTermStructure) {
+    for (const auto& [key, value] : parSensitivities) {
+        if (!QuantLib::close_enough(value, 0.0))
+            parSensitivities_[key.first].push_back({key.second, value});
+    }
+}
 
 ore::analytics::StressTestScenarioData::StressTestData
 ParStressScenarioConverter::convertScenario(const StressTestScenarioData::StressTestData& parStressScenario) const {
@@ -382,30 +390,57 @@ ParStressScenarioConverter::convertScenario(const StressTestScenarioData::Stress
     // Optimize IR curves and Credit curves
     LOG("ParStressConverter: Imply zero shifts");
     std::map<RiskFactorKey, double> shifts;
+    Size evaluations = 0, newtonSolves = 0;
     for (const auto& rfKey : relevantParKeys) {
         DLOG("Imply zero shifts for parInstrument " << rfKey);
         const double target = targets[rfKey];
-        auto targetFunction = [this, &target, &rfKey, &zeroSimMarketScenario](double x) {
+        auto targetFunction = [this, &target, &rfKey, &zeroSimMarketScenario, &evaluations](double x) {
             zeroSimMarketScenario->add(rfKey, x);
             simMarket_->applyScenario(zeroSimMarketScenario);
+            ++evaluations;
             return (impliedParRate(rfKey) - target) * 1e6;
         };
-        double targetValue;
-        Brent brent;
-        try {
-            DLOG("ParStressConverter: Try to imply zero rate" << rfKey << " with bounds << " << lowerBound(rfKey) << ","
-                                                              << upperBound(rfKey));
-            targetValue =
-                brent.solve(targetFunction, accuracy_, baseScenarioValues[rfKey], lowerBound(rfKey), upperBound(rfKey));
-        } catch (const std::exception& e) {
-            ALOG("ParStressConverter: Couldn't find a solution to imply a zero rate for parRate " << rfKey << ", got "
-                                                                                                  << e.what());
-            targetValue = simMarket_->baseScenario()->get(rfKey);
+        double targetValue = Null<double>();
+        // warm start from the linear solution given the zero shifts implied for the preceding par instruments
+        auto sensi = parSensitivities_.find(rfKey);
+        if (sensi != parSensitivities_.end()) {
+            double parShift = target - fairRates[rfKey];
+            double diagonal = 0.0;
+            for (const auto& [zeroKey, value] : sensi->second) {
+                if (zeroKey == rfKey)
+                    diagonal = value;
+                else if (auto s = shifts.find(zeroKey); s != shifts.end())
+                    parShift -= value * s->second;
+            }
+            if (!QuantLib::close_enough(diagonal, 0.0)) {
+                double guess = scenarioValueForShift(rfKey, parShift / diagonal, baseScenarioValues[rfKey]);
+                DLOG("ParStressConverter: Try to imply zero rate " << rfKey << " with Newton steps from guess "
+                                                                   << guess);
+                targetValue = solveNewton(targetFunction, rfKey, guess, diagonal);
+                if (targetValue != Null<double>())
+                    ++newtonSolves;
+            }
+        }
+        if (targetValue == Null<double>()) {
+            Brent brent;
+            try {
+                DLOG("ParStressConverter: Try to imply zero rate" << rfKey << " with bounds << " << lowerBound(rfKey)
+                                                                  << "," << upperBound(rfKey));
+                targetValue = brent.solve(targetFunction, accuracy_, baseScenarioValues[rfKey], lowerBound(rfKey),
+                                          upperBound(rfKey));
+            } catch (const std::exception& e) {
+                ALOG("ParStressConverter: Couldn't find a solution to imply a zero rate for parRate "
+                     << rfKey << ", got " << e.what());
+                targetValue = simMarket_->baseScenario()->get(rfKey);
+            }
         }
         zeroSimMarketScenario->add(rfKey, targetValue);
         shifts[rfKey] = shiftsSizeForScenario(rfKey, targetValue, baseScenarioValues[rfKey]);
         updateTargetStressTestScenarioData(zeroStressScenario, rfKey, shifts[rfKey]);
     }
+    LOG("ParStressConverter: Scenario " << parStressScenario.label << " implied " << relevantParKeys.size()
+                                        << " zero shifts (" << newtonSolves << " by Newton steps) with "
+                                        << evaluations << " par rate evaluations");
     simMarket_->applyScenario(zeroSimMarketScenario);
     DLOG("ParStressConverter: Implied Scenario");
     DLOG("parInstrument;fairRate;targetFairRate;zeroBaseValue;shift");
@@ -494,6 +529,50 @@ double ParStressScenarioConverter::shiftsSizeForScenario(const RiskFactorKey rfK
     return shift;
 }
 
+double ParStressScenarioConverter::scenarioValueForShift(const RiskFactorKey rfKey, double shift,
+                                                         double baseValue) const {
+    switch (rfKey.keytype) {
+    case RiskFactorKey::KeyType::DiscountCurve:
+    case RiskFactorKey::KeyType::YieldCurve:
+    case RiskFactorKey::KeyType::IndexCurve:
+    case RiskFactorKey::KeyType::SurvivalProbability:
+        return (useSpreadedTermStructure_ ? 1.0 : baseValue) * std::exp(-shift * maturityTime(rfKey));
+    case RiskFactorKey::KeyType::OptionletVolatility:
+        return (useSpreadedTermStructure_ ? 0.0 : baseValue) + shift;
+    default:
+        QL_FAIL("ScenarioValueForShift: Unsupported par instruments type " << rfKey.keytype);
+    }
+}
+
+double ParStressScenarioConverter::solveNewton(const std::function<double(double)>& targetFunction,
+                                               const RiskFactorKey& rfKey, double guess, double derivative) const {
+    const double lower = lowerBound(rfKey), upper = upperBound(rfKey);
+    if (!std::isfinite(guess) || guess < lower || guess > upper)
+        return Null<double>();
+    // the target function is scaled by 1e6, the derivative w.r.t. the zero shift is converted to the scenario value
+    double x = guess, fx = targetFunction(x);
+    double dfdx = derivative * 1e6;
+    if (rfKey.keytype != RiskFactorKey::KeyType::OptionletVolatility)
+        dfdx /= -maturityTime(rfKey) * x;
+    for (Size i = 0; i < maxNewtonIterations_; ++i) {
+        if (std::abs(fx) < accuracy_)
+            return x;
+        if (!std::isfinite(dfdx) || QuantLib::close_enough(dfdx, 0.0))
+            return Null<double>();
+        double xNew = x - fx / dfdx;
+        if (!std::isfinite(xNew) || xNew < lower || xNew > upper)
+            return Null<double>();
+        if (std::abs(xNew - x) < accuracy_)
+            return xNew;
+        double fxNew = targetFunction(xNew);
+        // secant update of the derivative for the next step
+        dfdx = (fxNew - fx) / (xNew - x);
+        x = xNew;
+        fx = fxNew;
+    }
+    return std::abs(fx) < accuracy_ ? x : Null<double>();
+}
+
 double ParStressScenarioConverter::impliedParRate(const RiskFactorKey& key) const {
     if (key.keytype == RiskFactorKey::KeyType::OptionletVolatility) {
         return impliedVolatility(key, parInstruments_);
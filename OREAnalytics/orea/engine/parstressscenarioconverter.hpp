@@ -33,6 +33,8 @@
 #include <ored/marketdata/market.hpp>
 #include <ored/marketdata/todaysmarketparameters.hpp>
 
+#include <functional>
+
 namespace ore {
 namespace analytics {
 
@@ -40,6 +42,11 @@ namespace analytics {
 std::set<RiskFactorKey::KeyType> disabledParRates(bool irCurveParRates, bool irCapFloorParRates, bool creditParRates);
 
 //! Convert all par shifts in a single stress test scenario to zero shifts
+/*! The zero shifts are implied par instrument by par instrument in the order of their dependencies. If the par
+    sensitivities w.r.t. the zero shifts are given, the solver for each par instrument starts from the linear
+    solution given the zero shifts implied for the preceding par instruments and uses Newton / secant steps, falling
+    back to a bracketing Brent solver if these do not converge. Without par sensitivities, the Brent solver is used
+    with the base scenario value as the initial guess. */
 class ParStressScenarioConverter {
 public:
     ParStressScenarioConverter(
@@ -48,7 +55,8 @@ public:
         const QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData>& sensiScenarioData,
         const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket>& simMarket,
         const ore::analytics::ParSensitivityInstrumentBuilder::Instruments& parInstruments,
-        bool useSpreadedTermStructure);
+        bool useSpreadedTermStructure,
+        const ore::analytics::ParSensitivityAnalysis::ParContainer& parSensitivities = {});
 
     //! Convert par shifts in a stress scenario to zero shifts
     ore::analytics::StressTestScenarioData::StressTestData
@@ -66,6 +74,14 @@ private:
     //! convert the scenario value to the corresponding zero shift size for the stress test data
     double shiftsSizeForScenario(const RiskFactorKey rfKey, double targetValue, double baseValue) const;
 
+    //! inverse of shiftsSizeForScenario(), convert a zero shift size to the scenario value
+    double scenarioValueForShift(const RiskFactorKey rfKey, double shift, double baseValue) const;
+
+    /*! imply the scenario value matching the target par rate with Newton / secant steps starting from the given
+        guess, returns null if the iteration does not converge within the bounds */
+    double solveNewton(const std::function<double(double)>& targetFunction, const RiskFactorKey& rfKey, double guess,
+                       double derivative) const;
+
     //! add zero shifts in the stress test data
     void updateTargetStressTestScenarioData(StressTestScenarioData::StressTestData& stressScenario,
                                             const RiskFactorKey& key, const double zeroShift) const;
@@ -86,12 +102,15 @@ private:
     mutable QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket> simMarket_;
     const ore::analytics::ParSensitivityInstrumentBuilder::Instruments& parInstruments_;
     bool useSpreadedTermStructure_ = true;
+    // par sensitivities w.r.t. zero shifts by par instrument
+    std::map<RiskFactorKey, std::vector<std::pair<RiskFactorKey, double>>> parSensitivities_;
 
     double minVol_ = 1e-8;
     double maxVol_ = 10.0;
     double minDiscountFactor_ = 1e-8;
     double maxDiscountFactor_ = 10.0;
     double accuracy_ = 1e-8;
+    Size maxNewtonIterations_ = 10;
 };
 } // namespace analytics
 } // namespace ore
\ No newline at end of file
@@ -103,8 +103,10 @@ std::set<MarketRiskConfiguration::RiskType> MarketRiskConfiguration::riskTypes(b
     return result;
 }
 
-RiskFilter::RiskFilter(const MarketRiskConfiguration::RiskClass& riskClass, const MarketRiskConfiguration::RiskType& riskType) {
+namespace {
 
+// The key types covered by the risk type All
+const std::set<RiskFactorKey::KeyType>& listedKeyTypes() {
     static const std::set<RiskFactorKey::KeyType> all = {RiskFactorKey::KeyType::DiscountCurve,
                                                          RiskFactorKey::KeyType::YieldCurve,
                                                          RiskFactorKey::KeyType::IndexCurve,
@@ -125,7 +127,13 @@ RiskFilter::RiskFilter(const MarketRiskConfiguration::RiskClass& riskClass, cons
                                                          RiskFactorKey::KeyType::YoYInflationCapFloorVolatility,
                                                          RiskFactorKey::KeyType::SecuritySpread,
                                                          RiskFactorKey::KeyType::YieldVolatility};
+    return all;
+}
 
+// The key types of the risk filter given by the risk class and risk type
+std::set<RiskFactorKey::KeyType> allowedKeyTypes(const MarketRiskConfiguration::RiskClass& riskClass,
+                                                 const MarketRiskConfiguration::RiskType& riskType) {
+    const std::set<RiskFactorKey::KeyType>& all = listedKeyTypes();
     std::set<RiskFactorKey::KeyType> allowed_type, allowed;
 
     if (riskType == MarketRiskConfiguration::RiskType::All) {
@@ -199,20 +207,57 @@ RiskFilter::RiskFilter(const MarketRiskConfiguration::RiskClass& riskClass, cons
         std::set_intersection(allowed_type.begin(), allowed_type.end(), allowed_class.begin(), allowed_class.end(),
                               std::inserter(allowed, allowed.begin()));
     }
-    // use the complement if smaller, the check is called frequently
-    if (allowed.size() > all.size() / 2) {
-        std::set_difference(all.begin(), all.end(), allowed.begin(), allowed.end(),
-                            std::inserter(allowed_, allowed_.begin()));
-        neg_ = true;
-    } else {
-        allowed_ = allowed;
-        neg_ = false;
-    }
+    return allowed;
 }
 
-bool RiskFilter::allow(const RiskFactorKey& t) const {
-    bool found = std::find(allowed_.begin(), allowed_.end(), t.keytype) != allowed_.end();
-    return neg_ ? !found : found;
+/* The check is done on the complement of the allowed key types if this is smaller. Key types which are not covered
+   by the risk type All are then allowed as well, this is kept as is. */
+bool allowedKeyType(const std::set<RiskFactorKey::KeyType>& allowed, const RiskFactorKey::KeyType& keyType) {
+    const std::set<RiskFactorKey::KeyType>& all = listedKeyTypes();
+    if (allowed.size() > all.size() / 2)
+        return allowed.count(keyType) > 0 || all.count(keyType) == 0;
+    return allowed.count(keyType) > 0;
+}
+
+// number of key types, CPR is the last enumerator of RiskFactorKey::KeyType
+constexpr Size numberOfKeyTypes = static_cast<Size>(RiskFactorKey::KeyType::CPR) + 1;
+
+} // namespace
+
+RiskFilter::RiskFilter(const MarketRiskConfiguration::RiskClass& riskClass,
+                       const MarketRiskConfiguration::RiskType& riskType) {
+    // validates the risk class and type
+    allowedKeyTypes(riskClass, riskType);
+    index_ = breakdownIndex(riskClass, riskType);
+}
+
+bool RiskFilter::allow(const RiskFactorKey& t) const { return membership(t.keytype)[index_]; }
+
+Size RiskFilter::breakdownIndex(const MarketRiskConfiguration::RiskClass& riskClass,
+                                const MarketRiskConfiguration::RiskType& riskType) {
+    static constexpr Size numberOfRiskTypes =
+        static_cast<Size>(MarketRiskConfiguration::RiskType::BaseCorrelation) + 1;
+    return static_cast<Size>(riskClass) * numberOfRiskTypes + static_cast<Size>(riskType);
+}
+
+const RiskFilter::Membership& RiskFilter::membership(const RiskFactorKey::KeyType& keyType) {
+    // compiled once from the key type sets of all breakdowns
+    static const std::vector<Membership> table = []() {
+        std::vector<Membership> result(numberOfKeyTypes);
+        for (auto const rc : MarketRiskConfiguration::riskClasses(true)) {
+            for (auto const rt : MarketRiskConfiguration::riskTypes(true)) {
+                auto allowed = allowedKeyTypes(rc, rt);
+                for (Size k = 0; k < numberOfKeyTypes; ++k) {
+                    if (allowedKeyType(allowed, RiskFactorKey::KeyType(k)))
+                        result[k].set(breakdownIndex(rc, rt));
+                }
+            }
+        }
+        return result;
+    }();
+    Size k = static_cast<Size>(keyType);
+    QL_REQUIRE(k < table.size(), "RiskFilter::membership(): unexpected key type " << k);
+    return table[k];
 }
 
 } // namespace analytics
@@ -27,6 +27,7 @@
 
 #include <ql/types.hpp>
 
+#include <bitset>
 #include <set>
 #include <string>
 #include <vector>
@@ -68,15 +69,32 @@ MarketRiskConfiguration::RiskType parseVarRiskType(const std::string& rt);
 //! Risk Filter
 /*! The risk filter class groups risk factor keys w.r.t. a risk class (IR, FX, EQ...) and a risk type (delta-gamma,
  * vega, ...). It can e.g. be used to break down a var report.
+ *
+ * The membership of each key type in all (risk class, risk type) breakdowns is compiled once into a bitmask, see
+ * membership(), so that allow() is a table lookup and a caller can evaluate all breakdowns of a key at once.
  */
 class RiskFilter : public ScenarioFilter {
 public:
+    //! Number of (risk class, risk type) breakdowns, including the All levels
+    static constexpr QuantLib::Size numberOfBreakdowns =
+        (static_cast<QuantLib::Size>(MarketRiskConfiguration::RiskClass::Commodity) + 1) *
+        (static_cast<QuantLib::Size>(MarketRiskConfiguration::RiskType::BaseCorrelation) + 1);
+
+    //! Bitmask over the breakdowns, indexed by breakdownIndex()
+    typedef std::bitset<numberOfBreakdowns> Membership;
+
     RiskFilter(const MarketRiskConfiguration::RiskClass& riskClass, const MarketRiskConfiguration::RiskType& riskType);
     bool allow(const RiskFactorKey& t) const override;
 
+    //! Index of the breakdown (\p riskClass, \p riskType) in a Membership bitmask
+    static QuantLib::Size breakdownIndex(const MarketRiskConfiguration::RiskClass& riskClass,
+                                         const MarketRiskConfiguration::RiskType& riskType);
+
+    //! The breakdowns the key type belongs to, i.e. the bit of (rc, rt) is set if RiskFilter(rc, rt) allows it
+    static const Membership& membership(const RiskFactorKey::KeyType& keyType);
+
 private:
-    std::set<RiskFactorKey::KeyType> allowed_;
-    bool neg_;
+    QuantLib::Size index_;
 };
 
 } // namespace analytics
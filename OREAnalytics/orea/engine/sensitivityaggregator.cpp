@@ -19,19 +19,48 @@
 #include <orea/engine/sensitivityaggregator.hpp>
 
 #include <ored/utilities/log.hpp>
+#include <qle/math/chunkworkers.hpp>
 #include <ql/errors.hpp>
 
+#include <unordered_map>
+
 using ore::analytics::ScenarioFilter;
 using std::function;
 using std::map;
 using std::set;
 using std::string;
+using std::vector;
 
 namespace ore {
 namespace analytics {
 
-SensitivityAggregator::SensitivityAggregator(const map<string, set<pair<string, Size>>>& categories)
-    : setCategories_(categories) {
+namespace {
+
+struct CrossPairHash {
+    std::size_t operator()(const SensitivityAggregator::CrossPair& p) const {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, hash_value(p.first));
+        boost::hash_combine(seed, hash_value(p.second));
+        return seed;
+    }
+};
+
+// a record aggregated in a chunk of the stream with the stream position of its first contribution
+struct AggregatedRecord {
+    SensitivityRecord record;
+    Size position;
+};
+
+using AggregatedRecords = std::unordered_map<SensitivityAggregator::CrossPair, AggregatedRecord, CrossPairHash>;
+
+// number of records per chunk processed by one thread
+constexpr Size chunkSize = 4096;
+
+} // namespace
+
+SensitivityAggregator::SensitivityAggregator(const map<string, set<pair<string, Size>>>& categories,
+                                             const Size nThreads)
+    : setCategories_(categories), nThreads_(nThreads) {
 
     // Initialise the category functions
     for (const auto& kv : setCategories_) {
@@ -42,8 +71,9 @@ SensitivityAggregator::SensitivityAggregator(const map<string, set<pair<string,
     init();
 }
 
-SensitivityAggregator::SensitivityAggregator(const map<string, function<bool(string)>>& categories)
-    : categories_(categories) {
+SensitivityAggregator::SensitivityAggregator(const map<string, function<bool(string)>>& categories,
+                                             const Size nThreads)
+    : categories_(categories), nThreads_(nThreads) {
 
     // Initialise the categorised records
     init();
@@ -53,32 +83,123 @@ void SensitivityAggregator::aggregate(SensitivityStream& ss, const QuantLib::ext
     // Ensure at start of stream
     ss.reset();
 
-    // Loop over stream's records
-    while (SensitivityRecord sr = ss.next()) {
-        // Skip this record if the risk factor is not in the filter
-        if (!sr.isCrossGamma() && !filter->allow(sr.key_1))
-            continue;
-        if (sr.isCrossGamma() && (!filter->allow(sr.key_1) || !filter->allow(sr.key_2)))
-            continue;
-
-        // "Blank out" trade ID before adding
-        string tradeId = sr.tradeId;
-        sr.tradeId = "";
-
-        // Update aggRecords_ for each category
-        for (const auto& kv : categories_) {
-            // Check if the sensitivity record's trade ID is in the category
-            if (kv.second(tradeId)) {
-                DLOG("Updating aggregated sensitivities for category " << kv.first << " with record: " << sr);
-                add(sr, aggRecords_[kv.first]);
+    // Remove a restriction from applyFilter()
+    filteredRecords_.clear();
+    filtered_ = false;
+
+    // The categories by index
+    vector<string> names;
+    vector<const function<bool(string)>*> categories;
+    for (const auto& kv : categories_) {
+        names.push_back(kv.first);
+        categories.push_back(&kv.second);
+    }
+
+    // The indices of the categories a trade ID belongs to, evaluated once per trade ID
+    std::unordered_map<string, vector<Size>> tradeCategories;
+
+    // Records aggregated per chunk and category, a chunk index always refers to the same part of a batch
+    QuantExt::ChunkWorkers workers(nThreads_);
+    Size nChunks = workers.nThreads();
+    vector<vector<AggregatedRecords>> chunkRecords(nChunks, vector<AggregatedRecords>(names.size()));
+
+    // Loop over stream's records in batches, each batch is split into chunks processed in parallel
+    std::vector<SensitivityRecord> records;
+    vector<const vector<Size>*> recordCategories;
+    Size position = 0;
+    while (Size n = ss.nextBatch(records, nChunks * chunkSize)) {
+        recordCategories.resize(n);
+        for (Size i = 0; i < n; ++i) {
+            auto c = tradeCategories.find(records[i].tradeId);
+            if (c == tradeCategories.end()) {
+                vector<Size> indices;
+                for (Size j = 0; j < categories.size(); ++j) {
+                    if ((*categories[j])(records[i].tradeId))
+                        indices.push_back(j);
+                }
+                c = tradeCategories.emplace(records[i].tradeId, std::move(indices)).first;
             }
+            recordCategories[i] = &c->second;
+        }
+
+        Size size = (n + nChunks - 1) / nChunks;
+        workers.run(nChunks, [&records, &recordCategories, &chunkRecords, &filter, n, size, position](const Size c) {
+            for (Size i = c * size; i < std::min(n, (c + 1) * size); ++i) {
+                SensitivityRecord& sr = records[i];
+                if (recordCategories[i]->empty())
+                    continue;
+                // Skip this record if the risk factor is not in the filter
+                if (!sr.isCrossGamma() && !filter->allow(sr.key_1))
+                    continue;
+                if (sr.isCrossGamma() && (!filter->allow(sr.key_1) || !filter->allow(sr.key_2)))
+                    continue;
+
+                // "Blank out" trade ID before adding
+                sr.tradeId.clear();
+
+                // Update the chunk's records for each category of the trade
+                CrossPair key(sr.key_1, sr.key_2);
+                for (Size j : *recordCategories[i]) {
+                    AggregatedRecords& agg = chunkRecords[c][j];
+                    auto r = agg.find(key);
+                    if (r == agg.end()) {
+                        agg.emplace(key, AggregatedRecord{sr, position + i});
+                    } else {
+                        r->second.record.baseNpv += sr.baseNpv;
+                        r->second.record.delta += sr.delta;
+                        r->second.record.gamma += sr.gamma;
+                    }
+                }
+            }
+        });
+        position += n;
+    }
+
+    // Merge the chunks, the first record in stream order is kept, then update aggRecords_ for each category
+    for (Size j = 0; j < names.size(); ++j) {
+        AggregatedRecords merged = std::move(chunkRecords[0][j]);
+        for (Size c = 1; c < nChunks; ++c) {
+            for (auto& [key, r] : chunkRecords[c][j]) {
+                auto it = merged.find(key);
+                if (it == merged.end()) {
+                    merged.emplace(key, std::move(r));
+                    continue;
+                }
+                AggregatedRecord& m = it->second;
+                if (r.position < m.position)
+                    std::swap(m, r);
+                m.record.baseNpv += r.record.baseNpv;
+                m.record.delta += r.record.delta;
+                m.record.gamma += r.record.gamma;
+            }
+            AggregatedRecords().swap(chunkRecords[c][j]);
+        }
+        DLOG("Updating aggregated sensitivities for category " << names[j] << " with " << merged.size()
+                                                               << " records");
+        set<SensitivityRecord>& result = aggRecords_[names[j]];
+        for (auto& [key, r] : merged)
+            add(r.record, result);
+    }
+}
+
+void SensitivityAggregator::applyFilter(const QuantLib::ext::shared_ptr<ScenarioFilter>& filter) {
+    filteredRecords_.clear();
+    for (const auto& [category, records] : aggRecords_) {
+        set<SensitivityRecord>& result = filteredRecords_[category];
+        for (const auto& sr : records) {
+            // Same condition as in aggregate(), the records are visited in order
+            if (filter->allow(sr.key_1) && (!sr.isCrossGamma() || filter->allow(sr.key_2)))
+                result.insert(result.end(), sr);
         }
     }
+    filtered_ = true;
 }
 
 void SensitivityAggregator::reset() {
     // Clear the aggregated sensitivities
     aggRecords_.clear();
+    filteredRecords_.clear();
+    filtered_ = false;
 
     // Initialise the categorised records
     init();
@@ -86,8 +207,9 @@ void SensitivityAggregator::reset() {
 
 const set<SensitivityRecord>& SensitivityAggregator::sensitivities(const string& category) const {
 
-    auto it = aggRecords_.find(category);
-    QL_REQUIRE(it != aggRecords_.end(),
+    const auto& records = filtered_ ? filteredRecords_ : aggRecords_;
+    auto it = records.find(category);
+    QL_REQUIRE(it != records.end(),
                "The category " << category << " was not used in the construction of the SensitivityAggregator");
 
     return it->second;
@@ -96,7 +218,7 @@ const set<SensitivityRecord>& SensitivityAggregator::sensitivities(const string&
 void SensitivityAggregator::generateDeltaGamma(const string& category, map<RiskFactorKey, Real>& deltas,
     map<CrossPair, Real>& gammas) {
 
-    auto srs = sensitivities(category);
+    const auto& srs = sensitivities(category);
     for (const auto& sr : srs) {
         if (!sr.isCrossGamma()) {
             QL_REQUIRE(deltas.count(sr.key_1) == 0,
@@ -141,7 +263,7 @@ void SensitivityAggregator::add(SensitivityRecord& sr, set<SensitivityRecord>& r
 
 bool SensitivityAggregator::inCategory(const string& tradeId, const string& category) const {
     QL_REQUIRE(setCategories_.count(category), "The category " << category << " is not valid");
-    auto tradeIds = setCategories_.at(category);
+    const auto& tradeIds = setCategories_.at(category);
     for (auto it = tradeIds.begin(); it != tradeIds.end(); ++it) {
         if (it->first == tradeId)
             return true;
@@ -35,7 +35,9 @@ namespace analytics {
 
 /*! Class for aggregating SensitivityRecords.
 
-    The SensitivityRecords are aggregated according to categories of predefined trade IDs.
+    The SensitivityRecords are aggregated according to categories of predefined trade IDs. The stream is read once
+    for all categories, the records are grouped by their risk factor keys in hash maps, in parallel over chunks of
+    the stream if more than one thread is given. The category membership is evaluated once per trade ID.
 */
 class SensitivityAggregator {
 public:
@@ -44,7 +46,8 @@ public:
         The \p categories map has a string key that defines the name of the category and a value
         that defines the set of trade IDs in that category.
     */
-    SensitivityAggregator(const std::map<std::string, std::set<std::pair<std::string, QuantLib::Size>>>& categories);
+    SensitivityAggregator(const std::map<std::string, std::set<std::pair<std::string, QuantLib::Size>>>& categories,
+                          const QuantLib::Size nThreads = 1);
 
     /*! Constructor that uses functions to define the aggregation categories.
 
@@ -52,7 +55,8 @@ public:
         is a function that when given a trade ID, returns a bool indicating if the trade ID is in the
         category.
     */
-    SensitivityAggregator(const std::map<std::string, std::function<bool(std::string)>>& categories);
+    SensitivityAggregator(const std::map<std::string, std::function<bool(std::string)>>& categories,
+                          const QuantLib::Size nThreads = 1);
 
     /*! Update the aggregator with SensitivityRecords from the stream \p ss after applying the
         optional filter. If no filter is specified, all risk factors are aggregated.
@@ -63,6 +67,13 @@ public:
     void aggregate(SensitivityStream& ss, const QuantLib::ext::shared_ptr<ScenarioFilter>& filter =
                                               QuantLib::ext::make_shared<ScenarioFilter>());
 
+    /*! Restrict the sensitivities returned by sensitivities() and generateDeltaGamma() to the risk factors allowed
+        by \p filter, cross gammas are kept if both of their risk factors are allowed. The filter is applied to the
+        records aggregated so far, so that a stream can be aggregated once and then be broken down by several
+        filters without reading it again. A further call replaces the restriction, aggregate() and reset() remove it.
+    */
+    void applyFilter(const QuantLib::ext::shared_ptr<ScenarioFilter>& filter);
+
     //! Reset the aggregator to it's initial state by clearing all aggregations
     void reset();
 
@@ -85,6 +96,11 @@ private:
     std::map<std::string, std::function<bool(std::string)>> categories_;
     //! Sensitivity records aggregated according to <code>categories_</code>
     std::map<std::string, std::set<SensitivityRecord>> aggRecords_;
+    //! Sensitivity records of <code>aggRecords_</code> allowed by the filter given in applyFilter()
+    std::map<std::string, std::set<SensitivityRecord>> filteredRecords_;
+    bool filtered_ = false;
+    //! Number of threads used in aggregate()
+    QuantLib::Size nThreads_;
 
     //! Initialise the container of aggregated records
     void init();
@@ -18,6 +18,7 @@
 
 #include <orea/cube/jointnpvsensicube.hpp>
 #include <orea/cube/sensicube.hpp>
+#include <orea/engine/analyticlinearsensitivities.hpp>
 #include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/sensitivityanalysis.hpp>
 #include <orea/engine/valuationcalculator.hpp>
@@ -177,25 +178,80 @@ void SensitivityAnalysis::generateSensitivities() {
             if (pf->trades().empty())
                 continue;
             LOG("Run Sensitivity Scenarios for " << pf->size() << " out of " << portfolio_->size() << " trades.");
-            QuantLib::ext::shared_ptr<NPVSensiCube> cube =
-                QuantLib::ext::make_shared<DoublePrecisionSensiCube>(pf->ids(), asof_, scenGen->samples());
             simMarket_->scenarioGenerator() = scenGen;
-            auto factory =
-                QuantLib::ext::make_shared<EngineFactory>(ed, simMarket_, configurations, referenceData_, iborFallbackConfig_);
-            pf->reset();
-            pf->build(factory, "sensi analysis");
-            if (recalibrateModels_)
-                modelBuilders_ = factory->modelBuilders();
-            else
-                modelBuilders_.clear();
-            ValuationEngine engine(asof_, dg, simMarket_, modelBuilders_);
-            for (auto const& i : this->progressIndicators())
-                engine.registerProgressIndicator(i);
-            engine.buildCube(pf, cube, calculators, true, nullptr, nullptr, {}, dryRun_);
 
-            sensiCubes_.push_back(QuantLib::ext::make_shared<SensitivityCube>(cube, scenGen->scenarioDescriptions(),
-                                                                      scenarioGenerator_->shiftSizes(),
-                                                                      scenGen->shiftSizes(), scenGen->shiftSchemes()));
+            // in incremental mode the trades are processed in blocks, each block is built, valued under all
+            // scenarios, passed to the handler and released again, otherwise there is one block holding all trades
+
+            std::vector<QuantLib::ext::shared_ptr<Portfolio>> blocks;
+            if (tradeBlockSize_ == 0 || !cubeHandler_) {
+                blocks.push_back(pf);
+            } else {
+                for (auto const& [_, t] : pf->trades()) {
+                    if (blocks.empty() || blocks.back()->size() == tradeBlockSize_)
+                        blocks.push_back(QuantLib::ext::make_shared<Portfolio>(pf->buildFailedTrades()));
+                    blocks.back()->add(t);
+                }
+                LOG("Incremental mode, process " << blocks.size() << " blocks of up to " << tradeBlockSize_
+                                                 << " trades");
+            }
+
+            for (auto const& block : blocks) {
+                auto factory = QuantLib::ext::make_shared<EngineFactory>(ed, simMarket_, configurations, referenceData_,
+                                                                         iborFallbackConfig_);
+                block->reset();
+                block->build(factory, "sensi analysis");
+                if (recalibrateModels_)
+                    modelBuilders_ = factory->modelBuilders();
+                else
+                    modelBuilders_.clear();
+
+                // the eligible linear trades are valued from their analytic deltas and gammas, the remaining trades
+                // are repriced under the scenarios
+
+                QuantLib::ext::shared_ptr<Portfolio> repricedBlock = block;
+                QuantLib::ext::shared_ptr<NPVSensiCube> analyticCube;
+                if (analyticLinearSensitivities_ && !dryRun_) {
+                    AnalyticLinearSensitivities analytic(simMarket_, simMarketData_, marketConfiguration_,
+                                                         nonShiftedBaseCurrencyConversion_ ? market_ : nullptr);
+                    auto remaining = QuantLib::ext::make_shared<Portfolio>(block->buildFailedTrades());
+                    for (auto const& [_, t] : block->trades()) {
+                        if (!analytic.add(t))
+                            remaining->add(t);
+                    }
+                    LOG("Analytic linear sensitivities for " << analytic.tradeIds().size() << " out of "
+                                                             << block->size() << " trades");
+                    if (!analytic.tradeIds().empty()) {
+                        analyticCube = QuantLib::ext::make_shared<DoublePrecisionSensiCube>(
+                            analytic.tradeIds(), asof_, scenGen->samples());
+                        analytic.buildCube(scenGen, analyticCube);
+                        repricedBlock = remaining;
+                    }
+                }
+
+                QuantLib::ext::shared_ptr<NPVSensiCube> cube = analyticCube;
+                if (!repricedBlock->trades().empty()) {
+                    cube = QuantLib::ext::make_shared<DoublePrecisionSensiCube>(repricedBlock->ids(), asof_,
+                                                                                scenGen->samples());
+                    ValuationEngine engine(asof_, dg, simMarket_, modelBuilders_);
+                    engine.skipUnaffectedTrades(skipUnaffectedTrades_);
+                    for (auto const& i : this->progressIndicators())
+                        engine.registerProgressIndicator(i);
+                    engine.buildCube(repricedBlock, cube, calculators, true, nullptr, nullptr, {}, dryRun_);
+                    if (analyticCube)
+                        cube = QuantLib::ext::make_shared<JointNPVSensiCube>(cube, analyticCube);
+                }
+
+                auto sensiCube = QuantLib::ext::make_shared<SensitivityCube>(
+                    cube, scenGen->scenarioDescriptions(), scenarioGenerator_->shiftSizes(), scenGen->shiftSizes(),
+                    scenGen->shiftSchemes());
+                if (cubeHandler_)
+                    cubeHandler_(sensiCube);
+                if (blocks.size() > 1)
+                    block->reset();
+                else
+                    sensiCubes_.push_back(sensiCube);
+            }
         }
     } else {
 
@@ -234,6 +290,10 @@ void SensitivityAnalysis::generateSensitivities() {
             if (pf->trades().empty())
                 continue;
 
+            if (analyticLinearSensitivities_)
+                LOG("SensitivityAnalysis: analytic linear sensitivities are not supported by the multi-threaded "
+                    "engine, all trades are repriced under the scenarios");
+
             MultiThreadedValuationEngine engine(
                 nThreads_, asof_, QuantLib::ext::make_shared<ore::analytics::DateGrid>(), scenGen->numScenarios(), loader_,
                 scenGen, ed, curveConfigs_, todaysMarketParams_, marketConfiguration_, simMarketData_,
@@ -267,6 +327,8 @@ void SensitivityAnalysis::generateSensitivities() {
             sensiCubes_.push_back(QuantLib::ext::make_shared<SensitivityCube>(cube, scenGen->scenarioDescriptions(),
                                                                       scenarioGenerator_->shiftSizes(),
                                                                       scenGen->shiftSizes(), scenGen->shiftSchemes()));
+            if (cubeHandler_)
+                cubeHandler_(sensiCubes_.back());
         }
     }
 
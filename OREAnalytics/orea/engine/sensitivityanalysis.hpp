@@ -37,6 +37,7 @@
 #include <ored/report/report.hpp>
 #include <ored/utilities/progressbar.hpp>
 
+#include <functional>
 #include <map>
 #include <set>
 #include <tuple>
@@ -117,6 +118,24 @@ public:
     //! override shift tenors with sim market tenors
     void overrideTenors(const bool b) { overrideTenors_ = b; }
 
+    /*! reprice only the trades affected by a scenario, see ValuationEngine::skipUnaffectedTrades(), this is only
+        supported by the single-threaded engine */
+    void skipUnaffectedTrades(const bool b) { skipUnaffectedTrades_ = b; }
+    /*! value eligible linear trades (single currency swaps with fixed and vanilla Ibor coupons) from their analytic
+        zero rate deltas and gammas instead of repricing them under each scenario, see AnalyticLinearSensitivities,
+        this is only supported by the single-threaded engine */
+    void analyticLinearSensitivities(const bool b) { analyticLinearSensitivities_ = b; }
+    /*! incremental mode: the trades are processed in blocks of tradeBlockSize trades and the sensitivity cube of
+        each block is passed to the handler as soon as the block is valued under all scenarios. The block is released
+        afterwards, so that the memory required is proportional to the block size rather than the portfolio size.
+        If the portfolio consists of more than one block, sensiCubes() is empty after the run. The multi-threaded
+        engine does not support blocks, it passes its full cubes to the handler. */
+    void setSensiCubeHandler(const Size tradeBlockSize,
+                             const std::function<void(const QuantLib::ext::shared_ptr<SensitivityCube>&)>& handler) {
+        tradeBlockSize_ = tradeBlockSize;
+        cubeHandler_ = handler;
+    }
+
     //! the portfolio of trades
     QuantLib::ext::shared_ptr<Portfolio> portfolio() const { return portfolio_; }
 
@@ -144,6 +163,10 @@ private:
     //! Optional todays market parameters. Used in building the scenario sim market.
     QuantLib::ext::shared_ptr<ore::data::TodaysMarketParameters> todaysMarketParams_;
     bool overrideTenors_;
+    bool skipUnaffectedTrades_ = false;
+    bool analyticLinearSensitivities_ = false;
+    Size tradeBlockSize_ = 0;
+    std::function<void(const QuantLib::ext::shared_ptr<SensitivityCube>&)> cubeHandler_;
 
     // if true, convert sensis to base currency using the original (non-shifted) FX rate
     bool nonShiftedBaseCurrencyConversion_;
@@ -35,6 +35,17 @@ SensitivityRecord SensitivityInMemoryStream::next() {
     return *(itCurrent_++);
 }
 
+Size SensitivityInMemoryStream::nextBatch(std::vector<SensitivityRecord>& records, const Size maxSize) {
+    Size n = std::min<Size>(maxSize, records_.end() - itCurrent_);
+    if (records.size() < n)
+        records.resize(n);
+    // copy assignment reuses the storage of the strings in the batch records
+    for (Size i = 0; i < n; ++i)
+        records[i] = *(itCurrent_++);
+    records.resize(n);
+    return n;
+}
+
 void SensitivityInMemoryStream::reset() {
     // Reset iterator to start of container
     itCurrent_ = records_.begin();
@@ -39,6 +39,8 @@ public:
     SensitivityInMemoryStream(Iter begin, Iter end);
     //! Returns the next SensitivityRecord in the stream
     SensitivityRecord next() override;
+    //! Copies the next batch of SensitivityRecords from the container
+    QuantLib::Size nextBatch(std::vector<SensitivityRecord>& records, const QuantLib::Size maxSize = 1024) override;
     //! Resets the stream so that SensitivityRecords can be streamed again
     void reset() override;
     /*! Add a record to the in-memory collection.
@@ -24,6 +24,8 @@
 
 #include <orea/engine/sensitivityrecord.hpp>
 
+#include <vector>
+
 namespace ore {
 namespace analytics {
 
@@ -34,6 +36,22 @@ public:
     virtual ~SensitivityStream() {}
     //! Returns the next SensitivityRecord in the stream
     virtual SensitivityRecord next() = 0;
+    /*! Fills \p records with the next (at most \p maxSize) SensitivityRecords in the stream and returns their number,
+        zero at the end of the stream. The elements of \p records are assigned to, so that their storage is reused
+        if the same vector is passed for consecutive batches. The default implementation calls next(). */
+    virtual QuantLib::Size nextBatch(std::vector<SensitivityRecord>& records, const QuantLib::Size maxSize = 1024) {
+        if (records.size() < maxSize)
+            records.resize(maxSize);
+        QuantLib::Size n = 0;
+        while (n < maxSize) {
+            SensitivityRecord sr = next();
+            if (!sr)
+                break;
+            records[n++] = std::move(sr);
+        }
+        records.resize(n);
+        return n;
+    }
     //! Resets the stream so that SensitivityRecord objects can be streamed again
     virtual void reset() = 0;
 };
@@ -17,17 +17,23 @@
 */
 
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/jointnpvcube.hpp>
+#include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/stresstest.hpp>
 #include <orea/engine/valuationcalculator.hpp>
 #include <orea/engine/valuationengine.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
 
+#include <ored/marketdata/todaysmarket.hpp>
 #include <ored/utilities/log.hpp>
 
 #include <ql/errors.hpp>
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <functional>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -44,7 +50,8 @@ StressTest::StressTest(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& po
                        const CurveConfigurations& curveConfigs, const TodaysMarketParameters& todaysMarketParams,
                        QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory,
                        const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData,
-                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError) {
+                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError,
+                       bool skipUnaffectedTrades) {
 
     LOG("Run Stress Test");
     DLOG("Build Simulation Market");
@@ -81,13 +88,72 @@ StressTest::StressTest(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& po
     vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
     calculators.push_back(QuantLib::ext::make_shared<NPVCalculator>(simMarketData->baseCcy()));
     ValuationEngine engine(asof, dg, simMarket, factory->modelBuilders());
+    engine.skipUnaffectedTrades(skipUnaffectedTrades);
 
     engine.registerProgressIndicator(QuantLib::ext::make_shared<ProgressLog>("stress scenarios", 100, oreSeverity::notice));
     engine.buildCube(portfolio, cube, calculators);
 
-    /*****************
-     * Collect results
-     */
+    collectResults(portfolio, cube, scenarioGenerator, engine.sampleTimes());
+    LOG("Stress testing done");
+}
+
+StressTest::StressTest(const Size nThreads, const Date& asof,
+                       const QuantLib::ext::shared_ptr<ore::data::Loader>& loader,
+                       const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+                       const string& marketConfiguration,
+                       const QuantLib::ext::shared_ptr<ore::data::EngineData>& engineData,
+                       const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                       const QuantLib::ext::shared_ptr<StressTestScenarioData>& stressData,
+                       const QuantLib::ext::shared_ptr<CurveConfigurations>& curveConfigs,
+                       const QuantLib::ext::shared_ptr<TodaysMarketParameters>& todaysMarketParams,
+                       const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData,
+                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError, bool skipUnaffectedTrades,
+                       const std::string& context) {
+
+    LOG("Run Stress Test using the multi-threaded valuation engine with " << nThreads << " threads");
+
+    // the base sim market is only used to generate the stress scenarios, the valuation is done in the worker threads
+    DLOG("Build Simulation Market");
+    auto market = QuantLib::ext::make_shared<TodaysMarket>(asof, todaysMarketParams, loader, curveConfigs, true, true,
+                                                           false, referenceData, false, iborFallbackConfig, false);
+    QuantLib::ext::shared_ptr<ScenarioSimMarket> simMarket = QuantLib::ext::make_shared<ScenarioSimMarket>(
+        market, simMarketData, marketConfiguration, curveConfigs ? *curveConfigs : CurveConfigurations(),
+        todaysMarketParams ? *todaysMarketParams : TodaysMarketParameters(), continueOnError,
+        stressData->useSpreadedTermStructures(), false, false, iborFallbackConfig, true);
+
+    DLOG("Build Stress Scenario Generator");
+    QuantLib::ext::shared_ptr<Scenario> baseScenario = simMarket->baseScenario();
+    auto scenarioGenerator = QuantLib::ext::make_shared<StressScenarioGenerator>(
+        stressData, baseScenario, simMarketData, simMarket,
+        QuantLib::ext::make_shared<CloneScenarioFactory>(baseScenario), simMarket->baseScenarioAbsolute());
+    simMarket->scenarioGenerator() = scenarioGenerator;
+
+    auto ed = QuantLib::ext::make_shared<EngineData>(*engineData);
+    ed->globalParameters()["RunType"] = "Stress";
+
+    DLOG("Run Stress Scenarios");
+    MultiThreadedValuationEngine engine(
+        nThreads, asof, QuantLib::ext::make_shared<DateGrid>("1,0W", NullCalendar()), scenarioGenerator->samples(),
+        loader, scenarioGenerator, ed, curveConfigs, todaysMarketParams, marketConfiguration, simMarketData,
+        stressData->useSpreadedTermStructures(), false, QuantLib::ext::make_shared<ScenarioFilter>(), referenceData,
+        iborFallbackConfig, true, true, true, {}, {}, {}, context);
+    engine.skipUnaffectedTrades(skipUnaffectedTrades);
+    engine.registerProgressIndicator(
+        QuantLib::ext::make_shared<ProgressLog>("stress scenarios", 100, oreSeverity::notice));
+    auto baseCcy = simMarketData->baseCcy();
+    engine.buildCube(portfolio, [&baseCcy]() -> std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>> {
+        return {QuantLib::ext::make_shared<NPVCalculator>(baseCcy)};
+    });
+
+    auto cube = QuantLib::ext::make_shared<JointNPVCube>(engine.outputCubes(), portfolio->ids());
+    collectResults(portfolio, cube, scenarioGenerator, engine.sampleTimes());
+    LOG("Stress testing done");
+}
+
+void StressTest::collectResults(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+                                const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                                const QuantLib::ext::shared_ptr<StressScenarioGenerator>& scenarioGenerator,
+                                const std::vector<double>& sampleTimes) {
     baseNPV_.clear();
     shiftedNPV_.clear();
     delta_.clear();
@@ -112,7 +178,22 @@ StressTest::StressTest(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& po
             labels_.insert(label);
         }
     }
-    LOG("Stress testing done");
+
+    // log the valuation times by scenario, the slowest scenarios first
+    scenarioTimes_.clear();
+    std::vector<std::pair<Real, string>> times;
+    for (Size j = 0; j < scenarioGenerator->samples() && j < sampleTimes.size(); ++j) {
+        const string& label = scenarioGenerator->scenarios()[j]->label();
+        scenarioTimes_[label] = sampleTimes[j];
+        times.push_back(std::make_pair(sampleTimes[j], label));
+    }
+    std::sort(times.begin(), times.end(), std::greater<std::pair<Real, string>>());
+    for (Size j = 0; j < times.size(); ++j) {
+        if (j < 10)
+            LOG("Stress scenario '" << times[j].second << "' valued in " << times[j].first << " sec");
+        else
+            DLOG("Stress scenario '" << times[j].second << "' valued in " << times[j].first << " sec");
+    }
 }
 
 void StressTest::writeReport(const QuantLib::ext::shared_ptr<ore::data::Report>& report, Real outputThreshold) {
@@ -28,6 +28,7 @@
 #include <orea/scenario/scenariosimmarketparameters.hpp>
 #include <orea/scenario/stressscenariodata.hpp>
 #include <orea/scenario/stressscenariogenerator.hpp>
+#include <ored/marketdata/loader.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/report/report.hpp>
@@ -65,7 +66,22 @@ public:
                QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory = {},
                const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData = nullptr,
                const IborFallbackConfig& iborFallbackConfig = IborFallbackConfig::defaultConfig(),
-               bool continueOnError = false);
+               bool continueOnError = false, bool skipUnaffectedTrades = false);
+
+    /*! Constructor using the multi-threaded valuation engine, the stress scenarios are distributed over nThreads
+        threads, each with its own sim market built from the loader */
+    StressTest(const QuantLib::Size nThreads, const QuantLib::Date& asof,
+               const QuantLib::ext::shared_ptr<ore::data::Loader>& loader,
+               const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio, const string& marketConfiguration,
+               const QuantLib::ext::shared_ptr<ore::data::EngineData>& engineData,
+               const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+               const QuantLib::ext::shared_ptr<StressTestScenarioData>& stressData,
+               const QuantLib::ext::shared_ptr<ore::data::CurveConfigurations>& curveConfigs,
+               const QuantLib::ext::shared_ptr<ore::data::TodaysMarketParameters>& todaysMarketParams,
+               const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData = nullptr,
+               const IborFallbackConfig& iborFallbackConfig = IborFallbackConfig::defaultConfig(),
+               bool continueOnError = false, bool skipUnaffectedTrades = false,
+               const std::string& context = "stress analysis");
 
     //! Return set of trades analysed
     const std::set<std::string>& trades() { return trades_; }
@@ -82,16 +98,27 @@ public:
     //! Return delta NPV by trade and scenario
     const std::map<std::pair<std::string, std::string>, Real>& delta() { return delta_; }
 
+    /*! Return the valuation time in seconds by scenario, in the multi-threaded case this is the time summed over
+        the threads */
+    const std::map<std::string, Real>& scenarioTimes() { return scenarioTimes_; }
+
     //! Write NPV by trade/scenario to a file (base and shifted NPVs, delta)
     void writeReport(const QuantLib::ext::shared_ptr<ore::data::Report>& report, Real outputThreshold = 0.0);
 
 private:
+    void collectResults(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+                        const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                        const QuantLib::ext::shared_ptr<StressScenarioGenerator>& scenarioGenerator,
+                        const std::vector<double>& sampleTimes);
+
     // base NPV by trade
     std::map<std::string, Real> baseNPV_;
     // NPV respectively sensitivity by trade and scenario
     std::map<std::pair<string, string>, Real> shiftedNPV_, delta_;
     // scenario labels
     std::set<std::string> labels_, trades_;
+    // valuation time by scenario
+    std::map<std::string, Real> scenarioTimes_;
 };
 } // namespace analytics
 } // namespace ore
@@ -77,6 +77,19 @@ public:
 
     // called after each scenario update before the calculators are run
     virtual void initScenario() = 0;
+
+    // false if calculate() does nothing for isCloseOut = true, the valuation engine does not run it on close-out dates
+    virtual bool closeOutValuation() const { return true; }
+
+    /* called instead of calculate() with isCloseOut = true for a trade that is not affected by the close-out scenario
+       of a sticky date run, i.e. its instruments still return their npvs of the valuation date, see ValuationEngine */
+    virtual void reuseValuation(const QuantLib::ext::shared_ptr<Trade>& trade, Size tradeIndex,
+                                const QuantLib::ext::shared_ptr<SimMarket>& simMarket,
+                                QuantLib::ext::shared_ptr<NPVCube>& outputCube,
+                                QuantLib::ext::shared_ptr<NPVCube>& outputCubeNettingSet, const Date& date,
+                                Size dateIndex, Size sample) {
+        calculate(trade, tradeIndex, simMarket, outputCube, outputCubeNettingSet, date, dateIndex, sample, true);
+    }
 };
 
 //! NPVCalculator
@@ -101,8 +114,12 @@ public:
     virtual Real npv(Size tradeIndex, const QuantLib::ext::shared_ptr<Trade>& trade,
                      const QuantLib::ext::shared_ptr<SimMarket>& simMarket);
 
+    //! fx rate converting the npv of the trade to base ccy in the current scenario
+    Real fxRate(Size tradeIndex) const { return fxRates_[tradeCcyIndex_[tradeIndex]]; }
+
     void init(const QuantLib::ext::shared_ptr<Portfolio>& portfolio, const QuantLib::ext::shared_ptr<SimMarket>& simMarket) override;
     void initScenario() override;
+    bool closeOutValuation() const override { return false; }
 
 protected:
     std::string baseCcyCode_;
@@ -136,6 +153,7 @@ public:
 
     void init(const QuantLib::ext::shared_ptr<Portfolio>& portfolio, const QuantLib::ext::shared_ptr<SimMarket>& simMarket) override;
     void initScenario() override;
+    bool closeOutValuation() const override { return false; }
 
 private:
     std::string baseCcyCode_;
@@ -174,6 +192,7 @@ public:
 
     void init(const QuantLib::ext::shared_ptr<Portfolio>& portfolio, const QuantLib::ext::shared_ptr<SimMarket>& simMarket) override;
     void initScenario() override {}
+    bool closeOutValuation() const override { return false; }
 
 private:
     std::string baseCcyCode_;
@@ -16,11 +16,13 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/cube/jointnpvcube.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/engine/cptycalculator.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/valuationcalculator.hpp>
 #include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/simulation/simmarket.hpp>
 
 #include <ored/portfolio/optionwrapper.hpp>
@@ -31,11 +33,15 @@
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/progressbar.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/trace.hpp>
 
 #include <ql/errors.hpp>
+#include <ql/settings.hpp>
 
 #include <boost/timer/timer.hpp>
 
+#include <algorithm>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -46,6 +52,46 @@ using boost::timer::default_places;
 namespace ore {
 namespace analytics {
 
+namespace {
+
+// the key by which trades are grouped, if the pricing order is grouped by pricing engine
+std::vector<std::string> pricingGroupKey(const Trade& trade) {
+    std::vector<std::string> key{trade.pricingEngine().empty() ? trade.tradeType() : trade.pricingEngine(),
+                                 trade.tradeType(), trade.npvCurrency(), std::string(), std::string()};
+    for (auto const& leg : trade.legs()) {
+        for (auto const& c : leg) {
+            if (auto frc = QuantLib::ext::dynamic_pointer_cast<FloatingRateCoupon>(c)) {
+                key[3] = frc->index()->name();
+                break;
+            }
+        }
+        if (!key[3].empty())
+            break;
+    }
+    try {
+        for (auto const& [assetClass, indices] : trade.underlyingIndices()) {
+            for (auto const& i : indices)
+                key[4] += i + ",";
+        }
+    } catch (const std::exception& e) {
+        DLOG("ValuationEngine: could not determine underlying indices of trade " << trade.id() << ": " << e.what());
+    }
+    return key;
+}
+
+} // namespace
+
+//! records whether one of the observed instruments of a trade was notified since the flag was last reset
+class ValuationEngine::TradeUpdateFlag : public QuantLib::Observer {
+public:
+    void update() override { updated_ = true; }
+    bool updated() const { return updated_; }
+    void reset() { updated_ = false; }
+
+private:
+    bool updated_ = true;
+};
+
 ValuationEngine::ValuationEngine(const Date& today, const QuantLib::ext::shared_ptr<DateGrid>& dg,
                                  const QuantLib::ext::shared_ptr<SimMarket>& simMarket,
                                  const set<std::pair<string, QuantLib::ext::shared_ptr<ModelBuilder>>>& modelBuilders)
@@ -58,6 +104,13 @@ ValuationEngine::ValuationEngine(const Date& today, const QuantLib::ext::shared_
     QL_REQUIRE(simMarket_, "ValuationEngine: Error, Null SimMarket");
 }
 
+void ValuationEngine::setSampleRange(const Size firstSample, const Size endSample) {
+    QL_REQUIRE(firstSample < endSample, "ValuationEngine::setSampleRange(): firstSample ("
+                                            << firstSample << ") must be less than endSample (" << endSample << ")");
+    firstSample_ = firstSample;
+    endSample_ = endSample;
+}
+
 void ValuationEngine::recalibrateModels() {
     ObservationMode::Mode om = ObservationMode::instance().mode();
     for (auto const& b : modelBuilders_) {
@@ -67,6 +120,33 @@ void ValuationEngine::recalibrateModels() {
     }
 }
 
+void ValuationEngine::updateCube(const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
+                                 const std::set<std::string>& tradeIds,
+                                 QuantLib::ext::shared_ptr<analytics::NPVCube> outputCube,
+                                 vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators,
+                                 bool mporStickyDate) {
+    QL_REQUIRE(outputCube, "ValuationEngine::updateCube(): no output cube given");
+    auto subPortfolio = QuantLib::ext::make_shared<Portfolio>(portfolio->buildFailedTrades());
+    for (auto const& id : tradeIds) {
+        auto c = outputCube->idsAndIndexes().find(id);
+        QL_REQUIRE(c != outputCube->idsAndIndexes().end(),
+                   "ValuationEngine::updateCube(): trade " << id << " not in output cube");
+        outputCube->remove(c->second);
+        auto t = portfolio->trades().find(id);
+        if (t != portfolio->trades().end())
+            subPortfolio->add(t->second);
+    }
+    LOG("ValuationEngine: update " << subPortfolio->size() << " trades and remove "
+                                   << tradeIds.size() - subPortfolio->size() << " trades in output cube of "
+                                   << outputCube->numIds() << " trades");
+    if (subPortfolio->empty())
+        return;
+    // the view on the output cube has the same trade order as the sub portfolio
+    auto cubeView = QuantLib::ext::make_shared<JointNPVCube>(
+        std::vector<QuantLib::ext::shared_ptr<NPVCube>>{outputCube}, subPortfolio->ids());
+    buildCube(subPortfolio, cubeView, calculators, mporStickyDate);
+}
+
 void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
                                 QuantLib::ext::shared_ptr<analytics::NPVCube> outputCube,
                                 vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators, bool mporStickyDate,
@@ -74,6 +154,8 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
                                 QuantLib::ext::shared_ptr<analytics::NPVCube> outputCptyCube,
                                 vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>> cptyCalculators, bool dryRun) {
 
+    ORE_TRACE_SCOPE("ValuationEngine::buildCube");
+
     struct SimMarketResetter {
         SimMarketResetter(QuantLib::ext::shared_ptr<SimMarket> simMarket) : simMarket_(simMarket) {}
         ~SimMarketResetter() { simMarket_->reset(); }
@@ -119,6 +201,13 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
         c->initScenario();
     }
 
+    // the calculators producing results on close-out dates, the others are not run on close-out dates
+    vector<QuantLib::ext::shared_ptr<ValuationCalculator>> closeOutCalculators;
+    for (auto const& c : calculators) {
+        if (c->closeOutValuation())
+            closeOutCalculators.push_back(c);
+    }
+
     // Loop is Samples, Dates, Trades
     const auto& dates = dg_->dates();
     const auto& trades = portfolio->trades();
@@ -164,20 +253,142 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
     }
     LOG("Total number of trades = " << portfolio->size());
 
+    // set up the order in which the trades are priced
+
+    pricingOrder_.clear();
+    i = 0;
+    for (auto const& [tradeId, trade] : trades)
+        pricingOrder_.push_back(std::make_pair(i++, trade));
+    if (groupTradesByPricingEngine_) {
+        std::vector<std::vector<std::string>> keys;
+        for (auto const& [tradeId, trade] : trades)
+            keys.push_back(pricingGroupKey(*trade));
+        std::stable_sort(pricingOrder_.begin(), pricingOrder_.end(),
+                         [&keys](const std::pair<Size, QuantLib::ext::shared_ptr<Trade>>& a,
+                                 const std::pair<Size, QuantLib::ext::shared_ptr<Trade>>& b) {
+                             return keys[a.first] < keys[b.first];
+                         });
+        LOG("ValuationEngine: trades are priced grouped by pricing engine and market dependencies");
+    }
+
     if (!dates.empty() && dates.front() > simMarket_->asofDate()) {
         // the fixing manager is only required if sim dates contain future dates
         simMarket_->fixingManager()->initialise(portfolio, simMarket_);
     }
 
+    // set up the skipping of unaffected trades
+
+    struct ChangedRiskFactorsTrackingResetter {
+        ~ChangedRiskFactorsTrackingResetter() {
+            if (simMarket_)
+                simMarket_->trackChangedRiskFactors(trackChangedRiskFactors_);
+        }
+        QuantLib::ext::shared_ptr<ScenarioSimMarket> simMarket_;
+        bool trackChangedRiskFactors_ = false;
+    } trackingResetter;
+
+    // an observer of the instruments of a trade, telling whether one of them was notified since its last reset
+    auto tradeUpdateFlag = [](const QuantLib::ext::shared_ptr<Trade>& trade) {
+        auto f = QuantLib::ext::make_shared<TradeUpdateFlag>();
+        if (auto qlInstr = trade->instrument()->qlInstrument())
+            f->registerWith(qlInstr);
+        for (auto const& a : trade->instrument()->additionalInstruments())
+            f->registerWith(a);
+        if (auto o = QuantLib::ext::dynamic_pointer_cast<OptionWrapper>(trade->instrument())) {
+            for (auto const& u : o->underlyingInstruments())
+                f->registerWith(u);
+        }
+        return f;
+    };
+
+    useTradeUpdateFlags_ = false;
+    skippedTradeValuations_ = 0;
+    if (skipUnaffectedTrades_) {
+        auto ssm = QuantLib::ext::dynamic_pointer_cast<ScenarioSimMarket>(simMarket_);
+        if (dates.size() != 1 || outputCubeNettingSet || outputCptyCube || ssm == nullptr ||
+            (om != ObservationMode::Mode::None && om != ObservationMode::Mode::Defer)) {
+            LOG("ValuationEngine: skipping of unaffected trades requires a single date, no netting set or cpty "
+                "output cube, a ScenarioSimMarket and observation mode None or Defer, will reprice all trades.");
+        } else {
+            LOG("ValuationEngine: skipping of unaffected trades is enabled.");
+            useTradeUpdateFlags_ = true;
+            trackingResetter.simMarket_ = ssm;
+            trackingResetter.trackChangedRiskFactors_ = ssm->trackChangedRiskFactors();
+            ssm->trackChangedRiskFactors(true);
+            lastNumeraire_ = simMarket_->numeraire();
+            lastPricedSample_.assign(trades.size(), Null<Size>());
+            tradeUpdateFlags_.clear();
+            for (auto const& [tradeId, trade] : trades)
+                tradeUpdateFlags_.push_back(tradeUpdateFlag(trade));
+        }
+    }
+
+    // set up the reuse of the valuation date npvs on sticky close-out dates
+
+    reuseCloseOutValuations_ = false;
+    if (mporStickyDate && !dg_->closeOutDates().empty() && !closeOutCalculators.empty()) {
+        if (om != ObservationMode::Mode::None && om != ObservationMode::Mode::Defer) {
+            LOG("ValuationEngine: reusing valuation date npvs on sticky close-out dates requires observation mode None "
+                "or Defer, will reprice all trades on close-out dates.");
+        } else {
+            LOG("ValuationEngine: reusing valuation date npvs on sticky close-out dates is enabled.");
+            reuseCloseOutValuations_ = true;
+            closeOutUpdateFlags_.clear();
+            tradeFlowDates_.clear();
+            for (auto const& [tradeId, trade] : trades) {
+                closeOutUpdateFlags_.push_back(tradeUpdateFlag(trade));
+                std::vector<Date> flowDates;
+                for (auto const& leg : trade->legs()) {
+                    for (auto const& cf : leg)
+                        flowDates.push_back(cf->date());
+                }
+                if (trade->maturity() != Date())
+                    flowDates.push_back(trade->maturity());
+                std::sort(flowDates.begin(), flowDates.end());
+                tradeFlowDates_.push_back(flowDates);
+            }
+        }
+    }
+
+    // notification statistics of the sim market
+    auto statsSimMarket = QuantLib::ext::dynamic_pointer_cast<ScenarioSimMarket>(simMarket_);
+    Size quoteNotifications = statsSimMarket ? statsSimMarket->quoteNotifications() : 0;
+    Size deferredNotificationBatches = statsSimMarket ? statsSimMarket->deferredNotificationBatches() : 0;
+
     cpu_timer timer;
     cpu_timer loopTimer;
     Size nTrades = trades.size();
 
     // We call Cube::samples() each time here to allow for dynamic stopping times
     // e.g. MC convergence tests
-    for (Size sample = 0; sample < (dryRun ? std::min<Size>(1, outputCube->samples()) : outputCube->samples());
-         ++sample) {
+    auto endSample = [this, &outputCube, dryRun]() {
+        if (dryRun)
+            return std::min<Size>(1, outputCube->samples());
+        return endSample_ == Null<Size>() ? outputCube->samples() : std::min(endSample_, outputCube->samples());
+    };
+    sampleTimes_.assign(outputCube->samples(), 0.0);
+    datePricings_.assign(outputCube->numDates(), 0);
+    datePricingTimes_.assign(outputCube->numDates(), 0.0);
+    dateSkippedExpiredTrades_.assign(outputCube->numDates(), 0);
+    dateReusedCloseOutValuations_.assign(outputCube->numDates(), 0);
+    if (skipExpiredTrades_ && !dryRun && firstSample_ < endSample()) {
+        // the skipped entries are not written, so the cube must be initialised with zero on all depths
+        Size lastDateIndex = outputCube->numDates() - 1;
+        for (auto const& [j, trade] : pricingOrder_) {
+            if (trade->maturity() == Date() || trade->maturity() >= dg_->valuationDates().back())
+                continue;
+            for (Size k = 0; k < outputCube->depth(); ++k) {
+                QL_REQUIRE(outputCube->get(j, lastDateIndex, firstSample_, k) == 0.0,
+                           "ValuationEngine: skipExpiredTrades requires an output cube initialised with zero, found "
+                               << outputCube->get(j, lastDateIndex, firstSample_, k) << " for trade "
+                               << trade->id() << " at depth " << k);
+            }
+        }
+    }
+    cpu_timer sampleTimer;
+    for (Size sample = dryRun ? 0 : firstSample_; sample < endSample(); ++sample) {
         TLOG("ValuationEngine: apply scenario sample #" << sample);
+        sampleTimer.start();
 
         for (auto& [tradeId, trade] : portfolio->trades())
             trade->instrument()->reset();
@@ -198,10 +409,13 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
                     outputCube, outputCubeNettingSet, counterparties, cptyCalculators, outputCptyCube);
                 pricingTime += priceTime;
                 updateTime += upTime;
-                if(closeOutDate != Date()){
+                if (closeOutDate != Date()) {
+                    // the close-out scenario is always applied, even if no calculator requires it, to keep the
+                    // scenario generator in sync with the date grid
                     std::tie(priceTime, upTime) = populateCube(
-                        closeOutDate, cubeDateIndex, sample, false, mporStickyDate, scenarioUpdated, trades, tradeHasError,
-                        calculators, outputCube, outputCubeNettingSet, counterparties, cptyCalculators, outputCptyCube);
+                        closeOutDate, cubeDateIndex, sample, false, mporStickyDate, scenarioUpdated, trades,
+                        tradeHasError, closeOutCalculators, outputCube, outputCubeNettingSet, counterparties,
+                        cptyCalculators, outputCptyCube);
                     pricingTime += priceTime;
                     updateTime += upTime;
                 }
@@ -223,8 +437,8 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
                     for (size_t& valueDateIndex : closeOutDateToValueDateIndex[d]) {
                         std::tie(priceTime, upTime) =
                             populateCube(d, valueDateIndex, sample, false, mporStickyDate, scenarioUpdated, trades,
-                                         tradeHasError, calculators, outputCube, outputCubeNettingSet, counterparties,
-                                         cptyCalculators, outputCptyCube);
+                                         tradeHasError, closeOutCalculators, outputCube, outputCubeNettingSet,
+                                         counterparties, cptyCalculators, outputCptyCube);
                         pricingTime += priceTime;
                         updateTime += upTime;
                         scenarioUpdated = true;
@@ -255,6 +469,10 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
         timer.start();
         simMarket_->fixingManager()->reset();
         fixingTime += timer.elapsed().wall * 1e-9;
+
+        if (sample >= sampleTimes_.size())
+            sampleTimes_.resize(sample + 1, 0.0);
+        sampleTimes_[sample] = sampleTimer.elapsed().wall * 1e-9;
     }
 
     if (dryRun) {
@@ -282,6 +500,37 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
                                            << "pricing " << pricingTime << " sec, "
                                            << "update " << updateTime << " sec "
                                            << "fixing " << fixingTime);
+    if (statsSimMarket) {
+        LOG("ValuationEngine: " << statsSimMarket->quoteNotifications() - quoteNotifications
+                                << " sim market quote notifications, coalesced in "
+                                << statsSimMarket->deferredNotificationBatches() - deferredNotificationBatches
+                                << " scenario applications");
+    }
+    if (skipExpiredTrades_) {
+        Size skippedExpiredTrades = 0;
+        for (Size i = 0; i < dateSkippedExpiredTrades_.size(); ++i) {
+            DLOG("ValuationEngine: date #" << i << " " << datePricings_[i] << " trade calculations, "
+                                           << dateSkippedExpiredTrades_[i] << " expired trade valuations skipped");
+            skippedExpiredTrades += dateSkippedExpiredTrades_[i];
+        }
+        LOG("ValuationEngine: skipped " << skippedExpiredTrades << " expired trade valuations");
+    }
+    if (useTradeUpdateFlags_) {
+        LOG("ValuationEngine: skipped " << skippedTradeValuations_ << " unaffected trade valuations");
+        useTradeUpdateFlags_ = false;
+        tradeUpdateFlags_.clear();
+    }
+    if (reuseCloseOutValuations_) {
+        Size reusedCloseOutValuations = 0;
+        for (Size i = 0; i < dateReusedCloseOutValuations_.size(); ++i)
+            reusedCloseOutValuations += dateReusedCloseOutValuations_[i];
+        LOG("ValuationEngine: reused " << reusedCloseOutValuations << " valuation date npvs on close-out dates");
+        reuseCloseOutValuations_ = false;
+        closeOutUpdateFlags_.clear();
+        tradeFlowDates_.clear();
+    }
+
+    pricingOrder_.clear();
 
     // for trades with errors set all output cube values to zero
     i = 0;
@@ -301,20 +550,69 @@ void ValuationEngine::runCalculators(bool isCloseOutDate, const std::map<std::st
                                      QuantLib::ext::shared_ptr<analytics::NPVCube>& outputCube,
                                      QuantLib::ext::shared_ptr<analytics::NPVCube>& outputCubeNettingSet, const Date& d,
                                      const Size cubeDateIndex, const Size sample, const string& label) {
+    if (calculators.empty())
+        return;
     ObservationMode::Mode om = ObservationMode::instance().mode();
     for (auto& calc : calculators)
         calc->initScenario();
-    // loop over trades
-    size_t j = 0;
-    for (auto tradeIt = trades.begin(); tradeIt != trades.end(); ++tradeIt, ++j) {
-        auto trade = tradeIt->second;
+    // the trades are priced as of the evaluation date, which differs from d in sticky close-out runs
+    Date evaluationDate = Settings::instance().evaluationDate();
+    // loop over trades in the pricing order set up in buildCube()
+    for (auto const& [j, trade] : pricingOrder_) {
         if (tradeHasError[j]) {
             continue;
         }
 
+        // trades are not priced after their maturity, this also stops the notifications at their instruments
+        if (skipExpiredTrades_ && trade->maturity() != Date() && evaluationDate > trade->maturity()) {
+            ++dateSkippedExpiredTrades_[cubeDateIndex];
+            continue;
+        }
+
+        // copy the results of unaffected trades from the sample they were priced last
+        if (useTradeUpdateFlags_) {
+            if (!repriceAllTrades_ && !tradeUpdateFlags_[j]->updated()) {
+                for (Size k = 0; k < outputCube->depth(); ++k) {
+                    outputCube->set(lastPricedSample_[j] == Null<Size>()
+                                        ? outputCube->getT0(j, k)
+                                        : outputCube->get(j, cubeDateIndex, lastPricedSample_[j], k),
+                                    j, cubeDateIndex, sample, k);
+                }
+                ++skippedTradeValuations_;
+                continue;
+            }
+            tradeUpdateFlags_[j]->reset();
+            lastPricedSample_[j] = sample;
+        }
+
+        // on a sticky close-out date, the instruments of a trade that were not notified since the valuation on the
+        // value date (the evaluation date) still return the npvs of the value date, trades with flows in the margin
+        // period of risk are repriced nevertheless
+        if (reuseCloseOutValuations_ && isCloseOutDate && !closeOutUpdateFlags_[j]->updated()) {
+            const std::vector<Date>& flowDates = tradeFlowDates_[j];
+            auto flow = std::upper_bound(flowDates.begin(), flowDates.end(), evaluationDate);
+            if (flow == flowDates.end() || *flow > d) {
+                try {
+                    for (auto& calc : calculators)
+                        calc->reuseValuation(trade, j, simMarket_, outputCube, outputCubeNettingSet, d, cubeDateIndex,
+                                             sample);
+                } catch (const std::exception& e) {
+                    string expMsg = "date = " + ore::data::to_string(io::iso_date(d)) +
+                                    ", sample = " + ore::data::to_string(sample) + ", label = " + label + ": " +
+                                    e.what();
+                    StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "ScenarioValuation", expMsg.c_str())
+                        .log();
+                    tradeHasError[j] = true;
+                }
+                ++dateReusedCloseOutValuations_[cubeDateIndex];
+                continue;
+            }
+        }
+
         // We can avoid checking mode here and always call updateQlInstruments()
         if (om == ObservationMode::Mode::Disable || om == ObservationMode::Mode::Unregister)
             trade->instrument()->updateQlInstruments();
+        std::size_t pricings = trade->getNumberOfPricings();
         try {
             for (auto& calc : calculators)
                 calc->calculate(trade, j, simMarket_, outputCube, outputCubeNettingSet, d, cubeDateIndex, sample,
@@ -325,6 +623,10 @@ void ValuationEngine::runCalculators(bool isCloseOutDate, const std::map<std::st
             StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "ScenarioValuation", expMsg.c_str()).log();
             tradeHasError[j] = true;
         }
+        // the trade's pricing count is only increased by NPV() calls that trigger a calculation
+        datePricings_[cubeDateIndex] += trade->getNumberOfPricings() - pricings;
+        if (reuseCloseOutValuations_ && !isCloseOutDate)
+            closeOutUpdateFlags_[j]->reset();
     }
 }
 
@@ -381,6 +683,16 @@ std::pair<double, double> ValuationEngine::populateCube(
     }
     recalibrateModels();
 
+    // a change in an fx spot might affect the base ccy conversion, a change of the numeraire affects all trades
+    if (useTradeUpdateFlags_) {
+        repriceAllTrades_ = simMarket_->numeraire() != lastNumeraire_;
+        lastNumeraire_ = simMarket_->numeraire();
+        if (auto ssm = QuantLib::ext::dynamic_pointer_cast<ScenarioSimMarket>(simMarket_)) {
+            for (auto const& [type, name] : ssm->changedRiskFactors())
+                repriceAllTrades_ = repriceAllTrades_ || type == RiskFactorKey::KeyType::FXSpot;
+        }
+    }
+
     timer.stop();
     updateTime += timer.elapsed().wall * 1e-9;
 
@@ -398,6 +710,7 @@ std::pair<double, double> ValuationEngine::populateCube(
     }
     timer.stop();
     pricingTime += timer.elapsed().wall * 1e-9;
+    datePricingTimes_[cubeDateIndex] += timer.elapsed().wall * 1e-9;
     return std::make_pair(pricingTime, updateTime);
 }
 
@@ -26,9 +26,11 @@
 #include <ored/utilities/progressbar.hpp>
 
 #include <ql/time/date.hpp>
+#include <ql/utilities/null.hpp>
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ore::data {
 class DateGrid;
@@ -99,7 +101,74 @@ public:
         //! Limit samples to one and fill the rest of the cube with random values
         bool dryRun = false);
 
+    /*! Reprice the trades with the given ids into an existing output cube holding these and possibly other trades,
+        e.g. after an amendment of the trades, which must be rebuilt against the sim market before, see
+        Portfolio::buildTrades(). The values of the given trades in the output cube are removed first, the ids of
+        trades not in the portfolio (i.e. removed trades) are only removed. All ids must be in the output cube, new
+        trades are priced into a separate cube by buildCube(), which can be joined with the existing one in a
+        JointNPVCube. The scenario generator of the sim market must reproduce the scenarios of the original run,
+        e.g. a model based generator reset to its initial state. Netting set and counterparty output cubes are not
+        updated. For a JaggedCube the trades can not extend beyond the maturity they had when the cube was built. */
+    void updateCube(const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio, const std::set<std::string>& tradeIds,
+                    QuantLib::ext::shared_ptr<analytics::NPVCube> outputCube,
+                    std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators,
+                    bool mporStickyDate = true);
+
+    /*! Restrict subsequent calls of buildCube() to the samples firstSample, ..., endSample - 1 of the output cube.
+        The scenario generator of the sim market must be positioned at firstSample by the caller. By default all
+        samples of the output cube are processed. */
+    void setSampleRange(const QuantLib::Size firstSample, const QuantLib::Size endSample);
+
+    /*! If enabled, a trade is only repriced in a sample if one of its instruments was notified of a change since it
+        was priced last, or if an fx spot or the numeraire changed. Otherwise its cube entries are copied from the
+        sample it was priced last. This requires a date grid with a single date, no netting set or counterparty
+        output cubes, a ScenarioSimMarket and an observation mode under which the instruments are notified (None or
+        Defer). If these requirements are not met, all trades are repriced. This is meant for sensitivity scenarios,
+        where most trades do not depend on the shifted risk factor. */
+    void skipUnaffectedTrades(const bool b) { skipUnaffectedTrades_ = b; }
+
+    /*! If enabled, the trades are priced grouped by their pricing engine (resp. trade type, if the engine is not
+        known) and, within a group, by their primary market dependencies (npv currency, first floating index of the
+        legs, underlying indices), so that trades sharing engine code and term structures are priced back to back.
+        The order is determined once per buildCube() run, the cube layout is not affected. Netting set level results
+        are accumulated in the new order, and may therefore differ in the last digits. */
+    void groupTradesByPricingEngine(const bool b) { groupTradesByPricingEngine_ = b; }
+
+    /*! If enabled, a trade is not priced if the evaluation date is after its maturity. This is the cube date except
+        for the close-out valuations with a sticky date, which are done as of the valuation date. The cube entries of
+        the skipped valuations keep their initial value, buildCube() checks that the output cube is initialised with
+        zero on all depths, as assumed by the JaggedCube as well. Since the instruments of an expired
+        trade are not recalculated, they do not forward the notifications of the sim market term structures and the
+        evaluation date to their observers either. This is only meant for calculators producing zero values after
+        the maturity of a trade, e.g. the NPV and cashflow calculators. */
+    void skipExpiredTrades(const bool b) { skipExpiredTrades_ = b; }
+
+    /*! wall time in seconds spent on each sample of the output cube in the last buildCube() run, samples outside the
+        processed sample range have time zero */
+    const std::vector<double>& sampleTimes() const { return sampleTimes_; }
+
+    /*! number of trade calculations triggered on each date of the output cube in the last buildCube() run, summed
+        over the samples and including the close-out valuations for that date. Only NPV() calls that trigger a
+        performCalculations() of an instrument are counted, see InstrumentWrapper::getNumberOfPricings(). */
+    const std::vector<QuantLib::Size>& datePricings() const { return datePricings_; }
+
+    /*! wall time in seconds spent on pricing on each date of the output cube in the last buildCube() run, summed
+        over the samples and including the close-out valuations for that date */
+    const std::vector<double>& datePricingTimes() const { return datePricingTimes_; }
+
+    /*! number of trade valuations skipped on each date of the output cube in the last buildCube() run since the trade
+        has expired, summed over the samples, see skipExpiredTrades() */
+    const std::vector<QuantLib::Size>& dateSkippedExpiredTrades() const { return dateSkippedExpiredTrades_; }
+
+    /*! number of sticky close-out valuations on each date of the output cube in the last buildCube() run that reused
+        the valuation date npv of the trade, summed over the samples. A trade is only repriced on a sticky close-out
+        date if one of its instruments was notified of a change since its valuation on the value date, or if it has
+        a flow or its maturity in the margin period of risk. This requires an observation mode under which the
+        instruments are notified (None or Defer), otherwise all trades are repriced. */
+    const std::vector<QuantLib::Size>& dateReusedCloseOutValuations() const { return dateReusedCloseOutValuations_; }
+
 private:
+    class TradeUpdateFlag;
     void recalibrateModels();
     std::pair<double, double> populateCube(const QuantLib::Date& d, size_t cubeDateIndex, size_t sample,
                                            bool isValueDate, bool isStickyDate, bool scenarioUpdated,
@@ -126,6 +195,29 @@ private:
     QuantLib::ext::shared_ptr<ore::data::DateGrid> dg_;
     QuantLib::ext::shared_ptr<ore::analytics::SimMarket> simMarket_;
     set<std::pair<std::string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>> modelBuilders_;
+    QuantLib::Size firstSample_ = 0;
+    QuantLib::Size endSample_ = QuantLib::Null<QuantLib::Size>();
+    // skipping of unaffected trades, the state is set up in buildCube()
+    bool skipUnaffectedTrades_ = false;
+    bool useTradeUpdateFlags_ = false;
+    // the order in which the trades are priced, as (position in the portfolio, trade), set up in buildCube()
+    bool groupTradesByPricingEngine_ = false;
+    std::vector<std::pair<QuantLib::Size, QuantLib::ext::shared_ptr<ore::data::Trade>>> pricingOrder_;
+    bool repriceAllTrades_ = true;
+    QuantLib::Real lastNumeraire_ = QuantLib::Null<QuantLib::Real>();
+    std::vector<QuantLib::ext::shared_ptr<TradeUpdateFlag>> tradeUpdateFlags_;
+    std::vector<QuantLib::Size> lastPricedSample_;
+    QuantLib::Size skippedTradeValuations_ = 0;
+    bool skipExpiredTrades_ = false;
+    std::vector<double> sampleTimes_;
+    std::vector<QuantLib::Size> datePricings_;
+    std::vector<double> datePricingTimes_;
+    std::vector<QuantLib::Size> dateSkippedExpiredTrades_;
+    // reuse of the valuation date npvs on sticky close-out dates, the state is set up in buildCube()
+    bool reuseCloseOutValuations_ = false;
+    std::vector<QuantLib::ext::shared_ptr<TradeUpdateFlag>> closeOutUpdateFlags_;
+    std::vector<std::vector<QuantLib::Date>> tradeFlowDates_;
+    std::vector<QuantLib::Size> dateReusedCloseOutValuations_;
 };
 } // namespace analytics
 } // namespace ore
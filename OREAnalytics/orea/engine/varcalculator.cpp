@@ -25,8 +25,11 @@ namespace analytics {
 VarReport::VarReport(const std::string& baseCurrency, const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
                      const std::string& portfolioFilter, const vector<Real>& p, boost::optional<ore::data::TimePeriod> period,
                      const QuantLib::ext::shared_ptr<HistoricalScenarioGenerator>& hisScenGen,
-                     std::unique_ptr<SensiRunArgs> sensiArgs, std::unique_ptr<FullRevalArgs> fullRevalArgs, const bool breakdown) 
-    : MarketRiskReport(baseCurrency, portfolio, portfolioFilter, period, hisScenGen, std::move(sensiArgs), std::move(fullRevalArgs), nullptr, breakdown), p_(p) { 
+                     std::unique_ptr<SensiRunArgs> sensiArgs, std::unique_ptr<FullRevalArgs> fullRevalArgs,
+                     const bool breakdown, std::unique_ptr<MultiThreadArgs> multiThreadArgs)
+    : MarketRiskReport(baseCurrency, portfolio, portfolioFilter, period, hisScenGen, std::move(sensiArgs),
+                       std::move(fullRevalArgs), std::move(multiThreadArgs), breakdown),
+      p_(p) {
 }
 
 void VarReport::createReports(const ext::shared_ptr<MarketRiskReport::Reports>& reports) {
@@ -50,10 +53,7 @@ void VarReport::writeReports(const ext::shared_ptr<MarketRiskReport::Reports>& r
     auto rg = ext::dynamic_pointer_cast<MarketRiskGroup>(riskGroup);
     auto tg = ext::dynamic_pointer_cast<TradeGroup>(tradeGroup);
 
-    std::vector<Real> var;
-    auto quantiles = p();
-    for (auto q : quantiles)
-        var.push_back(varCalculator_->var(q));
+    std::vector<Real> var = varCalculator_->vars(p());
 
     if (!close_enough(QuantExt::detail::absMax(var), 0.0)) {
         report->next();
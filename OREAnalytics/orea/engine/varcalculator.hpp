@@ -37,6 +37,17 @@ public:
 
     virtual QuantLib::Real var(QuantLib::Real confidence, const bool isCall = true, 
         const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) = 0;
+
+    /*! VaR for several confidence levels at once, the default implementation calls var() for each level, derived
+        classes can override this to share work between the confidence levels */
+    virtual std::vector<QuantLib::Real> vars(const std::vector<QuantLib::Real>& confidences, const bool isCall = true,
+                                             const std::set<std::pair<std::string, QuantLib::Size>>& tradeIds = {}) {
+        std::vector<QuantLib::Real> result;
+        result.reserve(confidences.size());
+        for (auto c : confidences)
+            result.push_back(var(c, isCall, tradeIds));
+        return result;
+    }
 };
 
 class VarReport : public MarketRiskReport {
@@ -47,7 +58,7 @@ public:
         const vector<Real>& p, boost::optional<ore::data::TimePeriod> period,
         const QuantLib::ext::shared_ptr<HistoricalScenarioGenerator>& hisScenGen = nullptr,
         std::unique_ptr<SensiRunArgs> sensiArgs = nullptr, std::unique_ptr<FullRevalArgs> fullRevalArgs = nullptr, 
-        const bool breakdown = false);
+        const bool breakdown = false, std::unique_ptr<MultiThreadArgs> multiThreadArgs = nullptr);
 
     void createReports(const QuantLib::ext::shared_ptr<MarketRiskReport::Reports>& reports) override;
 
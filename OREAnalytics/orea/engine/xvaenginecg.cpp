@@ -17,6 +17,7 @@
 */
 
 #include <orea/app/reportwriter.hpp>
+#include <orea/app/structuredanalyticswarning.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/npvsensicube.hpp>
 #include <orea/cube/sensicube.hpp>
@@ -32,11 +33,16 @@
 #include <qle/ad/backwardderivatives.hpp>
 #include <qle/ad/forwardderivatives.hpp>
 #include <qle/ad/forwardevaluation.hpp>
+#include <qle/ad/memoryplan.hpp>
+#include <qle/ad/optimisecomputationgraph.hpp>
+#include <qle/ad/parallelforwardevaluation.hpp>
 #include <qle/ad/ssaform.hpp>
 #include <qle/math/computeenvironment.hpp>
 #include <qle/math/randomvariable_ops.hpp>
 #include <qle/methods/multipathvariategenerator.hpp>
 
+#include <ql/math/comparison.hpp>
+
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/weighted_sum.hpp>
@@ -67,8 +73,14 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
                          const IborFallbackConfig& iborFallbackConfig, const bool bumpCvaSensis,
                          const bool useExternalComputeDevice, const bool externalDeviceCompatibilityMode,
                          const bool useDoublePrecisionForExternalCalculation, const std::string& externalComputeDevice,
-                         const bool continueOnCalibrationError, const bool continueOnError, const std::string& context)
-    : asof_(asof), loader_(loader), curveConfigs_(curveConfigs), todaysMarketParams_(todaysMarketParams),
+                         const bool continueOnCalibrationError, const bool continueOnError, const std::string& context,
+                         const Size checkpointInterval, const Real externalCalculationValidationTolerance,
+                         const bool regressionOnExternalDevice,
+                         const QuantLib::ext::shared_ptr<NettingSetManager>& nettingSetManager,
+                         const std::string& dvaName, const std::string& fvaBorrowingCurve,
+                         const std::string& fvaLendingCurve)
+    : nThreads_(nThreads), asof_(asof), loader_(loader), curveConfigs_(curveConfigs),
+      todaysMarketParams_(todaysMarketParams),
       simMarketData_(simMarketData), engineData_(engineData), crossAssetModelData_(crossAssetModelData),
       scenarioGeneratorData_(scenarioGeneratorData), portfolio_(portfolio), marketConfiguration_(marketConfiguration),
       marketConfigurationInCcy_(marketConfigurationInCcy), sensitivityData_(sensitivityData),
@@ -77,7 +89,11 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
       externalDeviceCompatibilityMode_(externalDeviceCompatibilityMode),
       useDoublePrecisionForExternalCalculation_(useDoublePrecisionForExternalCalculation),
       externalComputeDevice_(externalComputeDevice), continueOnCalibrationError_(continueOnCalibrationError),
-      continueOnError_(continueOnError), context_(context) {
+      continueOnError_(continueOnError), context_(context),
+      checkpointInterval_(checkpointInterval),
+      externalCalculationValidationTolerance_(externalCalculationValidationTolerance),
+      regressionOnExternalDevice_(regressionOnExternalDevice), nettingSetManager_(nettingSetManager),
+      dvaName_(dvaName), fvaBorrowingCurve_(fvaBorrowingCurve), fvaLendingCurve_(fvaLendingCurve) {
 
     // Just for performance testing, duplicate the trades in input portfolio as specified by env var N
 
@@ -232,28 +248,203 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
             cg_const(*g, 1.0), boost::none, ComputationGraph::nan, ComputationGraph::nan));
     }
 
+    // The same per netting set, the counterparty of a netting set is taken from its first trade. If there is only one
+    // netting set, we reuse the portfolio exposure nodes.
+
+    std::vector<Date> exposureDates(1, model_->referenceDate());
+    exposureDates.insert(exposureDates.end(), simulationDates.begin(), simulationDates.end());
+
+    std::map<std::string, std::vector<Size>> nettingSetTrades;
+    std::map<std::string, std::string> nettingSetCounterparty;
+    {
+        Size j = 0;
+        for (auto const& [id, trade] : portfolio_->trades()) {
+            nettingSetTrades[trade->envelope().nettingSetId()].push_back(j++);
+            nettingSetCounterparty.insert(
+                std::make_pair(trade->envelope().nettingSetId(), trade->envelope().counterparty()));
+        }
+    }
+
+    std::map<std::string, std::vector<std::size_t>> nettingSetExposureNodes;
+    for (auto const& [n, trades] : nettingSetTrades) {
+        if (nettingSetTrades.size() == 1) {
+            nettingSetExposureNodes[n] = pfExposureNodes;
+            continue;
+        }
+        std::vector<std::size_t> nettingSetSum(trades.size());
+        for (Size i = 0; i < exposureDates.size(); ++i) {
+            for (Size j = 0; j < trades.size(); ++j)
+                nettingSetSum[j] = amcNpvNodes[trades[j]][i];
+            nettingSetExposureNodes[n].push_back(model_->npv(cg_add(*g, nettingSetSum), exposureDates[i],
+                                                             cg_const(*g, 1.0), boost::none, ComputationGraph::nan,
+                                                             ComputationGraph::nan));
+        }
+    }
+
     boost::timer::nanosecond_type timing6 = timer.elapsed().wall;
 
     // Add post processor
     // This constitues part D of the computation graph from lastExposureNode ... g->size()
-    // The cvaNode is the ultimate result w.r.t. which we want to compute sensitivities
-
-    // note: very simplified calculation, for testing, just multiply the EPE on each date by fixed default prob
-    auto defaultCurve = simMarket_->defaultCurve("BANK")->curve();
-    model_->registerWith(defaultCurve);
-    Size cvaNode = cg_const(*g, 0.0);
-    for (Size i = 0; i < simulationDates.size(); ++i) {
-        Date d = i == 0 ? model_->referenceDate() : *std::next(simulationDates.begin(), i - 1);
-        Date e = *std::next(simulationDates.begin(), i);
-        std::size_t defaultProb =
-            addModelParameter(*g, model_->modelParameterFunctors(), "__defaultprob_" + std::to_string(i),
-                              [defaultCurve, d, e]() { return defaultCurve->defaultProbability(d, e); });
-        cvaNode = cg_add(*g, cvaNode, cg_mult(*g, defaultProb, cg_max(*g, pfExposureNodes[i], cg_const(*g, 0.0))));
+    // The xvaNodes are the ultimate results w.r.t. which we want to compute sensitivities, per netting set
+    // - the collateral C_i held at t_i under an active CSA is set from the netting set value V_j on the last date
+    //   t_j <= t_i - MPOR as C_i = max(V_j - TH_rcv, 0) - max(-V_j - TH_pay, 0), other CSA features are ignored. The
+    //   values are deflated, so we deflate the thresholds with the T0 discount factor to t_j
+    // - CVA = LGD_c sum_i PD_c(t_{i-1}, t_i) max(V_i - C_i, 0)
+    // - DVA = LGD_b sum_i PD_b(t_{i-1}, t_i) max(C_i - V_i, 0), if a dva name is given
+    // - FCA = sum_i S_c(t_{i-1}) S_b(t_{i-1}) s_borrow(t_{i-1}, t_i) max(V_i - C_i, 0), if a borrowing curve is given
+    // - FBA = sum_i S_c(t_{i-1}) S_b(t_{i-1}) s_lend(t_{i-1}, t_i) max(C_i - V_i, 0), if a lending curve is given
+    // where the funding spreads s are the forward excess factors of the funding curves over the discount curve.
+    // The market inputs enter as model parameters, so that we get their sensitivities from the backward sweep.
+
+    auto survivalProbabilities = [this, &g, &exposureDates](const std::string& name) {
+        QL_REQUIRE(simMarketData_->hasParamsName(RiskFactorKey::KeyType::SurvivalProbability, name),
+                   "XvaEngineCG: default curve '" << name << "' is not simulated, add it to the simulation market");
+        auto curve = simMarket_->defaultCurve(name)->curve();
+        model_->registerWith(curve);
+        std::vector<std::size_t> result;
+        for (Size i = 0; i < exposureDates.size(); ++i) {
+            Date d = exposureDates[i];
+            result.push_back(addModelParameter(*g, model_->modelParameterFunctors(),
+                                               "__xva_surv_" + name + "_" + std::to_string(i),
+                                               [curve, d]() { return curve->survivalProbability(d); }));
+        }
+        return result;
+    };
+
+    auto lgd = [this, &g](const std::string& name) {
+        auto rr = simMarket_->recoveryRate(name);
+        model_->registerWith(rr);
+        return addModelParameter(*g, model_->modelParameterFunctors(), "__xva_lgd_" + name,
+                                 [rr]() { return 1.0 - rr->value(); });
+    };
+
+    auto discountCurve = simMarket_->discountCurve(simMarketData_->baseCcy());
+    model_->registerWith(discountCurve);
+
+    auto fundingSpreads = [this, &g, &exposureDates, &discountCurve](const std::string& name) {
+        auto curve = simMarket_->yieldCurve(name);
+        model_->registerWith(curve);
+        std::vector<std::size_t> result(1, ComputationGraph::nan);
+        for (Size i = 1; i < exposureDates.size(); ++i) {
+            Date d = exposureDates[i - 1], e = exposureDates[i];
+            result.push_back(addModelParameter(
+                *g, model_->modelParameterFunctors(), "__xva_fundingspread_" + name + "_" + std::to_string(i),
+                [curve, discountCurve, d, e]() {
+                    return curve->discount(d) / curve->discount(e) * discountCurve->discount(e) /
+                               discountCurve->discount(d) -
+                           1.0;
+                }));
+        }
+        return result;
+    };
+
+    std::vector<std::size_t> ownSurvival, ownLgd;
+    if (!dvaName_.empty()) {
+        ownSurvival = survivalProbabilities(dvaName_);
+        ownLgd.push_back(lgd(dvaName_));
+    }
+    std::vector<std::size_t> borrowingSpreads, lendingSpreads;
+    if (!fvaBorrowingCurve_.empty())
+        borrowingSpreads = fundingSpreads(fvaBorrowingCurve_);
+    if (!fvaLendingCurve_.empty())
+        lendingSpreads = fundingSpreads(fvaLendingCurve_);
+
+    std::vector<std::pair<std::string, std::size_t>> xvaNodes;
+    std::map<std::string, std::vector<std::size_t>> xvaTotals;
+    std::vector<std::string> xvaTypes{"CVA", "DVA", "FBA", "FCA"};
+
+    for (auto const& [n, exposure] : nettingSetExposureNodes) {
+
+        // collateralised exposure
+
+        std::vector<std::size_t> collatExposure(exposure);
+        QuantLib::ext::shared_ptr<NettingSetDefinition> nettingSet;
+        if (nettingSetManager_ && nettingSetManager_->has(n))
+            nettingSet = nettingSetManager_->get(n);
+        if (nettingSet && nettingSet->activeCsaFlag()) {
+            auto csa = nettingSet->csaDetails();
+            QL_REQUIRE(csa->csaCurrency() == simMarketData_->baseCcy(),
+                       "XvaEngineCG: netting set '" << n << "' has CSA currency " << csa->csaCurrency()
+                                                    << ", only the base currency " << simMarketData_->baseCcy()
+                                                    << " is supported");
+            for (Size i = 0; i < exposureDates.size(); ++i) {
+                Size j = 0;
+                while (j + 1 <= i && exposureDates[j + 1] <= exposureDates[i] - csa->marginPeriodOfRisk())
+                    ++j;
+                std::size_t thresholdRcv = cg_const(*g, 0.0), thresholdPay = cg_const(*g, 0.0);
+                if (!QuantLib::close_enough(csa->thresholdRcv(), 0.0) ||
+                    !QuantLib::close_enough(csa->thresholdPay(), 0.0)) {
+                    Date d = exposureDates[j];
+                    std::size_t df =
+                        addModelParameter(*g, model_->modelParameterFunctors(), "__xva_df_" + std::to_string(j),
+                                          [discountCurve, d]() { return discountCurve->discount(d); });
+                    thresholdRcv = cg_mult(*g, cg_const(*g, csa->thresholdRcv()), df);
+                    thresholdPay = cg_mult(*g, cg_const(*g, csa->thresholdPay()), df);
+                }
+                std::size_t collateral =
+                    cg_subtract(*g, cg_max(*g, cg_subtract(*g, exposure[j], thresholdRcv), cg_const(*g, 0.0)),
+                                cg_max(*g, cg_subtract(*g, cg_negative(*g, exposure[j]), thresholdPay),
+                                       cg_const(*g, 0.0)));
+                collatExposure[i] = cg_subtract(*g, exposure[i], collateral);
+            }
+        }
+
+        // xva components
+
+        auto cptySurvival = survivalProbabilities(nettingSetCounterparty[n]);
+        std::size_t cptyLgd = lgd(nettingSetCounterparty[n]);
+        std::map<std::string, std::size_t> xva;
+        for (auto const& t : xvaTypes)
+            xva[t] = cg_const(*g, 0.0);
+        for (Size i = 1; i < exposureDates.size(); ++i) {
+            std::size_t epe = cg_max(*g, collatExposure[i], cg_const(*g, 0.0));
+            std::size_t ene = cg_max(*g, cg_negative(*g, collatExposure[i]), cg_const(*g, 0.0));
+            xva["CVA"] =
+                cg_add(*g, xva["CVA"],
+                       cg_mult(*g, cg_mult(*g, cptyLgd, cg_subtract(*g, cptySurvival[i - 1], cptySurvival[i])), epe));
+            std::size_t survival = cptySurvival[i - 1];
+            if (!ownSurvival.empty()) {
+                xva["DVA"] = cg_add(
+                    *g, xva["DVA"],
+                    cg_mult(*g, cg_mult(*g, ownLgd[0], cg_subtract(*g, ownSurvival[i - 1], ownSurvival[i])), ene));
+                survival = cg_mult(*g, survival, ownSurvival[i - 1]);
+            }
+            if (!borrowingSpreads.empty())
+                xva["FCA"] = cg_add(*g, xva["FCA"], cg_mult(*g, cg_mult(*g, survival, borrowingSpreads[i]), epe));
+            if (!lendingSpreads.empty())
+                xva["FBA"] = cg_add(*g, xva["FBA"], cg_mult(*g, cg_mult(*g, survival, lendingSpreads[i]), ene));
+        }
+        for (auto const& t : xvaTypes) {
+            if ((t == "DVA" && ownSurvival.empty()) || (t == "FCA" && borrowingSpreads.empty()) ||
+                (t == "FBA" && lendingSpreads.empty()))
+                continue;
+            xvaNodes.push_back(std::make_pair(t + "/" + n, xva[t]));
+            xvaTotals[t].push_back(xva[t]);
+        }
     }
 
+    for (auto const& [t, nodes] : xvaTotals)
+        xvaNodes.push_back(std::make_pair(t, cg_add(*g, nodes)));
+
     boost::timer::nanosecond_type timing7 = timer.elapsed().wall;
 
     LOG("XvaEngineCG: graph building complete, size is " << g->size());
+
+    // Optimise the graph, from here on we work with the optimised graph and map the model graph nodes to it
+
+    std::vector<std::size_t> outputNodes(pfExposureNodes);
+    for (auto const& [_, n] : xvaNodes)
+        outputNodes.push_back(n);
+    optimisedGraph_ = QuantLib::ext::make_shared<ComputationGraph>();
+    auto optimisationStats = optimiseComputationGraph(*g, *optimisedGraph_, nodeMap_, outputNodes);
+    LOG("XvaEngineCG: graph optimisation complete, " << optimisationStats);
+
+    g = optimisedGraph_;
+    for (auto& n : pfExposureNodes)
+        n = nodeMap_[n];
+    for (auto& [_, n] : xvaNodes)
+        n = nodeMap_[n];
+
     LOG("XvaEngineCG: got " << g->redBlockDependencies().size() << " red block dependencies.");
     std::size_t sumRedNodes = 0;
     for (auto const& r : g->redBlockRanges()) {
@@ -276,9 +467,21 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         ComputeEnvironment::instance().selectContext(externalComputeDevice_);
         externalComputeDeviceSettings.debug = false;
         externalComputeDeviceSettings.useDoublePrecision = useDoublePrecisionForExternalCalculation_;
+        if (useDoublePrecisionForExternalCalculation_ &&
+            !ComputeEnvironment::instance().context().supportsDoublePrecision()) {
+            // mixed precision: the path values are stored in single precision, the conditional expectations (unless
+            // calculated on the device) and the expectations below are still calculated in double precision on the host
+            StructuredAnalyticsWarningMessage("XvaEngineCG", "Double precision not supported",
+                                              "External compute device '" + externalComputeDevice_ +
+                                                  "' does not support double precision, fall back to single precision "
+                                                  "storage of path values with double precision regressions.")
+                .log();
+            externalComputeDeviceSettings.useDoublePrecision = false;
+        }
         externalComputeDeviceSettings.rngSequenceType = scenarioGeneratorData_->sequenceType();
         externalComputeDeviceSettings.rngSeed = scenarioGeneratorData_->seed();
         externalComputeDeviceSettings.regressionOrder = 4;
+        externalComputeDeviceSettings.regressionOnDevice = regressionOnExternalDevice_;
         externalCalculationId_ = ComputeEnvironment::instance()
                                      .context()
                                      .initiateCalculation(model_->size(), 0, 0, externalComputeDeviceSettings)
@@ -342,7 +545,7 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         }
 
         for (auto const& [n, v] : baseModelParams_) {
-            keepNodes[n] = true;
+            keepNodes[nodeMap_[n]] = true;
         }
 
         for (auto const n : g->redBlockDependencies()) {
@@ -354,7 +557,7 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         if (bumpCvaSensis_) {
             for (auto const& rv : model_->randomVariates())
                 for (auto const& v : rv)
-                    keepNodes[v] = true;
+                    keepNodes[nodeMap_[v]] = true;
         }
     }
 
@@ -362,10 +565,33 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         keepNodes[n] = true;
     }
 
-    keepNodes[cvaNode] = true;
+    for (auto const& [_, n] : xvaNodes)
+        keepNodes[n] = true;
+
+    // with checkpointing we only keep the values required to recompute the segments in the backward sweep
+
+    bool useCheckpointing =
+        sensitivityData_ && !bumpCvaSensis_ && !useExternalComputeDevice_ && checkpointInterval_ > 0;
+    std::vector<bool> fwdKeepNodes = keepNodes;
+    if (useCheckpointing) {
+        fwdKeepNodes = checkpointKeepNodes(*g, checkpointInterval_, keepNodes);
+        LOG("XvaEngineCG: use checkpointing with interval "
+            << checkpointInterval_ << ", keep " << std::count(fwdKeepNodes.begin(), fwdKeepNodes.end(), true)
+            << " nodes in forward evaluation");
+    }
 
     std::vector<bool> rvOpAllowsPredeletion = QuantExt::getRandomVariableOpAllowsPredeletion();
 
+    // for the multi-threaded evaluation on the cpu the wavefronts are computed once and reused for the bump sensis
+
+    ChunkWorkers workers(nThreads_);
+    std::vector<std::vector<std::size_t>> wavefronts;
+    if (!useExternalComputeDevice_ && nThreads_ > 1) {
+        wavefronts = computationGraphWavefronts(*g);
+        LOG("XvaEngineCG: use " << nThreads_ << " threads for forward evaluation, got " << wavefronts.size()
+                                << " wavefronts");
+    }
+
     std::vector<std::vector<double>> externalOutput;
     std::vector<double*> externalOutputPtr;
     if (useExternalComputeDevice_) {
@@ -375,19 +601,33 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         for (Size i = 0; i < pfExposureNodes.size(); ++i) {
             valuesExternal[pfExposureNodes[i]].declareAsOutput();
         }
-        valuesExternal[cvaNode].declareAsOutput();
-        externalOutput.resize(pfExposureNodes.size() + 1, std::vector<double>(model_->size()));
+        for (auto const& [_, n] : xvaNodes)
+            valuesExternal[n].declareAsOutput();
+        externalOutput.resize(pfExposureNodes.size() + xvaNodes.size(), std::vector<double>(model_->size()));
         externalOutputPtr.resize(externalOutput.size());
         std::transform(externalOutput.begin(), externalOutput.end(), externalOutputPtr.begin(),
                        [](std::vector<double>& v) { return &v[0]; });
         ComputeEnvironment::instance().context().finalizeCalculation(externalOutputPtr);
+        if (externalCalculationValidationTolerance_ != Null<Real>()) {
+            std::vector<std::size_t> outputNodes(pfExposureNodes);
+            for (auto const& [_, n] : xvaNodes)
+                outputNodes.push_back(n);
+            validateExternalCalculation(keepNodes, outputNodes, externalOutput, externalComputeDeviceSettings);
+        }
         // could skip this and use externalOutput directly below, but it's more convenient to copy the results to values
         for (Size i = 0; i < pfExposureNodes.size(); ++i) {
             values[pfExposureNodes[i]] = RandomVariable(model_->size(), externalOutputPtr[i]);
         }
-        values[cvaNode] = RandomVariable(model_->size(), externalOutputPtr.back());
+        for (Size k = 0; k < xvaNodes.size(); ++k) {
+            values[xvaNodes[k].second] =
+                RandomVariable(model_->size(), externalOutputPtr[pfExposureNodes.size() + k]);
+        }
+    } else if (nThreads_ > 1) {
+        parallelForwardEvaluation(*g, values, ops_, workers, RandomVariable::deleter,
+                                  !bumpCvaSensis_ && !useCheckpointing, opNodeRequirements_, fwdKeepNodes, wavefronts);
     } else {
-        forwardEvaluation(*g, values, ops_, RandomVariable::deleter, !bumpCvaSensis_, opNodeRequirements_, keepNodes);
+        forwardEvaluation(*g, values, ops_, RandomVariable::deleter, !bumpCvaSensis_ && !useCheckpointing,
+                          opNodeRequirements_, fwdKeepNodes);
     }
 
     boost::timer::nanosecond_type timing10 = timer.elapsed().wall;
@@ -409,8 +649,24 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         epeReport_->end();
     }
 
-    Real cva = expectation(values[cvaNode]).at(0);
-    LOG("XvaEngineCG: Calcuated CVA (node " << cvaNode << ") = " << cva);
+    LOG("XvaEngineCG: Write xva report.");
+
+    std::vector<Real> xva(xvaNodes.size());
+    {
+        xvaReport_ = QuantLib::ext::make_shared<InMemoryReport>();
+        xvaReport_->addColumn("NettingSetId", string()).addColumn("XVA", string()).addColumn("Value", double(), 2);
+        for (Size k = 0; k < xvaNodes.size(); ++k) {
+            xva[k] = expectation(values[xvaNodes[k].second]).at(0);
+            LOG("XvaEngineCG: Calculated " << xvaNodes[k].first << " (node " << xvaNodes[k].second
+                                           << ") = " << xva[k]);
+            auto pos = xvaNodes[k].first.find('/');
+            xvaReport_->next();
+            xvaReport_->add(pos == std::string::npos ? std::string() : xvaNodes[k].first.substr(pos + 1))
+                .add(xvaNodes[k].first.substr(0, pos))
+                .add(xva[k]);
+        }
+        xvaReport_->end();
+    }
 
     rvMemMax = std::max(rvMemMax, numberOfStochasticRvs(values) + numberOfStochasticRvs(derivatives));
 
@@ -424,38 +680,54 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
 
         timing11 = timer.elapsed().wall;
 
-        std::vector<double> modelParamDerivatives(baseModelParams_.size());
+        // model param derivatives per xva node
 
-        if (!bumpCvaSensis_) {
+        std::vector<std::vector<double>> modelParamDerivatives(xvaNodes.size(),
+                                                               std::vector<double>(baseModelParams_.size()));
 
-            LOG("XvaEngineCG: run backward derivatives");
+        if (!bumpCvaSensis_) {
 
-            derivatives[cvaNode] = RandomVariable(model_->size(), 1.0);
+            LOG("XvaEngineCG: run backward derivatives for " << xvaNodes.size() << " xva nodes");
 
             std::vector<bool> keepNodesDerivatives(g->size(), false);
 
             for (auto const& [n, _] : baseModelParams_)
-                keepNodesDerivatives[n] = true;
+                keepNodesDerivatives[nodeMap_[n]] = true;
 
-            // backward derivatives run
+            // one backward derivatives run per xva node, the runs do not release the values required by later runs
 
-            backwardDerivatives(*g, values, derivatives, grads_, RandomVariable::deleter, keepNodesDerivatives, ops_,
-                                opNodeRequirements_, keepNodes, RandomVariableOpCode::ConditionalExpectation,
-                                ops_[RandomVariableOpCode::ConditionalExpectation]);
+            for (Size k = 0; k < xvaNodes.size(); ++k) {
 
-            // read model param derivatives
+                if (k > 0)
+                    std::fill(derivatives.begin(), derivatives.end(), RandomVariable(model_->size(), 0.0));
+                derivatives[xvaNodes[k].second] = RandomVariable(model_->size(), 1.0);
 
-            Size i = 0;
-            for (auto const& [n, v] : baseModelParams_) {
-                modelParamDerivatives[i++] = expectation(derivatives[n]).at(0);
-            }
+                if (useCheckpointing) {
+                    backwardDerivativesCheckpointed(*g, values, derivatives, grads_, RandomVariable::deleter,
+                                                    keepNodesDerivatives, ops_, fwdKeepNodes, checkpointInterval_,
+                                                    RandomVariableOpCode::ConditionalExpectation,
+                                                    ops_[RandomVariableOpCode::ConditionalExpectation]);
+                } else {
+                    backwardDerivatives(*g, values, derivatives, grads_, RandomVariable::deleter,
+                                        keepNodesDerivatives, ops_, opNodeRequirements_, keepNodes,
+                                        RandomVariableOpCode::ConditionalExpectation,
+                                        ops_[RandomVariableOpCode::ConditionalExpectation]);
+                }
 
-            // get mem consumption
+                // read model param derivatives
 
-            rvMemMax = std::max(rvMemMax, numberOfStochasticRvs(values) + numberOfStochasticRvs(derivatives));
+                Size i = 0;
+                for (auto const& [n, v] : baseModelParams_) {
+                    modelParamDerivatives[k][i++] = expectation(derivatives[nodeMap_[n]]).at(0);
+                }
 
-            LOG("XvaEngineCG: got " << modelParamDerivatives.size()
-                                    << " model parameter derivatives from run backward derivatives");
+                // get mem consumption
+
+                rvMemMax = std::max(rvMemMax, numberOfStochasticRvs(values) + numberOfStochasticRvs(derivatives));
+            }
+
+            LOG("XvaEngineCG: got " << baseModelParams_.size()
+                                    << " model parameter derivatives per xva node from run backward derivatives");
 
             timing11 = timer.elapsed().wall;
 
@@ -477,9 +749,16 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
 
         simMarket_->scenarioGenerator() = sensiScenarioGenerator_;
 
-        auto resultCube = QuantLib::ext::make_shared<DoublePrecisionSensiCube>(std::set<std::string>{"CVA"}, asof_,
-                                                                               sensiScenarioGenerator_->samples());
-        resultCube->setT0(cva, 0, 0);
+        std::set<std::string> xvaIds;
+        for (auto const& [name, _] : xvaNodes)
+            xvaIds.insert(name);
+        auto resultCube =
+            QuantLib::ext::make_shared<DoublePrecisionSensiCube>(xvaIds, asof_, sensiScenarioGenerator_->samples());
+        std::vector<Size> cubeIndex(xvaNodes.size());
+        for (Size k = 0; k < xvaNodes.size(); ++k) {
+            cubeIndex[k] = resultCube->idsAndIndexes().at(xvaNodes[k].first);
+            resultCube->setT0(xva[k], cubeIndex[k], 0);
+        }
 
         model_->alwaysForwardNotifications();
 
@@ -496,7 +775,7 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
 
             camBuilder_->recalibrate();
 
-            Real sensi = 0.0;
+            std::vector<Real> sensi(xvaNodes.size(), 0.0);
 
             // calculate sensi if model was notified of a change
 
@@ -507,23 +786,25 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
 
                 if (!bumpCvaSensis_) {
 
-                    // calcuate CVA sensi using ad derivatives
+                    // calcuate xva sensis using ad derivatives
 
                     auto modelParameters = model_->modelParameters();
-                    Size i = 0;
-                    boost::accumulators::accumulator_set<
-                        double, boost::accumulators::stats<boost::accumulators::tag::weighted_sum>, double>
-                        acc;
-                    for (auto const& [n, v0] : baseModelParams_) {
-                        Real v1 = modelParameters[i].second;
-                        acc(modelParamDerivatives[i], boost::accumulators::weight = (v1 - v0));
-                        ++i;
+                    for (Size k = 0; k < xvaNodes.size(); ++k) {
+                        Size i = 0;
+                        boost::accumulators::accumulator_set<
+                            double, boost::accumulators::stats<boost::accumulators::tag::weighted_sum>, double>
+                            acc;
+                        for (auto const& [n, v0] : baseModelParams_) {
+                            Real v1 = modelParameters[i].second;
+                            acc(modelParamDerivatives[k][i], boost::accumulators::weight = (v1 - v0));
+                            ++i;
+                        }
+                        sensi[k] = boost::accumulators::weighted_sum(acc);
                     }
-                    sensi = boost::accumulators::weighted_sum(acc);
 
                 } else {
 
-                    // calcuate CVA sensi doing full recalc of CVA
+                    // calcuate xva sensis doing full recalc of xva
 
                     if (useExternalComputeDevice_) {
                         ComputeEnvironment::instance().context().initiateCalculation(
@@ -531,19 +812,29 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
                         populateConstants(values, valuesExternal);
                         populateModelParameters(model_->modelParameters(), values, valuesExternal);
                         ComputeEnvironment::instance().context().finalizeCalculation(externalOutputPtr);
-                        values[cvaNode] = RandomVariable(model_->size(), externalOutputPtr.back());
+                        for (Size k = 0; k < xvaNodes.size(); ++k) {
+                            values[xvaNodes[k].second] =
+                                RandomVariable(model_->size(), externalOutputPtr[pfExposureNodes.size() + k]);
+                        }
                     } else {
                         populateModelParameters(model_->modelParameters(), values, valuesExternal);
-                        forwardEvaluation(*g, values, ops_, RandomVariable::deleter, true, opNodeRequirements_,
-                                          keepNodes);
+                        if (nThreads_ > 1) {
+                            parallelForwardEvaluation(*g, values, ops_, workers, RandomVariable::deleter, true,
+                                                      opNodeRequirements_, keepNodes, wavefronts);
+                        } else {
+                            forwardEvaluation(*g, values, ops_, RandomVariable::deleter, true, opNodeRequirements_,
+                                              keepNodes);
+                        }
                     }
-                    sensi = expectation(values[cvaNode]).at(0) - cva;
+                    for (Size k = 0; k < xvaNodes.size(); ++k)
+                        sensi[k] = expectation(values[xvaNodes[k].second]).at(0) - xva[k];
                 }
             }
 
             // set result in cube
 
-            resultCube->set(cva + sensi, 0, 0, sample, 0);
+            for (Size k = 0; k < xvaNodes.size(); ++k)
+                resultCube->set(xva[k] + sensi[k], cubeIndex[k], 0, sample, 0);
         }
 
         timing12 = timer.elapsed().wall;
@@ -613,7 +904,7 @@ void XvaEngineCG::populateRandomVariates(std::vector<RandomVariable>& values,
             auto gen = ComputeEnvironment::instance().context().createInputVariates(rv.size(), rv.front().size());
             for (Size k = 0; k < rv.size(); ++k) {
                 for (Size j = 0; j < rv.front().size(); ++j)
-                    valuesExternal[rv[k][j]] = ExternalRandomVariable(gen[k][j]);
+                    valuesExternal[nodeMap_[rv[k][j]]] = ExternalRandomVariable(gen[k][j]);
             }
         } else {
             if (scenarioGeneratorData_->sequenceType() == QuantExt::SequenceType::MersenneTwister &&
@@ -625,7 +916,7 @@ void XvaEngineCG::populateRandomVariates(std::vector<RandomVariable>& values,
                 for (Size j = 0; j < rv.front().size(); ++j) {
                     for (Size i = 0; i < rv.size(); ++i) {
                         for (Size path = 0; path < model_->size(); ++path) {
-                            values[rv[i][j]].set(path, icn(rng->nextReal()));
+                            values[nodeMap_[rv[i][j]]].set(path, icn(rng->nextReal()));
                         }
                     }
                 }
@@ -639,7 +930,7 @@ void XvaEngineCG::populateRandomVariates(std::vector<RandomVariable>& values,
                     auto p = gen->next();
                     for (Size j = 0; j < rv.front().size(); ++j) {
                         for (Size k = 0; k < rv.size(); ++k) {
-                            values[rv[k][j]].set(path, p.value[j][k]);
+                            values[nodeMap_[rv[k][j]]].set(path, p.value[j][k]);
                         }
                     }
                 }
@@ -655,8 +946,7 @@ void XvaEngineCG::populateConstants(std::vector<RandomVariable>& values,
 
     DLOG("XvaEngineCG: populate constants");
 
-    auto g = model_->computationGraph();
-    for (auto const& c : g->constants()) {
+    for (auto const& c : optimisedGraph_->constants()) {
         if (useExternalComputeDevice_) {
             valuesExternal[c.second] = ExternalRandomVariable(c.first);
         } else {
@@ -664,7 +954,7 @@ void XvaEngineCG::populateConstants(std::vector<RandomVariable>& values,
         }
     }
 
-    DLOG("XvaEngineCG: set " << g->constants().size() << " constants");
+    DLOG("XvaEngineCG: set " << optimisedGraph_->constants().size() << " constants");
 }
 
 void XvaEngineCG::populateModelParameters(const std::vector<std::pair<std::size_t, double>>& modelParameters,
@@ -675,14 +965,83 @@ void XvaEngineCG::populateModelParameters(const std::vector<std::pair<std::size_
 
     for (auto const& [n, v] : modelParameters) {
         if (useExternalComputeDevice_) {
-            valuesExternal[n] = ExternalRandomVariable(v);
+            valuesExternal[nodeMap_[n]] = ExternalRandomVariable(v);
         } else {
-            values[n] = RandomVariable(model_->size(), v);
+            values[nodeMap_[n]] = RandomVariable(model_->size(), v);
         }
     }
 
     DLOG("XvaEngineCG: set " << modelParameters.size() << " model parameters.");
 }
 
+void XvaEngineCG::validateExternalCalculation(const std::vector<bool>& keepNodes,
+                                              const std::vector<std::size_t>& outputNodes,
+                                              const std::vector<std::vector<double>>& externalOutput,
+                                              ComputeContext::Settings settings) const {
+
+    // replay the calculation on the same graph on the basic cpu device in double precision, this device generates
+    // the same random variates as the external devices
+
+    const std::string referenceDevice = "BasicCpu/Default/Default";
+
+    LOG("XvaEngineCG: validate external calculation on '" << externalComputeDevice_ << "' against double precision "
+                                                          << "reference calculation on '" << referenceDevice << "'");
+
+    settings.useDoublePrecision = true;
+    ComputeEnvironment::instance().selectContext(referenceDevice);
+    std::size_t id = ComputeEnvironment::instance().context().initiateCalculation(model_->size(), 0, 0, settings).first;
+
+    std::vector<std::vector<double>> referenceOutput(outputNodes.size(), std::vector<double>(model_->size()));
+    try {
+        std::vector<RandomVariable> values;
+        std::vector<ExternalRandomVariable> valuesExternal(optimisedGraph_->size());
+        populateConstants(values, valuesExternal);
+        populateModelParameters(baseModelParams_, values, valuesExternal);
+        populateRandomVariates(values, valuesExternal);
+        forwardEvaluation(*optimisedGraph_, valuesExternal, opsExternal_, ExternalRandomVariable::deleter, false,
+                          opNodeRequirements_, keepNodes, 0, ComputationGraph::nan, false,
+                          ExternalRandomVariable::preDeleter, QuantExt::getRandomVariableOpAllowsPredeletion());
+        for (auto const n : outputNodes)
+            valuesExternal[n].declareAsOutput();
+        ComputeEnvironment::instance().context().finalizeCalculation(referenceOutput);
+    } catch (...) {
+        ComputeEnvironment::instance().context().disposeCalculation(id);
+        ComputeEnvironment::instance().selectContext(externalComputeDevice_);
+        throw;
+    }
+    ComputeEnvironment::instance().context().disposeCalculation(id);
+    ComputeEnvironment::instance().selectContext(externalComputeDevice_);
+
+    // compare the expectations of the outputs (the exposures and the xva), relative to the reference expectation or
+    // absolute if the latter is smaller than one
+
+    Real maxDeviation = 0.0;
+    Size nFailed = 0;
+    for (Size i = 0; i < outputNodes.size(); ++i) {
+        Real ext = expectation(RandomVariable(model_->size(), &externalOutput[i][0])).at(0);
+        Real ref = expectation(RandomVariable(model_->size(), &referenceOutput[i][0])).at(0);
+        Real deviation = std::abs(ext - ref) / std::max(std::abs(ref), 1.0);
+        maxDeviation = std::max(maxDeviation, deviation);
+        DLOG("XvaEngineCG: output #" << i << " (node " << outputNodes[i] << "): external " << ext << ", reference "
+                                     << ref << ", deviation " << deviation);
+        if (deviation > externalCalculationValidationTolerance_) {
+            ++nFailed;
+            WLOG("XvaEngineCG: output #" << i << " (node " << outputNodes[i] << ") deviates from reference: external "
+                                         << ext << ", reference " << ref << ", deviation " << deviation);
+        }
+    }
+
+    LOG("XvaEngineCG: validated " << outputNodes.size() << " outputs, max deviation " << maxDeviation);
+
+    if (nFailed > 0) {
+        StructuredAnalyticsWarningMessage("XvaEngineCG", "External calculation validation failed",
+                                          std::to_string(nFailed) + " of " + std::to_string(outputNodes.size()) +
+                                              " outputs deviate from the double precision reference by more than " +
+                                              std::to_string(externalCalculationValidationTolerance_) +
+                                              ", max deviation is " + std::to_string(maxDeviation))
+            .log();
+    }
+}
+
 } // namespace analytics
 } // namespace ore
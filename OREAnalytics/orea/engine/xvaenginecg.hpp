@@ -31,6 +31,7 @@
 #include <ored/configuration/curveconfigurations.hpp>
 #include <ored/marketdata/loader.hpp>
 #include <ored/model/crossassetmodelbuilder.hpp>
+#include <ored/portfolio/nettingsetmanager.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/scripting/models/gaussiancamcg.hpp>
 #include <ored/utilities/progressbar.hpp>
@@ -38,8 +39,10 @@
 #include <ored/marketdata/todaysmarket.hpp>
 
 #include <qle/ad/external_randomvariable_ops.hpp>
+#include <qle/math/computeenvironment.hpp>
 
 #include <ql/types.hpp>
+#include <ql/utilities/null.hpp>
 
 namespace ore {
 namespace analytics {
@@ -47,6 +50,13 @@ namespace analytics {
 using namespace QuantLib;
 using namespace ore::data;
 
+/*! XVA and XVA sensitivities using the computation graph
+
+    The exposures are aggregated per netting set and collateralised according to the netting set definitions, if
+    given. From these we compute the CVA against the counterparty of the netting set, the DVA if a dva name is given
+    and the FCA, FBA if a fva borrowing resp. lending curve is given, per netting set and in total. The sensitivities
+    of all these XVAs are computed by one backward derivatives run per XVA on the values of a single forward
+    evaluation, or by bump and revalue if bumpCvaSensis is true. */
 class XvaEngineCG : public ore::data::ProgressReporter {
 public:
     XvaEngineCG(const Size nThreads, const Date& asof, const QuantLib::ext::shared_ptr<ore::data::Loader>& loader,
@@ -66,9 +76,16 @@ public:
                 const bool externalDeviceCompatibilityMode = false,
                 const bool useDoublePrecisionForExternalCalculation = false,
                 const std::string& externalComputeDevice = std::string(), const bool continueOnCalibrationError = true,
-                const bool continueOnError = true, const std::string& context = "xva engine cg");
+                const bool continueOnError = true, const std::string& context = "xva engine cg",
+                const Size checkpointInterval = 0,
+                const Real externalCalculationValidationTolerance = Null<Real>(),
+                const bool regressionOnExternalDevice = false,
+                const QuantLib::ext::shared_ptr<NettingSetManager>& nettingSetManager = nullptr,
+                const std::string& dvaName = std::string(), const std::string& fvaBorrowingCurve = std::string(),
+                const std::string& fvaLendingCurve = std::string());
 
     QuantLib::ext::shared_ptr<InMemoryReport> exposureReport() { return epeReport_; }
+    QuantLib::ext::shared_ptr<InMemoryReport> xvaReport() { return xvaReport_; }
     QuantLib::ext::shared_ptr<InMemoryReport> sensiReport() { return sensiReport_; }
 
 private:
@@ -79,8 +96,12 @@ private:
     void populateModelParameters(const std::vector<std::pair<std::size_t, double>>& modelParameters,
                                  std::vector<RandomVariable>& values,
                                  std::vector<ExternalRandomVariable>& valuesExternal) const;
+    void validateExternalCalculation(const std::vector<bool>& keepNodes, const std::vector<std::size_t>& outputNodes,
+                                     const std::vector<std::vector<double>>& externalOutput,
+                                     ComputeContext::Settings settings) const;
 
     // input parameters
+    Size nThreads_;
     Date asof_;
     QuantLib::ext::shared_ptr<ore::data::Loader> loader_;
     QuantLib::ext::shared_ptr<ore::data::CurveConfigurations> curveConfigs_;
@@ -103,6 +124,13 @@ private:
     bool continueOnCalibrationError_;
     bool continueOnError_;
     std::string context_;
+    Size checkpointInterval_;
+    Real externalCalculationValidationTolerance_;
+    bool regressionOnExternalDevice_;
+    QuantLib::ext::shared_ptr<NettingSetManager> nettingSetManager_;
+    std::string dvaName_;
+    std::string fvaBorrowingCurve_;
+    std::string fvaLendingCurve_;
 
     // artefacts produced during run
     QuantLib::ext::shared_ptr<ore::data::Market> initMarket_;
@@ -110,6 +138,8 @@ private:
     QuantLib::ext::shared_ptr<SensitivityScenarioGenerator> sensiScenarioGenerator_;
     QuantLib::ext::shared_ptr<CrossAssetModelBuilder> camBuilder_;
     QuantLib::ext::shared_ptr<GaussianCamCG> model_;
+    QuantLib::ext::shared_ptr<ComputationGraph> optimisedGraph_;
+    std::vector<std::size_t> nodeMap_; // model graph node => optimised graph node
     std::vector<std::pair<std::size_t, double>> baseModelParams_;
     std::vector<RandomVariableOpNodeRequirements> opNodeRequirements_;
     std::vector<RandomVariableOp> ops_;
@@ -119,7 +149,7 @@ private:
     std::size_t externalCalculationId_;
 
     // output reports
-    QuantLib::ext::shared_ptr<InMemoryReport> epeReport_, sensiReport_;
+    QuantLib::ext::shared_ptr<InMemoryReport> epeReport_, xvaReport_, sensiReport_;
 };
 
 } // namespace analytics
@@ -21,6 +21,8 @@
 #include <orea/app/structuredanalyticserror.hpp>
 #include <ored/utilities/to_string.hpp>
 
+#include <qle/math/chunkworkers.hpp>
+
 #include <boost/numeric/ublas/vector.hpp>
 
 using namespace QuantLib;
@@ -50,16 +52,51 @@ ZeroToParCube::ZeroToParCube(const std::vector<QuantLib::ext::shared_ptr<Sensiti
     for (auto const& k : parConverter_->rawKeys()) {
         factorToIndex_[k] = counter++;
     }
+    parKeys_.assign(parConverter_->parKeys().begin(), parConverter_->parKeys().end());
+    zeroShifts_.assign(parConverter_->zeroShifts().begin(), parConverter_->zeroShifts().end());
+    parShifts_.assign(parConverter_->parShifts().begin(), parConverter_->parShifts().end());
+    conversionColumns_ = parConverter_->conversionMatrixColumns();
+    QL_REQUIRE(zeroShifts_.size() == factorToIndex_.size() && conversionColumns_.size() == factorToIndex_.size() &&
+                   parShifts_.size() == parKeys_.size(),
+               "ZeroToParCube: conversion matrix, shift sizes and keys of par converter do not match");
 }
 
 map<RiskFactorKey, Real> ZeroToParCube::parDeltas(QuantLib::Size cubeIdx, QuantLib::Size tradeIdx) const {
+    std::vector<Real> parSensitivities;
+    return parDeltas(cubeIdx, tradeIdx, parSensitivities);
+}
+
+std::vector<map<RiskFactorKey, Real>> ZeroToParCube::allParDeltas(QuantLib::Size cubeIdx,
+                                                                  QuantLib::Size nThreads) const {
+    QL_REQUIRE(cubeIdx < zeroCubes_.size(), "ZeroToParCube::allParDeltas(): cubeIdx ("
+                                                << cubeIdx << ") out of range 0..." << (zeroCubes_.size() - 1));
+    std::vector<Size> tradeIndices;
+    Size n = 0;
+    for (auto const& [id, idx] : zeroCubes_[cubeIdx]->tradeIdx()) {
+        tradeIndices.push_back(idx);
+        n = std::max(n, idx + 1);
+    }
+    std::vector<map<RiskFactorKey, Real>> result(n);
+    QuantExt::ChunkWorkers workers(nThreads);
+    Size nChunks = std::min(tradeIndices.size(), 4 * workers.nThreads());
+    workers.run(nChunks, [this, cubeIdx, nChunks, &tradeIndices, &result](const Size c) {
+        std::vector<Real> parSensitivities;
+        for (Size i = c; i < tradeIndices.size(); i += nChunks)
+            result[tradeIndices[i]] = parDeltas(cubeIdx, tradeIndices[i], parSensitivities);
+    });
+    return result;
+}
+
+map<RiskFactorKey, Real> ZeroToParCube::parDeltas(QuantLib::Size cubeIdx, QuantLib::Size tradeIdx,
+                                                  std::vector<Real>& parSensitivities) const {
 
     DLOG("Calculating par deltas for trade index " << tradeIdx);
 
     map<RiskFactorKey, Real> result;
 
-    // Get the "par-convertible" zero deltas
-    boost::numeric::ublas::vector<Real> zeroDeltas(parConverter_->rawKeys().size(), 0.0);
+    // The par sensitivities are accumulated from the sparse columns of the conversion matrix for the non-zero
+    // "par-convertible" zero deltas
+    parSensitivities.assign(parKeys_.size(), 0.0);
 
     QL_REQUIRE(cubeIdx < zeroCubes_.size(),
                "ZeroToParCube::parDeltas(): cubeIdx (" << cubeIdx << ") out of range 0..." << (zeroCubes_.size() - 1));
@@ -88,18 +125,18 @@ map<RiskFactorKey, Real> ZeroToParCube::parDeltas(QuantLib::Size cubeIdx, QuantL
                 }
             }
         } else {
-            zeroDeltas[it->second] = zeroCube->delta(tradeIdx, rk);
+            Real zeroDeriv = zeroCube->delta(tradeIdx, rk) / zeroShifts_[it->second];
+            for (auto const& [parIdx, value] : conversionColumns_[it->second])
+                parSensitivities[parIdx] += value * zeroDeriv;
         }
     }
 
-    // Convert the zero deltas to par deltas
-    boost::numeric::ublas::vector<Real> parDeltas = parConverter_->convertSensitivity(zeroDeltas);
-    Size counter = 0;
-    for (const auto& key : parConverter_->parKeys()) {
-        if (!close(parDeltas[counter], 0.0)) {
-            result[key] = parDeltas[counter];
+    // Scale to the first order NPV change due to the configured shift in each of the par factors
+    for (Size i = 0; i < parKeys_.size(); ++i) {
+        Real parDelta = parSensitivities[i] * parShifts_[i];
+        if (!close(parDelta, 0.0)) {
+            result[parKeys_[i]] = parDelta;
         }
-        counter++;
     }
 
     // Add non-zero deltas that do not need to be converted from underlying zero cube
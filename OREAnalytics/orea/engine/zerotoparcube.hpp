@@ -65,10 +65,23 @@ public:
     std::map<ore::analytics::RiskFactorKey, QuantLib::Real> parDeltas(QuantLib::Size cubeIdx,
                                                                       QuantLib::Size tradeIdx) const;
 
+    /*! Return the non-zero par deltas for all trades of the given cube, indexed by the trade index. The trades are
+        converted in parallel using \p nThreads threads. */
+    std::vector<std::map<ore::analytics::RiskFactorKey, QuantLib::Real>>
+    allParDeltas(QuantLib::Size cubeIdx, QuantLib::Size nThreads = 1) const;
+
 private:
+    //! Par deltas for the given cube and trade index, \p parSensitivities is a workspace of size parKeys()
+    std::map<ore::analytics::RiskFactorKey, QuantLib::Real>
+    parDeltas(QuantLib::Size cubeIdx, QuantLib::Size tradeIdx, std::vector<QuantLib::Real>& parSensitivities) const;
+
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::SensitivityCube>> zeroCubes_;
     QuantLib::ext::shared_ptr<ParSensitivityConverter> parConverter_;
     std::map<ore::analytics::RiskFactorKey, Size> factorToIndex_;
+    //! Par keys, zero and par shift sizes and the sparse columns of the conversion matrix from the par converter
+    std::vector<ore::analytics::RiskFactorKey> parKeys_;
+    std::vector<QuantLib::Real> zeroShifts_, parShifts_;
+    std::vector<std::vector<std::pair<QuantLib::Size, QuantLib::Real>>> conversionColumns_;
 
     //! Set of risk factor types available for par conversion but that are disabled for this instance of ZeroToParCube.
     std::set<ore::analytics::RiskFactorKey::KeyType> typesDisabled_;
@@ -21,6 +21,7 @@
 #include <orea/aggregation/postprocess.hpp>
 #include <orea/aggregation/staticcreditxvacalculator.hpp>
 #include <orea/aggregation/xvacalculator.hpp>
+#include <orea/aggregation/xvaconvergence.hpp>
 #include <orea/app/analytic.hpp>
 #include <orea/app/analytics/analyticfactory.hpp>
 #include <orea/app/analytics/imscheduleanalytic.hpp>
@@ -48,6 +49,7 @@
 #include <orea/app/marketdataloader.hpp>
 #include <orea/app/oreapp.hpp>
 #include <orea/app/parameters.hpp>
+#include <orea/app/pricingservice.hpp>
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/sensitivityrunner.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
@@ -57,19 +59,24 @@
 #include <orea/cube/cube_io.hpp>
 #include <orea/cube/cubecsvreader.hpp>
 #include <orea/cube/cubeinterpretation.hpp>
+#include <orea/cube/cubelayout.hpp>
 #include <orea/cube/cubewriter.hpp>
+#include <orea/cube/flatinmemorycube.hpp>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/jaggedcube.hpp>
 #include <orea/cube/jointnpvcube.hpp>
 #include <orea/cube/jointnpvsensicube.hpp>
+#include <orea/cube/mappedfilecube.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/npvsensicube.hpp>
 #include <orea/cube/sensicube.hpp>
 #include <orea/cube/sensitivitycube.hpp>
 #include <orea/cube/sparsenpvcube.hpp>
 #include <orea/engine/amcvaluationengine.hpp>
+#include <orea/engine/analyticlinearsensitivities.hpp>
 #include <orea/engine/bufferedsensitivitystream.hpp>
 #include <orea/engine/cptycalculator.hpp>
+#include <orea/engine/cubecostestimator.hpp>
 #include <orea/engine/decomposedsensitivitystream.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/historicalpnlgenerator.hpp>
@@ -82,6 +89,7 @@
 #include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/npvrecord.hpp>
 #include <orea/engine/observationmode.hpp>
+#include <orea/engine/observationmodecalibration.hpp>
 #include <orea/engine/parametricvar.hpp>
 #include <orea/engine/parsensitivityanalysis.hpp>
 #include <orea/engine/parsensitivitycubestream.hpp>
@@ -110,6 +118,7 @@
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <orea/scenario/clonedscenariogenerator.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
+#include <orea/scenario/crossassetmodelcomputescenariogenerator.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
 #include <orea/scenario/csvscenariogenerator.hpp>
 #include <orea/scenario/deltascenario.hpp>
@@ -118,7 +127,10 @@
 #include <orea/scenario/historicalscenariogenerator.hpp>
 #include <orea/scenario/historicalscenarioloader.hpp>
 #include <orea/scenario/historicalscenarioreader.hpp>
+#include <orea/scenario/historicalscenariostore.hpp>
 #include <orea/scenario/lgmscenariogenerator.hpp>
+#include <orea/scenario/mappedscenariostore.hpp>
+#include <orea/scenario/pipelinedscenariogenerator.hpp>
 #include <orea/scenario/scenario.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <orea/scenario/scenariofilter.hpp>
@@ -127,6 +139,7 @@
 #include <orea/scenario/scenariogeneratordata.hpp>
 #include <orea/scenario/scenariogeneratortransform.hpp>
 #include <orea/scenario/scenarioshiftcalculator.hpp>
+#include <orea/scenario/scenariostatistics.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
 #include <orea/scenario/scenarioutilities.hpp>
@@ -144,6 +157,7 @@
 #include <orea/simm/crifrecord.hpp>
 #include <orea/simm/imschedulecalculator.hpp>
 #include <orea/simm/imscheduleresults.hpp>
+#include <orea/simm/pathwisesimmcalculator.hpp>
 #include <orea/simm/simmbasicnamemapper.hpp>
 #include <orea/simm/simmbucketmapper.hpp>
 #include <orea/simm/simmbucketmapperbase.hpp>
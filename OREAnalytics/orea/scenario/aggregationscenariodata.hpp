@@ -27,6 +27,8 @@
 #include <ql/types.hpp>
 #include <ql/patterns/observable.hpp>
 
+#include <qle/utilities/memoryaccounting.hpp>
+
 #include <fstream>
 #include <map>
 #include <vector>
@@ -137,6 +139,7 @@ public:
         auto it = data_.find(key);
         if (it == data_.end()) {
             data_.insert(make_pair(key, vector<vector<Real>>(dimDates_, vector<Real>(dimSamples_, 0.0))));
+            memory_.resize(data_.size() * dimDates_ * (dimSamples_ * sizeof(Real) + sizeof(vector<Real>)));
         }
         data_[key][dateIndex][sampleIndex] = value;
     }
@@ -151,8 +154,76 @@ private:
     }
     Size dimDates_, dimSamples_;
     map<std::pair<AggregationScenarioDataType, string>, vector<vector<Real>>> data_;
+    QuantExt::AccountedMemory memory_{QuantExt::MemoryAccounting::Category::ScenarioData};
 };
 
+//! An in memory implementation of AggregationScenarioData with contiguous storage per key
+/*! The values of each key are stored in one contiguous block of dates x samples values of type T, so that float
+    storage halves the memory consumption compared to double. The block of a key can be accessed directly via
+    data(), e.g. to process all samples of one date in one go.
+
+    \ingroup scenario
+*/
+template <typename T> class CompactAggregationScenarioData : public AggregationScenarioData {
+public:
+    CompactAggregationScenarioData(Size dimDates, Size dimSamples)
+        : AggregationScenarioData(), dimDates_(dimDates), dimSamples_(dimSamples) {}
+    Size dimDates() const override { return dimDates_; }
+    Size dimSamples() const override { return dimSamples_; }
+
+    bool has(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
+        return index_.find(std::make_pair(type, qualifier)) != index_.end();
+    }
+
+    Real get(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
+             const string& qualifier = "") const override {
+        check(dateIndex, sampleIndex);
+        return static_cast<Real>(data(type, qualifier)[dateIndex * dimSamples_ + sampleIndex]);
+    }
+
+    std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const override {
+        std::vector<std::pair<AggregationScenarioDataType, std::string>> res;
+        for (auto const& k : index_)
+            res.push_back(k.first);
+        return res;
+    }
+
+    void set(Size dateIndex, Size sampleIndex, Real value, const AggregationScenarioDataType& type,
+             const string& qualifier = "") override {
+        check(dateIndex, sampleIndex);
+        auto key = std::make_pair(type, qualifier);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            it = index_.insert(std::make_pair(key, data_.size())).first;
+            data_.push_back(vector<T>(dimDates_ * dimSamples_, T(0.0)));
+            memory_.resize(data_.size() * dimDates_ * dimSamples_ * sizeof(T));
+        }
+        data_[it->second][dateIndex * dimSamples_ + sampleIndex] = static_cast<T>(value);
+    }
+
+    //! The values of a key, date-major, i.e. the value for date i and sample j is at position i * dimSamples() + j
+    const T* data(const AggregationScenarioDataType& type, const string& qualifier = "") const {
+        auto it = index_.find(std::make_pair(type, qualifier));
+        QL_REQUIRE(it != index_.end(), "CompactAggregationScenarioData: no data for key ("
+                                           << static_cast<unsigned int>(type) << "," << qualifier << ")");
+        return data_[it->second].data();
+    }
+
+private:
+    void check(Size dateIndex, Size sampleIndex) const {
+        QL_REQUIRE(dateIndex < dimDates_, "dateIndex (" << dateIndex << ") out of range 0..." << dimDates_ - 1);
+        QL_REQUIRE(sampleIndex < dimSamples_,
+                   "sampleIndex (" << sampleIndex << ") out of range 0..." << dimSamples_ - 1);
+    }
+    Size dimDates_, dimSamples_;
+    map<std::pair<AggregationScenarioDataType, string>, Size> index_;
+    vector<vector<T>> data_;
+    QuantExt::AccountedMemory memory_{QuantExt::MemoryAccounting::Category::ScenarioData};
+};
+
+using SinglePrecisionAggregationScenarioData = CompactAggregationScenarioData<float>;
+using DoublePrecisionAggregationScenarioData = CompactAggregationScenarioData<double>;
+
 inline std::ostream& operator<<(std::ostream& out, const AggregationScenarioDataType& t) {
     switch (t) {
     case AggregationScenarioDataType::IndexFixing:
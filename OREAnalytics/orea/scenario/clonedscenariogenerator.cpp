@@ -56,5 +56,13 @@ void ClonedScenarioGenerator::reset() {
     nSim_ = 0;
 }
 
+void ClonedScenarioGenerator::setNextSample(const Size sample) {
+    QL_REQUIRE(sample * dates_.size() < scenarios_.size(), "ClonedScenarioGenerator::setNextSample("
+                                                               << sample << "): only "
+                                                               << scenarios_.size() / dates_.size()
+                                                               << " samples stored.");
+    nSim_ = sample;
+}
+
 } // namespace analytics
 } // namespace ore
@@ -0,0 +1,353 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/crossassetmodelcomputescenariogenerator.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/processes/crossassetstateprocess.hpp>
+
+#include <boost/timer/timer.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace std;
+
+namespace ore {
+namespace analytics {
+
+CrossAssetModelComputeScenarioGenerator::CrossAssetModelComputeScenarioGenerator(
+    const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+    const QuantLib::ext::shared_ptr<ScenarioFactory>& scenarioFactory,
+    const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& simMarketConfig, const Date& today,
+    const QuantLib::ext::shared_ptr<DateGrid>& grid, const QuantLib::ext::shared_ptr<ore::data::Market>& initMarket,
+    const std::string& deviceName, const Size samples, const ComputeContext::Settings& settings,
+    const std::string& configuration)
+    : ScenarioPathGenerator(today, grid->dates(), grid->timeGrid()), model_(model), scenarioFactory_(scenarioFactory),
+      simMarketConfig_(simMarketConfig), initMarket_(initMarket), deviceName_(deviceName), samples_(samples),
+      settings_(settings), configuration_(configuration) {
+
+    LOG("CrossAssetModelComputeScenarioGenerator ctor called, device '" << deviceName_ << "', " << samples_
+                                                                        << " samples");
+
+    QL_REQUIRE(initMarket_ != nullptr, "CrossAssetModelComputeScenarioGenerator: initMarket is null");
+    QL_REQUIRE(timeGrid_.size() == dates_.size() + 1, "date/time grid size mismatch");
+    QL_REQUIRE(samples_ > 0, "CrossAssetModelComputeScenarioGenerator: samples must be positive");
+    QL_REQUIRE(!deviceName_.empty(), "CrossAssetModelComputeScenarioGenerator: no device name given");
+
+    // check that the model and the simulated market are supported
+
+    auto process = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(model_->stateProcess());
+    QL_REQUIRE(process && process->hasAffineStep(),
+               "CrossAssetModelComputeScenarioGenerator: model state process step must be affine (requires LGM1F "
+               "based model without CIR++ components)");
+    QL_REQUIRE(model_->measure() == IrModel::Measure::LGM,
+               "CrossAssetModelComputeScenarioGenerator: only the LGM measure is supported");
+    for (auto const t : {CrossAssetModel::AssetType::INF, CrossAssetModel::AssetType::CR,
+                         CrossAssetModel::AssetType::COM, CrossAssetModel::AssetType::CrState}) {
+        QL_REQUIRE(model_->components(t) == 0, "CrossAssetModelComputeScenarioGenerator: model components of type "
+                                                   << t << " are not supported");
+    }
+    Size n_ccy = model_->components(CrossAssetModel::AssetType::IR);
+    for (Size j = 0; j < n_ccy; ++j) {
+        QL_REQUIRE(model_->modelType(CrossAssetModel::AssetType::IR, j) == CrossAssetModel::ModelType::LGM1F,
+                   "CrossAssetModelComputeScenarioGenerator: IR model for "
+                       << model_->parametrizations()[j]->currency().code() << " must be LGM1F");
+    }
+    QL_REQUIRE(!simMarketConfig_->simulateFXVols() &&
+                   (!simMarketConfig_->simulateEquityVols() || simMarketConfig_->equityVolNames().empty()),
+               "CrossAssetModelComputeScenarioGenerator: simulation of FX or EQ vols is not supported");
+    QL_REQUIRE(simMarketConfig_->additionalScenarioDataSurvivalWeights().empty(),
+               "CrossAssetModelComputeScenarioGenerator: survival weights are not supported");
+
+    // keys in the order of the CrossAssetModelScenarioGenerator
+
+    for (Size j = 0; j < n_ccy; ++j) {
+        std::string ccy = model_->parametrizations()[j]->currency().code();
+        ten_dsc_.push_back(simMarketConfig_->yieldCurveTenors(ccy));
+        for (Size k = 0; k < ten_dsc_.back().size(); ++k)
+            keys_.emplace_back(RiskFactorKey::KeyType::DiscountCurve, ccy, k);
+    }
+
+    for (auto const& indexName : simMarketConfig_->indices()) {
+        ten_idx_.push_back(simMarketConfig_->yieldCurveTenors(indexName));
+        for (Size k = 0; k < ten_idx_.back().size(); ++k)
+            keys_.emplace_back(RiskFactorKey::KeyType::IndexCurve, indexName, k);
+        QuantLib::ext::shared_ptr<IborIndex> index = *initMarket_->iborIndex(indexName, configuration_);
+        fwdTargetCurves_.push_back(index->forwardingTermStructure());
+        indexCcyIdx_.push_back(model_->ccyIndex(index->currency()));
+    }
+
+    for (auto const& curveName : simMarketConfig_->yieldCurveNames()) {
+        ten_yc_.push_back(simMarketConfig_->yieldCurveTenors(curveName));
+        for (Size k = 0; k < ten_yc_.back().size(); ++k)
+            keys_.emplace_back(RiskFactorKey::KeyType::YieldCurve, curveName, k);
+        yieldTargetCurves_.push_back(initMarket_->yieldCurve(curveName, configuration_));
+        yieldCurveCcyIdx_.push_back(
+            model_->ccyIndex(parseCurrency(simMarketConfig_->yieldCurveCurrencies().at(curveName))));
+    }
+
+    for (Size k = 0; k + 1 < n_ccy; ++k)
+        keys_.emplace_back(RiskFactorKey::KeyType::FXSpot, model_->parametrizations()[k + 1]->currency().code() +
+                                                               model_->parametrizations()[0]->currency().code());
+
+    for (Size k = 0; k < model_->components(CrossAssetModel::AssetType::EQ); ++k)
+        keys_.emplace_back(RiskFactorKey::KeyType::EquitySpot, model_->eqbs(k)->name());
+
+    LOG("CrossAssetModelComputeScenarioGenerator ctor done, " << keys_.size() << " simulated values per date");
+}
+
+void CrossAssetModelComputeScenarioGenerator::reset() {
+    // the model may have been recalibrated or its curves relinked
+    calculated_ = false;
+    currentSample_ = 0;
+}
+
+namespace {
+
+// value = exp(a + sum_k b_k * x_{s_k}), floored at 0.00001 for the curves
+struct ValueCoefficients {
+    Real a;
+    std::vector<std::pair<Size, Real>> b;
+    bool floor;
+};
+
+// log discount factor P(t, t + T) = a + b * x for an LGM model, see CrossAssetModelScenarioGenerator
+ValueCoefficients lgmPillar(const QuantLib::ext::shared_ptr<IrLgm1fParametrization>& p, const Size stateIndex,
+                            const Time t, const Time T, const Handle<YieldTermStructure>& targetCurve) {
+    Handle<YieldTermStructure> curve = targetCurve.empty() ? p->termStructure() : targetCurve;
+    if (!targetCurve.empty() && QuantLib::close_enough(t, 0.0))
+        return {std::log(curve->discount(T)), {}, true};
+    Real Ht = p->H(t), HT = p->H(t + T);
+    return {std::log(curve->discount(t + T) / curve->discount(t)) - 0.5 * (HT * HT - Ht * Ht) * p->zeta(t),
+            {{stateIndex, -(HT - Ht)}},
+            true};
+}
+
+} // namespace
+
+void CrossAssetModelComputeScenarioGenerator::calculate() {
+
+    LOG("CrossAssetModelComputeScenarioGenerator: calculate " << samples_ << " paths on device '" << deviceName_
+                                                              << "'");
+    boost::timer::cpu_timer timer;
+
+    auto process = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(model_->stateProcess());
+    QL_REQUIRE(process, "CrossAssetModelComputeScenarioGenerator: expected CrossAssetStateProcess");
+    DayCounter dc = model_->irModel(0)->termStructure()->dayCounter();
+    const Size n = process->size();
+    const Size nSteps = timeGrid_.size() - 1;
+    const Size nValues = keys_.size() + 1;
+
+    // coefficients of the simulated values per date, the numeraire comes first, see LGM::numeraire()
+
+    std::vector<ValueCoefficients> values;
+    values.reserve(dates_.size() * nValues);
+    for (Size i = 0; i < dates_.size(); ++i) {
+        Time t = timeGrid_[i + 1];
+        auto p0 = model_->irlgm1f(0);
+        Real H = p0->H(t);
+        values.push_back({0.5 * H * H * p0->zeta(t) - std::log(p0->termStructure()->discount(t)),
+                          {{model_->pIdx(CrossAssetModel::AssetType::IR, 0), H}},
+                          false});
+        for (Size j = 0; j < ten_dsc_.size(); ++j) {
+            for (auto const& p : ten_dsc_[j])
+                values.push_back(lgmPillar(model_->irlgm1f(j), model_->pIdx(CrossAssetModel::AssetType::IR, j), t,
+                                           dc.yearFraction(dates_[i], dates_[i] + p), Handle<YieldTermStructure>()));
+        }
+        for (Size j = 0; j < ten_idx_.size(); ++j) {
+            Size ccy = indexCcyIdx_[j];
+            Time tRel = dc.yearFraction(model_->irModel(ccy)->termStructure()->referenceDate(), dates_[i]);
+            for (auto const& p : ten_idx_[j])
+                values.push_back(lgmPillar(model_->irlgm1f(ccy), model_->pIdx(CrossAssetModel::AssetType::IR, ccy),
+                                           tRel, dc.yearFraction(dates_[i], dates_[i] + p), fwdTargetCurves_[j]));
+        }
+        for (Size j = 0; j < ten_yc_.size(); ++j) {
+            Size ccy = yieldCurveCcyIdx_[j];
+            Time tRel = dc.yearFraction(model_->irModel(ccy)->termStructure()->referenceDate(), dates_[i]);
+            for (auto const& p : ten_yc_[j])
+                values.push_back(lgmPillar(model_->irlgm1f(ccy), model_->pIdx(CrossAssetModel::AssetType::IR, ccy),
+                                           tRel, dc.yearFraction(dates_[i], dates_[i] + p), yieldTargetCurves_[j]));
+        }
+        for (Size k = 0; k < model_->components(CrossAssetModel::AssetType::FX); ++k)
+            values.push_back({0.0, {{model_->pIdx(CrossAssetModel::AssetType::FX, k), 1.0}}, false});
+        for (Size k = 0; k < model_->components(CrossAssetModel::AssetType::EQ); ++k)
+            values.push_back({0.0, {{model_->pIdx(CrossAssetModel::AssetType::EQ, k), 1.0}}, false});
+    }
+    QL_REQUIRE(values.size() == dates_.size() * nValues, "CrossAssetModelComputeScenarioGenerator: internal error, got "
+                                                             << values.size() << " values, expected "
+                                                             << dates_.size() * nValues);
+
+    // set up the calculation
+
+    ComputeEnvironment::instance().selectContext(deviceName_);
+    auto& context = ComputeEnvironment::instance().context();
+    ComputeContext::Settings settings = settings_;
+    if (settings.useDoublePrecision && !context.supportsDoublePrecision()) {
+        WLOG("CrossAssetModelComputeScenarioGenerator: device '" << deviceName_
+                                                                 << "' does not support double precision, fall back "
+                                                                    "to single precision");
+        settings.useDoublePrecision = false;
+    }
+    std::size_t id = context.initiateCalculation(samples_, 0, 0, settings).first;
+    struct DisposeCalculation {
+        ~DisposeCalculation() { context.disposeCalculation(id); }
+        ComputeContext& context;
+        std::size_t id;
+    } disposeCalculation{context, id};
+
+    // input variables, these must all be created before the variates and the operations
+
+    const Size one = Null<Size>();
+    struct Term {
+        Size coefficient, variable;
+    };
+    struct Affine {
+        Size a;
+        std::vector<Term> b;
+    };
+
+    Array x0 = process->initialValues();
+    std::vector<Size> x(n);
+    for (Size k = 0; k < n; ++k)
+        x[k] = context.createInputVariable(x0[k]);
+
+    // state steps x(t+dt) = a + b * x(t) + c * dw, the variables of the terms are the state resp. factor indices
+    std::vector<std::vector<Affine>> steps(nSteps, std::vector<Affine>(n));
+    std::vector<std::vector<Term>> diffusion(nSteps);
+    std::vector<std::vector<Size>> diffusionRow(nSteps);
+    Array a;
+    Matrix b, c;
+    for (Size i = 0; i < nSteps; ++i) {
+        process->affineStep(timeGrid_[i], timeGrid_.dt(i), a, b, c);
+        for (Size r = 0; r < n; ++r) {
+            steps[i][r].a = context.createInputVariable(a[r]);
+            for (Size k = 0; k < n; ++k) {
+                if (b[r][k] != 0.0)
+                    steps[i][r].b.push_back({b[r][k] == 1.0 ? one : context.createInputVariable(b[r][k]), k});
+            }
+            for (Size k = 0; k < c.columns(); ++k) {
+                if (c[r][k] != 0.0) {
+                    diffusion[i].push_back({context.createInputVariable(c[r][k]), k});
+                    diffusionRow[i].push_back(r);
+                }
+            }
+        }
+    }
+
+    std::vector<Affine> outputs(values.size());
+    for (Size v = 0; v < values.size(); ++v) {
+        outputs[v].a = context.createInputVariable(values[v].a);
+        for (auto const& [s, coeff] : values[v].b)
+            outputs[v].b.push_back({coeff == 1.0 ? one : context.createInputVariable(coeff), s});
+    }
+    Size floor = context.createInputVariable(0.00001);
+
+    // variates
+
+    auto dw = context.createInputVariates(process->factors(), nSteps);
+
+    // operations, all intermediate results that are not inputs, variates or outputs are freed
+
+    auto add = [&context, one](const Size sum, const bool ownsSum, const Term& t) {
+        Size term = t.coefficient == one
+                        ? t.variable
+                        : context.applyOperation(RandomVariableOpCode::Mult, {t.coefficient, t.variable});
+        Size result = context.applyOperation(RandomVariableOpCode::Add, {sum, term});
+        if (term != t.variable)
+            context.freeVariable(term);
+        if (ownsSum)
+            context.freeVariable(sum);
+        return result;
+    };
+
+    std::vector<bool> ownsX(n, false);
+    for (Size i = 0; i < nSteps; ++i) {
+        std::vector<Size> y(n);
+        std::vector<bool> ownsY(n, false);
+        for (Size r = 0; r < n; ++r) {
+            y[r] = steps[i][r].a;
+            for (auto const& t : steps[i][r].b) {
+                y[r] = add(y[r], ownsY[r], {t.coefficient, x[t.variable]});
+                ownsY[r] = true;
+            }
+        }
+        for (Size k = 0; k < diffusion[i].size(); ++k) {
+            Size r = diffusionRow[i][k];
+            y[r] = add(y[r], ownsY[r], {diffusion[i][k].coefficient, dw[diffusion[i][k].variable][i]});
+            ownsY[r] = true;
+        }
+        for (Size r = 0; r < n; ++r) {
+            if (ownsX[r])
+                context.freeVariable(x[r]);
+        }
+        x.swap(y);
+        ownsX.swap(ownsY);
+        for (Size v = i * nValues; v < (i + 1) * nValues; ++v) {
+            Size e = outputs[v].a;
+            bool ownsE = false;
+            for (auto const& t : outputs[v].b) {
+                e = add(e, ownsE, {t.coefficient, x[t.variable]});
+                ownsE = true;
+            }
+            Size result = context.applyOperation(RandomVariableOpCode::Exp, {e});
+            if (ownsE)
+                context.freeVariable(e);
+            if (values[v].floor) {
+                Size floored = context.applyOperation(RandomVariableOpCode::Max, {result, floor});
+                context.freeVariable(result);
+                result = floored;
+            }
+            context.declareOutputVariable(result);
+        }
+    }
+
+    // run the calculation and copy the values back to the host
+
+    values_.assign(values.size(), std::vector<double>(samples_));
+    std::vector<double*> output(values_.size());
+    std::transform(values_.begin(), values_.end(), output.begin(), [](std::vector<double>& v) { return v.data(); });
+    context.finalizeCalculation(output);
+
+    calculated_ = true;
+    LOG("CrossAssetModelComputeScenarioGenerator: calculated " << values_.size() << " values x " << samples_
+                                                               << " samples in "
+                                                               << static_cast<double>(timer.elapsed().wall) / 1E6
+                                                               << " ms");
+}
+
+std::vector<QuantLib::ext::shared_ptr<Scenario>> CrossAssetModelComputeScenarioGenerator::nextPath() {
+    if (!calculated_)
+        calculate();
+    QL_REQUIRE(currentSample_ < samples_, "CrossAssetModelComputeScenarioGenerator::nextPath(): all "
+                                              << samples_ << " samples have been generated, reset() required");
+    const Size nValues = keys_.size() + 1;
+    std::vector<QuantLib::ext::shared_ptr<Scenario>> scenarios(dates_.size());
+    for (Size i = 0; i < dates_.size(); ++i) {
+        scenarios[i] = scenarioFactory_->buildScenario(dates_[i], true);
+        scenarios[i]->setNumeraire(values_[i * nValues][currentSample_]);
+        for (Size k = 0; k < keys_.size(); ++k)
+            scenarios[i]->add(keys_[k], values_[i * nValues + k + 1][currentSample_]);
+    }
+    ++currentSample_;
+    return scenarios;
+}
+
+} // namespace analytics
+} // namespace ore
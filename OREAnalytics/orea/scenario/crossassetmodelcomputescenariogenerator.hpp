@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/crossassetmodelcomputescenariogenerator.hpp
+    \brief Scenario generation using cross asset model paths evolved on a compute device
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariofactory.hpp>
+#include <orea/scenario/scenariogenerator.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <ored/marketdata/market.hpp>
+#include <ored/utilities/dategrid.hpp>
+
+#include <qle/math/computeenvironment.hpp>
+#include <qle/models/crossassetmodel.hpp>
+
+namespace ore {
+namespace analytics {
+using namespace data;
+using namespace QuantLib;
+using namespace QuantExt;
+
+//! Scenario Generator using cross asset model paths evolved on a compute device
+/*! The generator evolves the model state for all samples at once on the ComputeContext given by deviceName, using the
+    affine time step of the CrossAssetStateProcess, see CrossAssetStateProcess::affineStep(). The simulated values
+    (numeraire, discount, index and yield curve pillars, FX and equity spots) are computed on the device as well and
+    copied back to the host in one block per run, from which nextPath() builds the scenarios sample by sample.
+
+    The random variates are drawn by the device using the given settings (sequence type and seed), so the paths
+    coincide with the ones of CrossAssetModelScenarioGenerator in distribution only.
+
+    The generator supports models with LGM1F IR components in the LGM measure, FX and EQ components, and the scenario
+    types listed above. Other model components, or simulated FX / EQ vols, inflation, credit, commodity or survival
+    weight data raise an error in the constructor, use the CrossAssetModelScenarioGenerator in these cases.
+
+    The calculation is done on the first call to nextPath() after construction or reset(), it requires
+    samples x dates x simulated values doubles of host memory.
+
+    \ingroup scenario
+ */
+class CrossAssetModelComputeScenarioGenerator : public ScenarioPathGenerator {
+public:
+    CrossAssetModelComputeScenarioGenerator(
+        const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+        const QuantLib::ext::shared_ptr<ScenarioFactory>& scenarioFactory,
+        const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& simMarketConfig, const Date& today,
+        const QuantLib::ext::shared_ptr<DateGrid>& grid, const QuantLib::ext::shared_ptr<ore::data::Market>& initMarket,
+        const std::string& deviceName, const Size samples, const ComputeContext::Settings& settings,
+        const std::string& configuration = Market::defaultConfiguration);
+    std::vector<QuantLib::ext::shared_ptr<Scenario>> nextPath() override;
+    //! resets the generator to the first sample, the paths are recalculated on the next call to nextPath()
+    void reset() override;
+
+private:
+    void calculate();
+
+    QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel> model_;
+    QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory_;
+    QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig_;
+    QuantLib::ext::shared_ptr<ore::data::Market> initMarket_;
+    std::string deviceName_;
+    Size samples_;
+    ComputeContext::Settings settings_;
+    std::string configuration_;
+
+    // keys of the simulated values per date, the numeraire comes first and has no key
+    std::vector<RiskFactorKey> keys_;
+    std::vector<std::vector<Period>> ten_dsc_, ten_idx_, ten_yc_;
+    std::vector<Size> indexCcyIdx_, yieldCurveCcyIdx_;
+    std::vector<Handle<YieldTermStructure>> fwdTargetCurves_, yieldTargetCurves_;
+
+    bool calculated_ = false;
+    Size currentSample_ = 0;
+    // simulated values, value k on date i of sample p is at values_[i * (keys_.size() + 1) + k][p]
+    std::vector<std::vector<double>> values_;
+};
+
+} // namespace analytics
+} // namespace ore
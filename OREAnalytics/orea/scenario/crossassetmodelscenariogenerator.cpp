@@ -34,16 +34,22 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
     QuantLib::ext::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator,
     QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory, QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
     Date today, QuantLib::ext::shared_ptr<DateGrid> grid, QuantLib::ext::shared_ptr<ore::data::Market> initMarket,
-    const std::string& configuration)
+    const std::string& configuration, const Size firstSample)
     : ScenarioPathGenerator(today, grid->dates(), grid->timeGrid()), model_(model), pathGenerator_(pathGenerator),
       scenarioFactory_(scenarioFactory), simMarketConfig_(simMarketConfig), initMarket_(initMarket),
-      configuration_(configuration) {
+      configuration_(configuration), firstSample_(firstSample) {
 
     LOG("CrossAssetModelScenarioGenerator ctor called");
     
     QL_REQUIRE(initMarket != NULL, "CrossAssetScenarioGenerator: initMarket is null");
     QL_REQUIRE(timeGrid_.size() == dates_.size() + 1, "date/time grid size mismatch");
 
+    if (firstSample_ > 0) {
+        QL_REQUIRE(pathGenerator_ != nullptr, "CrossAssetModelScenarioGenerator: pathGenerator is null");
+        LOG("CrossAssetModelScenarioGenerator: skip to sample " << firstSample_);
+        pathGenerator_->skipTo(firstSample_);
+    }
+
     // TODO, curve tenors might be overwritten by dates in simMarketConfig_, here we just take the tenors
 
     DayCounter dc = model_->irModel(0)->termStructure()->dayCounter();
@@ -233,6 +239,7 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
         auto impliedFwdCurve = QuantLib::ext::make_shared<ModelImpliedYtsFwdFwdCorrected>(
             model_->irModel(model_->ccyIndex(index->currency())), fts, dc, false);
         fwdCurves_.push_back(impliedFwdCurve);
+        fwdTargetCurves_.push_back(fts);
         indices_.push_back(index->clone(Handle<YieldTermStructure>(impliedFwdCurve)));
     }
 
@@ -243,9 +250,15 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
         auto impliedYieldCurve =
             QuantLib::ext::make_shared<ModelImpliedYtsFwdFwdCorrected>(model_->irModel(model_->ccyIndex(ccy)), yts, dc, false);
         yieldCurves_.push_back(impliedYieldCurve);
+        yieldTargetCurves_.push_back(yts);
         yieldCurveCurrency_.push_back(ccy);
     }
 
+    dscPillars_.resize(dates_.size());
+    idxPillars_.resize(dates_.size());
+    ycPillars_.resize(dates_.size());
+    pillarsBuilt_.resize(dates_.size(), false);
+
     for (Size j = 0; j < n_com_; ++j) {
         QuantLib::ext::shared_ptr<CommodityModel> cm = model_->comModel(j);
         auto pts = QuantLib::ext::make_shared<QuantExt::ModelImpliedPriceTermStructure>(model_->comModel(j), dc, true);
@@ -320,6 +333,55 @@ void copyPathToArray(const MultiPath& p, Size t, Size a, Array& target) {
 }
 } // namespace
 
+CrossAssetModelScenarioGenerator::PillarCoefficients CrossAssetModelScenarioGenerator::pillarCoefficients(
+    const QuantLib::ext::shared_ptr<IrModel>& irModel, const Time t, const Date& date,
+    const std::vector<Period>& tenors, const Handle<YieldTermStructure>& targetCurve) const {
+    DayCounter dc = model_->irModel(0)->termStructure()->dayCounter();
+    PillarCoefficients c;
+    auto lgm = QuantLib::ext::dynamic_pointer_cast<LinearGaussMarkovModel>(irModel);
+    auto hw = QuantLib::ext::dynamic_pointer_cast<HwModel>(irModel);
+    if (lgm == nullptr && hw == nullptr)
+        return c;
+    Handle<YieldTermStructure> curve = targetCurve.empty() ? irModel->termStructure() : targetCurve;
+    for (auto const& p : tenors) {
+        Time T = dc.yearFraction(date, date + p);
+        if (!targetCurve.empty() && QuantLib::close_enough(t, 0.0)) {
+            // the fwd-fwd corrected ts returns the target curve's discount factors at t = 0
+            c.a.push_back(std::log(curve->discount(T)));
+            c.b.push_back(Array(irModel->n(), 0.0));
+        } else if (lgm != nullptr) {
+            // see LinearGaussMarkovModel::discountBond()
+            auto param = lgm->parametrization();
+            Real Ht = param->H(t), HT = param->H(t + T);
+            c.a.push_back(std::log(curve->discount(t + T) / curve->discount(t)) -
+                          0.5 * (HT * HT - Ht * Ht) * param->zeta(t));
+            c.b.push_back(Array(1, -(HT - Ht)));
+        } else {
+            // see HwModel::discountBond()
+            auto f = HwVectorised(hw->parametrization()).discountBondFactors(t, t + T, curve);
+            c.a.push_back(std::log(f.marketRatio) - f.halfVariance);
+            c.b.push_back(-f.g);
+        }
+    }
+    return c;
+}
+
+void CrossAssetModelScenarioGenerator::populateCurve(const PillarCoefficients& c, const Array& x,
+                                                     const std::vector<RiskFactorKey>& keys, const Size offset,
+                                                     const QuantLib::ext::shared_ptr<Scenario>& scenario) const {
+    for (Size k = 0; k < c.a.size(); ++k)
+        scenario->add(keys[offset + k], std::max(std::exp(c.a[k] + DotProduct(c.b[k], x)), 0.00001));
+}
+
+void CrossAssetModelScenarioGenerator::reset() {
+    // the model may have been recalibrated or its curves relinked
+    pillarsBuilt_.assign(dates_.size(), false);
+    if (firstSample_ > 0)
+        pathGenerator_->skipTo(firstSample_);
+    else
+        pathGenerator_->reset();
+}
+
 std::vector<QuantLib::ext::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextPath() {
     std::vector<QuantLib::ext::shared_ptr<Scenario>> scenarios(dates_.size());
     QL_REQUIRE(pathGenerator_ != nullptr, "CrossAssetModelScenarioGenerator::nextPath(): pathGenerator is null");
@@ -355,8 +417,36 @@ std::vector<QuantLib::ext::shared_ptr<Scenario>> CrossAssetModelScenarioGenerato
         // Set numeraire from domestic ir process
         scenarios[i]->setNumeraire(model_->numeraire(0, t, ir_state[0], Handle<YieldTermStructure>(), ir_state_aux));
 
+        // Pillar coefficients of the ir curves, the relative times of the date based implied term structures are
+        // computed as in ModelImpliedYieldTermStructure::update()
+        if (!pillarsBuilt_[i]) {
+            dscPillars_[i].clear();
+            idxPillars_[i].clear();
+            ycPillars_[i].clear();
+            for (Size j = 0; j < n_ccy_; j++)
+                dscPillars_[i].push_back(
+                    pillarCoefficients(model_->irModel(j), t, dates_[i], ten_dsc_[j], Handle<YieldTermStructure>()));
+            for (Size j = 0; j < n_indices_; ++j) {
+                auto irModel = model_->irModel(indexCcyIdx[j]);
+                Time tRel = dc.yearFraction(irModel->termStructure()->referenceDate(), dates_[i]);
+                idxPillars_[i].push_back(
+                    pillarCoefficients(irModel, tRel, dates_[i], ten_idx_[j], fwdTargetCurves_[j]));
+            }
+            for (Size j = 0; j < n_curves_; ++j) {
+                auto irModel = model_->irModel(yieldCurveCcyIdx[j]);
+                Time tRel = dc.yearFraction(irModel->termStructure()->referenceDate(), dates_[i]);
+                ycPillars_[i].push_back(
+                    pillarCoefficients(irModel, tRel, dates_[i], ten_yc_[j], yieldTargetCurves_[j]));
+            }
+            pillarsBuilt_[i] = true;
+        }
+
         // Discount curves
         for (Size j = 0; j < n_ccy_; j++) {
+            if (!dscPillars_[i][j].a.empty()) {
+                populateCurve(dscPillars_[i][j], ir_state[j], discountCurveKeys_, j * ten_dsc_[j].size(), scenarios[i]);
+                continue;
+            }
             curves_[j]->move(t, ir_state[j]);
             for (Size k = 0; k < ten_dsc_[j].size(); k++) {
                 Date d = dates_[i] + ten_dsc_[j][k];
@@ -368,6 +458,11 @@ std::vector<QuantLib::ext::shared_ptr<Scenario>> CrossAssetModelScenarioGenerato
 
         // Index curves and Index fixings
         for (Size j = 0; j < n_indices_; ++j) {
+            if (!idxPillars_[i][j].a.empty()) {
+                populateCurve(idxPillars_[i][j], ir_state[indexCcyIdx[j]], indexCurveKeys_, j * ten_idx_[j].size(),
+                              scenarios[i]);
+                continue;
+            }
             fwdCurves_[j]->move(dates_[i], ir_state[indexCcyIdx[j]]);
             for (Size k = 0; k < ten_idx_[j].size(); ++k) {
                 Date d = dates_[i] + ten_idx_[j][k];
@@ -379,6 +474,11 @@ std::vector<QuantLib::ext::shared_ptr<Scenario>> CrossAssetModelScenarioGenerato
 
         // Yield curves
         for (Size j = 0; j < n_curves_; ++j) {
+            if (!ycPillars_[i][j].a.empty()) {
+                populateCurve(ycPillars_[i][j], ir_state[yieldCurveCcyIdx[j]], yieldCurveKeys_, j * ten_yc_[j].size(),
+                              scenarios[i]);
+                continue;
+            }
             yieldCurves_[j]->move(dates_[i], ir_state[yieldCurveCcyIdx[j]]);
             for (Size k = 0; k < ten_yc_[j].size(); ++k) {
                 Date d = dates_[i] + ten_yc_[j][k];
@@ -37,6 +37,7 @@
 #include <qle/models/crossassetmodelimpliedfxvoltermstructure.hpp>
 #include <qle/models/dkimpliedyoyinflationtermstructure.hpp>
 #include <qle/models/dkimpliedzeroinflationtermstructure.hpp>
+#include <qle/models/hwvectorised.hpp>
 #include <qle/models/jyimpliedyoyinflationtermstructure.hpp>
 #include <qle/models/jyimpliedzeroinflationtermstructure.hpp>
 #include <qle/models/lgmimplieddefaulttermstructure.hpp>
@@ -59,6 +60,8 @@ using namespace QuantExt;
   - the configuration of market curves to be simulated
   - a simulation date grid that starts in the future, i.e. does not include today's date
   - the associated time grid including t=0
+  - optionally the index of the first sample, the path generator is skipped ahead to this sample on construction
+    and on reset()
 
   \ingroup scenario
  */
@@ -71,19 +74,35 @@ public:
                                      QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
                                      QuantLib::Date today, QuantLib::ext::shared_ptr<DateGrid> grid,
                                      QuantLib::ext::shared_ptr<ore::data::Market> initMarket,
-                                     const std::string& configuration = Market::defaultConfiguration);
+                                     const std::string& configuration = Market::defaultConfiguration,
+                                     const Size firstSample = 0);
     //! Default destructor
     ~CrossAssetModelScenarioGenerator(){};
     std::vector<QuantLib::ext::shared_ptr<Scenario>> nextPath() override;
-    void reset() override { pathGenerator_->reset(); }
+    //! resets the path generator to the first sample
+    void reset() override;
 
 private:
+    /* State independent coefficients of the model implied discount factors P(t, t + T_k) = exp(a_k + b_k' x) for the
+       tenors T_k of a simulated ir curve on one simulation date, available for LGM and HW models. If empty, the curve
+       is evaluated on its model implied term structure instead. */
+    struct PillarCoefficients {
+        std::vector<Real> a;
+        std::vector<Array> b;
+    };
+    PillarCoefficients pillarCoefficients(const QuantLib::ext::shared_ptr<IrModel>& irModel, const Time t,
+                                          const Date& date, const std::vector<Period>& tenors,
+                                          const Handle<YieldTermStructure>& targetCurve) const;
+    void populateCurve(const PillarCoefficients& c, const Array& x, const std::vector<RiskFactorKey>& keys,
+                       const Size offset, const QuantLib::ext::shared_ptr<Scenario>& scenario) const;
+
     QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel> model_;
     QuantLib::ext::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator_;
     QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory_;
     QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig_;
     QuantLib::ext::shared_ptr<ore::data::Market> initMarket_;
     const std::string configuration_;
+    const Size firstSample_;
     // generated data
     std::vector<RiskFactorKey> discountCurveKeys_, indexCurveKeys_, yieldCurveKeys_, zeroInflationKeys_,
         yoyInflationKeys_, defaultCurveKeys_, commodityCurveKeys_;
@@ -96,6 +115,11 @@ private:
     Size n_ccy_, n_eq_, n_inf_, n_cr_, n_indices_, n_curves_, n_com_, n_crstates_, n_survivalweights_;
 
     vector<QuantLib::ext::shared_ptr<QuantExt::ModelImpliedYieldTermStructure>> curves_, fwdCurves_, yieldCurves_;
+    vector<Handle<YieldTermStructure>> fwdTargetCurves_, yieldTargetCurves_;
+    /* pillar coefficients of the discount, index and yield curves indexed by date and curve, built on the first path
+       after a reset, since the simulation dates and tenors are fixed for the run */
+    vector<vector<PillarCoefficients>> dscPillars_, idxPillars_, ycPillars_;
+    vector<bool> pillarsBuilt_;
     vector<QuantLib::ext::shared_ptr<QuantExt::ModelImpliedPriceTermStructure>> comCurves_;
     vector<QuantLib::ext::shared_ptr<IborIndex>> indices_;
     vector<Currency> yieldCurveCurrency_;
@@ -68,10 +68,14 @@ Real ReturnConfiguration::returnValue(const RiskFactorKey& key, const Real v1, c
 
     // Checks
     check(key);
-    
+
     // Calculate the return
-    auto keyType = key.keytype;    
-    switch (returnType_.at(keyType)) {
+    return returnValue(returnType_.at(key.keytype), key, v1, v2, d1, d2);
+}
+
+Real ReturnConfiguration::returnValue(const ReturnType type, const RiskFactorKey& key, const Real v1, const Real v2,
+                                      const QuantLib::Date& d1, const QuantLib::Date& d2) const {
+    switch (type) {
     case ReturnConfiguration::ReturnType::Absolute:
         return v2 - v1;
         break;
@@ -103,10 +107,16 @@ Real ReturnConfiguration::applyReturn(const RiskFactorKey& key, const Real baseV
     // Checks
     check(key);
 
+    return applyReturn(returnType_.at(key.keytype), key, baseValue, returnValue);
+}
+
+Real ReturnConfiguration::applyReturn(const ReturnType type, const RiskFactorKey& key, const Real baseValue,
+                                      const Real returnValue) const {
+
     // Apply the return to the base value to generate the return value
     auto keyType = key.keytype;
     Real value;
-    switch (returnType_.at(keyType)) {
+    switch (type) {
     case ReturnConfiguration::ReturnType::Absolute:
         value = baseValue + returnValue;
         break;
@@ -138,7 +148,7 @@ Real ReturnConfiguration::applyReturn(const RiskFactorKey& key, const Real baseV
     return value;
 }
 
-const std::map<RiskFactorKey::KeyType, ReturnConfiguration::ReturnType> ReturnConfiguration::returnTypes() const {
+const std::map<RiskFactorKey::KeyType, ReturnConfiguration::ReturnType>& ReturnConfiguration::returnTypes() const {
     return returnType_;
 }
 
@@ -262,11 +272,28 @@ QuantLib::ext::shared_ptr<Scenario> HistoricalScenarioGenerator::next(const Date
     QL_REQUIRE(d >= baseScenario_->asof(), "Cannot generate a scenario in the past");
     QuantLib::ext::shared_ptr<Scenario> scen = scenarioFactory_->buildScenario(d, true, std::string(), 1.0);
 
+    // resolve the return types once per base scenario key table
+    const std::vector<RiskFactorKey>& keys = baseScenario_->keys();
+    if (keyReturnTypes_.size() != keys.size() || keyReturnTypesHash_ != baseScenario_->keysHash()) {
+        keyReturnTypes_.clear();
+        for (auto const& key : keys) {
+            QL_REQUIRE(key.keytype != RiskFactorKey::KeyType::None, "unsupported key type none for key " << key);
+            auto t = returnConfiguration_.returnTypes().find(key.keytype);
+            QL_REQUIRE(t != returnConfiguration_.returnTypes().end(),
+                       "ReturnConfiguration: key type " << key.keytype << " for key " << key << " not found");
+            keyReturnTypes_.push_back(t->second);
+        }
+        keyReturnTypesHash_ = baseScenario_->keysHash();
+    }
+
+    // the base values can be read by index from a simple scenario
+    auto simpleBase = QuantLib::ext::dynamic_pointer_cast<SimpleScenario>(baseScenario_);
+
     // loop over all keys
-    calculationDetails_.resize(baseScenario_->keys().size());
-    Size calcDetailsCounter = 0;
-    for (auto const& key : baseScenario_->keys()) {
-        Real base = baseScenario_->get(key);
+    calculationDetails_.resize(keys.size());
+    for (Size k = 0; k < keys.size(); ++k) {
+        const RiskFactorKey& key = keys[k];
+        Real base = simpleBase && k < simpleBase->data().size() ? simpleBase->data()[k] : baseScenario_->get(key);
         Real v1 = 1.0, v2 = 1.0;
         if (!s1->has(key) || !s2->has(key)) {
             DLOG("Missing key in historical scenario (" << io::iso_date(s1->asof()) << "," << io::iso_date(s2->asof())
@@ -278,33 +305,31 @@ QuantLib::ext::shared_ptr<Scenario> HistoricalScenarioGenerator::next(const Date
         Real value = 0.0;
 
         // Calculate the returned value
-        Real returnVal = returnConfiguration_.returnValue(key, v1, v2, s1->asof(), s2->asof());
+        Real returnVal = returnConfiguration_.returnValue(keyReturnTypes_[k], key, v1, v2, s1->asof(), s2->asof());
         // Adjust return for any scaling
         Real scaling = this->scaling(key, returnVal);
         returnVal = returnVal * scaling;
         // Calculate the shifted value
-        value = returnConfiguration_.applyReturn(key, base, returnVal);
+        value = returnConfiguration_.applyReturn(keyReturnTypes_[k], key, base, returnVal);
         if (std::isinf(value)) {
             ALOG("Value is inf for " << key << " from date " << s1->asof() << " to " << s2->asof());
         }
         // Add it
         scen->add(key, value);
         // Populate calculation details
-        calculationDetails_[calcDetailsCounter].scenarioDate1 = s1->asof();
-        calculationDetails_[calcDetailsCounter].scenarioDate2 = s2->asof();
-        calculationDetails_[calcDetailsCounter].key = key;
-        calculationDetails_[calcDetailsCounter].baseValue = base;
-        calculationDetails_[calcDetailsCounter].adjustmentFactor1 =
-            adjFactors_ ? adjFactors_->getFactor(key.name, s1->asof()) : 1.0;
-        calculationDetails_[calcDetailsCounter].adjustmentFactor2 =
-            adjFactors_ ? adjFactors_->getFactor(key.name, s2->asof()) : 1.0;
-        calculationDetails_[calcDetailsCounter].scenarioValue1 = v1;
-        calculationDetails_[calcDetailsCounter].scenarioValue2 = v2;
-        calculationDetails_[calcDetailsCounter].returnType = returnConfiguration_.returnTypes().at(key.keytype);
-        calculationDetails_[calcDetailsCounter].scaling = scaling;
-        calculationDetails_[calcDetailsCounter].returnValue = returnVal;
-        calculationDetails_[calcDetailsCounter].scenarioValue = value;
-        ++calcDetailsCounter;
+        auto& details = calculationDetails_[k];
+        details.scenarioDate1 = s1->asof();
+        details.scenarioDate2 = s2->asof();
+        details.key = key;
+        details.baseValue = base;
+        details.adjustmentFactor1 = adjFactors_ ? adjFactors_->getFactor(key.name, s1->asof()) : 1.0;
+        details.adjustmentFactor2 = adjFactors_ ? adjFactors_->getFactor(key.name, s2->asof()) : 1.0;
+        details.scenarioValue1 = v1;
+        details.scenarioValue2 = v2;
+        details.returnType = keyReturnTypes_[k];
+        details.scaling = scaling;
+        details.returnValue = returnVal;
+        details.scenarioValue = value;
     }
 
     // Label the scenario
@@ -59,8 +59,16 @@ public:
     QuantLib::Real applyReturn(const RiskFactorKey& key, const QuantLib::Real baseValue,
         const QuantLib::Real returnValue) const;
 
+    //! as returnValue() above, for a key with known return \p type, the key is not checked
+    QuantLib::Real returnValue(const ReturnType type, const RiskFactorKey& key, const QuantLib::Real v1,
+                               const QuantLib::Real v2, const QuantLib::Date& d1, const QuantLib::Date& d2) const;
+
+    //! as applyReturn() above, for a key with known return \p type, the key is not checked
+    QuantLib::Real applyReturn(const ReturnType type, const RiskFactorKey& key, const QuantLib::Real baseValue,
+                               const QuantLib::Real returnValue) const;
+
     //! get return types
-    const std::map<RiskFactorKey::KeyType, ReturnType> returnTypes() const;
+    const std::map<RiskFactorKey::KeyType, ReturnType>& returnTypes() const;
 
 private:
     const std::map<RiskFactorKey::KeyType, ReturnType> returnType_;
@@ -215,6 +223,10 @@ protected:
     // details on the last generated scenario
     std::vector<HistoricalScenarioCalculationDetails> calculationDetails_;
 
+    // return types of the base scenario keys, set up on the first call of next() for a base scenario key table
+    std::vector<ReturnConfiguration::ReturnType> keyReturnTypes_;
+    std::size_t keyReturnTypesHash_ = 0;
+
 protected:
     QuantLib::Calendar cal_;
     QuantLib::Size mporDays_ = 10;
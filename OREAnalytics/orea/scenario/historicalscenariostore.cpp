@@ -0,0 +1,249 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/historicalscenariostore.hpp>
+
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/to_string.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+using QuantLib::Date;
+using QuantLib::Null;
+using QuantLib::Real;
+using QuantLib::Size;
+using QuantLib::io::iso_date;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+// file layout, all integers in native byte order
+// magic (8 bytes), version (uint32), value size (uint32), numKeys, numDates, payload offset (uint64 each),
+// keys (uint64 length followed by the characters), padding up to the payload offset,
+// rows (numDates x (1 + numKeys) values, the first value of a row is the numeraire), dates (int64 serials)
+
+constexpr char magic[8] = {'O', 'R', 'E', 'H', 'S', 'C', 'E', 'N'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint64_t pageSize = 4096;
+// position of numDates in the header
+constexpr std::uint64_t numDatesPos = 8 + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+
+template <typename V> void write(std::ofstream& out, const V& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(V));
+}
+
+template <typename V> V read(std::ifstream& in, const std::string& filename) {
+    V v;
+    in.read(reinterpret_cast<char*>(&v), sizeof(V));
+    QL_REQUIRE(in, "HistoricalScenarioStore: unexpected end of file '" << filename << "'");
+    return v;
+}
+
+} // namespace
+
+HistoricalScenarioStore::HistoricalScenarioStore(const std::string& filename) : filename_(filename), data_(nullptr) {
+
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    QL_REQUIRE(in, "HistoricalScenarioStore: can not open '" << filename << "'");
+    char m[8];
+    in.read(m, 8);
+    QL_REQUIRE(in && std::memcmp(m, magic, 8) == 0,
+               "HistoricalScenarioStore: '" << filename << "' is not a historical scenario store");
+    auto v = read<std::uint32_t>(in, filename);
+    QL_REQUIRE(v == version, "HistoricalScenarioStore: unsupported version " << v << " in '" << filename
+                                                                             << "', expected " << version);
+    valueSize_ = read<std::uint32_t>(in, filename);
+    QL_REQUIRE(valueSize_ == sizeof(float) || valueSize_ == sizeof(double),
+               "HistoricalScenarioStore: invalid value size " << valueSize_ << " in '" << filename << "'");
+    auto numKeys = read<std::uint64_t>(in, filename);
+    auto numDates = read<std::uint64_t>(in, filename);
+    auto payloadOffset = read<std::uint64_t>(in, filename);
+    keys_.reserve(numKeys);
+    for (std::uint64_t k = 0; k < numKeys; ++k) {
+        auto len = read<std::uint64_t>(in, filename);
+        std::string key(len, ' ');
+        in.read(&key[0], len);
+        QL_REQUIRE(in, "HistoricalScenarioStore: unexpected end of file '" << filename << "'");
+        keys_.push_back(parseRiskFactorKey(key));
+    }
+
+    rowSize_ = (numKeys + 1) * valueSize_;
+    in.seekg(payloadOffset + numDates * rowSize_);
+    dates_.reserve(numDates);
+    for (std::uint64_t i = 0; i < numDates; ++i) {
+        dates_.push_back(Date(static_cast<Date::serial_type>(read<std::int64_t>(in, filename))));
+        QL_REQUIRE(i == 0 || dates_[i - 1] < dates_[i], "HistoricalScenarioStore: dates in '"
+                                                            << filename << "' are not ascending ("
+                                                            << iso_date(dates_[i - 1]) << ", "
+                                                            << iso_date(dates_[i]) << ")");
+    }
+
+    if (numDates > 0) {
+        file_ = std::make_unique<boost::interprocess::file_mapping>(filename.c_str(), boost::interprocess::read_only);
+        region_ = std::make_unique<boost::interprocess::mapped_region>(*file_, boost::interprocess::read_only,
+                                                                       payloadOffset, numDates * rowSize_);
+        data_ = static_cast<const char*>(region_->get_address());
+    }
+
+    DLOG("opened historical scenario store " << filename << ": " << numDates << " scenarios, " << numKeys
+                                             << " keys, value size " << valueSize_);
+}
+
+HistoricalScenarioStore::~HistoricalScenarioStore() {}
+
+QuantLib::ext::shared_ptr<Scenario> HistoricalScenarioStore::scenario(const Size i,
+                                                                      const ScenarioFactory& scenarioFactory) const {
+    auto scenario = scenarioFactory.buildScenario(dates_.at(i), true, std::string(), numeraire(i));
+    for (Size k = 0; k < keys_.size(); ++k) {
+        if (Real v = value(i, k); v != Null<Real>())
+            scenario->add(keys_[k], v);
+    }
+    return scenario;
+}
+
+HistoricalScenarioStoreReader::HistoricalScenarioStoreReader(
+    const std::string& fileName, const QuantLib::ext::shared_ptr<ScenarioFactory>& scenarioFactory)
+    : HistoricalScenarioStoreReader(QuantLib::ext::make_shared<HistoricalScenarioStore>(fileName), scenarioFactory) {}
+
+HistoricalScenarioStoreReader::HistoricalScenarioStoreReader(
+    const QuantLib::ext::shared_ptr<HistoricalScenarioStore>& store,
+    const QuantLib::ext::shared_ptr<ScenarioFactory>& scenarioFactory)
+    : store_(store), scenarioFactory_(scenarioFactory), current_(0) {
+    QL_REQUIRE(store_, "HistoricalScenarioStoreReader: no store given");
+    QL_REQUIRE(scenarioFactory_, "HistoricalScenarioStoreReader: no scenario factory given");
+}
+
+bool HistoricalScenarioStoreReader::next() {
+    if (!started_)
+        started_ = true;
+    else if (current_ < store_->dates().size())
+        ++current_;
+    return current_ < store_->dates().size();
+}
+
+Date HistoricalScenarioStoreReader::date() const {
+    return started_ && current_ < store_->dates().size() ? store_->dates()[current_] : Null<Date>();
+}
+
+QuantLib::ext::shared_ptr<Scenario> HistoricalScenarioStoreReader::scenario() const {
+    return started_ && current_ < store_->dates().size() ? store_->scenario(current_, *scenarioFactory_) : nullptr;
+}
+
+Size writeHistoricalScenarioStore(const std::string& filename, HistoricalScenarioReader& reader,
+                                  const std::vector<RiskFactorKey>& keys, const bool doublePrecision) {
+
+    std::uint32_t valueSize = doublePrecision ? sizeof(double) : sizeof(float);
+
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(out, "writeHistoricalScenarioStore(): can not open '" << filename << "' for writing");
+
+    std::vector<RiskFactorKey> dictionary = keys;
+    std::unordered_map<RiskFactorKey, Size> keyIndex;
+    std::vector<Date> dates;
+    std::vector<Real> row;
+    std::vector<float> floatRow;
+    bool headerWritten = false;
+
+    auto writeHeader = [&]() {
+        std::vector<std::string> keyStrings;
+        std::uint64_t headerSize = numDatesPos + 2 * sizeof(std::uint64_t);
+        for (Size k = 0; k < dictionary.size(); ++k) {
+            keyStrings.push_back(ore::data::to_string(dictionary[k]));
+            headerSize += sizeof(std::uint64_t) + keyStrings.back().size();
+            QL_REQUIRE(keyIndex.emplace(dictionary[k], k).second,
+                       "writeHistoricalScenarioStore(): duplicate key " << dictionary[k]);
+        }
+        std::uint64_t payloadOffset = ((headerSize + pageSize - 1) / pageSize) * pageSize;
+        out.write(magic, 8);
+        write(out, version);
+        write(out, valueSize);
+        write(out, static_cast<std::uint64_t>(dictionary.size()));
+        write(out, static_cast<std::uint64_t>(0)); // number of dates, set below
+        write(out, payloadOffset);
+        for (auto const& k : keyStrings) {
+            write(out, static_cast<std::uint64_t>(k.size()));
+            out.write(k.data(), k.size());
+        }
+        std::vector<char> padding(payloadOffset - headerSize, 0);
+        out.write(padding.data(), padding.size());
+        row.resize(dictionary.size() + 1);
+        floatRow.resize(dictionary.size() + 1);
+        headerWritten = true;
+    };
+
+    while (reader.next()) {
+        Date d = reader.date();
+        auto scenario = reader.scenario();
+        QL_REQUIRE(scenario, "writeHistoricalScenarioStore(): reader returned no scenario for " << iso_date(d));
+        QL_REQUIRE(dates.empty() || dates.back() < d, "writeHistoricalScenarioStore(): dates must be ascending, got "
+                                                          << iso_date(dates.back()) << " and " << iso_date(d));
+        if (!headerWritten) {
+            if (dictionary.empty())
+                dictionary = scenario->keys();
+            writeHeader();
+        }
+        std::fill(row.begin(), row.end(), std::numeric_limits<Real>::quiet_NaN());
+        row[0] = scenario->getNumeraire();
+        for (auto const& key : scenario->keys()) {
+            auto k = keyIndex.find(key);
+            QL_REQUIRE(k != keyIndex.end(), "writeHistoricalScenarioStore(): key "
+                                                << key << " in scenario " << iso_date(d)
+                                                << " is not in the key dictionary");
+            row[k->second + 1] = scenario->get(key);
+        }
+        if (doublePrecision) {
+            out.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(double));
+        } else {
+            std::copy(row.begin(), row.end(), floatRow.begin());
+            out.write(reinterpret_cast<const char*>(floatRow.data()), floatRow.size() * sizeof(float));
+        }
+        dates.push_back(d);
+    }
+
+    if (!headerWritten)
+        writeHeader();
+
+    for (auto const& d : dates)
+        write(out, static_cast<std::int64_t>(d.serialNumber()));
+    out.seekp(numDatesPos);
+    write(out, static_cast<std::uint64_t>(dates.size()));
+    out.close();
+    QL_REQUIRE(out, "writeHistoricalScenarioStore(): error while writing '" << filename << "'");
+
+    DLOG("wrote historical scenario store " << filename << ": " << dates.size() << " scenarios, "
+                                            << dictionary.size() << " keys, value size " << valueSize);
+    return dates.size();
+}
+
+bool isHistoricalScenarioStore(const std::string& filename) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    char m[8];
+    return in.read(m, 8) && std::memcmp(m, magic, 8) == 0;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/scenario/historicalscenariostore.hpp
+    \brief binary, memory-mapped store of historical scenarios
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/historicalscenarioreader.hpp>
+#include <orea/scenario/scenariofactory.hpp>
+
+#include <ql/utilities/null.hpp>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace interprocess {
+class file_mapping;
+class mapped_region;
+} // namespace interprocess
+} // namespace boost
+
+namespace ore {
+namespace analytics {
+
+//! Binary store of historical scenarios backed by a memory-mapped file
+/*! The file consists of a header holding the dimensions and the key dictionary (the risk factor keys as strings),
+    followed by one row per scenario date holding the numeraire and the values of all keys (float or double), and a
+    trailer holding the scenario dates. The rows start on a page boundary, missing values are stored as NaN.
+
+    Compared to the csv file read by the HistoricalScenarioFileReader no parsing is required and only the rows that
+    are actually accessed are paged in, so that e.g. a loader restricted to a short period never reads the full file.
+
+    Stores are written with writeHistoricalScenarioStore() from any HistoricalScenarioReader, e.g. a
+    HistoricalScenarioFileReader on an existing csv file.
+
+    \ingroup scenario
+*/
+class HistoricalScenarioStore {
+public:
+    explicit HistoricalScenarioStore(const std::string& filename);
+    ~HistoricalScenarioStore();
+
+    //! The risk factor keys, the values of a row are given in this order
+    const std::vector<RiskFactorKey>& keys() const { return keys_; }
+    //! The scenario dates in ascending order
+    const std::vector<QuantLib::Date>& dates() const { return dates_; }
+    //! The numeraire of the scenario no. i
+    QuantLib::Real numeraire(const QuantLib::Size i) const { return value(i, 0); }
+    //! The value of key no. k in scenario no. i, Null<Real>() if missing
+    QuantLib::Real value(const QuantLib::Size i, const QuantLib::Size k) const {
+        QuantLib::Real v = value(i, k + 1);
+        return std::isnan(v) ? QuantLib::Null<QuantLib::Real>() : v;
+    }
+    //! Build the scenario no. i using the given factory, missing values are not added to the scenario
+    QuantLib::ext::shared_ptr<Scenario> scenario(const QuantLib::Size i,
+                                                 const ScenarioFactory& scenarioFactory) const;
+    //! True if values are stored in double precision in the file
+    bool doublePrecision() const { return valueSize_ == sizeof(double); }
+
+private:
+    QuantLib::Real value(const QuantLib::Size i, const QuantLib::Size pos) const {
+        QL_REQUIRE(i < dates_.size(), "HistoricalScenarioStore: scenario index " << i << " out of range, store '"
+                                                                                  << filename_ << "' has "
+                                                                                  << dates_.size() << " scenarios");
+        const char* row = data_ + i * rowSize_;
+        return valueSize_ == sizeof(double) ? reinterpret_cast<const double*>(row)[pos]
+                                            : static_cast<QuantLib::Real>(reinterpret_cast<const float*>(row)[pos]);
+    }
+
+    std::string filename_;
+    std::size_t valueSize_, rowSize_;
+    std::vector<RiskFactorKey> keys_;
+    std::vector<QuantLib::Date> dates_;
+    std::unique_ptr<boost::interprocess::file_mapping> file_;
+    std::unique_ptr<boost::interprocess::mapped_region> region_;
+    const char* data_;
+};
+
+//! Scenario reader iterating over the scenarios of a HistoricalScenarioStore
+class HistoricalScenarioStoreReader : public HistoricalScenarioReader {
+public:
+    HistoricalScenarioStoreReader(const std::string& fileName,
+                                  const QuantLib::ext::shared_ptr<ScenarioFactory>& scenarioFactory);
+    HistoricalScenarioStoreReader(const QuantLib::ext::shared_ptr<HistoricalScenarioStore>& store,
+                                  const QuantLib::ext::shared_ptr<ScenarioFactory>& scenarioFactory);
+    bool next() override;
+    QuantLib::Date date() const override;
+    QuantLib::ext::shared_ptr<Scenario> scenario() const override;
+
+private:
+    QuantLib::ext::shared_ptr<HistoricalScenarioStore> store_;
+    QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory_;
+    // index of the current scenario, equal to the number of scenarios if the reader is finished
+    QuantLib::Size current_;
+    bool started_ = false;
+};
+
+/*! Write all scenarios provided by \p reader to a HistoricalScenarioStore file. If \p keys is empty, the keys of the
+    first scenario are used. The scenarios must not contain keys outside this dictionary, keys of the dictionary
+    missing in a scenario are stored as missing values. The dates must be ascending. Returns the number of scenarios
+    written. */
+QuantLib::Size writeHistoricalScenarioStore(const std::string& filename, HistoricalScenarioReader& reader,
+                                            const std::vector<RiskFactorKey>& keys = {},
+                                            const bool doublePrecision = true);
+
+//! Returns true if the given file starts with the HistoricalScenarioStore header
+bool isHistoricalScenarioStore(const std::string& filename);
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,277 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/mappedscenariostore.hpp>
+
+#include <ored/utilities/log.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+// file layout, all integers in native byte order
+// magic (8 bytes), version (uint32), value size (uint32), absolute flag (uint32), asof serial (int64),
+// numKeys, numDates, payload offset (uint64 each), dates (int64 serials),
+// keys (key type as int32, uint64 name length followed by the characters, index as uint64),
+// padding up to the payload offset, records (samples x numDates x (1 + numKeys)), each record holding the
+// numeraire followed by the key values
+
+constexpr char magic[8] = {'O', 'R', 'E', 'S', 'C', 'E', 'N', 'S'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint64_t pageSize = 4096;
+
+template <typename V> void write(std::ofstream& out, const V& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(V));
+}
+
+template <typename V> V read(std::ifstream& in, const std::string& filename) {
+    V v;
+    in.read(reinterpret_cast<char*>(&v), sizeof(V));
+    QL_REQUIRE(in, "MappedScenarioStoreGenerator: unexpected end of header in '" << filename << "'");
+    return v;
+}
+
+} // namespace
+
+MappedScenarioStoreWriter::MappedScenarioStoreWriter(const QuantLib::ext::shared_ptr<ScenarioGenerator>& src,
+                                                     const Date& asof, const std::vector<Date>& dates,
+                                                     const std::string& filename, const bool doublePrecision)
+    : src_(src), asof_(asof), dates_(dates), filename_(filename), doublePrecision_(doublePrecision) {
+    QL_REQUIRE(src_, "MappedScenarioStoreWriter: no source generator given");
+    QL_REQUIRE(!dates_.empty(), "MappedScenarioStoreWriter: no dates given");
+    out_.open(filename_, std::ios::out | std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(out_, "MappedScenarioStoreWriter: can not open '" << filename_ << "' for writing");
+}
+
+MappedScenarioStoreWriter::~MappedScenarioStoreWriter() {
+    try {
+        close();
+    } catch (const std::exception& e) {
+        ALOG("MappedScenarioStoreWriter: error while closing '" << filename_ << "': " << e.what());
+    }
+}
+
+QuantLib::ext::shared_ptr<Scenario> MappedScenarioStoreWriter::next(const Date& d) {
+    auto s = src_->next(d);
+    if (closed_)
+        return s;
+    if (d == dates_.front()) {
+        // new path
+        if (dateIndex_ != 0)
+            abortPath();
+        if (closed_)
+            return s;
+        sample_ = nextSample_++;
+    }
+    QL_REQUIRE(dateIndex_ < dates_.size() && d == dates_[dateIndex_],
+               "MappedScenarioStoreWriter: date " << QuantLib::io::iso_date(d) << " requested, expected "
+                                                  << QuantLib::io::iso_date(dates_[dateIndex_]));
+    // only paths beyond the ones already stored are written
+    bool writing = sample_ == samplesWritten_;
+    if (writing) {
+        if (!headerWritten_)
+            writeHeader(*s);
+        writeRecord(*s);
+    }
+    if (++dateIndex_ == dates_.size()) {
+        dateIndex_ = 0;
+        if (writing)
+            ++samplesWritten_;
+    }
+    return s;
+}
+
+void MappedScenarioStoreWriter::reset() {
+    src_->reset();
+    if (dateIndex_ != 0)
+        abortPath();
+    nextSample_ = 0;
+    dateIndex_ = 0;
+}
+
+void MappedScenarioStoreWriter::abortPath() {
+    // a partially written path can not be completed later, the store is closed with the complete paths only
+    if (sample_ == samplesWritten_) {
+        WLOG("MappedScenarioStoreWriter: path " << sample_ << " incomplete, stop writing to '" << filename_ << "'");
+        close();
+    }
+    dateIndex_ = 0;
+}
+
+void MappedScenarioStoreWriter::close() {
+    if (closed_)
+        return;
+    closed_ = true;
+    out_.close();
+    QL_REQUIRE(out_, "MappedScenarioStoreWriter: error while writing to '" << filename_ << "'");
+    DLOG("MappedScenarioStoreWriter: closed '" << filename_ << "', " << samplesWritten_ << " samples x "
+                                               << dates_.size() << " dates x " << keys_.size() << " keys");
+}
+
+void MappedScenarioStoreWriter::writeHeader(const Scenario& s) {
+    keys_ = s.keys();
+    std::uint32_t valueSize = doublePrecision_ ? sizeof(double) : sizeof(float);
+    record_.resize((1 + keys_.size()) * valueSize);
+
+    std::uint64_t headerSize = 8 + 3 * sizeof(std::uint32_t) + sizeof(std::int64_t) + 3 * sizeof(std::uint64_t) +
+                               dates_.size() * sizeof(std::int64_t);
+    for (auto const& k : keys_)
+        headerSize += sizeof(std::int32_t) + 2 * sizeof(std::uint64_t) + k.name.size();
+    std::uint64_t payloadOffset = ((headerSize + pageSize - 1) / pageSize) * pageSize;
+
+    out_.write(magic, 8);
+    write(out_, version);
+    write(out_, valueSize);
+    write(out_, static_cast<std::uint32_t>(s.isAbsolute() ? 1 : 0));
+    write(out_, static_cast<std::int64_t>(asof_.serialNumber()));
+    write(out_, static_cast<std::uint64_t>(keys_.size()));
+    write(out_, static_cast<std::uint64_t>(dates_.size()));
+    write(out_, payloadOffset);
+    for (auto const& d : dates_)
+        write(out_, static_cast<std::int64_t>(d.serialNumber()));
+    for (auto const& k : keys_) {
+        write(out_, static_cast<std::int32_t>(k.keytype));
+        write(out_, static_cast<std::uint64_t>(k.name.size()));
+        out_.write(k.name.data(), k.name.size());
+        write(out_, static_cast<std::uint64_t>(k.index));
+    }
+    std::vector<char> padding(payloadOffset - headerSize, 0);
+    out_.write(padding.data(), padding.size());
+    QL_REQUIRE(out_, "MappedScenarioStoreWriter: error while writing header to '" << filename_ << "'");
+    headerWritten_ = true;
+}
+
+void MappedScenarioStoreWriter::writeRecord(const Scenario& s) {
+    auto setValue = [this](const Size pos, const Real v) {
+        if (doublePrecision_)
+            reinterpret_cast<double*>(record_.data())[pos] = v;
+        else
+            reinterpret_cast<float*>(record_.data())[pos] = static_cast<float>(v);
+    };
+    setValue(0, s.getNumeraire());
+    // scenarios sharing the key table of the first scenario are copied without key lookup
+    auto simple = dynamic_cast<const SimpleScenario*>(&s);
+    if (simple != nullptr && simple->keys() == keys_ && simple->data().size() == keys_.size()) {
+        for (Size i = 0; i < keys_.size(); ++i)
+            setValue(i + 1, simple->data()[i]);
+    } else {
+        for (Size i = 0; i < keys_.size(); ++i)
+            setValue(i + 1, s.get(keys_[i]));
+    }
+    out_.write(record_.data(), record_.size());
+    QL_REQUIRE(out_, "MappedScenarioStoreWriter: error while writing to '" << filename_ << "'");
+}
+
+bool isMappedScenarioStore(const std::string& filename) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    char m[8];
+    return in.read(m, 8) && std::memcmp(m, magic, 8) == 0;
+}
+
+MappedScenarioStoreGenerator::MappedScenarioStoreGenerator(const std::string& filename)
+    : filename_(filename), sharedData_(QuantLib::ext::make_shared<SimpleScenario::SharedData>()) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary);
+    QL_REQUIRE(in, "MappedScenarioStoreGenerator: can not open '" << filename << "'");
+    char m[8];
+    in.read(m, 8);
+    QL_REQUIRE(in && std::memcmp(m, magic, 8) == 0,
+               "MappedScenarioStoreGenerator: '" << filename << "' is not a scenario store");
+    auto v = read<std::uint32_t>(in, filename);
+    QL_REQUIRE(v == version, "MappedScenarioStoreGenerator: unsupported version "
+                                 << v << " in '" << filename << "', expected " << version);
+    auto valueSize = read<std::uint32_t>(in, filename);
+    QL_REQUIRE(valueSize == sizeof(float) || valueSize == sizeof(double),
+               "MappedScenarioStoreGenerator: invalid value size " << valueSize << " in '" << filename << "'");
+    doublePrecision_ = valueSize == sizeof(double);
+    isAbsolute_ = read<std::uint32_t>(in, filename) != 0;
+    asof_ = Date(static_cast<Date::serial_type>(read<std::int64_t>(in, filename)));
+    auto numKeys = read<std::uint64_t>(in, filename);
+    auto numDates = read<std::uint64_t>(in, filename);
+    auto payloadOffset = read<std::uint64_t>(in, filename);
+    QL_REQUIRE(numDates > 0, "MappedScenarioStoreGenerator: no dates in '" << filename << "'");
+    for (std::uint64_t i = 0; i < numDates; ++i) {
+        dates_.push_back(Date(static_cast<Date::serial_type>(read<std::int64_t>(in, filename))));
+        dateIndex_[dates_.back()] = i;
+    }
+    for (std::uint64_t i = 0; i < numKeys; ++i) {
+        auto type = static_cast<RiskFactorKey::KeyType>(read<std::int32_t>(in, filename));
+        auto len = read<std::uint64_t>(in, filename);
+        std::string name(len, ' ');
+        in.read(&name[0], len);
+        QL_REQUIRE(in, "MappedScenarioStoreGenerator: unexpected end of header in '" << filename << "'");
+        auto index = read<std::uint64_t>(in, filename);
+        RiskFactorKey key(type, name, static_cast<Size>(index));
+        sharedData_->keyIndex[key] = sharedData_->keys.size();
+        sharedData_->keys.push_back(key);
+        boost::hash_combine(sharedData_->keysHash, key);
+    }
+    in.close();
+
+    std::uint64_t fileSize = boost::filesystem::file_size(filename);
+    std::uint64_t pathSize = numDates * (1 + numKeys) * valueSize;
+    samples_ = fileSize > payloadOffset ? (fileSize - payloadOffset) / pathSize : 0;
+    QL_REQUIRE(samples_ > 0, "MappedScenarioStoreGenerator: no samples in '" << filename << "'");
+
+    file_ = std::make_unique<boost::interprocess::file_mapping>(filename.c_str(), boost::interprocess::read_only);
+    region_ = std::make_unique<boost::interprocess::mapped_region>(*file_, boost::interprocess::read_only,
+                                                                   payloadOffset, samples_ * pathSize);
+    // the valuation engines request the paths in order
+    region_->advise(boost::interprocess::mapped_region::advice_sequential);
+    data_ = static_cast<const char*>(region_->get_address());
+
+    DLOG("MappedScenarioStoreGenerator: opened '" << filename << "', " << samples_ << " samples x " << numDates
+                                                  << " dates x " << numKeys << " keys, value size " << valueSize);
+}
+
+MappedScenarioStoreGenerator::~MappedScenarioStoreGenerator() {}
+
+QuantLib::ext::shared_ptr<Scenario> MappedScenarioStoreGenerator::next(const Date& d) {
+    if (d == dates_.front()) // new path
+        ++nSim_;
+    auto stepIdx = dateIndex_.find(d);
+    QL_REQUIRE(stepIdx != dateIndex_.end(),
+               "MappedScenarioStoreGenerator::next(" << QuantLib::io::iso_date(d) << "): invalid date");
+    QL_REQUIRE(nSim_ > 0 && nSim_ <= samples_, "MappedScenarioStoreGenerator::next("
+                                                   << QuantLib::io::iso_date(d) << "): no more scenarios stored, "
+                                                   << samples_ << " samples in '" << filename_ << "'");
+    Size numKeys = sharedData_->keys.size();
+    Size pos = ((nSim_ - 1) * dates_.size() + stepIdx->second) * (1 + numKeys);
+    auto s = QuantLib::ext::make_shared<SimpleScenario>(d, "", value(pos), sharedData_);
+    s->setAbsolute(isAbsolute_);
+    // the keys are added in the order of the shared key table, so that no lookup is required
+    for (Size i = 0; i < numKeys; ++i)
+        s->add(sharedData_->keys[i], value(pos + 1 + i));
+    return s;
+}
+
+void MappedScenarioStoreGenerator::setNextSample(const Size sample) {
+    QL_REQUIRE(sample < samples_, "MappedScenarioStoreGenerator::setNextSample(" << sample << "): only " << samples_
+                                                                                 << " samples stored.");
+    nSim_ = sample;
+}
+
+} // namespace analytics
+} // namespace ore
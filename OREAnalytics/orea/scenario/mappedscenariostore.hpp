@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/scenario/mappedscenariostore.hpp
+    \brief binary scenario store backed by a memory-mapped file and a generator replaying it
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariogenerator.hpp>
+#include <orea/scenario/simplescenario.hpp>
+
+#include <fstream>
+#include <map>
+#include <memory>
+
+namespace boost {
+namespace interprocess {
+class file_mapping;
+class mapped_region;
+} // namespace interprocess
+} // namespace boost
+
+namespace ore {
+namespace analytics {
+
+//! Scenario generator writing the scenarios of a source generator to a binary scenario store
+/*! The store consists of a fixed header holding the asof date, the simulation dates and the risk factor keys,
+    followed by one record per sample and date in sample-major order. A record holds the numeraire followed by the
+    values of all keys, as floats or doubles. The payload starts on a page boundary.
+
+    The scenarios are passed through unchanged. The keys are taken from the first scenario, all further scenarios
+    must provide values for them. The dates have to be requested in the order given in the constructor, as done by
+    the valuation engines. A path is only written if it follows the paths already stored, i.e. the source can be
+    reset() and replayed without changing the store. A path that is left incomplete closes the store. The number of
+    samples is implied by the file size, the store can be read with MappedScenarioStoreGenerator once close() has
+    been called or the writer is destroyed.
+
+    Single precision halves the size of the store, but the replayed scenarios then differ from the original ones by
+    the float rounding, so double precision is required if a replay must reproduce the original valuations exactly.
+
+    \ingroup scenario
+*/
+class MappedScenarioStoreWriter : public ScenarioGenerator {
+public:
+    MappedScenarioStoreWriter(const QuantLib::ext::shared_ptr<ScenarioGenerator>& src, const Date& asof,
+                              const std::vector<Date>& dates, const std::string& filename,
+                              const bool doublePrecision = false);
+    ~MappedScenarioStoreWriter() override;
+
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override;
+
+    //! Number of samples written so far
+    Size samples() const { return samplesWritten_; }
+    //! Write the pending records and close the file, no further samples are written after this call
+    void close();
+
+private:
+    void abortPath();
+    void writeHeader(const Scenario& s);
+    void writeRecord(const Scenario& s);
+
+    QuantLib::ext::shared_ptr<ScenarioGenerator> src_;
+    Date asof_;
+    std::vector<Date> dates_;
+    std::string filename_;
+    bool doublePrecision_;
+    std::ofstream out_;
+    bool headerWritten_ = false, closed_ = false;
+    std::vector<RiskFactorKey> keys_;
+    std::vector<char> record_;
+    Size dateIndex_ = 0, sample_ = 0, nextSample_ = 0, samplesWritten_ = 0;
+};
+
+//! Scenario generator replaying a scenario store written by MappedScenarioStoreWriter
+/*! The store is memory-mapped, a scenario is built from its record without any key lookup, so that the replay is
+    bound by the memory bandwidth rather than the simulation of the model. As with the ClonedScenarioGenerator, a
+    request for the first date starts a new path, setNextSample() allows to replay an arbitrary range of samples.
+
+    \ingroup scenario
+*/
+class MappedScenarioStoreGenerator : public ScenarioGenerator {
+public:
+    explicit MappedScenarioStoreGenerator(const std::string& filename);
+    ~MappedScenarioStoreGenerator() override;
+
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override { nSim_ = 0; }
+    //! position the generator such that the next path returned is the path with the given (zero based) index
+    void setNextSample(const Size sample);
+
+    const Date& asof() const { return asof_; }
+    const std::vector<Date>& dates() const { return dates_; }
+    const std::vector<RiskFactorKey>& keys() const { return sharedData_->keys; }
+    Size samples() const { return samples_; }
+    //! True if values are stored in double precision in the file
+    bool doublePrecision() const { return doublePrecision_; }
+
+private:
+    Real value(const Size pos) const {
+        return doublePrecision_ ? reinterpret_cast<const double*>(data_)[pos]
+                                : static_cast<Real>(reinterpret_cast<const float*>(data_)[pos]);
+    }
+
+    std::string filename_;
+    Date asof_;
+    std::vector<Date> dates_;
+    std::map<Date, Size> dateIndex_;
+    bool doublePrecision_, isAbsolute_;
+    Size samples_, nSim_ = 0;
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData> sharedData_;
+    std::unique_ptr<boost::interprocess::file_mapping> file_;
+    std::unique_ptr<boost::interprocess::mapped_region> region_;
+    const char* data_ = nullptr;
+};
+
+//! Returns true if the given file starts with the scenario store header
+bool isMappedScenarioStore(const std::string& filename);
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/pipelinedscenariogenerator.hpp>
+
+#include <ored/utilities/log.hpp>
+
+#include <algorithm>
+
+namespace ore {
+namespace analytics {
+
+PipelinedScenarioGenerator::PipelinedScenarioGenerator(const QuantLib::ext::shared_ptr<ScenarioGenerator>& src,
+                                                       const std::vector<Date>& dates, const Size depth,
+                                                       const Size samples)
+    : src_(src), dates_(dates), depth_(depth), samples_(samples) {
+    QL_REQUIRE(src_, "PipelinedScenarioGenerator: no source scenario generator given");
+    QL_REQUIRE(!dates_.empty(), "PipelinedScenarioGenerator: no dates given");
+    QL_REQUIRE(depth_ > 0, "PipelinedScenarioGenerator: depth must be positive");
+    DLOG("PipelinedScenarioGenerator: buffer up to " << depth_ << " samples with " << dates_.size() << " dates each");
+    start();
+}
+
+PipelinedScenarioGenerator::~PipelinedScenarioGenerator() { stop(); }
+
+void PipelinedScenarioGenerator::start() {
+    stop_ = done_ = false;
+    exception_ = nullptr;
+    producer_ = std::thread(&PipelinedScenarioGenerator::produce, this);
+}
+
+void PipelinedScenarioGenerator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    notFull_.notify_all();
+    if (producer_.joinable())
+        producer_.join();
+    buffer_.clear();
+}
+
+void PipelinedScenarioGenerator::produce() {
+    try {
+        for (Size sample = 0; samples_ == QuantLib::Null<Size>() || sample < samples_; ++sample) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                notFull_.wait(lock, [this] { return stop_ || buffer_.size() < depth_; });
+                if (stop_)
+                    return;
+            }
+            std::vector<QuantLib::ext::shared_ptr<Scenario>> scenarios;
+            scenarios.reserve(dates_.size());
+            for (auto const& d : dates_)
+                scenarios.push_back(src_->next(d));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffer_.push_back(std::move(scenarios));
+            }
+            notEmpty_.notify_one();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exception_ = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+    }
+    notEmpty_.notify_one();
+}
+
+QuantLib::ext::shared_ptr<Scenario> PipelinedScenarioGenerator::next(const Date& d) {
+    if (d == dates_.front()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !buffer_.empty() || done_; });
+        if (buffer_.empty()) {
+            if (exception_)
+                std::rethrow_exception(exception_);
+            QL_FAIL("PipelinedScenarioGenerator::next(): no more samples, " << samples_ << " samples were produced");
+        }
+        current_ = std::move(buffer_.front());
+        buffer_.pop_front();
+        currentStep_ = 0;
+        lock.unlock();
+        notFull_.notify_one();
+    }
+    QL_REQUIRE(!current_.empty(), "PipelinedScenarioGenerator::next(" << d << "): no sample started, expected date "
+                                                                      << dates_.front());
+    if (currentStep_ < dates_.size() && dates_[currentStep_] == d)
+        return current_[currentStep_++];
+    auto it = std::find(dates_.begin(), dates_.end(), d);
+    QL_REQUIRE(it != dates_.end(), "PipelinedScenarioGenerator::next(): invalid date " << d);
+    return current_[std::distance(dates_.begin(), it)];
+}
+
+void PipelinedScenarioGenerator::reset() {
+    stop();
+    current_.clear();
+    currentStep_ = 0;
+    src_->reset();
+    start();
+}
+
+} // namespace analytics
+} // namespace ore
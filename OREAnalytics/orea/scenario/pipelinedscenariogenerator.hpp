@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/pipelinedscenariogenerator.hpp
+    \brief scenario generator producing scenarios ahead on a separate thread
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariogenerator.hpp>
+
+#include <ql/utilities/null.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace ore {
+namespace analytics {
+
+//! Scenario generator producing the scenarios of a source generator ahead on a separate thread
+/*! The scenarios of each sample are generated by calling src->next(d) for the given dates in the given order. Up to
+    depth samples are buffered, the producer thread waits if the buffer is full, so that generation and valuation of
+    the current sample overlap while the memory consumption stays bounded.
+
+    The dates must be the dates for which next() is called for each sample, a new sample starts when next() is called
+    for the first date. At most samples samples are produced, if this is null the generation does not stop until the
+    generator is reset or destroyed.
+
+    The source generator is exclusively used by the producer thread. It must not depend on state that is modified by
+    the consumer, like the global evaluation date.
+
+    \ingroup scenario
+*/
+class PipelinedScenarioGenerator : public ScenarioGenerator {
+public:
+    PipelinedScenarioGenerator(const QuantLib::ext::shared_ptr<ScenarioGenerator>& src, const std::vector<Date>& dates,
+                               const Size depth, const Size samples = QuantLib::Null<Size>());
+    ~PipelinedScenarioGenerator();
+
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override;
+
+private:
+    void start();
+    void stop();
+    void produce();
+
+    QuantLib::ext::shared_ptr<ScenarioGenerator> src_;
+    std::vector<Date> dates_;
+    Size depth_, samples_;
+
+    std::thread producer_;
+    std::mutex mutex_;
+    std::condition_variable notFull_, notEmpty_;
+    std::deque<std::vector<QuantLib::ext::shared_ptr<Scenario>>> buffer_;
+    bool stop_ = false, done_ = false;
+    std::exception_ptr exception_;
+
+    std::vector<QuantLib::ext::shared_ptr<Scenario>> current_;
+    Size currentStep_ = 0;
+};
+
+} // namespace analytics
+} // namespace ore
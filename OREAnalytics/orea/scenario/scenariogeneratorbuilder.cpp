@@ -16,11 +16,15 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/crossassetmodelcomputescenariogenerator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <qle/methods/multipathgeneratorbatched.hpp>
+#include <qle/methods/multipathgeneratorblockparallel.hpp>
 #include <qle/methods/pathgeneratorfactory.hpp>
+#include <qle/processes/crossassetstateprocess.hpp>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
@@ -28,6 +32,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
 
+#include <algorithm>
 #include <map>
 
 using namespace ore::data;
@@ -49,17 +54,108 @@ ScenarioGeneratorBuilder::build(QuantLib::ext::shared_ptr<QuantExt::CrossAssetMo
 
     QL_REQUIRE(initMarket != NULL, "ScenarioGeneratorBuilder: initMarket is null");
 
+    /* path generation on a compute device, the device draws the variates and evolves all samples at once, the path
+       generator factory and the path generation settings below do not apply */
+    if (!data_->pathGenerationDevice().empty()) {
+        QL_REQUIRE(data_->firstSample() == 0, "ScenarioGeneratorBuilder: first sample ("
+                                                  << data_->firstSample()
+                                                  << ") must be 0 for the path generation on a compute device");
+        LOG("ScenarioGeneratorBuilder: generate paths on device " << data_->pathGenerationDevice());
+        ComputeContext::Settings settings;
+        settings.useDoublePrecision = true;
+        settings.rngSequenceType = data_->sequenceType();
+        settings.rngSeed = data_->seed();
+        return QuantLib::ext::make_shared<CrossAssetModelComputeScenarioGenerator>(
+            model, scenarioFactory, marketConfig, asof, data_->getGrid(), initMarket, data_->pathGenerationDevice(),
+            data_->samples(), settings, configuration);
+    }
+
     // enable cache
     auto process = model->stateProcess();
     if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
         tmp->resetCache(data_->getGrid()->timeGrid().size() - 1);
     }
 
-    auto pathGen = pf->build(data_->sequenceType(), process, data_->getGrid()->timeGrid(), data_->seed(),
-                             data_->ordering(), data_->directionIntegers());
+    /* batched path generation, the time step coefficients are computed once and shared by all blocks, the batch
+       size is the path generation block size */
+    /* Brownian bridge refinement: the random sequence is drawn for the steps to the valuation dates only, the steps
+       to the close-out dates that are not valuation dates are filled in with a Brownian bridge, this is done on the
+       batched path generation */
+    std::vector<bool> coarseSteps;
+    if (data_->brownianBridgeRefinement()) {
+        auto const& isValuationDate = data_->getGrid()->isValuationDate();
+        if (std::find(isValuationDate.begin(), isValuationDate.end(), false) != isValuationDate.end())
+            coarseSteps = isValuationDate;
+        else
+            LOG("ScenarioGeneratorBuilder: no close-out dates to refine, Brownian bridge refinement is not applied");
+    }
+
+    QuantLib::ext::shared_ptr<CrossAssetStateBatchEvolver> evolver;
+    if (data_->batchedPathGeneration() || !coarseSteps.empty()) {
+        auto camProcess = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process);
+        if (camProcess && camProcess->hasAffineStep()) {
+            LOG("ScenarioGeneratorBuilder: generate paths in batches of " << data_->pathGenerationBlockSize()
+                                                                          << " samples");
+            evolver = QuantLib::ext::make_shared<CrossAssetStateBatchEvolver>(camProcess, data_->getGrid()->timeGrid());
+            if (!coarseSteps.empty())
+                LOG("ScenarioGeneratorBuilder: draw variates for "
+                    << std::count(coarseSteps.begin(), coarseSteps.end(), true) << " valuation dates, fill in "
+                    << std::count(coarseSteps.begin(), coarseSteps.end(), false)
+                    << " close-out dates with a Brownian bridge");
+        } else {
+            WLOG("ScenarioGeneratorBuilder: batched path generation and Brownian bridge refinement are not supported "
+                 "by the model (requires LGM1F based model without CIR++ components), fall back to path-wise "
+                 "generation on the full grid");
+            coarseSteps.clear();
+        }
+    }
+
+    QuantLib::ext::shared_ptr<MultiPathGeneratorBase> pathGen;
+
+    if (data_->pathGenerationThreads() > 1) {
+
+        /* parallel path generation in blocks with per-block seeded streams, this is restricted to pseudo random
+           sequences, since a low discrepancy sequence can not be split into independently seeded blocks, each block
+           uses its own state process, since the process cache is not thread safe */
+
+        QL_REQUIRE(data_->sequenceType() == MersenneTwister || data_->sequenceType() == MersenneTwisterAntithetic,
+                   "ScenarioGeneratorBuilder: parallel path generation requires sequence type MersenneTwister or "
+                   "MersenneTwisterAntithetic, got "
+                       << data_->sequenceType());
+        QL_REQUIRE(data_->sequenceType() != MersenneTwisterAntithetic || data_->pathGenerationBlockSize() % 2 == 0,
+                   "ScenarioGeneratorBuilder: path generation block size ("
+                       << data_->pathGenerationBlockSize() << ") must be even for antithetic sampling");
+        LOG("ScenarioGeneratorBuilder: generate paths on " << data_->pathGenerationThreads()
+                                                           << " threads in blocks of "
+                                                           << data_->pathGenerationBlockSize() << " samples");
+        auto data = data_;
+        pathGen = QuantLib::ext::make_shared<MultiPathGeneratorBlockParallel>(
+            [model, pf, data, evolver,
+             coarseSteps](const Size block) -> QuantLib::ext::shared_ptr<MultiPathGeneratorBase> {
+                if (evolver)
+                    return QuantLib::ext::make_shared<MultiPathGeneratorBatched>(
+                        *evolver, data->sequenceType(), MultiPathGeneratorBlockParallel::blockSeed(data->seed(), block),
+                        data->ordering(), data->directionIntegers(), data->pathGenerationBlockSize(), coarseSteps);
+                auto blockProcess = QuantLib::ext::make_shared<CrossAssetStateProcess>(model);
+                blockProcess->resetCache(data->getGrid()->timeGrid().size() - 1);
+                return pf->build(data->sequenceType(), blockProcess, data->getGrid()->timeGrid(),
+                                 MultiPathGeneratorBlockParallel::blockSeed(data->seed(), block), data->ordering(),
+                                 data->directionIntegers());
+            },
+            data_->pathGenerationBlockSize(), data_->pathGenerationThreads());
+
+    } else if (evolver) {
+        pathGen = QuantLib::ext::make_shared<MultiPathGeneratorBatched>(*evolver, data_->sequenceType(), data_->seed(),
+                                                                       data_->ordering(), data_->directionIntegers(),
+                                                                       data_->pathGenerationBlockSize(), coarseSteps);
+    } else {
+        pathGen = pf->build(data_->sequenceType(), process, data_->getGrid()->timeGrid(), data_->seed(),
+                            data_->ordering(), data_->directionIntegers());
+    }
 
     return QuantLib::ext::make_shared<CrossAssetModelScenarioGenerator>(model, pathGen, scenarioFactory, marketConfig, asof,
-                                                                data_->getGrid(), initMarket, configuration);
+                                                                data_->getGrid(), initMarket, configuration,
+                                                                data_->firstSample());
 }
 } // namespace analytics
 } // namespace ore
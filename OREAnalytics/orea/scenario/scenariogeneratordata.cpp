@@ -131,6 +131,41 @@ void ScenarioGeneratorData::fromXML(XMLNode* root) {
         }
     }
 
+    firstSample_ = 0;
+    if (auto n = XMLUtils::getChildNode(node, "FirstSample")) {
+        firstSample_ = parseInteger(XMLUtils::getNodeValue(n));
+        LOG("ScenarioGeneratorData first sample = " << firstSample_);
+    }
+
+    pathGenerationThreads_ = 1;
+    if (auto n = XMLUtils::getChildNode(node, "PathGenerationThreads"))
+        pathGenerationThreads_ = parseInteger(XMLUtils::getNodeValue(n));
+    pathGenerationBlockSize_ = 1000;
+    if (auto n = XMLUtils::getChildNode(node, "PathGenerationBlockSize"))
+        pathGenerationBlockSize_ = parseInteger(XMLUtils::getNodeValue(n));
+    batchedPathGeneration_ = false;
+    if (auto n = XMLUtils::getChildNode(node, "BatchedPathGeneration"))
+        batchedPathGeneration_ = parseBool(XMLUtils::getNodeValue(n));
+    if (batchedPathGeneration_) {
+        LOG("ScenarioGeneratorData batched path generation enabled");
+    }
+    brownianBridgeRefinement_ = false;
+    if (auto n = XMLUtils::getChildNode(node, "BrownianBridgeRefinement"))
+        brownianBridgeRefinement_ = parseBool(XMLUtils::getNodeValue(n));
+    if (brownianBridgeRefinement_) {
+        LOG("ScenarioGeneratorData Brownian bridge refinement of the close-out grid enabled");
+    }
+    pathGenerationDevice_.clear();
+    if (auto n = XMLUtils::getChildNode(node, "PathGenerationDevice"))
+        pathGenerationDevice_ = XMLUtils::getNodeValue(n);
+    if (!pathGenerationDevice_.empty()) {
+        LOG("ScenarioGeneratorData path generation on device " << pathGenerationDevice_);
+    }
+    if (pathGenerationThreads_ > 1) {
+        LOG("ScenarioGeneratorData path generation threads = " << pathGenerationThreads_ << ", block size = "
+                                                               << pathGenerationBlockSize_);
+    }
+
     LOG("ScenarioGeneratorData done.");
 }
 
@@ -151,6 +186,8 @@ XMLNode* ScenarioGeneratorData::toXML(XMLDocument& doc) const {
     XMLUtils::addChild(doc, pNode, "Sequence", ore::data::to_string( sequenceType_));
     XMLUtils::addChild(doc, pNode, "Seed", to_string(seed_));
     XMLUtils::addChild(doc, pNode, "Samples", to_string(samples_));
+    if (firstSample_ > 0)
+        XMLUtils::addChild(doc, pNode, "FirstSample", static_cast<int>(firstSample_));
 
     XMLUtils::addChild(doc, pNode, "Ordering", ore::data::to_string((SobolBrownianGenerator::Ordering) ordering_) );
     XMLUtils::addChild(doc, pNode, "DirectionIntegers", ore::data::to_string(directionIntegers_));
@@ -163,6 +200,16 @@ XMLNode* ScenarioGeneratorData::toXML(XMLDocument& doc) const {
     } else {
         XMLUtils::addChild(doc, pNode, "MporMode", "ActualDate");
     }
+    if (pathGenerationThreads_ > 1) {
+        XMLUtils::addChild(doc, pNode, "PathGenerationThreads", static_cast<int>(pathGenerationThreads_));
+        XMLUtils::addChild(doc, pNode, "PathGenerationBlockSize", static_cast<int>(pathGenerationBlockSize_));
+    }
+    if (batchedPathGeneration_)
+        XMLUtils::addChild(doc, pNode, "BatchedPathGeneration", true);
+    if (brownianBridgeRefinement_)
+        XMLUtils::addChild(doc, pNode, "BrownianBridgeRefinement", true);
+    if (!pathGenerationDevice_.empty())
+        XMLUtils::addChild(doc, pNode, "PathGenerationDevice", pathGenerationDevice_);
 
     return node;
 }
@@ -80,12 +80,18 @@ public:
     SequenceType sequenceType() const { return sequenceType_; }
     long seed() const { return seed_; }
     Size samples() const { return samples_; }
+    Size firstSample() const { return firstSample_; }
     SobolBrownianGenerator::Ordering ordering() const { return ordering_; }
     SobolRsg::DirectionIntegers directionIntegers() const { return directionIntegers_; }
     QuantLib::ext::shared_ptr<DateGrid> closeOutDateGrid() const { return closeOutDateGrid_; }
     bool withCloseOutLag() const { return withCloseOutLag_; }
     bool withMporStickyDate() const { return withMporStickyDate_; }
     Period closeOutLag() const { return closeOutLag_; }
+    Size pathGenerationThreads() const { return pathGenerationThreads_; }
+    Size pathGenerationBlockSize() const { return pathGenerationBlockSize_; }
+    bool batchedPathGeneration() const { return batchedPathGeneration_; }
+    bool brownianBridgeRefinement() const { return brownianBridgeRefinement_; }
+    const std::string& pathGenerationDevice() const { return pathGenerationDevice_; }
     //@}
 
     //! \name Setters
@@ -94,17 +100,25 @@ public:
     SequenceType& sequenceType() { return sequenceType_; }
     long& seed() { return seed_; }
     Size& samples() { return samples_; }
+    Size& firstSample() { return firstSample_; }
     SobolBrownianGenerator::Ordering& ordering() { return ordering_; }
     SobolRsg::DirectionIntegers& directionIntegers() { return directionIntegers_; }
     bool& withCloseOutLag() { return withCloseOutLag_; }
     bool& withMporStickyDate() { return withMporStickyDate_; }
     Period& closeOutLag() { return closeOutLag_; }
+    Size& pathGenerationThreads() { return pathGenerationThreads_; }
+    Size& pathGenerationBlockSize() { return pathGenerationBlockSize_; }
+    bool& batchedPathGeneration() { return batchedPathGeneration_; }
+    bool& brownianBridgeRefinement() { return brownianBridgeRefinement_; }
+    std::string& pathGenerationDevice() { return pathGenerationDevice_; }
     //@}
 private:
     QuantLib::ext::shared_ptr<DateGrid> grid_;
     SequenceType sequenceType_;
     long seed_;
     Size samples_;
+    // index of the first generated sample, used to split a simulation into sample ranges
+    Size firstSample_ = 0;
     SobolBrownianGenerator::Ordering ordering_;
     SobolRsg::DirectionIntegers directionIntegers_;
     QuantLib::ext::shared_ptr<DateGrid> closeOutDateGrid_;
@@ -113,6 +127,16 @@ private:
     Period closeOutLag_;
     MporCashFlowMode mporCashFlowMode_;
     string gridString_;
+    // if more than one thread is given, paths are generated in parallel blocks with per-block seeded streams
+    Size pathGenerationThreads_ = 1;
+    Size pathGenerationBlockSize_ = 1000;
+    // if true, the paths of a block are evolved together one time step at a time
+    bool batchedPathGeneration_ = false;
+    /* if true, the random sequence is drawn for the steps to the valuation dates only and the steps to the close-out
+       dates are filled in with a Brownian bridge */
+    bool brownianBridgeRefinement_ = false;
+    // if not empty, the paths and the simulated market values are calculated on this compute device
+    std::string pathGenerationDevice_;
 };
 
 } // namespace analytics
@@ -19,8 +19,10 @@
 #include <orea/scenario/scenarioshiftcalculator.hpp>
 
 #include <orea/scenario/shiftscenariogenerator.hpp>
+#include <orea/scenario/simplescenario.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <qle/math/chunkworkers.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 #include <ql/time/daycounters/actual365fixed.hpp>
 #include <ql/time/daycounters/actual360.hpp>
@@ -47,10 +49,127 @@ ScenarioShiftCalculator::ScenarioShiftCalculator(const QuantLib::ext::shared_ptr
     : sensitivityConfig_(sensitivityConfig), simMarketConfig_(simMarketConfig), simMarket_(simMarket) {}
 
 Real ScenarioShiftCalculator::shift(const RiskFactorKey& key, const Scenario& s_1, const Scenario& s_2) const {
+    return shift(keyData(key), s_1.get(key), s_1.asof(), s_2.get(key), s_2.asof());
+}
+
+std::vector<std::vector<Real>>
+ScenarioShiftCalculator::shifts(const std::vector<RiskFactorKey>& keys, const Scenario& s_1,
+                                const std::vector<QuantLib::ext::shared_ptr<Scenario>>& s_2,
+                                const Size nThreads) const {
+
+    // resolve the shift configuration and the reference values once per key
+    std::vector<KeyData> data(keys.size());
+    std::vector<Real> v_1(keys.size(), Null<Real>());
+    for (Size j = 0; j < keys.size(); ++j) {
+        try {
+            data[j] = keyData(keys[j]);
+            v_1[j] = s_1.get(keys[j]);
+        } catch (const std::exception& e) {
+            ALOG("ScenarioShiftCalculator: can not compute shifts for key '" << keys[j] << "': " << e.what());
+        }
+    }
+
+    /* positions of the keys in the key tables of the simple scenarios in s_2, scenarios built by the same factory
+       share their key table, so that this is set up once */
+    std::map<const SimpleScenario::SharedData*, std::vector<Size>> positions;
+    std::vector<const std::vector<Size>*> scenarioPositions(s_2.size(), nullptr);
+    for (Size i = 0; i < s_2.size(); ++i) {
+        auto s = QuantLib::ext::dynamic_pointer_cast<SimpleScenario>(s_2[i]);
+        if (s == nullptr)
+            continue;
+        auto p = positions.find(s->sharedData().get());
+        if (p == positions.end()) {
+            std::unordered_map<RiskFactorKey, Size> index;
+            for (Size k = 0; k < s->keys().size(); ++k)
+                index[s->keys()[k]] = k;
+            std::vector<Size> pos(keys.size(), Null<Size>());
+            for (Size j = 0; j < keys.size(); ++j) {
+                if (auto k = index.find(keys[j]); k != index.end())
+                    pos[j] = k->second;
+            }
+            p = positions.insert(std::make_pair(s->sharedData().get(), std::move(pos))).first;
+        }
+        scenarioPositions[i] = &p->second;
+    }
+
+    std::vector<std::vector<Real>> result(s_2.size(), std::vector<Real>(keys.size(), Null<Real>()));
+    QuantExt::ChunkWorkers workers(nThreads);
+    workers.run(s_2.size(), [&](const Size i) {
+        const Scenario& s = *s_2[i];
+        const std::vector<Real>* values = nullptr;
+        if (scenarioPositions[i] != nullptr)
+            values = &static_cast<const SimpleScenario&>(s).data();
+        for (Size j = 0; j < keys.size(); ++j) {
+            if (v_1[j] == Null<Real>())
+                continue;
+            Real v_2 = Null<Real>();
+            if (values != nullptr) {
+                Size k = (*scenarioPositions[i])[j];
+                if (k != Null<Size>() && k < values->size())
+                    v_2 = (*values)[k];
+            } else if (s.has(keys[j])) {
+                v_2 = s.get(keys[j]);
+            }
+            if (v_2 == Null<Real>()) {
+                ALOG("ScenarioShiftCalculator: scenario '" << s.label() << "' does not provide data for key '"
+                                                           << keys[j] << "'");
+                continue;
+            }
+            result[i][j] = shift(data[j], v_1[j], s_1.asof(), v_2, s.asof());
+        }
+    });
+
+    return result;
+}
+
+ScenarioShiftCalculator::KeyData ScenarioShiftCalculator::keyData(const RiskFactorKey& key) const {
+
+    KeyData d;
+    d.key = key;
+
+    // Get the shift size and type from the sensitivity configuration
+    const ShiftData& shiftData = sensitivityConfig_->shiftData(key.keytype, key.name);
+    d.shiftSize = shiftData.shiftSize;
+    d.shiftType = shiftData.shiftType;
+
+    // Get the tenor and day counter of the transform, if any
+    d.dc = Actual365Fixed();
+    switch (key.keytype) {
+    case RFType::DiscountCurve:
+    case RFType::YieldCurve:
+    case RFType::IndexCurve:
+        d.tenor = simMarketConfig_->yieldCurveTenors(key.name).at(key.index);
+        if (simMarket_)
+            d.dc = simMarket_->iborIndex(key.name)->forwardingTermStructure()->dayCounter();
+        d.transformed = true;
+        break;
+    case RFType::DividendYield:
+        d.tenor = simMarketConfig_->equityDividendTenors(key.name).at(key.index);
+        if (simMarket_)
+            d.dc = simMarket_->equityDividendCurve(key.name)->dayCounter();
+        d.transformed = true;
+        break;
+    case RFType::SurvivalProbability:
+        d.tenor = simMarketConfig_->defaultTenors(key.name).at(key.index);
+        if (simMarket_)
+            d.dc = simMarket_->defaultCurve(key.name)->curve()->dayCounter();
+        d.transformed = true;
+        break;
+    default:
+        break;
+    }
+
+    return d;
+}
+
+Real ScenarioShiftCalculator::shift(const KeyData& keyData, Real v_1, const Date& asof_1, Real v_2,
+                                    const Date& asof_2) const {
+
+    const RiskFactorKey& key = keyData.key;
 
     // Get the respective (transformed) scenario values
-    Real v_1 = transform(key, s_1.get(key), s_1.asof());
-    Real v_2 = transform(key, s_2.get(key), s_2.asof());
+    v_1 = transform(keyData, v_1, asof_1);
+    v_2 = transform(keyData, v_2, asof_2);
 
     // If for any reason v_1 or v_2 are not finite or nan, log an alert and return 0
     if (!std::isfinite(v_1) || std::isnan(v_1)) {
@@ -62,10 +181,7 @@ Real ScenarioShiftCalculator::shift(const RiskFactorKey& key, const Scenario& s_
         return 0.0;
     }
 
-    // Get the shift size and type from the sensitivity configuration
-    const ShiftData& shiftData = sensitivityConfig_->shiftData(key.keytype, key.name);
-    Real shiftSize = shiftData.shiftSize;
-    ShiftType shiftType = shiftData.shiftType;
+    Real shiftSize = keyData.shiftSize;
 
     // If shiftSize is zero, log an alert and return 0 early
     if (close(shiftSize, 0.0)) {
@@ -75,7 +191,7 @@ Real ScenarioShiftCalculator::shift(const RiskFactorKey& key, const Scenario& s_
 
     // Get the multiple of the sensitivity shift size in moving from scenario 1 to 2
     Real result = 0.0;
-    if (shiftType == ShiftType::Absolute) {
+    if (keyData.shiftType == ShiftType::Absolute) {
         result = v_2 - v_1;
     } else {
         if (close(v_1, 0.0)) {
@@ -90,42 +206,19 @@ Real ScenarioShiftCalculator::shift(const RiskFactorKey& key, const Scenario& s_
     return result;
 }
 
-Real ScenarioShiftCalculator::transform(const RiskFactorKey& key, Real value, const Date& asof) const {
+Real ScenarioShiftCalculator::transform(const KeyData& keyData, Real value, const Date& asof) const {
 
-    Period p;
-    DayCounter dc = Actual365Fixed();
-
-    switch (key.keytype) {
-    case RFType::DiscountCurve:
-    case RFType::YieldCurve:
-    case RFType::IndexCurve:
-        p = simMarketConfig_->yieldCurveTenors(key.name).at(key.index);
-        if (simMarket_)
-            dc = simMarket_->iborIndex(key.name)->forwardingTermStructure()->dayCounter();
-        break;
-    case RFType::DividendYield:
-        p = simMarketConfig_->equityDividendTenors(key.name).at(key.index);
-        if (simMarket_)
-            dc = simMarket_->equityDividendCurve(key.name)->dayCounter();
-        break;
-    case RFType::SurvivalProbability:
-        p = simMarketConfig_->defaultTenors(key.name).at(key.index);
-        if (simMarket_)
-            dc = simMarket_->defaultCurve(key.name)->curve()->dayCounter();
-        break;
-    default:
-        // If we get to here, return untransformed value
+    // If the key is not transformed, return untransformed value
+    if (!keyData.transformed)
         return value;
-        break;
-    }
 
     // If we get to here, calculate transformed value
-    Time t = dc.yearFraction(asof, asof + p);
+    Time t = keyData.dc.yearFraction(asof, asof + keyData.tenor);
 
     // The way that this is used above should be ok i.e. will always be 0 - 0 when t = 0
     if (close(t, 0.0)) {
         ALOG("The time needed in the denominator of the transform for key '"
-             << key << "' is zero so we return a transformed value of zero");
+             << keyData.key << "' is zero so we return a transformed value of zero");
         return 0.0;
     }
 
@@ -57,11 +57,38 @@ public:
     QuantLib::Real shift(const ore::analytics::RiskFactorKey& key, const ore::analytics::Scenario& s_1,
                          const ore::analytics::Scenario& s_2) const;
 
+    /*! Calculate the shifts in the risk factors \p keys implied by going from scenario \p s_1 to each of the
+        scenarios \p s_2, i.e. result[i][j] is shift(keys[j], s_1, *s_2[i]). The shift configuration and curve
+        lookups are resolved once per key and the values of simple scenarios sharing a key table are read by index.
+        The scenarios \p s_2 are processed in parallel on \p nThreads threads. Shifts that can not be computed,
+        e.g. because a key is missing in a scenario, are logged and set to Null<Real>().
+    */
+    std::vector<std::vector<QuantLib::Real>>
+    shifts(const std::vector<ore::analytics::RiskFactorKey>& keys, const ore::analytics::Scenario& s_1,
+           const std::vector<QuantLib::ext::shared_ptr<ore::analytics::Scenario>>& s_2,
+           const QuantLib::Size nThreads = 1) const;
+
 private:
     QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData> sensitivityConfig_;
     QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters> simMarketConfig_;
     QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket> simMarket_;
   
+    //! shift configuration and transform data for a risk factor key
+    struct KeyData {
+        ore::analytics::RiskFactorKey key;
+        QuantLib::Real shiftSize = 0.0;
+        ore::analytics::ShiftType shiftType = ore::analytics::ShiftType::Absolute;
+        bool transformed = false;
+        QuantLib::Period tenor;
+        QuantLib::DayCounter dc;
+    };
+
+    KeyData keyData(const ore::analytics::RiskFactorKey& key) const;
+
+    //! the shift for precomputed key data and the (untransformed) values of the two scenarios
+    QuantLib::Real shift(const KeyData& keyData, QuantLib::Real v_1, const QuantLib::Date& asof_1,
+                         QuantLib::Real v_2, const QuantLib::Date& asof_2) const;
+
     /*! For some risk factors, the sensitivty is understood to be to a transform
         of the quantity that appears in the scenario and this transform can generally
         require the time to expiry of the factor.
@@ -74,8 +101,7 @@ private:
             z_t = - \frac{\ln(df_t)}{\tau(0, t)}
         \f]
     */
-    QuantLib::Real transform(const ore::analytics::RiskFactorKey& key, QuantLib::Real value,
-                             const QuantLib::Date& asof) const;
+    QuantLib::Real transform(const KeyData& keyData, QuantLib::Real value, const QuantLib::Date& asof) const;
 };
 
 } // namespace analytics
@@ -107,6 +107,9 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <list>
+#include <mutex>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace ore::data;
@@ -233,6 +236,78 @@ makeYieldCurve(const std::string& curveId, const bool spreaded, const Handle<Yie
     }
 }
 
+/* Key tables and coordinates of base scenarios built before, these are shared between the sim markets built for the
+   same parameters and asof (e.g. by the valuation threads of the multi-threaded engines or by successive analytics in
+   one run), so that the key index and coordinates are set up once and not per sim market instance. The tables are
+   frozen, i.e. a scenario adding a new key continues on a private copy. Entries are only reused if the keys and
+   coordinates match the sim market exactly, so a change of the parameters after the first build is harmless. */
+struct BaseScenarioTemplate {
+    QuantLib::ext::weak_ptr<ScenarioSimMarketParameters> parameters;
+    Date asof;
+    bool spreaded;
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData> data, dataAbsolute;
+};
+
+std::mutex baseScenarioTemplatesMutex;
+std::list<BaseScenarioTemplate> baseScenarioTemplates;
+constexpr Size maxBaseScenarioTemplates = 8;
+
+template <class M>
+bool templateMatches(const SimpleScenario::SharedData& d, const M& simData,
+                     const std::set<std::tuple<RiskFactorKey::KeyType, std::string, std::vector<std::vector<Real>>>>&
+                         coordinatesData) {
+    if (d.keys.size() != simData.size() || d.coordinates.size() != coordinatesData.size())
+        return false;
+    Size i = 0;
+    for (auto const& s : simData) {
+        if (!(d.keys[i++] == s.first))
+            return false;
+    }
+    for (auto const& [type, name, coordinates] : coordinatesData) {
+        auto c = d.coordinates.find(std::make_pair(type, name));
+        if (c == d.coordinates.end() || c->second != coordinates)
+            return false;
+    }
+    return true;
+}
+
+void findBaseScenarioTemplate(
+    const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& parameters, const Date& asof, const bool spreaded,
+    const std::map<RiskFactorKey, QuantLib::ext::shared_ptr<SimpleQuote>>& simData,
+    const std::map<RiskFactorKey, Real>& absoluteSimData,
+    const std::set<std::tuple<RiskFactorKey::KeyType, std::string, std::vector<std::vector<Real>>>>& coordinatesData,
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData>& data,
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData>& dataAbsolute) {
+    std::lock_guard<std::mutex> lock(baseScenarioTemplatesMutex);
+    for (auto t = baseScenarioTemplates.begin(); t != baseScenarioTemplates.end();) {
+        auto p = t->parameters.lock();
+        if (p == nullptr) {
+            t = baseScenarioTemplates.erase(t);
+            continue;
+        }
+        if (p == parameters && t->asof == asof && t->spreaded == spreaded &&
+            templateMatches(*t->data, simData, coordinatesData) &&
+            (!spreaded || templateMatches(*t->dataAbsolute, absoluteSimData, coordinatesData))) {
+            data = t->data;
+            dataAbsolute = t->dataAbsolute;
+            return;
+        }
+        ++t;
+    }
+}
+
+void storeBaseScenarioTemplate(const QuantLib::ext::shared_ptr<ScenarioSimMarketParameters>& parameters,
+                               const Date& asof, const bool spreaded,
+                               const QuantLib::ext::shared_ptr<SimpleScenario::SharedData>& data,
+                               const QuantLib::ext::shared_ptr<SimpleScenario::SharedData>& dataAbsolute) {
+    data->frozen = true;
+    dataAbsolute->frozen = true;
+    std::lock_guard<std::mutex> lock(baseScenarioTemplatesMutex);
+    baseScenarioTemplates.push_front({parameters, asof, spreaded, data, dataAbsolute});
+    if (baseScenarioTemplates.size() > maxBaseScenarioTemplates)
+        baseScenarioTemplates.pop_back();
+}
+
 } // namespace
 
 void ScenarioSimMarket::writeSimData(std::map<RiskFactorKey, QuantLib::ext::shared_ptr<SimpleQuote>>& simDataTmp,
@@ -2902,18 +2977,27 @@ ScenarioSimMarket::ScenarioSimMarket(
     }
 
     LOG("building base scenario");
-    auto tmp = QuantLib::ext::make_shared<SimpleScenario>(initMarket->asofDate(), "BASE", 1.0);
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData> sharedData, sharedDataAbsolute;
+    findBaseScenarioTemplate(parameters_, initMarket->asofDate(), useSpreadedTermStructures_, simData_,
+                             absoluteSimData_, coordinatesData_, sharedData, sharedDataAbsolute);
+    bool fromTemplate = sharedData != nullptr;
+    auto tmp = QuantLib::ext::make_shared<SimpleScenario>(initMarket->asofDate(), "BASE", 1.0, sharedData);
     if (!useSpreadedTermStructures_) {
         for (auto const& data : simData_) {
             tmp->add(data.first, data.second->value());
         }
         tmp->setAbsolute(true);
-        for (auto const& [type, name, coordinates] : coordinatesData_) {
-            tmp->setCoordinates(type, name, coordinates);
+        if (!fromTemplate) {
+            for (auto const& [type, name, coordinates] : coordinatesData_) {
+                tmp->setCoordinates(type, name, coordinates);
+            }
+            storeBaseScenarioTemplate(parameters_, initMarket->asofDate(), false, tmp->sharedData(),
+                                      tmp->sharedData());
         }
         baseScenarioAbsolute_ = baseScenario_ = tmp;
     } else {
-        auto tmpAbs = QuantLib::ext::make_shared<SimpleScenario>(initMarket->asofDate(), "BASE", 1.0);
+        auto tmpAbs =
+            QuantLib::ext::make_shared<SimpleScenario>(initMarket->asofDate(), "BASE", 1.0, sharedDataAbsolute);
         for (auto const& data : simData_) {
             tmp->add(data.first, data.second->value());
         }
@@ -2922,9 +3006,13 @@ ScenarioSimMarket::ScenarioSimMarket(
         }
         tmp->setAbsolute(false);
         tmpAbs->setAbsolute(true);
-        for (auto const& [type, name, coordinates] : coordinatesData_) {
-            tmp->setCoordinates(type, name, coordinates);
-            tmpAbs->setCoordinates(type, name, coordinates);
+        if (!fromTemplate) {
+            for (auto const& [type, name, coordinates] : coordinatesData_) {
+                tmp->setCoordinates(type, name, coordinates);
+                tmpAbs->setCoordinates(type, name, coordinates);
+            }
+            storeBaseScenarioTemplate(parameters_, initMarket->asofDate(), true, tmp->sharedData(),
+                                      tmpAbs->sharedData());
         }
         baseScenario_ = tmp;
         baseScenarioAbsolute_ = tmpAbs;
@@ -2979,6 +3067,22 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
 
     currentScenario_ = scenario;
 
+    // coalesce the notifications of the sim data quotes, so that each observer is notified once per scenario, this
+    // is a no-op if the observation mode disables or defers the updates anyway
+    DeferredNotificationsScope deferredNotifications;
+    if (deferredNotifications.active())
+        ++deferredNotificationBatches_;
+
+    // SimpleQuote::setValue() only notifies if the value changes and returns the difference to the old value
+    changedRiskFactors_.clear();
+    auto setValue = [this](const RiskFactorKey& key, const QuantLib::ext::shared_ptr<SimpleQuote>& q, const Real v) {
+        if (q->setValue(v) != 0.0) {
+            ++quoteNotifications_;
+            if (trackChangedRiskFactors_)
+                changedRiskFactors_.insert(std::make_pair(key.keytype, key.name));
+        }
+    };
+
     // 1 handle delta scenario
 
     auto deltaScenario = QuantLib::ext::dynamic_pointer_cast<DeltaScenario>(scenario);
@@ -2987,13 +3091,9 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
         delta scenarios or the base scenario */
 
     if (deltaScenario != nullptr) {
-        for (auto const& key : diffToBaseKeys_) {
-            auto it = simData_.find(key);
-            if (it != simData_.end()) {
-                it->second->setValue(baseScenario_->get(key));
-            }
-        }
-        diffToBaseKeys_.clear();
+        // set the keys of the new delta, then restore the base values for the keys of the previous delta that are
+        // not part of the new one, so that keys in both deltas are updated (and notify) only once
+        std::set<RiskFactorKey> newDiffToBaseKeys;
         auto delta = deltaScenario->delta();
         bool missingPoint = false;
         for (auto const& key : delta->keys()) {
@@ -3003,13 +3103,23 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
                 missingPoint = true;
             } else {
                 if (filter_->allow(key)) {
-                    it->second->setValue(delta->get(key));
-                    diffToBaseKeys_.insert(key);
+                    setValue(key, it->second, delta->get(key));
+                    newDiffToBaseKeys.insert(key);
                 }
             }
         }
+        for (auto const& key : diffToBaseKeys_) {
+            if (newDiffToBaseKeys.find(key) != newDiffToBaseKeys.end())
+                continue;
+            auto it = simData_.find(key);
+            if (it != simData_.end()) {
+                setValue(key, it->second, baseScenario_->get(key));
+            }
+        }
+        diffToBaseKeys_.swap(newDiffToBaseKeys);
         QL_REQUIRE(!missingPoint, "simulation data points missing from scenario, exit.");
 
+        deferredNotifications.release();
         return;
     }
 
@@ -3023,6 +3133,7 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
 
             if (cachedSimData_.empty() || s->keysHash() != cachedSimDataKeysHash_) {
                 cachedSimData_.clear();
+                cachedSimDataActive_.clear();
                 cachedSimDataKeysHash_ = s->keysHash();
                 Size count = 0;
                 for (auto const& key : s->keys()) {
@@ -3052,10 +3163,11 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
             Size i = 0;
             for (auto const& q : s->data()) {
                 if (cachedSimDataActive_[i])
-                    cachedSimData_[i]->setValue(q);
+                    setValue(s->keys()[i], cachedSimData_[i], q);
                 ++i;
             }
 
+            deferredNotifications.release();
             return;
         }
     }
@@ -3076,7 +3188,7 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
             WLOG("simulation data point missing for key " << key);
         } else {
             if (filter_->allow(key)) {
-                it->second->setValue(scenario->get(key));
+                setValue(key, it->second, scenario->get(key));
             }
             count++;
         }
@@ -3090,6 +3202,9 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
         }
         QL_FAIL("mismatch between scenario and sim data size, exit.");
     }
+
+    // notify the deferred observers, errors are propagated as without deferral
+    deferredNotifications.release();
 }
 
 void ScenarioSimMarket::preUpdate() {
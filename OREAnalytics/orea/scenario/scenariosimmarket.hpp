@@ -141,6 +141,25 @@ public:
 
     void applyScenario(const QuantLib::ext::shared_ptr<Scenario>& scenario);
 
+    /*! If enabled, applyScenario() records the risk factors (key type and name) for which at least one sim data point
+        changed its value, i.e. the term structures that were invalidated by the scenario. Quotes which are set to
+        their current value do not notify their observers and are not recorded. */
+    void trackChangedRiskFactors(const bool b) { trackChangedRiskFactors_ = b; }
+    bool trackChangedRiskFactors() const { return trackChangedRiskFactors_; }
+
+    /*! number of sim data quotes that changed their value and notified their observers in applyScenario() since
+        construction, without coalescing each of them would trigger a separate notification chain */
+    Size quoteNotifications() const { return quoteNotifications_; }
+    /*! number of applyScenario() calls in which the quote notifications were coalesced, so that each observer was
+        notified at most once per call; under the Disable or Defer observation mode the coalescing happens in
+        preUpdate() / postUpdate() instead and this number is zero */
+    Size deferredNotificationBatches() const { return deferredNotificationBatches_; }
+
+    //! the risk factors changed by the last applyScenario() call, only populated if tracking is enabled
+    const std::set<std::pair<RiskFactorKey::KeyType, std::string>>& changedRiskFactors() const {
+        return changedRiskFactors_;
+    }
+
 protected:
     
 
@@ -194,6 +213,14 @@ protected:
     // for delta scenario application
     std::set<ore::analytics::RiskFactorKey> diffToBaseKeys_;
 
+    // tracking of the risk factors changed by applyScenario()
+    bool trackChangedRiskFactors_ = false;
+    std::set<std::pair<RiskFactorKey::KeyType, std::string>> changedRiskFactors_;
+
+    // notification statistics
+    Size quoteNotifications_ = 0;
+    Size deferredNotificationBatches_ = 0;
+
     mutable QuantLib::ext::shared_ptr<Scenario> currentScenario_;
     QuantLib::ext::shared_ptr<Scenario> offsetScenario_;
 };
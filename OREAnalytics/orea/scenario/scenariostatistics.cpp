@@ -0,0 +1,205 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/scenariostatistics.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/utilities/null.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using QuantLib::Null;
+using QuantLib::Real;
+using QuantLib::Size;
+
+namespace ore {
+namespace analytics {
+
+void OnlineMoments::add(const Real x) {
+    if (n_ == 0) {
+        min_ = max_ = x;
+    } else {
+        min_ = std::min(min_, x);
+        max_ = std::max(max_, x);
+    }
+    Real n1 = static_cast<Real>(n_);
+    Real n = static_cast<Real>(++n_);
+    Real delta = x - mean_;
+    Real deltaN = delta / n;
+    Real deltaN2 = deltaN * deltaN;
+    Real term = delta * deltaN * n1;
+    mean_ += deltaN;
+    m4_ += term * deltaN2 * (n * n - 3.0 * n + 3.0) + 6.0 * deltaN2 * m2_ - 4.0 * deltaN * m3_;
+    m3_ += term * deltaN * (n - 2.0) - 3.0 * deltaN * m2_;
+    m2_ += term;
+}
+
+Real OnlineMoments::min() const { return n_ == 0 ? Null<Real>() : min_; }
+
+Real OnlineMoments::max() const { return n_ == 0 ? Null<Real>() : max_; }
+
+Real OnlineMoments::mean() const { return n_ == 0 ? Null<Real>() : mean_; }
+
+Real OnlineMoments::variance() const { return n_ == 0 ? Null<Real>() : m2_ / static_cast<Real>(n_); }
+
+Real OnlineMoments::skewness() const {
+    if (n_ == 0)
+        return Null<Real>();
+    return std::sqrt(static_cast<Real>(n_)) * m3_ / std::pow(m2_, 1.5);
+}
+
+Real OnlineMoments::kurtosis() const {
+    if (n_ == 0)
+        return Null<Real>();
+    return static_cast<Real>(n_) * m4_ / (m2_ * m2_) - 3.0;
+}
+
+P2Quantile::P2Quantile(const Real p) : p_(p) {
+    QL_REQUIRE(p > 0.0 && p < 1.0, "P2Quantile: probability (" << p << ") must be in (0,1)");
+    increments_ = {0.0, p / 2.0, p, (1.0 + p) / 2.0, 1.0};
+}
+
+void P2Quantile::add(const Real x) {
+    // collect the first five observations, they initialise the markers
+    if (n_ < 5) {
+        q_[n_++] = x;
+        if (n_ == 5) {
+            std::sort(q_.begin(), q_.end());
+            pos_ = {1.0, 2.0, 3.0, 4.0, 5.0};
+            desired_ = {1.0, 1.0 + 2.0 * p_, 1.0 + 4.0 * p_, 3.0 + 2.0 * p_, 5.0};
+        }
+        return;
+    }
+    ++n_;
+
+    // find the cell containing x and update the extreme markers
+    Size k;
+    if (x < q_[0]) {
+        q_[0] = x;
+        k = 0;
+    } else if (x >= q_[4]) {
+        q_[4] = x;
+        k = 3;
+    } else {
+        k = std::upper_bound(q_.begin() + 1, q_.begin() + 4, x) - q_.begin() - 1;
+    }
+    for (Size i = k + 1; i < 5; ++i)
+        pos_[i] += 1.0;
+    for (Size i = 0; i < 5; ++i)
+        desired_[i] += increments_[i];
+
+    // adjust the heights of the middle markers, using the piecewise parabolic prediction if it keeps the heights
+    // ordered and the linear prediction otherwise
+    for (Size i = 1; i < 4; ++i) {
+        Real d = desired_[i] - pos_[i];
+        if ((d >= 1.0 && pos_[i + 1] - pos_[i] > 1.0) || (d <= -1.0 && pos_[i - 1] - pos_[i] < -1.0)) {
+            Real s = d >= 0.0 ? 1.0 : -1.0;
+            Real qp = q_[i] + s / (pos_[i + 1] - pos_[i - 1]) *
+                                  ((pos_[i] - pos_[i - 1] + s) * (q_[i + 1] - q_[i]) / (pos_[i + 1] - pos_[i]) +
+                                   (pos_[i + 1] - pos_[i] - s) * (q_[i] - q_[i - 1]) / (pos_[i] - pos_[i - 1]));
+            if (q_[i - 1] < qp && qp < q_[i + 1]) {
+                q_[i] = qp;
+            } else {
+                Size j = s > 0.0 ? i + 1 : i - 1;
+                q_[i] += s * (q_[j] - q_[i]) / (pos_[j] - pos_[i]);
+            }
+            pos_[i] += s;
+        }
+    }
+}
+
+Real P2Quantile::value() const {
+    if (n_ == 0)
+        return Null<Real>();
+    if (n_ >= 5)
+        return q_[2];
+    // empirical quantile with linear interpolation between the order statistics
+    std::array<Real, 5> v = q_;
+    std::sort(v.begin(), v.begin() + n_);
+    Real h = p_ * static_cast<Real>(n_ - 1);
+    Size i = static_cast<Size>(std::floor(h));
+    if (i + 1 >= n_)
+        return v[n_ - 1];
+    return v[i] + (h - static_cast<Real>(i)) * (v[i + 1] - v[i]);
+}
+
+ScenarioStatisticsGenerator::ScenarioStatisticsGenerator(const QuantLib::ext::shared_ptr<ScenarioGenerator>& src,
+                                                         const std::vector<RiskFactorKey>& keys,
+                                                         const std::vector<Date>& dates,
+                                                         const std::vector<Real>& quantiles)
+    : src_(src), keys_(keys), dates_(dates), quantiles_(quantiles) {
+    QL_REQUIRE(src_, "ScenarioStatisticsGenerator: no source scenario generator given");
+    for (Size d = 0; d < dates_.size(); ++d) {
+        QL_REQUIRE(dateIndex_.insert(std::make_pair(dates_[d], d)).second,
+                   "ScenarioStatisticsGenerator: duplicate date " << QuantLib::io::iso_date(dates_[d]));
+    }
+    for (auto const& p : quantiles_) {
+        QL_REQUIRE(p > 0.0 && p < 1.0, "ScenarioStatisticsGenerator: quantile (" << p << ") must be in (0,1)");
+    }
+    clear();
+}
+
+QuantLib::ext::shared_ptr<Scenario> ScenarioStatisticsGenerator::next(const Date& d) {
+    QuantLib::ext::shared_ptr<Scenario> s = src_->next(d);
+    auto it = dateIndex_.find(d);
+    if (it == dateIndex_.end())
+        return s;
+    Size nq = quantiles_.size();
+    for (Size k = 0; k < keys_.size(); ++k) {
+        Size idx = it->second * keys_.size() + k;
+        Real x = s->get(keys_[k]);
+        moments_[idx].add(x);
+        for (Size q = 0; q < nq; ++q)
+            quantileEstimates_[idx * nq + q].add(x);
+    }
+    return s;
+}
+
+void ScenarioStatisticsGenerator::reset() {
+    src_->reset();
+    clear();
+}
+
+void ScenarioStatisticsGenerator::clear() {
+    moments_.assign(dates_.size() * keys_.size(), OnlineMoments());
+    quantileEstimates_.clear();
+    quantileEstimates_.reserve(moments_.size() * quantiles_.size());
+    for (Size i = 0; i < moments_.size(); ++i) {
+        for (auto const& p : quantiles_)
+            quantileEstimates_.push_back(P2Quantile(p));
+    }
+}
+
+const OnlineMoments& ScenarioStatisticsGenerator::moments(const Size dateIndex, const Size keyIndex) const {
+    QL_REQUIRE(dateIndex < dates_.size() && keyIndex < keys_.size(),
+               "ScenarioStatisticsGenerator::moments(): index (" << dateIndex << "," << keyIndex
+                                                                 << ") out of range");
+    return moments_[dateIndex * keys_.size() + keyIndex];
+}
+
+Real ScenarioStatisticsGenerator::quantile(const Size dateIndex, const Size keyIndex,
+                                           const Size quantileIndex) const {
+    QL_REQUIRE(dateIndex < dates_.size() && keyIndex < keys_.size() && quantileIndex < quantiles_.size(),
+               "ScenarioStatisticsGenerator::quantile(): index (" << dateIndex << "," << keyIndex << ","
+                                                                  << quantileIndex << ") out of range");
+    return quantileEstimates_[(dateIndex * keys_.size() + keyIndex) * quantiles_.size() + quantileIndex].value();
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/scenariostatistics.hpp
+    \brief online statistics of generated scenarios
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariogenerator.hpp>
+
+#include <array>
+#include <map>
+
+namespace ore {
+namespace analytics {
+
+//! Online estimate of the range and the first four moments of a sample
+/*! The central moments are updated one observation at a time (Welford's algorithm with Terriberry's extension to
+    the third and fourth moment), so no sample values are stored. As for the corresponding boost accumulators,
+    variance() is the population variance and kurtosis() the excess kurtosis. */
+class OnlineMoments {
+public:
+    void add(const QuantLib::Real x);
+
+    QuantLib::Size count() const { return n_; }
+    QuantLib::Real min() const;
+    QuantLib::Real max() const;
+    QuantLib::Real mean() const;
+    QuantLib::Real variance() const;
+    QuantLib::Real skewness() const;
+    QuantLib::Real kurtosis() const;
+
+private:
+    QuantLib::Size n_ = 0;
+    QuantLib::Real min_ = 0.0, max_ = 0.0, mean_ = 0.0, m2_ = 0.0, m3_ = 0.0, m4_ = 0.0;
+};
+
+//! Streaming quantile estimate
+/*! P^2 algorithm, see Jain, Chlamtac, The P^2 Algorithm for Dynamic Calculation of Quantiles and Histograms Without
+    Storing Observations, Communications of the ACM 28 (1985). Only five markers are stored, for fewer than five
+    observations the empirical quantile is returned. */
+class P2Quantile {
+public:
+    explicit P2Quantile(const QuantLib::Real p);
+    void add(const QuantLib::Real x);
+
+    QuantLib::Real probability() const { return p_; }
+    QuantLib::Size count() const { return n_; }
+    //! the quantile estimate, null if no observation was added
+    QuantLib::Real value() const;
+
+private:
+    QuantLib::Real p_;
+    QuantLib::Size n_ = 0;
+    // marker heights, actual and desired marker positions and increments of the desired positions
+    std::array<QuantLib::Real, 5> q_, pos_, desired_, increments_;
+};
+
+//! Scenario generator decorator accumulating statistics of the scenarios passing through it
+/*! For each of the given dates and keys the moments and estimates of the given quantiles of the risk factor values
+    are updated as the scenarios are generated, scenarios for other dates are not considered. The scenarios are
+    returned unchanged and are not stored, so that other analytics can collect statistics on the fly, without a
+    separate pass over the scenarios. A reset() restarts the source generator and clears the statistics. */
+class ScenarioStatisticsGenerator : public ScenarioGenerator {
+public:
+    ScenarioStatisticsGenerator(const QuantLib::ext::shared_ptr<ScenarioGenerator>& src,
+                                const std::vector<RiskFactorKey>& keys, const std::vector<Date>& dates,
+                                const std::vector<QuantLib::Real>& quantiles = {});
+
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override;
+
+    const std::vector<RiskFactorKey>& keys() const { return keys_; }
+    const std::vector<Date>& dates() const { return dates_; }
+    const std::vector<QuantLib::Real>& quantiles() const { return quantiles_; }
+
+    //! moments of the values of keys()[keyIndex] on dates()[dateIndex]
+    const OnlineMoments& moments(const QuantLib::Size dateIndex, const QuantLib::Size keyIndex) const;
+    //! estimate of the quantiles()[quantileIndex] quantile of the values of keys()[keyIndex] on dates()[dateIndex]
+    QuantLib::Real quantile(const QuantLib::Size dateIndex, const QuantLib::Size keyIndex,
+                            const QuantLib::Size quantileIndex) const;
+
+private:
+    void clear();
+
+    QuantLib::ext::shared_ptr<ScenarioGenerator> src_;
+    std::vector<RiskFactorKey> keys_;
+    std::vector<Date> dates_;
+    std::vector<QuantLib::Real> quantiles_;
+    std::map<Date, QuantLib::Size> dateIndex_;
+    std::vector<OnlineMoments> moments_;
+    std::vector<P2Quantile> quantileEstimates_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -17,6 +17,8 @@
 */
 
 #include <orea/app/structuredanalyticserror.hpp>
+#include <orea/scenario/deltascenario.hpp>
+#include <orea/scenario/deltascenariofactory.hpp>
 #include <orea/scenario/sensitivityscenariogenerator.hpp>
 
 #include <ored/utilities/indexparser.hpp>
@@ -30,6 +32,7 @@
 
 #include <algorithm>
 #include <ostream>
+#include <set>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -54,9 +57,30 @@ SensitivityScenarioGenerator::SensitivityScenarioGenerator(
 
     QL_REQUIRE(sensitivityData_, "SensitivityScenarioGenerator: sensitivityData is null");
 
+    /* store the shifted values only and build the full scenarios on demand in next(), this requires the base scenario
+       to be of the same type (absolute or spreaded) as the generated scenarios */
+    if (QuantLib::ext::dynamic_pointer_cast<DeltaScenarioFactory>(sensiScenarioFactory_) == nullptr &&
+        baseScenario_->isAbsolute() == !sensitivityData_->useSpreadedTermStructures()) {
+        materialisingScenarioFactory_ = sensiScenarioFactory_;
+        sensiScenarioFactory_ = QuantLib::ext::make_shared<DeltaScenarioFactory>(baseScenario_);
+    }
+
     generateScenarios();
 }
 
+QuantLib::ext::shared_ptr<Scenario> SensitivityScenarioGenerator::next(const Date& d) {
+    QuantLib::ext::shared_ptr<Scenario> scenario = ShiftScenarioGenerator::next(d);
+    auto deltaScenario = QuantLib::ext::dynamic_pointer_cast<DeltaScenario>(scenario);
+    if (materialisingScenarioFactory_ == nullptr || deltaScenario == nullptr)
+        return scenario;
+    auto delta = deltaScenario->delta();
+    QuantLib::ext::shared_ptr<Scenario> result = materialisingScenarioFactory_->buildScenario(
+        delta->asof(), delta->isAbsolute(), delta->label(), delta->getNumeraire());
+    for (auto const& key : delta->keys())
+        result->add(key, delta->get(key));
+    return result;
+}
+
 struct findFactor {
     findFactor(const string& factor) : factor_(factor) {}
 
@@ -228,7 +252,17 @@ void SensitivityScenarioGenerator::generateScenarios() {
             QuantLib::ext::shared_ptr<Scenario> crossScenario =
                 sensiScenarioFactory_->buildScenario(asof, !sensitivityData_->useSpreadedTermStructures());
 
-            for (auto const& k : baseScenario_->keys()) {
+            // if both scenarios are delta scenarios, only their shifted keys can differ from the base scenario
+            auto iDelta = QuantLib::ext::dynamic_pointer_cast<DeltaScenario>(scenarios_[i]);
+            auto jDelta = QuantLib::ext::dynamic_pointer_cast<DeltaScenario>(scenarios_[j]);
+            std::vector<RiskFactorKey> shiftedKeys;
+            if (iDelta != nullptr && jDelta != nullptr) {
+                std::set<RiskFactorKey> tmp(iDelta->delta()->keys().begin(), iDelta->delta()->keys().end());
+                tmp.insert(jDelta->delta()->keys().begin(), jDelta->delta()->keys().end());
+                shiftedKeys.assign(tmp.begin(), tmp.end());
+            }
+
+            for (auto const& k : iDelta != nullptr && jDelta != nullptr ? shiftedKeys : baseScenario_->keys()) {
                 Real v1 = scenarios_[i]->get(k);
                 Real v2 = scenarios_[j]->get(k);
                 Real b = baseScenario_->get(k);
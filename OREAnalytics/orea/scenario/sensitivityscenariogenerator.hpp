@@ -97,6 +97,11 @@ using namespace data;
   If sensitivityData_->generateSpreadScenarios() = true spread scenarios will be generated for
   supported risk factor types.
 
+  The scenarios are always stored as delta scenarios holding the shifted values only, so that the memory used is
+  proportional to the number of keys plus the number of shifted values. If the given scenario factory does not build
+  delta scenarios, next() returns a scenario built from this factory with the shifted values added, i.e. the scenario
+  that would have been stored otherwise.
+
   \ingroup scenario
  */
 class SensitivityScenarioGenerator : public ShiftScenarioGenerator {
@@ -133,6 +138,10 @@ public:
 
     QuantLib::ext::shared_ptr<Scenario> baseScenarioAbsolute() const { return baseScenarioAbsolute_; }
 
+    /*! If the scenarios are stored as delta scenarios although the given scenario factory does not build those, the
+        scenario returned here is built from the given factory and the stored delta */
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override;
+
 private:
     ShiftType getShiftType(SensitivityScenarioData::ShiftData& data) const;
     Real getShiftSize(SensitivityScenarioData::ShiftData& data) const;
@@ -205,6 +214,8 @@ private:
 
     QuantLib::ext::shared_ptr<SensitivityScenarioData> sensitivityData_;
     QuantLib::ext::shared_ptr<ScenarioFactory> sensiScenarioFactory_;
+    //! the given factory, if the scenarios are stored as delta scenarios and materialised in next()
+    QuantLib::ext::shared_ptr<ScenarioFactory> materialisingScenarioFactory_;
     std::string sensitivityTemplate_;
     const bool overrideTenors_, continueOnError_;
 
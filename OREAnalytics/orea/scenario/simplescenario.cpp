@@ -38,9 +38,12 @@ bool SimpleScenario::has(const RiskFactorKey& key) const {
 
 void SimpleScenario::add(const RiskFactorKey& key, Real value) {
     Size dataIndex;
-    if (auto i = sharedData_->keyIndex.find(key); i != sharedData_->keyIndex.end()) {
+    if (data_.size() < sharedData_->keys.size() && sharedData_->keys[data_.size()] == key) {
+        dataIndex = data_.size();
+    } else if (auto i = sharedData_->keyIndex.find(key); i != sharedData_->keyIndex.end()) {
         dataIndex = i->second;
     } else {
+        detachFrozenSharedData();
         dataIndex = sharedData_->keyIndex[key] = sharedData_->keys.size();
         sharedData_->keys.push_back(key);
         boost::hash_combine(sharedData_->keysHash, key);
@@ -62,10 +65,18 @@ QuantLib::ext::shared_ptr<Scenario> SimpleScenario::clone() const {
     return QuantLib::ext::make_shared<SimpleScenario>(*this);
 }
 
+void SimpleScenario::detachFrozenSharedData() {
+    if (sharedData_->frozen) {
+        sharedData_ = QuantLib::ext::make_shared<SharedData>(*sharedData_);
+        sharedData_->frozen = false;
+    }
+}
+
 void SimpleScenario::setAbsolute(const bool isAbsolute) { isAbsolute_ = isAbsolute; }
 
 void SimpleScenario::setCoordinates(const RiskFactorKey::KeyType type, const std::string& name,
                                     const std::vector<std::vector<Real>>& coordinates) {
+    detachFrozenSharedData();
     sharedData_->coordinates[std::make_pair(type, name)] = coordinates;
 }
 
@@ -25,6 +25,8 @@
 
 #include <orea/scenario/scenario.hpp>
 
+#include <unordered_map>
+
 namespace ore {
 namespace analytics {
 using std::string;
@@ -35,9 +37,12 @@ class SimpleScenario : public Scenario {
 public:
     struct SharedData {
         std::vector<RiskFactorKey> keys;
-        std::map<RiskFactorKey, std::size_t> keyIndex;
+        std::unordered_map<RiskFactorKey, std::size_t> keyIndex;
         std::map<std::pair<RiskFactorKey::KeyType, std::string>, std::vector<std::vector<Real>>> coordinates;
         std::size_t keysHash = 0;
+        /*! a frozen block is shared read-only between independent scenarios (e.g. the base scenarios of several sim
+            markets), a scenario adding a new key or coordinates to a frozen block continues on a private copy */
+        bool frozen = false;
     };
 
     SimpleScenario() {}
@@ -64,6 +69,8 @@ public:
 
     bool has(const RiskFactorKey& key) const override;
     const std::vector<RiskFactorKey>& keys() const override { return sharedData_->keys; }
+    /*! If the keys are added in the order of the shared key table, no key lookup is required, this is the case for all
+        but the first scenario built by a generator using a common shared data block. */
     void add(const RiskFactorKey& key, Real value) override;
     Real get(const RiskFactorKey& key) const override;
 
@@ -81,6 +88,8 @@ public:
     const std::vector<Real>& data() const { return data_; }
 
 private:
+    void detachFrozenSharedData();
+
     QuantLib::ext::shared_ptr<SharedData> sharedData_;
     bool isAbsolute_ = true;
     Date asof_;
@@ -404,5 +404,27 @@ XMLNode* StressTestScenarioData::toXML(ore::data::XMLDocument& doc) const {
     }
     return node;
 }
+
+std::set<RiskFactorKey> StressTestScenarioData::StressTestData::riskFactors() const {
+    std::set<RiskFactorKey> result;
+    auto add = [&result](const RiskFactorKey::KeyType type, const auto& shifts) {
+        for (auto const& s : shifts)
+            result.insert(RiskFactorKey(type, s.first));
+    };
+    add(RiskFactorKey::KeyType::DiscountCurve, discountCurveShifts);
+    add(RiskFactorKey::KeyType::IndexCurve, indexCurveShifts);
+    add(RiskFactorKey::KeyType::YieldCurve, yieldCurveShifts);
+    add(RiskFactorKey::KeyType::FXSpot, fxShifts);
+    add(RiskFactorKey::KeyType::FXVolatility, fxVolShifts);
+    add(RiskFactorKey::KeyType::EquitySpot, equityShifts);
+    add(RiskFactorKey::KeyType::EquityVolatility, equityVolShifts);
+    add(RiskFactorKey::KeyType::OptionletVolatility, capVolShifts);
+    add(RiskFactorKey::KeyType::SwaptionVolatility, swaptionVolShifts);
+    add(RiskFactorKey::KeyType::SecuritySpread, securitySpreadShifts);
+    add(RiskFactorKey::KeyType::RecoveryRate, recoveryRateShifts);
+    add(RiskFactorKey::KeyType::SurvivalProbability, survivalProbabilityShifts);
+    return result;
+}
+
 } // namespace analytics
 } // namespace ore
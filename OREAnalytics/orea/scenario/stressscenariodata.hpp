@@ -30,6 +30,8 @@
 
 #include <qle/termstructures/dynamicstype.hpp>
 
+#include <set>
+
 namespace ore {
 namespace analytics {
 using namespace QuantLib;
@@ -96,6 +98,9 @@ public:
         bool creditCurveParShifts = false;
 
         bool containsParShifts() const { return irCurveParShifts || irCapFloorParShifts || creditCurveParShifts; };        
+
+        //! the risk factors shifted by this scenario, given by key type and name, the key indices are zero
+        std::set<RiskFactorKey> riskFactors() const;
     };
 
     //! Default constructor
@@ -38,6 +38,48 @@ namespace analytics {
 auto isSimmParameter = [](const ore::analytics::CrifRecord& x) { return x.isSimmParameter(); };
 auto isNotSimmParameter = std::not_fn(isSimmParameter);
 
+Crif::Crif(const Crif& other)
+    : type_(other.type_), records_(other.records_), portfolioIds_(other.portfolioIds_),
+      nettingSetDetails_(other.nettingSetDetails_) {
+    rebuildIndices();
+}
+
+Crif& Crif::operator=(const Crif& other) {
+    if (this != &other) {
+        type_ = other.type_;
+        records_ = other.records_;
+        portfolioIds_ = other.portfolioIds_;
+        nettingSetDetails_ = other.nettingSetDetails_;
+        rebuildIndices();
+    }
+    return *this;
+}
+
+void Crif::clear() {
+    records_.clear();
+    diffAmountCurrenciesIndex_.clear();
+    index_.clear();
+}
+
+void Crif::indexRecord(const CrifRecord& record) {
+    index_[std::make_tuple(record.nettingSetDetails, record.productClass, record.riskType)].insert(&record);
+}
+
+void Crif::rebuildIndices() {
+    diffAmountCurrenciesIndex_.clear();
+    index_.clear();
+    for (const auto& r : records_) {
+        diffAmountCurrenciesIndex_.emplace(r.getSimmAmountCcyKey(), &r);
+        indexRecord(r);
+    }
+}
+
+const Crif::IndexedRecords* Crif::indexedRecords(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                                 const CrifRecord::RiskType rt) const {
+    auto it = index_.find(std::make_tuple(nsd, pc, rt));
+    return it == index_.end() ? nullptr : &it->second;
+}
+
 void Crif::addRecord(const CrifRecord& record, bool aggregateDifferentAmountCurrencies, bool sortFxVolQualifer) {
     if (record.type() == CrifRecord::RecordType::FRTB) {
         addFrtbCrifRecord(record, aggregateDifferentAmountCurrencies, sortFxVolQualifer);
@@ -84,6 +126,7 @@ void Crif::insertCrifRecord(const CrifRecord& record, bool aggregateDifferentAmo
     if (it == records_.end() && itDiffAmountCcy == diffAmountCurrenciesIndex_.end()) {
         auto recordIt = records_.insert(record);
         diffAmountCurrenciesIndex_[record.getSimmAmountCcyKey()] = &(*(recordIt.first));
+        indexRecord(*recordIt.first);
         portfolioIds_.insert(record.portfolioId);
         nettingSetDetails_.insert(record.nettingSetDetails);
     } else if (it != records_.end()) {
@@ -96,9 +139,9 @@ void Crif::insertCrifRecord(const CrifRecord& record, bool aggregateDifferentAmo
 void Crif::addSimmParameterRecord(const CrifRecord& record) {
     auto it = records_.find(record);
     if (it == records_.end()) {
-        CrifRecord newRecord = record;
-        records_.insert(newRecord);
-        diffAmountCurrenciesIndex_[record.getSimmAmountCcyKey()] = &newRecord;
+        auto recordIt = records_.insert(record);
+        diffAmountCurrenciesIndex_[record.getSimmAmountCcyKey()] = &(*(recordIt.first));
+        indexRecord(*recordIt.first);
     } else if (it->riskType == CrifRecord::RiskType::AddOnFixedAmount) {
         updateAmountExistingRecord(it, record);
     } else if (it->riskType == CrifRecord::RiskType::AddOnNotionalFactor ||
@@ -195,10 +238,13 @@ Crif Crif::simmParameters() const {
 //! Find first element
 std::set<CrifRecord>::const_iterator Crif::findBy(const NettingSetDetails nsd, CrifRecord::ProductClass pc,
                                                   const CrifRecord::RiskType rt, const std::string& qualifier) const {
-    return std::find_if(records_.begin(), records_.end(), [&nsd, &pc, &rt, &qualifier](const CrifRecord& record) {
-        return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-               record.qualifier == qualifier;
-    });
+    if (const IndexedRecords* records = indexedRecords(nsd, pc, rt)) {
+        for (const CrifRecord* r : *records) {
+            if (r->qualifier == qualifier)
+                return records_.find(*r);
+        }
+    }
+    return records_.end();
 };
 
 Crif Crif::filterNonZeroAmount(double threshold, std::string alwaysIncludeFxRiskCcy) const {
@@ -226,49 +272,36 @@ Crif Crif::filterNonZeroAmount(double threshold, std::string alwaysIncludeFxRisk
 
 std::set<std::string> Crif::qualifiersBy(const NettingSetDetails nsd, CrifRecord::ProductClass pc,
                                          const CrifRecord::RiskType rt) const {
-    auto res = records_ | boost::adaptors::filtered([&nsd, &pc, &rt](const CrifRecord& record) {
-                   return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt;
-               }) |
-               boost::adaptors::transformed([](const CrifRecord& record) { return record.qualifier; });
-    return boost::copy_range<std::set<std::string>>(res);
+    std::set<std::string> result;
+    if (const IndexedRecords* records = indexedRecords(nsd, pc, rt)) {
+        for (const CrifRecord* r : *records)
+            result.insert(r->qualifier);
+    }
+    return result;
 }
 
 std::vector<CrifRecord> Crif::filterByQualifierAndBucket(const NettingSetDetails& nsd,
                                                          const CrifRecord::ProductClass pc,
                                                          const CrifRecord::RiskType rt, const std::string& qualifier,
                                                          const std::string& bucket) const {
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt, &qualifier, &bucket](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-                   record.qualifier == qualifier && record.bucket == bucket;
-        }));
+    return filterIndexed(nsd, pc, rt, [&qualifier, &bucket](const CrifRecord& record) {
+        return record.qualifier == qualifier && record.bucket == bucket;
+    });
 }
 
 std::vector<CrifRecord> Crif::filterByQualifier(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
                                                 const CrifRecord::RiskType rt, const std::string& qualifier) const {
-
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt, &qualifier](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-                   record.qualifier == qualifier;
-        }));
+    return filterIndexed(nsd, pc, rt, [&qualifier](const CrifRecord& record) { return record.qualifier == qualifier; });
 }
 
 std::vector<CrifRecord> Crif::filterByBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
                                              const CrifRecord::RiskType rt, const std::string& bucket) const {
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt, &bucket](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-                   record.bucket == bucket;
-        }));
+    return filterIndexed(nsd, pc, rt, [&bucket](const CrifRecord& record) { return record.bucket == bucket; });
 }
 
 std::vector<CrifRecord> Crif::filterBy(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
                                        const CrifRecord::RiskType rt) const {
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt;
-        }));
+    return filterIndexed(nsd, pc, rt, [](const CrifRecord&) { return true; });
 }
 
 std::vector<CrifRecord> Crif::filterBy(const CrifRecord::RiskType rt) const {
@@ -289,7 +322,7 @@ std::set<std::string> Crif::tradeIds() const {
 //! deletes all existing simmParameter and replaces them with the new one
 void Crif::setSimmParameters(const Crif& crif) {
     auto backup = records_;
-    records_.clear();
+    clear();
     for (auto& r : backup) {
         if (!r.isSimmParameter()) {
             addRecord(r);
@@ -304,7 +337,7 @@ void Crif::setSimmParameters(const Crif& crif) {
 
 void Crif::setCrifRecords(const Crif& crif) {
     auto backup = records_;
-    records_.clear();
+    clear();
     for (auto& r : backup) {
         if (r.isSimmParameter()) {
             addRecord(r);
@@ -323,9 +356,9 @@ const std::set<NettingSetDetails>& Crif::nettingSetDetails() const { return nett
 
 std::set<CrifRecord::ProductClass> Crif::ProductClassesByNettingSetDetails(const NettingSetDetails nsd) const {
     std::set<CrifRecord::ProductClass> keys;
-    for (const auto& record : records_) {
-        if (record.nettingSetDetails == nsd) {
-            keys.insert(record.productClass);
+    for (const auto& [key, records] : index_) {
+        if (std::get<0>(key) == nsd && !records.empty()) {
+            keys.insert(std::get<1>(key));
         }
     }
     return keys;
@@ -333,10 +366,11 @@ std::set<CrifRecord::ProductClass> Crif::ProductClassesByNettingSetDetails(const
 
 size_t Crif::countMatching(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
                            const CrifRecord::RiskType rt, const std::string& qualifier) const {
-    return std::count_if(records_.begin(), records_.end(), [&nsd, &pc, &rt, &qualifier](const CrifRecord& record) {
-        return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-               record.qualifier == qualifier;
-    });
+    const IndexedRecords* records = indexedRecords(nsd, pc, rt);
+    if (records == nullptr)
+        return 0;
+    return std::count_if(records->begin(), records->end(),
+                         [&qualifier](const CrifRecord* record) { return record->qualifier == qualifier; });
 }
 
 bool Crif::hasNettingSetDetails() const {
@@ -353,6 +387,9 @@ void Crif::fillAmountUsd(const QuantLib::ext::shared_ptr<ore::data::Market> mark
         WLOG("CrifLoader::fillAmountUsd() was called, but market object is empty.")
         return;
     }
+    // The USD spot is looked up once per amount currency. The amounts are not part of the record ordering, so the
+    // updated records can be appended to the result in the original order.
+    std::map<std::string, double> usdSpots;
     std::set<CrifRecord> results;
 
     for (const CrifRecord& r : records_) {
@@ -368,13 +405,16 @@ void Crif::fillAmountUsd(const QuantLib::ext::shared_ptr<ore::data::Market> mark
                         ore::data::to_string(cr))
                     .log();
             } else {
-                double usdSpot = market->fxRate(cr.amountCurrency + "USD")->value();
-                cr.amountUsd = cr.amount * usdSpot;
+                auto s = usdSpots.find(cr.amountCurrency);
+                if (s == usdSpots.end())
+                    s = usdSpots.emplace(cr.amountCurrency, market->fxRate(cr.amountCurrency + "USD")->value()).first;
+                cr.amountUsd = cr.amount * s->second;
             }
         }
-        results.insert(cr);
+        results.insert(results.end(), std::move(cr));
     }
-    records_ = results;
+    records_ = std::move(results);
+    rebuildIndices();
 }
 
 } // namespace analytics
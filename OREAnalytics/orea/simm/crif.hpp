@@ -25,6 +25,10 @@
 #include <ored/report/report.hpp>
 #include <ored/marketdata/market.hpp>
 
+#include <map>
+#include <set>
+#include <tuple>
+
 namespace ore {
 namespace analytics {
 
@@ -32,17 +36,23 @@ struct crifRecordIsSimmParameter {
     bool operator()(const CrifRecord& x) { return x.isSimmParameter(); }
 };
 
+/*! Container of CRIF records. The records are indexed by netting set details, product class and risk type, so that
+    the filter methods below only visit the records of the requested netting set, product class and risk type. */
 class Crif {
 public:
     enum class CrifType { Empty, Frtb, Simm };
     Crif() = default;
+    Crif(const Crif& other);
+    Crif(Crif&& other) = default;
+    Crif& operator=(const Crif& other);
+    Crif& operator=(Crif&& other) = default;
 
     CrifType type() const { return type_; }
 
     void addRecord(const CrifRecord& record, bool aggregateDifferentAmountCurrencies = false, bool sortFxVolQualifer = true);
     void addRecords(const Crif& crif, bool aggregateDifferentAmountCurrencies = false, bool sortFxVolQualfier = true);
 
-    void clear() { records_.clear(); }
+    void clear();
 
     std::set<CrifRecord>::const_iterator begin() const { return records_.cbegin(); }
     std::set<CrifRecord>::const_iterator end() const { return records_.cend(); }
@@ -121,10 +131,39 @@ private:
     void updateAmountExistingRecord(std::set<CrifRecord>::iterator& it, const CrifRecord& record);
     void updateAmountExistingRecord(std::map<CrifRecord::SimmAmountCcyKey, const CrifRecord*>::iterator& it, const CrifRecord& record);
 
+    struct RecordPtrLess {
+        bool operator()(const CrifRecord* x, const CrifRecord* y) const { return *x < *y; }
+    };
+    typedef std::set<const CrifRecord*, RecordPtrLess> IndexedRecords;
+    typedef std::tuple<ore::data::NettingSetDetails, CrifRecord::ProductClass, CrifRecord::RiskType> IndexKey;
+
+    //! Add a record of records_ to the index
+    void indexRecord(const CrifRecord& record);
+    //! Rebuild the index and the amount currency index from records_
+    void rebuildIndices();
+    //! The indexed records for the given netting set details, product class and risk type, or nullptr
+    const IndexedRecords* indexedRecords(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                         const CrifRecord::RiskType rt) const;
+    //! Copy the indexed records satisfying the predicate
+    template <class P>
+    std::vector<CrifRecord> filterIndexed(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                          const CrifRecord::RiskType rt, const P& predicate) const {
+        std::vector<CrifRecord> result;
+        if (const IndexedRecords* records = indexedRecords(nsd, pc, rt)) {
+            for (const CrifRecord* r : *records) {
+                if (predicate(*r))
+                    result.push_back(*r);
+            }
+        }
+        return result;
+    }
+
 
     CrifType type_ = CrifType::Empty;
     std::set<CrifRecord> records_;
     std::map<CrifRecord::SimmAmountCcyKey, const CrifRecord*> diffAmountCurrenciesIndex_;
+    //! Records by netting set details, product class and risk type, in the order of records_
+    std::map<IndexKey, IndexedRecords> index_;
 
     //SIMM members
     //! Set of portfolio IDs that have been loaded
@@ -23,9 +23,15 @@
 #include <ored/portfolio/structuredtradewarning.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <qle/math/chunkworkers.hpp>
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <functional>
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <boost/range/adaptor/indexed.hpp>
 #include <boost/range/algorithm/max_element.hpp>
@@ -224,6 +230,162 @@ std::stringstream CsvFileCrifLoader::stream() const {
     return result;
 }
 
+void MemoryMappedCsvFileCrifLoader::tokenize(const char* begin, const char* end, vector<string>& fields) const {
+    // Same semantics as the boost::escaped_list_separator used by parseListOfValues(), but writing into the
+    // existing field strings, so that no allocations are needed once the buffers have grown to the field sizes
+    Size n = 0;
+    auto nextField = [&fields, &n]() -> string& {
+        if (n == fields.size())
+            fields.emplace_back();
+        string& field = fields[n++];
+        field.clear();
+        return field;
+    };
+    string* field = &nextField();
+    bool inQuote = false;
+    for (const char* p = begin; p != end; ++p) {
+        char c = *p;
+        if (c == escapeChar_) {
+            QL_REQUIRE(++p != end, "cannot end a CRIF line with the escape character");
+            c = *p;
+            if (c == escapeChar_ || c == quoteChar_ || c == delim_)
+                field->push_back(c);
+            else if (c == 'n')
+                field->push_back('\n');
+            else
+                QL_FAIL("unknown escape sequence in CRIF line");
+        } else if (c == delim_ && !inQuote) {
+            boost::trim(*field);
+            field = &nextField();
+        } else if (c == quoteChar_) {
+            inQuote = !inQuote;
+        } else {
+            field->push_back(c);
+        }
+    }
+    boost::trim(*field);
+    fields.resize(n);
+}
+
+Crif MemoryMappedCsvFileCrifLoader::loadCrifImpl() {
+    QL_REQUIRE(boost::filesystem::exists(filename_), "error opening file " << filename_);
+    Crif result;
+    if (boost::filesystem::file_size(filename_) == 0) {
+        LOG("Out of 0 lines, there were 0 valid lines, 0 invalid lines and 0 empty lines.");
+        return result;
+    }
+
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename_);
+    } catch (const std::exception& e) {
+        QL_FAIL("error mapping file " << filename_ << ": " << e.what());
+    }
+    const char* const data = file.data();
+    const char* const dataEnd = data + file.size();
+
+    // Iterate over the lines of [begin, end), trimmed as in loadFromStream()
+    auto forEachLine = [this](const char* begin, const char* end,
+                              const std::function<bool(const char*, const char*)>& f) {
+        while (begin < end) {
+            const char* eol = static_cast<const char*>(std::memchr(begin, eol_, end - begin));
+            const char* lineEnd = eol == nullptr ? end : eol;
+            const char* lineBegin = begin;
+            begin = eol == nullptr ? end : eol + 1;
+            while (lineBegin != lineEnd && std::isspace(static_cast<unsigned char>(*lineBegin)))
+                ++lineBegin;
+            while (lineEnd != lineBegin && std::isspace(static_cast<unsigned char>(*(lineEnd - 1))))
+                --lineEnd;
+            if (!f(lineBegin, lineEnd))
+                return begin;
+        }
+        return begin;
+    };
+
+    // The header is the first non-empty line, it is processed serially
+    Size headerLine = 0, headerEmptyLines = 0;
+    vector<string> fields;
+    auto header = [this, &headerLine, &headerEmptyLines, &fields](const char* b, const char* e) {
+        ++headerLine;
+        if (b == e) {
+            ++headerEmptyLines;
+            return true;
+        }
+        tokenize(b, e, fields);
+        processHeader(fields);
+        return false;
+    };
+    const char* body = forEachLine(data, dataEnd, header);
+
+    Size maxIndex = 0;
+    if (!columnIndex_.empty()) {
+        auto maxPair = max_element(
+            columnIndex_.begin(), columnIndex_.end(),
+            [](const pair<Size, Size>& p1, const pair<Size, Size>& p2) { return p1.second < p2.second; });
+        maxIndex = maxPair->second;
+    }
+
+    // Split the body into chunks ending at line boundaries
+    QuantExt::ChunkWorkers workers(nThreads_);
+    Size nChunks = std::min<Size>(4 * workers.nThreads(), std::max<Size>(1, (dataEnd - body) / (1 << 16)));
+    vector<const char*> bounds(1, body);
+    for (Size i = 1; i < nChunks; ++i) {
+        const char* b = std::max(bounds.back(), body + (dataEnd - body) * i / nChunks);
+        const char* eol = static_cast<const char*>(std::memchr(b, eol_, dataEnd - b));
+        if (eol == nullptr)
+            break;
+        if (eol + 1 > bounds.back())
+            bounds.push_back(eol + 1);
+    }
+    if (bounds.back() != dataEnd)
+        bounds.push_back(dataEnd);
+    nChunks = bounds.size() - 1;
+
+    // Line number of the first line of each chunk, for messages
+    vector<Size> firstLine(nChunks + 1, headerLine);
+    workers.run(nChunks, [&bounds, &firstLine, this](const Size i) {
+        firstLine[i + 1] = std::count(bounds[i], bounds[i + 1], eol_);
+    });
+    for (Size i = 0; i < nChunks; ++i)
+        firstLine[i + 1] += firstLine[i];
+
+    // Parse the chunks
+    vector<Crif> chunkCrifs(nChunks);
+    vector<Size> validLines(nChunks, 0), invalidLines(nChunks, 0), emptyLines(nChunks, 0), lines(nChunks, 0);
+    workers.run(nChunks, [&](const Size i) {
+        vector<string> entries;
+        Size currentLine = firstLine[i];
+        forEachLine(bounds[i], bounds[i + 1], [&](const char* b, const char* e) {
+            ++currentLine;
+            ++lines[i];
+            if (b == e) {
+                ++emptyLines[i];
+            } else {
+                tokenize(b, e, entries);
+                if (process(entries, maxIndex, currentLine, chunkCrifs[i]))
+                    ++validLines[i];
+                else
+                    ++invalidLines[i];
+            }
+            return true;
+        });
+    });
+
+    // Merge the chunks in file order
+    Size totalLines = headerLine, totalValid = 0, totalInvalid = 0, totalEmpty = headerEmptyLines;
+    for (Size i = 0; i < nChunks; ++i) {
+        result.addRecords(chunkCrifs[i]);
+        totalLines += lines[i];
+        totalValid += validLines[i];
+        totalInvalid += invalidLines[i];
+        totalEmpty += emptyLines[i];
+    }
+
+    LOG("Out of " << totalLines << " lines, there were " << totalValid << " valid lines, " << totalInvalid
+                  << " invalid lines and " << totalEmpty << " empty lines.");
+    return result;
+}
+
 std::stringstream CsvBufferCrifLoader::stream() const {
     std::stringstream csvStream;
     csvStream << buffer_;
@@ -345,13 +507,13 @@ bool StringStreamCrifLoader::process(const vector<string>& entries, Size maxInde
     // Try to create and add a CRIF record
     // There could still be issues here so we surround with try..catch to allow processing to continue
     auto loadOptionalString = [&entries, this](int column) {
-        return columnIndex_.count(column) == 0 ? "" : entries[columnIndex_[column]];
+        return columnIndex_.count(column) == 0 ? "" : entries[columnIndex_.at(column)];
     };
     auto loadOptionalReal = [&entries, this](int column) -> QuantLib::Real{
         if (columnIndex_.count(column) == 0) {
             return QuantLib::Null<QuantLib::Real>();
         } else{
-            const std::string& value = entries[columnIndex_[column]];
+            const std::string& value = entries[columnIndex_.at(column)];
 
             return value.empty() || value == nullString_ ? QuantLib::Null<QuantLib::Real>()
                                                          : parseReal(value);
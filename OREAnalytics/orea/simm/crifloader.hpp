@@ -150,6 +150,30 @@ protected:
     std::stringstream stream() const override;
 };
 
+/*! Loads a CRIF file like CsvFileCrifLoader, but memory-maps the file and parses it in \p nThreads threads. The body
+    of the file is split into chunks at line boundaries, the lines of each chunk are tokenised into reused field
+    buffers and aggregated into a Crif per chunk, and the chunk Crifs are merged in file order. */
+class MemoryMappedCsvFileCrifLoader : public CsvFileCrifLoader {
+public:
+    MemoryMappedCsvFileCrifLoader(const std::string& filename,
+                                  const QuantLib::ext::shared_ptr<SimmConfiguration>& configuration,
+                                  const std::vector<std::set<std::string>>& additionalHeaders = {},
+                                  bool updateMapper = false, bool aggregateTrades = true, char eol = '\n',
+                                  char delim = '\t', char quoteChar = '\0', char escapeChar = '\\',
+                                  const std::string& nullString = "#N/A", QuantLib::Size nThreads = 1)
+        : CsvFileCrifLoader(filename, configuration, additionalHeaders, updateMapper, aggregateTrades, eol, delim,
+                            quoteChar, escapeChar, nullString),
+          nThreads_(nThreads) {}
+
+protected:
+    Crif loadCrifImpl() override;
+
+    //! Split the line [begin, end) like parseListOfValues() into \p fields, reusing the strings in \p fields
+    void tokenize(const char* begin, const char* end, std::vector<std::string>& fields) const;
+
+    QuantLib::Size nThreads_;
+};
+
 class CsvBufferCrifLoader : public StringStreamCrifLoader {
 public:
     CsvBufferCrifLoader(const std::string& buffer, const QuantLib::ext::shared_ptr<SimmConfiguration>& configuration,
@@ -0,0 +1,430 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/simm/pathwisesimmcalculator.hpp>
+
+#include <ql/errors.hpp>
+
+#include <set>
+
+using QuantExt::RandomVariable;
+using QuantLib::Matrix;
+using QuantLib::Real;
+using QuantLib::Size;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace ore {
+namespace analytics {
+
+typedef CrifRecord::ProductClass ProductClass;
+typedef CrifRecord::RiskType RiskType;
+typedef SimmConfiguration::RiskClass RiskClass;
+typedef SimmConfiguration::MarginType MarginType;
+
+PathwiseSimmCalculator::PathwiseSimmCalculator(const QuantLib::ext::shared_ptr<SimmConfiguration>& simmConfiguration,
+                                               const Crif& structure, const string& calculationCcy)
+    : simmConfiguration_(simmConfiguration), calculationCcy_(calculationCcy) {
+
+    QL_REQUIRE(simmConfiguration_, "PathwiseSimmCalculator: no SIMM configuration given");
+
+    // Collect the sensitivities by margin component, in the order of the CRIF records
+
+    map<ProductClass, vector<Size>> irDelta, irVega;
+    map<std::pair<ProductClass, RiskType>, vector<Size>> other;
+    for (const auto& cr : structure) {
+        if (cr.isEmpty() || cr.isSimmParameter() || cr.imModel == "Schedule")
+            continue;
+        vector<Size>* records = nullptr;
+        switch (cr.riskType) {
+        case RiskType::IRCurve:
+        case RiskType::Inflation:
+        case RiskType::XCcyBasis:
+            records = &irDelta[cr.productClass];
+            break;
+        case RiskType::IRVol:
+        case RiskType::InflationVol:
+            records = &irVega[cr.productClass];
+            break;
+        case RiskType::FX:
+        case RiskType::FXVol:
+        case RiskType::CreditQ:
+        case RiskType::CreditVol:
+        case RiskType::BaseCorr:
+        case RiskType::CreditNonQ:
+        case RiskType::CreditVolNonQ:
+        case RiskType::Equity:
+        case RiskType::EquityVol:
+        case RiskType::Commodity:
+        case RiskType::CommodityVol:
+            records = &other[std::make_pair(cr.productClass, cr.riskType)];
+            break;
+        default:
+            break;
+        }
+        if (records != nullptr) {
+            records->push_back(sensitivities_.size());
+            sensitivities_.push_back(cr);
+        }
+    }
+
+    addInterestRateBlocks(irDelta, irVega);
+    for (const auto& [key, records] : other)
+        addBlock(key.first, key.second, records);
+}
+
+void PathwiseSimmCalculator::addInterestRateBlocks(const map<ProductClass, vector<Size>>& delta,
+                                                   const map<ProductClass, vector<Size>>& vega) {
+
+    // Interest rate delta, see SimmCalculator::irDeltaMargin()
+
+    for (const auto& [pc, records] : delta) {
+        Block& block = blocks_[std::make_tuple(pc, RiskClass::InterestRate, MarginType::Delta)];
+        block.interestRate = true;
+
+        // The currencies with their IRCurve, Inflation and XCcyBasis sensitivities in this order
+        map<string, vector<Size>> curve, inflation, xccy;
+        for (auto i : records) {
+            const CrifRecord& cr = sensitivities_[i];
+            auto& m = cr.riskType == RiskType::IRCurve ? curve : cr.riskType == RiskType::Inflation ? inflation : xccy;
+            m[cr.qualifier].push_back(i);
+        }
+        set<string> qualifiers;
+        for (const auto* m : {&curve, &inflation, &xccy}) {
+            for (const auto& kv : *m)
+                qualifiers.insert(kv.first);
+        }
+
+        for (const auto& q : qualifiers) {
+            const vector<Size>& c = curve[q];
+            const vector<Size>& inf = inflation[q];
+            const vector<Size>& x = xccy[q];
+            QL_REQUIRE(inf.size() < 2, "PathwiseSimmCalculator: Expected either 0 or 1 elements for risk type "
+                                           << RiskType::Inflation << " and qualifier " << q << " but got "
+                                           << inf.size());
+            QL_REQUIRE(x.size() < 2, "PathwiseSimmCalculator: Expected either 0 or 1 elements for risk type "
+                                         << RiskType::XCcyBasis << " and qualifier " << q << " but got " << x.size());
+
+            const Size group = block.thresholds.size();
+            block.thresholds.push_back(simmConfiguration_->concentrationThreshold(RiskType::IRCurve, q));
+
+            Bucket bucket;
+            vector<Size> all(c);
+            all.insert(all.end(), inf.begin(), inf.end());
+            all.insert(all.end(), x.begin(), x.end());
+            for (auto i : all) {
+                const CrifRecord& cr = sensitivities_[i];
+                // XccyBasis is not included in the concentration risk and not scaled by it
+                const bool concentration = cr.riskType != RiskType::XCcyBasis;
+                bucket.sensitivities.push_back(block.sensitivities.size());
+                block.sensitivities.push_back(
+                    {i, simmConfiguration_->weight(cr.riskType, q, cr.label1), 1.0, group, concentration});
+            }
+
+            bucket.correlation = Matrix(all.size(), all.size(), 1.0);
+            for (Size i = 0; i < all.size(); ++i) {
+                const CrifRecord& ci = sensitivities_[all[i]];
+                for (Size j = 0; j < i; ++j) {
+                    const CrifRecord& cj = sensitivities_[all[j]];
+                    Real corr;
+                    if (ci.riskType == RiskType::IRCurve && cj.riskType == RiskType::IRCurve) {
+                        corr = simmConfiguration_->correlation(RiskType::IRCurve, q, "", ci.label2, RiskType::IRCurve,
+                                                               q, "", cj.label2) *
+                               simmConfiguration_->correlation(RiskType::IRCurve, q, ci.label1, "", RiskType::IRCurve,
+                                                               q, cj.label1, "");
+                    } else {
+                        // Label1 and Label2 do not matter, the riskTypes are ordered as in irDeltaMargin()
+                        corr = simmConfiguration_->correlation(cj.riskType, q, "", "", ci.riskType, q, "", "");
+                    }
+                    bucket.correlation[i][j] = bucket.correlation[j][i] = corr;
+                }
+            }
+            block.buckets.push_back(bucket);
+        }
+
+        block.gamma = Matrix(qualifiers.size(), qualifiers.size(), 1.0);
+        Size b = 0;
+        for (auto o = qualifiers.begin(); o != qualifiers.end(); ++o, ++b) {
+            Size c = 0;
+            for (auto i = qualifiers.begin(); i != o; ++i, ++c) {
+                block.gamma[b][c] = block.gamma[c][b] =
+                    simmConfiguration_->correlation(RiskType::IRCurve, *o, "", "", RiskType::IRCurve, *i, "", "");
+            }
+        }
+    }
+
+    // Interest rate vega, see SimmCalculator::irVegaMargin()
+
+    for (const auto& [pc, records] : vega) {
+        Block& block = blocks_[std::make_tuple(pc, RiskClass::InterestRate, MarginType::Vega)];
+        block.interestRate = true;
+
+        map<string, vector<Size>> ir, inflation;
+        for (auto i : records) {
+            const CrifRecord& cr = sensitivities_[i];
+            (cr.riskType == RiskType::IRVol ? ir : inflation)[cr.qualifier].push_back(i);
+        }
+        set<string> qualifiers;
+        for (const auto* m : {&ir, &inflation}) {
+            for (const auto& kv : *m)
+                qualifiers.insert(kv.first);
+        }
+
+        for (const auto& q : qualifiers) {
+            const Size group = block.thresholds.size();
+            block.thresholds.push_back(simmConfiguration_->concentrationThreshold(RiskType::IRVol, q));
+
+            Bucket bucket;
+            vector<Size> all(ir[q]);
+            all.insert(all.end(), inflation[q].begin(), inflation[q].end());
+            for (auto i : all) {
+                const CrifRecord& cr = sensitivities_[i];
+                bucket.sensitivities.push_back(block.sensitivities.size());
+                block.sensitivities.push_back(
+                    {i, simmConfiguration_->weight(cr.riskType, q, cr.label1), 1.0, group, true});
+            }
+
+            bucket.correlation = Matrix(all.size(), all.size(), 1.0);
+            for (Size i = 0; i < all.size(); ++i) {
+                const CrifRecord& ci = sensitivities_[all[i]];
+                for (Size j = 0; j < i; ++j) {
+                    const CrifRecord& cj = sensitivities_[all[j]];
+                    bucket.correlation[i][j] = bucket.correlation[j][i] = simmConfiguration_->correlation(
+                        ci.riskType, q, ci.label1, "", cj.riskType, q, cj.label1, "");
+                }
+            }
+            block.buckets.push_back(bucket);
+        }
+
+        block.gamma = Matrix(qualifiers.size(), qualifiers.size(), 1.0);
+        Size b = 0;
+        for (auto o = qualifiers.begin(); o != qualifiers.end(); ++o, ++b) {
+            Size c = 0;
+            for (auto i = qualifiers.begin(); i != o; ++i, ++c) {
+                block.gamma[b][c] = block.gamma[c][b] = simmConfiguration_->correlation(
+                    RiskType::IRVol, *o, "", "", RiskType::IRVol, *i, "", "", calculationCcy_);
+            }
+        }
+    }
+}
+
+void PathwiseSimmCalculator::addBlock(const ProductClass pc, const RiskType rt, const vector<Size>& records) {
+
+    // See SimmCalculator::margin()
+
+    MarginType mt = MarginType::Delta;
+    if (rt == RiskType::BaseCorr)
+        mt = MarginType::BaseCorr;
+    else if (rt == RiskType::FXVol || rt == RiskType::CreditVol || rt == RiskType::CreditVolNonQ ||
+             rt == RiskType::EquityVol || rt == RiskType::CommodityVol)
+        mt = MarginType::Vega;
+    Block& block = blocks_[std::make_tuple(pc, SimmConfiguration::riskTypeToRiskClass(rt), mt)];
+
+    const Real hvr = simmConfiguration_->historicalVolatilityRatio(rt);
+
+    // The buckets with their sensitivities and qualifiers
+    map<string, vector<Size>> buckets;
+    map<string, set<string>> qualifiers;
+    for (auto i : records) {
+        buckets[sensitivities_[i].bucket].push_back(i);
+        qualifiers[sensitivities_[i].bucket].insert(sensitivities_[i].qualifier);
+    }
+
+    for (const auto& [name, bucketRecords] : buckets) {
+        Bucket bucket;
+        bucket.residual = name == "Residual";
+        map<string, Size> groups;
+        vector<Size> used;
+        for (auto i : bucketRecords) {
+            const CrifRecord& cr = sensitivities_[i];
+            // Do not include Risk_FX components in the calculation currency in the SIMM calculation
+            if (rt == RiskType::FX && cr.qualifier == calculationCcy_)
+                continue;
+            auto g = groups.find(cr.qualifier);
+            if (g == groups.end()) {
+                g = groups.emplace(cr.qualifier, block.thresholds.size()).first;
+                block.thresholds.push_back(simmConfiguration_->concentrationThreshold(rt, cr.qualifier));
+            }
+            Real rw = simmConfiguration_->weight(rt, cr.qualifier, cr.label1, calculationCcy_);
+            Real sigma = simmConfiguration_->sigma(rt, cr.qualifier, cr.label1, calculationCcy_);
+            bucket.sensitivities.push_back(block.sensitivities.size());
+            block.sensitivities.push_back({i, rw * sigma * hvr, sigma * hvr, g->second, true});
+            used.push_back(i);
+        }
+
+        bucket.correlation = Matrix(used.size(), used.size(), 1.0);
+        for (Size i = 0; i < used.size(); ++i) {
+            const CrifRecord& ci = sensitivities_[used[i]];
+            for (Size j = 0; j < i; ++j) {
+                const CrifRecord& cj = sensitivities_[used[j]];
+                bucket.correlation[i][j] = bucket.correlation[j][i] = simmConfiguration_->correlation(
+                    rt, ci.qualifier, ci.label1, ci.label2, rt, cj.qualifier, cj.label1, cj.label2, calculationCcy_);
+            }
+        }
+        block.buckets.push_back(bucket);
+    }
+
+    // Inter-bucket correlations, a qualifier from each of the buckets is used to look them up
+    block.gamma = Matrix(buckets.size(), buckets.size(), 1.0);
+    Size b = 0;
+    for (auto o = buckets.begin(); o != buckets.end(); ++o, ++b) {
+        Size c = 0;
+        for (auto i = buckets.begin(); i != o; ++i, ++c) {
+            block.gamma[b][c] = block.gamma[c][b] =
+                simmConfiguration_->correlation(rt, *qualifiers.at(o->first).begin(), "", "", rt,
+                                                *qualifiers.at(i->first).begin(), "", "", calculationCcy_);
+        }
+    }
+}
+
+RandomVariable PathwiseSimmCalculator::blockMargin(const Block& block, const vector<RandomVariable>& amounts) const {
+
+    const Size n = amounts.front().size();
+    const RandomVariable one(n, 1.0), zero(n, 0.0);
+
+    // Concentration risks $CR$ of the qualifiers
+
+    vector<RandomVariable> cr(block.thresholds.size(), zero);
+    for (const auto& s : block.sensitivities) {
+        if (s.concentration)
+            cr[s.group] += RandomVariable(n, s.concentrationFactor) * amounts[s.index];
+    }
+    for (Size g = 0; g < cr.size(); ++g)
+        cr[g] = max(one, sqrt(abs(cr[g]) / RandomVariable(n, block.thresholds[g])));
+
+    // Weighted sensitivities $WS_k$
+
+    vector<RandomVariable> ws(block.sensitivities.size());
+    for (Size k = 0; k < ws.size(); ++k) {
+        const auto& s = block.sensitivities[k];
+        ws[k] = RandomVariable(n, s.weight) * amounts[s.index];
+        if (s.concentration)
+            ws[k] *= cr[s.group];
+    }
+
+    // Bucket margins $K_b$ and bounded sums of weighted sensitivities $S_b$
+
+    const Size nb = block.buckets.size();
+    vector<RandomVariable> k(nb, zero), sb(nb, zero);
+    for (Size b = 0; b < nb; ++b) {
+        const Bucket& bucket = block.buckets[b];
+        RandomVariable sum = zero;
+        for (Size i = 0; i < bucket.sensitivities.size(); ++i) {
+            const Size si = bucket.sensitivities[i];
+            sum += ws[si];
+            k[b] += ws[si] * ws[si];
+            for (Size j = 0; j < i; ++j) {
+                const Size sj = bucket.sensitivities[j];
+                RandomVariable corr(n, 2.0 * bucket.correlation[i][j]);
+                if (!block.interestRate) {
+                    // $f_{k,l}$ from the SIMM docs
+                    const auto& ci = cr[block.sensitivities[si].group];
+                    const auto& cj = cr[block.sensitivities[sj].group];
+                    corr *= min(ci, cj) / max(ci, cj);
+                }
+                k[b] += corr * ws[si] * ws[sj];
+            }
+        }
+        k[b] = sqrt(max(k[b], zero));
+        sb[b] = max(min(sum, k[b]), -k[b]);
+    }
+
+    // Aggregation across the non-residual buckets, the residual bucket margin is added
+
+    RandomVariable margin = zero, residual = zero;
+    for (Size b = 0; b < nb; ++b) {
+        if (block.buckets[b].residual) {
+            residual += k[b];
+            continue;
+        }
+        margin += k[b] * k[b];
+        for (Size c = 0; c < b; ++c) {
+            if (block.buckets[c].residual)
+                continue;
+            RandomVariable corr(n, 2.0 * block.gamma[b][c]);
+            // For interest rate the buckets are the concentration groups, $g_{b,c}$ from the SIMM docs
+            if (block.interestRate)
+                corr *= min(cr[b], cr[c]) / max(cr[b], cr[c]);
+            margin += corr * sb[b] * sb[c];
+        }
+    }
+
+    return sqrt(max(margin, zero)) + residual;
+}
+
+map<PathwiseSimmCalculator::ComponentKey, RandomVariable>
+PathwiseSimmCalculator::componentMargins(const vector<RandomVariable>& amounts) const {
+    QL_REQUIRE(amounts.size() == sensitivities_.size(), "PathwiseSimmCalculator::componentMargins(): "
+                                                            << amounts.size() << " amounts given, expected "
+                                                            << sensitivities_.size());
+    map<ComponentKey, RandomVariable> result;
+    if (amounts.empty())
+        return result;
+    for (Size i = 1; i < amounts.size(); ++i) {
+        QL_REQUIRE(amounts[i].size() == amounts.front().size(),
+                   "PathwiseSimmCalculator::componentMargins(): amount "
+                       << i << " has size " << amounts[i].size() << ", expected " << amounts.front().size());
+    }
+    for (const auto& [key, block] : blocks_)
+        result[key] = blockMargin(block, amounts);
+    return result;
+}
+
+RandomVariable PathwiseSimmCalculator::margin(const vector<RandomVariable>& amounts) const {
+
+    auto components = componentMargins(amounts);
+    if (components.empty())
+        return RandomVariable(amounts.empty() ? 1 : amounts.front().size(), 0.0);
+
+    const Size n = amounts.front().size();
+    const RandomVariable zero(n, 0.0);
+
+    // Risk class margins as sum over the margin types, aggregation across risk classes within the product classes
+    // and sum over the product classes, see SimmCalculator::populateResults()
+
+    const auto rcs = SimmConfiguration::riskClasses(false);
+    RandomVariable im = zero;
+    for (const auto& pc : SimmConfiguration::productClasses(false)) {
+        map<RiskClass, RandomVariable> riskClassMargins;
+        for (const auto& [key, m] : components) {
+            if (std::get<0>(key) != pc)
+                continue;
+            auto r = riskClassMargins.emplace(std::get<1>(key), zero).first;
+            r->second += m;
+        }
+        if (riskClassMargins.empty())
+            continue;
+        RandomVariable productClassMargin = zero;
+        for (auto o = riskClassMargins.begin(); o != riskClassMargins.end(); ++o) {
+            productClassMargin += o->second * o->second;
+            for (auto i = riskClassMargins.begin(); i != o; ++i) {
+                productClassMargin +=
+                    RandomVariable(n, 2.0 * simmConfiguration_->correlationRiskClasses(o->first, i->first)) *
+                    o->second * i->second;
+            }
+        }
+        im += sqrt(max(productClassMargin, zero));
+    }
+
+    return im;
+}
+
+} // namespace analytics
+} // namespace ore
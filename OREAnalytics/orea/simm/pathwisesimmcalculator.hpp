@@ -0,0 +1,118 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/simm/pathwisesimmcalculator.hpp
+    \brief SIMM delta and vega margin evaluated on path-wise sensitivities
+*/
+
+#pragma once
+
+#include <orea/simm/crif.hpp>
+#include <orea/simm/simmconfiguration.hpp>
+
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/math/matrix.hpp>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+/*! Evaluates the SIMM delta, vega and base correlation margin for sensitivities given as random variables, i.e. with
+    one value per path, across all paths at once, e.g. to compute a path-wise dynamic initial margin from simulated
+    (AMC / CG) sensitivities.
+
+    The risk factors are given by the records of the \p structure CRIF on construction (the amounts are ignored).
+    Risk weights, concentration thresholds and correlations are looked up in the SIMM configuration once, on
+    construction. margin() then evaluates the same aggregation as SimmCalculator for the delta, vega and base
+    correlation margin types, with the concentration risk factors computed path-wise.
+
+    Curvature margin, add-on margins and product class multipliers are not included. Amounts are expected in USD, as
+    the concentration thresholds are. Records of risk types without delta or vega margin (e.g. Notional, PV and the
+    SIMM parameters) are ignored.
+*/
+class PathwiseSimmCalculator {
+public:
+    typedef std::tuple<CrifRecord::ProductClass, SimmConfiguration::RiskClass, SimmConfiguration::MarginType>
+        ComponentKey;
+
+    PathwiseSimmCalculator(const QuantLib::ext::shared_ptr<SimmConfiguration>& simmConfiguration,
+                           const ore::analytics::Crif& structure, const std::string& calculationCcy = "USD");
+
+    //! The sensitivities, margin() expects the amounts in this order
+    const std::vector<CrifRecord>& sensitivities() const { return sensitivities_; }
+
+    //! The margin for each product class, risk class and margin type, \p amounts are the amounts of sensitivities()
+    std::map<ComponentKey, QuantExt::RandomVariable>
+    componentMargins(const std::vector<QuantExt::RandomVariable>& amounts) const;
+
+    //! The total margin, aggregated from the component margins like in SimmCalculator
+    QuantExt::RandomVariable margin(const std::vector<QuantExt::RandomVariable>& amounts) const;
+
+private:
+    //! A sensitivity of a margin component, the weighted sensitivity is weight * amount * CR (if concentration)
+    struct Sensitivity {
+        QuantLib::Size index;
+        QuantLib::Real weight;
+        //! factor of the amount in the sum for the concentration risk of group
+        QuantLib::Real concentrationFactor;
+        QuantLib::Size group;
+        bool concentration;
+    };
+
+    struct Bucket {
+        //! the sensitivities of the bucket, indices into Block::sensitivities
+        std::vector<QuantLib::Size> sensitivities;
+        //! correlations between the bucket's sensitivities
+        QuantLib::Matrix correlation;
+        bool residual = false;
+    };
+
+    //! A margin component, i.e. the sensitivities of a product class, risk class and margin type
+    struct Block {
+        std::vector<Sensitivity> sensitivities;
+        //! concentration thresholds of the concentration groups (qualifiers)
+        std::vector<QuantLib::Real> thresholds;
+        std::vector<Bucket> buckets;
+        //! correlations between the buckets
+        QuantLib::Matrix gamma;
+        /*! For the interest rate risk class the buckets are the currencies and the concentration groups, the
+            inter-bucket correlations are scaled by the concentration ratio. Otherwise the intra-bucket correlations
+            are scaled by the ratio of the sensitivities' concentration risks. */
+        bool interestRate = false;
+    };
+
+    void addInterestRateBlocks(const std::map<CrifRecord::ProductClass, std::vector<QuantLib::Size>>& delta,
+                               const std::map<CrifRecord::ProductClass, std::vector<QuantLib::Size>>& vega);
+    void addBlock(const CrifRecord::ProductClass pc, const CrifRecord::RiskType rt,
+                  const std::vector<QuantLib::Size>& records);
+
+    QuantExt::RandomVariable blockMargin(const Block& block,
+                                         const std::vector<QuantExt::RandomVariable>& amounts) const;
+
+    QuantLib::ext::shared_ptr<SimmConfiguration> simmConfiguration_;
+    std::string calculationCcy_;
+    std::vector<CrifRecord> sensitivities_;
+    std::map<ComponentKey, Block> blocks_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -25,7 +25,9 @@
 #include <orea/simm/crif.hpp>
 #include <ql/time/date.hpp>
 
+#include <set>
 #include <string>
+#include <tuple>
 
 namespace ore {
 namespace analytics {
@@ -64,12 +66,25 @@ public:
 
     virtual const std::set<FailedMapping>& failedMappings() const = 0;
 
+    /*! Add the bucket mappings given by the records of \p crif. Each distinct combination of risk type, qualifier
+        and bucket is added once, since a CRIF usually contains many records per qualifier. */
     void updateFromCrif(const ore::analytics::Crif& crif) {
+        std::set<std::tuple<CrifRecord::RiskType, std::string, std::string>> mappings;
+        std::set<CrifRecord::RiskType> withBuckets, withoutBuckets;
         for (const auto& cr : crif) {
-            if (!cr.isSimmParameter() && hasBuckets(cr.riskType)) {
-                addMapping(cr.riskType, cr.qualifier, cr.bucket);
+            if (cr.isSimmParameter() || withoutBuckets.count(cr.riskType) > 0)
+                continue;
+            if (withBuckets.count(cr.riskType) == 0) {
+                if (!hasBuckets(cr.riskType)) {
+                    withoutBuckets.insert(cr.riskType);
+                    continue;
+                }
+                withBuckets.insert(cr.riskType);
             }
+            mappings.insert(std::make_tuple(cr.riskType, cr.qualifier, cr.bucket));
         }
+        for (const auto& [riskType, qualifier, bucket] : mappings)
+            addMapping(riskType, qualifier, bucket);
     }
 };
 
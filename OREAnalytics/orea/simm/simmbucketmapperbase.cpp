@@ -86,6 +86,8 @@ QuantLib::Date BucketMapping::validFromDate() const {
 
 string SimmBucketMapperBase::bucket(const RiskType& riskType, const string& qualifier) const {
 
+    std::lock_guard<std::mutex> lock(bucketMutex_);
+
     auto key = std::make_pair(riskType, qualifier);
     if (auto b = cache_.find(key); b != cache_.end())
         return b->second;
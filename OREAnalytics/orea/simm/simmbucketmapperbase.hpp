@@ -29,6 +29,7 @@
 #include <ored/portfolio/referencedata.hpp>
 
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -64,7 +65,7 @@ public:
 
     /*! Return the SIMM <em>bucket</em> for a given SIMM <em>RiskType</em> and
         SIMM <em>Qualifier</em>. An error is thrown if there is no <em>bucket</em>
-        for the combination.
+        for the combination. This method is safe to call concurrently.
     */
     std::string bucket(const CrifRecord::RiskType& riskType, const std::string& qualifier) const override;
 
@@ -117,6 +118,9 @@ protected:
 private:
     mutable std::map<std::pair<CrifRecord::RiskType, std::string>, std::string> cache_;
 
+    //! Protects cache_ and failedMappings_ in bucket()
+    mutable std::mutex bucketMutex_;
+
     //! Reset the SIMM bucket mapper i.e. clears all mappings and adds the initial hard-coded commodity mappings
     void reset();
 
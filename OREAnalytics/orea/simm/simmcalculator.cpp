@@ -21,6 +21,7 @@
 #include <orea/simm/simmcalculator.hpp>
 #include <orea/simm/utilities.hpp>
 #include <orea/simm/simmconfigurationbase.hpp>
+#include <qle/math/chunkworkers.hpp>
 
 #include <boost/math/distributions/normal.hpp>
 #include <numeric>
@@ -30,6 +31,7 @@
 #include <ored/utilities/parsers.hpp>
 #include <ql/math/comparison.hpp>
 #include <ql/quote.hpp>
+#include <ql/settings.hpp>
 
 using std::abs;
 using std::accumulate;
@@ -49,7 +51,10 @@ using ore::data::Market;
 using ore::data::to_string;
 using ore::data::parseBool;
 using QuantLib::close_enough;
+using QuantLib::Date;
 using QuantLib::Real;
+using QuantLib::Settings;
+using QuantLib::Size;
 
 namespace ore {
 namespace analytics {
@@ -62,16 +67,125 @@ typedef CrifRecord::RiskType RiskType;
 typedef SimmConfiguration::Regulation Regulation;
 typedef SimmConfiguration::SimmSide SimmSide;
 
+namespace {
+
+// Maps labels to consecutive integer ids in the order of their first occurrence
+class LabelIds {
+public:
+    Size id(const string& label) { return ids_.emplace(label, ids_.size()).first->second; }
+    Size size() const { return ids_.size(); }
+
+private:
+    map<string, Size> ids_;
+};
+
+// Dense table of correlations between label ids, each entry is looked up in the configuration on first use only
+class CorrelationTable {
+public:
+    explicit CorrelationTable(const Size n) : n_(n), values_(n * n, QuantLib::Null<Real>()) {}
+    template <class F> Real operator()(const Size i, const Size j, const F& lookup) {
+        Real& v = values_[i * n_ + j];
+        if (v == QuantLib::Null<Real>())
+            v = lookup();
+        return v;
+    }
+
+private:
+    Size n_;
+    std::vector<Real> values_;
+};
+
+// Helpers for the reverse pass of the SIMM gradient, each follows the branch taken by the margin calculation
+
+// Derivative of $\sqrt{\max(x, 0)}$ with respect to $x$, given the root, zero if the root is zero
+Real rootDerivative(const Real root) { return root > 0.0 ? 0.5 / root : 0.0; }
+
+// Derivative of $|x|$ with respect to $x$
+Real absDerivative(const Real x) { return x > 0.0 ? 1.0 : (x < 0.0 ? -1.0 : 0.0); }
+
+// Derivative of the concentration risk $\max(1, \sqrt{|x|})$ with respect to $x$
+Real concentrationRiskDerivative(const Real x) {
+    Real root = sqrt(std::abs(x));
+    return root > 1.0 ? absDerivative(x) * 0.5 / root : 0.0;
+}
+
+// Add the adjoint \p a of $S = \max(\min(s, k), -k)$ to the adjoints of $s$ and $k$
+void cappedSumAdjoint(const Real s, const Real k, const Real a, Real& aS, Real& aK) {
+    if (s > k)
+        aK += a;
+    else if (s < -k)
+        aK -= a;
+    else
+        aS += a;
+}
+
+// Add the adjoint \p a of $\min(x, y) / \max(x, y)$ to the adjoints of $x$ and $y$
+void ratioAdjoint(const Real x, const Real y, const Real a, Real& aX, Real& aY) {
+    if (x < y) {
+        aX += a / y;
+        aY -= a * x / (y * y);
+    } else if (y < x) {
+        aY += a / x;
+        aX -= a * y / (x * x);
+    }
+}
+
+// The records of a currency for the reverse pass through the IR delta or vega margin, with their risk weights, the
+// derivatives of $K_b^2$ w.r.t. their weighted sensitivities and whether these are scaled by the concentration risk,
+// and the concentration risk before the floor and its threshold
+struct CurrencyAdjoint {
+    std::vector<CrifRecord> records;
+    std::vector<Real> rw, dK2;
+    std::vector<bool> hasCr;
+    Real concentration = 0.0, threshold = 1.0;
+};
+
+// Reverse pass through the IR delta or vega margin $\sqrt{\sum_b K_b^2 + \sum_{b \neq c} \gamma_{b,c} g_{b,c} S_b S_c}$
+// aggregated across currencies, the currency margins $K_b$ and the concentration risks. The derivatives of the sum in
+// the root w.r.t. the $S_b$, and through the $g_{b,c}$ w.r.t. the concentration risks, are given by \p dMarginS and
+// \p dMarginCr.
+void addCurrencyMarginGradient(map<CrifRecord, Real>& gradient, const Real margin,
+                               const map<string, CurrencyAdjoint>& adjoints, const map<string, Real>& currencyMargin,
+                               const map<string, Real>& sumWeightedSensis, const map<string, Real>& concentrationRisk,
+                               const map<string, Real>& dMarginS, const map<string, Real>& dMarginCr) {
+    auto value = [](const map<string, Real>& m, const string& key) {
+        auto it = m.find(key);
+        return it == m.end() ? 0.0 : it->second;
+    };
+    Real aMargin = rootDerivative(margin);
+    for (const auto& [qualifier, adj] : adjoints) {
+        Real k = currencyMargin.at(qualifier);
+        Real aK = aMargin * 2.0 * k, aSum = 0.0;
+        cappedSumAdjoint(sumWeightedSensis.at(qualifier), k, aMargin * value(dMarginS, qualifier), aSum, aK);
+        Real aK2 = aK * rootDerivative(k);
+        Real cr = concentrationRisk.at(qualifier);
+        Real aCr = aMargin * value(dMarginCr, qualifier);
+        for (Size i = 0; i < adj.records.size(); ++i) {
+            Real aWs = aK2 * adj.dK2[i] + aSum;
+            gradient[adj.records[i]] += aWs * adj.rw[i] * (adj.hasCr[i] ? cr : 1.0);
+            if (adj.hasCr[i])
+                aCr += aWs * adj.rw[i] * adj.records[i].amountResultCcy;
+        }
+        Real aConcentration = aCr * concentrationRiskDerivative(adj.concentration) / adj.threshold;
+        for (Size i = 0; i < adj.records.size(); ++i) {
+            if (adj.hasCr[i])
+                gradient[adj.records[i]] += aConcentration;
+        }
+    }
+}
+
+} // namespace
+
 SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
                                const QuantLib::ext::shared_ptr<SimmConfiguration>& simmConfiguration,
                                const string& calculationCcyCall, const string& calculationCcyPost,
                                const string& resultCcy, const QuantLib::ext::shared_ptr<Market> market,
                                const bool determineWinningRegulations, const bool enforceIMRegulations,
                                const bool quiet, const map<SimmSide, set<NettingSetDetails>>& hasSEC,
-                               const map<SimmSide, set<NettingSetDetails>>& hasCFTC)
+                               const map<SimmSide, set<NettingSetDetails>>& hasCFTC, const Size nThreads)
     : simmConfiguration_(simmConfiguration), calculationCcyCall_(calculationCcyCall),
       calculationCcyPost_(calculationCcyPost), resultCcy_(resultCcy.empty() ? calculationCcyCall_ : resultCcy),
-      market_(market), quiet_(quiet), hasSEC_(hasSEC), hasCFTC_(hasCFTC) {
+      market_(market), quiet_(quiet), hasSEC_(hasSEC), hasCFTC_(hasCFTC), nThreads_(nThreads) {
 
     QL_REQUIRE(checkCurrency(calculationCcyCall_), "SIMM Calculator: The Call side calculation currency ("
                                                    << calculationCcyCall_ << ") must be a valid ISO currency code");
@@ -109,19 +223,7 @@ SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
         }
 
         // Make sure we have CRIF amount denominated in the result ccy
-        CrifRecord newCrifRecord = cr;
-        
-        if (cr.requiresAmountUsd() && resultCcy_ == "USD" && cr.hasAmountUsd()) {
-            newCrifRecord.amountResultCcy = newCrifRecord.amountUsd;
-        } else if(cr.requiresAmountUsd()) {
-            // ProductClassMultiplier and AddOnNotionalFactor  don't have a currency and dont need to be converted,
-            // we use the amount
-            const Real fxSpot = market_->fxRate(newCrifRecord.amountCurrency + resultCcy_)->value();
-            newCrifRecord.amountResultCcy = fxSpot * newCrifRecord.amount;
-        }
-        newCrifRecord.resultCurrency = resultCcy_;
-
-        crif_.addRecord(newCrifRecord);
+        crif_.addRecord(resultCcyRecord(cr));
     }
 
     // If there are no CRIF records to process
@@ -186,21 +288,18 @@ SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
     }
 
     // Calculate SIMM call and post for each regulation under each netting set
-    for (const auto& [side, nettingSetRegulationCrifMap] : regSensitivities_) {
-        for (const auto& [nsd, regulationCrifMap] : nettingSetRegulationCrifMap) {
-            // Calculate SIMM for particular side-nettingSet-regulation combination
-            for (const auto& [regulation, crif] : regulationCrifMap) {
-                bool hasFixedAddOn = false;
-                for (const auto& sp : crif) {
-                    if (sp.riskType == RiskType::AddOnFixedAmount) {
-                        hasFixedAddOn = true;
-                        break;
-                    }
+    if (nThreads_ <= 1) {
+        for (const auto& [side, nettingSetRegulationCrifMap] : regSensitivities_) {
+            for (const auto& [nsd, regulationCrifMap] : nettingSetRegulationCrifMap) {
+                // Calculate SIMM for particular side-nettingSet-regulation combination
+                for (const auto& [regulation, crif] : regulationCrifMap) {
+                    if (hasSimmRecords(crif))
+                        calculateRegulationSimm(crif, nsd, regulation, side);
                 }
-                if (crif.hasCrifRecords() || hasFixedAddOn)
-                    calculateRegulationSimm(crif, nsd, regulation, side);
             }
         }
+    } else {
+        calculateRegulationSimmParallel();
     }
 
     // Determine winning call and post regulations
@@ -256,124 +355,385 @@ const void SimmCalculator::calculateRegulationSimm(const Crif& crif,
         LOG("SimmCalculator: Calculating SIMM " << side << " for portfolio [" << nettingSetDetails << "], regulation "
                                                 << regulation);
     }
+
+    auto components = marginComponents(crif, nettingSetDetails, side);
+    for (auto& c : components)
+        c.result = c.calc(nullptr);
+
+    std::vector<CrifRecord> parameters;
+    aggregateRegulationSimm(simmResults_[side][nettingSetDetails][regulation], parameters, crif, nettingSetDetails,
+                            regulation, side, components);
+    for (const auto& cr : parameters)
+        simmParameters_.addRecord(cr);
+}
+
+void SimmCalculator::calculateRegulationSimmParallel() {
+
+    // The tasks, one per side-nettingSet-regulation combination, in the order of the sequential calculation. The
+    // results containers are created upfront, so that the tasks do not modify the containers' structure.
+
+    struct Task {
+        const SimmSide* side;
+        const NettingSetDetails* nsd;
+        const string* regulation;
+        const Crif* crif;
+        SimmResults* results;
+        std::vector<MarginComponent> components;
+        std::vector<CrifRecord> parameters;
+    };
+
+    std::vector<Task> tasks;
+    for (const auto& [side, nettingSetRegulationCrifMap] : regSensitivities_) {
+        for (const auto& [nsd, regulationCrifMap] : nettingSetRegulationCrifMap) {
+            for (const auto& [regulation, crif] : regulationCrifMap) {
+                if (hasSimmRecords(crif)) {
+                    if (!quiet_) {
+                        LOG("SimmCalculator: Calculating SIMM " << side << " for portfolio [" << nsd
+                                                                << "], regulation " << regulation);
+                    }
+                    tasks.push_back({&side, &nsd, &regulation, &crif, &simmResults_[side][nsd][regulation],
+                                     marginComponents(crif, nsd, side), {}});
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<Size, Size>> components;
+    for (Size i = 0; i < tasks.size(); ++i) {
+        for (Size j = 0; j < tasks[i].components.size(); ++j)
+            components.push_back(std::make_pair(i, j));
+    }
+
+    if (!quiet_) {
+        LOG("SimmCalculator: Calculating " << components.size() << " margin components for " << tasks.size()
+                                           << " netting set regulations using " << nThreads_ << " threads");
+    }
+
+    // The worker threads use the evaluation date of the calling thread, e.g. for the bucket mapping
+
+    Date today = Settings::instance().evaluationDate();
+    QuantExt::ChunkWorkers workers(nThreads_);
+
+    // Calculate the margin components over all netting sets, regulations, product classes and risk classes
+
+    workers.run(components.size(), [&tasks, &components, &today](const Size k) {
+        if (Settings::instance().evaluationDate() != today)
+            Settings::instance().evaluationDate() = today;
+        auto& c = tasks[components[k].first].components[components[k].second];
+        c.result = c.calc(nullptr);
+    });
+
+    // Aggregate the margin components for each netting set and regulation, each task writes to its own results
+
+    workers.run(tasks.size(), [this, &tasks, &today](const Size k) {
+        if (Settings::instance().evaluationDate() != today)
+            Settings::instance().evaluationDate() = today;
+        auto& t = tasks[k];
+        aggregateRegulationSimm(*t.results, t.parameters, *t.crif, *t.nsd, *t.regulation, *t.side, t.components);
+    });
+
+    // Record the SIMM parameters in the order of the sequential calculation
+
+    for (const auto& t : tasks) {
+        for (const auto& cr : t.parameters)
+            simmParameters_.addRecord(cr);
+    }
+}
+
+SimmResults SimmCalculator::incrementalSimm(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
+                                            const string& regulation, const Crif& added, const Crif& removed) {
+
+    const Crif& baseCrif = regulationCrif(side, nettingSetDetails, regulation);
+    const ComponentResults& cache = cachedComponents(side, nettingSetDetails, regulation);
+
+    // Apply the changes to a copy of the regulation CRIF, removed records are added with negated amounts. The
+    // records are prepared as in the constructor and splitCrifByRegulationsAndPortfolios().
+
+    Crif crif = baseCrif;
+    AffectedClasses affected;
+    auto apply = [this, &nettingSetDetails, &crif, &affected](const Crif& records, const bool remove) {
+        for (const CrifRecord& cr : records) {
+            if (cr.nettingSetDetails != nettingSetDetails || cr.isEmpty() || cr.imModel == "Schedule")
+                continue;
+            QL_REQUIRE(!cr.isSimmParameter(),
+                       "SimmCalculator::incrementalSimm(): SIMM parameter records can not be added or removed: " << cr);
+            CrifRecord r = resultCcyRecord(cr);
+            r.tradeId = "";
+            r.collectRegulations.clear();
+            r.postRegulations.clear();
+            if (remove) {
+                if (r.hasAmount())
+                    r.amount = -r.amount;
+                if (r.hasAmountUsd())
+                    r.amountUsd = -r.amountUsd;
+                if (r.hasAmountResultCcy())
+                    r.amountResultCcy = -r.amountResultCcy;
+            }
+            crif.addRecord(r, true);
+            addAffectedComponents(affected, r);
+        }
+    };
+    apply(added, false);
+    apply(removed, true);
+
+    return recalculateSimm(crif, nettingSetDetails, regulation, side, affected, cache);
+}
+
+std::vector<std::pair<CrifRecord, Real>> SimmCalculator::simmGradient(const SimmSide& side,
+                                                                      const NettingSetDetails& nettingSetDetails,
+                                                                      const string& regulation) {
+
+    const Crif& crif = regulationCrif(side, nettingSetDetails, regulation);
+
+    // Forward: the margin components, each with the derivatives of its margin w.r.t. its records, and the aggregation
+
+    RecordGradient total;
+    if (hasSimmRecords(crif)) {
+        auto components = marginComponents(crif, nettingSetDetails, side);
+        std::vector<RecordGradient> componentGradients(components.size());
+        for (Size i = 0; i < components.size(); ++i)
+            components[i].result = components[i].calc(&componentGradients[i]);
+
+        SimmResults results;
+        std::vector<CrifRecord> parameters;
+        aggregateRegulationSimm(results, parameters, crif, nettingSetDetails, regulation, side, components);
+
+        // Reverse: the total margin is the sum of the product class margins, each scaled by its product class
+        // multiplier if any, plus the fixed and notional based additional margins
+
+        map<ProductClass, Real> pcAdjoint;
+        for (const auto& pc : simmConfiguration_->productClasses(false))
+            pcAdjoint[pc] = 1.0;
+        for (const auto& it : crif.filterBy(nettingSetDetails, ProductClass::Empty, RiskType::ProductClassMultiplier)) {
+            auto qpc = parseProductClass(it.qualifier);
+            if (results.has(qpc, RiskClass::All, MarginType::All, "All"))
+                pcAdjoint[qpc] += it.amount - 1.0;
+        }
+
+        // The product class margin is $\sqrt{\sum_{r,s} \psi_{r,s} IM_r IM_s}$ over the risk class margins, each of
+        // which is the sum of its margin components, see populateResults()
+
+        auto rcs = simmConfiguration_->riskClasses(false);
+        map<pair<ProductClass, RiskClass>, Real> rcAdjoint;
+        for (const auto& [pc, aPc] : pcAdjoint) {
+            map<RiskClass, Real> im, dSum;
+            for (const auto& rc : rcs) {
+                if (results.has(pc, rc, MarginType::All, "All"))
+                    im[rc] = results.get(pc, rc, MarginType::All, "All");
+            }
+            Real sum = 0.0;
+            for (auto ito = im.begin(); ito != im.end(); ++ito) {
+                sum += ito->second * ito->second;
+                dSum[ito->first] += 2.0 * ito->second;
+                for (auto iti = im.begin(); iti != ito; ++iti) {
+                    Real corr = simmConfiguration_->correlationRiskClasses(ito->first, iti->first);
+                    sum += 2.0 * corr * ito->second * iti->second;
+                    dSum[ito->first] += 2.0 * corr * iti->second;
+                    dSum[iti->first] += 2.0 * corr * ito->second;
+                }
+            }
+            Real d = rootDerivative(sqrt(max(sum, 0.0)));
+            for (const auto& [rc, dIm] : dSum)
+                rcAdjoint[std::make_pair(pc, rc)] = aPc * d * dIm;
+        }
+
+        for (Size i = 0; i < components.size(); ++i) {
+            const auto& c = components[i];
+            auto a = rcAdjoint.find(std::make_pair(c.pc, c.rc));
+            if (!c.result.second || a == rcAdjoint.end())
+                continue;
+            for (const auto& [cr, d] : componentGradients[i])
+                total[cr] += a->second * d;
+        }
+
+        // The notional based additional margin, see calcAddMargin(), the fixed amounts are SIMM parameters
+        for (const auto& it : crif.filterBy(nettingSetDetails, ProductClass::Empty, RiskType::AddOnNotionalFactor)) {
+            auto notionals = crif.filterByQualifier(nettingSetDetails, ProductClass::Empty, RiskType::Notional,
+                                                    it.qualifier);
+            if (notionals.size() == 1)
+                total[notionals.front()] += it.amount / 100.0;
+        }
+    }
+
+    std::vector<pair<CrifRecord, Real>> gradient;
+    for (const CrifRecord& cr : crif) {
+        if (cr.isSimmParameter() || !cr.hasAmountResultCcy())
+            continue;
+        auto d = total.find(cr);
+        gradient.push_back(std::make_pair(cr, d == total.end() ? 0.0 : d->second));
+    }
+
+    return gradient;
+}
+
+const Crif& SimmCalculator::regulationCrif(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
+                                           const string& regulation) const {
+    static const Crif noRecords;
+    if (auto s = regSensitivities_.find(side); s != regSensitivities_.end()) {
+        if (auto n = s->second.find(nettingSetDetails); n != s->second.end()) {
+            if (auto r = n->second.find(regulation); r != n->second.end())
+                return r->second;
+        }
+    }
+    return noRecords;
+}
+
+const SimmCalculator::ComponentResults& SimmCalculator::cachedComponents(const SimmSide& side,
+                                                                         const NettingSetDetails& nettingSetDetails,
+                                                                         const string& regulation) {
+    auto [cache, isNew] = componentCache_[side][nettingSetDetails].try_emplace(regulation);
+    const Crif& crif = regulationCrif(side, nettingSetDetails, regulation);
+    if (isNew && hasSimmRecords(crif)) {
+        for (auto& c : marginComponents(crif, nettingSetDetails, side))
+            cache->second[std::make_tuple(c.pc, c.rc, c.mt)] = c.calc(nullptr);
+    }
+    return cache->second;
+}
+
+void SimmCalculator::addAffectedComponents(AffectedClasses& affected, const CrifRecord& cr) {
+    // Notional and PV records only enter the additional margin, which is always recalculated
+    if (cr.riskType != RiskType::Notional && cr.riskType != RiskType::PV)
+        affected.insert(std::make_pair(cr.productClass, SimmConfiguration::riskTypeToRiskClass(cr.riskType)));
+}
+
+SimmResults SimmCalculator::recalculateSimm(const Crif& crif, const NettingSetDetails& nettingSetDetails,
+                                            const string& regulation, const SimmSide& side,
+                                            const AffectedClasses& affected, const ComponentResults& cache) const {
+    SimmResults results;
+    if (!hasSimmRecords(crif))
+        return results;
+
+    auto components = marginComponents(crif, nettingSetDetails, side);
+    for (auto& c : components) {
+        auto cached = cache.find(std::make_tuple(c.pc, c.rc, c.mt));
+        if (cached == cache.end() || affected.count(std::make_pair(c.pc, c.rc)) > 0)
+            c.result = c.calc(nullptr);
+        else
+            c.result = cached->second;
+    }
+
+    std::vector<CrifRecord> parameters;
+    aggregateRegulationSimm(results, parameters, crif, nettingSetDetails, regulation, side, components);
+    return results;
+}
+
+CrifRecord SimmCalculator::resultCcyRecord(const CrifRecord& cr) const {
+    CrifRecord newCrifRecord = cr;
+    if (cr.requiresAmountUsd() && resultCcy_ == "USD" && cr.hasAmountUsd()) {
+        newCrifRecord.amountResultCcy = newCrifRecord.amountUsd;
+    } else if (cr.requiresAmountUsd()) {
+        // ProductClassMultiplier and AddOnNotionalFactor  don't have a currency and dont need to be converted,
+        // we use the amount
+        const Real fxSpot = market_->fxRate(newCrifRecord.amountCurrency + resultCcy_)->value();
+        newCrifRecord.amountResultCcy = fxSpot * newCrifRecord.amount;
+    }
+    newCrifRecord.resultCurrency = resultCcy_;
+    return newCrifRecord;
+}
+
+bool SimmCalculator::hasSimmRecords(const Crif& crif) {
+    if (crif.hasCrifRecords())
+        return true;
+    for (const auto& sp : crif) {
+        if (sp.riskType == RiskType::AddOnFixedAmount)
+            return true;
+    }
+    return false;
+}
+
+std::vector<SimmCalculator::MarginComponent>
+SimmCalculator::marginComponents(const Crif& crif, const NettingSetDetails& nettingSetDetails,
+                                 const SimmSide& side) const {
+
+    std::vector<MarginComponent> components;
+
+    auto addComponent = [&components](const ProductClass pc, const RiskClass rc, const MarginType mt,
+                                      std::function<pair<map<string, Real>, bool>(RecordGradient*)> calc) {
+        components.push_back({pc, rc, mt, calc, {}});
+    };
+
     // Loop over portfolios and product classes
-   for(const auto  productClass : crif.ProductClassesByNettingSetDetails(nettingSetDetails)){
+    for (const auto productClass : crif.ProductClassesByNettingSetDetails(nettingSetDetails)) {
+
         if (!quiet_) {
-            LOG("SimmCalculator: Calculating SIMM for product class " << productClass);
+            LOG("SimmCalculator: Setting up SIMM margin components for product class " << productClass);
         }
 
+        // The crif, netting set details and side are owned by the caller and must outlive the components
+        auto deltaVegaMargin = [this, &crif, &nettingSetDetails, &side, productClass](const RiskType rt) {
+            return [this, &crif, &nettingSetDetails, &side, productClass, rt](RecordGradient* gradient) {
+                return margin(nettingSetDetails, productClass, rt, crif, side, gradient);
+            };
+        };
+        auto curvature = [this, &crif, &nettingSetDetails, &side, productClass](const RiskType rt,
+                                                                               const bool rfLabels) {
+            return [this, &crif, &nettingSetDetails, &side, productClass, rt, rfLabels](RecordGradient* gradient) {
+                return curvatureMargin(nettingSetDetails, productClass, rt, side, crif, rfLabels, gradient);
+            };
+        };
+
         // Delta margin components
-        RiskClass rc = RiskClass::InterestRate;
         MarginType mt = MarginType::Delta;
-        auto p = irDeltaMargin(nettingSetDetails, productClass, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::FX;
-        p = margin(nettingSetDetails, productClass, RiskType::FX, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditQ, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditNonQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditNonQ, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Equity;
-        p = margin(nettingSetDetails, productClass, RiskType::Equity, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Commodity;
-        p = margin(nettingSetDetails, productClass, RiskType::Commodity, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+        addComponent(productClass, RiskClass::InterestRate, mt,
+                     [this, &crif, &nettingSetDetails, &side, productClass](RecordGradient* gradient) {
+                         return irDeltaMargin(nettingSetDetails, productClass, crif, side, gradient);
+                     });
+        addComponent(productClass, RiskClass::FX, mt, deltaVegaMargin(RiskType::FX));
+        addComponent(productClass, RiskClass::CreditQualifying, mt, deltaVegaMargin(RiskType::CreditQ));
+        addComponent(productClass, RiskClass::CreditNonQualifying, mt, deltaVegaMargin(RiskType::CreditNonQ));
+        addComponent(productClass, RiskClass::Equity, mt, deltaVegaMargin(RiskType::Equity));
+        addComponent(productClass, RiskClass::Commodity, mt, deltaVegaMargin(RiskType::Commodity));
 
         // Vega margin components
         mt = MarginType::Vega;
-        rc = RiskClass::InterestRate;
-        p = irVegaMargin(nettingSetDetails, productClass, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::FX;
-        p = margin(nettingSetDetails, productClass, RiskType::FXVol, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditVol, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditNonQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Equity;
-        p = margin(nettingSetDetails, productClass, RiskType::EquityVol, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Commodity;
-        p = margin(nettingSetDetails, productClass, RiskType::CommodityVol, crif, side);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+        addComponent(productClass, RiskClass::InterestRate, mt,
+                     [this, &crif, &nettingSetDetails, &side, productClass](RecordGradient* gradient) {
+                         return irVegaMargin(nettingSetDetails, productClass, crif, side, gradient);
+                     });
+        addComponent(productClass, RiskClass::FX, mt, deltaVegaMargin(RiskType::FXVol));
+        addComponent(productClass, RiskClass::CreditQualifying, mt, deltaVegaMargin(RiskType::CreditVol));
+        addComponent(productClass, RiskClass::CreditNonQualifying, mt, deltaVegaMargin(RiskType::CreditVolNonQ));
+        addComponent(productClass, RiskClass::Equity, mt, deltaVegaMargin(RiskType::EquityVol));
+        addComponent(productClass, RiskClass::Commodity, mt, deltaVegaMargin(RiskType::CommodityVol));
 
         // Curvature margin components for sides call and post
         mt = MarginType::Curvature;
-        rc = RiskClass::InterestRate;
-
-        p = irCurvatureMargin(nettingSetDetails, productClass, side, crif);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::FX;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::FXVol, side, crif, false);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditQualifying;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVol, side, crif);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::CreditNonQualifying;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, side, crif);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Equity;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::EquityVol, side, crif, false);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
-
-        rc = RiskClass::Commodity;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CommodityVol, side, crif, false);
-        if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+        addComponent(productClass, RiskClass::InterestRate, mt,
+                     [this, &crif, &nettingSetDetails, &side, productClass](RecordGradient* gradient) {
+                         return irCurvatureMargin(nettingSetDetails, productClass, side, crif, gradient);
+                     });
+        addComponent(productClass, RiskClass::FX, mt, curvature(RiskType::FXVol, false));
+        addComponent(productClass, RiskClass::CreditQualifying, mt, curvature(RiskType::CreditVol, true));
+        addComponent(productClass, RiskClass::CreditNonQualifying, mt, curvature(RiskType::CreditVolNonQ, true));
+        addComponent(productClass, RiskClass::Equity, mt, curvature(RiskType::EquityVol, false));
+        addComponent(productClass, RiskClass::Commodity, mt, curvature(RiskType::CommodityVol, false));
 
         // Base correlation margin components. This risk type came later so need to check
         // first if it is valid under the configuration
         if (simmConfiguration_->isValidRiskType(RiskType::BaseCorr)) {
-            p = margin(nettingSetDetails, productClass, RiskType::BaseCorr, crif, side);
-            if (p.second)
-                add(nettingSetDetails, regulation, productClass, RiskClass::CreditQualifying, MarginType::BaseCorr,
-                    p.first, side);
+            addComponent(productClass, RiskClass::CreditQualifying, MarginType::BaseCorr,
+                         deltaVegaMargin(RiskType::BaseCorr));
         }
     }
 
+    return components;
+}
+
+void SimmCalculator::aggregateRegulationSimm(SimmResults& results, std::vector<CrifRecord>& simmParameters,
+                                             const Crif& crif, const NettingSetDetails& nettingSetDetails,
+                                             const string& regulation, const SimmSide& side,
+                                             const std::vector<MarginComponent>& components) const {
+
+    for (const auto& c : components) {
+        if (c.result.second)
+            add(results, nettingSetDetails, regulation, c.pc, c.rc, c.mt, c.result.first, side);
+    }
+
     // Calculate the higher level margins
-    populateResults(side, nettingSetDetails, regulation);
+    populateResults(results, side, nettingSetDetails, regulation);
 
     // For each portfolio, calculate the additional margin
-    calcAddMargin(side, nettingSetDetails, regulation, crif);
+    calcAddMargin(results, simmParameters, side, nettingSetDetails, regulation, crif);
 }
 
 const string& SimmCalculator::winningRegulations(const SimmSide& side, const NettingSetDetails& nettingSetDetails) const {
@@ -443,8 +803,7 @@ const map<SimmSide, map<NettingSetDetails, pair<string, SimmResults>>>& SimmCalc
 
 pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDetails& nettingSetDetails,
                                                             const ProductClass& pc, const Crif& crif,
-                                                            const SimmSide& side) const {
-    const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
+                                                            const SimmSide& side, RecordGradient* gradient) const {
 
     // "Bucket" here referse to exposures under the CRIF qualifiers
     map<string, Real> bucketMargins;
@@ -466,6 +825,9 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
     // The sum of the weighted sensitivities for each currency i.e. $\sum_{i,k} WS_{k,i}$ from SIMM docs
     map<string, Real> sumWeightedSensis;
 
+    // For the gradient, the records of each currency
+    map<string, CurrencyAdjoint> adjoints;
+
     // Loop over the qualifiers i.e. currencies
     // Loop over the qualifiers i.e. currencies
     for (const auto& qualifier : qualifiers) {
@@ -502,76 +864,106 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
         if (resultCcy_ != "USD")
             concThreshold *= market_->fxRate("USD" + resultCcy_)->value();
         concentrationRisk[qualifier] /= concThreshold;
+        if (gradient) {
+            adjoints[qualifier].concentration = concentrationRisk[qualifier];
+            adjoints[qualifier].threshold = concThreshold;
+        }
         // Final concentration risk amount
         concentrationRisk[qualifier] = max(1.0, sqrt(std::abs(concentrationRisk[qualifier])));
 
+        // Weighted sensitivities i.e. $WS_{k,i}$ from SIMM docs, using the risk weights $RW_k$. The Label1 and Label2
+        // values are interned, so that each correlation is looked up once per pair of labels.
+        const Size n = pIrQualifier.size();
+        std::vector<Real> ws(n), rws(n), dK2(gradient ? n : 0);
+        std::vector<Size> label1Id(n), label2Id(n);
+        LabelIds labels1, labels2;
+        for (Size i = 0; i < n; ++i) {
+            const auto& cr = pIrQualifier[i];
+            rws[i] = simmConfiguration_->weight(RiskType::IRCurve, qualifier, cr.label1);
+            ws[i] = rws[i] * cr.amountResultCcy * concentrationRisk[qualifier];
+            label1Id[i] = labels1.id(cr.label1);
+            label2Id[i] = labels2.id(cr.label2);
+        }
+        CorrelationTable subCurveCorrs(labels2.size()), tenorCorrs(labels1.size());
+
         // Calculate the delta margin piece for this qualifier i.e. $K_b$ from SIMM docs
-        for (auto itOuter = pIrQualifier.begin(); itOuter != pIrQualifier.end(); ++itOuter) {
-            // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(RiskType::IRCurve, qualifier, itOuter->label1);
-            // Weighted sensitivity i.e. $WS_{k,i}$ from SIMM docs
-            Real wsOuter = rwOuter * itOuter->amountResultCcy * concentrationRisk[qualifier];
+        for (Size i = 0; i < n; ++i) {
             // Update weighted sensitivity sum
-            sumWeightedSensis[qualifier] += wsOuter;
+            sumWeightedSensis[qualifier] += ws[i];
             // Add diagonal element to delta margin
-            deltaMargin[qualifier] += wsOuter * wsOuter;
+            deltaMargin[qualifier] += ws[i] * ws[i];
+            if (gradient)
+                dK2[i] += 2.0 * ws[i];
             // Add the cross elements to the delta margin
-            for (auto itInner = pIrQualifier.begin(); itInner != itOuter; ++itInner) {
+            for (Size j = 0; j < i; ++j) {
                 // Label2 level correlation i.e. $\phi_{i,j}$ from SIMM docs
-                Real subCurveCorr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", itOuter->label2,
-                                                                    RiskType::IRCurve, qualifier, "", itInner->label2);
+                Real subCurveCorr = subCurveCorrs(label2Id[i], label2Id[j], [&]() {
+                    return simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", pIrQualifier[i].label2,
+                                                           RiskType::IRCurve, qualifier, "", pIrQualifier[j].label2);
+                });
                 // Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real tenorCorr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, itOuter->label1, "",
-                                                                 RiskType::IRCurve, qualifier, itInner->label1, "");
+                Real tenorCorr = tenorCorrs(label1Id[i], label1Id[j], [&]() {
+                    return simmConfiguration_->correlation(RiskType::IRCurve, qualifier, pIrQualifier[i].label1, "",
+                                                           RiskType::IRCurve, qualifier, pIrQualifier[j].label1, "");
+                });
                 // Add cross element to delta margin
-                Real rwInner = simmConfiguration_->weight(RiskType::IRCurve, qualifier, itInner->label1);
-                Real wsInner = rwInner * itInner->amountResultCcy * concentrationRisk[qualifier];
-                deltaMargin[qualifier] += 2 * subCurveCorr * tenorCorr * wsOuter * wsInner;
+                deltaMargin[qualifier] += 2 * subCurveCorr * tenorCorr * ws[i] * ws[j];
+                if (gradient) {
+                    dK2[i] += 2.0 * subCurveCorr * tenorCorr * ws[j];
+                    dK2[j] += 2.0 * subCurveCorr * tenorCorr * ws[i];
+                }
             }
         }
 
         // Add the Inflation component, if any
-        Real wsInflation = 0.0;
+        Real wsInflation = 0.0, rwInflation = 0.0, dK2Inflation = 0.0;
         if (itInflation != crif.end()) {
             // Risk weight
-            Real rwInflation = simmConfiguration_->weight(RiskType::Inflation, qualifier, itInflation->label1);
+            rwInflation = simmConfiguration_->weight(RiskType::Inflation, qualifier, itInflation->label1);
             // Weighted sensitivity
             wsInflation = rwInflation * itInflation->amountResultCcy * concentrationRisk[qualifier];
             // Update weighted sensitivity sum
             sumWeightedSensis[qualifier] += wsInflation;
             // Add diagonal element to delta margin
             deltaMargin[qualifier] += wsInflation * wsInflation;
+            dK2Inflation += 2.0 * wsInflation;
             // Add the cross elements (Inflation with IRCurve tenors) to the delta margin
             // Correlation (know that Label1 and Label2 do not matter)
             Real corr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", "", RiskType::Inflation,
                                                         qualifier, "", "");
-            for (auto it = pIrQualifier.begin(); it != pIrQualifier.end(); ++it) {
+            for (Size i = 0; i < n; ++i) {
                 // Add cross element to delta margin
-                Real rw = simmConfiguration_->weight(RiskType::IRCurve, qualifier, it->label1);
-                Real ws = rw * it->amountResultCcy * concentrationRisk[qualifier];
-                deltaMargin[qualifier] += 2 * corr * ws * wsInflation;
+                deltaMargin[qualifier] += 2 * corr * ws[i] * wsInflation;
+                if (gradient) {
+                    dK2[i] += 2.0 * corr * wsInflation;
+                    dK2Inflation += 2.0 * corr * ws[i];
+                }
             }
         }
 
         // Add the XccyBasis component, if any
+        Real rwXccy = 0.0, dK2Xccy = 0.0;
         if (itXccy != crif.end()) {
             // Risk weight
-            Real rwXccy = simmConfiguration_->weight(RiskType::XCcyBasis, qualifier, itXccy->label1);
+            rwXccy = simmConfiguration_->weight(RiskType::XCcyBasis, qualifier, itXccy->label1);
             // Weighted sensitivity (no concentration risk here)
             Real wsXccy = rwXccy * itXccy->amountResultCcy;
             // Update weighted sensitivity sum
             sumWeightedSensis[qualifier] += wsXccy;
             // Add diagonal element to delta margin
             deltaMargin[qualifier] += wsXccy * wsXccy;
+            dK2Xccy += 2.0 * wsXccy;
             // Add the cross elements (XccyBasis with IRCurve tenors) to the delta margin
             // Correlation (know that Label1 and Label2 do not matter)
             Real corr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", "", RiskType::XCcyBasis,
                                                         qualifier, "", "");
-            for (auto it = pIrQualifier.begin(); it != pIrQualifier.end(); ++it) {
+            for (Size i = 0; i < n; ++i) {
                 // Add cross element to delta margin
-                Real rw = simmConfiguration_->weight(RiskType::IRCurve, qualifier, it->label1, calcCcy);
-                Real ws = rw * it->amountResultCcy * concentrationRisk[qualifier];
-                deltaMargin[qualifier] += 2 * corr * ws * wsXccy;
+                deltaMargin[qualifier] += 2 * corr * ws[i] * wsXccy;
+                if (gradient) {
+                    dK2[i] += 2.0 * corr * wsXccy;
+                    dK2Xccy += 2.0 * corr * ws[i];
+                }
             }
 
             // Inflation vs. XccyBasis cross component if any
@@ -580,15 +972,39 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
                 Real corr = simmConfiguration_->correlation(RiskType::Inflation, qualifier, "", "", RiskType::XCcyBasis,
                                                             qualifier, "", "");
                 deltaMargin[qualifier] += 2 * corr * wsInflation * wsXccy;
+                dK2Inflation += 2.0 * corr * wsXccy;
+                dK2Xccy += 2.0 * corr * wsInflation;
             }
         }
 
         // Finally have the value of $K_b$
         deltaMargin[qualifier] = sqrt(max(deltaMargin[qualifier], 0.0));
+
+        if (gradient) {
+            auto& adj = adjoints[qualifier];
+            adj.records = std::move(pIrQualifier);
+            adj.rw = std::move(rws);
+            adj.dK2 = std::move(dK2);
+            adj.hasCr.assign(n, true);
+            if (itInflation != crif.end()) {
+                adj.records.push_back(*itInflation);
+                adj.rw.push_back(rwInflation);
+                adj.dK2.push_back(dK2Inflation);
+                adj.hasCr.push_back(true);
+            }
+            if (itXccy != crif.end()) {
+                adj.records.push_back(*itXccy);
+                adj.rw.push_back(rwXccy);
+                adj.dK2.push_back(dK2Xccy);
+                adj.hasCr.push_back(false);
+            }
+        }
     }
 
-    // Now calculate final IR delta margin by aggregating across currencies
+    // Now calculate final IR delta margin by aggregating across currencies, for the gradient with the derivatives of
+    // the sum w.r.t. the $S_b$ and the concentration risks
     Real margin = 0.0;
+    map<string, Real> dMarginS, dMarginCr;
     for (auto itOuter = qualifiers.begin(); itOuter != qualifiers.end(); ++itOuter) {
         // Diagonal term
         margin += deltaMargin.at(*itOuter) * deltaMargin.at(*itOuter);
@@ -601,10 +1017,20 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
             Real corr = simmConfiguration_->correlation(RiskType::IRCurve, *itOuter, "", "", RiskType::IRCurve,
                                                         *itInner, "", "");
             margin += 2.0 * sOuter * sInner * corr * g;
+            if (gradient) {
+                dMarginS[*itOuter] += 2.0 * sInner * corr * g;
+                dMarginS[*itInner] += 2.0 * sOuter * corr * g;
+                ratioAdjoint(concentrationRisk.at(*itOuter), concentrationRisk.at(*itInner),
+                             2.0 * sOuter * sInner * corr, dMarginCr[*itOuter], dMarginCr[*itInner]);
+            }
         }
     }
     margin = sqrt(max(margin, 0.0));
 
+    if (gradient)
+        addCurrencyMarginGradient(*gradient, margin, adjoints, deltaMargin, sumWeightedSensis, concentrationRisk,
+                                  dMarginS, dMarginCr);
+
     for (const auto& m : deltaMargin)
         bucketMargins[m.first] = m.second;
     bucketMargins["All"] = margin;
@@ -614,7 +1040,7 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
 
 pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetails& nettingSetDetails,
                                                            const CrifRecord::ProductClass& pc, const Crif& crif,
-                                                           const SimmSide& side) const {
+                                                           const SimmSide& side, RecordGradient* gradient) const {
 
     const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
 
@@ -636,6 +1062,8 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
     map<string, Real> vegaMargin;
     // The sum of the weighted sensitivities for each currency i.e. $\sum_{k=1}^K VR_{k}$ from SIMM docs
     map<string, Real> sumWeightedSensis;
+    // For the gradient, the records of each currency
+    map<string, CurrencyAdjoint> adjoints;
 
     // Loop over the qualifiers i.e. currencies
     for (const auto& qualifier : qualifiers) {
@@ -657,74 +1085,109 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
         if (resultCcy_ != "USD")
             concThreshold *= market_->fxRate("USD" + resultCcy_)->value();
         concentrationRisk[qualifier] /= concThreshold;
+        if (gradient) {
+            adjoints[qualifier].concentration = concentrationRisk[qualifier];
+            adjoints[qualifier].threshold = concThreshold;
+        }
 
         // Final concentration risk amount
         concentrationRisk[qualifier] = max(1.0, sqrt(std::abs(concentrationRisk[qualifier])));
 
+        // Weighted sensitivities i.e. $WS_{k,i}$ from SIMM docs, using the risk weights $RW_k$
+        std::vector<Real> wsIr, wsInf, rws;
+        wsIr.reserve(pIrQualifier.size());
+        wsInf.reserve(pInfQualifier.size());
+        rws.reserve(pIrQualifier.size() + pInfQualifier.size());
+        for (const auto& cr : pIrQualifier) {
+            rws.push_back(simmConfiguration_->weight(RiskType::IRVol, qualifier, cr.label1));
+            wsIr.push_back(rws.back() * cr.amountResultCcy * concentrationRisk[qualifier]);
+        }
+        for (const auto& cr : pInfQualifier) {
+            rws.push_back(simmConfiguration_->weight(RiskType::InflationVol, qualifier, cr.label1));
+            wsInf.push_back(rws.back() * cr.amountResultCcy * concentrationRisk[qualifier]);
+        }
+        // Derivatives of $K_b^2$ w.r.t. the IRVol and then the InflationVol weighted sensitivities
+        const Size nIr = pIrQualifier.size();
+        std::vector<Real> dK2(gradient ? rws.size() : 0);
+
         // Calculate the margin piece for this qualifier i.e. $K_b$ from SIMM docs
         // Start with IRVol vs. IRVol components
-        for (auto itOuter = pIrQualifier.begin(); itOuter != pIrQualifier.end(); ++itOuter) {
-            // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(RiskType::IRVol, qualifier, itOuter->label1);
-            // Weighted sensitivity i.e. $WS_{k,i}$ from SIMM docs
-            Real wsOuter = rwOuter * itOuter->amountResultCcy * concentrationRisk[qualifier];
+        for (Size i = 0; i < pIrQualifier.size(); ++i) {
             // Update weighted sensitivity sum
-            sumWeightedSensis[qualifier] += wsOuter;
+            sumWeightedSensis[qualifier] += wsIr[i];
             // Add diagonal element to vega margin
-            vegaMargin[qualifier] += wsOuter * wsOuter;
+            vegaMargin[qualifier] += wsIr[i] * wsIr[i];
+            if (gradient)
+                dK2[i] += 2.0 * wsIr[i];
             // Add the cross elements to the vega margin
-            for (auto itInner = pIrQualifier.begin(); itInner != itOuter; ++itInner) {
+            for (Size j = 0; j < i; ++j) {
                 // Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real corr = simmConfiguration_->correlation(RiskType::IRVol, qualifier, itOuter->label1, "",
-                                                            RiskType::IRVol, qualifier, itInner->label1, "");
+                Real corr = simmConfiguration_->correlation(RiskType::IRVol, qualifier, pIrQualifier[i].label1, "",
+                                                            RiskType::IRVol, qualifier, pIrQualifier[j].label1, "");
                 // Add cross element to vega margin
-                Real rwInner = simmConfiguration_->weight(RiskType::IRVol, qualifier, itInner->label1);
-                Real wsInner = rwInner * itInner->amountResultCcy * concentrationRisk[qualifier];
-                vegaMargin[qualifier] += 2 * corr * wsOuter * wsInner;
+                vegaMargin[qualifier] += 2 * corr * wsIr[i] * wsIr[j];
+                if (gradient) {
+                    dK2[i] += 2.0 * corr * wsIr[j];
+                    dK2[j] += 2.0 * corr * wsIr[i];
+                }
             }
         }
 
         // Now deal with inflation component
         // To be generic/future-proof, assume that we don't know correlation structure. The way SIMM is
         // currently, we could just sum over the InflationVol numbers within qualifier and use this.
-        for (auto itOuter = pInfQualifier.begin(); itOuter != pInfQualifier.end(); ++itOuter) {
-            // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(RiskType::InflationVol, qualifier, itOuter->label1);
-            // Weighted sensitivity i.e. $WS_{k,i}$ from SIMM docs
-            Real wsOuter = rwOuter * itOuter->amountResultCcy * concentrationRisk[qualifier];
+        for (Size i = 0; i < pInfQualifier.size(); ++i) {
             // Update weighted sensitivity sum
-            sumWeightedSensis[qualifier] += wsOuter;
+            sumWeightedSensis[qualifier] += wsInf[i];
             // Add diagonal element to vega margin
-            vegaMargin[qualifier] += wsOuter * wsOuter;
+            vegaMargin[qualifier] += wsInf[i] * wsInf[i];
+            if (gradient)
+                dK2[nIr + i] += 2.0 * wsInf[i];
             // Add the cross elements to the vega margin
             // Firstly, against all IRVol components
-            for (auto itInner = pIrQualifier.begin(); itInner != pIrQualifier.end(); ++itInner) {
+            for (Size j = 0; j < pIrQualifier.size(); ++j) {
                 // Correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real corr = simmConfiguration_->correlation(RiskType::InflationVol, qualifier, itOuter->label1, "",
-                                                            RiskType::IRVol, qualifier, itInner->label1, "");
+                Real corr = simmConfiguration_->correlation(RiskType::InflationVol, qualifier, pInfQualifier[i].label1,
+                                                            "", RiskType::IRVol, qualifier, pIrQualifier[j].label1, "");
                 // Add cross element to vega margin
-                Real rwInner = simmConfiguration_->weight(RiskType::IRVol, qualifier, itInner->label1);
-                Real wsInner = rwInner * itInner->amountResultCcy * concentrationRisk[qualifier];
-                vegaMargin[qualifier] += 2 * corr * wsOuter * wsInner;
+                vegaMargin[qualifier] += 2 * corr * wsInf[i] * wsIr[j];
+                if (gradient) {
+                    dK2[nIr + i] += 2.0 * corr * wsIr[j];
+                    dK2[j] += 2.0 * corr * wsInf[i];
+                }
             }
             // Secondly, against all previous InflationVol components
-            for (auto itInner = pInfQualifier.begin(); itInner != itOuter; ++itInner) {
+            for (Size j = 0; j < i; ++j) {
                 // Correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real corr = simmConfiguration_->correlation(RiskType::InflationVol, qualifier, itOuter->label1, "",
-                                                            RiskType::InflationVol, qualifier, itInner->label1, "");
+                Real corr =
+                    simmConfiguration_->correlation(RiskType::InflationVol, qualifier, pInfQualifier[i].label1, "",
+                                                    RiskType::InflationVol, qualifier, pInfQualifier[j].label1, "");
                 // Add cross element to vega margin
-                Real rwInner = simmConfiguration_->weight(RiskType::InflationVol, qualifier, itInner->label1);
-                Real wsInner = rwInner * itInner->amountResultCcy * concentrationRisk[qualifier];
-                vegaMargin[qualifier] += 2 * corr * wsOuter * wsInner;
+                vegaMargin[qualifier] += 2 * corr * wsInf[i] * wsInf[j];
+                if (gradient) {
+                    dK2[nIr + i] += 2.0 * corr * wsInf[j];
+                    dK2[nIr + j] += 2.0 * corr * wsInf[i];
+                }
             }
         }
 
         // Finally have the value of $K_b$
         vegaMargin[qualifier] = sqrt(max(vegaMargin[qualifier], 0.0));
+
+        if (gradient) {
+            auto& adj = adjoints[qualifier];
+            adj.records = std::move(pIrQualifier);
+            adj.records.insert(adj.records.end(), pInfQualifier.begin(), pInfQualifier.end());
+            adj.rw = std::move(rws);
+            adj.dK2 = std::move(dK2);
+            adj.hasCr.assign(adj.records.size(), true);
+        }
     }
 
-    // Now calculate final vega margin by aggregating across currencies
+    // Now calculate final vega margin by aggregating across currencies, for the gradient with the derivatives of the
+    // sum w.r.t. the $S_b$ and the concentration risks
     Real margin = 0.0;
+    map<string, Real> dMarginS, dMarginCr;
     for (auto itOuter = qualifiers.begin(); itOuter != qualifiers.end(); ++itOuter) {
         // Diagonal term
         margin += vegaMargin.at(*itOuter) * vegaMargin.at(*itOuter);
@@ -737,10 +1200,20 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
             Real corr = simmConfiguration_->correlation(RiskType::IRVol, *itOuter, "", "", RiskType::IRVol, *itInner,
                                                         "", "", calcCcy);
             margin += 2.0 * sOuter * sInner * corr * g;
+            if (gradient) {
+                dMarginS[*itOuter] += 2.0 * sInner * corr * g;
+                dMarginS[*itInner] += 2.0 * sOuter * corr * g;
+                ratioAdjoint(concentrationRisk.at(*itOuter), concentrationRisk.at(*itInner),
+                             2.0 * sOuter * sInner * corr, dMarginCr[*itOuter], dMarginCr[*itInner]);
+            }
         }
     }
     margin = sqrt(max(margin, 0.0));
 
+    if (gradient)
+        addCurrencyMarginGradient(*gradient, margin, adjoints, vegaMargin, sumWeightedSensis, concentrationRisk,
+                                  dMarginS, dMarginCr);
+
     for (const auto& m : vegaMargin)
         bucketMargins[m.first] = m.second;
     bucketMargins["All"] = margin;
@@ -750,7 +1223,8 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
 
 pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSetDetails& nettingSetDetails,
                                                                 const CrifRecord::ProductClass& pc,
-                                                                const SimmSide& side, const Crif& crif) const {
+                                                                const SimmSide& side, const Crif& crif,
+                                                                RecordGradient* gradient) const {
 
     // "Bucket" here refers to exposures under the CRIF qualifiers
     map<string, Real> bucketMargins;
@@ -776,6 +1250,16 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
     // The sum of the absolute value of weighted sensitivities across currencies and risk factors
     Real sumAbsWs = 0.0;
 
+    // For the gradient, the records of each currency with their curvature weights times the multiplier, the index of
+    // their weighted sensitivities, and the weighted sensitivities with the derivatives of $K_b^2$ w.r.t. them. The
+    // InflationVol records share the last weighted sensitivity.
+    struct CurvatureAdjoint {
+        std::vector<CrifRecord> records;
+        std::vector<Real> sf, ws, dK2;
+        std::vector<Size> wsIndex;
+    };
+    map<string, CurvatureAdjoint> adjoints;
+
     // Loop over the qualifiers i.e. currencies
     for (const auto& qualifier : qualifiers) {
         // Pair of iterators to start and end of IRVol sensitivities with current qualifier
@@ -785,37 +1269,51 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
         auto pInfQualifier =
             crif.filterByQualifier(nettingSetDetails, pc, RiskType::InflationVol, qualifier);
 
+        // Curvature sensitivities i.e. $CVR_{ik}$ from SIMM docs, using the curvature weights $SF(t_{kj})$
+        std::vector<Real> wsIr;
+        wsIr.reserve(pIrQualifier.size());
+        for (const auto& cr : pIrQualifier) {
+            Real sf = simmConfiguration_->curvatureWeight(RiskType::IRVol, cr.label1);
+            wsIr.push_back(sf * (cr.amountResultCcy * multiplier));
+        }
+
+        // Derivatives of $K_b^2$ w.r.t. the IRVol and then the InflationVol weighted sensitivities
+        const Size nIr = pIrQualifier.size();
+        std::vector<Real> dK2(gradient ? nIr + 1 : 0);
+
         // Calculate the margin piece for this qualifier i.e. $K_b$ from SIMM docs
         // Start with IRVol vs. IRVol components
-        for (auto itOuter = pIrQualifier.begin(); itOuter != pIrQualifier.end(); ++itOuter) {
-            // Curvature weight i.e. $SF(t_{kj})$ from SIMM docs
-            Real sfOuter = simmConfiguration_->curvatureWeight(RiskType::IRVol, itOuter->label1);
-            // Curvature sensitivity i.e. $CVR_{ik}$ from SIMM docs
-            Real wsOuter = sfOuter * (itOuter->amountResultCcy * multiplier);
+        for (Size i = 0; i < pIrQualifier.size(); ++i) {
             // Update weighted sensitivity sums
-            sumWeightedSensis[qualifier] += wsOuter;
-            sumWs += wsOuter;
-            sumAbsWs += std::abs(wsOuter);
+            sumWeightedSensis[qualifier] += wsIr[i];
+            sumWs += wsIr[i];
+            sumAbsWs += std::abs(wsIr[i]);
             // Add diagonal element to curvature margin
-            curvatureMargin[qualifier] += wsOuter * wsOuter;
+            curvatureMargin[qualifier] += wsIr[i] * wsIr[i];
+            if (gradient)
+                dK2[i] += 2.0 * wsIr[i];
             // Add the cross elements to the curvature margin
-            for (auto itInner = pIrQualifier.begin(); itInner != itOuter; ++itInner) {
+            for (Size j = 0; j < i; ++j) {
                 // Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real corr = simmConfiguration_->correlation(RiskType::IRVol, qualifier, itOuter->label1, "",
-                                                            RiskType::IRVol, qualifier, itInner->label1, "");
+                Real corr = simmConfiguration_->correlation(RiskType::IRVol, qualifier, pIrQualifier[i].label1, "",
+                                                            RiskType::IRVol, qualifier, pIrQualifier[j].label1, "");
                 // Add cross element to curvature margin
-                Real sfInner = simmConfiguration_->curvatureWeight(RiskType::IRVol, itInner->label1);
-                Real wsInner = sfInner * (itInner->amountResultCcy * multiplier);
-                curvatureMargin[qualifier] += 2 * corr * corr * wsOuter * wsInner;
+                curvatureMargin[qualifier] += 2 * corr * corr * wsIr[i] * wsIr[j];
+                if (gradient) {
+                    dK2[i] += 2.0 * corr * corr * wsIr[j];
+                    dK2[j] += 2.0 * corr * corr * wsIr[i];
+                }
             }
         }
 
         // Now deal with inflation component
         const string simmVersion = simmConfiguration_->version();
         SimmVersion thresholdVersion = SimmVersion::V1_0;
-        if (simmConfiguration_->isSimmConfigCalibration() || parseSimmVersion(simmVersion) > thresholdVersion) {
+        Real infWs = 0.0;
+        const bool hasInflation =
+            simmConfiguration_->isSimmConfigCalibration() || parseSimmVersion(simmVersion) > thresholdVersion;
+        if (hasInflation) {
             // Weighted sensitivity i.e. $WS_{k,i}$ from SIMM docs
-            Real infWs = 0.0;
             for (auto infIt = pInfQualifier.begin(); infIt != pInfQualifier.end(); ++infIt) {
                 // Curvature weight i.e. $SF(t_{kj})$ from SIMM docs
                 Real infSf = simmConfiguration_->curvatureWeight(RiskType::InflationVol, infIt->label1);
@@ -828,22 +1326,47 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
 
             // Add diagonal element to curvature margin - there is only one element for inflationVol
             curvatureMargin[qualifier] += infWs * infWs;
+            if (gradient)
+                dK2[nIr] += 2.0 * infWs;
 
             // Add the cross elements to the curvature margin against IRVol components.
             // There are no cross elements against InflationVol since we only have one element.
-            for (auto irIt = pIrQualifier.begin(); irIt != pIrQualifier.end(); ++irIt) {
+            for (Size j = 0; j < pIrQualifier.size(); ++j) {
                 // Correlation i.e. $\rho_{k,l}$ from SIMM docs
                 Real corr = simmConfiguration_->correlation(RiskType::InflationVol, qualifier, "", "", RiskType::IRVol,
-                                                            qualifier, irIt->label1, "");
+                                                            qualifier, pIrQualifier[j].label1, "");
                 // Add cross element to curvature margin
-                Real irSf = simmConfiguration_->curvatureWeight(RiskType::IRVol, irIt->label1);
-                Real irWs = irSf * (irIt->amountResultCcy * multiplier);
-                curvatureMargin[qualifier] += 2 * corr * corr * infWs * irWs;
+                curvatureMargin[qualifier] += 2 * corr * corr * infWs * wsIr[j];
+                if (gradient) {
+                    dK2[nIr] += 2.0 * corr * corr * wsIr[j];
+                    dK2[j] += 2.0 * corr * corr * infWs;
+                }
             }
         }
 
         // Finally have the value of $K_b$
         curvatureMargin[qualifier] = sqrt(max(curvatureMargin[qualifier], 0.0));
+
+        if (gradient) {
+            auto& adj = adjoints[qualifier];
+            for (Size i = 0; i < nIr; ++i) {
+                adj.sf.push_back(simmConfiguration_->curvatureWeight(RiskType::IRVol, pIrQualifier[i].label1) *
+                                 multiplier);
+                adj.wsIndex.push_back(i);
+            }
+            adj.records = std::move(pIrQualifier);
+            if (hasInflation) {
+                for (const auto& cr : pInfQualifier) {
+                    adj.records.push_back(cr);
+                    adj.sf.push_back(simmConfiguration_->curvatureWeight(RiskType::InflationVol, cr.label1) *
+                                     multiplier);
+                    adj.wsIndex.push_back(nIr);
+                }
+            }
+            adj.ws = std::move(wsIr);
+            adj.ws.push_back(infWs);
+            adj.dK2 = std::move(dK2);
+        }
     }
 
     // If sum of absolute value of all individual curvature risks is zero, we can return 0.0
@@ -852,10 +1375,12 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
         return make_pair(bucketMargins, true);
     }
 
-    // Now calculate final curvature margin by aggregating across currencies
+    // Now calculate final curvature margin by aggregating across currencies, for the gradient with the derivatives of
+    // the sum w.r.t. the $S_b$
     Real theta = min(sumWs / sumAbsWs, 0.0);
 
     Real margin = 0.0;
+    map<string, Real> dMarginS;
     for (auto itOuter = qualifiers.begin(); itOuter != qualifiers.end(); ++itOuter) {
         // Diagonal term
         margin += curvatureMargin.at(*itOuter) * curvatureMargin.at(*itOuter);
@@ -868,9 +1393,14 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
             Real corr =
                 simmConfiguration_->correlation(RiskType::IRVol, *itOuter, "", "", RiskType::IRVol, *itInner, "", "");
             margin += 2.0 * sOuter * sInner * corr * corr;
+            if (gradient) {
+                dMarginS[*itOuter] += 2.0 * sInner * corr * corr;
+                dMarginS[*itInner] += 2.0 * sOuter * corr * corr;
+            }
         }
     }
-    margin = sumWs + lambda(theta) * sqrt(max(margin, 0.0));
+    Real root = sqrt(max(margin, 0.0));
+    margin = sumWs + lambda(theta) * root;
 
     for (const auto& m : curvatureMargin)
         bucketMargins[m.first] = m.second;
@@ -880,11 +1410,34 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
     // TODO: Review, should we return the pre-scaled value instead?
     bucketMargins["All"] = totalCurvatureMargin;
 
+    // Reverse pass through the floor and scaling, $\lambda(\theta)$, the aggregation and the currency margins
+    if (gradient && !(margin < 0.0)) {
+        Real aSumWs = scaling, aRoot = scaling * lambda(theta), aSumAbsWs = 0.0;
+        if (!(0.0 < sumWs / sumAbsWs)) {
+            Real aRatio = scaling * root * lambdaDerivative();
+            aSumWs += aRatio / sumAbsWs;
+            aSumAbsWs -= aRatio * sumWs / (sumAbsWs * sumAbsWs);
+        }
+        Real aMargin = aRoot * rootDerivative(root);
+        for (const auto& [qualifier, adj] : adjoints) {
+            Real k = curvatureMargin.at(qualifier);
+            Real aK = aMargin * 2.0 * k, aSum = aSumWs;
+            cappedSumAdjoint(sumWeightedSensis.at(qualifier), k, aMargin * dMarginS[qualifier], aSum, aK);
+            Real aK2 = aK * rootDerivative(k);
+            for (Size i = 0; i < adj.records.size(); ++i) {
+                Size w = adj.wsIndex[i];
+                Real aWs = aK2 * adj.dK2[w] + aSum + aSumAbsWs * absDerivative(adj.ws[w]);
+                (*gradient)[adj.records[i]] += aWs * adj.sf[i];
+            }
+        }
+    }
+
     return make_pair(bucketMargins, true);
 }
 
 pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& nettingSetDetails, const ProductClass& pc,
-                                                     const RiskType& rt, const Crif& crif, const SimmSide& side) const {
+                                                     const RiskType& rt, const Crif& crif, const SimmSide& side,
+                                                     RecordGradient* gradient) const {
 
     const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
     
@@ -922,6 +1475,17 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
     // The historical volatility ratio for the risk type - will be 1.0 if not applicable
     Real hvr = simmConfiguration_->historicalVolatilityRatio(rt);
 
+    // For the gradient, the records of each bucket with the factors of their weighted sensitivities other than the
+    // amount and the concentration risk, their concentration risks, the weights of their amounts in the concentration
+    // risks, and the derivatives of $K_b^2$ w.r.t. their weighted sensitivities. For each qualifier, the concentration
+    // risk before the floor with its threshold and the derivative of $K_b^2$ through the $f_{k,l}$.
+    struct BucketAdjoint {
+        std::vector<const CrifRecord*> records;
+        std::vector<Real> rw, cr, concentrationWeight, dK2;
+        map<string, Real> concentration, threshold, dK2dCr;
+    };
+    map<string, BucketAdjoint> adjoints;
+
     // Loop over the buckets
     for (const auto& kv : buckets) {
         string bucket = kv.first;
@@ -931,6 +1495,7 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
 
         // Get the concentration risk for each qualifier in current bucket i.e. $CR_k$ from SIMM docs
         map<string, Real> concentrationRisk;
+        BucketAdjoint* adj = gradient ? &adjoints[bucket] : nullptr;
 
         for (const auto& qualifier : kv.second) {
 
@@ -945,7 +1510,7 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
             }
 
             // Pair of iterators to start and end of sensitivities with current qualifier
-            auto pQualifier = crifByQualifierAndBucket[std::make_pair(qualifier,bucket)];
+            const auto& pQualifier = crifByQualifierAndBucket[std::make_pair(qualifier,bucket)];
 
             // One pass to get the concentration risk for this qualifier
             for (auto it = pQualifier.begin(); it != pQualifier.end(); ++it) {
@@ -958,69 +1523,86 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
             if (resultCcy_ != "USD")
                 concThreshold *= market_->fxRate("USD" + resultCcy_)->value();
             concentrationRisk[qualifier] /= concThreshold;
+            if (adj) {
+                adj->concentration[qualifier] = concentrationRisk[qualifier];
+                adj->threshold[qualifier] = concThreshold;
+            }
             // Final concentration risk amount
             concentrationRisk[qualifier] = max(1.0, sqrt(std::abs(concentrationRisk[qualifier])));
         }
 
 
-        // Calculate the margin component for the current bucket
-        // Pair of iterators to start and end of sensitivities within current bucket
-        auto pBucket = crifByBucket[bucket];
-        for (auto itOuter = pBucket.begin(); itOuter != pBucket.end(); ++itOuter) {
+        // Weighted sensitivities i.e. $WS_{k}$ from SIMM docs and concentration risks of the sensitivities within the
+        // current bucket, computed once per sensitivity
+        const auto& pBucket = crifByBucket[bucket];
+        std::vector<const CrifRecord*> records;
+        std::vector<Real> ws, cr;
+        records.reserve(pBucket.size());
+        ws.reserve(pBucket.size());
+        cr.reserve(pBucket.size());
+        for (const auto& it : pBucket) {
             // Do not include Risk_FX components in the calculation currency in the SIMM calculation
-            if (rt == RiskType::FX && itOuter->qualifier == calcCcy) {
+            if (rt == RiskType::FX && it.qualifier == calcCcy) {
                 if (!quiet_) {
-                    DLOG("Skipping qualifier " << itOuter->qualifier << " of risk type " << rt
+                    DLOG("Skipping qualifier " << it.qualifier << " of risk type " << rt
                                                << " since the qualifier equals the SIMM calculation currency "
                                                << calcCcy);
                 }
                 continue;
             }
             // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(rt, itOuter->qualifier, itOuter->label1, calcCcy);
+            Real rw = simmConfiguration_->weight(rt, it.qualifier, it.label1, calcCcy);
             // Get the sigma value if applicable - returns 1.0 if not applicable
-            Real sigmaOuter = simmConfiguration_->sigma(rt, itOuter->qualifier, itOuter->label1, calcCcy);
-            // Weighted sensitivity i.e. $WS_{k}$ from SIMM docs
-            Real wsOuter =
-                rwOuter * (itOuter->amountResultCcy * sigmaOuter * hvr) * concentrationRisk[itOuter->qualifier];
-            // Get concentration risk for outer qualifier
-            Real outerConcentrationRisk = concentrationRisk.at(itOuter->qualifier);
+            Real sigma = simmConfiguration_->sigma(rt, it.qualifier, it.label1, calcCcy);
+            records.push_back(&it);
+            cr.push_back(concentrationRisk.at(it.qualifier));
+            ws.push_back(rw * (it.amountResultCcy * sigma * hvr) * cr.back());
+            if (adj) {
+                adj->rw.push_back(rw * sigma * hvr);
+                adj->concentrationWeight.push_back(sigma * hvr);
+            }
+        }
+        if (adj)
+            adj->dK2.resize(records.size());
+
+        // Calculate the margin component for the current bucket
+        for (Size i = 0; i < records.size(); ++i) {
             // Update weighted sensitivity sum
-            sumWeightedSensis[bucket] += wsOuter;
+            sumWeightedSensis[bucket] += ws[i];
             // Add diagonal element to bucket margin
-            bucketMargin[bucket] += wsOuter * wsOuter;
+            bucketMargin[bucket] += ws[i] * ws[i];
+            if (adj)
+                adj->dK2[i] += 2.0 * ws[i];
             // Add the cross elements to the bucket margin
-            for (auto itInner = pBucket.begin(); itInner != itOuter; ++itInner) {
-                // Do not include Risk_FX components in the calculation currency in the SIMM calculation
-                if (rt == RiskType::FX && itInner->qualifier == calcCcy) {
-                    if (!quiet_) {
-                        DLOG("Skipping qualifier " << itInner->qualifier << " of risk type " << rt
-                                                   << " since the qualifier equals the SIMM calculation currency "
-                                                   << calcCcy);
-                    }
-                    continue;
-                }
+            for (Size j = 0; j < i; ++j) {
                 // Correlation, $\rho_{k,l}$ in the SIMM docs
-                Real corr =
-                    simmConfiguration_->correlation(rt, itOuter->qualifier, itOuter->label1, itOuter->label2, rt,
-                                                    itInner->qualifier, itInner->label1, itInner->label2, calcCcy);
+                Real corr = simmConfiguration_->correlation(rt, records[i]->qualifier, records[i]->label1,
+                                                            records[i]->label2, rt, records[j]->qualifier,
+                                                            records[j]->label1, records[j]->label2, calcCcy);
                 // $f_{k,l}$ from the SIMM docs
-                Real f = min(outerConcentrationRisk, concentrationRisk.at(itInner->qualifier)) /
-                         max(outerConcentrationRisk, concentrationRisk.at(itInner->qualifier));
+                Real f = min(cr[i], cr[j]) / max(cr[i], cr[j]);
                 // Add cross element to delta margin
-                Real sigmaInner = simmConfiguration_->sigma(rt, itInner->qualifier, itInner->label1, calcCcy);
-                Real rwInner = simmConfiguration_->weight(rt, itInner->qualifier, itInner->label1, calcCcy);
-                Real wsInner =
-                    rwInner * (itInner->amountResultCcy * sigmaInner * hvr) * concentrationRisk[itInner->qualifier];
-                bucketMargin[bucket] += 2 * corr * f * wsOuter * wsInner;
+                bucketMargin[bucket] += 2 * corr * f * ws[i] * ws[j];
+                if (adj) {
+                    adj->dK2[i] += 2.0 * corr * f * ws[j];
+                    adj->dK2[j] += 2.0 * corr * f * ws[i];
+                    ratioAdjoint(cr[i], cr[j], 2.0 * corr * ws[i] * ws[j], adj->dK2dCr[records[i]->qualifier],
+                                 adj->dK2dCr[records[j]->qualifier]);
+                }
             }
-            // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not used for Risk_FX
+            // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not
+            // used for Risk_FX
             if (riskClassIsFX)
-                bucketMargins[itOuter->qualifier] += wsOuter;
+                bucketMargins[records[i]->qualifier] += ws[i];
         }
 
         // Finally have the value of $K_b$
         bucketMargin[bucket] = sqrt(max(bucketMargin[bucket], 0.0));
+
+        if (adj) {
+            adj->records = std::move(records);
+            adj->cr = std::move(cr);
+        }
     }
 
     // If there is a "Residual" bucket entry store it separately
@@ -1031,8 +1613,10 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
         bucketMargin.erase("Residual");
     }
 
-    // Now calculate final margin by aggregating across non-residual buckets
+    // Now calculate final margin by aggregating across non-residual buckets, for the gradient with the derivatives of
+    // the sum w.r.t. the $S_b$
     Real margin = 0.0;
+    map<string, Real> dMarginS;
     for (auto itOuter = bucketMargin.begin(); itOuter != bucketMargin.end(); ++itOuter) {
         string outerBucket = itOuter->first;
         // Diagonal term, $K_b^2$ from SIMM docs
@@ -1051,10 +1635,42 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
             string outerQualifier = *buckets.at(outerBucket).begin();
             Real corr = simmConfiguration_->correlation(rt, outerQualifier, "", "", rt, innerQualifier, "", "", calcCcy);
             margin += 2.0 * sOuter * sInner * corr;
+            if (gradient) {
+                dMarginS[outerBucket] += 2.0 * sInner * corr;
+                dMarginS[innerBucket] += 2.0 * sOuter * corr;
+            }
         }
     }
     margin = sqrt(max(margin, 0.0));
 
+    // Reverse pass through the aggregation, the bucket margins and the concentration risks
+    if (gradient) {
+        Real aMargin = rootDerivative(margin);
+        for (const auto& [bucket, adj] : adjoints) {
+            Real k = residualMargin, aK = 1.0, aSum = 0.0;
+            if (bucket != "Residual") {
+                k = bucketMargin.at(bucket);
+                aK = aMargin * 2.0 * k;
+                cappedSumAdjoint(sumWeightedSensis.at(bucket), k, aMargin * dMarginS[bucket], aSum, aK);
+            }
+            Real aK2 = aK * rootDerivative(k);
+            map<string, Real> aCr;
+            for (const auto& [qualifier, d] : adj.dK2dCr)
+                aCr[qualifier] = aK2 * d;
+            for (Size i = 0; i < adj.records.size(); ++i) {
+                Real aWs = aK2 * adj.dK2[i] + aSum;
+                (*gradient)[*adj.records[i]] += aWs * adj.rw[i] * adj.cr[i];
+                aCr[adj.records[i]->qualifier] += aWs * adj.rw[i] * adj.records[i]->amountResultCcy;
+            }
+            for (Size i = 0; i < adj.records.size(); ++i) {
+                const string& qualifier = adj.records[i]->qualifier;
+                (*gradient)[*adj.records[i]] += aCr[qualifier] *
+                                                concentrationRiskDerivative(adj.concentration.at(qualifier)) *
+                                                adj.concentrationWeight[i] / adj.threshold.at(qualifier);
+            }
+        }
+    }
+
     // Now add the residual component back in
     margin += residualMargin;
     if (!close_enough(residualMargin, 0.0))
@@ -1074,7 +1690,8 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
 
 pair<map<string, Real>, bool>
 SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, const ProductClass& pc, const RiskType& rt,
-                                const SimmSide& side, const Crif& crif, bool rfLabels) const {
+                                const SimmSide& side, const Crif& crif, bool rfLabels,
+                                RecordGradient* gradient) const {
 
     const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
 
@@ -1109,51 +1726,68 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
     map<string, map<string, Real>> sumAbsTemp;
     map<string, Real> sumAbsWeightedSensis;
 
+    // For the gradient, the records of each bucket with the factors of their weighted sensitivities other than the
+    // amount, the weighted sensitivities and the derivatives of $K_b^2$ w.r.t. them
+    struct BucketAdjoint {
+        std::vector<CrifRecord> records;
+        std::vector<Real> sf, ws, dK2;
+    };
+    map<string, BucketAdjoint> adjoints;
+
     // Loop over the buckets
     for (const auto& kv : buckets) {
         string bucket = kv.first;
         sumAbsTemp[bucket] = {};
 
-        // Calculate the margin component for the current bucket
-        // Pair of iterators to start and end of sensitivities within current bucket
+        // Weighted curvatures i.e. $CVR_{ik}$ from SIMM docs of the sensitivities within the current bucket, computed
+        // once per sensitivity
         auto pBucket = crif.filterByBucket(nettingSetDetails, pc, rt, bucket);
-        for (auto itOuter = pBucket.begin(); itOuter != pBucket.end(); ++itOuter) {
+        // for ISDA SIMM 2.2 or higher, this $CVR_{ik}$ for EQ bucket 12 is zero
+        const string simmVersion = simmConfiguration_->version();
+        SimmVersion thresholdVersion = SimmVersion::V2_2;
+        const bool zeroCurvature =
+            (simmConfiguration_->isSimmConfigCalibration() || parseSimmVersion(simmVersion) >= thresholdVersion) &&
+            bucket == "12" && rt == RiskType::EquityVol;
+        std::vector<Real> ws, sfs, dK2(gradient ? pBucket.size() : 0);
+        ws.reserve(pBucket.size());
+        for (const auto& it : pBucket) {
             // Curvature weight i.e. $SF(t_{kj})$ from SIMM docs
-            Real sfOuter = simmConfiguration_->curvatureWeight(rt, itOuter->label1);
+            Real sf = simmConfiguration_->curvatureWeight(rt, it.label1);
             // Get the sigma value if applicable - returns 1.0 if not applicable
-            Real sigmaOuter = simmConfiguration_->sigma(rt, itOuter->qualifier, itOuter->label1, calcCcy);
-            // Weighted curvature i.e. $CVR_{ik}$ from SIMM docs
+            Real sigma = simmConfiguration_->sigma(rt, it.qualifier, it.label1, calcCcy);
             // WARNING: The order of multiplication here is important because unit tests fail if for
-            //          example you use sfOuter * (itOuter->amountResultCcy * multiplier) * sigmaOuter;
-            Real wsOuter = sfOuter * ((itOuter->amountResultCcy * multiplier) * sigmaOuter);
-            // for ISDA SIMM 2.2 or higher, this $CVR_{ik}$ for EQ bucket 12 is zero
-            const string simmVersion = simmConfiguration_->version();
-            SimmVersion thresholdVersion = SimmVersion::V2_2;
-            if ((simmConfiguration_->isSimmConfigCalibration() || parseSimmVersion(simmVersion) >= thresholdVersion) &&
-                bucket == "12" && rt == RiskType::EquityVol) {
-                wsOuter = 0.0;
-            }
+            //          example you use sf * (it.amountResultCcy * multiplier) * sigma;
+            ws.push_back(zeroCurvature ? 0.0 : sf * ((it.amountResultCcy * multiplier) * sigma));
+            if (gradient)
+                sfs.push_back(zeroCurvature ? 0.0 : sf * multiplier * sigma);
+        }
+
+        // Calculate the margin component for the current bucket
+        for (Size i = 0; i < pBucket.size(); ++i) {
             // Update weighted sensitivity sum
-            sumWeightedSensis[bucket] += wsOuter;
-            sumAbsTemp[bucket][itOuter->qualifier] += rfLabels ? std::abs(wsOuter) : wsOuter;
+            sumWeightedSensis[bucket] += ws[i];
+            sumAbsTemp[bucket][pBucket[i].qualifier] += rfLabels ? std::abs(ws[i]) : ws[i];
             // Add diagonal element to curvature margin
-            curvatureMargin[bucket] += wsOuter * wsOuter;
+            curvatureMargin[bucket] += ws[i] * ws[i];
+            if (gradient)
+                dK2[i] += 2.0 * ws[i];
             // Add the cross elements to the curvature margin
-            for (auto itInner = pBucket.begin(); itInner != itOuter; ++itInner) {
+            for (Size j = 0; j < i; ++j) {
                 // Correlation, $\rho_{k,l}$ in the SIMM docs
-                Real corr = simmConfiguration_->correlation(rt, itOuter->qualifier, itOuter->label1, itOuter->label2,
-                                                            rt, itInner->qualifier, itInner->label1, itInner->label2,
-                                                            calcCcy);
+                Real corr = simmConfiguration_->correlation(rt, pBucket[i].qualifier, pBucket[i].label1,
+                                                            pBucket[i].label2, rt, pBucket[j].qualifier,
+                                                            pBucket[j].label1, pBucket[j].label2, calcCcy);
                 // Add cross element to delta margin
-                Real sfInner = simmConfiguration_->curvatureWeight(rt, itInner->label1);
-                Real sigmaInner = simmConfiguration_->sigma(rt, itInner->qualifier, itInner->label1, calcCcy);
-                Real wsInner = sfInner * ((itInner->amountResultCcy * multiplier) * sigmaInner);
-                curvatureMargin[bucket] += 2 * corr * corr * wsOuter * wsInner;
+                curvatureMargin[bucket] += 2 * corr * corr * ws[i] * ws[j];
+                if (gradient) {
+                    dK2[i] += 2.0 * corr * corr * ws[j];
+                    dK2[j] += 2.0 * corr * corr * ws[i];
+                }
             }
             // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not
             // used for Risk_FX
             if (riskClassIsFX)
-                bucketMargins[itOuter->qualifier] += wsOuter;
+                bucketMargins[pBucket[i].qualifier] += ws[i];
         }
 
         // Finally have the value of $K_b$
@@ -1164,6 +1798,9 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
         for (const auto& kv : sumAbsTemp[bucket]) {
             sumAbsWeightedSensis[bucket] += std::abs(kv.second);
         }
+
+        if (gradient)
+            adjoints[bucket] = {std::move(pBucket), std::move(sfs), std::move(ws), std::move(dK2)};
     }
 
     // If there is a "Residual" bucket entry store it separately
@@ -1181,8 +1818,10 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
         sumAbsWeightedSensis.erase("Residual");
     }
 
-    // Now calculate final margin
+    // Now calculate final margin, for the gradient with the adjoints of the bucket margins, the sums of the weighted
+    // sensitivities and the sums of their absolute values
     Real margin = 0.0;
+    map<string, Real> aBucketMargin, aSum, aSumAbs;
 
     // First, aggregating across non-residual buckets
     auto acc = [](const Real p, const pair<const string, Real>& kv) { return p + kv.second; };
@@ -1191,6 +1830,7 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
 
     if (!close_enough(sumAbsSensis, 0.0)) {
         Real theta = min(sumSensis / sumAbsSensis, 0.0);
+        map<string, Real> dMarginS;
         for (auto itOuter = curvatureMargin.begin(); itOuter != curvatureMargin.end(); ++itOuter) {
             string outerBucket = itOuter->first;
             // Diagonal term
@@ -1209,16 +1849,71 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
                 string outerQualifier = *buckets.at(outerBucket).begin();
                 Real corr = simmConfiguration_->correlation(rt, outerQualifier, "", "", rt, innerQualifier, "", "", calcCcy);
                 margin += 2.0 * sOuter * sInner * corr * corr;
+                if (gradient) {
+                    dMarginS[outerBucket] += 2.0 * sInner * corr * corr;
+                    dMarginS[innerBucket] += 2.0 * sOuter * corr * corr;
+                }
+            }
+        }
+        Real root = sqrt(max(margin, 0.0));
+        Real unfloored = sumSensis + lambda(theta) * root;
+        margin = max(unfloored, 0.0);
+
+        // Reverse pass through the floor, $\lambda(\theta)$ and the aggregation across buckets
+        if (gradient && !(unfloored < 0.0)) {
+            Real aSumSensis = 1.0, aSumAbsSensis = 0.0;
+            if (!(0.0 < sumSensis / sumAbsSensis)) {
+                Real aRatio = root * lambdaDerivative();
+                aSumSensis += aRatio / sumAbsSensis;
+                aSumAbsSensis -= aRatio * sumSensis / (sumAbsSensis * sumAbsSensis);
+            }
+            Real aMargin = lambda(theta) * rootDerivative(root);
+            for (const auto& [bucket, k] : curvatureMargin) {
+                aBucketMargin[bucket] = aMargin * 2.0 * k;
+                aSum[bucket] = aSumSensis;
+                aSumAbs[bucket] = aSumAbsSensis;
+                cappedSumAdjoint(sumWeightedSensis.at(bucket), k, aMargin * dMarginS[bucket], aSum[bucket],
+                                 aBucketMargin[bucket]);
             }
         }
-        margin = max(sumSensis + lambda(theta) * sqrt(max(margin, 0.0)), 0.0);
     }
 
     // Second, the residual bucket if necessary, and add "Residual" bucket back in to be added to the SIMM results
     if (!close_enough(residualAbsSum, 0.0)) {
         Real theta = min(residualSum / residualAbsSum, 0.0);
-        curvatureMargin["Residual"] = max(residualSum + lambda(theta) * residualMargin, 0.0);
+        Real unfloored = residualSum + lambda(theta) * residualMargin;
+        curvatureMargin["Residual"] = max(unfloored, 0.0);
         margin += curvatureMargin["Residual"];
+
+        // Reverse pass through the floor and $\lambda(\theta)$ of the residual bucket
+        if (gradient && !(unfloored < 0.0)) {
+            aSum["Residual"] = 1.0;
+            aSumAbs["Residual"] = 0.0;
+            aBucketMargin["Residual"] = lambda(theta);
+            if (!(0.0 < residualSum / residualAbsSum)) {
+                Real aRatio = residualMargin * lambdaDerivative();
+                aSum["Residual"] += aRatio / residualAbsSum;
+                aSumAbs["Residual"] -= aRatio * residualSum / (residualAbsSum * residualAbsSum);
+            }
+        }
+    }
+
+    // Reverse pass through the bucket margins and the sums to the weighted sensitivities
+    if (gradient) {
+        for (const auto& [bucket, adj] : adjoints) {
+            auto a = aBucketMargin.find(bucket);
+            if (a == aBucketMargin.end())
+                continue;
+            Real k = bucket == "Residual" ? residualMargin : curvatureMargin.at(bucket);
+            Real aK2 = a->second * rootDerivative(k);
+            const auto& sumAbsQualifier = sumAbsTemp.at(bucket);
+            for (Size i = 0; i < adj.records.size(); ++i) {
+                Real dAbs = absDerivative(sumAbsQualifier.at(adj.records[i].qualifier)) *
+                            (rfLabels ? absDerivative(adj.ws[i]) : 1.0);
+                Real aWs = aK2 * adj.dK2[i] + aSum.at(bucket) + aSumAbs.at(bucket) * dAbs;
+                (*gradient)[adj.records[i]] += aWs * adj.sf[i];
+            }
+        }
     }
 
     // For non-FX risk class, results are broken down by buckets
@@ -1233,11 +1928,9 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
     return make_pair(bucketMargins, true);
 }
 
-void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
-                                   const string& regulation, const Crif& crif) {
-
-    // Reference to SIMM results for this portfolio
-    auto& results = simmResults_[side][nettingSetDetails][regulation];
+void SimmCalculator::calcAddMargin(SimmResults& results, std::vector<CrifRecord>& simmParameters,
+                                   const SimmSide& side, const NettingSetDetails& nettingSetDetails,
+                                   const string& regulation, const Crif& crif) const {
 
     const bool overwrite = false;
 
@@ -1261,23 +1954,24 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
             QL_REQUIRE(factor >= 0.0, "SIMM Calculator: Amount for risk type "
                 << rt << " must be greater than or equal to 0 but we got " << factor);
             Real pcmMargin = (factor - 1.0) * im;
-            add(nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin, side,
-                overwrite);
+            add(results, nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin,
+                side, overwrite);
 
             // Add to aggregation at margin type level
-            add(nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::All, "All", pcmMargin, side, overwrite);
+            add(results, nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::All, "All", pcmMargin, side,
+                overwrite);
             // Add to aggregation at product class level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin,
-                side, overwrite);
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM,
+                "All", pcmMargin, side, overwrite);
             // Add to aggregation at portfolio level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", pcmMargin, side,
-                overwrite);
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All",
+                pcmMargin, side, overwrite);
             CrifRecord spRecord = it;
             if (side == SimmSide::Call)
                 spRecord.collectRegulations = regulation;
             else
                 spRecord.postRegulations = regulation;
-            simmParameters_.addRecord(spRecord);
+            simmParameters.push_back(spRecord);
         }
     }
 
@@ -1285,25 +1979,24 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
     pIt = crif.filterBy(nettingSetDetails, pc, RiskType::AddOnFixedAmount);
     for(const auto& it : pIt){
         Real fixedMargin = it.amountResultCcy;
-        add(nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::AdditionalIM,
-            "All", fixedMargin, side, overwrite);
+        add(results, nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All,
+            MarginType::AdditionalIM, "All", fixedMargin, side, overwrite);
 
         // Add to aggregation at margin type level
-        add(nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::All, "All",
-            fixedMargin,
-            side, overwrite);
+        add(results, nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::All,
+            "All", fixedMargin, side, overwrite);
         // Add to aggregation at product class level
-        add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
+        add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
             fixedMargin, side, overwrite);
         // Add to aggregation at portfolio level
-        add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", fixedMargin, side,
-            overwrite);
+        add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All",
+            fixedMargin, side, overwrite);
         CrifRecord spRecord = it;
         if (side == SimmSide::Call)
             spRecord.collectRegulations = regulation;
         else
             spRecord.postRegulations = regulation;
-        simmParameters_.addRecord(spRecord);
+        simmParameters.push_back(spRecord);
     }
 
     // Third, add percentage of notional amounts IM, using "AddOnNotionalFactor"
@@ -1324,18 +2017,17 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
             Real factor = it.amount;
             Real notionalFactorMargin = notional * factor / 100.0;
 
-            add(nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All,
+            add(results, nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All,
                 MarginType::AdditionalIM, "All", notionalFactorMargin, side, overwrite);
 
             // Add to aggregation at margin type level
-            add(nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All, MarginType::All,
-                "All",
-                notionalFactorMargin, side, overwrite);
+            add(results, nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All,
+                MarginType::All, "All", notionalFactorMargin, side, overwrite);
             // Add to aggregation at product class level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
-                notionalFactorMargin, side, overwrite);
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM,
+                "All", notionalFactorMargin, side, overwrite);
             // Add to aggregation at portfolio level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All",
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All",
                 notionalFactorMargin,
                 side, overwrite);
             CrifRecord spRecord = it;
@@ -1343,13 +2035,13 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
                 spRecord.collectRegulations = regulation;
             else
                 spRecord.postRegulations = regulation;
-            simmParameters_.addRecord(spRecord);
+            simmParameters.push_back(spRecord);
         }
     }
 }
 
-void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
-                                     const string& regulation) {
+void SimmCalculator::populateResults(SimmResults& results, const SimmSide& side,
+                                     const NettingSetDetails& nettingSetDetails, const string& regulation) const {
 
     if (!quiet_) {
         LOG("SimmCalculator: Populating higher level results")
@@ -1362,9 +2054,6 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
     // Populate netting set level results for each portfolio
 
-    // Reference to SIMM results for this portfolio
-    auto& results = simmResults_[side][nettingSetDetails][regulation];
-
     // Fill in the margin within each (product class, risk class) combination
     for (const auto& pc : pcs) {
         for (const auto& rc : rcs) {
@@ -1382,7 +2071,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
             // Add the margin to the results if it was calculated
             if (hasRiskClass) {
-                add(nettingSetDetails, regulation, pc, rc, MarginType::All, "All", riskClassMargin, side);
+                add(results, nettingSetDetails, regulation, pc, rc, MarginType::All, "All", riskClassMargin, side);
             }
         }
     }
@@ -1420,7 +2109,8 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
         // Add the margin to the results if it was calculated
         if (hasProductClass) {
             productClassMargin = sqrt(max(productClassMargin, 0.0));
-            add(nettingSetDetails, regulation, pc, RiskClass::All, MarginType::All, "All", productClassMargin, side);
+            add(results, nettingSetDetails, regulation, pc, RiskClass::All, MarginType::All, "All", productClassMargin,
+                side);
         }
     }
 
@@ -1432,7 +2122,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
             im += results.get(pc, RiskClass::All, MarginType::All, "All");
         }
     }
-    add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", im, side);
+    add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", im, side);
 
     // Combinations outside of the natural SIMM hierarchy
 
@@ -1470,7 +2160,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
             // Add the margin to the results if it was calculated
             if (hasPcMt) {
                 margin = sqrt(max(margin, 0.0));
-                add(nettingSetDetails, regulation, pc, RiskClass::All, mt, "All", margin, side);
+                add(results, nettingSetDetails, regulation, pc, RiskClass::All, mt, "All", margin, side);
             }
         }
     }
@@ -1495,7 +2185,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
             // Add the margin to the results if it was calculated
             if (hasRcMt) {
-                add(nettingSetDetails, regulation, ProductClass::All, rc, mt, "All", margin, side);
+                add(results, nettingSetDetails, regulation, ProductClass::All, rc, mt, "All", margin, side);
             }
         }
     }
@@ -1520,7 +2210,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
         // Add the margin to the results if it was calculated
         if (hasRc) {
-            add(nettingSetDetails, regulation, ProductClass::All, rc, MarginType::All, "All", margin, side);
+            add(results, nettingSetDetails, regulation, ProductClass::All, rc, MarginType::All, "All", margin, side);
         }
     }
 
@@ -1544,7 +2234,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
         // Add the margin to the results if it was calculated
         if (hasMt) {
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, mt, "All", margin, side);
+            add(results, nettingSetDetails, regulation, ProductClass::All, RiskClass::All, mt, "All", margin, side);
         }
     }
 }
@@ -1596,9 +2286,9 @@ void SimmCalculator::populateFinalResults() {
     populateFinalResults(winningRegulations_);
 }
 
-void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const string& regulation, const ProductClass& pc,
-                         const RiskClass& rc, const MarginType& mt, const string& b, Real margin, SimmSide side,
-                         const bool overwrite) {
+void SimmCalculator::add(SimmResults& results, const NettingSetDetails& nettingSetDetails, const string& regulation,
+                         const ProductClass& pc, const RiskClass& rc, const MarginType& mt, const string& b,
+                         Real margin, SimmSide side, const bool overwrite) const {
     if (!quiet_) {
         DLOG("Calculated " << side << " margin for [netting set details, product class, risk class, margin type] = ["
                            << "[" << NettingSetDetails(nettingSetDetails) << "]"
@@ -1606,15 +2296,15 @@ void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const strin
     }
 
     const string& calculationCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
-    simmResults_[side][nettingSetDetails][regulation].add(pc, rc, mt, b, margin, resultCcy_, calculationCcy, overwrite);
+    results.add(pc, rc, mt, b, margin, resultCcy_, calculationCcy, overwrite);
 }
 
-void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const string& regulation, const ProductClass& pc,
-                         const RiskClass& rc, const MarginType& mt, const map<string, Real>& margins, SimmSide side,
-                         const bool overwrite) {
+void SimmCalculator::add(SimmResults& results, const NettingSetDetails& nettingSetDetails, const string& regulation,
+                         const ProductClass& pc, const RiskClass& rc, const MarginType& mt,
+                         const map<string, Real>& margins, SimmSide side, const bool overwrite) const {
 
     for (const auto& kv : margins)
-        add(nettingSetDetails, regulation, pc, rc, mt, kv.first, kv.second, side, overwrite);
+        add(results, nettingSetDetails, regulation, pc, rc, mt, kv.first, kv.second, side, overwrite);
 }
 
 void SimmCalculator::splitCrifByRegulationsAndPortfolios(const Crif& crif, const bool enforceIMRegulations) {
@@ -1664,6 +2354,11 @@ Real SimmCalculator::lambda(Real theta) const {
     return (q * q - 1.0) * (1.0 + theta) - theta;
 }
 
+Real SimmCalculator::lambdaDerivative() const {
+    static Real q = boost::math::quantile(boost::math::normal(), 0.995);
+    return q * q - 2.0;
+}
+
 std::set<std::string> SimmCalculator::getQualifiers(const Crif& crif,
                                                     const ore::data::NettingSetDetails& nettingSetDetails,
                                                     const CrifRecord::ProductClass& pc,
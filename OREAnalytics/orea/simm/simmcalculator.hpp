@@ -27,7 +27,10 @@
 #include <orea/simm/simmresults.hpp>
 #include <ored/marketdata/market.hpp>
 
+#include <functional>
 #include <map>
+#include <tuple>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -44,6 +47,9 @@ public:
         \p calculationCcy is not USD then the \p usdSpot parameter must be used to
         give the FX spot rate between USD and the \p calculationCcy. This spot rate is
         interpreted as the number of USD per unit of \p calculationCcy.
+
+        If \p nThreads is greater than one, the margin components of the netting sets, regulations, product classes
+        and risk classes are calculated in parallel. The results do not depend on the number of threads.
     */
     SimmCalculator(const ore::analytics::Crif& crif,
                    const QuantLib::ext::shared_ptr<SimmConfiguration>& simmConfiguration,
@@ -56,7 +62,8 @@ public:
                    const std::map<SimmSide, std::set<NettingSetDetails>>& hasSEC =
                        std::map<SimmSide, std::set<NettingSetDetails>>(),
                    const std::map<SimmSide, std::set<NettingSetDetails>>& hasCFTC =
-                       std::map<SimmSide, std::set<NettingSetDetails>>());
+                       std::map<SimmSide, std::set<NettingSetDetails>>(),
+                   const QuantLib::Size nThreads = 1);
 
     //! Calculates SIMM for a given regulation under a given netting set
     const void calculateRegulationSimm(const ore::analytics::Crif& crif, const ore::data::NettingSetDetails& nsd,
@@ -102,6 +109,30 @@ public:
     //! Return the calculator's result currency
     const std::string& resultCurrency() const { return resultCcy_; }
 
+    /*! SIMM for the given side, netting set and regulation as if the records in \p added were added to, and the
+        records in \p removed were removed from, the netting set's CRIF, e.g. for the marginal impact of a trade.
+        Records of other netting sets are ignored, SIMM parameter records can not be added or removed.
+
+        The margin components of the regulation CRIF are cached on the first call for the side, netting set and
+        regulation. Only the components of the product classes and risk classes touched by the changed records are
+        recalculated, followed by the aggregation to the total margin and the additional margin. The results of the
+        calculator itself are not changed.
+    */
+    SimmResults incrementalSimm(const SimmSide& side, const ore::data::NettingSetDetails& nettingSetDetails,
+                                const std::string& regulation, const ore::analytics::Crif& added,
+                                const ore::analytics::Crif& removed = ore::analytics::Crif());
+
+    /*! Derivatives of the total margin of the given side, netting set and regulation with respect to the result
+        currency amount of each sensitivity record of the netting set's regulation CRIF, e.g. for the allocation of
+        IM to trades. The derivatives are exact and computed in one pass: each margin component is calculated once
+        together with the derivatives of its margin with respect to its records, which are then combined with the
+        derivatives of the aggregation to the total margin and of the additional margin. Where the margin is not
+        differentiable, e.g. at a cap of the weighted sensitivity sums, the branch taken by the calculation is used.
+    */
+    std::vector<std::pair<CrifRecord, QuantLib::Real>>
+    simmGradient(const SimmSide& side, const ore::data::NettingSetDetails& nettingSetDetails,
+                 const std::string& regulation);
+
     /*! Populate the finalSimmResults_ and finalAddMargins_ containers
         using the provided map of winning call/post regulations.
     */
@@ -162,20 +193,91 @@ private:
 
     std::map<SimmSide, set<string>> finalTradeIds_;
 
-    //! Calculate the Interest Rate delta margin component for the given portfolio and product class
+    //! Number of threads used to calculate the margin components
+    QuantLib::Size nThreads_;
+
+    typedef std::tuple<CrifRecord::ProductClass, SimmConfiguration::RiskClass, SimmConfiguration::MarginType>
+        ComponentKey;
+    typedef std::map<ComponentKey, std::pair<std::map<std::string, QuantLib::Real>, bool>> ComponentResults;
+    typedef std::set<std::pair<CrifRecord::ProductClass, SimmConfiguration::RiskClass>> AffectedClasses;
+    //! Derivatives of a margin with respect to the result currency amounts of the CRIF records
+    typedef std::map<CrifRecord, QuantLib::Real> RecordGradient;
+
+    //! Margin components of the regulation CRIFs, by side, netting set and regulation, used by incrementalSimm()
+    std::map<SimmSide, std::map<ore::data::NettingSetDetails, std::map<std::string, ComponentResults>>>
+        componentCache_;
+
+    /*! A margin component for a product class, risk class and margin type, calc() is safe to call concurrently.
+        If the gradient passed to calc() is not null, the derivatives of the component's margin are added to it.
+    */
+    struct MarginComponent {
+        CrifRecord::ProductClass pc;
+        SimmConfiguration::RiskClass rc;
+        SimmConfiguration::MarginType mt;
+        std::function<std::pair<std::map<std::string, QuantLib::Real>, bool>(RecordGradient*)> calc;
+        std::pair<std::map<std::string, QuantLib::Real>, bool> result;
+    };
+
+    //! Calculate SIMM for all side-nettingSet-regulation combinations using nThreads_ threads
+    void calculateRegulationSimmParallel();
+
+    //! The regulation CRIF for the side, netting set and regulation, or an empty CRIF if there is none
+    const ore::analytics::Crif& regulationCrif(const SimmSide& side, const ore::data::NettingSetDetails& nsd,
+                                               const std::string& regulation) const;
+
+    //! The margin components of the regulation CRIF, calculated on first use
+    const ComponentResults& cachedComponents(const SimmSide& side, const ore::data::NettingSetDetails& nsd,
+                                             const std::string& regulation);
+
+    //! Add the product class and risk class whose margin components depend on the record
+    static void addAffectedComponents(AffectedClasses& affected, const CrifRecord& cr);
+
+    /*! SIMM for \p crif, a modification of the regulation CRIF, recalculating only the margin components of the
+        \p affected product classes and risk classes, the other components are taken from \p cache
+    */
+    SimmResults recalculateSimm(const ore::analytics::Crif& crif, const ore::data::NettingSetDetails& nsd,
+                                const std::string& regulation, const SimmSide& side,
+                                const AffectedClasses& affected, const ComponentResults& cache) const;
+
+    //! Copy of the record with the amount in the result currency populated
+    CrifRecord resultCcyRecord(const CrifRecord& cr) const;
+
+    //! Whether the regulation CRIF contains records to calculate SIMM for
+    static bool hasSimmRecords(const ore::analytics::Crif& crif);
+
+    //! The margin components to calculate for the given netting set, in the order they are added to the results
+    std::vector<MarginComponent> marginComponents(const ore::analytics::Crif& crif,
+                                                  const ore::data::NettingSetDetails& nettingSetDetails,
+                                                  const SimmSide& side) const;
+
+    /*! Add the calculated margin components to \p results, populate the higher level results and the additional
+        margin. The SIMM parameters used are appended to \p simmParameters. Only \p results and \p simmParameters
+        are modified, so that this can be called concurrently for distinct results containers.
+    */
+    void aggregateRegulationSimm(SimmResults& results, std::vector<CrifRecord>& simmParameters,
+                                 const ore::analytics::Crif& crif, const ore::data::NettingSetDetails& nsd,
+                                 const string& regulation, const SimmSide& side,
+                                 const std::vector<MarginComponent>& components) const;
+
+    /*! Calculate the Interest Rate delta margin component for the given portfolio and product class. If \p gradient
+        is not null, the derivatives of the "All" margin are added to it, likewise for the margin components below.
+    */
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irDeltaMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
-                  const ore::analytics::Crif& netRecords, const SimmSide& side) const;
+                  const ore::analytics::Crif& netRecords, const SimmSide& side,
+                  RecordGradient* gradient = nullptr) const;
 
     //! Calculate the Interest Rate vega margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irVegaMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
-                 const ore::analytics::Crif& netRecords, const SimmSide& side) const;
+                 const ore::analytics::Crif& netRecords, const SimmSide& side,
+                 RecordGradient* gradient = nullptr) const;
 
     //! Calculate the Interest Rate curvature margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irCurvatureMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
-                      const SimmSide& side, const ore::analytics::Crif& crif) const;
+                      const SimmSide& side, const ore::analytics::Crif& crif,
+                      RecordGradient* gradient = nullptr) const;
 
     /*! Calculate the (delta or vega) margin component for the given portfolio, product class and risk type
         Used to calculate delta or vega or base correlation margin for all risk types except IR, IRVol
@@ -185,7 +287,8 @@ private:
                                                                   const CrifRecord::ProductClass& pc,
                                                                   const CrifRecord::RiskType& rt,
                                                                   const ore::analytics::Crif& netRecords,
-                                                                  const SimmSide& side) const;
+                                                                  const SimmSide& side,
+                                                                  RecordGradient* gradient = nullptr) const;
 
     /*! Calculate the curvature margin component for the given portfolio, product class and risk type
         Used to calculate curvature margin for all risk types except IR
@@ -193,36 +296,40 @@ private:
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     curvatureMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
                     const CrifRecord::RiskType& rt, const SimmSide& side, const ore::analytics::Crif& netRecords,
-                    bool rfLabels = true) const;
+                    bool rfLabels = true, RecordGradient* gradient = nullptr) const;
 
-    //! Calculate the additional initial margin for the portfolio ID and regulation
-    void calcAddMargin(const SimmSide& side, const ore::data::NettingSetDetails& nsd, const string& regulation, const ore::analytics::Crif& netRecords);
+    /*! Calculate the additional initial margin for the portfolio ID and regulation, the SIMM parameters used are
+        appended to \p simmParameters
+    */
+    void calcAddMargin(SimmResults& results, std::vector<CrifRecord>& simmParameters, const SimmSide& side,
+                       const ore::data::NettingSetDetails& nsd, const string& regulation,
+                       const ore::analytics::Crif& netRecords) const;
 
     /*! Populate the results structure with the higher level results after the IMs have been
         calculated at the (product class, risk class, margin type) level for the given
-        regulation under the given portfolio
+        regulation under the given portfolio. Only \p results is modified.
     */
-    void populateResults(const SimmSide& side, const ore::data::NettingSetDetails& nsd, const string& regulation);
+    void populateResults(SimmResults& results, const SimmSide& side, const ore::data::NettingSetDetails& nsd,
+                         const string& regulation) const;
 
     /*! Populate final (i.e. winning regulators') using own list of winning regulators, which were determined
         solely by the SIMM results (i.e. not including any external IMSchedule results)
     */
     void populateFinalResults();
 
-    /*! Add a margin result to either call or post results container depending on the
-        \p side parameter.
+    /*! Add a margin result to the \p results container of the given netting set, regulation and \p side
 
         \remark all additions to the results containers should happen in this method
     */
-    void add(const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
+    void add(SimmResults& results, const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
              const CrifRecord::ProductClass& pc, const SimmConfiguration::RiskClass& rc,
              const SimmConfiguration::MarginType& mt, const std::string& b, QuantLib::Real margin, SimmSide side,
-             const bool overwrite = true);
+             const bool overwrite = true) const;
 
-    void add(const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
+    void add(SimmResults& results, const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
              const CrifRecord::ProductClass& pc, const SimmConfiguration::RiskClass& rc,
-             const SimmConfiguration::MarginType& mt, const std::map<std::string, QuantLib::Real>& margins, SimmSide side,
-             const bool overwrite = true);
+             const SimmConfiguration::MarginType& mt, const std::map<std::string, QuantLib::Real>& margins,
+             SimmSide side, const bool overwrite = true) const;
 
     //! Add CRIF record to the CRIF records container that correspondsd to the given regulation/s and portfolio ID
     void splitCrifByRegulationsAndPortfolios(const Crif& crif, const bool enforceIMRegulations);
@@ -230,6 +337,9 @@ private:
     //! Give the \f$\lambda\f$ used in the curvature margin calculation
     QuantLib::Real lambda(QuantLib::Real theta) const;
 
+    //! Give the derivative of \f$\lambda\f$ with respect to \f$\theta\f$, it does not depend on \f$\theta\f$
+    QuantLib::Real lambdaDerivative() const;
+
     std::set<std::string> getQualifiers(const Crif& crif, const ore::data::NettingSetDetails& nettingSetDetails,
                                         const CrifRecord::ProductClass& pc,
                                         const std::vector<CrifRecord::RiskType>& riskTypes) const;
@@ -39,6 +39,8 @@
 #include <ql/experimental/coupons/cmsspreadcoupon.hpp>
 #include <ql/experimental/coupons/digitalcmsspreadcoupon.hpp>
 
+#include <algorithm>
+
 using namespace std;
 using namespace QuantLib;
 using namespace QuantExt;
@@ -111,9 +113,23 @@ void FixingManager::initialise(const QuantLib::ext::shared_ptr<Portfolio>& portf
         }
     }
 
-    // Now cache the original fixings so we can re-write on reset()
+    // Now cache the original fixings so we can re-write on reset(), the required fixing dates are stored in a sorted
+    // vector along with their validity as fixing dates, so that the latter is not rechecked on each update
+    indexFixings_.clear();
+    indexFixings_.reserve(fixingMap_.size());
     for (auto const& m : fixingMap_) {
-        fixingCache_[m.first] = IndexManager::instance().getHistory(m.first->name());
+        IndexFixings f;
+        f.index = m.first;
+        f.zeroInflationIndex = QuantLib::ext::dynamic_pointer_cast<ZeroInflationIndex>(m.first);
+        f.yoyInflationIndex = QuantLib::ext::dynamic_pointer_cast<YoYInflationIndex>(m.first);
+        f.commodityIndex = QuantLib::ext::dynamic_pointer_cast<QuantExt::CommodityIndex>(m.first);
+        f.dates.assign(m.second.begin(), m.second.end());
+        f.validFixingDate.reserve(f.dates.size());
+        // Fixing dates include the valuation grid dates which might not be valid fixing dates (BMA/SIFMA)
+        for (auto const& d : f.dates)
+            f.validFixingDate.push_back(m.first->isValidFixingDate(d));
+        f.originalHistory = IndexManager::instance().getHistory(m.first->name());
+        indexFixings_.push_back(std::move(f));
     }
 }
 
@@ -132,8 +148,12 @@ void FixingManager::update(Date d) {
 //! Reset fixings to t0 (today)
 void FixingManager::reset() {
     if (modifiedFixingHistory_) {
-        for (auto& kv : fixingCache_)
-            IndexManager::instance().setHistory(kv.first->name(), kv.second);
+        for (auto& f : indexFixings_) {
+            if (f.modified) {
+                IndexManager::instance().setHistory(f.index->name(), f.originalHistory);
+                f.modified = false;
+            }
+        }
         modifiedFixingHistory_ = false;
     }
     fixingsEnd_ = today_;
@@ -141,64 +161,57 @@ void FixingManager::reset() {
 
 void FixingManager::applyFixings(Date start, Date end) {
     // Loop over all indices
-    for (auto const& m : fixingMap_) {
+    for (auto& f : indexFixings_) {
         Date fixStart = start;
         Date fixEnd = end;
-        Date currentFixingDate;
-        if (auto zii = QuantLib::ext::dynamic_pointer_cast<ZeroInflationIndex>(m.first)) {
+        bool isInflation = false;
+        if (auto const& zii = f.zeroInflationIndex) {
             fixStart =
                 inflationPeriod(fixStart - zii->zeroInflationTermStructure()->observationLag(), zii->frequency()).first;
             fixEnd =
                 inflationPeriod(fixEnd - zii->zeroInflationTermStructure()->observationLag(), zii->frequency()).first +
                 1;
-            currentFixingDate = fixEnd;
-        } else if (auto yii = QuantLib::ext::dynamic_pointer_cast<YoYInflationIndex>(m.first)) {
+            isInflation = true;
+        } else if (auto const& yii = f.yoyInflationIndex) {
             fixStart =
                 inflationPeriod(fixStart - yii->yoyInflationTermStructure()->observationLag(), yii->frequency()).first;
             fixEnd =
                 inflationPeriod(fixEnd - yii->yoyInflationTermStructure()->observationLag(), yii->frequency()).first +
                 1;
+            isInflation = true;
+        }
+
+        // Add we have a coupon between start and asof.
+        auto first = std::lower_bound(f.dates.begin(), f.dates.end(), fixStart);
+        if (first == f.dates.end() || *first >= fixEnd)
+            continue;
+
+        Date currentFixingDate;
+        if (isInflation) {
             currentFixingDate = fixEnd;
         } else {
-            currentFixingDate = m.first->fixingCalendar().adjust(fixEnd, Following);
+            currentFixingDate = f.index->fixingCalendar().adjust(fixEnd, Following);
             // This date is a business day but may not be a valid fixing date in case of BMA/SIFMA
-            if (!m.first->isValidFixingDate(currentFixingDate))
-                currentFixingDate = nextValidFixingDate(currentFixingDate, m.first);
+            if (!f.index->isValidFixingDate(currentFixingDate))
+                currentFixingDate = nextValidFixingDate(currentFixingDate, f.index);
         }
 
-        // Add we have a coupon between start and asof.
-        bool needFixings = false;
-        for (auto const& d : m.second) {
-            if (d >= fixStart && d < fixEnd) {
-                needFixings = true;
-                break;
-            }
+        Rate currentFixing;
+        if (f.commodityIndex != nullptr && f.commodityIndex->expiryDate() < currentFixingDate) {
+            currentFixing = f.commodityIndex->priceCurve()->price(currentFixingDate);
+        } else {
+            currentFixing = f.index->fixing(currentFixingDate);
         }
-
-        if (needFixings) {
-            Rate currentFixing;
-            if (auto comm = QuantLib::ext::dynamic_pointer_cast<QuantExt::CommodityIndex>(m.first);
-                comm != nullptr && comm->expiryDate() < currentFixingDate) {
-                currentFixing = comm->priceCurve()->price(currentFixingDate);
-            } else {
-                currentFixing = m.first->fixing(currentFixingDate);
-            }
-            // if we read the fixing from an inverted FxIndex we have to undo the inversion
-            TimeSeries<Real> history;
-            for (auto const& d : m.second) {
-                if (d >= fixStart && d < fixEnd) {
-                    // Fixing dates include the valuation grid dates which might not be valid fixing dates (BMA/SIFMA)
-                    bool valid = m.first->isValidFixingDate(d);
-                    if (valid) {
-                        history[d] = currentFixing;
-                        modifiedFixingHistory_ = true;
-                    }
-                }
-                if (d >= fixEnd)
-                    break;
+        // if we read the fixing from an inverted FxIndex we have to undo the inversion
+        TimeSeries<Real> history;
+        for (auto d = first; d != f.dates.end() && *d < fixEnd; ++d) {
+            if (f.validFixingDate[d - f.dates.begin()]) {
+                history[*d] = currentFixing;
+                f.modified = true;
+                modifiedFixingHistory_ = true;
             }
-            m.first->addFixings(history, true);
         }
+        f.index->addFixings(history, true);
     }
 }
 
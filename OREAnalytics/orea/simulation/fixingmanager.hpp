@@ -25,6 +25,12 @@
 #include <ored/marketdata/market.hpp>
 #include <ored/portfolio/portfolio.hpp>
 
+#include <qle/indexes/commodityindex.hpp>
+
+#include <ql/indexes/inflationindex.hpp>
+
+#include <vector>
+
 namespace ore {
 namespace analytics {
 using namespace QuantLib;
@@ -52,6 +58,10 @@ struct IndexComparator {
   When stepping between simulation dated t_(n-1) and t_(n) and update a fixing t with t_(n-1) < t < t(n) than the fixing
   from t(n) will be backfilled. There is currently no interpolation of fixings.
 
+  The required fixing dates of each index are stored in a sorted vector together with their validity as fixing dates,
+  so that an update only visits the dates within the updated period. On reset() only the fixing histories of the
+  indices that were actually modified since the last reset are restored.
+
   \ingroup simulation
  */
 class FixingManager {
@@ -79,10 +89,20 @@ private:
     Date today_, fixingsEnd_;
     bool modifiedFixingHistory_;
 
-    using FixingCache = std::map<QuantLib::ext::shared_ptr<Index>, TimeSeries<Real>, detail::IndexComparator>;
+    // an index with its required fixing dates (sorted) and the original fixing history
+    struct IndexFixings {
+        QuantLib::ext::shared_ptr<Index> index;
+        QuantLib::ext::shared_ptr<ZeroInflationIndex> zeroInflationIndex;
+        QuantLib::ext::shared_ptr<YoYInflationIndex> yoyInflationIndex;
+        QuantLib::ext::shared_ptr<QuantExt::CommodityIndex> commodityIndex;
+        std::vector<Date> dates;
+        std::vector<bool> validFixingDate;
+        TimeSeries<Real> originalHistory;
+        bool modified = false;
+    };
 
     FixingMap fixingMap_;
-    FixingCache fixingCache_;
+    std::vector<IndexFixings> indexFixings_;
 };
 
 } // namespace analytics
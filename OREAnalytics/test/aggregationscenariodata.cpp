@@ -16,7 +16,9 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <orea/cube/cube_io.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <test/oreatoplevelfixture.hpp>
@@ -65,6 +67,97 @@ BOOST_AUTO_TEST_CASE(testInMemoryAggregationScenarioData) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testCompactAggregationScenarioData) {
+    SinglePrecisionAggregationScenarioData single(3, 5);
+    DoublePrecisionAggregationScenarioData dbl(3, 5);
+
+    BOOST_CHECK_THROW(single.set(3, 0, 0.0, AggregationScenarioDataType::Generic, "blabla"), std::exception);
+    BOOST_CHECK_THROW(dbl.set(0, 5, 0.0, AggregationScenarioDataType::Generic, "blabla"), std::exception);
+
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 5; ++j) {
+            for (AggregationScenarioData* data : std::vector<AggregationScenarioData*>{&single, &dbl}) {
+                data->set(i, j, 0.0001 * i + 0.01 * j, AggregationScenarioDataType::IndexFixing, "OIS_EUR");
+                data->set(i, j, i + 0.1 * j, AggregationScenarioDataType::FXSpot, "EURUSD");
+            }
+        }
+    }
+
+    BOOST_CHECK(dbl.has(AggregationScenarioDataType::FXSpot, "EURUSD"));
+    BOOST_CHECK(!dbl.has(AggregationScenarioDataType::FXSpot, "EURGBP"));
+    BOOST_CHECK_EQUAL(dbl.keys().size(), 2);
+    BOOST_CHECK_THROW(dbl.get(0, 0, AggregationScenarioDataType::FXSpot, "EURGBP"), std::exception);
+
+    const double* block = dbl.data(AggregationScenarioDataType::FXSpot, "EURUSD");
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 5; ++j) {
+            BOOST_CHECK_EQUAL(dbl.get(i, j, AggregationScenarioDataType::IndexFixing, "OIS_EUR"),
+                              0.0001 * i + 0.01 * j);
+            BOOST_CHECK_EQUAL(dbl.get(i, j, AggregationScenarioDataType::FXSpot, "EURUSD"), i + 0.1 * j);
+            BOOST_CHECK_EQUAL(block[i * 5 + j], i + 0.1 * j);
+            BOOST_CHECK_EQUAL(single.get(i, j, AggregationScenarioDataType::FXSpot, "EURUSD"),
+                              static_cast<Real>(static_cast<float>(i + 0.1 * j)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testBinaryAggregationScenarioData) {
+    InMemoryAggregationScenarioData data(3, 5);
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 5; ++j) {
+            data.set(i, j, 0.0001 * i + 0.01 * j, AggregationScenarioDataType::IndexFixing, "OIS_EUR");
+            data.set(i, j, 0.1 + 0.0001 * i + 0.01 * j, AggregationScenarioDataType::IndexFixing, "OIS_USD");
+            data.set(i, j, i + 0.1 * j, AggregationScenarioDataType::FXSpot, "EURUSD");
+            data.set(i, j, 1.0 / (1.0 + i + 0.1 * j), AggregationScenarioDataType::Numeraire);
+        }
+    }
+
+    std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+
+    for (bool doublePrecision : {true, false}) {
+        for (bool compress : {true, false}) {
+            saveAggregationScenarioDataBinary(filename, data, doublePrecision, compress);
+            auto check = [&data, doublePrecision](const AggregationScenarioData& loaded,
+                                                  const AggregationScenarioDataType type, const std::string& q) {
+                for (Size i = 0; i < 3; ++i) {
+                    for (Size j = 0; j < 5; ++j) {
+                        Real expected = data.get(i, j, type, q);
+                        if (!doublePrecision)
+                            expected = static_cast<Real>(static_cast<float>(expected));
+                        BOOST_CHECK_EQUAL(loaded.get(i, j, type, q), expected);
+                    }
+                }
+            };
+
+            // loadAggregationScenarioData() recognises the binary format and reads the keys on first access only
+            auto loaded = QuantLib::ext::dynamic_pointer_cast<BinaryFileAggregationScenarioData>(
+                loadAggregationScenarioData(filename));
+            BOOST_REQUIRE(loaded);
+            BOOST_CHECK_EQUAL(loaded->dimDates(), 3);
+            BOOST_CHECK_EQUAL(loaded->dimSamples(), 5);
+            BOOST_CHECK(loaded->keys() == data.keys());
+            BOOST_CHECK(loaded->has(AggregationScenarioDataType::FXSpot, "EURUSD"));
+            BOOST_CHECK_EQUAL(loaded->loadedKeys(), 0);
+            check(*loaded, AggregationScenarioDataType::Numeraire, "");
+            BOOST_CHECK_EQUAL(loaded->loadedKeys(), 1);
+            check(*loaded, AggregationScenarioDataType::FXSpot, "EURUSD");
+            check(*loaded, AggregationScenarioDataType::Numeraire, "");
+            BOOST_CHECK_EQUAL(loaded->loadedKeys(), 2);
+            BOOST_CHECK_THROW(loaded->set(0, 0, 1.0, AggregationScenarioDataType::Numeraire), std::exception);
+            BOOST_CHECK_THROW(loaded->get(0, 0, AggregationScenarioDataType::FXSpot, "EURGBP"), std::exception);
+            BOOST_CHECK_THROW(loaded->get(3, 0, AggregationScenarioDataType::Numeraire), std::exception);
+
+            // full load
+            auto full = loadAggregationScenarioDataBinary(filename, false);
+            BOOST_CHECK(full->keys() == data.keys());
+            for (auto const& [type, q] : data.keys())
+                check(*full, type, q);
+        }
+    }
+
+    boost::filesystem::remove(filename);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
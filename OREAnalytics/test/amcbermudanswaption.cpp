@@ -794,6 +794,189 @@ BOOST_DATA_TEST_CASE(testBermudanSwaptionExposure, boost::unit_test::data::make(
 
 } // testBermudanSwaptionExposure
 
+BOOST_AUTO_TEST_CASE(testSinglePrecisionPathsExposure) {
+
+    BOOST_TEST_MESSAGE("Testing Bermudan swaption exposure with single precision paths against double precision paths");
+
+    // Simulation date grid, coarse grid 6m spacing
+    Date today = referenceDate;
+    Calendar cal = JointCalendar(UnitedStates(UnitedStates::Settlement), UnitedKingdom());
+    std::vector<Period> tenorGrid;
+    for (Size i = 0; i < 2 * 21; ++i)
+        tenorGrid.push_back(((i + 1) * 6) * Months);
+    auto grid = QuantLib::ext::make_shared<DateGrid>(tenorGrid, cal, ActualActual(ActualActual::ISDA));
+
+    auto sgd = QuantLib::ext::make_shared<ScenarioGeneratorData>();
+    sgd->sequenceType() = SobolBrownianBridge;
+    sgd->seed() = 42;
+    sgd->setGrid(grid);
+
+    // USD Bermudan swaption 10y into 10y, so that the fx and ir state buffers of the amc valuation engine are used
+    Date startDate = cal.advance(today, 2 * Days);
+    Date fwdStartDate = cal.advance(startDate, 10 * Years);
+    Date endDate = cal.advance(fwdStartDate, 10 * Years);
+    Schedule fixedSchedule(fwdStartDate, endDate, 1 * Years, cal, Following, Following, DateGeneration::Forward, false);
+    Schedule floatingSchedule(fwdStartDate, endDate, 3 * Months, cal, Following, Following, DateGeneration::Forward,
+                              false);
+    auto underlying = QuantLib::ext::make_shared<VanillaSwap>(VanillaSwap::Payer, 1.0, fixedSchedule, 0.03,
+                                                              Thirty360(Thirty360::BondBasis), floatingSchedule,
+                                                              *market->iborIndex("USD-LIBOR-3M"), 0.0, Actual360());
+    std::vector<Date> exerciseDates;
+    for (Size i = 0; i < 10; ++i)
+        exerciseDates.push_back(grid->dates()[19 + 2 * i]);
+    auto swaption = QuantLib::ext::make_shared<Swaption>(underlying,
+                                                         QuantLib::ext::make_shared<BermudanExercise>(exerciseDates),
+                                                         Settlement::Physical, Settlement::PhysicalOTC);
+
+    class TestTrade : public Trade {
+    public:
+        TestTrade(const string& tradeType, const string& curr, const QuantLib::ext::shared_ptr<InstrumentWrapper>& inst)
+            : Trade(tradeType) {
+            instrument_ = inst;
+            npvCurrency_ = curr;
+        }
+        void build(const QuantLib::ext::shared_ptr<EngineFactory>&) override {}
+    };
+
+    // run the amc valuation and return the (discounted) epe profile
+    auto epeProfile = [&](const bool singlePrecisionPaths) {
+        swaption->setPricingEngine(QuantLib::ext::make_shared<McLgmSwaptionEngine>(
+            lgm_usd, MersenneTwisterAntithetic, SobolBrownianBridge, 2000, 0, 4711, 4712, 6, LsmBasisSystem::Monomial,
+            SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7, Handle<YieldTermStructure>(), grid->dates(),
+            std::vector<Size>{1}, true, McMultiLegBaseEngine::Simple, Null<Real>(), false, false,
+            singlePrecisionPaths));
+        AMCValuationEngine amcValEngine(ccLgm, sgd, QuantLib::ext::shared_ptr<Market>(), std::vector<string>(),
+                                        std::vector<string>(), 0, singlePrecisionPaths);
+        auto trade = QuantLib::ext::make_shared<TestTrade>("BermudanSwaption", "USD",
+                                                           QuantLib::ext::make_shared<VanillaInstrument>(swaption));
+        trade->id() = "DummyTradeId";
+        auto portfolio = QuantLib::ext::make_shared<Portfolio>();
+        portfolio->add(trade);
+        Size samples = 1000;
+        QuantLib::ext::shared_ptr<NPVCube> outputCube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(
+            referenceDate, std::set<string>{"DummyTradeId"}, grid->dates(), samples);
+        amcValEngine.buildCube(portfolio, outputCube);
+        std::vector<Real> epe(grid->dates().size(), 0.0);
+        for (Size j = 0; j < grid->dates().size(); ++j) {
+            for (Size i = 0; i < samples; ++i)
+                epe[j] += std::max(outputCube->get(0, j, i, 0), 0.0);
+            epe[j] /= static_cast<Real>(samples);
+        }
+        return epe;
+    };
+
+    std::vector<Real> epeDouble = epeProfile(false);
+    std::vector<Real> epeSingle = epeProfile(true);
+
+    Real tolerance = 1E-5, maxDiff = 0.0;
+    for (Size i = 0; i < epeDouble.size(); ++i) {
+        BOOST_CHECK_MESSAGE(std::abs(epeDouble[i] - epeSingle[i]) <= tolerance,
+                            "Can not verify swaption epe at grid point t="
+                                << grid->timeGrid()[i + 1] << ", double precision = " << epeDouble[i]
+                                << ", single precision = " << epeSingle[i] << ", difference "
+                                << (epeDouble[i] - epeSingle[i]) << ", tolerance " << tolerance);
+        maxDiff = std::max(maxDiff, std::abs(epeDouble[i] - epeSingle[i]));
+    }
+    BOOST_TEST_MESSAGE("Max difference in swaption epe between single and double precision paths = " << maxDiff);
+
+} // testSinglePrecisionPathsExposure
+
+BOOST_AUTO_TEST_CASE(testProjectedModelExposure) {
+
+    BOOST_TEST_MESSAGE("Testing Bermudan swaption exposure with projected model against full model simulation");
+
+    // Simulation date grid, coarse grid 6m spacing
+    Date today = referenceDate;
+    Calendar cal = TARGET();
+    std::vector<Period> tenorGrid;
+    for (Size i = 0; i < 2 * 21; ++i)
+        tenorGrid.push_back(((i + 1) * 6) * Months);
+    auto grid = QuantLib::ext::make_shared<DateGrid>(tenorGrid, cal, ActualActual(ActualActual::ISDA));
+
+    auto sgd = QuantLib::ext::make_shared<ScenarioGeneratorData>();
+    sgd->sequenceType() = SobolBrownianBridge;
+    sgd->seed() = 42;
+    sgd->setGrid(grid);
+
+    // EUR Bermudan swaption 10y into 10y, only the EUR IR component of the EUR-USD model is required
+    Date startDate = cal.advance(today, 2 * Days);
+    Date fwdStartDate = cal.advance(startDate, 10 * Years);
+    Date endDate = cal.advance(fwdStartDate, 10 * Years);
+    Schedule fixedSchedule(fwdStartDate, endDate, 1 * Years, cal, Following, Following, DateGeneration::Forward, false);
+    Schedule floatingSchedule(fwdStartDate, endDate, 6 * Months, cal, Following, Following, DateGeneration::Forward,
+                              false);
+    auto underlying = QuantLib::ext::make_shared<VanillaSwap>(VanillaSwap::Payer, 1.0, fixedSchedule, 0.03,
+                                                              Thirty360(Thirty360::BondBasis), floatingSchedule,
+                                                              *market->iborIndex("EUR-EURIBOR-6M"), 0.0, Actual360());
+    std::vector<Date> exerciseDates;
+    for (Size i = 0; i < 10; ++i)
+        exerciseDates.push_back(grid->dates()[19 + 2 * i]);
+    auto swaption = QuantLib::ext::make_shared<Swaption>(underlying,
+                                                         QuantLib::ext::make_shared<BermudanExercise>(exerciseDates),
+                                                         Settlement::Physical, Settlement::PhysicalOTC);
+    swaption->setPricingEngine(QuantLib::ext::make_shared<McLgmSwaptionEngine>(
+        lgm_eur, MersenneTwisterAntithetic, SobolBrownianBridge, 2000, 0, 4711, 4712, 6, LsmBasisSystem::Monomial,
+        SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7, Handle<YieldTermStructure>(), grid->dates(),
+        std::vector<Size>{0}));
+
+    class TestTrade : public Trade {
+    public:
+        TestTrade(const string& tradeType, const string& curr, const QuantLib::ext::shared_ptr<InstrumentWrapper>& inst)
+            : Trade(tradeType) {
+            instrument_ = inst;
+            npvCurrency_ = curr;
+        }
+        void build(const QuantLib::ext::shared_ptr<EngineFactory>&) override {}
+    };
+
+    // run the amc valuation and return the (discounted) epe profile and its standard error
+    Size samples = 2000;
+    auto epeProfile = [&](const bool projectModel) {
+        AMCValuationEngine amcValEngine(ccLgm, sgd, QuantLib::ext::shared_ptr<Market>(), std::vector<string>(),
+                                        std::vector<string>(), 0, false, projectModel);
+        auto trade = QuantLib::ext::make_shared<TestTrade>("BermudanSwaption", "EUR",
+                                                           QuantLib::ext::make_shared<VanillaInstrument>(swaption));
+        trade->id() = "DummyTradeId";
+        auto portfolio = QuantLib::ext::make_shared<Portfolio>();
+        portfolio->add(trade);
+        QuantLib::ext::shared_ptr<NPVCube> outputCube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(
+            referenceDate, std::set<string>{"DummyTradeId"}, grid->dates(), samples);
+        amcValEngine.buildCube(portfolio, outputCube);
+        std::vector<std::pair<Real, Real>> epe(grid->dates().size(), {0.0, 0.0});
+        for (Size j = 0; j < grid->dates().size(); ++j) {
+            Real sum = 0.0, sum2 = 0.0;
+            for (Size i = 0; i < samples; ++i) {
+                Real v = std::max(outputCube->get(0, j, i, 0), 0.0);
+                sum += v;
+                sum2 += v * v;
+            }
+            Real mean = sum / static_cast<Real>(samples);
+            Real var = std::max(sum2 / static_cast<Real>(samples) - mean * mean, 0.0);
+            epe[j] = std::make_pair(mean, std::sqrt(var / static_cast<Real>(samples)));
+        }
+        return epe;
+    };
+
+    auto epeFull = epeProfile(false);
+    auto epeProjected = epeProfile(true);
+
+    // the projected model generates different paths, so we compare within the mc error
+    Real maxDiff = 0.0;
+    for (Size i = 0; i < epeFull.size(); ++i) {
+        Real diff = std::abs(epeFull[i].first - epeProjected[i].first);
+        Real tolerance = 5.0 * std::sqrt(epeFull[i].second * epeFull[i].second +
+                                         epeProjected[i].second * epeProjected[i].second) +
+                         1E-6;
+        BOOST_CHECK_MESSAGE(diff <= tolerance, "Can not verify swaption epe at grid point t="
+                                                   << grid->timeGrid()[i + 1] << ", full model = " << epeFull[i].first
+                                                   << ", projected model = " << epeProjected[i].first
+                                                   << ", difference " << diff << ", tolerance " << tolerance);
+        maxDiff = std::max(maxDiff, diff);
+    }
+    BOOST_TEST_MESSAGE("Max difference in swaption epe between full and projected model = " << maxDiff);
+
+} // testProjectedModelExposure
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -17,11 +17,17 @@
 */
 
 #include <boost/filesystem.hpp>
+#include <cstdint>
 #include <boost/test/unit_test.hpp>
+#include <orea/cube/flatinmemorycube.hpp>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/cube_io.hpp>
+#include <orea/cube/cubelayout.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/jaggedcube.hpp>
+#include <orea/cube/jointnpvcube.hpp>
+#include <orea/cube/mappedfilecube.hpp>
+#include <orea/cube/sparsenpvcube.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/parametricvar.hpp>
@@ -442,6 +448,48 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeN) {
     testCube(c, "DoublePrecisionInMemoryCubeN", 1e-14);
 }
 
+BOOST_AUTO_TEST_CASE(testSinglePrecisionFlatInMemoryCube) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    vector<Date> dates(50, Date());
+    Size samples = 200;
+    Size depth = 3;
+    SinglePrecisionFlatInMemoryCube c1(Date(), ids, dates, samples, depth, 0.0f, FlatCubeLayout::TradeMajor);
+    testCube(c1, "SinglePrecisionFlatInMemoryCube (TradeMajor)", 1e-5);
+    SinglePrecisionFlatInMemoryCube c2(Date(), ids, dates, samples, depth, 0.0f, FlatCubeLayout::SampleMajor);
+    testCube(c2, "SinglePrecisionFlatInMemoryCube (SampleMajor)", 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(testDoublePrecisionFlatInMemoryCube) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    vector<Date> dates(50, Date());
+    Size samples = 200;
+    Size depth = 3;
+    DoublePrecisionFlatInMemoryCube c1(Date(), ids, dates, samples, depth, 0.0, FlatCubeLayout::TradeMajor);
+    testCube(c1, "DoublePrecisionFlatInMemoryCube (TradeMajor)", 1e-14);
+    DoublePrecisionFlatInMemoryCube c2(Date(), ids, dates, samples, depth, 0.0, FlatCubeLayout::SampleMajor);
+    testCube(c2, "DoublePrecisionFlatInMemoryCube (SampleMajor)", 1e-14);
+
+    // the data block is cache line aligned and the layouts differ in the position of the values only
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(c1.data()) % DoublePrecisionFlatInMemoryCube::alignment, 0u);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(c2.data()) % DoublePrecisionFlatInMemoryCube::alignment, 0u);
+    BOOST_CHECK_EQUAL(c1.index(0, 0, 1, 0), depth);
+    BOOST_CHECK_EQUAL(c2.index(1, 0, 0, 0), depth);
+}
+
+BOOST_AUTO_TEST_CASE(testFlatInMemoryCubeFactory) {
+    std::set<string> ids{string("id1"), string("id2")};
+    Date d(1, QuantLib::Jan, 2016);
+    vector<Date> dates(10, d);
+    auto factory = flatInMemoryCubeFactory<float>(2, FlatCubeLayout::SampleMajor);
+    auto cube = factory(d, ids, dates, 100);
+    BOOST_REQUIRE(cube != nullptr);
+    BOOST_CHECK_EQUAL(cube->numIds(), 2);
+    BOOST_CHECK_EQUAL(cube->numDates(), 10);
+    BOOST_CHECK_EQUAL(cube->samples(), 100);
+    BOOST_CHECK_EQUAL(cube->depth(), 2);
+    testCube(*cube, "FlatInMemoryCube from factory", 1e-5);
+}
+
 BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeFileIO) {
     std::set<string> ids{string("id")}; // the overlap doesn't matter
     Date d(1, QuantLib::Jan, 2016);        // need a real date here
@@ -461,6 +509,163 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeFileNIO) {
     testCubeFileIO<DoublePrecisionInMemoryCubeN>(c, "DoublePrecisionInMemoryCubeN", 1e-14, true);
 }
 
+BOOST_AUTO_TEST_CASE(testMappedFileCube) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    Date d(1, QuantLib::Jan, 2016);
+    vector<Date> dates(20, d);
+    Size samples = 100;
+    Size depth = 2;
+    string filename = boost::filesystem::unique_path().string();
+
+    // mini-cubes writing into disjoint regions of the same file
+    auto factory = mappedFileCubeFactory(filename, ids, depth, true);
+    auto c1 = factory(d, {"id1", "id3"}, dates, samples);
+    auto c2 = factory(d, {"id2"}, dates, samples);
+    testCube(*c1, "MappedFileNPVCube (view 1)", 1e-14);
+    testCube(*c2, "MappedFileNPVCube (view 2)", 1e-14);
+    c1.reset();
+    c2.reset();
+
+    // the full file read back through loadCube()
+    auto cube = loadCube(filename).cube;
+    BOOST_REQUIRE(QuantLib::ext::dynamic_pointer_cast<MappedFileNPVCube>(cube) != nullptr);
+    BOOST_CHECK_EQUAL(cube->numIds(), 3);
+    BOOST_CHECK_EQUAL(cube->numDates(), 20);
+    BOOST_CHECK_EQUAL(cube->samples(), samples);
+    BOOST_CHECK_EQUAL(cube->depth(), depth);
+    for (Size j = 0; j < cube->numDates(); ++j) {
+        for (Size k = 0; k < cube->samples(); ++k) {
+            for (Size dd = 0; dd < cube->depth(); ++dd) {
+                BOOST_CHECK_CLOSE(cube->get(cube->getTradeIndex("id1"), j, k, dd), j + k / 1000000.0 + dd * 3, 1e-14);
+                BOOST_CHECK_CLOSE(cube->get(cube->getTradeIndex("id2"), j, k, dd), j + k / 1000000.0 + dd * 3, 1e-14);
+                BOOST_CHECK_CLOSE(cube->get(cube->getTradeIndex("id3"), j, k, dd),
+                                  1000000.0 + j + k / 1000000.0 + dd * 3, 1e-14);
+            }
+        }
+    }
+
+    // the cube is read only
+    BOOST_CHECK_THROW(cube->set(1.0, 0, 0, 0), std::exception);
+    cube.reset();
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(testBinaryCubeFileIO) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    Date d(1, QuantLib::Jan, 2016);
+    vector<Date> dates;
+    for (Size j = 0; j < 20; ++j)
+        dates.push_back(d + static_cast<QuantLib::Integer>(j) * QuantLib::Months);
+    Size samples = 100;
+    Size depth = 2;
+    auto cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(d, ids, dates, samples, depth);
+    initCube(*cube);
+    for (Size i = 0; i < cube->numIds(); ++i)
+        cube->setT0(i + 0.5, i, 1);
+
+    string filename = boost::filesystem::unique_path().string();
+    saveCubeBinary(filename, NPVCubeWithMetaData{cube, nullptr, true, boost::none}, true, false);
+
+    // full cube via loadCube(), read with several threads via loadCubeBinary()
+    for (auto const& c : {loadCube(filename, true), loadCubeBinary(filename, true, {}, {}, 4)}) {
+        BOOST_REQUIRE(c.cube != nullptr);
+        BOOST_REQUIRE(c.storeFlows);
+        BOOST_CHECK(*c.storeFlows);
+        BOOST_CHECK(!c.storeCreditStateNPVs);
+        BOOST_CHECK_EQUAL(c.cube->numIds(), cube->numIds());
+        BOOST_CHECK_EQUAL(c.cube->numDates(), cube->numDates());
+        BOOST_CHECK_EQUAL(c.cube->samples(), cube->samples());
+        BOOST_CHECK_EQUAL(c.cube->depth(), cube->depth());
+        checkCube(*c.cube, 1e-14);
+        BOOST_CHECK_CLOSE(c.cube->getT0(2, 1), 2.5, 1e-14);
+    }
+
+    // subset of ids and dates
+    auto sub = loadCubeBinary(filename, true, {"id2"}, {dates[3], dates[7]}, 2).cube;
+    BOOST_CHECK_EQUAL(sub->numIds(), 1);
+    BOOST_REQUIRE_EQUAL(sub->numDates(), 2);
+    BOOST_CHECK_EQUAL(sub->dates()[0], dates[3]);
+    BOOST_CHECK_EQUAL(sub->dates()[1], dates[7]);
+    for (Size k = 0; k < samples; ++k) {
+        for (Size dd = 0; dd < depth; ++dd) {
+            BOOST_CHECK_CLOSE(sub->get(0, 0, k, dd), cube->get(1, 3, k, dd), 1e-14);
+            BOOST_CHECK_CLOSE(sub->get(0, 1, k, dd), cube->get(1, 7, k, dd), 1e-14);
+        }
+    }
+    BOOST_CHECK_THROW(loadCubeBinary(filename, true, {"unknown"}), std::exception);
+
+    boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(testMergeCubes) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    Date d(1, QuantLib::Jan, 2016);
+    vector<Date> dates;
+    for (Size j = 0; j < 5; ++j)
+        dates.push_back(d + static_cast<QuantLib::Integer>(j) * QuantLib::Months);
+    Size depth = 2;
+    auto value = [](Size i, Size j, Size k, Size dd) { return i * 1000.0 + j * 100.0 + k + dd * 0.5; };
+
+    // two partial cubes covering the samples 10, ..., 39 and 40, ..., 109
+    std::vector<NPVCubeWithMetaData> cubes;
+    std::vector<QuantLib::ext::shared_ptr<AggregationScenarioData>> asd;
+    Size firstSample = 10;
+    for (Size samples : {30, 70}) {
+        auto cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(d, ids, dates, samples, depth);
+        auto data = QuantLib::ext::make_shared<InMemoryAggregationScenarioData>(dates.size(), samples);
+        for (Size i = 0; i < ids.size(); ++i) {
+            cube->setT0(i + 0.25, i, 0);
+            for (Size j = 0; j < dates.size(); ++j) {
+                for (Size k = 0; k < samples; ++k) {
+                    for (Size dd = 0; dd < depth; ++dd)
+                        cube->set(value(i, j, firstSample + k, dd), i, j, k, dd);
+                    data->set(j, k, value(0, j, firstSample + k, 0), AggregationScenarioDataType::Numeraire);
+                }
+            }
+        }
+        auto sgd = QuantLib::ext::make_shared<ScenarioGeneratorData>();
+        sgd->seed() = 42;
+        sgd->samples() = samples;
+        sgd->firstSample() = firstSample;
+        cubes.push_back(NPVCubeWithMetaData{cube, sgd, true, boost::none});
+        asd.push_back(data);
+        firstSample += samples;
+    }
+
+    auto merged = mergeCubes(cubes, true);
+    BOOST_REQUIRE(merged.cube != nullptr);
+    BOOST_REQUIRE(merged.scenarioGeneratorData != nullptr);
+    BOOST_CHECK_EQUAL(merged.scenarioGeneratorData->firstSample(), 10);
+    BOOST_CHECK_EQUAL(merged.scenarioGeneratorData->samples(), 100);
+    BOOST_REQUIRE(merged.storeFlows);
+    BOOST_CHECK(*merged.storeFlows);
+    BOOST_REQUIRE_EQUAL(merged.cube->samples(), 100);
+    BOOST_CHECK_EQUAL(merged.cube->numIds(), ids.size());
+    BOOST_CHECK_EQUAL(merged.cube->numDates(), dates.size());
+    BOOST_CHECK_EQUAL(merged.cube->depth(), depth);
+    for (Size i = 0; i < ids.size(); ++i) {
+        BOOST_CHECK_EQUAL(merged.cube->getT0(i, 0), i + 0.25);
+        for (Size j = 0; j < dates.size(); ++j) {
+            for (Size k = 0; k < 100; ++k) {
+                for (Size dd = 0; dd < depth; ++dd)
+                    BOOST_CHECK_EQUAL(merged.cube->get(i, j, k, dd), value(i, j, 10 + k, dd));
+            }
+        }
+    }
+
+    auto mergedAsd = mergeAggregationScenarioData(asd);
+    BOOST_REQUIRE_EQUAL(mergedAsd->dimSamples(), 100);
+    BOOST_CHECK_EQUAL(mergedAsd->dimDates(), dates.size());
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < 100; ++k)
+            BOOST_CHECK_EQUAL(mergedAsd->get(j, k, AggregationScenarioDataType::Numeraire), value(0, j, 10 + k, 0));
+    }
+
+    // the sample ranges must be contiguous and in order
+    std::swap(cubes[0], cubes[1]);
+    BOOST_CHECK_THROW(mergeCubes(cubes), std::exception);
+}
+
 BOOST_AUTO_TEST_CASE(testInMemoryCubeGetSetbyDateID) {
     std::set<string> ids = {"id1", "id2", "id3"}; // the overlap doesn't matter
     Date today = Date::todaysDate();
@@ -539,6 +744,26 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionJaggedCube) {
     IndexManager::instance().clearHistories();
 }
 
+BOOST_AUTO_TEST_CASE(testSinglePrecisionCubeWithSparseIds) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    vector<Date> dates(20, Date());
+    Size samples = 50;
+    Size depth = 3;
+    auto cube = createSinglePrecisionCube(Date(), ids, dates, samples, depth, {string("id2")});
+    BOOST_REQUIRE(QuantLib::ext::dynamic_pointer_cast<JointNPVCube>(cube));
+    BOOST_CHECK_EQUAL(cube->numIds(), ids.size());
+    testCube(*cube, "SinglePrecisionCubeWithSparseIds", 1e-5);
+
+    // overwriting an entry with zero must remove the previous value from the sparse cube
+    SinglePrecisionSparseNpvCube sparse(Date(), ids, dates, samples, depth);
+    sparse.set(1.0, 1, 2, 3, 1);
+    sparse.setT0(2.0, 1, 0);
+    sparse.set(0.0, 1, 2, 3, 1);
+    sparse.setT0(0.0, 1, 0);
+    BOOST_CHECK_EQUAL(sparse.get(1, 2, 3, 1), 0.0);
+    BOOST_CHECK_EQUAL(sparse.getT0(1, 0), 0.0);
+}
+
 string writeCube(const QuantLib::ext::shared_ptr<NPVCube>& cube, Size bufferSize) {
     auto report = QuantLib::ext::make_shared<InMemoryReport>(bufferSize);
     ReportWriter().writeCube(*report, cube);
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/engine/cubecostestimator.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <test/oreatoplevelfixture.hpp>
+#include "testportfolio.hpp"
+
+using namespace ore::analytics;
+using namespace ore::data;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(CubeCostEstimatorTest)
+
+BOOST_AUTO_TEST_CASE(testEstimate) {
+
+    BOOST_TEST_MESSAGE("Testing cube cost estimator...");
+
+    auto portfolio = QuantLib::ext::make_shared<Portfolio>();
+    for (Size i = 0; i < 12; ++i)
+        portfolio->add(testsuite::buildSwap("swap_" + std::to_string(10 + i), "EUR", true, 1E6, 0, 10, 0.02, 0.0,
+                                            "1Y", "30/360", "6M", "A360", "EUR-EURIBOR-6M"));
+    for (Size i = 0; i < 3; ++i)
+        portfolio->add(testsuite::buildFxOption("fxo_" + std::to_string(i), "Long", "Call", 1, "USD", 1E6, "EUR",
+                                                1E6));
+
+    CubeCostEstimator estimator(portfolio, 4);
+    auto sample = estimator.samplePortfolio();
+    BOOST_REQUIRE_EQUAL(sample->size(), 7u);
+    // the swaps are sampled evenly spaced
+    for (auto const& id : {"swap_11", "swap_14", "swap_17", "swap_20"})
+        BOOST_CHECK(sample->has(id));
+
+    // pricing time of 1ms (swaps) resp. 2ms (fx options) per trade and sample over 2 samples
+    for (auto const& [id, t] : sample->trades())
+        t->resetPricingStats(2, t->tradeType() == "Swap" ? 2000000 : 4000000);
+
+    CubeCostEstimate e;
+    e.dates = 10;
+    e.samples = 1000;
+    e.threads = 4;
+    e.maxThreads = 8;
+    e.timeBudget = 10.0;
+    e.estimationSamples = 2;
+    e.estimationTime = 0.05;
+    e.setupTime = 1.0;
+    e.estimationScenarioDataBytes = 1000;
+    estimator.estimate(e);
+
+    Real tol = 1E-10;
+    BOOST_REQUIRE_EQUAL(e.tradeTypes.size(), 2u);
+    BOOST_CHECK_EQUAL(e.tradeTypes["Swap"].trades, 12u);
+    BOOST_CHECK_EQUAL(e.tradeTypes["Swap"].sampledTrades, 4u);
+    BOOST_CHECK_CLOSE(e.tradeTypes["Swap"].timePerTradeAndSample, 1E-3, tol);
+    BOOST_CHECK_CLOSE(e.tradeTypes["Swap"].pricingTime, 12.0, tol);
+    BOOST_CHECK_EQUAL(e.tradeTypes["FxOption"].trades, 3u);
+    BOOST_CHECK_CLOSE(e.tradeTypes["FxOption"].pricingTime, 6.0, tol);
+
+    // the time not spent in pricing is 0.03s over 2 samples
+    BOOST_CHECK_CLOSE(e.overheadPerSample, 0.015, tol);
+    BOOST_CHECK_CLOSE(e.cpuTime, 33.0, tol);
+    BOOST_CHECK_CLOSE(e.wallTime, 1.0 + 33.0 / 4.0, tol);
+    BOOST_CHECK_EQUAL(e.cubeBytes, 15 * (10 * 1000 + 1) * sizeof(float));
+    BOOST_CHECK_EQUAL(e.scenarioDataBytes, 500000u);
+    BOOST_CHECK_EQUAL(e.suggestedThreads, 4u);
+    BOOST_CHECK_EQUAL(e.suggestedSampleChunks, 1u);
+
+    // no number of threads meets the budget, the samples must be split into 3 chunks of 2s on 8 threads
+    e.timeBudget = 3.0;
+    estimator.estimate(e);
+    BOOST_CHECK_EQUAL(e.suggestedThreads, 8u);
+    BOOST_CHECK_EQUAL(e.suggestedSampleChunks, 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
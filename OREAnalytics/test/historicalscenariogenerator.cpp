@@ -7,6 +7,10 @@
 #include <orea/scenario/simplescenario.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <orea/scenario/historicalscenariogenerator.hpp>
+#include <orea/scenario/historicalscenarioloader.hpp>
+#include <orea/scenario/historicalscenariostore.hpp>
+
+#include <boost/filesystem.hpp>
 
 #include "testmarket.hpp"
 
@@ -22,6 +26,31 @@ BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::TopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(HistoricalScenarioGeneratorTest)
 
+namespace {
+// reader on a given vector of scenarios
+class VectorScenarioReader : public HistoricalScenarioReader {
+public:
+    explicit VectorScenarioReader(const vector<QuantLib::ext::shared_ptr<Scenario>>& scenarios)
+        : scenarios_(scenarios) {}
+    bool next() override {
+        current_ = started_ ? current_ + 1 : 0;
+        started_ = true;
+        return current_ < scenarios_.size();
+    }
+    Date date() const override {
+        return started_ && current_ < scenarios_.size() ? scenarios_[current_]->asof() : Null<Date>();
+    }
+    QuantLib::ext::shared_ptr<Scenario> scenario() const override {
+        return started_ && current_ < scenarios_.size() ? scenarios_[current_] : nullptr;
+    }
+
+private:
+    vector<QuantLib::ext::shared_ptr<Scenario>> scenarios_;
+    Size current_ = 0;
+    bool started_ = false;
+};
+} // namespace
+
 BOOST_AUTO_TEST_CASE(testHistoricalScenarioGeneratorTransform) {
 
     BOOST_TEST_MESSAGE(
@@ -105,6 +134,63 @@ BOOST_AUTO_TEST_CASE(testHistoricalScenarioGeneratorTransform) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testHistoricalScenarioStore) {
+
+    BOOST_TEST_MESSAGE("Checking round trip of historical scenarios through the binary scenario store...");
+
+    vector<RiskFactorKey> keys = {{RiskFactorKey::KeyType::DiscountCurve, "EUR", 0},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "EUR", 1},
+                                  {RiskFactorKey::KeyType::FXSpot, "USDEUR", 0},
+                                  {RiskFactorKey::KeyType::SurvivalProbability, "dc", 0}};
+
+    vector<QuantLib::ext::shared_ptr<Scenario>> scenarios;
+    Date d(14, April, 2016);
+    for (Size i = 0; i < 5; ++i) {
+        auto s = QuantLib::ext::make_shared<SimpleScenario>(d + i, "", 1.0 + 0.1 * i);
+        for (Size k = 0; k < keys.size(); ++k) {
+            // the fx spot is missing in the third scenario
+            if (i != 2 || k != 2)
+                s->add(keys[k], 0.9 + 0.01 * i + 0.001 * k);
+        }
+        scenarios.push_back(s);
+    }
+
+    for (bool doublePrecision : {true, false}) {
+        string filename = boost::filesystem::unique_path().string();
+        VectorScenarioReader reader(scenarios);
+        BOOST_CHECK_EQUAL(writeHistoricalScenarioStore(filename, reader, keys, doublePrecision), scenarios.size());
+        BOOST_CHECK(isHistoricalScenarioStore(filename));
+
+        // tolerance in percent
+        Real tol = doublePrecision ? 1E-12 : 1E-4;
+        {
+            auto store = QuantLib::ext::make_shared<HistoricalScenarioStore>(filename);
+            BOOST_CHECK_EQUAL(store->doublePrecision(), doublePrecision);
+            BOOST_REQUIRE_EQUAL(store->keys().size(), keys.size());
+            BOOST_REQUIRE_EQUAL(store->dates().size(), scenarios.size());
+
+            // load a sub period through the reader and compare with the original scenarios
+            HistoricalScenarioLoader loader(QuantLib::ext::make_shared<HistoricalScenarioStoreReader>(
+                                                store, QuantLib::ext::make_shared<SimpleScenarioFactory>(false)),
+                                            d + 1, d + 3, NullCalendar());
+            BOOST_REQUIRE_EQUAL(loader.numScenarios(), Size(3));
+            for (Size i = 0; i < loader.numScenarios(); ++i) {
+                auto const& expected = scenarios[i + 1];
+                auto const& s = loader.historicalScenarios()[i];
+                BOOST_CHECK_EQUAL(loader.dates()[i], expected->asof());
+                BOOST_CHECK_CLOSE(s->getNumeraire(), expected->getNumeraire(), tol);
+                BOOST_CHECK_EQUAL(s->keys().size(), expected->keys().size());
+                for (auto const& k : keys) {
+                    BOOST_CHECK_EQUAL(s->has(k), expected->has(k));
+                    if (expected->has(k))
+                        BOOST_CHECK_CLOSE(s->get(k), expected->get(k), tol);
+                }
+            }
+        }
+        boost::filesystem::remove(filename);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics.hpp>
+#include <boost/accumulators/statistics/tail_quantile.hpp>
+#include <boost/test/unit_test.hpp>
+#include <orea/engine/historicalsimulationvar.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace ore::analytics;
+using namespace boost::accumulators;
+using QuantLib::Real;
+using QuantLib::Size;
+
+namespace {
+
+// the quantile as computed by the boost tail_quantile accumulator
+Real tailQuantile(const std::vector<Real>& pnls, Real confidence, bool isCall) {
+    Size c = static_cast<Size>(std::floor(pnls.size() * (1.0 - confidence) + 0.5)) + 2;
+    typedef accumulator_set<double, stats<boost::accumulators::tag::tail_quantile<boost::accumulators::right>>>
+        accumulator;
+    accumulator acc(boost::accumulators::tag::tail<boost::accumulators::right>::cache_size = c);
+    for (auto const& p : pnls)
+        acc(isCall ? p : -p);
+    return quantile(acc, quantile_probability = confidence);
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(HistoricalSimulationVarTest)
+
+BOOST_AUTO_TEST_CASE(testVarAndExpectedShortfall) {
+
+    BOOST_TEST_MESSAGE("Testing historical simulation VaR and expected shortfall against boost tail quantile...");
+
+    QuantLib::MersenneTwisterUniformRng rng(42);
+    std::vector<Real> confidences = {0.99, 0.975, 0.95, 0.5, 0.999, 0.99};
+
+    for (Size n : {10, 250, 251, 1000}) {
+        std::vector<Real> pnls(n);
+        // round half of the samples to produce ties
+        for (Size i = 0; i < n; ++i)
+            pnls[i] = i % 2 == 0 ? 1000.0 * (rng.nextReal() - 0.5) : std::round(100.0 * (rng.nextReal() - 0.5));
+
+        HistoricalSimulationVarCalculator calc(pnls);
+        for (bool isCall : {true, false}) {
+            std::vector<Real> var = calc.vars(confidences, isCall);
+            std::vector<Real> es = calc.expectedShortfalls(confidences, isCall);
+            BOOST_REQUIRE_EQUAL(var.size(), confidences.size());
+            BOOST_REQUIRE_EQUAL(es.size(), confidences.size());
+
+            std::vector<Real> sorted(pnls);
+            for (auto& p : sorted)
+                p = isCall ? p : -p;
+            std::sort(sorted.begin(), sorted.end(), std::greater<Real>());
+
+            for (Size i = 0; i < confidences.size(); ++i) {
+                BOOST_CHECK_EQUAL(var[i], tailQuantile(pnls, confidences[i], isCall));
+                BOOST_CHECK_EQUAL(calc.var(confidences[i], isCall), var[i]);
+                Size r = std::max<Size>(static_cast<Size>(std::ceil(n * (1.0 - confidences[i]))), 1);
+                Real expected = 0.0;
+                for (Size k = 0; k < r; ++k)
+                    expected += sorted[k];
+                expected /= static_cast<Real>(r);
+                BOOST_CHECK_CLOSE(es[i], expected, 1E-10);
+                BOOST_CHECK_CLOSE(calc.expectedShortfall(confidences[i], isCall), expected, 1E-10);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
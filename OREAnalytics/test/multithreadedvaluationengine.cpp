@@ -0,0 +1,266 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/cubelayout.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/multithreadedvaluationengine.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/crossassetmodelscenariogenerator.hpp>
+#include <orea/scenario/scenariofilter.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
+#include <ored/configuration/conventions.hpp>
+#include <ored/configuration/curveconfigurations.hpp>
+#include <ored/marketdata/csvloader.hpp>
+#include <ored/marketdata/todaysmarket.hpp>
+#include <ored/marketdata/todaysmarketparameters.hpp>
+#include <ored/model/crossassetmodelbuilder.hpp>
+#include <ored/model/irlgmdata.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/osutils.hpp>
+#include <oret/datapaths.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace boost::unit_test_framework;
+using namespace ore;
+using namespace ore::data;
+using namespace ore::analytics;
+
+namespace {
+
+/* market, model and scenario generator on a EUR-EURIBOR-6M single curve setup, the swaps in the portfolio started in
+   the past, so that their current floating coupons require the fixings from the loader */
+struct TestData {
+    TestData() : asof(31, Dec, 2018), dateGrid(QuantLib::ext::make_shared<DateGrid>("10,6M")), samples(20) {
+        Settings::instance().evaluationDate() = asof;
+
+        auto conventions = QuantLib::ext::make_shared<Conventions>();
+        conventions->fromFile(TEST_INPUT_FILE("conventions.xml"));
+        InstrumentConventions::instance().setConventions(conventions);
+
+        todaysMarketParams = QuantLib::ext::make_shared<TodaysMarketParameters>();
+        todaysMarketParams->fromFile(TEST_INPUT_FILE("todaysmarket.xml"));
+        curveConfigs = QuantLib::ext::make_shared<CurveConfigurations>();
+        curveConfigs->fromFile(TEST_INPUT_FILE("curveconfig.xml"));
+        loader = QuantLib::ext::make_shared<CSVLoader>(TEST_INPUT_FILE("market.txt"), TEST_INPUT_FILE("fixings.txt"),
+                                                       false);
+        engineData = QuantLib::ext::make_shared<EngineData>();
+        engineData->fromFile(TEST_INPUT_FILE("pricingengine.xml"));
+
+        initMarket = QuantLib::ext::make_shared<TodaysMarket>(asof, todaysMarketParams, loader, curveConfigs, false);
+
+        simMarketParams = QuantLib::ext::make_shared<ScenarioSimMarketParameters>();
+        simMarketParams->baseCcy() = "EUR";
+        simMarketParams->setDiscountCurveNames({"EUR"});
+        simMarketParams->setYieldCurveTenors(
+            "", {3 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years, 20 * Years});
+        simMarketParams->setIndices({"EUR-EURIBOR-6M"});
+        simMarketParams->interpolation() = "LogLinear";
+
+        // an uncalibrated LGM model, no swaption vols are needed
+        std::vector<QuantLib::ext::shared_ptr<IrModelData>> irConfigs;
+        irConfigs.push_back(QuantLib::ext::make_shared<IrLgmData>(
+            "EUR", CalibrationType::None, LgmData::ReversionType::HullWhite, LgmData::VolatilityType::Hagan, false,
+            ParamType::Constant, std::vector<Time>(), std::vector<Real>{0.02}, false, ParamType::Constant,
+            std::vector<Time>(), std::vector<Real>{0.01}));
+        auto modelData = QuantLib::ext::make_shared<CrossAssetModelData>(
+            irConfigs, std::vector<QuantLib::ext::shared_ptr<FxBsData>>(),
+            std::map<CorrelationKey, Handle<Quote>>());
+        model = *CrossAssetModelBuilder(initMarket, modelData).model();
+
+        auto pathGen = QuantLib::ext::make_shared<MultiPathGeneratorMersenneTwister>(model->stateProcess(),
+                                                                                      dateGrid->timeGrid(), 42);
+        scenarioGenerator = QuantLib::ext::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGen, QuantLib::ext::make_shared<SimpleScenarioFactory>(true), simMarketParams, asof, dateGrid,
+            initMarket);
+    }
+
+    QuantLib::ext::shared_ptr<Portfolio> portfolio() const {
+        auto p = QuantLib::ext::make_shared<Portfolio>();
+        p->fromFile(TEST_INPUT_FILE("portfolio.xml"));
+        return p;
+    }
+
+    // single-threaded reference run on a sim market built on the init market of this session
+    QuantLib::ext::shared_ptr<NPVCube> referenceCube() const {
+        auto simMarket = QuantLib::ext::make_shared<ScenarioSimMarket>(
+            initMarket, simMarketParams, Market::defaultConfiguration, *curveConfigs, *todaysMarketParams, true);
+        simMarket->scenarioGenerator() = scenarioGenerator;
+        auto p = portfolio();
+        p->build(QuantLib::ext::make_shared<EngineFactory>(engineData, simMarket));
+        auto cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(asof, p->ids(), dateGrid->valuationDates(),
+                                                                            samples);
+        ValuationEngine engine(asof, dateGrid, simMarket);
+        engine.buildCube(p, cube, {QuantLib::ext::make_shared<NPVCalculator>("EUR")}, true);
+        return cube;
+    }
+
+    QuantLib::ext::shared_ptr<MultiThreadedValuationEngine>
+    engine(const Size nThreads,
+           const std::function<QuantLib::ext::shared_ptr<NPVCube>(const Date&, const std::set<std::string>&,
+                                                                  const std::vector<Date>&, const Size)>&
+               cubeFactory = {}) const {
+        return QuantLib::ext::make_shared<MultiThreadedValuationEngine>(
+            nThreads, asof, dateGrid, samples, loader, scenarioGenerator, engineData, curveConfigs,
+            todaysMarketParams, Market::defaultConfiguration, simMarketParams, false, false,
+            QuantLib::ext::make_shared<ScenarioFilter>(), nullptr, IborFallbackConfig::defaultConfig(), true, true,
+            true, cubeFactory);
+    }
+
+    Date asof;
+    QuantLib::ext::shared_ptr<DateGrid> dateGrid;
+    Size samples;
+    QuantLib::ext::shared_ptr<TodaysMarketParameters> todaysMarketParams;
+    QuantLib::ext::shared_ptr<CurveConfigurations> curveConfigs;
+    QuantLib::ext::shared_ptr<Loader> loader;
+    QuantLib::ext::shared_ptr<EngineData> engineData;
+    QuantLib::ext::shared_ptr<Market> initMarket;
+    QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketParams;
+    QuantLib::ext::shared_ptr<CrossAssetModel> model;
+    QuantLib::ext::shared_ptr<ScenarioGenerator> scenarioGenerator;
+};
+
+std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators() {
+    return {QuantLib::ext::make_shared<NPVCalculator>("EUR")};
+}
+
+/* check that the mini-cubes of a multi-threaded run cover the trades of the reference cube and match its values up to
+   the given relative tolerance */
+void checkCubes(const QuantLib::ext::shared_ptr<NPVCube>& reference,
+                const std::vector<QuantLib::ext::shared_ptr<NPVCube>>& miniCubes, const Real tolerance = 1E-10) {
+    Size nIds = 0;
+    for (auto const& c : miniCubes) {
+        BOOST_REQUIRE(c);
+        BOOST_REQUIRE_EQUAL(c->numDates(), reference->numDates());
+        BOOST_REQUIRE_EQUAL(c->samples(), reference->samples());
+        for (auto const& [id, i] : c->idsAndIndexes()) {
+            Size j = reference->idsAndIndexes().at(id);
+            Real r = reference->getT0(j);
+            BOOST_CHECK_SMALL(c->getT0(i) - r, tolerance * std::max(1.0, std::abs(r)));
+            for (Size k = 0; k < c->numDates(); ++k) {
+                for (Size l = 0; l < c->samples(); ++l) {
+                    r = reference->get(j, k, l);
+                    BOOST_CHECK_SMALL(c->get(i, k, l) - r, tolerance * std::max(1.0, std::abs(r)));
+                }
+            }
+            ++nIds;
+        }
+    }
+    BOOST_CHECK_EQUAL(nIds, reference->numIds());
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(MultiThreadedValuationEngineTest)
+
+BOOST_AUTO_TEST_CASE(testShareInitMarket) {
+
+    BOOST_TEST_MESSAGE("Testing multi-threaded valuation engine with shared init market against single-threaded run");
+
+    TestData td;
+    auto reference = td.referenceCube();
+    BOOST_REQUIRE_EQUAL(reference->numIds(), Size(8));
+
+    // worker processes sharing the init market of the calling thread, including its fixings
+
+    if (ore::data::os::forkSupported() && ore::data::os::getNumberOfThreads() <= 1) {
+        auto engine = td.engine(4);
+        engine->setMultiProcess(true);
+        engine->setShareInitMarket(true);
+        engine->buildCube(td.portfolio(), calculators);
+        checkCubes(reference, engine->outputCubes());
+    } else {
+        BOOST_TEST_MESSAGE("Worker processes not supported or other threads running, skip multi-process run");
+    }
+
+#ifdef QL_ENABLE_SESSIONS
+    // worker threads build their own todays market, even if sharing is requested
+    for (bool share : {false, true}) {
+        auto engine = td.engine(4);
+        engine->setShareInitMarket(share);
+        engine->buildCube(td.portfolio(), calculators);
+        checkCubes(reference, engine->outputCubes());
+    }
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(testWorkStealing) {
+
+    BOOST_TEST_MESSAGE("Testing multi-threaded valuation engine with work stealing against single-threaded run");
+
+#ifdef QL_ENABLE_SESSIONS
+    TestData td;
+    auto reference = td.referenceCube();
+
+    // two blocks of four trades, four sample ranges of five samples, more workers than blocks, so that the units of
+    // a block are valued concurrently
+    auto engine = td.engine(8);
+    engine->setWorkStealing(4, 5);
+    engine->buildCube(td.portfolio(), calculators);
+
+    BOOST_REQUIRE_EQUAL(engine->outputCubes().size(), Size(2));
+    checkCubes(reference, engine->outputCubes());
+
+    Size units = 0;
+    for (auto const& w : engine->workerStats())
+        units += w.units;
+    BOOST_CHECK_EQUAL(units, Size(8));
+#else
+    BOOST_TEST_MESSAGE("Work stealing requires a build with QL_ENABLE_SESSIONS = ON, skip test");
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(testWorkStealingSparseCubes) {
+
+    BOOST_TEST_MESSAGE("Testing multi-threaded valuation engine with work stealing into sparse cubes");
+
+#ifdef QL_ENABLE_SESSIONS
+    TestData td;
+    auto reference = td.referenceCube();
+
+    // block cubes as in the Auto cube layout, i.e. JointNPVCubes on a dense and a sparse cube, written by concurrent
+    // units of the same block
+    std::set<std::string> sparseIds = {"Swap_1", "Swap_4", "Swap_6", "Swap_7"};
+    auto engine = td.engine(8, [&sparseIds](const Date& asof, const std::set<std::string>& ids,
+                                            const std::vector<Date>& dates, const Size samples) {
+        return createSinglePrecisionCube(asof, ids, dates, samples, 1, sparseIds);
+    });
+    engine->setWorkStealing(4, 2);
+    engine->buildCube(td.portfolio(), calculators);
+
+    // single precision storage
+    checkCubes(reference, engine->outputCubes(), 1E-6);
+#else
+    BOOST_TEST_MESSAGE("Work stealing requires a build with QL_ENABLE_SESSIONS = ON, skip test");
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
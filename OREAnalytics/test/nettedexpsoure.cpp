@@ -56,8 +56,10 @@
 #include <ored/portfolio/nettingsetmanager.hpp>
 #include <orea/cube/cube_io.hpp>
 #include <orea/engine/mporcalculator.hpp>
+#include <orea/engine/observationmode.hpp>
 #include <ql/time/date.hpp>
 #include <ql/utilities/dataparsers.hpp>
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -698,5 +700,215 @@ BOOST_AUTO_TEST_CASE(NettedExposureCalculatorTest) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(SkipExpiredTradesStickyCloseOutTest) {
+
+    BOOST_TEST_MESSAGE("Running SkipExpiredTradesStickyCloseOutTest...");
+    Date referenceDate = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = referenceDate;
+
+    // the 1Y swap of the test portfolio matures between the second valuation date and its close-out date
+    Calendar cal = TARGET();
+    Date maturity = cal.adjust(cal.adjust(referenceDate) + 1 * Years, ModifiedFollowing);
+    std::vector<Date> dates = {cal.advance(referenceDate, 6 * Months), cal.advance(maturity, -2 * Days),
+                               cal.advance(maturity, 3 * Months)};
+    QuantLib::ext::shared_ptr<DateGrid> dateGrid = QuantLib::ext::make_shared<DateGrid>(dates);
+    dateGrid->addCloseOutDates(1 * Weeks);
+
+    TestData td(referenceDate, dateGrid, true, true);
+    QuantLib::ext::shared_ptr<Trade> trade = td.portfolio_->trades().begin()->second;
+    Date valueDate = dateGrid->valuationDates()[1];
+    BOOST_TEST_MESSAGE("Trade maturity " << io::iso_date(trade->maturity()) << ", value date "
+                                         << io::iso_date(valueDate) << ", close-out date "
+                                         << io::iso_date(dateGrid->closeOutDateFromValuationDate(valueDate)));
+    BOOST_REQUIRE(valueDate < trade->maturity() &&
+                  trade->maturity() <= dateGrid->closeOutDateFromValuationDate(valueDate));
+
+    // the sticky close-out valuations are done as of the value date, so the trade must not be skipped there
+    td.simMarket_->scenarioGenerator()->reset();
+    ValuationEngine valEngine(referenceDate, dateGrid, td.simMarket_);
+    valEngine.skipExpiredTrades(true);
+    QuantLib::ext::shared_ptr<NPVCube> cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(
+        referenceDate, td.portfolio_->ids(), dateGrid->valuationDates(), 1, 2);
+    vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
+    QuantLib::ext::shared_ptr<NPVCalculator> npvCalc = QuantLib::ext::make_shared<NPVCalculator>("EUR");
+    calculators.push_back(npvCalc);
+    calculators.push_back(QuantLib::ext::make_shared<MPORCalculator>(npvCalc));
+    valEngine.buildCube(td.portfolio_, cube, calculators, true);
+
+    BOOST_REQUIRE_EQUAL(valEngine.dateSkippedExpiredTrades().size(), dateGrid->valuationDates().size());
+    BOOST_CHECK_EQUAL(valEngine.dateSkippedExpiredTrades()[0], Size(0));
+    BOOST_CHECK_EQUAL(valEngine.dateSkippedExpiredTrades()[1], Size(0));
+    BOOST_CHECK_EQUAL(valEngine.dateSkippedExpiredTrades()[2], Size(2));
+    BOOST_CHECK(td.cube_->get(0, 1, 0, 1) != 0.0);
+    for (Size j = 0; j < dateGrid->valuationDates().size(); ++j) {
+        for (Size d = 0; d < 2; ++d)
+            BOOST_CHECK_CLOSE(cube->get(0, j, 0, d), td.cube_->get(0, j, 0, d), 1E-10);
+    }
+}
+
+// returns the scenarios of the given generator, but the scenario of the preceding valuation date on close-out dates
+class ValuationScenarioOnCloseOutGenerator : public ScenarioGenerator {
+public:
+    ValuationScenarioOnCloseOutGenerator(const QuantLib::ext::shared_ptr<ScenarioGenerator>& generator,
+                                         const QuantLib::ext::shared_ptr<DateGrid>& dateGrid)
+        : generator_(generator), dateGrid_(dateGrid) {}
+
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override {
+        // the given generator is called on all dates, so that the valuation date scenarios are not changed
+        QuantLib::ext::shared_ptr<Scenario> scenario = generator_->next(d);
+        auto it = std::find(dateGrid_->dates().begin(), dateGrid_->dates().end(), d);
+        QL_REQUIRE(it != dateGrid_->dates().end(), "date " << io::iso_date(d) << " not in date grid");
+        if (dateGrid_->isValuationDate()[std::distance(dateGrid_->dates().begin(), it)]) {
+            valuationScenario_ = scenario->clone();
+            return scenario;
+        }
+        QL_REQUIRE(valuationScenario_, "no valuation date scenario before close-out date " << io::iso_date(d));
+        QuantLib::ext::shared_ptr<Scenario> closeOutScenario = valuationScenario_->clone();
+        closeOutScenario->setAsof(d);
+        return closeOutScenario;
+    }
+
+    void reset() override {
+        generator_->reset();
+        valuationScenario_ = nullptr;
+    }
+
+private:
+    QuantLib::ext::shared_ptr<ScenarioGenerator> generator_;
+    QuantLib::ext::shared_ptr<DateGrid> dateGrid_;
+    QuantLib::ext::shared_ptr<Scenario> valuationScenario_;
+};
+
+BOOST_AUTO_TEST_CASE(ReuseValuationNpvsStickyCloseOutTest) {
+
+    BOOST_TEST_MESSAGE("Testing the reuse of valuation date npvs on sticky close-out dates...");
+    ObservationMode::instance().setMode(ObservationMode::Mode::None);
+    Date referenceDate = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = referenceDate;
+
+    QuantLib::ext::shared_ptr<DateGrid> dateGrid = QuantLib::ext::make_shared<DateGrid>("13,1M");
+    dateGrid->addCloseOutDates(1 * Weeks);
+    Size samples = 5;
+    TestData td(referenceDate, dateGrid, true, true, samples);
+    Size numDates = dateGrid->valuationDates().size();
+
+    vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
+    QuantLib::ext::shared_ptr<NPVCalculator> npvCalc = QuantLib::ext::make_shared<NPVCalculator>("EUR");
+    calculators.push_back(npvCalc);
+    calculators.push_back(QuantLib::ext::make_shared<MPORCalculator>(npvCalc));
+    ValuationEngine valEngine(referenceDate, dateGrid, td.simMarket_);
+    auto buildCube = [&]() {
+        td.simMarket_->scenarioGenerator()->reset();
+        QuantLib::ext::shared_ptr<NPVCube> cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(
+            referenceDate, td.portfolio_->ids(), dateGrid->valuationDates(), samples, 2);
+        valEngine.buildCube(td.portfolio_, cube, calculators, true);
+        BOOST_REQUIRE_EQUAL(valEngine.dateReusedCloseOutValuations().size(), numDates);
+        return cube;
+    };
+    auto checkCube = [&](const QuantLib::ext::shared_ptr<NPVCube>& cube,
+                         const QuantLib::ext::shared_ptr<NPVCube>& reference, Size depth) {
+        for (Size j = 0; j < numDates; ++j) {
+            for (Size k = 0; k < samples; ++k) {
+                for (Size d = 0; d < depth; ++d)
+                    BOOST_CHECK_CLOSE(cube->get(0, j, k, d), reference->get(0, j, k, d), 1E-10);
+            }
+        }
+    };
+
+    // the close-out scenarios of the model move the curves, so that the trade is repriced on all close-out dates
+    QuantLib::ext::shared_ptr<NPVCube> cube = buildCube();
+    for (Size j = 0; j < numDates; ++j)
+        BOOST_CHECK_EQUAL(valEngine.dateReusedCloseOutValuations()[j], Size(0));
+    checkCube(cube, td.cube_, 2);
+
+    // with the valuation date scenarios on the close-out dates, the trade is only repriced if it has a flow in the
+    // margin period of risk
+    td.simMarket_->scenarioGenerator() =
+        QuantLib::ext::make_shared<ValuationScenarioOnCloseOutGenerator>(td.simMarket_->scenarioGenerator(), dateGrid);
+    QuantLib::ext::shared_ptr<Trade> trade = td.portfolio_->trades().begin()->second;
+    cube = buildCube();
+    Size reused = 0;
+    for (Size j = 0; j < numDates; ++j) {
+        Date valueDate = dateGrid->valuationDates()[j];
+        Date closeOutDate = dateGrid->closeOutDateFromValuationDate(valueDate);
+        bool hasFlow = valueDate < trade->maturity() && trade->maturity() <= closeOutDate;
+        for (auto const& leg : trade->legs()) {
+            for (auto const& cf : leg)
+                hasFlow = hasFlow || (valueDate < cf->date() && cf->date() <= closeOutDate);
+        }
+        Size expected = closeOutDate == Date() || hasFlow ? 0 : samples;
+        BOOST_CHECK_EQUAL(valEngine.dateReusedCloseOutValuations()[j], expected);
+        reused += valEngine.dateReusedCloseOutValuations()[j];
+    }
+    BOOST_CHECK(reused > 0);
+
+    // the valuation dates are not affected, i.e. the generator is advanced on the close-out dates as before
+    checkCube(cube, td.cube_, 1);
+
+    // the close-out values match a run that reprices all trades on the close-out dates
+    ObservationMode::instance().setMode(ObservationMode::Mode::Disable);
+    QuantLib::ext::shared_ptr<NPVCube> repricedCube = buildCube();
+    for (Size j = 0; j < numDates; ++j)
+        BOOST_CHECK_EQUAL(valEngine.dateReusedCloseOutValuations()[j], Size(0));
+    checkCube(cube, repricedCube, 2);
+}
+
+BOOST_AUTO_TEST_CASE(VectorisedCollateralBalancesTest) {
+
+    BOOST_TEST_MESSAGE("Testing vectorised collateral balances against the collateral account paths...");
+
+    Date today(7, July, 2023);
+    vector<Date> dateGrid;
+    for (Size i = 1; i <= 40; ++i)
+        dateGrid.push_back(today + (i % 2 == 0 ? 7 : 5) * i * Days);
+    std::sort(dateGrid.begin(), dateGrid.end());
+    Size samples = 50;
+
+    MersenneTwisterUniformRng rng(42);
+    vector<vector<Real>> values(dateGrid.size(), vector<Real>(samples));
+    vector<vector<Real>> fxRates(dateGrid.size(), vector<Real>(samples));
+    vector<vector<Real>> rates(dateGrid.size(), vector<Real>(samples));
+    for (Size k = 0; k < samples; ++k) {
+        Real v = 0.0;
+        for (Size j = 0; j < dateGrid.size(); ++j) {
+            v += 2.0E5 * (rng.nextReal() - 0.5);
+            values[j][k] = v;
+            fxRates[j][k] = 1.1 + 0.2 * (rng.nextReal() - 0.5);
+            rates[j][k] = 0.04 * (rng.nextReal() - 0.25);
+        }
+    }
+
+    vector<string> elgColls = {"EUR"};
+    for (auto const& [callFreq, postFreq, mpor] : vector<tuple<string, string, string>>{
+             {"1D", "1D", "2W"}, {"1W", "3D", "10D"}, {"1D", "1W", "0D"}}) {
+        auto netting = QuantLib::ext::make_shared<NettingSetDefinition>(
+            NettingSetDetails("NS"), "Bilateral", "EUR", "EUR-EONIA", 5.0E4, 2.0E4, 1.0E4, 5.0E3, 1.0E4, "FIXED",
+            callFreq, postFreq, mpor, 0.001, 0.002, elgColls);
+        auto balance = QuantLib::ext::make_shared<CollateralBalance>(NettingSetDetails("NS"), "EUR", 0.0, 3.0E4);
+        for (auto calcType : {CollateralExposureHelper::Symmetric, CollateralExposureHelper::AsymmetricCVA,
+                              CollateralExposureHelper::AsymmetricDVA, CollateralExposureHelper::NoLag}) {
+            auto paths = CollateralExposureHelper::collateralBalancePaths(
+                netting, 1.5E4, today, values, dateGrid.back() - 30, dateGrid, 1.1, fxRates, 0.01, rates, calcType,
+                balance);
+            auto balances = CollateralExposureHelper::collateralBalances(
+                netting, 1.5E4, today, values, dateGrid.back() - 30, dateGrid, 1.1, fxRates, 0.01, rates, calcType,
+                balance);
+            BOOST_REQUIRE_EQUAL(balances.size(), dateGrid.size());
+            Size mismatches = 0;
+            for (Size j = 0; j < dateGrid.size(); ++j) {
+                BOOST_REQUIRE_EQUAL(balances[j].size(), samples);
+                for (Size k = 0; k < samples; ++k) {
+                    if (balances[j][k] != paths->at(k)->accountBalance(dateGrid[j]))
+                        ++mismatches;
+                }
+            }
+            BOOST_CHECK_MESSAGE(mismatches == 0, "found " << mismatches << " differences between the vectorised "
+                                                          << "and the path-wise collateral balances for calc type "
+                                                          << calcType << ", call frequency " << callFreq
+                                                          << ", post frequency " << postFreq << ", mpor " << mpor);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
@@ -23,6 +23,7 @@
 #include <orea/cube/npvcube.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/observationmode.hpp>
+#include <orea/engine/observationmodecalibration.hpp>
 #include <orea/engine/parametricvar.hpp>
 #include <orea/engine/riskfilter.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
@@ -323,11 +324,61 @@ void simulation(string dateGridString, bool checkFixings) {
         QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dg->dates(), samples);
     vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
     calculators.push_back(QuantLib::ext::make_shared<NPVCalculator>(baseCcy));
+    auto totalPricings = [&portfolio]() {
+        Size n = 0;
+        for (auto const& [tradeId, trade] : portfolio->trades())
+            n += trade->getNumberOfPricings();
+        return n;
+    };
+    Size pricingsBefore = totalPricings();
     valEngine.buildCube(portfolio, cube, calculators);
     t.stop();
 
     BOOST_TEST_MESSAGE("Cube generated in " << t.format(default_places, "%w") << " seconds");
 
+    // the pricings per date cover all pricings of the run except the t0 pricings, at most one per trade
+    BOOST_REQUIRE_EQUAL(valEngine.datePricings().size(), dg->valuationDates().size());
+    BOOST_REQUIRE_EQUAL(valEngine.datePricingTimes().size(), dg->valuationDates().size());
+    Size datePricings = 0;
+    for (Size i = 0; i < valEngine.datePricings().size(); ++i) {
+        BOOST_CHECK_LE(valEngine.datePricings()[i], samples * portfolio->size());
+        BOOST_CHECK_GE(valEngine.datePricingTimes()[i], 0.0);
+        datePricings += valEngine.datePricings()[i];
+    }
+    BOOST_CHECK(datePricings > 0);
+    BOOST_CHECK_LE(datePricings, totalPricings() - pricingsBefore);
+    BOOST_CHECK_LE(totalPricings() - pricingsBefore - datePricings, portfolio->size());
+    for (auto const& [tradeId, trade] : portfolio->trades())
+        BOOST_CHECK_EQUAL(trade->pricingEngine(), "DiscountedCashflows/DiscountingSwapEngine");
+
+    // repricing the trade into the cube on the same scenarios reproduces its values
+    vector<Real> values;
+    for (Size j = 0; j < dg->size(); ++j) {
+        for (Size k = 0; k < samples; ++k)
+            values.push_back(cube->get(0, j, k));
+    }
+    scenarioGenerator->reset();
+    valEngine.updateCube(portfolio, {"SWAP"}, cube, calculators);
+    for (Size j = 0; j < dg->size(); ++j) {
+        for (Size k = 0; k < samples; ++k)
+            BOOST_CHECK_CLOSE(cube->get(0, j, k), values[j * samples + k], 1E-10);
+    }
+
+    // skipping the trade after its maturity reproduces its values as well
+    scenarioGenerator->reset();
+    valEngine.skipExpiredTrades(true);
+    QuantLib::ext::shared_ptr<NPVCube> skipCube =
+        QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dg->dates(), samples);
+    valEngine.buildCube(portfolio, skipCube, calculators);
+    BOOST_REQUIRE_EQUAL(valEngine.dateSkippedExpiredTrades().size(), dg->valuationDates().size());
+    Date maturity = portfolio->trades().begin()->second->maturity();
+    for (Size j = 0; j < dg->size(); ++j) {
+        BOOST_CHECK_EQUAL(valEngine.dateSkippedExpiredTrades()[j], dg->dates()[j] > maturity ? samples : 0);
+        for (Size k = 0; k < samples; ++k)
+            BOOST_CHECK_CLOSE(skipCube->get(0, j, k), values[j * samples + k], 1E-10);
+    }
+    valEngine.skipExpiredTrades(false);
+
     map<string, vector<Real>> referenceFixings;
     // First 10 EUR-EURIBOR-6M fixings at dateIndex 5, date grid 11,1Y
     referenceFixings["11,1Y"] = {0.00739033, 0.0281673, 0.0344399, 0.03362,   0.0325276, 0.030573,
@@ -432,6 +483,63 @@ BOOST_AUTO_TEST_CASE(testDefer) {
     simulation("10,1Y", true);
 }
 
+BOOST_AUTO_TEST_CASE(testCalibrationCubeDifference) {
+    BOOST_TEST_MESSAGE("Testing the comparison of the cubes of the observation mode calibration runs");
+
+    Date today(14, April, 2016);
+    std::set<std::string> ids{"trade1", "trade2"};
+    vector<Date> dates{today + 1 * Years, today + 2 * Years};
+    DoublePrecisionInMemoryCube reference(today, ids, dates, 3), cube(today, ids, dates, 3);
+    for (Size i = 0; i < ids.size(); ++i) {
+        reference.setT0(1000.0 * (i + 1), i);
+        cube.setT0(1000.0 * (i + 1), i);
+        for (Size j = 0; j < dates.size(); ++j) {
+            for (Size k = 0; k < 3; ++k) {
+                reference.set(0.1 * (i + j + k), i, j, k);
+                cube.set(0.1 * (i + j + k), i, j, k);
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(maxRelativeDifference(reference, cube), 0.0);
+
+    // differences are relative to the reference value, but absolute for reference values below one
+    cube.setT0(1000.5, 0);
+    BOOST_CHECK_CLOSE(maxRelativeDifference(reference, cube), 0.5E-3, 1E-8);
+    cube.set(0.2 + 0.01, 1, 1, 0);
+    BOOST_CHECK_CLOSE(maxRelativeDifference(reference, cube), 0.01, 1E-8);
+
+    // cubes of different shape are never consistent
+    DoublePrecisionInMemoryCube other(today, ids, dates, 2);
+    BOOST_CHECK_EQUAL(maxRelativeDifference(reference, other), QL_MAX_REAL);
+}
+
+BOOST_AUTO_TEST_CASE(testCalibrationRunSelection) {
+    BOOST_TEST_MESSAGE("Testing the selection of the observation mode from the calibration runs");
+
+    std::vector<ObservationModeCalibrationRun> runs(4);
+    runs[0].mode = ObservationMode::Mode::None;
+    runs[1].mode = ObservationMode::Mode::Disable;
+    runs[2].mode = ObservationMode::Mode::Defer;
+    runs[3].mode = ObservationMode::Mode::Unregister;
+    runs[0].estimatedTime = 4.0;
+    runs[1].estimatedTime = 2.0;
+    runs[2].estimatedTime = 3.0;
+    runs[3].estimatedTime = 1.0;
+    BOOST_CHECK_EQUAL(fastestConsistentRun(runs), 3u);
+
+    // the fastest run does not reproduce the reference values
+    runs[3].consistent = false;
+    BOOST_CHECK_EQUAL(fastestConsistentRun(runs), 1u);
+
+    // only the reference run is consistent
+    runs[1].consistent = runs[2].consistent = false;
+    BOOST_CHECK_EQUAL(fastestConsistentRun(runs), 0u);
+
+    std::ostringstream out;
+    out << runs[3].mode;
+    BOOST_CHECK_EQUAL(out.str(), "Unregister");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
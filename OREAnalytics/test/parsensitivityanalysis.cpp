@@ -1186,6 +1186,19 @@ void testParConversion(ObservationMode::Mode om) {
         }
     }
 
+    // The conversion of all trades at once in parallel must give the same par deltas
+    auto allParDeltas = parCube.allParDeltas(0, 4);
+    for (const auto& [tradeId, tradeIdx] : sensiCube->tradeIdx()) {
+        BOOST_REQUIRE(tradeIdx < allParDeltas.size());
+        auto exp = parCube.parDeltas(tradeId);
+        BOOST_CHECK_EQUAL(allParDeltas[tradeIdx].size(), exp.size());
+        for (const auto& kv : exp) {
+            auto it = allParDeltas[tradeIdx].find(kv.first);
+            BOOST_REQUIRE(it != allParDeltas[tradeIdx].end());
+            BOOST_CHECK_EQUAL(it->second, kv.second);
+        }
+    }
+
     struct Results {
         string id;
         string label;
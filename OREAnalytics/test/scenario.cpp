@@ -9,6 +9,12 @@ All rights reserved.
 #include <orea/scenario/simplescenario.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <orea/scenario/csvscenariogenerator.hpp>
+#include <orea/scenario/scenariostatistics.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+#include <algorithm>
+#include <numeric>
 
 using namespace boost::unit_test_framework;
 using namespace QuantLib;
@@ -89,4 +95,123 @@ BOOST_AUTO_TEST_CASE(testCSVScenarioGenerator) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(SimpleScenarioTest)
+
+BOOST_AUTO_TEST_CASE(testSharedData) {
+
+    BOOST_TEST_MESSAGE("Testing simple scenarios sharing their key table...");
+
+    Date d(21, Dec, 2016);
+    vector<RiskFactorKey> rfks = {{RiskFactorKey::KeyType::DiscountCurve, "EUR", 0},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "EUR", 1},
+                                  {RiskFactorKey::KeyType::IndexCurve, "EUR-EURIBOR-6M", 0},
+                                  {RiskFactorKey::KeyType::FXSpot, "USDEUR", 0}};
+
+    SimpleScenarioFactory factory(true);
+    auto s1 = factory.buildScenario(d, true);
+    for (Size i = 0; i < rfks.size(); ++i)
+        s1->add(rfks[i], static_cast<Real>(i));
+
+    // keys added in the order of the shared key table
+    auto s2 = factory.buildScenario(d, true);
+    for (Size i = 0; i < rfks.size(); ++i)
+        s2->add(rfks[i], 10.0 + i);
+
+    // keys added in reverse order, a key overwritten and a new key added
+    RiskFactorKey newKey(RiskFactorKey::KeyType::FXSpot, "GBPEUR", 0);
+    auto s3 = factory.buildScenario(d, true);
+    for (Size i = rfks.size(); i > 0; --i)
+        s3->add(rfks[i - 1], 20.0 + (i - 1));
+    s3->add(rfks[1], 42.0);
+    s3->add(newKey, 43.0);
+
+    BOOST_CHECK_EQUAL(s1->keysHash(), s2->keysHash());
+    BOOST_REQUIRE_EQUAL(s3->keys().size(), rfks.size() + 1);
+    BOOST_CHECK(s1->has(newKey));
+    for (Size i = 0; i < rfks.size(); ++i) {
+        BOOST_CHECK_EQUAL(s1->keys()[i], rfks[i]);
+        BOOST_CHECK_EQUAL(s1->get(rfks[i]), static_cast<Real>(i));
+        BOOST_CHECK_EQUAL(s2->get(rfks[i]), 10.0 + i);
+        BOOST_CHECK_EQUAL(s3->get(rfks[i]), i == 1 ? 42.0 : 20.0 + i);
+    }
+    BOOST_CHECK_EQUAL(s3->get(newKey), 43.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ScenarioStatisticsTest)
+
+BOOST_AUTO_TEST_CASE(testScenarioStatisticsGenerator) {
+
+    BOOST_TEST_MESSAGE("Testing online scenario statistics against the statistics of the stored values");
+
+    Date d(21, Dec, 2016);
+    vector<RiskFactorKey> rfks = {{RiskFactorKey::KeyType::DiscountCurve, "EUR", 0},
+                                  {RiskFactorKey::KeyType::FXSpot, "USDEUR", 0}};
+
+    // normal and lognormal samples
+    Size n = 10000;
+    MersenneTwisterUniformRng rng(42);
+    InverseCumulativeNormal icn;
+    QuantLib::ext::shared_ptr<TestScenarioGenerator> tsg = QuantLib::ext::make_shared<TestScenarioGenerator>();
+    vector<vector<Real>> values(rfks.size());
+    for (Size i = 0; i < n; ++i) {
+        Real z = icn(rng.nextReal());
+        values[0].push_back(0.5 + 0.1 * z);
+        values[1].push_back(std::exp(0.2 * z));
+        auto s = QuantLib::ext::make_shared<SimpleScenario>(d);
+        for (Size k = 0; k < rfks.size(); ++k)
+            s->add(rfks[k], values[k].back());
+        tsg->addScenario(s);
+    }
+    tsg->reset();
+
+    vector<Real> quantiles = {0.01, 0.5, 0.99};
+    ScenarioStatisticsGenerator sg(tsg, rfks, {d}, quantiles);
+    for (Size i = 0; i < n; ++i) {
+        auto s = sg.next(d);
+        BOOST_CHECK(s == tsg->scenarios[i]);
+    }
+
+    for (Size k = 0; k < rfks.size(); ++k) {
+        vector<Real>& v = values[k];
+        Real mean = std::accumulate(v.begin(), v.end(), 0.0) / n, m2 = 0.0, m3 = 0.0, m4 = 0.0;
+        for (auto const& x : v) {
+            m2 += std::pow(x - mean, 2) / n;
+            m3 += std::pow(x - mean, 3) / n;
+            m4 += std::pow(x - mean, 4) / n;
+        }
+        const OnlineMoments& m = sg.moments(0, k);
+        BOOST_CHECK_EQUAL(m.count(), n);
+        BOOST_CHECK_EQUAL(m.min(), *std::min_element(v.begin(), v.end()));
+        BOOST_CHECK_EQUAL(m.max(), *std::max_element(v.begin(), v.end()));
+        BOOST_CHECK_CLOSE(m.mean(), mean, 1E-10);
+        BOOST_CHECK_CLOSE(m.variance(), m2, 1E-8);
+        BOOST_CHECK_CLOSE(m.skewness(), m3 / std::pow(m2, 1.5), 1E-6);
+        BOOST_CHECK_CLOSE(m.kurtosis(), m4 / (m2 * m2) - 3.0, 1E-6);
+
+        // the P^2 estimates are compared to the empirical quantiles, relative to the standard deviation
+        std::sort(v.begin(), v.end());
+        for (Size q = 0; q < quantiles.size(); ++q) {
+            Real empirical = v[static_cast<Size>(quantiles[q] * (n - 1))];
+            BOOST_TEST_MESSAGE("key " << rfks[k] << " quantile " << quantiles[q] << " estimate "
+                                      << sg.quantile(0, k, q) << " empirical " << empirical);
+            BOOST_CHECK_SMALL((sg.quantile(0, k, q) - empirical) / std::sqrt(m2), 0.05);
+        }
+    }
+
+    // a reset restarts the source and clears the statistics
+    sg.reset();
+    BOOST_CHECK_EQUAL(sg.moments(0, 0).count(), Size(0));
+    BOOST_CHECK(sg.next(d) == tsg->scenarios[0]);
+    BOOST_CHECK_EQUAL(sg.moments(0, 0).count(), Size(1));
+    BOOST_CHECK_EQUAL(sg.quantile(0, 0, 1), tsg->scenarios[0]->get(rfks[0]));
+
+    // scenarios on other dates pass through without being counted
+    BOOST_CHECK(sg.next(d + 1) == tsg->scenarios[1]);
+    BOOST_CHECK_EQUAL(sg.moments(0, 0).count(), Size(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -16,9 +16,13 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <orea/scenario/crossassetmodelcomputescenariogenerator.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
 #include <orea/scenario/lgmscenariogenerator.hpp>
+#include <orea/scenario/mappedscenariostore.hpp>
+#include <orea/scenario/pipelinedscenariogenerator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/simplescenario.hpp>
@@ -36,6 +40,7 @@
 #include <test/oreatoplevelfixture.hpp>
 
 #include <qle/instruments/fxforward.hpp>
+#include <qle/math/basiccpuenvironment.hpp>
 #include <qle/models/crossassetmodel.hpp>
 #include <qle/models/fxbspiecewiseconstantparametrization.hpp>
 #include <qle/models/irlgm1fpiecewiseconstantparametrization.hpp>
@@ -481,6 +486,216 @@ BOOST_AUTO_TEST_CASE(testCrossAssetLowDiscrepancyBrownianBridge) {
     test_crossasset(true, false, true);
 }
 
+BOOST_AUTO_TEST_CASE(testCrossAssetPipelined) {
+    BOOST_TEST_MESSAGE("Testing pipelined CrossAssetScenarioGenerator...");
+    setConventions();
+
+    TestData d;
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    QuantLib::ext::shared_ptr<DateGrid> grid = QuantLib::ext::make_shared<DateGrid>(tenorGrid);
+    QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel> model = d.ccLgm;
+
+    QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 1 * Years, 5 * Years, 10 * Years, 30 * Years});
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+    simMarketConfig->setZeroInflationTenors("", {1 * Years, 5 * Years, 10 * Years});
+
+    // two generators with the same seed, each with its own state process
+    auto makeGenerator = [&]() {
+        auto stateProcess = QuantLib::ext::make_shared<CrossAssetStateProcess>(model);
+        stateProcess->resetCache(grid->timeGrid().size() - 1);
+        auto pathGen =
+            QuantLib::ext::make_shared<MultiPathGeneratorMersenneTwister>(stateProcess, grid->timeGrid(), 42);
+        return QuantLib::ext::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGen, QuantLib::ext::make_shared<SimpleScenarioFactory>(), simMarketConfig, today, grid,
+            d.market);
+    };
+
+    Size samples = 50;
+    auto refGen = makeGenerator();
+    PipelinedScenarioGenerator pipelinedGen(makeGenerator(), grid->dates(), 3, samples);
+
+    for (Size pass = 0; pass < 2; ++pass) {
+        for (Size i = 0; i < samples; ++i) {
+            for (Date dt : grid->dates()) {
+                auto ref = refGen->next(dt);
+                auto scen = pipelinedGen.next(dt);
+                BOOST_REQUIRE(scen != nullptr);
+                BOOST_CHECK_EQUAL(scen->asof(), ref->asof());
+                BOOST_CHECK_EQUAL(scen->getNumeraire(), ref->getNumeraire());
+                for (auto const& k : ref->keys())
+                    BOOST_CHECK_EQUAL(scen->get(k), ref->get(k));
+            }
+        }
+        BOOST_CHECK_THROW(pipelinedGen.next(grid->dates().front()), QuantLib::Error);
+        refGen->reset();
+        pipelinedGen.reset();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testCrossAssetComputeDevice) {
+    BOOST_TEST_MESSAGE("Testing CrossAssetModelComputeScenarioGenerator on the basic cpu device...");
+    setConventions();
+
+    TestData d;
+
+    ComputeFrameworkRegistry::instance().add("BasicCpu", &createComputeFrameworkCreator<BasicCpuFramework>, true);
+    ComputeEnvironment::instance().reset();
+
+    // IR-FX part of the test model, the inflation components are not supported by the generator
+    std::vector<QuantLib::ext::shared_ptr<Parametrization>> parametrizations(d.ccLgm->parametrizations().begin(),
+                                                                             d.ccLgm->parametrizations().begin() + 5);
+    Matrix correlation(5, 5);
+    for (Size i = 0; i < 5; ++i)
+        for (Size j = 0; j < 5; ++j)
+            correlation[i][j] = d.ccLgm->correlation()[i][j];
+    auto model = QuantLib::ext::make_shared<QuantExt::CrossAssetModel>(parametrizations, correlation);
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    QuantLib::ext::shared_ptr<DateGrid> grid = QuantLib::ext::make_shared<DateGrid>(tenorGrid);
+
+    QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 1 * Years, 5 * Years, 10 * Years, 30 * Years});
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+
+    ComputeContext::Settings settings;
+    settings.useDoublePrecision = true;
+    settings.rngSequenceType = SequenceType::MersenneTwister;
+    settings.rngSeed = 42;
+    Size samples = 10000;
+    CrossAssetModelComputeScenarioGenerator scenGen(model, QuantLib::ext::make_shared<SimpleScenarioFactory>(),
+                                                    simMarketConfig, today, grid, d.market,
+                                                    "BasicCpu/Default/Default", samples, settings);
+
+    // martingale tests for the 10y discount bonds and fx spots deflated by the numeraire
+    Real eur = 0.0, usd = 0.0, gbp = 0.0;
+    for (Size pass = 0; pass < 2; ++pass) {
+        for (Size i = 0; i < samples; ++i) {
+            for (Date dt : grid->dates()) {
+                auto scenario = scenGen.next(dt);
+                if (pass == 0 && dt == grid->dates()[4]) { // in 7 years from today
+                    Real numeraire = scenario->getNumeraire();
+                    eur += scenario->get(RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 3)) / numeraire;
+                    usd += scenario->get(RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "USD", 3)) *
+                           scenario->get(RiskFactorKey(RiskFactorKey::KeyType::FXSpot, "USDEUR")) / numeraire;
+                    gbp += scenario->get(RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "GBP", 3)) *
+                           scenario->get(RiskFactorKey(RiskFactorKey::KeyType::FXSpot, "GBPEUR")) / numeraire;
+                }
+            }
+        }
+        BOOST_CHECK_THROW(scenGen.next(grid->dates().front()), QuantLib::Error);
+        scenGen.reset();
+    }
+    eur /= samples;
+    usd /= samples;
+    gbp /= samples;
+
+    Real relTolerance = 0.01;
+    Time T = grid->timeGrid()[5] + 10.0;
+    Real eurExpected = d.market->discountCurve("EUR")->discount(T);
+    Real usdExpected = d.market->fxRate("USDEUR")->value() * d.market->discountCurve("USD")->discount(T);
+    Real gbpExpected = d.market->fxRate("GBPEUR")->value() * d.market->discountCurve("GBP")->discount(T);
+    BOOST_CHECK_MESSAGE(std::fabs(eur - eurExpected) / eurExpected < relTolerance,
+                        "EUR 17Y Discount mismatch: " << eur << " vs " << eurExpected);
+    BOOST_CHECK_MESSAGE(std::fabs(usd - usdExpected) / usdExpected < relTolerance,
+                        "USD 17Y Discount mismatch: " << usd << " vs " << usdExpected);
+    BOOST_CHECK_MESSAGE(std::fabs(gbp - gbpExpected) / gbpExpected < relTolerance,
+                        "GBP 17Y Discount mismatch: " << gbp << " vs " << gbpExpected);
+
+    ComputeEnvironment::instance().reset();
+}
+
+BOOST_AUTO_TEST_CASE(testCrossAssetMappedScenarioStore) {
+    BOOST_TEST_MESSAGE("Testing replay of CrossAssetScenarioGenerator paths from a mapped scenario store...");
+    setConventions();
+
+    TestData d;
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    QuantLib::ext::shared_ptr<DateGrid> grid = QuantLib::ext::make_shared<DateGrid>(tenorGrid);
+    QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel> model = d.ccLgm;
+
+    QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 1 * Years, 5 * Years, 10 * Years, 30 * Years});
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+    simMarketConfig->setZeroInflationTenors("", {1 * Years, 5 * Years, 10 * Years});
+
+    auto makeGenerator = [&]() {
+        auto stateProcess = QuantLib::ext::make_shared<CrossAssetStateProcess>(model);
+        stateProcess->resetCache(grid->timeGrid().size() - 1);
+        auto pathGen =
+            QuantLib::ext::make_shared<MultiPathGeneratorMersenneTwister>(stateProcess, grid->timeGrid(), 42);
+        return QuantLib::ext::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGen, QuantLib::ext::make_shared<SimpleScenarioFactory>(), simMarketConfig, today, grid,
+            d.market);
+    };
+
+    Size samples = 20;
+    for (bool doublePrecision : {true, false}) {
+        std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+
+        // write the store on the first pass, a second pass must not change it
+        {
+            MappedScenarioStoreWriter writer(makeGenerator(), today, grid->dates(), filename, doublePrecision);
+            for (Size pass = 0; pass < 2; ++pass) {
+                for (Size i = 0; i < samples; ++i)
+                    for (Date dt : grid->dates())
+                        writer.next(dt);
+                writer.reset();
+            }
+            BOOST_CHECK_EQUAL(writer.samples(), samples);
+        }
+
+        BOOST_REQUIRE(isMappedScenarioStore(filename));
+        MappedScenarioStoreGenerator replay(filename);
+        BOOST_CHECK_EQUAL(replay.samples(), samples);
+        BOOST_CHECK_EQUAL(replay.asof(), today);
+        BOOST_CHECK_EQUAL(replay.doublePrecision(), doublePrecision);
+        BOOST_REQUIRE(replay.dates() == grid->dates());
+
+        // double precision reproduces the paths exactly, single precision up to the float rounding
+        auto check = [doublePrecision](Real x, Real y) {
+            if (doublePrecision)
+                BOOST_CHECK_EQUAL(x, y);
+            else
+                BOOST_CHECK_SMALL(x - y, 1E-6 * std::max(1.0, std::abs(y)));
+        };
+        auto refGen = makeGenerator();
+        for (Size i = 0; i < samples; ++i) {
+            for (Date dt : grid->dates()) {
+                auto ref = refGen->next(dt);
+                auto scen = replay.next(dt);
+                BOOST_CHECK_EQUAL(scen->asof(), ref->asof());
+                BOOST_CHECK_EQUAL(scen->isAbsolute(), ref->isAbsolute());
+                BOOST_REQUIRE(scen->keys() == ref->keys());
+                check(scen->getNumeraire(), ref->getNumeraire());
+                for (auto const& k : ref->keys())
+                    check(scen->get(k), ref->get(k));
+            }
+        }
+        BOOST_CHECK_THROW(replay.next(grid->dates().front()), QuantLib::Error);
+
+        // replay a single path
+        replay.setNextSample(samples - 1);
+        replay.next(grid->dates().front());
+        auto last = replay.next(grid->dates().back());
+        replay.reset();
+        for (Size i = 0; i < samples; ++i)
+            replay.next(grid->dates().front());
+        auto lastAgain = replay.next(grid->dates().back());
+        BOOST_CHECK_EQUAL(last->getNumeraire(), lastAgain->getNumeraire());
+
+        boost::filesystem::remove(filename);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testCrossAssetSimMarket) {
     BOOST_TEST_MESSAGE("Testing CrossAssetScenarioGenerator via SimMarket (Martingale tests)...");
     setConventions();
@@ -369,6 +369,61 @@ BOOST_AUTO_TEST_CASE(testRelativeSwaptionVolShift) {
     BOOST_CHECK_CLOSE(cal, exp, tol);
 }
 
+BOOST_AUTO_TEST_CASE(testBatchShifts) {
+
+    BOOST_TEST_MESSAGE("Testing batch shift calculation against single key shifts");
+
+    // Set up
+    auto ssd = QuantLib::ext::make_shared<SensitivityScenarioData>();
+    auto ssp = QuantLib::ext::make_shared<ScenarioSimMarketParameters>();
+
+    ssd->discountCurveShiftData()["EUR"] = QuantLib::ext::make_shared<CurveShiftData>();
+    ssd->discountCurveShiftData()["EUR"]->shiftSize = 0.0001;
+    ssd->discountCurveShiftData()["EUR"]->shiftType = ShiftType::Absolute;
+    ssd->fxShiftData()["EURUSD"].shiftSize = 0.01;
+    ssd->fxShiftData()["EURUSD"].shiftType = ShiftType::Relative;
+    ssp->setYieldCurveTenors("EUR", {3 * Months, 6 * Months});
+
+    std::vector<RiskFactorKey> keys = {RiskFactorKey(RFType::DiscountCurve, "EUR", 0),
+                                       RiskFactorKey(RFType::DiscountCurve, "EUR", 1),
+                                       RiskFactorKey(RFType::FXSpot, "EURUSD", 0)};
+    std::vector<Real> baseValues = {0.998, 0.995, 1.1637};
+
+    SimpleScenario base(asof);
+    for (Size j = 0; j < keys.size(); ++j)
+        base.add(keys[j], baseValues[j]);
+
+    // simple scenarios sharing a key table, one of them with the keys added in reverse order
+    auto sharedData = QuantLib::ext::make_shared<SimpleScenario::SharedData>();
+    std::vector<QuantLib::ext::shared_ptr<ore::analytics::Scenario>> scenarios;
+    for (Size i = 0; i < 5; ++i) {
+        auto s = QuantLib::ext::make_shared<SimpleScenario>(asof, "scenario_" + std::to_string(i), 1.0, sharedData);
+        for (Size j = 0; j < keys.size(); ++j) {
+            Size k = i == 3 ? keys.size() - 1 - j : j;
+            s->add(keys[k], baseValues[k] * (1.0 - 0.001 * (i + 1) * (k + 1)));
+        }
+        scenarios.push_back(s);
+    }
+
+    ScenarioShiftCalculator ssc(ssd, ssp);
+    auto shifts = ssc.shifts(keys, base, scenarios, 2);
+
+    BOOST_REQUIRE_EQUAL(shifts.size(), scenarios.size());
+    for (Size i = 0; i < scenarios.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(shifts[i].size(), keys.size());
+        for (Size j = 0; j < keys.size(); ++j)
+            BOOST_CHECK_CLOSE(shifts[i][j], ssc.shift(keys[j], base, *scenarios[i]), tol);
+    }
+
+    // a key missing in the scenarios yields a null shift
+    RiskFactorKey missing(RFType::FXSpot, "GBPUSD", 0);
+    ssd->fxShiftData()["GBPUSD"].shiftSize = 0.01;
+    base.add(missing, 1.25);
+    shifts = ssc.shifts({missing}, base, scenarios);
+    for (Size i = 0; i < scenarios.size(); ++i)
+        BOOST_CHECK(shifts[i][0] == Null<Real>());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
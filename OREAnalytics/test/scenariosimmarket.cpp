@@ -17,8 +17,10 @@
 */
 
 #include <boost/test/unit_test.hpp>
+#include <orea/scenario/deltascenariofactory.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/simplescenario.hpp>
 #include <ored/configuration/conventions.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/marketdata/marketimpl.hpp>
@@ -306,6 +308,133 @@ BOOST_AUTO_TEST_CASE(testScenarioSimMarket) {
     testToXML(parameters);
 }
 
+BOOST_AUTO_TEST_CASE(testChangedRiskFactors) {
+    BOOST_TEST_MESSAGE("Testing tracking of changed risk factors in ScenarioSimMarket...");
+
+    using analytics::RiskFactorKey;
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+    QuantLib::ext::shared_ptr<ore::data::Market> initMarket = QuantLib::ext::make_shared<TestMarket>(today);
+
+    convs();
+    auto simMarket = QuantLib::ext::make_shared<analytics::ScenarioSimMarket>(initMarket, scenarioParameters());
+    simMarket->trackChangedRiskFactors(true);
+
+    RiskFactorKey discKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 1);
+    RiskFactorKey indexKey(RiskFactorKey::KeyType::IndexCurve, "EUR-EURIBOR-6M", 0);
+    auto discRf = std::make_pair(discKey.keytype, discKey.name);
+    auto indexRf = std::make_pair(indexKey.keytype, indexKey.name);
+
+    analytics::DeltaScenarioFactory factory(simMarket->baseScenario());
+    auto base = simMarket->baseScenario();
+    Real baseDiscount = simMarket->discountCurve("EUR")->discount(1.0);
+
+    // shift a single discount factor
+    auto s1 = factory.buildScenario(today, true);
+    s1->add(discKey, base->get(discKey) * 0.99);
+    simMarket->applyScenario(s1);
+    BOOST_CHECK_EQUAL(simMarket->changedRiskFactors().size(), 1);
+    BOOST_CHECK(simMarket->changedRiskFactors().count(discRf) == 1);
+
+    // applying the same scenario again does not change anything
+    simMarket->applyScenario(s1);
+    BOOST_CHECK(simMarket->changedRiskFactors().empty());
+
+    // shift an index curve point, the discount curve is restored to its base value
+    auto s2 = factory.buildScenario(today, true);
+    s2->add(indexKey, base->get(indexKey) * 0.99);
+    simMarket->applyScenario(s2);
+    BOOST_CHECK_EQUAL(simMarket->changedRiskFactors().size(), 2);
+    BOOST_CHECK(simMarket->changedRiskFactors().count(discRf) == 1);
+    BOOST_CHECK(simMarket->changedRiskFactors().count(indexRf) == 1);
+    BOOST_CHECK_EQUAL(simMarket->discountCurve("EUR")->discount(1.0), baseDiscount);
+
+    // back to the base scenario
+    simMarket->reset();
+    BOOST_CHECK_EQUAL(simMarket->changedRiskFactors().size(), 1);
+    BOOST_CHECK(simMarket->changedRiskFactors().count(indexRf) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testDeferredNotifications) {
+    BOOST_TEST_MESSAGE("Testing coalescing of notifications in ScenarioSimMarket...");
+
+    using analytics::RiskFactorKey;
+
+    class CountingObserver : public Observer {
+    public:
+        void update() override { ++count; }
+        Size count = 0;
+    };
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+    QuantLib::ext::shared_ptr<ore::data::Market> initMarket = QuantLib::ext::make_shared<TestMarket>(today);
+
+    convs();
+    auto simMarket = QuantLib::ext::make_shared<analytics::ScenarioSimMarket>(initMarket, scenarioParameters());
+
+    auto observer = QuantLib::ext::make_shared<CountingObserver>();
+    observer->registerWith(simMarket->discountCurve("EUR"));
+
+    Size quoteNotifications = simMarket->quoteNotifications();
+    Size batches = simMarket->deferredNotificationBatches();
+
+    // shift two points of the same curve
+    analytics::DeltaScenarioFactory factory(simMarket->baseScenario());
+    auto base = simMarket->baseScenario();
+    auto s = factory.buildScenario(today, true);
+    for (Size i = 0; i < 2; ++i) {
+        RiskFactorKey key(RiskFactorKey::KeyType::DiscountCurve, "EUR", i);
+        s->add(key, base->get(key) * 0.99);
+    }
+    simMarket->applyScenario(s);
+
+    BOOST_CHECK(ObservableSettings::instance().updatesEnabled());
+    BOOST_CHECK_EQUAL(simMarket->quoteNotifications() - quoteNotifications, 2);
+    BOOST_CHECK_EQUAL(simMarket->deferredNotificationBatches() - batches, 1);
+    BOOST_CHECK_EQUAL(observer->count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(testSharedBaseScenarioKeys) {
+    BOOST_TEST_MESSAGE("Testing sim markets sharing the key table of their base scenarios...");
+
+    using analytics::RiskFactorKey;
+    using analytics::SimpleScenario;
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+    QuantLib::ext::shared_ptr<ore::data::Market> initMarket = QuantLib::ext::make_shared<TestMarket>(today);
+
+    convs();
+    auto parameters = scenarioParameters();
+    auto simMarket1 = QuantLib::ext::make_shared<analytics::ScenarioSimMarket>(initMarket, parameters);
+    auto simMarket2 = QuantLib::ext::make_shared<analytics::ScenarioSimMarket>(initMarket, parameters);
+
+    auto base1 = QuantLib::ext::dynamic_pointer_cast<SimpleScenario>(simMarket1->baseScenario());
+    auto base2 = QuantLib::ext::dynamic_pointer_cast<SimpleScenario>(simMarket2->baseScenario());
+    BOOST_REQUIRE(base1 != nullptr && base2 != nullptr);
+    BOOST_CHECK(base1->sharedData() == base2->sharedData());
+    BOOST_CHECK(base1->coordinates() == base2->coordinates());
+    BOOST_REQUIRE_EQUAL(base1->keys().size(), base2->keys().size());
+    for (auto const& k : base1->keys())
+        BOOST_CHECK_EQUAL(base1->get(k), base2->get(k));
+
+    // a new key goes to a private copy of the shared key table
+    RiskFactorKey newKey(RiskFactorKey::KeyType::FXSpot, "XYZEUR", 0);
+    base2->add(newKey, 1.0);
+    BOOST_CHECK(base1->sharedData() != base2->sharedData());
+    BOOST_CHECK(base2->has(newKey));
+    BOOST_CHECK(!base1->has(newKey));
+    BOOST_CHECK_EQUAL(base2->keys().size(), base1->keys().size() + 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -17,6 +17,9 @@
 */
 
 #include <boost/test/unit_test.hpp>
+#include <orea/engine/bufferedsensitivitystream.hpp>
+#include <orea/engine/filteredsensitivitystream.hpp>
+#include <orea/engine/riskfilter.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
 #include <orea/engine/sensitivityinmemorystream.hpp>
 #include <oret/toplevelfixture.hpp>
@@ -27,12 +30,17 @@ using namespace boost::unit_test_framework;
 using namespace std;
 
 using ore::analytics::RiskFactorKey;
+using ore::analytics::BufferedSensitivityStream;
+using ore::analytics::FilteredSensitivityStream;
+using ore::analytics::MarketRiskConfiguration;
+using ore::analytics::RiskFilter;
 using ore::analytics::SensitivityAggregator;
 using ore::analytics::SensitivityInMemoryStream;
 using ore::analytics::SensitivityRecord;
 using std::function;
 using std::map;
 using std::set;
+using std::vector;
 
 using RFType = RiskFactorKey::KeyType;
 
@@ -240,6 +248,129 @@ BOOST_AUTO_TEST_CASE(testGeneralAggregationFunctionCategories) {
     check(expAggregationAll, res, "all_except_002");
 }
 
+BOOST_AUTO_TEST_CASE(testBatchedStreams) {
+
+    BOOST_TEST_MESSAGE("Testing that batched streams return the same records as record by record streaming");
+
+    auto byRecord = [](ore::analytics::SensitivityStream& ss) {
+        vector<SensitivityRecord> res;
+        ss.reset();
+        while (SensitivityRecord sr = ss.next())
+            res.push_back(sr);
+        return res;
+    };
+    auto byBatch = [](ore::analytics::SensitivityStream& ss) {
+        vector<SensitivityRecord> res, batch;
+        ss.reset();
+        while (QuantLib::Size n = ss.nextBatch(batch, 4)) {
+            BOOST_REQUIRE_EQUAL(n, batch.size());
+            BOOST_REQUIRE_LE(n, 4);
+            res.insert(res.end(), batch.begin(), batch.end());
+        }
+        return res;
+    };
+
+    auto ss = QuantLib::ext::make_shared<SensitivityInMemoryStream>(records.begin(), records.end());
+    vector<SensitivityRecord> exp(records.begin(), records.end());
+    BOOST_CHECK(byRecord(*ss) == exp);
+    BOOST_CHECK(byBatch(*ss) == exp);
+
+    // threshold 1.0 filters out a part of the records
+    FilteredSensitivityStream fss(ss, 1.0);
+    vector<SensitivityRecord> filtered = byRecord(fss);
+    BOOST_CHECK_LT(filtered.size(), exp.size());
+    BOOST_CHECK(byBatch(fss) == filtered);
+
+    // buffered stream filled batch by batch and then replayed from the buffer in batches and record by record
+    BufferedSensitivityStream bss(ss);
+    BOOST_CHECK(byBatch(bss) == exp);
+    BOOST_CHECK(byBatch(bss) == exp);
+    BOOST_CHECK(byRecord(bss) == exp);
+
+    // aggregation from a filtered stream
+    SensitivityAggregator sAgg(map<string, function<bool(string)>>{{"all", [](string) { return true; }}});
+    sAgg.aggregate(fss);
+    set<SensitivityRecord> res = sAgg.sensitivities("all");
+    SensitivityAggregator sAggUnfiltered(map<string, function<bool(string)>>{{"all", [](string) { return true; }}});
+    SensitivityInMemoryStream ssFiltered(filtered.begin(), filtered.end());
+    sAggUnfiltered.aggregate(ssFiltered);
+    check(sAggUnfiltered.sensitivities("all"), res, "all");
+}
+
+BOOST_AUTO_TEST_CASE(testParallelAggregation) {
+
+    BOOST_TEST_MESSAGE("Testing aggregation in parallel over chunks of the stream");
+
+    SensitivityInMemoryStream ss(records.begin(), records.end());
+
+    map<string, set<pair<string, QuantLib::Size>>> categories;
+    categories["all"] = {make_pair("trade_001", 0), make_pair("trade_002", 1), make_pair("trade_003", 2),
+                         make_pair("trade_004", 3), make_pair("trade_005", 4), make_pair("trade_006", 5)};
+    categories["trade_002"] = {make_pair("trade_002", 1)};
+
+    SensitivityAggregator sAgg(categories, 1);
+    sAgg.aggregate(ss);
+    SensitivityAggregator sAggParallel(categories, 4);
+    sAggParallel.aggregate(ss);
+
+    for (const auto& c : categories) {
+        BOOST_TEST_MESSAGE("Testing for category " << c.first);
+        check(sAgg.sensitivities(c.first), sAggParallel.sensitivities(c.first), c.first);
+    }
+    check(filter(records, "trade_002"), sAggParallel.sensitivities("trade_002"), "trade_002");
+
+    // a second aggregation adds to the existing results
+    sAggParallel.aggregate(ss);
+    for (const auto& sr : sAggParallel.sensitivities("trade_002")) {
+        auto it = sAgg.sensitivities("trade_002").find(sr);
+        BOOST_REQUIRE(it != sAgg.sensitivities("trade_002").end());
+        BOOST_CHECK(QuantLib::close(sr.delta, 2.0 * it->delta));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testApplyFilter) {
+
+    BOOST_TEST_MESSAGE("Testing that filtering aggregated records matches aggregation under the filter");
+
+    SensitivityInMemoryStream ss(records.begin(), records.end());
+
+    map<string, set<pair<string, QuantLib::Size>>> categories;
+    categories["all"] = {make_pair("trade_001", 0), make_pair("trade_002", 1), make_pair("trade_003", 2),
+                         make_pair("trade_004", 3), make_pair("trade_005", 4), make_pair("trade_006", 5)};
+    categories["trade_001"] = {make_pair("trade_001", 0)};
+
+    SensitivityAggregator sAggOnce(categories);
+    sAggOnce.aggregate(ss);
+
+    for (auto const rc : MarketRiskConfiguration::riskClasses(true)) {
+        for (auto const rt : MarketRiskConfiguration::riskTypes(true)) {
+            auto filter = QuantLib::ext::make_shared<RiskFilter>(rc, rt);
+            for (const auto& sr : records) {
+                BOOST_CHECK_EQUAL(filter->allow(sr.key_1),
+                                  RiskFilter::membership(sr.key_1.keytype)[RiskFilter::breakdownIndex(rc, rt)]);
+            }
+            SensitivityAggregator sAgg(categories);
+            sAgg.aggregate(ss, filter);
+            sAggOnce.applyFilter(filter);
+            for (const auto& c : categories) {
+                BOOST_TEST_MESSAGE("Testing for risk class " << rc << ", risk type " << rt << ", category "
+                                                             << c.first);
+                check(sAgg.sensitivities(c.first), sAggOnce.sensitivities(c.first), c.first);
+            }
+        }
+    }
+
+    // the FX filter keeps the FX spot deltas only
+    sAggOnce.applyFilter(
+        QuantLib::ext::make_shared<RiskFilter>(MarketRiskConfiguration::RiskClass::FX,
+                                               MarketRiskConfiguration::RiskType::All));
+    BOOST_CHECK(!sAggOnce.sensitivities("trade_001").empty());
+    for (const auto& sr : sAggOnce.sensitivities("trade_001")) {
+        BOOST_CHECK(!sr.isCrossGamma());
+        BOOST_CHECK(sr.key_1.keytype == RFType::FXSpot);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -811,6 +811,59 @@ void testPortfolioSensitivity(ObservationMode::Mode om) {
                                                                  << gamma << ", computed=" << gammaMap[p]);
     }
 
+    // Repeat analysis skipping unaffected trades, the results must be identical
+    QuantLib::ext::shared_ptr<SensitivityAnalysis> saSkip = QuantLib::ext::make_shared<SensitivityAnalysis>(
+        portfolio, initMarket, Market::defaultConfiguration, data, simMarketData, sensiData, false);
+    saSkip->skipUnaffectedTrades(true);
+    saSkip->generateSensitivities();
+    for (const auto& [pid, p] : portfolio->trades()) {
+        for (const auto& f : saSkip->sensiCube()->factors()) {
+            auto des = saSkip->sensiCube()->factorDescription(f);
+            BOOST_CHECK_CLOSE(saSkip->sensiCube()->delta(pid, f), deltaMap[make_pair(pid, des)], 1E-10);
+            BOOST_CHECK_CLOSE(saSkip->sensiCube()->gamma(pid, f), gammaMap[make_pair(pid, des)], 1E-10);
+        }
+    }
+
+    // Repeat analysis in incremental mode with blocks of two trades, the results must be identical
+    QuantLib::ext::shared_ptr<SensitivityAnalysis> saBlocks = QuantLib::ext::make_shared<SensitivityAnalysis>(
+        portfolio, initMarket, Market::defaultConfiguration, data, simMarketData, sensiData, false);
+    std::vector<QuantLib::ext::shared_ptr<SensitivityCube>> blockCubes;
+    saBlocks->setSensiCubeHandler(
+        2, [&blockCubes](const QuantLib::ext::shared_ptr<SensitivityCube>& c) { blockCubes.push_back(c); });
+    saBlocks->generateSensitivities();
+    BOOST_CHECK(saBlocks->sensiCubes().empty());
+    BOOST_CHECK_EQUAL(blockCubes.size(), (portfolio->size() + 1) / 2);
+    Size blockTrades = 0;
+    for (auto const& c : blockCubes) {
+        BOOST_CHECK(c->tradeIdx().size() <= 2);
+        for (auto const& [pid, _] : c->tradeIdx()) {
+            ++blockTrades;
+            for (const auto& f : c->factors()) {
+                auto des = c->factorDescription(f);
+                BOOST_CHECK_CLOSE(c->delta(pid, f), deltaMap[make_pair(pid, des)], 1E-10);
+                BOOST_CHECK_CLOSE(c->gamma(pid, f), gammaMap[make_pair(pid, des)], 1E-10);
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(blockTrades, portfolio->size());
+
+    // Repeat analysis valuing the swaps from their analytic deltas and gammas, the results agree with the full
+    // revaluation up to terms of third order in the shift size, the other trades are still repriced
+    QuantLib::ext::shared_ptr<SensitivityAnalysis> saAnalytic = QuantLib::ext::make_shared<SensitivityAnalysis>(
+        portfolio, initMarket, Market::defaultConfiguration, data, simMarketData, sensiData, false);
+    saAnalytic->analyticLinearSensitivities(true);
+    saAnalytic->generateSensitivities();
+    for (const auto& [pid, p] : portfolio->trades()) {
+        BOOST_CHECK_CLOSE(saAnalytic->sensiCube()->npv(pid), sa->sensiCube()->npv(pid), 1E-10);
+        for (const auto& f : saAnalytic->sensiCube()->factors()) {
+            auto des = saAnalytic->sensiCube()->factorDescription(f);
+            Real delta = deltaMap[make_pair(pid, des)];
+            Real gamma = gammaMap[make_pair(pid, des)];
+            BOOST_CHECK_SMALL(saAnalytic->sensiCube()->delta(pid, f) - delta, 0.05 + 1E-6 * std::abs(delta));
+            BOOST_CHECK_SMALL(saAnalytic->sensiCube()->gamma(pid, f) - gamma, 0.05 + 1E-6 * std::abs(gamma));
+        }
+    }
+
     BOOST_TEST_MESSAGE("Cube generated in " << t.format(default_places, "%w") << " seconds");
     ObservationMode::instance().setMode(backupMode);
     IndexManager::instance().clearHistories();
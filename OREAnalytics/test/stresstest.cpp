@@ -378,6 +378,16 @@ BOOST_AUTO_TEST_CASE(regression) {
     BOOST_CHECK_MESSAGE(count == cachedResults.size(), "number of non-zero stress impacts ("
                                                            << count << ") do not match regression data ("
                                                            << cachedResults.size() << ")");
+    BOOST_CHECK_EQUAL(analysis.scenarioTimes().size(), analysis.stressTests().size());
+
+    // repeat the analysis skipping unaffected trades, the results must be identical
+    ore::analytics::StressTest analysisSkip(portfolio, initMarket, "default", engineData, simMarketData, stressData,
+                                            CurveConfigurations(), TodaysMarketParameters(), nullptr, nullptr,
+                                            IborFallbackConfig::defaultConfig(), false, true);
+    BOOST_REQUIRE_EQUAL(analysisSkip.shiftedNPV().size(), shiftedNPV.size());
+    for (auto const& [p, npv] : shiftedNPV)
+        BOOST_CHECK_CLOSE(analysisSkip.shiftedNPV().at(p), npv, 1E-10);
+
     IndexManager::instance().clearHistories();
 }
 
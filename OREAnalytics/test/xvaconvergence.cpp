@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/aggregation/xvaconvergence.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+using namespace ore::analytics;
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(XvaConvergenceTest)
+
+BOOST_AUTO_TEST_CASE(testConvergenceMonitor) {
+
+    BOOST_TEST_MESSAGE("Testing xva convergence monitor...");
+
+    Date today(15, Jan, 2024);
+    std::vector<Date> dates = {today + 1 * Years, today + 2 * Years, today + 3 * Years};
+    Size samples = 1000;
+    auto cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(
+        today, std::set<std::string>{"trade_1", "trade_2", "trade_3"}, dates, samples);
+    auto cubeInterpretation = QuantLib::ext::make_shared<CubeInterpretation>(false, false);
+
+    MersenneTwisterUniformRng rng(42);
+    for (Size i = 0; i < 3; ++i)
+        for (Size j = 0; j < dates.size(); ++j)
+            for (Size k = 0; k < samples; ++k)
+                cube->set(100.0 * (rng.nextReal() - 0.4), i, j, k);
+
+    // netting set A holds trades 1 and 2, B holds trade 3 and tracks the EPE only
+    std::map<std::string, XvaConvergenceMonitor::NettingSet> nettingSets;
+    nettingSets["A"].tradeIndices = {0, 1};
+    nettingSets["A"].cvaWeights = {0.01, 0.02, 0.03};
+    nettingSets["A"].dvaWeights = {0.005, 0.005, 0.005};
+    nettingSets["A"].epeWeights = {1.0 / 3.0, 1.0 / 3.0, 1.0 / 3.0};
+    nettingSets["B"].tradeIndices = {2};
+    nettingSets["B"].epeWeights = {0.5, 0.25, 0.25};
+
+    // reference values for the CVA of netting set A
+    Real sum = 0.0, sumSquares = 0.0;
+    for (Size k = 0; k < samples; ++k) {
+        Real cva = 0.0;
+        for (Size j = 0; j < dates.size(); ++j)
+            cva += nettingSets["A"].cvaWeights[j] * std::max(cube->get(0, j, k) + cube->get(1, j, k), 0.0);
+        sum += cva;
+        sumSquares += cva * cva;
+    }
+    Real mean = sum / samples;
+    Real stdError = std::sqrt((sumSquares - samples * mean * mean) / (samples - 1.0) / samples);
+    Real z = InverseCumulativeNormal()(0.975);
+
+    // the statistics do not depend on the batches
+    XvaConvergenceMonitor monitor(cube, cubeInterpretation, nettingSets, 0.95, 0.0, 0.0);
+    monitor.update(0, 300);
+    monitor.update(300, samples);
+    BOOST_CHECK_EQUAL(monitor.samples(), samples);
+    auto const& a = monitor.statistics().at("A");
+    BOOST_CHECK(a.cva.tracked && a.dva.tracked && a.epe.tracked);
+    BOOST_CHECK_CLOSE(a.cva.estimate, mean, 1E-8);
+    BOOST_CHECK_CLOSE(a.cva.standardError, stdError, 1E-6);
+    BOOST_CHECK_CLOSE(a.cva.halfWidth, z * stdError, 1E-6);
+    auto const& b = monitor.statistics().at("B");
+    BOOST_CHECK(!b.cva.tracked && b.cva.converged && !b.dva.tracked && b.dva.converged && b.epe.tracked);
+
+    // zero tolerances are not met
+    BOOST_CHECK(!a.cva.converged);
+    BOOST_CHECK(!monitor.converged());
+
+    // a relative tolerance just above resp. below the relative half width of the CVA of netting set A
+    Real relativeHalfWidth = z * stdError / mean;
+    XvaConvergenceMonitor loose(cube, cubeInterpretation, nettingSets, 0.95, 1.0, 0.0);
+    loose.update(0, samples);
+    BOOST_CHECK(loose.converged());
+    XvaConvergenceMonitor tight(cube, cubeInterpretation, nettingSets, 0.95, 0.99 * relativeHalfWidth, 0.0);
+    tight.update(0, samples);
+    BOOST_CHECK(!tight.statistics().at("A").cva.converged);
+    XvaConvergenceMonitor justMet(cube, cubeInterpretation, nettingSets, 0.95, 1.01 * relativeHalfWidth, 0.0);
+    justMet.update(0, samples);
+    BOOST_CHECK(justMet.statistics().at("A").cva.converged);
+
+    // an absolute tolerance above all half widths
+    XvaConvergenceMonitor absolute(cube, cubeInterpretation, nettingSets, 0.95, 0.0, 1E6);
+    BOOST_CHECK(!absolute.converged());
+    absolute.update(0, 2);
+    BOOST_CHECK(absolute.converged());
+
+    BOOST_CHECK_THROW(monitor.update(samples - 1, samples + 1), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,7 @@
 
 #include <ored/marketdata/bondspreadimply.hpp>
 #include <ored/marketdata/bondspreadimplymarket.hpp>
+#include <ored/marketdata/bootstrapwarmstarts.hpp>
 
 #include <ored/portfolio/referencedata.hpp>
 #include <ored/marketdata/curvespecparser.hpp>
@@ -28,6 +29,7 @@
 #include <ored/portfolio/bondutils.hpp>
 
 #include <ql/instruments/bond.hpp>
+#include <ql/math/solvers1d/brent.hpp>
 #include <ql/pricingengines/bond/bondfunctions.hpp>
 
 #include <regex>
@@ -106,6 +108,93 @@ BondSpreadImply::requiredSecurities(const Date& asof, const QuantLib::ext::share
     return securities;
 }
 
+namespace {
+
+// a bond set up for the spread imply, the bond is built once per security and priced repeatedly by the solver
+struct SpreadImplyBond {
+    std::string securityId;
+    Real marketPrice;
+    BondBuilder::Result bond;
+    QuantLib::ext::shared_ptr<SimpleQuote> spreadQuote;
+    QuantLib::ext::shared_ptr<QuantExt::IterativeBootstrapWarmStart> warmStart;
+    // the effective clean price targeted by the solver
+    Real targetPrice = Null<Real>();
+    Real spread = Null<Real>();
+    std::string error;
+};
+
+// build the bond from reference data and determine the target price
+void setupBond(SpreadImplyBond& sb, const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceDataManager,
+               const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory,
+               const QuantLib::ext::shared_ptr<SimpleQuote>& spreadQuote) {
+
+    QL_REQUIRE(referenceDataManager, "no reference data manager given");
+
+    sb.spreadQuote = spreadQuote;
+    sb.bond = BondFactory::instance().build(engineFactory, referenceDataManager, sb.securityId);
+    Real adj = sb.bond.priceQuoteMethod == QuantExt::BondIndex::PriceQuoteMethod::CurrencyPerUnit
+                   ? 1.0 / sb.bond.priceQuoteBaseValue
+                   : 1.0;
+
+    Real inflationFactor = sb.bond.inflationFactor();
+    sb.targetPrice = sb.marketPrice * inflationFactor * adj;
+
+    DLOG("implySpread for securityId " << sb.securityId << ":");
+    DLOG("settlement date         = " << QuantLib::io::iso_date(sb.bond.bond->settlementDate()));
+    DLOG("market quote            = " << sb.marketPrice);
+    DLOG("accrueds                = " << sb.bond.bond->accruedAmount());
+    DLOG("inflation factor        = " << inflationFactor);
+    DLOG("price quote method adj  = " << adj);
+    DLOG("effective market price  = " << sb.targetPrice);
+
+    // edge case: bond has a zero settlement value -> skip spread imply
+
+    if (QuantLib::close_enough(sb.bond.bond->cleanPrice(), 0.0)) {
+        DLOG("bond has a theoretical clean price of zero (no outstanding flows as of settlement date) -> skip spread "
+             "imply and continue with zero security spread.");
+        sb.spread = 0.0;
+        return;
+    }
+
+    sb.warmStart = BootstrapWarmStarts::instance().warmStart("BondSpread/" + sb.securityId);
+}
+
+// solve for the spread, starting from the spread implied in a previous run if available
+void solveSpread(SpreadImplyBond& sb) {
+    auto targetFunction = [&sb](const Real& s) {
+        sb.spreadQuote->setValue(s);
+        if (sb.bond.modelBuilder != nullptr)
+            sb.bond.modelBuilder->recalibrate();
+        Real c = sb.bond.bond->cleanPrice() / 100.0;
+        TLOG("--> spread imply: trying s = " << s << " yields clean price " << c);
+        return c - sb.targetPrice;
+    };
+
+    Brent brent;
+    // the previous spread is only used for the same bond, which we identify by its maturity date
+    std::vector<Date> key(1, sb.bond.bond->maturityDate());
+    std::vector<Real> previous;
+    bool warmStarted = sb.warmStart && sb.warmStart->guess(key, previous), rejected = false;
+    if (warmStarted) {
+        try {
+            sb.spread = brent.solve(targetFunction, 1E-8, previous.front(), 1E-4);
+        } catch (const std::exception& e) {
+            DLOG("spread imply for security " << sb.securityId << " from previous spread " << previous.front()
+                                              << " failed (" << e.what() << "), retry from zero spread");
+            rejected = true;
+        }
+    }
+    if (!warmStarted || rejected)
+        sb.spread = brent.solve(targetFunction, 1E-8, 0.0, 0.001);
+
+    if (sb.warmStart) {
+        sb.warmStart->update(key, {sb.spread});
+        sb.warmStart->addStatistics(warmStarted && !rejected, rejected, 1, brent.evaluationNumber());
+    }
+}
+
+} // namespace
+
 QuantLib::ext::shared_ptr<Loader>
 BondSpreadImply::implyBondSpreads(const std::map<std::string, QuantLib::ext::shared_ptr<Security>>& securities,
                                   const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceDataManager,
@@ -126,27 +215,52 @@ BondSpreadImply::implyBondSpreads(const std::map<std::string, QuantLib::ext::sha
     auto engineFactory = QuantLib::ext::make_shared<EngineFactory>(edCopy, spreadImplyMarket, configurations,
                                                            referenceDataManager, iborFallbackConfig);
 
-    // imply spreads and store the generate market data
+    /* Each bond is built once, the solver then only sets its spread quote and reprices it. The securities are
+       processed sequentially, since pricing the bonds calculates lazy objects shared between them (curves, indices)
+       and uses global singletons. */
 
-    std::map<std::string, QuantLib::ext::shared_ptr<MarketDatum>> generatedSpreads;
+    std::vector<SpreadImplyBond> bonds;
     for (auto const& sec : securities) {
-        auto storedSpread = generatedSpreads.find(sec.first);
-        if (storedSpread == generatedSpreads.end()) {
-            try {
-                auto impliedSpread = QuantLib::ext::make_shared<SecuritySpreadQuote>(
-                    implySpread(sec.first, sec.second->price()->value(), referenceDataManager, engineFactory,
-                                spreadImplyMarket->spreadQuote(sec.first), configuration),
-                    market->asofDate(), "BOND/YIELD_SPREAD/" + sec.first, sec.first);
-                generatedSpreads[sec.first] = impliedSpread;
-                LOG("spread imply succeded for security " << sec.first << ", got " << std::setprecision(10)
-                                                          << impliedSpread->quote()->value());
-            } catch (const std::exception& e) {
-                StructuredCurveErrorMessage(
-                    sec.first,
-                    "bond spread imply failed (target price = " + std::to_string(sec.second->price()->value()) +
-                        "). Will continue the calculations with a zero security spread.",
-                    e.what()).log();
-            }
+        SpreadImplyBond sb;
+        sb.securityId = sec.first;
+        sb.marketPrice = sec.second->price()->value();
+        try {
+            setupBond(sb, referenceDataManager, engineFactory, spreadImplyMarket->spreadQuote(sec.first));
+            if (sb.spread == Null<Real>())
+                solveSpread(sb);
+        } catch (const std::exception& e) {
+            sb.error = e.what();
+        }
+        bonds.push_back(sb);
+    }
+
+    // store the generated market data
+
+    std::map<std::string, QuantLib::ext::shared_ptr<MarketDatum>> generatedSpreads;
+    for (auto const& sb : bonds) {
+        if (sb.error.empty()) {
+            auto impliedSpread = QuantLib::ext::make_shared<SecuritySpreadQuote>(
+                sb.spread, market->asofDate(), "BOND/YIELD_SPREAD/" + sb.securityId, sb.securityId);
+            generatedSpreads[sb.securityId] = impliedSpread;
+            DLOG("theoretical pricing for security " << sb.securityId << " = " << sb.bond.bond->cleanPrice() / 100.0);
+            LOG("spread imply succeded for security " << sb.securityId << ", got " << std::setprecision(10)
+                                                      << impliedSpread->quote()->value());
+        } else {
+            StructuredCurveErrorMessage(sb.securityId,
+                                        "bond spread imply failed (target price = " + std::to_string(sb.marketPrice) +
+                                            "). Will continue the calculations with a zero security spread.",
+                                        sb.error)
+                .log();
+        }
+    }
+
+    for (auto const& sb : bonds) {
+        if (sb.warmStart) {
+            auto stats = sb.warmStart->statistics();
+            DLOG("Spread imply statistics for " << sb.securityId << ": " << stats.calculations << " calculations, "
+                                                << stats.hits << " warm start hits, " << stats.rejections
+                                                << " warm start rejections, " << stats.evaluations
+                                                << " price evaluations");
         }
     }
 
@@ -164,55 +278,5 @@ BondSpreadImply::implyBondSpreads(const std::map<std::string, QuantLib::ext::sha
     return loader;
 }
 
-Real BondSpreadImply::implySpread(const std::string& securityId, const Real cleanPrice,
-                                  const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceDataManager,
-                                  const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory,
-                                  const QuantLib::ext::shared_ptr<SimpleQuote>& spreadQuote, const std::string& configuration) {
-
-    // checks, build bond from reference data
-
-    QL_REQUIRE(referenceDataManager, "no reference data manager given");
-
-    auto b = BondFactory::instance().build(engineFactory, referenceDataManager, securityId);
-    Real adj = b.priceQuoteMethod == QuantExt::BondIndex::PriceQuoteMethod::CurrencyPerUnit
-                   ? 1.0 / b.priceQuoteBaseValue
-                   : 1.0;
-
-    Real inflationFactor = b.inflationFactor();
-
-    DLOG("implySpread for securityId " << securityId << ":");
-    DLOG("settlement date         = " << QuantLib::io::iso_date(b.bond->settlementDate()));
-    DLOG("market quote            = " << cleanPrice);
-    DLOG("accrueds                = " << b.bond->accruedAmount());
-    DLOG("inflation factor        = " << inflationFactor);
-    DLOG("price quote method adj  = " << adj);
-    DLOG("effective market price  = " << cleanPrice * inflationFactor * adj);
-
-    auto targetFunction = [&b, spreadQuote, cleanPrice, adj, inflationFactor](const Real& s) {
-        spreadQuote->setValue(s);
-        if (b.modelBuilder != nullptr)
-            b.modelBuilder->recalibrate();
-        Real c = b.bond->cleanPrice() / 100.0;
-        TLOG("--> spread imply: trying s = " << s << " yields clean price " << c);
-        return c - cleanPrice * inflationFactor * adj;
-    };
-
-    // edge case: bond has a zero settlement value -> skip spread imply
-
-    if (QuantLib::close_enough(b.bond->cleanPrice(), 0.0)) {
-        DLOG("bond has a theoretical clean price of zero (no outstanding flows as of settlement date) -> skip spread "
-             "imply and continue with zero security spread.");
-        return 0.0;
-    }
-
-    // solve for spread and return result
-
-    Brent brent;
-    Real s = brent.solve(targetFunction, 1E-8, 0.0, 0.001);
-
-    DLOG("theoretical pricing     = " << b.bond->cleanPrice() / 100.0);
-    return s;
-}
-
 } // namespace data
 } // namespace ore
@@ -41,19 +41,14 @@ public:
                        const QuantLib::ext::shared_ptr<CurveConfigurations>& curveConfigs, const Loader& loader,
                        const bool continueOnError = false, const std::string& excludeRegex = std::string());
 
-    /*! Imply bond spreads and add them to the loader. */
+    /*! Imply bond spreads and add them to the loader. Each bond is built once and priced repeatedly by the solver.
+        If the bootstrap warm start is enabled, the solver starts from the spread implied for the same security in a
+        previous run. */
     static QuantLib::ext::shared_ptr<Loader>
     implyBondSpreads(const std::map<std::string, QuantLib::ext::shared_ptr<Security>>& securities,
                      const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceDataManager,
                      const QuantLib::ext::shared_ptr<Market>& market, const QuantLib::ext::shared_ptr<EngineData>& engineData,
                      const std::string& configuration, const IborFallbackConfig& iborFallbackConfig);
-
-private:
-    //! helper function that computes a single implied spread for a bond
-    static Real implySpread(const std::string& securityId, const Real cleanPrice,
-                            const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceDataManager,
-                            const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory,
-                            const QuantLib::ext::shared_ptr<SimpleQuote>& spreadQuote, const std::string& configuration);
 };
 
 } // namespace data
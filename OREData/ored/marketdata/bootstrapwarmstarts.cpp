@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/marketdata/bootstrapwarmstarts.hpp>
+
+namespace ore {
+namespace data {
+
+void BootstrapWarmStarts::enable(const bool b) {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    enabled_ = b;
+    if (!enabled_)
+        warmStarts_.clear();
+}
+
+bool BootstrapWarmStarts::enabled() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return enabled_;
+}
+
+QuantLib::ext::shared_ptr<QuantExt::IterativeBootstrapWarmStart>
+BootstrapWarmStarts::warmStart(const std::string& curveSpec) {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    if (!enabled_)
+        return nullptr;
+    auto& w = warmStarts_[curveSpec];
+    if (!w)
+        w = QuantLib::ext::make_shared<QuantExt::IterativeBootstrapWarmStart>();
+    return w;
+}
+
+std::map<std::string, QuantExt::IterativeBootstrapWarmStart::Statistics> BootstrapWarmStarts::statistics() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    std::map<std::string, QuantExt::IterativeBootstrapWarmStart::Statistics> result;
+    for (auto const& w : warmStarts_)
+        result[w.first] = w.second->statistics();
+    return result;
+}
+
+void BootstrapWarmStarts::clear() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    warmStarts_.clear();
+}
+
+} // namespace data
+} // namespace ore
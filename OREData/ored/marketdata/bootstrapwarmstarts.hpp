@@ -0,0 +1,63 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file marketdata/bootstrapwarmstarts.hpp
+    \brief warm start data for bootstrapped curves, shared across market builds
+    \ingroup marketdata
+*/
+
+#pragma once
+
+#include <qle/termstructures/iterativebootstrapwarmstart.hpp>
+
+#include <ql/patterns/singleton.hpp>
+
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <map>
+#include <string>
+
+namespace ore {
+namespace data {
+
+//! Warm start data for bootstrapped curves
+/*! Stores one QuantExt::IterativeBootstrapWarmStart per curve spec, so that a curve built again in a later market
+    build, e.g. in a stress or sensitivity run rebuilding the market with slightly changed quotes, is bootstrapped
+    starting from the solution of the previous build. The warm start is disabled by default, since the results then
+    depend on the previous builds within the bootstrap accuracy. */
+class BootstrapWarmStarts : public QuantLib::Singleton<BootstrapWarmStarts, std::integral_constant<bool, true>> {
+public:
+    //! enables or disables the warm start, disabling it removes the stored data
+    void enable(const bool b);
+    bool enabled() const;
+    //! the warm start data for a curve spec, or null if the warm start is disabled
+    QuantLib::ext::shared_ptr<QuantExt::IterativeBootstrapWarmStart> warmStart(const std::string& curveSpec);
+    //! the bootstrap statistics by curve spec
+    std::map<std::string, QuantExt::IterativeBootstrapWarmStart::Statistics> statistics() const;
+    //! removes the stored data
+    void clear();
+
+private:
+    mutable boost::shared_mutex mutex_;
+    bool enabled_ = false;
+    std::map<std::string, QuantLib::ext::shared_ptr<QuantExt::IterativeBootstrapWarmStart>> warmStarts_;
+};
+
+} // namespace data
+} // namespace ore
@@ -38,6 +38,7 @@ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 #include <ql/time/calendars/weekendsonly.hpp>
 #include <qle/indexes/commodityindex.hpp>
 #include <qle/math/flatextrapolation.hpp>
+#include <qle/math/vectorisedblackformula.hpp>
 #include <qle/termstructures/aposurface.hpp>
 #include <qle/termstructures/blackinvertedvoltermstructure.hpp>
 #include <qle/termstructures/blackvariancesurfacemoneyness.hpp>
@@ -1895,22 +1896,43 @@ void CommodityVolCurve::buildVolCalibrationInfo(const Date& asof, QuantLib::ext:
                 std::vector<std::vector<bool>>(times.size(), std::vector<bool>(moneyness.size(), true));
             for (Size i = 0; i < times.size(); ++i) {
                 Real t = times[i];
+                Real disc = Null<Real>();
+                // collect the valid strikes and std devs of the expiry, the prices are computed in one batch below
+                std::vector<Size> valid;
+                std::vector<Real> strikes, stdDevs;
                 for (Size j = 0; j < moneyness.size(); ++j) {
                     try {
                         Real strike = moneyness[j] * forwards[i];
                         info->moneynessGridStrikes[i][j] = strike;
                         Real stddev = std::sqrt(volatility_->blackVariance(t, strike));
-                        callPricesMoneyness[i][j] = blackFormula(Option::Call, strike, forwards[i], stddev);
                         info->moneynessGridImpliedVolatility[i][j] = stddev / std::sqrt(t);
-                        if (moneyness[j] >= 1) {
-                            calibrationInfo_->moneynessCallPrices[i][j] = blackFormula(Option::Call, strike, forwards[i], stddev, yts_->discount(t));
-                        } else {
-                            calibrationInfo_->moneynessPutPrices[i][j] = blackFormula(Option::Put, strike, forwards[i], stddev, yts_->discount(t));
-                        };
+                        if (disc == Null<Real>())
+                            disc = yts_->discount(t);
+                        QL_REQUIRE(strike >= 0.0 && forwards[i] > 0.0 && stddev >= 0.0 && disc > 0.0,
+                                   "invalid black formula input: strike " << strike << ", forward " << forwards[i]
+                                       << ", stddev " << stddev << ", discount " << disc);
+                        valid.push_back(j);
+                        strikes.push_back(strike);
+                        stdDevs.push_back(stddev);
                     } catch (const std::exception& e) {
                         TLOG("CommodityVolCurve: error for time " << t << " moneyness " << moneyness[j] << ": " << e.what());
                     }
                 }
+                Size n = valid.size();
+                std::vector<Real> fwds(n, forwards[i]), ones(n, 1.0), discs(n, disc), calls(n), puts(n);
+                QuantExt::vectorisedBlackFormula(Option::Call, strikes.data(), fwds.data(), stdDevs.data(),
+                                                 ones.data(), n, calls.data());
+                QuantExt::vectorisedBlackFormula(Option::Put, strikes.data(), fwds.data(), stdDevs.data(),
+                                                 discs.data(), n, puts.data());
+                for (Size k = 0; k < n; ++k) {
+                    Size j = valid[k];
+                    callPricesMoneyness[i][j] = calls[k];
+                    if (moneyness[j] >= 1) {
+                        info->moneynessCallPrices[i][j] = calls[k] * disc;
+                    } else {
+                        info->moneynessPutPrices[i][j] = puts[k];
+                    }
+                }
             }
             if (!times.empty() && !moneyness.empty()) {
                 try {
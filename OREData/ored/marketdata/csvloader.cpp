@@ -22,13 +22,17 @@
 */
 
 #include <algorithm>
-#include <boost/algorithm/string.hpp>
-#include <fstream>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cctype>
+#include <cstring>
+#include <iterator>
 #include <map>
 #include <ored/marketdata/csvloader.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <qle/math/chunkworkers.hpp>
 
 using namespace std;
 
@@ -36,26 +40,31 @@ namespace ore {
 namespace data {
 
 CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename, bool implyTodaysFixings,
-		     Date fixingCutOffDate)
-    : CSVLoader(marketFilename, fixingFilename, "", implyTodaysFixings, fixingCutOffDate) {}
+		     Date fixingCutOffDate, Size nThreads, bool loadFixingsOnDemand)
+    : CSVLoader(marketFilename, fixingFilename, "", implyTodaysFixings, fixingCutOffDate, nThreads,
+                loadFixingsOnDemand) {}
 
-CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles, bool implyTodaysFixings, Date fixingCutOffDate)
-    : CSVLoader(marketFiles, fixingFiles, {}, implyTodaysFixings, fixingCutOffDate) {}
+CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles, bool implyTodaysFixings,
+                     Date fixingCutOffDate, Size nThreads, bool loadFixingsOnDemand)
+    : CSVLoader(marketFiles, fixingFiles, {}, implyTodaysFixings, fixingCutOffDate, nThreads, loadFixingsOnDemand) {}
 
 CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename, const string& dividendFilename,
-                     bool implyTodaysFixings, Date fixingCutOffDate)
-    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate) {
+                     bool implyTodaysFixings, Date fixingCutOffDate, Size nThreads, bool loadFixingsOnDemand)
+    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate), nThreads_(nThreads),
+      loadFixingsOnDemand_(loadFixingsOnDemand), fixingFiles_(1, fixingFilename) {
 
     // load market data
     loadFile(marketFilename, DataType::Market);
     // log
-    for (auto it : data_) {
+    for (auto const& it : data_) {
         LOG("CSVLoader loaded " << it.second.size() << " market data points for " << it.first);
     }
 
     // load fixings
-    loadFile(fixingFilename, DataType::Fixing);
-    LOG("CSVLoader loaded " << fixings_.size() << " fixings");
+    if (!loadFixingsOnDemand_) {
+        loadFile(fixingFilename, DataType::Fixing);
+        LOG("CSVLoader loaded " << fixings_.size() << " fixings");
+    }
 
     // load dividends
     if (dividendFilename != "") {
@@ -68,21 +77,24 @@ CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename,
 
 CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles,
                      const vector<string>& dividendFiles, bool implyTodaysFixings,
-		     Date fixingCutOffDate)
-    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate) {
+		     Date fixingCutOffDate, Size nThreads, bool loadFixingsOnDemand)
+    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate), nThreads_(nThreads),
+      loadFixingsOnDemand_(loadFixingsOnDemand), fixingFiles_(fixingFiles) {
 
     for (auto marketFile : marketFiles)
         // load market data
         loadFile(marketFile, DataType::Market);
 
     // log
-    for (auto it : data_)
+    for (auto const& it : data_)
         LOG("CSVLoader loaded " << it.second.size() << " market data points for " << it.first);
 
-    for (auto fixingFile : fixingFiles)
-        // load fixings
-        loadFile(fixingFile, DataType::Fixing);
-    LOG("CSVLoader loaded " << fixings_.size() << " fixings");
+    if (!loadFixingsOnDemand_) {
+        for (auto fixingFile : fixingFiles)
+            // load fixings
+            loadFile(fixingFile, DataType::Fixing);
+        LOG("CSVLoader loaded " << fixings_.size() << " fixings");
+    }
 
     for (auto dividendFile : dividendFiles)
         // load dividends
@@ -92,116 +104,335 @@ CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fi
     LOG("CSVLoader complete.");
 }
 
-QuantLib::ext::shared_ptr<MarketDatum> makeDummyMarketDatum(const Date& d, const std::string& name) {
-    return QuantLib::ext::make_shared<MarketDatum>(0.0, d, name, MarketDatum::QuoteType::NONE,
-                                           MarketDatum::InstrumentType::NONE);
+namespace {
+
+// call f for each line in [begin, end), with leading and trailing whitespace removed
+template <class F> void forEachLine(const char* begin, const char* end, F f) {
+    while (begin < end) {
+        const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        const char* lineEnd = eol == nullptr ? end : eol;
+        const char* lineBegin = begin;
+        begin = eol == nullptr ? end : eol + 1;
+        while (lineBegin != lineEnd && std::isspace(static_cast<unsigned char>(*lineBegin)))
+            ++lineBegin;
+        while (lineEnd != lineBegin && std::isspace(static_cast<unsigned char>(*(lineEnd - 1))))
+            --lineEnd;
+        f(lineBegin, lineEnd);
+    }
 }
 
-void CSVLoader::loadFile(const string& filename, DataType dataType) {
-    LOG("CSVLoader loading from " << filename);
+// split [begin, end) like boost::split(tokens, line, is_any_of(",;\t "), token_compress_on), reusing the strings
+void tokenize(const char* begin, const char* end, vector<string>& tokens) {
+    auto isSeparator = [](const char c) { return c == ',' || c == ';' || c == '\t' || c == ' '; };
+    Size n = 0;
+    const char* tokenBegin = begin;
+    const char* p = begin;
+    while (true) {
+        if (p == end || isSeparator(*p)) {
+            if (n == tokens.size())
+                tokens.emplace_back();
+            tokens[n++].assign(tokenBegin, p);
+            if (p == end)
+                break;
+            while (p != end && isSeparator(*p))
+                ++p;
+            tokenBegin = p;
+        } else {
+            ++p;
+        }
+    }
+    tokens.resize(n);
+}
 
-    Date today = QuantLib::Settings::instance().evaluationDate();
+// a tokenised line of a market data or dividend file
+struct CSVRecord {
+    Date date;
+    string key;
+    Real value;
+    Date payDate;
+    // market data only, the parsed datum or the parse error
+    QuantLib::ext::shared_ptr<MarketDatum> datum;
+    string error;
+};
+
+// memory-map the file, returns false if the file is empty
+bool mapFile(const string& filename, boost::iostreams::mapped_file_source& file) {
+    QL_REQUIRE(boost::filesystem::exists(filename), "error opening file " << filename);
+    if (boost::filesystem::file_size(filename) == 0)
+        return false;
+    try {
+        file.open(filename);
+    } catch (const std::exception& e) {
+        QL_FAIL("error mapping file " << filename << ": " << e.what());
+    }
+    return true;
+}
+
+// split [data, dataEnd) into chunks ending at line boundaries, returns the chunk bounds
+vector<const char*> chunkBounds(const char* const data, const char* const dataEnd, const Size nThreads) {
+    Size nChunks = std::min<Size>(4 * nThreads, std::max<Size>(1, (dataEnd - data) / (1 << 16)));
+    vector<const char*> bounds(1, data);
+    for (Size i = 1; i < nChunks; ++i) {
+        const char* b = std::max(bounds.back(), data + (dataEnd - data) * i / nChunks);
+        const char* eol = static_cast<const char*>(std::memchr(b, '\n', dataEnd - b));
+        if (eol == nullptr)
+            break;
+        if (eol + 1 > bounds.back())
+            bounds.push_back(eol + 1);
+    }
+    if (bounds.back() != dataEnd)
+        bounds.push_back(dataEnd);
+    return bounds;
+}
+
+} // namespace
 
-    ifstream file;
-    file.open(filename.c_str());
-    QL_REQUIRE(file.is_open(), "error opening file " << filename);
+void CSVLoader::loadFile(const string& filename, DataType dataType) {
+    if (dataType == DataType::Fixing) {
+        loadFixingFile(filename, nullptr, fixings_);
+        return;
+    }
 
-    while (!file.eof()) {
-        string line;
-        getline(file, line);
-        boost::trim(line);
-        // skip blank and comment lines
-        if (line.size() > 0 && line[0] != '#') {
+    LOG("CSVLoader loading from " << filename);
 
-            vector<string> tokens;
-            boost::trim(line);
-            boost::split(tokens, line, boost::is_any_of(",;\t "), boost::token_compress_on);
+    Date today = QuantLib::Settings::instance().evaluationDate();
 
+    boost::iostreams::mapped_file_source file;
+    if (!mapFile(filename, file)) {
+        LOG("CSVLoader completed processing " << filename);
+        return;
+    }
+    const char* const data = file.data();
+    const char* const dataEnd = data + file.size();
+
+    QuantExt::ChunkWorkers workers(nThreads_);
+    vector<const char*> bounds = chunkBounds(data, dataEnd, workers.nThreads());
+    Size nChunks = bounds.size() - 1;
+
+    // tokenise the chunks, dividends outside the relevant date range are dropped here
+    vector<vector<CSVRecord>> records(nChunks);
+    workers.run(nChunks, [&](const Size i) {
+        vector<string> tokens;
+        forEachLine(bounds[i], bounds[i + 1], [&](const char* b, const char* e) {
+            // skip blank and comment lines
+            if (b == e || *b == '#')
+                return;
+            tokenize(b, e, tokens);
             // TODO: should we try, catch and log any invalid lines?
-            QL_REQUIRE(tokens.size() == 3 || tokens.size() == 4, "Invalid CSVLoader line, 3 tokens expected " << line);
+            QL_REQUIRE(tokens.size() == 3 || tokens.size() == 4,
+                       "Invalid CSVLoader line, 3 tokens expected " << string(b, e));
             if (tokens.size() == 4)
                 QL_REQUIRE(dataType == DataType::Dividend, "CSVLoader, dataType must be of type Dividend");
             Date date = parseDate(tokens[0]);
-            const string& key = tokens[1];
             Real value = parseReal(tokens[2]);
-
             if (dataType == DataType::Market) {
-                // process market
-                // build market datum and add to map
+                // the market datum is parsed here in parallel, parse errors are logged below in file order
+                records[i].push_back({date, tokens[1], value, Date(), nullptr, string()});
                 try {
-                    QuantLib::ext::shared_ptr<MarketDatum> md;
-                    try {
-                        md = parseMarketDatum(date, key, value);
-                    } catch (std::exception& e) {
-                        WLOG("Failed to parse MarketDatum " << key << ": " << e.what());
-                    }
+                    records[i].back().datum = parseMarketDatum(date, records[i].back().key, value);
+                } catch (std::exception& e) {
+                    records[i].back().error = e.what();
+                }
+            } else if (dataType == DataType::Dividend) {
+                Date payDate = date;
+                if (tokens.size() == 4)
+                    payDate = parseDate(tokens[3]);
+                if (date <= today)
+                    records[i].push_back({date, tokens[1], value, payDate});
+            } else {
+                QL_FAIL("unknown data type");
+            }
+        });
+    });
+
+    if (dataType == DataType::Market) {
+        // process market, add the market datum to the map in file order
+        for (auto const& chunk : records) {
+            for (auto const& r : chunk) {
+                const Date& date = r.date;
+                const string& key = r.key;
+                try {
+                    const QuantLib::ext::shared_ptr<MarketDatum>& md = r.datum;
+                    if (!r.error.empty())
+                        WLOG("Failed to parse MarketDatum " << key << ": " << r.error);
                     if (md != nullptr) {
                         std::pair<bool, string> addFX = {true, ""};
                         if (md->instrumentType() == MarketDatum::InstrumentType::FX_SPOT &&
                             md->quoteType() == MarketDatum::QuoteType::RATE) {
                             addFX = checkFxDuplicate(md, date);
                             if (!addFX.second.empty()) {
-                                auto it2 = data_[date].find(makeDummyMarketDatum(date, addFX.second));
                                 TLOG("Replacing MarketDatum " << addFX.second << " with " << key
-                                                                  << " due to FX Dominance.");
-                                if (it2 != data_[date].end())
-                                    data_[date].erase(it2);
+                                                              << " due to FX Dominance.");
+                                data_[date].erase(addFX.second);
                             }
                         }
-                        if (addFX.first && data_[date].insert(md).second) {
+                        if (addFX.first && data_[date].insert(md)) {
                             LOG("Added MarketDatum " << key);
                         } else if (!addFX.first) {
                             LOG("Skipped MarketDatum " << key << " - dominant FX already present.")
-                        }
-						else {
+                        } else {
                             LOG("Skipped MarketDatum " << key << " - this is already present.");
                         }
                     }
                 } catch (std::exception& e) {
                     WLOG("Failed to parse MarketDatum " << key << ": " << e.what());
                 }
-            } else if (dataType == DataType::Fixing) {
-                // process fixings
-                if (date < today || (date == today && !implyTodaysFixings_)
-		    || (fixingCutOffDate_ != Date() && date <= fixingCutOffDate_)) {
-                    if(!fixings_.insert(Fixing(date, key, value)).second) {
-                        WLOG("Skipped Fixing " << key << "@" << QuantLib::io::iso_date(date)
-                                               << " - this is already present.");
-                    }
-                }
-            } else if (dataType == DataType::Dividend) {
-                Date payDate = date;
-                if (tokens.size() == 4)
-                    payDate = parseDate(tokens[3]);
-                // process dividends
-                if (date <= today) {
-                    if (!dividends_.insert(QuantExt::Dividend(date, key, value, payDate)).second) {
-                        WLOG("Skipped Dividend " << key << "@" << QuantLib::io::iso_date(date)
-                                                 << " - this is already present.");
-                    }
+            }
+        }
+    } else if (dataType == DataType::Dividend) {
+        // process dividends
+        for (auto const& chunk : records) {
+            for (auto const& r : chunk) {
+                if (!dividends_.insert(QuantExt::Dividend(r.date, r.key, r.value, r.payDate)).second) {
+                    WLOG("Skipped Dividend " << r.key << "@" << QuantLib::io::iso_date(r.date)
+                                             << " - this is already present.");
                 }
-            } else {
-                QL_FAIL("unknown data type");
             }
         }
     }
-    file.close();
     LOG("CSVLoader completed processing " << filename);
 }
 
+void CSVLoader::loadFixingFile(const string& filename,
+                               const std::map<std::string, std::set<QuantLib::Date>>* requiredFixings,
+                               std::set<Fixing>& fixings) const {
+    LOG("CSVLoader loading fixings from " << filename
+                                          << (requiredFixings ? " (required fixings only)" : " (all fixings)"));
+
+    Date today = QuantLib::Settings::instance().evaluationDate();
+
+    boost::iostreams::mapped_file_source file;
+    if (!mapFile(filename, file)) {
+        LOG("CSVLoader completed processing " << filename);
+        return;
+    }
+    const char* const data = file.data();
+    const char* const dataEnd = data + file.size();
+
+    QuantExt::ChunkWorkers workers(nThreads_);
+    vector<const char*> bounds = chunkBounds(data, dataEnd, workers.nThreads());
+    Size nChunks = bounds.size() - 1;
+
+    /* tokenise the chunks, fixings outside the relevant date range and - if required fixings are given - fixings
+       that are not required are dropped here, so that they are never held in memory */
+    vector<vector<Fixing>> chunkFixings(nChunks);
+    workers.run(nChunks, [&](const Size i) {
+        vector<string> tokens;
+        forEachLine(bounds[i], bounds[i + 1], [&](const char* b, const char* e) {
+            // skip blank and comment lines
+            if (b == e || *b == '#')
+                return;
+            tokenize(b, e, tokens);
+            QL_REQUIRE(tokens.size() == 3, "Invalid CSVLoader line, 3 tokens expected " << string(b, e));
+            Date date = parseDate(tokens[0]);
+            if (requiredFixings) {
+                auto r = requiredFixings->find(tokens[1]);
+                if (r == requiredFixings->end() || r->second.find(date) == r->second.end())
+                    return;
+            }
+            if (date < today || (date == today && !implyTodaysFixings_) ||
+                (fixingCutOffDate_ != Date() && date <= fixingCutOffDate_))
+                chunkFixings[i].emplace_back(date, tokens[1], parseReal(tokens[2]));
+        });
+    });
+
+    // sort the chunks and merge them pairwise, all sorts are stable, so that a fixing given several times keeps its
+    // first occurrence in file order, as with a direct insertion into the set
+    workers.run(nChunks,
+                [&chunkFixings](const Size i) { std::stable_sort(chunkFixings[i].begin(), chunkFixings[i].end()); });
+    vector<Size> offsets(nChunks + 1, 0);
+    for (Size i = 0; i < nChunks; ++i)
+        offsets[i + 1] = offsets[i] + chunkFixings[i].size();
+    vector<Fixing> sorted;
+    sorted.reserve(offsets.back());
+    for (auto& chunk : chunkFixings) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(sorted));
+        vector<Fixing>().swap(chunk);
+    }
+    for (Size width = 1; width < nChunks; width *= 2) {
+        workers.run((nChunks + 2 * width - 1) / (2 * width), [&sorted, &offsets, nChunks, width](const Size j) {
+            Size first = 2 * j * width, middle = first + width, last = std::min(first + 2 * width, nChunks);
+            if (middle < last)
+                std::inplace_merge(sorted.begin() + offsets[first], sorted.begin() + offsets[middle],
+                                   sorted.begin() + offsets[last]);
+        });
+    }
+    // the input is sorted, so inserting at the position after the previous fixing is amortised constant time
+    auto hint = fixings.end();
+    for (auto& f : sorted) {
+        Size n = fixings.size();
+        hint = fixings.insert(hint, std::move(f));
+        if (fixings.size() == n) {
+            WLOG("Skipped Fixing " << hint->name << "@" << QuantLib::io::iso_date(hint->date)
+                                   << " - this is already present.");
+        }
+        ++hint;
+    }
+    LOG("CSVLoader completed processing " << filename);
+}
+
+std::set<Fixing> CSVLoader::loadFixings() const {
+    if (!loadFixingsOnDemand_)
+        return fixings_;
+    std::set<Fixing> result;
+    for (auto const& f : fixingFiles_)
+        loadFixingFile(f, nullptr, result);
+    LOG("CSVLoader loaded " << result.size() << " fixings on demand");
+    return result;
+}
+
+std::set<Fixing>
+CSVLoader::loadFixings(const std::map<std::string, std::set<QuantLib::Date>>& requiredFixings) const {
+    std::set<Fixing> result;
+    if (loadFixingsOnDemand_) {
+        for (auto const& f : fixingFiles_)
+            loadFixingFile(f, &requiredFixings, result);
+    } else {
+        // the fixings are ordered by name and date, look up each index and walk its dates
+        for (auto const& [name, dates] : requiredFixings) {
+            if (dates.empty())
+                continue;
+            auto it = fixings_.lower_bound(Fixing(*dates.begin(), name, 0.0));
+            for (auto const& d : dates) {
+                while (it != fixings_.end() && it->name == name && it->date < d)
+                    ++it;
+                if (it == fixings_.end() || it->name != name)
+                    break;
+                if (it->date == d)
+                    result.insert(result.end(), *it);
+            }
+        }
+    }
+    LOG("CSVLoader loaded " << result.size() << " required fixings for " << requiredFixings.size() << " indices");
+    return result;
+}
+
+bool CSVLoader::hasFixing(const string& name, const QuantLib::Date& d) const {
+    return !getFixing(name, d).empty();
+}
+
+Fixing CSVLoader::getFixing(const string& name, const QuantLib::Date& d) const {
+    if (loadFixingsOnDemand_) {
+        auto f = loadFixings({{name, {d}}});
+        return f.empty() ? Fixing() : *f.begin();
+    }
+    auto it = fixings_.find(Fixing(d, name, 0.0));
+    return it == fixings_.end() ? Fixing() : *it;
+}
+
 vector<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::loadQuotes(const QuantLib::Date& d) const {
     auto it = data_.find(d);
     if (it == data_.end())
         return {};
-    return std::vector<QuantLib::ext::shared_ptr<MarketDatum>>(it->second.begin(), it->second.end());
+    return it->second.data();
 }
 
 QuantLib::ext::shared_ptr<MarketDatum> CSVLoader::get(const string& name, const QuantLib::Date& d) const {
     auto it = data_.find(d);
     QL_REQUIRE(it != data_.end(), "No datum for " << name << " on date " << d);
-    auto it2 = it->second.find(makeDummyMarketDatum(d, name));
-    QL_REQUIRE(it2 != it->second.end(), "No datum for " << name << " on date " << d);
-    return *it2;
+    auto md = it->second.get(name);
+    QL_REQUIRE(md != nullptr, "No datum for " << name << " on date " << d);
+    return md;
 }
 
 std::set<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::get(const std::set<std::string>& names,
@@ -211,43 +442,18 @@ std::set<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::get(const std::set<s
         return {};
     std::set<QuantLib::ext::shared_ptr<MarketDatum>> result;
     for (auto const& n : names) {
-        auto it2 = it->second.find(makeDummyMarketDatum(asof, n));
-        if (it2 != it->second.end())
-            result.insert(*it2);
+        if (auto md = it->second.get(n))
+            result.insert(md);
     }
     return result;
 }
 
 std::set<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::get(const Wildcard& wildcard,
                                                              const QuantLib::Date& asof) const {
-    if (!wildcard.hasWildcard()) {
-        // no wildcard => use get by name function
-        try {
-            return {get(wildcard.pattern(), asof)};
-        } catch (...) {
-        }
-        return {};
-    }
     auto it = data_.find(asof);
     if (it == data_.end())
         return {};
-    std::set<QuantLib::ext::shared_ptr<MarketDatum>> result;
-    std::set<QuantLib::ext::shared_ptr<MarketDatum>>::iterator it1, it2;
-    if (wildcard.wildcardPos() == 0) {
-        // wildcard at first position => we have to search all of the data
-        it1 = it->second.begin();
-        it2 = it->second.end();
-    } else {
-        // search the range matching the substring of the pattern until the wildcard
-        std::string prefix = wildcard.pattern().substr(0, wildcard.wildcardPos());
-        it1 = it->second.lower_bound(makeDummyMarketDatum(asof, prefix));
-        it2 = it->second.upper_bound(makeDummyMarketDatum(asof, prefix + "\xFF"));
-    }
-    for (auto it = it1; it != it2; ++it) {
-        if (wildcard.isPrefix() || wildcard.matches((*it)->name()))
-            result.insert(*it);
-    }
-    return result;
+    return it->second.get(wildcard);
 }
 } // namespace data
 } // namespace ore
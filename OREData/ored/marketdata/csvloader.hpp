@@ -24,6 +24,7 @@
 #pragma once
 
 #include <map>
+#include <ored/marketdata/indexedmarketdata.hpp>
 #include <ored/marketdata/loader.hpp>
 
 namespace ore {
@@ -34,6 +35,17 @@ namespace data {
   Data is loaded with the call to the constructor.
   Inspectors can be called to then retrieve quotes and fixings.
 
+  The files are memory-mapped and split into chunks at line boundaries. The chunks are tokenised in \p nThreads
+  threads, fixings and dividends outside the relevant date range are dropped at this stage already. The market data
+  points are then built in file order in the calling thread, since the market datum parser relies on global parsers
+  and the FX dominance check on the order of the quotes. The fixings of each file are sorted in parallel and inserted
+  into the result set in one pass.
+
+  If \p loadFixingsOnDemand is true, the fixing files are not read in the constructor. Instead loadFixings() reads
+  them on each call, and loadFixings(requiredFixings) only keeps the requested (index, date) pairs during the
+  tokenisation, so that only the fixings a portfolio needs are held in memory. Otherwise the fixings are held in an
+  ordered set and single fixings or fixings for a set of required dates are looked up by index name and date.
+
   TODO implementation has large overlap with inmemoryloader.?pp, factor this out
 
   \ingroup marketdata
@@ -50,7 +62,11 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        Size nThreads = 1,
+        //! Do not load the fixings in the constructor, but read them from the files when requested
+        bool loadFixingsOnDemand = false);
 
     CSVLoader( //! Quote file name
         const vector<string>& marketFiles,
@@ -59,7 +75,11 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        Size nThreads = 1,
+        //! Do not load the fixings in the constructor, but read them from the files when requested
+        bool loadFixingsOnDemand = false);
 
     CSVLoader( //! Quote file name
         const string& marketFilename,
@@ -70,7 +90,11 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        Size nThreads = 1,
+        //! Do not load the fixings in the constructor, but read them from the files when requested
+        bool loadFixingsOnDemand = false);
 
     CSVLoader( //! Quote file name
         const vector<string>& marketFiles,
@@ -81,7 +105,11 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        Size nThreads = 1,
+        //! Do not load the fixings in the constructor, but read them from the files when requested
+        bool loadFixingsOnDemand = false);
 
     std::vector<QuantLib::ext::shared_ptr<MarketDatum>> loadQuotes(const QuantLib::Date&) const override;
 
@@ -92,7 +120,11 @@ public:
     std::set<QuantLib::ext::shared_ptr<MarketDatum>> get(const Wildcard& wildcard, const QuantLib::Date& asof) const override;
 
     //! Load fixings
-    std::set<Fixing> loadFixings() const override { return fixings_; }
+    std::set<Fixing> loadFixings() const override;
+    //! Load the fixings for the given index names and dates only, missing fixings are skipped
+    std::set<Fixing> loadFixings(const std::map<std::string, std::set<QuantLib::Date>>& requiredFixings) const;
+    bool hasFixing(const string& name, const QuantLib::Date& d) const override;
+    Fixing getFixing(const string& name, const QuantLib::Date& d) const override;
     //! Load dividends
     std::set<QuantExt::Dividend> loadDividends() const override { return dividends_; }
     //@}
@@ -100,12 +132,19 @@ public:
 private:
     enum class DataType { Market, Fixing, Dividend };
     void loadFile(const string&, DataType);
+    //! read a fixing file into \p fixings, if \p requiredFixings is given, keep only the fixings contained in it
+    void loadFixingFile(const string& filename,
+                        const std::map<std::string, std::set<QuantLib::Date>>* requiredFixings,
+                        std::set<Fixing>& fixings) const;
 
     bool implyTodaysFixings_;
-    std::map<QuantLib::Date, std::set<QuantLib::ext::shared_ptr<MarketDatum>, SharedPtrMarketDatumComparator>> data_;
+    std::map<QuantLib::Date, IndexedMarketData> data_;
     std::set<Fixing> fixings_;
     std::set<QuantExt::Dividend> dividends_;
     Date fixingCutOffDate_;
+    Size nThreads_;
+    bool loadFixingsOnDemand_;
+    vector<string> fixingFiles_;
 };
 } // namespace data
 } // namespace ore
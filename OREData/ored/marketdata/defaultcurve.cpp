@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <ored/marketdata/bootstrapwarmstarts.hpp>
 #include <ored/marketdata/defaultcurve.hpp>
 #include <ored/marketdata/yieldcurve.hpp>
 #include <ored/utilities/log.hpp>
@@ -25,6 +26,7 @@
 #include <qle/termstructures/interpolatedhazardratecurve.hpp>
 #include <qle/termstructures/interpolatedsurvivalprobabilitycurve.hpp>
 #include <qle/termstructures/iterativebootstrap.hpp>
+#include <qle/termstructures/memoiseddiscountcurve.hpp>
 #include <qle/termstructures/multisectiondefaultcurve.hpp>
 #include <qle/termstructures/probabilitytraits.hpp>
 #include <qle/termstructures/terminterpolateddefaultcurve.hpp>
@@ -361,6 +363,12 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
         QL_REQUIRE(!quotes.empty(), "No market points found for CDS curve config " << curveID);
     }
 
+    /* The helpers' CDS are repriced in each iteration of the bootstrap with the same discount factors, they read
+       them from a memoised copy of the discount curve. The helpers only live for the bootstrap below, the resulting
+       curve and the credit curve use the original discount curve. */
+    Handle<YieldTermStructure> helperDiscountCurve(
+        QuantLib::ext::make_shared<QuantExt::MemoisedDiscountCurve>(discountCurve));
+
     // Create the CDS instrument helpers, only keep alive helpers
     vector<QuantLib::ext::shared_ptr<QuantExt::DefaultProbabilityHelper>> helpers;
     std::map<QuantLib::Date, QuantLib::Period> helperQuoteTerms;
@@ -375,8 +383,9 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
             try {
                 tmp = QuantLib::ext::make_shared<SpreadCdsHelper>(
                     quote.value, quote.term, cdsConv->settlementDays(), cdsConv->calendar(), cdsConv->frequency(),
-                    cdsConv->paymentConvention(), cdsConv->rule(), cdsConv->dayCounter(), recoveryRate_, discountCurve,
-                    cdsConv->settlesAccrual(), ppt, config.startDate(), cdsConv->lastPeriodDayCounter());
+                    cdsConv->paymentConvention(), cdsConv->rule(), cdsConv->dayCounter(), recoveryRate_,
+                    helperDiscountCurve, cdsConv->settlesAccrual(), ppt, config.startDate(),
+                    cdsConv->lastPeriodDayCounter());
 
             } catch (exception& e) {
                 if (quote.term == Period(0, Months)) {
@@ -409,7 +418,7 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
             auto tmp = QuantLib::ext::make_shared<UpfrontCdsHelper>(
                 quote.value, runningSpread, quote.term, cdsConv->settlementDays(), cdsConv->calendar(),
                 cdsConv->frequency(), cdsConv->paymentConvention(), cdsConv->rule(), cdsConv->dayCounter(),
-                recoveryRate_, discountCurve, cdsConv->upfrontSettlementDays(), cdsConv->settlesAccrual(), ppt,
+                recoveryRate_, helperDiscountCurve, cdsConv->upfrontSettlementDays(), cdsConv->settlesAccrual(), ppt,
                 config.startDate(), cdsConv->lastPeriodDayCounter());
             if (tmp->latestDate() > asof) {
                 helpers.push_back(tmp);
@@ -436,10 +445,16 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
     Size dontThrowSteps = config.bootstrapConfig().dontThrowSteps();
 
     typedef PiecewiseDefaultCurve<QuantExt::SurvivalProbability, LogLinear, QuantExt::IterativeBootstrap> SpCurve;
-    SpCurve::bootstrap_type btconfig(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                   minFactor, dontThrowSteps);
     QuantLib::ext::shared_ptr<DefaultProbabilityTermStructure> qlCurve;
 
+    // bootstrap config with a warm start from a previous build of the same curve, if enabled
+    std::vector<std::pair<std::string, QuantLib::ext::shared_ptr<QuantExt::IterativeBootstrapWarmStart>>> warmStarts;
+    auto bootstrapConfig = [&](const std::string& key) {
+        warmStarts.push_back(std::make_pair(key, BootstrapWarmStarts::instance().warmStart(key)));
+        return SpCurve::bootstrap_type(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor, minFactor,
+                                       dontThrowSteps, warmStarts.back().second);
+    };
+
     if (config.indexTerm() != 0 * Days) {
 
         // build flat index curve picking a quote with identical term as configured if possible
@@ -457,7 +472,7 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
 
         auto tmp1 = QuantLib::ext::make_shared<SpCurve>(
             asof, std::vector<QuantLib::ext::shared_ptr<QuantExt::DefaultProbabilityHelper>>{helpers[helperIndex_m]},
-            config.dayCounter(), LogLinear(), btconfig);
+            config.dayCounter(), LogLinear(), bootstrapConfig(spec.name() + "/" + std::to_string(helperIndex_m)));
         Date d1 = helpers[helperIndex_m]->pillarDate();
         Real p1 = tmp1->survivalProbability(d1);
         auto tmp1i = QuantLib::ext::make_shared<QuantExt::InterpolatedSurvivalProbabilityCurve<LogLinear>>(
@@ -469,7 +484,7 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
         } else {
             auto tmp2 = QuantLib::ext::make_shared<SpCurve>(
                 asof, std::vector<QuantLib::ext::shared_ptr<QuantExt::DefaultProbabilityHelper>>{helpers[helperIndex_p]},
-                config.dayCounter(), LogLinear(), btconfig);
+                config.dayCounter(), LogLinear(), bootstrapConfig(spec.name() + "/" + std::to_string(helperIndex_p)));
             Date d2 = helpers[helperIndex_p]->pillarDate();
             Real p2 = tmp2->survivalProbability(d2);
             auto tmp2i = QuantLib::ext::make_shared<QuantExt::InterpolatedSurvivalProbabilityCurve<LogLinear>>(
@@ -486,9 +501,7 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
         // build single name curve
 
         QuantLib::ext::shared_ptr<DefaultProbabilityTermStructure> tmp = QuantLib::ext::make_shared<SpCurve>(
-            asof, helpers, config.dayCounter(), LogLinear(),
-            QuantExt::IterativeBootstrap<SpCurve>(accuracy, globalAccuracy, dontThrow, maxAttempts, maxFactor,
-                                                  minFactor, dontThrowSteps));
+            asof, helpers, config.dayCounter(), LogLinear(), bootstrapConfig(spec.name()));
 
         // As for yield curves we need to copy the piecewise curve because on eval date changes the relative date
         // helpers with trigger a bootstrap.
@@ -527,6 +540,16 @@ void DefaultCurve::buildCdsCurve(const std::string& curveID, const DefaultCurveC
             LogLinear(), config.allowNegativeRates());
     }
 
+    for (auto const& [key, warmStart] : warmStarts) {
+        if (warmStart) {
+            auto stats = warmStart->statistics();
+            DLOG("Bootstrap statistics for " << key << ": " << stats.calculations << " calculations, " << stats.hits
+                                             << " warm start hits, " << stats.rejections << " warm start rejections, "
+                                             << stats.iterations << " iterations, " << stats.evaluations
+                                             << " helper evaluations");
+        }
+    }
+
     if (config.extrapolation()) {
         qlCurve->enableExtrapolation();
         DLOG("DefaultCurve: Enabled Extrapolation");
@@ -31,9 +31,28 @@
 #include <ored/utilities/to_string.hpp>
 #include <ql/tuple.hpp>
 
+#include <algorithm>
+
 namespace ore {
 namespace data {
 
+std::vector<std::vector<DependencyGraph::Vertex>> DependencyGraph::levels(const Graph& g,
+                                                                          const std::vector<Vertex>& order) {
+    auto index = QuantLib::ext::get(boost::vertex_index, g);
+    std::vector<std::size_t> level(boost::num_vertices(g), 0);
+    std::vector<std::vector<Vertex>> result;
+    for (auto const& v : order) {
+        // an edge v -> w means that v depends on w
+        boost::graph_traits<Graph>::out_edge_iterator e, eend;
+        for (std::tie(e, eend) = boost::out_edges(v, g); e != eend; ++e)
+            level[index[v]] = std::max(level[index[v]], level[index[boost::target(*e, g)]] + 1);
+        if (result.size() <= level[index[v]])
+            result.resize(level[index[v]] + 1);
+        result[level[index[v]]].push_back(v);
+    }
+    return result;
+}
+
 void DependencyGraph::buildDependencyGraph(const std::string& configuration,
                                            std::map<std::string, std::string>& buildErrors) {
 
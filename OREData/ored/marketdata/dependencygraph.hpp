@@ -111,6 +111,11 @@ public:
 
     std::map<std::string, Graph> dependencies() { return dependencies_; }
 
+    /*! Groups the vertices of a graph into levels, such that the nodes of a level only depend on nodes of lower
+        levels. The nodes within one level are independent of each other. The given order must contain the vertices
+        with their dependencies first, as returned by boost::topological_sort(). */
+    static std::vector<std::vector<Vertex>> levels(const Graph& g, const std::vector<Vertex>& order);
+
 private:
     friend std::ostream& operator<<(std::ostream& o, const Node& n);
 
@@ -36,6 +36,7 @@
 #include <ql/termstructures/volatility/equityfx/blackvariancesurface.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
 #include <ql/time/daycounters/actual365fixed.hpp>
+#include <qle/math/vectorisedblackformula.hpp>
 #include <qle/models/carrmadanarbitragecheck.hpp>
 #include <qle/termstructures/blackdeltautilities.hpp>
 #include <qle/termstructures/blackvariancesurfacemoneyness.hpp>
@@ -1243,22 +1244,41 @@ void EquityVolCurve::buildCalibrationInfo(const QuantLib::Date& asof, const Curv
                 std::vector<std::vector<bool>>(times.size(), std::vector<bool>(moneyness.size(), true));
             for (Size i = 0; i < times.size(); ++i) {
                 Real t = times[i];
+                Real disc = rfDisc[i];
+                // collect the valid strikes and std devs of the expiry, the prices are computed in one batch below
+                std::vector<Size> valid;
+                std::vector<Real> strikes, stdDevs;
                 for (Size j = 0; j < moneyness.size(); ++j) {
                     try {
                         Real strike = moneyness[j] * forwards[i];
                         calibrationInfo_->moneynessGridStrikes[i][j] = strike;
                         Real stddev = std::sqrt(vol_->blackVariance(t, strike));
-                        callPricesMoneyness[i][j] = blackFormula(Option::Call, strike, forwards[i], stddev);
                         calibrationInfo_->moneynessGridImpliedVolatility[i][j] = stddev / std::sqrt(t);
-                        if (moneyness[j] >= 1) {
-                            calibrationInfo_->moneynessCallPrices[i][j] = blackFormula(Option::Call, strike, forwards[i], stddev, rfDisc[i]);
-                        } else {
-                            calibrationInfo_->moneynessPutPrices[i][j] = blackFormula(Option::Put, strike, forwards[i], stddev, rfDisc[i]);
-                        };
+                        QL_REQUIRE(strike >= 0.0 && forwards[i] > 0.0 && stddev >= 0.0 && disc > 0.0,
+                                   "invalid black formula input: strike " << strike << ", forward " << forwards[i]
+                                       << ", stddev " << stddev << ", discount " << disc);
+                        valid.push_back(j);
+                        strikes.push_back(strike);
+                        stdDevs.push_back(stddev);
                     } catch (const std::exception& e) {
                         TLOG("EquityVolCurve: error for time " << t << " moneyness " << moneyness[j] << ": " << e.what());
                     }
                 }
+                Size n = valid.size();
+                std::vector<Real> fwds(n, forwards[i]), ones(n, 1.0), discs(n, disc), calls(n), puts(n);
+                QuantExt::vectorisedBlackFormula(Option::Call, strikes.data(), fwds.data(), stdDevs.data(),
+                                                 ones.data(), n, calls.data());
+                QuantExt::vectorisedBlackFormula(Option::Put, strikes.data(), fwds.data(), stdDevs.data(),
+                                                 discs.data(), n, puts.data());
+                for (Size k = 0; k < n; ++k) {
+                    Size j = valid[k];
+                    callPricesMoneyness[i][j] = calls[k];
+                    if (moneyness[j] >= 1) {
+                        calibrationInfo_->moneynessCallPrices[i][j] = calls[k] * disc;
+                    } else {
+                        calibrationInfo_->moneynessPutPrices[i][j] = puts[k];
+                    }
+                }
             }
             if (!times.empty() && !moneyness.empty()) {
                 try {
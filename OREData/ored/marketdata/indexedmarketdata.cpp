@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/marketdata/indexedmarketdata.hpp>
+
+namespace ore {
+namespace data {
+
+bool IndexedMarketData::insert(const QuantLib::ext::shared_ptr<MarketDatum>& md) {
+    if (!byName_.emplace(md->name(), md).second)
+        return false;
+    sorted_.emplace(md->name(), md);
+    return true;
+}
+
+bool IndexedMarketData::erase(const std::string& name) {
+    if (byName_.erase(name) == 0)
+        return false;
+    sorted_.erase(name);
+    return true;
+}
+
+QuantLib::ext::shared_ptr<MarketDatum> IndexedMarketData::get(const std::string& name) const {
+    auto it = byName_.find(name);
+    return it == byName_.end() ? nullptr : it->second;
+}
+
+std::set<QuantLib::ext::shared_ptr<MarketDatum>> IndexedMarketData::get(const Wildcard& wildcard) const {
+    if (!wildcard.hasWildcard()) {
+        if (auto md = get(wildcard.pattern()))
+            return {md};
+        return {};
+    }
+    // search the range matching the substring of the pattern until the wildcard, this is all of the data if the
+    // wildcard is at the first position
+    std::string prefix = wildcard.pattern().substr(0, wildcard.wildcardPos());
+    std::set<QuantLib::ext::shared_ptr<MarketDatum>> result;
+    for (auto it = sorted_.lower_bound(prefix);
+         it != sorted_.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        if (wildcard.isPrefix() || wildcard.matches(it->first))
+            result.insert(it->second);
+    }
+    return result;
+}
+
+std::vector<QuantLib::ext::shared_ptr<MarketDatum>> IndexedMarketData::data() const {
+    std::vector<QuantLib::ext::shared_ptr<MarketDatum>> result;
+    result.reserve(sorted_.size());
+    for (auto const& md : sorted_)
+        result.push_back(md.second);
+    return result;
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/marketdata/indexedmarketdata.hpp
+    \brief market data points for one date, indexed by name
+    \ingroup marketdata
+*/
+
+#pragma once
+
+#include <ored/marketdata/marketdatum.hpp>
+#include <ored/utilities/wildcard.hpp>
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Market data points for one date, indexed by name
+/*! Market data points are looked up by name in a hash map in constant time. A second index sorted by name serves
+    the wildcard queries: the quotes matching the part of the pattern before the first wildcard form a contiguous
+    range in this index, so that only the quotes within this range have to be matched against the full pattern.
+
+    \ingroup marketdata
+ */
+class IndexedMarketData {
+public:
+    //! add a market datum, returns false if a datum with the same name is already present
+    bool insert(const QuantLib::ext::shared_ptr<MarketDatum>& md);
+    //! remove the datum with the given name, returns false if there is no such datum
+    bool erase(const std::string& name);
+    //! the datum with the given name or null if there is no such datum
+    QuantLib::ext::shared_ptr<MarketDatum> get(const std::string& name) const;
+    //! the data matching the wildcard
+    std::set<QuantLib::ext::shared_ptr<MarketDatum>> get(const Wildcard& wildcard) const;
+    //! all data, sorted by name
+    std::vector<QuantLib::ext::shared_ptr<MarketDatum>> data() const;
+    Size size() const { return byName_.size(); }
+    bool empty() const { return byName_.empty(); }
+
+private:
+    std::unordered_map<std::string, QuantLib::ext::shared_ptr<MarketDatum>> byName_;
+    std::map<std::string, QuantLib::ext::shared_ptr<MarketDatum>> sorted_;
+};
+
+} // namespace data
+} // namespace ore
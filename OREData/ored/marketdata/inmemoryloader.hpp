@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <ored/marketdata/indexedmarketdata.hpp>
 #include <ored/marketdata/loader.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
 
@@ -51,7 +52,7 @@ public:
     void reset();
 
 protected:
-    std::map<QuantLib::Date, std::set<QuantLib::ext::shared_ptr<MarketDatum>, SharedPtrMarketDatumComparator>> data_;
+    std::map<QuantLib::Date, IndexedMarketData> data_;
     std::set<Fixing> fixings_;
     std::set<QuantExt::Dividend> dividends_;
 };
@@ -20,6 +20,7 @@
 #include <boost/make_shared.hpp>
 #include <boost/range.hpp>
 #include <map>
+#include <string_view>
 #include <ored/marketdata/expiry.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
 #include <ored/marketdata/strike.hpp>
@@ -217,11 +218,35 @@ bool matchFxFwdStringTerm(const boost::variant<QuantLib::Period, FXForwardQuote:
     return boost::apply_visitor(FxFwdStringCompare(fxfwdString), term);
 }
 
+namespace {
+
+/* split the datum name at '/' like boost::split(tokens, datumName, boost::is_any_of("/")), but reusing the strings
+   of the given vector, so that no allocations are required once its capacity is large enough */
+void splitDatumName(const string& datumName, vector<string>& tokens) {
+    std::string_view name(datumName);
+    Size n = 0;
+    for (std::string_view::size_type b = 0;;) {
+        std::string_view::size_type e = name.find('/', b);
+        std::string_view token = name.substr(b, e == std::string_view::npos ? std::string_view::npos : e - b);
+        if (n == tokens.size())
+            tokens.emplace_back();
+        tokens[n++].assign(token.data(), token.size());
+        if (e == std::string_view::npos)
+            break;
+        b = e + 1;
+    }
+    tokens.resize(n);
+}
+
+} // namespace
+
 //! Function to parse a market datum
 QuantLib::ext::shared_ptr<MarketDatum> parseMarketDatum(const Date& asof, const string& datumName, const Real& value) {
 
-    vector<string> tokens;
-    boost::split(tokens, datumName, boost::is_any_of("/"));
+    // one token buffer per thread, this function is called for each quote and may be called in parallel
+    thread_local vector<string> tokenBuffer;
+    vector<string>& tokens = tokenBuffer;
+    splitDatumName(datumName, tokens);
     QL_REQUIRE(tokens.size() > 2, "more than 2 tokens expected in " << datumName);
 
     MarketDatum::InstrumentType instrumentType = parseInstrumentType(tokens[0]);
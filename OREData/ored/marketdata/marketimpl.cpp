@@ -21,9 +21,11 @@
 #include <ored/configuration/conventions.hpp>
 #include <ored/marketdata/marketimpl.hpp>
 #include <ored/utilities/indexparser.hpp>
+#include <ored/utilities/log.hpp>
 #include <ored/utilities/marketdata.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <qle/termstructures/blackinvertedvoltermstructure.hpp>
+#include <qle/utilities/freeze.hpp>
 
 using namespace std;
 using std::make_pair;
@@ -510,112 +512,117 @@ void MarketImpl::addSwapIndex(const string& swapIndex, const string& discountInd
     }
 }
 
-void MarketImpl::refresh(const string& configuration) {
-
-    auto it = refreshTs_.find(configuration);
-    if (it == refreshTs_.end()) {
-        it = refreshTs_.insert(make_pair(configuration, std::set<QuantLib::ext::shared_ptr<TermStructure>>())).first;
+std::set<QuantLib::ext::shared_ptr<TermStructure>> MarketImpl::termStructures(const string& configuration) const {
+    std::set<QuantLib::ext::shared_ptr<TermStructure>> result;
+    for (auto& x : yieldCurves_) {
+        if (get<0>(x.first) == configuration || get<0>(x.first) == Market::defaultConfiguration)
+            result.insert(*x.second);
     }
-
-    if (it->second.empty()) {
-        for (auto& x : yieldCurves_) {
-            if (get<0>(x.first) == configuration || get<0>(x.first) == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : iborIndices_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
-                Handle<YieldTermStructure> y = x.second->forwardingTermStructure();
-                if (!y.empty())
-                    it->second.insert(*y);
-            }
-        }
-        for (auto& x : swapIndices_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
-                Handle<YieldTermStructure> y = x.second->forwardingTermStructure();
-                if (!y.empty())
-                    it->second.insert(*y);
-                y = x.second->discountingTermStructure();
-                if (!y.empty())
-                    it->second.insert(*y);
-            }
-        }
-        for (auto& x : swaptionCurves_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : capFloorCurves_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : yoyCapFloorVolSurfaces_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : fxVols_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : defaultCurves_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second->curve());
+    for (auto& x : iborIndices_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
+            Handle<YieldTermStructure> y = x.second->forwardingTermStructure();
+            if (!y.empty())
+                result.insert(*y);
         }
-        for (auto& x : cdsVols_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : baseCorrelations_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : zeroInflationIndices_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
-                it->second.insert(*x.second->zeroInflationTermStructure());
-            }
-        }
-        for (auto& x : yoyInflationIndices_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
-                it->second.insert(*x.second->yoyInflationTermStructure());
-            }
-        }
-        for (auto& x : cpiInflationCapFloorVolatilitySurfaces_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
-        for (auto& x : yoyCapFloorVolSurfaces_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
+    }
+    for (auto& x : swapIndices_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
+            Handle<YieldTermStructure> y = x.second->forwardingTermStructure();
+            if (!y.empty())
+                result.insert(*y);
+            y = x.second->discountingTermStructure();
+            if (!y.empty())
+                result.insert(*y);
         }
-        for (auto& x : equityVols_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
+    }
+    for (auto& x : swaptionCurves_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : capFloorCurves_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : yoyCapFloorVolSurfaces_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : fxVols_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : defaultCurves_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second->curve());
+    }
+    for (auto& x : cdsVols_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : baseCorrelations_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : zeroInflationIndices_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
+            result.insert(*x.second->zeroInflationTermStructure());
         }
-        for (auto& x : equityCurves_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
-                Handle<YieldTermStructure> y = x.second->equityForecastCurve();
-                if (!y.empty())
-                    it->second.insert(*y);
-                y = x.second->equityDividendCurve();
-                if (!y.empty())
-                    it->second.insert(*y);
-            }
+    }
+    for (auto& x : yoyInflationIndices_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
+            result.insert(*x.second->yoyInflationTermStructure());
         }
-        for (auto& x : commodityIndices_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
-                const auto& pts = x.second->priceCurve();
-                if (!pts.empty())
-                    it->second.insert(*pts);
-            }
+    }
+    for (auto& x : cpiInflationCapFloorVolatilitySurfaces_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : yoyCapFloorVolSurfaces_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : equityVols_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
+    for (auto& x : equityCurves_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
+            Handle<YieldTermStructure> y = x.second->equityForecastCurve();
+            if (!y.empty())
+                result.insert(*y);
+            y = x.second->equityDividendCurve();
+            if (!y.empty())
+                result.insert(*y);
         }
-        for (auto& x : commodityVols_) {
-            if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
-                it->second.insert(*x.second);
+    }
+    for (auto& x : commodityIndices_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration) {
+            const auto& pts = x.second->priceCurve();
+            if (!pts.empty())
+                result.insert(*pts);
         }
+    }
+    for (auto& x : commodityVols_) {
+        if (x.first.first == configuration || x.first.first == Market::defaultConfiguration)
+            result.insert(*x.second);
+    }
 
-        for (auto& x : correlationCurves_) {
-            if (get<0>(x.first) == configuration || get<0>(x.first) == Market::defaultConfiguration)
-                it->second.insert(*x.second);
-        }
+    for (auto& x : correlationCurves_) {
+        if (get<0>(x.first) == configuration || get<0>(x.first) == Market::defaultConfiguration)
+            result.insert(*x.second);
     }
+    return result;
+}
+
+void MarketImpl::refresh(const string& configuration) {
+
+    auto it = refreshTs_.find(configuration);
+    if (it == refreshTs_.end()) {
+        it = refreshTs_.insert(make_pair(configuration, std::set<QuantLib::ext::shared_ptr<TermStructure>>())).first;
+    }
+
+    if (it->second.empty())
+        it->second = termStructures(configuration);
 
     // term structures might be wrappers around nested termstructures that need to be updated as well,
     // therefore we need to call deepUpdate() (=update() if no such nesting is present)
@@ -624,5 +631,24 @@ void MarketImpl::refresh(const string& configuration) {
 
 } // refresh
 
+void MarketImpl::freeze(const string& configuration) const {
+    for (auto const& ts : termStructures(configuration)) {
+        if (ts == nullptr || !frozenTs_.insert(ts).second)
+            continue;
+        try {
+            QuantExt::freeze(ts);
+        } catch (const std::exception& e) {
+            WLOG("MarketImpl::freeze(): could not freeze term structure in configuration " << configuration << ": "
+                                                                                           << e.what());
+        }
+    }
+}
+
+void MarketImpl::unfreeze() const {
+    for (auto const& ts : frozenTs_)
+        QuantExt::unfreeze(ts);
+    frozenTs_.clear();
+}
+
 } // namespace data
 } // namespace ore
@@ -182,6 +182,15 @@ public:
     //! Send an explicit update() call to all term structures
     void refresh(const string& configuration = Market::defaultConfiguration) override;
 
+    /*! Compute and freeze all term structures of the given configuration (and the default configuration), see
+        QuantExt::freeze(). Frozen term structures can be read concurrently from several threads, but they do not
+        reflect changes in market data or the evaluation date, this includes a refresh(), until unfreeze() is called.
+        Term structures that can not be computed are left unfrozen, a warning is logged in this case. */
+    void freeze(const string& configuration = Market::defaultConfiguration) const;
+
+    //! Unfreeze all term structures frozen by freeze()
+    void unfreeze() const;
+
 protected:
     /*! Require a market object, this can be used in derived classes to build objects lazily. If the
         method is not overwritten in a derived class, it is assumed that the class builds all market
@@ -239,6 +248,12 @@ protected:
     // set of term structure pointers for refresh (per configuration)
     map<string, std::set<QuantLib::ext::shared_ptr<TermStructure>>> refreshTs_;
 
+    // set of term structures frozen by freeze()
+    mutable std::set<QuantLib::ext::shared_ptr<TermStructure>> frozenTs_;
+
+    // the term structures of the given configuration and the default configuration
+    std::set<QuantLib::ext::shared_ptr<TermStructure>> termStructures(const string& configuration) const;
+
 private:
     pair<string, string> swapIndexBases(const string& key,
                                         const string& configuration = Market::defaultConfiguration) const;
@@ -44,6 +44,7 @@
 #include <ored/utilities/indexnametranslator.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/trace.hpp>
 #include <qle/indexes/dividendmanager.hpp>
 #include <qle/indexes/equityindex.hpp>
 #include <qle/indexes/fallbackiborindex.hpp>
@@ -79,11 +80,13 @@ TodaysMarket::TodaysMarket(const Date& asof, const QuantLib::ext::shared_ptr<Tod
                            const bool loadFixings, const bool lazyBuild,
                            const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData,
                            const bool preserveQuoteLinkage, const IborFallbackConfig& iborFallbackConfig,
-                           const bool buildCalibrationInfo, const bool handlePseudoCurrencies)
+                           const bool buildCalibrationInfo, const bool handlePseudoCurrencies,
+                           const bool freezeTermStructures)
     : MarketImpl(handlePseudoCurrencies), params_(params), loader_(loader), curveConfigs_(curveConfigs),
       continueOnError_(continueOnError), loadFixings_(loadFixings), lazyBuild_(lazyBuild),
       preserveQuoteLinkage_(preserveQuoteLinkage), referenceData_(referenceData),
-      iborFallbackConfig_(iborFallbackConfig), buildCalibrationInfo_(buildCalibrationInfo) {
+      iborFallbackConfig_(iborFallbackConfig), buildCalibrationInfo_(buildCalibrationInfo),
+      freezeTermStructures_(freezeTermStructures) {
     QL_REQUIRE(params_, "TodaysMarket: TodaysMarketParameters are null");
     QL_REQUIRE(loader_, "TodaysMarket: Loader is null");
     QL_REQUIRE(curveConfigs_, "TodaysMarket: CurveConfigurations are null");
@@ -99,6 +102,8 @@ struct Count {
 
 void TodaysMarket::initialise(const Date& asof) {
 
+    ORE_TRACE_SCOPE("TodaysMarket::initialise");
+
     std::map<std::string, boost::timer::nanosecond_type> timings;
     std::map<std::string, Count> counts;
     boost::timer::cpu_timer timer;
@@ -143,16 +148,18 @@ void TodaysMarket::initialise(const Date& asof) {
     }
     timings["3 add all fx quotes"] = timer.elapsed().wall;
 
-    // build the dependency graph for all configurations and  build all FX Spots
+    // build the dependency graph for all configurations and  build all FX Spots, if the market is built lazily, the
+    // graph of a configuration is built on its first use in require()
     timer.start();
-    DependencyGraph dg(asof_, params_, curveConfigs_, iborFallbackConfig_);
     map<string, string> buildErrors;
-
-    for (const auto& configuration : params_->configurations()) {
-        // Build the graph of objects to build for the current configuration
-        dg.buildDependencyGraph(configuration.first, buildErrors);
+    if (!lazyBuild_) {
+        DependencyGraph dg(asof_, params_, curveConfigs_, iborFallbackConfig_);
+        for (const auto& configuration : params_->configurations()) {
+            // Build the graph of objects to build for the current configuration
+            dg.buildDependencyGraph(configuration.first, buildErrors);
+        }
+        dependencies_ = dg.dependencies();
     }
-    dependencies_ = dg.dependencies();
     timings["4 build dep graphs"] = timer.elapsed().wall;
 
     // if market is not build lazily, sort the dependency graph and build the objects
@@ -195,31 +202,45 @@ void TodaysMarket::initialise(const Date& asof) {
             }
             timings["5 topological sort dep graphs"] += timer.elapsed().wall;
 
+            // Group the objects into levels of mutually independent nodes, building the levels in sequence is
+            // equivalent to building in topological order
+
+            auto levels = DependencyGraph::levels(g, order);
+            Size maxLevelSize = 0;
+            for (auto const& l : levels)
+                maxLevelSize = std::max(maxLevelSize, l.size());
+            LOG("Dependency graph has " << order.size() << " nodes in " << levels.size()
+                                        << " levels of independent nodes, max level size is " << maxLevelSize);
+
             TLOG("Can build objects in the following order:");
-            for (auto const& m : order) {
-                TLOG("vertex #" << index[m] << ": " << g[m]);
+            for (Size l = 0; l < levels.size(); ++l) {
+                for (auto const& m : levels[l]) {
+                    TLOG("level #" << l << ", vertex #" << index[m] << ": " << g[m]);
+                }
             }
 
-            // Build the objects in the graph in topological order
+            // Build the objects in the graph level by level
 
             Size countSuccess = 0, countError = 0;
-            for (auto const& m : order) {
-                timer.start();
-                try {
-                    buildNode(configuration.first, g[m]);
-                    ++countSuccess;
-                    DLOG("built node " << g[m] << " in configuration " << configuration.first);
-                } catch (const std::exception& e) {
-                    if (g[m].curveSpec)
-                        buildErrors[g[m].curveSpec->name()] = e.what();
-                    else
-                        buildErrors[g[m].name] = e.what();
-                    ++countError;
-                    ALOG("error while building node " << g[m] << " in configuration " << configuration.first << ": "
-                                                      << e.what());
+            for (auto const& level : levels) {
+                for (auto const& m : level) {
+                    timer.start();
+                    try {
+                        buildNode(configuration.first, g[m]);
+                        ++countSuccess;
+                        DLOG("built node " << g[m] << " in configuration " << configuration.first);
+                    } catch (const std::exception& e) {
+                        if (g[m].curveSpec)
+                            buildErrors[g[m].curveSpec->name()] = e.what();
+                        else
+                            buildErrors[g[m].name] = e.what();
+                        ++countError;
+                        ALOG("error while building node " << g[m] << " in configuration " << configuration.first << ": "
+                                                          << e.what());
+                    }
+                    timings["6 build " + ore::data::to_string(g[m].obj)] += timer.elapsed().wall;
+                    counts["6 build " + ore::data::to_string(g[m].obj)].inc();
                 }
-                timings["6 build " + ore::data::to_string(g[m].obj)] += timer.elapsed().wall;
-                counts["6 build " + ore::data::to_string(g[m].obj)].inc();
             }
 
             LOG("Loaded CurvesSpecs: success: " << countSuccess << ", error: " << countError);
@@ -257,6 +278,13 @@ void TodaysMarket::initialise(const Date& asof) {
         }
     }
 
+    // freeze the term structures, if the market is built lazily this is done in require()
+
+    if (freezeTermStructures_ && !lazyBuild_) {
+        for (const auto& configuration : params_->configurations())
+            freeze(configuration.first);
+    }
+
 } // TodaysMarket::initialise()
 
 void TodaysMarket::buildNode(const std::string& configuration, Node& node) const {
@@ -266,6 +294,8 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
     if (node.built)
         return;
 
+    ORE_TRACE_SCOPE("TodaysMarket::buildNode " + ore::data::to_string(node.obj) + " " + node.name);
+
     if (node.curveSpec == nullptr) {
 
         // not spec-based node, this can only be a SwapIndexCurve
@@ -810,6 +840,7 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
     }     // else-block (spec based node)
 
     node.built = true;
+    builtObjects_[configuration].insert(std::make_pair(node.obj, node.name));
 } // TodaysMarket::buildNode()
 
 void TodaysMarket::require(const MarketObject o, const string& name, const string& configuration,
@@ -825,6 +856,29 @@ void TodaysMarket::require(const MarketObject o, const string& name, const strin
     DLOG("market object " << o << "(" << name << ") required for configuration '" << configuration << "'");
 
     auto tmp = dependencies_.find(configuration);
+
+    // in a lazily built market the dependency graph of a configuration is built on its first use
+
+    if (tmp == dependencies_.end() && lazyBuild_ && params_->hasConfiguration(configuration)) {
+        DLOG("build dependency graph for configuration '" << configuration << "'");
+        DependencyGraph dg(asof_, params_, curveConfigs_, iborFallbackConfig_);
+        map<string, string> graphErrors;
+        dg.buildDependencyGraph(configuration, graphErrors);
+        tmp = dependencies_.insert(std::make_pair(configuration, dg.dependencies()[configuration])).first;
+        if (!graphErrors.empty()) {
+            for (auto const& error : graphErrors) {
+                StructuredCurveErrorMessage(error.first, "Failed to Build Curve", error.second).log();
+            }
+            if (!continueOnError_) {
+                string errStr;
+                for (auto const& error : graphErrors) {
+                    errStr += "(" + error.first + ": " + error.second + "); ";
+                }
+                QL_FAIL("Cannot build dependency graph for configuration '" << configuration << "': " << errStr);
+            }
+        }
+    }
+
     if (tmp == dependencies_.end()) {
         if (configuration != Market::defaultConfiguration) {
             StructuredCurveWarningMessage(
@@ -944,6 +998,11 @@ void TodaysMarket::require(const MarketObject o, const string& name, const strin
             QL_FAIL("Cannot build all required curves! Building failed for: " << errStr);
         }
     }
+
+    // freeze the newly built term structures
+
+    if (freezeTermStructures_ && lazyBuild_ && countSuccess > 0)
+        freeze(configuration);
 } // TodaysMarket::require()
 
 std::ostream& operator<<(std::ostream& o, const DependencyGraph::Node& n) {
@@ -39,6 +39,7 @@
 #include <boost/enable_shared_from_this.hpp>
 
 #include <map>
+#include <set>
 
 namespace ore {
 namespace data {
@@ -103,10 +104,19 @@ public:
         //! build calibration info?
         const bool buildCalibrationInfo = true,
         //! support pseudo currencies
-        const bool handlePseudoCurrencies = true);
+        const bool handlePseudoCurrencies = true,
+        //! If true, freeze the term structures once built, so that they can be read concurrently, see freeze()
+        const bool freezeTermStructures = false);
 
     QuantLib::ext::shared_ptr<TodaysMarketCalibrationInfo> calibrationInfo() const { return calibrationInfo_; }
 
+    /*! The market objects (type, name) that were built so far, by configuration. For a lazily built market this is
+        the set of objects that were actually requested together with their dependencies, which can be used to trim
+        the todays market parameters. */
+    const std::map<std::string, std::set<std::pair<MarketObject, std::string>>>& builtObjects() const {
+        return builtObjects_;
+    }
+
 private:
     // MarketImpl interface
     void require(const MarketObject o, const string& name, const string& configuration,
@@ -125,6 +135,7 @@ private:
     const QuantLib::ext::shared_ptr<ReferenceDataManager> referenceData_;
     const IborFallbackConfig iborFallbackConfig_;
     const bool buildCalibrationInfo_;
+    const bool freezeTermStructures_;
 
     // initialise market
     void initialise(const Date& asof);
@@ -145,6 +156,9 @@ private:
     // calibration results
     QuantLib::ext::shared_ptr<TodaysMarketCalibrationInfo> calibrationInfo_;
 
+    // the built market objects by configuration
+    mutable std::map<std::string, std::set<std::pair<MarketObject, std::string>>> builtObjects_;
+
     // cached market objects, the key of the maps is the curve spec name, except for swap indices, see below
     mutable map<string, QuantLib::ext::shared_ptr<YieldCurve>> requiredYieldCurves_;
     mutable map<string, QuantLib::ext::shared_ptr<FXVolCurve>> requiredFxVolCurves_;
@@ -81,7 +81,7 @@ CrossAssetModelBuilder::CrossAssetModelBuilder(
     const std::string& configurationEqCalibration, const std::string& configurationInfCalibration,
     const std::string& configurationCrCalibration, const std::string& configurationFinalModel, const bool dontCalibrate,
     const bool continueOnError, const std::string& referenceCalibrationGrid, const SalvagingAlgorithm::Type salvaging,
-    const std::string& id)
+    const std::string& id, const Size nThreads, const std::map<std::string, Array>& lgmStartParams)
     : market_(market), config_(config), configurationLgmCalibration_(configurationLgmCalibration),
       configurationFxCalibration_(configurationFxCalibration), configurationEqCalibration_(configurationEqCalibration),
       configurationInfCalibration_(configurationInfCalibration),
@@ -89,6 +89,7 @@ CrossAssetModelBuilder::CrossAssetModelBuilder(
       configurationComCalibration_(Market::defaultConfiguration), configurationFinalModel_(configurationFinalModel),
       dontCalibrate_(dontCalibrate), continueOnError_(continueOnError),
       referenceCalibrationGrid_(referenceCalibrationGrid), salvaging_(salvaging), id_(id),
+      nThreads_(nThreads), lgmStartParams_(lgmStartParams),
       optimizationMethod_(QuantLib::ext::shared_ptr<OptimizationMethod>(new LevenbergMarquardt(1E-8, 1E-8, 1E-8))),
       endCriteria_(EndCriteria(1000, 500, 1E-8, 1E-8, 1E-8)) {
     buildModel();
@@ -133,6 +134,16 @@ const std::vector<Real>& CrossAssetModelBuilder::comOptionCalibrationErrors() {
     return comOptionCalibrationErrors_;
 }
 
+std::map<std::string, Array> CrossAssetModelBuilder::lgmCalibratedParams() {
+    calculate();
+    std::map<std::string, Array> result;
+    for (auto const& [i, b] : subBuilders_[CrossAssetModel::AssetType::IR]) {
+        if (auto lgm = QuantLib::ext::dynamic_pointer_cast<LgmBuilder>(b))
+            result[lgm->qualifier()] = lgm->calibratedParams();
+    }
+    return result;
+}
+
 bool CrossAssetModelBuilder::requiresRecalibration() const {
     for (auto okv : subBuilders_)
         for (auto ikv : okv.second)
@@ -262,23 +273,75 @@ void CrossAssetModelBuilder::buildModel() const {
     std::vector<QuantLib::ext::shared_ptr<EqBsBuilder>> eqBuilder;
     std::vector<QuantLib::ext::shared_ptr<CommoditySchwartzModelBuilder>> csBuilder;
 
+    /* Set up the LGM builders first. The LGM calibrations are independent of each other, so that they can be run in
+       parallel if more than one thread is given. The preparation of the calibrations touches the shared market
+       objects and is therefore done sequentially, the optimisations only modify objects owned by the respective
+       builder. The calibration is triggered lazily in the loop below otherwise. */
+    std::map<Size, bool> lgmRequiresRecalibration;
+    std::vector<QuantLib::ext::shared_ptr<LgmBuilder>> pendingLgmCalibrations;
+    for (Size i = 0; i < config_->irConfigs().size(); i++) {
+        auto ir = QuantLib::ext::dynamic_pointer_cast<IrLgmData>(config_->irConfigs()[i]);
+        if (!ir)
+            continue;
+        if (!buildersAreInitialized) {
+            subBuilders_[CrossAssetModel::AssetType::IR][i] = QuantLib::ext::make_shared<LgmBuilder>(
+                market_, ir, configurationLgmCalibration_, config_->bootstrapTolerance(), continueOnError_,
+                referenceCalibrationGrid_, false, id_);
+            if (auto p = lgmStartParams_.find(ir->qualifier()); p != lgmStartParams_.end()) {
+                DLOG("Use " << p->second.size() << " start parameters for the calibration of LGM " << ir->qualifier());
+                QuantLib::ext::dynamic_pointer_cast<LgmBuilder>(subBuilders_[CrossAssetModel::AssetType::IR][i])
+                    ->setStartParams(p->second);
+            }
+        }
+        auto builder = QuantLib::ext::dynamic_pointer_cast<LgmBuilder>(subBuilders_[CrossAssetModel::AssetType::IR][i]);
+        if (dontCalibrate_) {
+            builder->freeze();
+        }
+        lgmRequiresRecalibration[i] = builder->requiresRecalibration();
+        if (builder->calibrationPending())
+            pendingLgmCalibrations.push_back(builder);
+    }
+
+    // a single pending calibration uses the threads to reprice its swaption basket in parallel instead
+    for (auto const& b : pendingLgmCalibrations)
+        b->setCalibrationThreads(pendingLgmCalibrations.size() == 1 ? nThreads_ : 1);
+
+    if (nThreads_ > 1 && pendingLgmCalibrations.size() > 1) {
+        DLOG("Calibrate " << pendingLgmCalibrations.size() << " LGM models using " << nThreads_ << " threads");
+        for (auto const& b : pendingLgmCalibrations)
+            b->prepareCalibration();
+        // the settings are thread local if QuantLib is built with sessions enabled, we only write them if necessary
+        Date asof = Settings::instance().evaluationDate();
+        bool includeReferenceDateEvents = Settings::instance().includeReferenceDateEvents();
+        auto includeTodaysCashFlows = Settings::instance().includeTodaysCashFlows();
+        bool enforcesTodaysHistoricFixings = Settings::instance().enforcesTodaysHistoricFixings();
+        ChunkWorkers workers(std::min(nThreads_, pendingLgmCalibrations.size()));
+        workers.run(pendingLgmCalibrations.size(), [&pendingLgmCalibrations, asof, includeReferenceDateEvents,
+                                                     includeTodaysCashFlows,
+                                                     enforcesTodaysHistoricFixings](const std::size_t i) {
+            if (Settings::instance().evaluationDate() != asof)
+                Settings::instance().evaluationDate() = asof;
+            if (Settings::instance().includeReferenceDateEvents() != includeReferenceDateEvents)
+                Settings::instance().includeReferenceDateEvents() = includeReferenceDateEvents;
+            if (Settings::instance().includeTodaysCashFlows() != includeTodaysCashFlows)
+                Settings::instance().includeTodaysCashFlows() = includeTodaysCashFlows;
+            if (Settings::instance().enforcesTodaysHistoricFixings() != enforcesTodaysHistoricFixings)
+                Settings::instance().enforcesTodaysHistoricFixings() = enforcesTodaysHistoricFixings;
+            pendingLgmCalibrations[i]->runCalibration();
+        });
+        for (auto const& b : pendingLgmCalibrations)
+            b->completeCalibration();
+    }
+
     std::set<std::string> recalibratedCurrencies;
     for (Size i = 0; i < config_->irConfigs().size(); i++) {
         auto irConfig = config_->irConfigs()[i];
         DLOG("IR Parametrization " << i << " qualifier " << irConfig->qualifier());
 
         if (auto ir = QuantLib::ext::dynamic_pointer_cast<IrLgmData>(irConfig)) {
-            if (!buildersAreInitialized) {
-                subBuilders_[CrossAssetModel::AssetType::IR][i] = QuantLib::ext::make_shared<LgmBuilder>(
-                    market_, ir, configurationLgmCalibration_, config_->bootstrapTolerance(), continueOnError_,
-                    referenceCalibrationGrid_, false, id_);
-            }
             auto builder = QuantLib::ext::dynamic_pointer_cast<LgmBuilder>(subBuilders_[CrossAssetModel::AssetType::IR][i]);
             lgmBuilder.push_back(builder);
-            if (dontCalibrate_) {
-                builder->freeze();
-            }
-            if (builder->requiresRecalibration())
+            if (lgmRequiresRecalibration.at(i))
                 recalibratedCurrencies.insert(builder->parametrization()->currency().code());
             auto parametrization = builder->parametrization();
             swaptionBaskets_[i] = builder->swaptionBasket();
@@ -84,7 +84,11 @@ public:
 	//! salvaging algorithm to apply to correlation matrix
 	const SalvagingAlgorithm::Type salvaging = SalvagingAlgorithm::None,
         //! id of the builder
-        const std::string& id = "unknown");
+        const std::string& id = "unknown",
+        //! number of threads used to calibrate the IR LGM components
+        const Size nThreads = 1,
+        //! start values for the calibration of the IR LGM components by qualifier, see lgmCalibratedParams()
+        const std::map<std::string, Array>& lgmStartParams = {});
 
     //! Default destructor
     ~CrossAssetModelBuilder() {}
@@ -99,6 +103,8 @@ public:
     const std::vector<Real>& eqOptionCalibrationErrors();
     const std::vector<Real>& inflationCalibrationErrors();
     const std::vector<Real>& comOptionCalibrationErrors();
+    //! calibrated parameters of the IR LGM components by qualifier, can be used as lgmStartParams in the ctor
+    std::map<std::string, Array> lgmCalibratedParams();
     //@}
 
     //! \name ModelBuilder interface
@@ -145,6 +151,8 @@ private:
     const std::string referenceCalibrationGrid_;
     const SalvagingAlgorithm::Type salvaging_;
     const std::string id_;
+    const Size nThreads_;
+    const std::map<std::string, Array> lgmStartParams_;
 
     // TODO: Move CalibrationErrorType, optimizer and end criteria parameters to data
     QuantLib::ext::shared_ptr<OptimizationMethod> optimizationMethod_;
@@ -37,6 +37,8 @@
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/strike.hpp>
 
+#include <boost/timer/timer.hpp>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -317,11 +319,25 @@ std::vector<QuantLib::ext::shared_ptr<BlackCalibrationHelper>> LgmBuilder::swapt
     return swaptionBasket_;
 }
 
+Array LgmBuilder::calibratedParams() const {
+    calculate();
+    return model_->params();
+}
+
+void LgmBuilder::setStartParams(const Array& params) {
+    QL_REQUIRE(params.empty() || params.size() == params_.size(),
+               "LgmBuilder::setStartParams(): got " << params.size() << " parameters for " << data_->qualifier()
+                                                    << ", expected " << params_.size());
+    startParams_ = params;
+}
+
 bool LgmBuilder::requiresRecalibration() const {
     return requiresCalibration_ &&
            (volSurfaceChanged(false) || marketObserver_->hasUpdated(false) || forceCalibration_);
 }
 
+bool LgmBuilder::calibrationPending() const { return !calculated_ && !frozen_ && requiresRecalibration(); }
+
 void LgmBuilder::performCalculations() const {
 
     DLOG("Recalibrate LGM model for qualifier " << data_->qualifier() << " currency " << currency_);
@@ -331,6 +347,13 @@ void LgmBuilder::performCalculations() const {
         return;
     }
 
+    prepareCalibration();
+    runCalibration();
+    completeCalibration();
+} // performCalculations()
+
+void LgmBuilder::prepareCalibration() const {
+
     // reset lgm observer's updated flag
     marketObserver_->hasUpdated(true);
 
@@ -354,17 +377,72 @@ void LgmBuilder::performCalculations() const {
         swaptionBasket_[j]->update();
     }
 
-    // reset model parameters to ensure identical results on identical market data input
-    model_->setParams(params_);
+    /* reset model parameters to ensure identical results on identical market data input, use the start parameters
+       if given */
+    model_->setParams(startParams_.empty() ? params_ : startParams_);
     parametrization_->shift() = 0.0;
     parametrization_->scaling() = 1.0;
 
-    LgmCalibrationInfo calibrationInfo;
+    /* evaluate the market and model values once, so that all lazy market objects the calibration depends on are
+       calculated and the swaptions are set up before runCalibration() is called */
+    try {
+        for (auto const& h : swaptionBasket_) {
+            h->marketValue();
+            h->modelValue();
+        }
+    } catch (const std::exception&) {
+        // the error will occur again and be reported in runCalibration()
+    }
+
+    setupReplicas();
+
     error_ = QL_MAX_REAL;
-    std::string errorTemplate =
-        std::string("Failed to calibrate LGM Model. ") +
-        (continueOnError_ ? std::string("Calculation will proceed anyway - using the calibration as is!")
-                          : std::string("Calculation will aborted."));
+}
+
+void LgmBuilder::setupReplicas() const {
+    std::vector<QuantExt::LinkableCalibratedModel::CalibrationReplica> replicas;
+    if (calibrationThreads_ > 1 && data_->calibrationType() != CalibrationType::Bootstrap &&
+        swaptionBasket_.size() > 1) {
+        Size nReplicas = std::min(calibrationThreads_, swaptionBasket_.size()) - 1;
+        try {
+            // the replicas are built from the same market and configuration, they do not recalibrate themselves
+            while (replicas_.size() < nReplicas) {
+                replicas_.push_back(QuantLib::ext::make_shared<LgmBuilder>(
+                    market_, data_, configuration_, bootstrapTolerance_, continueOnError_, referenceCalibrationGrid_,
+                    false, id_));
+            }
+            replicas_.resize(nReplicas);
+            for (auto const& r : replicas_) {
+                r->prepareCalibration();
+                QL_REQUIRE(r->swaptionBasket_.size() == swaptionBasket_.size(),
+                           "replica basket has " << r->swaptionBasket_.size() << " swaptions, expected "
+                                                 << swaptionBasket_.size());
+                replicas.push_back({r->model_, std::vector<QuantLib::ext::shared_ptr<CalibrationHelper>>(
+                                                   r->swaptionBasket_.begin(), r->swaptionBasket_.end())});
+            }
+            DLOG("LGM " << data_->qualifier() << " calibration uses " << replicas.size() + 1 << " threads");
+        } catch (const std::exception& e) {
+            WLOG("LGM " << data_->qualifier() << ": could not set up model replicas for parallel calibration ("
+                        << e.what() << "), calibrate sequentially");
+            replicas.clear();
+            replicas_.clear();
+        }
+    } else {
+        replicas_.clear();
+    }
+    model_->setCalibrationReplicas(
+        std::vector<QuantLib::ext::shared_ptr<CalibrationHelper>>(swaptionBasket_.begin(), swaptionBasket_.end()),
+        replicas);
+}
+
+std::string LgmBuilder::calibrationErrorTemplate() const {
+    return std::string("Failed to calibrate LGM Model. ") +
+           (continueOnError_ ? std::string("Calculation will proceed anyway - using the calibration as is!")
+                             : std::string("Calculation will aborted."));
+}
+
+void LgmBuilder::runCalibration() const {
+    boost::timer::cpu_timer timer;
     try {
         if (data_->calibrateA() && !data_->calibrateH() && data_->calibrationType() == CalibrationType::Bootstrap) {
             DLOG("call calibrateVolatilitiesIterative for volatility calibration (bootstrap)");
@@ -391,10 +469,18 @@ void LgmBuilder::performCalculations() const {
         TLOG("LGM " << data_->qualifier() << " calibration errors:");
         error_ = getCalibrationError(swaptionBasket_);
     } catch (const std::exception& e) {
-        // just log a warning, we check below if we meet the bootstrap tolerance and handle the result there
-        StructuredModelErrorMessage(errorTemplate, e.what(), id_).log();
+        // just log a warning, we check in completeCalibration() if we meet the bootstrap tolerance
+        StructuredModelErrorMessage(calibrationErrorTemplate(), e.what(), id_).log();
     }
+    calibrationTime_ = timer.elapsed().wall * 1e-9;
+    DLOG("LGM " << data_->qualifier() << " calibration took " << calibrationTime_ << " seconds");
+}
+
+void LgmBuilder::completeCalibration() const {
+    LgmCalibrationInfo calibrationInfo;
+    std::string errorTemplate = calibrationErrorTemplate();
     calibrationInfo.rmse = error_;
+    calibrationInfo.calibrationTime = calibrationTime_;
     if (fabs(error_) < bootstrapTolerance_ ||
         (data_->calibrationType() == CalibrationType::BestFit && error_ != QL_MAX_REAL)) {
         // we check the log level here to avoid unnecessary computations
@@ -462,7 +548,7 @@ void LgmBuilder::performCalculations() const {
         DLOG("Apply scaling " << data_->scaling() << " to the " << data_->qualifier() << " LGM model");
         parametrization_->scaling() = data_->scaling();
     }
-} // performCalculations()
+} // completeCalibration()
 
 void LgmBuilder::getExpiryAndTerm(const Size j, Period& expiryPb, Period& termPb, Date& expiryDb, Date& termDb,
                                   Real& termT, bool& expiryDateBased, bool& termDateBased) const {
@@ -689,6 +775,8 @@ std::string LgmBuilder::getBasketDetails(LgmCalibrationInfo& info) const {
     return log.str();
 }
 
+void LgmBuilder::setCalibrationThreads(const Size nThreads) { calibrationThreads_ = std::max<Size>(nThreads, 1); }
+
 void LgmBuilder::forceRecalculate() {
     forceCalibration_ = true;
     ModelBuilder::forceRecalculate();
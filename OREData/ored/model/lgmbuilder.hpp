@@ -69,17 +69,48 @@ public:
     RelinkableHandle<YieldTermStructure> discountCurve() { return modelDiscountCurve_; }
     QuantLib::ext::shared_ptr<QuantExt::IrLgm1fParametrization> parametrization() const;
     std::vector<QuantLib::ext::shared_ptr<BlackCalibrationHelper>> swaptionBasket() const;
+    //! The model parameters after the last calibration, can be passed as start values to another builder
+    Array calibratedParams() const;
     //@}
 
+    /*! Set the start values for the model parameters in subsequent calibrations. By default the optimiser starts
+        from the initial values given in the configuration. Starting from the calibrated parameters of a similar
+        market (e.g. the base scenario in a sensitivity analysis) usually reduces the number of iterations. An
+        empty array restores the default. */
+    void setStartParams(const Array& params);
+
+    /*! Set the number of threads used to reprice the swaption basket in global (best fit) calibrations. For more
+        than one thread, the basket is repriced in chunks on replicas of the model and basket, which are set up by
+        prepareCalibration(). The default is one thread, i.e. a sequential calibration. */
+    void setCalibrationThreads(const Size nThreads);
+
     //! \name ModelBuilder interface
     //@{
     void forceRecalculate() override;
     bool requiresRecalibration() const override;
     //@}
 
+    /*! \name Calibration steps
+        The calibration triggered by calculate() can alternatively be run in three steps, so that the optimisation
+        can be run for several builders in parallel: prepareCalibration() sets up the swaption basket and evaluates
+        all market data dependent objects, runCalibration() only modifies objects owned by this builder and may be
+        called concurrently for distinct builders, completeCalibration() checks the calibration error, logs the
+        results and applies the shift horizon and scaling. The steps should only be called if calibrationPending()
+        is true, i.e. if calculate() would recalibrate the model, and in the given order. A subsequent calculate()
+        then does not recalibrate the model again. */
+    //@{
+    bool calibrationPending() const;
+    void prepareCalibration() const;
+    void runCalibration() const;
+    void completeCalibration() const;
+    //@}
+
 private:
     void performCalculations() const override;
+    std::string calibrationErrorTemplate() const;
     void buildSwaptionBasket() const;
+    // set up the model and basket replicas for a parallel calibration, if more than one thread is given
+    void setupReplicas() const;
     void updateSwaptionBasketVols() const;
     std::string getBasketDetails(QuantExt::LgmCalibrationInfo& info) const;
     // checks whether swaption vols have changed compared to cache and updates the cache if requested
@@ -104,6 +135,7 @@ private:
     mutable Real error_;
     mutable QuantLib::ext::shared_ptr<QuantExt::LGM> model_;
     mutable Array params_;
+    Array startParams_;
     mutable QuantLib::ext::shared_ptr<QuantExt::IrLgm1fParametrization> parametrization_;
 
     // which swaptions in data->optionExpries() are actually in the basket?
@@ -113,6 +145,11 @@ private:
     mutable std::vector<QuantLib::ext::shared_ptr<SimpleQuote>> swaptionBasketVols_;
     mutable Array swaptionExpiries_;
     mutable Array swaptionMaturities_;
+
+    // parallel calibration
+    Size calibrationThreads_ = 1;
+    mutable std::vector<QuantLib::ext::shared_ptr<LgmBuilder>> replicas_;
+    mutable Real calibrationTime_ = Null<Real>();
     mutable Date swaptionBasketRefDate_;
 
     Handle<QuantLib::SwaptionVolatilityStructure> svts_;
@@ -22,6 +22,7 @@
 #include <ored/utilities/log.hpp>
 
 #include <qle/models/carrmadanarbitragecheck.hpp>
+#include <qle/termstructures/gridlocalvolsurface.hpp>
 
 #include <ql/exercise.hpp>
 #include <ql/instruments/payoffs.hpp>
@@ -41,9 +42,16 @@ LocalVolModelBuilder::LocalVolModelBuilder(
     const std::vector<Handle<YieldTermStructure>>& curves,
     const std::vector<ext::shared_ptr<GeneralizedBlackScholesProcess>>& processes,
     const std::set<Date>& simulationDates, const std::set<Date>& addDates, const Size timeStepsPerYear,
-    const Type lvType, const std::vector<Real>& calibrationMoneyness, const bool dontCalibrate)
+    const Type lvType, const std::vector<Real>& calibrationMoneyness, const bool dontCalibrate,
+    const Size localVolGridStrikes, const Real localVolGridStdDevs, const bool checkLocalVolGrid)
     : BlackScholesModelBuilderBase(curves, processes, simulationDates, addDates, timeStepsPerYear), lvType_(lvType),
-      calibrationMoneyness_(calibrationMoneyness), dontCalibrate_(dontCalibrate) {
+      calibrationMoneyness_(calibrationMoneyness), dontCalibrate_(dontCalibrate),
+      localVolGridStrikes_(localVolGridStrikes), localVolGridStdDevs_(localVolGridStdDevs),
+      checkLocalVolGrid_(checkLocalVolGrid) {
+    QL_REQUIRE(localVolGridStrikes_ == 0 || localVolGridStrikes_ >= 2,
+               "LocalVolModelBuilder: localVolGridStrikes (" << localVolGridStrikes_ << ") must be 0 or >= 2");
+    QL_REQUIRE(localVolGridStdDevs_ > 0.0,
+               "LocalVolModelBuilder: localVolGridStdDevs (" << localVolGridStdDevs_ << ") must be positive");
     // we have to observe the whole vol surface for the Dupire implementation unfortunately; we can specify the time
     // steps that are relevant, but not a set of discrete strikes
     if (lvType == Type::Dupire) {
@@ -147,6 +155,33 @@ std::vector<QuantLib::ext::shared_ptr<GeneralizedBlackScholesProcess>> LocalVolM
             QL_FAIL("unexpected local vol type");
         }
 
+        // precompute the local vol on the discretisation time grid and a log-strike grid, the range of the latter
+        // is given by the spot and the atm forwards on the time grid shifted by a multiple of the atm std dev
+        if (!dontCalibrate_ && localVolGridStrikes_ > 0) {
+            std::vector<Real> times(discretisationTimeGrid_.begin(), discretisationTimeGrid_.end());
+            Real logX0 = std::log(processes_[l]->x0());
+            Real minLogStrike = logX0, maxLogStrike = logX0;
+            for (auto const t : times) {
+                Real atmLevel =
+                    atmForward(processes_[l]->x0(), processes_[l]->riskFreeRate(), processes_[l]->dividendYield(), t);
+                Real atmMarketVol = std::max(1e-4, processes_[l]->blackVolatility()->blackVol(t, atmLevel));
+                Real width = localVolGridStdDevs_ * atmMarketVol * std::sqrt(std::max(t, 1.0 / 365.0));
+                minLogStrike = std::min(minLogStrike, std::min(logX0, std::log(atmLevel)) - width);
+                maxLogStrike = std::max(maxLogStrike, std::max(logX0, std::log(atmLevel)) + width);
+            }
+            auto grid = QuantLib::ext::make_shared<QuantExt::GridLocalVolSurface>(localVol, times, minLogStrike,
+                                                                                  maxLogStrike, localVolGridStrikes_);
+            DLOG("local vol for process #" << l << " precomputed on " << times.size() << " times x "
+                                           << localVolGridStrikes_ << " log-strikes in [" << minLogStrike << ","
+                                           << maxLogStrike << "]");
+            if (checkLocalVolGrid_) {
+                LOG("local vol grid for process #" << l << ": max abs interpolation error on cell midpoints = "
+                                                   << std::scientific << std::setprecision(6)
+                                                   << grid->maxMidpointError());
+            }
+            localVol = Handle<LocalVolTermStructure>(grid);
+        }
+
         processes.push_back(QuantLib::ext::make_shared<GeneralizedBlackScholesProcess>(
             processes_[l]->stateVariable(), processes_[l]->dividendYield(), processes_[l]->riskFreeRate(),
             processes_[l]->blackVolatility(), localVol));
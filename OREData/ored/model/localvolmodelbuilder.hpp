@@ -30,6 +30,10 @@ namespace data {
 
 using namespace QuantLib;
 
+/*! If localVolGridStrikes > 0, the calibrated local vol surfaces are precomputed on the discretisation time grid
+    and on localVolGridStrikes log-strikes covering localVolGridStdDevs standard deviations around the spot and the
+    atm forwards, see QuantExt::GridLocalVolSurface. If checkLocalVolGrid is true, the maximum interpolation error of
+    the grid on the cell midpoints is logged. */
 class LocalVolModelBuilder : public BlackScholesModelBuilderBase {
 public:
     enum class Type { Dupire, DupireFloored, AndreasenHuge };
@@ -40,7 +44,8 @@ public:
                          const Size timeStepsPerYear = 1,
                          const Type lvType = Type::Dupire,
                          const std::vector<Real>& calibrationMoneyness = { -2.0, -1.0, 0.0, 1.0, 2.0 },
-                         const bool dontCalibrate = false);
+                         const bool dontCalibrate = false, const Size localVolGridStrikes = 0,
+                         const Real localVolGridStdDevs = 5.0, const bool checkLocalVolGrid = false);
     LocalVolModelBuilder(const Handle<YieldTermStructure>& curve,
                          const ext::shared_ptr<GeneralizedBlackScholesProcess>& process,
                          const std::set<Date>& simulationDates = {},
@@ -48,10 +53,12 @@ public:
                          const Size timeStepsPerYear = 1,
                          const Type lvType = Type::Dupire,
                          const std::vector<Real>& calibrationMoneyness = { -2.0, -1.0, 0.0, 1.0, 2.0 },
-                         const bool dontCalibrate = false)
+                         const bool dontCalibrate = false, const Size localVolGridStrikes = 0,
+                         const Real localVolGridStdDevs = 5.0, const bool checkLocalVolGrid = false)
         : LocalVolModelBuilder(std::vector<Handle<YieldTermStructure>>{curve},
                                std::vector<ext::shared_ptr<GeneralizedBlackScholesProcess>>{process}, simulationDates,
-                               addDates, timeStepsPerYear, lvType, calibrationMoneyness, dontCalibrate) {}
+                               addDates, timeStepsPerYear, lvType, calibrationMoneyness, dontCalibrate,
+                               localVolGridStrikes, localVolGridStdDevs, checkLocalVolGrid) {}
 
     std::vector<ext::shared_ptr<GeneralizedBlackScholesProcess>> getCalibratedProcesses() const override;
 
@@ -63,6 +70,9 @@ private:
     const Type lvType_;
     const std::vector<Real> calibrationMoneyness_;
     const bool dontCalibrate_;
+    const Size localVolGridStrikes_;
+    const Real localVolGridStdDevs_;
+    const bool checkLocalVolGrid_;
 };
 
 } // namespace data
@@ -38,6 +38,7 @@
 #include <ored/marketdata/basecorrelationcurve.hpp>
 #include <ored/marketdata/bondspreadimply.hpp>
 #include <ored/marketdata/bondspreadimplymarket.hpp>
+#include <ored/marketdata/bootstrapwarmstarts.hpp>
 #include <ored/marketdata/capfloorvolcurve.hpp>
 #include <ored/marketdata/cdsvolcurve.hpp>
 #include <ored/marketdata/clonedloader.hpp>
@@ -59,6 +60,7 @@
 #include <ored/marketdata/fxtriangulation.hpp>
 #include <ored/marketdata/fxvolcurve.hpp>
 #include <ored/marketdata/genericyieldvolcurve.hpp>
+#include <ored/marketdata/indexedmarketdata.hpp>
 #include <ored/marketdata/inflationcapfloorvolcurve.hpp>
 #include <ored/marketdata/inflationcurve.hpp>
 #include <ored/marketdata/inmemoryloader.hpp>
@@ -343,6 +345,7 @@
 #include <ored/scripting/astprinter.hpp>
 #include <ored/scripting/astresetter.hpp>
 #include <ored/scripting/asttoscriptconverter.hpp>
+#include <ored/scripting/bytecode.hpp>
 #include <ored/scripting/computationgraphbuilder.hpp>
 #include <ored/scripting/context.hpp>
 #include <ored/scripting/engines/analyticblackriskparticipationagreementengine.hpp>
@@ -372,9 +375,13 @@
 #include <ored/scripting/models/modelcg.hpp>
 #include <ored/scripting/models/modelcgimpl.hpp>
 #include <ored/scripting/models/modelimpl.hpp>
+#include <ored/scripting/models/pathslicemodel.hpp>
+#include <ored/scripting/models/tapemodelcg.hpp>
+#include <ored/scripting/pathcache.hpp>
 #include <ored/scripting/paylog.hpp>
 #include <ored/scripting/randomastgenerator.hpp>
 #include <ored/scripting/safestack.hpp>
+#include <ored/scripting/scriptcache.hpp>
 #include <ored/scripting/scriptedinstrument.hpp>
 #include <ored/scripting/scriptengine.hpp>
 #include <ored/scripting/scriptparser.hpp>
@@ -408,6 +415,7 @@
 #include <ored/utilities/strike.hpp>
 #include <ored/utilities/timeperiod.hpp>
 #include <ored/utilities/to_string.hpp>
+#include <ored/utilities/trace.hpp>
 #include <ored/utilities/vectorutils.hpp>
 #include <ored/utilities/wildcard.hpp>
 #include <ored/utilities/xmlutils.hpp>
@@ -101,6 +101,7 @@ void AsianOption::build(const QuantLib::ext::shared_ptr<EngineFactory>& engineFa
         additionalData_ = delegatingBuilderTrade_->additionalData();
 	requiredFixings_ = delegatingBuilderTrade_->requiredFixings();
         setSensitivityTemplate(delegatingBuilderTrade_->sensitivityTemplate());
+        pricingEngine_ = delegatingBuilderTrade_->pricingEngine();
 
         // notional and notional currency are defined in overriden methods!
 
@@ -256,12 +256,29 @@ QuantLib::ext::shared_ptr<QuantLib::PricingEngine> ConvertibleBondFDDefaultableE
         generateAdditionalResults = parseBool(genAddParam->second);
     }
 
-    // set up model and pricing engine
-
-    auto modelBuilder = QuantLib::ext::make_shared<DefaultableEquityJumpDiffusionModelBuilder>(
-        calibrationTimes, equity, volatility, isExchangeable ? equityCreditCurve : creditCurve, p, eta, staticMesher,
-        modelTimeStepsPerYear, modelStateGridPoints, modelMesherEpsilon, modelMesherScaling, modelMesherConcentration,
-        bootstrapMode, false, calibrate, adjustEquityVolatility, adjustEquityForward);
+    /* set up model and pricing engine, the model only depends on the trade via the arguments below (the credit
+       curve adjustments are security specific, the calibration times depend on the maturity date and the compo
+       equity index on the start date), trades sharing these share the model */
+
+    std::ostringstream modelKey;
+    modelKey << equityName << "|" << ccy << "|" << (fx == nullptr ? std::string() : fx->name()) << "|"
+             << isExchangeable << "|" << (isExchangeable ? equityCreditCurveId : creditCurveId) << "|"
+             << hasCreditRisk << "|" << securityId << "|" << QuantLib::io::iso_date(maturityDate);
+    if (fx != nullptr)
+        modelKey << "|" << QuantLib::io::iso_date(startDate);
+
+    QuantLib::ext::shared_ptr<DefaultableEquityJumpDiffusionModelBuilder> modelBuilder;
+    auto m = sharedModelBuilders_.find(modelKey.str());
+    if (m != sharedModelBuilders_.end()) {
+        DLOG("ConvertibleBond engine builder: reuse model for trade " << id << " (" << modelKey.str() << ")");
+        modelBuilder = m->second;
+    } else {
+        modelBuilder = QuantLib::ext::make_shared<DefaultableEquityJumpDiffusionModelBuilder>(
+            calibrationTimes, equity, volatility, isExchangeable ? equityCreditCurve : creditCurve, p, eta,
+            staticMesher, modelTimeStepsPerYear, modelStateGridPoints, modelMesherEpsilon, modelMesherScaling,
+            modelMesherConcentration, bootstrapMode, false, calibrate, adjustEquityVolatility, adjustEquityForward);
+        sharedModelBuilders_[modelKey.str()] = modelBuilder;
+    }
 
     modelBuilders_.insert(std::make_pair(id, modelBuilder));
 
@@ -272,5 +289,10 @@ QuantLib::ext::shared_ptr<QuantLib::PricingEngine> ConvertibleBondFDDefaultableE
         conversionRatioDiscretisationGrid, generateAdditionalResults);
 }
 
+void ConvertibleBondFDDefaultableEquityJumpDiffusionEngineBuilder::reset() {
+    ConvertibleBondEngineBuilder::reset();
+    sharedModelBuilders_.clear();
+}
+
 } // namespace data
 } // namespace ore
@@ -24,6 +24,8 @@
 #include <ored/portfolio/enginefactory.hpp>
 #include <ored/utilities/log.hpp>
 
+#include <qle/models/defaultableequityjumpdiffusionmodel.hpp>
+
 #include <ql/time/date.hpp>
 
 #include <boost/make_shared.hpp>
@@ -54,6 +56,8 @@ public:
     ConvertibleBondFDDefaultableEquityJumpDiffusionEngineBuilder()
         : ConvertibleBondEngineBuilder("DefaultableEquityJumpDiffusion", "FD") {}
 
+    void reset() override;
+
 protected:
     QuantLib::ext::shared_ptr<QuantExt::PricingEngine>
     engineImpl(const std::string& id, const std::string& ccy, const std::string& creditCurveId,
@@ -61,6 +65,12 @@ protected:
                const bool isExchangeable, QuantLib::ext::shared_ptr<QuantExt::EquityIndex2> equity,
                const QuantLib::ext::shared_ptr<QuantExt::FxIndex>& fx, const std::string& equityCreditCurveId,
                const QuantLib::Date& startDate, const QuantLib::Date& maturityDate) override;
+
+private:
+    /* model builders by model key, trades with identical model inputs share one model, so that the model
+       calibration (which involves a forward PDE solve) is done once for all of them */
+    std::map<std::string, QuantLib::ext::shared_ptr<QuantExt::DefaultableEquityJumpDiffusionModelBuilder>>
+        sharedModelBuilders_;
 };
 
 } // namespace data
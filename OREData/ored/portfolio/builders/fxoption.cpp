@@ -96,7 +96,10 @@ QuantLib::ext::shared_ptr<PricingEngine> CamAmcFxOptionEngineBuilder::engineImpl
         parseSobolRsgDirectionIntegers(engineParameter("SobolDirectionIntegers")), discountCurves, simulationDates_,
         externalModelIndices, parseBool(engineParameter("MinObsDate")),
         parseRegressorModel(engineParameter("RegressorModel", {}, false, "Simple")),
-        parseRealOrNull(engineParameter("RegressionVarianceCutoff", {}, false, std::string())));
+        parseRealOrNull(engineParameter("RegressionVarianceCutoff", {}, false, std::string())),
+        parseBool(engineParameter("ShareRegressionFactorisations", {}, false, "false")),
+        parseBool(engineParameter("UsePathStore", {}, false, "false")),
+        parseBool(engineParameter("SinglePrecisionPaths", {}, false, "false")));
 
     return engine;
 }
@@ -18,16 +18,41 @@
 
 #include <ored/portfolio/builders/indexcreditdefaultswap.hpp>
 #include <qle/pricingengines/midpointindexcdsengine.hpp>
+#include <qle/pricingengines/midpointindexcdsenginemultistate.hpp>
 
 #include <ored/utilities/marketdata.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
 
+#include <ql/quotes/simplequote.hpp>
+
+#include <boost/algorithm/string.hpp>
 #include <boost/make_shared.hpp>
 
+#include <regex>
+
 namespace ore {
 namespace data {
 
+namespace {
+// mid point engine on the constituent curves
+QuantLib::ext::shared_ptr<PricingEngine>
+underlyingCurvesEngine(const QuantLib::ext::shared_ptr<Market>& market, const string& configuration,
+                       const string& discountConfiguration, const Currency& ccy, const vector<string>& creditCurveIds,
+                       const Real recoveryRate) {
+    std::vector<Handle<DefaultProbabilityTermStructure>> dpts;
+    std::vector<Real> recovery;
+    for (auto& c : creditCurveIds) {
+        auto tmp = market->defaultCurve(c, configuration);
+        auto tmp2 = market->recoveryRate(c, configuration);
+        dpts.push_back(tmp->curve());
+        recovery.push_back(recoveryRate != Null<Real>() ? recoveryRate : tmp2->value());
+    }
+    return QuantLib::ext::make_shared<QuantExt::MidPointIndexCdsEngine>(
+        dpts, recovery, market->discountCurve(ccy.code(), discountConfiguration));
+}
+} // namespace
+
 CreditPortfolioSensitivityDecomposition IndexCreditDefaultSwapEngineBuilder::sensitivityDecomposition() {
     return parseCreditPortfolioSensitivityDecomposition(
         engineParameter("SensitivityDecomposition", {}, false, "Underlying"));
@@ -62,23 +87,86 @@ QuantLib::ext::shared_ptr<PricingEngine> MidPointIndexCdsEngineBuilder::engineIm
             market_->discountCurve(
                 ccy.code(), configuration(inCcyDiscountCurve ? MarketContext::irCalibration : MarketContext::pricing)));
     } else if (curve == "Underlying") {
-        std::vector<Handle<DefaultProbabilityTermStructure>> dpts;
-        std::vector<Real> recovery;
-        for (auto& c : creditCurveIds) {
-            auto tmp = market_->defaultCurve(c, configuration(MarketContext::pricing));
-            auto tmp2 = market_->recoveryRate(c, configuration(MarketContext::pricing));
-            dpts.push_back(tmp->curve());
-            recovery.push_back(recoveryRate != Null<Real>() ? recoveryRate : tmp2->value());
-        }
-        return QuantLib::ext::make_shared<QuantExt::MidPointIndexCdsEngine>(
-            dpts, recovery,
-            market_->discountCurve(
-                ccy.code(), configuration(inCcyDiscountCurve ? MarketContext::irCalibration : MarketContext::pricing)));
+        return underlyingCurvesEngine(market_, configuration(MarketContext::pricing),
+                                      configuration(inCcyDiscountCurve ? MarketContext::irCalibration
+                                                                       : MarketContext::pricing),
+                                      ccy, creditCurveIds, recoveryRate);
     } else {
         QL_FAIL("MidPointIndexCdsEngineBuilder: Curve Parameter value \""
                 << engineParameter("Curve") << "\" not recognised, expected Underlying or Index");
     }
 }
 
+QuantLib::ext::shared_ptr<PricingEngine> MidPointIndexCdsMultiStateEngineBuilder::engineImpl(
+    const Currency& ccy, const string& creditCurveId, const vector<string>& creditCurveIds,
+    const boost::optional<string>& overrideCurve, Real recoveryRate, const bool inCcyDiscountCurve) {
+
+    // the states are defined on the index curve, on request (e.g. for the underlying of an index cds option) we
+    // fall back to a single state engine on the constituent curves
+    if (overrideCurve && *overrideCurve == "Underlying") {
+        return underlyingCurvesEngine(market_, configuration(MarketContext::pricing),
+                                      configuration(inCcyDiscountCurve ? MarketContext::irCalibration
+                                                                       : MarketContext::pricing),
+                                      ccy, creditCurveIds, recoveryRate);
+    }
+    QL_REQUIRE(!overrideCurve || *overrideCurve == "Index",
+               "MidPointIndexCdsMultiStateEngineBuilder: override curve \"" << *overrideCurve
+                                                                            << "\" not recognised, expected "
+                                                                               "Underlying or Index");
+
+    // build state curves and recovery rates
+    std::vector<Handle<DefaultProbabilityTermStructure>> dpts;
+    std::vector<Handle<Quote>> recovery;
+    Size mainResultState = Null<Size>();
+    auto addState = [this, &dpts, &recovery, recoveryRate](const string& stateCreditCurveId) {
+        auto cfg = configuration(MarketContext::pricing);
+        dpts.push_back(indexCdsDefaultCurve(market_, stateCreditCurveId, cfg)->curve());
+        recovery.push_back(recoveryRate == Null<Real>()
+                               ? market_->recoveryRate(stateCreditCurveId, cfg)
+                               : Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(recoveryRate)));
+    };
+    Size i = 0;
+    for (; true; ++i) {
+        std::ostringstream rule_s;
+        rule_s << "Rule_" << i;
+        if (engineParameters_.count(rule_s.str()) == 0)
+            break;
+        std::string rule = engineParameters_[rule_s.str()];
+        std::string stateCreditCurveId;
+        // if rule is empty, we use the initial curve for this state, the engine prices it only once
+        if (rule.empty()) {
+            stateCreditCurveId = creditCurveId;
+            DLOG("Rule " << rule_s.str() << " is empty, use initial curve " << stateCreditCurveId
+                         << " for this state.");
+        } else {
+            std::vector<std::string> tokens;
+            boost::split(tokens, rule, boost::is_any_of(","));
+            QL_REQUIRE(tokens.size() == 2, "invalid rule: " << rule);
+            stateCreditCurveId = regex_replace(creditCurveId, std::regex(tokens[0]), tokens[1]);
+            DLOG("Apply " << rule_s.str() << " => " << tokens[0] << " in " << creditCurveId << " yields state #" << i
+                          << " creditCurve id " << stateCreditCurveId);
+        }
+        if (stateCreditCurveId == creditCurveId) {
+            mainResultState = i;
+            DLOG("State #" << i << " is the main result state (overwriting previous choice)");
+        }
+        addState(stateCreditCurveId);
+    }
+    // If there were no rules at all we take the original creditCurveId as the only state
+    if (i == 0) {
+        addState(creditCurveId);
+        mainResultState = 0;
+        DLOG("No rules given, only states are " << creditCurveId << " and default");
+    }
+    // check we have a main result state
+    QL_REQUIRE(mainResultState != Null<Size>(),
+               "MidPointIndexCdsMultiStateEngineBuilder: No main state found for " << creditCurveId);
+    return QuantLib::ext::make_shared<QuantExt::MidPointIndexCdsEngineMultiState>(
+        dpts, recovery,
+        market_->discountCurve(
+            ccy.code(), configuration(inCcyDiscountCurve ? MarketContext::irCalibration : MarketContext::pricing)),
+        mainResultState);
+}
+
 } // namespace data
 } // namespace ore
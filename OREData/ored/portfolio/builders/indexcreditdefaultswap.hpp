@@ -72,5 +72,24 @@ protected:
                                                 const bool inCcyDiscountCurve = false) override;
 };
 
+//! Multi State Engine Builder class for IndexCreditDefaultSwaps
+/*! This class creates a MidPointIndexCdsEngineMultiState on the index curve. The states are derived from the index
+    credit curve id by the rules Rule_0, Rule_1, ... as for the MidPointCdsMultiStateEngineBuilder.
+    \ingroup portfolio
+*/
+
+class MidPointIndexCdsMultiStateEngineBuilder : public IndexCreditDefaultSwapEngineBuilder {
+public:
+    MidPointIndexCdsMultiStateEngineBuilder()
+        : IndexCreditDefaultSwapEngineBuilder("DiscountedCashflows", "MidPointIndexCdsEngineMultiState") {}
+
+protected:
+    QuantLib::ext::shared_ptr<PricingEngine> engineImpl(const Currency& ccy, const string& creditCurveId,
+                                                const vector<string>& creditCurveIds,
+                                                const boost::optional<string>& overrideCurve,
+                                                Real recoveryRate = Null<Real>(),
+                                                const bool inCcyDiscountCurve = false) override;
+};
+
 } // namespace data
 } // namespace ore
@@ -58,6 +58,8 @@ RiskParticipationAgreementBlackEngineBuilder::engineImpl(const std::string& id,
     Size maxDiscretisationPoints = parseInteger(engineParameter("MaxDiscretisationPoints"));
     if (maxDiscretisationPoints == 0)
         maxDiscretisationPoints = Null<Size>();
+    std::string toleranceParam = engineParameter("OptionRepresentationTolerance", {}, false, "");
+    Real optionRepresentationTolerance = toleranceParam.empty() ? Null<Real>() : parseReal(toleranceParam);
     string config = configuration(MarketContext::pricing);
     // the first ibor / ois index found
     QuantLib::ext::shared_ptr<IborIndex> index;
@@ -83,7 +85,7 @@ RiskParticipationAgreementBlackEngineBuilder::engineImpl(const std::string& id,
         parseReal(
             modelParameter("Reversion", {IndexNameTranslator::instance().oreName(index->name()), rpa->npvCurrency()})),
         parseBool(engineParameter("AlwaysRecomputeOptionRepresentation")), parseInteger(engineParameter("MaxGapDays")),
-        maxDiscretisationPoints);
+        maxDiscretisationPoints, optionRepresentationTolerance);
 }
 
 QuantLib::ext::shared_ptr<QuantLib::PricingEngine>
@@ -28,6 +28,7 @@
 #include <ored/scripting/engines/scriptedinstrumentpricingenginecg.hpp>
 #include <ored/scripting/astprinter.hpp>
 #include <ored/scripting/context.hpp>
+#include <ored/scripting/scriptcache.hpp>
 #include <ored/scripting/scriptparser.hpp>
 #include <ored/scripting/scriptedinstrument.hpp>
 
@@ -117,16 +118,7 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
     ScriptedTradeScriptData script =
         getScript(scriptedTrade, ScriptLibraryStorage::instance().get(), purpose, true).second;
 
-    auto f = astCache_.find(script.code());
-
-    if (f != astCache_.end()) {
-        ast_ = f->second;
-        DLOG("retrieved ast from cache");
-    } else {
-        ast_ = parseScript(script.code());
-        astCache_[script.code()] = ast_;
-        DLOGGERSTREAM("built ast:\n" << to_string(ast_));
-    }
+    ast_ = ScriptCache::instance().ast(script.code());
 
     // 4 set up context
 
@@ -262,9 +254,14 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
 
     DLOG("built model          : " << modelParam_ << " / " << engineParam_);
     DLOG("useCg                = " << std::boolalpha << useCg_);
+    DLOG("useBytecode          = " << std::boolalpha << useBytecode_);
+    DLOG("pathChunks           = " << pathChunks_);
+    DLOG("pathwiseSensis       = " << std::boolalpha << pathwiseSensitivities_);
+    DLOG("keepPayLogPaths      = " << std::boolalpha << keepPayLogPaths_);
     DLOG("useAd                = " << std::boolalpha << useAd_);
     DLOG("useExternalDevice    = " << std::boolalpha << useExternalComputeDevice_);
     DLOG("useDblPrecExtCalc    = " << std::boolalpha << useDoublePrecisionForExternalCalculation_);
+    DLOG("regressionOnExtDev   = " << std::boolalpha << regressionOnExternalDevice_);
     DLOG("extDeviceCompatMode  = " << std::boolalpha << externalDeviceCompatibilityMode_);
     DLOG("externalDevice       = " << (useExternalComputeDevice_ ? externalComputeDevice_ : "na"));
     DLOG("calibration          = " << calibration_);
@@ -291,6 +288,7 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
         }
         DLOG("sobol bb ordering    = " << mcParams_.sobolOrdering);
         DLOG("sobol direction int. = " << mcParams_.sobolDirectionIntegers);
+        DLOG("use path cache       = " << std::boolalpha << mcParams_.usePathCache);
     } else if (engineParam_ == "FD") {
         DLOG("stateGridPoints      = " << modelSize_);
         DLOG("mesherEpsilon        = " << mesherEpsilon_);
@@ -298,6 +296,7 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
         DLOG("mesherConcentration  = " << mesherConcentration_);
         DLOG("mesherMaxConcentrPts = " << mesherMaxConcentratingPoints_);
         DLOG("mesherIsStatic       = " << std::boolalpha << mesherIsStatic_);
+        DLOG("cacheStepOperators   = " << std::boolalpha << cacheStepOperators_);
     }
     if (modelParam_ == "GaussianCam") {
         DLOG("fullDynamicIr        = " << std::boolalpha << fullDynamicIr_);
@@ -308,6 +307,11 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
     } else if (modelParam_ == "LocalVolAndreasenHuge") {
         DLOG("moneyness points = " << calibrationMoneyness_.size());
     }
+    if (modelParam_ == "LocalVolDupire" || modelParam_ == "LocalVolAndreasenHuge") {
+        DLOG("localVolGridStrikes  = " << localVolGridStrikes_);
+        DLOG("localVolGridStdDevs  = " << localVolGridStdDevs_);
+        DLOG("localVolGridCheck    = " << std::boolalpha << localVolGridCheck_);
+    }
 
     // 22 build the pricing engine and return it
 
@@ -322,8 +326,13 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
         engine = QuantLib::ext::make_shared<ScriptedInstrumentPricingEngine>(
             script.npv(), script.results(), model_, ast_, context, script.code(), interactive_, amcCam_ != nullptr,
             std::set<std::string>(script.stickyCloseOutStates().begin(), script.stickyCloseOutStates().end()),
-            generateAdditionalResults, includePastCashflows_);
+            generateAdditionalResults, includePastCashflows_,
+            useBytecode_ ? ScriptCache::instance().bytecode(script.code()) : nullptr, pathChunks_,
+            pathwiseSensitivities_, keepPayLogPaths_, script.controlVariates());
     } else if (modelCG_) {
+        if (!script.controlVariates().empty()) {
+            WLOG("Will not apply control variates, since they are not supported by the computation graph engine");
+        }
         auto rt = globalParameters_.find("RunType");
         std::string runType = rt != globalParameters_.end() ? rt->second : "<<no run type set>>";
         bool useCachedSensis = useAd_ && (runType == "SensitivityDelta");
@@ -341,7 +350,7 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
         engine = QuantLib::ext::make_shared<ScriptedInstrumentPricingEngineCG>(
             script.npv(), script.results(), modelCG_, ast_, context, mcParams_, script.code(), interactive_,
             generateAdditionalResults, includePastCashflows_, useCachedSensis, useExternalDev,
-            useDoublePrecisionForExternalCalculation_);
+            useDoublePrecisionForExternalCalculation_, regressionOnExternalDevice_);
         if (useExternalDev) {
             ComputeEnvironment::instance().selectContext(externalComputeDevice_);
         }
@@ -502,9 +511,18 @@ void ScriptedTradeEngineBuilder::populateModelParameters() {
         parseBool(engineParameter("UseExternalComputeDevice", {resolvedProductTag_}, false, "false"));
     useDoublePrecisionForExternalCalculation_ =
         parseBool(engineParameter("UseDoublePrecisionForExternalCalculation", {resolvedProductTag_}, false, "false"));
+    regressionOnExternalDevice_ =
+        parseBool(engineParameter("RegressionOnExternalDevice", {resolvedProductTag_}, false, "false"));
     externalComputeDevice_ = engineParameter("ExternalComputeDevice", {}, false, "");
     externalDeviceCompatibilityMode_ = parseBool(engineParameter("ExternalDeviceCompatibilityMode", {}, false, "false"));
     includePastCashflows_ = parseBool(engineParameter("IncludePastCashflows", {resolvedProductTag_}, false, "false"));
+    useBytecode_ = parseBool(engineParameter("UseBytecode", {resolvedProductTag_}, false, "false"));
+    Integer pathChunks = parseInteger(engineParameter("PathChunks", {resolvedProductTag_}, false, "1"));
+    QL_REQUIRE(pathChunks >= 1, "PathChunks (" << pathChunks << ") must be positive");
+    pathChunks_ = pathChunks;
+    pathwiseSensitivities_ =
+        parseBool(engineParameter("PathwiseSensitivities", {resolvedProductTag_}, false, "false"));
+    keepPayLogPaths_ = parseBool(engineParameter("KeepPayLogPaths", {resolvedProductTag_}, false, "false"));
 
     // usage of ad or an external device implies usage of cg
     if (useAd_ || useExternalComputeDevice_)
@@ -521,6 +539,10 @@ void ScriptedTradeEngineBuilder::populateModelParameters() {
     mesherConcentration_ = 0.1;
     mesherMaxConcentratingPoints_ = 9999;
     mesherIsStatic_ = false;
+    cacheStepOperators_ = false;
+    localVolGridStrikes_ = 0;
+    localVolGridStdDevs_ = 5.0;
+    localVolGridCheck_ = false;
 
     // parameters only needed for certain model / engine pairs
 
@@ -536,6 +558,12 @@ void ScriptedTradeEngineBuilder::populateModelParameters() {
             parseListOfValues<Real>(engineParameter("CalibrationMoneyness", {resolvedProductTag_}), &parseReal);
     }
 
+    if (modelParam_ == "LocalVolDupire" || modelParam_ == "LocalVolAndreasenHuge") {
+        localVolGridStrikes_ = parseInteger(engineParameter("LocalVolGridStrikes", {resolvedProductTag_}, false, "0"));
+        localVolGridStdDevs_ = parseReal(engineParameter("LocalVolGridStdDevs", {resolvedProductTag_}, false, "5.0"));
+        localVolGridCheck_ = parseBool(engineParameter("LocalVolGridCheck", {resolvedProductTag_}, false, "false"));
+    }
+
     if (engineParam_ == "MC") {
         mcParams_.seed = parseInteger(engineParameter("Seed", {resolvedProductTag_}, false, "42"));
         modelSize_ = parseInteger(engineParameter("Samples", {resolvedProductTag_}));
@@ -559,6 +587,7 @@ void ScriptedTradeEngineBuilder::populateModelParameters() {
         mcParams_.regressionVarianceCutoff =
             parseRealOrNull(engineParameter("RegressionVarianceCutoff", {resolvedProductTag_}, false, std::string()));
         mcParams_.externalDeviceCompatibilityMode = externalDeviceCompatibilityMode_;
+        mcParams_.usePathCache = parseBool(engineParameter("UsePathCache", {resolvedProductTag_}, false, "false"));
     } else if (engineParam_ == "FD") {
         modelSize_ = parseInteger(engineParameter("StateGridPoints", {resolvedProductTag_}));
         mesherEpsilon_ = parseReal(engineParameter("MesherEpsilon", {resolvedProductTag_}, false, "1.0E-4"));
@@ -567,6 +596,8 @@ void ScriptedTradeEngineBuilder::populateModelParameters() {
         mesherMaxConcentratingPoints_ =
             parseInteger(engineParameter("MesherMaxConcentratingPoints", {resolvedProductTag_}, false, "9999"));
         mesherIsStatic_ = parseBool(engineParameter("MesherIsStatic", {resolvedProductTag_}, false, "false"));
+        cacheStepOperators_ =
+            parseBool(engineParameter("CacheStepOperators", {resolvedProductTag_}, false, "false"));
     }
 
     // global parameters that are relevant
@@ -1235,7 +1266,7 @@ void ScriptedTradeEngineBuilder::buildFdBlackScholes(const std::string& id,
         modelSize_, modelCcys_, modelCurves_, modelFxSpots_, modelIrIndices_, modelInfIndices_, modelIndices_,
         modelIndicesCurrencies_, payCcys_, builder->model(), correlations_, simulationDates_, iborFallbackConfig,
         calibration_, filteredStrikes, mesherEpsilon_, mesherScaling_, mesherConcentration_,
-        mesherMaxConcentratingPoints_, mesherIsStatic_);
+        mesherMaxConcentratingPoints_, mesherIsStatic_, cacheStepOperators_);
     modelBuilders_.insert(std::make_pair(id, builder));
 }
 
@@ -1250,7 +1281,8 @@ void ScriptedTradeEngineBuilder::buildLocalVol(const std::string& id, const Ibor
     }
     auto builder = QuantLib::ext::make_shared<LocalVolModelBuilder>(modelCurves_, processes_, simulationDates_, addDates_,
                                                             timeStepsPerYear_, lvType, calibrationMoneyness_,
-                                                            !calibrate_ || zeroVolatility_);
+                                                            !calibrate_ || zeroVolatility_, localVolGridStrikes_,
+                                                            localVolGridStdDevs_, localVolGridCheck_);
     model_ = QuantLib::ext::make_shared<LocalVol>(modelSize_, modelCcys_, modelCurves_, modelFxSpots_, modelIrIndices_,
                                           modelInfIndices_, modelIndices_, modelIndicesCurrencies_, builder->model(),
                                           correlations_, mcParams_, simulationDates_, iborFallbackConfig);
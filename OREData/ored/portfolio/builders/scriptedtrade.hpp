@@ -111,9 +111,6 @@ protected:
     const QuantLib::ext::shared_ptr<ore::data::ModelCG> amcCgModel_;
     const std::vector<Date> amcGrid_;
 
-    // cache for parsed asts
-    std::map<std::string, ASTNodePtr> astCache_;
-
     // populated by a call to engine()
     ASTNodePtr ast_;
     std::string npvCurrency_;
@@ -150,9 +147,13 @@ protected:
     Model::McParams mcParams_;
     bool interactive_, zeroVolatility_, continueOnCalibrationError_;
     std::vector<Real> calibrationMoneyness_;
+    Size localVolGridStrikes_;
+    Real localVolGridStdDevs_;
+    bool localVolGridCheck_;
     Real mesherEpsilon_, mesherScaling_, mesherConcentration_;
     Size mesherMaxConcentratingPoints_;
     bool mesherIsStatic_;
+    bool cacheStepOperators_;
     std::string referenceCalibrationGrid_;
     Real bootstrapTolerance_;
     bool calibrate_;
@@ -161,9 +162,14 @@ protected:
     bool useAd_;
     bool useExternalComputeDevice_;
     bool useDoublePrecisionForExternalCalculation_;
+    bool regressionOnExternalDevice_;
     bool externalDeviceCompatibilityMode_;
     std::string externalComputeDevice_;
     bool includePastCashflows_;
+    bool useBytecode_;
+    Size pathChunks_;
+    bool pathwiseSensitivities_;
+    bool keepPayLogPaths_;
 };
 
 } // namespace data
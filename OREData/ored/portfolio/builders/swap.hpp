@@ -30,6 +30,7 @@
 
 #include <qle/models/crossassetmodel.hpp>
 #include <qle/pricingengines/discountingcurrencyswapengine.hpp>
+#include <qle/pricingengines/discountingswapbatchengine.hpp>
 #include <qle/pricingengines/discountingswapenginemulticurve.hpp>
 #include <qle/pricingengines/mclgmswaptionengine.hpp>
 
@@ -101,6 +102,29 @@ protected:
     }
 };
 
+//! Engine Builder for Single Currency Swaps
+/*! This builder uses QuantExt::DiscountingSwapBatchEngine, the engine is shared by all swaps with the same currency,
+    discount curve and security spread and prices them in one batch
+    \ingroup builders
+*/
+class SwapEngineBuilderBatch : public SwapEngineBuilderBase {
+public:
+    SwapEngineBuilderBatch() : SwapEngineBuilderBase("DiscountedCashflows", "DiscountingSwapBatchEngine") {}
+
+protected:
+    virtual QuantLib::ext::shared_ptr<PricingEngine> engineImpl(const Currency& ccy, const std::string& discountCurve,
+                                                        const std::string& securitySpread) override {
+
+        Handle<YieldTermStructure> yts =
+            discountCurve.empty() ? market_->discountCurve(ccy.code(), configuration(MarketContext::pricing))
+                                  : indexOrYieldCurve(market_, discountCurve, configuration(MarketContext::pricing));
+        if (!securitySpread.empty())
+            yts = Handle<YieldTermStructure>(QuantLib::ext::make_shared<ZeroSpreadedTermStructure>(
+                yts, market_->securitySpread(securitySpread, configuration(MarketContext::pricing))));
+        return QuantLib::ext::make_shared<QuantExt::DiscountingSwapBatchEngine>(yts);
+    }
+};
+
 //! Engine Builder base class for Cross Currency Swaps
 /*! Pricing engines are cached by currencies (represented as a string list)
 
@@ -300,6 +300,7 @@ void CommodityAveragePriceOption::buildStandardOption(const QuantLib::ext::share
                                flow->index()->isFuturesIndex(), flow->pricingDate());
     commOption.build(engineFactory);
     setSensitivityTemplate(commOption.sensitivityTemplate());
+    pricingEngine_ = commOption.pricingEngine();
     instrument_ = commOption.instrument();
     maturity_ = commOption.maturity();
 }
@@ -48,8 +48,10 @@ void CompositeTrade::build(const QuantLib::ext::shared_ptr<EngineFactory>& engin
 	    trade->build(engineFactory);
 	    trade->validate();
 
-        if (sensitivityTemplate_.empty())
+        if (sensitivityTemplate_.empty()) {
             setSensitivityTemplate(trade->sensitivityTemplate());
+            pricingEngine_ = trade->pricingEngine();
+        }
 
         Handle<Quote> fx = Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(1.0));
 	    if (trade->npvCurrency() != npvCurrency_)
@@ -24,10 +24,18 @@
 #include <ored/portfolio/swap.hpp>
 #include <ored/portfolio/swaption.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/trace.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ql/errors.hpp>
 #include <ql/time/date.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
 using namespace QuantLib;
 using namespace std;
 
@@ -50,50 +58,196 @@ void Portfolio::reset() {
 void Portfolio::fromXML(XMLNode* node) {
     XMLUtils::checkNode(node, "Portfolio");
     vector<XMLNode*> nodes = XMLUtils::getChildrenNodes(node, "Trade");
-    for (Size i = 0; i < nodes.size(); i++) {
-        string tradeType = XMLUtils::getChildValue(nodes[i], "TradeType", true);
-
-        // Get the id attribute
-        string id = XMLUtils::getAttribute(nodes[i], "id");
-        QL_REQUIRE(id != "", "No id attribute in Trade Node");
-        DLOG("Parsing trade id:" << id);
-        
-        QuantLib::ext::shared_ptr<Trade> trade;
-        bool failedToLoad = true;
+    for (Size i = 0; i < nodes.size(); i++)
+        addTradeFromXML(nodes[i]);
+    LOG("Finished Parsing XML doc");
+}
+
+void Portfolio::addTradeFromXML(XMLNode* node) {
+    string tradeType = XMLUtils::getChildValue(node, "TradeType", true);
+
+    // Get the id attribute
+    string id = XMLUtils::getAttribute(node, "id");
+    QL_REQUIRE(id != "", "No id attribute in Trade Node");
+    DLOG("Parsing trade id:" << id);
+    
+    QuantLib::ext::shared_ptr<Trade> trade;
+    bool failedToLoad = true;
+    try {
+        trade = TradeFactory::instance().build(tradeType);
+        trade->fromXML(node);
+        trade->id() = id;
+        add(trade);
+        DLOG("Added Trade " << id << " (" << trade->id() << ")"
+                            << " type:" << tradeType);
+        failedToLoad = false;
+    } catch (std::exception& ex) {
+        StructuredTradeErrorMessage(id, tradeType, "Error parsing Trade XML", ex.what()).log();
+    }
+
+    // If trade loading failed, then insert a dummy trade with same id and envelope
+    if (failedToLoad && buildFailedTrades_) {
         try {
-            trade = TradeFactory::instance().build(tradeType);
-            trade->fromXML(nodes[i]);
-            trade->id() = id;
-            add(trade);
-            DLOG("Added Trade " << id << " (" << trade->id() << ")"
-                                << " type:" << tradeType);
-            failedToLoad = false;
+            trade = TradeFactory::instance().build("Failed");
+            // this loads only type, id and envelope, but type will be set to the original trade's type
+            trade->fromXML(node);
+            // create a dummy trade of type "Dummy"
+            QuantLib::ext::shared_ptr<FailedTrade> failedTrade = QuantLib::ext::make_shared<FailedTrade>();
+            // copy id and envelope
+            failedTrade->id() = id;
+            failedTrade->setUnderlyingTradeType(tradeType);
+            failedTrade->setEnvelope(trade->envelope());
+            // and add it to the portfolio
+            add(failedTrade);
+            WLOG("Added trade id " << failedTrade->id() << " type " << failedTrade->tradeType()
+                                   << " for original trade type " << trade->tradeType());
         } catch (std::exception& ex) {
-            StructuredTradeErrorMessage(id, tradeType, "Error parsing Trade XML", ex.what()).log();
+            StructuredTradeErrorMessage(id, tradeType, "Error parsing type and envelope", ex.what()).log();
+        }
+    }
+}
+
+namespace {
+/* Scans an xml document for the <Trade> elements which are children of the root <Portfolio> element. The input is
+   read in chunks, only the current (incomplete) trade element is kept in memory. Comments, CDATA sections,
+   processing instructions and declarations are skipped. */
+class TradeElementScanner {
+public:
+    TradeElementScanner(std::istream& in, const Size bufferSize)
+        : in_(in), bufferSize_(std::max<Size>(bufferSize, 1)) {}
+
+    // retrieve the next trade element, returns false if there are no more trade elements
+    bool next(std::string& element) {
+        Size start = std::string::npos, startDepth = 0;
+        while (true) {
+            Size lt = buffer_.find('<', pos_);
+            if (lt == std::string::npos) {
+                pos_ = buffer_.size();
+                if (!fill(start)) {
+                    QL_REQUIRE(start == std::string::npos, "unexpected end of input in Trade element");
+                    return false;
+                }
+                continue;
+            }
+            Size end = markupEnd(lt);
+            if (end == std::string::npos) {
+                pos_ = lt;
+                QL_REQUIRE(fill(start), "unexpected end of input in xml markup");
+                continue;
+            }
+            pos_ = end;
+            if (!isTag(lt))
+                continue;
+            bool closing = buffer_[lt + 1] == '/';
+            bool selfClosing = !closing && buffer_[end - 2] == '/';
+            std::string name = tagName(lt + (closing ? 2 : 1));
+            if (!closing) {
+                if (!rootFound_) {
+                    QL_REQUIRE(name == "Portfolio", "expected root node Portfolio, found " << name);
+                    rootFound_ = true;
+                }
+                if (start == std::string::npos && depth_ == 1 && name == "Trade") {
+                    start = lt;
+                    startDepth = depth_;
+                }
+                if (!selfClosing)
+                    ++depth_;
+            } else {
+                QL_REQUIRE(depth_ > 0, "unexpected closing tag " << name);
+                --depth_;
+            }
+            if (start != std::string::npos && depth_ == startDepth) {
+                element = buffer_.substr(start, end - start);
+                return true;
+            }
         }
+    }
 
-        // If trade loading failed, then insert a dummy trade with same id and envelope
-        if (failedToLoad && buildFailedTrades_) {
-            try {
-                trade = TradeFactory::instance().build("Failed");
-                // this loads only type, id and envelope, but type will be set to the original trade's type
-                trade->fromXML(nodes[i]);
-                // create a dummy trade of type "Dummy"
-                QuantLib::ext::shared_ptr<FailedTrade> failedTrade = QuantLib::ext::make_shared<FailedTrade>();
-                // copy id and envelope
-                failedTrade->id() = id;
-                failedTrade->setUnderlyingTradeType(tradeType);
-                failedTrade->setEnvelope(trade->envelope());
-                // and add it to the portfolio
-                add(failedTrade);
-                WLOG("Added trade id " << failedTrade->id() << " type " << failedTrade->tradeType()
-                                       << " for original trade type " << trade->tradeType());
-            } catch (std::exception& ex) {
-                StructuredTradeErrorMessage(id, tradeType, "Error parsing type and envelope", ex.what()).log();
+    bool rootFound() const { return rootFound_; }
+
+private:
+    // drop the processed part of the buffer (keeping an incomplete trade element) and read the next chunk
+    bool fill(Size& start) {
+        Size keep = std::min(start, pos_);
+        buffer_.erase(0, keep);
+        pos_ -= keep;
+        if (start != std::string::npos)
+            start -= keep;
+        chunk_.resize(bufferSize_);
+        in_.read(&chunk_[0], bufferSize_);
+        Size n = static_cast<Size>(in_.gcount());
+        buffer_.append(chunk_.data(), n);
+        return n > 0;
+    }
+
+    bool startsWith(const Size pos, const char* s) const { return buffer_.compare(pos, std::strlen(s), s) == 0; }
+
+    bool isTag(const Size lt) const { return !startsWith(lt, "<!") && !startsWith(lt, "<?"); }
+
+    // position after the markup starting at lt, or npos if the markup is not complete in the buffer yet
+    Size markupEnd(const Size lt) const {
+        auto after = [this](const Size p, const char* s) {
+            Size r = buffer_.find(s, p);
+            return r == std::string::npos ? r : r + std::strlen(s);
+        };
+        if (startsWith(lt, "<!--"))
+            return after(lt + 4, "-->");
+        if (startsWith(lt, "<![CDATA["))
+            return after(lt + 9, "]]>");
+        if (startsWith(lt, "<?"))
+            return after(lt + 2, "?>");
+        // a tag or declaration, skip quoted attribute values which might contain '>'
+        char quote = 0;
+        for (Size i = lt + 1; i < buffer_.size(); ++i) {
+            char c = buffer_[i];
+            if (quote != 0) {
+                if (c == quote)
+                    quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '>') {
+                return i + 1;
             }
         }
+        return std::string::npos;
     }
-    LOG("Finished Parsing XML doc");
+
+    std::string tagName(const Size p) const {
+        Size e = p;
+        while (e < buffer_.size() && !std::isspace(static_cast<unsigned char>(buffer_[e])) && buffer_[e] != '/' &&
+               buffer_[e] != '>')
+            ++e;
+        return buffer_.substr(p, e - p);
+    }
+
+    std::istream& in_;
+    Size bufferSize_;
+    std::string buffer_, chunk_;
+    Size pos_ = 0, depth_ = 0;
+    bool rootFound_ = false;
+};
+} // namespace
+
+void Portfolio::fromFileStreamed(const std::string& fileName, const Size bufferSize) {
+    LOG("Loading portfolio from file " << fileName << " trade by trade");
+    std::ifstream in(fileName, std::ios::binary);
+    QL_REQUIRE(in.is_open(), "Portfolio::fromFileStreamed(): could not open file " << fileName);
+    TradeElementScanner scanner(in, bufferSize);
+    std::string element;
+    Size n = 0;
+    try {
+        while (scanner.next(element)) {
+            XMLDocument doc;
+            doc.fromXMLString(element);
+            addTradeFromXML(doc.getFirstNode("Trade"));
+            ++n;
+        }
+    } catch (const std::exception& e) {
+        QL_FAIL("Portfolio::fromFileStreamed(): error reading " << fileName << " after " << n
+                                                                << " trades: " << e.what());
+    }
+    QL_REQUIRE(scanner.rootFound(), "Portfolio::fromFileStreamed(): no Portfolio node found in " << fileName);
+    LOG("Finished loading " << n << " trades from " << fileName);
 }
 
 XMLNode* Portfolio::toXML(XMLDocument& doc) const {
@@ -121,13 +275,20 @@ void Portfolio::removeMatured(const Date& asof) {
 
 void Portfolio::build(const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory, const std::string& context,
                       const bool emitStructuredError) {
+    ORE_TRACE_SCOPE("Portfolio::build " + context);
     LOG("Building Portfolio of size " << trades_.size() << " for context = '" << context << "'");
     auto trade = trades_.begin();
     Size initialSize = trades_.size();
     Size failedTrades = 0;
+    // number of trades and total build time in seconds by trade type
+    std::map<std::string, std::pair<Size, double>> buildTimes;
     while (trade != trades_.end()) {
+        auto start = std::chrono::steady_clock::now();
+        auto& [buildCount, buildTime] = buildTimes[(*trade).second->tradeType()];
         auto [ft, success] = buildTrade((*trade).second, engineFactory, context, ignoreTradeBuildFail(),
                                         buildFailedTrades(), emitStructuredError);
+        ++buildCount;
+        buildTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
         if (success) {
             ++trade;
         } else if (ft) {
@@ -141,9 +302,48 @@ void Portfolio::build(const QuantLib::ext::shared_ptr<EngineFactory>& engineFact
     LOG("Built Portfolio. Initial size = " << initialSize << ", size now " << trades_.size() << ", built "
                                            << failedTrades << " failed trades, context is " + context);
 
+    std::vector<std::pair<std::string, std::pair<Size, double>>> sortedBuildTimes(buildTimes.begin(),
+                                                                                  buildTimes.end());
+    std::sort(sortedBuildTimes.begin(), sortedBuildTimes.end(),
+              [](const auto& a, const auto& b) { return a.second.second > b.second.second; });
+    for (Size i = 0; i < std::min<Size>(10, sortedBuildTimes.size()); ++i) {
+        auto const& [tradeType, stats] = sortedBuildTimes[i];
+        LOG("Build time for trade type " << tradeType << ": " << std::fixed << std::setprecision(3) << stats.second
+                                         << " sec for " << stats.first << " trades");
+    }
+
     QL_REQUIRE(trades_.size() > 0, "Portfolio does not contain any built trades, context is '" + context + "'");
 }
 
+void Portfolio::buildTrades(const std::set<std::string>& tradeIds,
+                            const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory, const std::string& context,
+                            const bool emitStructuredError) {
+    ORE_TRACE_SCOPE("Portfolio::buildTrades " + context);
+    LOG("Building " << tradeIds.size() << " trades of portfolio of size " << trades_.size() << " for context = '"
+                    << context << "'");
+    Size builtTrades = 0, failedTrades = 0, removedTrades = 0;
+    for (auto const& id : tradeIds) {
+        auto trade = trades_.find(id);
+        if (trade == trades_.end()) {
+            DLOG("Trade " << id << " is not in the portfolio, skip build");
+            continue;
+        }
+        auto [ft, success] = buildTrade((*trade).second, engineFactory, context, ignoreTradeBuildFail(),
+                                        buildFailedTrades(), emitStructuredError);
+        if (success) {
+            ++builtTrades;
+        } else if (ft) {
+            (*trade).second = ft;
+            ++failedTrades;
+        } else {
+            trades_.erase(trade);
+            ++removedTrades;
+        }
+    }
+    LOG("Built " << builtTrades << " trades, built " << failedTrades << " failed trades, removed " << removedTrades
+                 << " trades, portfolio size now " << trades_.size() << ", context is " + context);
+}
+
 Date Portfolio::maturity() const {
     QL_REQUIRE(trades_.size() > 0, "Cannot get maturity of an empty portfolio");
     Date mat = Date::minDate();
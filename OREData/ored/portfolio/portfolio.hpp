@@ -73,16 +73,32 @@ public:
     void fromXML(XMLNode* node) override;
     XMLNode* toXML(XMLDocument& doc) const override;
 
+    /*! Load the trades from a portfolio xml file without holding the whole document in memory. The file is read in
+        chunks of \p bufferSize bytes and each Trade node is parsed and loaded on its own, with the same handling of
+        trades that fail to load as in fromXML(). The memory required is bounded by the chunk size plus the size of
+        the largest trade node, as opposed to several times the file size for fromFile(). */
+    void fromFileStreamed(const std::string& fileName, const QuantLib::Size bufferSize = 1048576);
+
     //! Remove specified trade from the portfolio
     bool remove(const std::string& tradeID);
 
     //! Remove matured trades from portfolio for a given date, each removal is logged with an Alert
     void removeMatured(const QuantLib::Date& asof);
 
-    //! Call build on all trades in the portfolio, the context is included in error messages
+    /*! Call build on all trades in the portfolio, the context is included in error messages. The trades are built
+        sequentially: building registers the instruments with the market's term structures and quotes, and reads
+        the engine builder caches and the Settings / IndexManager singletons, none of which are safe for concurrent
+        use against the same market. Parallel builds are done on separate markets, as in the multi-threaded
+        valuation engine. The build time by trade type is logged to identify expensive builders. */
     void build(const QuantLib::ext::shared_ptr<EngineFactory>&, const std::string& context = "unspecified",
                const bool emitStructuredError = true);
 
+    /*! Call build on the trades with the given ids only, e.g. after an amendment of these trades, which were replaced
+        using remove() and add(). The failed trades are handled as in build(), ids not in the portfolio are ignored.
+        Unlike build(), the portfolio may be empty afterwards. */
+    void buildTrades(const std::set<std::string>& tradeIds, const QuantLib::ext::shared_ptr<EngineFactory>&,
+                     const std::string& context = "unspecified", const bool emitStructuredError = true);
+
     //! Calculates the maturity of the portfolio
     QuantLib::Date maturity() const;
 
@@ -129,6 +145,9 @@ public:
                       const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceDataManager = nullptr);
 
 private:
+    // load a single trade node and add it to the portfolio
+    void addTradeFromXML(XMLNode* node);
+
     bool buildFailedTrades_, ignoreTradeBuildFail_;
     std::map<std::string, QuantLib::ext::shared_ptr<Trade>> trades_;
     std::map<AssetClass, std::set<std::string>> underlyingIndicesCache_;
@@ -17,6 +17,7 @@
 */
 
 #include <ored/portfolio/schedule.hpp>
+#include <ored/utilities/calendarparser.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/to_string.hpp>
@@ -333,7 +334,76 @@ Schedule makeSchedule(const ScheduleDerived& data, const Schedule& baseSchedule)
                               endOfMonthConvention);
 }
 
+namespace {
+// canonical key of the schedule rules, covering all fields read by makeScheduleUncached()
+std::string scheduleCacheKey(const ScheduleRules& data, const Date& openEndDateReplacement) {
+    std::string key;
+    for (const string* s : {&data.startDate(), &data.endDate(), &data.tenor(), &data.calendar(), &data.convention(),
+                            &data.termConvention(), &data.rule(), &data.endOfMonth(), &data.endOfMonthConvention(),
+                            &data.firstDate(), &data.lastDate()}) {
+        key.append(*s);
+        key.push_back('|');
+    }
+    key.push_back(data.removeFirstDate() ? '1' : '0');
+    key.push_back(data.removeLastDate() ? '1' : '0');
+    key.push_back('|');
+    if (data.endDate().empty())
+        key.append(std::to_string(openEndDateReplacement.serialNumber()));
+    return key;
+}
+} // namespace
+
+Schedule ScheduleCache::schedule(const ScheduleRules& rules, const Date& openEndDateReplacement) {
+    if (!enabled_)
+        return makeScheduleUncached(rules, openEndDateReplacement);
+    std::string key = scheduleCacheKey(rules, openEndDateReplacement);
+    std::size_t generation = CalendarParser::instance().calendarGeneration();
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        if (generation == calendarGeneration_) {
+            auto s = schedules_.find(key);
+            if (s != schedules_.end()) {
+                ++hits_;
+                return s->second;
+            }
+        }
+    }
+    ++misses_;
+    Schedule schedule = makeScheduleUncached(rules, openEndDateReplacement);
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    if (generation != calendarGeneration_ || schedules_.size() >= maxSize_) {
+        schedules_.clear();
+        calendarGeneration_ = generation;
+    }
+    schedules_.emplace(std::move(key), schedule);
+    return schedule;
+}
+
+void ScheduleCache::setEnabled(const bool enabled) {
+    enabled_ = enabled;
+    if (!enabled)
+        clear();
+}
+
+void ScheduleCache::clear() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    schedules_.clear();
+}
+
+std::size_t ScheduleCache::size() const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
+    return schedules_.size();
+}
+
+std::pair<std::size_t, std::size_t> ScheduleCache::statistics() const {
+    return std::make_pair(hits_.load(), misses_.load());
+}
+
 Schedule makeSchedule(const ScheduleRules& data, const Date& openEndDateReplacement) {
+    return ScheduleCache::instance().schedule(data, openEndDateReplacement);
+}
+
+Schedule makeScheduleUncached(const ScheduleRules& data, const Date& openEndDateReplacement) {
     QL_REQUIRE(!data.endDate().empty() || openEndDateReplacement != Null<Date>(),
                "makeSchedule(): Schedule does not have an end date, this is not supported in this context / for this "
                "trade type. Please provide an end date.");
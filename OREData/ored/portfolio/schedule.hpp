@@ -24,7 +24,14 @@
 #pragma once
 
 #include <ored/utilities/xmlutils.hpp>
+#include <ql/patterns/singleton.hpp>
 #include <ql/time/schedule.hpp>
+
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
+#include <unordered_map>
 // #include <ored/utilities/parsers.hpp>
 
 namespace ore {
@@ -274,13 +281,53 @@ private:
     map<string, pair<ScheduleData, QuantLib::Schedule&>> schedules_;
 };
 
+//! Cache of schedules built from rules
+/*! Trades in a portfolio often share identical schedule rules, the schedules built from them by makeSchedule() are
+    stored here by a canonical key of the rules and the open end date replacement, so that they are generated once
+    and then copied. The cache is dropped automatically when the calendars in the CalendarParser change.
+
+    \ingroup tradedata
+*/
+class ScheduleCache : public QuantLib::Singleton<ScheduleCache, std::integral_constant<bool, true>> {
+public:
+    //! Return the cached schedule for the given rules or build and cache it using makeSchedule()
+    QuantLib::Schedule schedule(const ScheduleRules& rules, const QuantLib::Date& openEndDateReplacement);
+    //! Enable or disable the cache, disabling it clears the cache
+    void setEnabled(const bool enabled);
+    bool enabled() const { return enabled_; }
+    //! Remove all cached schedules
+    void clear();
+    //! Number of cached schedules
+    std::size_t size() const;
+    //! hits and misses of the cache
+    std::pair<std::size_t, std::size_t> statistics() const;
+
+private:
+    friend class QuantLib::Singleton<ScheduleCache, std::integral_constant<bool, true>>;
+    ScheduleCache() = default;
+
+    // maximum number of cached schedules, the cache is cleared when this is exceeded
+    static constexpr std::size_t maxSize_ = 100000;
+
+    mutable boost::shared_mutex mutex_;
+    std::unordered_map<std::string, QuantLib::Schedule> schedules_;
+    std::atomic<bool> enabled_{true};
+    std::atomic<std::size_t> hits_{0}, misses_{0};
+    std::size_t calendarGeneration_ = 0;
+};
+
 //! Functions
 QuantLib::Schedule makeSchedule(const ScheduleData& data,
                                 const QuantLib::Date& openEndDateReplacement = QuantLib::Null<QuantLib::Date>(),
                                 const map<string, QuantLib::Schedule>& baseSchedules = map<string, QuantLib::Schedule>());
 QuantLib::Schedule makeSchedule(const ScheduleDates& dates);
+/*! Build a schedule from rules, identical rules share the generated dates via the ScheduleCache, if enabled */
 QuantLib::Schedule makeSchedule(const ScheduleRules& rules,
                                 const QuantLib::Date& openEndDateReplacement = QuantLib::Null<QuantLib::Date>());
+//! Build a schedule from rules, bypassing the ScheduleCache
+QuantLib::Schedule
+makeScheduleUncached(const ScheduleRules& rules,
+                     const QuantLib::Date& openEndDateReplacement = QuantLib::Null<QuantLib::Date>());
 QuantLib::Schedule makeSchedule(const ScheduleDerived& derived, const QuantLib::Schedule& baseSchedule);
 
 } // namespace data
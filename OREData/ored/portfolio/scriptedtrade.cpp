@@ -92,6 +92,7 @@ void ScriptedTrade::build(const QuantLib::ext::shared_ptr<EngineFactory>& engine
 
     // set sensitivity template
     setSensitivityTemplate(builder->sensitivityTemplate());
+    pricingEngine_ = builder->model() + "/" + builder->engine();
 }
 
 void ScriptedTrade::build(const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory) {
@@ -553,6 +554,13 @@ void ScriptedTradeScriptData::fromXML(XMLNode* node) {
     if (XMLNode* ns = XMLUtils::getChildNode(node, "ConditionalExpectation")) {
         conditionalExpectationModelStates_ = XMLUtils::getChildrenValues(ns, "ModelStates", "ModelState", false);
     }
+    std::vector<std::string> prices;
+    std::vector<std::string> payoffs =
+        XMLUtils::getChildrenValuesWithAttributes(node, "ControlVariates", "ControlVariate", "price", prices);
+    for (Size i = 0; i < payoffs.size(); ++i) {
+        QL_REQUIRE(!prices[i].empty(), "ControlVariate '" << payoffs[i] << "' requires a price attribute");
+        controlVariates_.push_back(std::make_pair(payoffs[i], prices[i]));
+    }
 }
 
 XMLNode* ScriptedTradeScriptData::toXML(XMLDocument& doc) const {
@@ -580,6 +588,14 @@ XMLNode* ScriptedTradeScriptData::toXML(XMLDocument& doc) const {
     XMLNode* condExp = doc.allocNode("ConditionalExpectation");
     XMLUtils::appendNode(n, condExp);
     XMLUtils::addChildren(doc, condExp, "ModelStates", "ModelState", conditionalExpectationModelStates_);
+    if (!controlVariates_.empty()) {
+        std::vector<std::string> payoffs, prices;
+        for (auto const& c : controlVariates_) {
+            payoffs.push_back(c.first);
+            prices.push_back(c.second);
+        }
+        XMLUtils::addChildrenWithAttributes(doc, n, "ControlVariates", "ControlVariate", payoffs, "price", prices);
+    }
     return n;
 }
 
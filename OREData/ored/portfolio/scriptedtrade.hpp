@@ -143,10 +143,11 @@ public:
                             const std::vector<NewScheduleData>& newSchedules = {},
                             const std::vector<CalibrationData>& calibrationSpec = {},
                             const std::vector<std::string>& stickyCloseOutStates = {},
-                            const std::vector<std::string>& conditionalExpectationModelStates = {})
+                            const std::vector<std::string>& conditionalExpectationModelStates = {},
+                            const std::vector<std::pair<std::string, std::string>>& controlVariates = {})
         : code_(code), npv_(npv), results_(results), schedulesEligibleForCoarsening_(schedulesEligibleForCoarsening),
           newSchedules_(newSchedules), calibrationSpec_(calibrationSpec), stickyCloseOutStates_(stickyCloseOutStates),
-          conditionalExpectationModelStates_(conditionalExpectationModelStates) {
+          conditionalExpectationModelStates_(conditionalExpectationModelStates), controlVariates_(controlVariates) {
         formatCode();
     }
 
@@ -164,6 +165,8 @@ public:
     const std::vector<std::string>& conditionalExpectationModelStates() const {
         return conditionalExpectationModelStates_;
     }
+    // a control variate is given by a payoff and a price variable, e.g. ("ForwardPayoff", "ForwardPrice")
+    const std::vector<std::pair<std::string, std::string>>& controlVariates() const { return controlVariates_; }
 
 private:
     void formatCode();
@@ -175,6 +178,7 @@ private:
     std::vector<CalibrationData> calibrationSpec_;
     std::vector<std::string> stickyCloseOutStates_;
     std::vector<std::string> conditionalExpectationModelStates_;
+    std::vector<std::pair<std::string, std::string>> controlVariates_;
 };
 
 class ScriptLibraryData : public XMLSerializable {
@@ -168,6 +168,10 @@ public:
     /*! returns the sensi template, e.g. "IR_Analytical" for this trade,
         this is only available after build() has been called */
     const std::string& sensitivityTemplate() const;
+
+    /*! returns the model and engine of the engine builder used for this trade, e.g.
+        "DiscountedCashflows/DiscountingSwapEngine", this is empty if the trade builder did not set it */
+    const std::string& pricingEngine() const { return pricingEngine_; }
     //@}
 
     //! \name Utility
@@ -205,6 +209,7 @@ protected:
     string issuer_;
     string sensitivityTemplate_;
     bool sensitivityTemplateSet_ = false;
+    string pricingEngine_;
 
     std::size_t savedNumberOfPricings_ = 0;
     boost::timer::nanosecond_type savedCumulativePricingTime_ = 0;
@@ -228,7 +233,7 @@ protected:
        parameter resultLegId. */
     void setLegBasedAdditionalData(const Size legNo, Size resultLegId = Null<Size>()) const;
 
-    /* sets the sensitivity template for this trade */
+    /* sets the sensitivity template for this trade, the first variant also sets the pricing engine */
     void setSensitivityTemplate(const EngineBuilder& builder);
     void setSensitivityTemplate(const std::string& id);
 
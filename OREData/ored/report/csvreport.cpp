@@ -21,6 +21,8 @@
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
 
+#include <qle/math/chunkworkers.hpp>
+
 #include <ql/errors.hpp>
 #include <ql/math/comparison.hpp>
 #include <ql/math/rounding.hpp>
@@ -30,67 +32,106 @@
 #include <boost/variant/static_visitor.hpp>
 #include <boost/algorithm/string/join.hpp>
 
+#include <algorithm>
+#include <cstdio>
+
 using std::string;
 
 namespace ore {
 namespace data {
 
-// Local class for printing each report type via fprintf
-class ReportTypePrinter : public boost::static_visitor<> {
+// Local class for formatting each report type into a string
+class ReportTypeFormatter {
 public:
-    ReportTypePrinter(FILE* fp, int prec, char quoteChar = '\0', const string& nullString = "#N/A")
-        : fp_(fp), rounding_(prec, QuantLib::Rounding::Closest), quoteChar_(quoteChar), null_(nullString) {}
+    ReportTypeFormatter(int prec, char quoteChar = '\0', const string& nullString = "#N/A")
+        : rounding_(prec, QuantLib::Rounding::Closest), quoteChar_(quoteChar), null_(nullString) {}
 
-    void operator()(const Size i) const {
+    void format(const Size i, string& out) const {
         if (i == QuantLib::Null<Size>()) {
-            fprintNull();
+            out.append(null_);
         } else {
-            fprintf(fp_, "%zu", i);
+            char buf[32];
+            int n = std::snprintf(buf, sizeof(buf), "%zu", i);
+            out.append(buf, n);
         }
     }
-    void operator()(const Real d) const {
+    void format(const Real d, string& out) const {
         if (d == QuantLib::Null<Real>() || !std::isfinite(d)) {
-            fprintNull();
+            out.append(null_);
         } else {
             Real r = rounding_(d);
-            fprintf(fp_, "%.*f", rounding_.precision(), QuantLib::close_enough(r, 0.0) ? 0.0 : r);
+            r = QuantLib::close_enough(r, 0.0) ? 0.0 : r;
+            char buf[64];
+            int n = std::snprintf(buf, sizeof(buf), "%.*f", rounding_.precision(), r);
+            if (n < static_cast<int>(sizeof(buf))) {
+                out.append(buf, n);
+            } else {
+                Size size = out.size();
+                out.resize(size + n + 1);
+                std::snprintf(&out[size], n + 1, "%.*f", rounding_.precision(), r);
+                out.resize(size + n);
+            }
         }
     }
-    void operator()(const string& s) const { fprintString(s); }
-    void operator()(const Date& d) const {
+    void format(const string& s, string& out) const { formatString(s, out); }
+    void format(const Date& d, string& out) const {
         if (d == QuantLib::Null<Date>()) {
-            fprintNull();
+            out.append(null_);
         } else {
-            string s = to_string(d);
-            fprintString(s);
+            formatString(to_string(d), out);
         }
     }
-    void operator()(const Period& p) const {
-        string s = to_string(p);
-        fprintString(s);
-    }
+    void format(const Period& p, string& out) const { formatString(to_string(p), out); }
 
-    void updateFile(FILE* fp) { fp_ = fp; }
+    void format(const Report::ReportType& rt, string& out) const { boost::apply_visitor(Visitor(*this, out), rt); }
 
 private:
-    void fprintNull() const { fprintf(fp_, "%s", null_.c_str()); }
+    class Visitor : public boost::static_visitor<> {
+    public:
+        Visitor(const ReportTypeFormatter& formatter, string& out) : formatter_(formatter), out_(out) {}
+        template <class T> void operator()(const T& v) const { formatter_.format(v, out_); }
+
+    private:
+        const ReportTypeFormatter& formatter_;
+        string& out_;
+    };
 
     // Shared implementation to include the quote character.
-    void fprintString(const string& s) const {
+    void formatString(const string& s, string& out) const {
         bool quoted = s.size() > 1 && s[0] == quoteChar_ && s[s.size() - 1] == quoteChar_;
         if (!quoted && quoteChar_ != '\0')
-            fputc(quoteChar_, fp_);
-        fprintf(fp_, "%s", s.c_str());
+            out.push_back(quoteChar_);
+        out.append(s.c_str());
         if (!quoted && quoteChar_ != '\0')
-            fputc(quoteChar_, fp_);
+            out.push_back(quoteChar_);
     }
 
-    FILE* fp_;
     QuantLib::Rounding rounding_;
     char quoteChar_;
     string null_;
 };
 
+// Local class for printing each report type to a file
+class ReportTypePrinter : public boost::static_visitor<> {
+public:
+    ReportTypePrinter(FILE* fp, int prec, char quoteChar = '\0', const string& nullString = "#N/A")
+        : fp_(fp), formatter_(prec, quoteChar, nullString) {}
+
+    template <class T> void operator()(const T& v) const {
+        buffer_.clear();
+        formatter_.format(v, buffer_);
+        fwrite(buffer_.data(), 1, buffer_.size(), fp_);
+    }
+
+    void updateFile(FILE* fp) { fp_ = fp; }
+    const ReportTypeFormatter& formatter() const { return formatter_; }
+
+private:
+    FILE* fp_;
+    ReportTypeFormatter formatter_;
+    mutable string buffer_;
+};
+
 CSVFileReport::CSVFileReport(const string& filename, const char sep, const bool commentCharacter, char quoteChar,
                              const string& nullString, bool lowerHeader, QuantLib::Size rolloverSize)
     : filename_(filename), sep_(sep), commentCharacter_(commentCharacter), quoteChar_(quoteChar),
@@ -188,6 +229,67 @@ Report& CSVFileReport::add(const ReportType& rt) {
     return *this;
 }
 
+void CSVFileReport::addRows(const std::vector<std::vector<ReportType>>& data, const Size nThreads) {
+    checkIsOpen("addRows()");
+    QL_REQUIRE(data.size() == columnTypes_.size(), "Cannot add rows with " << data.size() << " columns, expected "
+                                                                           << columnTypes_.size()
+                                                                           << ", report headers are: "
+                                                                           << boost::join(headers_, ","));
+    if (data.empty() || data.front().empty())
+        return;
+    Size rows = data.front().size();
+    for (Size j = 0; j < data.size(); ++j) {
+        QL_REQUIRE(data[j].size() == rows, "Cannot add rows, column " << j << " has " << data[j].size()
+                                                                       << " rows, expected " << rows
+                                                                       << ", report headers are: "
+                                                                       << boost::join(headers_, ","));
+    }
+
+    // the rollover is checked row by row
+    if (rolloverSize_ != QuantLib::Null<Size>()) {
+        for (Size r = 0; r < rows; ++r) {
+            next();
+            for (Size j = 0; j < data.size(); ++j)
+                add(data[j][r]);
+        }
+        return;
+    }
+
+    QL_REQUIRE(i_ == columnTypes_.size(), "Cannot go to next line, only "
+                                              << i_
+                                              << " entries filled, report headers are: " << boost::join(headers_, ","));
+
+    // the rows are formatted in chunks, which are processed in batches of several chunks in parallel and then
+    // written to the file in order
+    constexpr Size chunkSize = 10000;
+    QuantExt::ChunkWorkers workers(nThreads);
+    Size nChunks = (rows + chunkSize - 1) / chunkSize;
+    Size batchSize = 4 * workers.nThreads();
+    std::vector<string> text(std::min(nChunks, batchSize));
+    for (Size b = 0; b < nChunks; b += batchSize) {
+        Size n = std::min(batchSize, nChunks - b);
+        workers.run(n, [this, &data, &text, b, rows](const Size c) {
+            string& out = text[c];
+            out.clear();
+            for (Size r = (b + c) * chunkSize; r < std::min((b + c + 1) * chunkSize, rows); ++r) {
+                out.push_back('\n');
+                for (Size j = 0; j < data.size(); ++j) {
+                    const ReportType& rt = data[j][r];
+                    QL_REQUIRE(rt.which() == columnTypes_[j].which(),
+                               "Cannot add value " << rt << " of type " << rt.which() << " to column " << j
+                                                   << " of type " << columnTypes_[j].which()
+                                                   << ", report headers are: " << boost::join(headers_, ","));
+                    if (j != 0)
+                        out.push_back(sep_);
+                    printers_[j].formatter().format(rt, out);
+                }
+            }
+        });
+        for (Size c = 0; c < n; ++c)
+            fwrite(text[c].data(), 1, text[c].size(), fp_);
+    }
+}
+
 void CSVFileReport::end() {
     checkIsOpen("end()");
 
@@ -60,6 +60,11 @@ public:
     void end() override;
     void flush() override;
 
+    /*! Add the rows given by the columns \p data, this is equivalent to calling next() and add() for each row. The
+        rows are formatted in \p nThreads threads and written to the file in order. If a rollover size is set, the
+        rows are added one by one. */
+    void addRows(const std::vector<std::vector<ReportType>>& data, const QuantLib::Size nThreads = 1);
+
 private:
     void checkIsOpen(const std::string& op) const;
 
@@ -56,6 +56,7 @@ Report& InMemoryReport::next() {
         os.close();
         files_.push_back(s);
     }
+    accountMemory();
     return *this;
 }
 
@@ -102,6 +103,15 @@ void InMemoryReport::end() {
     QL_REQUIRE(i_ == headers_.size() || i_ == 0, "report is finalized with incomplete row, got data for "
                                                      << i_ << " columns out of " << columns()
                                                      << ", report headers are: " << boost::join(headers_, ","));
+    accountMemory();
+}
+
+void InMemoryReport::accountMemory() {
+    // the capacity grows geometrically, so that the accounting is updated rarely
+    Size n = 0;
+    for (auto const& d : data_)
+        n += d.capacity();
+    memory_.resize(n * sizeof(ReportType));
 }
 
 const vector<Report::ReportType>& InMemoryReport::data(Size i) const {
@@ -115,7 +125,7 @@ const vector<Report::ReportType>& InMemoryReport::data(Size i) const {
 }
 
 void InMemoryReport::toFile(const string& filename, const char sep, const bool commentCharacter, char quoteChar,
-                            const string& nullString, bool lowerHeader) {
+                            const string& nullString, bool lowerHeader, const Size nThreads) {
 
     CSVFileReport cReport(filename, sep, commentCharacter, quoteChar, nullString, lowerHeader);
 
@@ -135,22 +145,10 @@ void InMemoryReport::toFile(const string& filename, const char sep, const bool c
             }
             is.close();
 
-            for (Size i = 0; i < data[0].size(); i++) {
-                cReport.next();
-                for (Size j = 0; j < numColumns; j++) {
-                    cReport.add(data[j][i]);
-                }
-            }
+            cReport.addRows(data, nThreads);
         }
 
-        auto numRows = data_[0].size();
-
-        for (Size i = 0; i < numRows; i++) {
-            cReport.next();
-            for (Size j = 0; j < numColumns; j++) {
-                cReport.add(data_[j][i]);
-            }
-        }
+        cReport.addRows(data_, nThreads);
     }
 
     cReport.end();
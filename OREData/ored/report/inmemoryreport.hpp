@@ -27,6 +27,7 @@
 #include <ored/report/report.hpp>
 #include <ql/errors.hpp>
 #include <ql/tuple.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
 #include <vector>
 
 namespace ore {
@@ -36,6 +37,9 @@ using std::vector;
 
 /*! InMemoryReport just stores report information in local vectors and provides an interface to access
  *  the values. It could be used as a backend to a GUI
+ *
+ *  The memory held by the column vectors is accounted to MemoryAccounting::Category::Report, strings are counted
+ *  with the size of the variant only.
  \ingroup report
  */
 class InMemoryReport : public Report {
@@ -57,11 +61,14 @@ public:
     Size columnPrecision(Size i) const { return columnPrecision_[i]; }
     //! Returns the data
     const vector<ReportType>& data(Size i) const;
+    /*! Write the report to a csv file, the rows are formatted in \p nThreads threads, see CSVFileReport::addRows() */
     void toFile(const string& filename, const char sep = ',', const bool commentCharacter = true, char quoteChar = '\0',
-                const string& nullString = "#N/A", bool lowerHeader = false);
+                const string& nullString = "#N/A", bool lowerHeader = false, const Size nThreads = 1);
     void jumpToColumn(Size i) { i_ = i; }
 
 private:
+    void accountMemory();
+
     Size i_;
     Size bufferSize_;
     vector<string> headers_;
@@ -69,6 +76,7 @@ private:
     vector<Size> columnPrecision_;
     vector<vector<ReportType>> data_;
     vector<string> files_;
+    QuantExt::AccountedMemory memory_{QuantExt::MemoryAccounting::Category::Report};
 };
 
 //! InMemoryReport with access to plain types instead of boost::variant<>, to facilitate language bindings
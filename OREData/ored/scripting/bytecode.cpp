@@ -0,0 +1,411 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/scripting/bytecode.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+
+namespace ore {
+namespace data {
+
+namespace {
+
+using OpCode = ScriptBytecode::OpCode;
+using Operand = ScriptBytecode::Operand;
+
+const std::vector<std::string> opCodeLabels = {"Plus",
+                                                "Minus",
+                                                "Multiply",
+                                                "Divide",
+                                                "Min",
+                                                "Max",
+                                                "Pow",
+                                                "Eq",
+                                                "Neq",
+                                                "Lt",
+                                                "Leq",
+                                                "Gt",
+                                                "Geq",
+                                                "Negate",
+                                                "Abs",
+                                                "Exp",
+                                                "Log",
+                                                "Sqrt",
+                                                "NormalCdf",
+                                                "NormalPdf",
+                                                "Not",
+                                                "Move",
+                                                "LoadElement",
+                                                "AndShortCut",
+                                                "OrShortCut",
+                                                "And",
+                                                "Or",
+                                                "AssignPrepare",
+                                                "Assign",
+                                                "Require",
+                                                "PushFilter",
+                                                "PushFilterNegated",
+                                                "PopFilter",
+                                                "LoopCheck",
+                                                "LoopInit",
+                                                "LoopNext",
+                                                "DelegateExpression",
+                                                "DelegateStatement"};
+
+class ScriptCompiler : public AcyclicVisitor,
+                       public Visitor<ASTNode>,
+                       public Visitor<OperatorPlusNode>,
+                       public Visitor<OperatorMinusNode>,
+                       public Visitor<OperatorMultiplyNode>,
+                       public Visitor<OperatorDivideNode>,
+                       public Visitor<NegateNode>,
+                       public Visitor<FunctionAbsNode>,
+                       public Visitor<FunctionExpNode>,
+                       public Visitor<FunctionLogNode>,
+                       public Visitor<FunctionSqrtNode>,
+                       public Visitor<FunctionNormalCdfNode>,
+                       public Visitor<FunctionNormalPdfNode>,
+                       public Visitor<FunctionMinNode>,
+                       public Visitor<FunctionMaxNode>,
+                       public Visitor<FunctionPowNode>,
+                       public Visitor<ConstantNumberNode>,
+                       public Visitor<VariableNode>,
+                       public Visitor<AssignmentNode>,
+                       public Visitor<RequireNode>,
+                       public Visitor<SequenceNode>,
+                       public Visitor<ConditionEqNode>,
+                       public Visitor<ConditionNeqNode>,
+                       public Visitor<ConditionLtNode>,
+                       public Visitor<ConditionLeqNode>,
+                       public Visitor<ConditionGtNode>,
+                       public Visitor<ConditionGeqNode>,
+                       public Visitor<ConditionNotNode>,
+                       public Visitor<ConditionAndNode>,
+                       public Visitor<ConditionOrNode>,
+                       public Visitor<IfThenElseNode>,
+                       public Visitor<LoopNode> {
+public:
+    explicit ScriptCompiler(ScriptBytecode& code) : code_(code) {}
+
+    // compile an expression, the result is in register target or a constant / variable operand
+
+    Operand expression(ASTNode& n, const Size target) {
+        bool expression = expression_;
+        Size t = target_;
+        expression_ = true;
+        target_ = target;
+        useRegister(target);
+        n.accept(*this);
+        expression_ = expression;
+        target_ = t;
+        return result_;
+    }
+
+    // compile an expression into register target
+
+    void expressionToRegister(ASTNode& n, const Size target) {
+        Operand o = expression(n, target);
+        if (o.kind != Operand::Kind::Register || o.index != target)
+            emit(OpCode::Move, n, target, o);
+    }
+
+    // compile a statement, the registers starting at firstFree can be used
+
+    void statement(ASTNode& n, const Size firstFree) {
+        bool expression = expression_;
+        Size t = target_;
+        expression_ = false;
+        target_ = firstFree;
+        n.accept(*this);
+        expression_ = expression;
+        target_ = t;
+    }
+
+    // helpers
+
+    Size emit(const OpCode op, ASTNode& n, const Size dst = 0, const Operand& a = Operand(),
+              const Operand& b = Operand(), const Size slot = 0) {
+        ScriptBytecode::Instruction i;
+        i.op = op;
+        i.dst = dst;
+        i.a = a;
+        i.b = b;
+        i.slot = slot;
+        i.node = &n;
+        code_.instructions.push_back(i);
+        return code_.instructions.size() - 1;
+    }
+
+    // let a jump instruction point to the next instruction that is emitted
+    void patch(const Size instruction) { code_.instructions[instruction].jump = code_.instructions.size(); }
+
+    void useRegister(const Size r) { code_.registers = std::max(code_.registers, r + 1); }
+
+    Operand reg(const Size r) {
+        useRegister(r);
+        return Operand{Operand::Kind::Register, r};
+    }
+
+    Size slot(const std::string& name) {
+        auto s = slots_.find(name);
+        if (s != slots_.end())
+            return s->second;
+        code_.variables.push_back(name);
+        return slots_[name] = code_.variables.size() - 1;
+    }
+
+    Size constant(const Real value) {
+        // distinguish -0.0 and 0.0
+        auto key = std::make_pair(std::signbit(value), value);
+        auto c = constants_.find(key);
+        if (c != constants_.end())
+            return c->second;
+        code_.constants.push_back(value);
+        return constants_[key] = code_.constants.size() - 1;
+    }
+
+    void delegate(ASTNode& n) {
+        if (expression_) {
+            emit(OpCode::DelegateExpression, n, target_);
+            result_ = reg(target_);
+        } else {
+            emit(OpCode::DelegateStatement, n);
+        }
+    }
+
+    void binary(ASTNode& n, const OpCode op) {
+        if (!expression_) {
+            delegate(n);
+            return;
+        }
+        Size t = target_;
+        Operand a = expression(*n.args[0], t);
+        Operand b = expression(*n.args[1], t + 1);
+        emit(op, n, t, a, b);
+        result_ = reg(t);
+    }
+
+    void unary(ASTNode& n, const OpCode op) {
+        if (!expression_) {
+            delegate(n);
+            return;
+        }
+        Size t = target_;
+        Operand a = expression(*n.args[0], t);
+        emit(op, n, t, a);
+        result_ = reg(t);
+    }
+
+    void shortCut(ASTNode& n, const OpCode shortCutOp, const OpCode op) {
+        if (!expression_) {
+            delegate(n);
+            return;
+        }
+        Size t = target_;
+        Operand a = expression(*n.args[0], t);
+        Size s = emit(shortCutOp, n, t, a);
+        Operand b = expression(*n.args[1], t + 1);
+        emit(op, n, t, a, b);
+        patch(s);
+        result_ = reg(t);
+    }
+
+    void requireStatement(ASTNode& n) {
+        QL_REQUIRE(!expression_, "ScriptCompiler: unexpected statement in expression at " << to_string(n.locationInfo));
+    }
+
+    // nodes that are not compiled are delegated to the ast runner
+
+    void visit(ASTNode& n) override { delegate(n); }
+
+    // operator / function node types
+
+    void visit(OperatorPlusNode& n) override { binary(n, OpCode::Plus); }
+    void visit(OperatorMinusNode& n) override { binary(n, OpCode::Minus); }
+    void visit(OperatorMultiplyNode& n) override { binary(n, OpCode::Multiply); }
+    void visit(OperatorDivideNode& n) override { binary(n, OpCode::Divide); }
+    void visit(NegateNode& n) override { unary(n, OpCode::Negate); }
+    void visit(FunctionAbsNode& n) override { unary(n, OpCode::Abs); }
+    void visit(FunctionExpNode& n) override { unary(n, OpCode::Exp); }
+    void visit(FunctionLogNode& n) override { unary(n, OpCode::Log); }
+    void visit(FunctionSqrtNode& n) override { unary(n, OpCode::Sqrt); }
+    void visit(FunctionNormalCdfNode& n) override { unary(n, OpCode::NormalCdf); }
+    void visit(FunctionNormalPdfNode& n) override { unary(n, OpCode::NormalPdf); }
+    void visit(FunctionMinNode& n) override { binary(n, OpCode::Min); }
+    void visit(FunctionMaxNode& n) override { binary(n, OpCode::Max); }
+    void visit(FunctionPowNode& n) override { binary(n, OpCode::Pow); }
+
+    // condition nodes
+
+    void visit(ConditionEqNode& n) override { binary(n, OpCode::Eq); }
+    void visit(ConditionNeqNode& n) override { binary(n, OpCode::Neq); }
+    void visit(ConditionLtNode& n) override { binary(n, OpCode::Lt); }
+    void visit(ConditionLeqNode& n) override { binary(n, OpCode::Leq); }
+    void visit(ConditionGtNode& n) override { binary(n, OpCode::Gt); }
+    void visit(ConditionGeqNode& n) override { binary(n, OpCode::Geq); }
+    void visit(ConditionNotNode& n) override { unary(n, OpCode::Not); }
+    void visit(ConditionAndNode& n) override { shortCut(n, OpCode::AndShortCut, OpCode::And); }
+    void visit(ConditionOrNode& n) override { shortCut(n, OpCode::OrShortCut, OpCode::Or); }
+
+    // constants / variables
+
+    void visit(ConstantNumberNode& n) override {
+        if (!expression_) {
+            delegate(n);
+            return;
+        }
+        result_ = Operand{Operand::Kind::Constant, constant(n.value)};
+    }
+
+    void visit(VariableNode& n) override {
+        if (!expression_) {
+            delegate(n);
+            return;
+        }
+        Size t = target_;
+        Size s = slot(n.name);
+        if (n.args[0]) {
+            Operand i = expression(*n.args[0], t);
+            emit(OpCode::LoadElement, n, t, Operand(), i, s);
+            result_ = reg(t);
+        } else {
+            result_ = Operand{Operand::Kind::Variable, s};
+        }
+    }
+
+    // statements
+
+    void visit(AssignmentNode& n) override {
+        requireStatement(n);
+        auto v = QuantLib::ext::dynamic_pointer_cast<VariableNode>(n.args[0]);
+        if (!v) {
+            // invalid assignment, let the ast runner produce the error
+            delegate(n);
+            return;
+        }
+        Size t = target_;
+        Operand right = expression(*n.args[1], t);
+        Size s = slot(v->name);
+        Size prepare = emit(OpCode::AssignPrepare, n, 0, Operand(), Operand(), s);
+        Operand i;
+        if (v->args[0])
+            i = expression(*v->args[0], t + 1);
+        emit(OpCode::Assign, n, 0, right, i, s);
+        patch(prepare);
+    }
+
+    void visit(RequireNode& n) override {
+        requireStatement(n);
+        Operand c = expression(*n.args[0], target_);
+        emit(OpCode::Require, n, 0, c);
+    }
+
+    void visit(SequenceNode& n) override {
+        requireStatement(n);
+        for (auto const& arg : n.args)
+            statement(*arg, target_);
+    }
+
+    void visit(IfThenElseNode& n) override {
+        requireStatement(n);
+        // the condition must survive the branches, which therefore use the registers after it
+        Size t = target_;
+        Operand c = expression(*n.args[0], t);
+        Size push = emit(OpCode::PushFilter, n, 0, c);
+        statement(*n.args[1], t + 1);
+        patch(push);
+        emit(OpCode::PopFilter, n);
+        if (n.args[2]) {
+            Size pushNegated = emit(OpCode::PushFilterNegated, n, 0, c);
+            statement(*n.args[2], t + 1);
+            patch(pushNegated);
+            emit(OpCode::PopFilter, n);
+        }
+    }
+
+    void visit(LoopNode& n) override {
+        requireStatement(n);
+        Size t = target_;
+        Size s = slot(n.name);
+        emit(OpCode::LoopCheck, n, 0, Operand(), Operand(), s);
+        expressionToRegister(*n.args[0], t);
+        expressionToRegister(*n.args[1], t + 1);
+        expressionToRegister(*n.args[2], t + 2);
+        Size id = code_.loops++;
+        Size init = emit(OpCode::LoopInit, n, id, reg(t), Operand(), s);
+        Size body = code_.instructions.size();
+        statement(*n.args[3], t + 3);
+        Size next = emit(OpCode::LoopNext, n, id, Operand(), Operand(), s);
+        code_.instructions[next].jump = body;
+        patch(init);
+    }
+
+private:
+    ScriptBytecode& code_;
+    bool expression_ = false;
+    Size target_ = 0;
+    Operand result_;
+    std::map<std::string, Size> slots_;
+    std::map<std::pair<bool, Real>, Size> constants_;
+};
+
+std::ostream& operator<<(std::ostream& out, const Operand& o) {
+    switch (o.kind) {
+    case Operand::Kind::Register:
+        return out << "r" << o.index;
+    case Operand::Kind::Constant:
+        return out << "c" << o.index;
+    case Operand::Kind::Variable:
+        return out << "v" << o.index;
+    default:
+        return out << "-";
+    }
+}
+
+} // namespace
+
+QuantLib::ext::shared_ptr<ScriptBytecode> compileScript(const ASTNodePtr root) {
+    QL_REQUIRE(root, "compileScript(): ast is null");
+    auto code = QuantLib::ext::make_shared<ScriptBytecode>();
+    code->root = root;
+    ScriptCompiler compiler(*code);
+    compiler.statement(*root, 0);
+    return code;
+}
+
+std::ostream& operator<<(std::ostream& out, const ScriptBytecode& code) {
+    for (Size i = 0; i < code.constants.size(); ++i)
+        out << "c" << i << " = " << code.constants[i] << "\n";
+    for (Size i = 0; i < code.variables.size(); ++i)
+        out << "v" << i << " = " << code.variables[i] << "\n";
+    for (Size i = 0; i < code.instructions.size(); ++i) {
+        auto const& ins = code.instructions[i];
+        out << std::setw(5) << i << " " << std::left << std::setw(20) << opCodeLabels.at(static_cast<Size>(ins.op))
+            << std::right << " dst=" << ins.dst << " a=" << ins.a << " b=" << ins.b << " slot=" << ins.slot
+            << " jump=" << ins.jump << " " << to_string(ins.node->locationInfo) << "\n";
+    }
+    return out;
+}
+
+} // namespace data
+} // namespace ore
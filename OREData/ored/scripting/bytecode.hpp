@@ -0,0 +1,135 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/scripting/bytecode.hpp
+    \brief compiled representation of a script ast
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ored/scripting/ast.hpp>
+
+#include <ostream>
+
+namespace ore {
+namespace data {
+
+/*! Compiled form of a script ast which is executed by the ScriptEngine instead of visiting the ast.
+
+    Operators, functions without model dependency, conditions, assignments and the control flow are translated into a
+    flat list of instructions working on value registers. Variables are referenced by slots which are bound to the
+    context once per run, number constants are held in a pool. All other nodes (model dependent functions, SORT,
+    PERMUTE, declarations, ...) are kept as ast nodes and delegated to the ast runner when their instruction is
+    executed, so that the semantics, in particular w.r.t. the paylog, are the same as when the ast is run directly.
+
+    The bytecode does not depend on a context or model and is not modified during a run, i.e. it can be shared. */
+struct ScriptBytecode {
+
+    enum class OpCode {
+        // dst = op(a, b)
+        Plus,
+        Minus,
+        Multiply,
+        Divide,
+        Min,
+        Max,
+        Pow,
+        Eq,
+        Neq,
+        Lt,
+        Leq,
+        Gt,
+        Geq,
+        // dst = op(a)
+        Negate,
+        Abs,
+        Exp,
+        Log,
+        Sqrt,
+        NormalCdf,
+        NormalPdf,
+        Not,
+        // dst = a
+        Move,
+        // dst = variables[slot][b]
+        LoadElement,
+        // a is a condition, jump if it is deterministic false (And) / true (Or) and set dst accordingly
+        AndShortCut,
+        OrShortCut,
+        // dst = logicalAnd(a, b) / logicalOr(a, b)
+        And,
+        Or,
+        // skip the assignment to variables[slot] (to jump) if it is ignored, check that it is not constant
+        AssignPrepare,
+        // variables[slot][b] = a, using the current filter
+        Assign,
+        // check that the condition a holds for the current filter
+        Require,
+        // push current filter && a (resp. && !a), jump if the new filter is deterministic false
+        PushFilter,
+        PushFilterNegated,
+        PopFilter,
+        // check loop variable variables[slot]
+        LoopCheck,
+        // initialise loop with id dst, start, end and step in registers a, a + 1, a + 2, jump to end if empty
+        LoopInit,
+        // advance loop with id dst, jump to body if not finished
+        LoopNext,
+        // let the ast runner evaluate node, for expressions dst is set to the result
+        DelegateExpression,
+        DelegateStatement
+    };
+
+    struct Operand {
+        enum class Kind { None, Register, Constant, Variable };
+        Kind kind = Kind::None;
+        Size index = 0;
+    };
+
+    struct Instruction {
+        OpCode op;
+        Size dst = 0;
+        Operand a, b;
+        Size slot = 0;
+        Size jump = 0;
+        // the node is used for diagnostics and for delegation
+        ASTNode* node = nullptr;
+    };
+
+    //! the ast the bytecode was compiled from
+    ASTNodePtr root;
+    std::vector<Instruction> instructions;
+    //! number constants, materialised as random variables of the model size on each run
+    std::vector<Real> constants;
+    //! variable names referenced by slot
+    std::vector<std::string> variables;
+    //! number of value registers
+    Size registers = 0;
+    //! number of loops
+    Size loops = 0;
+};
+
+//! compile an ast into bytecode
+QuantLib::ext::shared_ptr<ScriptBytecode> compileScript(const ASTNodePtr root);
+
+//! print the bytecode for debugging purposes
+std::ostream& operator<<(std::ostream& out, const ScriptBytecode& code);
+
+} // namespace data
+} // namespace ore
@@ -131,6 +131,14 @@ public:
         value_node.push(ComputationGraph::nan);
     }
 
+    /* model calls with identical arguments return the same node, so that calls repeated in loops do not add to the
+       graph (eval() and pay() are memoised by the model already) */
+    template <class F> std::size_t memoised(const std::string& key, const F& f) {
+        if (auto r = modelCalls_.find(key); r != modelCalls_.end())
+            return r->second;
+        return modelCalls_[key] = f();
+    }
+
     // helper functions to perform operations
 
     template <typename R>
@@ -1366,11 +1374,19 @@ public:
         bool localCapFloorBool = QuantLib::close_enough(localCapFloorValue.at(0), 1.0);
 
         value.push(RandomVariable()); // uninitialized, since model dependent
-        value_node.push(model_->fwdCompAvg(
-            isAvg, QuantLib::ext::get<IndexVec>(underlying).value, obs, start, end, spreadValue.at(0), gearingValue.at(0),
-            static_cast<Integer>(lookbackValue.at(0)), static_cast<Natural>(rateCutoffValue.at(0)),
-            static_cast<Natural>(fixingDaysValue.at(0)), includeSpreadBool, capValue.at(0), floorValue.at(0),
-            nakedOptionBool, localCapFloorBool));
+        const std::string& und = QuantLib::ext::get<IndexVec>(underlying).value;
+        Real spread = spreadValue.at(0), gearing = gearingValue.at(0), cap = capValue.at(0), floor = floorValue.at(0);
+        Integer lookback = static_cast<Integer>(lookbackValue.at(0));
+        Natural rateCutoff = static_cast<Natural>(rateCutoffValue.at(0));
+        Natural fixingDays = static_cast<Natural>(fixingDaysValue.at(0));
+        value_node.push(memoised(modelCallKey("fwdCompAvg", isAvg, und, obs.serialNumber(), start.serialNumber(),
+                                              end.serialNumber(), spread, gearing, lookback, rateCutoff, fixingDays,
+                                              includeSpreadBool, cap, floor, nakedOptionBool, localCapFloorBool),
+                                 [&]() {
+                                     return model_->fwdCompAvg(isAvg, und, obs, start, end, spread, gearing, lookback,
+                                                               rateCutoff, fixingDays, includeSpreadBool, cap, floor,
+                                                               nakedOptionBool, localCapFloorBool);
+                                 }));
 
         TRACE("fwdCompAvg(" << isAvg << " , " << underlying << " , " << obsdate << " , " << startdate << " , "
                             << enddate << " , " << spreadValue.at(0) << " , " << gearingValue.at(0) << " , "
@@ -1411,7 +1427,10 @@ public:
             value_node.push(cg_const(g_,0.0));
         } else {
             value.push(RandomVariable());
-            value_node.push(model_->barrierProbability(und, obs1, obs2, barrierNode, above));
+            value_node.push(
+                memoised(modelCallKey("barrierProbability", und, obs1.serialNumber(), obs2.serialNumber(),
+                                      barrierNode, above),
+                         [&]() { return model_->barrierProbability(und, obs1, obs2, barrierNode, above); }));
         }
         TRACE((above ? "above" : "below") << "prob(" << underlying << " , " << obsdate1 << " , " << obsdate2 << " , "
                                           << barrier << " (#" << barrierNode << "))",
@@ -1478,6 +1497,8 @@ public:
     SafeStack<ValueType> value;
     SafeStack<std::size_t> filter_node;
     SafeStack<std::size_t> value_node;
+    // memoised model calls
+    std::map<std::string, std::size_t> modelCalls_;
 };
 
 } // namespace
@@ -1508,6 +1529,17 @@ void ComputationGraphBuilder::run(const bool generatePayLog, const bool includeP
         std::cerr << pattern << "\nInitial Context: \n" << (*context_) << std::endl;
     }
 
+    // identical operations share one node in the generated graph, the previous setting is restored afterwards
+
+    struct CseToggle {
+        CseToggle(ComputationGraph& g) : g(g), enabled(g.commonSubexpressionElimination()) {
+            g.enableCommonSubexpressionElimination(true);
+        }
+        ~CseToggle() { g.enableCommonSubexpressionElimination(enabled); }
+        ComputationGraph& g;
+        bool enabled;
+    } cseToggle(g_);
+
     boost::timer::cpu_timer timer;
     try {
         reset(root_);
@@ -31,15 +31,34 @@ AnalyticBlackRiskParticipationAgreementEngine::AnalyticBlackRiskParticipationAgr
     const std::map<std::string, Handle<Quote>>& fxSpots, const Handle<DefaultProbabilityTermStructure>& defaultCurve,
     const Handle<Quote>& recoveryRate, const Handle<SwaptionVolatilityStructure>& volatility,
     const QuantLib::ext::shared_ptr<SwapIndex>& swapIndexBase, const bool matchUnderlyingTenor, const Real reversion,
-    const bool alwaysRecomputeOptionRepresentation, const Size maxGapDays, const Size maxDiscretisationPoints)
+    const bool alwaysRecomputeOptionRepresentation, const Size maxGapDays, const Size maxDiscretisationPoints,
+    const Real optionRepresentationTolerance)
     : RiskParticipationAgreementBaseEngine(baseCcy, discountCurves, fxSpots, defaultCurve, recoveryRate, maxGapDays,
                                            maxDiscretisationPoints),
       volatility_(volatility), swapIndexBase_(swapIndexBase), matchUnderlyingTenor_(matchUnderlyingTenor),
-      reversion_(reversion), alwaysRecomputeOptionRepresentation_(alwaysRecomputeOptionRepresentation) {
+      reversion_(reversion), alwaysRecomputeOptionRepresentation_(alwaysRecomputeOptionRepresentation),
+      optionRepresentationTolerance_(optionRepresentationTolerance) {
     registerWith(volatility_);
     registerWith(swapIndexBase_);
 }
 
+std::vector<Real> AnalyticBlackRiskParticipationAgreementEngine::curveRates(
+    const std::vector<std::tuple<Date, Date, Date>>& periods) const {
+    std::vector<Real> rates;
+    std::vector<Handle<YieldTermStructure>> curves = {discountCurves_[arguments_.underlyingCcys[0]]};
+    if (!swapIndexBase_->forwardingTermStructure().empty())
+        curves.push_back(swapIndexBase_->forwardingTermStructure());
+    for (auto const& c : curves) {
+        if (c.empty())
+            continue;
+        for (auto const& p : periods) {
+            Real t = c->timeFromReference(std::get<0>(p));
+            rates.push_back(t > 0.0 ? -std::log(c->discount(t)) / t : 0.0);
+        }
+    }
+    return rates;
+}
+
 Real AnalyticBlackRiskParticipationAgreementEngine::protectionLegNpv() const {
 
     QL_REQUIRE(!volatility_.empty(),
@@ -47,8 +66,23 @@ Real AnalyticBlackRiskParticipationAgreementEngine::protectionLegNpv() const {
 
     // check if we can reuse the swaption representation, otherwise compute it
 
-    if (alwaysRecomputeOptionRepresentation_ || arguments_.optionRepresentationReferenceDate == Date() ||
-        referenceDate_ != arguments_.optionRepresentationReferenceDate) {
+    bool recompute = alwaysRecomputeOptionRepresentation_ || arguments_.optionRepresentationReferenceDate == Date() ||
+                     referenceDate_ != arguments_.optionRepresentationReferenceDate;
+
+    // if a tolerance is given, we recompute if the rates on the option representation dates have moved too much
+
+    if (!recompute && optionRepresentationTolerance_ != Null<Real>()) {
+        std::vector<Real> rates = curveRates(arguments_.optionRepresentationPeriods);
+        if (rates.size() != arguments_.optionRepresentationCurveRates.size()) {
+            recompute = true;
+        } else {
+            for (Size i = 0; i < rates.size() && !recompute; ++i)
+                recompute = std::abs(rates[i] - arguments_.optionRepresentationCurveRates[i]) >
+                            optionRepresentationTolerance_;
+        }
+    }
+
+    if (recompute) {
 
         results_.optionRepresentationReferenceDate = referenceDate_;
         results_.optionRepresentationPeriods.clear();
@@ -88,10 +122,13 @@ Real AnalyticBlackRiskParticipationAgreementEngine::protectionLegNpv() const {
             // swp might be null, if there are not underlying flows left, this is handled below
             results_.optionRepresentation.push_back(swp);
         }
+        if (optionRepresentationTolerance_ != Null<Real>())
+            results_.optionRepresentationCurveRates = curveRates(results_.optionRepresentationPeriods);
     } else {
         results_.optionRepresentationReferenceDate = arguments_.optionRepresentationReferenceDate;
         results_.optionRepresentationPeriods = arguments_.optionRepresentationPeriods;
         results_.optionRepresentation = arguments_.optionRepresentation;
+        results_.optionRepresentationCurveRates = arguments_.optionRepresentationCurveRates;
         QL_REQUIRE(
             results_.optionRepresentation.size() == results_.optionRepresentationPeriods.size(),
             "AnalyticBlackRiskParticipationAgreementEngine::calculate(): inconsistent swaption representation periods");
@@ -33,6 +33,11 @@ namespace data {
 
 using namespace QuantLib;
 
+/*! If alwaysRecomputeOptionRepresentation is false, the representative swaptions computed on the first calculation
+    are reused on subsequent calculations with the same reference date. If in addition an
+    optionRepresentationTolerance is given, they are only reused as long as the continuously compounded zero rates of
+    the discount curve and the swap index forwarding curve on the option representation dates do not move by more than
+    this tolerance (in absolute terms) against the rates at the time of the last computation. */
 class AnalyticBlackRiskParticipationAgreementEngine : public RiskParticipationAgreementBaseEngine {
 public:
     AnalyticBlackRiskParticipationAgreementEngine(
@@ -41,16 +46,20 @@ public:
         const Handle<DefaultProbabilityTermStructure>& defaultCurve, const Handle<Quote>& recoveryRate,
         const Handle<SwaptionVolatilityStructure>& volatility, const QuantLib::ext::shared_ptr<SwapIndex>& swapIndexBase,
         const bool matchUnderlyingTenor, const Real reversion, const bool alwaysRecomputeOptionRepresentation,
-        const Size maxGapDays = Null<Size>(), const Size maxDiscretisationPoints = Null<Size>());
+        const Size maxGapDays = Null<Size>(), const Size maxDiscretisationPoints = Null<Size>(),
+        const Real optionRepresentationTolerance = Null<Real>());
 
 private:
     Real protectionLegNpv() const override;
+    // zero rates of the discount and swap index forwarding curve on the given option representation dates
+    std::vector<Real> curveRates(const std::vector<std::tuple<Date, Date, Date>>& periods) const;
 
     const Handle<SwaptionVolatilityStructure> volatility_;
     const QuantLib::ext::shared_ptr<SwapIndex> swapIndexBase_;
     const bool matchUnderlyingTenor_;
     const Real reversion_;
     const bool alwaysRecomputeOptionRepresentation_;
+    const Real optionRepresentationTolerance_;
 };
 
 } // namespace data
@@ -643,12 +643,14 @@ Real NumericLgmRiskParticipationAgreementEngine::protectionLegNpv() const {
 
         auto states = stateGrid(eventTimes[i]);
 
-        // rollback underlying PV to current event date, if we are not on the latest event date
+        // rollback underlying and swaption PV to current event date, if we are not on the latest event date
 
         if (i < static_cast<int>(eventDates.size()) - 1) {
+            std::vector<RandomVariable*> values{&swaptionPv};
             for (auto& u : underlyingPv) {
-                u.second = rollback(u.second, eventTimes[i + 1], eventTimes[i]);
+                values.push_back(&u.second);
             }
+            rollbackMultiple(values, eventTimes[i + 1], eventTimes[i]);
         }
 
         // move relevant PV components to index 0
@@ -659,12 +661,6 @@ Real NumericLgmRiskParticipationAgreementEngine::protectionLegNpv() const {
                 u.second = RandomVariable(gridSize(), 0.0);
             }
         }
-        // rollback swaption PV
-
-        if (i < static_cast<int>(eventDates.size()) - 1) {
-            swaptionPv = rollback(swaptionPv, eventTimes[i + 1], eventTimes[i]);
-        }
-
         // loop over floating coupons with fixingDate == eventDate and add them to the underlyingPv
 
         for (Size k = 0; k < floatingIndices[i].size(); ++k) {
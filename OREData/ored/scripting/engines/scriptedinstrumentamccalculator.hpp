@@ -25,6 +25,7 @@
 #include <ored/scripting/models/amcmodel.hpp>
 #include <ored/scripting/models/model.hpp>
 #include <ored/scripting/ast.hpp>
+#include <ored/scripting/bytecode.hpp>
 #include <ored/scripting/context.hpp>
 #include <ored/scripting/scriptedinstrument.hpp>
 
@@ -40,17 +41,20 @@ public:
     ScriptedInstrumentAmcCalculator(const std::string& npv, const QuantLib::ext::shared_ptr<Model>& model, const ASTNodePtr ast,
                                     const QuantLib::ext::shared_ptr<Context>& context, const std::string& script = "",
                                     const bool interactive = false,
-                                    const std::set<std::string>& stickyCloseOutStates = {})
+                                    const std::set<std::string>& stickyCloseOutStates = {},
+                                    const QuantLib::ext::shared_ptr<ScriptBytecode>& bytecode = nullptr)
         : npv_(npv), model_(model), ast_(ast), context_(context), script_(script), interactive_(interactive),
-          stickyCloseOutStates_(stickyCloseOutStates) {}
+          stickyCloseOutStates_(stickyCloseOutStates), bytecode_(bytecode) {}
 
     QuantLib::Currency npvCurrency() override;
 
     std::vector<QuantExt::RandomVariable> simulatePath(const std::vector<QuantLib::Real>& pathTimes,
-                                                       std::vector<std::vector<QuantExt::RandomVariable>>& paths,
+                                                       const std::vector<std::vector<QuantExt::RandomVariable>>& paths,
                                                        const std::vector<size_t>& relevantPathIndex,
                                                        const std::vector<size_t>& relevantTimeIndex) override;
 
+    std::vector<QuantLib::Size> requiredStateIndices() const override;
+
 private:
     const std::string npv_;
     const QuantLib::ext::shared_ptr<Model> model_;
@@ -59,6 +63,7 @@ private:
     const std::string script_;
     const bool interactive_;
     const std::set<std::string> stickyCloseOutStates_;
+    const QuantLib::ext::shared_ptr<ScriptBytecode> bytecode_;
     //
     std::map<std::string, ValueType> stickyCloseOutRunScalars_;
     std::map<std::string, std::vector<ValueType>> stickyCloseOutRunArrays_;
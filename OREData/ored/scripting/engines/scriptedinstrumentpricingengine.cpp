@@ -18,13 +18,23 @@
 
 #include <ored/scripting/engines/scriptedinstrumentamccalculator.hpp>
 #include <ored/scripting/engines/scriptedinstrumentpricingengine.hpp>
+#include <ored/scripting/models/pathslicemodel.hpp>
+#include <ored/scripting/models/tapemodelcg.hpp>
+#include <ored/scripting/asttoscriptconverter.hpp>
+#include <ored/scripting/computationgraphbuilder.hpp>
 #include <ored/scripting/scriptengine.hpp>
 #include <ored/scripting/utilities.hpp>
 
 #include <ored/utilities/log.hpp>
 
+#include <qle/ad/backwardderivatives.hpp>
+#include <qle/ad/forwardevaluation.hpp>
 #include <qle/instruments/cashflowresults.hpp>
 #include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/math/randomvariable_ops.hpp>
+
+#include <ql/math/matrix.hpp>
 
 namespace ore {
 namespace data {
@@ -50,8 +60,87 @@ boost::any valueToAny(const QuantLib::ext::shared_ptr<Model>& model, const Value
     return boost::apply_visitor(anyGetter(model), v);
 }
 
+// true if the ast contains a node that requires all paths (NPV, NPVMEM) or the calling thread's session (HISTFIXING)
+
+bool requiresAllPaths(const ASTNodePtr& n) {
+    if (n == nullptr)
+        return false;
+    if (QuantLib::ext::dynamic_pointer_cast<FunctionNpvNode>(n) ||
+        QuantLib::ext::dynamic_pointer_cast<FunctionNpvMemNode>(n) ||
+        QuantLib::ext::dynamic_pointer_cast<HistFixingNode>(n))
+        return true;
+    for (auto const& a : n->args)
+        if (requiresAllPaths(a))
+            return true;
+    return false;
+}
+
+// merge the values of the path chunks with the given offsets into a value for all n paths
+
+ValueType mergeChunks(const std::vector<const ValueType*>& values, const std::vector<Size>& offsets, const Size n) {
+    const ValueType& v0 = *values.front();
+    if (v0.which() == ValueTypeWhich::Number) {
+        bool deterministic = true;
+        for (auto v : values) {
+            QL_REQUIRE(v->which() == ValueTypeWhich::Number, "mergeChunks(): inconsistent value types");
+            const RandomVariable& r = QuantLib::ext::get<RandomVariable>(*v);
+            deterministic = deterministic && r.deterministic() &&
+                            r.at(0) == QuantLib::ext::get<RandomVariable>(v0).at(0);
+        }
+        if (deterministic) {
+            RandomVariable result = QuantLib::ext::get<RandomVariable>(v0);
+            result.resetSize(n);
+            return result;
+        }
+        std::vector<double> data(n);
+        for (Size c = 0; c < values.size(); ++c) {
+            const RandomVariable& r = QuantLib::ext::get<RandomVariable>(*values[c]);
+            for (Size i = offsets[c]; i < offsets[c + 1]; ++i)
+                data[i] = r[i - offsets[c]];
+        }
+        return RandomVariable(data, QuantLib::ext::get<RandomVariable>(v0).time());
+    } else if (v0.which() == ValueTypeWhich::Filter) {
+        Filter result(n, false);
+        for (Size c = 0; c < values.size(); ++c) {
+            QL_REQUIRE(values[c]->which() == ValueTypeWhich::Filter, "mergeChunks(): inconsistent value types");
+            const Filter& f = QuantLib::ext::get<Filter>(*values[c]);
+            for (Size i = offsets[c]; i < offsets[c + 1]; ++i)
+                result.set(i, f[i - offsets[c]]);
+        }
+        result.updateDeterministic();
+        return result;
+    } else if (v0.which() == ValueTypeWhich::Event) {
+        return EventVec{n, QuantLib::ext::get<EventVec>(v0).value};
+    } else if (v0.which() == ValueTypeWhich::Currency) {
+        return CurrencyVec{n, QuantLib::ext::get<CurrencyVec>(v0).value};
+    } else if (v0.which() == ValueTypeWhich::Index) {
+        return IndexVec{n, QuantLib::ext::get<IndexVec>(v0).value};
+    } else if (v0.which() == ValueTypeWhich::Daycounter) {
+        return DaycounterVec{n, QuantLib::ext::get<DaycounterVec>(v0).value};
+    } else {
+        QL_FAIL("mergeChunks(): value type " << v0.which() << " not handled, internal error");
+    }
+}
+
 } // namespace
 
+ScriptedInstrumentPricingEngine::ScriptedInstrumentPricingEngine(
+    const std::string& npv, const std::vector<std::pair<std::string, std::string>>& additionalResults,
+    const QuantLib::ext::shared_ptr<Model>& model, const ASTNodePtr ast,
+    const QuantLib::ext::shared_ptr<Context>& context, const std::string& script, const bool interactive,
+    const bool amcEnabled, const std::set<std::string>& amcStickyCloseOutStates, const bool generateAdditionalResults,
+    const bool includePastCashflows, const QuantLib::ext::shared_ptr<ScriptBytecode>& bytecode, const Size pathChunks,
+    const bool pathwiseSensitivities, const bool keepPayLogPaths,
+    const std::vector<std::pair<std::string, std::string>>& controlVariates)
+    : npv_(npv), additionalResults_(additionalResults), model_(model), ast_(ast), context_(context), script_(script),
+      interactive_(interactive), amcEnabled_(amcEnabled), amcStickyCloseOutStates_(amcStickyCloseOutStates),
+      generateAdditionalResults_(generateAdditionalResults), includePastCashflows_(includePastCashflows),
+      bytecode_(bytecode), pathChunks_(pathChunks), pathwiseSensitivities_(pathwiseSensitivities),
+      keepPayLogPaths_(keepPayLogPaths), controlVariates_(controlVariates),
+      pathChunkable_(pathChunks > 1 && !requiresAllPaths(ast)) {
+    registerWith(model_);
+}
+
 Real ScriptedInstrumentPricingEngine::addMcErrorEstimate(const std::string& label, const ValueType& v) const {
     if (model_->type() != Model::Type::MC)
         return Null<Real>();
@@ -64,6 +153,216 @@ Real ScriptedInstrumentPricingEngine::addMcErrorEstimate(const std::string& labe
     return errEst;
 }
 
+void ScriptedInstrumentPricingEngine::runOnPathChunks(const QuantLib::ext::shared_ptr<Context>& workingContext,
+                                                      const QuantLib::ext::shared_ptr<PayLog>& paylog) const {
+
+    PathSliceModel::Slices slices(model_, std::min(pathChunks_, model_->size()));
+    Size nChunks = slices.size();
+    DLOG("run script on " << nChunks << " path chunks");
+
+    // the asts cache references to the context during a run, so each chunk gets its own ast
+
+    if (chunkScripts_.size() != nChunks) {
+        chunkScripts_.clear();
+        chunkScripts_.push_back(std::make_pair(ast_, bytecode_));
+        std::string code = script_.empty() ? to_script(ast_) : script_;
+        for (Size c = 1; c < nChunks; ++c) {
+            auto ast = parseScript(code);
+            chunkScripts_.push_back(std::make_pair(ast, bytecode_ ? compileScript(ast) : nullptr));
+        }
+    }
+
+    // set up the chunk contexts and paylogs
+
+    std::vector<Size> offsets;
+    std::vector<QuantLib::ext::shared_ptr<Context>> contexts;
+    std::vector<QuantLib::ext::shared_ptr<PayLog>> paylogs;
+    for (Size c = 0; c < nChunks; ++c) {
+        offsets.push_back(slices.slice(c)->offset());
+        contexts.push_back(QuantLib::ext::make_shared<Context>(*workingContext));
+        contexts.back()->resetSize(slices.slice(c)->size());
+        paylogs.push_back(paylog ? QuantLib::ext::make_shared<PayLog>(paylog->keepPaths()) : nullptr);
+    }
+    offsets.push_back(model_->size());
+
+    // run the chunks, the model is evaluated on this thread
+
+    slices.run([this, &slices, &contexts, &paylogs](const Size c) {
+        ScriptEngine engine(chunkScripts_[c].first, contexts[c], slices.slice(c), chunkScripts_[c].second);
+        engine.run(script_, false, paylogs[c], includePastCashflows_);
+    });
+
+    // merge the chunk contexts into the working context
+
+    for (auto const& [name, _] : contexts.front()->scalars) {
+        std::vector<const ValueType*> values;
+        for (auto const& c : contexts)
+            values.push_back(&c->scalars.at(name));
+        workingContext->scalars[name] = mergeChunks(values, offsets, model_->size());
+    }
+    for (auto const& [name, a] : contexts.front()->arrays) {
+        std::vector<ValueType> merged;
+        for (Size i = 0; i < a.size(); ++i) {
+            std::vector<const ValueType*> values;
+            for (auto const& c : contexts) {
+                QL_REQUIRE(c->arrays.at(name).size() == a.size(),
+                           "array '" << name << "' has different sizes in path chunks, this is unexpected");
+                values.push_back(&c->arrays.at(name)[i]);
+            }
+            merged.push_back(mergeChunks(values, offsets, model_->size()));
+        }
+        workingContext->arrays[name] = merged;
+    }
+
+    // merge the chunk paylogs
+
+    if (paylog) {
+        for (Size c = 0; c < nChunks; ++c) {
+            paylogs[c]->consolidateAndSort();
+            paylog->mergeChunk(*paylogs[c], offsets[c], model_->size());
+        }
+    }
+}
+
+void ScriptedInstrumentPricingEngine::calculatePathwiseSensitivities() const {
+
+    std::vector<std::string> inputs = model_->pathwiseSensitivityInputs();
+    if (inputs.empty()) {
+        WLOG("ScriptedInstrumentPricingEngine: model does not provide pathwise sensitivity inputs, skip computation");
+        return;
+    }
+
+    // record the script as a computation graph, the model calls are leaves evaluated by the classic model
+
+    auto tapeModel = QuantLib::ext::make_shared<TapeModelCG>(model_);
+    auto g = tapeModel->computationGraph();
+
+    auto tapeContext = QuantLib::ext::make_shared<Context>(*context_);
+    tapeContext->scalars["TODAY"] = EventVec{model_->size(), model_->referenceDate()};
+    tapeContext->constants.insert("TODAY");
+
+    for (auto const& v : tapeContext->scalars) {
+        if (v.second.which() == ValueTypeWhich::Number) {
+            auto r = QuantLib::ext::get<RandomVariable>(v.second);
+            QL_REQUIRE(r.deterministic(), "ScriptedInstrumentPricingEngine: pathwise sensitivities require variable '"
+                                              << v.first << "' from initial context to be deterministic");
+            g->setVariable(v.first + "_0", cg_const(*g, r.at(0)));
+        }
+    }
+
+    for (auto const& a : tapeContext->arrays) {
+        for (Size i = 0; i < a.second.size(); ++i) {
+            if (a.second[i].which() == ValueTypeWhich::Number) {
+                auto r = QuantLib::ext::get<RandomVariable>(a.second[i]);
+                QL_REQUIRE(r.deterministic(), "ScriptedInstrumentPricingEngine: pathwise sensitivities require "
+                                              "variable '"
+                                                  << a.first << "[" << i
+                                                  << "]' from initial context to be deterministic");
+                g->setVariable(a.first + "_" + std::to_string(i), cg_const(*g, r.at(0)));
+            }
+        }
+    }
+
+    ComputationGraphBuilder cgBuilder(*g, getRandomVariableOpLabels(), ast_, tapeContext, tapeModel);
+    cgBuilder.run(false, includePastCashflows_);
+    DLOG("recorded computation graph for pathwise sensitivities, size is " << g->size() << ", "
+                                                                           << tapeModel->leafValues().size()
+                                                                           << " model call leaves");
+
+    // forward evaluation keeping all values and one backward sweep starting at the npv node
+
+    std::vector<RandomVariable> values(g->size(), RandomVariable(model_->size()));
+    for (auto const& c : g->constants())
+        values[c.second] = RandomVariable(model_->size(), c.first);
+    for (auto const& l : tapeModel->leafValues())
+        values[l.first] = l.second;
+    forwardEvaluation(*g, values, getRandomVariableOps(model_->size()));
+
+    std::vector<RandomVariable> derivatives(g->size(), RandomVariable(model_->size(), 0.0));
+    derivatives[cg_var(*g, npv_ + "_0")] = RandomVariable(model_->size(), 1.0);
+    backwardDerivatives(*g, values, derivatives, getRandomVariableGradients(model_->size()));
+
+    // chain the adjoints of the model call leaves with their pathwise derivatives w.r.t. the model inputs
+
+    for (Size k = 0; k < inputs.size(); ++k) {
+        RandomVariable sensi(model_->size(), 0.0);
+        for (Size i = 0; i < tapeModel->leafValues().size(); ++i) {
+            const RandomVariable& adjoint = derivatives[tapeModel->leafValues()[i].first];
+            if (!isDeterministicAndZero(adjoint))
+                sensi += adjoint * tapeModel->leafDerivative(i, k);
+        }
+        Real s = model_->extractT0Result(sensi);
+        results_.additionalResults["PathwiseSensitivity_" + inputs[k]] = s;
+        DLOG("got pathwise sensitivity " << inputs[k] << " = " << s);
+    }
+}
+
+RandomVariable
+ScriptedInstrumentPricingEngine::applyControlVariates(const QuantLib::ext::shared_ptr<Context>& workingContext,
+                                                      const RandomVariable& npv) const {
+
+    // collect the control payoffs and their prices from the context
+
+    Size n = controlVariates_.size();
+    std::vector<RandomVariable> payoffs;
+    Array prices(n);
+    for (Size i = 0; i < n; ++i) {
+        auto const& [payoff, price] = controlVariates_[i];
+        auto c = workingContext->scalars.find(payoff);
+        QL_REQUIRE(c != workingContext->scalars.end(),
+                   "did not find control variate payoff variable '" << payoff << "' as scalar in context");
+        QL_REQUIRE(c->second.which() == ValueTypeWhich::Number, "control variate payoff variable '"
+                                                                    << payoff << "' must be of type NUMBER, got "
+                                                                    << c->second.which());
+        payoffs.push_back(QuantLib::ext::get<RandomVariable>(c->second));
+        auto p = workingContext->scalars.find(price);
+        QL_REQUIRE(p != workingContext->scalars.end(),
+                   "did not find control variate price variable '" << price << "' as scalar in context");
+        QL_REQUIRE(p->second.which() == ValueTypeWhich::Number, "control variate price variable '"
+                                                                    << price << "' must be of type NUMBER, got "
+                                                                    << p->second.which());
+        const RandomVariable& r = QuantLib::ext::get<RandomVariable>(p->second);
+        QL_REQUIRE(r.deterministic(), "control variate price variable '" << price << "' must be deterministic");
+        prices[i] = r.at(0);
+    }
+
+    // the optimal coefficients are beta = Cov(C, C)^{-1} Cov(C, npv), estimated on the simulated paths
+
+    Matrix cov(n, n);
+    Array b(n);
+    for (Size i = 0; i < n; ++i) {
+        b[i] = covariance(payoffs[i], npv).at(0);
+        for (Size j = 0; j <= i; ++j)
+            cov[i][j] = cov[j][i] = covariance(payoffs[i], payoffs[j]).at(0);
+    }
+    Array beta;
+    try {
+        beta = inverse(cov) * b;
+    } catch (const std::exception& e) {
+        WLOG("ScriptedInstrumentPricingEngine: can not estimate control variate coefficients (" << e.what()
+                                                                                              << "), ignore them");
+        return npv;
+    }
+
+    // adjust the npv and return the residual npv - beta * C, its variance determines the error estimate
+
+    RandomVariable residual = npv;
+    Real adjustment = 0.0;
+    for (Size i = 0; i < n; ++i) {
+        residual -= RandomVariable(model_->size(), beta[i]) * payoffs[i];
+        adjustment += beta[i] * (model_->extractT0Result(payoffs[i]) - prices[i]);
+        DLOG("control variate '" << controlVariates_[i].first << "': price = " << prices[i] << ", beta = " << beta[i]);
+        if (generateAdditionalResults_)
+            results_.additionalResults["ControlVariateBeta_" + controlVariates_[i].first] = beta[i];
+    }
+    if (generateAdditionalResults_)
+        results_.additionalResults["NPV_WithoutControlVariates"] = results_.value;
+    results_.value -= adjustment;
+    DLOG("got NPV = " << results_.value << " " << model_->baseCcy() << " after control variate adjustment "
+                      << -adjustment);
+    return residual;
+}
+
 void ScriptedInstrumentPricingEngine::calculate() const {
 
     lastCalculationWasValid_ = false;
@@ -100,19 +399,22 @@ void ScriptedInstrumentPricingEngine::calculate() const {
             ~TrainingPathToggle() { model->toggleTrainingPaths(); }
             QuantLib::ext::shared_ptr<Model> model;
         } toggle(model_);
-        ScriptEngine trainingEngine(ast_, trainingContext, model_);
+        ScriptEngine trainingEngine(ast_, trainingContext, model_, bytecode_);
         trainingEngine.run(script_, interactive_);
     }
 
-    // set up script engine and run it
-
-    ScriptEngine engine(ast_, workingContext, model_);
+    // set up script engine and run it, on path chunks in parallel if possible
 
     QuantLib::ext::shared_ptr<PayLog> paylog;
     if (generateAdditionalResults_)
-        paylog = QuantLib::ext::make_shared<PayLog>();
+        paylog = QuantLib::ext::make_shared<PayLog>(keepPayLogPaths_ || model_->type() != Model::Type::MC);
 
-    engine.run(script_, interactive_, paylog, includePastCashflows_);
+    if (pathChunkable_ && !interactive_ && model_->type() == Model::Type::MC && model_->size() > 1) {
+        runOnPathChunks(workingContext, paylog);
+    } else {
+        ScriptEngine engine(ast_, workingContext, model_, bytecode_);
+        engine.run(script_, interactive_, paylog, includePastCashflows_);
+    }
 
     // extract npv result and set it
 
@@ -124,10 +426,16 @@ void ScriptedInstrumentPricingEngine::calculate() const {
     results_.value = model_->extractT0Result(QuantLib::ext::get<RandomVariable>(npv->second));
     DLOG("got NPV = " << results_.value << " " << model_->baseCcy());
 
+    // apply control variates, if given
+
+    ValueType npvForErrorEstimate = npv->second;
+    if (!controlVariates_.empty() && model_->type() == Model::Type::MC)
+        npvForErrorEstimate = applyControlVariates(workingContext, QuantLib::ext::get<RandomVariable>(npv->second));
+
     // set additional results, if this feature is enabled
 
     if (generateAdditionalResults_) {
-        results_.errorEstimate = addMcErrorEstimate("NPV_MCErrEst", npv->second);
+        results_.errorEstimate = addMcErrorEstimate("NPV_MCErrEst", npvForErrorEstimate);
         for (auto const& r : additionalResults_) {
             auto s = workingContext->scalars.find(r.second);
             bool resultSet = false;
@@ -212,10 +520,14 @@ void ScriptedInstrumentPricingEngine::calculate() const {
                                  << cashFlowResults[i].currency << "-" << model_->baseCcy() << " " << fx << " discount("
                                  << cashFlowResults[i].currency << ") " << discount);
             if (paylog->dates().at(i) > model_->referenceDate()) {
-                addMcErrorEstimate("cashflow_" + std::to_string(paylog->legNos().at(i)) + "_" +
-                                       std::to_string(++cashflowNumber[paylog->legNos().at(i)]) + "_MCErrEst",
-                                   paylog->amounts().at(i) /
-                                       RandomVariable(paylog->amounts().at(i).size(), (fx * discount)));
+                std::string label = "cashflow_" + std::to_string(paylog->legNos().at(i)) + "_" +
+                                    std::to_string(++cashflowNumber[paylog->legNos().at(i)]) + "_MCErrEst";
+                Real var = model_->type() == Model::Type::MC ? paylog->variance(i) : Null<Real>();
+                if (var != Null<Real>())
+                    results_.additionalResults[label] =
+                        std::sqrt(var / static_cast<double>(model_->size())) / (fx * discount);
+                else if (model_->type() == Model::Type::MC)
+                    DLOG("could not determine " << label << " without the cashflow paths, set KeepPayLogPaths");
             }
         }
         results_.additionalResults["cashFlowResults"] = cashFlowResults;
@@ -226,13 +538,18 @@ void ScriptedInstrumentPricingEngine::calculate() const {
 
     } // if generate additional results
 
+    // compute pathwise sensitivities, if this feature is enabled
+
+    if (pathwiseSensitivities_)
+        calculatePathwiseSensitivities();
+
     // if the engine is amc enabled, add an amc calculator to the additional results
 
     if (amcEnabled_) {
         DLOG("add amc calculator to results");
         results_.additionalResults["amcCalculator"] =
             QuantLib::ext::static_pointer_cast<AmcCalculator>(QuantLib::ext::make_shared<ScriptedInstrumentAmcCalculator>(
-                npv_, model_, ast_, context_, script_, interactive_, amcStickyCloseOutStates_));
+                npv_, model_, ast_, context_, script_, interactive_, amcStickyCloseOutStates_, bytecode_));
     }
 
     lastCalculationWasValid_ = true;
@@ -24,7 +24,9 @@
 
 #include <ored/scripting/models/model.hpp>
 #include <ored/scripting/ast.hpp>
+#include <ored/scripting/bytecode.hpp>
 #include <ored/scripting/context.hpp>
+#include <ored/scripting/paylog.hpp>
 #include <ored/scripting/scriptedinstrument.hpp>
 
 #include <ored/configuration/conventions.hpp>
@@ -34,6 +36,21 @@ namespace data {
 
 class ScriptedInstrumentPricingEngine : public QuantExt::ScriptedInstrument::engine {
 public:
+    /*! If pathChunks > 1, an mc model is used and the script does not use NPV(), NPVMEM() or HISTFIXING(), the paths
+        are split into pathChunks chunks, on which the script is run in parallel. The results are merged so that they
+        agree with a run on all paths up to rounding differences.
+
+        If pathwiseSensitivities is true, the script is in addition recorded as a computation graph against the model
+        and the pathwise derivatives of the npv w.r.t. the model's pathwiseSensitivityInputs() are computed in one
+        backward sweep. They are set as additional results PathwiseSensitivity_<input>.
+
+        If keepPayLogPaths is false and an mc model is used, the cashflow log only keeps the statistics of the logged
+        amounts required for the cashflow results, see PayLog.
+
+        If controlVariates are given and an mc model is used, each pair (payoff, price) names a script variable holding
+        the pathwise (deflated) control payoff and a script variable holding its known price. The npv is adjusted by
+        the control variates with coefficients estimated by a regression of the npv on the control payoffs over the
+        simulated paths. The npv error estimate is computed from the residual of this regression then. */
     ScriptedInstrumentPricingEngine(const std::string& npv,
                                     const std::vector<std::pair<std::string, std::string>>& additionalResults,
                                     const QuantLib::ext::shared_ptr<Model>& model, const ASTNodePtr ast,
@@ -41,19 +58,22 @@ public:
                                     const bool interactive = false, const bool amcEnabled = false,
                                     const std::set<std::string>& amcStickyCloseOutStates = {},
                                     const bool generateAdditionalResults = false,
-                                    const bool includePastCashflows = false)
-        : npv_(npv), additionalResults_(additionalResults), model_(model), ast_(ast), context_(context),
-          script_(script), interactive_(interactive), amcEnabled_(amcEnabled),
-          amcStickyCloseOutStates_(amcStickyCloseOutStates), generateAdditionalResults_(generateAdditionalResults),
-          includePastCashflows_(includePastCashflows) {
-        registerWith(model_);
-    }
+                                    const bool includePastCashflows = false,
+                                    const QuantLib::ext::shared_ptr<ScriptBytecode>& bytecode = nullptr,
+                                    const Size pathChunks = 1, const bool pathwiseSensitivities = false,
+                                    const bool keepPayLogPaths = false,
+                                    const std::vector<std::pair<std::string, std::string>>& controlVariates = {});
 
     bool lastCalculationWasValid() const { return lastCalculationWasValid_; }
 
 private:
     void calculate() const override;
     Real addMcErrorEstimate(const std::string& label, const ValueType& v) const;
+    void runOnPathChunks(const QuantLib::ext::shared_ptr<Context>& workingContext,
+                         const QuantLib::ext::shared_ptr<PayLog>& paylog) const;
+    void calculatePathwiseSensitivities() const;
+    RandomVariable applyControlVariates(const QuantLib::ext::shared_ptr<Context>& workingContext,
+                                        const RandomVariable& npv) const;
 
     // calculation state, true iff calculate() was called at least once and last call went without errors
     mutable bool lastCalculationWasValid_ = false;
@@ -69,6 +89,15 @@ private:
     const std::set<std::string> amcStickyCloseOutStates_;
     const bool generateAdditionalResults_;
     const bool includePastCashflows_;
+    const QuantLib::ext::shared_ptr<ScriptBytecode> bytecode_;
+    const Size pathChunks_;
+    const bool pathwiseSensitivities_;
+    const bool keepPayLogPaths_;
+    const std::vector<std::pair<std::string, std::string>> controlVariates_;
+    // true if the script can be run on path chunks, i.e. it does not use NPV(), NPVMEM() or HISTFIXING()
+    bool pathChunkable_;
+    // ast and bytecode used for each path chunk, since an ast can not be run by several threads simultaneously
+    mutable std::vector<std::pair<ASTNodePtr, QuantLib::ext::shared_ptr<ScriptBytecode>>> chunkScripts_;
 };
 
 } // namespace data
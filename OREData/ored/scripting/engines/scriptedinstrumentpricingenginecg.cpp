@@ -75,12 +75,13 @@ ScriptedInstrumentPricingEngineCG::ScriptedInstrumentPricingEngineCG(
     const QuantLib::ext::shared_ptr<Context>& context, const Model::McParams& mcParams, const std::string& script,
     const bool interactive, const bool generateAdditionalResults, const bool includePastCashflows,
     const bool useCachedSensis, const bool useExternalComputeFramework,
-    const bool useDoublePrecisionForExternalCalculation)
+    const bool useDoublePrecisionForExternalCalculation, const bool regressionOnExternalDevice)
     : npv_(npv), additionalResults_(additionalResults), model_(model), ast_(ast), context_(context),
       mcParams_(mcParams), script_(script), interactive_(interactive),
       generateAdditionalResults_(generateAdditionalResults), includePastCashflows_(includePastCashflows),
       useCachedSensis_(useCachedSensis), useExternalComputeFramework_(useExternalComputeFramework),
-      useDoublePrecisionForExternalCalculation_(useDoublePrecisionForExternalCalculation) {
+      useDoublePrecisionForExternalCalculation_(useDoublePrecisionForExternalCalculation),
+      regressionOnExternalDevice_(regressionOnExternalDevice) {
 
     // register with model
 
@@ -193,6 +194,7 @@ void ScriptedInstrumentPricingEngineCG::calculate() const {
             settings.rngSequenceType = mcParams_.sequenceType;
             settings.rngSeed = mcParams_.seed;
             settings.regressionOrder = mcParams_.regressionOrder;
+            settings.regressionOnDevice = regressionOnExternalDevice_;
             std::tie(externalCalculationId_, newExternalCalc) =
                 ComputeEnvironment::instance().context().initiateCalculation(model_->size(), externalCalculationId_,
                                                                              cgVersion_, settings);
@@ -47,7 +47,8 @@ public:
                                       const bool interactive = false, const bool generateAdditionalResults = false,
                                       const bool includePastCashflows = false, const bool useCachedSensis = false,
                                       const bool useExternalComputeFramework = false,
-                                      const bool useDoublePrecisionForExternalCalculation = false);
+                                      const bool useDoublePrecisionForExternalCalculation = false,
+                                      const bool regressionOnExternalDevice = false);
     ~ScriptedInstrumentPricingEngineCG();
 
     bool lastCalculationWasValid() const { return lastCalculationWasValid_; }
@@ -113,6 +114,7 @@ private:
     const bool useCachedSensis_;
     const bool useExternalComputeFramework_;
     const bool useDoublePrecisionForExternalCalculation_;
+    const bool regressionOnExternalDevice_;
 };
 
 } // namespace data
@@ -34,6 +34,8 @@ public:
     virtual void injectPaths(const std::vector<QuantLib::Real>* pathTimes,
                              const std::vector<std::vector<QuantExt::RandomVariable>>* variates,
                              const std::vector<size_t>* pathIndexes, const std::vector<size_t>* timeIndexes) = 0;
+    // the indices of the state process components in the injected paths that are used by the model
+    virtual std::vector<QuantLib::Size> injectedStateIndices() const = 0;
 };
 
 } // namespace data
@@ -17,6 +17,7 @@
 */
 
 #include <ored/scripting/models/blackscholes.hpp>
+#include <ored/scripting/pathcache.hpp>
 
 #include <ored/utilities/to_string.hpp>
 #include <ored/model/utilities.hpp>
@@ -26,6 +27,9 @@
 #include <ql/math/matrixutilities/pseudosqrt.hpp>
 #include <ql/math/matrixutilities/symmetricschurdecomposition.hpp>
 
+#include <iomanip>
+#include <sstream>
+
 namespace ore {
 namespace data {
 
@@ -94,6 +98,7 @@ void BlackScholes::performCalculations() const {
     } else {
         QL_FAIL("BlackScholes: calibration '" << calibration_ << "' not supported, expected ATM, Deal");
     }
+    effectiveCalibrationStrikes_ = calibrationStrikes;
 
     // set reference date values, if there are no future simulation dates we are done
 
@@ -107,8 +112,64 @@ void BlackScholes::performCalculations() const {
     if (effectiveSimulationDates_.size() == 1)
         return;
 
-    // compute drift and covariances of log spots to evolve the process; the covariance computation is done
-    // on the refined grid where we assume the volatilities to be constant
+    // compute drift and covariances of log spots to evolve the process
+
+    Array x0(indices_.size());
+    for (Size j = 0; j < indices_.size(); ++j)
+        x0[j] = model_->processes()[j]->x0();
+
+    std::vector<Array> drift;
+    std::vector<Matrix> sqrtCov;
+    computeDriftAndCovariance(correlation, calibrationStrikes, x0, Null<Size>(), 0.0, drift, covariance_, sqrtCov);
+
+    // evolve the process using correlated normal variates and set the underlying path values
+
+    populatePathValues(size(), underlyingPaths_, mcParams_.sequenceType, mcParams_.seed, drift, sqrtCov, x0);
+
+    if (trainingSamples() != Null<Size>()) {
+        populatePathValues(trainingSamples(), underlyingPathsTraining_, mcParams_.trainingSequenceType,
+                           mcParams_.trainingSeed, drift, sqrtCov, x0);
+    }
+
+    // set additional results provided by this model
+
+    for (Size i = 0; i < indices_.size(); ++i) {
+        for (Size j = 0; j < i; ++j) {
+            additionalResults_["BlackScholes.Correlation_" + indices_[i].name() + "_" + indices_[j].name()] =
+                correlation(i, j);
+        }
+    }
+
+    for (Size i = 0; i < calibrationStrikes.size(); ++i) {
+        additionalResults_["BlackScholes.CalibrationStrike_" + indices_[i].name()] =
+            (calibrationStrikes[i] == Null<Real>() ? "ATMF" : std::to_string(calibrationStrikes[i]));
+    }
+
+    for (Size i = 0; i < indices_.size(); ++i) {
+        Size timeStep = 0;
+        for (auto const& d : effectiveSimulationDates_) {
+            Real t = timeGrid_[positionInTimeGrid_[timeStep]];
+            Real forward = atmForward(model_->processes()[i]->x0(), model_->processes()[i]->riskFreeRate(),
+                                      model_->processes()[i]->dividendYield(), t);
+            if (timeStep > 0) {
+                Real volatility = model_->processes()[i]->blackVolatility()->blackVol(
+                    t, calibrationStrikes[i] == Null<Real>() ? forward : calibrationStrikes[i]);
+                additionalResults_["BlackScholes.Volatility_" + indices_[i].name() + "_" + ore::data::to_string(d)] =
+                    volatility;
+            }
+            additionalResults_["BlackScholes.Forward_" + indices_[i].name() + "_" + ore::data::to_string(d)] = forward;
+            ++timeStep;
+        }
+    }
+}
+
+void BlackScholes::computeDriftAndCovariance(const Matrix& correlation, const std::vector<Real>& calibrationStrikes,
+                                             const Array& x0, const Size shiftedIndex, const Real volShift,
+                                             std::vector<Array>& drift, std::vector<Matrix>& covariance,
+                                             std::vector<Matrix>& sqrtCov) const {
+
+    // the covariance computation is done on the refined grid where we assume the volatilities to be constant; if
+    // shiftedIndex is given, the black vols of this index are shifted by volShift (used for pathwise vegas)
 
     // used for dirf adjustment eq / com that are not in base ccy below
     std::vector<Size> forCcyDaIndex(indices_.size(), Null<Size>());
@@ -124,9 +185,9 @@ void BlackScholes::performCalculations() const {
         }
     }
 
-    std::vector<Array> drift(effectiveSimulationDates_.size() - 1, Array(indices_.size(), 0.0));
-    std::vector<Matrix> sqrtCov;
-    covariance_ =
+    drift = std::vector<Array>(effectiveSimulationDates_.size() - 1, Array(indices_.size(), 0.0));
+    sqrtCov.clear();
+    covariance =
         std::vector<Matrix>(effectiveSimulationDates_.size() - 1, Matrix(indices_.size(), indices_.size(), 0.0));
     Array variance(indices_.size(), 0.0), discountRatio(indices_.size(), 1.0);
     Size tidx = 1; // index in the refined time grid
@@ -141,18 +202,22 @@ void BlackScholes::performCalculations() const {
                 Real tmp = model_->processes()[j]->blackVolatility()->blackVariance(
                     timeGrid_[tidx],
                     calibrationStrikes[j] == Null<Real>()
-                        ? atmForward(model_->processes()[j]->x0(), model_->processes()[j]->riskFreeRate(),
+                        ? atmForward(x0[j], model_->processes()[j]->riskFreeRate(),
                                      model_->processes()[j]->dividendYield(), timeGrid_[tidx])
                         : calibrationStrikes[j]);
+                if (j == shiftedIndex) {
+                    Real vol = std::sqrt(tmp / timeGrid_[tidx]) + volShift;
+                    tmp = vol * vol * timeGrid_[tidx];
+                }
                 d_variance[j] = std::max(tmp - variance[j], 1E-20);
                 variance[j] = tmp;
             }
             for (Size j = 0; j < indices_.size(); ++j) {
-                covariance_[i - 1][j][j] += d_variance[j];
+                covariance[i - 1][j][j] += d_variance[j];
                 for (Size k = 0; k < j; ++k) {
                     Real tmp = correlation[k][j] * std::sqrt(d_variance[j] * d_variance[k]);
-                    covariance_[i - 1][k][j] += tmp;
-                    covariance_[i - 1][j][k] += tmp;
+                    covariance[i - 1][k][j] += tmp;
+                    covariance[i - 1][j][k] += tmp;
                 }
             }
             ++tidx;
@@ -160,25 +225,25 @@ void BlackScholes::performCalculations() const {
 
         // salvage covariance matrix using spectral method if not positive semidefinite
 
-        SymmetricSchurDecomposition jd(covariance_[i - 1]);
+        SymmetricSchurDecomposition jd(covariance[i - 1]);
 
         bool needsSalvaging = false;
-        for (Size k = 0; k < covariance_[i - 1].rows(); ++k) {
+        for (Size k = 0; k < covariance[i - 1].rows(); ++k) {
             if (jd.eigenvalues()[k] < -1E-16)
                 needsSalvaging = true;
         }
 
         if (needsSalvaging) {
-            Matrix diagonal(covariance_[i - 1].rows(), covariance_[i - 1].rows(), 0.0);
+            Matrix diagonal(covariance[i - 1].rows(), covariance[i - 1].rows(), 0.0);
             for (Size k = 0; k < jd.eigenvalues().size(); ++k) {
                 diagonal[k][k] = std::sqrt(std::max<Real>(jd.eigenvalues()[k], 0.0));
             }
-            covariance_[i - 1] = jd.eigenvectors() * diagonal * diagonal * transpose(jd.eigenvectors());
+            covariance[i - 1] = jd.eigenvectors() * diagonal * diagonal * transpose(jd.eigenvectors());
         }
 
         // compute the _unique_ pos semidefinite square root
 
-        sqrtCov.push_back(CholeskyDecomposition(covariance_[i - 1], true));
+        sqrtCov.push_back(CholeskyDecomposition(covariance[i - 1], true));
 
         // drift
 
@@ -186,67 +251,72 @@ void BlackScholes::performCalculations() const {
         for (Size j = 0; j < indices_.size(); ++j) {
             Real tmp = model_->processes()[j]->riskFreeRate()->discount(d) /
                        model_->processes()[j]->dividendYield()->discount(d);
-            drift[i - 1][j] = -std::log(tmp / discountRatio[j]) - 0.5 * covariance_[i - 1][j][j];
+            drift[i - 1][j] = -std::log(tmp / discountRatio[j]) - 0.5 * covariance[i - 1][j][j];
             discountRatio[j] = tmp;
 
             // drift adjustment for eq / com indices that are not in base ccy
             if (forCcyDaIndex[j] != Null<Size>()) {
-                drift[i - 1][j] -= covariance_[i - 1][forCcyDaIndex[j]][j];
+                drift[i - 1][j] -= covariance[i - 1][forCcyDaIndex[j]][j];
             }
         }
     }
+} // computeDriftAndCovariance()
 
-    // evolve the process using correlated normal variates and set the underlying path values
+void BlackScholes::populatePathValues(const Size nSamples, std::map<Date, std::vector<RandomVariable>>& paths,
+                                      const QuantExt::SequenceType sequenceType, const Size seed,
+                                      const std::vector<Array>& drift, const std::vector<Matrix>& sqrtCov,
+                                      const Array& x0) const {
 
-    populatePathValues(size(), underlyingPaths_,
-                       makeMultiPathVariateGenerator(mcParams_.sequenceType, indices_.size(),
-                                                     effectiveSimulationDates_.size() - 1, mcParams_.seed,
-                                                     mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers),
-                       drift, sqrtCov);
+    auto generator = [this, sequenceType, seed]() {
+        return makeMultiPathVariateGenerator(sequenceType, indices_.size(), effectiveSimulationDates_.size() - 1, seed,
+                                             mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers);
+    };
 
-    if (trainingSamples() != Null<Size>()) {
-        populatePathValues(trainingSamples(), underlyingPathsTraining_,
-                           makeMultiPathVariateGenerator(mcParams_.trainingSequenceType, indices_.size(),
-                                                         effectiveSimulationDates_.size() - 1, mcParams_.trainingSeed,
-                                                         mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers),
-                           drift, sqrtCov);
+    if (!mcParams_.usePathCache) {
+        populatePathValues(nSamples, paths, generator(), drift, sqrtCov, x0);
+        return;
     }
 
-    // set additional results provided by this model
-
-    for (Size i = 0; i < indices_.size(); ++i) {
-        for (Size j = 0; j < i; ++j) {
-            additionalResults_["BlackScholes.Correlation_" + indices_[i].name() + "_" + indices_[j].name()] =
-                correlation(i, j);
+    // the paths are determined by the generator settings, the initial values, the drifts and the covariances
+
+    std::ostringstream key;
+    key << std::setprecision(17) << "BlackScholes|" << nSamples << '|' << static_cast<int>(sequenceType) << '|'
+        << seed << '|' << static_cast<int>(mcParams_.sobolOrdering) << '|'
+        << static_cast<int>(mcParams_.sobolDirectionIntegers) << '|';
+    for (Size j = 0; j < x0.size(); ++j)
+        key << x0[j] << '|';
+    for (Size i = 0; i < drift.size(); ++i) {
+        for (Size j = 0; j < drift[i].size(); ++j)
+            key << drift[i][j] << '|';
+        for (Size j = 0; j < sqrtCov[i].rows(); ++j) {
+            for (Size k = 0; k < sqrtCov[i].columns(); ++k)
+                key << sqrtCov[i][j][k] << '|';
         }
     }
 
-    for (Size i = 0; i < calibrationStrikes.size(); ++i) {
-        additionalResults_["BlackScholes.CalibrationStrike_" + indices_[i].name()] =
-            (calibrationStrikes[i] == Null<Real>() ? "ATMF" : std::to_string(calibrationStrikes[i]));
-    }
+    auto cached = PathCache::instance().paths(key.str(), [this, nSamples, &generator, &drift, &sqrtCov, &x0]() {
+        std::map<Date, std::vector<RandomVariable>> tmp;
+        for (auto const& d : effectiveSimulationDates_)
+            tmp[d] = std::vector<RandomVariable>(indices_.size(), RandomVariable(nSamples, 0.0));
+        populatePathValues(nSamples, tmp, generator(), drift, sqrtCov, x0);
+        PathCache::Paths result;
+        for (auto d = std::next(effectiveSimulationDates_.begin()); d != effectiveSimulationDates_.end(); ++d)
+            result.push_back(std::move(tmp[*d]));
+        return result;
+    });
 
-    for (Size i = 0; i < indices_.size(); ++i) {
-        Size timeStep = 0;
-        for (auto const& d : effectiveSimulationDates_) {
-            Real t = timeGrid_[positionInTimeGrid_[timeStep]];
-            Real forward = atmForward(model_->processes()[i]->x0(), model_->processes()[i]->riskFreeRate(),
-                                      model_->processes()[i]->dividendYield(), t);
-            if (timeStep > 0) {
-                Real volatility = model_->processes()[i]->blackVolatility()->blackVol(
-                    t, calibrationStrikes[i] == Null<Real>() ? forward : calibrationStrikes[i]);
-                additionalResults_["BlackScholes.Volatility_" + indices_[i].name() + "_" + ore::data::to_string(d)] =
-                    volatility;
-            }
-            additionalResults_["BlackScholes.Forward_" + indices_[i].name() + "_" + ore::data::to_string(d)] = forward;
-            ++timeStep;
-        }
-    }
+    QL_REQUIRE(cached->size() == effectiveSimulationDates_.size() - 1,
+               "BlackScholes: cached paths have " << cached->size() << " steps, expected "
+                                                  << effectiveSimulationDates_.size() - 1 << ", internal error");
+    auto date = effectiveSimulationDates_.begin();
+    for (Size i = 0; i < cached->size(); ++i)
+        paths[*(++date)] = (*cached)[i];
 }
 
 void BlackScholes::populatePathValues(const Size nSamples, std::map<Date, std::vector<RandomVariable>>& paths,
                                       const QuantLib::ext::shared_ptr<MultiPathVariateGeneratorBase>& gen,
-                                      const std::vector<Array>& drift, const std::vector<Matrix>& sqrtCov) const {
+                                      const std::vector<Array>& drift, const std::vector<Matrix>& sqrtCov,
+                                      const Array& x0) const {
 
     std::vector<std::vector<RandomVariable*>> rvs(indices_.size(),
                                                   std::vector<RandomVariable*>(effectiveSimulationDates_.size() - 1));
@@ -261,7 +331,7 @@ void BlackScholes::populatePathValues(const Size nSamples, std::map<Date, std::v
 
     Array logState(indices_.size()), logState0(indices_.size());
     for (Size j = 0; j < indices_.size(); ++j) {
-        logState0[j] = std::log(model_->processes()[j]->x0());
+        logState0[j] = std::log(x0[j]);
     }
 
     for (Size path = 0; path < nSamples; ++path) {
@@ -279,6 +349,38 @@ void BlackScholes::populatePathValues(const Size nSamples, std::map<Date, std::v
     }
 } // populatePathValues()
 
+void BlackScholes::populateBumpedPathValues(const Size indexNo, const Real spotShift, const Real volShift,
+                                            std::map<Date, std::vector<RandomVariable>>& paths) const {
+
+    Array x0(indices_.size());
+    for (Size j = 0; j < indices_.size(); ++j)
+        x0[j] = model_->processes()[j]->x0();
+    x0[indexNo] += spotShift;
+
+    for (auto const& d : effectiveSimulationDates_)
+        paths[d] = std::vector<RandomVariable>(indices_.size(), RandomVariable(size(), 0.0));
+    for (Size l = 0; l < indices_.size(); ++l)
+        paths[*effectiveSimulationDates_.begin()][l].setAll(x0[l]);
+
+    if (effectiveSimulationDates_.size() == 1)
+        return;
+
+    // the calibration strikes are kept, but an atmf calibration follows the shifted spot as in performCalculations()
+
+    std::vector<Array> drift;
+    std::vector<Matrix> covariance, sqrtCov;
+    computeDriftAndCovariance(getCorrelation(), effectiveCalibrationStrikes_, x0, indexNo, volShift, drift,
+                              covariance, sqrtCov);
+
+    // use the same variates as for the underlying paths
+
+    populatePathValues(size(), paths,
+                       makeMultiPathVariateGenerator(mcParams_.sequenceType, indices_.size(),
+                                                     effectiveSimulationDates_.size() - 1, mcParams_.seed,
+                                                     mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers),
+                       drift, sqrtCov, x0);
+}
+
 namespace {
 struct comp {
     comp(const std::string& indexInput) : indexInput_(indexInput) {}
@@ -64,12 +64,26 @@ private:
                                         const RandomVariable& barrier, const bool above) const override;
     // BlackScholesBase interface implementation
     void performCalculations() const override;
+    void populateBumpedPathValues(const Size indexNo, const Real spotShift, const Real volShift,
+                                  std::map<Date, std::vector<RandomVariable>>& paths) const override;
 
+    void computeDriftAndCovariance(const Matrix& correlation, const std::vector<Real>& calibrationStrikes,
+                                   const Array& x0, const Size shiftedIndex, const Real volShift,
+                                   std::vector<Array>& drift, std::vector<Matrix>& covariance,
+                                   std::vector<Matrix>& sqrtCov) const;
+    // populate path values using a generator with the given settings, or retrieve them from the PathCache
+    void populatePathValues(const Size nSamples, std::map<Date, std::vector<RandomVariable>>& paths,
+                            const QuantExt::SequenceType sequenceType, const Size seed,
+                            const std::vector<Array>& drift, const std::vector<Matrix>& sqrtCov,
+                            const Array& x0) const;
     void populatePathValues(const Size nSamples, std::map<Date, std::vector<RandomVariable>>& paths,
                             const QuantLib::ext::shared_ptr<MultiPathVariateGeneratorBase>& gen,
-                            const std::vector<Array>& drift, const std::vector<Matrix>& sqrtCov) const;
+                            const std::vector<Array>& drift, const std::vector<Matrix>& sqrtCov,
+                            const Array& x0) const;
     // covariance per effective simulation date
     mutable std::vector<Matrix> covariance_;
+    // calibration strikes per index (null for atmf)
+    mutable std::vector<Real> effectiveCalibrationStrikes_;
 
     // the calibration to use, ATM or Deal
     const std::string calibration_;
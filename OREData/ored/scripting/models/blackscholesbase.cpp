@@ -133,6 +133,44 @@ void BlackScholesBase::performCalculations() const {
 
     underlyingPaths_.clear();
     underlyingPathsTraining_.clear();
+    underlyingPathLogDerivatives_.clear();
+}
+
+std::vector<std::string> BlackScholesBase::pathwiseSensitivityInputs() const {
+    std::vector<std::string> inputs;
+    for (auto const& i : indices_)
+        inputs.push_back("Spot_" + i.name());
+    for (auto const& i : indices_)
+        inputs.push_back("Vol_" + i.name());
+    return inputs;
+}
+
+RandomVariable BlackScholesBase::getIndexLogDerivative(const Size input, const Size indexNo, const Date& d) const {
+    QL_REQUIRE(input < 2 * indices_.size(), "BlackScholesBase::getIndexLogDerivative(): input " << input
+                                                << " out of range, expected less than " << 2 * indices_.size());
+    QL_REQUIRE(!inTrainingPhase_, "BlackScholesBase::getIndexLogDerivative(): not supported in training phase");
+
+    auto l = underlyingPathLogDerivatives_.find(input);
+    if (l == underlyingPathLogDerivatives_.end()) {
+        Size bumpedIndex = input % indices_.size();
+        bool isVolInput = input >= indices_.size();
+        Real h = isVolInput ? 1E-4 : 1E-4 * model_->processes()[bumpedIndex]->x0();
+        std::map<Date, std::vector<RandomVariable>> up, down;
+        populateBumpedPathValues(bumpedIndex, isVolInput ? 0.0 : h, isVolInput ? h : 0.0, up);
+        populateBumpedPathValues(bumpedIndex, isVolInput ? 0.0 : -h, isVolInput ? -h : 0.0, down);
+        l = underlyingPathLogDerivatives_.insert(std::make_pair(input, std::map<Date, std::vector<RandomVariable>>()))
+                .first;
+        for (auto const& p : up) {
+            std::vector<RandomVariable>& logDerivatives = l->second[p.first];
+            for (Size j = 0; j < p.second.size(); ++j) {
+                logDerivatives.push_back((log(p.second[j]) - log(down.at(p.first)[j])) /
+                                         RandomVariable(size(), 2.0 * h));
+            }
+        }
+    }
+
+    QL_REQUIRE(l->second.find(d) != l->second.end(), "did not find path log derivative for " << d);
+    return l->second.at(d).at(indexNo);
 }
 
 RandomVariable BlackScholesBase::getIndexValue(const Size indexNo, const Date& d, const Date& fwd) const {
@@ -288,6 +326,7 @@ RandomVariable BlackScholesBase::npv(const RandomVariable& amount, const Date& o
     // if we do not have retrieved a model in the previous step, we create it now
 
     std::vector<RandomVariable> transformedState;
+    std::vector<RandomVariable> basisValues;
 
     if(!haveStoredModel) {
 
@@ -301,10 +340,9 @@ RandomVariable BlackScholesBase::npv(const RandomVariable& amount, const Date& o
 
         // train coefficients
 
-        coeff = regressionCoefficients(amount, state,
-                                       multiPathBasisSystem(state.size(), mcParams_.regressionOrder,
-                                                            mcParams_.polynomType, std::min(size(), trainingSamples())),
-                                       filter, RandomVariableRegressionMethod::QR);
+        basisValues = multiPathBasisSystemValues(state, mcParams_.regressionOrder, mcParams_.polynomType,
+                                                 std::min(size(), trainingSamples()));
+        coeff = regressionCoefficients(amount, basisValues, filter, RandomVariableRegressionMethod::QR);
         DLOG("BlackScholesBase::npv(" << ore::data::to_string(obsdate) << "): regression coefficients are " << coeff
                                       << " (got model state size " << nModelStates << " and " << nAddReg
                                       << " additional regressors, coordinate transform "
@@ -326,17 +364,19 @@ RandomVariable BlackScholesBase::npv(const RandomVariable& amount, const Date& o
         }
     }
 
-    // compute conditional expectation and return the result
+    // compute conditional expectation and return the result, the basis values from the training are reused if available
+
+    if (basisValues.empty())
+        basisValues = multiPathBasisSystemValues(state, mcParams_.regressionOrder, mcParams_.polynomType,
+                                                 std::min(size(), trainingSamples()));
 
-    return conditionalExpectation(state,
-                                  multiPathBasisSystem(state.size(), mcParams_.regressionOrder, mcParams_.polynomType,
-                                                       std::min(size(), trainingSamples())),
-                                  coeff);
+    return conditionalExpectation(basisValues, coeff);
 }
 
 void BlackScholesBase::releaseMemory() {
     underlyingPaths_.clear();
     underlyingPathsTraining_.clear();
+    underlyingPathLogDerivatives_.clear();
 }
 
 void BlackScholesBase::resetNPVMem() { storedRegressionModel_.clear(); }
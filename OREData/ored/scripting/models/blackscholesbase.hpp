@@ -80,6 +80,9 @@ public:
     void toggleTrainingPaths() const override;
     Size trainingSamples() const override;
     Size size() const override;
+    /* pathwise sensitivity inputs are the spots Spot_<index> and parallel vol shifts Vol_<index> of all indices,
+       the derivatives are computed on the same variates by a central difference of simulated log paths */
+    std::vector<std::string> pathwiseSensitivityInputs() const override;
 
 protected:
     // ModelImpl interface implementation (except initiModelState, this is done in the derived classes)
@@ -90,6 +93,12 @@ protected:
     RandomVariable getDiscount(const Size idx, const Date& s, const Date& t) const override;
     RandomVariable getNumeraire(const Date& s) const override;
     Real getFxSpot(const Size idx) const override;
+    RandomVariable getIndexLogDerivative(const Size input, const Size indexNo, const Date& d) const override;
+
+    /* populate paths for all effective simulation dates with the spot of indices_[indexNo] shifted by spotShift and
+       its volatility shifted by volShift, using the same variates as for underlyingPaths_ */
+    virtual void populateBumpedPathValues(const Size indexNo, const Real spotShift, const Real volShift,
+                                          std::map<Date, std::vector<RandomVariable>>& paths) const = 0;
 
     // helper function that constructs the correlation matrix
     Matrix getCorrelation() const;
@@ -110,6 +119,7 @@ protected:
     mutable std::map<Date, std::vector<RandomVariable>> underlyingPaths_;         // per simulation date index states
     mutable std::map<Date, std::vector<RandomVariable>> underlyingPathsTraining_; // ditto (training phase)
     mutable bool inTrainingPhase_ = false; // are we currently using training paths?
+    mutable std::map<Size, std::map<Date, std::vector<RandomVariable>>> underlyingPathLogDerivatives_; // per input
 
     // stored regression coefficients
     mutable std::map<long, std::tuple<Array, Size, Matrix>> storedRegressionModel_;
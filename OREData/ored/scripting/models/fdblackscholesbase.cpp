@@ -48,11 +48,12 @@ FdBlackScholesBase::FdBlackScholesBase(const Size stateGridPoints, const std::st
                                        const IborFallbackConfig& iborFallbackConfig, const std::string& calibration,
                                        const std::vector<Real>& calibrationStrikes, const Real mesherEpsilon,
                                        const Real mesherScaling, const Real mesherConcentration,
-                                       const Size mesherMaxConcentratingPoints, const bool staticMesher)
+                                       const Size mesherMaxConcentratingPoints, const bool staticMesher,
+                                       const bool cacheStepOperators)
     : FdBlackScholesBase(stateGridPoints, {currency}, {curve}, {}, {}, {}, {index}, {indexCurrency}, {currency}, model,
                          {}, simulationDates, iborFallbackConfig, calibration, {{index, calibrationStrikes}},
                          mesherEpsilon, mesherScaling, mesherConcentration, mesherMaxConcentratingPoints,
-                         staticMesher) {}
+                         staticMesher, cacheStepOperators) {}
 
 FdBlackScholesBase::FdBlackScholesBase(
     const Size stateGridPoints, const std::vector<std::string>& currencies,
@@ -65,13 +66,14 @@ FdBlackScholesBase::FdBlackScholesBase(
     const std::set<Date>& simulationDates, const IborFallbackConfig& iborFallbackConfig, const std::string& calibration,
     const std::map<std::string, std::vector<Real>>& calibrationStrikes, const Real mesherEpsilon,
     const Real mesherScaling, const Real mesherConcentration, const Size mesherMaxConcentratingPoints,
-    const bool staticMesher)
+    const bool staticMesher, const bool cacheStepOperators)
     : ModelImpl(curves.at(0)->dayCounter(), stateGridPoints, currencies, irIndices, infIndices, indices,
                 indexCurrencies, simulationDates, iborFallbackConfig),
       curves_(curves), fxSpots_(fxSpots), payCcys_(payCcys), model_(model), correlations_(correlations),
       calibration_(calibration), calibrationStrikes_(calibrationStrikes), mesherEpsilon_(mesherEpsilon),
       mesherScaling_(mesherScaling), mesherConcentration_(mesherConcentration),
-      mesherMaxConcentratingPoints_(mesherMaxConcentratingPoints), staticMesher_(staticMesher) {
+      mesherMaxConcentratingPoints_(mesherMaxConcentratingPoints), staticMesher_(staticMesher),
+      cacheStepOperators_(cacheStepOperators) {
 
     // check inputs
 
@@ -173,6 +175,7 @@ const Date& FdBlackScholesBase::referenceDate() const {
 void FdBlackScholesBase::performCalculations() const {
 
     referenceDate_ = curves_.front()->referenceDate();
+    stepOperators_.clear();
 
     // 0a set up time grid
 
@@ -263,10 +266,7 @@ void FdBlackScholesBase::performCalculations() const {
         QuantLib::ext::make_shared<QuantExt::FdmBlackScholesOp>(mesher_, model_->processes()[0], calibrationStrikes[0], false,
                                                         -static_cast<Real>(Null<Real>()), 0, quantoHelper, false, true);
 
-    // 4 set up bwd solver, hardcoded Douglas scheme (= CrankNicholson)
-
-    solver_ = QuantLib::ext::make_shared<FdmBackwardSolver>(
-        operator_, std::vector<QuantLib::ext::shared_ptr<BoundaryCondition<FdmLinearOp>>>(), nullptr, FdmSchemeDesc::Douglas());
+    // 4 the bwd steps use the hardcoded Douglas scheme (= CrankNicholson), see rollbackStep()
 
     // 5 fill random variable with underlying values, these are valid for all times
 
@@ -404,54 +404,184 @@ RandomVariable FdBlackScholesBase::npv(const RandomVariable& amount, const Date&
     QL_REQUIRE(!addRegressor1.initialised(), "FdBlackScholesBase::npv(). addRegressor1 not allowed");
     QL_REQUIRE(!addRegressor2.initialised(), "FdBlackScholesBase::npv(). addRegressor2 not allowed");
 
+    return npv(std::vector<RandomVariable>{amount}, obsdate).front();
+}
+
+std::vector<RandomVariable> FdBlackScholesBase::npv(const std::vector<RandomVariable>& amounts,
+                                                    const Date& obsdate) const {
+
     calculate();
 
-    Real t1 = amount.time();
     Real t0 = timeFromReference(obsdate);
+    Size ind0 = Null<Size>();
+
+    std::vector<RandomVariable> result(amounts.size());
+    std::vector<Size> ind1(amounts.size(), Null<Size>());
+    Size maxInd1 = 0;
+
+    for (Size i = 0; i < amounts.size(); ++i) {
+
+        const RandomVariable& amount = amounts[i];
+        Real t1 = amount.time();
+
+        // handle case when amount is deterministic
+
+        if (amount.deterministic()) {
+            result[i] = amount;
+            result[i].setTime(t0);
+            continue;
+        }
+
+        // handle stochastic amount
+
+        QL_REQUIRE(t1 != Null<Real>(),
+                   "FdBlackScholesBase::npv(): can not roll back amount wiithout time attached (to t0=" << t0 << ")");
+
+        // might throw if t0, t1 are not found in timeGrid_
+
+        if (ind0 == Null<Size>())
+            ind0 = timeGrid_.index(t0);
+        ind1[i] = timeGrid_.index(t1);
+
+        // check t0 <= t1, i.e. ind0 <= ind1
+
+        QL_REQUIRE(ind0 <= ind1[i], "FdBlackScholesBase::npv(): can not roll back from t1= "
+                                        << t1 << " (index " << ind1[i] << ") to t0= " << t0 << " (" << ind0 << ")");
+
+        // if t0 = t1, no rollback is necessary and we can return the input random variable
+
+        if (ind0 == ind1[i]) {
+            result[i] = amount;
+            ind1[i] = Null<Size>();
+            continue;
+        }
+
+        maxInd1 = std::max(maxInd1, ind1[i]);
+    }
 
-    // handle case when amount is deterministic
+    // if t0 < t1, we roll back on the time grid, an amount joins the rollback when its time index is reached
 
-    if (amount.deterministic()) {
-        RandomVariable result(amount);
-        result.setTime(t0);
+    if (maxInd1 == 0)
         return result;
+
+    std::vector<Array> workingArrays(amounts.size());
+    std::vector<Size> active;
+
+    for (int j = static_cast<int>(maxInd1) - 1; j >= static_cast<int>(ind0); --j) {
+        for (Size i = 0; i < amounts.size(); ++i) {
+            if (ind1[i] == static_cast<Size>(j + 1)) {
+                workingArrays[i] = Array(amounts[i].size());
+                amounts[i].copyToArray(workingArrays[i]);
+                active.push_back(i);
+            }
+        }
+        rollbackStep(workingArrays, active, j);
     }
 
-    // handle stochastic amount
+    // return the rolled back values
 
-    QL_REQUIRE(t1 != Null<Real>(),
-               "FdBlackScholesBase::npv(): can not roll back amount wiithout time attached (to t0=" << t0 << ")");
+    for (auto i : active)
+        result[i] = RandomVariable(workingArrays[i], t0);
 
-    // might throw if t0, t1 are not found in timeGrid_
+    return result;
+}
+
+const FdBlackScholesBase::StepOperator& FdBlackScholesBase::stepOperator(const Size j) const {
+
+    if (stepOperators_.size() != timeGrid_.size() - 1)
+        stepOperators_.resize(timeGrid_.size() - 1);
 
-    Size ind1 = timeGrid_.index(t1);
-    Size ind0 = timeGrid_.index(t0);
+    StepOperator& op = stepOperators_[j];
+    if (!op.explicitDiag.empty())
+        return op;
 
-    // check t0 <= t1, i.e. ind0 <= ind1
+    // extract the bands of the tridiagonal operator by applying it to the vectors that are 1 on each third point
 
-    QL_REQUIRE(ind0 <= ind1, "FdBlackScholesBase::npv(): can not roll back from t1= "
-                                 << t1 << " (index " << ind1 << ") to t0= " << t0 << " (" << ind0 << ")");
+    Size n = size();
+    Real dt = timeGrid_[j + 1] - timeGrid_[j];
+    Real theta = FdmSchemeDesc::Douglas().theta;
 
-    // if t0 = t1, no rollback is necessary and we can return the input random variable
+    operator_->setTime(timeGrid_[j], timeGrid_[j + 1]);
+    std::vector<Array> probes(3, Array(n, 0.0));
+    for (Size i = 0; i < n; ++i)
+        probes[i % 3][i] = 1.0;
+    for (auto& p : probes)
+        p = operator_->apply(p);
+
+    Array lower(n, 0.0), diag(n), upper(n, 0.0);
+    for (Size i = 0; i < n; ++i) {
+        if (i > 0)
+            lower[i] = probes[(i - 1) % 3][i];
+        diag[i] = probes[i % 3][i];
+        if (i < n - 1)
+            upper[i] = probes[(i + 1) % 3][i];
+    }
 
-    if (ind0 == ind1)
-        return amount;
+    // explicit part I + (1-theta) dt L
 
-    // if t0 < t1, we roll back on the time grid
+    op.explicitLower = (1.0 - theta) * dt * lower;
+    op.explicitDiag = 1.0 + (1.0 - theta) * dt * diag;
+    op.explicitUpper = (1.0 - theta) * dt * upper;
 
-    Array workingArray(amount.size());
-    amount.copyToArray(workingArray);
+    // LU factorisation of the implicit part I - theta dt L (Thomas algorithm)
 
-    for (int j = static_cast<int>(ind1) - 1; j >= static_cast<int>(ind0); --j) {
-        solver_->rollback(workingArray, timeGrid_[j + 1], timeGrid_[j], 1, 0);
+    op.implicitLower = -theta * dt * lower;
+    op.implicitUpperFactor = Array(n);
+    op.implicitInversePivot = Array(n);
+    for (Size i = 0; i < n; ++i) {
+        Real pivot = 1.0 - theta * dt * diag[i] - (i > 0 ? op.implicitLower[i] * op.implicitUpperFactor[i - 1] : 0.0);
+        QL_REQUIRE(!QuantLib::close_enough(pivot, 0.0),
+                   "FdBlackScholesBase::stepOperator(): zero pivot in time step " << j << ", row " << i);
+        op.implicitInversePivot[i] = 1.0 / pivot;
+        op.implicitUpperFactor[i] = -theta * dt * upper[i] * op.implicitInversePivot[i];
     }
 
-    // return the rolled back value
+    return op;
+}
+
+void FdBlackScholesBase::rollbackStep(std::vector<Array>& values, const std::vector<Size>& active,
+                                      const Size j) const {
+
+    Real dt = timeGrid_[j + 1] - timeGrid_[j];
+    Real theta = FdmSchemeDesc::Douglas().theta;
+
+    // without cached operators we set up the operator once per step for all values, the step itself is identical
+    // to the one of the QuantLib Douglas scheme
+
+    if (!cacheStepOperators_ || size() < 3) {
+        operator_->setTime(timeGrid_[j], timeGrid_[j + 1]);
+        for (auto i : active) {
+            Array la = operator_->apply(values[i]);
+            Array y = values[i] + dt * la;
+            Array rhs = y - theta * dt * la;
+            values[i] = operator_->solve_splitting(0, rhs, -theta * dt);
+        }
+        return;
+    }
 
-    return RandomVariable(workingArray, t0);
+    // with cached operators we apply the explicit part and solve the implicit part using the stored factorisation
+
+    const StepOperator& op = stepOperator(j);
+    Size n = size();
+    Array y(n);
+    for (auto i : active) {
+        Array& u = values[i];
+        for (Size k = 0; k < n; ++k) {
+            y[k] = op.explicitDiag[k] * u[k];
+            if (k > 0)
+                y[k] += op.explicitLower[k] * u[k - 1];
+            if (k < n - 1)
+                y[k] += op.explicitUpper[k] * u[k + 1];
+        }
+        u[0] = y[0] * op.implicitInversePivot[0];
+        for (Size k = 1; k < n; ++k)
+            u[k] = (y[k] - op.implicitLower[k] * u[k - 1]) * op.implicitInversePivot[k];
+        for (Size k = n - 1; k > 0; --k)
+            u[k - 1] -= op.implicitUpperFactor[k - 1] * u[k];
+    }
 }
 
-void FdBlackScholesBase::releaseMemory() {}
+void FdBlackScholesBase::releaseMemory() { stepOperators_.clear(); }
 
 RandomVariable FdBlackScholesBase::getFutureBarrierProb(const std::string& index, const Date& obsdate1,
                                                         const Date& obsdate2, const RandomVariable& barrier,
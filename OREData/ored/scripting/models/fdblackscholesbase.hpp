@@ -48,6 +48,9 @@ public:
        - instead we have a stateGridPoints parameter and additional fd specific parameters
        - if staticMesher is true, the mesh will be held constant after its initial construction, this
          is important to get stable sensitivities
+       - if cacheStepOperators is true, the operators of the time steps on the FD time grid are set up and
+         factorised once and then reused for all rollbacks until the model is recalculated, this saves the operator
+         set up and the elimination part of the tridiagonal solves for scripts with many NPV() calls
     */
     FdBlackScholesBase(
         const Size stateGridPoints, const std::vector<std::string>& currencies,
@@ -60,7 +63,8 @@ public:
         const std::set<Date>& simulationDates, const IborFallbackConfig& iborFallbackConfig,
         const std::string& calibration, const std::map<std::string, std::vector<Real>>& calibrationStrikes = {},
         const Real mesherEpsilon = 1E-4, const Real mesherScaling = 1.5, const Real mesherConcentration = 0.1,
-        const Size mesherMaxConcentratingPoints = 9999, const bool staticMesher = false);
+        const Size mesherMaxConcentratingPoints = 9999, const bool staticMesher = false,
+        const bool cacheStepOperators = false);
 
     // ctor for single underlying
     FdBlackScholesBase(const Size stateGridPoints, const std::string& currency, const Handle<YieldTermStructure>& curve,
@@ -69,7 +73,8 @@ public:
                        const IborFallbackConfig& iborFallbackConfig, const std::string& calibration,
                        const std::vector<Real>& calibrationStrikes = {}, const Real mesherEpsilon = 1E-4,
                        const Real mesherScaling = 1.5, const Real mesherConcentration = 0.1,
-                       const Size mesherMaxConcentratingPoints = 9999, const bool staticMesher = false);
+                       const Size mesherMaxConcentratingPoints = 9999, const bool staticMesher = false,
+        const bool cacheStepOperators = false);
 
     // Model interface implementation
     Type type() const override { return Type::FD; }
@@ -77,6 +82,10 @@ public:
     RandomVariable npv(const RandomVariable& amount, const Date& obsdate, const Filter& filter,
                        const boost::optional<long>& memSlot, const RandomVariable& addRegressor1,
                        const RandomVariable& addRegressor2) const override;
+    /* Roll back several amounts to obsdate at once, the result is the same as calling npv() for each of the
+       amounts. The amounts are rolled back together through each time step, so that the step operator is set up
+       once for all amounts. */
+    std::vector<RandomVariable> npv(const std::vector<RandomVariable>& amounts, const Date& obsdate) const;
     RandomVariable fwdCompAvg(const bool isAvg, const std::string& index, const Date& obsdate, const Date& start,
                               const Date& end, const Real spread, const Real gearing, const Integer lookback,
                               const Natural rateCutoff, const Natural fixingDays, const bool includeSpread,
@@ -105,6 +114,17 @@ protected:
     // helper function that constructs the correlation matrix
     Matrix getCorrelation() const;
 
+    /* the Douglas step from time index j + 1 to j on the time grid, u_j = (I - theta dt L)^{-1} (I + (1-theta) dt L)
+       u_{j+1}, with the explicit part as a tridiagonal matrix and the implicit part as its LU factorisation */
+    struct StepOperator {
+        Array explicitLower, explicitDiag, explicitUpper;
+        Array implicitLower, implicitUpperFactor, implicitInversePivot;
+    };
+    const StepOperator& stepOperator(const Size j) const;
+
+    // roll back the values with the given indices from time index j + 1 to j
+    void rollbackStep(std::vector<Array>& values, const std::vector<Size>& active, const Size j) const;
+
     // input parameters
     const std::vector<Handle<YieldTermStructure>> curves_;
     const std::vector<Handle<Quote>> fxSpots_;
@@ -117,6 +137,7 @@ protected:
     const Real mesherEpsilon_, mesherScaling_, mesherConcentration_;
     const Size mesherMaxConcentratingPoints_;
     const bool staticMesher_;
+    const bool cacheStepOperators_;
 
     // quanto adjustment parameters
     bool applyQuantoAdjustment_ = false;
@@ -131,7 +152,7 @@ protected:
     mutable std::vector<Size> positionInTimeGrid_;    // for each effective simulation date the index in the time grid
     mutable QuantLib::ext::shared_ptr<FdmMesher> mesher_;     // the mesher for the FD solver
     mutable QuantLib::ext::shared_ptr<FdmLinearOpComposite> operator_; // the operator
-    mutable QuantLib::ext::shared_ptr<FdmBackwardSolver> solver_;      // the sovler
+    mutable std::vector<StepOperator> stepOperators_;                   // the cached step operators (if enabled)
     mutable RandomVariable underlyingValues_;                  // the discretised underlying
 };
 
@@ -20,6 +20,7 @@
 #include <qle/models/infdkvectorised.hpp>
 
 #include <qle/math/randomvariablelsmbasissystem.hpp>
+#include <qle/methods/multipathgeneratorbatched.hpp>
 #include <qle/methods/multipathvariategenerator.hpp>
 
 #include <ored/utilities/indexparser.hpp>
@@ -312,21 +313,47 @@ void GaussianCam::populatePathValues(const Size nSamples, std::map<Date, std::ve
 
         if (injectedPathTimes_ == nullptr) {
 
-            // the usual path generator
+            auto camProcess = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process);
+
+            if (camProcess && camProcess->hasAffineStep()) {
+
+                // evolve the paths in batches, all paths of a batch one time step at a time
+
+                CrossAssetStateBatchEvolver evolver(camProcess, timeGrid_);
+                auto gen = makeMultiPathVariateGenerator(
+                    isTraining ? mcParams_.trainingSequenceType : mcParams_.sequenceType, process->factors(),
+                    timeGrid_.size() - 1, isTraining ? mcParams_.trainingSeed : mcParams_.seed,
+                    mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers);
+                constexpr Size batchSize = 1024;
+                for (Size offset = 0; offset < nSamples; offset += batchSize) {
+                    Size n = std::min(batchSize, nSamples - offset);
+                    evolver.evolve(*gen, n);
+                    for (Size j = 0; j < effectiveSimulationDates_.size() - 1; ++j) {
+                        const Real* state = evolver.state(positionInTimeGrid_[j + 1]);
+                        for (Size k = 0; k < process->size(); ++k) {
+                            std::copy(state + k * n, state + (k + 1) * n, pathValues[j][k].begin() + offset);
+                        }
+                    }
+                }
 
-            if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
-                tmp->resetCache(timeGrid_.size() - 1);
-            }
+            } else {
 
-            auto pathGen =
-                makeMultiPathGenerator(isTraining ? mcParams_.trainingSequenceType : mcParams_.sequenceType, process,
-                                       timeGrid_, isTraining ? mcParams_.trainingSeed : mcParams_.seed,
-                                       mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers);
-            for (Size i = 0; i < nSamples; ++i) {
-                MultiPath path = pathGen->next().value;
-                for (Size j = 0; j < effectiveSimulationDates_.size() - 1; ++j) {
-                    for (Size k = 0; k < process->size(); ++k) {
-                        pathValues[j][k][i] = path[k][positionInTimeGrid_[j + 1]];
+                // the usual path generator
+
+                if (camProcess) {
+                    camProcess->resetCache(timeGrid_.size() - 1);
+                }
+
+                auto pathGen = makeMultiPathGenerator(
+                    isTraining ? mcParams_.trainingSequenceType : mcParams_.sequenceType, process, timeGrid_,
+                    isTraining ? mcParams_.trainingSeed : mcParams_.seed, mcParams_.sobolOrdering,
+                    mcParams_.sobolDirectionIntegers);
+                for (Size i = 0; i < nSamples; ++i) {
+                    MultiPath path = pathGen->next().value;
+                    for (Size j = 0; j < effectiveSimulationDates_.size() - 1; ++j) {
+                        for (Size k = 0; k < process->size(); ++k) {
+                            pathValues[j][k][i] = path[k][positionInTimeGrid_[j + 1]];
+                        }
                     }
                 }
             }
@@ -652,6 +679,7 @@ RandomVariable GaussianCam::npv(const RandomVariable& amount, const Date& obsdat
     // if we do not have retrieved a model in the previous step, we create it now
 
     std::vector<RandomVariable> transformedState;
+    std::vector<RandomVariable> basisValues;
 
     if(!haveStoredModel) {
 
@@ -665,10 +693,9 @@ RandomVariable GaussianCam::npv(const RandomVariable& amount, const Date& obsdat
 
         // train coefficients
 
-        coeff = regressionCoefficients(amount, state,
-                                       multiPathBasisSystem(state.size(), mcParams_.regressionOrder,
-                                                            mcParams_.polynomType, std::min(size(), trainingSamples())),
-                                       filter, RandomVariableRegressionMethod::QR);
+        basisValues = multiPathBasisSystemValues(state, mcParams_.regressionOrder, mcParams_.polynomType,
+                                                 std::min(size(), trainingSamples()));
+        coeff = regressionCoefficients(amount, basisValues, filter, RandomVariableRegressionMethod::QR);
         DLOG("GaussianCam::npv(" << ore::data::to_string(obsdate) << "): regression coefficients are " << coeff
                                  << " (got model state size " << nModelStates << " and " << nAddReg
                                  << " additional regressors, coordinate transform " << coordinateTransform.columns()
@@ -690,12 +717,13 @@ RandomVariable GaussianCam::npv(const RandomVariable& amount, const Date& obsdat
         }
     }
 
-    // compute conditional expectation and return the result
+    // compute conditional expectation and return the result, the basis values from the training are reused if available
+
+    if (basisValues.empty())
+        basisValues = multiPathBasisSystemValues(state, mcParams_.regressionOrder, mcParams_.polynomType,
+                                                 std::min(size(), trainingSamples()));
 
-    return conditionalExpectation(state,
-                                  multiPathBasisSystem(state.size(), mcParams_.regressionOrder, mcParams_.polynomType,
-                                                       std::min(size(), trainingSamples())),
-                                  coeff);
+    return conditionalExpectation(basisValues, coeff);
 }
 
 void GaussianCam::toggleTrainingPaths() const {
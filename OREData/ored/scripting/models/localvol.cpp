@@ -70,7 +70,7 @@ void LocalVol::performCalculations() const {
 
     // compile the correlation matrix
 
-    Matrix correlation = getCorrelation();
+    correlation_ = getCorrelation();
 
     // set reference date values, if there are no future simulation dates we are done
 
@@ -86,17 +86,17 @@ void LocalVol::performCalculations() const {
 
     // compute the sqrt correlation
 
-    Matrix sqrtCorr = pseudoSqrt(correlation, SalvagingAlgorithm::Spectral);
+    sqrtCorr_ = pseudoSqrt(correlation_, SalvagingAlgorithm::Spectral);
 
     // precompute the deterministic part of the drift on each time step
 
-    std::vector<Array> deterministicDrift(timeGrid_.size() - 1, Array(indices_.size(), 0.0));
+    deterministicDrift_ = std::vector<Array>(timeGrid_.size() - 1, Array(indices_.size(), 0.0));
 
     for (Size i = 0; i < timeGrid_.size() - 1; ++i) {
         for (Size j = 0; j < indices_.size(); ++j) {
             Real t0 = timeGrid_[i];
             Real t1 = timeGrid_[i + 1];
-            deterministicDrift[i][j] = -std::log(model_->processes()[j]->riskFreeRate()->discount(t1) /
+            deterministicDrift_[i][j] = -std::log(model_->processes()[j]->riskFreeRate()->discount(t1) /
                                                  model_->processes()[j]->dividendYield()->discount(t1) /
                                                  (model_->processes()[j]->riskFreeRate()->discount(t0) /
                                                   model_->processes()[j]->dividendYield()->discount(t0)));
@@ -105,7 +105,7 @@ void LocalVol::performCalculations() const {
 
     // precompute index for drift adjustment for eq / com indices that are not in base ccy
 
-    std::vector<Size> eqComIdx(indices_.size());
+    eqComIdx_ = std::vector<Size>(indices_.size());
     for (Size j = 0; j < indices_.size(); ++j) {
         Size idx = Null<Size>();
         if (!indices_[j].isFx()) {
@@ -117,46 +117,49 @@ void LocalVol::performCalculations() const {
                 }
             }
         }
-        eqComIdx[j] = idx;
+        eqComIdx_[j] = idx;
     }
 
     // precompute some time related quantities
 
-    std::vector<Real> t(timeGrid_.size() - 1), dt(timeGrid_.size() - 1), sqrtdt(timeGrid_.size() - 1);
+    t_ = std::vector<Real>(timeGrid_.size() - 1);
+    dt_ = std::vector<Real>(timeGrid_.size() - 1);
+    sqrtdt_ = std::vector<Real>(timeGrid_.size() - 1);
     for (Size i = 0; i < timeGrid_.size() - 1; ++i) {
-        t[i] = timeGrid_[i];
-        dt[i] = timeGrid_[i + 1] - timeGrid_[i];
-        sqrtdt[i] = std::sqrt(dt[i]);
+        t_[i] = timeGrid_[i];
+        dt_[i] = timeGrid_[i + 1] - timeGrid_[i];
+        sqrtdt_[i] = std::sqrt(dt_[i]);
     }
 
+    Array x0(indices_.size());
+    for (Size j = 0; j < indices_.size(); ++j)
+        x0[j] = model_->processes()[j]->x0();
+
     // evolve the process using correlated normal variates and set the underlying path values
 
     populatePathValues(size(), underlyingPaths_,
                        makeMultiPathVariateGenerator(mcParams_.sequenceType, indices_.size(), timeGrid_.size() - 1,
                                                      mcParams_.seed, mcParams_.sobolOrdering,
                                                      mcParams_.sobolDirectionIntegers),
-                       correlation, sqrtCorr, deterministicDrift, eqComIdx, t, dt, sqrtdt);
+                       x0);
 
     if (trainingSamples() != Null<Size>()) {
         populatePathValues(trainingSamples(), underlyingPathsTraining_,
                            makeMultiPathVariateGenerator(mcParams_.trainingSequenceType, indices_.size(),
                                                          timeGrid_.size() - 1, mcParams_.trainingSeed,
                                                          mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers),
-                           correlation, sqrtCorr, deterministicDrift, eqComIdx, t, dt, sqrtdt);
+                           x0);
     }
 
 } // initPaths()
 
 void LocalVol::populatePathValues(const Size nSamples, std::map<Date, std::vector<RandomVariable>>& paths,
                                   const QuantLib::ext::shared_ptr<MultiPathVariateGeneratorBase>& gen,
-                                  const Matrix& correlation, const Matrix& sqrtCorr,
-                                  const std::vector<Array>& deterministicDrift, const std::vector<Size>& eqComIdx,
-                                  const std::vector<Real>& t, const std::vector<Real>& dt,
-                                  const std::vector<Real>& sqrtdt) const {
+                                  const Array& x0, const Size shiftedIndex, const Real volShift) const {
 
     Array stateDiff(indices_.size()), logState(indices_.size()), logState0(indices_.size());
     for (Size j = 0; j < indices_.size(); ++j) {
-        logState0[j] = std::log(model_->processes()[j]->x0());
+        logState0[j] = std::log(x0[j]);
     }
 
     std::vector<std::vector<RandomVariable*>> rvs(indices_.size(),
@@ -183,25 +186,29 @@ void LocalVol::populatePathValues(const Size nSamples, std::map<Date, std::vecto
                 // by setting the local vol to zero
                 Real volj = 0.0;
                 try {
-                    volj = model_->processes()[j]->localVolatility()->localVol(t[i], std::exp(logState[j]));
+                    volj = model_->processes()[j]->localVolatility()->localVol(t_[i], std::exp(logState[j]));
                 } catch (...) {
                 }
                 if (!std::isfinite(volj))
                     volj = 0.0;
+                if (j == shiftedIndex)
+                    volj += volShift;
                 Real dw = 0;
                 for (Size k = 0; k < indices_.size(); ++k) {
-                    dw += sqrtCorr[j][k] * p.value[i][k];
+                    dw += sqrtCorr_[j][k] * p.value[i][k];
                 }
-                stateDiff[j] = volj * dw * sqrtdt[i] - 0.5 * volj * volj * dt[i];
+                stateDiff[j] = volj * dw * sqrtdt_[i] - 0.5 * volj * volj * dt_[i];
                 // drift adjustment for eq / com indices that are not in base ccy
-                if (eqComIdx[j] != Null<Size>()) {
-                    Real volIdx = model_->processes()[eqComIdx[j]]->localVolatility()->localVol(
-                        t[i], std::exp(logState[eqComIdx[j]]));
-                    stateDiff[j] -= correlation[eqComIdx[j]][j] * volIdx * volj * dt[i];
+                if (eqComIdx_[j] != Null<Size>()) {
+                    Real volIdx = model_->processes()[eqComIdx_[j]]->localVolatility()->localVol(
+                        t_[i], std::exp(logState[eqComIdx_[j]]));
+                    if (eqComIdx_[j] == shiftedIndex)
+                        volIdx += volShift;
+                    stateDiff[j] -= correlation_[eqComIdx_[j]][j] * volIdx * volj * dt_[i];
                 }
             }
             // update state with stateDiff from above and deterministic part of the drift
-            logState += stateDiff + deterministicDrift[i];
+            logState += stateDiff + deterministicDrift_[i];
             // on the effective simulation dates populate the underlying paths
             if (i + 1 == *pos) {
                 for (Size j = 0; j < indices_.size(); ++j)
@@ -213,6 +220,31 @@ void LocalVol::populatePathValues(const Size nSamples, std::map<Date, std::vecto
     }
 } // populatePathValues()
 
+void LocalVol::populateBumpedPathValues(const Size indexNo, const Real spotShift, const Real volShift,
+                                        std::map<Date, std::vector<RandomVariable>>& paths) const {
+
+    Array x0(indices_.size());
+    for (Size j = 0; j < indices_.size(); ++j)
+        x0[j] = model_->processes()[j]->x0();
+    x0[indexNo] += spotShift;
+
+    for (auto const& d : effectiveSimulationDates_)
+        paths[d] = std::vector<RandomVariable>(indices_.size(), RandomVariable(size(), 0.0));
+    for (Size l = 0; l < indices_.size(); ++l)
+        paths[*effectiveSimulationDates_.begin()][l].setAll(x0[l]);
+
+    if (effectiveSimulationDates_.size() == 1)
+        return;
+
+    // use the same variates as for the underlying paths
+
+    populatePathValues(size(), paths,
+                       makeMultiPathVariateGenerator(mcParams_.sequenceType, indices_.size(), timeGrid_.size() - 1,
+                                                     mcParams_.seed, mcParams_.sobolOrdering,
+                                                     mcParams_.sobolDirectionIntegers),
+                       x0, indexNo, volShift);
+}
+
 RandomVariable LocalVol::getFutureBarrierProb(const std::string& index, const Date& obsdate1, const Date& obsdate2,
                                               const RandomVariable& barrier, const bool above) const {
     QL_FAIL("getFutureBarrierProb not implemented by LocalVol");
@@ -62,13 +62,20 @@ private:
 
     // BlackScholesBase interface implementation
     void performCalculations() const override;
+    void populateBumpedPathValues(const Size indexNo, const Real spotShift, const Real volShift,
+                                  std::map<Date, std::vector<RandomVariable>>& paths) const override;
 
-    // helper method to populate path values
+    /* helper method to populate path values, if shiftedIndex is given, the local vols of this index are shifted by
+       volShift (used for pathwise vegas) */
     void populatePathValues(const Size nSamples, std::map<Date, std::vector<RandomVariable>>& paths,
-                            const QuantLib::ext::shared_ptr<MultiPathVariateGeneratorBase>& gen, const Matrix& correlation,
-                            const Matrix& sqrtCorr, const std::vector<Array>& deterministicDrift,
-                            const std::vector<Size>& eqComIdx, const std::vector<Real>& t, const std::vector<Real>& dt,
-                            const std::vector<Real>& sqrtdt) const;
+                            const QuantLib::ext::shared_ptr<MultiPathVariateGeneratorBase>& gen, const Array& x0,
+                            const Size shiftedIndex = Null<Size>(), const Real volShift = 0.0) const;
+
+    // quantities used to evolve the process, set in performCalculations()
+    mutable Matrix correlation_, sqrtCorr_;
+    mutable std::vector<Array> deterministicDrift_;
+    mutable std::vector<Size> eqComIdx_;
+    mutable std::vector<Real> t_, dt_, sqrtdt_;
 };
 
 } // namespace data
@@ -59,6 +59,8 @@ public:
         QuantLib::SobolBrownianGenerator::Ordering sobolOrdering = QuantLib::SobolBrownianGenerator::Steps;
         QuantLib::SobolRsg::DirectionIntegers sobolDirectionIntegers = QuantLib::SobolRsg::DirectionIntegers::JoeKuoD7;
         QuantLib::Real regressionVarianceCutoff = Null<QuantLib::Real>();
+        // share simulated paths with other models via the PathCache (if supported by the model)
+        bool usePathCache = false;
     };
 
     explicit Model(const Size n) : n_(n) {}
@@ -145,6 +147,20 @@ public:
     // additional results provided by the model
     const std::map<std::string, boost::any>& additionalResults() const { return additionalResults_; }
 
+    /* Pathwise sensitivities: the model inputs w.r.t. which pathwise derivatives of eval() and pay() are provided,
+       empty if the model does not support pathwise sensitivities. The derivatives are taken w.r.t. the i-th input
+       on the same paths (i.e. the same random variates) as the values returned by eval() resp. pay(). For pay() the
+       amount is held fixed, i.e. only the derivative of the conversion to the base ccy and the deflation is given. */
+    virtual std::vector<std::string> pathwiseSensitivityInputs() const { return {}; }
+    virtual RandomVariable evalDerivative(const Size input, const std::string& index, const Date& obsdate,
+                                          const Date& fwddate, const bool ignoreTodaysFixing = false) const {
+        QL_FAIL("pathwise sensitivities are not supported by this model");
+    }
+    virtual RandomVariable payDerivative(const Size input, const RandomVariable& amount, const Date& obsdate,
+                                         const Date& paydate, const std::string& currency) const {
+        QL_FAIL("pathwise sensitivities are not supported by this model");
+    }
+
 protected:
     // default implementation lazy object interface
     void performCalculations() const override {}
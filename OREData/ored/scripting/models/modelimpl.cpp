@@ -333,6 +333,70 @@ RandomVariable ModelImpl::eval(const std::string& indexInput, const Date& obsdat
     return res;
 }
 
+RandomVariable ModelImpl::evalDerivative(const Size input, const std::string& indexInput, const Date& obsdate,
+                                         const Date& fwddate, const bool ignoreTodaysFixing) const {
+    calculate();
+
+    IndexInfo indexInfo(indexInput);
+    RandomVariable zero(size(), 0.0);
+
+    // ir and inflation indices do not depend on the inputs, neither do historical fixings
+
+    if (indexInfo.isInf() || indexInfo.isIr() || obsdate < referenceDate())
+        return zero;
+
+    if (fwddate == Null<Date>() && obsdate == referenceDate() && !ignoreTodaysFixing) {
+        QuantLib::ext::shared_ptr<Index> idx = indexInfo.index(obsdate);
+        Real fixing = Null<Real>();
+        try {
+            fixing = idx->fixing(idx->fixingCalendar().adjust(obsdate, Preceding));
+        } catch (...) {
+        }
+        if (fixing != Null<Real>())
+            return zero;
+    }
+
+    // FX, EQ, COMM indices: the forwarding factors are deterministic, so we only need the log derivative of the
+    // underlying index values, see eval() for the treatment of fx indices that are not directly modelled
+
+    RandomVariable value = eval(indexInput, obsdate, fwddate, false, ignoreTodaysFixing);
+
+    if (indexInfo.isFx())
+        indexInfo = IndexInfo("FX-GENERIC-" + indexInfo.fx()->sourceCurrency().code() + "-" +
+                              indexInfo.fx()->targetCurrency().code());
+
+    auto i = std::find(indices_.begin(), indices_.end(), indexInfo);
+    if (i != indices_.end())
+        return value * getIndexLogDerivative(input, std::distance(indices_.begin(), i), obsdate);
+
+    QL_REQUIRE(indexInfo.isFx(), "ModelImpl::evalDerivative(): index " << indexInput << " not handled");
+    RandomVariable logDerivative = zero;
+    for (Size i = 0; i < indexCurrencies_.size(); ++i) {
+        if (indices_[i].isFx()) {
+            if (indexInfo.fx()->sourceCurrency().code() == indexCurrencies_[i])
+                logDerivative += getIndexLogDerivative(input, i, obsdate);
+            if (indexInfo.fx()->targetCurrency().code() == indexCurrencies_[i])
+                logDerivative -= getIndexLogDerivative(input, i, obsdate);
+        }
+    }
+    return value * logDerivative;
+}
+
+RandomVariable ModelImpl::payDerivative(const Size input, const RandomVariable& amount, const Date& obsdate,
+                                        const Date& paydate, const std::string& currency) const {
+    calculate();
+
+    // only the conversion with a dynamic fx underlying depends on the inputs, see pay()
+
+    Date effectiveDate = std::max(obsdate, referenceDate());
+    for (Size i = 0; i < indexCurrencies_.size(); ++i) {
+        if (indices_.at(i).isFx() && currency == indexCurrencies_[i]) {
+            return pay(amount, obsdate, paydate, currency) * getIndexLogDerivative(input, i, effectiveDate);
+        }
+    }
+    return RandomVariable(size(), 0.0);
+}
+
 Real ModelImpl::fxSpotT0(const std::string& forCcy, const std::string& domCcy) const {
     auto c1 = std::find(currencies_.begin(), currencies_.end(), forCcy);
     auto c2 = std::find(currencies_.begin(), currencies_.end(), domCcy);
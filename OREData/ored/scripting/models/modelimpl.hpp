@@ -82,6 +82,11 @@ public:
                                       const RandomVariable& barrier, const bool above) const override;
     // provide default implementation for MC type models (taking a simple expectation)
     Real extractT0Result(const RandomVariable& value) const override;
+    // pathwise derivatives based on getIndexLogDerivative(), see below
+    RandomVariable evalDerivative(const Size input, const std::string& index, const Date& obsdate,
+                                  const Date& fwddate, const bool ignoreTodaysFixing = false) const override;
+    RandomVariable payDerivative(const Size input, const RandomVariable& amount, const Date& obsdate,
+                                 const Date& paydate, const std::string& currency) const override;
     //
 
 protected:
@@ -102,6 +107,11 @@ protected:
     // get barrier probability for refDate <= obsdate1 <= obsdate2, the case obsdate1 < refDate is handled in this class
     virtual RandomVariable getFutureBarrierProb(const std::string& index, const Date& obsdate1, const Date& obsdate2,
                                                 const RandomVariable& barrier, const bool above) const = 0;
+    /* get the pathwise derivative of the log of the (non-ir) index value for index[indexNo] at d >= reference date
+       w.r.t. the pathwise sensitivity input no. input, only required if pathwiseSensitivityInputs() is not empty */
+    virtual RandomVariable getIndexLogDerivative(const Size input, const Size indexNo, const Date& d) const {
+        QL_FAIL("getIndexLogDerivative() not implemented by this model");
+    }
 
     const DayCounter dayCounter_;
     const std::vector<std::string> currencies_;
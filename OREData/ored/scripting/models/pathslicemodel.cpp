@@ -0,0 +1,218 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/scripting/models/pathslicemodel.hpp>
+#include <ored/scripting/utilities.hpp>
+
+namespace ore {
+namespace data {
+
+PathSliceModel::Slices::Slices(const QuantLib::ext::shared_ptr<Model>& model, const Size nSlices)
+    : model_(model), owner_(std::this_thread::get_id()) {
+    QL_REQUIRE(model_ != nullptr, "PathSliceModel::Slices: no underlying model given");
+    QL_REQUIRE(model_->type() == Model::Type::MC, "PathSliceModel::Slices: underlying model must be of type MC");
+    QL_REQUIRE(nSlices > 0 && nSlices <= model_->size(), "PathSliceModel::Slices: number of slices ("
+                                                             << nSlices << ") must be positive and not exceed the "
+                                                             << "model size (" << model_->size() << ")");
+    referenceDate_ = model_->referenceDate();
+    baseCcy_ = model_->baseCcy();
+    Size n = model_->size();
+    for (Size i = 0; i < nSlices; ++i) {
+        Size offset = i * n / nSlices;
+        slices_.push_back(QuantLib::ext::shared_ptr<PathSliceModel>(
+            new PathSliceModel(this, offset, (i + 1) * n / nSlices - offset)));
+    }
+}
+
+void PathSliceModel::Slices::run(const std::function<void(Size)>& f) {
+    QL_REQUIRE(std::this_thread::get_id() == owner_,
+               "PathSliceModel::Slices::run(): must be called from the thread that created the slices");
+    Size running = slices_.size();
+    std::exception_ptr error;
+    std::vector<std::thread> threads;
+    for (Size i = 0; i < slices_.size(); ++i) {
+        threads.emplace_back([this, &f, &running, &error, i]() {
+            try {
+                f(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error)
+                    error = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --running;
+            }
+            cv_.notify_all();
+        });
+    }
+    // serve the requests of the slices until all of them are finished
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this, &running]() { return !requests_.empty() || running == 0; });
+            if (requests_.empty())
+                break;
+            Request* r = requests_.front();
+            requests_.pop_front();
+            lock.unlock();
+            try {
+                r->task();
+            } catch (...) {
+                r->error = std::current_exception();
+            }
+            lock.lock();
+            r->done = true;
+            cv_.notify_all();
+        }
+    }
+    for (auto& t : threads)
+        t.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void PathSliceModel::Slices::call(const std::function<void()>& task) {
+    if (std::this_thread::get_id() == owner_) {
+        task();
+        return;
+    }
+    Request r;
+    r.task = task;
+    std::unique_lock<std::mutex> lock(mutex_);
+    requests_.push_back(&r);
+    cv_.notify_all();
+    cv_.wait(lock, [&r]() { return r.done; });
+    if (r.error)
+        std::rethrow_exception(r.error);
+}
+
+const RandomVariable& PathSliceModel::Slices::get(const std::string& key,
+                                                  const std::function<RandomVariable(const Model&)>& f) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto v = values_.find(key);
+        if (v != values_.end())
+            return v->second;
+    }
+    RandomVariable result;
+    call([this, &f, &result]() { result = f(*model_); });
+    // map entries are not modified once inserted, so the reference stays valid when the lock is released
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_.insert(std::make_pair(key, std::move(result))).first->second;
+}
+
+PathSliceModel::PathSliceModel(Slices* slices, const Size offset, const Size size)
+    : Model(size), slices_(slices), offset_(offset) {}
+
+RandomVariable PathSliceModel::slice(const RandomVariable& x) const {
+    if (!x.initialised())
+        return x;
+    QL_REQUIRE(x.size() == slices_->model_->size(), "PathSliceModel: unexpected result size "
+                                                         << x.size() << ", expected " << slices_->model_->size());
+    if (x.deterministic())
+        return RandomVariable(size(), x.at(0), x.time());
+    return RandomVariable(size(), x.data() + offset_, x.time());
+}
+
+Real PathSliceModel::dt(const Date& d1, const Date& d2) const {
+    Real result;
+    slices_->call([this, &d1, &d2, &result]() { result = slices_->model_->dt(d1, d2); });
+    return result;
+}
+
+RandomVariable PathSliceModel::pay(const RandomVariable& amount, const Date& obsdate, const Date& paydate,
+                                   const std::string& currency) const {
+    return amount * slice(slices_->get(modelCallKey("pay", obsdate.serialNumber(), paydate.serialNumber(), currency),
+                                       [&](const Model& m) {
+                                           return m.pay(RandomVariable(m.size(), 1.0), obsdate, paydate, currency);
+                                       }));
+}
+
+RandomVariable PathSliceModel::discount(const Date& obsdate, const Date& paydate, const std::string& currency) const {
+    return slice(slices_->get(modelCallKey("discount", obsdate.serialNumber(), paydate.serialNumber(), currency),
+                              [&](const Model& m) { return m.discount(obsdate, paydate, currency); }));
+}
+
+RandomVariable PathSliceModel::npv(const RandomVariable& amount, const Date& obsdate, const Filter& filter,
+                                   const boost::optional<long>& memSlot, const RandomVariable& addRegressor1,
+                                   const RandomVariable& addRegressor2) const {
+    QL_FAIL("PathSliceModel: NPV() is not supported, since it requires a regression over all paths");
+}
+
+RandomVariable PathSliceModel::eval(const std::string& index, const Date& obsdate, const Date& fwddate,
+                                    const bool returnMissingFixingAsNull, const bool ignoreTodaysFixing) const {
+    return slice(slices_->get(modelCallKey("eval", index, obsdate.serialNumber(), fwddate.serialNumber(),
+                                          returnMissingFixingAsNull, ignoreTodaysFixing),
+                              [&](const Model& m) {
+                                  return m.eval(index, obsdate, fwddate, returnMissingFixingAsNull,
+                                                ignoreTodaysFixing);
+                              }));
+}
+
+RandomVariable PathSliceModel::fwdCompAvg(const bool isAvg, const std::string& index, const Date& obsdate,
+                                          const Date& start, const Date& end, const Real spread, const Real gearing,
+                                          const Integer lookback, const Natural rateCutoff, const Natural fixingDays,
+                                          const bool includeSpread, const Real cap, const Real floor,
+                                          const bool nakedOption, const bool localCapFloor) const {
+    return slice(slices_->get(modelCallKey("fwdCompAvg", isAvg, index, obsdate.serialNumber(), start.serialNumber(),
+                                          end.serialNumber(), spread, gearing, lookback, rateCutoff, fixingDays,
+                                          includeSpread, cap, floor, nakedOption, localCapFloor),
+                              [&](const Model& m) {
+                                  return m.fwdCompAvg(isAvg, index, obsdate, start, end, spread, gearing, lookback,
+                                                      rateCutoff, fixingDays, includeSpread, cap, floor, nakedOption,
+                                                      localCapFloor);
+                              }));
+}
+
+RandomVariable PathSliceModel::barrierProbability(const std::string& index, const Date& obsdate1,
+                                                  const Date& obsdate2, const RandomVariable& barrier,
+                                                  const bool above) const {
+    if (barrier.deterministic()) {
+        return slice(slices_->get(modelCallKey("barrierProbability", index, obsdate1.serialNumber(),
+                                              obsdate2.serialNumber(), barrier.at(0), above),
+                                  [&](const Model& m) {
+                                      return m.barrierProbability(index, obsdate1, obsdate2,
+                                                                  RandomVariable(m.size(), barrier.at(0)), above);
+                                  }));
+    }
+    QL_REQUIRE(barrier.size() == size(),
+               "PathSliceModel: barrier size (" << barrier.size() << ") does not match slice size (" << size() << ")");
+    // a path dependent barrier is embedded into a barrier for all paths, the result is not shared
+    RandomVariable result;
+    slices_->call([this, &index, &obsdate1, &obsdate2, &barrier, above, &result]() {
+        RandomVariable fullBarrier(slices_->model_->size(), 0.0);
+        fullBarrier.expand();
+        std::copy(barrier.data(), barrier.data() + size(), fullBarrier.data() + offset_);
+        result = slices_->model_->barrierProbability(index, obsdate1, obsdate2, fullBarrier, above);
+    });
+    return slice(result);
+}
+
+Real PathSliceModel::fxSpotT0(const std::string& forCcy, const std::string& domCcy) const {
+    Real result;
+    slices_->call([this, &forCcy, &domCcy, &result]() { result = slices_->model_->fxSpotT0(forCcy, domCcy); });
+    return result;
+}
+
+Real PathSliceModel::extractT0Result(const RandomVariable& value) const {
+    QL_FAIL("PathSliceModel: extractT0Result() is not supported, the results of the slices must be merged first");
+}
+
+} // namespace data
+} // namespace ore
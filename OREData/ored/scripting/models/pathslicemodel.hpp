@@ -0,0 +1,123 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/scripting/models/pathslicemodel.hpp
+    \brief model restricted to a contiguous range of the paths of another model
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ored/scripting/models/model.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace ore {
+namespace data {
+
+/*! Model providing the paths offset, ..., offset + size - 1 of an underlying mc model. This is used to run a script
+    on several path chunks in parallel, see PathSliceModel::Slices.
+
+    The slices do not call the underlying model from their own threads. Instead the calls are executed on the thread
+    running Slices::run(), so that the underlying model and the market data it depends on (which might be stored in
+    session singletons) are only accessed from this thread. The results are computed once for all paths and shared
+    between the slices. For pay() the linearity in the amount is used. NPV() requires a regression over all paths and
+    is not supported. */
+class PathSliceModel : public Model {
+public:
+    //! slices of an underlying model and the shared state needed to evaluate them in parallel
+    class Slices {
+    public:
+        Slices(const QuantLib::ext::shared_ptr<Model>& model, const Size nSlices);
+        Slices(const Slices&) = delete;
+        Slices& operator=(const Slices&) = delete;
+
+        Size size() const { return slices_.size(); }
+        const QuantLib::ext::shared_ptr<PathSliceModel>& slice(const Size i) const { return slices_.at(i); }
+
+        /*! Run f(i) for each slice i in a separate thread. The calling thread evaluates the underlying model on
+            behalf of the slices meanwhile. The first exception thrown by f is rethrown after all threads finished. */
+        void run(const std::function<void(Size)>& f);
+
+    private:
+        friend class PathSliceModel;
+        struct Request {
+            std::function<void()> task;
+            std::exception_ptr error;
+            bool done = false;
+        };
+        // execute task on the thread that owns the underlying model
+        void call(const std::function<void()>& task);
+        // get the result for key or compute it on the underlying model
+        const RandomVariable& get(const std::string& key, const std::function<RandomVariable(const Model&)>& f);
+
+        QuantLib::ext::shared_ptr<Model> model_;
+        Date referenceDate_;
+        std::string baseCcy_;
+        std::vector<QuantLib::ext::shared_ptr<PathSliceModel>> slices_;
+        std::thread::id owner_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<Request*> requests_;
+        std::map<std::string, RandomVariable> values_;
+    };
+
+    Type type() const override { return Type::MC; }
+    const Date& referenceDate() const override { return slices_->referenceDate_; }
+    const std::string& baseCcy() const override { return slices_->baseCcy_; }
+    Real dt(const Date& d1, const Date& d2) const override;
+
+    RandomVariable pay(const RandomVariable& amount, const Date& obsdate, const Date& paydate,
+                       const std::string& currency) const override;
+    RandomVariable discount(const Date& obsdate, const Date& paydate, const std::string& currency) const override;
+    RandomVariable npv(const RandomVariable& amount, const Date& obsdate, const Filter& filter,
+                       const boost::optional<long>& memSlot, const RandomVariable& addRegressor1,
+                       const RandomVariable& addRegressor2) const override;
+    RandomVariable eval(const std::string& index, const Date& obsdate, const Date& fwddate,
+                        const bool returnMissingFixingAsNull = false,
+                        const bool ignoreTodaysFixing = false) const override;
+    RandomVariable fwdCompAvg(const bool isAvg, const std::string& index, const Date& obsdate, const Date& start,
+                              const Date& end, const Real spread, const Real gearing, const Integer lookback,
+                              const Natural rateCutoff, const Natural fixingDays, const bool includeSpread,
+                              const Real cap, const Real floor, const bool nakedOption,
+                              const bool localCapFloor) const override;
+    RandomVariable barrierProbability(const std::string& index, const Date& obsdate1, const Date& obsdate2,
+                                      const RandomVariable& barrier, const bool above) const override;
+    Real fxSpotT0(const std::string& forCcy, const std::string& domCcy) const override;
+    Real extractT0Result(const RandomVariable& value) const override;
+
+    //! first path of the underlying model covered by this slice
+    Size offset() const { return offset_; }
+
+private:
+    PathSliceModel(Slices* slices, const Size offset, const Size size);
+    // the slice of a result of the underlying model
+    RandomVariable slice(const RandomVariable& x) const;
+
+    Slices* slices_;
+    Size offset_;
+};
+
+} // namespace data
+} // namespace ore
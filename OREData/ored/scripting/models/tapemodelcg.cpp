@@ -0,0 +1,124 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/scripting/models/tapemodelcg.hpp>
+#include <ored/scripting/utilities.hpp>
+
+#include <qle/ad/computationgraph.hpp>
+
+namespace ore {
+namespace data {
+
+TapeModelCG::TapeModelCG(const QuantLib::ext::shared_ptr<Model>& model) : ModelCG(model->size()), model_(model) {
+    QL_REQUIRE(model_->type() == Model::Type::MC, "TapeModelCG: only MC models are supported");
+}
+
+std::size_t TapeModelCG::leaf(const std::string& key, const LeafInfo& info,
+                              const std::function<RandomVariable()>& f) const {
+    auto l = leafIndex_.find(key);
+    if (l != leafIndex_.end())
+        return leafValues_[l->second].first;
+    RandomVariable value = f();
+    QL_REQUIRE(value.initialised(), "TapeModelCG: model returned uninitialised value for " << key);
+    std::size_t node = cg_insert(*g_);
+    leafIndex_[key] = leafValues_.size();
+    leafValues_.push_back(std::make_pair(node, value));
+    leafInfo_.push_back(info);
+    return node;
+}
+
+std::size_t TapeModelCG::dt(const Date& d1, const Date& d2) const { return cg_const(*g_, model_->dt(d1, d2)); }
+
+std::size_t TapeModelCG::pay(const std::size_t amount, const Date& obsdate, const Date& paydate,
+                             const std::string& currency) const {
+    // pay() is linear in the amount, so we record the factor that is applied to the amount
+    LeafInfo info{LeafInfo::Kind::Pay, currency, obsdate, paydate};
+    std::size_t factor =
+        leaf(modelCallKey("pay", obsdate.serialNumber(), paydate.serialNumber(), currency), info, [&]() {
+            return model_->pay(RandomVariable(size(), 1.0), obsdate, paydate, currency);
+        });
+    return cg_mult(*g_, amount, factor);
+}
+
+std::size_t TapeModelCG::discount(const Date& obsdate, const Date& paydate, const std::string& currency) const {
+    // the discount factors only depend on the rate curves, which are not among the pathwise sensitivity inputs
+    return leaf(modelCallKey("discount", obsdate.serialNumber(), paydate.serialNumber(), currency), LeafInfo(),
+                [&]() { return model_->discount(obsdate, paydate, currency); });
+}
+
+std::size_t TapeModelCG::npv(const std::size_t amount, const Date& obsdate, const std::size_t filter,
+                             const boost::optional<long>& memSlot, const std::size_t addRegressor1,
+                             const std::size_t addRegressor2) const {
+    QL_FAIL("TapeModelCG: NPV() is not supported");
+}
+
+std::size_t TapeModelCG::eval(const std::string& index, const Date& obsdate, const Date& fwddate,
+                              const bool returnMissingFixingAsNull, const bool ignoreTodaysFixing) const {
+    LeafInfo info{LeafInfo::Kind::Eval, index, obsdate, fwddate, ignoreTodaysFixing};
+    return leaf(modelCallKey("eval", index, obsdate.serialNumber(), fwddate.serialNumber(), ignoreTodaysFixing), info,
+                [&]() { return model_->eval(index, obsdate, fwddate, returnMissingFixingAsNull, ignoreTodaysFixing); });
+}
+
+std::size_t TapeModelCG::fwdCompAvg(const bool isAvg, const std::string& index, const Date& obsdate,
+                                    const Date& start, const Date& end, const Real spread, const Real gearing,
+                                    const Integer lookback, const Natural rateCutoff, const Natural fixingDays,
+                                    const bool includeSpread, const Real cap, const Real floor,
+                                    const bool nakedOption, const bool localCapFloor) const {
+    // the compounded / averaged rates only depend on the rate curves, as the discount factors
+    return leaf(modelCallKey("fwdCompAvg", isAvg, index, obsdate.serialNumber(), start.serialNumber(),
+                             end.serialNumber(), spread, gearing, lookback, rateCutoff, fixingDays, includeSpread,
+                             cap, floor, nakedOption, localCapFloor),
+                LeafInfo(), [&]() {
+                    return model_->fwdCompAvg(isAvg, index, obsdate, start, end, spread, gearing, lookback,
+                                              rateCutoff, fixingDays, includeSpread, cap, floor, nakedOption,
+                                              localCapFloor);
+                });
+}
+
+std::size_t TapeModelCG::barrierProbability(const std::string& index, const Date& obsdate1, const Date& obsdate2,
+                                            const std::size_t barrier, const bool above) const {
+    QL_FAIL("TapeModelCG: ABOVEPROB() / BELOWPROB() are not supported, the barrier probability depends on the spot and "
+            "vol inputs, but is not differentiated");
+}
+
+std::size_t TapeModelCG::fxSpotT0(const std::string& forCcy, const std::string& domCcy) const {
+    return cg_const(*g_, model_->fxSpotT0(forCcy, domCcy));
+}
+
+Real TapeModelCG::getDirectFxSpotT0(const std::string& forCcy, const std::string& domCcy) const {
+    return model_->fxSpotT0(forCcy, domCcy);
+}
+
+Real TapeModelCG::getDirectDiscountT0(const Date& paydate, const std::string& currency) const {
+    return model_->extractT0Result(model_->discount(referenceDate(), paydate, currency));
+}
+
+RandomVariable TapeModelCG::leafDerivative(const Size i, const Size input) const {
+    const LeafInfo& info = leafInfo_.at(i);
+    switch (info.kind) {
+    case LeafInfo::Kind::Eval:
+        return model_->evalDerivative(input, info.name, info.obsdate, info.date, info.ignoreTodaysFixing);
+    case LeafInfo::Kind::Pay:
+        return model_->payDerivative(input, RandomVariable(size(), 1.0), info.obsdate, info.date, info.name);
+    default:
+        return RandomVariable(size(), 0.0);
+    }
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/scripting/models/tapemodelcg.hpp
+    \brief cg model recording the calls to a classic model as leaves of a computation graph
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ored/scripting/models/model.hpp>
+#include <ored/scripting/models/modelcg.hpp>
+
+namespace ore {
+namespace data {
+
+/*! This class allows to record a tape of a script run against a classic (RandomVariable based) model: each model call
+    from the ComputationGraphBuilder is evaluated by the underlying model and inserted as a leaf node into the graph.
+    The values of the leaves are provided by leafValues(), the pathwise derivatives of the leaves w.r.t. the model's
+    pathwiseSensitivityInputs() by leafDerivative(). Identical model calls are represented by the same leaf.
+
+    Only eval() and pay() are differentiated. The other model calls (discount, fwdCompAvg) only depend on the rate
+    curves and are recorded as leaves with zero derivative. NPV() and barrierProbability() are not supported. */
+class TapeModelCG : public ModelCG {
+public:
+    explicit TapeModelCG(const QuantLib::ext::shared_ptr<Model>& model);
+
+    // ModelCG interface implementation
+    Type type() const override { return Type::MC; }
+    const Date& referenceDate() const override { return model_->referenceDate(); }
+    const std::string& baseCcy() const override { return model_->baseCcy(); }
+    std::size_t dt(const Date& d1, const Date& d2) const override;
+    std::size_t pay(const std::size_t amount, const Date& obsdate, const Date& paydate,
+                    const std::string& currency) const override;
+    std::size_t discount(const Date& obsdate, const Date& paydate, const std::string& currency) const override;
+    std::size_t npv(const std::size_t amount, const Date& obsdate, const std::size_t filter,
+                    const boost::optional<long>& memSlot, const std::size_t addRegressor1,
+                    const std::size_t addRegressor2) const override;
+    std::size_t eval(const std::string& index, const Date& obsdate, const Date& fwddate,
+                     const bool returnMissingFixingAsNull = false,
+                     const bool ignoreTodaysFixing = false) const override;
+    std::size_t fwdCompAvg(const bool isAvg, const std::string& index, const Date& obsdate, const Date& start,
+                           const Date& end, const Real spread, const Real gearing, const Integer lookback,
+                           const Natural rateCutoff, const Natural fixingDays, const bool includeSpread,
+                           const Real cap, const Real floor, const bool nakedOption,
+                           const bool localCapFloor) const override;
+    std::size_t barrierProbability(const std::string& index, const Date& obsdate1, const Date& obsdate2,
+                                   const std::size_t barrier, const bool above) const override;
+    std::size_t fxSpotT0(const std::string& forCcy, const std::string& domCcy) const override;
+    Real extractT0Result(const QuantExt::RandomVariable& value) const override {
+        return model_->extractT0Result(value);
+    }
+    std::size_t cgVersion() const override { return 0; }
+    const std::vector<std::vector<std::size_t>>& randomVariates() const override { return randomVariates_; }
+    std::vector<std::pair<std::size_t, double>> modelParameters() const override { return {}; }
+    std::vector<std::pair<std::size_t, std::function<double(void)>>>& modelParameterFunctors() const override {
+        return modelParameterFunctors_;
+    }
+    Real getDirectFxSpotT0(const std::string& forCcy, const std::string& domCcy) const override;
+    Real getDirectDiscountT0(const Date& paydate, const std::string& currency) const override;
+
+    // leaf nodes and their values
+    const std::vector<std::pair<std::size_t, RandomVariable>>& leafValues() const { return leafValues_; }
+    // pathwise derivative of the i-th leaf w.r.t. the model's pathwise sensitivity input no. input
+    RandomVariable leafDerivative(const Size i, const Size input) const;
+
+private:
+    struct LeafInfo {
+        enum class Kind { Eval, Pay, Other };
+        Kind kind = Kind::Other;
+        std::string name;
+        Date obsdate, date;
+        bool ignoreTodaysFixing = false;
+    };
+    std::size_t leaf(const std::string& key, const LeafInfo& info, const std::function<RandomVariable()>& f) const;
+
+    QuantLib::ext::shared_ptr<Model> model_;
+    mutable std::map<std::string, std::size_t> leafIndex_;
+    mutable std::vector<std::pair<std::size_t, RandomVariable>> leafValues_;
+    mutable std::vector<LeafInfo> leafInfo_;
+    std::vector<std::vector<std::size_t>> randomVariates_;
+    mutable std::vector<std::pair<std::size_t, std::function<double(void)>>> modelParameterFunctors_;
+};
+
+} // namespace data
+} // namespace ore
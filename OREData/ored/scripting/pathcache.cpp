@@ -0,0 +1,64 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/scripting/pathcache.hpp>
+
+#include <ored/utilities/log.hpp>
+
+namespace ore {
+namespace data {
+
+QuantLib::ext::shared_ptr<const PathCache::Paths> PathCache::paths(const std::string& key,
+                                                                   const std::function<Paths()>& build) {
+    auto e = cache_.find(key);
+    if (e != cache_.end()) {
+        lru_.splice(lru_.begin(), lru_, e->second.lru);
+        ++hits_;
+        DLOG("retrieved paths from path cache");
+        return e->second.paths;
+    }
+    auto paths = QuantLib::ext::make_shared<const Paths>(build());
+    if (maxSize_ == 0)
+        return paths;
+    lru_.push_front(key);
+    cache_[key] = Entry{paths, lru_.begin()};
+    shrink();
+    DLOG("added paths to path cache, size is " << cache_.size());
+    return paths;
+}
+
+void PathCache::setMaxSize(const Size maxSize) {
+    maxSize_ = maxSize;
+    shrink();
+}
+
+void PathCache::clear() {
+    cache_.clear();
+    lru_.clear();
+    hits_ = 0;
+}
+
+void PathCache::shrink() {
+    while (cache_.size() > maxSize_) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+} // namespace data
+} // namespace ore
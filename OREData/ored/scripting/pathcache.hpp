@@ -0,0 +1,78 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/scripting/pathcache.hpp
+    \brief cache for simulated model paths shared between scripted trades
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/patterns/singleton.hpp>
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace ore {
+namespace data {
+
+/*! Cache for simulated underlying paths, so that models of different trades which simulate the same paths share one
+    simulation. The key must determine the paths completely, i.e. it should contain all numerical inputs to the path
+    simulation (initial values, drifts, covariances, time steps) and the random number generator settings, see
+    BlackScholes for a usage example.
+
+    The cache holds at most maxSize() entries. If a new entry is added to a full cache, the least recently used entry
+    is removed. Like the ScriptCache this is a session singleton. */
+class PathCache : public QuantLib::Singleton<PathCache> {
+    friend class QuantLib::Singleton<PathCache>;
+    PathCache() = default;
+
+public:
+    //! paths per simulation step, per underlying
+    using Paths = std::vector<std::vector<QuantExt::RandomVariable>>;
+
+    //! get the paths for the given key, the paths are built by the given function if they are not yet in the cache
+    QuantLib::ext::shared_ptr<const Paths> paths(const std::string& key, const std::function<Paths()>& build);
+    //! number of cached path sets
+    Size size() const { return cache_.size(); }
+    //! number of requests that were served from the cache
+    Size hits() const { return hits_; }
+    //! maximum number of cached path sets, defaults to 4
+    Size maxSize() const { return maxSize_; }
+    void setMaxSize(const Size maxSize);
+    //! remove all paths from the cache and reset the hit counter
+    void clear();
+
+private:
+    using LruList = std::list<std::string>;
+    struct Entry {
+        QuantLib::ext::shared_ptr<const Paths> paths;
+        LruList::iterator lru;
+    };
+    void shrink();
+    std::unordered_map<std::string, Entry> cache_;
+    LruList lru_;
+    Size maxSize_ = 4;
+    Size hits_ = 0;
+};
+
+} // namespace data
+} // namespace ore
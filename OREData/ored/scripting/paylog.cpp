@@ -17,6 +17,9 @@
 */
 
 #include <ored/scripting/paylog.hpp>
+
+#include <ql/math/comparison.hpp>
+
 #include <set>
 
 namespace ore {
@@ -25,7 +28,8 @@ namespace data {
 void PayLog::write(RandomVariable value, const Filter& filter, const Date& obs, const Date& pay, const std::string& ccy,
                    const Size legNo, const std::string& cashflowType, const Size slot) {
 
-    // if a slot is given, we erase the results that we already have for this slot
+    // if a slot is given, we erase the results that we already have for this slot, notice that entries with a slot
+    // are always stored as path vectors
 
     if (slot != 0) {
         for (Size i = 0; i < slots_.size(); ++i) {
@@ -35,35 +39,72 @@ void PayLog::write(RandomVariable value, const Filter& filter, const Date& obs,
         }
     }
 
-    // determine the index where the result belongs, i.e. look for an existing entry for the given
-    // pay date, ccy, legNo, cashflowType and slot
+    // determine the index where the result belongs
 
-    Size idx = Null<Size>();
-    for (Size i = 0; i < slots_.size(); ++i) {
-        if (dates_[i] == pay && currencies_[i] == ccy && legNos_[i] == legNo && cashflowTypes_[i] == cashflowType &&
-            (slot == slots_[i]))
-            idx = i;
-    }
+    Size idx = entry(value.size(), pay, ccy, legNo, cashflowType, slot);
 
-    // if we did not find a slot, we create one
+    // add the value
 
-    if (idx == Null<Size>()) {
-        slots_.push_back(slot);
-        amounts_.push_back(RandomVariable(value.size(), 0.0));
-        dates_.push_back(pay);
-        currencies_.push_back(ccy);
-        legNos_.push_back(legNo);
-        cashflowTypes_.push_back(cashflowType);
-        idx = slots_.size() - 1;
+    if (keepPaths_ || slot != 0) {
+        amounts_[idx] += applyFilter(value, filter);
+    } else {
+        add(statistics_[idx],
+            statistics(applyFilter(value, filter), filter.initialised() ? filter : Filter(value.size(), true)));
+        amounts_[idx] = RandomVariable(value.size(), statistics_[idx].sum / static_cast<Real>(value.size()));
     }
+}
 
-    // add the value
-
-    amounts_[idx] += applyFilter(value, filter);
+void PayLog::mergeChunk(const PayLog& chunk, const Size offset, const Size size) {
+    QL_REQUIRE(chunk.keepPaths_ == keepPaths_, "PayLog::mergeChunk(): inconsistent keepPaths settings");
+    Filter all(size, true);
+    for (Size i = 0; i < chunk.size(); ++i) {
+        QL_REQUIRE(chunk.slots_[i] == 0, "PayLog::mergeChunk(): chunk log must be consolidated");
+        QL_REQUIRE(offset + chunk.amounts_[i].size() <= size, "PayLog::mergeChunk(): chunk paths "
+                                                                  << offset << "..."
+                                                                  << offset + chunk.amounts_[i].size() - 1
+                                                                  << " exceed total number of paths " << size);
+        if (keepPaths_) {
+            // the chunk amounts are embedded into amounts for all paths
+            const RandomVariable& a = chunk.amounts_[i];
+            std::vector<double> amount(size, 0.0);
+            for (Size j = 0; j < a.size(); ++j)
+                amount[offset + j] = a[j];
+            write(RandomVariable(amount), all, chunk.dates_[i], chunk.dates_[i], chunk.currencies_[i],
+                  chunk.legNos_[i], chunk.cashflowTypes_[i]);
+        } else {
+            // the chunks live on disjoint paths, so their statistics can be added without checking the supports
+            Size idx = entry(size, chunk.dates_[i], chunk.currencies_[i], chunk.legNos_[i], chunk.cashflowTypes_[i], 0);
+            Statistics& s = statistics_[idx];
+            s.sum += chunk.statistics_[i].sum;
+            s.sumOfSquares += chunk.statistics_[i].sumOfSquares;
+            s.exactVariance = s.exactVariance && chunk.statistics_[i].exactVariance;
+            s.support = s.exactVariance ? all : Filter();
+            amounts_[idx] = RandomVariable(size, s.sum / static_cast<Real>(size));
+        }
+    }
 }
 
 void PayLog::consolidateAndSort() {
 
+    // if we do not keep the paths, convert the entries with slots to statistics
+
+    if (!keepPaths_) {
+        for (Size i = 0; i < slots_.size(); ++i) {
+            if (slots_[i] == 0)
+                continue;
+            const RandomVariable& a = amounts_[i];
+            Filter support(a.size(), a.deterministic() && !QuantLib::close_enough(a[0], 0.0));
+            if (!a.deterministic()) {
+                for (Size j = 0; j < a.size(); ++j) {
+                    if (a[j] != 0.0)
+                        support.set(j, true);
+                }
+            }
+            statistics_[i] = statistics(a, support);
+            amounts_[i] = RandomVariable(a.size(), statistics_[i].sum / static_cast<Real>(a.size()));
+        }
+    }
+
     // Create set of (legNo, payDate, payCcy, cfType),  index in amounts / dates / ... vectors.
     // This will also create the sorting we want. Ignore slots from here on.
 
@@ -79,16 +120,25 @@ void PayLog::consolidateAndSort() {
     std::vector<Size> resultLegNos;
     std::vector<std::string> resultCashflowTypes;
     std::vector<RandomVariable> resultAmounts;
+    std::vector<Statistics> resultStatistics;
     Date lastDate = Null<Date>();
     std::string lastCurrency;
     Size lastLegNo = Null<Size>();
     std::string lastCashflowType;
     for (auto const& d : dates) {
         if (std::get<1>(d) == lastDate && std::get<2>(d) == lastCurrency && std::get<0>(d) == lastLegNo &&
-            std::get<3>(d) == lastCashflowType)
-            resultAmounts.back() += amounts_[std::get<4>(d)];
-        else {
+            std::get<3>(d) == lastCashflowType) {
+            if (keepPaths_) {
+                resultAmounts.back() += amounts_[std::get<4>(d)];
+            } else {
+                add(resultStatistics.back(), statistics_[std::get<4>(d)]);
+                resultAmounts.back() = RandomVariable(resultAmounts.back().size(),
+                                                      resultStatistics.back().sum /
+                                                          static_cast<Real>(resultAmounts.back().size()));
+            }
+        } else {
             resultAmounts.push_back(amounts_[std::get<4>(d)]);
+            resultStatistics.push_back(statistics_[std::get<4>(d)]);
             resultDates.push_back(std::get<1>(d));
             resultCurrencies.push_back(std::get<2>(d));
             resultLegNos.push_back(std::get<0>(d));
@@ -103,6 +153,7 @@ void PayLog::consolidateAndSort() {
     // overwrite the existing members
 
     amounts_ = std::move(resultAmounts);
+    statistics_ = std::move(resultStatistics);
     dates_ = std::move(resultDates);
     currencies_ = std::move(resultCurrencies);
     legNos_ = std::move(resultLegNos);
@@ -113,5 +164,79 @@ void PayLog::consolidateAndSort() {
     slots_ = std::vector<Size>(amounts_.size(), 0);
 }
 
+Real PayLog::variance(const Size i) const {
+    QL_REQUIRE(i < slots_.size(), "PayLog::variance(" << i << "): out of bounds, size is " << slots_.size());
+    if (keepPaths_)
+        return QuantExt::variance(amounts_[i]).at(0);
+    if (slots_[i] != 0 || !statistics_[i].exactVariance)
+        return Null<Real>();
+    Real n = static_cast<Real>(amounts_[i].size());
+    Real mean = statistics_[i].sum / n;
+    return std::max(statistics_[i].sumOfSquares / n - mean * mean, 0.0);
+}
+
+PayLog::Statistics PayLog::statistics(const RandomVariable& value, const Filter& support) {
+    Statistics s;
+    if (value.deterministic()) {
+        s.sum = static_cast<Real>(value.size()) * value[0];
+        s.sumOfSquares = static_cast<Real>(value.size()) * value[0] * value[0];
+    } else {
+        for (Size i = 0; i < value.size(); ++i) {
+            s.sum += value[i];
+            s.sumOfSquares += value[i] * value[i];
+        }
+    }
+    s.support = support;
+    return s;
+}
+
+void PayLog::add(Statistics& target, const Statistics& source) {
+
+    /* the sum of squares of a sum of contributions is the sum of the contributions' sums of squares only if the
+       contributions live on disjoint paths, otherwise we can not determine the variance without the paths */
+
+    bool exact = target.exactVariance && source.exactVariance;
+    if (exact && target.support.initialised()) {
+        Filter overlap = target.support && source.support;
+        if (overlap.deterministic())
+            exact = !overlap[0];
+        for (Size i = 0; i < overlap.size() && exact && !overlap.deterministic(); ++i)
+            exact = !overlap[i];
+    }
+
+    target.sum += source.sum;
+    target.sumOfSquares += source.sumOfSquares;
+    target.exactVariance = exact;
+    if (!exact)
+        target.support = Filter();
+    else if (target.support.initialised())
+        target.support = target.support || source.support;
+    else
+        target.support = source.support;
+}
+
+Size PayLog::entry(const Size n, const Date& pay, const std::string& ccy, const Size legNo,
+                   const std::string& cashflowType, const Size slot) {
+
+    // look for an existing entry for the given pay date, ccy, legNo, cashflowType and slot
+
+    for (Size i = 0; i < slots_.size(); ++i) {
+        if (dates_[i] == pay && currencies_[i] == ccy && legNos_[i] == legNo && cashflowTypes_[i] == cashflowType &&
+            (slot == slots_[i]))
+            return i;
+    }
+
+    // if we did not find an entry, we create one
+
+    slots_.push_back(slot);
+    amounts_.push_back(RandomVariable(n, 0.0));
+    statistics_.push_back(Statistics());
+    dates_.push_back(pay);
+    currencies_.push_back(ccy);
+    legNos_.push_back(legNo);
+    cashflowTypes_.push_back(cashflowType);
+    return slots_.size() - 1;
+}
+
 } // namespace data
 } // namespace ore
@@ -33,26 +33,55 @@ namespace data {
 using namespace QuantLib;
 using namespace QuantExt;
 
+/*! If keepPaths is true, the full path vectors of the amounts are stored. Otherwise only the sum and the sum of
+    squares over the paths are kept for each entry, which is all that is needed for the expected flows and their mc
+    error estimates. In this case amounts() contains deterministic random variables holding the expectation of the
+    amounts. This is only meaningful for mc models. Entries written to a slot > 0 are still stored as path vectors
+    until consolidateAndSort() is called, since they can be overwritten by later writes to the same slot. */
 class PayLog {
 public:
+    explicit PayLog(const bool keepPaths = true) : keepPaths_(keepPaths) {}
+
     // write to log, if slot > 0 overwrite existing entry with same slot, otherwise add to existing results
     void write(RandomVariable value, const Filter& filter, const Date& obs, const Date& pay, const std::string& ccy,
                const Size legNo, const std::string& cashflowType, const Size slot = 0);
 
+    /* add the consolidated entries of a log that was generated on the paths offset, ..., offset + chunk size - 1 of
+       a simulation with size paths in total, both logs must have the same keepPaths setting */
+    void mergeChunk(const PayLog& chunk, const Size offset, const Size size);
+
     // group amounts and sort in ascending order using the key (legNo, pay date, pay ccy, cfType)
     void consolidateAndSort();
 
     // read from log, the vectors are guaranteed to have all the same length size()
     Size size() const { return slots_.size(); }
+    bool keepPaths() const { return keepPaths_; }
     const std::vector<RandomVariable>& amounts() const { return amounts_; }
     const std::vector<Date>& dates() const { return dates_; }
     const std::vector<std::string>& currencies() const { return currencies_; }
     const std::vector<Size>& legNos() const { return legNos_; }
     const std::vector<std::string>& cashflowTypes() const { return cashflowTypes_; }
 
+    /* variance of the i-th amount over the paths, if keepPaths is false this is only available after
+       consolidateAndSort(), and only if the writes to the entry were on disjoint paths, otherwise null is returned */
+    Real variance(const Size i) const;
+
 private:
+    struct Statistics {
+        Real sum = 0.0, sumOfSquares = 0.0;
+        // paths on which the entry was written, only kept while the variance can be computed exactly
+        Filter support;
+        bool exactVariance = true;
+    };
+    static Statistics statistics(const RandomVariable& value, const Filter& support);
+    static void add(Statistics& target, const Statistics& source);
+    Size entry(const Size n, const Date& pay, const std::string& ccy, const Size legNo,
+               const std::string& cashflowType, const Size slot);
+
+    bool keepPaths_;
     std::vector<Size> slots_;
     std::vector<RandomVariable> amounts_;
+    std::vector<Statistics> statistics_;
     std::vector<Date> dates_;
     std::vector<std::string> currencies_;
     std::vector<Size> legNos_;
@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <ored/scripting/astprinter.hpp>
+#include <ored/scripting/scriptcache.hpp>
+#include <ored/scripting/utilities.hpp>
+
+#include <ored/utilities/log.hpp>
+
+namespace ore {
+namespace data {
+
+ScriptCache::Entry& ScriptCache::entry(const std::string& code) {
+    auto e = cache_.find(code);
+    if (e != cache_.end()) {
+        DLOG("retrieved ast from script cache");
+        return e->second;
+    }
+    Entry result;
+    result.ast = parseScript(code);
+    DLOGGERSTREAM("built ast:\n" << to_string(result.ast));
+    return cache_[code] = result;
+}
+
+ASTNodePtr ScriptCache::ast(const std::string& code) { return entry(code).ast; }
+
+QuantLib::ext::shared_ptr<ScriptBytecode> ScriptCache::bytecode(const std::string& code) {
+    Entry& e = entry(code);
+    if (e.bytecode == nullptr) {
+        e.bytecode = compileScript(e.ast);
+        DLOG("compiled script to bytecode (" << e.bytecode->instructions.size() << " instructions)");
+    }
+    return e.bytecode;
+}
+
+} // namespace data
+} // namespace ore
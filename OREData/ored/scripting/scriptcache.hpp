@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file ored/scripting/scriptcache.hpp
+    \brief cache for parsed and compiled scripts
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ored/scripting/ast.hpp>
+#include <ored/scripting/bytecode.hpp>
+
+#include <ql/patterns/singleton.hpp>
+
+#include <unordered_map>
+
+namespace ore {
+namespace data {
+
+/*! Cache for the ast and bytecode of scripts, keyed by the script code, so that trades referencing the same library
+    script share the parsed ast and the bytecode.
+
+    The ast holds cached variable references which are modified when it is run, therefore the cache is a session
+    singleton, i.e. each session (thread) builds its own asts. Static analysis results depend on the trade's context
+    and are not cached. */
+class ScriptCache : public QuantLib::Singleton<ScriptCache> {
+    friend class QuantLib::Singleton<ScriptCache>;
+    ScriptCache() = default;
+
+public:
+    //! get the ast for the given code, the code is parsed if it is not yet in the cache
+    ASTNodePtr ast(const std::string& code);
+    //! get the bytecode for the given code, the code is parsed and compiled if it is not yet in the cache
+    QuantLib::ext::shared_ptr<ScriptBytecode> bytecode(const std::string& code);
+    //! number of cached scripts
+    Size size() const { return cache_.size(); }
+    //! remove all scripts from the cache
+    void clear() { cache_.clear(); }
+
+private:
+    struct Entry {
+        ASTNodePtr ast;
+        QuantLib::ext::shared_ptr<ScriptBytecode> bytecode;
+    };
+    Entry& entry(const std::string& code);
+    std::unordered_map<std::string, Entry> cache_;
+};
+
+} // namespace data
+} // namespace ore
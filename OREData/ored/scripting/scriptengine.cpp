@@ -53,6 +53,7 @@ namespace ore {
 namespace data {
 
 namespace {
+
 class ASTRunner : public AcyclicVisitor,
                   public Visitor<ASTNode>,
                   public Visitor<OperatorPlusNode>,
@@ -113,6 +114,18 @@ public:
         value.push(RandomVariable());
     }
 
+    /* Model calls with identical arguments return the same result during a run. The result of a call is stored when
+       the call is seen for the second time, e.g. in a loop, so that calls which are made once only do not use memory.
+       This makes the evaluation of loop invariant model calls as cheap as if they were hoisted out of the loop. */
+    template <class F> RandomVariable memoised(const std::string& key, const F& f) {
+        if (auto r = modelCalls_.find(key); r != modelCalls_.end())
+            return r->second;
+        RandomVariable result = f();
+        if (!modelCallsSeen_.insert(key).second)
+            modelCalls_[key] = result;
+        return result;
+    }
+
     // helper functions to perform operations
 
     template <typename R>
@@ -761,6 +774,14 @@ public:
               n);
     }
 
+    RandomVariable payModel(const RandomVariable& amount, const Date& obs, const Date& pay, const std::string& ccy) {
+        // path dependent amounts are not memoised, since they will differ between calls in general
+        if (!amount.deterministic())
+            return model_->pay(amount, obs, pay, ccy);
+        return memoised(modelCallKey("pay", amount.at(0), obs.serialNumber(), pay.serialNumber(), ccy),
+                        [this, &amount, &obs, &pay, &ccy]() { return model_->pay(amount, obs, pay, ccy); });
+    }
+
     void payHelper(ASTNode& n, const bool log) {
         n.args[2]->accept(*this);
         auto paydate = value.pop();
@@ -788,7 +809,7 @@ public:
             QL_REQUIRE(obs <= pay, "observation date (" << obs << ") <= payment date (" << pay << ") required");
             RandomVariable result = pay <= model_->referenceDate()
                                         ? RandomVariable(model_->size(), 0.0)
-                                        : model_->pay(boost::get<RandomVariable>(amount), obs, pay, pccy);
+                                        : payModel(boost::get<RandomVariable>(amount), obs, pay, pccy);
             RandomVariable cashflowResult =
                 pay <= model_->referenceDate() ? boost::get<RandomVariable>(amount) : result;
             if (!log || paylog_ == nullptr) {
@@ -948,7 +969,9 @@ public:
         QL_REQUIRE(obs >= model_->referenceDate(),
                    "observation date (" << obs << ") >= reference date (" << model_->referenceDate() << ") required");
         QL_REQUIRE(obs <= pay, "observation date (" << obs << ") <= payment date (" << pay << ") required");
-        value.push(model_->discount(obs, pay, QuantLib::ext::get<CurrencyVec>(paycurr).value));
+        const std::string& ccy = QuantLib::ext::get<CurrencyVec>(paycurr).value;
+        value.push(memoised(modelCallKey("discount", obs.serialNumber(), pay.serialNumber(), ccy),
+                            [this, &obs, &pay, &ccy]() { return model_->discount(obs, pay, ccy); }));
         TRACE("discount( " << obsdate << " , " << paydate << " , " << paycurr << " )", n);
     }
 
@@ -1060,11 +1083,19 @@ public:
         bool nakedOptionBool = QuantLib::close_enough(nakedOptionValue.at(0), 1.0);
         bool localCapFloorBool = QuantLib::close_enough(localCapFloorValue.at(0), 1.0);
 
-        value.push(model_->fwdCompAvg(isAvg, QuantLib::ext::get<IndexVec>(underlying).value, obs, start, end, spreadValue.at(0),
-                                      gearingValue.at(0), static_cast<Integer>(lookbackValue.at(0)),
-                                      static_cast<Natural>(rateCutoffValue.at(0)),
-                                      static_cast<Natural>(fixingDaysValue.at(0)), includeSpreadBool, capValue.at(0),
-                                      floorValue.at(0), nakedOptionBool, localCapFloorBool));
+        const std::string& und = QuantLib::ext::get<IndexVec>(underlying).value;
+        Real spread = spreadValue.at(0), gearing = gearingValue.at(0), cap = capValue.at(0), floor = floorValue.at(0);
+        Integer lookback = static_cast<Integer>(lookbackValue.at(0));
+        Natural rateCutoff = static_cast<Natural>(rateCutoffValue.at(0));
+        Natural fixingDays = static_cast<Natural>(fixingDaysValue.at(0));
+        value.push(memoised(modelCallKey("fwdCompAvg", isAvg, und, obs.serialNumber(), start.serialNumber(),
+                                         end.serialNumber(), spread, gearing, lookback, rateCutoff, fixingDays,
+                                         includeSpreadBool, cap, floor, nakedOptionBool, localCapFloorBool),
+                            [&]() {
+                                return model_->fwdCompAvg(isAvg, und, obs, start, end, spread, gearing, lookback,
+                                                          rateCutoff, fixingDays, includeSpreadBool, cap, floor,
+                                                          nakedOptionBool, localCapFloorBool);
+                            }));
 
         TRACE("fwdCompAvg(" << isAvg << " , " << underlying << " , " << obsdate << " , " << startdate << " , "
                             << enddate << " , " << spreadValue.at(0) << " , " << gearingValue.at(0) << " , "
@@ -1100,8 +1131,12 @@ public:
         RandomVariable barrierValue = QuantLib::ext::get<RandomVariable>(barrier);
         if (obs1 > obs2)
             value.push(RandomVariable(model_->size(), 0.0));
-        else
+        else if (!barrierValue.deterministic())
             value.push(model_->barrierProbability(und, obs1, obs2, barrierValue, above));
+        else
+            value.push(memoised(modelCallKey("barrierProbability", und, obs1.serialNumber(), obs2.serialNumber(),
+                                             barrierValue.at(0), above),
+                                [&]() { return model_->barrierProbability(und, obs1, obs2, barrierValue, above); }));
         TRACE((above ? "above" : "below")
                   << "prob(" << underlying << " , " << obsdate1 << " , " << obsdate2 << " , " << barrier << ")",
               n);
@@ -1139,10 +1174,299 @@ public:
                            "evaluation operator() requires obsDate (" << obs << ") < fwdDate (" << fwd << ")");
             }
         }
-        value.push(model_->eval(QuantLib::ext::get<IndexVec>(left).value, obs, fwd));
+        const std::string& index = QuantLib::ext::get<IndexVec>(left).value;
+        value.push(memoised(modelCallKey("eval", index, obs.serialNumber(), fwd.serialNumber()),
+                            [this, &index, &obs, &fwd]() { return model_->eval(index, obs, fwd); }));
         TRACE("indexEval( " << left << " , " << right << " , " << fwd << " )", n);
     }
 
+    // bytecode execution, the nodes that are not compiled are delegated to the visitor methods above
+
+    void execute(const ScriptBytecode& code) {
+        registers_.assign(code.registers, ValueType());
+        constants_.clear();
+        for (auto const c : code.constants)
+            constants_.push_back(RandomVariable(size_, c));
+        bindings_.assign(code.variables.size(), SlotBinding());
+        ignored_.resize(code.variables.size());
+        constant_.resize(code.variables.size());
+        for (Size s = 0; s < code.variables.size(); ++s) {
+            ignored_[s] = context_.ignoreAssignments.find(code.variables[s]) != context_.ignoreAssignments.end();
+            constant_[s] = context_.constants.find(code.variables[s]) != context_.constants.end();
+        }
+        loops_.assign(code.loops, LoopState());
+
+        Size pc = 0;
+        while (pc < code.instructions.size()) {
+            auto const& i = code.instructions[pc++];
+            checkpoint(*i.node);
+            switch (i.op) {
+            case ScriptBytecode::OpCode::Plus:
+                registers_[i.dst] = operand(code, i.a) + operand(code, i.b);
+                break;
+            case ScriptBytecode::OpCode::Minus:
+                registers_[i.dst] = operand(code, i.a) - operand(code, i.b);
+                break;
+            case ScriptBytecode::OpCode::Multiply:
+                registers_[i.dst] = operand(code, i.a) * operand(code, i.b);
+                break;
+            case ScriptBytecode::OpCode::Divide:
+                registers_[i.dst] = operand(code, i.a) / operand(code, i.b);
+                break;
+            case ScriptBytecode::OpCode::Min:
+                registers_[i.dst] = min(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Max:
+                registers_[i.dst] = max(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Pow:
+                registers_[i.dst] = pow(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Eq:
+                registers_[i.dst] = equal(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Neq:
+                registers_[i.dst] = notequal(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Lt:
+                registers_[i.dst] = lt(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Leq:
+                registers_[i.dst] = leq(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Gt:
+                registers_[i.dst] = gt(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Geq:
+                registers_[i.dst] = geq(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Negate:
+                registers_[i.dst] = -operand(code, i.a);
+                break;
+            case ScriptBytecode::OpCode::Abs:
+                registers_[i.dst] = abs(operand(code, i.a));
+                break;
+            case ScriptBytecode::OpCode::Exp:
+                registers_[i.dst] = exp(operand(code, i.a));
+                break;
+            case ScriptBytecode::OpCode::Log:
+                registers_[i.dst] = log(operand(code, i.a));
+                break;
+            case ScriptBytecode::OpCode::Sqrt:
+                registers_[i.dst] = sqrt(operand(code, i.a));
+                break;
+            case ScriptBytecode::OpCode::NormalCdf:
+                registers_[i.dst] = normalCdf(operand(code, i.a));
+                break;
+            case ScriptBytecode::OpCode::NormalPdf:
+                registers_[i.dst] = normalPdf(operand(code, i.a));
+                break;
+            case ScriptBytecode::OpCode::Not:
+                registers_[i.dst] = logicalNot(operand(code, i.a));
+                break;
+            case ScriptBytecode::OpCode::Move:
+                registers_[i.dst] = operand(code, i.a);
+                break;
+            case ScriptBytecode::OpCode::LoadElement:
+                registers_[i.dst] = variableRef(code, i.slot, i.b);
+                break;
+            case ScriptBytecode::OpCode::AndShortCut:
+            case ScriptBytecode::OpCode::OrShortCut: {
+                bool isAnd = i.op == ScriptBytecode::OpCode::AndShortCut;
+                auto const& left = operand(code, i.a);
+                QL_REQUIRE(left.which() == ValueTypeWhich::Filter, "expected condition");
+                const Filter& l = QuantLib::ext::get<Filter>(left);
+                if (l.deterministic() && l[0] != isAnd) {
+                    // short cut if first expression is already false (and) resp. true (or)
+                    registers_[i.dst] = Filter(l.size(), !isAnd);
+                    pc = i.jump;
+                }
+                break;
+            }
+            case ScriptBytecode::OpCode::And:
+                registers_[i.dst] = logicalAnd(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::Or:
+                registers_[i.dst] = logicalOr(operand(code, i.a), operand(code, i.b));
+                break;
+            case ScriptBytecode::OpCode::AssignPrepare:
+                if (ignored_[i.slot]) {
+                    pc = i.jump;
+                } else {
+                    QL_REQUIRE(!constant_[i.slot],
+                               "can not assign to const variable '" << code.variables[i.slot] << "'");
+                }
+                break;
+            case ScriptBytecode::OpCode::Assign: {
+                auto const& right = operand(code, i.a);
+                ValueType& ref = variableRef(code, i.slot, i.b);
+                if (ref.which() == ValueTypeWhich::Event || ref.which() == ValueTypeWhich::Currency ||
+                    ref.which() == ValueTypeWhich::Index) {
+                    typeSafeAssign(ref, right);
+                } else {
+                    QL_REQUIRE(ref.which() == ValueTypeWhich::Number,
+                               "internal error: expected NUMBER, got " << valueTypeLabels.at(ref.which()));
+                    QL_REQUIRE(right.which() == ValueTypeWhich::Number,
+                               "invalid assignment: type " << valueTypeLabels.at(ref.which()) << " <- "
+                                                           << valueTypeLabels.at(right.which()));
+                    // copy the right hand side first, it might refer to the assigned variable
+                    RandomVariable r = QuantLib::ext::get<RandomVariable>(right);
+                    RandomVariable& x = QuantLib::ext::get<RandomVariable>(ref);
+                    x.setTime(Null<Real>());
+                    x = conditionalResult(filter.top(), std::move(r), x);
+                    x.updateDeterministic();
+                }
+                break;
+            }
+            case ScriptBytecode::OpCode::Require: {
+                auto const& condition = operand(code, i.a);
+                QL_REQUIRE(condition.which() == ValueTypeWhich::Filter, "expected condition");
+                auto c = !filter.top() || QuantLib::ext::get<Filter>(condition);
+                c.updateDeterministic();
+                QL_REQUIRE(c.deterministic() && c.at(0), "required condition is not (always) fulfilled");
+                break;
+            }
+            case ScriptBytecode::OpCode::PushFilter:
+            case ScriptBytecode::OpCode::PushFilterNegated: {
+                auto const& if_ = operand(code, i.a);
+                QL_REQUIRE(if_.which() == ValueTypeWhich::Filter,
+                           "IF must be followed by a boolean, got " << valueTypeLabels.at(if_.which()));
+                const Filter& cond = QuantLib::ext::get<Filter>(if_);
+                Filter currentFilter =
+                    i.op == ScriptBytecode::OpCode::PushFilter ? filter.top() && cond : filter.top() && !cond;
+                currentFilter.updateDeterministic();
+                bool skip = currentFilter.deterministic() && !currentFilter[0];
+                filter.push(std::move(currentFilter));
+                if (skip)
+                    pc = i.jump;
+                break;
+            }
+            case ScriptBytecode::OpCode::PopFilter:
+                filter.pop();
+                break;
+            case ScriptBytecode::OpCode::LoopCheck:
+                QL_REQUIRE(binding(code, i.slot).scalar != nullptr,
+                           "loop variable '" << code.variables[i.slot] << "' not defined or not scalar");
+                QL_REQUIRE(!constant_[i.slot], "loop variable '" << code.variables[i.slot] << "' is constant");
+                break;
+            case ScriptBytecode::OpCode::LoopInit: {
+                auto const& left = registers_[i.a.index];
+                auto const& right = registers_[i.a.index + 1];
+                auto const& step = registers_[i.a.index + 2];
+                QL_REQUIRE(left.which() == ValueTypeWhich::Number && right.which() == ValueTypeWhich::Number &&
+                               step.which() == ValueTypeWhich::Number,
+                           "loop bounds and step must be of type NUMBER, got "
+                               << valueTypeLabels.at(left.which()) << ", " << valueTypeLabels.at(right.which())
+                               << ", " << valueTypeLabels.at(step.which()));
+                const RandomVariable& a = QuantLib::ext::get<RandomVariable>(left);
+                const RandomVariable& b = QuantLib::ext::get<RandomVariable>(right);
+                const RandomVariable& s = QuantLib::ext::get<RandomVariable>(step);
+                QL_REQUIRE(a.deterministic(), "first loop bound must be deterministic");
+                QL_REQUIRE(b.deterministic(), "second loop bound must be deterministic");
+                QL_REQUIRE(s.deterministic(), "loop step must be deterministic");
+                LoopState& l = loops_[i.dst];
+                l.current = std::lround(a.at(0));
+                l.end = std::lround(b.at(0));
+                l.step = std::lround(s.at(0));
+                QL_REQUIRE(l.step != 0, "loop step must be non-zero");
+                if (l.running())
+                    *binding(code, i.slot).scalar = RandomVariable(size_, static_cast<double>(l.current));
+                else
+                    pc = i.jump;
+                break;
+            }
+            case ScriptBytecode::OpCode::LoopNext: {
+                LoopState& l = loops_[i.dst];
+                ValueType& var = *binding(code, i.slot).scalar;
+                QL_REQUIRE(var.which() == ValueTypeWhich::Number &&
+                               close_enough_all(QuantLib::ext::get<RandomVariable>(var),
+                                                RandomVariable(size_, static_cast<double>(l.current))),
+                           "loop variable was modified in body from " << l.current << " to " << var
+                                                                      << ", this is illegal.");
+                l.current += l.step;
+                if (l.running()) {
+                    var = RandomVariable(size_, static_cast<double>(l.current));
+                    pc = i.jump;
+                }
+                break;
+            }
+            case ScriptBytecode::OpCode::DelegateExpression:
+                i.node->accept(*this);
+                registers_[i.dst] = value.pop();
+                break;
+            case ScriptBytecode::OpCode::DelegateStatement:
+                i.node->accept(*this);
+                break;
+            default:
+                QL_FAIL("ScriptEngine: unhandled op code " << static_cast<int>(i.op));
+            }
+        }
+    }
+
+    // bind a variable slot to the context, the binding stays empty as long as the variable is not declared
+
+    struct SlotBinding {
+        ValueType* scalar = nullptr;
+        std::vector<ValueType>* array = nullptr;
+    };
+
+    SlotBinding& binding(const ScriptBytecode& code, const Size slot) {
+        SlotBinding& b = bindings_[slot];
+        if (b.scalar == nullptr && b.array == nullptr) {
+            auto scalar = context_.scalars.find(code.variables[slot]);
+            if (scalar != context_.scalars.end()) {
+                b.scalar = &scalar->second;
+            } else {
+                auto array = context_.arrays.find(code.variables[slot]);
+                if (array != context_.arrays.end())
+                    b.array = &array->second;
+            }
+        }
+        return b;
+    }
+
+    // get ref to context variable, same checks as in getVariableRef()
+
+    ValueType& variableRef(const ScriptBytecode& code, const Size slot, const ScriptBytecode::Operand& subscript) {
+        SlotBinding& b = binding(code, slot);
+        const std::string& name = code.variables[slot];
+        if (b.scalar != nullptr) {
+            QL_REQUIRE(subscript.kind == ScriptBytecode::Operand::Kind::None,
+                       "no array subscript allowed for variable '" << name << "'");
+            return *b.scalar;
+        }
+        QL_REQUIRE(b.array != nullptr, "variable '" << name << "' is not defined.");
+        QL_REQUIRE(subscript.kind != ScriptBytecode::Operand::Kind::None,
+                   "array subscript required for variable '" << name << "'");
+        auto const& arg = operand(code, subscript);
+        QL_REQUIRE(arg.which() == ValueTypeWhich::Number,
+                   "array subscript must be of type NUMBER, got " << valueTypeLabels.at(arg.which()));
+        const RandomVariable& i = QuantLib::ext::get<RandomVariable>(arg);
+        QL_REQUIRE(i.deterministic(), "array subscript must be deterministic");
+        long il = std::lround(i.at(0));
+        QL_REQUIRE(static_cast<long>(b.array->size()) >= il && il >= 1,
+                   "array index " << il << " out of bounds 1..." << b.array->size());
+        return (*b.array)[il - 1];
+    }
+
+    const ValueType& operand(const ScriptBytecode& code, const ScriptBytecode::Operand& o) {
+        switch (o.kind) {
+        case ScriptBytecode::Operand::Kind::Register:
+            return registers_[o.index];
+        case ScriptBytecode::Operand::Kind::Constant:
+            return constants_[o.index];
+        case ScriptBytecode::Operand::Kind::Variable:
+            return variableRef(code, o.index, ScriptBytecode::Operand());
+        default:
+            QL_FAIL("ScriptEngine: missing operand");
+        }
+    }
+
+    struct LoopState {
+        long current = 0, end = 0, step = 1;
+        bool running() const { return (step > 0 && current <= end) || (step < 0 && current >= end); }
+    };
+
     // inputs
     const QuantLib::ext::shared_ptr<Model> model_;
     const Size size_;
@@ -1156,6 +1480,15 @@ public:
     // state of the runner
     SafeStack<Filter> filter;
     SafeStack<ValueType> value;
+    // state of the bytecode execution
+    std::vector<ValueType> registers_;
+    std::vector<ValueType> constants_;
+    std::vector<SlotBinding> bindings_;
+    std::vector<bool> ignored_, constant_;
+    std::vector<LoopState> loops_;
+    // memoised model calls
+    std::map<std::string, RandomVariable> modelCalls_;
+    std::set<std::string> modelCallsSeen_;
 };
 
 } // namespace
@@ -1185,7 +1518,10 @@ void ScriptEngine::run(const std::string& script, bool interactive, QuantLib::ex
     boost::timer::cpu_timer timer;
     try {
         reset(root_);
-        root_->accept(runner);
+        if (bytecode_ != nullptr && !interactive)
+            runner.execute(*bytecode_);
+        else
+            root_->accept(runner);
         timer.stop();
         QL_REQUIRE(runner.value.size() == 1,
                    "ScriptEngine::run(): value stack has wrong size (" << runner.value.size() << "), should be 1");
@@ -25,19 +25,28 @@
 
 #include <ored/scripting/models/model.hpp>
 #include <ored/scripting/ast.hpp>
+#include <ored/scripting/bytecode.hpp>
 #include <ored/scripting/context.hpp>
 #include <ored/scripting/paylog.hpp>
 
 #include <ored/configuration/conventions.hpp>
 
+#include <ql/errors.hpp>
+
 namespace ore {
 namespace data {
 
 class ScriptEngine {
 public:
+    /*! If bytecode compiled from root is given, it is executed instead of visiting the ast, except in interactive
+        mode, which is only supported by the ast visitor. */
     ScriptEngine(const ASTNodePtr root, const QuantLib::ext::shared_ptr<Context> context,
-                 const QuantLib::ext::shared_ptr<Model> model = nullptr)
-        : root_(root), context_(context), model_(model) {}
+                 const QuantLib::ext::shared_ptr<Model> model = nullptr,
+                 const QuantLib::ext::shared_ptr<ScriptBytecode> bytecode = nullptr)
+        : root_(root), context_(context), model_(model), bytecode_(bytecode) {
+        QL_REQUIRE(bytecode_ == nullptr || bytecode_->root == root_,
+                   "ScriptEngine: bytecode was not compiled from the given ast");
+    }
     void run(const std::string& script = "", bool interactive = false, QuantLib::ext::shared_ptr<PayLog> paylog = nullptr,
              bool includePastCashflows = false);
 
@@ -45,6 +54,7 @@ private:
     const ASTNodePtr root_;
     const QuantLib::ext::shared_ptr<Context> context_;
     const QuantLib::ext::shared_ptr<Model> model_;
+    const QuantLib::ext::shared_ptr<ScriptBytecode> bytecode_;
 };
 
 } // namespace data
@@ -33,6 +33,9 @@
 #include <qle/indexes/fallbackiborindex.hpp>
 #include <qle/indexes/fallbackovernightindex.hpp>
 
+#include <iomanip>
+#include <sstream>
+
 #pragma once
 
 namespace QuantLib {
@@ -59,6 +62,14 @@ std::pair<std::string, ScriptedTradeScriptData> getScript(const ScriptedTrade& s
 /*! parse script and return ast */
 ASTNodePtr parseScript(const std::string& code);
 
+/*! key identifying a model call by its arguments, used to memoise model calls */
+template <class... Args> std::string modelCallKey(const Args&... args) {
+    std::ostringstream key;
+    key << std::setprecision(17);
+    ((key << args << '|'), ...);
+    return key.str();
+}
+
 /*! convert a IR / FX / EQ index name to a correlation label that is understood by the cam builder;
     return the tenor of the index too (or 0*Days if not applicable) */
 std::pair<std::string, Period>
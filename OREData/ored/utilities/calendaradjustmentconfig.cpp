@@ -163,6 +163,8 @@ void CalendarAdjustmentConfig::fromXML(XMLNode* node) {
         addBaseCalendar(calname, baseCalendar);
     }
 
+    // joint calendars built before the adjustments above have precomputed business days, drop them
+    CalendarParser::instance().clearJointCalendarCache();
 }
 
 XMLNode* CalendarAdjustmentConfig::toXML(XMLDocument& doc) const {
@@ -24,6 +24,7 @@
 
 #include <ql/time/calendars/all.hpp>
 #include <qle/calendars/amendedcalendar.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/calendars/austria.hpp>
 #include <qle/calendars/belgium.hpp>
 #include <qle/calendars/cme.hpp>
@@ -63,6 +64,15 @@ QuantLib::Calendar CalendarParser::parseCalendar(const std::string& name) const
     if (it != calendars_.end())
         return it->second;
     else {
+        {
+            boost::shared_lock<boost::shared_mutex> jointLock(jointMutex_);
+            auto j = jointCalendars_.find(name);
+            if (j != jointCalendars_.end()) {
+                ++jointHits_;
+                return j->second;
+            }
+        }
+        ++jointMisses_;
         // Try to split them up
         std::vector<std::string> calendarNames;
         split(calendarNames, name, boost::is_any_of(",()")); // , is delimiter, the brackets may arise if joint calendar
@@ -87,7 +97,11 @@ QuantLib::Calendar CalendarParser::parseCalendar(const std::string& name) const
                 QL_FAIL("Cannot convert \"" << name << "\" to Calendar [unhandled exception]");
             }
         }
-        return QuantLib::JointCalendar(calendars);
+        QuantLib::Calendar joint = QuantLib::JointCalendar(calendars);
+        boost::unique_lock<boost::shared_mutex> jointLock(jointMutex_);
+        if (jointCacheStart_ != Date() && jointCacheEnd_ != Date())
+            joint = QuantExt::CachedCalendar(joint, jointCacheStart_, jointCacheEnd_);
+        return jointCalendars_.emplace(name, joint).first->second;
     }
 }
 
@@ -98,6 +112,7 @@ QuantLib::Calendar CalendarParser::addCalendar(const std::string baseName, std::
     if (it == calendars_.end()) {
         QuantExt::AmendedCalendar tmp(cal, newName);
         calendars_[newName] = tmp;
+        ++calendarGeneration_;
         return std::move(tmp);
     } else {
         return it->second;
@@ -435,6 +450,7 @@ void CalendarParser::reset() {
     for (auto const& c : ref) {
         calendars_[c.second.name()] = c.second;
     }
+    ++calendarGeneration_;
 }
 
 void CalendarParser::resetAddedAndRemovedHolidays() {
@@ -442,6 +458,29 @@ void CalendarParser::resetAddedAndRemovedHolidays() {
     for (auto& m : calendars_) {
         m.second.resetAddedAndRemovedHolidays();
     }
+    boost::unique_lock<boost::shared_mutex> jointLock(jointMutex_);
+    jointCalendars_.clear();
+    ++calendarGeneration_;
+}
+
+void CalendarParser::setJointCalendarCacheRange(const Date& start, const Date& end) {
+    QL_REQUIRE(start == Date() || end == Date() || start <= end,
+               "CalendarParser: joint calendar cache start (" << start << ") must be <= end (" << end << ")");
+    boost::unique_lock<boost::shared_mutex> jointLock(jointMutex_);
+    jointCacheStart_ = start;
+    jointCacheEnd_ = end;
+    jointCalendars_.clear();
+    ++calendarGeneration_;
+}
+
+void CalendarParser::clearJointCalendarCache() {
+    boost::unique_lock<boost::shared_mutex> jointLock(jointMutex_);
+    jointCalendars_.clear();
+    ++calendarGeneration_;
+}
+
+std::pair<std::size_t, std::size_t> CalendarParser::jointCalendarCacheStatistics() const {
+    return std::make_pair(jointHits_.load(), jointMisses_.load());
 }
 
 } // namespace data
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <ql/patterns/singleton.hpp>
 #include <ql/time/calendar.hpp>
@@ -39,10 +40,29 @@ public:
     QuantLib::Calendar addCalendar(const std::string baseName, std::string& newName);
     void reset();
     void resetAddedAndRemovedHolidays();
+    //! hits and misses of the cache of joint calendars built by parseCalendar()
+    std::pair<std::size_t, std::size_t> jointCalendarCacheStatistics() const;
+    /*! Set the range of dates for which the business days of joint calendars are precomputed, null dates disable the
+        precomputation. This clears the joint calendar cache. */
+    void setJointCalendarCacheRange(const QuantLib::Date& start, const QuantLib::Date& end);
+    /*! Clear the joint calendar cache, this is required when holidays of a component calendar are changed, since the
+        cached business days only reflect the holidays at the time of the construction. */
+    void clearJointCalendarCache();
+    /*! A counter which is incremented whenever calendars or their holidays may have changed, caches of objects built
+        from parsed calendars can compare it to detect stale entries. */
+    std::size_t calendarGeneration() const { return calendarGeneration_.load(); }
 
 private:
     mutable boost::shared_mutex mutex_;
     std::map<std::string, QuantLib::Calendar> calendars_;
+    /* joint calendars parsed from a list of names, these are built once and then shared, with their business days
+       precomputed over [jointCacheStart_, jointCacheEnd_] */
+    mutable boost::shared_mutex jointMutex_;
+    mutable std::map<std::string, QuantLib::Calendar> jointCalendars_;
+    mutable std::atomic<std::size_t> jointHits_{0}, jointMisses_{0};
+    QuantLib::Date jointCacheStart_ = QuantLib::Date(1, QuantLib::January, 1990),
+                   jointCacheEnd_ = QuantLib::Date(31, QuantLib::December, 2100);
+    std::atomic<std::size_t> calendarGeneration_{0};
 };
 
 } // namespace data
@@ -209,6 +209,7 @@
 #include <ored/portfolio/worstofbasketswap.hpp>
 
 #include <qle/math/basiccpuenvironment.hpp>
+#include <qle/math/cudaenvironment.hpp>
 #include <qle/math/openclenvironment.hpp>
 
 #include <boost/thread/lock_types.hpp>
@@ -456,9 +457,11 @@ void dataBuilders() {
     ORE_REGISTER_ENGINE_BUILDER(FxEuropeanAsianOptionTWEngineBuilder, false)
     ORE_REGISTER_ENGINE_BUILDER(SwapEngineBuilder, false)
     ORE_REGISTER_ENGINE_BUILDER(SwapEngineBuilderOptimised, false)
+    ORE_REGISTER_ENGINE_BUILDER(SwapEngineBuilderBatch, false)
     ORE_REGISTER_ENGINE_BUILDER(CrossCurrencySwapEngineBuilder, false)
     ORE_REGISTER_ENGINE_BUILDER(MidPointIndexCdsEngineBuilder, false)
     ORE_REGISTER_ENGINE_BUILDER(MidPointCdsMultiStateEngineBuilder, false)
+    ORE_REGISTER_ENGINE_BUILDER(MidPointIndexCdsMultiStateEngineBuilder, false)
     ORE_REGISTER_ENGINE_BUILDER(CommodityForwardEngineBuilder, false)
     ORE_REGISTER_ENGINE_BUILDER(EquityEuropeanAsianOptionMCDAAPEngineBuilder, false)
     ORE_REGISTER_ENGINE_BUILDER(EquityEuropeanAsianOptionMCDAASEngineBuilder, false)
@@ -543,6 +546,7 @@ void dataBuilders() {
     ORE_REGISTER_TRS_UNDERLYING_BUILDER("CBO", CBOTrsUnderlyingBuilder, false)
 
     ORE_REGISTER_COMPUTE_FRAMEWORK_CREATOR("OpenCL", QuantExt::OpenClFramework, false);
+    ORE_REGISTER_COMPUTE_FRAMEWORK_CREATOR("CUDA", QuantExt::CudaFramework, false);
     ORE_REGISTER_COMPUTE_FRAMEWORK_CREATOR("BasicCpu", QuantExt::BasicCpuFramework, false);
 }
 
@@ -25,6 +25,10 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/regex.hpp>
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
 #include <map>
 #include <ored/configuration/conventions.hpp>
 #include <ored/utilities/conventionsbasedfutureexpiry.hpp>
@@ -906,62 +910,75 @@ QuantLib::ext::shared_ptr<QuantExt::CommodityIndex> parseCommodityIndex(const st
     return index;
 }
 
+namespace {
+
+// the parsers tried by parseIndex(), in this order
+const vector<QuantLib::ext::shared_ptr<Index> (*)(const string&)>& indexParsers() {
+    static const vector<QuantLib::ext::shared_ptr<Index> (*)(const string&)> parsers = {
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> { return parseEquityIndex(s); },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> { return parseBondIndex(s); },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> {
+            return parseCommodityIndex(s, true, QuantLib::Handle<QuantExt::PriceTermStructure>(),
+                                       QuantLib::NullCalendar(), false);
+        },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> { return parseFxIndex(s); },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> { return parseGenericIndex(s); },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> { return parseConstantMaturityBondIndex(s); },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> { return parseIborIndex(s); },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> {
+            return parseSwapIndex(s, Handle<YieldTermStructure>(), Handle<YieldTermStructure>());
+        },
+        [](const string& s) -> QuantLib::ext::shared_ptr<Index> {
+            return parseZeroInflationIndex(s, Handle<ZeroInflationTermStructure>());
+        }};
+    return parsers;
+}
+
+/* The parser that succeeded for an index name in parseIndex(), so that repeated calls do not go through the failing
+   parsers (and their exceptions) again. The parsers still build a new index on each call. */
+boost::shared_mutex parseIndexCacheMutex;
+std::map<string, Size> parseIndexCache;
+std::atomic<std::size_t> parseIndexCacheHits{0}, parseIndexCacheMisses{0};
+
+} // namespace
+
 QuantLib::ext::shared_ptr<Index> parseIndex(const string& s) {
-    QuantLib::ext::shared_ptr<QuantLib::Index> ret_idx;
-    try {
-        ret_idx = parseEquityIndex(s);
-    } catch (...) {
+    const auto& parsers = indexParsers();
+    Size cached = Null<Size>();
+    {
+        boost::shared_lock<boost::shared_mutex> lock(parseIndexCacheMutex);
+        auto it = parseIndexCache.find(s);
+        if (it != parseIndexCache.end())
+            cached = it->second;
     }
-    if (!ret_idx) {
+    if (cached != Null<Size>()) {
         try {
-            ret_idx = parseBondIndex(s);
-        } catch (...) {
-        }
-    }
-    if (!ret_idx) {
-        try {
-            ret_idx = parseCommodityIndex(s, true, QuantLib::Handle<QuantExt::PriceTermStructure>(), QuantLib::NullCalendar(), false);
-        } catch (...) {
-        }
-    }
-    if (!ret_idx) {
-        try {
-            ret_idx = parseFxIndex(s);
-        } catch (...) {
-        }
-    }
-    if (!ret_idx) {
-        try {
-            ret_idx = parseGenericIndex(s);
-        } catch (...) {
-        }
-    }
-    if (!ret_idx) {
-        try {
-            ret_idx = parseConstantMaturityBondIndex(s);
-        } catch (...) {
-        }
-    }
-    if (!ret_idx) {
-        try {
-            ret_idx = parseIborIndex(s);
+            if (auto ret_idx = parsers[cached](s)) {
+                ++parseIndexCacheHits;
+                return ret_idx;
+            }
         } catch (...) {
+            // the parser depends on e.g. the conventions, which might have changed, try all parsers below
         }
     }
-    if (!ret_idx) {
+    ++parseIndexCacheMisses;
+    for (Size i = 0; i < parsers.size(); ++i) {
+        QuantLib::ext::shared_ptr<QuantLib::Index> ret_idx;
         try {
-            ret_idx = parseSwapIndex(s, Handle<YieldTermStructure>(), Handle<YieldTermStructure>());
+            ret_idx = parsers[i](s);
         } catch (...) {
         }
-    }
-    if (!ret_idx) {
-        try {
-            ret_idx = parseZeroInflationIndex(s, Handle<ZeroInflationTermStructure>());
-        } catch (...) {
+        if (ret_idx) {
+            boost::unique_lock<boost::shared_mutex> lock(parseIndexCacheMutex);
+            parseIndexCache[s] = i;
+            return ret_idx;
         }
     }
-    QL_REQUIRE(ret_idx, "parseIndex \"" << s << "\" not recognized");
-    return ret_idx;
+    QL_FAIL("parseIndex \"" << s << "\" not recognized");
+}
+
+std::pair<std::size_t, std::size_t> parseIndexCacheStatistics() {
+    return std::make_pair(parseIndexCacheHits.load(), parseIndexCacheMisses.load());
 }
 
 bool isOvernightIndex(const string& indexName) {
@@ -182,6 +182,12 @@ QuantLib::ext::shared_ptr<QuantLib::Index> parseGenericIndex(const string& s);
 */
 QuantLib::ext::shared_ptr<Index> parseIndex(const string& s);
 
+//! Hits and misses of the cache of parsers that succeeded in parseIndex()
+/*!
+    \ingroup utilities
+*/
+std::pair<std::size_t, std::size_t> parseIndexCacheStatistics();
+
 //! Return true if the \p indexName is that of an overnight index, otherwise false
 /*! \ingroup utilities
  */
@@ -98,6 +98,91 @@ void FileLogger::log(unsigned, const string& msg) {
         fout_ << msg << endl;
 }
 
+void FileLogger::flush() {
+    if (fout_.is_open())
+        fout_.flush();
+}
+
+// -- Async Logger
+
+AsyncLogger::AsyncLogger(const QuantLib::ext::shared_ptr<Logger>& logger, Size bufferSize,
+                         OverflowPolicy overflowPolicy)
+    : Logger(logger->name()), logger_(logger), bufferSize_(std::max<Size>(bufferSize, 1)),
+      overflowPolicy_(overflowPolicy) {
+    buffer_.reserve(bufferSize_);
+    thread_ = std::thread(&AsyncLogger::run, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    messageAvailable_.notify_one();
+    thread_.join();
+}
+
+void AsyncLogger::log(unsigned level, const string& msg) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (buffer_.size() >= bufferSize_) {
+        if (overflowPolicy_ == OverflowPolicy::Drop) {
+            ++dropped_;
+            return;
+        }
+        spaceAvailable_.wait(lock, [this]() { return buffer_.size() < bufferSize_; });
+    }
+    buffer_.emplace_back(level, msg);
+    lock.unlock();
+    messageAvailable_.notify_one();
+}
+
+void AsyncLogger::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    spaceAvailable_.wait(lock, [this]() { return buffer_.empty() && !busy_; });
+    // the background thread can not start a new batch while we hold the lock
+    logger_->flush();
+}
+
+void AsyncLogger::run() {
+    // the messages are taken from the buffer in batches and written without holding the lock
+    std::vector<std::pair<unsigned, string>> batch;
+    batch.reserve(bufferSize_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        messageAvailable_.wait(lock, [this]() { return stop_ || !buffer_.empty() || dropped_ > 0; });
+        if (buffer_.empty() && dropped_ == 0 && stop_)
+            break;
+        batch.swap(buffer_);
+        Size dropped = dropped_;
+        dropped_ = 0;
+        busy_ = true;
+        lock.unlock();
+        spaceAvailable_.notify_all();
+        // an exception must not escape from the background thread, we can not do better than ignoring it
+        try {
+            for (auto const& m : batch)
+                logger_->log(m.first, m.second);
+            if (dropped > 0)
+                logger_->log(ORE_WARNING, "AsyncLogger: " + std::to_string(dropped) +
+                                              " messages were dropped, since the buffer of size " +
+                                              std::to_string(bufferSize_) + " was full");
+        } catch (...) {
+        }
+        batch.clear();
+        lock.lock();
+        busy_ = false;
+        spaceAvailable_.notify_all();
+    }
+}
+
+AsyncLogger::OverflowPolicy parseAsyncLoggerOverflowPolicy(const string& s) {
+    if (s == "Block")
+        return AsyncLogger::OverflowPolicy::Block;
+    else if (s == "Drop")
+        return AsyncLogger::OverflowPolicy::Drop;
+    QL_FAIL("AsyncLogger overflow policy '" << s << "' not recognised, expected Block or Drop");
+}
+
 void IndependentLogger::clear() { messages_.clear(); }
 
 ProgressLogger::ProgressLogger() : IndependentLogger(name) {
@@ -345,6 +430,12 @@ void Log::removeAllLoggers() {
     independentLoggers_.clear();
 }
 
+void Log::flush() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    for (auto& [_, l] : loggers_)
+        l->flush();
+}
+
 string Log::source(const char* filename, int lineNo) const {
     string filepath;
     if (rootPath_.empty()) {
@@ -33,10 +33,14 @@
 #define ORE_DATA 64    // 01000000  127
 #define ORE_MEMORY 128 // 10000000  255
 
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <time.h>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/log/attributes/mutable_constant.hpp>
@@ -140,6 +144,9 @@ public:
      */
     virtual void log(unsigned level, const std::string& s) = 0;
 
+    //! Writes out buffered messages, e.g. before the process exits without running the destructors
+    virtual void flush() {}
+
     //! Returns the Logger name
     const std::string& name() { return name_; }
 
@@ -205,6 +212,8 @@ public:
     virtual ~FileLogger();
     //! The log callback
     virtual void log(unsigned, const std::string&) override;
+    //! Flushes the file
+    virtual void flush() override;
 
 private:
     std::string filename_;
@@ -254,6 +263,56 @@ private:
     unsigned minLevel_;
 };
 
+//! AsyncLogger
+/*!
+  This logger forwards each log message to another logger, which is called from a background thread. The calling
+  thread only appends the message to a bounded buffer, so that the time spent under the Log mutex no longer
+  includes the I/O of the wrapped logger, e.g. the write and flush of a FileLogger.
+
+  If the buffer is full, the calling thread either waits until the background thread has made room (Block) or the
+  message is dropped (Drop). The number of dropped messages is reported through the wrapped logger.
+
+  The logger has the name of the wrapped logger. Messages still in the buffer are written out on destruction, i.e.
+  when the logger is removed from the Log.
+
+  To log asynchronously to a file
+  <pre>
+      Log::instance().registerLogger(QuantLib::ext::make_shared<AsyncLogger>(
+          QuantLib::ext::make_shared<FileLogger>("/tmp/my_log.txt")));
+  </pre>
+  \ingroup utilities
+  \see Log
+ */
+class AsyncLogger : public Logger {
+public:
+    enum class OverflowPolicy { Block, Drop };
+    //! Constructor
+    AsyncLogger(const QuantLib::ext::shared_ptr<Logger>& logger, QuantLib::Size bufferSize = 65536,
+                OverflowPolicy overflowPolicy = OverflowPolicy::Block);
+    //! Destructor, writes out the buffered messages
+    virtual ~AsyncLogger();
+    //! The log callback, appends the message to the buffer
+    virtual void log(unsigned, const std::string&) override;
+    //! Wait until all buffered messages are written by the wrapped logger, then flush the wrapped logger
+    virtual void flush() override;
+
+private:
+    void run();
+
+    QuantLib::ext::shared_ptr<Logger> logger_;
+    QuantLib::Size bufferSize_;
+    OverflowPolicy overflowPolicy_;
+    std::vector<std::pair<unsigned, std::string>> buffer_;
+    QuantLib::Size dropped_ = 0;
+    bool busy_ = false, stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable messageAvailable_, spaceAvailable_;
+    std::thread thread_;
+};
+
+//! Convert text to AsyncLogger::OverflowPolicy
+AsyncLogger::OverflowPolicy parseAsyncLoggerOverflowPolicy(const std::string& s);
+
 //! Base Log handler class that utilises Boost logging to create log sinks
 /*!
   This type of logger should only be received via Log::registerIndependentLoggers().
@@ -429,6 +488,9 @@ public:
      */
     void removeAllLoggers();
 
+    //! Flushes all registered loggers, see Logger::flush()
+    void flush();
+
     void addExcludeFilter(const std::string&, const std::function<bool(const std::string&)>);
 
     void removeExcludeFilter(const std::string&);
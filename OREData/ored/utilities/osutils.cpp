@@ -20,11 +20,14 @@
 #include <ored/utilities/osutils.hpp>
 #include <ored/version.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <map>
 #include <sstream>
 
 #include <boost/version.hpp>
+#include <ql/errors.hpp>
 #include <ql/version.hpp>
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -47,6 +50,19 @@
 #include <unistd.h>
 #endif
 
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <cerrno>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+#ifdef __linux__
+#include <boost/filesystem.hpp>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #if defined(_WIN32) || defined(_WIN64)
 #include <boost/version.hpp>
 #if BOOST_VERSION > 106500
@@ -181,6 +197,8 @@ unsigned long long getPeakMemoryUsageBytes() {
     return info.PeakWorkingSetSize;
 }
 
+std::size_t getNumberOfThreads() { return 0; }
+
 string getUsername() {
     char acUserName[256 + 1];
     DWORD nUserName = sizeof(acUserName);
@@ -275,6 +293,17 @@ string getMemoryRAM() {
     return memoryString(mem);
 }
 
+std::size_t getNumberOfThreads() {
+    thread_act_array_t threads;
+    mach_msg_type_number_t count;
+    if (task_threads(mach_task_self(), &threads, &count) != KERN_SUCCESS)
+        return 0;
+    for (mach_msg_type_number_t i = 0; i < count; ++i)
+        mach_port_deallocate(mach_task_self(), threads[i]);
+    vm_deallocate(mach_task_self(), (vm_address_t)threads, count * sizeof(thread_act_t));
+    return count;
+}
+
 // -------------------------------------
 // ---- Linux Stuff
 // -------------------------------------
@@ -349,6 +378,11 @@ unsigned long long getMemoryUsageBytes() {
 
 string getMemoryRAM() { return parseProcFile("/proc/meminfo", "MemTotal"); }
 
+std::size_t getNumberOfThreads() {
+    string n = parseProcFile("/proc/self/status", "Threads");
+    return n.empty() ? 0 : std::stoul(n);
+}
+
 #endif
 
 #endif
@@ -416,7 +450,168 @@ void setAssertHandler() {
     }
 }
 #endif
-    
+
+#ifdef __linux__
+
+namespace {
+// parse a cpu list as "0-3,8,10-11" into the cpus 0, 1, 2, 3, 8, 10, 11
+std::vector<unsigned int> parseCpuList(const string& list) {
+    std::vector<unsigned int> cpus;
+    std::istringstream in(list);
+    string range;
+    while (std::getline(in, range, ',')) {
+        boost::trim(range);
+        if (range.empty())
+            continue;
+        std::size_t dash = range.find('-');
+        unsigned int from = std::stoul(range.substr(0, dash));
+        unsigned int to = dash == string::npos ? from : std::stoul(range.substr(dash + 1));
+        for (unsigned int c = from; c <= to; ++c)
+            cpus.push_back(c);
+    }
+    return cpus;
+}
+} // namespace
+
+std::vector<std::vector<unsigned int>> getNumaNodeCpus() {
+    std::map<unsigned int, std::vector<unsigned int>> nodes;
+    try {
+        boost::filesystem::path root("/sys/devices/system/node");
+        if (boost::filesystem::is_directory(root)) {
+            for (auto const& entry : boost::filesystem::directory_iterator(root)) {
+                string name = entry.path().filename().string();
+                if (!boost::starts_with(name, "node") || name.size() == 4 ||
+                    name.find_first_not_of("0123456789", 4) != string::npos)
+                    continue;
+                ifstream cpulist((entry.path() / "cpulist").string());
+                string list;
+                if (cpulist.is_open() && std::getline(cpulist, list)) {
+                    auto cpus = parseCpuList(list);
+                    // nodes without cpus (e.g. memory only nodes) are skipped
+                    if (!cpus.empty())
+                        nodes[std::stoul(name.substr(4))] = cpus;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        WLOG("could not read NUMA topology: " << e.what());
+        nodes.clear();
+    }
+    std::vector<std::vector<unsigned int>> result;
+    for (auto& n : nodes)
+        result.push_back(std::move(n.second));
+    if (result.empty()) {
+        result.resize(1);
+        for (unsigned int c = 0; c < std::max(getNumberCores(), 1u); ++c)
+            result.front().push_back(c);
+    }
+    return result;
+}
+
+bool setThreadAffinity(const std::vector<unsigned int>& cpus) {
+    if (cpus.empty())
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto c : cpus) {
+        if (c < CPU_SETSIZE)
+            CPU_SET(c, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+}
+
+#else
+
+std::vector<std::vector<unsigned int>> getNumaNodeCpus() {
+    std::vector<std::vector<unsigned int>> result(1);
+    for (unsigned int c = 0; c < std::max(getNumberCores(), 1u); ++c)
+        result.front().push_back(c);
+    return result;
+}
+
+bool setThreadAffinity(const std::vector<unsigned int>& cpus) { return false; }
+
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+
+bool forkSupported() { return false; }
+
+void* allocateSharedMemory(const std::size_t bytes) { return nullptr; }
+
+void freeSharedMemory(void* p, const std::size_t bytes) {}
+
+std::vector<int> runForkedProcesses(const std::size_t n, const std::function<int(std::size_t)>& f) {
+    QL_FAIL("runForkedProcesses(): fork() is not supported on this platform");
+}
+
+#else
+
+bool forkSupported() { return true; }
+
+void* allocateSharedMemory(const std::size_t bytes) {
+    if (bytes == 0)
+        return nullptr;
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+void freeSharedMemory(void* p, const std::size_t bytes) {
+    if (p != nullptr && bytes > 0)
+        munmap(p, bytes);
+}
+
+std::vector<int> runForkedProcesses(const std::size_t n, const std::function<int(std::size_t)>& f) {
+    // the other threads would not exist in the children, while their locks, e.g. of the logger, could be held
+    std::size_t nThreads = getNumberOfThreads();
+    QL_REQUIRE(nThreads <= 1, "runForkedProcesses(): the calling process runs " << nThreads
+                                                                                << " threads, fork() requires that "
+                                                                                   "no other thread is running");
+    // write out buffered output, so that it is not duplicated in the children
+    Log::instance().flush();
+    std::cout << std::flush;
+    std::cerr << std::flush;
+    std::vector<pid_t> pids(n, -1);
+    std::vector<int> result(n, -1);
+    for (std::size_t i = 0; i < n; ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int rc;
+            try {
+                rc = f(i);
+            } catch (...) {
+                rc = 1;
+            }
+            Log::instance().flush();
+            std::cout << std::flush;
+            std::cerr << std::flush;
+            // skip the exit handlers and destructors of the copied parent state
+            _exit(rc);
+        }
+        if (pid < 0) {
+            ALOG("runForkedProcesses(): could not fork child process #" << i);
+            continue;
+        }
+        pids[i] = pid;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        if (pids[i] < 0)
+            continue;
+        int status;
+        while (waitpid(pids[i], &status, 0) < 0) {
+            if (errno != EINTR) {
+                status = -1;
+                break;
+            }
+        }
+        if (status >= 0 && WIFEXITED(status))
+            result[i] = WEXITSTATUS(status);
+    }
+    return result;
+}
+
+#endif
+
 } // end namespace os
 } // end namespace data
 } // end namespace ore
@@ -23,7 +23,10 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <vector>
 
 namespace ore {
 namespace data {
@@ -62,6 +65,9 @@ unsigned long long getMemoryUsageBytes();
 //! Returns the current process peak memory usage in bytes
 unsigned long long getPeakMemoryUsageBytes();
 
+//! Returns the number of threads of the current process, or 0 if this is not available on the platform
+std::size_t getNumberOfThreads();
+
 //! Returns the current username
 std::string getUsername();
 
@@ -77,6 +83,37 @@ void dumpStacktrace();
 //! Set an assert handler that logs the stacktrace
 void setAssertHandler();
 
+/*! Returns the logical cpus available to the OS grouped by NUMA node. On Linux the topology is read from
+    /sys/devices/system/node, on other platforms or if it is not available, a single node holding the cpus
+    0, ..., getNumberCores() - 1 is returned. */
+std::vector<std::vector<unsigned int>> getNumaNodeCpus();
+
+/*! Restrict the calling thread to run on the given logical cpus. Returns false if this is not supported on the
+    platform or if the affinity could not be set, in which case the thread is not restricted. */
+bool setThreadAffinity(const std::vector<unsigned int>& cpus);
+
+//! Returns true if child processes can be forked on the platform, see runForkedProcesses()
+bool forkSupported();
+
+/*! Allocates zero-initialised anonymous memory that is shared with the child processes forked after the allocation,
+    i.e. writes of the children are visible to the calling process. Returns nullptr if this is not supported on the
+    platform or if the allocation fails. The memory must be released with freeSharedMemory(). */
+void* allocateSharedMemory(const std::size_t bytes);
+
+//! Releases memory allocated with allocateSharedMemory()
+void freeSharedMemory(void* p, const std::size_t bytes);
+
+/*! Forks n child processes, child i runs f(i) and exits with its return value (0 = success), the calling process
+    waits for all children and returns their exit codes. An exception escaping f() gives exit code 1, a child
+    terminated by a signal gives -1.
+
+    The children are copy-on-write copies of the calling process, i.e. they see all data built before the call, but
+    their modifications are only visible to the calling process via shared memory, see allocateSharedMemory(). Only
+    the calling thread is copied into the children, therefore the call throws if other threads of the process are
+    running (e.g. the thread of an AsyncLogger or a ChunkWorkers pool), see getNumberOfThreads(). The loggers of
+    the Log are flushed before the children exit. Throws if fork() is not supported on the platform. */
+std::vector<int> runForkedProcesses(const std::size_t n, const std::function<int(std::size_t)>& f);
+
 //! @}
 }; // namespace os
 } // namespace data
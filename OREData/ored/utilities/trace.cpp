@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+#include <ored/utilities/trace.hpp>
+
+#include <ql/errors.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace ore {
+namespace data {
+
+namespace {
+// escape a string for use in a json string literal
+std::string jsonEscape(const std::string& s) {
+    std::ostringstream out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        else
+            out << c;
+    }
+    return out.str();
+}
+} // namespace
+
+void Trace::enable() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_.clear();
+    threads_.clear();
+    threads_[std::this_thread::get_id()] = 0;
+    origin_ = clock::now();
+    enabled_ = true;
+}
+
+void Trace::disable() { enabled_ = false; }
+
+void Trace::addSpan(std::string name, const clock::time_point& start, const clock::time_point& end) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // a span that started before the trace was (re-)enabled is dropped
+    if (start < origin_)
+        return;
+    auto t = threads_.emplace(std::this_thread::get_id(), threads_.size()).first->second;
+    spans_.push_back({std::move(name), std::chrono::duration_cast<std::chrono::microseconds>(start - origin_).count(),
+                      std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), t});
+}
+
+std::size_t Trace::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return spans_.size();
+}
+
+void Trace::writeChromeTrace(const std::string& fileName) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream file(fileName);
+    QL_REQUIRE(file.is_open(), "Trace::writeChromeTrace(): error opening file " << fileName);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (auto const& [id, t] : threads_) {
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+             << ",\"args\":{\"name\":\"" << (t == 0 ? std::string("main") : "thread " + std::to_string(t)) << "\"}}";
+        first = false;
+    }
+    for (auto const& s : spans_) {
+        file << (first ? "" : ",") << "\n{\"name\":\"" << jsonEscape(s.name)
+             << "\",\"cat\":\"ore\",\"ph\":\"X\",\"pid\":1,\"tid\":" << s.thread << ",\"ts\":" << s.start
+             << ",\"dur\":" << s.duration << "}";
+        first = false;
+    }
+    file << "\n]}\n";
+    QL_REQUIRE(file.good(), "Trace::writeChromeTrace(): error writing file " << fileName);
+}
+
+} // namespace data
+} // namespace ore
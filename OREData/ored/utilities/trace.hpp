@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+/*! \file ored/utilities/trace.hpp
+    \brief timeline tracing of an ore run
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ql/patterns/singleton.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Collects timed spans of a run
+/*! Spans are recorded by ORE_TRACE_SCOPE(name) for the lifetime of the enclosing scope, nested scopes give nested
+    spans. Tracing is disabled by default, a disabled trace scope costs a check of an atomic flag. Once enabled, the
+    spans of all threads are collected and can be written as a Chrome trace event file, which can be loaded into
+    chrome://tracing or https://ui.perfetto.dev to show the timeline per thread, i.e. the parallelism and idle
+    times of the run.
+
+    \ingroup utilities
+*/
+class Trace : public QuantLib::Singleton<Trace, std::integral_constant<bool, true>> {
+    friend class QuantLib::Singleton<Trace, std::integral_constant<bool, true>>;
+
+public:
+    using clock = std::chrono::steady_clock;
+
+    //! Clear all spans and start tracing, times are measured relative to this call
+    void enable();
+    //! Stop tracing, the spans collected so far are kept
+    void disable();
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    //! Record a completed span of the calling thread
+    void addSpan(std::string name, const clock::time_point& start, const clock::time_point& end);
+
+    //! Number of spans collected
+    std::size_t size() const;
+
+    /*! Write the collected spans as complete ("X") events in the Chrome trace event format, the threads are
+        numbered in the order in which they recorded their first span, the thread that enabled the tracing is
+        "main" */
+    void writeChromeTrace(const std::string& fileName) const;
+
+private:
+    Trace() = default;
+
+    struct Span {
+        std::string name;
+        long long start, duration; // micro seconds
+        std::size_t thread;
+    };
+
+    std::atomic<bool> enabled_{false};
+    clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::vector<Span> spans_;
+    std::map<std::thread::id, std::size_t> threads_;
+};
+
+//! Records a span from its construction to its destruction if tracing is enabled, use ORE_TRACE_SCOPE
+class TraceScope {
+public:
+    /*! the name is given as a function returning the name, so that no string is built if tracing is disabled */
+    template <class F> explicit TraceScope(const F& name) {
+        if (Trace::instance().enabled()) {
+            active_ = true;
+            name_ = name();
+            start_ = Trace::clock::now();
+        }
+    }
+    ~TraceScope() {
+        if (active_)
+            Trace::instance().addSpan(std::move(name_), start_, Trace::clock::now());
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    bool active_ = false;
+    std::string name_;
+    Trace::clock::time_point start_;
+};
+
+} // namespace data
+} // namespace ore
+
+#define ORE_TRACE_CONCAT_IMPL(a, b) a##b
+#define ORE_TRACE_CONCAT(a, b) ORE_TRACE_CONCAT_IMPL(a, b)
+
+//! Trace the enclosing scope, name can be any expression convertible to std::string, it is only evaluated if enabled
+#define ORE_TRACE_SCOPE(name)                                                                                          \
+    ore::data::TraceScope ORE_TRACE_CONCAT(oreTraceScope_, __LINE__)([&]() { return std::string(name); })
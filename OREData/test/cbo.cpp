@@ -62,6 +62,15 @@ BOOST_AUTO_TEST_CASE(testSimpleCBO) {
     BOOST_CHECK_NO_THROW(p.get("CBO-Constellation")->instrument()->NPV());
     BOOST_TEST_MESSAGE(p.get("CBO-Constellation")->instrument()->NPV());
     BOOST_CHECK_CLOSE(p.get("CBO-Constellation")->instrument()->NPV(), expectedNpv, tol);
+
+    // the waterfalls run in parallel give identical results, since the default times are drawn sequentially
+    Real npv = p.get("CBO-Constellation")->instrument()->NPV();
+    engineData->engineParameters("CBO")["Threads"] = "4";
+    QuantLib::ext::shared_ptr<EngineFactory> factoryMt = QuantLib::ext::make_shared<EngineFactory>(engineData, market);
+    Portfolio pMt;
+    pMt.fromFile(TEST_INPUT_FILE("cbo.xml"));
+    pMt.build(factoryMt);
+    BOOST_CHECK_EQUAL(pMt.get("CBO-Constellation")->instrument()->NPV(), npv);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -38,6 +38,7 @@
 #include <oret/datapaths.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
+#include <fstream>
 #include <tuple>
 
 using namespace QuantLib;
@@ -437,6 +438,123 @@ BOOST_FIXTURE_TEST_CASE(testDividends, F) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testCsvLoaderThreads) {
+
+    BOOST_TEST_MESSAGE("Testing that the CSVLoader gives the same results for one and several threads");
+
+    Date today(15, Jan, 2024);
+    Settings::instance().evaluationDate() = today;
+
+    // a fixings file large enough to be split into several chunks, with comments, blank lines, windows line endings,
+    // duplicates and future fixings
+    string fixingsFile = TEST_OUTPUT_FILE("csvloader_threads_fixings.txt");
+    {
+        std::ofstream f(fixingsFile);
+        f << "# fixings\n";
+        for (Size i = 0; i < 20000; ++i) {
+            Date d = today - (i % 4000) + 10;
+            f << io::iso_date(d) << (i % 3 == 0 ? "," : " ") << "IR_INDEX_" << i % 5 << ";" << 0.01 * i
+              << (i % 5 == 0 ? "\r\n" : "\n");
+            if (i % 1000 == 0)
+                f << "\n  \n# comment\n";
+        }
+    }
+    string marketFile = TEST_OUTPUT_FILE("csvloader_threads_market.txt");
+    {
+        std::ofstream f(marketFile);
+        f << "2024-01-15 FX/RATE/EUR/USD 1.1\n2024-01-15 FX/RATE/USD/EUR 0.9\n2024-01-15 MM/RATE/EUR/0D/1D 0.03\n"
+          << "2024-01-15 MM/RATE/EUR/0D/1D 0.04\n2024-01-16 MM/RATE/EUR/0D/1D 0.05\n";
+    }
+
+    CSVLoader loader1(marketFile, fixingsFile, false, Date(), 1);
+    CSVLoader loader4(marketFile, fixingsFile, false, Date(), 4);
+
+    auto fixings1 = loader1.loadFixings();
+    auto fixings4 = loader4.loadFixings();
+    BOOST_REQUIRE_EQUAL(fixings1.size(), fixings4.size());
+    // each of the 4000 dates occurs five times for the same index, 10 dates are in the future
+    BOOST_CHECK_EQUAL(fixings1.size(), 3990);
+    for (auto f1 = fixings1.begin(), f4 = fixings4.begin(); f1 != fixings1.end(); ++f1, ++f4) {
+        BOOST_CHECK_EQUAL(f1->name, f4->name);
+        BOOST_CHECK_EQUAL(f1->date, f4->date);
+        BOOST_CHECK_EQUAL(f1->fixing, f4->fixing);
+    }
+    // the first occurrence of a duplicate fixing wins
+    auto f = fixings4.find(Fixing(today, "IR_INDEX_0", 0.0));
+    BOOST_REQUIRE(f != fixings4.end());
+    BOOST_CHECK_CLOSE(f->fixing, 0.01 * 10, 1E-10);
+
+    for (auto const& d : {today, today + 1}) {
+        auto quotes1 = loader1.loadQuotes(d);
+        auto quotes4 = loader4.loadQuotes(d);
+        BOOST_REQUIRE_EQUAL(quotes1.size(), quotes4.size());
+        for (Size i = 0; i < quotes1.size(); ++i) {
+            BOOST_CHECK_EQUAL(quotes1[i]->name(), quotes4[i]->name());
+            BOOST_CHECK_EQUAL(quotes1[i]->quote()->value(), quotes4[i]->quote()->value());
+        }
+    }
+    BOOST_CHECK_EQUAL(loader4.loadQuotes(today).size(), 2);
+    BOOST_CHECK_EQUAL(loader4.get("MM/RATE/EUR/0D/1D", today)->quote()->value(), 0.03);
+}
+
+BOOST_AUTO_TEST_CASE(testCsvLoaderRequiredFixings) {
+
+    BOOST_TEST_MESSAGE("Testing that the CSVLoader loads the required fixings only");
+
+    Date today(15, Jan, 2024);
+    Settings::instance().evaluationDate() = today;
+
+    string fixingsFile = TEST_OUTPUT_FILE("csvloader_required_fixings.txt");
+    {
+        std::ofstream f(fixingsFile);
+        for (Size i = 0; i < 20000; ++i) {
+            Date d = today - (i % 4000) + 10;
+            f << io::iso_date(d) << " IR_INDEX_" << i % 5 << " " << 0.01 * i << "\n";
+        }
+    }
+    string marketFile = TEST_OUTPUT_FILE("csvloader_required_market.txt");
+    {
+        std::ofstream f(marketFile);
+        f << "2024-01-15 MM/RATE/EUR/0D/1D 0.03\n";
+    }
+
+    // a mix of available, missing, future and unknown index fixings
+    std::map<std::string, std::set<Date>> required = {
+        {"IR_INDEX_0", {today - 2000, today - 1990, today - 1, today, today + 5}},
+        {"IR_INDEX_3", {today - 3988, today - 3987}},
+        {"IR_INDEX_7", {today - 10}}};
+
+    CSVLoader eager(marketFile, fixingsFile, false, Date(), 4);
+    CSVLoader onDemand(marketFile, fixingsFile, false, Date(), 4, true);
+
+    auto all = eager.loadFixings();
+    std::set<Fixing> expected;
+    for (auto const& f : all) {
+        auto r = required.find(f.name);
+        if (r != required.end() && r->second.count(f.date) > 0)
+            expected.insert(f);
+    }
+    BOOST_CHECK_EQUAL(expected.size(), 4);
+
+    for (auto const& loader : {&eager, &onDemand}) {
+        auto fixings = loader->loadFixings(required);
+        BOOST_REQUIRE_EQUAL(fixings.size(), expected.size());
+        for (auto f1 = fixings.begin(), f2 = expected.begin(); f1 != fixings.end(); ++f1, ++f2) {
+            BOOST_CHECK_EQUAL(f1->name, f2->name);
+            BOOST_CHECK_EQUAL(f1->date, f2->date);
+            BOOST_CHECK_EQUAL(f1->fixing, f2->fixing);
+        }
+        BOOST_CHECK(loader->hasFixing("IR_INDEX_3", today - 3988));
+        BOOST_CHECK(!loader->hasFixing("IR_INDEX_3", today - 3987));
+        BOOST_CHECK(!loader->hasFixing("IR_INDEX_0", today + 5));
+        BOOST_CHECK_EQUAL(loader->getFixing("IR_INDEX_0", today - 1990).fixing,
+                          eager.getFixing("IR_INDEX_0", today - 1990).fixing);
+    }
+
+    // without a filter the on demand loader reads all fixings
+    BOOST_CHECK_EQUAL(onDemand.loadFixings().size(), all.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
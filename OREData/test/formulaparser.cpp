@@ -18,7 +18,11 @@
 
 #include <boost/timer/timer.hpp>
 #include <ored/utilities/formulaparser.hpp>
+#include <qle/ad/computationgraph.hpp>
+#include <qle/ad/forwardevaluation.hpp>
 #include <qle/math/compiledformula.hpp>
+#include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_ops.hpp>
 #include <oret/toplevelfixture.hpp>
 
 using namespace ore::data;
@@ -227,6 +231,50 @@ BOOST_AUTO_TEST_CASE(testCompiledFormula) {
     // BOOST_TEST_MESSAGE("timing muparser = " << timer.format(boost::timer::default_places, "%w") << " secs.");
 }
 
+BOOST_AUTO_TEST_CASE(testCompiledFormulaOnRandomVariables) {
+    BOOST_TEST_MESSAGE("Testing CompiledFormula evaluation on random variables and computation graphs...");
+
+    double tol = 1E-12;
+
+    std::vector<std::string> variables;
+    QuantExt::CompiledFormula f = parseFormula("max((2.3*({x}-{y}))-4.3,0.0)+abs({y})*gtZero({x}-1.5)-exp(-{y})/"
+                                               "pow({x},2.0)+min(log({x}),{y})+geqZero({y})",
+                                               variables);
+    BOOST_REQUIRE(variables.size() == 2);
+
+    constexpr Size n = 5;
+    std::vector<Real> xs = {0.5, 1.0, 2.0, 4.2, 7.5};
+    std::vector<Real> ys = {-2.3, 0.0, 1.7, 3.1, -0.4};
+    std::vector<QuantExt::RandomVariable> values(2, QuantExt::RandomVariable(n));
+    for (Size i = 0; i < n; ++i) {
+        values[0].set(i, xs[i]);
+        values[1].set(i, ys[i]);
+    }
+
+    QuantExt::RandomVariable r = f.eval(values);
+    BOOST_REQUIRE_EQUAL(r.size(), n);
+    for (Size i = 0; i < n; ++i)
+        BOOST_CHECK_CLOSE(r[i], f({xs[i], ys[i]}), tol);
+
+    // a constant formula yields a deterministic random variable of the size of the inputs
+    QuantExt::RandomVariable c = parseFormula("2.0*3.0", variables).eval(values);
+    BOOST_REQUIRE_EQUAL(c.size(), n);
+    BOOST_CHECK(c.deterministic());
+    BOOST_CHECK_CLOSE(c.at(0), 6.0, tol);
+
+    // the same program recorded on a computation graph and evaluated forward
+    QuantExt::ComputationGraph g;
+    std::vector<std::size_t> nodes = {QuantExt::cg_insert(g), QuantExt::cg_insert(g)};
+    std::size_t result = f.eval(g, nodes);
+    std::vector<QuantExt::RandomVariable> cgValues(g.size(), QuantExt::RandomVariable(n, 0.0));
+    cgValues[nodes[0]] = values[0];
+    cgValues[nodes[1]] = values[1];
+    QuantExt::forwardEvaluation(g, cgValues, QuantExt::getRandomVariableOps(n), QuantExt::RandomVariable::deleter,
+                                true);
+    for (Size i = 0; i < n; ++i)
+        BOOST_CHECK_CLOSE(cgValues[result][i], r[i], tol);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <ored/marketdata/indexedmarketdata.hpp>
+#include <oret/toplevelfixture.hpp>
+
+using namespace ore::data;
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace std;
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(IndexedMarketDataTest)
+
+BOOST_AUTO_TEST_CASE(testIndexedMarketData) {
+    BOOST_TEST_MESSAGE("Testing IndexedMarketData...");
+
+    Date asof(15, January, 2024);
+    vector<string> names = {"IR_SWAP/RATE/EUR/2D/6M/10Y", "IR_SWAP/RATE/EUR/2D/6M/5Y",  "IR_SWAP/RATE/EUR/2D/3M/5Y",
+                            "IR_SWAP/RATE/EURX/2D/6M/5Y", "IR_SWAP/RATE/EUR",           "IR_SWAP/RATE/USD/2D/3M/5Y",
+                            "MM/RATE/EUR/0D/6M",          "FX/RATE/EUR/USD",            "ZERO/RATE/EUR/6M"};
+
+    IndexedMarketData data;
+    for (Size i = 0; i < names.size(); ++i) {
+        BOOST_CHECK(data.insert(QuantLib::ext::make_shared<MarketDatum>(
+            0.01 * i, asof, names[i], MarketDatum::QuoteType::RATE, MarketDatum::InstrumentType::NONE)));
+    }
+    BOOST_CHECK(!data.insert(QuantLib::ext::make_shared<MarketDatum>(1.0, asof, names[0], MarketDatum::QuoteType::RATE,
+                                                                     MarketDatum::InstrumentType::NONE)));
+    BOOST_CHECK_EQUAL(data.size(), names.size());
+
+    // lookup by name
+    for (Size i = 0; i < names.size(); ++i) {
+        auto md = data.get(names[i]);
+        BOOST_REQUIRE(md != nullptr);
+        BOOST_CHECK_EQUAL(md->name(), names[i]);
+        BOOST_CHECK_CLOSE(md->quote()->value(), 0.01 * i, 1E-10);
+    }
+    BOOST_CHECK(data.get("IR_SWAP/RATE/GBP/2D/6M/5Y") == nullptr);
+
+    // all data, sorted by name
+    auto all = data.data();
+    BOOST_REQUIRE_EQUAL(all.size(), names.size());
+    for (Size i = 1; i < all.size(); ++i)
+        BOOST_CHECK_LT(all[i - 1]->name(), all[i]->name());
+
+    // wildcard queries agree with matching the pattern against all data
+    for (auto const& pattern : {"IR_SWAP/RATE/EUR/*", "IR_SWAP/RATE/EUR*", "IR_SWAP/RATE/EUR/*/6M/*", "*/6M",
+                                "*/EUR/*", "*", "MM/RATE/EUR/0D/6M", "MM/RATE/GBP/0D/6M", "ZERO/*/6M", "A*"}) {
+        Wildcard w(pattern);
+        set<QuantLib::ext::shared_ptr<MarketDatum>> expected;
+        for (auto const& md : all) {
+            if (w.matches(md->name()))
+                expected.insert(md);
+        }
+        BOOST_CHECK_MESSAGE(data.get(w) == expected, "wildcard query " << pattern << " gives " << data.get(w).size()
+                                                                       << " data, expected " << expected.size());
+    }
+
+    // erase
+    BOOST_CHECK(data.erase("FX/RATE/EUR/USD"));
+    BOOST_CHECK(!data.erase("FX/RATE/EUR/USD"));
+    BOOST_CHECK(data.get("FX/RATE/EUR/USD") == nullptr);
+    BOOST_CHECK(data.get(Wildcard("FX/*")).empty());
+    BOOST_CHECK_EQUAL(data.data().size(), names.size() - 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
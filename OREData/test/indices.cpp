@@ -482,6 +482,22 @@ BOOST_AUTO_TEST_CASE(testInflationIndexParsing) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testParseIndexCache) {
+
+    BOOST_TEST_MESSAGE("Testing repeated generic index parsing...");
+
+    for (auto const& name : {"EUR-EURIBOR-6M", "EUR-CMS-10Y", "EUHICPXT", "FX-ECB-EUR-USD"}) {
+        auto first = ore::data::parseIndex(name);
+        auto hits = ore::data::parseIndexCacheStatistics().first;
+        auto second = ore::data::parseIndex(name);
+        BOOST_CHECK_EQUAL(ore::data::parseIndexCacheStatistics().first, hits + 1);
+        BOOST_CHECK_EQUAL(first->name(), second->name());
+        // a new index is built on each call
+        BOOST_CHECK(first != second);
+    }
+    BOOST_CHECK_THROW(ore::data::parseIndex("NOT-AN-INDEX-NAME-AT-ALL"), QuantLib::Error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
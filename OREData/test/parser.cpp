@@ -20,6 +20,7 @@
 #include <boost/test/unit_test.hpp>
 #include <iostream>
 #include <ored/marketdata/marketdatumparser.hpp>
+#include <ored/utilities/calendarparser.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/strike.hpp>
 #include <oret/toplevelfixture.hpp>
@@ -337,6 +338,21 @@ BOOST_AUTO_TEST_CASE(testMarketDatumParsing) {
 
     BOOST_TEST_MESSAGE("Testing market datum parsing...");
 
+    { // the token buffer is reused between calls, a shorter name must not see tokens of a previous longer name
+        Date d(1, Jan, 1990);
+        Real value = 0.01;
+
+        auto capfloor = parseMarketDatum(d, "CAPFLOOR/RATE_SLNVOL/JPY/EYTIBOR/5Y/3M/1/1/0.0075", value);
+        BOOST_CHECK(capfloor->instrumentType() == MarketDatum::InstrumentType::CAPFLOOR);
+        auto zero = parseMarketDatum(d, "ZERO/RATE/EUR/EUR1D/A365/1Y", value);
+        BOOST_CHECK(zero->instrumentType() == MarketDatum::InstrumentType::ZERO);
+        BOOST_CHECK_EQUAL(zero->name(), "ZERO/RATE/EUR/EUR1D/A365/1Y");
+
+        // empty tokens are kept, as with boost::split
+        BOOST_CHECK_THROW(parseMarketDatum(d, "ZERO/RATE/EUR/EUR1D/A365/1Y/", value), Error);
+        BOOST_CHECK_THROW(parseMarketDatum(d, "ZERO/RATE", value), Error);
+    }
+
     BOOST_TEST_MESSAGE("Testing cap/floor market datum parsing...");
 
     { // test capfloor normal vol ATM
@@ -1091,6 +1107,22 @@ BOOST_AUTO_TEST_CASE(testJointCalendar) {
     checkCalendars(expectedHolidays, hol);
 }
 
+BOOST_AUTO_TEST_CASE(testParseJointCalendarCache) {
+
+    BOOST_TEST_MESSAGE("Testing repeated joint calendar parsing...");
+
+    Calendar first = parseCalendar("PE,CO,TH");
+    auto hits = ore::data::CalendarParser::instance().jointCalendarCacheStatistics().first;
+    Calendar second = parseCalendar("PE,CO,TH");
+    BOOST_CHECK_EQUAL(ore::data::CalendarParser::instance().jointCalendarCacheStatistics().first, hits + 1);
+    BOOST_CHECK(first == second);
+    std::vector<Date> hol1 = first.holidayList(Date(1, January, 2018), Date(31, December, 2018));
+    std::vector<Date> hol2 =
+        QuantLib::JointCalendar(QuantExt::Peru(), Colombia(), Thailand())
+            .holidayList(Date(1, January, 2018), Date(31, December, 2018));
+    BOOST_CHECK(hol1 == hol2);
+}
+
 BOOST_AUTO_TEST_CASE(testParseBoostAny) {
 
     BOOST_TEST_MESSAGE("Testing parsing of Boost::Any...");
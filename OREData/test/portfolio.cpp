@@ -20,8 +20,11 @@
 #include <boost/test/unit_test.hpp>
 #include <ored/portfolio/fxforward.hpp>
 #include <ored/portfolio/portfolio.hpp>
+#include <oret/datapaths.hpp>
 #include <oret/toplevelfixture.hpp>
 
+#include <fstream>
+
 using namespace QuantLib;
 using namespace boost::unit_test_framework;
 using namespace std;
@@ -119,6 +122,57 @@ BOOST_AUTO_TEST_CASE(testIds) {
     BOOST_CHECK(portfolio->ids() == trade_ids);
 }
 
+BOOST_AUTO_TEST_CASE(testFromFileStreamed) {
+    BOOST_TEST_MESSAGE("Testing streamed loading of a portfolio file...");
+
+    auto fxForward = [](const std::string& id, const std::string& amount) {
+        return "  <Trade id=\"" + id +
+               "\">\n"
+               "    <TradeType>FxForward</TradeType>\n"
+               "    <Envelope><CounterParty>CPTY_A</CounterParty><NettingSetId>CPTY_A</NettingSetId></Envelope>\n"
+               "    <FxForwardData>\n"
+               "      <ValueDate>2030-02-01</ValueDate><BoughtCurrency>EUR</BoughtCurrency>\n"
+               "      <BoughtAmount>" +
+               amount +
+               "</BoughtAmount><SoldCurrency>USD</SoldCurrency><SoldAmount>1100000</SoldAmount>\n"
+               "    </FxForwardData>\n"
+               "  </Trade>\n";
+    };
+
+    // includes a commented out trade and a trade with an unknown trade type that is loaded as a failed trade
+    std::string xml = "<?xml version=\"1.0\"?>\n<Portfolio>\n" + fxForward("FXFWD_1", "1000000") +
+                      "  <!-- <Trade id=\"COMMENTED\"><TradeType>FxForward</TradeType></Trade> -->\n" +
+                      fxForward("FXFWD_2", "2000000") +
+                      "  <Trade id=\"UNKNOWN\">\n    <TradeType>NoSuchTradeType</TradeType>\n"
+                      "    <Envelope><CounterParty>CPTY_B</CounterParty></Envelope>\n  </Trade>\n" +
+                      fxForward("FXFWD_3", "3000000") + "</Portfolio>\n";
+    std::string fileName = TEST_OUTPUT_FILE("portfolio_streamed.xml");
+    std::ofstream out(fileName);
+    out << xml;
+    out.close();
+
+    Portfolio reference;
+    reference.fromXMLString(xml);
+    BOOST_REQUIRE_EQUAL(reference.size(), 4);
+
+    // small chunk sizes split the trade nodes and tags across chunks
+    for (Size bufferSize : {7, 64, 1048576}) {
+        Portfolio portfolio;
+        portfolio.fromFileStreamed(fileName, bufferSize);
+        BOOST_CHECK(portfolio.ids() == reference.ids());
+        XMLDocument doc1, doc2;
+        doc1.appendNode(portfolio.toXML(doc1));
+        doc2.appendNode(reference.toXML(doc2));
+        BOOST_CHECK_EQUAL(doc1.toString(), doc2.toString());
+    }
+
+    std::ofstream bad(fileName);
+    bad << "<Portfolio>\n" << fxForward("FXFWD_1", "1000000") << "  <Trade id=\"TRUNCATED\">\n";
+    bad.close();
+    Portfolio portfolio;
+    BOOST_CHECK_THROW(portfolio.fromFileStreamed(fileName), std::exception);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <ored/report/inmemoryreport.hpp>
+#include <oret/datapaths.hpp>
+#include <oret/toplevelfixture.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace ore::data;
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace std;
+
+namespace {
+string readFile(const string& filename) {
+    std::ifstream is(filename);
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return ss.str();
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ReportTest)
+
+BOOST_AUTO_TEST_CASE(testInMemoryReportToFileThreads) {
+    BOOST_TEST_MESSAGE("Testing InMemoryReport::toFile() with several threads...");
+
+    // use a small buffer size, so that part of the data is written to and read back from the buffer files
+    InMemoryReport report(10000);
+    report.addColumn("Id", string())
+        .addColumn("Index", Size())
+        .addColumn("Value", Real(), 4)
+        .addColumn("Date", Date())
+        .addColumn("Tenor", Period());
+    Date d(15, January, 2024);
+    for (Size i = 0; i < 45678; ++i) {
+        report.next()
+            .add("ID_" + std::to_string(i))
+            .add(i % 17 == 0 ? Null<Size>() : i)
+            .add(i % 13 == 0 ? Null<Real>() : std::sin(static_cast<Real>(i)) * 1.0E4)
+            .add(d + static_cast<Integer>(i % 1000))
+            .add(Period(i % 30 + 1, Months));
+    }
+    report.end();
+
+    string file1 = TEST_OUTPUT_FILE("report_1.csv");
+    string file4 = TEST_OUTPUT_FILE("report_4.csv");
+    report.toFile(file1, ',', true, '"', "#N/A", false, 1);
+    report.toFile(file4, ',', true, '"', "#N/A", false, 4);
+
+    string content1 = readFile(file1), content4 = readFile(file4);
+    BOOST_CHECK(!content1.empty());
+    BOOST_CHECK(content1 == content4);
+    // header, rows and the trailing newline
+    BOOST_CHECK_EQUAL(std::count(content1.begin(), content1.end(), '\n'), 45678 + 1);
+    BOOST_CHECK(content1.find("\n\"ID_17\",#N/A,") != string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
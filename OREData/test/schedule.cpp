@@ -18,6 +18,8 @@
 
 #include <boost/test/unit_test.hpp>
 #include <ored/portfolio/schedule.hpp>
+#include <ored/utilities/calendarparser.hpp>
+#include <ored/utilities/parsers.hpp>
 #include <oret/toplevelfixture.hpp>
 
 using namespace boost::unit_test_framework;
@@ -91,6 +93,45 @@ BOOST_AUTO_TEST_CASE(testLastWednesdayDateGenerationRule) {
     BOOST_CHECK_EQUAL_COLLECTIONS(s.dates().begin(), s.dates().end(), expected.begin(), expected.end());
 }
 
+BOOST_AUTO_TEST_CASE(testScheduleCache) {
+
+    BOOST_TEST_MESSAGE("Testing ScheduleCache...");
+
+    ScheduleCache::instance().clear();
+    auto stats0 = ScheduleCache::instance().statistics();
+
+    ScheduleRules rules("2015-01-09", "2015-04-09", "1M", "TARGET", "MF", "MF", "Forward");
+    Schedule s1 = makeSchedule(rules);
+    Schedule s2 = makeSchedule(ScheduleRules(rules));
+    Schedule s3 = makeScheduleUncached(rules);
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().statistics().first, stats0.first + 1);
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().statistics().second, stats0.second + 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(s1.dates().begin(), s1.dates().end(), s3.dates().begin(), s3.dates().end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(s2.dates().begin(), s2.dates().end(), s3.dates().begin(), s3.dates().end());
+    BOOST_CHECK_EQUAL(s1[1], Date(9, Feb, 2015));
+
+    // rules differing in a single field do not share the cached schedule
+    Schedule s4 = makeSchedule(ScheduleRules("2015-01-09", "2015-04-09", "1M", "TARGET", "MF", "MF", "Backward"));
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().statistics().second, stats0.second + 2);
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 2U);
+
+    // a change of the calendar holidays signalled via the calendar parser invalidates the cache
+    parseCalendar("TARGET").addHoliday(Date(9, Feb, 2015));
+    CalendarParser::instance().clearJointCalendarCache();
+    Schedule s5 = makeSchedule(rules);
+    BOOST_CHECK_EQUAL(s5[1], Date(10, Feb, 2015));
+    CalendarParser::instance().resetAddedAndRemovedHolidays();
+    BOOST_CHECK_EQUAL(makeSchedule(rules)[1], Date(9, Feb, 2015));
+
+    // a disabled cache builds the schedules directly
+    ScheduleCache::instance().setEnabled(false);
+    auto stats1 = ScheduleCache::instance().statistics();
+    makeSchedule(rules);
+    BOOST_CHECK(ScheduleCache::instance().statistics() == stats1);
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 0U);
+    ScheduleCache::instance().setEnabled(true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
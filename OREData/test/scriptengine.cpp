@@ -22,12 +22,20 @@
 // clang-format on
 #include <boost/timer/timer.hpp>
 
+#include <ored/scripting/engines/scriptedinstrumentpricingengine.hpp>
 #include <ored/scripting/models/blackscholes.hpp>
 #include <ored/scripting/models/dummymodel.hpp>
+#include <ored/scripting/models/fdblackscholesbase.hpp>
+#include <ored/scripting/models/pathslicemodel.hpp>
 #include <ored/scripting/astprinter.hpp>
+#include <ored/scripting/bytecode.hpp>
+#include <ored/scripting/pathcache.hpp>
+#include <ored/scripting/paylog.hpp>
+#include <ored/scripting/scriptcache.hpp>
 #include <ored/scripting/scriptengine.hpp>
 #include <ored/scripting/scriptparser.hpp>
 #include <ored/scripting/staticanalyser.hpp>
+#include <ored/scripting/utilities.hpp>
 
 #include <oret/toplevelfixture.hpp>
 
@@ -39,6 +47,7 @@
 
 #include <ql/indexes/ibor/eonia.hpp>
 #include <ql/instruments/vanillaoption.hpp>
+#include <ql/pricingengines/blackcalculator.hpp>
 #include <ql/pricingengines/blackformula.hpp>
 #include <ql/pricingengines/vanilla/fdblackscholesvanillaengine.hpp>
 #include <ql/processes/stochasticprocessarray.hpp>
@@ -1318,6 +1327,7 @@ BOOST_AUTO_TEST_CASE(testAutocallable) {
         std::vector<std::string>(3, "USD"),
         BlackScholesModelBuilder({yts}, processesBs, simulationDates, payDates, 24).model(), correlations, mcParams,
         simulationDates);
+    Context initialContext = *context;
     ScriptEngine engine(parser.ast(), context, model);
     BOOST_REQUIRE_NO_THROW(engine.run());
     BOOST_REQUIRE(context->scalars["Option"].which() == ValueTypeWhich::Number);
@@ -1328,6 +1338,16 @@ BOOST_AUTO_TEST_CASE(testAutocallable) {
     BOOST_TEST_MESSAGE("option value estimation " << avg << " (timing " << timer.format(default_places, "%w") << "s)");
     BOOST_TEST_MESSAGE(*context);
 
+    // the compiled script must reproduce the result of the ast run exactly
+    auto bytecodeContext = QuantLib::ext::make_shared<Context>(initialContext);
+    ScriptEngine bytecodeEngine(parser.ast(), bytecodeContext, model, compileScript(parser.ast()));
+    timer.start();
+    BOOST_REQUIRE_NO_THROW(bytecodeEngine.run());
+    timer.stop();
+    BOOST_TEST_MESSAGE("run compiled script (timing " << timer.format(default_places, "%w") << "s)");
+    BOOST_REQUIRE(bytecodeContext->scalars["Option"].which() == ValueTypeWhich::Number);
+    BOOST_CHECK(QuantLib::ext::get<RandomVariable>(bytecodeContext->scalars["Option"]) == rv);
+
     // hardcoded version of the script
     std::vector<Real> times;
     for (auto const& d : expectedSimDates)
@@ -1481,6 +1501,595 @@ BOOST_AUTO_TEST_CASE(testNestedIfThenElse) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testBytecode) {
+    BOOST_TEST_MESSAGE("Testing compiled scripts...");
+
+    std::string script = "NUMBER i, s, t, a[5];\n"
+                         "FOR i IN (1, SIZE(a), 1) DO\n"
+                         "  a[i] = x * i;\n"
+                         "END;\n"
+                         "FOR i IN (5, 1, -2) DO\n"
+                         "  IF a[i] > 4 AND x < 3 THEN\n"
+                         "    s = s + a[i];\n"
+                         "  ELSE\n"
+                         "    IF x > 1 OR a[i] == 0 THEN\n"
+                         "      s = s - 1;\n"
+                         "    END;\n"
+                         "  END;\n"
+                         "END;\n"
+                         "IF 1 == 0 AND x > 0 THEN\n"
+                         "  s = s + 1000;\n"
+                         "END;\n"
+                         "t = max(s, 0) + pow(x, 2) - abs(-x) / 2 + LOGPAY(x, Expiry, Expiry, PayCcy);\n"
+                         "REQUIRE t > -100;\n"
+                         "result = t;\n"
+                         "fixed = 1;\n";
+
+    ScriptParser parser(script);
+    BOOST_REQUIRE(parser.success());
+    auto code = compileScript(parser.ast());
+    BOOST_TEST_MESSAGE("Compiled script:\n" << *code);
+
+    RandomVariable x(4);
+    for (Size i = 0; i < 4; ++i)
+        x.set(i, static_cast<Real>(i));
+
+    Context initialContext;
+    initialContext.scalars["x"] = x;
+    initialContext.scalars["result"] = RandomVariable(4, 0.0);
+    initialContext.scalars["fixed"] = RandomVariable(4, 0.0);
+    initialContext.scalars["Expiry"] = EventVec{4, Date(7, May, 2030)};
+    initialContext.scalars["PayCcy"] = CurrencyVec{4, "EUR"};
+    initialContext.ignoreAssignments.insert("fixed");
+
+    auto astContext = QuantLib::ext::make_shared<Context>(initialContext);
+    auto bytecodeContext = QuantLib::ext::make_shared<Context>(initialContext);
+    auto model = QuantLib::ext::make_shared<DummyModel>(4);
+    auto astPaylog = QuantLib::ext::make_shared<PayLog>();
+    auto bytecodePaylog = QuantLib::ext::make_shared<PayLog>();
+    ScriptEngine astEngine(parser.ast(), astContext, model);
+    ScriptEngine bytecodeEngine(parser.ast(), bytecodeContext, model, code);
+    BOOST_REQUIRE_NO_THROW(astEngine.run(script, false, astPaylog));
+    BOOST_REQUIRE_NO_THROW(bytecodeEngine.run(script, false, bytecodePaylog));
+    BOOST_TEST_MESSAGE("Context after run:\n" << *bytecodeContext);
+
+    for (auto const& v : {"i", "s", "t", "result", "fixed"}) {
+        BOOST_REQUIRE(bytecodeContext->scalars.at(v).which() == ValueTypeWhich::Number);
+        BOOST_CHECK_MESSAGE(QuantLib::ext::get<RandomVariable>(bytecodeContext->scalars.at(v)) ==
+                                QuantLib::ext::get<RandomVariable>(astContext->scalars.at(v)),
+                            "variable " << v << " differs");
+    }
+    BOOST_REQUIRE_EQUAL(bytecodeContext->arrays.at("a").size(), 5);
+    for (Size i = 0; i < 5; ++i)
+        BOOST_CHECK(QuantLib::ext::get<RandomVariable>(bytecodeContext->arrays.at("a")[i]) ==
+                    QuantLib::ext::get<RandomVariable>(astContext->arrays.at("a")[i]));
+    BOOST_CHECK(QuantLib::ext::get<RandomVariable>(bytecodeContext->scalars.at("fixed")) == RandomVariable(4, 0.0));
+    BOOST_REQUIRE_EQUAL(astPaylog->size(), 1);
+    BOOST_REQUIRE_EQUAL(bytecodePaylog->size(), 1);
+    BOOST_CHECK(bytecodePaylog->amounts().front() == astPaylog->amounts().front());
+
+    // errors are raised as in the ast run
+
+    auto errorContext = QuantLib::ext::make_shared<Context>(initialContext);
+    errorContext->constants.insert("result");
+    ScriptEngine errorEngine(parser.ast(), errorContext, model, code);
+    BOOST_CHECK_EXCEPTION(errorEngine.run(), QuantLib::Error, [](const QuantLib::Error& e) {
+        return std::string(e.what()).find("can not assign to const variable 'result'") != std::string::npos;
+    });
+
+    ScriptParser parser2("NUMBER a[2]; a[3] = 1;");
+    BOOST_REQUIRE(parser2.success());
+    ScriptEngine errorEngine2(parser2.ast(), QuantLib::ext::make_shared<Context>(), model,
+                              compileScript(parser2.ast()));
+    BOOST_CHECK_EXCEPTION(errorEngine2.run(), QuantLib::Error, [](const QuantLib::Error& e) {
+        return std::string(e.what()).find("array index 3 out of bounds 1...2") != std::string::npos;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(testScriptCache) {
+    BOOST_TEST_MESSAGE("Testing script cache...");
+
+    ScriptCache::instance().clear();
+    std::string script1 = "NUMBER x; x = 2 * y;";
+    std::string script2 = "NUMBER x; x = 3 * y;";
+
+    auto ast1 = ScriptCache::instance().ast(script1);
+    BOOST_CHECK_EQUAL(ScriptCache::instance().size(), 1);
+    BOOST_CHECK(ScriptCache::instance().ast(script1) == ast1);
+
+    auto code1 = ScriptCache::instance().bytecode(script1);
+    BOOST_REQUIRE(code1 != nullptr);
+    BOOST_CHECK(code1->root == ast1);
+    BOOST_CHECK(ScriptCache::instance().bytecode(script1) == code1);
+    BOOST_CHECK_EQUAL(ScriptCache::instance().size(), 1);
+
+    auto code2 = ScriptCache::instance().bytecode(script2);
+    BOOST_CHECK_EQUAL(ScriptCache::instance().size(), 2);
+    BOOST_CHECK(code2->root == ScriptCache::instance().ast(script2));
+    BOOST_CHECK(code2->root != ast1);
+
+    ScriptCache::instance().clear();
+    BOOST_CHECK_EQUAL(ScriptCache::instance().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testPayLogStatistics) {
+    BOOST_TEST_MESSAGE("Testing pay log keeping statistics only...");
+
+    auto filter = [](const std::vector<bool>& v) {
+        Filter f(v.size(), false);
+        for (Size i = 0; i < v.size(); ++i)
+            f.set(i, v[i]);
+        return f;
+    };
+
+    Filter all(4, true);
+    Date d1(7, May, 2020), d2(7, May, 2021), d3(7, May, 2022), d4(7, May, 2023);
+    PayLog paths, stats(false);
+    for (auto p : {&paths, &stats}) {
+        // overlapping writes
+        p->write(RandomVariable(std::vector<double>{1.0, 2.0, 3.0, 4.0}), all, d1, d1, "EUR", 0, "A");
+        p->write(RandomVariable(std::vector<double>{10.0, 20.0, 30.0, 40.0}), filter({true, false, true, false}), d1,
+                 d1, "EUR", 0, "A");
+        // single write
+        p->write(RandomVariable(std::vector<double>{5.0, 6.0, 7.0, 8.0}), filter({true, false, false, true}), d2, d2,
+                 "USD", 0, "A");
+        // overwritten slot
+        p->write(RandomVariable(4, 1.0), all, d3, d3, "EUR", 1, "B", 1);
+        p->write(RandomVariable(4, 2.0), filter({true, true, false, false}), d3, d3, "EUR", 1, "B", 1);
+        // disjoint writes
+        p->write(RandomVariable(std::vector<double>{1.0, 2.0, 3.0, 4.0}), filter({true, true, false, false}), d4, d4,
+                 "EUR", 1, "B");
+        p->write(RandomVariable(std::vector<double>{5.0, 6.0, 7.0, 8.0}), filter({false, false, true, true}), d4, d4,
+                 "EUR", 1, "B");
+        p->consolidateAndSort();
+    }
+
+    BOOST_REQUIRE_EQUAL(paths.size(), 4);
+    BOOST_REQUIRE_EQUAL(stats.size(), 4);
+    for (Size i = 0; i < paths.size(); ++i) {
+        BOOST_CHECK_EQUAL(stats.dates()[i], paths.dates()[i]);
+        BOOST_CHECK_EQUAL(stats.currencies()[i], paths.currencies()[i]);
+        BOOST_CHECK_EQUAL(stats.legNos()[i], paths.legNos()[i]);
+        BOOST_CHECK_EQUAL(stats.cashflowTypes()[i], paths.cashflowTypes()[i]);
+        BOOST_CHECK(stats.amounts()[i].deterministic());
+        BOOST_CHECK_CLOSE(stats.amounts()[i].at(0), expectation(paths.amounts()[i]).at(0), 1E-12);
+        if (paths.dates()[i] == d1)
+            BOOST_CHECK(stats.variance(i) == Null<Real>());
+        else
+            BOOST_CHECK_CLOSE(stats.variance(i), paths.variance(i), 1E-10);
+    }
+
+    // merge logs generated on path chunks
+
+    PayLog chunk1(false), chunk2(false), merged(false);
+    chunk1.write(RandomVariable(std::vector<double>{5.0, 6.0}), Filter(2, true), d2, d2, "USD", 0, "A");
+    chunk2.write(RandomVariable(std::vector<double>{7.0, 8.0}), Filter(2, true), d2, d2, "USD", 0, "A");
+    chunk1.consolidateAndSort();
+    chunk2.consolidateAndSort();
+    merged.mergeChunk(chunk1, 0, 4);
+    merged.mergeChunk(chunk2, 2, 4);
+    merged.consolidateAndSort();
+    BOOST_REQUIRE_EQUAL(merged.size(), 1);
+    RandomVariable expected(std::vector<double>{5.0, 6.0, 7.0, 8.0});
+    BOOST_CHECK_EQUAL(merged.amounts()[0].size(), 4);
+    BOOST_CHECK_CLOSE(merged.amounts()[0].at(0), expectation(expected).at(0), 1E-12);
+    BOOST_CHECK_CLOSE(merged.variance(0), variance(expected).at(0), 1E-10);
+}
+
+BOOST_AUTO_TEST_CASE(testFdBatchedRollback) {
+    BOOST_TEST_MESSAGE("Testing batched rollback in fd black scholes model...");
+
+    Date ref(7, May, 2019);
+    Settings::instance().evaluationDate() = ref;
+
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(ref, 0.02, dc));
+    Handle<YieldTermStructure> yts0(QuantLib::ext::make_shared<FlatForward>(ref, 0.0, dc));
+    Handle<BlackVolTermStructure> volts(QuantLib::ext::make_shared<BlackConstantVol>(ref, NullCalendar(), 0.20, dc));
+    auto process = QuantLib::ext::make_shared<GeneralizedBlackScholesProcess>(
+        Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(100.0)), yts0, yts, volts);
+    Date d1(7, May, 2020), d2(7, May, 2021);
+    std::set<Date> simulationDates = {d1, d2};
+
+    auto makeModel = [&](const bool cacheStepOperators) {
+        return QuantLib::ext::make_shared<FdBlackScholesBase>(
+            200, "USD", yts, "EQ-SP5", "USD",
+            BlackScholesModelBuilder(yts, process, simulationDates, std::set<Date>(), 24).model(), simulationDates,
+            IborFallbackConfig::defaultConfig(), "ATM", std::vector<Real>(), 1E-4, 1.5, 0.1, 9999, false,
+            cacheStepOperators);
+    };
+
+    std::vector<RandomVariable> batchedResults;
+    for (bool cacheStepOperators : {false, true}) {
+        auto model = makeModel(cacheStepOperators);
+        RandomVariable call = max(model->eval("EQ-SP5", d2, Null<Date>()) - RandomVariable(model->size(), 100.0),
+                                  RandomVariable(model->size(), 0.0));
+        call.setTime(model->timeFromReference(d2));
+        RandomVariable put = max(RandomVariable(model->size(), 100.0) - model->eval("EQ-SP5", d1, Null<Date>()),
+                                 RandomVariable(model->size(), 0.0));
+        put.setTime(model->timeFromReference(d1));
+
+        // the batched rollback yields the same results as the single rollbacks
+
+        auto batched = model->npv(std::vector<RandomVariable>{call, put}, ref);
+        BOOST_REQUIRE_EQUAL(batched.size(), 2);
+        BOOST_CHECK(batched[0] == model->npv(call, ref, Filter(), boost::none, RandomVariable(), RandomVariable()));
+        BOOST_CHECK(batched[1] == model->npv(put, ref, Filter(), boost::none, RandomVariable(), RandomVariable()));
+
+        // check the (undiscounted) call price against the black formula
+
+        Real t = model->timeFromReference(d2);
+        Real expected = blackFormula(Option::Call, 100.0, 100.0 / yts->discount(t), 0.20 * std::sqrt(t));
+        BOOST_TEST_MESSAGE("cacheStepOperators = " << std::boolalpha << cacheStepOperators << ": call "
+                                                   << model->extractT0Result(batched[0]) << " expected " << expected);
+        BOOST_CHECK_CLOSE(model->extractT0Result(batched[0]), expected, 1.0);
+        batchedResults.insert(batchedResults.end(), batched.begin(), batched.end());
+    }
+
+    // the cached step operators only lead to rounding differences
+
+    for (Size i = 0; i < 2; ++i) {
+        for (Size j = 0; j < batchedResults[i].size(); ++j)
+            BOOST_CHECK_SMALL(batchedResults[i][j] - batchedResults[i + 2][j], 1E-8);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testPathCache) {
+    BOOST_TEST_MESSAGE("Testing path cache shared between black scholes models...");
+
+    Date ref(7, May, 2019);
+    Settings::instance().evaluationDate() = ref;
+    PathCache::instance().clear();
+
+    constexpr Size nPaths = 1000;
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    std::set<Date> simulationDates = {Date(7, Nov, 2019), Date(7, May, 2020)}, payDates;
+
+    // each model gets its own market objects, so sharing paths relies on the path inputs only
+
+    auto makeModel = [&](const Real vol, const bool usePathCache) {
+        Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(ref, 0.02, dc));
+        Handle<YieldTermStructure> yts0(QuantLib::ext::make_shared<FlatForward>(ref, 0.0, dc));
+        Handle<BlackVolTermStructure> volts(
+            QuantLib::ext::make_shared<BlackConstantVol>(ref, NullCalendar(), vol, dc));
+        auto process = QuantLib::ext::make_shared<GeneralizedBlackScholesProcess>(
+            Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(100.0)), yts0, yts, volts);
+        Model::McParams mcParams;
+        mcParams.usePathCache = usePathCache;
+        return QuantLib::ext::make_shared<BlackScholes>(
+            nPaths, "USD", yts, "EQ-SP5", "USD",
+            BlackScholesModelBuilder(yts, process, simulationDates, payDates, 1).model(), mcParams, simulationDates);
+    };
+
+    auto reference = makeModel(0.18, false);
+    auto model1 = makeModel(0.18, true);
+    auto model2 = makeModel(0.18, true);
+    auto model3 = makeModel(0.25, true);
+
+    for (auto const& d : simulationDates) {
+        RandomVariable v = reference->eval("EQ-SP5", d, Null<Date>());
+        for (auto const& m : {model1, model2}) {
+            RandomVariable w = m->eval("EQ-SP5", d, Null<Date>());
+            BOOST_REQUIRE_EQUAL(w.size(), nPaths);
+            for (Size i = 0; i < nPaths; ++i)
+                BOOST_CHECK_CLOSE(w[i], v[i], 1E-12);
+        }
+    }
+    BOOST_CHECK_EQUAL(PathCache::instance().size(), 1);
+    BOOST_CHECK_EQUAL(PathCache::instance().hits(), 1);
+
+    // different inputs lead to different paths
+
+    BOOST_CHECK(!close_enough_all(model3->eval("EQ-SP5", *simulationDates.rbegin(), Null<Date>()),
+                                  reference->eval("EQ-SP5", *simulationDates.rbegin(), Null<Date>())));
+    BOOST_CHECK_EQUAL(PathCache::instance().size(), 2);
+    BOOST_CHECK_EQUAL(PathCache::instance().hits(), 1);
+
+    // the least recently used entry is removed when the cache is full
+
+    PathCache::instance().setMaxSize(1);
+    BOOST_CHECK_EQUAL(PathCache::instance().size(), 1);
+    PathCache::instance().setMaxSize(4);
+
+    PathCache::instance().clear();
+    BOOST_CHECK_EQUAL(PathCache::instance().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testPathSlices) {
+    BOOST_TEST_MESSAGE("Testing script runs on path slices...");
+
+    Date ref(7, May, 2019);
+    Settings::instance().evaluationDate() = ref;
+
+    std::string script = "NUMBER Payoff;\n"
+                         "Payoff = max(PutCall * (Underlying(Expiry) - Strike), 0);\n"
+                         "Option = Quantity * PAY(Payoff, Expiry, Settlement, PayCcy);\n"
+                         "Discount = DISCOUNT(Expiry, Settlement, PayCcy);";
+    ScriptParser parser(script);
+    BOOST_REQUIRE(parser.success());
+
+    Date expiry(7, May, 2020);
+    Date settlement(9, May, 2020);
+    constexpr Size nPaths = 1000;
+
+    Context initialContext;
+    initialContext.scalars["Quantity"] = RandomVariable(nPaths, 10.0);
+    initialContext.scalars["PutCall"] = RandomVariable(nPaths, 1.0);
+    initialContext.scalars["Strike"] = RandomVariable(nPaths, 100.0);
+    initialContext.scalars["Underlying"] = IndexVec{nPaths, "EQ-SP5"};
+    initialContext.scalars["Expiry"] = EventVec{nPaths, expiry};
+    initialContext.scalars["Settlement"] = EventVec{nPaths, settlement};
+    initialContext.scalars["PayCcy"] = CurrencyVec{nPaths, "USD"};
+    initialContext.scalars["Option"] = RandomVariable(nPaths, 0.0);
+    initialContext.scalars["Discount"] = RandomVariable(nPaths, 0.0);
+
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(ref, 0.02, dc));
+    Handle<YieldTermStructure> yts0(QuantLib::ext::make_shared<FlatForward>(ref, 0.0, dc));
+    Handle<BlackVolTermStructure> volts(QuantLib::ext::make_shared<BlackConstantVol>(ref, NullCalendar(), 0.18, dc));
+    auto process = QuantLib::ext::make_shared<GeneralizedBlackScholesProcess>(
+        Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(100.0)), yts0, yts, volts);
+    std::set<Date> simulationDates = {expiry}, payDates = {settlement};
+    auto model = QuantLib::ext::make_shared<BlackScholes>(
+        nPaths, "USD", yts, "EQ-SP5", "USD",
+        BlackScholesModelBuilder(yts, process, simulationDates, payDates, 1).model(), Model::McParams(),
+        simulationDates);
+
+    auto context = QuantLib::ext::make_shared<Context>(initialContext);
+    ScriptEngine engine(parser.ast(), context, model);
+    BOOST_REQUIRE_NO_THROW(engine.run());
+
+    PathSliceModel::Slices slices(model, 3);
+    BOOST_REQUIRE_EQUAL(slices.size(), 3);
+    std::vector<ASTNodePtr> asts;
+    std::vector<QuantLib::ext::shared_ptr<Context>> contexts;
+    for (Size c = 0; c < slices.size(); ++c) {
+        asts.push_back(parseScript(script));
+        contexts.push_back(QuantLib::ext::make_shared<Context>(initialContext));
+        contexts.back()->resetSize(slices.slice(c)->size());
+    }
+    BOOST_REQUIRE_NO_THROW(slices.run([&asts, &contexts, &slices](const Size c) {
+        ScriptEngine sliceEngine(asts[c], contexts[c], slices.slice(c));
+        sliceEngine.run();
+    }));
+
+    Size n = 0;
+    for (Size c = 0; c < slices.size(); ++c) {
+        BOOST_CHECK_EQUAL(slices.slice(c)->offset(), n);
+        for (auto const& v : {"Option", "Discount"}) {
+            auto const& full = QuantLib::ext::get<RandomVariable>(context->scalars.at(v));
+            auto const& slice = QuantLib::ext::get<RandomVariable>(contexts[c]->scalars.at(v));
+            BOOST_REQUIRE_EQUAL(slice.size(), slices.slice(c)->size());
+            for (Size i = 0; i < slice.size(); ++i)
+                BOOST_CHECK_CLOSE(slice[i], full[n + i], 1E-10);
+        }
+        n += slices.slice(c)->size();
+    }
+    BOOST_CHECK_EQUAL(n, nPaths);
+
+    // errors in the slices are rethrown
+
+    auto npv = [&slices](const Size c) {
+        slices.slice(c)->npv(RandomVariable(slices.slice(c)->size(), 1.0), Date(), Filter(), boost::none,
+                             RandomVariable(), RandomVariable());
+    };
+    BOOST_CHECK_THROW(slices.run(npv), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testMemoisedModelCalls) {
+    BOOST_TEST_MESSAGE("Testing memoisation of model calls...");
+
+    class CountingModel : public DummyModel {
+    public:
+        explicit CountingModel(const Size n) : DummyModel(n) {}
+        RandomVariable eval(const std::string& index, const Date& obsdate, const Date& fwdDate,
+                            const bool returnMissingFixingAsNull, const bool ignoreTodaysFixing) const override {
+            ++evalCalls;
+            return RandomVariable(size(), static_cast<Real>(obsdate.serialNumber()));
+        }
+        RandomVariable pay(const RandomVariable& amount, const Date& obsdate, const Date& paydate,
+                           const std::string& currency) const override {
+            ++payCalls;
+            return amount * RandomVariable(size(), 0.5);
+        }
+        mutable Size evalCalls = 0, payCalls = 0;
+    };
+
+    std::string script = "NUMBER i, x, y, z;\n"
+                         "FOR i IN (1, 5, 1) DO\n"
+                         "  x = x + Underlying(Expiry);\n"
+                         "  y = y + PAY(2, Expiry, Expiry, PayCcy);\n"
+                         "  z = z + PAY(i, Expiry, Expiry, PayCcy);\n"
+                         "END;\n"
+                         "x = x + Underlying(Expiry2);";
+    ScriptParser parser(script);
+    BOOST_REQUIRE(parser.success());
+
+    auto model = QuantLib::ext::make_shared<CountingModel>(2);
+    Context initialContext;
+    initialContext.scalars["Underlying"] = IndexVec{2, "EQ-SP5"};
+    initialContext.scalars["Expiry"] = EventVec{2, Date(7, May, 2030)};
+    initialContext.scalars["Expiry2"] = EventVec{2, Date(8, May, 2030)};
+    initialContext.scalars["PayCcy"] = CurrencyVec{2, "EUR"};
+    auto context = QuantLib::ext::make_shared<Context>(initialContext);
+    ScriptEngine engine(parser.ast(), context, model);
+    BOOST_REQUIRE_NO_THROW(engine.run());
+
+    // identical calls are evaluated twice before the result is stored, calls with different amounts are not shared
+    BOOST_CHECK_EQUAL(model->evalCalls, 3);
+    BOOST_CHECK_EQUAL(model->payCalls, 7);
+    Real d = static_cast<Real>(Date(7, May, 2030).serialNumber());
+    BOOST_CHECK_CLOSE(QuantLib::ext::get<RandomVariable>(context->scalars.at("x")).at(0),
+                      5.0 * d + static_cast<Real>(Date(8, May, 2030).serialNumber()), 1E-12);
+    BOOST_CHECK_CLOSE(QuantLib::ext::get<RandomVariable>(context->scalars.at("y")).at(0), 5.0, 1E-12);
+    BOOST_CHECK_CLOSE(QuantLib::ext::get<RandomVariable>(context->scalars.at("z")).at(0), 7.5, 1E-12);
+
+    // the memoised results are not reused in a new run
+    ScriptEngine engine2(parser.ast(), QuantLib::ext::make_shared<Context>(initialContext), model);
+    BOOST_REQUIRE_NO_THROW(engine2.run());
+    BOOST_CHECK_EQUAL(model->evalCalls, 6);
+}
+
+BOOST_AUTO_TEST_CASE(testPathwiseSensitivities) {
+    BOOST_TEST_MESSAGE("Testing pathwise sensitivities from the scripted instrument pricing engine...");
+
+    Date ref(7, May, 2019);
+    Settings::instance().evaluationDate() = ref;
+
+    std::string script = "Option = Quantity * PAY(max( PutCall * (Underlying(Expiry) - Strike), 0 ),\n"
+                         "                        Expiry, Settlement, PayCcy);";
+    ScriptParser parser(script);
+    BOOST_REQUIRE(parser.success());
+
+    Real s0 = 100.0, vol = 0.18, quantity = 10.0, strike = 100.0;
+    Date expiry(7, May, 2020);
+    Date settlement(9, May, 2020);
+    constexpr Size nPaths = 10000;
+
+    auto context = QuantLib::ext::make_shared<Context>();
+    context->scalars["Quantity"] = RandomVariable(nPaths, quantity);
+    context->scalars["PutCall"] = RandomVariable(nPaths, 1.0);
+    context->scalars["Strike"] = RandomVariable(nPaths, strike);
+    context->scalars["Underlying"] = IndexVec{nPaths, "EQ-SP5"};
+    context->scalars["Expiry"] = EventVec{nPaths, expiry};
+    context->scalars["Settlement"] = EventVec{nPaths, settlement};
+    context->scalars["PayCcy"] = CurrencyVec{nPaths, "USD"};
+    context->scalars["Option"] = RandomVariable(nPaths, 0.0);
+
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(ref, 0.02, dc));
+    Handle<YieldTermStructure> yts0(QuantLib::ext::make_shared<FlatForward>(ref, 0.0, dc));
+    Handle<BlackVolTermStructure> volts(QuantLib::ext::make_shared<BlackConstantVol>(ref, NullCalendar(), vol, dc));
+    auto spot = QuantLib::ext::make_shared<SimpleQuote>(s0);
+    auto process = QuantLib::ext::make_shared<GeneralizedBlackScholesProcess>(Handle<Quote>(spot), yts0, yts, volts);
+    std::set<Date> simulationDates = {expiry}, payDates = {settlement};
+    auto model = QuantLib::ext::make_shared<BlackScholes>(
+        nPaths, "USD", yts, "EQ-SP5", "USD",
+        BlackScholesModelBuilder(yts, process, simulationDates, payDates, 1).model(), Model::McParams(),
+        simulationDates);
+
+    auto instrument = QuantLib::ext::make_shared<QuantExt::ScriptedInstrument>(settlement);
+    instrument->setPricingEngine(QuantLib::ext::make_shared<ScriptedInstrumentPricingEngine>(
+        "Option", std::vector<std::pair<std::string, std::string>>(), model, parser.ast(), context, script, false,
+        false, std::set<std::string>(), false, false, nullptr, 1, true));
+
+    Real npv = 0.0, delta = 0.0, vega = 0.0;
+    BOOST_REQUIRE_NO_THROW(npv = instrument->NPV());
+    BOOST_REQUIRE_NO_THROW(delta = instrument->result<Real>("PathwiseSensitivity_Spot_EQ-SP5"));
+    BOOST_REQUIRE_NO_THROW(vega = instrument->result<Real>("PathwiseSensitivity_Vol_EQ-SP5"));
+    BOOST_TEST_MESSAGE("npv = " << npv << ", delta = " << delta << ", vega = " << vega);
+
+    // check against the analytical values
+
+    Real t = yts->timeFromReference(expiry);
+    BlackCalculator black(Option::Call, strike, s0 / yts->discount(expiry), vol * std::sqrt(t),
+                          yts->discount(settlement));
+    BOOST_TEST_MESSAGE("expected npv = " << quantity * black.value() << ", delta = " << quantity * black.delta(s0)
+                                         << ", vega = " << quantity * black.vega(t));
+    BOOST_CHECK_CLOSE(npv, quantity * black.value(), 0.5);
+    BOOST_CHECK_CLOSE(delta, quantity * black.delta(s0), 1.0);
+    BOOST_CHECK_CLOSE(vega, quantity * black.vega(t), 2.0);
+
+    // check the delta against bump and revaluation on the same paths
+
+    Real h = 0.01 * s0;
+    spot->setValue(s0 + h);
+    Real npvUp = instrument->NPV();
+    spot->setValue(s0 - h);
+    Real npvDown = instrument->NPV();
+    spot->setValue(s0);
+    BOOST_TEST_MESSAGE("bump and revaluation delta = " << (npvUp - npvDown) / (2.0 * h));
+    BOOST_CHECK_CLOSE(delta, (npvUp - npvDown) / (2.0 * h), 0.5);
+
+    // barrier probabilities are not differentiated, so a script using them is rejected
+
+    std::string barrierScript = "Option = Quantity * PAY(BELOWPROB(Underlying, TODAY, Expiry, Strike),\n"
+                                "                        Expiry, Settlement, PayCcy);";
+    ScriptParser barrierParser(barrierScript);
+    BOOST_REQUIRE(barrierParser.success());
+    auto barrierInstrument = QuantLib::ext::make_shared<QuantExt::ScriptedInstrument>(settlement);
+    barrierInstrument->setPricingEngine(QuantLib::ext::make_shared<ScriptedInstrumentPricingEngine>(
+        "Option", std::vector<std::pair<std::string, std::string>>(), model, barrierParser.ast(), context,
+        barrierScript, false, false, std::set<std::string>(), false, false, nullptr, 1, true));
+    BOOST_CHECK_THROW(barrierInstrument->NPV(), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testControlVariates) {
+    BOOST_TEST_MESSAGE("Testing control variates in the scripted instrument pricing engine...");
+
+    Date ref(7, May, 2019);
+    Settings::instance().evaluationDate() = ref;
+
+    // the control payoff is the underlying paid at the option's settlement date
+
+    std::string script = "Option = Quantity * PAY(max( PutCall * (Underlying(Expiry) - Strike), 0 ),\n"
+                         "                        Expiry, Settlement, PayCcy);\n"
+                         "Control = PAY(Underlying(Expiry), Expiry, Settlement, PayCcy);";
+    ScriptParser parser(script);
+    BOOST_REQUIRE(parser.success());
+
+    Real s0 = 100.0, vol = 0.18, quantity = 10.0, strike = 100.0;
+    Date expiry(7, May, 2020);
+    Date settlement(9, May, 2020);
+    constexpr Size nPaths = 10000;
+
+    DayCounter dc = ActualActual(ActualActual::ISDA);
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(ref, 0.02, dc));
+    Handle<YieldTermStructure> yts0(QuantLib::ext::make_shared<FlatForward>(ref, 0.0, dc));
+    Handle<BlackVolTermStructure> volts(QuantLib::ext::make_shared<BlackConstantVol>(ref, NullCalendar(), vol, dc));
+    auto process = QuantLib::ext::make_shared<GeneralizedBlackScholesProcess>(
+        Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(s0)), yts0, yts, volts);
+
+    auto context = QuantLib::ext::make_shared<Context>();
+    context->scalars["Quantity"] = RandomVariable(nPaths, quantity);
+    context->scalars["PutCall"] = RandomVariable(nPaths, 1.0);
+    context->scalars["Strike"] = RandomVariable(nPaths, strike);
+    context->scalars["Underlying"] = IndexVec{nPaths, "EQ-SP5"};
+    context->scalars["Expiry"] = EventVec{nPaths, expiry};
+    context->scalars["Settlement"] = EventVec{nPaths, settlement};
+    context->scalars["PayCcy"] = CurrencyVec{nPaths, "USD"};
+    context->scalars["Option"] = RandomVariable(nPaths, 0.0);
+    context->scalars["Control"] = RandomVariable(nPaths, 0.0);
+    context->scalars["ControlPrice"] =
+        RandomVariable(nPaths, s0 / yts->discount(expiry) * yts->discount(settlement));
+
+    std::set<Date> simulationDates = {expiry}, payDates = {settlement};
+    Model::McParams mcParams;
+    mcParams.sequenceType = QuantExt::SequenceType::MersenneTwister;
+    auto model = QuantLib::ext::make_shared<BlackScholes>(
+        nPaths, "USD", yts, "EQ-SP5", "USD",
+        BlackScholesModelBuilder(yts, process, simulationDates, payDates, 1).model(), mcParams, simulationDates);
+
+    auto plain = QuantLib::ext::make_shared<QuantExt::ScriptedInstrument>(settlement);
+    plain->setPricingEngine(QuantLib::ext::make_shared<ScriptedInstrumentPricingEngine>(
+        "Option", std::vector<std::pair<std::string, std::string>>(), model, parser.ast(), context, script, false,
+        false, std::set<std::string>(), true));
+    auto controlled = QuantLib::ext::make_shared<QuantExt::ScriptedInstrument>(settlement);
+    controlled->setPricingEngine(QuantLib::ext::make_shared<ScriptedInstrumentPricingEngine>(
+        "Option", std::vector<std::pair<std::string, std::string>>(), model, parser.ast(), context, script, false,
+        false, std::set<std::string>(), true, false, nullptr, 1, false, false,
+        std::vector<std::pair<std::string, std::string>>{{"Control", "ControlPrice"}}));
+
+    Real npvPlain = plain->NPV(), errPlain = plain->errorEstimate();
+    Real npvControlled = controlled->NPV(), errControlled = controlled->errorEstimate();
+    Real beta = controlled->result<Real>("ControlVariateBeta_Control");
+    BOOST_TEST_MESSAGE("plain mc      : npv = " << npvPlain << ", error estimate = " << errPlain);
+    BOOST_TEST_MESSAGE("control variate: npv = " << npvControlled << ", error estimate = " << errControlled
+                                                 << ", beta = " << beta);
+
+    Real t = yts->timeFromReference(expiry);
+    Real expected = quantity * blackFormula(Option::Call, strike, s0 / yts->discount(expiry), vol * std::sqrt(t),
+                                            yts->discount(settlement));
+    BOOST_TEST_MESSAGE("expected npv   = " << expected);
+
+    // the unadjusted npv is kept as an additional result, the adjusted one must be closer to the analytical value
+
+    BOOST_CHECK_CLOSE(controlled->result<Real>("NPV_WithoutControlVariates"), npvPlain, 1.0E-10);
+    BOOST_CHECK(beta > 0.0);
+    BOOST_CHECK_SMALL(npvControlled - expected, 3.0 * errControlled);
+    BOOST_CHECK(errControlled < 0.6 * errPlain);
+}
+
 BOOST_AUTO_TEST_CASE(testInteractive, *boost::unit_test::disabled()) {
 
     // not a test, just for convenience, to be removed at some stage...
@@ -830,6 +830,34 @@ BOOST_AUTO_TEST_CASE(testZeroSpreadedYieldCurve) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testLazyBuild) {
+
+    BOOST_TEST_MESSAGE("Testing lazy build of todays market...");
+
+    Date asof(26, February, 2016);
+    auto lazyMarket = QuantLib::ext::make_shared<TodaysMarket>(
+        asof, marketParameters(), QuantLib::ext::make_shared<MarketDataLoader>(), curveConfigurations(), false, true,
+        true);
+
+    // nothing is built on construction
+    BOOST_CHECK(lazyMarket->builtObjects().empty());
+
+    Handle<YieldTermStructure> dtsLend = lazyMarket->yieldCurve("EUR_LEND");
+    BOOST_REQUIRE(!dtsLend.empty());
+
+    // the lending curve and the discount curve it is spread over are built, unrelated objects are not
+    auto b = lazyMarket->builtObjects().find(Market::defaultConfiguration);
+    BOOST_REQUIRE(b != lazyMarket->builtObjects().end());
+    BOOST_CHECK(b->second.count(std::make_pair(MarketObject::YieldCurve, std::string("EUR_LEND"))) == 1);
+    BOOST_CHECK(b->second.count(std::make_pair(MarketObject::YieldCurve, std::string("EUR_BORROW"))) == 0);
+    BOOST_CHECK(b->second.count(std::make_pair(MarketObject::EquityCurve, std::string("SP5"))) == 0);
+
+    // the lazily built curve coincides with the one from the fully built market
+    Handle<YieldTermStructure> dtsLendFull = market->yieldCurve("EUR_LEND");
+    Date d = asof + 5 * Years;
+    BOOST_CHECK_CLOSE(dtsLend->discount(d), dtsLendFull->discount(d), 1.0e-10);
+}
+
 BOOST_AUTO_TEST_CASE(testNormalOptionletVolatility) {
 
     BOOST_TEST_MESSAGE("Testing normal optionlet volatilities...");
@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ored/utilities/trace.hpp>
+#include <oret/toplevelfixture.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace ore::data;
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(TraceTests)
+
+BOOST_AUTO_TEST_CASE(testTraceScopes) {
+
+    BOOST_TEST_MESSAGE("Testing trace scopes...");
+
+    Trace::instance().disable();
+    bool evaluated = false;
+    {
+        ORE_TRACE_SCOPE((evaluated = true, "disabled"));
+    }
+    BOOST_CHECK(!evaluated);
+
+    Trace::instance().enable();
+    BOOST_CHECK_EQUAL(Trace::instance().size(), 0u);
+    {
+        ORE_TRACE_SCOPE("outer");
+        {
+            ORE_TRACE_SCOPE("inner");
+        }
+        std::thread t([]() { ORE_TRACE_SCOPE("worker"); });
+        t.join();
+    }
+    Trace::instance().disable();
+    {
+        ORE_TRACE_SCOPE("ignored");
+    }
+    BOOST_CHECK_EQUAL(Trace::instance().size(), 3u);
+
+    std::string fileName = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    Trace::instance().writeChromeTrace(fileName);
+    std::ifstream in(fileName);
+    std::stringstream s;
+    s << in.rdbuf();
+    in.close();
+    boost::filesystem::remove(fileName);
+    std::string json = s.str();
+    BOOST_TEST_MESSAGE(json);
+    for (auto const& n : {"\"outer\"", "\"inner\"", "\"worker\"", "\"main\"", "\"thread 1\""})
+        BOOST_CHECK_MESSAGE(json.find(n) != std::string::npos, "expected " << n << " in trace");
+    BOOST_CHECK(json.find("\"ignored\"") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
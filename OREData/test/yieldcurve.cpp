@@ -21,6 +21,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/data/test_case.hpp>
 // clang-format on
+#include <ored/marketdata/bootstrapwarmstarts.hpp>
 #include <ored/marketdata/csvloader.hpp>
 #include <ored/marketdata/loader.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
@@ -246,6 +247,54 @@ BOOST_AUTO_TEST_CASE(testBootstrapAndFixings) {
     BOOST_CHECK_NO_THROW(YieldCurve jpyYieldCurve(asof, spec, curveConfigs, loader));
 }
 
+BOOST_AUTO_TEST_CASE(testBootstrapWarmStart) {
+
+    BOOST_TEST_MESSAGE("Testing bootstrap warm start across curve builds...");
+
+    Date asof(31, August, 2015);
+    Settings::instance().evaluationDate() = asof;
+
+    YieldCurveSpec spec("JPY", "JPY6M");
+
+    vector<string> quoteNames{"IR_SWAP/RATE/JPY/2D/6M/2Y", "IR_SWAP/RATE/JPY/2D/6M/5Y", "IR_SWAP/RATE/JPY/2D/6M/10Y"};
+    CurveConfigurations curveConfigs;
+    vector<QuantLib::ext::shared_ptr<YieldCurveSegment>> segments{
+        QuantLib::ext::make_shared<SimpleYieldCurveSegment>("Swap", "JPY-SWAP-CONVENTIONS", quoteNames)};
+    curveConfigs.add(CurveSpec::CurveType::Yield, "JPY6M",
+                     QuantLib::ext::make_shared<YieldCurveConfig>("JPY6M", "JPY 6M curve", "JPY", "", segments));
+
+    QuantLib::ext::shared_ptr<Conventions> conventions = QuantLib::ext::make_shared<Conventions>();
+    conventions->add(QuantLib::ext::make_shared<IRSwapConvention>("JPY-SWAP-CONVENTIONS", "JP", "Semiannual", "MF",
+                                                                  "A365", "JPY-LIBOR-6M"));
+    InstrumentConventions::instance().setConventions(conventions);
+
+    auto loader = [&quoteNames](const Real shift) {
+        vector<Real> rates{0.0022875, 0.0031, 0.0055};
+        vector<string> data;
+        for (Size i = 0; i < quoteNames.size(); ++i)
+            data.push_back("20150831 " + quoteNames[i] + " " + ore::data::to_string(rates[i] + shift));
+        return MarketDataLoader(data);
+    };
+
+    Date d = asof + 7 * Years;
+
+    // reference curve with shifted quotes, built without warm start
+    YieldCurve reference(asof, spec, curveConfigs, loader(1.0E-5));
+
+    BootstrapWarmStarts::instance().enable(true);
+    YieldCurve base(asof, spec, curveConfigs, loader(0.0));
+    YieldCurve shifted(asof, spec, curveConfigs, loader(1.0E-5));
+
+    auto stats = BootstrapWarmStarts::instance().statistics();
+    BootstrapWarmStarts::instance().enable(false);
+
+    BOOST_REQUIRE(stats.find(spec.name()) != stats.end());
+    BOOST_CHECK_EQUAL(stats[spec.name()].calculations, Size(2));
+    BOOST_CHECK_EQUAL(stats[spec.name()].hits, Size(1));
+    BOOST_CHECK_EQUAL(stats[spec.name()].rejections, Size(0));
+    BOOST_CHECK_CLOSE(shifted.handle()->discount(d), reference.handle()->discount(d), 1.0E-8);
+}
+
 BOOST_AUTO_TEST_CASE(testBuildDiscountCurveDirectSegment) {
 
     Date asof(13, October, 2023);
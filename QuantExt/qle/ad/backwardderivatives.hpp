@@ -23,13 +23,63 @@
 #pragma once
 
 #include <qle/ad/computationgraph.hpp>
+#include <qle/ad/forwardevaluation.hpp>
 
 #include <ql/errors.hpp>
 
 #include <ql/shared_ptr.hpp>
 
+#include <algorithm>
+
 namespace QuantExt {
 
+namespace detail {
+
+// propagate the derivative at a node to its predecessors
+template <class T>
+void propagateDerivative(const ComputationGraph& g, const std::size_t node, std::vector<T>& values,
+                         std::vector<T>& derivatives,
+                         const std::vector<std::function<std::vector<T>(const std::vector<const T*>&, const T*)>>& grad,
+                         const std::size_t conditionalExpectationOpId,
+                         const std::function<T(const std::vector<const T*>&)>& conditionalExpectation) {
+
+    if (g.predecessors(node).empty() || isDeterministicAndZero(derivatives[node]))
+        return;
+
+    std::vector<const T*> args(g.predecessors(node).size());
+    for (std::size_t arg = 0; arg < g.predecessors(node).size(); ++arg) {
+        args[arg] = &values[g.predecessors(node)[arg]];
+    }
+
+    QL_REQUIRE(derivatives[node].initialised(),
+               "backwardDerivatives(): derivative at active node " << node << " is not initialized.");
+
+    if (g.opId(node) == conditionalExpectationOpId && conditionalExpectation) {
+
+        // expected stochastic automatic differentiaion, Fries, 2017
+        args[0] = &derivatives[node];
+        derivatives[g.predecessors(node)[0]] += conditionalExpectation(args);
+
+    } else {
+
+        auto gr = grad[g.opId(node)](args, &values[node]);
+
+        for (std::size_t p = 0; p < g.predecessors(node).size(); ++p) {
+            QL_REQUIRE(derivatives[g.predecessors(node)[p]].initialised(),
+                       "backwardDerivatives: derivative at node "
+                           << g.predecessors(node)[p] << " not initialized, which is an active predecessor of "
+                           << node);
+            QL_REQUIRE(gr[p].initialised(),
+                       "backwardDerivatives: gradient at node "
+                           << node << " (opId " << g.opId(node) << ") not initialized at component " << p
+                           << " but required to push to predecessor " << g.predecessors(node)[p]);
+            derivatives[g.predecessors(node)[p]] += derivatives[node] * gr[p];
+        }
+    }
+}
+
+} // namespace detail
+
 template <class T>
 void backwardDerivatives(const ComputationGraph& g, std::vector<T>& values, std::vector<T>& derivatives,
                          const std::vector<std::function<std::vector<T>(const std::vector<const T*>&, const T*)>>& grad,
@@ -79,41 +129,8 @@ void backwardDerivatives(const ComputationGraph& g, std::vector<T>& values, std:
             redBlockId = g.redBlockId(node);
         }
 
-        if (!g.predecessors(node).empty() && !isDeterministicAndZero(derivatives[node])) {
-
-            // propagate the derivative at a node to its predecessors
-
-            std::vector<const T*> args(g.predecessors(node).size());
-            for (std::size_t arg = 0; arg < g.predecessors(node).size(); ++arg) {
-                args[arg] = &values[g.predecessors(node)[arg]];
-            }
-
-            QL_REQUIRE(derivatives[node].initialised(),
-                       "backwardDerivatives(): derivative at active node " << node << " is not initialized.");
-
-            if (g.opId(node) == conditionalExpectationOpId && conditionalExpectation) {
-
-                // expected stochastic automatic differentiaion, Fries, 2017
-                args[0] = &derivatives[node];
-                derivatives[g.predecessors(node)[0]] += conditionalExpectation(args);
-
-            } else {
-
-                auto gr = grad[g.opId(node)](args, &values[node]);
-
-                for (std::size_t p = 0; p < g.predecessors(node).size(); ++p) {
-                    QL_REQUIRE(derivatives[g.predecessors(node)[p]].initialised(),
-                               "backwardDerivatives: derivative at node "
-                                   << g.predecessors(node)[p] << " not initialized, which is an active predecessor of "
-                                   << node);
-                    QL_REQUIRE(gr[p].initialised(),
-                               "backwardDerivatives: gradient at node "
-                                   << node << " (opId " << g.opId(node) << ") not initialized at component " << p
-                                   << " but required to push to predecessor " << g.predecessors(node)[p]);
-                    derivatives[g.predecessors(node)[p]] += derivatives[node] * gr[p];
-                }
-            }
-        }
+        detail::propagateDerivative(g, node, values, derivatives, grad, conditionalExpectationOpId,
+                                    conditionalExpectation);
 
         // then check if we can delete the node
 
@@ -132,4 +149,55 @@ void backwardDerivatives(const ComputationGraph& g, std::vector<T>& values, std:
     } // for node
 }
 
+/*! Backward derivatives with checkpointing: the forward evaluation preceding this call only needs to keep the nodes
+    given by checkpointKeepNodes(g, checkpointInterval, fwdKeepNodes). The graph is processed in segments of
+    checkpointInterval nodes in reverse order. For each segment the values are recomputed from the kept nodes, the
+    derivatives are propagated through the segment and the recomputed values are released again. This trades one
+    additional forward evaluation for the memory otherwise needed to keep all values required for the derivatives.
+    Since the values are recomputed for each segment anyway, red blocks do not need a special treatment here. */
+template <class T>
+void backwardDerivativesCheckpointed(
+    const ComputationGraph& g, std::vector<T>& values, std::vector<T>& derivatives,
+    const std::vector<std::function<std::vector<T>(const std::vector<const T*>&, const T*)>>& grad,
+    std::function<void(T&)> deleter, const std::vector<bool>& keepNodes,
+    const std::vector<std::function<T(const std::vector<const T*>&)>>& fwdOps, const std::vector<bool>& fwdKeepNodes,
+    const std::size_t checkpointInterval, const std::size_t conditionalExpectationOpId = 0,
+    const std::function<T(const std::vector<const T*>&)>& conditionalExpectation = {}) {
+
+    QL_REQUIRE(checkpointInterval > 0, "backwardDerivativesCheckpointed(): checkpointInterval must be positive");
+
+    if (g.size() == 0)
+        return;
+
+    std::size_t nSegments = (g.size() - 1) / checkpointInterval + 1;
+
+    for (std::size_t segment = nSegments; segment > 0; --segment) {
+
+        std::size_t start = (segment - 1) * checkpointInterval;
+        std::size_t end = std::min(g.size(), start + checkpointInterval);
+
+        // recompute the values in the segment, the args from previous segments are kept by checkpointKeepNodes()
+
+        forwardEvaluation(g, values, fwdOps, {}, false, {}, {}, start, end);
+
+        // propagate the derivatives through the segment
+
+        for (std::size_t node = end; node > start; --node) {
+            detail::propagateDerivative(g, node - 1, values, derivatives, grad, conditionalExpectationOpId,
+                                        conditionalExpectation);
+            if (deleter && (keepNodes.empty() || !keepNodes[node - 1]))
+                deleter(derivatives[node - 1]);
+        }
+
+        // release the values in the segment, they are not required by the previous segments
+
+        if (deleter) {
+            for (std::size_t node = start; node < end; ++node) {
+                if (fwdKeepNodes.empty() || !fwdKeepNodes[node])
+                    deleter(values[node]);
+            }
+        }
+    }
+}
+
 } // namespace QuantExt
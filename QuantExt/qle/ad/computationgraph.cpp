@@ -23,7 +23,16 @@
 #include <ql/errors.hpp>
 #include <ql/math/comparison.hpp>
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/math/distributions/normal.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <fstream>
 
 namespace QuantExt {
 
@@ -40,6 +49,7 @@ void ComputationGraph::clear() {
     variables_.clear();
     variableVersion_.clear();
     labels_.clear();
+    nodeByOp_.clear();
 }
 
 std::size_t ComputationGraph::size() const { return predecessors_.size(); }
@@ -59,6 +69,15 @@ std::size_t ComputationGraph::insert(const std::string& label) {
 
 std::size_t ComputationGraph::insert(const std::vector<std::size_t>& predecessors, const std::size_t opId,
                                      const std::string& label) {
+    if (enableCse_ && opId != 0) {
+        auto key = std::make_tuple(opId, currentRedBlockId_, predecessors);
+        if (auto n = nodeByOp_.find(key); n != nodeByOp_.end()) {
+            if (enableLabels_ && !label.empty())
+                labels_[n->second].insert(label);
+            return n->second;
+        }
+        nodeByOp_[key] = predecessors_.size();
+    }
     std::size_t node = predecessors_.size();
     predecessors_.push_back(predecessors);
     opId_.push_back(opId);
@@ -155,8 +174,15 @@ void ComputationGraph::setVariable(const std::string& name, const std::size_t no
     }
 }
 
+void ComputationGraph::enableCommonSubexpressionElimination(const bool b) { enableCse_ = b; }
+
 void ComputationGraph::enableLabels(const bool b) { enableLabels_ = b; }
 
+void ComputationGraph::addLabel(const std::size_t node, const std::string& label) {
+    if (enableLabels_ && !label.empty())
+        labels_[node].insert(label);
+}
+
 const std::map<std::size_t, std::set<std::string>>& ComputationGraph::labels() const { return labels_; }
 
 void ComputationGraph::startRedBlock() {
@@ -184,6 +210,45 @@ bool ComputationGraph::isConstant(const std::size_t node) const { return isConst
 
 double ComputationGraph::constantValue(const std::size_t node) const { return constantValue_[node]; }
 
+template <class Archive> void ComputationGraph::serialize(Archive& ar, const unsigned int version) {
+    ar& predecessors_;
+    ar& opId_;
+    ar& isConstant_;
+    ar& constantValue_;
+    ar& maxNodeRequiringArg_;
+    ar& redBlockId_;
+    ar& constants_;
+    ar& variables_;
+    ar& variableVersion_;
+    ar& enableLabels_;
+    ar& labels_;
+    ar& currentRedBlockId_;
+    ar& nextRedBlockId_;
+    ar& redBlockRange_;
+    ar& redBlockDependencies_;
+}
+
+template void ComputationGraph::serialize(boost::archive::binary_oarchive& ar, const unsigned int version);
+template void ComputationGraph::serialize(boost::archive::binary_iarchive& ar, const unsigned int version);
+
+void saveComputationGraph(const ComputationGraph& g, const std::string& filename) {
+    std::ofstream os(filename.c_str(), std::ios::binary);
+    QL_REQUIRE(os.is_open(), "saveComputationGraph(): could not open file '" << filename << "'");
+    boost::archive::binary_oarchive oa(os);
+    oa << g;
+}
+
+void loadComputationGraph(ComputationGraph& g, const std::string& filename) {
+    std::ifstream is(filename.c_str(), std::ios::binary);
+    QL_REQUIRE(is.is_open(), "loadComputationGraph(): could not open file '" << filename << "'");
+    try {
+        boost::archive::binary_iarchive ia(is);
+        ia >> g;
+    } catch (const std::exception& e) {
+        QL_FAIL("loadComputationGraph(): could not read computation graph from '" << filename << "': " << e.what());
+    }
+}
+
 std::size_t cg_const(ComputationGraph& g, const double value) { return g.constant(value); }
 
 std::size_t cg_insert(ComputationGraph& g, const std::string& label) { return g.insert(label); }
@@ -23,10 +23,12 @@
 #pragma once
 
 #include <boost/integer.hpp>
+#include <boost/serialization/access.hpp>
 
 #include <map>
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace QuantExt {
@@ -57,7 +59,13 @@ public:
     const std::map<std::string, std::size_t>& variables() const;
     void setVariable(const std::string& name, const std::size_t node);
 
+    /*! If enabled, inserting an operation with the same op id and predecessors as an existing node in the same red
+        block returns the existing node instead of adding a new one. */
+    void enableCommonSubexpressionElimination(const bool b = true);
+    bool commonSubexpressionElimination() const { return enableCse_; }
+
     void enableLabels(const bool b = true);
+    void addLabel(const std::size_t node, const std::string& label);
     const std::map<std::size_t, std::set<std::string>>& labels() const;
 
     void startRedBlock();
@@ -67,6 +75,9 @@ public:
     const std::set<std::size_t>& redBlockDependencies() const;
 
 private:
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version);
+
     std::vector<std::vector<std::size_t>> predecessors_;
     std::vector<std::size_t> opId_;
     std::vector<bool> isConstant_;
@@ -79,6 +90,9 @@ private:
     std::map<std::string, std::size_t> variables_;
     std::map<std::string, std::size_t> variableVersion_;
 
+    bool enableCse_ = false;
+    std::map<std::tuple<std::size_t, std::size_t, std::vector<std::size_t>>, std::size_t> nodeByOp_;
+
     bool enableLabels_ = false;
     std::map<std::size_t, std::set<std::string>> labels_;
 
@@ -88,6 +102,14 @@ private:
     std::set<std::size_t> redBlockDependencies_;
 };
 
+/*! Writes the graph to a binary file, this includes the variables, labels and red block information. Model parameters
+    are variables of the graph, their bindings to the nodes are therefore restored by loadComputationGraph() as well.
+    The ops themselves are not part of the file, only their ids. */
+void saveComputationGraph(const ComputationGraph& g, const std::string& filename);
+
+/*! Reads a graph written by saveComputationGraph(), the current content of g is replaced. */
+void loadComputationGraph(ComputationGraph& g, const std::string& filename);
+
 // methods to construct cg
 
 std::size_t cg_const(ComputationGraph& g, const double value);
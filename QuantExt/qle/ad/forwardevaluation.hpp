@@ -23,7 +23,9 @@
 #pragma once
 
 #include <qle/ad/computationgraph.hpp>
+#include <qle/ad/memoryplan.hpp>
 
+#include <ql/errors.hpp>
 #include <ql/shared_ptr.hpp>
 
 namespace QuantExt {
@@ -109,4 +111,48 @@ void forwardEvaluation(const ComputationGraph& g, std::vector<T>& values,
     }         // for node
 }
 
+/*! forward evaluation using a memory plan, the value of node n is read from resp. written to arena[plan.slot(n)],
+    the inputs must be populated before the evaluation, the deleter is applied to slots that are released */
+template <class T>
+void forwardEvaluation(const ComputationGraph& g, const ComputationGraphMemoryPlan& plan, std::vector<T>& arena,
+                       const std::vector<std::function<T(const std::vector<const T*>&)>>& ops,
+                       std::function<void(T&)> deleter = {}) {
+
+    QL_REQUIRE(plan.size() == g.size(), "forwardEvaluation(): memory plan size (" << plan.size()
+                                                                                 << ") does not match graph size ("
+                                                                                 << g.size() << ")");
+    QL_REQUIRE(arena.size() >= plan.numberOfSlots(), "forwardEvaluation(): arena size ("
+                                                          << arena.size() << ") must be at least "
+                                                          << plan.numberOfSlots());
+
+    std::vector<const T*> args;
+    for (std::size_t node = 0; node < g.size(); ++node) {
+
+        if (!g.predecessors(node).empty()) {
+
+            args.resize(g.predecessors(node).size());
+            for (std::size_t arg = 0; arg < g.predecessors(node).size(); ++arg) {
+                args[arg] = &arena[plan.slot(g.predecessors(node)[arg])];
+            }
+
+            // the result might be stored in the slot of one of the args, so we assign it after the op is evaluated
+
+            T result = ops[g.opId(node)](args);
+
+            QL_REQUIRE(result.initialised(), "forwardEvaluation(): value at active node "
+                                                 << node << " is not initialized, opId = " << g.opId(node));
+
+            arena[plan.slot(node)] = std::move(result);
+
+            if (deleter) {
+                for (auto const s : plan.releasedSlots(node))
+                    deleter(arena[s]);
+            }
+        }
+
+        if (deleter && plan.isDead(node))
+            deleter(arena[plan.slot(node)]);
+    }
+}
+
 } // namespace QuantExt
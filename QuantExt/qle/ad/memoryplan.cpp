@@ -0,0 +1,108 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/ad/memoryplan.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+
+namespace QuantExt {
+
+ComputationGraphMemoryPlan::ComputationGraphMemoryPlan(const ComputationGraph& g, const std::vector<bool>& keepNodes)
+    : slot_(g.size(), ComputationGraph::nan), lastUse_(g.size(), ComputationGraph::nan), releasedSlots_(g.size()),
+      isDead_(g.size(), false) {
+
+    QL_REQUIRE(keepNodes.empty() || keepNodes.size() == g.size(),
+               "ComputationGraphMemoryPlan: keepNodes size (" << keepNodes.size() << ") does not match graph size ("
+                                                              << g.size() << ")");
+
+    // determine the lifetimes, maxNodeRequiringArg = 0 means that the node is not used by any other node
+
+    for (std::size_t n = 0; n < g.size(); ++n) {
+        if ((keepNodes.empty() || !keepNodes[n]) && g.maxNodeRequiringArg(n) > 0)
+            lastUse_[n] = g.maxNodeRequiringArg(n);
+    }
+
+    // inputs get dedicated slots
+
+    for (std::size_t n = 0; n < g.size(); ++n) {
+        if (g.predecessors(n).empty())
+            slot_[n] = numberOfSlots_++;
+    }
+
+    // linear scan over the op nodes, the slots of args that are used for the last time are released before the slot
+    // for the node is allocated, so that the result of an op can be stored in the slot of one of its args
+
+    std::vector<std::size_t> freeSlots;
+    for (std::size_t n = 0; n < g.size(); ++n) {
+        for (auto const p : g.predecessors(n)) {
+            if (lastUse_[p] == n && std::find(releasedSlots_[n].begin(), releasedSlots_[n].end(), slot_[p]) ==
+                                        releasedSlots_[n].end()) {
+                releasedSlots_[n].push_back(slot_[p]);
+                freeSlots.push_back(slot_[p]);
+            }
+        }
+        if (!g.predecessors(n).empty()) {
+            if (freeSlots.empty()) {
+                slot_[n] = numberOfSlots_++;
+            } else {
+                slot_[n] = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            // the result slot might be one of the released args' slots, it is not released then
+            auto r = std::find(releasedSlots_[n].begin(), releasedSlots_[n].end(), slot_[n]);
+            if (r != releasedSlots_[n].end())
+                releasedSlots_[n].erase(r);
+        }
+        if (lastUse_[n] == ComputationGraph::nan && (keepNodes.empty() || !keepNodes[n])) {
+            isDead_[n] = true;
+            freeSlots.push_back(slot_[n]);
+        }
+    }
+}
+
+std::size_t ComputationGraphMemoryPlan::size() const { return slot_.size(); }
+
+std::size_t ComputationGraphMemoryPlan::numberOfSlots() const { return numberOfSlots_; }
+
+std::size_t ComputationGraphMemoryPlan::slot(const std::size_t node) const { return slot_[node]; }
+
+std::size_t ComputationGraphMemoryPlan::lastUse(const std::size_t node) const { return lastUse_[node]; }
+
+const std::vector<std::size_t>& ComputationGraphMemoryPlan::releasedSlots(const std::size_t node) const {
+    return releasedSlots_[node];
+}
+
+bool ComputationGraphMemoryPlan::isDead(const std::size_t node) const { return isDead_[node]; }
+
+std::vector<bool> checkpointKeepNodes(const ComputationGraph& g, const std::size_t checkpointInterval,
+                                      const std::vector<bool>& keepNodes) {
+    QL_REQUIRE(checkpointInterval > 0, "checkpointKeepNodes(): checkpointInterval must be positive");
+    QL_REQUIRE(keepNodes.empty() || keepNodes.size() == g.size(),
+               "checkpointKeepNodes(): keepNodes size (" << keepNodes.size() << ") does not match graph size ("
+                                                         << g.size() << ")");
+    std::vector<bool> result(keepNodes.empty() ? std::vector<bool>(g.size(), false) : keepNodes);
+    for (std::size_t n = 0; n < g.size(); ++n) {
+        if (g.predecessors(n).empty() || g.maxNodeRequiringArg(n) / checkpointInterval > n / checkpointInterval)
+            result[n] = true;
+    }
+    return result;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/ad/memoryplan.hpp
+    \brief liveness based memory planning for computation graph evaluations
+*/
+
+#pragma once
+
+#include <qle/ad/computationgraph.hpp>
+
+namespace QuantExt {
+
+/*! Assigns the values of the nodes of a computation graph to slots of a fixed arena, such that nodes with disjoint
+    lifetimes share a slot. The lifetime of a node starts when it is evaluated and ends after the evaluation of the
+    last node requiring it as an argument. Nodes marked in keepNodes live until the end of the evaluation.
+
+    Nodes without predecessors (constants and other inputs) get dedicated slots, so that they can be populated
+    before the evaluation is started. Their slots are released after their last use like all other slots.
+
+    The arena is evaluated by the overload of forwardEvaluation() that takes a memory plan, the value of node n is
+    stored in arena[slot(n)]. */
+class ComputationGraphMemoryPlan {
+public:
+    ComputationGraphMemoryPlan() = default;
+    explicit ComputationGraphMemoryPlan(const ComputationGraph& g, const std::vector<bool>& keepNodes = {});
+
+    //! number of nodes in the planned graph
+    std::size_t size() const;
+    //! number of arena slots, this is the maximum number of node values alive at the same time
+    std::size_t numberOfSlots() const;
+    //! the slot holding the value of a node
+    std::size_t slot(const std::size_t node) const;
+    //! the last node requiring the value of a node, or nan if the node is kept or not used at all
+    std::size_t lastUse(const std::size_t node) const;
+    //! slots that can be released after the evaluation of a node, this excludes the slot of the node itself
+    const std::vector<std::size_t>& releasedSlots(const std::size_t node) const;
+    //! true if the value of the node is not needed after its own evaluation
+    bool isDead(const std::size_t node) const;
+
+private:
+    std::size_t numberOfSlots_ = 0;
+    std::vector<std::size_t> slot_;
+    std::vector<std::size_t> lastUse_;
+    std::vector<std::vector<std::size_t>> releasedSlots_;
+    std::vector<bool> isDead_;
+};
+
+/*! Returns the keep nodes for a forward evaluation preceding backwardDerivativesCheckpointed() run with the given
+    checkpoint interval. These are the given keepNodes, the nodes without predecessors and the nodes that are
+    required in a later segment of the graph than their own. A segment consists of checkpointInterval consecutive
+    nodes, segment k spans the nodes k * checkpointInterval, ..., (k + 1) * checkpointInterval - 1. */
+std::vector<bool> checkpointKeepNodes(const ComputationGraph& g, const std::size_t checkpointInterval,
+                                      const std::vector<bool>& keepNodes = {});
+
+} // namespace QuantExt
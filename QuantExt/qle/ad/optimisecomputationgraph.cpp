@@ -0,0 +1,358 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/ad/optimisecomputationgraph.hpp>
+
+#include <qle/math/randomvariable_opcodes.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/math/comparison.hpp>
+
+#include <boost/math/distributions/normal.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+namespace QuantExt {
+
+namespace {
+
+// keeps track of the red block the nodes are inserted into while rebuilding a graph
+class RedBlockTracker {
+public:
+    explicit RedBlockTracker(ComputationGraph& g) : g_(g) {}
+    void update(const std::size_t redBlockId) {
+        if (redBlockId == currentRedBlockId_)
+            return;
+        if (currentRedBlockId_ != 0)
+            g_.endRedBlock();
+        if (redBlockId != 0)
+            g_.startRedBlock();
+        currentRedBlockId_ = redBlockId;
+    }
+    void finish() { update(0); }
+
+private:
+    ComputationGraph& g_;
+    std::size_t currentRedBlockId_ = 0;
+};
+
+class Optimiser {
+public:
+    Optimiser(ComputationGraph& g, ComputationGraphOptimisationStats& stats, const bool cse, const bool folding,
+              const bool simplification)
+        : g_(g), stats_(stats), cse_(cse), folding_(folding), simplification_(simplification) {}
+
+    void setRedBlockId(const std::size_t redBlockId) { redBlockId_ = redBlockId; }
+
+    // returns a node in g_ that represents op(args)
+    std::size_t node(const std::size_t op, const std::vector<std::size_t>& args) {
+        if (folding_) {
+            std::size_t n = fold(op, args);
+            if (n != ComputationGraph::nan) {
+                ++stats_.foldedConstants;
+                return n;
+            }
+        }
+        if (simplification_) {
+            std::size_t n = simplify(op, args);
+            if (n != ComputationGraph::nan) {
+                ++stats_.simplifications;
+                return n;
+            }
+        }
+        if (!cse_)
+            return g_.insert(args, op);
+        auto key = std::make_tuple(redBlockId_, op, args);
+        if (isCommutative(op, args.size()) && std::get<2>(key)[0] > std::get<2>(key)[1])
+            std::swap(std::get<2>(key)[0], std::get<2>(key)[1]);
+        auto n = subexpressions_.find(key);
+        if (n != subexpressions_.end()) {
+            ++stats_.commonSubexpressions;
+            return n->second;
+        }
+        std::size_t result = g_.insert(args, op);
+        subexpressions_[key] = result;
+        return result;
+    }
+
+private:
+    static bool isCommutative(const std::size_t op, const std::size_t nArgs) {
+        // for more than two args the summation order matters numerically, so we do not reorder those
+        return nArgs == 2 && (op == RandomVariableOpCode::Add || op == RandomVariableOpCode::Mult ||
+                              op == RandomVariableOpCode::IndicatorEq || op == RandomVariableOpCode::Min ||
+                              op == RandomVariableOpCode::Max);
+    }
+
+    bool isConstant(const std::size_t n, const double v) const {
+        return g_.isConstant(n) && QuantLib::close_enough(g_.constantValue(n), v);
+    }
+
+    bool isOp(const std::size_t n, const std::size_t op) const {
+        return !g_.predecessors(n).empty() && g_.opId(n) == op;
+    }
+
+    std::size_t fold(const std::size_t op, const std::vector<std::size_t>& args) {
+        static const boost::math::normal_distribution<double> normal;
+        if (op == RandomVariableOpCode::ConditionalExpectation)
+            return g_.isConstant(args[0]) ? args[0] : ComputationGraph::nan;
+        if (!std::all_of(args.begin(), args.end(), [this](const std::size_t n) { return g_.isConstant(n); }))
+            return ComputationGraph::nan;
+        std::vector<double> x(args.size());
+        std::transform(args.begin(), args.end(), x.begin(),
+                       [this](const std::size_t n) { return g_.constantValue(n); });
+        switch (op) {
+        case RandomVariableOpCode::Add: {
+            double sum = 0.0;
+            for (auto const v : x)
+                sum += v;
+            return g_.constant(sum);
+        }
+        case RandomVariableOpCode::Subtract:
+            return g_.constant(x[0] - x[1]);
+        case RandomVariableOpCode::Negative:
+            return g_.constant(-x[0]);
+        case RandomVariableOpCode::Mult:
+            return g_.constant(x[0] * x[1]);
+        case RandomVariableOpCode::Div:
+            return g_.constant(x[0] / x[1]);
+        case RandomVariableOpCode::IndicatorEq:
+            return g_.constant(QuantLib::close_enough(x[0], x[1]) ? 1.0 : 0.0);
+        case RandomVariableOpCode::IndicatorGt:
+            return g_.constant(x[0] > x[1] && !QuantLib::close_enough(x[0], x[1]) ? 1.0 : 0.0);
+        case RandomVariableOpCode::IndicatorGeq:
+            return g_.constant(x[0] > x[1] || QuantLib::close_enough(x[0], x[1]) ? 1.0 : 0.0);
+        case RandomVariableOpCode::Min:
+            return g_.constant(std::min(x[0], x[1]));
+        case RandomVariableOpCode::Max:
+            return g_.constant(std::max(x[0], x[1]));
+        case RandomVariableOpCode::Abs:
+            return g_.constant(std::abs(x[0]));
+        case RandomVariableOpCode::Exp:
+            return g_.constant(std::exp(x[0]));
+        case RandomVariableOpCode::Sqrt:
+            return g_.constant(std::sqrt(x[0]));
+        case RandomVariableOpCode::Log:
+            return g_.constant(std::log(x[0]));
+        case RandomVariableOpCode::Pow:
+            return g_.constant(std::pow(x[0], x[1]));
+        case RandomVariableOpCode::NormalCdf:
+            return g_.constant(boost::math::cdf(normal, x[0]));
+        case RandomVariableOpCode::NormalPdf:
+            return g_.constant(boost::math::pdf(normal, x[0]));
+        default:
+            return ComputationGraph::nan;
+        }
+    }
+
+    std::size_t simplify(const std::size_t op, const std::vector<std::size_t>& args) {
+        switch (op) {
+        case RandomVariableOpCode::Add: {
+            std::vector<std::size_t> nonZero;
+            std::copy_if(args.begin(), args.end(), std::back_inserter(nonZero),
+                         [this](const std::size_t n) { return !isConstant(n, 0.0); });
+            if (nonZero.size() == args.size())
+                return ComputationGraph::nan;
+            if (nonZero.empty())
+                return g_.constant(0.0);
+            if (nonZero.size() == 1)
+                return nonZero.front();
+            return node(op, nonZero);
+        }
+        case RandomVariableOpCode::Subtract:
+            if (args[0] == args[1])
+                return g_.constant(0.0);
+            if (isConstant(args[1], 0.0))
+                return args[0];
+            if (isConstant(args[0], 0.0))
+                return node(RandomVariableOpCode::Negative, {args[1]});
+            if (isOp(args[1], RandomVariableOpCode::Negative))
+                return node(RandomVariableOpCode::Add, {args[0], g_.predecessors(args[1])[0]});
+            return ComputationGraph::nan;
+        case RandomVariableOpCode::Negative:
+            if (isOp(args[0], RandomVariableOpCode::Negative))
+                return g_.predecessors(args[0])[0];
+            return ComputationGraph::nan;
+        case RandomVariableOpCode::Mult:
+            if (isConstant(args[0], 0.0) || isConstant(args[1], 0.0))
+                return g_.constant(0.0);
+            for (std::size_t i = 0; i < 2; ++i) {
+                if (isConstant(args[i], 1.0))
+                    return args[1 - i];
+                if (isConstant(args[i], -1.0))
+                    return node(RandomVariableOpCode::Negative, {args[1 - i]});
+            }
+            return ComputationGraph::nan;
+        case RandomVariableOpCode::Div:
+            if (args[0] == args[1])
+                return g_.constant(1.0);
+            if (isConstant(args[0], 0.0))
+                return g_.constant(0.0);
+            if (isConstant(args[1], 1.0))
+                return args[0];
+            if (isConstant(args[1], -1.0))
+                return node(RandomVariableOpCode::Negative, {args[0]});
+            return ComputationGraph::nan;
+        case RandomVariableOpCode::IndicatorEq:
+        case RandomVariableOpCode::IndicatorGeq:
+            return args[0] == args[1] ? g_.constant(1.0) : ComputationGraph::nan;
+        case RandomVariableOpCode::IndicatorGt:
+            return args[0] == args[1] ? g_.constant(0.0) : ComputationGraph::nan;
+        case RandomVariableOpCode::Min:
+        case RandomVariableOpCode::Max:
+            return args[0] == args[1] ? args[0] : ComputationGraph::nan;
+        case RandomVariableOpCode::Abs:
+            return isOp(args[0], RandomVariableOpCode::Abs) ? args[0] : ComputationGraph::nan;
+        case RandomVariableOpCode::Log:
+            return isOp(args[0], RandomVariableOpCode::Exp) ? g_.predecessors(args[0])[0] : ComputationGraph::nan;
+        case RandomVariableOpCode::Pow:
+            if (isConstant(args[1], 0.0))
+                return g_.constant(1.0);
+            if (isConstant(args[1], 1.0))
+                return args[0];
+            return ComputationGraph::nan;
+        default:
+            return ComputationGraph::nan;
+        }
+    }
+
+    ComputationGraph& g_;
+    ComputationGraphOptimisationStats& stats_;
+    bool cse_, folding_, simplification_;
+    std::size_t redBlockId_ = 0;
+    std::map<std::tuple<std::size_t, std::size_t, std::vector<std::size_t>>, std::size_t> subexpressions_;
+};
+
+} // namespace
+
+std::ostream& operator<<(std::ostream& out, const ComputationGraphOptimisationStats& stats) {
+    return out << "nodes " << stats.nodesBefore << " -> " << stats.nodesAfter << " (cse "
+               << stats.commonSubexpressions << ", folded constants " << stats.foldedConstants << ", simplifications "
+               << stats.simplifications << ", dead nodes " << stats.deadNodes << ")";
+}
+
+ComputationGraphOptimisationStats optimiseComputationGraph(const ComputationGraph& g, ComputationGraph& result,
+                                                           std::vector<std::size_t>& nodeMap,
+                                                           const std::vector<std::size_t>& outputNodes,
+                                                           const bool commonSubexpressionElimination,
+                                                           const bool constantFolding,
+                                                           const bool algebraicSimplification,
+                                                           const bool deadNodeElimination) {
+
+    QL_REQUIRE(result.size() == 0,
+               "optimiseComputationGraph(): result graph must be empty, has size " << result.size());
+
+    ComputationGraphOptimisationStats stats;
+    stats.nodesBefore = g.size();
+
+    // 1 rebuild the graph applying cse, constant folding and algebraic simplifications
+
+    ComputationGraph tmp;
+    std::vector<std::size_t> tmpMap(g.size(), ComputationGraph::nan);
+    {
+        Optimiser optimiser(tmp, stats, commonSubexpressionElimination, constantFolding, algebraicSimplification);
+        RedBlockTracker redBlocks(tmp);
+        std::vector<std::size_t> args;
+        for (std::size_t n = 0; n < g.size(); ++n) {
+            redBlocks.update(g.redBlockId(n));
+            optimiser.setRedBlockId(g.redBlockId(n));
+            if (g.isConstant(n)) {
+                tmpMap[n] = tmp.constant(g.constantValue(n));
+            } else if (g.predecessors(n).empty()) {
+                tmpMap[n] = tmp.insert();
+            } else {
+                args.resize(g.predecessors(n).size());
+                std::transform(g.predecessors(n).begin(), g.predecessors(n).end(), args.begin(),
+                               [&tmpMap](const std::size_t p) { return tmpMap[p]; });
+                tmpMap[n] = optimiser.node(g.opId(n), args);
+            }
+        }
+        redBlocks.finish();
+    }
+
+    // 2 determine the live nodes, i.e. the inputs and the nodes the output nodes depend on
+
+    std::vector<bool> live(tmp.size(), !deadNodeElimination);
+    if (deadNodeElimination) {
+        for (auto const n : outputNodes) {
+            QL_REQUIRE(n < g.size(), "optimiseComputationGraph(): output node " << n << " out of range, graph size is "
+                                                                                << g.size());
+            live[tmpMap[n]] = true;
+        }
+        for (std::size_t n = tmp.size(); n > 0; --n) {
+            if (tmp.predecessors(n - 1).empty() && !tmp.isConstant(n - 1))
+                live[n - 1] = true;
+            if (live[n - 1]) {
+                for (auto const p : tmp.predecessors(n - 1))
+                    live[p] = true;
+            }
+        }
+    }
+
+    // 3 copy the live nodes to the result graph
+
+    std::vector<std::size_t> resultMap(tmp.size(), ComputationGraph::nan);
+    {
+        RedBlockTracker redBlocks(result);
+        std::vector<std::size_t> args;
+        for (std::size_t n = 0; n < tmp.size(); ++n) {
+            if (!live[n]) {
+                ++stats.deadNodes;
+                continue;
+            }
+            redBlocks.update(tmp.redBlockId(n));
+            if (tmp.isConstant(n)) {
+                resultMap[n] = result.constant(tmp.constantValue(n));
+            } else if (tmp.predecessors(n).empty()) {
+                resultMap[n] = result.insert();
+            } else {
+                args.resize(tmp.predecessors(n).size());
+                std::transform(tmp.predecessors(n).begin(), tmp.predecessors(n).end(), args.begin(),
+                               [&resultMap](const std::size_t p) { return resultMap[p]; });
+                resultMap[n] = result.insert(args, tmp.opId(n));
+            }
+        }
+        redBlocks.finish();
+    }
+
+    // 4 set the node map, variables and labels
+
+    nodeMap.resize(g.size());
+    for (std::size_t n = 0; n < g.size(); ++n)
+        nodeMap[n] = resultMap[tmpMap[n]];
+
+    result.enableLabels(false);
+    for (auto const& [name, n] : g.variables()) {
+        if (nodeMap[n] != ComputationGraph::nan)
+            result.setVariable(name, nodeMap[n]);
+    }
+
+    result.enableLabels(!g.labels().empty());
+    for (auto const& [n, labels] : g.labels()) {
+        if (nodeMap[n] == ComputationGraph::nan)
+            continue;
+        for (auto const& l : labels)
+            result.addLabel(nodeMap[n], l);
+    }
+
+    stats.nodesAfter = result.size();
+    return stats;
+}
+
+} // namespace QuantExt
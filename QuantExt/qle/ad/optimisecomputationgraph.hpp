@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/ad/optimisecomputationgraph.hpp
+    \brief optimisation passes on a computation graph
+*/
+
+#pragma once
+
+#include <qle/ad/computationgraph.hpp>
+
+#include <ostream>
+
+namespace QuantExt {
+
+struct ComputationGraphOptimisationStats {
+    std::size_t nodesBefore = 0;
+    std::size_t nodesAfter = 0;
+    std::size_t commonSubexpressions = 0;
+    std::size_t foldedConstants = 0;
+    std::size_t simplifications = 0;
+    std::size_t deadNodes = 0;
+};
+
+std::ostream& operator<<(std::ostream& out, const ComputationGraphOptimisationStats& stats);
+
+/*! Builds an optimised copy of the graph g in result, which must be empty. The op ids are assumed to be the ones
+    defined in RandomVariableOpCode. The following passes are applied:
+
+    - common subexpression elimination: nodes with the same op and predecessors within the same red block are merged
+    - constant folding: ops with constant arguments only are replaced by constants
+    - algebraic simplification: e.g. x * 1 = x, x - (-y) = x + y, -(-x) = x, min(x, x) = x, log(exp(x)) = x
+    - dead node elimination: nodes that do not contribute to the outputNodes are removed
+
+    Nodes without predecessors which are not constants (i.e. the inputs of the graph like model parameters or random
+    variates) are always kept. The node order, the red blocks, the variables and the labels are preserved. On return
+    nodeMap[n] is the node in result representing the node n in g or ComputationGraph::nan if the node was removed. */
+ComputationGraphOptimisationStats optimiseComputationGraph(const ComputationGraph& g, ComputationGraph& result,
+                                                           std::vector<std::size_t>& nodeMap,
+                                                           const std::vector<std::size_t>& outputNodes,
+                                                           const bool commonSubexpressionElimination = true,
+                                                           const bool constantFolding = true,
+                                                           const bool algebraicSimplification = true,
+                                                           const bool deadNodeElimination = true);
+
+} // namespace QuantExt
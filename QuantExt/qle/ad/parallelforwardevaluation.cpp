@@ -0,0 +1,40 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/ad/parallelforwardevaluation.hpp>
+
+#include <algorithm>
+
+namespace QuantExt {
+
+std::vector<std::vector<std::size_t>> computationGraphWavefronts(const ComputationGraph& g) {
+    std::vector<std::vector<std::size_t>> result;
+    std::vector<std::size_t> level(g.size(), 0);
+    for (std::size_t node = 0; node < g.size(); ++node) {
+        if (g.predecessors(node).empty())
+            continue;
+        for (auto const p : g.predecessors(node))
+            level[node] = std::max(level[node], level[p] + 1);
+        if (result.size() < level[node])
+            result.resize(level[node]);
+        result[level[node] - 1].push_back(node);
+    }
+    return result;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/ad/parallelforwardevaluation.hpp
+    \brief multi-threaded forward evaluation
+*/
+
+#pragma once
+
+#include <qle/ad/computationgraph.hpp>
+#include <qle/math/chunkworkers.hpp>
+
+#include <ql/errors.hpp>
+
+namespace QuantExt {
+
+/*! Returns the op nodes of g grouped into wavefronts: wavefront k contains the nodes whose longest path from an input
+    has length k + 1. The nodes within a wavefront are independent of each other and all their predecessors are
+    contained in the previous wavefronts or are inputs. Independent red blocks end up in the same wavefronts. */
+std::vector<std::vector<std::size_t>> computationGraphWavefronts(const ComputationGraph& g);
+
+/*! Multi-threaded forward evaluation of the whole graph. The wavefronts are evaluated in sequence, the nodes within a
+    wavefront are distributed over the worker threads. The ops must be safe to call concurrently. The parameters
+    have the same meaning as for forwardEvaluation(). Since the order of node evaluations is not fixed within a
+    wavefront, values are released when all their successors are evaluated, not based on maxNodeRequiringArg(). The
+    wavefronts can be passed in if the graph is evaluated several times. */
+template <class T>
+void parallelForwardEvaluation(const ComputationGraph& g, std::vector<T>& values,
+                               const std::vector<std::function<T(const std::vector<const T*>&)>>& ops,
+                               ChunkWorkers& workers, std::function<void(T&)> deleter = {},
+                               bool keepValuesForDerivatives = true,
+                               const std::vector<std::function<std::pair<std::vector<bool>, bool>(const std::size_t)>>&
+                                   opRequiresNodesForDerivatives = {},
+                               const std::vector<bool>& keepNodes = {},
+                               const std::vector<std::vector<std::size_t>>& wavefronts = {}) {
+
+    std::vector<std::vector<std::size_t>> tmp;
+    if (wavefronts.empty())
+        tmp = computationGraphWavefronts(g);
+    const std::vector<std::vector<std::size_t>>& w = wavefronts.empty() ? tmp : wavefronts;
+
+    // determine the number of pending uses of each node and the nodes to keep for the derivatives beforehand, this
+    // is equivalent to what forwardEvaluation() does on the fly
+
+    std::vector<std::size_t> pendingUses;
+    std::vector<bool> keep;
+    if (deleter) {
+        pendingUses.resize(g.size(), 0);
+        keep = keepNodes.empty() ? std::vector<bool>(g.size(), false) : keepNodes;
+        for (std::size_t node = 0; node < g.size(); ++node) {
+            for (std::size_t arg = 0; arg < g.predecessors(node).size(); ++arg) {
+                std::size_t p = g.predecessors(node)[arg];
+                ++pendingUses[p];
+                if (keepValuesForDerivatives && g.redBlockId(p) == 0 &&
+                    (opRequiresNodesForDerivatives[g.opId(p)](g.predecessors(node).size()).second ||
+                     opRequiresNodesForDerivatives[g.opId(node)](g.predecessors(node).size()).first[arg]))
+                    keep[p] = true;
+            }
+        }
+    }
+
+    for (auto const& wavefront : w) {
+
+        workers.run(wavefront.size(), [&g, &values, &ops, &wavefront](const std::size_t i) {
+            std::size_t node = wavefront[i];
+            std::vector<const T*> args(g.predecessors(node).size());
+            for (std::size_t arg = 0; arg < g.predecessors(node).size(); ++arg) {
+                args[arg] = &values[g.predecessors(node)[arg]];
+            }
+            values[node] = ops[g.opId(node)](args);
+            QL_REQUIRE(values[node].initialised(), "parallelForwardEvaluation(): value at active node "
+                                                       << node << " is not initialized, opId = " << g.opId(node));
+        });
+
+        if (deleter) {
+            for (auto const node : wavefront) {
+                for (auto const p : g.predecessors(node)) {
+                    if (--pendingUses[p] == 0 && !keep[p])
+                        deleter(values[p]);
+                }
+            }
+        }
+    }
+}
+
+} // namespace QuantExt
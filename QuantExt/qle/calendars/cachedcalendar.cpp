@@ -0,0 +1,50 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ql/errors.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
+
+using namespace QuantLib;
+
+namespace QuantExt {
+
+CachedCalendar::Impl::Impl(const Calendar& calendar, const Date& start, const Date& end)
+    : baseCalendar_(calendar), start_(start), end_(end) {
+    QL_REQUIRE(!calendar.empty(), "CachedCalendar: no underlying calendar given");
+    QL_REQUIRE(start <= end, "CachedCalendar: start (" << start << ") must be <= end (" << end << ")");
+    businessDays_.resize(end_ - start_ + 1);
+    Date d = start_;
+    for (Size i = 0; i < businessDays_.size(); ++i, ++d)
+        businessDays_[i] = baseCalendar_.isBusinessDay(d);
+}
+
+std::string CachedCalendar::Impl::name() const { return baseCalendar_.name(); }
+
+bool CachedCalendar::Impl::isWeekend(Weekday w) const { return baseCalendar_.isWeekend(w); }
+
+bool CachedCalendar::Impl::isBusinessDay(const Date& date) const {
+    if (date >= start_ && date <= end_)
+        return businessDays_[date - start_];
+    return baseCalendar_.isBusinessDay(date);
+}
+
+CachedCalendar::CachedCalendar(const Calendar& calendar, const Date& start, const Date& end) {
+    impl_ = ext::shared_ptr<Calendar::Impl>(new CachedCalendar::Impl(calendar, start, end));
+}
+
+} // namespace QuantExt
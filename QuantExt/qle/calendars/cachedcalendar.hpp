@@ -0,0 +1,63 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file cachedcalendar.hpp
+    \brief Calendar with precomputed business days
+*/
+
+#ifndef quantext_cached_calendar_h
+#define quantext_cached_calendar_h
+
+#include <ql/time/calendar.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+
+//! Cached calendar
+/*! The business days of the underlying calendar are precomputed for the dates in [start, end], so that
+    isBusinessDay() is a single lookup for these dates. Outside this range the underlying calendar is used.
+
+    The calendar has the name of the underlying calendar. Holidays added to or removed from the underlying calendar
+    after the construction of this calendar are not reflected in the cached range, while holidays added to or removed
+    from this calendar work as usual.
+
+    \ingroup calendars
+*/
+class CachedCalendar : public QuantLib::Calendar {
+private:
+    class Impl : public Calendar::Impl {
+    public:
+        Impl(const QuantLib::Calendar& calendar, const QuantLib::Date& start, const QuantLib::Date& end);
+        std::string name() const override;
+        bool isWeekend(QuantLib::Weekday) const override;
+        bool isBusinessDay(const QuantLib::Date&) const override;
+
+    private:
+        QuantLib::Calendar baseCalendar_;
+        QuantLib::Date start_, end_;
+        std::vector<bool> businessDays_;
+    };
+
+public:
+    CachedCalendar(const QuantLib::Calendar& calendar, const QuantLib::Date& start, const QuantLib::Date& end);
+};
+
+} // namespace QuantExt
+
+#endif
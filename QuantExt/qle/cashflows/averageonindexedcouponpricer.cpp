@@ -17,6 +17,9 @@
 */
 
 #include <qle/cashflows/averageonindexedcouponpricer.hpp>
+#include <qle/cashflows/overnightcompoundingcache.hpp>
+
+#include <algorithm>
 
 namespace QuantExt {
 
@@ -47,8 +50,24 @@ Rate AverageONIndexedCouponPricer::swapletRate() const {
     if (approximationType_ == Takada) {
         Size i = 0;
         Date valuationDate = Settings::instance().evaluationDate();
+        // Past fixings before the rate cutoff from the compounding cache, if possible.
+        Size cacheFirst = overnightIndex_->fixingCalendar().isBusinessDay(coupon_->valueDates().front()) ? 0 : 1;
+        Size cacheLast =
+            std::lower_bound(fixingDates.begin(), fixingDates.begin() + nCutoff, valuationDate) - fixingDates.begin();
+        bool useCache = cacheLast > cacheFirst + 1;
         // Deal with past fixings.
         while (i < numPeriods && fixingDates[std::min(i, nCutoff)] < valuationDate) {
+            if (useCache && i == cacheFirst) {
+                useCache = false;
+                Real cachedRate = OvernightCompoundingCache::instance().accumulatedRate(
+                    overnightIndex_, coupon_->fixingDays(), coupon_->dayCounter(), coupon_->valueDates(), cacheFirst,
+                    cacheLast);
+                if (cachedRate != Null<Real>()) {
+                    accumulatedRate += cachedRate;
+                    i = cacheLast;
+                    continue;
+                }
+            }
             Rate pastFixing = overnightIndex_->pastFixing(fixingDates[std::min(i, nCutoff)]);
             QL_REQUIRE(pastFixing != Null<Real>(),
                        "Missing " << overnightIndex_->name() << " fixing for " << fixingDates[std::min(i, nCutoff)]);
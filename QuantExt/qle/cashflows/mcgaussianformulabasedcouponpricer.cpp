@@ -17,6 +17,7 @@
 */
 
 #include <qle/cashflows/mcgaussianformulabasedcouponpricer.hpp>
+#include <qle/math/randomvariable.hpp>
 
 #include <ql/cashflows/cmscoupon.hpp>
 #include <ql/cashflows/iborcoupon.hpp>
@@ -25,13 +26,8 @@
 #include <ql/math/randomnumbers/mt19937uniformrng.hpp>
 #include <ql/math/randomnumbers/sobolrsg.hpp>
 
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
-
 #include <boost/make_shared.hpp>
 using namespace QuantLib;
-using namespace boost::accumulators;
 
 namespace QuantExt {
 
@@ -220,9 +216,7 @@ void MCGaussianFormulaBasedCouponPricer::compute() const {
         return;
     }
 
-    // the actual MC simulation
-
-    accumulator_set<double, stats<tag::mean>> acc;
+    // the actual MC simulation, the formula is evaluated on all samples at once
 
     Matrix C = pseudoSqrt(covariance_, salvaging_);
     InverseCumulativeNormal icn;
@@ -231,6 +225,7 @@ void MCGaussianFormulaBasedCouponPricer::compute() const {
     MersenneTwisterUniformRng mt_(seed_);
     SobolRsg sb_(n_, seed_); // default direction integers
     Array w(n_), z(n_);
+    std::vector<RandomVariable> values(n_, RandomVariable(samples_));
     for (Size i = 0; i < samples_; ++i) {
         if (useSobol_) {
             auto seq = sb_.nextSequence().value;
@@ -246,10 +241,11 @@ void MCGaussianFormulaBasedCouponPricer::compute() const {
                 z[j] = (atmRate_[j] + volShift_[j]) * std::exp(z[j]) - volShift_[j];
             }
         }
-        acc(formula(z.begin(), z.end()));
+        for (Size j = 0; j < n_; ++j)
+            values[j].set(i, z[j]);
     }
 
-    rateEstimate_ = mean(acc);
+    rateEstimate_ = expectation(formula.eval(values)).at(0);
 } // compute
 
 } // namespace QuantExt
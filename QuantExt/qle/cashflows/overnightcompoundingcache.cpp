@@ -0,0 +1,155 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/cashflows/overnightcompoundingcache.hpp>
+#include <qle/indexes/fallbackovernightindex.hpp>
+
+#include <ql/indexes/indexmanager.hpp>
+#include <ql/patterns/observable.hpp>
+#include <ql/settings.hpp>
+
+#include <algorithm>
+#include <typeinfo>
+
+namespace QuantExt {
+
+// the cumulative products and sums for one index, fixing days and day counter
+class OvernightCompoundingCache::Entry : public Observer {
+public:
+    Entry(const QuantLib::ext::shared_ptr<OvernightIndex>& index, const Natural fixingDays,
+          const DayCounter& dayCounter)
+        : index_(index), fixingDays_(fixingDays), dayCounter_(dayCounter), calendar_(index->fixingCalendar()) {
+        registerWith(IndexManager::instance().notifier(index->name()));
+    }
+    void update() override { dates_.clear(); }
+
+    // positions of valueDates[first], valueDates[last] in dates_, or false if the cache can not be used
+    bool locate(const std::vector<Date>& valueDates, const Size first, const Size last, Size& k0, Size& k1);
+
+    std::vector<Real> products_, sums_;
+
+private:
+    void reset(const Date& start);
+    void extend(const Date& end);
+
+    QuantLib::ext::shared_ptr<OvernightIndex> index_;
+    Natural fixingDays_;
+    DayCounter dayCounter_;
+    Calendar calendar_;
+    Date today_;
+    // consecutive business days, the values refer to the periods before dates_[k], missing_ counts missing fixings
+    std::vector<Date> dates_;
+    std::vector<Size> missing_;
+};
+
+void OvernightCompoundingCache::Entry::reset(const Date& start) {
+    dates_.assign(1, start);
+    products_.assign(1, 1.0);
+    sums_.assign(1, 0.0);
+    missing_.assign(1, 0);
+}
+
+void OvernightCompoundingCache::Entry::extend(const Date& end) {
+    while (dates_.back() < end) {
+        const Date& d = dates_.back();
+        Date fixingDate = calendar_.advance(d, -static_cast<Integer>(fixingDays_), Days, Preceding);
+        if (fixingDate >= today_)
+            return;
+        Date next = calendar_.advance(d, 1, Days, Following);
+        Rate fixing = Null<Real>();
+        try {
+            fixing = index_->pastFixing(fixingDate);
+        } catch (const std::exception&) {
+        }
+        Real f = fixing == Null<Real>() ? 0.0 : fixing * dayCounter_.yearFraction(d, next);
+        products_.push_back(products_.back() * (1.0 + f));
+        sums_.push_back(sums_.back() + f);
+        missing_.push_back(missing_.back() + (fixing == Null<Real>() ? 1 : 0));
+        dates_.push_back(next);
+    }
+}
+
+bool OvernightCompoundingCache::Entry::locate(const std::vector<Date>& valueDates, const Size first, const Size last,
+                                              Size& k0, Size& k1) {
+    const Date& start = valueDates[first];
+    const Date& end = valueDates[last];
+    if (!calendar_.isBusinessDay(start) || !calendar_.isBusinessDay(end))
+        return false;
+    Date today = Settings::instance().evaluationDate();
+    if (dates_.empty() || today != today_) {
+        today_ = today;
+        reset(start);
+    } else if (start < dates_.front()) {
+        Date oldEnd = dates_.back();
+        reset(start);
+        extend(oldEnd);
+    }
+    extend(end);
+    if (dates_.back() < end)
+        return false;
+    k0 = std::lower_bound(dates_.begin(), dates_.end(), start) - dates_.begin();
+    k1 = std::lower_bound(dates_.begin(), dates_.end(), end) - dates_.begin();
+    // the value dates must be consecutive business days and all fixings must be available
+    return k1 - k0 == last - first && missing_[k1] == missing_[k0];
+}
+
+QuantLib::ext::shared_ptr<OvernightCompoundingCache::Entry>
+OvernightCompoundingCache::entry(const QuantLib::ext::shared_ptr<OvernightIndex>& index, const Natural fixingDays,
+                                 const DayCounter& dayCounter) {
+    // fallback indices derive their past fixings from another index, for which we would not be notified
+    if (!enabled_ || !ObservableSettings::instance().updatesEnabled() ||
+        QuantLib::ext::dynamic_pointer_cast<FallbackOvernightIndex>(index) != nullptr)
+        return nullptr;
+    auto key = std::make_tuple(index->name(), std::string(typeid(*index).name()), fixingDays, dayCounter.name());
+    auto e = entries_.find(key);
+    if (e == entries_.end())
+        e = entries_.emplace(key, QuantLib::ext::make_shared<Entry>(index, fixingDays, dayCounter)).first;
+    return e->second;
+}
+
+Real OvernightCompoundingCache::compoundFactor(const QuantLib::ext::shared_ptr<OvernightIndex>& index,
+                                               const Natural fixingDays, const DayCounter& dayCounter,
+                                               const std::vector<Date>& valueDates, const Size first,
+                                               const Size last) {
+    Size k0, k1;
+    auto e = entry(index, fixingDays, dayCounter);
+    if (e == nullptr || !e->locate(valueDates, first, last, k0, k1))
+        return Null<Real>();
+    return e->products_[k1] / e->products_[k0];
+}
+
+Real OvernightCompoundingCache::accumulatedRate(const QuantLib::ext::shared_ptr<OvernightIndex>& index,
+                                                const Natural fixingDays, const DayCounter& dayCounter,
+                                                const std::vector<Date>& valueDates, const Size first,
+                                                const Size last) {
+    Size k0, k1;
+    auto e = entry(index, fixingDays, dayCounter);
+    if (e == nullptr || !e->locate(valueDates, first, last, k0, k1))
+        return Null<Real>();
+    return e->sums_[k1] - e->sums_[k0];
+}
+
+void OvernightCompoundingCache::enable(const bool b) {
+    enabled_ = b;
+    if (!b)
+        clear();
+}
+
+void OvernightCompoundingCache::clear() { entries_.clear(); }
+
+} // namespace QuantExt
@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/cashflows/overnightcompoundingcache.hpp
+    \brief cache for the compounding of past overnight fixings
+    \ingroup cashflows
+*/
+
+#pragma once
+
+#include <ql/indexes/iborindex.hpp>
+#include <ql/patterns/singleton.hpp>
+#include <ql/time/daycounter.hpp>
+
+#include <map>
+#include <tuple>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Cache for the compounding of past overnight fixings
+/*! For each overnight index, number of fixing days and day counter the cache stores the cumulative products of
+    1 + f_k * dt_k and the cumulative sums of f_k * dt_k over consecutive value dates d_k (the business days of the
+    index fixing calendar), where f_k is the past fixing of the index for the fixing date fixingDays business days
+    before d_k and dt_k is the year fraction between d_k and d_{k+1}. This way the past part of a compounded or
+    averaged overnight coupon is the ratio resp. difference of two cached values instead of a loop over its daily
+    fixings.
+
+    The cached values are kept until the fixings of the index or the evaluation date change. Since changes of the
+    fixings are detected via the notifications of the IndexManager, the cache is not used while notifications are
+    disabled.
+
+    \ingroup cashflows
+*/
+class OvernightCompoundingCache : public QuantLib::Singleton<OvernightCompoundingCache> {
+    friend class QuantLib::Singleton<OvernightCompoundingCache>;
+
+private:
+    OvernightCompoundingCache() = default;
+
+public:
+    /*! The product of 1 + f_i * dt_i over the periods first <= i < last of the given value dates, where f_i is the past
+        fixing for valueDates[i] and dt_i = dayCounter.yearFraction(valueDates[i], valueDates[i + 1]). Returns Null if
+        the cache can not be used, i.e. if the value dates are not consecutive business days of the index fixing
+        calendar, a fixing is missing or not all fixing dates lie before the evaluation date. */
+    Real compoundFactor(const QuantLib::ext::shared_ptr<OvernightIndex>& index, const Natural fixingDays,
+                        const DayCounter& dayCounter, const std::vector<Date>& valueDates, const Size first,
+                        const Size last);
+    //! The sum of f_i * dt_i over the same periods, with the same conditions as compoundFactor()
+    Real accumulatedRate(const QuantLib::ext::shared_ptr<OvernightIndex>& index, const Natural fixingDays,
+                         const DayCounter& dayCounter, const std::vector<Date>& valueDates, const Size first,
+                         const Size last);
+
+    //! enable or disable the cache, it is enabled by default
+    void enable(const bool b);
+    bool enabled() const { return enabled_; }
+    void clear();
+
+private:
+    class Entry;
+    QuantLib::ext::shared_ptr<Entry> entry(const QuantLib::ext::shared_ptr<OvernightIndex>& index,
+                                           const Natural fixingDays, const DayCounter& dayCounter);
+    bool enabled_ = true;
+    std::map<std::tuple<std::string, std::string, Natural, std::string>, QuantLib::ext::shared_ptr<Entry>> entries_;
+};
+
+} // namespace QuantExt
@@ -37,6 +37,7 @@
  FOR A PARTICULAR PURPOSE.  See the license for more details.
 */
 
+#include <qle/cashflows/overnightcompoundingcache.hpp>
 #include <qle/cashflows/overnightindexedcoupon.hpp>
 
 #include <ql/cashflows/cashflowvectors.hpp>
@@ -45,6 +46,8 @@
 #include <ql/time/calendars/weekendsonly.hpp>
 #include <ql/utilities/vectors.hpp>
 
+#include <algorithm>
+
 using std::vector;
 
 namespace QuantExt {
@@ -209,7 +212,24 @@ void OvernightIndexedCouponPricer::compute() const {
 
     // already fixed part
     Date today = Settings::instance().evaluationDate();
+
+    /* the fixed periods before the rate cutoff are taken from the compounding cache if possible, the first period is
+       excluded if its value date is not a business day, the cache can not be used if the spread is compounded */
+    Size cacheFirst = index->fixingCalendar().isBusinessDay(coupon_->valueDates().front()) ? 0 : 1;
+    Size cacheLast = std::lower_bound(fixingDates.begin(), fixingDates.begin() + nCutoff, today) - fixingDates.begin();
+    bool useCache = !coupon_->includeSpread() && cacheLast > cacheFirst + 1;
+
     while (i < n && fixingDates[std::min(i, nCutoff)] < today) {
+        if (useCache && i == cacheFirst) {
+            useCache = false;
+            Real cachedFactor = OvernightCompoundingCache::instance().compoundFactor(
+                index, coupon_->fixingDays(), index->dayCounter(), coupon_->valueDates(), cacheFirst, cacheLast);
+            if (cachedFactor != Null<Real>()) {
+                compoundFactor *= cachedFactor;
+                i = cacheLast;
+                continue;
+            }
+        }
         // rate must have been fixed
         Rate pastFixing = index->pastFixing(fixingDates[std::min(i, nCutoff)]);
         QL_REQUIRE(pastFixing != Null<Real>(),
@@ -87,6 +87,7 @@ void RiskParticipationAgreement::setupExpired() const {
     optionMultiplier_.clear();
     optionRepresentationPeriods_.clear();
     optionRepresentationReferenceDate_ = Date();
+    optionRepresentationCurveRates_.clear();
 }
 
 void RiskParticipationAgreement::setupArguments(QuantLib::PricingEngine::arguments* args) const {
@@ -113,6 +114,7 @@ void RiskParticipationAgreement::setupArguments(QuantLib::PricingEngine::argumen
     arguments->optionMultiplier = optionMultiplier_;
     arguments->optionRepresentationPeriods = optionRepresentationPeriods_;
     arguments->optionRepresentationReferenceDate = optionRepresentationReferenceDate_;
+    arguments->optionRepresentationCurveRates = optionRepresentationCurveRates_;
 }
 
 void RiskParticipationAgreement::fetchResults(const PricingEngine::results* r) const {
@@ -124,6 +126,7 @@ void RiskParticipationAgreement::fetchResults(const PricingEngine::results* r) c
     optionMultiplier_ = results->optionMultiplier;
     optionRepresentationPeriods_ = results->optionRepresentationPeriods;
     optionRepresentationReferenceDate_ = results->optionRepresentationReferenceDate;
+    optionRepresentationCurveRates_ = results->optionRepresentationCurveRates;
 }
 
 } // namespace QuantExt
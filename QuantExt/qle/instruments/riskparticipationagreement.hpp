@@ -94,6 +94,7 @@ private:
     mutable std::vector<std::tuple<Date, Date, Date>> optionRepresentationPeriods_;
     mutable std::vector<QuantLib::ext::shared_ptr<Instrument>> optionRepresentation_;
     mutable std::vector<Real> optionMultiplier_;
+    mutable std::vector<Real> optionRepresentationCurveRates_;
 };
 
 class RiskParticipationAgreement::arguments : public PricingEngine::arguments {
@@ -118,6 +119,7 @@ public:
     std::vector<Real> optionMultiplier;
     std::vector<std::tuple<Date, Date, Date>> optionRepresentationPeriods;
     Date optionRepresentationReferenceDate;
+    std::vector<Real> optionRepresentationCurveRates;
 };
 
 class RiskParticipationAgreement::results : public Instrument::results {
@@ -126,12 +128,14 @@ public:
     std::vector<Real> optionMultiplier;
     std::vector<std::tuple<Date, Date, Date>> optionRepresentationPeriods;
     Date optionRepresentationReferenceDate;
+    std::vector<Real> optionRepresentationCurveRates;
     void reset() override {
         Instrument::results::reset();
         optionRepresentation.clear();
         optionMultiplier.clear();
         optionRepresentationPeriods.clear();
         optionRepresentationReferenceDate = Date();
+        optionRepresentationCurveRates.clear();
     }
 };
 
@@ -17,6 +17,7 @@
 */
 
 #include <qle/math/basiccpuenvironment.hpp>
+#include <qle/math/chunkworkers.hpp>
 #include <qle/math/randomvariable.hpp>
 #include <qle/math/randomvariable_io.hpp>
 #include <qle/math/randomvariable_opcodes.hpp>
@@ -31,11 +32,48 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace QuantExt {
 
+namespace {
+
+// the part [offset, offset + size) of x, resp. the concatenation of the chunks
+
+RandomVariable chunkOf(const RandomVariable& x, const std::size_t offset, const std::size_t size) {
+    if (!x.initialised())
+        return RandomVariable();
+    if (x.deterministic())
+        return RandomVariable(size, x[0], x.time());
+    return RandomVariable(size, x.data() + offset, x.time());
+}
+
+RandomVariable joinChunks(const std::vector<const RandomVariable*>& chunks, const std::size_t n) {
+    bool deterministic = true;
+    for (auto const c : chunks) {
+        if (!c->initialised())
+            return RandomVariable();
+        deterministic = deterministic && c->deterministic() && (*c)[0] == (*chunks.front())[0];
+    }
+    if (deterministic)
+        return RandomVariable(n, (*chunks.front())[0], chunks.front()->time());
+    RandomVariable result(n, 0.0, chunks.front()->time());
+    result.expand();
+    std::size_t offset = 0;
+    for (auto const c : chunks) {
+        for (std::size_t j = 0; j < c->size(); ++j)
+            result.data()[offset + j] = (*c)[j];
+        offset += c->size();
+    }
+    return result;
+}
+
+} // namespace
+
 class BasicCpuContext : public ComputeContext {
 public:
-    BasicCpuContext();
+    explicit BasicCpuContext(const bool multiThreaded = false, const bool blocked = false);
     ~BasicCpuContext() override final;
     void init() override final;
 
@@ -84,7 +122,29 @@ private:
         std::vector<std::size_t> resultId_;
     };
 
+    /* for the multi-threaded execution the samples are split into chunks of this minimum size, the number of chunks
+       does not depend on the number of threads, using more chunks than threads balances the load */
+    static constexpr std::size_t minChunkSize = 1024;
+    static constexpr std::size_t maxChunks = 64;
+
+    /* for the blocked execution the samples are split into chunks of (roughly) this size without an upper bound on
+       the number of chunks, so that the ops between two conditional expectations are executed on one block of paths
+       after the other with the live values of a block staying in the cache */
+    static constexpr std::size_t blockSize = 1024;
+
+    // layout of the chunks for the current calc, the sizes are multiples of 8 except for the last chunk
+    void setupChunks(const std::size_t n);
+    // executes the op i of the current program on the given chunk
+    void executeOperation(const std::vector<RandomVariableOp>& ops, const std::size_t i, const std::size_t chunk);
+    // executes the op i of the current program on the joined chunks (for ops not operating pathwise)
+    void executeOperationOnAllChunks(const std::vector<RandomVariableOp>& ops, const std::size_t i);
+    const RandomVariable* chunkArgument(const std::size_t chunk, const std::size_t id) const;
+    RandomVariable& chunkResult(const std::size_t chunk, const std::size_t id);
+
     bool initialized_ = false;
+    bool multiThreaded_;
+    bool blocked_;
+    ChunkWorkers workers_;
 
     // will be accumulated over all calcs
     ComputeContext::DebugInfo debugInfo_;
@@ -110,6 +170,12 @@ private:
     std::vector<RandomVariable> values_;
     std::vector<std::size_t> freedVariables_;
 
+    // the values and variates split into chunks during the calculation, for one chunk the variates are not copied
+
+    std::vector<std::size_t> chunkOffset_, chunkSize_;
+    std::vector<std::vector<RandomVariable>> chunkValues_;
+    std::vector<std::vector<RandomVariable>> chunkVariates_;
+
     // shared random variates for all calcs
 
     std::unique_ptr<QuantLib::MersenneTwisterUniformRng> rng_;
@@ -117,7 +183,11 @@ private:
     std::vector<RandomVariable> variates_;
 };
 
-BasicCpuFramework::BasicCpuFramework() { contexts_["BasicCpu/Default/Default"] = new BasicCpuContext(); }
+BasicCpuFramework::BasicCpuFramework() {
+    contexts_["BasicCpu/Default/Default"] = new BasicCpuContext();
+    contexts_["BasicCpu/Default/MultiThreaded"] = new BasicCpuContext(true);
+    contexts_["BasicCpu/Default/Blocked"] = new BasicCpuContext(false, true);
+}
 
 BasicCpuFramework::~BasicCpuFramework() {
     for (auto& [_, c] : contexts_) {
@@ -125,7 +195,9 @@ BasicCpuFramework::~BasicCpuFramework() {
     }
 }
 
-BasicCpuContext::BasicCpuContext() : initialized_(false) {}
+BasicCpuContext::BasicCpuContext(const bool multiThreaded, const bool blocked)
+    : initialized_(false), multiThreaded_(multiThreaded), blocked_(blocked),
+      workers_(multiThreaded ? std::max<std::size_t>(std::thread::hardware_concurrency(), 1) : 1) {}
 
 BasicCpuContext::~BasicCpuContext() {}
 
@@ -350,55 +422,138 @@ void BasicCpuContext::finalizeCalculation(std::vector<double*>& output) {
 
     values_.resize(numberOfInputVars_[currentId_ - 1] + numberOfVars_[currentId_ - 1]);
 
-    // execute calculation
+    // split values and variates into chunks
+
+    setupChunks(size_[currentId_ - 1]);
+    const std::size_t nChunks = chunkSize_.size();
+
+    chunkValues_.resize(nChunks);
+    if (nChunks == 1) {
+        chunkValues_[0] = std::move(values_);
+    } else {
+        workers_.run(nChunks, [this](const std::size_t c) {
+            chunkValues_[c].clear();
+            for (auto const& v : values_)
+                chunkValues_[c].push_back(chunkOf(v, chunkOffset_[c], chunkSize_[c]));
+            for (std::size_t k = chunkVariates_[c].size(); k < variates_.size(); ++k)
+                chunkVariates_[c].push_back(chunkOf(variates_[k], chunkOffset_[c], chunkSize_[c]));
+        });
+        values_.clear();
+    }
 
-    for (Size i = 0; i < program_[currentId_ - 1].size(); ++i) {
-        std::vector<const RandomVariable*> args(p.args(i).size());
-        for (Size j = 0; j < p.args(i).size(); ++j) {
-            if (p.args(i)[j] < numberOfInputVars_[currentId_ - 1])
-                args[j] = &values_[p.args(i)[j]];
-            else if (p.args(i)[j] < numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1])
-                args[j] = &variates_[p.args(i)[j] - numberOfInputVars_[currentId_ - 1]];
+    // execute calculation, the ops between two conditional expectations are executed chunkwise in parallel
+
+    for (Size i = 0; i < p.size();) {
+        Size end = i;
+        while (end < p.size() && p.op(end) != RandomVariableOpCode::ConditionalExpectation)
+            ++end;
+        workers_.run(nChunks, [this, &ops, i, end](const std::size_t c) {
+            for (Size k = i; k < end; ++k)
+                executeOperation(ops, k, c);
+        });
+        if (end < p.size()) {
+            if (nChunks == 1)
+                executeOperation(ops, end, 0);
             else
-                args[j] = &values_[p.args(i)[j] - numberOfVariates_[currentId_ - 1]];
-        }
-        if (p.resultId(i) < numberOfInputVars_[currentId_ - 1])
-            values_[p.resultId(i)] = ops[p.op(i)](args);
-        else if (p.resultId(i) >= numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1])
-            values_[p.resultId(i) - numberOfVariates_[currentId_ - 1]] = ops[p.op(i)](args);
-        else {
-            QL_FAIL("BasiCpuContext::finalizeCalculation(): internal error, result id "
-                    << p.resultId(i) << " does not fall into values array.");
+                executeOperationOnAllChunks(ops, end);
         }
+        i = end + 1;
     }
 
     // fill output
 
-    for (Size i = 0; i < outputVars_[currentId_ - 1].size(); ++i) {
-        std::size_t id = outputVars_[currentId_ - 1][i];
-        RandomVariable* v;
-        if (id < numberOfInputVars_[currentId_ - 1])
-            v = &values_[id];
-        else if (id < numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1]) {
-            v = &variates_[id - numberOfInputVars_[currentId_ - 1]];
-        }
-        else
-            v = &values_[id - numberOfVariates_[currentId_ - 1]];
-        for (Size j = 0; j < size_[currentId_ - 1]; ++j) {
-            output[i][j] = v->operator[](j);
+    workers_.run(nChunks, [this, &output](const std::size_t c) {
+        for (Size i = 0; i < outputVars_[currentId_ - 1].size(); ++i) {
+            const RandomVariable* v = chunkArgument(c, outputVars_[currentId_ - 1][i]);
+            for (Size j = 0; j < chunkSize_[c]; ++j) {
+                output[i][chunkOffset_[c] + j] = v->operator[](j);
+            }
         }
+        // release the values on the thread that (mostly) allocated them
+        chunkValues_[c].clear();
+    });
+}
+
+void BasicCpuContext::setupChunks(const std::size_t n) {
+    std::size_t nChunks = 1;
+    if (blocked_)
+        nChunks = (n + blockSize - 1) / blockSize;
+    else if (multiThreaded_)
+        nChunks = std::max<std::size_t>(std::min(maxChunks, n / minChunkSize), 1);
+    std::size_t chunkSize = ((n + nChunks - 1) / nChunks + 7) / 8 * 8;
+    std::vector<std::size_t> offset, size;
+    for (std::size_t o = 0; o < n; o += chunkSize) {
+        offset.push_back(o);
+        size.push_back(std::min(chunkSize, n - o));
+    }
+    if (offset != chunkOffset_ || size != chunkSize_) {
+        chunkOffset_ = offset;
+        chunkSize_ = size;
+        chunkVariates_.clear();
     }
+    chunkVariates_.resize(chunkSize_.size() == 1 ? 0 : chunkSize_.size());
+}
+
+const RandomVariable* BasicCpuContext::chunkArgument(const std::size_t chunk, const std::size_t id) const {
+    std::size_t nInput = numberOfInputVars_[currentId_ - 1], nVariates = numberOfVariates_[currentId_ - 1];
+    if (id < nInput)
+        return &chunkValues_[chunk][id];
+    else if (id < nInput + nVariates)
+        return chunkVariates_.empty() ? &variates_[id - nInput] : &chunkVariates_[chunk][id - nInput];
+    else
+        return &chunkValues_[chunk][id - nVariates];
+}
+
+RandomVariable& BasicCpuContext::chunkResult(const std::size_t chunk, const std::size_t id) {
+    std::size_t nInput = numberOfInputVars_[currentId_ - 1], nVariates = numberOfVariates_[currentId_ - 1];
+    if (id < nInput)
+        return chunkValues_[chunk][id];
+    else if (id >= nInput + nVariates)
+        return chunkValues_[chunk][id - nVariates];
+    QL_FAIL("BasiCpuContext::finalizeCalculation(): internal error, result id " << id
+                                                                               << " does not fall into values array.");
+}
+
+void BasicCpuContext::executeOperation(const std::vector<RandomVariableOp>& ops, const std::size_t i,
+                                       const std::size_t chunk) {
+    const auto& p = program_[currentId_ - 1];
+    std::vector<const RandomVariable*> args(p.args(i).size());
+    for (Size j = 0; j < p.args(i).size(); ++j)
+        args[j] = chunkArgument(chunk, p.args(i)[j]);
+    chunkResult(chunk, p.resultId(i)) = ops[p.op(i)](args);
+}
+
+void BasicCpuContext::executeOperationOnAllChunks(const std::vector<RandomVariableOp>& ops, const std::size_t i) {
+    const auto& p = program_[currentId_ - 1];
+    std::vector<RandomVariable> joinedArgs(p.args(i).size());
+    std::vector<const RandomVariable*> args(p.args(i).size());
+    for (Size j = 0; j < p.args(i).size(); ++j) {
+        std::vector<const RandomVariable*> chunks;
+        for (Size c = 0; c < chunkSize_.size(); ++c)
+            chunks.push_back(chunkArgument(c, p.args(i)[j]));
+        joinedArgs[j] = joinChunks(chunks, size_[currentId_ - 1]);
+        args[j] = &joinedArgs[j];
+    }
+    RandomVariable result = ops[p.op(i)](args);
+    for (Size c = 0; c < chunkSize_.size(); ++c)
+        chunkResult(c, p.resultId(i)) = chunkOf(result, chunkOffset_[c], chunkSize_[c]);
 }
 
 const ComputeContext::DebugInfo& BasicCpuContext::debugInfo() const { return debugInfo_; }
 
-std::set<std::string> BasicCpuFramework::getAvailableDevices() const { return {"BasicCpu/Default/Default"}; }
+std::set<std::string> BasicCpuFramework::getAvailableDevices() const {
+    std::set<std::string> result;
+    for (auto const& [name, _] : contexts_)
+        result.insert(name);
+    return result;
+}
 
 ComputeContext* BasicCpuFramework::getContext(const std::string& deviceName) {
-    QL_REQUIRE(deviceName == "BasicCpu/Default/Default",
-               "BasicCpuFramework::getContext(): device '"
-                   << deviceName << "' not supported. Available device is 'BasicCpu/Default/Default'.");
-    return contexts_[deviceName];
+    auto c = contexts_.find(deviceName);
+    QL_REQUIRE(c != contexts_.end(), "BasicCpuFramework::getContext(): device '"
+                                         << deviceName << "' not supported. Available devices are '"
+                                         << boost::join(getAvailableDevices(), "', '") << "'.");
+    return c->second;
 }
 
 }; // namespace QuantExt
@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/chunkworkers.hpp>
+
+#include <algorithm>
+
+namespace QuantExt {
+
+ChunkWorkers::~ChunkWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& t : threads_)
+        t.join();
+}
+
+void ChunkWorkers::work(const std::function<void(std::size_t)>& f) {
+    std::size_t c;
+    while ((c = nextChunk_.fetch_add(1)) < nChunks_) {
+        try {
+            f(c);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!exception_)
+                exception_ = std::current_exception();
+        }
+    }
+}
+
+void ChunkWorkers::workerLoop() {
+    std::size_t generation = 0;
+    while (true) {
+        const std::function<void(std::size_t)>* f;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [this, generation] { return stop_ || generation_ != generation; });
+            if (stop_)
+                return;
+            generation = generation_;
+            // the run might be finished by the other threads already
+            if (f_ == nullptr)
+                continue;
+            f = f_;
+            ++busy_;
+        }
+        work(*f);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busy_;
+        }
+        done_.notify_one();
+    }
+}
+
+void ChunkWorkers::run(const std::size_t nChunks, const std::function<void(std::size_t)>& f) {
+    if (nChunks <= 1 || nThreads_ == 1) {
+        for (std::size_t c = 0; c < nChunks; ++c)
+            f(c);
+        return;
+    }
+    if (threads_.empty()) {
+        for (std::size_t i = 0; i < nThreads_ - 1; ++i)
+            threads_.emplace_back(&ChunkWorkers::workerLoop, this);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        f_ = &f;
+        nChunks_ = nChunks;
+        nextChunk_ = 0;
+        exception_ = nullptr;
+        ++generation_;
+    }
+    start_.notify_all();
+    work(f);
+    std::exception_ptr e;
+    {
+        // no worker picks up the current generation once all chunks are taken and busy_ is zero
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        f_ = nullptr;
+        e = exception_;
+    }
+    if (e)
+        std::rethrow_exception(e);
+}
+
+} // namespace QuantExt
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/chunkworkers.hpp
+    \brief persistent worker threads processing chunks of work
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace QuantExt {
+
+/*! Persistent worker threads executing a function for a number of chunks. The calling thread takes part in the work,
+   so that nThreads - 1 workers are started. The first exception thrown by the function is rethrown by run(). */
+class ChunkWorkers {
+public:
+    explicit ChunkWorkers(const std::size_t nThreads) : nThreads_(std::max<std::size_t>(nThreads, 1)) {}
+    ~ChunkWorkers();
+    std::size_t nThreads() const { return nThreads_; }
+    void run(const std::size_t nChunks, const std::function<void(std::size_t)>& f);
+
+private:
+    void work(const std::function<void(std::size_t)>& f);
+    void workerLoop();
+
+    std::size_t nThreads_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    bool stop_ = false;
+    std::size_t generation_ = 0, busy_ = 0, nChunks_ = 0;
+    const std::function<void(std::size_t)>* f_ = nullptr;
+    std::atomic<std::size_t> nextChunk_{0};
+    std::exception_ptr exception_;
+};
+
+} // namespace QuantExt
@@ -16,82 +16,32 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <qle/ad/computationgraph.hpp>
 #include <qle/math/compiledformula.hpp>
+#include <qle/math/randomvariable.hpp>
 
 namespace QuantExt {
 
-CompiledFormula& CompiledFormula::operator=(const CompiledFormula& f) {
-    op_ = f.op_;
-    x_ = f.x_;
-    v_ = f.v_;
-    args_ = f.args_;
-    return *this;
-}
-
-CompiledFormula& CompiledFormula::operator=(CompiledFormula&& f) {
-    op_ = f.op_;
-    x_ = f.x_;
-    v_ = f.v_;
-    args_.swap(f.args_);
+CompiledFormula& CompiledFormula::apply(const CompiledFormula& y, Operator op) {
+    stackSize_ = std::max(stackSize_, y.stackSize_ + 1);
+    program_.insert(program_.end(), y.program_.begin(), y.program_.end());
+    program_.push_back({op, Null<Real>(), Null<Size>()});
     return *this;
 }
 
 //
 
-CompiledFormula& CompiledFormula::operator+=(const CompiledFormula& y) {
-    std::vector<CompiledFormula> newArgs;
-    newArgs.push_back(*this);
-    newArgs.push_back(y);
-    op_ = plus;
-    x_ = Null<Real>();
-    v_ = Null<Size>();
-    args_.swap(newArgs);
-    return *this;
-}
+CompiledFormula& CompiledFormula::operator+=(const CompiledFormula& y) { return apply(y, plus); }
 
-CompiledFormula& CompiledFormula::operator-=(const CompiledFormula& y) {
-    std::vector<CompiledFormula> newArgs;
-    newArgs.push_back(*this);
-    newArgs.push_back(y);
-    op_ = minus;
-    x_ = Null<Real>();
-    v_ = Null<Size>();
-    args_.swap(newArgs);
-    return *this;
-}
+CompiledFormula& CompiledFormula::operator-=(const CompiledFormula& y) { return apply(y, minus); }
 
-CompiledFormula& CompiledFormula::operator*=(const CompiledFormula& y) {
-    std::vector<CompiledFormula> newArgs;
-    newArgs.push_back(*this);
-    newArgs.push_back(y);
-    op_ = multiply;
-    x_ = Null<Real>();
-    v_ = Null<Size>();
-    args_.swap(newArgs);
-    return *this;
-}
+CompiledFormula& CompiledFormula::operator*=(const CompiledFormula& y) { return apply(y, multiply); }
 
-CompiledFormula& CompiledFormula::operator/=(const CompiledFormula& y) {
-    std::vector<CompiledFormula> newArgs;
-    newArgs.push_back(*this);
-    newArgs.push_back(y);
-    op_ = divide;
-    x_ = Null<Real>();
-    v_ = Null<Size>();
-    args_.swap(newArgs);
-    return *this;
-}
+CompiledFormula& CompiledFormula::operator/=(const CompiledFormula& y) { return apply(y, divide); }
 
 //
 
-CompiledFormula CompiledFormula::operator-() const {
-    CompiledFormula r;
-    r.args_ = std::vector<CompiledFormula>(1, *this);
-    r.op_ = negate;
-    r.x_ = Null<Real>();
-    r.v_ = Null<Size>();
-    return r;
-}
+CompiledFormula CompiledFormula::operator-() const { return unaryOp(*this, negate); }
 
 //
 
@@ -116,23 +66,12 @@ CompiledFormula operator/(CompiledFormula x, const CompiledFormula& y) {
 }
 
 CompiledFormula unaryOp(CompiledFormula x, CompiledFormula::Operator op) {
-    std::vector<CompiledFormula> newArgs;
-    newArgs.push_back(x);
-    x.op_ = op;
-    x.x_ = Null<Real>();
-    x.v_ = Null<Size>();
-    x.args_.swap(newArgs);
+    x.program_.push_back({op, Null<Real>(), Null<Size>()});
     return x;
 }
 
 CompiledFormula binaryOp(CompiledFormula x, const CompiledFormula& y, CompiledFormula::Operator op) {
-    std::vector<CompiledFormula> newArgs;
-    newArgs.push_back(x);
-    newArgs.push_back(y);
-    x.op_ = op;
-    x.x_ = Null<Real>();
-    x.v_ = Null<Size>();
-    x.args_.swap(newArgs);
+    x.apply(y, op);
     return x;
 }
 
@@ -164,4 +103,140 @@ CompiledFormula min(CompiledFormula x, const CompiledFormula& y) { return binary
 // cppcheck-suppress passedByValue
 CompiledFormula pow(CompiledFormula x, const CompiledFormula& y) { return binaryOp(x, y, CompiledFormula::pow); }
 
+//
+
+RandomVariable CompiledFormula::eval(const std::vector<RandomVariable>& values) const {
+    Size n = values.empty() ? 1 : values.front().size();
+    RandomVariable zero(n, 0.0);
+    std::vector<RandomVariable> stack;
+    stack.reserve(stackSize_);
+    for (auto const& i : program_) {
+        if (i.op == none) {
+            if (i.v == Null<Size>()) {
+                stack.push_back(RandomVariable(n, i.x));
+            } else {
+                QL_REQUIRE(i.v < values.size(), "CompiledFormula: need value for index "
+                                                    << i.v << ", given values size is " << values.size());
+                stack.push_back(values[i.v]);
+            }
+            continue;
+        }
+        RandomVariable& x = stack[stack.size() - (i.op <= pow ? 2 : 1)];
+        switch (i.op) {
+        case plus:
+            x += stack.back();
+            break;
+        case minus:
+            x -= stack.back();
+            break;
+        case multiply:
+            x *= stack.back();
+            break;
+        case divide:
+            x /= stack.back();
+            break;
+        case max:
+            x = QuantExt::max(std::move(x), stack.back());
+            break;
+        case min:
+            x = QuantExt::min(std::move(x), stack.back());
+            break;
+        case pow:
+            x = QuantExt::pow(std::move(x), stack.back());
+            break;
+        case gtZero:
+            x = QuantExt::indicatorGt(std::move(x), zero);
+            break;
+        case geqZero:
+            x = QuantExt::indicatorGeq(std::move(x), zero);
+            break;
+        case abs:
+            x = QuantExt::abs(std::move(x));
+            break;
+        case negate:
+            x = -std::move(x);
+            break;
+        case exp:
+            x = QuantExt::exp(std::move(x));
+            break;
+        case log:
+            x = QuantExt::log(std::move(x));
+            break;
+        default:
+            QL_FAIL("CompiledFormula: unknown operator");
+        }
+        if (i.op <= pow)
+            stack.pop_back();
+    }
+    return stack.front();
+}
+
+std::size_t CompiledFormula::eval(ComputationGraph& g, const std::vector<std::size_t>& values) const {
+    std::vector<std::size_t> stack;
+    stack.reserve(stackSize_);
+    for (auto const& i : program_) {
+        if (i.op == none) {
+            if (i.v == Null<Size>()) {
+                stack.push_back(cg_const(g, i.x));
+            } else {
+                QL_REQUIRE(i.v < values.size(), "CompiledFormula: need node for index "
+                                                    << i.v << ", given nodes size is " << values.size());
+                stack.push_back(values[i.v]);
+            }
+            continue;
+        }
+        bool binary = i.op <= pow;
+        std::size_t a = stack[stack.size() - (binary ? 2 : 1)];
+        std::size_t b = stack.back();
+        std::size_t r;
+        switch (i.op) {
+        case plus:
+            r = cg_add(g, a, b);
+            break;
+        case minus:
+            r = cg_subtract(g, a, b);
+            break;
+        case multiply:
+            r = cg_mult(g, a, b);
+            break;
+        case divide:
+            r = cg_div(g, a, b);
+            break;
+        case max:
+            r = cg_max(g, a, b);
+            break;
+        case min:
+            r = cg_min(g, a, b);
+            break;
+        case pow:
+            r = cg_pow(g, a, b);
+            break;
+        case gtZero:
+            r = cg_indicatorGt(g, a, cg_const(g, 0.0));
+            break;
+        case geqZero:
+            r = cg_indicatorGeq(g, a, cg_const(g, 0.0));
+            break;
+        case abs:
+            r = cg_abs(g, a);
+            break;
+        case negate:
+            r = cg_negative(g, a);
+            break;
+        case exp:
+            r = cg_exp(g, a);
+            break;
+        case log:
+            r = cg_log(g, a);
+            break;
+        default:
+            QL_FAIL("CompiledFormula: unknown operator");
+        }
+        if (binary)
+            stack.pop_back();
+        stack.back() = r;
+    }
+    return stack.front();
+}
+
 } // namespace QuantExt
@@ -28,6 +28,8 @@
 #include <ql/types.hpp>
 #include <ql/utilities/null.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 using QuantLib::Null;
@@ -36,23 +38,41 @@ using QuantLib::Size;
 
 namespace QuantExt {
 
+class ComputationGraph;
+struct RandomVariable;
+
 //! helper class representing a formula with variables given by an id v
+/*! The formula is held as a flat postfix program, which is extended as the formula is built up by the operators
+    below, so that an evaluation is a single loop over the program without recursion. The same program can be
+    evaluated on scalars, on random variables (i.e. on all paths at once) and on computation graph nodes. */
 class CompiledFormula {
 public:
+    // the operators plus, ..., pow are binary, the ones following pow are unary
     enum Operator { none, plus, minus, multiply, divide, max, min, pow, abs, gtZero, geqZero, negate, exp, log };
-    CompiledFormula() : op_(none), x_(0.0), v_(Null<Size>()) {}
+    //! instruction of the postfix program, for op = none a constant x or a variable with index v is pushed
+    struct Instruction {
+        Operator op;
+        Real x;
+        Size v;
+    };
+    CompiledFormula() : program_(1, {none, 0.0, Null<Size>()}), stackSize_(1) {}
     // ctor representing a formula that is a constant value x
-    CompiledFormula(const Real x) : op_(none), x_(x), v_(Null<Size>()) {}
+    CompiledFormula(const Real x) : program_(1, {none, x, Null<Size>()}), stackSize_(1) {}
     // ctor representing a formula that is a variable with index v
-    CompiledFormula(const Size v) : op_(none), x_(Null<Real>()), v_(v) {}
-    CompiledFormula(const CompiledFormula& f) : op_(f.op_), x_(f.x_), v_(f.v_), args_(f.args_) {}
-    CompiledFormula(CompiledFormula&& f) : op_(f.op_), x_(f.x_), v_(f.v_) { args_.swap(f.args_); }
-    CompiledFormula& operator=(const CompiledFormula&);
-    CompiledFormula& operator=(CompiledFormula&&);
+    CompiledFormula(const Size v) : program_(1, {none, Null<Real>(), v}), stackSize_(1) {}
 
     // evaluate given values for the variables at index 0, 1, 2, ...
     template <class I> Real operator()(I begin, I end) const;
     Real operator()(const std::vector<Real>& values) const { return operator()(values.begin(), values.end()); }
+    /* evaluate given random variables for the variables at index 0, 1, 2, ..., all of the same size, which is also
+       the size of the result */
+    RandomVariable eval(const std::vector<RandomVariable>& values) const;
+    // add the formula to a computation graph given the nodes of the variables at index 0, 1, 2, ...
+    std::size_t eval(ComputationGraph& g, const std::vector<std::size_t>& values) const;
+
+    // the postfix program and the maximum stack size needed to evaluate it
+    const std::vector<Instruction>& program() const { return program_; }
+    Size stackSize() const { return stackSize_; }
 
     // Operators
     CompiledFormula& operator+=(const CompiledFormula&);
@@ -80,56 +100,86 @@ public:
 private:
     friend CompiledFormula unaryOp(CompiledFormula, Operator op);
     friend CompiledFormula binaryOp(CompiledFormula, const CompiledFormula&, Operator op);
-    Operator op_;
-    Real x_;
-    Size v_;
-    std::vector<CompiledFormula> args_;
+    CompiledFormula& apply(const CompiledFormula&, Operator op);
+    std::vector<Instruction> program_;
+    Size stackSize_;
 };
 
 // implementation
 
 template <class I> Real CompiledFormula::operator()(I begin, I end) const {
-    if (x_ != Null<Real>())
-        return x_;
-    if (v_ != Null<Size>()) {
-        QL_REQUIRE((end - begin) > static_cast<int>(v_),
-                   "CompiledFormula: need value for index " << v_ << ", given values size is " << (end - begin));
-        return *(begin + v_);
-    }
-    switch (op_) {
-    case plus:
-        return args_[0](begin, end) + args_[1](begin, end);
-    case minus:
-        return args_[0](begin, end) - args_[1](begin, end);
-    case multiply:
-        return args_[0](begin, end) * args_[1](begin, end);
-    case divide:
-        return args_[0](begin, end) / args_[1](begin, end);
-    case max:
-        return std::max(args_[0](begin, end), args_[1](begin, end));
-    case min:
-        return std::min(args_[0](begin, end), args_[1](begin, end));
-    case pow:
-        return std::pow(args_[0](begin, end), args_[1](begin, end));
-    case gtZero: {
-        Real tmp = args_[0](begin, end);
-        return tmp > 0.0 && !QuantLib::close_enough(tmp, 0.0) ? 1.0 : 0.0;
-    }
-    case geqZero: {
-        Real tmp = args_[0](begin, end);
-        return tmp > 0.0 || QuantLib::close_enough(tmp, 0.0) ? 1.0 : 0.0;
+    Real localStack[16];
+    std::vector<Real> heapStack;
+    Real* stack = localStack;
+    if (stackSize_ > 16) {
+        heapStack.resize(stackSize_);
+        stack = heapStack.data();
     }
-    case abs:
-        return std::abs(args_[0](begin, end));
-    case negate:
-        return -args_[0](begin, end);
-    case exp:
-        return std::exp(args_[0](begin, end));
-    case log:
-        return std::log(args_[0](begin, end));
-    default:
-        QL_FAIL("CompiledFormula: unknown operator");
+    // t is the number of values on the stack, the top value is stack[t-1]
+    Size t = 0;
+    for (auto const& i : program_) {
+        switch (i.op) {
+        case none:
+            if (i.v == Null<Size>()) {
+                stack[t++] = i.x;
+            } else {
+                QL_REQUIRE((end - begin) > static_cast<int>(i.v), "CompiledFormula: need value for index "
+                                                                      << i.v << ", given values size is "
+                                                                      << (end - begin));
+                stack[t++] = *(begin + i.v);
+            }
+            break;
+        case plus:
+            --t;
+            stack[t - 1] += stack[t];
+            break;
+        case minus:
+            --t;
+            stack[t - 1] -= stack[t];
+            break;
+        case multiply:
+            --t;
+            stack[t - 1] *= stack[t];
+            break;
+        case divide:
+            --t;
+            stack[t - 1] /= stack[t];
+            break;
+        case max:
+            --t;
+            stack[t - 1] = std::max(stack[t - 1], stack[t]);
+            break;
+        case min:
+            --t;
+            stack[t - 1] = std::min(stack[t - 1], stack[t]);
+            break;
+        case pow:
+            --t;
+            stack[t - 1] = std::pow(stack[t - 1], stack[t]);
+            break;
+        case gtZero:
+            stack[t - 1] = stack[t - 1] > 0.0 && !QuantLib::close_enough(stack[t - 1], 0.0) ? 1.0 : 0.0;
+            break;
+        case geqZero:
+            stack[t - 1] = stack[t - 1] > 0.0 || QuantLib::close_enough(stack[t - 1], 0.0) ? 1.0 : 0.0;
+            break;
+        case abs:
+            stack[t - 1] = std::abs(stack[t - 1]);
+            break;
+        case negate:
+            stack[t - 1] = -stack[t - 1];
+            break;
+        case exp:
+            stack[t - 1] = std::exp(stack[t - 1]);
+            break;
+        case log:
+            stack[t - 1] = std::log(stack[t - 1]);
+            break;
+        default:
+            QL_FAIL("CompiledFormula: unknown operator");
+        }
     }
+    return stack[0];
 }
 
 } // namespace QuantExt
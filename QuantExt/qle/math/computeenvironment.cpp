@@ -17,8 +17,11 @@
 */
 
 #include <qle/math/computeenvironment.hpp>
+#include <qle/math/shardedcomputeenvironment.hpp>
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
 
 #include <ql/errors.hpp>
 
@@ -29,6 +32,10 @@ ComputeEnvironment::ComputeEnvironment() { reset(); }
 ComputeEnvironment::~ComputeEnvironment() { releaseFrameworks(); }
 
 void ComputeEnvironment::releaseFrameworks() {
+    // the sharded contexts refer to the contexts owned by the frameworks
+    for (auto& [_, c] : shardedContexts_)
+        delete c;
+    shardedContexts_.clear();
     for (auto& f : frameworks_)
         delete f;
     frameworks_.clear();
@@ -53,19 +60,36 @@ std::set<std::string> ComputeEnvironment::getAvailableDevices() const {
 
 bool ComputeEnvironment::hasContext() const { return currentContext_ != nullptr; }
 
+ComputeContext* ComputeEnvironment::getContext(const std::string& deviceName) {
+    for (auto& f : frameworks_) {
+        if (auto tmp = f->getAvailableDevices(); tmp.find(deviceName) != tmp.end())
+            return f->getContext(deviceName);
+    }
+    QL_FAIL("ComputeEnvironment::selectContext(): device '"
+            << deviceName << "' not found. Available devices: " << boost::join(getAvailableDevices(), ","));
+}
+
 void ComputeEnvironment::selectContext(const std::string& deviceName) {
     if (currentContextDeviceName_ == deviceName)
         return;
-    for (auto& f : frameworks_) {
-        if (auto tmp = f->getAvailableDevices(); tmp.find(deviceName) != tmp.end()) {
-            currentContext_ = f->getContext(deviceName);
-            currentContext_->init();
-            currentContextDeviceName_ = deviceName;
-            return;
+    if (deviceName.find('+') == std::string::npos) {
+        currentContext_ = getContext(deviceName);
+    } else {
+        auto s = shardedContexts_.find(deviceName);
+        if (s == shardedContexts_.end()) {
+            std::vector<std::string> names;
+            boost::split(names, deviceName, [](const char c) { return c == '+'; });
+            std::vector<ComputeContext*> devices;
+            for (auto& n : names) {
+                boost::trim(n);
+                devices.push_back(getContext(n));
+            }
+            s = shardedContexts_.insert(std::make_pair(deviceName, new ShardedComputeContext(devices, names))).first;
         }
+        currentContext_ = s->second;
     }
-    QL_FAIL("ComputeEnvironment::selectContext(): device '"
-            << deviceName << "' not found. Available devices: " << boost::join(getAvailableDevices(), ","));
+    currentContext_->init();
+    currentContextDeviceName_ = deviceName;
 }
 
 ComputeContext& ComputeEnvironment::context() { return *currentContext_; }
@@ -29,6 +29,7 @@
 #include <boost/thread/shared_mutex.hpp>
 
 #include <cstdint>
+#include <map>
 #include <set>
 
 namespace QuantExt {
@@ -36,6 +37,8 @@ namespace QuantExt {
 class ComputeContext;
 class ComputeFramework;
 
+/*! A device name of the form "deviceA+deviceB+..." selects a context splitting the samples of a calculation over the
+    given devices, see ShardedComputeContext. */
 class ComputeEnvironment : public QuantLib::Singleton<ComputeEnvironment> {
 public:
     ComputeEnvironment();
@@ -48,8 +51,10 @@ public:
 
 private:
     void releaseFrameworks();
+    ComputeContext* getContext(const std::string& deviceName);
 
     std::vector<ComputeFramework*> frameworks_;
+    std::map<std::string, ComputeContext*> shardedContexts_;
     ComputeContext* currentContext_;
     std::string currentContextDeviceName_;
 };
@@ -66,12 +71,18 @@ public:
     struct Settings {
         Settings()
             : debug(false), useDoublePrecision(false), rngSequenceType(QuantExt::SequenceType::MersenneTwister),
-              rngSeed(42), regressionOrder(4) {}
+              rngSeed(42), regressionOrder(4), regressionOnDevice(false) {}
         bool debug;
+        /* if false, the kernel based devices store the path values in single precision, the conditional
+           expectations are calculated in double precision on the host nevertheless */
         bool useDoublePrecision;
         QuantExt::SequenceType rngSequenceType;
         std::size_t rngSeed;
         std::size_t regressionOrder;
+        /* if true, devices that support this calculate the conditional expectations on the device (normal equations
+           solved by a Cholesky decomposition, in the precision given by useDoublePrecision), so that the path values
+           do not need to be copied to the host and back for each conditional expectation */
+        bool regressionOnDevice;
     };
 
     struct DebugInfo {
@@ -79,6 +90,10 @@ public:
         unsigned long nanoSecondsDataCopy = 0;
         unsigned long nanoSecondsProgramBuild = 0;
         unsigned long nanoSecondsCalculation = 0;
+        // pathwise ops evaluated within a fused kernel with their result kept in a register, counted per path as
+        // numberOfOperations, and the global memory traffic in bytes that this saves, only set by kernel generators
+        unsigned long numberOfFusedOperations = 0;
+        unsigned long bytesMemoryTrafficSaved = 0;
     };
 
     virtual ~ComputeContext() {}
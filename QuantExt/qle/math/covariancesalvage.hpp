@@ -24,6 +24,9 @@
 #pragma once
 
 #include <ql/math/matrixutilities/pseudosqrt.hpp>
+#include <ql/shared_ptr.hpp>
+
+#include <algorithm>
 
 namespace QuantExt {
 
@@ -64,4 +67,30 @@ struct SpectralCovarianceSalvage : public CovarianceSalvage {
     }
 };
 
+/*! Decorator caching the result of another salvage method for the last input matrix, i.e. repeated calls with the
+    same matrix (e.g. for several confidence levels or several portfolios sharing a covariance matrix) only salvage the
+    matrix once. The cache is not protected against concurrent access. */
+class CachedCovarianceSalvage : public CovarianceSalvage {
+public:
+    explicit CachedCovarianceSalvage(const QuantLib::ext::shared_ptr<CovarianceSalvage>& salvage)
+        : salvage_(salvage) {}
+    std::pair<Matrix, Matrix> salvage(const Matrix& m) const override {
+        if (!valid_ || m.rows() != input_.rows() || m.columns() != input_.columns() ||
+            !std::equal(m.begin(), m.end(), input_.begin())) {
+            result_ = salvage_->salvage(m);
+            input_ = m;
+            valid_ = true;
+        }
+        return result_;
+    }
+    //! the salvage method whose results are cached
+    const QuantLib::ext::shared_ptr<CovarianceSalvage>& underlying() const { return salvage_; }
+
+private:
+    QuantLib::ext::shared_ptr<CovarianceSalvage> salvage_;
+    mutable bool valid_ = false;
+    mutable Matrix input_;
+    mutable std::pair<Matrix, Matrix> result_;
+};
+
 } // namespace QuantExt
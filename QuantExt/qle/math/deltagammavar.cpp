@@ -42,68 +42,113 @@ void check(const Matrix& omega, const Array& delta, const Matrix& gamma) {
                "gamma (" << gamma.rows() << "x" << gamma.columns() << ") must have same dimensions as omega ("
                          << omega.rows() << "x" << omega.columns() << ")");
 }
-} // namespace detail
 
-namespace {
-void moments(const Matrix& omega, const Array& delta, const Matrix& gamma, Real& num, Real& mu, Real& variance) {
-    detail::check(omega, delta, gamma);
+std::vector<Size> gammaSupport(const Matrix& gamma) {
+    QL_REQUIRE(gamma.rows() == gamma.columns(),
+               "gamma (" << gamma.rows() << "x" << gamma.columns() << ") must be square in VaR calculation");
+    std::vector<Size> support;
+    for (Size i = 0; i < gamma.rows(); ++i) {
+        for (Size j = 0; j < gamma.columns(); ++j) {
+            if (gamma[i][j] != 0.0 || gamma[j][i] != 0.0) {
+                support.push_back(i);
+                break;
+            }
+        }
+    }
+    return support;
+}
+
+void deltaGammaMoments(const Matrix& omega, const Array& delta, const Matrix& gamma, Real& num, Real& mu,
+                       Real& variance, Real* tau, Real* kappa, const bool gammaSupportOnly) {
+    check(omega, delta);
+    check(omega, delta, gamma);
 
     // see Carol Alexander, Market Risk, Vol IV
     // Formulas IV5.30 and IV5.31 are buggy though:
     // IV.5.30 should have ... + 3 \delta' \Omega \Gamma \Omega \delta in the numerator
     // IV.5.31 should have ... + 12 \delta \Omega (\Gamma \Omega)^2 \delta + 3\sigma^4 in the numerator
 
-    num = std::max(QuantExt::detail::absMax(delta), QuantExt::detail::absMax(gamma));
+    num = std::max(absMax(delta), absMax(gamma));
     if (close_enough(num, 0.0))
         return;
 
     Array tmpDelta = 1.0 / num * delta;
-    Matrix tmpGamma = 1.0 / num * gamma;
+    bool higherMoments = tau != nullptr && kappa != nullptr;
 
-    Real dOd = DotProduct(tmpDelta, omega * tmpDelta);
-    Matrix go = tmpGamma * omega;
-    Matrix go2 = go * go;
-    Real trGo2 = Trace(go2);
+    if (!gammaSupportOnly) {
+        Matrix tmpGamma = 1.0 / num * gamma;
 
-    mu = 0.5 * Trace(go);
-    variance = dOd + 0.5 * trGo2;
-}
+        Real dOd = DotProduct(tmpDelta, omega * tmpDelta);
+        Matrix go = tmpGamma * omega;
+        Matrix go2 = go * go;
+        Real trGo2 = Trace(go2);
 
-void moments(const Matrix& omega, const Array& delta, const Matrix& gamma, Real& num, Real& mu, Real& variance,
-             Real& tau, Real& kappa) {
-    detail::check(omega, delta, gamma);
+        mu = 0.5 * Trace(go);
+        variance = dOd + 0.5 * trGo2;
 
-    // see Carol Alexander, Market Risk, Vol IV
-    // Formulas IV5.30 and IV5.31 are buggy though:
-    // IV.5.30 should have ... + 3 \delta' \Omega \Gamma \Omega \delta in the numerator
-    // IV.5.31 should have ... + 12 \delta \Omega (\Gamma \Omega)^2 \delta + 3\sigma^4 in the numerator
+        if (higherMoments) {
+            Matrix go3 = go2 * go;
+            Matrix go4 = go2 * go2;
+            Matrix ogo = omega * go;
+            Matrix o_go2 = omega * go2;
+            Real trGo3 = Trace(go3);
+            Real trGo4 = Trace(go4);
 
-    num = std::max(QuantExt::detail::absMax(delta), QuantExt::detail::absMax(gamma));
-    if (close_enough(num, 0.0))
+            *tau = (trGo3 + 3.0 * DotProduct(tmpDelta, ogo * tmpDelta)) / std::pow(variance, 1.5);
+            *kappa = (3.0 * trGo4 + 12.0 * DotProduct(tmpDelta, o_go2 * tmpDelta)) / (variance * variance);
+        }
         return;
+    }
 
-    Array tmpDelta = 1.0 / num * delta;
-    Matrix tmpGamma = 1.0 / num * gamma;
+    /* Gamma vanishes outside the rows and columns S = gammaSupport(gamma), hence with w = \Omega \delta and the
+       restrictions G = \Gamma_{SS}, O = \Omega_{SS}, w_S we have tr((\Gamma \Omega)^k) = tr((G O)^k),
+       \delta' \Omega \Gamma \Omega \delta = w_S' G w_S and \delta' \Omega (\Gamma \Omega)^2 \delta = w_S' G O G w_S.
+       Only w requires a product with the full covariance matrix. */
+
+    Array w = omega * tmpDelta;
+    Real dOd = DotProduct(tmpDelta, w);
 
-    Real dOd = DotProduct(tmpDelta, omega * tmpDelta);
-    Matrix go = tmpGamma * omega;
+    std::vector<Size> support = gammaSupport(gamma);
+    Size m = support.size();
+
+    if (m == 0) {
+        mu = 0.0;
+        variance = dOd;
+        if (higherMoments) {
+            *tau = 0.0;
+            *kappa = 0.0;
+        }
+        return;
+    }
+
+    Matrix g(m, m), o(m, m);
+    Array wS(m);
+    for (Size a = 0; a < m; ++a) {
+        wS[a] = w[support[a]];
+        for (Size b = 0; b < m; ++b) {
+            g[a][b] = 1.0 / num * gamma[support[a]][support[b]];
+            o[a][b] = omega[support[a]][support[b]];
+        }
+    }
+
+    Matrix go = g * o;
     Matrix go2 = go * go;
     Real trGo2 = Trace(go2);
 
     mu = 0.5 * Trace(go);
     variance = dOd + 0.5 * trGo2;
 
-    Matrix go3 = go2 * go;
-    Matrix go4 = go2 * go2;
-    Matrix ogo = omega * go;
-    Matrix o_go2 = omega * go2;
-    Real trGo3 = Trace(go3);
-    Real trGo4 = Trace(go4);
-
-    tau = (trGo3 + 3.0 * DotProduct(tmpDelta, ogo * tmpDelta)) / std::pow(variance, 1.5);
-    kappa = (3.0 * trGo4 + 12.0 * DotProduct(tmpDelta, o_go2 * tmpDelta)) / (variance * variance);
+    if (higherMoments) {
+        Real trGo3 = Trace(go2 * go);
+        Real trGo4 = Trace(go2 * go2);
+        Array gw = g * wS;
+        *tau = (trGo3 + 3.0 * DotProduct(wS, gw)) / std::pow(variance, 1.5);
+        *kappa = (3.0 * trGo4 + 12.0 * DotProduct(wS, g * (o * gw))) / (variance * variance);
+    }
 }
+} // namespace detail
 
+namespace {
 std::pair<Real, Real> bracketRoot(const std::function<Real(Real)>& p, const Real h, const Real growth, const Real tol,
                                   const Size maxSteps, const Real leftBoundary, const Real rightBoundary) {
     // very simple bracketing algorithm, TODO can we do that smarter?
@@ -318,7 +363,7 @@ Real deltaGammaVarNormal(const Matrix& omega, const Array& delta, const Matrix&
     detail::check(p);
     Real s = QuantLib::InverseCumulativeNormal()(p);
     Real num = 0.0, mu = 0.0, variance = 0.0;
-    moments(sal.salvage(omega).first, delta, gamma, num, mu, variance);
+    detail::deltaGammaMoments(sal.salvage(omega).first, delta, gamma, num, mu, variance);
     if (close_enough(num, 0.0) || close_enough(variance, 0.0))
         return 0.0;
     return (std::sqrt(variance) * s + mu) * num;
@@ -330,7 +375,7 @@ Real deltaGammaVarCornishFisher(const Matrix& omega, const Array& delta, const M
     detail::check(p);
     Real s = QuantLib::InverseCumulativeNormal()(p);
     Real num = 0.0, mu = 0.0, variance = 0.0, tau = 0.0, kappa = 0.0;
-    moments(sal.salvage(omega).first, delta, gamma, num, mu, variance, tau, kappa);
+    detail::deltaGammaMoments(sal.salvage(omega).first, delta, gamma, num, mu, variance, &tau, &kappa);
     if (close_enough(num, 0.0) || close_enough(variance, 0.0))
         return 0.0;
 
@@ -33,6 +33,8 @@
 #include <ql/math/matrixutilities/pseudosqrt.hpp>
 #include <ql/math/randomnumbers/rngtraits.hpp>
 
+#include <vector>
+
 // fix for boost 1.64, see https://lists.boost.org/Archives/boost/2016/11/231756.php
 #if BOOST_VERSION >= 106400
 #include <boost/serialization/array_wrapper.hpp>
@@ -87,6 +89,18 @@ template <typename A> Real absMax(const A& a) {
     }
     return tmp;
 }
+
+/*! indices of the risk factors with a non-zero entry in the corresponding row or column of gamma, the gamma
+    contributions to the moments and to the PL only depend on these risk factors */
+std::vector<Size> gammaSupport(const Matrix& gamma);
+
+/*! moments of the delta-gamma PL, scaled by 1 / num where num is the largest absolute delta or gamma entry. If
+    gammaSupportOnly is true, the products involving gamma are computed on the submatrices spanned by gammaSupport(),
+    i.e. the cost is O(n^2 + m^3) for n risk factors of which m have non-zero gamma entries. Otherwise the dense
+    O(n^3) products are computed, this serves as a reference. The skewness tau and excess kurtosis kappa are only
+    computed if both pointers are given. */
+void deltaGammaMoments(const Matrix& omega, const Array& delta, const Matrix& gamma, Real& num, Real& mu,
+                       Real& variance, Real* tau = nullptr, Real* kappa = nullptr, const bool gammaSupportOnly = true);
 } // namespace detail
 
 // implementation
@@ -117,13 +131,24 @@ std::vector<Real> deltaGammaVarMc(const Matrix& omega, const Array& delta, const
         double, boost::accumulators::stats<boost::accumulators::tag::tail_quantile<boost::accumulators::right> > >
         acc(boost::accumulators::tag::tail<boost::accumulators::right>::cache_size = cache);
 
+    // the gamma term only depends on the risk factors with non-zero gamma entries
+    std::vector<Size> support = detail::gammaSupport(gamma);
+    Size m = support.size();
+    Matrix gammaS(m, m);
+    for (Size a = 0; a < m; ++a)
+        for (Size b = 0; b < m; ++b)
+            gammaS[a][b] = gamma[support[a]][support[b]];
+    Array uS(m);
+
     typename RNG::rsg_type rng = RNG::make_sequence_generator(delta.size(), seed);
 
     for (Size i = 0; i < paths; ++i) {
         std::vector<Real> seq = rng.nextSequence().value;
         Array z(seq.begin(), seq.end());
         Array u = L * z;
-        acc(DotProduct(u, delta) + 0.5 * DotProduct(u, gamma * u));
+        for (Size a = 0; a < m; ++a)
+            uS[a] = u[support[a]];
+        acc(DotProduct(u, delta) + (m == 0 ? 0.0 : 0.5 * DotProduct(uS, gammaS * uS)));
     }
 
     std::vector<Real> res;
@@ -18,6 +18,7 @@
 
 #include <qle/math/openclenvironment.hpp>
 #include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariablelsmbasissystem.hpp>
 #include <qle/math/randomvariable_opcodes.hpp>
 
 #include <qle/math/randomvariable_io.hpp> // just for debugging!
@@ -27,15 +28,21 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <list>
 #include <optional>
+#include <sstream>
 #include <thread>
 
 #define ORE_OPENCL_MAX_N_DEV_INFO 1024U
 #define ORE_OPENCL_MAX_N_DEV_INFO_LARGE 65536U
 #define ORE_OPENCL_MAX_BUILD_LOG 65536U
 #define ORE_OPENCL_MAX_BUILD_LOG_LOGFILE 1024U
+#define ORE_OPENCL_MAX_UNUSED_CACHED_PROGRAMS 64U
 
 namespace QuantExt {
 
@@ -170,6 +177,32 @@ void errorCallback(const char* errinfo, const void* private_info, size_t cb, voi
     printf("Callback from OpenCL context: errinfo = '%s'\n", errinfo);
 }
 
+// 64 bit FNV-1a, used to identify persisted programs, this must be stable across runs and platforms
+std::uint64_t fnv1a(const std::string& s, std::uint64_t h = 14695981039346656037ULL) {
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+constexpr char programCacheFileMagic[8] = {'O', 'R', 'E', 'O', 'C', 'L', 'B', '1'};
+
+/* exponents of the monomials in dim variables of total degree <= order, flattened to one vector with dim entries per
+   monomial, this spans the same space as the host side monomial basis system used for the conditional expectations */
+void monomialExponents(const std::size_t dim, const std::size_t order, std::vector<cl_uint>& current,
+                       std::vector<cl_uint>& result) {
+    if (current.size() == dim) {
+        result.insert(result.end(), current.begin(), current.end());
+        return;
+    }
+    for (std::size_t e = 0; e <= order; ++e) {
+        current.push_back(static_cast<cl_uint>(e));
+        monomialExponents(dim, order - e, current, result);
+        current.pop_back();
+    }
+}
+
 } // namespace
 
 class OpenClContext : public ComputeContext {
@@ -220,9 +253,36 @@ private:
     std::pair<std::vector<std::string>, std::set<std::size_t>> getArgString(const std::vector<std::size_t>& args) const;
     void startNewSsaPart();
     std::string generateSsaCode(const std::vector<SSA::ssa_entry>& ssa) const;
+    static void countFusedOperations(const std::vector<SSA::ssa_entry>& ssa, const std::set<std::size_t>& cachedIds,
+                                     const std::size_t fpSize, std::size_t& nFusedOps, std::size_t& nBytesSaved);
+
+    struct CachedProgram {
+        cl_program program;
+        std::vector<cl_kernel> kernels;
+        std::size_t useCount = 0;
+    };
+    using ProgramCache = std::map<std::string, CachedProgram>;
+
+    ProgramCache::iterator getCachedProgram(const std::string& source, const std::size_t nKernels);
+    void releaseCachedProgram(const std::size_t id);
+    std::string programCacheFileName(const std::string& source) const;
+    bool loadProgramBinary(const std::string& source, cl_program& program) const;
+    void saveProgramBinary(const std::string& source, const cl_program program) const;
 
     void updateVariatesPool();
 
+    struct RegressionProgram {
+        cl_program program;
+        cl_kernel normalEquations;
+        cl_kernel solve;
+        cl_kernel evaluate;
+    };
+
+    const RegressionProgram& getRegressionProgram();
+    void enqueueConditionalExpectation(const std::vector<std::size_t>& varIds, cl_mem valuesBuffer,
+                                       const std::map<std::size_t, std::size_t>& valuesBufferMap,
+                                       std::vector<cl_event>& runWaitEvents, std::vector<cl_mem>& mem);
+
     void runHealthChecks();
     std::string runHealthCheckProgram(const std::string& source, const std::string& kernelName);
 
@@ -251,13 +311,15 @@ private:
     std::vector<bool> disposed_;
     std::vector<bool> hasKernel_;
     std::vector<std::size_t> version_;
-    std::vector<cl_program> program_;
+    std::vector<ProgramCache::iterator> program_;
     std::vector<std::vector<cl_kernel>> kernel_;
     std::vector<std::vector<std::vector<std::vector<std::size_t>>>> conditionalExpectationVarIds_;
     std::vector<std::size_t> inputBufferSize_;
     std::vector<std::size_t> nOutputVars_;
     std::vector<std::vector<std::size_t>> nVars_;
     std::vector<std::size_t> nVariates_;
+    std::vector<std::size_t> nFusedOps_;       // per path, see DebugInfo
+    std::vector<std::size_t> nFusedBytesSaved_; // per path, see DebugInfo
 
     // 1b variates (shared pool of mersenne twister based normal variates)
 
@@ -269,6 +331,17 @@ private:
     cl_kernel variatesKernelTwist_;
     cl_kernel variatesKernelGenerate_;
 
+    /* 1c compiled programs keyed on their source, which determines the op sequence and the input / variates layout,
+          so that structurally identical calculations share one program. Programs not used by any calculation are kept
+          up to a limit, the oldest are released first. */
+
+    ProgramCache programCache_;
+    std::list<ProgramCache::iterator> unusedCachedPrograms_;
+
+    // 1d programs to calculate conditional expectations on the device, keyed on the double precision flag
+
+    std::map<bool, RegressionProgram> regressionPrograms_;
+
     // 2 curent calc
 
     std::size_t currentId_ = 0;
@@ -402,16 +475,16 @@ OpenClContext::~OpenClContext() {
             releaseProgram(variatesProgram_, "variates");
         }
 
-        for (Size i = 0; i < kernel_.size(); ++i) {
-            if (disposed_[i] || !hasKernel_[i])
-                continue;
-            releaseKernel(kernel_[i], "ore kernel");
+        for (auto& [_, p] : programCache_) {
+            releaseKernel(p.kernels, "ore kernel");
+            releaseProgram(p.program, "ore program");
         }
 
-        for (Size i = 0; i < program_.size(); ++i) {
-            if (disposed_[i] || !hasKernel_[i])
-                continue;
-            releaseProgram(program_[i], "ore program");
+        for (auto& [_, p] : regressionPrograms_) {
+            releaseKernel(p.normalEquations, "ce normal equations");
+            releaseKernel(p.solve, "ce solve");
+            releaseKernel(p.evaluate, "ce evaluate");
+            releaseProgram(p.program, "ce");
         }
 
         cl_int err;
@@ -546,6 +619,8 @@ void OpenClContext::init() {
     debugInfo_.nanoSecondsDataCopy = 0;
     debugInfo_.nanoSecondsProgramBuild = 0;
     debugInfo_.nanoSecondsCalculation = 0;
+    debugInfo_.numberOfFusedOperations = 0;
+    debugInfo_.bytesMemoryTrafficSaved = 0;
 
     cl_int err;
 #if CL_VERSION_2_0
@@ -566,9 +641,161 @@ void OpenClContext::disposeCalculation(const std::size_t id) {
     QL_REQUIRE(!disposed_[id - 1], "OpenClContext::disposeCalculation(): id " << id << " was already disposed.");
     disposed_[id - 1] = true;
     if (hasKernel_[id - 1]) {
-        releaseKernel(kernel_[id - 1], "kernel id " + std::to_string(id) + " (during dispose())");
-        releaseProgram(program_[id - 1], "program id " + std::to_string(id) + " (during dispose())");
+        releaseCachedProgram(id);
+    }
+}
+
+OpenClContext::ProgramCache::iterator OpenClContext::getCachedProgram(const std::string& source,
+                                                                      const std::size_t nKernels) {
+    if (auto p = programCache_.find(source); p != programCache_.end()) {
+        if (p->second.useCount++ == 0)
+            unusedCachedPrograms_.remove(p);
+        return p;
+    }
+
+    // build the program from a persisted binary if available and from source otherwise
+
+    cl_int err;
+    cl_program program;
+    bool fromBinary = loadProgramBinary(source, program);
+    if (!fromBinary) {
+        const char* sourcePtr = source.c_str();
+        program = clCreateProgramWithSource(*context_, 1, &sourcePtr, NULL, &err);
+        QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::getCachedProgram(): error during clCreateProgramWithSource(): "
+                                          << errorText(err));
+        err = clBuildProgram(program, 1, device_, NULL, NULL, NULL);
+        if (err != CL_SUCCESS) {
+            char buffer[ORE_OPENCL_MAX_BUILD_LOG];
+            clGetProgramBuildInfo(program, *device_, CL_PROGRAM_BUILD_LOG, ORE_OPENCL_MAX_BUILD_LOG * sizeof(char),
+                                  buffer, NULL);
+            releaseProgram(program, "failed build");
+            QL_FAIL("OpenClContext::getCachedProgram(): error during program build for kernel 'ore_kernel_*': "
+                    << errorText(err) << ": " << std::string(buffer).substr(0, ORE_OPENCL_MAX_BUILD_LOG_LOGFILE));
+        }
     }
+
+    std::vector<cl_kernel> kernels;
+    for (std::size_t part = 0; part < nKernels; ++part) {
+        std::string kernelName = "ore_kernel_" + std::to_string(part);
+        kernels.push_back(clCreateKernel(program, kernelName.c_str(), &err));
+        if (err != CL_SUCCESS) {
+            kernels.pop_back();
+            releaseKernel(kernels, "failed build");
+            releaseProgram(program, "failed build");
+            QL_FAIL("OpenClContext::getCachedProgram(): error during clCreateKernel(), part #" << part << ": "
+                                                                                             << errorText(err));
+        }
+    }
+
+    if (!fromBinary)
+        saveProgramBinary(source, program);
+
+    return programCache_.insert(std::make_pair(source, CachedProgram{program, kernels, 1})).first;
+}
+
+void OpenClContext::releaseCachedProgram(const std::size_t id) {
+    auto p = program_[id - 1];
+    if (--p->second.useCount > 0)
+        return;
+    unusedCachedPrograms_.push_back(p);
+    while (unusedCachedPrograms_.size() > ORE_OPENCL_MAX_UNUSED_CACHED_PROGRAMS) {
+        auto& oldest = unusedCachedPrograms_.front()->second;
+        releaseKernel(oldest.kernels, "ore kernel (expired from program cache)");
+        releaseProgram(oldest.program, "ore program (expired from program cache)");
+        programCache_.erase(unusedCachedPrograms_.front());
+        unusedCachedPrograms_.pop_front();
+    }
+}
+
+std::string OpenClContext::programCacheFileName(const std::string& source) const {
+    std::string directory = OpenClFramework::programCacheDirectory();
+    if (directory.empty())
+        return std::string();
+    // the binary is specific to the device and driver
+    std::string key;
+    for (auto const& [k, v] : deviceInfo_) {
+        if (k == "device_name" || k == "driver_version" || k == "device_version")
+            key += v + "\n";
+    }
+    std::ostringstream fileName;
+    fileName << directory << "/ore_opencl_" << std::hex << fnv1a(key + source) << ".bin";
+    return fileName.str();
+}
+
+bool OpenClContext::loadProgramBinary(const std::string& source, cl_program& program) const {
+    std::string fileName = programCacheFileName(source);
+    if (fileName.empty())
+        return false;
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file)
+        return false;
+
+    // check that the file was written for the same source, the file name only identifies it up to hash collisions
+
+    char magic[sizeof(programCacheFileMagic)];
+    std::uint64_t sourceSize, sourceHash, binarySize;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&sourceSize), sizeof(sourceSize));
+    file.read(reinterpret_cast<char*>(&sourceHash), sizeof(sourceHash));
+    file.read(reinterpret_cast<char*>(&binarySize), sizeof(binarySize));
+    if (!file || !std::equal(magic, magic + sizeof(magic), programCacheFileMagic) || sourceSize != source.size() ||
+        sourceHash != fnv1a(source, sourceSize))
+        return false;
+    std::vector<unsigned char> binary(binarySize);
+    file.read(reinterpret_cast<char*>(binary.data()), binarySize);
+    if (!file)
+        return false;
+
+    // a binary that the driver does not accept is ignored, the program is then built from source
+
+    cl_int err, binaryStatus;
+    std::size_t size = binary.size();
+    const unsigned char* binaryPtr = binary.data();
+    program = clCreateProgramWithBinary(*context_, 1, device_, &size, &binaryPtr, &binaryStatus, &err);
+    if (err != CL_SUCCESS)
+        return false;
+    if (binaryStatus != CL_SUCCESS || clBuildProgram(program, 1, device_, NULL, NULL, NULL) != CL_SUCCESS) {
+        releaseProgram(program, "persisted program");
+        return false;
+    }
+    return true;
+}
+
+void OpenClContext::saveProgramBinary(const std::string& source, const cl_program program) const {
+    std::string fileName = programCacheFileName(source);
+    if (fileName.empty())
+        return;
+    std::size_t size;
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(std::size_t), &size, NULL) != CL_SUCCESS ||
+        size == 0)
+        return;
+    std::vector<unsigned char> binary(size);
+    unsigned char* binaryPtr = binary.data();
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char*), &binaryPtr, NULL) != CL_SUCCESS)
+        return;
+
+    // write to a temporary file first, so that concurrent runs never see a partially written file
+
+    std::ostringstream tmpFileName;
+    tmpFileName << fileName << "." << std::this_thread::get_id() << "." << this << ".tmp";
+    {
+        std::ofstream file(tmpFileName.str(), std::ios::binary | std::ios::trunc);
+        if (!file)
+            return;
+        std::uint64_t sourceSize = source.size(), sourceHash = fnv1a(source, sourceSize), binarySize = size;
+        file.write(programCacheFileMagic, sizeof(programCacheFileMagic));
+        file.write(reinterpret_cast<const char*>(&sourceSize), sizeof(sourceSize));
+        file.write(reinterpret_cast<const char*>(&sourceHash), sizeof(sourceHash));
+        file.write(reinterpret_cast<const char*>(&binarySize), sizeof(binarySize));
+        file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+        if (!file) {
+            file.close();
+            std::remove(tmpFileName.str().c_str());
+            return;
+        }
+    }
+    if (std::rename(tmpFileName.str().c_str(), fileName.c_str()) != 0)
+        std::remove(tmpFileName.str().c_str());
 }
 
 std::pair<std::size_t, bool> OpenClContext::initiateCalculation(const std::size_t n, const std::size_t id,
@@ -586,13 +813,15 @@ std::pair<std::size_t, bool> OpenClContext::initiateCalculation(const std::size_
         disposed_.push_back(false);
         hasKernel_.push_back(false);
         version_.push_back(version);
-        program_.push_back(cl_program());
+        program_.push_back(ProgramCache::iterator());
         kernel_.push_back(std::vector<cl_kernel>());
         conditionalExpectationVarIds_.push_back(std::vector<std::vector<std::vector<std::size_t>>>(1));
         inputBufferSize_.push_back(0);
         nOutputVars_.push_back(0);
         nVars_.push_back(std::vector<std::size_t>());
         nVariates_.push_back(0);
+        nFusedOps_.push_back(0);
+        nFusedBytesSaved_.push_back(0);
 
         currentId_ = hasKernel_.size();
         newCalc = true;
@@ -610,17 +839,16 @@ std::pair<std::size_t, bool> OpenClContext::initiateCalculation(const std::size_
                                            << id << ") was already disposed, it can not be used any more.");
 
         if (version != version_[id - 1]) {
+            if (hasKernel_[id - 1])
+                releaseCachedProgram(id);
             hasKernel_[id - 1] = false;
             version_[id - 1] = version;
             nVars_[id - 1].clear();
             nVariates_[id - 1] = 0;
-            releaseKernel(kernel_[id - 1],
-                          "kernel id " + std::to_string(id) + " (during initiateCalculation, old version: " +
-                              std::to_string(version_[id - 1]) + ", new version:" + std::to_string(version) + ")");
+            nFusedOps_[id - 1] = 0;
+            nFusedBytesSaved_[id - 1] = 0;
+            kernel_[id - 1].clear();
             conditionalExpectationVarIds_[id - 1] = std::vector<std::vector<std::vector<std::size_t>>>(1);
-            releaseProgram(program_[id - 1],
-                           "program id " + std::to_string(id) + " (during initiateCalculation, old version: " +
-                               std::to_string(version_[id - 1]) + ", new version:" + std::to_string(version) + ")");
             newCalc = true;
         }
 
@@ -966,6 +1194,282 @@ void OpenClContext::updateVariatesPool() {
     variatesPoolSize_ = currentPoolSize;
 }
 
+const OpenClContext::RegressionProgram& OpenClContext::getRegressionProgram() {
+
+    if (auto p = regressionPrograms_.find(settings_.useDoublePrecision); p != regressionPrograms_.end())
+        return p->second;
+
+    std::string fpTypeStr = settings_.useDoublePrecision ? "double" : "float";
+    std::string fpEpsStr = settings_.useDoublePrecision ? "0x1.0p-52" : "0x1.0p-23f";
+    std::string fpSuffix = settings_.useDoublePrecision ? std::string() : "f";
+
+    /* The regression is done via the normal equations: ore_ce_normal_equations computes partial sums of the entries
+       of the lower triangle of A^T A and of A^T b (packed, followed by the rhs) over chunks of paths, one work item per
+       entry and chunk. ore_ce_solve adds up these partial sums and solves the system by a Cholesky decomposition,
+       basis functions with a pivot below a relative threshold are dropped (i.e. get a zero coefficient). Finally
+       ore_ce_evaluate writes the conditional expectation to the values buffer, one work item per path. */
+
+    // clang-format off
+    std::string programSource =
+        "bool ore_ce_closeToOne(const " + fpTypeStr + " x);\n"
+        "bool ore_ce_closeToOne(const " + fpTypeStr + " x) {\n"
+        "    const " + fpTypeStr + " tol = 42.0" + fpSuffix + " * " + fpEpsStr + ";\n"
+        "    " + fpTypeStr + " diff = fabs(x - 1.0" + fpSuffix + ");\n"
+        "    return diff <= tol * fabs(x) || diff <= tol;\n"
+        "}\n\n" +
+        fpTypeStr + " ore_ce_basis(const uint j, const ulong i, const uint dim,\n"
+        "                     __global const ulong* regressorOffsets, __global const uint* exponents,\n"
+        "                     __global const " + fpTypeStr + "* values);\n" +
+        fpTypeStr + " ore_ce_basis(const uint j, const ulong i, const uint dim,\n"
+        "                     __global const ulong* regressorOffsets, __global const uint* exponents,\n"
+        "                     __global const " + fpTypeStr + "* values) {\n"
+        "    " + fpTypeStr + " r = 1.0" + fpSuffix + ";\n"
+        "    for (uint d = 0; d < dim; ++d) {\n"
+        "        const uint e = exponents[j * dim + d];\n"
+        "        if (e > 0)\n"
+        "            r *= pown(values[regressorOffsets[d] + i], (int)e);\n"
+        "    }\n"
+        "    return r;\n"
+        "}\n\n"
+        "__kernel void ore_ce_normal_equations(const ulong n, const ulong chunk, const uint m, const uint dim,\n"
+        "                                      const uint useFilter, const ulong regressandOffset,\n"
+        "                                      const ulong filterOffset, __global const ulong* regressorOffsets,\n"
+        "                                      __global const uint* exponents,\n"
+        "                                      __global const " + fpTypeStr + "* values,\n"
+        "                                      __global " + fpTypeStr + "* partials) {\n"
+        "    const ulong g = get_global_id(0);\n"
+        "    const ulong nSym = (ulong)m * (m + 1) / 2;\n"
+        "    const ulong k = g % (nSym + m);\n"
+        "    const ulong start = (g / (nSym + m)) * chunk;\n"
+        "    const ulong end = min(start + chunk, n);\n"
+        "    uint j = 0, l = m;\n"
+        "    if (k < nSym) {\n"
+        "        while ((ulong)(j + 1) * (j + 2) / 2 <= k)\n"
+        "            ++j;\n"
+        "        l = (uint)(k - (ulong)j * (j + 1) / 2);\n"
+        "    } else {\n"
+        "        j = (uint)(k - nSym);\n"
+        "    }\n"
+        "    " + fpTypeStr + " sum = 0.0" + fpSuffix + ";\n"
+        "    for (ulong i = start; i < end; ++i) {\n"
+        "        if (useFilter && !ore_ce_closeToOne(values[filterOffset + i]))\n"
+        "            continue;\n"
+        "        " + fpTypeStr + " b = l == m ? values[regressandOffset + i]\n"
+        "                         : ore_ce_basis(l, i, dim, regressorOffsets, exponents, values);\n"
+        "        sum += ore_ce_basis(j, i, dim, regressorOffsets, exponents, values) * b;\n"
+        "    }\n"
+        "    partials[g] = sum;\n"
+        "}\n\n"
+        "__kernel void ore_ce_solve(const uint m, const uint nGroups, __global const " + fpTypeStr + "* partials,\n"
+        "                           __global " + fpTypeStr + "* a, __global " + fpTypeStr + "* coefficients) {\n"
+        "    const ulong nSym = (ulong)m * (m + 1) / 2;\n"
+        "    for (ulong k = 0; k < nSym + m; ++k) {\n"
+        "        " + fpTypeStr + " sum = 0.0" + fpSuffix + ";\n"
+        "        for (uint g = 0; g < nGroups; ++g)\n"
+        "            sum += partials[g * (nSym + m) + k];\n"
+        "        a[k] = sum;\n"
+        "    }\n"
+        "    " + fpTypeStr + " maxDiag = 0.0" + fpSuffix + ";\n"
+        "    for (uint j = 0; j < m; ++j)\n"
+        "        maxDiag = fmax(maxDiag, a[(ulong)j * (j + 1) / 2 + j]);\n"
+        "    const " + fpTypeStr + " tol = (" + fpTypeStr + ")m * " + fpEpsStr + " * maxDiag;\n"
+        "    for (uint j = 0; j < m; ++j) {\n"
+        "        const ulong rj = (ulong)j * (j + 1) / 2;\n"
+        "        " + fpTypeStr + " d = a[rj + j];\n"
+        "        for (uint k = 0; k < j; ++k)\n"
+        "            d -= a[rj + k] * a[rj + k];\n"
+        "        if (d <= tol) {\n"
+        "            for (uint i = j; i < m; ++i)\n"
+        "                a[(ulong)i * (i + 1) / 2 + j] = 0.0" + fpSuffix + ";\n"
+        "            continue;\n"
+        "        }\n"
+        "        a[rj + j] = sqrt(d);\n"
+        "        for (uint i = j + 1; i < m; ++i) {\n"
+        "            const ulong ri = (ulong)i * (i + 1) / 2;\n"
+        "            " + fpTypeStr + " s = a[ri + j];\n"
+        "            for (uint k = 0; k < j; ++k)\n"
+        "                s -= a[ri + k] * a[rj + k];\n"
+        "            a[ri + j] = s / a[rj + j];\n"
+        "        }\n"
+        "    }\n"
+        "    for (uint j = 0; j < m; ++j) {\n"
+        "        const ulong rj = (ulong)j * (j + 1) / 2;\n"
+        "        " + fpTypeStr + " s = a[nSym + j];\n"
+        "        for (uint k = 0; k < j; ++k)\n"
+        "            s -= a[rj + k] * a[nSym + k];\n"
+        "        a[nSym + j] = a[rj + j] > 0.0" + fpSuffix + " ? s / a[rj + j] : 0.0" + fpSuffix + ";\n"
+        "    }\n"
+        "    for (uint jj = m; jj > 0; --jj) {\n"
+        "        const uint j = jj - 1;\n"
+        "        const ulong rj = (ulong)j * (j + 1) / 2;\n"
+        "        " + fpTypeStr + " s = a[nSym + j];\n"
+        "        for (uint i = j + 1; i < m; ++i)\n"
+        "            s -= a[(ulong)i * (i + 1) / 2 + j] * coefficients[i];\n"
+        "        coefficients[j] = a[rj + j] > 0.0" + fpSuffix + " ? s / a[rj + j] : 0.0" + fpSuffix + ";\n"
+        "    }\n"
+        "}\n\n"
+        "__kernel void ore_ce_evaluate(const ulong n, const uint m, const uint dim, const ulong resultOffset,\n"
+        "                              __global const ulong* regressorOffsets, __global const uint* exponents,\n"
+        "                              __global const " + fpTypeStr + "* coefficients,\n"
+        "                              __global " + fpTypeStr + "* values) {\n"
+        "    const ulong i = get_global_id(0);\n"
+        "    if (i < n) {\n"
+        "        " + fpTypeStr + " r = 0.0" + fpSuffix + ";\n"
+        "        for (uint j = 0; j < m; ++j)\n"
+        "            r += coefficients[j] * ore_ce_basis(j, i, dim, regressorOffsets, exponents, values);\n"
+        "        values[resultOffset + i] = r;\n"
+        "    }\n"
+        "}\n";
+    // clang-format on
+
+    RegressionProgram p;
+    const char* programSourcePtr = programSource.c_str();
+    cl_int err;
+    p.program = clCreateProgramWithSource(*context_, 1, &programSourcePtr, NULL, &err);
+    QL_REQUIRE(err == CL_SUCCESS,
+               "OpenClContext::getRegressionProgram(): error creating program: " << errorText(err));
+    err = clBuildProgram(p.program, 1, device_, NULL, NULL, NULL);
+    if (err != CL_SUCCESS) {
+        char buffer[ORE_OPENCL_MAX_BUILD_LOG];
+        clGetProgramBuildInfo(p.program, *device_, CL_PROGRAM_BUILD_LOG, ORE_OPENCL_MAX_BUILD_LOG * sizeof(char),
+                              buffer, NULL);
+        releaseProgram(p.program, "failed build");
+        QL_FAIL("OpenClContext::getRegressionProgram(): error during program build: "
+                << errorText(err) << ": " << std::string(buffer).substr(ORE_OPENCL_MAX_BUILD_LOG_LOGFILE));
+    }
+
+    p.normalEquations = clCreateKernel(p.program, "ore_ce_normal_equations", &err);
+    QL_REQUIRE(err == CL_SUCCESS,
+               "OpenClContext::getRegressionProgram(): error creating kernel normal equations: " << errorText(err));
+
+    p.solve = clCreateKernel(p.program, "ore_ce_solve", &err);
+    QL_REQUIRE(err == CL_SUCCESS,
+               "OpenClContext::getRegressionProgram(): error creating kernel solve: " << errorText(err));
+
+    p.evaluate = clCreateKernel(p.program, "ore_ce_evaluate", &err);
+    QL_REQUIRE(err == CL_SUCCESS,
+               "OpenClContext::getRegressionProgram(): error creating kernel evaluate: " << errorText(err));
+
+    return regressionPrograms_[settings_.useDoublePrecision] = p;
+}
+
+void OpenClContext::enqueueConditionalExpectation(const std::vector<std::size_t>& v, cl_mem valuesBuffer,
+                                                  const std::map<std::size_t, std::size_t>& valuesBufferMap,
+                                                  std::vector<cl_event>& runWaitEvents, std::vector<cl_mem>& mem) {
+
+    // v = (result, regressand, filter, regressor1, regressor2, ...)
+
+    QL_REQUIRE(v.size() >= 3, "OpenClContext::enqueueConditionalExpectation(): expected at least 3 varIds (2 args and "
+                              "1 result) for conditional expectation, got "
+                                  << v.size());
+
+    const RegressionProgram& program = getRegressionProgram();
+
+    const std::size_t n = size_[currentId_ - 1];
+    const std::size_t fpSize = settings_.useDoublePrecision ? sizeof(double) : sizeof(float);
+
+    // no regressor given -> take plain expectation, i.e. regress on the constant basis function and ignore the filter
+
+    const std::size_t dim = v.size() < 4 ? 0 : v.size() - 3;
+
+    // same order reduction as in multiPathBasisSystem() on the host
+
+    std::size_t order = settings_.regressionOrder;
+    while (RandomVariableLsmBasisSystem::size(dim, order) > static_cast<double>(n) && order > 1)
+        --order;
+
+    std::vector<cl_uint> exponents, tmp;
+    monomialExponents(dim, order, tmp, exponents);
+    const cl_uint m = dim == 0 ? 1 : static_cast<cl_uint>(exponents.size() / dim);
+    const std::size_t nEntries = m * (m + 1) / 2 + m;
+
+    std::vector<cl_ulong> regressorOffsets;
+    for (std::size_t d = 0; d < dim; ++d)
+        regressorOffsets.push_back(valuesBufferMap.at(v[3 + d]) * n);
+
+    // we can not create empty buffers, so we use dummy entries if there are no regressors
+
+    if (dim == 0) {
+        exponents.push_back(0);
+        regressorOffsets.push_back(0);
+    }
+
+    // each work item of the normal equations kernel sums over a chunk of paths
+
+    const cl_uint nGroups = static_cast<cl_uint>(std::min<std::size_t>(256, std::max<std::size_t>(1, n / 1024)));
+    const cl_ulong chunk = (n + nGroups - 1) / nGroups;
+
+    auto createBuffer = [this, &mem](const std::size_t bytes, const cl_mem_flags flags, void* hostPtr,
+                                     const std::string& description) {
+        cl_int err;
+        cl_mem buffer = clCreateBuffer(*context_, flags, bytes, hostPtr, &err);
+        QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::enqueueConditionalExpectation(): creating "
+                                          << description << " buffer fails: " << errorText(err));
+        mem.push_back(buffer);
+        return buffer;
+    };
+
+    cl_mem regressorOffsetsBuffer =
+        createBuffer(sizeof(cl_ulong) * regressorOffsets.size(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                     &regressorOffsets[0], "regressor offsets");
+    cl_mem exponentsBuffer = createBuffer(sizeof(cl_uint) * exponents.size(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                                          &exponents[0], "exponents");
+    cl_mem partialsBuffer = createBuffer(fpSize * nEntries * nGroups, CL_MEM_READ_WRITE, NULL, "partials");
+    cl_mem workspaceBuffer = createBuffer(fpSize * nEntries, CL_MEM_READ_WRITE, NULL, "workspace");
+    cl_mem coefficientsBuffer = createBuffer(fpSize * m, CL_MEM_READ_WRITE, NULL, "coefficients");
+
+    cl_ulong nArg = n;
+    cl_uint dimArg = static_cast<cl_uint>(dim);
+    cl_uint useFilter = dim > 0 ? 1 : 0;
+    cl_ulong regressandOffset = valuesBufferMap.at(v[1]) * n;
+    cl_ulong filterOffset = valuesBufferMap.at(v[2]) * n;
+    cl_ulong resultOffset = valuesBufferMap.at(v[0]) * n;
+
+    cl_int err = 0;
+    err |= clSetKernelArg(program.normalEquations, 0, sizeof(cl_ulong), &nArg);
+    err |= clSetKernelArg(program.normalEquations, 1, sizeof(cl_ulong), &chunk);
+    err |= clSetKernelArg(program.normalEquations, 2, sizeof(cl_uint), &m);
+    err |= clSetKernelArg(program.normalEquations, 3, sizeof(cl_uint), &dimArg);
+    err |= clSetKernelArg(program.normalEquations, 4, sizeof(cl_uint), &useFilter);
+    err |= clSetKernelArg(program.normalEquations, 5, sizeof(cl_ulong), &regressandOffset);
+    err |= clSetKernelArg(program.normalEquations, 6, sizeof(cl_ulong), &filterOffset);
+    err |= clSetKernelArg(program.normalEquations, 7, sizeof(cl_mem), &regressorOffsetsBuffer);
+    err |= clSetKernelArg(program.normalEquations, 8, sizeof(cl_mem), &exponentsBuffer);
+    err |= clSetKernelArg(program.normalEquations, 9, sizeof(cl_mem), &valuesBuffer);
+    err |= clSetKernelArg(program.normalEquations, 10, sizeof(cl_mem), &partialsBuffer);
+
+    err |= clSetKernelArg(program.solve, 0, sizeof(cl_uint), &m);
+    err |= clSetKernelArg(program.solve, 1, sizeof(cl_uint), &nGroups);
+    err |= clSetKernelArg(program.solve, 2, sizeof(cl_mem), &partialsBuffer);
+    err |= clSetKernelArg(program.solve, 3, sizeof(cl_mem), &workspaceBuffer);
+    err |= clSetKernelArg(program.solve, 4, sizeof(cl_mem), &coefficientsBuffer);
+
+    err |= clSetKernelArg(program.evaluate, 0, sizeof(cl_ulong), &nArg);
+    err |= clSetKernelArg(program.evaluate, 1, sizeof(cl_uint), &m);
+    err |= clSetKernelArg(program.evaluate, 2, sizeof(cl_uint), &dimArg);
+    err |= clSetKernelArg(program.evaluate, 3, sizeof(cl_ulong), &resultOffset);
+    err |= clSetKernelArg(program.evaluate, 4, sizeof(cl_mem), &regressorOffsetsBuffer);
+    err |= clSetKernelArg(program.evaluate, 5, sizeof(cl_mem), &exponentsBuffer);
+    err |= clSetKernelArg(program.evaluate, 6, sizeof(cl_mem), &coefficientsBuffer);
+    err |= clSetKernelArg(program.evaluate, 7, sizeof(cl_mem), &valuesBuffer);
+
+    QL_REQUIRE(err == CL_SUCCESS,
+               "OpenClContext::enqueueConditionalExpectation(): set kernel args fails: " << errorText(err));
+
+    // run the three kernels, each one waiting for its predecessors
+
+    const std::size_t sizeNormalEquations = nEntries * nGroups, sizeSolve = 1;
+    for (auto const& [kernel, globalSize] : std::vector<std::pair<cl_kernel, const std::size_t*>>{
+             {program.normalEquations, &sizeNormalEquations}, {program.solve, &sizeSolve}, {program.evaluate, &n}}) {
+        cl_event runEvent;
+        err = clEnqueueNDRangeKernel(queue_, kernel, 1, NULL, globalSize, NULL, runWaitEvents.size(),
+                                     runWaitEvents.empty() ? NULL : &runWaitEvents[0], &runEvent);
+        QL_REQUIRE(err == CL_SUCCESS,
+                   "OpenClContext::enqueueConditionalExpectation(): enqueue kernel fails: " << errorText(err));
+        runWaitEvents.push_back(runEvent);
+    }
+}
+
 std::vector<std::vector<std::size_t>> OpenClContext::createInputVariates(const std::size_t dim,
                                                                          const std::size_t steps) {
     QL_REQUIRE(currentState_ == ComputeState::createInput || currentState_ == ComputeState::createVariates,
@@ -1249,6 +1753,33 @@ std::string OpenClContext::generateSsaCode(const std::vector<SSA::ssa_entry>& ss
     return result;
 }
 
+/* The pathwise ops of one ssa part are evaluated in one kernel, their results are kept in registers unless they are
+   cached to the values buffer for a later part. A result kept in a register saves the write to global memory and
+   one read per use, which an evaluation op by op would require. If a local id is reused, only its last definition
+   in the part is cached. Dead results are not emitted by generateSsaCode() and not counted. */
+void OpenClContext::countFusedOperations(const std::vector<SSA::ssa_entry>& ssa, const std::set<std::size_t>& cachedIds,
+                                         const std::size_t fpSize, std::size_t& nFusedOps, std::size_t& nBytesSaved) {
+    std::vector<std::size_t> uses(ssa.size(), 0);
+    std::map<std::size_t, std::size_t> currentDefinition;
+    for (std::size_t k = 0; k < ssa.size(); ++k) {
+        for (auto const id : ssa[k].rhs_local_id) {
+            if (auto d = currentDefinition.find(id); d != currentDefinition.end())
+                ++uses[d->second];
+        }
+        if (ssa[k].lhs_local_id && ssa[k].cond_exp_local_id.empty())
+            currentDefinition[*ssa[k].lhs_local_id] = k;
+    }
+    for (std::size_t k = 0; k < ssa.size(); ++k) {
+        if (!ssa[k].lhs_local_id || !ssa[k].cond_exp_local_id.empty() || uses[k] == 0)
+            continue;
+        if (cachedIds.find(*ssa[k].lhs_local_id) != cachedIds.end() &&
+            currentDefinition.at(*ssa[k].lhs_local_id) == k)
+            continue;
+        ++nFusedOps;
+        nBytesSaved += fpSize * (1 + uses[k]);
+    }
+}
+
 void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
     struct exitGuard {
         exitGuard() {}
@@ -1406,8 +1937,9 @@ void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
 
         // clang-format on
 
-        std::string kernelNameStem =
-            "ore_kernel_" + std::to_string(currentId_) + "_" + std::to_string(version_[currentId_ - 1]) + "_";
+        // the kernel names do not depend on the calculation id, so that the source can serve as the cache key
+
+        std::string kernelNameStem = "ore_kernel_";
 
         for (std::size_t part = 0; part < currentSsa_.ssa.size(); ++part) {
 
@@ -1447,11 +1979,11 @@ void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
 
             ssa.insert(ssa.end(), currentSsa_.ssa[part].begin(), currentSsa_.ssa[part].end());
 
+            std::set<std::size_t> tmp2;
             if (cacheToValues) {
                 std::set<std::size_t> tmp;
                 for (std::size_t p = part + 1; p < currentSsa_.ssa.size(); ++p)
                     tmp.insert(currentSsa_.rhs_local_id[p].begin(), currentSsa_.rhs_local_id[p].end());
-                std::set<std::size_t> tmp2;
                 std::set_intersection(tmp.begin(), tmp.end(), currentSsa_.lhs_local_id[part].begin(),
                                       currentSsa_.lhs_local_id[part].end(), std::inserter(tmp2, tmp2.end()));
                 tmp2.insert(currentSsa_.cond_exp_local_id[part].begin(), currentSsa_.cond_exp_local_id[part].end());
@@ -1467,6 +1999,9 @@ void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
             kernelSource += generateSsaCode(ssa);
             kernelSource += "}}\n";
 
+            countFusedOperations(currentSsa_.ssa[part], tmp2, fpSize, nFusedOps_[currentId_ - 1],
+                                 nFusedBytesSaved_[currentId_ - 1]);
+
         } // for part
 
         // std::cerr << "generated kernel is " << kernelSource.size() / 1024.0 / 1024.0 << " MB" << std::endl;
@@ -1476,27 +2011,8 @@ void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
             timerBase = timer.elapsed().wall;
         }
 
-        cl_int err;
-        const char* kernelSourcePtr = kernelSource.c_str();
-        program_[currentId_ - 1] = clCreateProgramWithSource(*context_, 1, &kernelSourcePtr, NULL, &err);
-        QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): error during clCreateProgramWithSource(): "
-                                          << errorText(err));
-        err = clBuildProgram(program_[currentId_ - 1], 1, device_, NULL, NULL, NULL);
-        if (err != CL_SUCCESS) {
-            char buffer[ORE_OPENCL_MAX_BUILD_LOG];
-            clGetProgramBuildInfo(program_[currentId_ - 1], *device_, CL_PROGRAM_BUILD_LOG,
-                                  ORE_OPENCL_MAX_BUILD_LOG * sizeof(char), buffer, NULL);
-            QL_FAIL("OpenClContext::finalizeCalculation(): error during program build for kernel '"
-                    << kernelNameStem << "*': " << errorText(err) << ": "
-                    << std::string(buffer).substr(ORE_OPENCL_MAX_BUILD_LOG_LOGFILE));
-        }
-
-        for (std::size_t part = 0; part < currentSsa_.ssa.size(); ++part) {
-            std::string kernelName = kernelNameStem + std::to_string(part);
-            kernel_[currentId_ - 1].push_back(clCreateKernel(program_[currentId_ - 1], kernelName.c_str(), &err));
-            QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): error during clCreateKernel(), part #"
-                                              << part << ": " << errorText(err));
-        }
+        program_[currentId_ - 1] = getCachedProgram(kernelSource, currentSsa_.ssa.size());
+        kernel_[currentId_ - 1] = program_[currentId_ - 1]->second.kernels;
 
         hasKernel_[currentId_ - 1] = true;
         inputBufferSize_[currentId_ - 1] = inputBufferSize;
@@ -1511,6 +2027,11 @@ void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
                        << inputBufferSize_[currentId_ - 1] << ")");
     }
 
+    if (settings_.debug) {
+        debugInfo_.numberOfFusedOperations += nFusedOps_[currentId_ - 1] * size_[currentId_ - 1];
+        debugInfo_.bytesMemoryTrafficSaved += nFusedBytesSaved_[currentId_ - 1] * size_[currentId_ - 1];
+    }
+
     // write input data to input buffer (asynchronously)
 
     if (settings_.debug) {
@@ -1537,7 +2058,8 @@ void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
     if (inputBufferSize > 0)
         runWaitEvents.push_back(inputBufferEvent);
 
-    std::vector<double> values(valuesBufferMap.size() * size_[currentId_ - 1]);
+    // host copy of the values buffer, only needed if the conditional expectations are calculated on the host
+    std::vector<double> values(settings_.regressionOnDevice ? 0 : valuesBufferMap.size() * size_[currentId_ - 1]);
     std::vector<float> valuesFloat;
     if (!settings_.useDoublePrecision) {
         valuesFloat.resize(values.size());
@@ -1580,9 +2102,15 @@ void OpenClContext::finalizeCalculation(std::vector<double*>& output) {
         QL_REQUIRE(err == CL_SUCCESS, "OpenClContext::finalizeCalculation(): enqueue kernel fails: " << errorText(err));
         runWaitEvents.push_back(runEvent);
 
-        // calculate conditional expectations, this is the variant where we do this on the host
+        // calculate conditional expectations, either on the device or on the host
+
+        if (kernel_[currentId_ - 1].size() > 1 && part < kernel_[currentId_ - 1].size() - 1 &&
+            settings_.regressionOnDevice) {
 
-        if (kernel_[currentId_ - 1].size() > 1 && part < kernel_[currentId_ - 1].size() - 1) {
+            for (auto const& v : conditionalExpectationVarIds_[currentId_ - 1][part])
+                enqueueConditionalExpectation(v, valuesBuffer, valuesBufferMap, runWaitEvents, guard.mem);
+
+        } else if (kernel_[currentId_ - 1].size() > 1 && part < kernel_[currentId_ - 1].size() - 1) {
 
             // copy values from device to host
 
@@ -1718,6 +2246,19 @@ OpenClFramework::OpenClFramework() {}
 OpenClFramework::~OpenClFramework() {}
 #endif
 
+boost::shared_mutex OpenClFramework::programCacheDirectoryMutex_;
+std::string OpenClFramework::programCacheDirectory_;
+
+void OpenClFramework::setProgramCacheDirectory(const std::string& directory) {
+    boost::unique_lock<boost::shared_mutex> lock(programCacheDirectoryMutex_);
+    programCacheDirectory_ = directory;
+}
+
+std::string OpenClFramework::programCacheDirectory() {
+    boost::shared_lock<boost::shared_mutex> lock(programCacheDirectoryMutex_);
+    return programCacheDirectory_;
+}
+
 std::set<std::string> OpenClFramework::getAvailableDevices() const {
     std::set<std::string> tmp;
     for (auto const& [name, _] : contexts_)
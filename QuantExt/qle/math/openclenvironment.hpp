@@ -49,6 +49,11 @@ public:
     std::set<std::string> getAvailableDevices() const override final;
     ComputeContext* getContext(const std::string& deviceName) override final;
 
+    /*! Directory in which the compiled programs are persisted between runs. If empty (the default), the programs are
+        only cached in memory for the lifetime of a context. */
+    static void setProgramCacheDirectory(const std::string& directory);
+    static std::string programCacheDirectory();
+
 private:
     static void init();
 
@@ -67,6 +72,9 @@ private:
     static std::vector<std::pair<std::string, std::string>> deviceInfo_[ORE_OPENCL_MAX_N_PLATFORMS]
                                                                        [ORE_OPENCL_MAX_N_DEVICES];
     static bool supportsDoublePrecision_[ORE_OPENCL_MAX_N_PLATFORMS][ORE_OPENCL_MAX_N_DEVICES];
+
+    static boost::shared_mutex programCacheDirectoryMutex_;
+    static std::string programCacheDirectory_;
 };
 
 } // namespace QuantExt
@@ -17,6 +17,8 @@
 */
 
 #include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/randomvariable_pool.hpp>
 #include <qle/math/randomvariablelsmbasissystem.hpp>
 
 #include <ql/experimental/math/moorepenroseinverse.hpp>
@@ -24,6 +26,7 @@
 #include <ql/math/generallinearleastsquares.hpp>
 #include <ql/math/matrixutilities/qrdecomposition.hpp>
 #include <ql/math/matrixutilities/symmetricschurdecomposition.hpp>
+#include <ql/math/optimization/lmdif.hpp>
 
 #include <boost/math/distributions/normal.hpp>
 
@@ -36,6 +39,7 @@
 
 #include <iostream>
 #include <map>
+#include <tuple>
 
 // if defined, RandomVariableStats are updated (this might impact perfomance!), default is undefined
 //#define ENABLE_RANDOMVARIABLE_STATS
@@ -317,7 +321,7 @@ RandomVariable::RandomVariable(const RandomVariable& r) {
     constantData_ = r.constantData_;
     if (r.data_) {
         resumeDataStats();
-        data_ = new double[n_];
+        data_ = detail::allocateRandomVariableData(n_);
         // std::memcpy(data_, r.data_, n_ * sizeof(double));
         std::copy(r.data_, r.data_ + n_, data_);
         stopDataStats(n_);
@@ -341,24 +345,25 @@ RandomVariable& RandomVariable::operator=(const RandomVariable& r) {
     if (r.deterministic_) {
         deterministic_ = true;
         if (data_) {
-            delete[] data_;
+            detail::releaseRandomVariableData(data_, n_);
             data_ = nullptr;
         }
     } else {
         deterministic_ = false;
         if (r.n_ != 0) {
             resumeDataStats();
-            if (n_ != r.n_) {
-                if (data_)
-                    delete[] data_;
-                data_ = new double[r.n_];
+            if (data_ && n_ != r.n_) {
+                detail::releaseRandomVariableData(data_, n_);
+                data_ = nullptr;
             }
+            if (!data_)
+                data_ = detail::allocateRandomVariableData(r.n_);
             // std::memcpy(data_, r.data_, r.n_ * sizeof(double));
             std::copy(r.data_, r.data_ + r.n_, data_);
             stopDataStats(r.n_);
         } else {
             if (data_) {
-                delete[] data_;
+                detail::releaseRandomVariableData(data_, n_);
                 data_ = nullptr;
             }
         }
@@ -370,11 +375,11 @@ RandomVariable& RandomVariable::operator=(const RandomVariable& r) {
 }
 
 RandomVariable& RandomVariable::operator=(RandomVariable&& r) {
-    n_ = r.n_;
-    constantData_ = r.constantData_;
     if (data_) {
-        delete[] data_;
+        detail::releaseRandomVariableData(data_, n_);
     }
+    n_ = r.n_;
+    constantData_ = r.constantData_;
     data_ = r.data_;
     r.data_ = nullptr;
     deterministic_ = r.deterministic_;
@@ -399,7 +404,7 @@ RandomVariable::RandomVariable(const Filter& f, const Real valueTrue, const Real
         resumeDataStats();
         constantData_ = 0.0;
         deterministic_ = false;
-        data_ = new double[n_];
+        data_ = detail::allocateRandomVariableData(n_);
         for (Size i = 0; i < n_; ++i)
             set(i, f[i] ? valueTrue : valueFalse);
         stopDataStats(n_);
@@ -413,7 +418,7 @@ RandomVariable::RandomVariable(const Size n, const Real* const data, const Real
     time_ = time;
     if (n_ != 0) {
         resumeDataStats();
-        data_ = new double[n_];
+        data_ = detail::allocateRandomVariableData(n_);
         // std::memcpy(data_, array.begin(), n_ * sizeof(double));
         std::copy(data, data + n_, data_);
         stopDataStats(n_);
@@ -451,12 +456,12 @@ void RandomVariable::copyToArray(QuantLib::Array& array) const {
 }
 
 void RandomVariable::clear() {
-    n_ = 0;
-    constantData_ = 0.0;
     if (data_) {
-        delete[] data_;
+        detail::releaseRandomVariableData(data_, n_);
         data_ = nullptr;
     }
+    n_ = 0;
+    constantData_ = 0.0;
     deterministic_ = false;
     time_ = Null<Real>();
 }
@@ -478,7 +483,7 @@ void RandomVariable::updateDeterministic() {
 void RandomVariable::setAll(const Real v) {
     QL_REQUIRE(n_ > 0, "RandomVariable::setAll(): dimension is zero");
     if (data_) {
-        delete[] data_;
+        detail::releaseRandomVariableData(data_, n_);
         data_ = nullptr;
     }
     constantData_ = v;
@@ -495,7 +500,7 @@ void RandomVariable::expand() {
         return;
     deterministic_ = false;
     resumeDataStats();
-    data_ = new double[n_];
+    data_ = detail::allocateRandomVariableData(n_);
     std::fill(data_, data_ + n_, constantData_);
     stopDataStats(n_);
 }
@@ -546,9 +551,10 @@ RandomVariable& RandomVariable::operator+=(const RandomVariable& y) {
         constantData_ += y.constantData_;
     else {
         resumeCalcStats();
-        for (Size i = 0; i < n_; ++i) {
-            data_[i] += y[i];
-        }
+        if (y.deterministic_)
+            randomVariableKernels().addScalar(data_, y.constantData_, n_);
+        else
+            randomVariableKernels().add(data_, y.data_, n_);
         stopCalcStats(n_);
     }
     return *this;
@@ -570,9 +576,10 @@ RandomVariable& RandomVariable::operator-=(const RandomVariable& y) {
         constantData_ -= y.constantData_;
     else {
         resumeCalcStats();
-        for (Size i = 0; i < n_; ++i) {
-            data_[i] -= y[i];
-        }
+        if (y.deterministic_)
+            randomVariableKernels().subtractScalar(data_, y.constantData_, n_);
+        else
+            randomVariableKernels().subtract(data_, y.data_, n_);
         stopCalcStats(n_);
     }
     return *this;
@@ -594,9 +601,10 @@ RandomVariable& RandomVariable::operator*=(const RandomVariable& y) {
         constantData_ *= y.constantData_;
     else {
         resumeCalcStats();
-        for (Size i = 0; i < n_; ++i) {
-            data_[i] *= y[i];
-        }
+        if (y.deterministic_)
+            randomVariableKernels().multiplyScalar(data_, y.constantData_, n_);
+        else
+            randomVariableKernels().multiply(data_, y.data_, n_);
         stopCalcStats(n_);
     }
     return *this;
@@ -618,9 +626,10 @@ RandomVariable& RandomVariable::operator/=(const RandomVariable& y) {
         constantData_ /= y.constantData_;
     else {
         resumeCalcStats();
-        for (Size i = 0; i < n_; ++i) {
-            data_[i] /= y[i];
-        }
+        if (y.deterministic_)
+            randomVariableKernels().divideScalar(data_, y.constantData_, n_);
+        else
+            randomVariableKernels().divide(data_, y.data_, n_);
         stopCalcStats(n_);
     }
     return *this;
@@ -666,9 +675,10 @@ RandomVariable max(RandomVariable x, const RandomVariable& y) {
         x.constantData_ = std::max(x.constantData_, y.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.size(); ++i) {
-            x.data_[i] = std::max(x.data_[i], y[i]);
-        }
+        if (y.deterministic_)
+            randomVariableKernels().maxScalar(x.data_, y.constantData_, x.n_);
+        else
+            randomVariableKernels().max(x.data_, y.data_, x.n_);
         stopCalcStats(x.size());
     }
     return x;
@@ -686,9 +696,10 @@ RandomVariable min(RandomVariable x, const RandomVariable& y) {
         x.constantData_ = std::min(x.constantData_, y.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.size(); ++i) {
-            x.data_[i] = std::min(x.data_[i], y[i]);
-        }
+        if (y.deterministic_)
+            randomVariableKernels().minScalar(x.data_, y.constantData_, x.n_);
+        else
+            randomVariableKernels().min(x.data_, y.data_, x.n_);
         stopCalcStats(x.size());
     }
     return x;
@@ -721,9 +732,7 @@ RandomVariable operator-(RandomVariable x) {
         x.constantData_ = -x.constantData_;
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.n_; ++i) {
-            x.data_[i] = -x.data_[i];
-        }
+        randomVariableKernels().negate(x.data_, x.n_);
         stopCalcStats(x.n_);
     }
     return x;
@@ -734,9 +743,7 @@ RandomVariable abs(RandomVariable x) {
         x.constantData_ = std::abs(x.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.n_; ++i) {
-            x.data_[i] = std::abs(x.data_[i]);
-        }
+        randomVariableKernels().abs(x.data_, x.n_);
         stopCalcStats(x.n_);
     }
     return x;
@@ -747,9 +754,7 @@ RandomVariable exp(RandomVariable x) {
         x.constantData_ = std::exp(x.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.n_; ++i) {
-            x.data_[i] = std::exp(x.data_[i]);
-        }
+        randomVariableKernels().exp(x.data_, x.n_);
         stopCalcStats(x.n_);
     }
     return x;
@@ -760,9 +765,7 @@ RandomVariable log(RandomVariable x) {
         x.constantData_ = std::log(x.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.n_; ++i) {
-            x.data_[i] = std::log(x.data_[i]);
-        }
+        randomVariableKernels().log(x.data_, x.n_);
         stopCalcStats(x.n_);
     }
     return x;
@@ -773,9 +776,7 @@ RandomVariable sqrt(RandomVariable x) {
         x.constantData_ = std::sqrt(x.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.n_; ++i) {
-            x.data_[i] = std::sqrt(x.data_[i]);
-        }
+        randomVariableKernels().sqrt(x.data_, x.n_);
         stopCalcStats(x.n_);
     }
     return x;
@@ -813,9 +814,7 @@ RandomVariable normalCdf(RandomVariable x) {
         x.constantData_ = boost::math::cdf(n, x.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.n_; ++i) {
-            x.data_[i] = boost::math::cdf(n, x.data_[i]);
-        }
+        randomVariableKernels().normalCdf(x.data_, x.n_);
         stopCalcStats(x.n_);
     }
     return x;
@@ -827,9 +826,7 @@ RandomVariable normalPdf(RandomVariable x) {
         x.constantData_ = boost::math::pdf(n, x.constantData_);
     else {
         resumeCalcStats();
-        for (Size i = 0; i < x.n_; ++i) {
-            x.data_[i] = boost::math::pdf(n, x.data_[i]);
-        }
+        randomVariableKernels().normalPdf(x.data_, x.n_);
         stopCalcStats(x.n_);
     }
     return x;
@@ -881,10 +878,10 @@ RandomVariable conditionalResult(const Filter& f, RandomVariable x, const Random
         return f.at(0) ? x : y;
     resumeCalcStats();
     x.expand();
-    for (Size i = 0; i < f.size(); ++i) {
-        if (!f[i])
-            x.set(i, y[i]);
-    }
+    if (y.deterministic_)
+        randomVariableKernels().selectScalar(x.data_, f.data(), y.constantData_, x.n_);
+    else
+        randomVariableKernels().select(x.data_, f.data(), y.data_, x.n_);
     stopCalcStats(f.size());
     return x;
 }
@@ -1160,26 +1157,101 @@ std::vector<const RandomVariable*> vec2vecptr(const std::vector<RandomVariable>&
     return result;
 }
 
-Array regressionCoefficients(
-    RandomVariable r, std::vector<const RandomVariable*> regressor,
-    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter, const RandomVariableRegressionMethod regressionMethod, const std::string& debugLabel) {
+namespace {
 
-    for (auto const reg : regressor) {
-        QL_REQUIRE(reg->size() == r.size(),
-                   "regressor size (" << reg->size() << ") must match regressand size (" << r.size() << ")");
-    }
+// paths per block for the one-pass accumulation of the normal equations
+constexpr Size regressionBlockSize = 1024;
 
-    QL_REQUIRE(filter.size() == 0 || filter.size() == r.size(),
-               "filter size (" << filter.size() << ") must match regressand size (" << r.size() << ")");
+RandomVariable regressionBlock(const RandomVariable& x, const Size offset, const Size size) {
+    if (x.deterministic())
+        return RandomVariable(size, x[0]);
+    return RandomVariable(size, x.data() + offset);
+}
 
-    QL_REQUIRE(r.size() >= basisFn.size(), "regressionCoefficients(): sample size ("
-                                               << r.size() << ") must be geq basis fns size (" << basisFn.size()
-                                               << ")");
+Filter regressionBlock(const Filter& f, const Size offset, const Size size) {
+    if (f.deterministic())
+        return Filter(size, f[0]);
+    Filter result(size);
+    for (Size i = 0; i < size; ++i)
+        result.set(i, f.data()[offset + i]);
+    return result;
+}
 
-    resumeCalcStats();
+/* Accumulates A^T A and A^T b_k of the design matrix A and the regressands b_k block by block, so that the basis
+   function values of one block of paths stay in the cache and the full design matrix is never built. Filtered out
+   paths contribute zero rows. The normal equations are solved with a pseudo inverse based on the svd of A^T A, where
+   the singular values are truncated in the same way as for the svd regression method. */
+std::vector<Array> regressionCoefficientsNormalEquations(
+    const std::vector<RandomVariable>& r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter) {
+
+    const Size n = r.front().size(), m = basisFn.size();
+    Matrix AtA(m, m, 0.0);
+    std::vector<Array> Atb(r.size(), Array(m, 0.0));
+
+    std::vector<double> a(m * regressionBlockSize), b(r.size() * regressionBlockSize);
+    std::vector<RandomVariable> regressorBlock(regressor.size());
+
+    for (Size offset = 0; offset < n; offset += regressionBlockSize) {
+        const Size bs = std::min(regressionBlockSize, n - offset);
+        for (Size k = 0; k < regressor.size(); ++k)
+            regressorBlock[k] = regressionBlock(*regressor[k], offset, bs);
+        auto regressorBlockPtr = vec2vecptr(regressorBlock);
+        Filter filterBlock;
+        if (filter.initialised())
+            filterBlock = regressionBlock(filter, offset, bs);
+        for (Size j = 0; j < m; ++j) {
+            RandomVariable v = basisFn[j](regressorBlockPtr);
+            if (filterBlock.initialised())
+                v = applyFilter(v, filterBlock);
+            for (Size i = 0; i < bs; ++i)
+                a[j * regressionBlockSize + i] = v[i];
+        }
+        for (Size k = 0; k < r.size(); ++k) {
+            RandomVariable v = regressionBlock(r[k], offset, bs);
+            if (filterBlock.initialised())
+                v = applyFilter(v, filterBlock);
+            for (Size i = 0; i < bs; ++i)
+                b[k * regressionBlockSize + i] = v[i];
+        }
+        for (Size j = 0; j < m; ++j) {
+            const double* aj = &a[j * regressionBlockSize];
+            for (Size l = 0; l <= j; ++l)
+                AtA[j][l] += std::inner_product(aj, aj + bs, &a[l * regressionBlockSize], 0.0);
+            for (Size k = 0; k < r.size(); ++k)
+                Atb[k][j] += std::inner_product(aj, aj + bs, &b[k * regressionBlockSize], 0.0);
+        }
+    }
 
-    Matrix A(r.size(), basisFn.size());
+    for (Size j = 0; j < m; ++j)
+        for (Size l = 0; l < j; ++l)
+            AtA[l][j] = AtA[j][l];
+
+    SVD svd(AtA);
+    const Matrix& V = svd.V();
+    const Matrix& U = svd.U();
+    const Array& w = svd.singularValues();
+    Real threshold = n * QL_EPSILON * w[0];
+    std::vector<Array> res(r.size(), Array(m, 0.0));
+    for (Size i = 0; i < m; ++i) {
+        if (w[i] > threshold) {
+            for (Size k = 0; k < r.size(); ++k) {
+                Real u = std::inner_product(U.column_begin(i), U.column_end(i), Atb[k].begin(), Real(0.0)) / w[i];
+                for (Size j = 0; j < m; ++j)
+                    res[k][j] += u * V[j][i];
+            }
+        }
+    }
+    return res;
+}
+
+// the values of the basis functions on the (filtered) paths, one column per basis function
+Matrix regressionDesignMatrix(
+    const Size n, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter) {
+    Matrix A(n, basisFn.size());
     for (Size j = 0; j < basisFn.size(); ++j) {
         RandomVariable a = basisFn[j](regressor);
         if (filter.initialised()) {
@@ -1190,51 +1262,200 @@ Array regressionCoefficients(
         else
             a.copyToMatrixCol(A, j);
     }
+    return A;
+}
 
-    if (!debugLabel.empty()) {
-        for (Size i = 0; i < r.size(); ++i) {
-            std::cout << debugLabel << "," << r[i] << ",";
-            for (Size j = 0; j < regressor.size(); ++j) {
-                std::cout << regressor[j]->operator[](i) << (j == regressor.size() - 1 ? "\n" : ",");
-            }
-        }
-        std::cout << std::flush;
+std::vector<Array> regressionCoefficientsImpl(
+    std::vector<RandomVariable> r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter, const RandomVariableRegressionMethod regressionMethod) {
+
+    QL_REQUIRE(!r.empty(), "regressionCoefficients(): no regressand given");
+
+    for (auto const& s : r) {
+        QL_REQUIRE(s.size() == r.front().size(), "regressand size (" << s.size()
+                                                                    << ") must match first regressand size ("
+                                                                    << r.front().size() << ")");
     }
 
-    if (filter.size() > 0) {
-        r = applyFilter(r, filter);
+    for (auto const reg : regressor) {
+        QL_REQUIRE(reg->size() == r.front().size(),
+                   "regressor size (" << reg->size() << ") must match regressand size (" << r.front().size() << ")");
     }
 
-    Array b(r.size());
-    if (r.deterministic())
-        std::fill(b.begin(), b.end(), r[0]);
-    else
-        r.copyToArray(b);
+    QL_REQUIRE(filter.size() == 0 || filter.size() == r.front().size(),
+               "filter size (" << filter.size() << ") must match regressand size (" << r.front().size() << ")");
 
-    Array res;
+    QL_REQUIRE(r.front().size() >= basisFn.size(), "regressionCoefficients(): sample size ("
+                                                       << r.front().size() << ") must be geq basis fns size ("
+                                                       << basisFn.size() << ")");
+
+    resumeCalcStats();
+
+    const Size n = r.front().size();
+
+    if (regressionMethod == RandomVariableRegressionMethod::NormalEquations) {
+        auto res = regressionCoefficientsNormalEquations(r, regressor, basisFn, filter);
+        stopCalcStats(n * basisFn.size() * (basisFn.size() + r.size()));
+        return res;
+    }
+
+    Matrix A = regressionDesignMatrix(n, regressor, basisFn, filter);
+
+    std::vector<Array> b(r.size(), Array(n));
+    for (Size k = 0; k < r.size(); ++k) {
+        if (filter.size() > 0) {
+            r[k] = applyFilter(r[k], filter);
+        }
+        if (r[k].deterministic())
+            std::fill(b[k].begin(), b[k].end(), r[k][0]);
+        else
+            r[k].copyToArray(b[k]);
+    }
+
+    std::vector<Array> res(r.size());
     if (regressionMethod == RandomVariableRegressionMethod::SVD) {
         SVD svd(A);
         const Matrix& V = svd.V();
         const Matrix& U = svd.U();
         const Array& w = svd.singularValues();
-        Real threshold = r.size() * QL_EPSILON * svd.singularValues()[0];
-        res = Array(basisFn.size(), 0.0);
-        for (Size i = 0; i < basisFn.size(); ++i) {
-            if (w[i] > threshold) {
-                Real u = std::inner_product(U.column_begin(i), U.column_end(i), b.begin(), Real(0.0)) / w[i];
-                for (Size j = 0; j < basisFn.size(); ++j) {
-                    res[j] += u * V[j][i];
+        Real threshold = n * QL_EPSILON * svd.singularValues()[0];
+        for (Size k = 0; k < r.size(); ++k) {
+            res[k] = Array(basisFn.size(), 0.0);
+            for (Size i = 0; i < basisFn.size(); ++i) {
+                if (w[i] > threshold) {
+                    Real u = std::inner_product(U.column_begin(i), U.column_end(i), b[k].begin(), Real(0.0)) / w[i];
+                    for (Size j = 0; j < basisFn.size(); ++j) {
+                        res[k][j] += u * V[j][i];
+                    }
                 }
             }
         }
     } else if (regressionMethod == RandomVariableRegressionMethod::QR) {
-        res = qrSolve(A, b);
+        QrRegressionFactorisation qr(A);
+        for (Size k = 0; k < r.size(); ++k)
+            res[k] = qr.solve(b[k]);
     } else {
-        QL_FAIL("regressionCoefficients(): unknown regression method, expected SVD or QR");
+        QL_FAIL("regressionCoefficients(): unknown regression method, expected SVD, QR or NormalEquations");
     }
 
     // rough estimate, SVD is O(mn min(m,n))
-    stopCalcStats(r.size() * basisFn.size() * std::min(r.size(), basisFn.size()));
+    stopCalcStats(r.size() * n * basisFn.size() * std::min(n, basisFn.size()));
+    return res;
+}
+
+} // namespace
+
+Array regressionCoefficients(
+    RandomVariable r, std::vector<const RandomVariable*> regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter, const RandomVariableRegressionMethod regressionMethod, const std::string& debugLabel) {
+
+    if (!debugLabel.empty()) {
+        for (auto const reg : regressor) {
+            QL_REQUIRE(reg->size() == r.size(),
+                       "regressor size (" << reg->size() << ") must match regressand size (" << r.size() << ")");
+        }
+        for (Size i = 0; i < r.size(); ++i) {
+            std::cout << debugLabel << "," << r[i] << ",";
+            for (Size j = 0; j < regressor.size(); ++j) {
+                std::cout << regressor[j]->operator[](i) << (j == regressor.size() - 1 ? "\n" : ",");
+            }
+        }
+        std::cout << std::flush;
+    }
+
+    return regressionCoefficientsImpl({r}, regressor, basisFn, filter, regressionMethod).front();
+}
+
+std::vector<Array> regressionCoefficients(
+    const std::vector<RandomVariable>& r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter, const RandomVariableRegressionMethod regressionMethod) {
+    return regressionCoefficientsImpl(r, regressor, basisFn, filter, regressionMethod);
+}
+
+namespace {
+// the basis values are used as regressors and the i-th basis function picks the i-th regressor
+std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>
+basisValuesProjections(const Size n) {
+    std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>> result;
+    for (Size i = 0; i < n; ++i)
+        result.push_back([i](const std::vector<const RandomVariable*>& x) { return *x[i]; });
+    return result;
+}
+} // namespace
+
+Array regressionCoefficients(const RandomVariable& r, const std::vector<RandomVariable>& basisValues,
+                             const Filter& filter, const RandomVariableRegressionMethod regressionMethod) {
+    QL_REQUIRE(!basisValues.empty(), "regressionCoefficients(): basis values are empty");
+    return regressionCoefficientsImpl({r}, vec2vecptr(basisValues), basisValuesProjections(basisValues.size()),
+                                      filter, regressionMethod)
+        .front();
+}
+
+QrRegressionFactorisation::QrRegressionFactorisation(const Matrix& designMatrix) {
+    const Size n = designMatrix.columns();
+    QL_REQUIRE(designMatrix.rows() >= n, "QrRegressionFactorisation: number of rows ("
+                                             << designMatrix.rows() << ") must be geq number of columns (" << n
+                                             << ")");
+    // this is the decomposition done in qrSolve(), we keep the factors to solve for several rhs
+    Matrix q, r;
+    std::vector<Size> ipvt = qrDecomposition(designMatrix, q, r, true);
+    qT_ = transpose(q);
+    rT_ = transpose(r);
+    ipvt_ = std::vector<int>(ipvt.begin(), ipvt.end());
+}
+
+Array QrRegressionFactorisation::solve(const Array& b) const {
+    const Size n = columns();
+    QL_REQUIRE(b.size() == rows(),
+               "QrRegressionFactorisation::solve(): rhs size (" << b.size() << ") must match rows (" << rows() << ")");
+    Array qtb(n);
+    for (Size j = 0; j < n; ++j)
+        qtb[j] = std::inner_product(qT_.row_begin(j), qT_.row_end(j), b.begin(), Real(0.0));
+    // qrsolv() overwrites the strict lower triangle of r, so we work on a copy to keep this method const
+    Matrix rT(rT_);
+    std::vector<int> ipvt(ipvt_);
+    Array x(n), d(n, 0.0), sdiag(n), wa(n);
+    MINPACK::qrsolv(static_cast<int>(n), rT.begin(), static_cast<int>(n), ipvt.data(), d.begin(), qtb.begin(),
+                    x.begin(), sdiag.begin(), wa.begin());
+    return x;
+}
+
+QrRegressionFactorisation qrRegressionFactorisation(const std::vector<RandomVariable>& basisValues,
+                                                    const Filter& filter) {
+    QL_REQUIRE(!basisValues.empty(), "qrRegressionFactorisation(): basis values are empty");
+    const Size n = basisValues.front().size();
+    for (auto const& v : basisValues) {
+        QL_REQUIRE(v.size() == n, "qrRegressionFactorisation(): basis value size (" << v.size()
+                                                                                   << ") must match first basis value "
+                                                                                   << "size (" << n << ")");
+    }
+    QL_REQUIRE(filter.size() == 0 || filter.size() == n,
+               "qrRegressionFactorisation(): filter size (" << filter.size() << ") must match basis value size (" << n
+                                                            << ")");
+    resumeCalcStats();
+    QrRegressionFactorisation qr(regressionDesignMatrix(
+        n, vec2vecptr(basisValues), basisValuesProjections(basisValues.size()), filter));
+    stopCalcStats(n * basisValues.size() * basisValues.size());
+    return qr;
+}
+
+Array regressionCoefficients(RandomVariable r, const QrRegressionFactorisation& qr, const Filter& filter) {
+    QL_REQUIRE(r.size() == qr.rows(),
+               "regressionCoefficients(): regressand size (" << r.size() << ") must match factorisation rows ("
+                                                             << qr.rows() << ")");
+    if (filter.initialised())
+        r = applyFilter(r, filter);
+    Array b(r.size());
+    if (r.deterministic())
+        std::fill(b.begin(), b.end(), r[0]);
+    else
+        r.copyToArray(b);
+    resumeCalcStats();
+    Array res = qr.solve(b);
+    stopCalcStats(r.size() * qr.columns());
     return res;
 }
 
@@ -1268,6 +1489,27 @@ RandomVariable conditionalExpectation(
     return conditionalExpectation(regressor, basisFn, coeff);
 }
 
+RandomVariable conditionalExpectation(const std::vector<RandomVariable>& basisValues, const Array& coefficients) {
+    QL_REQUIRE(!basisValues.empty(), "basis values are empty");
+    QL_REQUIRE(basisValues.size() == coefficients.size(), "basis values size (" << basisValues.size()
+                                                                                << ") must match coefficients size ("
+                                                                                << coefficients.size() << ")");
+    Size n = basisValues.front().size();
+    RandomVariable r(n, 0.0);
+    for (Size i = 0; i < coefficients.size(); ++i) {
+        r = r + RandomVariable(n, coefficients[i]) * basisValues[i];
+    }
+    return r;
+}
+
+RandomVariable conditionalExpectation(const RandomVariable& r, const std::vector<RandomVariable>& basisValues,
+                                      const Filter& filter, const RandomVariableRegressionMethod regressionMethod) {
+    if (r.deterministic())
+        return r;
+    auto coeff = regressionCoefficients(r, basisValues, filter, regressionMethod);
+    return conditionalExpectation(basisValues, coeff);
+}
+
 RandomVariable expectation(const RandomVariable& r) {
     if (r.deterministic())
         return r;
@@ -1358,7 +1600,7 @@ std::function<void(RandomVariable&)> RandomVariable::deleter =
 
 std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>
 multiPathBasisSystem(Size dim, Size order, QuantLib::LsmBasisSystem::PolynomialType type, Size basisSystemSizeBound) {
-    thread_local static std::map<std::pair<Size, Size>,
+    thread_local static std::map<std::tuple<Size, Size, QuantLib::LsmBasisSystem::PolynomialType>,
                                  std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>>
         cache;
     QL_REQUIRE(order > 0, "multiPathBasisSystem: order must be > 0");
@@ -1367,11 +1609,24 @@ multiPathBasisSystem(Size dim, Size order, QuantLib::LsmBasisSystem::PolynomialT
             --order;
         }
     }
-    if (auto c = cache.find(std::make_pair(dim, order)); c != cache.end())
+    if (auto c = cache.find(std::make_tuple(dim, order, type)); c != cache.end())
         return c->second;
     auto tmp = RandomVariableLsmBasisSystem::multiPathBasisSystem(dim, order, type);
-    cache[std::make_pair(dim, order)] = tmp;
+    cache[std::make_tuple(dim, order, type)] = tmp;
     return tmp;
 }
 
+std::vector<RandomVariable> multiPathBasisSystemValues(const std::vector<const RandomVariable*>& regressor, Size order,
+                                                       QuantLib::LsmBasisSystem::PolynomialType type,
+                                                       Size basisSystemSizeBound) {
+    QL_REQUIRE(order > 0, "multiPathBasisSystemValues: order must be > 0");
+    if (basisSystemSizeBound != Null<Size>()) {
+        while (RandomVariableLsmBasisSystem::size(regressor.size(), order) > static_cast<Real>(basisSystemSizeBound) &&
+               order > 1) {
+            --order;
+        }
+    }
+    return RandomVariableLsmBasisSystem::multiPathBasisSystemValues(regressor, order, type);
+}
+
 } // namespace QuantExt
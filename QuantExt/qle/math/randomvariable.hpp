@@ -100,6 +100,7 @@ struct Filter {
 
     // pointer to raw data, this is null for deterministic variables
     bool* data();
+    const bool* data() const;
 
 private:
     // for invariants see the corresponding section below in class RandomVariable
@@ -138,6 +139,7 @@ inline bool Filter::at(const Size i) const {
 }
 
 inline bool* Filter::data() { return data_; }
+inline const bool* Filter::data() const { return data_; }
 
 bool operator==(const Filter& a, const Filter& b);
 bool operator!=(const Filter& a, const Filter& b);
@@ -223,6 +225,7 @@ struct RandomVariable {
     void expand();
     // pointer to raw data, this is null for deterministic variables
     double* data();
+    const double* data() const;
 
     static std::function<void(RandomVariable&)> deleter;
 
@@ -300,14 +303,50 @@ std::vector<RandomVariable> applyCoordinateTransform(const std::vector<const Ran
 /* Create vector of pointers to rvs from vector of rvs */
 std::vector<const RandomVariable*> vec2vecptr(const std::vector<RandomVariable>& values);
 
-// compute regression coefficients
-enum class RandomVariableRegressionMethod { QR, SVD };
+/* compute regression coefficients
+   - QR, SVD: solve the least squares problem for the full design matrix
+   - NormalEquations: accumulate the normal equations in one pass over blocks of paths without building the design
+     matrix, this is faster and uses less memory, but squares the condition number of the problem */
+enum class RandomVariableRegressionMethod { QR, SVD, NormalEquations };
 Array regressionCoefficients(
     RandomVariable r, std::vector<const RandomVariable*> regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
     const Filter& filter = Filter(), const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR,
     const std::string& debugLabel = std::string());
 
+/* compute regression coefficients for several regressands sharing the regressor, the design matrix is built
+   (resp. the normal equations are accumulated) and decomposed only once */
+std::vector<Array> regressionCoefficients(
+    const std::vector<RandomVariable>& r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter = Filter(), const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR);
+
+// compute regression coefficients for given values of the basis functions, see multiPathBasisSystemValues()
+Array regressionCoefficients(const RandomVariable& r, const std::vector<RandomVariable>& basisValues,
+                             const Filter& filter = Filter(),
+                             const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR);
+
+/* QR factorisation of a regression design matrix (paths x basis functions), solve() gives the same least squares
+   solution as qrSolve() on the design matrix, but the matrix is only factorised once for several regressands */
+class QrRegressionFactorisation {
+public:
+    explicit QrRegressionFactorisation(const Matrix& designMatrix);
+    Array solve(const Array& b) const;
+    Size rows() const { return qT_.columns(); }
+    Size columns() const { return qT_.rows(); }
+
+private:
+    Matrix qT_, rT_;
+    std::vector<int> ipvt_;
+};
+
+// QR factorisation for given values of the basis functions, see multiPathBasisSystemValues()
+QrRegressionFactorisation qrRegressionFactorisation(const std::vector<RandomVariable>& basisValues,
+                                                    const Filter& filter = Filter());
+
+// compute regression coefficients from a QR factorisation, the filter must be the one used to build the factorisation
+Array regressionCoefficients(RandomVariable r, const QrRegressionFactorisation& qr, const Filter& filter = Filter());
+
 // evaluate regression function
 RandomVariable conditionalExpectation(
     const std::vector<const RandomVariable*>& regressor,
@@ -320,6 +359,14 @@ RandomVariable conditionalExpectation(
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
     const Filter& filter = Filter(), const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR);
 
+// evaluate regression function for given values of the basis functions
+RandomVariable conditionalExpectation(const std::vector<RandomVariable>& basisValues, const Array& coefficients);
+
+// compute and evaluate regression in one run for given values of the basis functions
+RandomVariable conditionalExpectation(const RandomVariable& r, const std::vector<RandomVariable>& basisValues,
+                                      const Filter& filter = Filter(),
+                                      const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR);
+
 // time zero expectation
 RandomVariable expectation(const RandomVariable& r);
 
@@ -371,6 +418,7 @@ inline Real RandomVariable::at(const Size i) const {
 }
 
 inline double* RandomVariable::data() { return data_; }
+inline const double* RandomVariable::data() const { return data_; }
 
 /*! helper function that returns a LSM basis system with size restriction: the order is reduced until
   the size of the basis system is not greater than the given bound (if this is not null) or the order is 1 */
@@ -378,4 +426,10 @@ std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*
 multiPathBasisSystem(Size dim, Size order, QuantLib::LsmBasisSystem::PolynomialType type,
                      Size basisSystemSizeBound = Null<Size>());
 
+/*! helper function that returns the values of the LSM basis system evaluated at the regressor, with the same size
+  restriction as multiPathBasisSystem() */
+std::vector<RandomVariable> multiPathBasisSystemValues(const std::vector<const RandomVariable*>& regressor, Size order,
+                                                       QuantLib::LsmBasisSystem::PolynomialType type,
+                                                       Size basisSystemSizeBound = Null<Size>());
+
 } // namespace QuantExt
@@ -0,0 +1,228 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/randomvariable_kernels_impl.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/math/distributions/normal.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace QuantExt {
+
+namespace detail {
+
+double scalarExp(const double x) { return std::exp(x); }
+double scalarLog(const double x) { return std::log(x); }
+double scalarNormalCdf(const double x) {
+    static const boost::math::normal_distribution<double> n;
+    return boost::math::cdf(n, x);
+}
+double scalarNormalPdf(const double x) {
+    static const boost::math::normal_distribution<double> n;
+    return boost::math::pdf(n, x);
+}
+
+namespace {
+
+void add(double* x, const double* y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] += y[i];
+}
+void addScalar(double* x, const double y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] += y;
+}
+void subtract(double* x, const double* y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] -= y[i];
+}
+void subtractScalar(double* x, const double y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] -= y;
+}
+void multiply(double* x, const double* y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] *= y[i];
+}
+void multiplyScalar(double* x, const double y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] *= y;
+}
+void divide(double* x, const double* y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] /= y[i];
+}
+void divideScalar(double* x, const double y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] /= y;
+}
+void max(double* x, const double* y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::max(x[i], y[i]);
+}
+void maxScalar(double* x, const double y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::max(x[i], y);
+}
+void min(double* x, const double* y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::min(x[i], y[i]);
+}
+void minScalar(double* x, const double y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::min(x[i], y);
+}
+void negate(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = -x[i];
+}
+void abs(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::abs(x[i]);
+}
+void sqrt(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::sqrt(x[i]);
+}
+void exp(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::exp(x[i]);
+}
+void log(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = std::log(x[i]);
+}
+void normalCdf(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = scalarNormalCdf(x[i]);
+}
+void normalPdf(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        x[i] = scalarNormalPdf(x[i]);
+}
+void select(double* x, const bool* f, const double* y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        if (!f[i])
+            x[i] = y[i];
+}
+void selectScalar(double* x, const bool* f, const double y, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        if (!f[i])
+            x[i] = y;
+}
+
+const RandomVariableKernelTable scalarTable = {
+    "Scalar", add,    addScalar, subtract,  subtractScalar, multiply, multiplyScalar, divide,
+    divideScalar, max, maxScalar, min,       minScalar,      negate,   abs,            sqrt,
+    exp,      log,    normalCdf, normalPdf, select,         selectScalar};
+
+// cpu support of the instruction sets, including the os support for the extended register state
+
+bool cpuSupportsAvx2() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int r[4];
+    __cpuid(r, 1);
+    bool osxsave = (r[2] & (1 << 27)) != 0, fma = (r[2] & (1 << 12)) != 0;
+    if (!osxsave || !fma || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool cpuSupportsAvx512() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int r[4];
+    __cpuid(r, 1);
+    if ((r[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0xE6) != 0xE6)
+        return false;
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 16)) != 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+const RandomVariableKernelTable* scalarRandomVariableKernels() { return &scalarTable; }
+
+} // namespace detail
+
+namespace {
+
+// available kernels, ordered by increasing vector width
+std::vector<const RandomVariableKernelTable*> availableKernels() {
+    std::vector<const RandomVariableKernelTable*> result = {detail::scalarRandomVariableKernels()};
+    if (auto t = detail::avx2RandomVariableKernels(); t != nullptr && detail::cpuSupportsAvx2())
+        result.push_back(t);
+    if (auto t = detail::avx512RandomVariableKernels(); t != nullptr && detail::cpuSupportsAvx512())
+        result.push_back(t);
+    return result;
+}
+
+} // namespace
+
+RandomVariableKernels::RandomVariableKernels() : table_(detail::scalarRandomVariableKernels()) {}
+
+std::set<std::string> RandomVariableKernels::getAvailableKernels() const {
+    std::set<std::string> result;
+    for (auto const& t : availableKernels())
+        result.insert(t->name);
+    return result;
+}
+
+void RandomVariableKernels::selectKernels(const std::string& name) {
+    auto available = availableKernels();
+    if (name == "Auto") {
+        table_.store(available.back(), std::memory_order_relaxed);
+        return;
+    }
+    for (auto const& t : available) {
+        if (name == t->name) {
+            table_.store(t, std::memory_order_relaxed);
+            return;
+        }
+    }
+    QL_FAIL("RandomVariableKernels::selectKernels(): kernels '"
+            << name << "' not available. Available kernels are: " << boost::join(getAvailableKernels(), ", ")
+            << ", Auto");
+}
+
+std::string RandomVariableKernels::selectedKernels() const { return kernels().name; }
+
+void RandomVariableKernels::reset() { table_.store(detail::scalarRandomVariableKernels(), std::memory_order_relaxed); }
+
+} // namespace QuantExt
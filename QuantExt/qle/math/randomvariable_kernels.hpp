@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_kernels.hpp
+    \brief kernels operating on the data of random variables, with runtime selection of the instruction set
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable_kerneltable.hpp>
+
+#include <ql/patterns/singleton.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <set>
+#include <string>
+
+namespace QuantExt {
+
+//! Selection of the kernels used by RandomVariable
+/*! The available kernels are
+
+    - "Scalar": plain loops calling the standard library (resp. boost for normalCdf, normalPdf), this is the default
+    - "AVX2":   AVX2 and FMA, 4 doubles per instruction
+    - "AVX512": AVX-512F, 8 doubles per instruction
+
+    "AVX2" and "AVX512" are only available if the library was built for x86 and the cpu supports the instruction
+    set. Selecting "Auto" chooses the widest available kernels.
+
+    The arithmetic kernels, max, min, negate, abs, sqrt and select produce the same results for all kernels. The
+    vectorised exp, log, normalCdf and normalPdf are approximations with the following accuracy:
+
+    - exp:       relative error below 3E-16 for |x| <= 708, outside this range std::exp is used
+    - log:       relative error below 5E-16 for positive normal x, otherwise std::log is used
+    - normalCdf: absolute error below 3E-16, relative error below 2E-14 for x >= -3, this is Hart's algorithm 5666
+                 as given in G. West, "Better approximations to cumulative normal functions", values below -3 and
+                 NaN are handled by the scalar kernel
+    - normalPdf: relative error below 5E-16 for |x| <= 37.6, otherwise the scalar kernel is used
+
+    The selection is global, i.e. it applies to all threads. */
+class RandomVariableKernels : public QuantLib::Singleton<RandomVariableKernels, std::integral_constant<bool, true>> {
+public:
+    RandomVariableKernels();
+    std::set<std::string> getAvailableKernels() const;
+    void selectKernels(const std::string& name);
+    std::string selectedKernels() const;
+    const RandomVariableKernelTable& kernels() const { return *table_.load(std::memory_order_relaxed); }
+    //! select the scalar kernels
+    void reset();
+
+private:
+    std::atomic<const RandomVariableKernelTable*> table_;
+};
+
+//! the kernels currently selected
+inline const RandomVariableKernelTable& randomVariableKernels() { return RandomVariableKernels::instance().kernels(); }
+
+} // namespace QuantExt
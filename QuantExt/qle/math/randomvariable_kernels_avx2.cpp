@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/* This translation unit is compiled with AVX2 and FMA enabled (see CMakeLists.txt), it must therefore not contain any
+   code that might be shared with other translation units (e.g. inline functions from QuantLib or boost headers). */
+
+#include <qle/math/randomvariable_kernels_impl.hpp>
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace QuantExt {
+namespace detail {
+
+namespace {
+
+struct Avx2 {
+    using Reg = __m256d;
+    using Mask = __m256d;
+    static constexpr std::size_t width = 4;
+
+    static Reg load(const double* x) { return _mm256_loadu_pd(x); }
+    static void store(double* x, Reg v) { _mm256_storeu_pd(x, v); }
+    static Reg set1(double v) { return _mm256_set1_pd(v); }
+
+    static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+    static Reg div(Reg a, Reg b) { return _mm256_div_pd(a, b); }
+    // same semantics as std::max(a, b) = a < b ? b : a and std::min(a, b) = b < a ? b : a, also for NaN
+    static Reg max(Reg a, Reg b) { return _mm256_max_pd(b, a); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_pd(b, a); }
+    static Reg sqrt(Reg a) { return _mm256_sqrt_pd(a); }
+    static Reg neg(Reg a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+    static Reg abs(Reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    // a * b + c, c - a * b
+    static Reg fmadd(Reg a, Reg b, Reg c) { return _mm256_fmadd_pd(a, b, c); }
+    static Reg fnmadd(Reg a, Reg b, Reg c) { return _mm256_fnmadd_pd(a, b, c); }
+    static Reg round(Reg a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    // 2^n for integer valued n in [-1022, 1023]
+    static Reg pow2n(Reg n) {
+        __m256i b = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0)));
+        b = _mm256_add_epi64(b, _mm256_set1_epi64x(1023 - 0x4338000000000000LL));
+        return _mm256_castsi256_pd(_mm256_slli_epi64(b, 52));
+    }
+
+    // x = 2^e m with 1 <= m < 2 for positive normal x
+    static void decompose(Reg x, Reg& e, Reg& m) {
+        __m256i b = _mm256_castpd_si256(x);
+        __m256i ex = _mm256_srli_epi64(b, 52);
+        e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(ex, _mm256_set1_epi64x(0x4330000000000000LL))),
+                          _mm256_set1_pd(4503599627370496.0 + 1023.0));
+        m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(b, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                                _mm256_set1_epi64x(0x3FF0000000000000LL)));
+    }
+
+    static Mask lt(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static Mask le(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static Mask gt(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static Mask ge(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static Mask eq(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static Mask bitAnd(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+    static bool all(Mask m) { return _mm256_movemask_pd(m) == 0xF; }
+    static bool lane(Mask m, std::size_t j) { return (_mm256_movemask_pd(m) >> j) & 1; }
+    // m ? a : b
+    static Reg blend(Mask m, Reg a, Reg b) { return _mm256_blendv_pd(b, a, m); }
+    static Mask loadMask(const bool* f) {
+        std::int32_t tmp;
+        std::memcpy(&tmp, f, sizeof(tmp));
+        __m256i v = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(tmp));
+        return _mm256_castsi256_pd(_mm256_cmpgt_epi64(v, _mm256_setzero_si256()));
+    }
+};
+
+} // namespace
+
+const RandomVariableKernelTable* avx2RandomVariableKernels() {
+    static const RandomVariableKernelTable table = VectorKernels<Avx2>::table("AVX2");
+    return &table;
+}
+
+} // namespace detail
+} // namespace QuantExt
+
+#else
+
+namespace QuantExt {
+namespace detail {
+const RandomVariableKernelTable* avx2RandomVariableKernels() { return nullptr; }
+} // namespace detail
+} // namespace QuantExt
+
+#endif
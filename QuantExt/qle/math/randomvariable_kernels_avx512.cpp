@@ -0,0 +1,111 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/* This translation unit is compiled with AVX-512F enabled (see CMakeLists.txt), it must therefore not contain any
+   code that might be shared with other translation units (e.g. inline functions from QuantLib or boost headers). */
+
+#include <qle/math/randomvariable_kernels_impl.hpp>
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+namespace QuantExt {
+namespace detail {
+
+namespace {
+
+struct Avx512 {
+    using Reg = __m512d;
+    using Mask = __mmask8;
+    static constexpr std::size_t width = 8;
+
+    static Reg load(const double* x) { return _mm512_loadu_pd(x); }
+    static void store(double* x, Reg v) { _mm512_storeu_pd(x, v); }
+    static Reg set1(double v) { return _mm512_set1_pd(v); }
+
+    static Reg add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm512_sub_pd(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+    static Reg div(Reg a, Reg b) { return _mm512_div_pd(a, b); }
+    // same semantics as std::max(a, b) = a < b ? b : a and std::min(a, b) = b < a ? b : a, also for NaN
+    static Reg max(Reg a, Reg b) { return _mm512_max_pd(b, a); }
+    static Reg min(Reg a, Reg b) { return _mm512_min_pd(b, a); }
+    static Reg sqrt(Reg a) { return _mm512_sqrt_pd(a); }
+    static Reg neg(Reg a) {
+        return _mm512_castsi512_pd(
+            _mm512_xor_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL))));
+    }
+    static Reg abs(Reg a) { return _mm512_abs_pd(a); }
+    // a * b + c, c - a * b
+    static Reg fmadd(Reg a, Reg b, Reg c) { return _mm512_fmadd_pd(a, b, c); }
+    static Reg fnmadd(Reg a, Reg b, Reg c) { return _mm512_fnmadd_pd(a, b, c); }
+    static Reg round(Reg a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    // 2^n for integer valued n in [-1022, 1023]
+    static Reg pow2n(Reg n) {
+        __m512i b = _mm512_castpd_si512(_mm512_add_pd(n, _mm512_set1_pd(6755399441055744.0)));
+        b = _mm512_add_epi64(b, _mm512_set1_epi64(1023 - 0x4338000000000000LL));
+        return _mm512_castsi512_pd(_mm512_slli_epi64(b, 52));
+    }
+
+    // x = 2^e m with 1 <= m < 2 for positive normal x
+    static void decompose(Reg x, Reg& e, Reg& m) {
+        __m512i b = _mm512_castpd_si512(x);
+        __m512i ex = _mm512_srli_epi64(b, 52);
+        e = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(ex, _mm512_set1_epi64(0x4330000000000000LL))),
+                          _mm512_set1_pd(4503599627370496.0 + 1023.0));
+        m = _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(b, _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL)),
+                                                _mm512_set1_epi64(0x3FF0000000000000LL)));
+    }
+
+    static Mask lt(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static Mask le(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    static Mask gt(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static Mask ge(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+    static Mask eq(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+    static Mask bitAnd(Mask a, Mask b) { return a & b; }
+    static bool all(Mask m) { return m == 0xFF; }
+    static bool lane(Mask m, std::size_t j) { return (m >> j) & 1; }
+    // m ? a : b
+    static Reg blend(Mask m, Reg a, Reg b) { return _mm512_mask_blend_pd(m, b, a); }
+    static Mask loadMask(const bool* f) {
+        __m512i v = _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(f)));
+        return _mm512_test_epi64_mask(v, v);
+    }
+};
+
+} // namespace
+
+const RandomVariableKernelTable* avx512RandomVariableKernels() {
+    static const RandomVariableKernelTable table = VectorKernels<Avx512>::table("AVX512");
+    return &table;
+}
+
+} // namespace detail
+} // namespace QuantExt
+
+#else
+
+namespace QuantExt {
+namespace detail {
+const RandomVariableKernelTable* avx512RandomVariableKernels() { return nullptr; }
+} // namespace detail
+} // namespace QuantExt
+
+#endif
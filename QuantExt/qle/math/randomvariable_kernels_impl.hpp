@@ -0,0 +1,268 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_kernels_impl.hpp
+    \brief generic implementation of the vectorised random variable kernels
+
+    This header is included by the translation units compiled for a specific instruction set only. The kernels are
+    written against a type V providing the vector operations, see randomvariable_kernels_avx2.cpp for the interface.
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable_kerneltable.hpp>
+
+#include <cstddef>
+
+namespace QuantExt {
+namespace detail {
+
+// the scalar functions used for the values outside the domain of the vectorised approximations
+double scalarExp(const double x);
+double scalarLog(const double x);
+double scalarNormalCdf(const double x);
+double scalarNormalPdf(const double x);
+
+template <class V> struct VectorKernels {
+
+    using R = typename V::Reg;
+    using M = typename V::Mask;
+    static constexpr std::size_t w = V::width;
+
+    // loops over the full blocks and a padded tail, so that the result does not depend on the position of a value
+
+    template <class F> static void unary(double* x, std::size_t n, F f) {
+        std::size_t i = 0;
+        for (; i + w <= n; i += w)
+            V::store(x + i, f(V::load(x + i)));
+        if (i < n) {
+            double tmp[w];
+            for (std::size_t j = 0; j < w; ++j)
+                tmp[j] = i + j < n ? x[i + j] : 1.0;
+            V::store(tmp, f(V::load(tmp)));
+            for (std::size_t j = 0; i + j < n; ++j)
+                x[i + j] = tmp[j];
+        }
+    }
+
+    template <class F> static void binary(double* x, const double* y, std::size_t n, F f) {
+        std::size_t i = 0;
+        for (; i + w <= n; i += w)
+            V::store(x + i, f(V::load(x + i), V::load(y + i)));
+        if (i < n) {
+            double tmpx[w], tmpy[w];
+            for (std::size_t j = 0; j < w; ++j) {
+                tmpx[j] = i + j < n ? x[i + j] : 1.0;
+                tmpy[j] = i + j < n ? y[i + j] : 1.0;
+            }
+            V::store(tmpx, f(V::load(tmpx), V::load(tmpy)));
+            for (std::size_t j = 0; i + j < n; ++j)
+                x[i + j] = tmpx[j];
+        }
+    }
+
+    // as unary(), but lanes for which valid() is false are recomputed with the scalar function s
+
+    template <class F, class G, class S> static void unary(double* x, std::size_t n, F f, G valid, S s) {
+        unary(x, n, [&f, &valid, &s](R v) {
+            R r = f(v);
+            M m = valid(v);
+            if (!V::all(m)) {
+                double in[w], out[w];
+                V::store(in, v);
+                V::store(out, r);
+                for (std::size_t j = 0; j < w; ++j)
+                    if (!V::lane(m, j))
+                        out[j] = s(in[j]);
+                r = V::load(out);
+            }
+            return r;
+        });
+    }
+
+    // exp(x) for |x| <= 708, x = n ln2 + r with |r| <= ln2 / 2, exp(r) as Taylor polynomial of degree 13
+
+    static R expCore(R x) {
+        const R n = V::round(V::mul(x, V::set1(1.4426950408889634074)));
+        R r = V::fnmadd(n, V::set1(6.93147180369123816490e-01), x);
+        r = V::fnmadd(n, V::set1(1.90821492927058770002e-10), r);
+        static constexpr double c[] = {1.0 / 6227020800.0, 1.0 / 479001600.0, 1.0 / 39916800.0, 1.0 / 3628800.0,
+                                       1.0 / 362880.0,     1.0 / 40320.0,     1.0 / 5040.0,     1.0 / 720.0,
+                                       1.0 / 120.0,        1.0 / 24.0,        1.0 / 6.0,        0.5,
+                                       1.0,                1.0};
+        R p = V::set1(c[0]);
+        for (std::size_t k = 1; k < sizeof(c) / sizeof(double); ++k)
+            p = V::fmadd(p, r, V::set1(c[k]));
+        return V::mul(p, V::pow2n(n));
+    }
+
+    static M expValid(R x) { return V::le(V::abs(x), V::set1(708.0)); }
+
+    /* log(x) for positive normal x, x = 2^e m with sqrt(1/2) <= m < sqrt(2), log(m) = 2 atanh(s) with
+       s = (m - 1) / (m + 1), |s| <= 0.1716, as odd series in s up to degree 21 */
+
+    static R logCore(R x) {
+        R e, m;
+        V::decompose(x, e, m);
+        M big = V::gt(m, V::set1(1.4142135623730950488));
+        m = V::blend(big, V::mul(m, V::set1(0.5)), m);
+        e = V::blend(big, V::add(e, V::set1(1.0)), e);
+        R f = V::sub(m, V::set1(1.0));
+        R s = V::div(f, V::add(f, V::set1(2.0)));
+        R s2 = V::mul(s, s);
+        static constexpr double c[] = {1.0 / 21.0, 1.0 / 19.0, 1.0 / 17.0, 1.0 / 15.0, 1.0 / 13.0, 1.0 / 11.0,
+                                       1.0 / 9.0,  1.0 / 7.0,  1.0 / 5.0,  1.0 / 3.0};
+        R p = V::set1(c[0]);
+        for (std::size_t k = 1; k < sizeof(c) / sizeof(double); ++k)
+            p = V::fmadd(p, s2, V::set1(c[k]));
+        // log(m) = 2s + 2s s2 p
+        R twoS = V::add(s, s);
+        R logm = V::fmadd(V::mul(twoS, s2), p, twoS);
+        return V::fmadd(e, V::set1(6.93147180369123816490e-01),
+                        V::fmadd(e, V::set1(1.90821492927058770002e-10), logm));
+    }
+
+    static M logValid(R x) {
+        return V::bitAnd(V::ge(x, V::set1(2.2250738585072014e-308)), V::le(x, V::set1(1.7976931348623157e308)));
+    }
+
+    /* normal cdf, Hart's algorithm 5666 as given in G. West, "Better approximations to cumulative normal functions",
+       the relative error in the lower tail deteriorates below -3, these values are computed by the scalar function */
+
+    static R normalCdfCore(R x) {
+        R a = V::abs(x);
+        R ex = expCore(V::max(V::mul(V::mul(a, a), V::set1(-0.5)), V::set1(-708.0)));
+        static constexpr double pn[] = {3.52624965998911e-02, 0.700383064443688, 6.37396220353165, 33.912866078383,
+                                        112.079291497871,     221.213596169931,  220.206867912376};
+        static constexpr double pd[] = {8.83883476483184e-02, 1.75566716318264, 16.064177579207,  86.7807322029461,
+                                        296.564248779674,     637.333633378831, 793.826512519948, 440.413735824752};
+        R num = V::set1(pn[0]);
+        for (std::size_t k = 1; k < sizeof(pn) / sizeof(double); ++k)
+            num = V::fmadd(num, a, V::set1(pn[k]));
+        R den = V::set1(pd[0]);
+        for (std::size_t k = 1; k < sizeof(pd) / sizeof(double); ++k)
+            den = V::fmadd(den, a, V::set1(pd[k]));
+        R c1 = V::div(V::mul(ex, num), den);
+        R b = V::add(a, V::set1(0.65));
+        b = V::add(a, V::div(V::set1(4.0), b));
+        b = V::add(a, V::div(V::set1(3.0), b));
+        b = V::add(a, V::div(V::set1(2.0), b));
+        b = V::add(a, V::div(V::set1(1.0), b));
+        R c2 = V::div(ex, V::mul(b, V::set1(2.506628274631)));
+        R c = V::blend(V::lt(a, V::set1(7.07106781186547)), c1,
+                       V::blend(V::lt(a, V::set1(37.0)), c2, V::set1(0.0)));
+        return V::blend(V::gt(x, V::set1(0.0)), V::sub(V::set1(1.0), c), c);
+    }
+
+    static M normalCdfValid(R x) { return V::ge(x, V::set1(-3.0)); }
+
+    static R normalPdfCore(R x) {
+        return V::mul(expCore(V::mul(V::mul(x, x), V::set1(-0.5))), V::set1(0.39894228040143267794));
+    }
+
+    static M normalPdfValid(R x) { return V::le(V::abs(x), V::set1(37.6)); }
+
+    // the transcendental kernels
+
+    static void exp(double* x, std::size_t n) {
+        unary(x, n, [](R v) { return expCore(v); }, [](R v) { return expValid(v); }, scalarExp);
+    }
+    static void log(double* x, std::size_t n) {
+        unary(x, n, [](R v) { return logCore(v); }, [](R v) { return logValid(v); }, scalarLog);
+    }
+    static void normalCdf(double* x, std::size_t n) {
+        unary(x, n, [](R v) { return normalCdfCore(v); }, [](R v) { return normalCdfValid(v); }, scalarNormalCdf);
+    }
+    static void normalPdf(double* x, std::size_t n) {
+        unary(x, n, [](R v) { return normalPdfCore(v); }, [](R v) { return normalPdfValid(v); }, scalarNormalPdf);
+    }
+
+    static void select(double* x, const bool* f, const double* y, std::size_t n) {
+        std::size_t i = 0;
+        for (; i + w <= n; i += w)
+            V::store(x + i, V::blend(V::loadMask(f + i), V::load(x + i), V::load(y + i)));
+        for (; i < n; ++i)
+            x[i] = f[i] ? x[i] : y[i];
+    }
+
+    static void selectScalar(double* x, const bool* f, const double y, std::size_t n) {
+        std::size_t i = 0;
+        R yv = V::set1(y);
+        for (; i + w <= n; i += w)
+            V::store(x + i, V::blend(V::loadMask(f + i), V::load(x + i), yv));
+        for (; i < n; ++i)
+            x[i] = f[i] ? x[i] : y;
+    }
+
+    // the arithmetic kernels
+
+    static void add(double* x, const double* y, std::size_t n) {
+        binary(x, y, n, [](R a, R b) { return V::add(a, b); });
+    }
+    static void addScalar(double* x, const double y, std::size_t n) {
+        unary(x, n, [y](R a) { return V::add(a, V::set1(y)); });
+    }
+    static void subtract(double* x, const double* y, std::size_t n) {
+        binary(x, y, n, [](R a, R b) { return V::sub(a, b); });
+    }
+    static void subtractScalar(double* x, const double y, std::size_t n) {
+        unary(x, n, [y](R a) { return V::sub(a, V::set1(y)); });
+    }
+    static void multiply(double* x, const double* y, std::size_t n) {
+        binary(x, y, n, [](R a, R b) { return V::mul(a, b); });
+    }
+    static void multiplyScalar(double* x, const double y, std::size_t n) {
+        unary(x, n, [y](R a) { return V::mul(a, V::set1(y)); });
+    }
+    static void divide(double* x, const double* y, std::size_t n) {
+        binary(x, y, n, [](R a, R b) { return V::div(a, b); });
+    }
+    static void divideScalar(double* x, const double y, std::size_t n) {
+        unary(x, n, [y](R a) { return V::div(a, V::set1(y)); });
+    }
+    static void max(double* x, const double* y, std::size_t n) {
+        binary(x, y, n, [](R a, R b) { return V::max(a, b); });
+    }
+    static void maxScalar(double* x, const double y, std::size_t n) {
+        unary(x, n, [y](R a) { return V::max(a, V::set1(y)); });
+    }
+    static void min(double* x, const double* y, std::size_t n) {
+        binary(x, y, n, [](R a, R b) { return V::min(a, b); });
+    }
+    static void minScalar(double* x, const double y, std::size_t n) {
+        unary(x, n, [y](R a) { return V::min(a, V::set1(y)); });
+    }
+    static void negate(double* x, std::size_t n) {
+        unary(x, n, [](R a) { return V::neg(a); });
+    }
+    static void abs(double* x, std::size_t n) {
+        unary(x, n, [](R a) { return V::abs(a); });
+    }
+    static void sqrt(double* x, std::size_t n) {
+        unary(x, n, [](R a) { return V::sqrt(a); });
+    }
+
+    static RandomVariableKernelTable table(const char* name) {
+        return {name,      add,    addScalar, subtract, subtractScalar, multiply, multiplyScalar, divide,
+                divideScalar, max, maxScalar, min,      minScalar,      negate,   abs,            sqrt,
+                exp,       log,    normalCdf, normalPdf, select,        selectScalar};
+    }
+};
+
+} // namespace detail
+} // namespace QuantExt
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_kerneltable.hpp
+    \brief table of kernels operating on the data of random variables
+
+    This header is included by the translation units compiled for a specific instruction set. It must therefore only
+    contain declarations, and no inline functions or templates that might be instantiated in other translation units
+    as well, since the linker might pick the copy compiled for the extended instruction set.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace QuantExt {
+
+/*! Table of kernels operating on the raw data of non-deterministic random variables. All kernels work in place on
+    the first argument x of size n, the scalar variants take a constant second argument. */
+struct RandomVariableKernelTable {
+    const char* name;
+    // x[i] = x[i] op y[i] resp. x[i] = x[i] op y
+    void (*add)(double* x, const double* y, std::size_t n);
+    void (*addScalar)(double* x, const double y, std::size_t n);
+    void (*subtract)(double* x, const double* y, std::size_t n);
+    void (*subtractScalar)(double* x, const double y, std::size_t n);
+    void (*multiply)(double* x, const double* y, std::size_t n);
+    void (*multiplyScalar)(double* x, const double y, std::size_t n);
+    void (*divide)(double* x, const double* y, std::size_t n);
+    void (*divideScalar)(double* x, const double y, std::size_t n);
+    // x[i] = std::max(x[i], y[i]) resp. std::min(), same for the scalar variants
+    void (*max)(double* x, const double* y, std::size_t n);
+    void (*maxScalar)(double* x, const double y, std::size_t n);
+    void (*min)(double* x, const double* y, std::size_t n);
+    void (*minScalar)(double* x, const double y, std::size_t n);
+    // x[i] = f(x[i])
+    void (*negate)(double* x, std::size_t n);
+    void (*abs)(double* x, std::size_t n);
+    void (*sqrt)(double* x, std::size_t n);
+    void (*exp)(double* x, std::size_t n);
+    void (*log)(double* x, std::size_t n);
+    void (*normalCdf)(double* x, std::size_t n);
+    void (*normalPdf)(double* x, std::size_t n);
+    // x[i] = f[i] ? x[i] : y[i] resp. y
+    void (*select)(double* x, const bool* f, const double* y, std::size_t n);
+    void (*selectScalar)(double* x, const bool* f, const double y, std::size_t n);
+};
+
+namespace detail {
+// the kernel tables, the vectorised ones are null if not supported by the build
+const RandomVariableKernelTable* scalarRandomVariableKernels();
+const RandomVariableKernelTable* avx2RandomVariableKernels();
+const RandomVariableKernelTable* avx512RandomVariableKernels();
+} // namespace detail
+
+} // namespace QuantExt
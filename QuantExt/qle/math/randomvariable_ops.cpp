@@ -68,8 +68,9 @@ std::vector<RandomVariableOp> getRandomVariableOps(const Size size, const Size r
         if (regressor.empty())
             return expectation(*args[0]);
         else {
-            auto tmp = multiPathBasisSystem(regressor.size(), regressionOrder, polynomType, size);
-            return conditionalExpectation(*args[0], regressor, tmp, !close_enough(*args[1], RandomVariable(size, 0.0)));
+            return conditionalExpectation(*args[0],
+                                          multiPathBasisSystemValues(regressor, regressionOrder, polynomType, size),
+                                          !close_enough(*args[1], RandomVariable(size, 0.0)));
         }
     });
 
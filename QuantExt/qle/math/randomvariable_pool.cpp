@@ -0,0 +1,135 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/randomvariable_pool.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+
+namespace QuantExt {
+
+namespace {
+// trivially destructible, so that it can still be read during the destruction of thread local objects
+thread_local bool poolDestroyed = false;
+
+// all buffers are allocated and freed here, so that the memory held (in use or pooled) is accounted
+double* newData(const std::size_t n) {
+    double* p = new double[n];
+    MemoryAccounting::instance().allocate(MemoryAccounting::Category::RandomVariable, n * sizeof(double));
+    return p;
+}
+
+void deleteData(double* p, const std::size_t n) {
+    delete[] p;
+    MemoryAccounting::instance().release(MemoryAccounting::Category::RandomVariable, n * sizeof(double));
+}
+} // namespace
+
+RandomVariablePool& RandomVariablePool::instance() {
+    thread_local RandomVariablePool pool;
+    return pool;
+}
+
+RandomVariablePool::~RandomVariablePool() {
+    clear();
+    poolDestroyed = true;
+}
+
+double* RandomVariablePool::allocate(const std::size_t n) {
+    QL_REQUIRE(n > 0, "RandomVariablePool::allocate(): n must be positive");
+    for (auto& c : sizeClasses_) {
+        if (c.n == n) {
+            if (c.buffers.empty())
+                break;
+            double* p = c.buffers.back();
+            c.buffers.pop_back();
+            stats_.pooledBytes -= n * sizeof(double);
+            ++stats_.poolAllocations;
+            return p;
+        }
+    }
+    ++stats_.freshAllocations;
+    return newData(n);
+}
+
+void RandomVariablePool::release(double* p, const std::size_t n) {
+    if (p == nullptr)
+        return;
+    std::size_t bytes = n * sizeof(double);
+    if (stats_.pooledBytes + bytes > maxPooledBytes_) {
+        ++stats_.freedReleases;
+        deleteData(p, n);
+        return;
+    }
+    auto c = std::find_if(sizeClasses_.begin(), sizeClasses_.end(), [n](const SizeClass& c) { return c.n == n; });
+    if (c == sizeClasses_.end())
+        c = sizeClasses_.insert(sizeClasses_.end(), SizeClass{n, {}});
+    c->buffers.push_back(p);
+    ++stats_.pooledReleases;
+    stats_.pooledBytes += bytes;
+    stats_.peakPooledBytes = std::max(stats_.peakPooledBytes, stats_.pooledBytes);
+}
+
+void RandomVariablePool::clear() { shrink(0); }
+
+void RandomVariablePool::setMaxPooledBytes(const std::size_t maxPooledBytes) {
+    maxPooledBytes_ = maxPooledBytes;
+    shrink(maxPooledBytes);
+}
+
+void RandomVariablePool::resetStats() {
+    std::size_t pooledBytes = stats_.pooledBytes;
+    stats_ = RandomVariablePoolStats();
+    stats_.pooledBytes = stats_.peakPooledBytes = pooledBytes;
+}
+
+void RandomVariablePool::shrink(const std::size_t maxBytes) {
+    for (auto& c : sizeClasses_) {
+        while (stats_.pooledBytes > maxBytes && !c.buffers.empty()) {
+            deleteData(c.buffers.back(), c.n);
+            c.buffers.pop_back();
+            stats_.pooledBytes -= c.n * sizeof(double);
+        }
+    }
+    sizeClasses_.erase(std::remove_if(sizeClasses_.begin(), sizeClasses_.end(),
+                                      [](const SizeClass& c) { return c.buffers.empty(); }),
+                       sizeClasses_.end());
+}
+
+namespace detail {
+
+double* allocateRandomVariableData(const std::size_t n) {
+    if (poolDestroyed)
+        return newData(n);
+    return RandomVariablePool::instance().allocate(n);
+}
+
+void releaseRandomVariableData(double* p, const std::size_t n) {
+    if (poolDestroyed) {
+        if (p != nullptr)
+            deleteData(p, n);
+        return;
+    }
+    RandomVariablePool::instance().release(p, n);
+}
+
+} // namespace detail
+
+} // namespace QuantExt
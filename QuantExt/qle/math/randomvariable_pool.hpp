@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/randomvariable_pool.hpp
+    \brief thread local pool for the data buffers of random variables
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace QuantExt {
+
+//! Statistics of the random variable data pool of one thread
+struct RandomVariablePoolStats {
+    // allocations served from the pool resp. by a fresh allocation
+    std::size_t poolAllocations = 0;
+    std::size_t freshAllocations = 0;
+    // released buffers kept in the pool resp. freed because the pool was full or disabled
+    std::size_t pooledReleases = 0;
+    std::size_t freedReleases = 0;
+    // memory currently held by the pool and its maximum since the last reset of the stats
+    std::size_t pooledBytes = 0;
+    std::size_t peakPooledBytes = 0;
+};
+
+//! Thread local pool of the data buffers of RandomVariable
+/*! The buffers released by RandomVariable (on destruction, clear(), setAll() or via RandomVariable::deleter) are kept
+    in a free list per buffer size and handed out again on the next allocation of the same size, e.g. when a temporary
+    random variable is expanded. Since all variables in a simulation share the sample size, there are typically only
+    a few size classes.
+
+    The memory held by the pool of a thread is bounded by maxPooledBytes(), buffers released beyond this bound are
+    freed. A bound of zero disables the pooling. Each thread owns its pool, buffers may be released on a different
+    thread than they were allocated on. */
+class RandomVariablePool {
+public:
+    //! the pool of the current thread
+    static RandomVariablePool& instance();
+
+    ~RandomVariablePool();
+    RandomVariablePool(const RandomVariablePool&) = delete;
+    RandomVariablePool& operator=(const RandomVariablePool&) = delete;
+
+    //! returns a buffer of size n > 0, the content is uninitialised
+    double* allocate(const std::size_t n);
+    //! returns a buffer of size n, obtained from allocate() on any thread, to the pool
+    void release(double* p, const std::size_t n);
+
+    //! free all pooled buffers
+    void clear();
+
+    //! the default bound is 256 MB per thread, reducing the bound frees pooled buffers as required
+    void setMaxPooledBytes(const std::size_t maxPooledBytes);
+    std::size_t maxPooledBytes() const { return maxPooledBytes_; }
+
+    const RandomVariablePoolStats& stats() const { return stats_; }
+    void resetStats();
+
+private:
+    RandomVariablePool() = default;
+    void shrink(const std::size_t maxBytes);
+
+    struct SizeClass {
+        std::size_t n;
+        std::vector<double*> buffers;
+    };
+    std::vector<SizeClass> sizeClasses_;
+    std::size_t maxPooledBytes_ = 256 * 1024 * 1024;
+    RandomVariablePoolStats stats_;
+};
+
+namespace detail {
+// used by RandomVariable, these fall back to new / delete during the destruction of the thread's pool
+double* allocateRandomVariableData(const std::size_t n);
+void releaseRandomVariableData(double* p, const std::size_t n);
+} // namespace detail
+
+} // namespace QuantExt
@@ -22,6 +22,7 @@
 
 #include <boost/math/special_functions/binomial.hpp>
 
+#include <map>
 #include <numeric>
 #include <set>
 
@@ -231,6 +232,61 @@ VF_A RandomVariableLsmBasisSystem::multiPathBasisSystem(Size dim, Size order,
     return ret;
 }
 
+std::vector<RandomVariable>
+RandomVariableLsmBasisSystem::multiPathBasisSystemValues(const std::vector<const RandomVariable*>& regressor,
+                                                         Size order, QuantLib::LsmBasisSystem::PolynomialType type) {
+    const Size dim = regressor.size();
+    QL_REQUIRE(dim > 0, "zero dimension");
+
+    // univariate values p_i(x_k), i = 0, ..., order, monomials are built up incrementally
+
+    std::vector<std::vector<RandomVariable>> pathValues(dim, std::vector<RandomVariable>(order + 1));
+    VF_R pathBasis;
+    if (type != QuantLib::LsmBasisSystem::Monomial)
+        pathBasis = pathBasisSystem(order, type);
+    for (Size k = 0; k < dim; ++k) {
+        for (Size i = 0; i <= order; ++i) {
+            if (type != QuantLib::LsmBasisSystem::Monomial)
+                pathValues[k][i] = pathBasis[i](*regressor[k]);
+            else if (i == 0)
+                pathValues[k][i] = RandomVariable(regressor[k]->size(), 1.0);
+            else if (i == 1)
+                pathValues[k][i] = *regressor[k];
+            else
+                pathValues[k][i] = pathValues[k][i - 1] * *regressor[k];
+        }
+    }
+
+    /* the value for a tuple t is the product p_t[0](x_0) * ... * p_t[dim-1](x_{dim-1}), we store the partial products
+       for all prefixes t[0], ..., t[j] that occur, so that each of them is computed by a single multiplication */
+
+    std::map<std::vector<Size>, RandomVariable> prefixValues;
+    auto value = [&pathValues, &prefixValues, dim](const std::vector<Size>& t) {
+        std::vector<Size> prefix(1, t[0]);
+        const RandomVariable* v = &pathValues[0][t[0]];
+        for (Size j = 1; j < dim; ++j) {
+            prefix.push_back(t[j]);
+            auto p = prefixValues.find(prefix);
+            if (p == prefixValues.end())
+                p = prefixValues.insert(std::make_pair(prefix, *v * pathValues[j][t[j]])).first;
+            v = &p->second;
+        }
+        return *v;
+    };
+
+    // same order of the tuples as in multiPathBasisSystem()
+
+    std::vector<RandomVariable> ret;
+    VV tuples(1, std::vector<Size>(dim));
+    ret.push_back(value(tuples.front()));
+    for (Size i = 1; i <= order; ++i) {
+        tuples = next_order_tuples(tuples);
+        for (Size j = 0; j < tuples.size(); ++j)
+            ret.push_back(value(tuples[j]));
+    }
+    return ret;
+}
+
 Real RandomVariableLsmBasisSystem::size(Size dim, Size order) {
     // see e.g. proposition 3 in https://murphmath.wordpress.com/2012/08/22/counting-monomials/
     return boost::math::binomial_coefficient<Real>(
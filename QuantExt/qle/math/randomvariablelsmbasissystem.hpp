@@ -39,6 +39,14 @@ public:
     static std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>
     multiPathBasisSystem(Size dim, Size order, QuantLib::LsmBasisSystem::PolynomialType type);
 
+    /* returns the values of the basis functions of multiPathBasisSystem(regressor.size(), order, type) evaluated at
+       the regressor, in the same order. The values are computed incrementally, the univariate polynomials are
+       evaluated once per regressor and each basis function value is obtained from a lower order product by a single
+       multiplication, which is much cheaper than evaluating the basis functions one by one for higher dimensions. */
+    static std::vector<RandomVariable> multiPathBasisSystemValues(const std::vector<const RandomVariable*>& regressor,
+                                                                  Size order,
+                                                                  QuantLib::LsmBasisSystem::PolynomialType type);
+
     // return the size of a basis system (or std::numeric_limits<Real>::infinity() if too big)
     static Real size(Size dim, Size order);
 };
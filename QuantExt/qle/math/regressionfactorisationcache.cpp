@@ -0,0 +1,116 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/regressionfactorisationcache.hpp>
+
+#include <boost/functional/hash.hpp>
+
+namespace QuantExt {
+
+namespace {
+std::size_t regressionHash(const std::vector<const RandomVariable*>& regressor, const Size polynomOrder,
+                           const QuantLib::LsmBasisSystem::PolynomialType polynomType, const Filter& filter) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, polynomOrder);
+    boost::hash_combine(seed, static_cast<int>(polynomType));
+    boost::hash_combine(seed, regressor.size());
+    for (auto const r : regressor) {
+        boost::hash_combine(seed, r->size());
+        for (Size i = 0; i < r->size(); ++i)
+            boost::hash_combine(seed, (*r)[i]);
+    }
+    boost::hash_combine(seed, filter.size());
+    for (Size i = 0; i < filter.size(); ++i)
+        boost::hash_combine(seed, filter[i]);
+    return seed;
+}
+
+bool sameRegression(const std::vector<RandomVariable>& r1, const Filter& f1,
+                    const std::vector<const RandomVariable*>& r2, const Filter& f2) {
+    if (r1.size() != r2.size() || f1 != f2)
+        return false;
+    for (Size i = 0; i < r1.size(); ++i) {
+        if (!(r1[i] == *r2[i]))
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+QuantLib::ext::shared_ptr<const QrRegressionFactorisation>
+RegressionFactorisationCache::factorisation(const std::vector<const RandomVariable*>& regressor,
+                                            const Size polynomOrder,
+                                            const QuantLib::LsmBasisSystem::PolynomialType polynomType,
+                                            const Filter& filter) {
+    std::size_t hash = regressionHash(regressor, polynomOrder, polynomType, filter);
+    auto range = index_.equal_range(hash);
+    for (auto e = range.first; e != range.second; ++e) {
+        const Entry& entry = *e->second;
+        if (entry.polynomOrder == polynomOrder && entry.polynomType == polynomType &&
+            sameRegression(entry.regressor, entry.filter, regressor, filter)) {
+            lru_.splice(lru_.begin(), lru_, e->second);
+            ++hits_;
+            return entry.factorisation;
+        }
+    }
+    auto factorisation = QuantLib::ext::make_shared<const QrRegressionFactorisation>(
+        qrRegressionFactorisation(multiPathBasisSystemValues(regressor, polynomOrder, polynomType), filter));
+    Size n = regressor.empty() ? 0 : regressor.front()->size();
+    Size memory = (regressor.size() * n + factorisation->rows() * factorisation->columns() +
+                   factorisation->columns() * factorisation->columns()) *
+                      sizeof(Real) +
+                  filter.size() * sizeof(bool);
+    if (memory > maxMemory_)
+        return factorisation;
+    std::vector<RandomVariable> regressorCopy;
+    for (auto const r : regressor)
+        regressorCopy.push_back(*r);
+    lru_.push_front(Entry{hash, std::move(regressorCopy), filter, polynomOrder, polynomType, factorisation, memory});
+    index_.insert(std::make_pair(hash, lru_.begin()));
+    memory_ += memory;
+    shrink();
+    return factorisation;
+}
+
+void RegressionFactorisationCache::setMaxMemory(const Size maxMemory) {
+    maxMemory_ = maxMemory;
+    shrink();
+}
+
+void RegressionFactorisationCache::clear() {
+    index_.clear();
+    lru_.clear();
+    memory_ = 0;
+    hits_ = 0;
+}
+
+void RegressionFactorisationCache::shrink() {
+    while (memory_ > maxMemory_) {
+        auto range = index_.equal_range(lru_.back().hash);
+        for (auto e = range.first; e != range.second; ++e) {
+            if (e->second == std::prev(lru_.end())) {
+                index_.erase(e);
+                break;
+            }
+        }
+        memory_ -= lru_.back().memory;
+        lru_.pop_back();
+    }
+}
+
+} // namespace QuantExt
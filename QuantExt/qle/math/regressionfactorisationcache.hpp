@@ -0,0 +1,84 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/regressionfactorisationcache.hpp
+    \brief cache for qr factorisations of regression design matrices shared between amc trades
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/methods/montecarlo/lsmbasissystem.hpp>
+#include <ql/patterns/singleton.hpp>
+
+#include <list>
+#include <unordered_map>
+
+namespace QuantExt {
+
+/*! Cache for the QR factorisations of regression design matrices. Regressions with the same regressor values, basis
+    system and filter share one factorisation, only the right hand side differs between them. This is the case for
+    trades with the same exercise or xva observation times which are priced on the same calibration paths, see
+    McMultiLegBaseEngine for a usage example.
+
+    An entry is identified by a hash of the regressor and filter values, a hit is confirmed by comparing the values
+    with a copy stored in the cache, i.e. a factorisation is never used for a regression with different input data.
+    If the memory used by the entries exceeds maxMemory(), the least recently used entries are removed. This is a
+    session singleton. */
+class RegressionFactorisationCache : public QuantLib::Singleton<RegressionFactorisationCache> {
+    friend class QuantLib::Singleton<RegressionFactorisationCache>;
+    RegressionFactorisationCache() = default;
+
+public:
+    //! get the factorisation, it is built if it is not yet in the cache
+    QuantLib::ext::shared_ptr<const QrRegressionFactorisation>
+    factorisation(const std::vector<const RandomVariable*>& regressor, const Size polynomOrder,
+                  const QuantLib::LsmBasisSystem::PolynomialType polynomType, const Filter& filter = Filter());
+    //! number of cached factorisations
+    Size size() const { return lru_.size(); }
+    //! number of requests that were served from the cache
+    Size hits() const { return hits_; }
+    //! memory used by the cached entries in bytes
+    Size memory() const { return memory_; }
+    //! maximum memory used by the cached entries in bytes, defaults to 512 MB
+    Size maxMemory() const { return maxMemory_; }
+    void setMaxMemory(const Size maxMemory);
+    //! remove all entries from the cache and reset the hit counter
+    void clear();
+
+private:
+    struct Entry {
+        std::size_t hash;
+        std::vector<RandomVariable> regressor;
+        Filter filter;
+        Size polynomOrder;
+        QuantLib::LsmBasisSystem::PolynomialType polynomType;
+        QuantLib::ext::shared_ptr<const QrRegressionFactorisation> factorisation;
+        Size memory;
+    };
+    using LruList = std::list<Entry>;
+    void shrink();
+    LruList lru_;
+    std::unordered_multimap<std::size_t, LruList::iterator> index_;
+    Size memory_ = 0;
+    Size maxMemory_ = 512 * 1024 * 1024;
+    Size hits_ = 0;
+};
+
+} // namespace QuantExt
@@ -0,0 +1,501 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/math/randomvariable_ops.hpp>
+#include <qle/math/shardedcomputeenvironment.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/timer/timer.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <set>
+
+namespace QuantExt {
+
+ShardedComputeContext::ShardedComputeContext(const std::vector<ComputeContext*>& devices,
+                                             const std::vector<std::string>& deviceNames)
+    : devices_(devices), deviceNames_(deviceNames), workers_(devices.size()) {
+    QL_REQUIRE(!devices_.empty(), "ShardedComputeContext: no devices given");
+    QL_REQUIRE(devices_.size() == deviceNames_.size(), "ShardedComputeContext: number of devices ("
+                                                           << devices_.size() << ") does not match number of names ("
+                                                           << deviceNames_.size() << ")");
+    for (std::size_t i = 0; i < devices_.size(); ++i) {
+        QL_REQUIRE(devices_[i] != nullptr, "ShardedComputeContext: device '" << deviceNames_[i] << "' is null");
+        QL_REQUIRE(std::count(devices_.begin(), devices_.end(), devices_[i]) == 1,
+                   "ShardedComputeContext: device '" << deviceNames_[i] << "' is given more than once");
+    }
+}
+
+void ShardedComputeContext::init() {
+
+    if (initialized_) {
+        return;
+    }
+
+    for (auto d : devices_)
+        d->init();
+
+    hostDebugInfo_ = DebugInfo();
+
+    initialized_ = true;
+}
+
+void ShardedComputeContext::disposeCalculation(const std::size_t id) {
+    QL_REQUIRE(id > 0 && id <= calculations_.size(), "ShardedComputeContext::disposeCalculation(): id ("
+                                                          << id << ") invalid, got 1..." << calculations_.size());
+    auto& c = calculations_[id - 1];
+    QL_REQUIRE(!c.disposed, "ShardedComputeContext::disposeCalculation(): id " << id << " was already disposed.");
+    for (auto const& s : c.childIds) {
+        for (std::size_t d = 0; d < s.size(); ++d) {
+            if (s[d] != 0)
+                devices_[d]->disposeCalculation(s[d]);
+        }
+    }
+    c.program.clear();
+    c.stages.clear();
+    c.childIds.clear();
+    c.disposed = true;
+}
+
+std::pair<std::size_t, bool> ShardedComputeContext::initiateCalculation(const std::size_t n, const std::size_t id,
+                                                                        const std::size_t version,
+                                                                        const Settings settings) {
+
+    QL_REQUIRE(n > 0, "ShardedComputeContext::initiateCalculation(): n must not be zero");
+
+    newCalc_ = false;
+    settings_ = settings;
+
+    if (id == 0) {
+
+        // initiate new calculation, split the samples into one shard per device
+
+        Calculation c;
+        c.size = n;
+        c.version = version;
+        std::size_t shardSize = ((n + devices_.size() - 1) / devices_.size() + 7) / 8 * 8;
+        for (std::size_t o = 0; o < n; o += shardSize) {
+            c.shardOffset.push_back(o);
+            c.shardSize.push_back(std::min(shardSize, n - o));
+        }
+        calculations_.push_back(c);
+
+        currentId_ = calculations_.size();
+        newCalc_ = true;
+
+    } else {
+
+        // initiate calculation on existing id
+
+        QL_REQUIRE(id <= calculations_.size(), "ShardedComputeContext::initiateCalculation(): id ("
+                                                   << id << ") invalid, got 1..." << calculations_.size());
+        auto& c = calculations_[id - 1];
+        QL_REQUIRE(c.size == n, "ShardedComputeContext::initiateCalculation(): size ("
+                                    << c.size << ") for id " << id << " does not match current size (" << n << ")");
+        QL_REQUIRE(!c.disposed, "ShardedComputeContext::initiateCalculation(): id ("
+                                    << id << ") was already disposed, it can not be used any more.");
+
+        if (version != c.version) {
+            // the child calcs are kept, they are rebuilt since they are initiated with the new version
+            c.version = version;
+            c.program.clear();
+            c.stages.clear();
+            c.numberOfVariates = 0;
+            c.numberOfVars = 0;
+            c.outputVars.clear();
+            newCalc_ = true;
+        }
+
+        currentId_ = id;
+    }
+
+    // reset variables
+
+    calculations_[currentId_ - 1].numberOfInputVars = 0;
+    inputs_.clear();
+    inputIsScalar_.clear();
+
+    // set state
+
+    currentState_ = ComputeState::createInput;
+
+    // return calc id
+
+    return std::make_pair(currentId_, newCalc_);
+}
+
+std::size_t ShardedComputeContext::createInputVariable(double v) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput,
+               "ShardedComputeContext::createInputVariable(): not in state createInput ("
+                   << static_cast<int>(currentState_) << ")");
+    auto& c = calculations_[currentId_ - 1];
+    inputs_.push_back(RandomVariable(c.size, v));
+    inputIsScalar_.push_back(true);
+    return c.numberOfInputVars++;
+}
+
+std::size_t ShardedComputeContext::createInputVariable(double* v) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput,
+               "ShardedComputeContext::createInputVariable(): not in state createInput ("
+                   << static_cast<int>(currentState_) << ")");
+    auto& c = calculations_[currentId_ - 1];
+    inputs_.push_back(RandomVariable(c.size, v));
+    inputs_.back().expand();
+    inputIsScalar_.push_back(false);
+    return c.numberOfInputVars++;
+}
+
+std::vector<std::vector<std::size_t>> ShardedComputeContext::createInputVariates(const std::size_t dim,
+                                                                                 const std::size_t steps) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput || currentState_ == ComputeState::createVariates,
+               "ShardedComputeContext::createInputVariates(): not in state createInput or createVariates ("
+                   << static_cast<int>(currentState_) << ")");
+    QL_REQUIRE(currentId_ > 0, "ShardedComputeContext::createInputVariates(): current id is not set");
+    auto& c = calculations_[currentId_ - 1];
+    QL_REQUIRE(newCalc_, "ShardedComputeContext::createInputVariates(): id (" << currentId_ << ") in version "
+                                                                              << c.version << " is replayed.");
+    currentState_ = ComputeState::createVariates;
+
+    // same stream as in the BasicCpu contexts, the devices get the slices of their shards
+
+    if (rng_ == nullptr) {
+        rng_ = std::make_unique<QuantLib::MersenneTwisterUniformRng>(settings_.rngSeed);
+    }
+
+    for (std::size_t i = variates_.size(); i < c.numberOfVariates + dim * steps; ++i) {
+        variates_.push_back(RandomVariable(c.size));
+        variates_.back().expand();
+        for (std::size_t j = 0; j < c.size; ++j)
+            variates_.back().data()[j] = icn_(rng_->nextReal());
+    }
+
+    std::vector<std::vector<std::size_t>> resultIds(dim, std::vector<std::size_t>(steps));
+    for (std::size_t i = 0; i < dim; ++i) {
+        for (std::size_t j = 0; j < steps; ++j) {
+            resultIds[i][j] = c.numberOfInputVars + c.numberOfVariates + j * dim + i;
+        }
+    }
+
+    c.numberOfVariates += dim * steps;
+
+    return resultIds;
+}
+
+std::size_t ShardedComputeContext::applyOperation(const std::size_t randomVariableOpCode,
+                                                  const std::vector<std::size_t>& args) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput || currentState_ == ComputeState::createVariates ||
+                   currentState_ == ComputeState::calc,
+               "ShardedComputeContext::applyOperation(): not in state createInput or calc ("
+                   << static_cast<int>(currentState_) << ")");
+    currentState_ = ComputeState::calc;
+    QL_REQUIRE(currentId_ > 0, "ShardedComputeContext::applyOperation(): current id is not set");
+    auto& c = calculations_[currentId_ - 1];
+    QL_REQUIRE(newCalc_, "ShardedComputeContext::applyOperation(): id (" << currentId_ << ") in version "
+                                                                         << c.version << " is replayed.");
+
+    /* the ids are not reused, so that every id is defined once in the program, the devices manage their own
+       variables and reuse them */
+
+    std::size_t resultId = c.numberOfInputVars + c.numberOfVariates + c.numberOfVars++;
+    for (auto a : args) {
+        QL_REQUIRE(a < resultId, "ShardedComputeContext::applyOperation(): argument id " << a << " invalid, got 0..."
+                                                                                          << resultId - 1);
+    }
+    c.program.push_back({randomVariableOpCode, args, resultId});
+
+    // the ops on the devices are counted by them
+
+    if (settings_.debug && randomVariableOpCode == RandomVariableOpCode::ConditionalExpectation)
+        hostDebugInfo_.numberOfOperations += c.size;
+
+    return resultId;
+}
+
+void ShardedComputeContext::freeVariable(const std::size_t id) {
+    QL_REQUIRE(currentState_ == ComputeState::calc,
+               "ShardedComputeContext::free(): not in state calc (" << static_cast<int>(currentState_) << ")");
+    QL_REQUIRE(currentId_ > 0, "ShardedComputeContext::freeVariable(): current id is not set");
+    QL_REQUIRE(newCalc_, "ShardedComputeContext::freeVariable(): id ("
+                             << currentId_ << ") in version " << calculations_[currentId_ - 1].version
+                             << " is replayed.");
+
+    // nothing to do, the variables on the devices are freed after their last use in a stage
+}
+
+void ShardedComputeContext::declareOutputVariable(const std::size_t id) {
+    QL_REQUIRE(currentState_ != ComputeState::idle, "ShardedComputeContext::declareOutputVariable(): state is idle");
+    QL_REQUIRE(currentId_ > 0, "ShardedComputeContext::declareOutputVariable(): current id not set");
+    auto& c = calculations_[currentId_ - 1];
+    QL_REQUIRE(newCalc_, "ShardedComputeContext::declareOutputVariable(): id ("
+                             << currentId_ << ") in version " << c.version << " is replayed.");
+    c.outputVars.push_back(id);
+}
+
+void ShardedComputeContext::analyseProgram(Calculation& c) const {
+    constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+    const auto& p = c.program;
+    const std::size_t nIds = c.numberOfInputVars + c.numberOfVariates + c.numberOfVars;
+
+    std::vector<bool> isOutput(nIds, false);
+    for (auto o : c.outputVars)
+        isOutput[o] = true;
+
+    // the defining op and the last op using an id
+
+    std::vector<std::size_t> definingOp(nIds, none), lastUse(nIds, none);
+    for (std::size_t k = 0; k < p.size(); ++k) {
+        definingOp[p[k].resultId] = k;
+        for (auto a : p[k].args)
+            lastUse[a] = k;
+    }
+
+    // split the program at the conditional expectations
+
+    c.stages.clear();
+    std::vector<std::size_t> opStage(p.size());
+    for (std::size_t b = 0;;) {
+        std::size_t e = b;
+        while (e < p.size() && p[e].code != RandomVariableOpCode::ConditionalExpectation)
+            ++e;
+        for (std::size_t k = b; k < std::min(e + 1, p.size()); ++k)
+            opStage[k] = c.stages.size();
+        c.stages.push_back(Stage{b, e, {}, {}, {}, {}});
+        if (e >= p.size())
+            break;
+        b = e + 1;
+    }
+
+    for (std::size_t s = 0; s < c.stages.size(); ++s) {
+        auto& stage = c.stages[s];
+        std::set<std::size_t> inputs, outputs;
+        for (std::size_t k = stage.begin; k < stage.end; ++k) {
+            for (auto a : p[k].args) {
+                if (definingOp[a] == none || definingOp[a] < stage.begin)
+                    inputs.insert(a);
+            }
+            std::size_t r = p[k].resultId;
+            if (isOutput[r] || (lastUse[r] != none && lastUse[r] >= stage.end))
+                outputs.insert(r);
+        }
+        stage.inputs.assign(inputs.begin(), inputs.end());
+        stage.outputs.assign(outputs.begin(), outputs.end());
+
+        // going backwards, the first occurrence of a variable local to the device is its last use in the stage
+
+        stage.frees.resize(stage.end - stage.begin);
+        std::set<std::size_t> seen;
+        for (std::size_t k = stage.end; k > stage.begin; --k) {
+            auto& frees = stage.frees[k - 1 - stage.begin];
+            std::size_t r = p[k - 1].resultId;
+            if (seen.insert(r).second && outputs.find(r) == outputs.end())
+                frees.push_back(r);
+            for (auto a : p[k - 1].args) {
+                if (seen.insert(a).second && outputs.find(a) == outputs.end())
+                    frees.push_back(a);
+            }
+        }
+    }
+
+    // host values (stage outputs, conditional expectations) are released after the stage of their last use
+
+    for (std::size_t s = 0; s < c.stages.size(); ++s) {
+        std::vector<std::size_t> ids(c.stages[s].outputs);
+        if (c.stages[s].end < p.size())
+            ids.push_back(p[c.stages[s].end].resultId);
+        for (auto r : ids) {
+            if (!isOutput[r])
+                c.stages[lastUse[r] == none ? s : opStage[lastUse[r]]].releases.push_back(r);
+        }
+    }
+
+    // the child calc ids of previous versions are kept
+
+    for (std::size_t s = c.stages.size(); s < c.childIds.size(); ++s) {
+        for (std::size_t d = 0; d < c.childIds[s].size(); ++d) {
+            if (c.childIds[s][d] != 0)
+                devices_[d]->disposeCalculation(c.childIds[s][d]);
+        }
+    }
+    c.childIds.resize(c.stages.size(), std::vector<std::size_t>(c.shardSize.size(), 0));
+}
+
+const RandomVariable& ShardedComputeContext::value(const Calculation& c, const std::size_t id) const {
+    if (id < c.numberOfInputVars)
+        return inputs_[id];
+    else if (id < c.numberOfInputVars + c.numberOfVariates)
+        return variates_[id - c.numberOfInputVars];
+    else
+        return hostValues_[id - c.numberOfInputVars - c.numberOfVariates];
+}
+
+RandomVariable& ShardedComputeContext::hostValue(const Calculation& c, const std::size_t id) {
+    QL_REQUIRE(id >= c.numberOfInputVars + c.numberOfVariates,
+               "ShardedComputeContext::finalizeCalculation(): internal error, id "
+                   << id << " does not fall into the host values array.");
+    return hostValues_[id - c.numberOfInputVars - c.numberOfVariates];
+}
+
+void ShardedComputeContext::runStage(Calculation& c, const std::size_t s, const std::size_t d) {
+    const auto& stage = c.stages[s];
+    const auto& p = c.program;
+    ComputeContext& device = *devices_[d];
+    const std::size_t offset = c.shardOffset[d];
+
+    auto [childId, newChildCalc] = device.initiateCalculation(c.shardSize[d], c.childIds[s][d], c.version, settings_);
+    c.childIds[s][d] = childId;
+
+    // the stage inputs are passed as slices of the host values, scalar inputs of the calc are passed as scalars
+
+    std::vector<std::size_t> deviceId(c.numberOfInputVars + c.numberOfVariates + c.numberOfVars);
+    for (auto i : stage.inputs) {
+        const RandomVariable& v = value(c, i);
+        QL_REQUIRE(v.initialised(), "ShardedComputeContext::finalizeCalculation(): internal error, input "
+                                        << i << " of stage " << s << " is not initialised.");
+        if (i < c.numberOfInputVars && inputIsScalar_[i])
+            deviceId[i] = device.createInputVariable(v[0]);
+        else
+            deviceId[i] = device.createInputVariable(const_cast<double*>(v.data()) + offset);
+    }
+
+    if (newChildCalc) {
+        std::vector<std::size_t> args;
+        for (std::size_t k = stage.begin; k < stage.end; ++k) {
+            args.resize(p[k].args.size());
+            std::transform(p[k].args.begin(), p[k].args.end(), args.begin(),
+                           [&deviceId](const std::size_t a) { return deviceId[a]; });
+            deviceId[p[k].resultId] = device.applyOperation(p[k].code, args);
+            for (auto f : stage.frees[k - stage.begin])
+                device.freeVariable(deviceId[f]);
+        }
+        for (auto o : stage.outputs)
+            device.declareOutputVariable(deviceId[o]);
+    }
+
+    // the device writes its shard of the stage outputs into the host values
+
+    std::vector<double*> output(stage.outputs.size());
+    for (std::size_t i = 0; i < stage.outputs.size(); ++i)
+        output[i] = hostValues_[stage.outputs[i] - c.numberOfInputVars - c.numberOfVariates].data() + offset;
+    device.finalizeCalculation(output);
+}
+
+void ShardedComputeContext::finalizeCalculation(std::vector<double*>& output) {
+    struct exitGuard {
+        exitGuard() {}
+        ~exitGuard() {
+            *currentState = ComputeState::idle;
+            hostValues->clear();
+        }
+        ComputeState* currentState;
+        std::vector<RandomVariable>* hostValues;
+    } guard;
+
+    guard.currentState = &currentState_;
+    guard.hostValues = &hostValues_;
+
+    QL_REQUIRE(currentId_ > 0, "ShardedComputeContext::finalizeCalculation(): current id is not set");
+    auto& c = calculations_[currentId_ - 1];
+    QL_REQUIRE(output.size() == c.outputVars.size(), "ShardedComputeContext::finalizeCalculation(): output size ("
+                                                         << output.size() << ") inconsistent to kernel output size ("
+                                                         << c.outputVars.size() << ")");
+
+    if (c.stages.empty())
+        analyseProgram(c);
+
+    auto ops = getRandomVariableOps(c.size, settings_.regressionOrder);
+
+    hostValues_.assign(c.numberOfVars, RandomVariable());
+
+    for (std::size_t s = 0; s < c.stages.size(); ++s) {
+        const auto& stage = c.stages[s];
+
+        // run the device ops of the stage on all shards in parallel
+
+        if (stage.begin < stage.end && !stage.outputs.empty()) {
+            for (auto i : stage.inputs) {
+                if (i >= c.numberOfInputVars + c.numberOfVariates)
+                    hostValue(c, i).expand();
+            }
+            for (auto o : stage.outputs) {
+                hostValue(c, o) = RandomVariable(c.size);
+                hostValue(c, o).expand();
+            }
+            workers_.run(c.shardSize.size(), [this, &c, s](const std::size_t d) { runStage(c, s, d); });
+        }
+
+        // the conditional expectation closing the stage is calculated on the host over all samples
+
+        if (stage.end < c.program.size()) {
+            boost::timer::cpu_timer timer;
+            const auto& op = c.program[stage.end];
+            std::vector<const RandomVariable*> args(op.args.size());
+            for (std::size_t j = 0; j < op.args.size(); ++j)
+                args[j] = &value(c, op.args[j]);
+            hostValue(c, op.resultId) = ops[op.code](args);
+            if (settings_.debug)
+                hostDebugInfo_.nanoSecondsCalculation += timer.elapsed().wall;
+        }
+
+        for (auto r : stage.releases)
+            hostValue(c, r).clear();
+    }
+
+    // fill output
+
+    for (std::size_t i = 0; i < c.outputVars.size(); ++i) {
+        const RandomVariable& v = value(c, c.outputVars[i]);
+        QL_REQUIRE(v.initialised(), "ShardedComputeContext::finalizeCalculation(): output variable "
+                                        << c.outputVars[i] << " is not initialised.");
+        for (std::size_t j = 0; j < c.size; ++j)
+            output[i][j] = v[j];
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> ShardedComputeContext::deviceInfo() const {
+    std::vector<std::pair<std::string, std::string>> result;
+    for (std::size_t d = 0; d < devices_.size(); ++d) {
+        result.push_back(std::make_pair("shard " + std::to_string(d), deviceNames_[d]));
+        for (auto const& [key, value] : devices_[d]->deviceInfo())
+            result.push_back(std::make_pair("shard " + std::to_string(d) + " " + key, value));
+    }
+    return result;
+}
+
+bool ShardedComputeContext::supportsDoublePrecision() const {
+    return std::all_of(devices_.begin(), devices_.end(),
+                       [](const ComputeContext* d) { return d->supportsDoublePrecision(); });
+}
+
+const ComputeContext::DebugInfo& ShardedComputeContext::debugInfo() const {
+    debugInfo_ = hostDebugInfo_;
+    for (auto d : devices_) {
+        auto const& info = d->debugInfo();
+        debugInfo_.numberOfOperations += info.numberOfOperations;
+        debugInfo_.nanoSecondsDataCopy += info.nanoSecondsDataCopy;
+        debugInfo_.nanoSecondsProgramBuild += info.nanoSecondsProgramBuild;
+        debugInfo_.nanoSecondsCalculation += info.nanoSecondsCalculation;
+        debugInfo_.numberOfFusedOperations += info.numberOfFusedOperations;
+        debugInfo_.bytesMemoryTrafficSaved += info.bytesMemoryTrafficSaved;
+    }
+    return debugInfo_;
+}
+
+} // namespace QuantExt
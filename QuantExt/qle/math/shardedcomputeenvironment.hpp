@@ -0,0 +1,141 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/shardedcomputeenvironment.hpp
+    \brief compute context splitting the samples of a calculation over several devices
+*/
+
+#pragma once
+
+#include <qle/math/chunkworkers.hpp>
+#include <qle/math/computeenvironment.hpp>
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace QuantExt {
+
+/*! Compute context that records a calculation and executes it on a number of child contexts (devices), each of
+    them processing a contiguous shard of the samples. The program is split into stages at the conditional
+    expectations: the pathwise ops of a stage are run on all devices in parallel, the conditional expectation
+    requiring all samples is then calculated on the host over the gathered shards before the next stage starts.
+
+    The random variates are generated on the host in the same order as by the BasicCpu contexts, each device
+    receives the slice of the global stream belonging to its shard, so that the results do not depend on the
+    number of devices.
+
+    The child contexts are not owned by this class. */
+class ShardedComputeContext : public ComputeContext {
+public:
+    ShardedComputeContext(const std::vector<ComputeContext*>& devices, const std::vector<std::string>& deviceNames);
+    void init() override final;
+
+    std::pair<std::size_t, bool> initiateCalculation(const std::size_t n, const std::size_t id = 0,
+                                                     const std::size_t version = 0,
+                                                     const Settings settings = {}) override final;
+    void disposeCalculation(const std::size_t id) override final;
+    std::size_t createInputVariable(double v) override final;
+    std::size_t createInputVariable(double* v) override final;
+    std::vector<std::vector<std::size_t>> createInputVariates(const std::size_t dim,
+                                                              const std::size_t steps) override final;
+    std::size_t applyOperation(const std::size_t randomVariableOpCode,
+                               const std::vector<std::size_t>& args) override final;
+    void freeVariable(const std::size_t id) override final;
+    void declareOutputVariable(const std::size_t id) override final;
+    void finalizeCalculation(std::vector<double*>& output) override final;
+
+    std::vector<std::pair<std::string, std::string>> deviceInfo() const override final;
+    bool supportsDoublePrecision() const override final;
+
+    //! sum of the debug infos of the devices and the host part of this context
+    const DebugInfo& debugInfo() const override final;
+
+private:
+    enum class ComputeState { idle, createInput, createVariates, calc };
+
+    struct Operation {
+        std::size_t code;
+        std::vector<std::size_t> args;
+        std::size_t resultId;
+    };
+
+    /* the ops [begin, end) of the program run on the devices, the op end (if end < program size) is a conditional
+       expectation run on the host */
+    struct Stage {
+        std::size_t begin, end;
+        // ids defined outside the stage used by the device ops, ids defined by the device ops needed after the stage
+        std::vector<std::size_t> inputs, outputs;
+        // for each device op, the ids that can be freed on the device after the op
+        std::vector<std::vector<std::size_t>> frees;
+        // host values that are not needed any more after the stage
+        std::vector<std::size_t> releases;
+    };
+
+    struct Calculation {
+        std::size_t size, version;
+        bool disposed = false;
+        std::size_t numberOfInputVars = 0, numberOfVariates = 0, numberOfVars = 0;
+        std::vector<Operation> program;
+        std::vector<std::size_t> outputVars;
+        // derived from the program on the first finalize
+        std::vector<Stage> stages;
+        // child calc ids per stage and device, zero if not yet initiated
+        std::vector<std::vector<std::size_t>> childIds;
+        // the shards, the sizes are multiples of 8 except for the last shard
+        std::vector<std::size_t> shardOffset, shardSize;
+    };
+
+    void analyseProgram(Calculation& c) const;
+    void runStage(Calculation& c, const std::size_t stage, const std::size_t device);
+    const RandomVariable& value(const Calculation& c, const std::size_t id) const;
+    RandomVariable& hostValue(const Calculation& c, const std::size_t id);
+
+    std::vector<ComputeContext*> devices_;
+    std::vector<std::string> deviceNames_;
+    ChunkWorkers workers_;
+
+    bool initialized_ = false;
+    mutable DebugInfo debugInfo_;
+    DebugInfo hostDebugInfo_;
+
+    std::vector<Calculation> calculations_;
+
+    // current calc
+
+    std::size_t currentId_ = 0;
+    ComputeState currentState_ = ComputeState::idle;
+    Settings settings_;
+    bool newCalc_ = false;
+
+    std::vector<RandomVariable> inputs_;
+    std::vector<bool> inputIsScalar_;
+    std::vector<RandomVariable> hostValues_;
+
+    // shared random variates for all calcs
+
+    std::unique_ptr<QuantLib::MersenneTwisterUniformRng> rng_;
+    QuantLib::InverseCumulativeNormal icn_;
+    std::vector<RandomVariable> variates_;
+};
+
+} // namespace QuantExt
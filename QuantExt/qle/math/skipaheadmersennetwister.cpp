@@ -0,0 +1,207 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/skipaheadmersennetwister.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/math/randomnumbers/seedgenerator.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+
+namespace {
+
+// polynomials over GF(2), bit k represents the coefficient of t^k
+typedef std::vector<std::uint64_t> Poly;
+
+constexpr std::size_t mtDegree = 19937;
+
+// below this number of draws a direct skip is cheaper than the jump polynomial computation
+constexpr unsigned long long directSkipThreshold = 1ULL << 25;
+
+bool bit(const Poly& p, const std::size_t k) { return (p[k / 64] >> (k % 64)) & 1ULL; }
+
+// a ^= b * t^shift, bits beyond the size of a are dropped
+void xorShifted(Poly& a, const Poly& b, const std::size_t shift) {
+    std::size_t ws = shift / 64, bs = shift % 64;
+    for (std::size_t w = 0; w < b.size() && w + ws < a.size(); ++w) {
+        if (b[w] == 0)
+            continue;
+        a[w + ws] ^= b[w] << bs;
+        if (bs != 0 && w + ws + 1 < a.size())
+            a[w + ws + 1] ^= b[w] >> (64 - bs);
+    }
+}
+
+// 64 bits of p starting at bit position k, zero beyond the end of p
+std::uint64_t bits(const Poly& p, const std::size_t k) {
+    std::size_t w = k / 64, b = k % 64;
+    if (w >= p.size())
+        return 0;
+    std::uint64_t r = p[w] >> b;
+    if (b != 0 && w + 1 < p.size())
+        r |= p[w + 1] << (64 - b);
+    return r;
+}
+
+int parity(std::uint64_t x) {
+    x ^= x >> 32;
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return static_cast<int>(x & 1ULL);
+}
+
+// interleave the lower 32 bits of x with zeros, i.e. square the corresponding polynomial
+std::uint64_t spread(std::uint64_t x) {
+    x &= 0xffffffffULL;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffULL;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+}
+
+/* The characteristic polynomial of the MT19937 recurrence, computed by the Berlekamp-Massey algorithm from the
+   least significant output bits. Since the polynomial is irreducible, the minimal polynomial of any non-zero
+   output bit sequence is the characteristic polynomial itself. */
+Poly computeCharacteristicPolynomial() {
+    const std::size_t n = 2 * mtDegree;
+    SkipAheadMersenneTwisterUniformRng rng(5489UL);
+    // the output bits in reversed order, so that the discrepancy is a word wise inner product
+    Poly rev(n / 64 + 2, 0);
+    for (std::size_t k = 0; k < n; ++k) {
+        if (rng.nextInt32() & 1UL) {
+            std::size_t j = n - 1 - k;
+            rev[j / 64] |= 1ULL << (j % 64);
+        }
+    }
+    Poly c(n / 64 + 2, 0), b(n / 64 + 2, 0), tmp;
+    c[0] = b[0] = 1ULL;
+    std::size_t l = 0, m = 1;
+    for (std::size_t k = 0; k < n; ++k) {
+        // discrepancy d = sum_{i=0}^{l} c_i s_{k-i}, with s_{k-i} = rev_{n-1-k+i}
+        std::size_t offset = n - 1 - k;
+        int d = 0;
+        for (std::size_t w = 0; w <= l / 64; ++w)
+            d ^= parity(c[w] & bits(rev, offset + 64 * w));
+        if (d == 0) {
+            ++m;
+        } else if (2 * l <= k) {
+            tmp = c;
+            xorShifted(c, b, m);
+            l = k + 1 - l;
+            b.swap(tmp);
+            m = 1;
+        } else {
+            xorShifted(c, b, m);
+            ++m;
+        }
+    }
+    QL_REQUIRE(l == mtDegree, "SkipAheadMersenneTwisterUniformRng: characteristic polynomial has degree "
+                                  << l << ", expected " << mtDegree << ". Internal error, contact dev.");
+    // phi(t) = t^l c(1/t)
+    Poly phi(mtDegree / 64 + 1, 0);
+    for (std::size_t i = 0; i <= l; ++i) {
+        if (bit(c, i))
+            phi[(l - i) / 64] |= 1ULL << ((l - i) % 64);
+    }
+    return phi;
+}
+
+const Poly& characteristicPolynomial() {
+    static const Poly phi = computeCharacteristicPolynomial();
+    return phi;
+}
+
+// reduce p of degree < 2 * mtDegree modulo phi
+void reduce(Poly& p, const Poly& phi) {
+    for (std::size_t k = 2 * mtDegree - 2; k >= mtDegree; --k) {
+        if (bit(p, k))
+            xorShifted(p, phi, k - mtDegree);
+    }
+    p.resize(phi.size());
+}
+
+// t^n mod phi
+Poly jumpPolynomial(const unsigned long long n, const Poly& phi) {
+    Poly g(phi.size(), 0), sq(2 * phi.size(), 0);
+    g[0] = 1ULL;
+    int top = 63;
+    while (((n >> top) & 1ULL) == 0)
+        --top;
+    for (int k = top; k >= 0; --k) {
+        // g = g^2 mod phi
+        for (std::size_t w = 0; w < g.size(); ++w) {
+            sq[2 * w] = spread(g[w]);
+            sq[2 * w + 1] = spread(g[w] >> 32);
+        }
+        reduce(sq, phi);
+        g.swap(sq);
+        sq.assign(2 * phi.size(), 0);
+        // g = g * t mod phi
+        if ((n >> k) & 1ULL) {
+            for (std::size_t w = g.size() - 1; w > 0; --w)
+                g[w] = (g[w] << 1) | (g[w - 1] >> 63);
+            g[0] <<= 1;
+            if (bit(g, mtDegree))
+                xorShifted(g, phi, 0);
+        }
+    }
+    return g;
+}
+
+} // namespace
+
+SkipAheadMersenneTwisterUniformRng::SkipAheadMersenneTwisterUniformRng(const unsigned long seed) : i_(0) {
+    unsigned long s = (seed != 0 ? seed : QuantLib::SeedGenerator::instance().get());
+    mt_[0] = static_cast<std::uint32_t>(s & 0xffffffffUL);
+    for (std::size_t k = 1; k < N; ++k)
+        mt_[k] = 1812433253U * (mt_[k - 1] ^ (mt_[k - 1] >> 30)) + static_cast<std::uint32_t>(k);
+}
+
+void SkipAheadMersenneTwisterUniformRng::skip(const unsigned long long n) {
+    if (n < directSkipThreshold) {
+        for (unsigned long long k = 0; k < n; ++k)
+            twist();
+        return;
+    }
+    /* The state after n steps is g(A) s for the jump polynomial g = t^n mod phi, where A is the one step transition
+       and s the current state. We evaluate g(A) s by Horner's scheme, state words are aligned relative to the
+       current position. The lower bits of the word at the current position do not affect the future output, so
+       they can be disregarded although they are not part of the 19937 bit state space. */
+    const Poly& phi = characteristicPolynomial();
+    Poly g = jumpPolynomial(n, phi);
+    SkipAheadMersenneTwisterUniformRng r(*this);
+    r.mt_.fill(0);
+    for (std::size_t d = mtDegree; d > 0; --d) {
+        r.twist();
+        if (bit(g, d - 1)) {
+            for (std::size_t k = 0; k < N; ++k)
+                r.mt_[(r.i_ + k) % N] ^= mt_[(i_ + k) % N];
+        }
+    }
+    mt_ = r.mt_;
+    i_ = r.i_;
+}
+
+} // namespace QuantExt
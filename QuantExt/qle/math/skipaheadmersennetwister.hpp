@@ -0,0 +1,99 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/skipaheadmersennetwister.hpp
+    \brief mersenne twister uniform rng with skip ahead
+    \ingroup math
+*/
+
+#pragma once
+
+#include <ql/math/randomnumbers/inversecumulativersg.hpp>
+#include <ql/math/randomnumbers/randomsequencegenerator.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/methods/montecarlo/sample.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace QuantExt {
+using QuantLib::Real;
+using QuantLib::Sample;
+
+//! Mersenne Twister MT19937 uniform random number generator supporting skip ahead
+/*! The generated sequence is identical to the one of QuantLib::MersenneTwisterUniformRng for the same seed, with
+    seed = 0 meaning that the seed is taken from QuantLib's SeedGenerator.
+
+    skip(n) advances the generator by n draws. For large n this is done in O(log n) polynomial operations by
+    computing the jump polynomial t^n mod phi(t), where phi is the characteristic polynomial of the MT19937
+    recurrence, and evaluating it on the generator state (Haramoto, Matsumoto, Nishimura, Panneton, L'Ecuyer:
+    Efficient Jump Ahead for F2-Linear Random Number Generators, 2008). The characteristic polynomial is computed
+    once per process from the output of the generator itself using the Berlekamp-Massey algorithm.
+
+    \ingroup math
+*/
+class SkipAheadMersenneTwisterUniformRng {
+public:
+    typedef Sample<Real> sample_type;
+
+    explicit SkipAheadMersenneTwisterUniformRng(const unsigned long seed = 0);
+
+    //! returns a sample with weight 1.0 containing a random number in the (0.0, 1.0) interval
+    sample_type next() const { return {nextReal(), 1.0}; }
+
+    //! return a random number in the (0.0, 1.0) interval
+    Real nextReal() const { return (Real(nextInt32()) + 0.5) / 4294967296.0; }
+
+    //! return a random integer in the [0,0xffffffff] interval
+    unsigned long nextInt32() const {
+        std::uint32_t y = twist();
+        y ^= (y >> 11);
+        y ^= (y << 7) & 0x9d2c5680U;
+        y ^= (y << 15) & 0xefc60000U;
+        y ^= (y >> 18);
+        return static_cast<unsigned long>(y);
+    }
+
+    //! advance the generator by n draws
+    void skip(const unsigned long long n);
+
+private:
+    static constexpr std::size_t N = 624;
+    static constexpr std::size_t M = 397;
+
+    // update the state word at the current position and return the new (untempered) word
+    std::uint32_t twist() const {
+        std::size_t i1 = i_ + 1 == N ? 0 : i_ + 1;
+        std::size_t im = i_ + M < N ? i_ + M : i_ + M - N;
+        std::uint32_t y = (mt_[i_] & 0x80000000U) | (mt_[i1] & 0x7fffffffU);
+        mt_[i_] = mt_[im] ^ (y >> 1) ^ ((y & 1U) ? 0x9908b0dfU : 0U);
+        std::uint32_t r = mt_[i_];
+        i_ = i1;
+        return r;
+    }
+
+    mutable std::array<std::uint32_t, N> mt_;
+    mutable std::size_t i_;
+};
+
+//! Inverse cumulative normal pseudo random sequence generator based on SkipAheadMersenneTwisterUniformRng
+typedef QuantLib::InverseCumulativeRsg<QuantLib::RandomSequenceGenerator<SkipAheadMersenneTwisterUniformRng>,
+                                       QuantLib::InverseCumulativeNormal>
+    SkipAheadPseudoRandomRsg;
+
+} // namespace QuantExt
@@ -27,6 +27,7 @@
 #include <ql/math/array.hpp>
 #include <ql/math/comparison.hpp>
 #include <ql/math/generallinearleastsquares.hpp>
+#include <ql/math/matrixutilities/svd.hpp>
 
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/mean.hpp>
@@ -35,6 +36,7 @@
 #include <boost/make_shared.hpp>
 #include <boost/type_traits.hpp>
 
+#include <numeric>
 #include <vector>
 
 namespace QuantExt {
@@ -272,6 +274,149 @@ Real StabilisedGLLS::eval(xType x, vContainer& v,
     return tmp / yMultiplier_ - yShift_;
 }
 
+//! Numerically stabilised general linear least squares for several y data sets given on the same x values
+/*! The x values are transformed and the design matrix is decomposed only once, each y data set is then fitted using
+  the same decomposition. The transformation and the solution for each y data set are the same as the ones of
+  StabilisedGLLS and GeneralLinearLeastSquares, only the coefficients are computed though.
+    \ingroup math
+ */
+class StabilisedMultiGLLS {
+public:
+    template <class vContainer>
+    StabilisedMultiGLLS(const std::vector<Array>& x, const std::vector<std::vector<Real>>& y, const vContainer& v,
+                        const StabilisedGLLS::Method method = StabilisedGLLS::MeanStdDev);
+
+    //! number of y data sets
+    Size size() const { return coefficients_.size(); }
+
+    const Array& transformedCoefficients(const Size i) const { return coefficients_.at(i); }
+
+    //! Transformation parameters (u => (u + shift) * multiplier for u = x, y)
+    const Array& xMultiplier() const { return xMultiplier_; }
+    const Array& xShift() const { return xShift_; }
+    Real yMultiplier(const Size i) const { return yMultiplier_.at(i); }
+    Real yShift(const Size i) const { return yShift_.at(i); }
+
+    //! evaluate the regression function for the i-th y data set in terms of original x, y
+    template <class vContainer> Real eval(const Size i, const Array& x, vContainer& v) const;
+
+private:
+    Array xMultiplier_, xShift_;
+    std::vector<Real> yMultiplier_, yShift_;
+    std::vector<Array> coefficients_;
+};
+
+template <class vContainer>
+StabilisedMultiGLLS::StabilisedMultiGLLS(const std::vector<Array>& x, const std::vector<std::vector<Real>>& y,
+                                         const vContainer& v, const StabilisedGLLS::Method method)
+    : yMultiplier_(y.size(), 1.0), yShift_(y.size(), 0.0) {
+
+    QL_REQUIRE(!x.empty(), "StabilisedMultiGLLS: x container is empty");
+    QL_REQUIRE(!x[0].empty(), "StabilisedMultiGLLS: x contains empty point(s)");
+
+    const Size n = x.size(), d = x[0].size(), m = v.end() - v.begin();
+    QL_REQUIRE(n > m, "StabilisedMultiGLLS: not enough points (" << n << ") for " << m << " basis functions");
+    xMultiplier_ = Array(d, 1.0);
+    xShift_ = Array(d, 0.0);
+
+    // transformation of the x values, this is shared by all y data sets
+
+    switch (method) {
+    case StabilisedGLLS::None:
+        break;
+    case StabilisedGLLS::MaxAbs: {
+        Array mx(d, 0.0);
+        for (Size i = 0; i < n; ++i)
+            for (Size j = 0; j < d; ++j)
+                mx[j] = std::max(std::abs(x[i][j]), mx[j]);
+        for (Size j = 0; j < d; ++j)
+            if (!QuantLib::close_enough(mx[j], 0.0))
+                xMultiplier_[j] = 1.0 / mx[j];
+        break;
+    }
+    case StabilisedGLLS::MeanStdDev: {
+        std::vector<accumulator_set<Real, stats<boost::accumulators::tag::mean, boost::accumulators::tag::variance> > >
+            acc(d);
+        for (Size i = 0; i < n; ++i)
+            for (Size j = 0; j < d; ++j)
+                acc[j](x[i][j]);
+        for (Size j = 0; j < d; ++j) {
+            xShift_[j] = -mean(acc[j]);
+            Real tmp = boost::accumulators::variance(acc[j]);
+            if (!QuantLib::close_enough(tmp, 0.0))
+                xMultiplier_[j] = 1.0 / std::sqrt(tmp);
+        }
+        break;
+    }
+    default:
+        QL_FAIL("unknown stabilisation method");
+    }
+
+    // design matrix and its singular value decomposition, as in GeneralLinearLeastSquares
+
+    Matrix A(n, m);
+    Array xData(d);
+    for (Size i = 0; i < n; ++i) {
+        for (Size j = 0; j < d; ++j)
+            xData[j] = (x[i][j] + xShift_[j]) * xMultiplier_[j];
+        for (Size k = 0; k < m; ++k)
+            A[i][k] = v[k](xData);
+    }
+    const SVD svd(A);
+    const Matrix& U = svd.U();
+    const Matrix& V = svd.V();
+    const Array& w = svd.singularValues();
+    const Real threshold = n * QL_EPSILON * w[0];
+
+    // transformation of the y values and solution for each y data set
+
+    coefficients_.resize(y.size(), Array(m, 0.0));
+    std::vector<Real> yData(n);
+    for (Size l = 0; l < y.size(); ++l) {
+        QL_REQUIRE(y[l].size() == n,
+                   "StabilisedMultiGLLS: y data set #" << l << " has size " << y[l].size() << ", expected " << n);
+        if (method == StabilisedGLLS::MaxAbs) {
+            Real my = 0.0;
+            for (Size i = 0; i < n; ++i)
+                my = std::max(std::abs(y[l][i]), my);
+            if (!QuantLib::close_enough(my, 0.0))
+                yMultiplier_[l] = 1.0 / my;
+        } else if (method == StabilisedGLLS::MeanStdDev) {
+            accumulator_set<Real, stats<boost::accumulators::tag::mean, boost::accumulators::tag::variance> > acc;
+            for (Size i = 0; i < n; ++i)
+                acc(y[l][i]);
+            yShift_[l] = -mean(acc);
+            Real tmp = boost::accumulators::variance(acc);
+            if (!QuantLib::close_enough(tmp, 0.0))
+                yMultiplier_[l] = 1.0 / std::sqrt(tmp);
+        }
+        for (Size i = 0; i < n; ++i)
+            yData[i] = (y[l][i] + yShift_[l]) * yMultiplier_[l];
+        Array& a = coefficients_[l];
+        for (Size k = 0; k < m; ++k) {
+            if (w[k] > threshold) {
+                const Real u = std::inner_product(U.column_begin(k), U.column_end(k), yData.begin(), 0.0) / w[k];
+                for (Size j = 0; j < m; ++j)
+                    a[j] += u * V[j][k];
+            }
+        }
+    }
+}
+
+template <class vContainer> Real StabilisedMultiGLLS::eval(const Size i, const Array& x, vContainer& v) const {
+    const Array& a = coefficients_.at(i);
+    QL_REQUIRE(static_cast<Size>(v.end() - v.begin()) == a.size(),
+               "StabilisedMultiGLLS::eval(): v size (" << v.end() - v.begin() << ") must be equal to dim ("
+                                                       << a.size() << ")");
+    Array xNew(x.size());
+    for (Size j = 0; j < x.size(); ++j)
+        xNew[j] = (x[j] + xShift_[j]) * xMultiplier_[j];
+    Real tmp = 0.0;
+    for (Size k = 0; k < a.size(); ++k)
+        tmp += a[k] * v[k](xNew);
+    return tmp / yMultiplier_[i] - yShift_[i];
+}
+
 } // namespace QuantExt
 
 #endif
@@ -0,0 +1,140 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/tdigest.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/math/comparison.hpp>
+#include <ql/mathconstants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace QuantExt {
+
+using QuantLib::Real;
+
+namespace {
+// k1 scale function and its inverse, the centroids cover at most one unit of k
+Real scale(const Real q, const Real compression) { return compression / (2.0 * M_PI) * std::asin(2.0 * q - 1.0); }
+Real inverseScale(const Real k, const Real compression) {
+    return k >= compression / 4.0 ? 1.0 : (std::sin(k * 2.0 * M_PI / compression) + 1.0) / 2.0;
+}
+} // namespace
+
+TDigest::TDigest(const Real compression)
+    : compression_(compression), min_(std::numeric_limits<Real>::infinity()),
+      max_(-std::numeric_limits<Real>::infinity()) {
+    QL_REQUIRE(compression_ >= 1.0, "TDigest: compression (" << compression_ << ") must be at least 1");
+    bufferSize_ = static_cast<std::size_t>(5.0 * compression_);
+    buffer_.reserve(bufferSize_);
+}
+
+void TDigest::add(const Real x, const Real weight) {
+    QL_REQUIRE(std::isfinite(x), "TDigest::add(): value must be finite, got " << x);
+    QL_REQUIRE(weight > 0.0, "TDigest::add(): weight must be positive, got " << weight);
+    buffer_.push_back(std::make_pair(x, weight));
+    totalWeight_ += weight;
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+    if (buffer_.size() >= bufferSize_)
+        compress();
+}
+
+void TDigest::merge(const TDigest& other) {
+    other.compress();
+    for (auto const& c : other.centroids_) {
+        buffer_.push_back(c);
+        if (buffer_.size() >= bufferSize_)
+            compress();
+    }
+    totalWeight_ += other.totalWeight_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void TDigest::compress() const {
+    if (buffer_.empty())
+        return;
+    buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+    std::sort(buffer_.begin(), buffer_.end());
+    centroids_.clear();
+
+    // merge neighbouring values as long as the merged centroid spans at most one unit of the scale function
+
+    Real total = 0.0;
+    for (auto const& c : buffer_)
+        total += c.second;
+    Real weightSoFar = 0.0;
+    Real qLimit = inverseScale(scale(0.0, compression_) + 1.0, compression_);
+    std::pair<Real, Real> current = buffer_.front();
+    for (std::size_t i = 1; i < buffer_.size(); ++i) {
+        const auto& next = buffer_[i];
+        if ((weightSoFar + current.second + next.second) / total <= qLimit) {
+            current.second += next.second;
+            current.first += (next.first - current.first) * next.second / current.second;
+        } else {
+            weightSoFar += current.second;
+            centroids_.push_back(current);
+            current = next;
+            qLimit = inverseScale(scale(weightSoFar / total, compression_) + 1.0, compression_);
+        }
+    }
+    centroids_.push_back(current);
+    buffer_.clear();
+}
+
+std::size_t TDigest::size() const {
+    compress();
+    return centroids_.size();
+}
+
+Real TDigest::quantile(const Real q) const {
+    QL_REQUIRE(q >= 0.0 && q <= 1.0, "TDigest::quantile(): q (" << q << ") must be in [0,1]");
+    QL_REQUIRE(totalWeight_ > 0.0, "TDigest::quantile(): no values added");
+    compress();
+
+    if (q == 0.0)
+        return min_;
+    if (q == 1.0)
+        return max_;
+
+    // interpolate linearly between the centroid means, which are located in the middle of their weight, and use the
+    // exact extreme values at both ends
+
+    if (centroids_.size() == 1 || QuantLib::close_enough(min_, max_))
+        return min_ + q * (max_ - min_);
+    Real index = q * totalWeight_;
+    Real cumulated = centroids_.front().second / 2.0;
+    if (index < cumulated)
+        return min_ + (centroids_.front().first - min_) * index / cumulated;
+    for (std::size_t i = 0; i + 1 < centroids_.size(); ++i) {
+        Real dw = (centroids_[i].second + centroids_[i + 1].second) / 2.0;
+        if (index < cumulated + dw) {
+            return centroids_[i].first +
+                   (centroids_[i + 1].first - centroids_[i].first) * (index - cumulated) / dw;
+        }
+        cumulated += dw;
+    }
+    Real lastHalfWeight = centroids_.back().second / 2.0;
+    return std::min(max_, centroids_.back().first +
+                              (max_ - centroids_.back().first) * (index - cumulated) / lastHalfWeight);
+}
+
+} // namespace QuantExt
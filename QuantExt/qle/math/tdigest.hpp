@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/tdigest.hpp
+    \brief streaming quantile estimator
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace QuantExt {
+
+/*! Merging t-digest (T. Dunning, O. Ertl, Computing Extremely Accurate Quantiles Using t-Digests, 2019) for
+    estimating quantiles of a stream of values without storing the values. The values are collected in a buffer and
+    merged into at most about compression centroids, with small centroids in the tails. The quantile rank error is
+    of order 1 / compression, and less in the tails. The extreme values are tracked exactly. */
+class TDigest {
+public:
+    explicit TDigest(const QuantLib::Real compression = 100.0);
+
+    //! add a value with the given weight
+    void add(const QuantLib::Real x, const QuantLib::Real weight = 1.0);
+    //! add the centroids of another digest, e.g. one built on a different thread
+    void merge(const TDigest& other);
+
+    //! estimate of the q-quantile, q in [0, 1]
+    QuantLib::Real quantile(const QuantLib::Real q) const;
+
+    QuantLib::Real compression() const { return compression_; }
+    QuantLib::Real totalWeight() const { return totalWeight_; }
+    QuantLib::Real min() const { return min_; }
+    QuantLib::Real max() const { return max_; }
+    //! number of centroids after merging the buffered values
+    std::size_t size() const;
+
+private:
+    void compress() const;
+
+    QuantLib::Real compression_;
+    std::size_t bufferSize_;
+    QuantLib::Real totalWeight_ = 0.0;
+    QuantLib::Real min_, max_;
+    // (mean, weight) of the centroids sorted by mean and of the values not yet merged
+    mutable std::vector<std::pair<QuantLib::Real, QuantLib::Real>> centroids_, buffer_;
+};
+
+} // namespace QuantExt
@@ -0,0 +1,133 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/vectorisedblackformula.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+void vectorisedBlackFormula(Option::Type type, const Real* strikes, const Real* forwards, const Real* stdDevs,
+                            const Real* discounts, Size n, Real* prices, Real* stdDevDerivatives,
+                            Real* forwardDerivatives, Real displacement) {
+    if (n == 0)
+        return;
+
+    const Real omega = type == Option::Call ? 1.0 : -1.0;
+    const RandomVariableKernelTable& k = randomVariableKernels();
+
+    // options with zero std dev or zero displaced strike are priced separately below, for them we compute dummy
+    // values in the vectorised part avoiding divisions by zero
+
+    std::vector<unsigned char> special(n);
+    std::vector<Real> d1(n), n1(n), n2(n);
+    for (Size i = 0; i < n; ++i) {
+        QL_REQUIRE(strikes[i] + displacement >= 0.0, "vectorisedBlackFormula: strike + displacement ("
+                                                         << strikes[i] << " + " << displacement
+                                                         << ") must be non-negative");
+        QL_REQUIRE(forwards[i] + displacement > 0.0, "vectorisedBlackFormula: forward + displacement ("
+                                                         << forwards[i] << " + " << displacement
+                                                         << ") must be positive");
+        QL_REQUIRE(stdDevs[i] >= 0.0, "vectorisedBlackFormula: stdDev (" << stdDevs[i] << ") must be non-negative");
+        QL_REQUIRE(discounts[i] > 0.0, "vectorisedBlackFormula: discount (" << discounts[i] << ") must be positive");
+        special[i] = stdDevs[i] == 0.0 || strikes[i] + displacement == 0.0;
+        d1[i] = special[i] ? 1.0 : (forwards[i] + displacement) / (strikes[i] + displacement);
+    }
+
+    k.log(d1.data(), n);
+    for (Size i = 0; i < n; ++i) {
+        Real s = special[i] ? 1.0 : stdDevs[i];
+        d1[i] = d1[i] / s + 0.5 * s;
+        n1[i] = omega * d1[i];
+        n2[i] = omega * (d1[i] - s);
+    }
+    k.normalCdf(n1.data(), n);
+    k.normalCdf(n2.data(), n);
+
+    for (Size i = 0; i < n; ++i)
+        prices[i] = discounts[i] * omega * ((forwards[i] + displacement) * n1[i] - (strikes[i] + displacement) * n2[i]);
+    if (forwardDerivatives != nullptr) {
+        for (Size i = 0; i < n; ++i)
+            forwardDerivatives[i] = discounts[i] * omega * n1[i];
+    }
+    if (stdDevDerivatives != nullptr) {
+        k.normalPdf(d1.data(), n);
+        for (Size i = 0; i < n; ++i)
+            stdDevDerivatives[i] = discounts[i] * (forwards[i] + displacement) * d1[i];
+    }
+
+    // the special cases, as in QuantLib::blackFormula()
+
+    for (Size i = 0; i < n; ++i) {
+        if (!special[i])
+            continue;
+        bool itm;
+        if (stdDevs[i] == 0.0) {
+            itm = (forwards[i] - strikes[i]) * omega > 0.0;
+            prices[i] = std::max((forwards[i] - strikes[i]) * omega, 0.0) * discounts[i];
+        } else {
+            itm = type == Option::Call;
+            prices[i] = itm ? (forwards[i] + displacement) * discounts[i] : 0.0;
+        }
+        if (forwardDerivatives != nullptr)
+            forwardDerivatives[i] = itm ? discounts[i] * omega : 0.0;
+        if (stdDevDerivatives != nullptr)
+            stdDevDerivatives[i] = 0.0;
+    }
+}
+
+void vectorisedBachelierBlackFormula(Option::Type type, const Real* strikes, const Real* forwards,
+                                     const Real* stdDevs, const Real* discounts, Size n, Real* prices,
+                                     Real* stdDevDerivatives, Real* forwardDerivatives) {
+    if (n == 0)
+        return;
+
+    const Real omega = type == Option::Call ? 1.0 : -1.0;
+    const RandomVariableKernelTable& k = randomVariableKernels();
+
+    std::vector<Real> h(n), p(n);
+    for (Size i = 0; i < n; ++i) {
+        QL_REQUIRE(stdDevs[i] >= 0.0,
+                   "vectorisedBachelierBlackFormula: stdDev (" << stdDevs[i] << ") must be non-negative");
+        QL_REQUIRE(discounts[i] > 0.0,
+                   "vectorisedBachelierBlackFormula: discount (" << discounts[i] << ") must be positive");
+        h[i] = stdDevs[i] == 0.0 ? 0.0 : (forwards[i] - strikes[i]) * omega / stdDevs[i];
+        p[i] = h[i];
+    }
+
+    k.normalCdf(h.data(), n);
+    k.normalPdf(p.data(), n);
+
+    for (Size i = 0; i < n; ++i) {
+        Real d = (forwards[i] - strikes[i]) * omega;
+        bool special = stdDevs[i] == 0.0;
+        prices[i] = discounts[i] * (special ? std::max(d, 0.0) : stdDevs[i] * p[i] + d * h[i]);
+        if (forwardDerivatives != nullptr)
+            forwardDerivatives[i] = special ? (d > 0.0 ? discounts[i] * omega : 0.0) : discounts[i] * omega * h[i];
+        if (stdDevDerivatives != nullptr)
+            stdDevDerivatives[i] = special ? 0.0 : discounts[i] * p[i];
+    }
+}
+
+} // namespace QuantExt
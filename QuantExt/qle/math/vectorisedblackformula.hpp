@@ -0,0 +1,54 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/vectorisedblackformula.hpp
+    \brief Black and Bachelier formulas for arrays of options
+*/
+
+#pragma once
+
+#include <ql/option.hpp>
+
+namespace QuantExt {
+
+/*! Black formula for n options of the same type, i.e.
+
+    prices[i] = QuantLib::blackFormula(type, strikes[i], forwards[i], stdDevs[i], discounts[i], displacement)
+
+    If stdDevDerivatives resp. forwardDerivatives are not null, they are set to the derivatives of the prices w.r.t.
+    the standard deviations (as QuantLib::blackFormulaStdDevDerivative()) resp. the forwards. The logarithm, normal
+    cdf and normal pdf are evaluated with the RandomVariable kernels, i.e. vectorised if selected, see
+    RandomVariableKernels for their accuracy. The outputs must not overlap with the inputs. */
+void vectorisedBlackFormula(QuantLib::Option::Type type, const QuantLib::Real* strikes,
+                            const QuantLib::Real* forwards, const QuantLib::Real* stdDevs,
+                            const QuantLib::Real* discounts, QuantLib::Size n, QuantLib::Real* prices,
+                            QuantLib::Real* stdDevDerivatives = nullptr, QuantLib::Real* forwardDerivatives = nullptr,
+                            QuantLib::Real displacement = 0.0);
+
+/*! Bachelier formula for n options of the same type, i.e.
+
+    prices[i] = QuantLib::bachelierBlackFormula(type, strikes[i], forwards[i], stdDevs[i], discounts[i])
+
+    the derivatives and the evaluation are as for vectorisedBlackFormula(). */
+void vectorisedBachelierBlackFormula(QuantLib::Option::Type type, const QuantLib::Real* strikes,
+                                     const QuantLib::Real* forwards, const QuantLib::Real* stdDevs,
+                                     const QuantLib::Real* discounts, QuantLib::Size n, QuantLib::Real* prices,
+                                     QuantLib::Real* stdDevDerivatives = nullptr,
+                                     QuantLib::Real* forwardDerivatives = nullptr);
+
+} // namespace QuantExt
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/methods/mcpathstore.hpp>
+
+#include <algorithm>
+
+namespace QuantExt {
+
+McPathStore::Entry::Entry(const QuantLib::ext::shared_ptr<QuantLib::Observable>& model) : model(model) {
+    registerWith(model);
+}
+
+bool McPathStore::Entry::valid(const QuantLib::ext::shared_ptr<QuantLib::Observable>& m) const {
+    return !stale && model.lock() == m;
+}
+
+QuantLib::ext::shared_ptr<const McPathStore::Paths>
+McPathStore::paths(const QuantLib::ext::shared_ptr<QuantLib::Observable>& model, const std::string& key,
+                   const std::set<Real>& times, const Simulator& simulate) {
+
+    QL_REQUIRE(model, "McPathStore::paths(): no model given");
+
+    // remove paths of models that were updated or destroyed
+
+    for (auto it = store_.begin(); it != store_.end();) {
+        if (it->second->stale || it->second->model.expired())
+            it = store_.erase(it);
+        else
+            ++it;
+    }
+
+    auto storeKey = std::make_pair(model.get(), key);
+    auto e = store_.find(storeKey);
+
+    // check if the stored paths can be used
+
+    std::set<Real> simulationTimes(times);
+    if (e != store_.end() && e->second->valid(model)) {
+        const auto& storedTimes = e->second->paths->times;
+        if (std::includes(storedTimes.begin(), storedTimes.end(), times.begin(), times.end())) {
+            ++hits_;
+            return e->second->paths;
+        }
+        simulationTimes.insert(storedTimes.begin(), storedTimes.end());
+    }
+
+    // simulate the paths on the union of the requested and stored times
+
+    auto paths = QuantLib::ext::make_shared<Paths>();
+    paths->times.assign(simulationTimes.begin(), simulationTimes.end());
+    paths->values = simulate(simulationTimes);
+    QL_REQUIRE(paths->values.size() == paths->times.size(), "McPathStore::paths(): simulated paths size ("
+                                                                << paths->values.size() << ") does not match times ("
+                                                                << paths->times.size() << ")");
+
+    // store the paths, if they do not exceed the memory limit
+
+    Size memory = 0;
+    for (auto const& v : paths->values)
+        for (auto const& r : v)
+            memory += r.size() * sizeof(double);
+
+    if (memory <= maxMemory_) {
+        auto entry = QuantLib::ext::make_shared<Entry>(model);
+        entry->paths = paths;
+        store_[storeKey] = entry;
+    } else if (e != store_.end()) {
+        store_.erase(e);
+    }
+
+    return paths;
+}
+
+void McPathStore::clear() {
+    store_.clear();
+    hits_ = 0;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/methods/mcpathstore.hpp
+    \brief store for simulated model state paths shared between mc engines
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+
+#include <ql/patterns/observable.hpp>
+#include <ql/patterns/singleton.hpp>
+
+#include <functional>
+#include <map>
+#include <set>
+
+namespace QuantExt {
+
+/*! Store for simulated model state paths, so that mc engines using the same model and path generator settings share
+    one simulation, see McMultiLegBaseEngine for a usage example. The paths are identified by the model instance and a
+    key which must contain all other inputs to the path generation (sequence type, seed, number of samples, reference
+    date etc.).
+
+    A request for a set of times that is contained in the stored time grid is served from the store, the caller
+    takes the paths on its own times from the returned grid. Otherwise the paths are simulated on the union of the
+    requested and the stored times and replace the stored paths. Therefore the paths returned for a request depend on
+    the times requested before, although they are always a valid simulation of the model on the requested times.
+
+    The stored paths are discarded when the model notifies its observers, or when the model is destroyed. Paths that
+    would use more memory than maxMemory() are not stored. This is a session singleton. */
+class McPathStore : public QuantLib::Singleton<McPathStore> {
+    friend class QuantLib::Singleton<McPathStore>;
+    McPathStore() = default;
+
+public:
+    //! simulated paths, values[i][j] is the state variable j at times[i]
+    struct Paths {
+        std::vector<Real> times;
+        std::vector<std::vector<RandomVariable>> values;
+    };
+
+    //! simulates the paths on the given times, the result must be indexed by time first and state variable second
+    using Simulator = std::function<std::vector<std::vector<RandomVariable>>(const std::set<Real>&)>;
+
+    //! get paths containing the given times
+    QuantLib::ext::shared_ptr<const Paths> paths(const QuantLib::ext::shared_ptr<QuantLib::Observable>& model,
+                                                 const std::string& key, const std::set<Real>& times,
+                                                 const Simulator& simulate);
+
+    //! number of stored path sets
+    Size size() const { return store_.size(); }
+    //! number of requests that were served from the store
+    Size hits() const { return hits_; }
+    //! maximum memory for one path set in bytes, defaults to 1 GB
+    Size maxMemory() const { return maxMemory_; }
+    void setMaxMemory(const Size maxMemory) { maxMemory_ = maxMemory; }
+    //! remove all paths from the store and reset the hit counter
+    void clear();
+
+private:
+    class Entry : public QuantLib::Observer {
+    public:
+        explicit Entry(const QuantLib::ext::shared_ptr<QuantLib::Observable>& model);
+        void update() override { stale = true; }
+        bool valid(const QuantLib::ext::shared_ptr<QuantLib::Observable>& model) const;
+        QuantLib::ext::weak_ptr<QuantLib::Observable> model;
+        QuantLib::ext::shared_ptr<const Paths> paths;
+        bool stale = false;
+    };
+    std::map<std::pair<const QuantLib::Observable*, std::string>, QuantLib::ext::shared_ptr<Entry>> store_;
+    Size maxMemory_ = 1024 * 1024 * 1024;
+    Size hits_ = 0;
+};
+
+} // namespace QuantExt
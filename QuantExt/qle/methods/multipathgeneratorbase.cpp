@@ -20,10 +20,39 @@
 
 #include <boost/make_shared.hpp>
 
+#include <cstdint>
+
 using namespace QuantLib;
 
 namespace QuantExt {
 
+namespace {
+
+std::uint32_t sobolSkip(const Size path) {
+    QL_REQUIRE(path <= 0xffffffffULL, "skipTo(" << path << "): Sobol sequences support at most 2^32 paths");
+    return static_cast<std::uint32_t>(path);
+}
+
+/* Sobol brownian generator starting from a given sobol sequence generator, this is used to skip ahead, since the
+   QuantLib brownian generators do not expose their sequence generators */
+template <class RSG> class SkippedSobolBrownianGenerator : public SobolBrownianGeneratorBase {
+public:
+    SkippedSobolBrownianGenerator(const Size factors, const Size steps, const Ordering ordering, const RSG& rsg)
+        : SobolBrownianGeneratorBase(factors, steps, ordering), generator_(rsg) {}
+
+private:
+    const SobolRsg::sample_type& nextSequence() override { return generator_.nextSequence(); }
+    InverseCumulativeRsg<RSG, InverseCumulativeNormal> generator_;
+};
+
+} // namespace
+
+void MultiPathGeneratorBase::skipTo(const Size path) {
+    reset();
+    for (Size i = 0; i < path; ++i)
+        next();
+}
+
 MultiPathGeneratorMersenneTwister::MultiPathGeneratorMersenneTwister(
     const QuantLib::ext::shared_ptr<StochasticProcess>& process, const TimeGrid& grid, BigNatural seed, bool antitheticSampling)
     : process_(process), grid_(grid), seed_(seed), antitheticSampling_(antitheticSampling), antitheticVariate_(true),
@@ -31,12 +60,25 @@ MultiPathGeneratorMersenneTwister::MultiPathGeneratorMersenneTwister(
     MultiPathGeneratorMersenneTwister::reset();
 }
 
-void MultiPathGeneratorMersenneTwister::reset() {
-    PseudoRandom::rsg_type rsg = PseudoRandom::make_sequence_generator(process_->factors() * (grid_.size() - 1), seed_);
+void MultiPathGeneratorMersenneTwister::reset() { init(0); }
+
+void MultiPathGeneratorMersenneTwister::skipTo(const Size path) {
+    // an antithetic pair of paths consumes one sequence of random numbers
+    unsigned long long dimension = process_->factors() * (grid_.size() - 1);
+    init(dimension * (antitheticSampling_ ? path / 2 : path));
+    if (antitheticSampling_ && path % 2 == 1)
+        next();
+}
+
+void MultiPathGeneratorMersenneTwister::init(const unsigned long long skippedDraws) {
+    Size dimension = process_->factors() * (grid_.size() - 1);
+    SkipAheadMersenneTwisterUniformRng rng(seed_);
+    rng.skip(skippedDraws);
+    SkipAheadPseudoRandomRsg rsg(RandomSequenceGenerator<SkipAheadMersenneTwisterUniformRng>(dimension, rng));
     if (auto tmp = QuantLib::ext::dynamic_pointer_cast<StochasticProcess1D>(process_)) {
-        pg1D_ = QuantLib::ext::make_shared<PathGenerator<PseudoRandom::rsg_type>>(tmp, grid_, rsg, false);
+        pg1D_ = QuantLib::ext::make_shared<PathGenerator<SkipAheadPseudoRandomRsg>>(tmp, grid_, rsg, false);
     } else {
-        pg_ = QuantLib::ext::make_shared<MultiPathGenerator<PseudoRandom::rsg_type>>(process_, grid_, rsg, false);
+        pg_ = QuantLib::ext::make_shared<MultiPathGenerator<SkipAheadPseudoRandomRsg>>(process_, grid_, rsg, false);
     }
     antitheticVariate_ = true;
 }
@@ -68,19 +110,21 @@ MultiPathGeneratorSobol::MultiPathGeneratorSobol(const QuantLib::ext::shared_ptr
     MultiPathGeneratorSobol::reset();
 }
 
-void MultiPathGeneratorSobol::reset() {
+void MultiPathGeneratorSobol::reset() { init(0); }
+
+void MultiPathGeneratorSobol::skipTo(const Size path) { init(path); }
+
+void MultiPathGeneratorSobol::init(const Size path) {
+    SobolRsg rsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_);
+    if (path > 0)
+        rsg.skipTo(sobolSkip(path));
     if (auto tmp = QuantLib::ext::dynamic_pointer_cast<StochasticProcess1D>(process_)) {
         pg1D_ = QuantLib::ext::make_shared<PathGenerator<InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>>>(
-            tmp, grid_,
-            InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(
-                SobolRsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_)),
-            false);
+            tmp, grid_, InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(rsg), false);
 
     } else {
         pg_ = QuantLib::ext::make_shared<MultiPathGenerator<InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>>>(
-            process_, grid_,
-            InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(
-                SobolRsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_)));
+            process_, grid_, InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(rsg));
     }
 }
 
@@ -102,19 +146,21 @@ MultiPathGeneratorBurley2020Sobol::MultiPathGeneratorBurley2020Sobol(const Quant
     MultiPathGeneratorBurley2020Sobol::reset();
 }
 
-void MultiPathGeneratorBurley2020Sobol::reset() {
+void MultiPathGeneratorBurley2020Sobol::reset() { init(0); }
+
+void MultiPathGeneratorBurley2020Sobol::skipTo(const Size path) { init(path); }
+
+void MultiPathGeneratorBurley2020Sobol::init(const Size path) {
+    Burley2020SobolRsg rsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_, scrambleSeed_);
+    if (path > 0)
+        rsg.skipTo(sobolSkip(path));
     if (auto tmp = QuantLib::ext::dynamic_pointer_cast<StochasticProcess1D>(process_)) {
         pg1D_ = QuantLib::ext::make_shared<PathGenerator<InverseCumulativeRsg<Burley2020SobolRsg, InverseCumulativeNormal>>>(
-            tmp, grid_,
-            InverseCumulativeRsg<Burley2020SobolRsg, InverseCumulativeNormal>(
-                Burley2020SobolRsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_, scrambleSeed_)),
-            false);
+            tmp, grid_, InverseCumulativeRsg<Burley2020SobolRsg, InverseCumulativeNormal>(rsg), false);
 
     } else {
         pg_ = QuantLib::ext::make_shared<MultiPathGenerator<InverseCumulativeRsg<Burley2020SobolRsg, InverseCumulativeNormal>>>(
-            process_, grid_,
-            InverseCumulativeRsg<Burley2020SobolRsg, InverseCumulativeNormal>(Burley2020SobolRsg(
-                process_->factors() * (grid_.size() - 1), seed_, directionIntegers_, scrambleSeed_)));
+            process_, grid_, InverseCumulativeRsg<Burley2020SobolRsg, InverseCumulativeNormal>(rsg));
     }
 }
 
@@ -172,6 +218,13 @@ void MultiPathGeneratorSobolBrownianBridge::reset() {
                                                       directionIntegers_);
 }
 
+void MultiPathGeneratorSobolBrownianBridge::skipTo(const Size path) {
+    SobolRsg rsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_);
+    rsg.skipTo(sobolSkip(path));
+    gen_ = QuantLib::ext::make_shared<SkippedSobolBrownianGenerator<SobolRsg>>(process_->factors(), grid_.size() - 1,
+                                                                               ordering_, rsg);
+}
+
 MultiPathGeneratorBurley2020SobolBrownianBridge::MultiPathGeneratorBurley2020SobolBrownianBridge(
     const QuantLib::ext::shared_ptr<StochasticProcess>& process, const TimeGrid& grid,
     Burley2020SobolBrownianGenerator::Ordering ordering, BigNatural seed, SobolRsg::DirectionIntegers directionIntegers,
@@ -186,6 +239,13 @@ void MultiPathGeneratorBurley2020SobolBrownianBridge::reset() {
                                                                 directionIntegers_, scrambleSeed_);
 }
 
+void MultiPathGeneratorBurley2020SobolBrownianBridge::skipTo(const Size path) {
+    Burley2020SobolRsg rsg(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_, scrambleSeed_);
+    rsg.skipTo(sobolSkip(path));
+    gen_ = QuantLib::ext::make_shared<SkippedSobolBrownianGenerator<Burley2020SobolRsg>>(
+        process_->factors(), grid_.size() - 1, ordering_, rsg);
+}
+
 QuantLib::ext::shared_ptr<MultiPathGeneratorBase>
 makeMultiPathGenerator(const SequenceType s, const QuantLib::ext::shared_ptr<StochasticProcess>& process,
                        const TimeGrid& timeGrid, const BigNatural seed, const SobolBrownianGenerator::Ordering ordering,
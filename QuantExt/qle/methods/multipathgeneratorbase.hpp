@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <qle/math/skipaheadmersennetwister.hpp>
+
 #include <ql/math/randomnumbers/rngtraits.hpp>
 #include <ql/methods/montecarlo/brownianbridge.hpp>
 #include <ql/methods/montecarlo/multipath.hpp>
@@ -51,6 +53,11 @@ public:
     virtual ~MultiPathGeneratorBase() {}
     virtual const Sample<MultiPath>& next() const = 0;
     virtual void reset() = 0;
+    /*! Reset the generator such that the next call to next() returns the path with the given (zero based) index,
+        i.e. the same path as the (path + 1)-th call to next() after reset(). This allows to split a simulation into
+        sample ranges which are generated independently. The default implementation discards the first paths, the
+        generators below override this with an O(log path) skip ahead of the underlying sequence generator. */
+    virtual void skipTo(const Size path);
 };
 
 //! Instantiation of MultiPathGenerator with standard PseudoRandom traits
@@ -62,14 +69,17 @@ public:
                                       bool antitheticSampling = false);
     const Sample<MultiPath>& next() const override;
     void reset() override;
+    void skipTo(const Size path) override;
 
 private:
+    void init(const unsigned long long skippedDraws);
+
     const QuantLib::ext::shared_ptr<StochasticProcess> process_;
     TimeGrid grid_;
     BigNatural seed_;
 
-    QuantLib::ext::shared_ptr<MultiPathGenerator<PseudoRandom::rsg_type>> pg_;
-    QuantLib::ext::shared_ptr<PathGenerator<PseudoRandom::rsg_type>> pg1D_;
+    QuantLib::ext::shared_ptr<MultiPathGenerator<SkipAheadPseudoRandomRsg>> pg_;
+    QuantLib::ext::shared_ptr<PathGenerator<SkipAheadPseudoRandomRsg>> pg1D_;
     bool antitheticSampling_;
     mutable bool antitheticVariate_;
     mutable Sample<MultiPath> next_;
@@ -94,8 +104,11 @@ public:
                             SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     const Sample<MultiPath>& next() const override;
     void reset() override;
+    void skipTo(const Size path) override;
 
 private:
+    void init(const Size path);
+
     const QuantLib::ext::shared_ptr<StochasticProcess> process_;
     TimeGrid grid_;
     BigNatural seed_;
@@ -120,8 +133,11 @@ public:
                                       BigNatural scrambleSeed = 43);
     const Sample<MultiPath>& next() const override;
     void reset() override;
+    void skipTo(const Size path) override;
 
 private:
+    void init(const Size path);
+
     const QuantLib::ext::shared_ptr<StochasticProcess> process_;
     TimeGrid grid_;
     BigNatural seed_;
@@ -165,6 +181,7 @@ public:
                                           BigNatural seed = 0,
                                           SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     void reset() override final;
+    void skipTo(const Size path) override final;
 };
 
 //! Instantiation using Burley2020SobolBrownianGenerator from  models/marketmodels/browniangenerators
@@ -177,6 +194,7 @@ public:
         SobolBrownianGenerator::Ordering ordering = SobolBrownianGenerator::Steps, BigNatural seed = 42,
         SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7, BigNatural scrambleSeed = 43);
     void reset() override final;
+    void skipTo(const Size path) override final;
 
 protected:
     BigNatural scrambleSeed_;
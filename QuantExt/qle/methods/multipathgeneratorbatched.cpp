@@ -0,0 +1,226 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/methods/brownianbridgepathinterpolator.hpp>
+#include <qle/methods/multipathgeneratorbatched.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+
+namespace QuantExt {
+
+CrossAssetStateBatchEvolver::CrossAssetStateBatchEvolver(
+    const QuantLib::ext::shared_ptr<CrossAssetStateProcess>& process, const TimeGrid& grid)
+    : grid_(grid) {
+    QL_REQUIRE(process, "CrossAssetStateBatchEvolver: no process given");
+    QL_REQUIRE(process->hasAffineStep(),
+               "CrossAssetStateBatchEvolver: process step is not affine (requires LGM1F based model without CIR++)");
+    QL_REQUIRE(grid_.size() > 0, "CrossAssetStateBatchEvolver: empty time grid");
+    factors_ = process->factors();
+    x0_ = process->initialValues();
+    Array a;
+    Matrix b, c;
+    steps_.resize(grid_.size() - 1);
+    for (Size i = 0; i < steps_.size(); ++i) {
+        process->affineStep(grid_[i], grid_.dt(i), a, b, c);
+        QL_REQUIRE(c.columns() == factors_,
+                   "CrossAssetStateBatchEvolver: diffusion has " << c.columns() << " columns, expected " << factors_);
+        steps_[i].a.assign(a.begin(), a.end());
+        for (Size r = 0; r < b.rows(); ++r) {
+            for (Size k = 0; k < b.columns(); ++k)
+                if (b[r][k] != 0.0)
+                    steps_[i].b.push_back({r, k, b[r][k]});
+            for (Size k = 0; k < c.columns(); ++k)
+                if (c[r][k] != 0.0)
+                    steps_[i].c.push_back({r, k, c[r][k]});
+        }
+    }
+    states_.resize(grid_.size());
+    variates_.resize(steps_.size());
+}
+
+void CrossAssetStateBatchEvolver::evolve(const MultiPathVariateGeneratorBase& generator, const Size nPaths) {
+
+    const Size n = size();
+    nPaths_ = nPaths;
+
+    for (auto& s : states_)
+        s.resize(n * nPaths);
+    for (auto& v : variates_)
+        v.resize(factors_ * nPaths);
+    weights_.resize(nPaths);
+
+    // transpose the variates to [step][factor][path]
+
+    for (Size p = 0; p < nPaths; ++p) {
+        auto sample = generator.next();
+        QL_REQUIRE(sample.value.size() == steps_.size(), "CrossAssetStateBatchEvolver: generator produces "
+                                                             << sample.value.size() << " time steps, expected "
+                                                             << steps_.size());
+        for (Size i = 0; i < steps_.size(); ++i) {
+            QL_REQUIRE(sample.value[i].size() == factors_, "CrossAssetStateBatchEvolver: generator produces "
+                                                               << sample.value[i].size() << " factors, expected "
+                                                               << factors_);
+            for (Size f = 0; f < factors_; ++f)
+                variates_[i][f * nPaths + p] = sample.value[i][f];
+        }
+        weights_[p] = sample.weight;
+    }
+
+    evolveStates();
+}
+
+void CrossAssetStateBatchEvolver::evolve(const MultiPathVariateGeneratorBase& generator, const Size nPaths,
+                                         const std::vector<bool>& coarseSteps, const BigNatural bridgeSeed) {
+
+    QL_REQUIRE(coarseSteps.size() == steps_.size(), "CrossAssetStateBatchEvolver: coarse steps size ("
+                                                        << coarseSteps.size() << ") must match number of time steps ("
+                                                        << steps_.size() << ")");
+
+    const Size n = size();
+    nPaths_ = nPaths;
+
+    for (auto& s : states_)
+        s.resize(n * nPaths);
+    for (auto& v : variates_)
+        v.resize(factors_ * nPaths);
+    weights_.resize(nPaths);
+
+    // collect the coarse variates as random variables over the paths of the batch
+
+    std::vector<Size> coarseIndex;
+    for (Size i = 0; i < steps_.size(); ++i)
+        if (coarseSteps[i])
+            coarseIndex.push_back(i);
+    QL_REQUIRE(!coarseIndex.empty(), "CrossAssetStateBatchEvolver: at least one coarse step required");
+
+    std::vector<std::vector<RandomVariable>> variates(steps_.size());
+    for (auto i : coarseIndex)
+        variates[i].resize(factors_, RandomVariable(nPaths));
+
+    for (Size p = 0; p < nPaths; ++p) {
+        auto sample = generator.next();
+        QL_REQUIRE(sample.value.size() == coarseIndex.size(), "CrossAssetStateBatchEvolver: generator produces "
+                                                                  << sample.value.size() << " time steps, expected "
+                                                                  << coarseIndex.size());
+        for (Size i = 0; i < coarseIndex.size(); ++i) {
+            QL_REQUIRE(sample.value[i].size() == factors_, "CrossAssetStateBatchEvolver: generator produces "
+                                                               << sample.value[i].size() << " factors, expected "
+                                                               << factors_);
+            for (Size f = 0; f < factors_; ++f)
+                variates[coarseIndex[i]][f].set(p, sample.value[i][f]);
+        }
+        weights_[p] = sample.weight;
+    }
+
+    // fill in the variates of the fine steps and transpose all variates to [step][factor][path]
+
+    std::vector<Real> times(grid_.begin() + 1, grid_.end());
+    interpolateVariatesWithBrownianBridge(times, variates, bridgeSeed);
+
+    for (Size i = 0; i < steps_.size(); ++i) {
+        for (Size f = 0; f < factors_; ++f) {
+            const RandomVariable& v = variates[i][f];
+            for (Size p = 0; p < nPaths; ++p)
+                variates_[i][f * nPaths + p] = v[p];
+        }
+    }
+
+    evolveStates();
+}
+
+void CrossAssetStateBatchEvolver::evolveStates() {
+
+    const Size n = size();
+    const Size nPaths = nPaths_;
+
+    for (Size k = 0; k < n; ++k)
+        std::fill(states_[0].begin() + k * nPaths, states_[0].begin() + (k + 1) * nPaths, x0_[k]);
+
+    // evolve all paths, one time step at a time
+
+    for (Size i = 0; i < steps_.size(); ++i) {
+        const Real* x = states_[i].data();
+        const Real* dw = variates_[i].data();
+        Real* y = states_[i + 1].data();
+        const Step& step = steps_[i];
+        for (Size k = 0; k < n; ++k)
+            std::fill(y + k * nPaths, y + (k + 1) * nPaths, step.a[k]);
+        for (auto const& e : step.b) {
+            Real* yr = y + e.row * nPaths;
+            const Real* xc = x + e.col * nPaths;
+            const Real v = e.value;
+            for (Size p = 0; p < nPaths; ++p)
+                yr[p] += v * xc[p];
+        }
+        for (auto const& e : step.c) {
+            Real* yr = y + e.row * nPaths;
+            const Real* dwc = dw + e.col * nPaths;
+            const Real v = e.value;
+            for (Size p = 0; p < nPaths; ++p)
+                yr[p] += v * dwc[p];
+        }
+    }
+}
+
+MultiPathGeneratorBatched::MultiPathGeneratorBatched(const CrossAssetStateBatchEvolver& evolver, const SequenceType s,
+                                                     const BigNatural seed,
+                                                     const SobolBrownianGenerator::Ordering ordering,
+                                                     const SobolRsg::DirectionIntegers directionIntegers,
+                                                     const Size batchSize)
+    : evolver_(evolver), batchSize_(batchSize), coarseSteps_(coarseSteps), seed_(seed),
+      next_(MultiPath(evolver.size(), evolver.timeGrid()), 1.0) {
+    QL_REQUIRE(batchSize_ > 0, "MultiPathGeneratorBatched: batch size must be positive");
+    Size timeSteps = evolver.timeGrid().size() - 1;
+    if (!coarseSteps_.empty()) {
+        QL_REQUIRE(coarseSteps_.size() == timeSteps, "MultiPathGeneratorBatched: coarse steps size ("
+                                                         << coarseSteps_.size() << ") must match number of time steps ("
+                                                         << timeSteps << ")");
+        timeSteps = std::count(coarseSteps_.begin(), coarseSteps_.end(), true);
+        QL_REQUIRE(timeSteps > 0, "MultiPathGeneratorBatched: at least one coarse step required");
+    }
+    generator_ = makeMultiPathVariateGenerator(s, evolver.factors(), timeSteps, seed, ordering, directionIntegers);
+    reset();
+}
+
+void MultiPathGeneratorBatched::reset() {
+    generator_->reset();
+    bridgeSeeds_ = MersenneTwisterUniformRng(seed_);
+    currentPath_ = batchSize_;
+}
+
+const Sample<MultiPath>& MultiPathGeneratorBatched::next() const {
+    if (currentPath_ == batchSize_) {
+        if (coarseSteps_.empty())
+            evolver_.evolve(*generator_, batchSize_);
+        else
+            evolver_.evolve(*generator_, batchSize_, coarseSteps_, bridgeSeeds_.nextInt32());
+        currentPath_ = 0;
+    }
+    MultiPath& path = next_.value;
+    for (Size i = 0; i < path.pathSize(); ++i) {
+        const Real* s = evolver_.state(i);
+        for (Size k = 0; k < path.assetNumber(); ++k)
+            path[k][i] = s[k * batchSize_ + currentPath_];
+    }
+    next_.weight = evolver_.weight(currentPath_++);
+    return next_;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file multipathgeneratorbatched.hpp
+    \brief batched simulation of the cross asset model state process
+    \ingroup methods
+*/
+
+#pragma once
+
+#include <qle/methods/multipathgeneratorbase.hpp>
+#include <qle/methods/multipathvariategenerator.hpp>
+#include <qle/processes/crossassetstateprocess.hpp>
+
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+namespace QuantExt {
+
+/*! Evolves a batch of paths of a CrossAssetStateProcess over a time grid, one time step for all paths at a time.
+
+    The process step is affine, x(t+dt) = a + b * x(t) + c * dw, see CrossAssetStateProcess::affineStep(). The
+    coefficients are computed once per time step in the constructor and stored as lists of the non-zero entries. The
+    states and variates of a batch are held in buffers of layout [component][path], so that the update of one
+    component is a sequence of vectorisable loops over the paths. The buffers are reused over the batches, i.e. no
+    allocations happen per path or per time step once the batch size is stable.
+
+    The evolver only reads from the process in the constructor and can be copied to evolve batches concurrently. */
+class CrossAssetStateBatchEvolver {
+public:
+    CrossAssetStateBatchEvolver(const QuantLib::ext::shared_ptr<CrossAssetStateProcess>& process, const TimeGrid& grid);
+
+    Size size() const { return x0_.size(); }
+    Size factors() const { return factors_; }
+    const TimeGrid& timeGrid() const { return grid_; }
+
+    /*! evolves nPaths paths, drawing one sample per path from the generator, which must produce factors() variates
+        over timeGrid().size() - 1 time steps */
+    void evolve(const MultiPathVariateGeneratorBase& generator, const Size nPaths);
+
+    /*! as above, but the generator produces variates only for the time steps i with coarseSteps[i] = true, the
+        variates of the other time steps are filled in with a Brownian bridge using the given seed, see
+        interpolateVariatesWithBrownianBridge() */
+    void evolve(const MultiPathVariateGeneratorBase& generator, const Size nPaths, const std::vector<bool>& coarseSteps,
+                const BigNatural bridgeSeed);
+
+    //! number of paths in the last batch
+    Size paths() const { return nPaths_; }
+    //! states at time grid index i, component k of path p is at state(i)[k * paths() + p]
+    const Real* state(const Size i) const { return states_[i].data(); }
+    //! weight of path p of the last batch
+    Real weight(const Size p) const { return weights_[p]; }
+
+private:
+    void evolveStates();
+
+    struct Entry {
+        Size row, col;
+        Real value;
+    };
+    struct Step {
+        std::vector<Real> a;
+        std::vector<Entry> b, c;
+    };
+
+    TimeGrid grid_;
+    Size factors_;
+    Array x0_;
+    std::vector<Step> steps_;
+    Size nPaths_ = 0;
+    std::vector<std::vector<Real>> states_, variates_;
+    std::vector<Real> weights_;
+};
+
+/*! Multi path generator based on the CrossAssetStateBatchEvolver. The paths are generated in batches of batchSize
+    samples and then handed out one by one. The paths coincide with the ones produced by makeMultiPathGenerator() for
+    the same sequence type and seed up to rounding differences.
+
+    If coarseSteps is not empty, it must have one entry per time step of the evolver's time grid. The sequence
+    generator then only produces the variates for the time steps flagged true, e.g. the steps to the valuation dates
+    of an exposure simulation, and the variates of the remaining steps, e.g. to the close-out dates, are filled in
+    with a Brownian bridge. The dimension of the sequence, which matters for the low discrepancy sequences, is
+    therefore given by the coarse steps only, and the paths on the coarse steps do not depend on the refinement
+    in distribution. */
+class MultiPathGeneratorBatched : public MultiPathGeneratorBase {
+public:
+    MultiPathGeneratorBatched(const CrossAssetStateBatchEvolver& evolver, const SequenceType s, const BigNatural seed,
+                              const SobolBrownianGenerator::Ordering ordering,
+                              const SobolRsg::DirectionIntegers directionIntegers, const Size batchSize = 1024,
+                              const std::vector<bool>& coarseSteps = {});
+    const Sample<MultiPath>& next() const override;
+    void reset() override;
+
+private:
+    mutable CrossAssetStateBatchEvolver evolver_;
+    QuantLib::ext::shared_ptr<MultiPathVariateGeneratorBase> generator_;
+    Size batchSize_;
+    std::vector<bool> coarseSteps_;
+    BigNatural seed_;
+    mutable MersenneTwisterUniformRng bridgeSeeds_;
+    mutable Size currentPath_;
+    mutable Sample<MultiPath> next_;
+};
+
+} // namespace QuantExt
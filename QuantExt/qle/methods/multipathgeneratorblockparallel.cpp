@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/methods/multipathgeneratorblockparallel.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/settings.hpp>
+
+namespace QuantExt {
+
+MultiPathGeneratorBlockParallel::MultiPathGeneratorBlockParallel(
+    const std::function<QuantLib::ext::shared_ptr<MultiPathGeneratorBase>(Size)>& blockGenerator,
+    const Size blockSize, const Size nThreads)
+    : blockGenerator_(blockGenerator), blockSize_(blockSize), workers_(nThreads) {
+    QL_REQUIRE(blockGenerator_, "MultiPathGeneratorBlockParallel: no block generator given");
+    QL_REQUIRE(blockSize_ > 0, "MultiPathGeneratorBlockParallel: block size must be positive");
+    reset();
+}
+
+void MultiPathGeneratorBlockParallel::reset() {
+    buffer_.clear();
+    nextBlock_ = currentBlock_ = currentPath_ = 0;
+}
+
+void MultiPathGeneratorBlockParallel::skipTo(const Size path) {
+    buffer_.clear();
+    nextBlock_ = path / blockSize_;
+    generateBlocks();
+    currentPath_ = path % blockSize_;
+}
+
+void MultiPathGeneratorBlockParallel::generateBlocks() const {
+    std::vector<QuantLib::ext::shared_ptr<MultiPathGeneratorBase>> generators;
+    for (Size i = 0; i < workers_.nThreads(); ++i) {
+        generators.push_back(blockGenerator_(nextBlock_ + i));
+        QL_REQUIRE(generators.back(), "MultiPathGeneratorBlockParallel: block generator for block "
+                                          << nextBlock_ + i << " is null");
+    }
+    buffer_.resize(generators.size());
+    // the settings are thread local if QuantLib is built with sessions enabled, the workers take them from the
+    // calling thread, so that e.g. the reference dates of the term structures used by the processes coincide
+    Date asof = Settings::instance().evaluationDate();
+    bool includeReferenceDateEvents = Settings::instance().includeReferenceDateEvents();
+    auto includeTodaysCashFlows = Settings::instance().includeTodaysCashFlows();
+    bool enforcesTodaysHistoricFixings = Settings::instance().enforcesTodaysHistoricFixings();
+    workers_.run(generators.size(), [this, &generators, asof, includeReferenceDateEvents, includeTodaysCashFlows,
+                                     enforcesTodaysHistoricFixings](const std::size_t i) {
+        if (Settings::instance().evaluationDate() != asof)
+            Settings::instance().evaluationDate() = asof;
+        if (Settings::instance().includeReferenceDateEvents() != includeReferenceDateEvents)
+            Settings::instance().includeReferenceDateEvents() = includeReferenceDateEvents;
+        if (Settings::instance().includeTodaysCashFlows() != includeTodaysCashFlows)
+            Settings::instance().includeTodaysCashFlows() = includeTodaysCashFlows;
+        if (Settings::instance().enforcesTodaysHistoricFixings() != enforcesTodaysHistoricFixings)
+            Settings::instance().enforcesTodaysHistoricFixings() = enforcesTodaysHistoricFixings;
+        buffer_[i].clear();
+        buffer_[i].reserve(blockSize_);
+        for (Size j = 0; j < blockSize_; ++j)
+            buffer_[i].push_back(generators[i]->next());
+    });
+    nextBlock_ += generators.size();
+    currentBlock_ = currentPath_ = 0;
+}
+
+const Sample<MultiPath>& MultiPathGeneratorBlockParallel::next() const {
+    if (currentPath_ == blockSize_) {
+        currentPath_ = 0;
+        ++currentBlock_;
+    }
+    if (currentBlock_ >= buffer_.size())
+        generateBlocks();
+    return buffer_[currentBlock_][currentPath_++];
+}
+
+BigNatural MultiPathGeneratorBlockParallel::blockSeed(const BigNatural seed, const Size block) {
+    // splitmix64 finalizer applied to the combination of seed and block, a zero seed is avoided since this means
+    // a clock based seed for the QuantLib generators
+    unsigned long long z = static_cast<unsigned long long>(seed) * 0x9E3779B97F4A7C15ULL + block + 1;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    BigNatural result = static_cast<BigNatural>(z & 0xFFFFFFFFULL);
+    return result == 0 ? 1 : result;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,64 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file multipathgeneratorblockparallel.hpp
+    \brief multi path generator producing blocks of paths in parallel
+    \ingroup methods
+*/
+
+#pragma once
+
+#include <qle/math/chunkworkers.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+
+#include <functional>
+
+namespace QuantExt {
+
+/*! Multi path generator producing the paths in blocks of blockSize consecutive samples, where block b is generated by
+    the generator returned by blockGenerator(b). When the buffered paths are consumed, the next nThreads blocks are
+    generated in parallel. The block generators are created on the calling thread, but they are used concurrently,
+    so they must not share mutable state. In particular each block generator must use its own state process if this
+    uses a cache like the CrossAssetStateProcess.
+
+    The generated paths only depend on the block generators and the block size, but not on the number of threads.
+    The buffer holds nThreads * blockSize paths. */
+class MultiPathGeneratorBlockParallel : public MultiPathGeneratorBase {
+public:
+    MultiPathGeneratorBlockParallel(
+        const std::function<QuantLib::ext::shared_ptr<MultiPathGeneratorBase>(Size)>& blockGenerator,
+        const Size blockSize, const Size nThreads);
+    const Sample<MultiPath>& next() const override;
+    void reset() override;
+    //! generates the blocks from the one containing the given path on
+    void skipTo(const Size path) override;
+
+    //! deterministic seed for the pseudo random generator of a block, derived from the global seed
+    static BigNatural blockSeed(const BigNatural seed, const Size block);
+
+private:
+    void generateBlocks() const;
+
+    const std::function<QuantLib::ext::shared_ptr<MultiPathGeneratorBase>(Size)> blockGenerator_;
+    const Size blockSize_;
+    mutable ChunkWorkers workers_;
+    mutable std::vector<std::vector<Sample<MultiPath>>> buffer_;
+    mutable Size nextBlock_ = 0, currentBlock_ = 0, currentPath_ = 0;
+};
+
+} // namespace QuantExt
@@ -17,6 +17,13 @@
 */
 
 #include <qle/models/crossassetanalytics.hpp>
+#include <qle/models/eqbsconstantparametrization.hpp>
+#include <qle/models/eqbspiecewiseconstantparametrization.hpp>
+#include <qle/models/fxbsconstantparametrization.hpp>
+#include <qle/models/fxbspiecewiseconstantparametrization.hpp>
+#include <qle/models/irlgm1fconstantparametrization.hpp>
+#include <qle/models/irlgm1fpiecewiseconstantparametrization.hpp>
+#include <qle/models/irlgm1fpiecewiselinearparametrization.hpp>
 #include <qle/utilities/inflation.hpp>
 
 using std::make_pair;
@@ -740,5 +747,40 @@ Real crstate_crstate_covariance(const CrossAssetModel& x, const Size i, const Si
     return res;
 }
 
+Size ir_H_degree(const CrossAssetModel& x, const Size i) {
+    auto p = x.irlgm1f(i);
+    if (QuantLib::ext::dynamic_pointer_cast<IrLgm1fPiecewiseLinearParametrization>(p))
+        return 1;
+    // for a constant reversion H is linear only for a zero reversion, otherwise it is exponential
+    if (QuantLib::ext::dynamic_pointer_cast<IrLgm1fConstantParametrization>(p) && p->kappa(0.0) == 0.0)
+        return 1;
+    return Null<Size>();
+}
+
+Size ir_alpha_degree(const CrossAssetModel& x, const Size i) {
+    auto p = x.irlgm1f(i);
+    if (QuantLib::ext::dynamic_pointer_cast<IrLgm1fPiecewiseConstantParametrization>(p) ||
+        QuantLib::ext::dynamic_pointer_cast<IrLgm1fPiecewiseLinearParametrization>(p) ||
+        QuantLib::ext::dynamic_pointer_cast<IrLgm1fConstantParametrization>(p))
+        return 0;
+    return Null<Size>();
+}
+
+Size fx_sigma_degree(const CrossAssetModel& x, const Size i) {
+    auto p = x.fxbs(i);
+    if (QuantLib::ext::dynamic_pointer_cast<FxBsPiecewiseConstantParametrization>(p) ||
+        QuantLib::ext::dynamic_pointer_cast<FxBsConstantParametrization>(p))
+        return 0;
+    return Null<Size>();
+}
+
+Size eq_sigma_degree(const CrossAssetModel& x, const Size i) {
+    auto p = x.eqbs(i);
+    if (QuantLib::ext::dynamic_pointer_cast<EqBsPiecewiseConstantParametrization>(p) ||
+        QuantLib::ext::dynamic_pointer_cast<EqBsConstantParametrization>(p))
+        return 0;
+    return Null<Size>();
+}
+
 } // namespace CrossAssetAnalytics
 } // namespace QuantExt
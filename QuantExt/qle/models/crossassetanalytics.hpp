@@ -431,10 +431,18 @@ Real fx_crstate_covariance(const CrossAssetModel& model, const Size i, const Siz
 #/*! CrState_CrState Covariance */
 Real crstate_crstate_covariance(const CrossAssetModel& model, const Size i, const Size j, const Time t0, const Time dt);
 
+/*! polynomial degrees of the parametrization functions between consecutive parameter times, Null<Size>() if the
+    parametrization type is not known to give a polynomial */
+Size ir_H_degree(const CrossAssetModel& x, const Size i);
+Size ir_alpha_degree(const CrossAssetModel& x, const Size i);
+Size fx_sigma_degree(const CrossAssetModel& x, const Size i);
+Size eq_sigma_degree(const CrossAssetModel& x, const Size i);
+
 /*! IR H component */
 struct Hz {
     Hz(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel& x, const Real t) const { return x.irlgm1f(i_)->H(t); }
+    Size degree(const CrossAssetModel& x) const { return ir_H_degree(x, i_); }
     const Size i_;
 };
 
@@ -442,6 +450,7 @@ struct Hz {
 struct az {
     az(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel& x, const Real t) const { return x.irlgm1f(i_)->alpha(t); }
+    Size degree(const CrossAssetModel& x) const { return ir_alpha_degree(x, i_); }
     const Size i_;
 };
 
@@ -449,6 +458,10 @@ struct az {
 struct zetaz {
     zetaz(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel& x, const Real t) const { return x.irlgm1f(i_)->zeta(t); }
+    Size degree(const CrossAssetModel& x) const {
+        Size d = ir_alpha_degree(x, i_);
+        return d == Null<Size>() ? d : 2 * d + 1;
+    }
     const Size i_;
 };
 
@@ -456,6 +469,7 @@ struct zetaz {
 struct sx {
     sx(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel& x, const Real t) const { return x.fxbs(i_)->sigma(t); }
+    Size degree(const CrossAssetModel& x) const { return fx_sigma_degree(x, i_); }
     const Size i_;
 };
 
@@ -463,6 +477,10 @@ struct sx {
 struct vx {
     vx(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel& x, const Real t) const { return x.fxbs(i_)->variance(t); }
+    Size degree(const CrossAssetModel& x) const {
+        Size d = fx_sigma_degree(x, i_);
+        return d == Null<Size>() ? d : 2 * d + 1;
+    }
     const Size i_;
 };
 
@@ -567,6 +585,7 @@ struct zetal {
 struct ss {
     ss(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel& x, const Real t) const { return x.eqbs(i_)->sigma(t); }
+    Size degree(const CrossAssetModel& x) const { return eq_sigma_degree(x, i_); }
     const Size i_;
 };
 
@@ -574,6 +593,10 @@ struct ss {
 struct vs {
     vs(const Size i) : i_(i) {}
     Real eval(const CrossAssetModel& x, const Real t) const { return x.eqbs(i_)->variance(t); }
+    Size degree(const CrossAssetModel& x) const {
+        Size d = eq_sigma_degree(x, i_);
+        return d == Null<Size>() ? d : 2 * d + 1;
+    }
     const Size i_;
 };
 
@@ -590,6 +613,7 @@ struct rzz {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::IR, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -599,6 +623,7 @@ struct rzx {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::FX, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -608,6 +633,7 @@ struct rxx {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::FX, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -626,6 +652,7 @@ struct ryy {
         return x.correlation(CrossAssetModel::AssetType::INF, i_, CrossAssetModel::AssetType::INF, j_, iOffset_,
                              jOffset_);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
 
     QuantLib::Size i_;
     QuantLib::Size j_;
@@ -640,6 +667,7 @@ struct rzy {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::INF, j_, 0, jOffset_);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
 
     const Size i_, j_;
     QuantLib::Size jOffset_;
@@ -652,6 +680,7 @@ struct rxy {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::INF, j_, 0, jOffset_);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
 
     const Size i_, j_;
     QuantLib::Size jOffset_;
@@ -663,6 +692,7 @@ struct rll {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::CR, i_, CrossAssetModel::AssetType::CR, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -672,6 +702,7 @@ struct rzl {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::CR, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -681,6 +712,7 @@ struct rxl {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::CR, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -691,6 +723,7 @@ struct ryl {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::INF, i_, CrossAssetModel::AssetType::CR, j_, iOffset_, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
 
     const Size i_, j_;
     QuantLib::Size iOffset_;
@@ -702,6 +735,7 @@ struct rss {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::EQ, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -711,6 +745,7 @@ struct rzs {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -720,6 +755,7 @@ struct rxs {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -730,6 +766,7 @@ struct rys {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::INF, i_, CrossAssetModel::AssetType::EQ, j_, iOffset_, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
 
     const Size i_, j_;
     QuantLib::Size iOffset_;
@@ -741,6 +778,7 @@ struct rls {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::CR, i_, CrossAssetModel::AssetType::EQ, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -750,6 +788,7 @@ struct rcc {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::COM, i_, CrossAssetModel::AssetType::COM, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -767,6 +806,7 @@ struct rzcrs {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::IR, i_, CrossAssetModel::AssetType::CrState, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -776,6 +816,7 @@ struct rxcrs {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::FX, i_, CrossAssetModel::AssetType::CrState, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 
@@ -785,6 +826,7 @@ struct rccrs {
     Real eval(const CrossAssetModel& x, const Real) const {
         return x.correlation(CrossAssetModel::AssetType::CrState, i_, CrossAssetModel::AssetType::CrState, j_, 0, 0);
     }
+    Size degree(const CrossAssetModel&) const { return 0; }
     const Size i_, j_;
 };
 /*! @} */
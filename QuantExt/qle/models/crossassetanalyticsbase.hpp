@@ -24,12 +24,19 @@
 #ifndef quantext_crossasset_analytics_base_hpp
 #define quantext_crossasset_analytics_base_hpp
 
-#include <boost/bind/bind.hpp>
-
+#include <ql/math/comparison.hpp>
+#include <ql/math/integrals/gaussianquadratures.hpp>
 #include <ql/types.hpp>
+#include <ql/utilities/null.hpp>
 
 #include <qle/models/crossassetmodel.hpp>
 
+#include <algorithm>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -42,16 +49,47 @@ namespace CrossAssetAnalytics {
 /*! generic integrand */
 template <class E> Real integral_helper(const CrossAssetModel& x, const E& e, const Real t);
 
-/*! generic integral calculation */
+/*! generic integral calculation, expressions which are polynomials between consecutive parameter times of the model
+    (see degree()) are integrated exactly by a Gauss-Legendre rule on each of these intervals, all other expressions
+    with the integrator of the model */
 template <typename E>
 Real integral(const CrossAssetModel& model, const E& e, const Real a, const Real b);
 
+/*! polynomial degree of an expression between two consecutive parameter times of the model, Null<Size>() if the
+    expression is not known to be a polynomial there, expressions without a degree(const CrossAssetModel&) member are
+    treated as the latter */
+template <typename E> Size degree(const CrossAssetModel& model, const E& e);
+
+/*! degree of a product, resp. of a linear combination (including a constant) of expressions */
+inline Size productDegree(std::initializer_list<Size> degrees) {
+    Size result = 0;
+    for (auto d : degrees) {
+        if (d == Null<Size>())
+            return Null<Size>();
+        result += d;
+    }
+    return result;
+}
+
+inline Size linearCombinationDegree(std::initializer_list<Size> degrees) {
+    Size result = 0;
+    for (auto d : degrees) {
+        if (d == Null<Size>())
+            return Null<Size>();
+        result = std::max(result, d);
+    }
+    return result;
+}
+
 /*! product expression, 2 factors */
 template <typename E1, typename E2> struct P2_ {
     P2_(const E1& e1, const E2& e2) : e1_(e1), e2_(e2) {}
     Real eval(const CrossAssetModel& x, const Real t) const {
         return e1_.eval(x, t) * e2_.eval(x, t);
     }
+    Size degree(const CrossAssetModel& x) const {
+        return productDegree({CrossAssetAnalytics::degree(x, e1_), CrossAssetAnalytics::degree(x, e2_)});
+    }
     const E1& e1_;
     const E2& e2_;
 };
@@ -62,6 +100,11 @@ template <typename E1, typename E2, typename E3> struct P3_ {
     Real eval(const CrossAssetModel& x, const Real t) const {
         return e1_.eval(x, t) * e2_.eval(x, t) * e3_.eval(x, t);
     }
+    Size degree(const CrossAssetModel& x) const {
+        return productDegree({CrossAssetAnalytics::degree(x, e1_),
+                              CrossAssetAnalytics::degree(x, e2_),
+                              CrossAssetAnalytics::degree(x, e3_)});
+    }
     const E1& e1_;
     const E2& e2_;
     const E3& e3_;
@@ -73,6 +116,12 @@ template <typename E1, typename E2, typename E3, typename E4> struct P4_ {
     Real eval(const CrossAssetModel& x, const Real t) const {
         return e1_.eval(x, t) * e2_.eval(x, t) * e3_.eval(x, t) * e4_.eval(x, t);
     }
+    Size degree(const CrossAssetModel& x) const {
+        return productDegree({CrossAssetAnalytics::degree(x, e1_),
+                              CrossAssetAnalytics::degree(x, e2_),
+                              CrossAssetAnalytics::degree(x, e3_),
+                              CrossAssetAnalytics::degree(x, e4_)});
+    }
     const E1& e1_;
     const E2& e2_;
     const E3& e3_;
@@ -86,6 +135,13 @@ template <typename E1, typename E2, typename E3, typename E4, typename E5> struc
     Real eval(const CrossAssetModel& x, const Real t) const {
         return e1_.eval(x, t) * e2_.eval(x, t) * e3_.eval(x, t) * e4_.eval(x, t) * e5_.eval(x, t);
     }
+    Size degree(const CrossAssetModel& x) const {
+        return productDegree({CrossAssetAnalytics::degree(x, e1_),
+                              CrossAssetAnalytics::degree(x, e2_),
+                              CrossAssetAnalytics::degree(x, e3_),
+                              CrossAssetAnalytics::degree(x, e4_),
+                              CrossAssetAnalytics::degree(x, e5_)});
+    }
     const E1& e1_;
     const E2& e2_;
     const E3& e3_;
@@ -120,6 +176,10 @@ template <typename E1> struct LC1_ {
 
     Real eval(const CrossAssetModel& x, const Real t) const { return c_ + c1_ * e1_.eval(x, t); }
 
+    Size degree(const CrossAssetModel& x) const {
+        return linearCombinationDegree({CrossAssetAnalytics::degree(x, e1_)});
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -135,6 +195,10 @@ template <typename E1, typename E2> struct LC2_ {
         return c_ + c1_ * e1_.eval(x, t) + c2_ * e2_.eval(x, t);
     }
 
+    Size degree(const CrossAssetModel& x) const {
+        return linearCombinationDegree({CrossAssetAnalytics::degree(x, e1_), CrossAssetAnalytics::degree(x, e2_)});
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -153,6 +217,12 @@ template <typename E1, typename E2, typename E3> struct LC3_ {
         return c_ + c1_ * e1_.eval(x, t) + c2_ * e2_.eval(x, t) + c3_ * e3_.eval(x, t);
     }
 
+    Size degree(const CrossAssetModel& x) const {
+        return linearCombinationDegree({CrossAssetAnalytics::degree(x, e1_),
+                                        CrossAssetAnalytics::degree(x, e2_),
+                                        CrossAssetAnalytics::degree(x, e3_)});
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -173,6 +243,13 @@ template <typename E1, typename E2, typename E3, typename E4> struct LC4_ {
         return c_ + c1_ * e1_.eval(x, t) + c2_ * e2_.eval(x, t) + c3_ * e3_.eval(x, t) + c4_ * e4_.eval(x, t);
     }
 
+    Size degree(const CrossAssetModel& x) const {
+        return linearCombinationDegree({CrossAssetAnalytics::degree(x, e1_),
+                                        CrossAssetAnalytics::degree(x, e2_),
+                                        CrossAssetAnalytics::degree(x, e3_),
+                                        CrossAssetAnalytics::degree(x, e4_)});
+    }
+
     QuantLib::Real c_;
     QuantLib::Real c1_;
     E1 e1_;
@@ -213,9 +290,72 @@ template <class E> inline Real integral_helper(const CrossAssetModel& x, const E
     return e.eval(x, t);
 }
 
+namespace detail {
+
+template <class E, class = void> struct HasDegree : std::false_type {};
+template <class E>
+struct HasDegree<E, std::void_t<decltype(std::declval<const E&>().degree(std::declval<const CrossAssetModel&>()))>>
+    : std::true_type {};
+
+// nodes and weights of the Gauss-Legendre rules with 1, ..., maxPoints points on [-1, 1]
+struct GaussLegendreRules {
+    static constexpr Size maxPoints = 10;
+    GaussLegendreRules() {
+        for (Size n = 1; n <= maxPoints; ++n) {
+            GaussLegendreIntegration rule(n);
+            Array nodes = rule.x(), weights = rule.weights();
+            x.emplace_back(nodes.begin(), nodes.end());
+            w.emplace_back(weights.begin(), weights.end());
+        }
+    }
+    std::vector<std::vector<Real>> x, w;
+};
+
+inline const GaussLegendreRules& gaussLegendreRules() {
+    static const GaussLegendreRules rules;
+    return rules;
+}
+
+// integral of e over [a, b], a < b, with an n point Gauss-Legendre rule on each interval between parameter times
+template <class E>
+Real segmentwiseGaussLegendre(const CrossAssetModel& x, const E& e, const Real a, const Real b, const Size n) {
+    const std::vector<Real>& nodes = gaussLegendreRules().x[n - 1];
+    const std::vector<Real>& weights = gaussLegendreRules().w[n - 1];
+    const std::vector<Time>& times = x.parameterTimes();
+    Real result = 0.0;
+    Real t0 = a;
+    for (auto t = std::upper_bound(times.begin(), times.end(), a); t0 < b; ++t) {
+        Real t1 = t == times.end() || *t >= b ? b : *t;
+        Real h = 0.5 * (t1 - t0), m = 0.5 * (t0 + t1);
+        for (Size k = 0; k < n; ++k)
+            result += h * weights[k] * e.eval(x, m + h * nodes[k]);
+        t0 = t1;
+        if (t == times.end())
+            break;
+    }
+    return result;
+}
+
+} // namespace detail
+
+template <class E> inline Size degree(const CrossAssetModel& x, const E& e) {
+    if constexpr (detail::HasDegree<E>::value)
+        return e.degree(x);
+    else
+        return Null<Size>();
+}
+
 template <class E>
 inline Real integral(const CrossAssetModel& x, const E& e, const Real a, const Real b) {
-    return x.integrator()->operator()(QuantLib::ext::bind(&integral_helper<E>, x, e, QuantLib::ext::placeholders::_1), a, b);
+    // an n point rule is exact for polynomials up to degree 2n - 1
+    Size d = degree(x, e);
+    if (d != Null<Size>() && d < 2 * detail::GaussLegendreRules::maxPoints) {
+        if (close_enough(a, b))
+            return 0.0;
+        return a < b ? detail::segmentwiseGaussLegendre(x, e, a, b, d / 2 + 1)
+                     : -detail::segmentwiseGaussLegendre(x, e, b, a, d / 2 + 1);
+    }
+    return x.integrator()->operator()([&x, &e](const Real t) { return e.eval(x, t); }, a, b);
 }
 
 /*! @} */
@@ -23,10 +23,13 @@
 #include <qle/utilities/inflation.hpp>
 
 #include <ql/experimental/math/piecewiseintegral.hpp>
+#include <ql/math/comparison.hpp>
 #include <ql/math/integrals/simpsonintegral.hpp>
 #include <ql/math/matrixutilities/symmetricschurdecomposition.hpp>
 #include <ql/processes/eulerdiscretization.hpp>
 
+#include <algorithm>
+
 using namespace QuantExt::CrossAssetAnalytics;
 using std::map;
 using std::vector;
@@ -277,19 +280,24 @@ void CrossAssetModel::initDefaultIntegrator() {
 void CrossAssetModel::setIntegrationPolicy(const QuantLib::ext::shared_ptr<Integrator> integrator,
                                            const bool usePiecewiseIntegration) const {
 
-    if (!usePiecewiseIntegration) {
-        integrator_ = integrator;
-        return;
-    }
-
-    // collect relevant times from parametrizations, we don't have to sort them or make them unique,
-    // this is all done in PiecewiseIntegral for us
+    // collect relevant times from parametrizations, PiecewiseIntegral sorts them and makes them unique itself, the
+    // sorted times are kept for the segment wise integration in CrossAssetAnalytics::integral()
 
     std::vector<Time> allTimes;
     for (Size i = 0; i < p_.size(); ++i) {
         for (Size j = 0; j < getNumberOfParameters(i); ++j)
             allTimes.insert(allTimes.end(), p_[i]->parameterTimes(j).begin(), p_[i]->parameterTimes(j).end());
     }
+    parameterTimes_ = allTimes;
+    std::sort(parameterTimes_.begin(), parameterTimes_.end());
+    parameterTimes_.erase(std::unique(parameterTimes_.begin(), parameterTimes_.end(),
+                                      [](const Time s, const Time t) { return QuantLib::close_enough(s, t); }),
+                          parameterTimes_.end());
+
+    if (!usePiecewiseIntegration) {
+        integrator_ = integrator;
+        return;
+    }
 
     // use piecewise integrator avoiding the step points
     integrator_ = QuantLib::ext::make_shared<PiecewiseIntegral>(integrator, allTimes, true);
@@ -272,6 +272,10 @@ public:
                               const bool usePiecewiseIntegration = true) const;
     const QuantLib::ext::shared_ptr<Integrator> integrator() const;
 
+    /*! the parameter times of all parametrizations, sorted and unique, between two consecutive times piecewise
+        constant parametrizations are constant, see CrossAssetAnalytics::integral() */
+    const std::vector<Time>& parameterTimes() const { return parameterTimes_; }
+
     /*! return (V(t), V^tilde(t,T)) in the notation of the book */
     std::pair<Real, Real> infdkV(const Size i, const Time t, const Time T);
 
@@ -498,6 +502,7 @@ protected:
     IrModel::Measure measure_;
     Discretization discretization_;
     mutable QuantLib::ext::shared_ptr<Integrator> integrator_;
+    mutable std::vector<Time> parameterTimes_;
     mutable QuantLib::ext::shared_ptr<CrossAssetStateProcess> stateProcess_;
 
     void appendToFixedParameterVector(const AssetType t, const AssetType v, const Size param, const Size index,
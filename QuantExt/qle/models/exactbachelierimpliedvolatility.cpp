@@ -90,4 +90,12 @@ Real exactBachelierImpliedVolatility(Option::Type optionType, Real strike, Real
     return impliedVol;
 }
 
+void exactBachelierImpliedVolatilities(Option::Type optionType, const Real* strikes, const Real* forwards,
+                                       const Real* ttes, const Real* bachelierPrices, const Real* discounts, Size n,
+                                       Real* impliedVols) {
+    for (Size i = 0; i < n; ++i)
+        impliedVols[i] = exactBachelierImpliedVolatility(optionType, strikes[i], forwards[i], ttes[i],
+                                                         bachelierPrices[i], discounts[i]);
+}
+
 } // namespace QuantExt
@@ -33,4 +33,9 @@ using namespace QuantLib;
 Real exactBachelierImpliedVolatility(Option::Type optionType, Real strike, Real forward, Real tte, Real bachelierPrice,
                                      Real discount = 1.0);
 
+//! Implied bachelier volatilities of n options of one type, see exactBachelierImpliedVolatility()
+void exactBachelierImpliedVolatilities(Option::Type optionType, const Real* strikes, const Real* forwards,
+                                       const Real* ttes, const Real* bachelierPrices, const Real* discounts, Size n,
+                                       Real* impliedVols);
+
 } // namespace QuantExt
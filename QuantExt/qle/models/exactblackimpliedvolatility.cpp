@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/models/exactblackimpliedvolatility.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/math/distributions/normal.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+namespace {
+
+static boost::math::normal_distribution<double> normal_dist;
+Real Phi(const Real x) { return boost::math::cdf(normal_dist, x); }
+Real inversePhi(const Real p) { return boost::math::quantile(normal_dist, p); }
+
+// normalised out of the money call price b(x,s) = exp(x/2) Phi(x/s+s/2) - exp(-x/2) Phi(x/s-s/2), x <= 0, s > 0
+Real normalisedCall(const Real x, const Real s) {
+    return std::exp(0.5 * x) * Phi(x / s + 0.5 * s) - std::exp(-0.5 * x) * Phi(x / s - 0.5 * s);
+}
+
+// exp(x/2) - b(x,s) computed without cancellation
+Real normalisedCallComplement(const Real x, const Real s) {
+    return std::exp(0.5 * x) * Phi(-x / s - 0.5 * s) + std::exp(-0.5 * x) * Phi(x / s - 0.5 * s);
+}
+
+// db/ds
+Real normalisedVega(const Real x, const Real s) {
+    static const Real oneOverSqrtTwoPi = 0.3989422804014326779399461;
+    return oneOverSqrtTwoPi * std::exp(-0.5 * (x * x / (s * s) + 0.25 * s * s));
+}
+
+// solves b(x,s) = beta for s, x <= 0, 0 < beta < exp(x/2)
+Real normalisedImpliedStdDev(const Real x, const Real beta) {
+
+    const Real eps = std::numeric_limits<Real>::epsilon();
+    const Real bMax = std::exp(0.5 * x);
+
+    // the inflection point of b(x, .) separates the lower and upper branch
+
+    const Real sc = std::sqrt(2.0 * std::abs(x));
+    const bool lower = sc > 0.0 && beta < normalisedCall(x, sc);
+
+    // objective (increasing in s) and its derivative on the branch: log b(s) - log beta on the lower branch,
+    // log (bMax - beta) - log (bMax - b(s)) on the upper branch
+
+    const Real target = lower ? std::log(beta) : std::log(bMax - beta);
+    auto objective = [x, lower, target](const Real s, Real& derivative) {
+        Real v = normalisedVega(x, s);
+        if (lower) {
+            Real b = normalisedCall(x, s);
+            derivative = v / b;
+            return std::log(b) - target;
+        } else {
+            Real c = normalisedCallComplement(x, s);
+            derivative = v / c;
+            return target - std::log(c);
+        }
+    };
+
+    // bracket and initial guess from the asymptotics b ~ exp(-x^2 / (2 s^2)) for s -> 0 resp.
+    // bMax - b ~ 2 cosh(x/2) Phi(-s/2) for s -> infinity
+
+    Real lo, hi, s;
+    if (lower) {
+        lo = 0.0;
+        hi = sc;
+        s = std::abs(x) / std::sqrt(-2.0 * std::log(beta));
+    } else {
+        lo = sc;
+        hi = std::max(2.0 * sc, 1.0);
+        Real d;
+        while (objective(hi, d) < 0.0) {
+            lo = hi;
+            hi *= 2.0;
+            QL_REQUIRE(hi < 1E10, "exactBlackImpliedStdDev: can not bracket implied std dev (x=" << x
+                                                                                                  << ", beta=" << beta
+                                                                                                  << ")");
+        }
+        s = -2.0 * inversePhi(std::min(0.5, (bMax - beta) / (2.0 * std::cosh(0.5 * x))));
+    }
+    if (!(s > lo && s < hi))
+        s = 0.5 * (lo + hi);
+
+    for (Size iter = 0; iter < 100; ++iter) {
+        Real d;
+        Real f = objective(s, d);
+        if (f == 0.0)
+            return s;
+        if (f < 0.0)
+            lo = s;
+        else
+            hi = s;
+        Real sNew = s - f / d;
+        // bisect if the Newton step leaves the bracket
+        if (!(sNew > lo && sNew < hi))
+            sNew = 0.5 * (lo + hi);
+        if (std::abs(sNew - s) <= 4.0 * eps * s || hi - lo <= 4.0 * eps * hi)
+            return sNew;
+        s = sNew;
+    }
+
+    QL_FAIL("exactBlackImpliedStdDev: no convergence (x=" << x << ", beta=" << beta << ")");
+}
+
+} // namespace
+
+Real exactBlackImpliedStdDev(Option::Type optionType, Real strike, Real forward, Real blackPrice, Real discount,
+                             Real displacement) {
+
+    QL_REQUIRE(discount > 0.0, "exactBlackImpliedStdDev: discount (" << discount << ") must be positive");
+    QL_REQUIRE(strike + displacement > 0.0, "exactBlackImpliedStdDev: strike + displacement ("
+                                               << strike << " + " << displacement << ") must be positive");
+    QL_REQUIRE(forward + displacement > 0.0, "exactBlackImpliedStdDev: forward + displacement ("
+                                                << forward << " + " << displacement << ") must be positive");
+
+    Real theta = optionType == Option::Call ? 1.0 : -1.0;
+    Real f = forward + displacement, k = strike + displacement;
+
+    // compound the price, so that effectively discount = 1, and check the bounds
+
+    Real price = blackPrice / discount;
+    Real intrinsic = std::max(theta * (f - k), 0.0);
+    Real upperBound = optionType == Option::Call ? f : k;
+    QL_REQUIRE(price < upperBound, "exactBlackImpliedStdDev(theta="
+                                       << theta << ",strike=" << strike << ",forward=" << forward
+                                       << ",price=" << blackPrice << "): price exceeds upper bound (" << upperBound
+                                       << ")");
+
+    // a time value within the rounding error of the intrinsic value implies a zero std dev
+
+    Real timeValue = price - intrinsic;
+    if (std::abs(timeValue) <= 1E-14 * intrinsic || timeValue == 0.0)
+        return 0.0;
+    QL_REQUIRE(timeValue > 0.0, "exactBlackImpliedStdDev(theta="
+                                    << theta << ",strike=" << strike << ",forward=" << forward
+                                    << ",price=" << blackPrice << "): option price implies negative time value ("
+                                    << timeValue << ")");
+
+    // normalise and reduce to an out of the money call, the time value of an in the money option is the price of
+    // the out of the money option of the other type, and b(x, s, -theta) = b(-x, s, theta)
+
+    Real sqrtFK = std::sqrt(f * k);
+    Real x = -std::abs(std::log(f / k));
+    Real beta = timeValue / sqrtFK;
+
+    return normalisedImpliedStdDev(x, std::min(beta, std::exp(0.5 * x) * (1.0 - 1E-16)));
+}
+
+Real exactBlackImpliedVolatility(Option::Type optionType, Real strike, Real forward, Real tte, Real blackPrice,
+                                 Real discount, Real displacement) {
+    QL_REQUIRE(tte > 0.0, "exactBlackImpliedVolatility: time to expiry (" << tte << ") must be positive");
+    return exactBlackImpliedStdDev(optionType, strike, forward, blackPrice, discount, displacement) / std::sqrt(tte);
+}
+
+void exactBlackImpliedStdDevs(Option::Type optionType, const Real* strikes, const Real* forwards,
+                              const Real* blackPrices, const Real* discounts, Size n, Real* stdDevs,
+                              Real displacement) {
+    for (Size i = 0; i < n; ++i)
+        stdDevs[i] = exactBlackImpliedStdDev(optionType, strikes[i], forwards[i], blackPrices[i], discounts[i],
+                                             displacement);
+}
+
+} // namespace QuantExt
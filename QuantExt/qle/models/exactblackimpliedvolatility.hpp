@@ -0,0 +1,53 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file models/exactblackimpliedvolatility.hpp
+    \brief implied black volatility from a non-iterative guess and a safeguarded Newton iteration
+    \ingroup models
+*/
+
+#pragma once
+
+#include <ql/option.hpp>
+#include <ql/types.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+/*! Implied (shifted) lognormal standard deviation of a Black price. The problem is normalised and reduced to an out
+    of the money call as in Jaeckel, Let's Be Rational, 2015. The iteration is carried out on the log of the
+    normalised price (lower branch) resp. the log of its distance to the upper price bound (upper branch), starting
+    from the asymptotic solutions of the two branches, so that it converges to machine precision in a few Newton
+    steps. Bisection within the branch bracket is used as a safeguard.
+
+    A price equal to the intrinsic value returns zero, a price above the upper bound or below the intrinsic value
+    throws. */
+Real exactBlackImpliedStdDev(Option::Type optionType, Real strike, Real forward, Real blackPrice,
+                             Real discount = 1.0, Real displacement = 0.0);
+
+//! Implied (shifted) lognormal volatility, i.e. the implied std dev divided by the square root of the time to expiry
+Real exactBlackImpliedVolatility(Option::Type optionType, Real strike, Real forward, Real tte, Real blackPrice,
+                                 Real discount = 1.0, Real displacement = 0.0);
+
+//! Implied std devs of n options of one type, see exactBlackImpliedStdDev()
+void exactBlackImpliedStdDevs(Option::Type optionType, const Real* strikes, const Real* forwards,
+                              const Real* blackPrices, const Real* discounts, Size n, Real* stdDevs,
+                              Real displacement = 0.0);
+
+} // namespace QuantExt
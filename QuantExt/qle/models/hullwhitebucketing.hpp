@@ -27,6 +27,10 @@
 #include <ql/math/array.hpp>
 #include <ql/math/comparison.hpp>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -107,30 +111,44 @@ template <class I1, class I2> void HullWhiteBucketing::compute(I1 pdBegin, I1 pd
 
 template <class I1, class I2> void HullWhiteBucketing::computeMultiState(I1 pBegin, I1 pEnd, I2 lossesBegin) {
     init_p_A();
-    Array A2(A_.size()), p2(p_.size());
+    Array A2(A_.size(), 0.0), p2(p_.size(), 0.0);
+    std::vector<std::pair<Real, Real>> states;
+
+    // range of buckets which can have a non-zero probability
+    Size kmin = index(0.0), kmax = kmin;
 
     auto it2 = lossesBegin;
     for (auto it = pBegin; it != pEnd; ++it, ++it2) {
-        std::fill(A2.begin(), A2.end(), 0.0);
-        std::fill(p2.begin(), p2.end(), 0.0);
-        for (Size k = 0; k < buckets_.size(); ++k) {
+        // the states with non-zero probability and loss do not depend on the bucket, collect them once
+        states.clear();
+        auto it2_i = (*it2).begin();
+        for (auto it_i = (*it).begin(), itend = (*it).end(); it_i != itend; ++it_i, ++it2_i) {
+            if (!QuantLib::close_enough(*it_i, 0.0) && !QuantLib::close_enough(*it2_i, 0.0))
+                states.push_back(std::make_pair(*it_i, *it2_i));
+        }
+        Size newMin = kmin, newMax = kmax;
+        for (Size k = kmin; k <= kmax; ++k) {
             if (QuantLib::close_enough(p_[k], 0.0))
                 continue;
             Real q = 0.0;
-            auto it2_i = (*it2).begin();
-            for (auto it_i = (*it).begin(), itend = (*it).end(); it_i != itend; ++it_i, ++it2_i) {
-                if (QuantLib::close_enough(*it_i, 0.0) || QuantLib::close_enough(*it2_i, 0.0))
-                    continue;
-                Size t = index(A_[k] / p_[k] + *it2_i);
-                p2[t] += p_[k] * (*it_i);
-                A2[t] += (*it_i) * (A_[k] + p_[k] * (*it2_i));
-                q += *it_i;
+            for (auto const& s : states) {
+                Size t = index(A_[k] / p_[k] + s.second);
+                p2[t] += p_[k] * s.first;
+                A2[t] += s.first * (A_[k] + p_[k] * s.second);
+                q += s.first;
+                newMin = std::min(newMin, t);
+                newMax = std::max(newMax, t);
             }
             p2[k] += p_[k] * (1.0 - q);
             A2[k] += A_[k] * (1.0 - q);
         }
-        std::copy(A2.begin(), A2.end(), A_.begin());
-        std::copy(p2.begin(), p2.end(), p_.begin());
+        p_.swap(p2);
+        A_.swap(A2);
+        // the previous distribution is non-zero on [kmin, kmax] only, reset it for the next step
+        std::fill(p2.begin() + kmin, p2.begin() + kmax + 1, 0.0);
+        std::fill(A2.begin() + kmin, A2.begin() + kmax + 1, 0.0);
+        kmin = newMin;
+        kmax = newMax;
     } // for it
 
     finalize_p_A();
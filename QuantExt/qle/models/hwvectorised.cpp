@@ -0,0 +1,193 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/models/hwvectorised.hpp>
+
+#include <ql/indexes/indexmanager.hpp>
+#include <ql/settings.hpp>
+
+namespace QuantExt {
+
+HwVectorised::DiscountBondFactors
+HwVectorised::discountBondFactors(const Time t, const Time T, const Handle<YieldTermStructure>& discountCurve) const {
+    QL_REQUIRE(T >= t && t >= 0.0, "T(" << T << ") >= t(" << t << ") >= 0 required in HwVectorised::discountBond");
+    DiscountBondFactors f;
+    f.g = p_->g(t, T);
+    f.halfVariance = 0.5 * DotProduct(f.g, p_->y(t) * f.g);
+    f.marketRatio = discountCurve.empty() ? p_->termStructure()->discount(T) / p_->termStructure()->discount(t)
+                                          : discountCurve->discount(T) / discountCurve->discount(t);
+    return f;
+}
+
+RandomVariable HwVectorised::numeraire(const Time t, const std::vector<RandomVariable>& aux,
+                                       const Handle<YieldTermStructure>& discountCurve) const {
+    QL_REQUIRE(t >= 0.0, "t (" << t << ") >= 0 required in HwVectorised::numeraire");
+    QL_REQUIRE(aux.size() == p_->n(), "HwVectorised::numeraire(): aux size ("
+                                          << aux.size() << ") does not match number of factors (" << p_->n()
+                                          << "), is the bank account evaluated in the model?");
+    Size size = aux.front().size();
+    RandomVariable logBankAccount(size, 0.0);
+    for (auto const& a : aux)
+        logBankAccount += a;
+    return exp(logBankAccount) /
+           RandomVariable(size, discountCurve.empty() ? p_->termStructure()->discount(t) : discountCurve->discount(t));
+}
+
+RandomVariable HwVectorised::discountBond(const Time t, const Time T, const std::vector<RandomVariable>& x,
+                                          const Handle<YieldTermStructure>& discountCurve) const {
+    QL_REQUIRE(!x.empty(), "HwVectorised::discountBond(): empty state");
+    if (QuantLib::close_enough(t, T))
+        return RandomVariable(x.front().size(), 1.0);
+    return discountBond(discountBondFactors(t, T, discountCurve), x);
+}
+
+RandomVariable HwVectorised::discountBond(const DiscountBondFactors& f, const std::vector<RandomVariable>& x) const {
+    QL_REQUIRE(x.size() == f.g.size(), "HwVectorised::discountBond(): state size ("
+                                           << x.size() << ") does not match number of factors (" << f.g.size()
+                                           << ")");
+    Size size = x.front().size();
+    RandomVariable exponent(size, -f.halfVariance);
+    for (Size i = 0; i < x.size(); ++i)
+        exponent -= RandomVariable(size, f.g[i]) * x[i];
+    return RandomVariable(size, f.marketRatio) * exp(exponent);
+}
+
+Real HwVectorised::discountBond(const DiscountBondFactors& f, const Array& x) const {
+    QL_REQUIRE(x.size() == f.g.size(), "HwVectorised::discountBond(): state size ("
+                                           << x.size() << ") does not match number of factors (" << f.g.size()
+                                           << ")");
+    return f.marketRatio * std::exp(-DotProduct(f.g, x) - f.halfVariance);
+}
+
+RandomVariable HwVectorised::reducedDiscountBond(const Time t, const Time T, const std::vector<RandomVariable>& x,
+                                                 const std::vector<RandomVariable>& aux,
+                                                 const Handle<YieldTermStructure>& discountCurve) const {
+    return discountBond(t, T, x, discountCurve) / numeraire(t, aux, discountCurve);
+}
+
+RandomVariable HwVectorised::compoundedOnRate(const QuantLib::ext::shared_ptr<OvernightIndex>& index,
+                                              const std::vector<Date>& fixingDates,
+                                              const std::vector<Date>& valueDates, const std::vector<Real>& dt,
+                                              const Natural rateCutoff, const bool includeSpread, const Real spread,
+                                              const Real gearing, const Time t,
+                                              const std::vector<RandomVariable>& x) const {
+
+    QL_REQUIRE(!x.empty(), "HwVectorised::compoundedOnRate(): empty state");
+
+    QL_REQUIRE(!includeSpread || QuantLib::close_enough(gearing, 1.0),
+               "HwVectorised::compoundedOnRate(): if include spread = true, only a gearing 1.0 is allowed - scale "
+               "the notional in this case instead.");
+
+    QL_REQUIRE(rateCutoff < dt.size(), "HwVectorised::compoundedOnRate(): rate cutoff ("
+                                           << rateCutoff << ") must be less than number of fixings in period ("
+                                           << dt.size() << ")");
+
+    // the following follows LgmVectorised::compoundedOnRate()
+
+    Size i = 0, n = dt.size();
+    Size nCutoff = n - rateCutoff;
+    Size size = x.front().size();
+    Real compoundFactor = 1.0, compoundFactorWithoutSpread = 1.0;
+
+    Date today = Settings::instance().evaluationDate();
+
+    while (i < n && fixingDates[std::min(i, nCutoff)] < today) {
+        Rate pastFixing = IndexManager::instance().getHistory(index->name())[fixingDates[std::min(i, nCutoff)]];
+        QL_REQUIRE(pastFixing != Null<Real>(), "HwVectorised::compoundedOnRate(): Missing "
+                                                   << index->name() << " fixing for "
+                                                   << fixingDates[std::min(i, nCutoff)]);
+        if (includeSpread) {
+            compoundFactorWithoutSpread *= (1.0 + pastFixing * dt[i]);
+            pastFixing += spread;
+        }
+        compoundFactor *= (1.0 + pastFixing * dt[i]);
+        ++i;
+    }
+
+    if (i < n && fixingDates[std::min(i, nCutoff)] == today) {
+        Rate pastFixing = IndexManager::instance().getHistory(index->name())[fixingDates[std::min(i, nCutoff)]];
+        if (pastFixing != Null<Real>()) {
+            if (includeSpread) {
+                compoundFactorWithoutSpread *= (1.0 + pastFixing * dt[i]);
+                pastFixing += spread;
+            }
+            compoundFactor *= (1.0 + pastFixing * dt[i]);
+            ++i;
+        }
+    }
+
+    RandomVariable compoundFactorHw(size, compoundFactor),
+        compoundFactorWithoutSpreadHw(size, compoundFactorWithoutSpread);
+
+    if (i < n) {
+        Handle<YieldTermStructure> curve = index->forwardingTermStructure();
+        QL_REQUIRE(!curve.empty(),
+                   "HwVectorised::compoundedOnRate(): null term structure set to this instance of " << index->name());
+
+        DiscountFactor startDiscount = curve->discount(valueDates[i]);
+        DiscountFactor endDiscount = curve->discount(valueDates[std::max(nCutoff, i)]);
+
+        if (nCutoff < n) {
+            DiscountFactor discountCutoffDate =
+                curve->discount(valueDates[nCutoff] + 1) / curve->discount(valueDates[nCutoff]);
+            endDiscount *= std::pow(discountCutoffDate, valueDates[n] - valueDates[nCutoff]);
+        }
+
+        // the times associated to the projection on the T0 curve
+
+        Real T1 = p_->termStructure()->timeFromReference(valueDates[i]);
+        Real T2 = p_->termStructure()->timeFromReference(valueDates[n]);
+
+        // the times we use for the projection in the HW model, if t > T1 they are displaced by (t-T1)
+
+        Real T1_hw = T1, T2_hw = T2;
+        if (t > T1) {
+            T1_hw += t - T1;
+            T2_hw += t - T1;
+        }
+
+        // the compound factor P(t,T1) / P(t,T2) estimated in the hw model, corrected to the forwarding curve
+
+        DiscountBondFactors f1 = discountBondFactors(t, T1_hw, curve);
+        DiscountBondFactors f2 = discountBondFactors(t, T2_hw, curve);
+        DiscountBondFactors f;
+        f.g = f1.g - f2.g;
+        f.halfVariance = f1.halfVariance - f2.halfVariance;
+        f.marketRatio = startDiscount / endDiscount;
+
+        RandomVariable fwdCompoundFactor = discountBond(f, x);
+        compoundFactorHw *= fwdCompoundFactor;
+
+        if (includeSpread) {
+            compoundFactorWithoutSpreadHw *= fwdCompoundFactor;
+            Real tau = index->dayCounter().yearFraction(valueDates[i], valueDates.back()) /
+                       (valueDates.back() - valueDates[i]);
+            compoundFactorHw *=
+                RandomVariable(size, std::pow(1.0 + tau * spread, static_cast<int>(valueDates.back() - valueDates[i])));
+        }
+    }
+
+    Rate tau = index->dayCounter().yearFraction(valueDates.front(), valueDates.back());
+    RandomVariable rate = (compoundFactorHw - RandomVariable(size, 1.0)) / RandomVariable(size, tau);
+    RandomVariable swapletRate = RandomVariable(size, gearing) * rate;
+    if (!includeSpread)
+        swapletRate += RandomVariable(size, spread);
+    return swapletRate;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,85 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file models/hwvectorised.hpp
+    \brief vectorised hull white n factor model calculations
+    \ingroup models
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+#include <qle/models/hwparametrization.hpp>
+
+#include <ql/indexes/iborindex.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+class HwVectorised {
+public:
+    /* State independent factors of a zero bond P(t,T) = marketRatio * exp( -g(t,T)' x - halfVariance ) with
+       marketRatio = P(0,T) / P(0,t) and halfVariance = 0.5 g(t,T)' y(t) g(t,T). These can be built once per
+       (t,T) and reused for all states resp. paths. */
+    struct DiscountBondFactors {
+        Array g;
+        Real halfVariance = 0.0;
+        Real marketRatio = 1.0;
+    };
+
+    HwVectorised() = default;
+    HwVectorised(const QuantLib::ext::shared_ptr<IrHwParametrization>& p) : p_(p) {}
+
+    QuantLib::ext::shared_ptr<IrHwParametrization> parametrization() const { return p_; }
+
+    DiscountBondFactors
+    discountBondFactors(const Time t, const Time T,
+                        const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>()) const;
+
+    /* numeraire in the BA measure, aux are the integrated states (the components of the log bank account) */
+    RandomVariable numeraire(const Time t, const std::vector<RandomVariable>& aux,
+                             const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>()) const;
+
+    RandomVariable discountBond(const Time t, const Time T, const std::vector<RandomVariable>& x,
+                                const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>()) const;
+
+    /* zero bond from precomputed factors, x are the n state variables */
+    RandomVariable discountBond(const DiscountBondFactors& f, const std::vector<RandomVariable>& x) const;
+
+    /* zero bond from precomputed factors for a single state, as HwModel::discountBond() */
+    Real discountBond(const DiscountBondFactors& f, const Array& x) const;
+
+    RandomVariable
+    reducedDiscountBond(const Time t, const Time T, const std::vector<RandomVariable>& x,
+                        const std::vector<RandomVariable>& aux,
+                        const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>()) const;
+
+    /* Exact if t <= first value date, for t > first value date the same approximation as in
+       LgmVectorised::compoundedOnRate() is applied. Caps / floors are not supported. */
+    RandomVariable compoundedOnRate(const QuantLib::ext::shared_ptr<OvernightIndex>& index,
+                                    const std::vector<Date>& fixingDates, const std::vector<Date>& valueDates,
+                                    const std::vector<Real>& dt, const Natural rateCutoff, const bool includeSpread,
+                                    const Real spread, const Real gearing, const Time t,
+                                    const std::vector<RandomVariable>& x) const;
+
+private:
+    QuantLib::ext::shared_ptr<IrHwParametrization> p_;
+};
+
+} // namespace QuantExt
@@ -17,8 +17,11 @@
 */
 
 #include <qle/models/infdkvectorised.hpp>
+#include <qle/models/lgmvectorised.hpp>
 #include <qle/utilities/inflation.hpp>
 
+#include <map>
+
 namespace QuantExt {
 
 	InfDkVectorised::InfDkVectorised(const QuantLib::ext::shared_ptr<CrossAssetModel>& cam)
@@ -59,5 +62,31 @@ namespace QuantExt {
             return std::make_pair(It, Itilde_t_T);
 	}
 
+std::vector<RandomVariable> InfDkVectorised::infdkYY(const Size i, const Time t, const std::vector<Time>& S,
+                                                     const std::vector<Time>& T, const RandomVariable& z,
+                                                     const RandomVariable& y, const RandomVariable& irz,
+                                                     bool indexIsInterpolated) const {
+    QL_REQUIRE(S.size() == T.size(), "InfDkVectorised::infdkYY(): start times (" << S.size() << ") and end times ("
+                                                                                 << T.size() << ") mismatch");
+
+    // consecutive yoy periods share their start and end times, so we cache Itilde(t, .) per time
+    std::map<Time, RandomVariable> Itilde;
+    auto getItilde = [this, &Itilde, i, t, &z, &y, indexIsInterpolated](const Time u) -> const RandomVariable& {
+        auto it = Itilde.find(u);
+        if (it == Itilde.end())
+            it = Itilde.emplace(u, infdkI(i, t, u, z, y, indexIsInterpolated).second).first;
+        return it->second;
+    };
+
+    // as in CrossAssetModel::infdkYY() the convexity adjustment is set to 1
+    LgmVectorised lgm(cam_->irlgm1f(cam_->ccyIndex(cam_->infdk(i)->currency())));
+    std::vector<RandomVariable> result;
+    result.reserve(S.size());
+    for (Size k = 0; k < S.size(); ++k) {
+        RandomVariable Pn_t_T = lgm.discountBond(t, T[k], irz);
+        result.push_back(getItilde(T[k]) / getItilde(S[k]) * Pn_t_T - Pn_t_T);
+    }
+    return result;
+}
 
 } // namespace QuantExt
@@ -40,6 +40,12 @@ public:
     std::pair<RandomVariable, RandomVariable> infdkI(const Size i, const Time t, const Time T, const RandomVariable& z,
                                                      const RandomVariable& y, bool indexIsInterpolated) const;
 
+    /* yoy swaplet prices for the periods S[k] to T[k] as of t for all periods in one call, as
+       CrossAssetModel::infdkYY(), the index ratios are computed once per distinct period end */
+    std::vector<RandomVariable> infdkYY(const Size i, const Time t, const std::vector<Time>& S,
+                                        const std::vector<Time>& T, const RandomVariable& z, const RandomVariable& y,
+                                        const RandomVariable& irz, bool indexIsInterpolated) const;
+
 private:
     const QuantLib::ext::shared_ptr<CrossAssetModel> cam_;
 };
@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/models/crossassetanalytics.hpp>
+#include <qle/models/infjyvectorised.hpp>
+#include <qle/utilities/inflation.hpp>
+
+namespace QuantExt {
+
+InfJyVectorised::InfJyVectorised(const QuantLib::ext::shared_ptr<CrossAssetModel>& cam) : cam_(cam) {}
+
+RandomVariable InfJyVectorised::growth(const Size i, const Time S, const Time T, const RandomVariable& irState,
+                                       const RandomVariable& rrState, bool indexIsInterpolated) const {
+
+    QL_REQUIRE(T >= S, "InfJyVectorised::growth(): end time (" << T << ") must be >= start time (" << S << ")");
+
+    Size n = irState.size();
+
+    // P_n(S, T) * P_n(0, S) / P_n(0, T) = exp( - [H_n(T) - H_n(S)] z_n(S) - 1/2 [H^2_n(T) - H^2_n(S)] zeta_n(S) )
+    auto irIdx = cam_->ccyIndex(cam_->infjy(i)->currency());
+    auto irParam = cam_->irlgm1f(irIdx);
+    Real H_n_S = irParam->H(S), H_n_T = irParam->H(T);
+
+    // P_r(S, T) * P_r(0, S) / P_r(0, T), same as above with the real rate parameters
+    auto rrParam = cam_->infjy(i)->realRate();
+    Real H_r_S = rrParam->H(S), H_r_T = rrParam->H(T);
+
+    const auto& zts = rrParam->termStructure();
+    Real marketGrowth = inflationGrowth(zts, T, indexIsInterpolated) / inflationGrowth(zts, S, indexIsInterpolated);
+
+    Real c = -0.5 * (H_r_T * H_r_T - H_r_S * H_r_S) * rrParam->zeta(S) +
+             0.5 * (H_n_T * H_n_T - H_n_S * H_n_S) * irParam->zeta(S);
+
+    return RandomVariable(n, marketGrowth) *
+           exp(RandomVariable(n, H_n_T - H_n_S) * irState - RandomVariable(n, H_r_T - H_r_S) * rrState +
+               RandomVariable(n, c));
+}
+
+std::vector<RandomVariable> InfJyVectorised::zeroRates(const Size i, const Time S, const std::vector<Time>& maturities,
+                                                       const RandomVariable& irState, const RandomVariable& rrState,
+                                                       bool indexIsInterpolated) const {
+    // z(S) = ( P_r(S, S + t) / P_n(S, S + t) )^(1/t) - 1, see JyImpliedZeroInflationTermStructure::zeroRateImpl()
+    std::vector<RandomVariable> result;
+    result.reserve(maturities.size());
+    Size n = irState.size();
+    for (auto const t : maturities) {
+        QL_REQUIRE(t >= 0.0, "InfJyVectorised::zeroRates(): negative time (" << t << ") given");
+        result.push_back(exp(log(growth(i, S, S + t, irState, rrState, indexIsInterpolated)) / RandomVariable(n, t)) -
+                         RandomVariable(n, 1.0));
+    }
+    return result;
+}
+
+std::vector<RandomVariable> InfJyVectorised::yoySwaplets(const Size i, const Time t, const std::vector<Time>& S,
+                                                         const std::vector<Time>& T, const RandomVariable& irState,
+                                                         const RandomVariable& rrState,
+                                                         bool indexIsInterpolated) const {
+
+    QL_REQUIRE(S.size() == T.size(), "InfJyVectorised::yoySwaplets(): start times (" << S.size()
+                                                                                       << ") and end times ("
+                                                                                       << T.size() << ") mismatch");
+
+    using CrossAssetAnalytics::ay;
+    using CrossAssetAnalytics::az;
+    using CrossAssetAnalytics::Hy;
+    using CrossAssetAnalytics::Hz;
+    using CrossAssetAnalytics::integral;
+    using CrossAssetAnalytics::LC;
+    using CrossAssetAnalytics::P;
+    using CrossAssetAnalytics::ryy;
+    using CrossAssetAnalytics::rzy;
+    using CrossAssetAnalytics::sy;
+
+    Size n = irState.size();
+
+    auto irIdx = cam_->ccyIndex(cam_->infjy(i)->currency());
+    auto irParam = cam_->irlgm1f(irIdx);
+    auto irTs = irParam->termStructure();
+    auto rrParam = cam_->infjy(i)->realRate();
+    const auto& zts = rrParam->termStructure();
+
+    Real H_n_t = irParam->H(t), zeta_n_t = irParam->zeta(t), zeta_r_t = rrParam->zeta(t);
+
+    std::vector<RandomVariable> result;
+    result.reserve(S.size());
+
+    for (Size k = 0; k < S.size(); ++k) {
+
+        // see JyImpliedYoYInflationTermStructure::yoySwaplet(), the swaplet is
+        // P_n(t,S) P_r(t,T) / P_r(t,S) e^C(t,S,T) - P_n(t,T)
+        // and we collect the state independent parts of both terms in a factor times exp(linear in the states)
+
+        Real H_n_S = irParam->H(S[k]), H_n_T = irParam->H(T[k]);
+        Real H_r_S = rrParam->H(S[k]), H_r_T = rrParam->H(T[k]);
+
+            Real rrMarketRatio = (irTs->discount(T[k]) * inflationGrowth(zts, T[k], indexIsInterpolated)) /
+                             (irTs->discount(S[k]) * inflationGrowth(zts, S[k], indexIsInterpolated));
+    
+        Real c = H_r_S * (rrParam->zeta(S[k]) - zeta_r_t);
+        c -= H_n_S * integral(*cam_, P(rzy(irIdx, i, 0), az(irIdx), ay(i)), t, S[k]);
+        c += integral(*cam_,
+                      LC(0.0, -1.0, P(ay(i), ay(i), Hy(i)), 1.0, P(rzy(irIdx, i, 0), az(irIdx), ay(i), Hz(irIdx)),
+                         -1.0, P(ryy(i, i, 0, 1), ay(i), sy(i))),
+                      t, S[k]);
+        c *= (H_r_S - H_r_T);
+
+        // first term: P_n(t,S) * rrRatio * e^C
+        Real f1 = irTs->discount(S[k]) / irTs->discount(t) * rrMarketRatio *
+                  std::exp(-0.5 * (H_n_S * H_n_S - H_n_t * H_n_t) * zeta_n_t -
+                           0.5 * (H_r_T * H_r_T - H_r_S * H_r_S) * zeta_r_t + c);
+        // second term: P_n(t,T)
+        Real f2 = irTs->discount(T[k]) / irTs->discount(t) *
+                  std::exp(-0.5 * (H_n_T * H_n_T - H_n_t * H_n_t) * zeta_n_t);
+
+        result.push_back(RandomVariable(n, f1) * exp(-RandomVariable(n, H_n_S - H_n_t) * irState -
+                                                     RandomVariable(n, H_r_T - H_r_S) * rrState) -
+                         RandomVariable(n, f2) * exp(-RandomVariable(n, H_n_T - H_n_t) * irState));
+    }
+
+    return result;
+}
+
+} // namespace QuantExt
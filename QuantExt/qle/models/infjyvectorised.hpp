@@ -0,0 +1,57 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/models/infjyvectorised.hpp
+    \brief vectorised jarrow yildirim inflation model calculations
+    \ingroup models
+*/
+
+#pragma once
+
+#include <qle/math/randomvariable.hpp>
+#include <qle/models/crossassetmodel.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+class InfJyVectorised {
+public:
+    InfJyVectorised(const QuantLib::ext::shared_ptr<CrossAssetModel>& cam);
+
+    /* P_r(S,T) / P_n(S,T) given the real rate state rrState and the nominal ir state irState at S, this is the
+       vectorised version of inflationGrowth() in jyimpliedzeroinflationtermstructure.hpp */
+    RandomVariable growth(const Size i, const Time S, const Time T, const RandomVariable& irState,
+                          const RandomVariable& rrState, bool indexIsInterpolated) const;
+
+    /* the zero inflation rates as of S for all given times to maturity, as JyImpliedZeroInflationTermStructure */
+    std::vector<RandomVariable> zeroRates(const Size i, const Time S, const std::vector<Time>& maturities,
+                                          const RandomVariable& irState, const RandomVariable& rrState,
+                                          bool indexIsInterpolated) const;
+
+    /* the yoy swaplet prices for the periods S[k] to T[k] as of t, as JyImpliedYoYInflationTermStructure. The state
+       independent parts (market ratios and convexity correction) are computed once per swaplet for all paths. */
+    std::vector<RandomVariable> yoySwaplets(const Size i, const Time t, const std::vector<Time>& S,
+                                            const std::vector<Time>& T, const RandomVariable& irState,
+                                            const RandomVariable& rrState, bool indexIsInterpolated) const;
+
+private:
+    const QuantLib::ext::shared_ptr<CrossAssetModel> cam_;
+};
+
+} // namespace QuantExt
@@ -46,6 +46,14 @@ public:
     virtual RandomVariable rollback(const RandomVariable& v, const Real t1, const Real t0,
                                     Size steps = Null<Size>()) const = 0;
 
+    /* roll back several deflated NPV arrays from t1 to t0 in place, the default implementation calls rollback() for
+       each of the arrays, a solver can override this to share work between the arrays */
+    virtual void rollbackMultiple(const std::vector<RandomVariable*>& v, const Real t1, const Real t0,
+                                  Size steps = Null<Size>()) const {
+        for (auto r : v)
+            *r = rollback(*r, t1, t0, steps);
+    }
+
     /* the underlying model */
     virtual const QuantLib::ext::shared_ptr<LinearGaussMarkovModel>& model() const = 0;
 };
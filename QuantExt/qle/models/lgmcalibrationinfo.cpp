@@ -24,6 +24,8 @@ std::map<std::string, boost::any> getAdditionalResultsMap(const LgmCalibrationIn
     std::map<std::string, boost::any> result;
     if (info.valid) {
         result["lgmCalibrationError"] = info.rmse;
+        if (info.calibrationTime != Null<Real>())
+            result["lgmCalibrationTime"] = info.calibrationTime;
         std::vector<Real> timeToExpiry, swapLength, strike, atmForward, annuity, vega, vols;
         std::vector<Real> modelTime, modelVol, marketVol, modelValue, marketValue, modelAlpha, modelKappa, modelHwSigma;
         std::vector<Real> volDiff, valueDiff;
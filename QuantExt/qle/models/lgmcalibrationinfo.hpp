@@ -58,6 +58,8 @@ struct LgmCalibrationData {
 struct LgmCalibrationInfo {
     bool valid = false;
     Real rmse = Null<Real>();
+    // wall clock time of the calibration in seconds
+    Real calibrationTime = Null<Real>();
     std::vector<SwaptionData> swaptionData;
     std::vector<LgmCalibrationData> lgmCalibrationData;
 };
@@ -23,8 +23,8 @@
 namespace QuantExt {
 
 LgmConvolutionSolver2::LgmConvolutionSolver2(const QuantLib::ext::shared_ptr<LinearGaussMarkovModel>& model, const Real sy,
-                                             const Size ny, const Real sx, const Size nx)
-    : model_(model), nx_(static_cast<int>(nx)) {
+                                             const Size ny, const Real sx, const Size nx, const Size nThreads)
+    : model_(model), nx_(static_cast<int>(nx)), workers_(nThreads) {
 
     // precompute weights
 
@@ -68,49 +68,131 @@ RandomVariable LgmConvolutionSolver2::stateGrid(const Real t) const {
     return x;
 }
 
-RandomVariable LgmConvolutionSolver2::rollback(const RandomVariable& v, const Real t1, const Real t0, Size) const {
-    if (QuantLib::close_enough(t0, t1) || v.deterministic())
-        return v;
-    QL_REQUIRE(t0 < t1, "LgmConvolutionSolver2::rollback(): t0 (" << t0 << ") < t1 (" << t1 << ") required.");
-    Real sigma = std::sqrt(model_->parametrization()->zeta(t1));
-    Real dx = sigma / static_cast<Real>(nx_);
-    if (QuantLib::close_enough(t0, 0.0)) {
-        // rollback from t1 to t0 = 0
-        Real value = 0.0;
+const LgmConvolutionSolver2::RollbackKernel& LgmConvolutionSolver2::rollbackKernel(const Real t1,
+                                                                                   const Real t0) const {
+    bool toZero = QuantLib::close_enough(t0, 0.0);
+    Real zeta0 = toZero ? 0.0 : model_->parametrization()->zeta(t0);
+    Real zeta1 = model_->parametrization()->zeta(t1);
+
+    // look up kernel in cache, it is valid if the model parameters did not change
+
+    auto key = std::make_pair(t1, toZero ? 0.0 : t0);
+    if (auto k = kernelCache_.find(key);
+        k != kernelCache_.end() && k->second.zeta0 == zeta0 && k->second.zeta1 == zeta1) {
+        return k->second;
+    }
+
+    // build the kernel, for t0 = 0 the result is a constant, so we only need one row
+
+    RollbackKernel& kernel = kernelCache_[key];
+    kernel.zeta0 = zeta0;
+    kernel.zeta1 = zeta1;
+    kernel.first.clear();
+    kernel.size.clear();
+    kernel.offset.clear();
+    kernel.weights.clear();
+
+    Real dx = std::sqrt(zeta1) / static_cast<Real>(nx_);
+    Real std = std::sqrt(zeta1 - zeta0);
+    Real dx2 = std::sqrt(zeta0) / static_cast<Real>(nx_);
+    int nRows = toZero ? 1 : 2 * mx_ + 1;
+
+    std::vector<Real> row(2 * mx_ + 1, 0.0);
+    for (int k = 0; k < nRows; ++k) {
+        int lo = 2 * mx_, hi = 0;
         for (int i = 0; i <= 2 * my_; i++) {
             // Map y index to x index, not integer in general
-            Real kp = y_[i] * sigma / dx + mx_;
+            Real kp = (dx2 * (k - mx_) + y_[i] * std) / dx + mx_;
             // Adjacent integer x index <= k
             int kk = int(floor(kp));
-            // Get value at kp by linear interpolation on
+            // Weights for the value at kp by linear interpolation on
             // kk <= kp <= kk + 1 with flat extrapolation
-            value +=
-                w_[i] *
-                (kk < 0 ? v[0] : (kk + 1 > 2 * mx_ ? v[2 * mx_] : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk]));
+            if (kk < 0) {
+                row[0] += w_[i];
+                lo = 0;
+                hi = std::max(hi, 0);
+            } else if (kk + 1 > 2 * mx_) {
+                row[2 * mx_] += w_[i];
+                lo = std::min(lo, 2 * mx_);
+                hi = 2 * mx_;
+            } else {
+                row[kk + 1] += w_[i] * (kp - kk);
+                row[kk] += w_[i] * (1.0 + kk - kp);
+                lo = std::min(lo, kk);
+                hi = std::max(hi, kk + 1);
+            }
         }
+        kernel.first.push_back(lo);
+        kernel.size.push_back(hi - lo + 1);
+        kernel.offset.push_back(static_cast<int>(kernel.weights.size()));
+        kernel.weights.insert(kernel.weights.end(), std::next(row.begin(), lo), std::next(row.begin(), hi + 1));
+        std::fill(std::next(row.begin(), lo), std::next(row.begin(), hi + 1), 0.0);
+    }
+
+    return kernel;
+}
+
+void LgmConvolutionSolver2::applyKernel(const RollbackKernel& kernel, const double* v, double* value) {
+    for (Size k = 0; k < kernel.first.size(); ++k) {
+        const Real* w = &kernel.weights[kernel.offset[k]];
+        const double* vk = v + kernel.first[k];
+        Real tmp = 0.0;
+        for (int j = 0; j < kernel.size[k]; ++j)
+            tmp += w[j] * vk[j];
+        value[k] = tmp;
+    }
+}
+
+RandomVariable LgmConvolutionSolver2::rollback(const RandomVariable& v, const Real t1, const Real t0, Size) const {
+    if (QuantLib::close_enough(t0, t1) || v.deterministic())
+        return v;
+    QL_REQUIRE(t0 < t1, "LgmConvolutionSolver2::rollback(): t0 (" << t0 << ") < t1 (" << t1 << ") required.");
+    const RollbackKernel& kernel = rollbackKernel(t1, t0);
+    if (QuantLib::close_enough(t0, 0.0)) {
+        // rollback from t1 to t0 = 0
+        Real value;
+        applyKernel(kernel, v.data(), &value);
         return RandomVariable(2 * mx_ + 1, value);
     } else {
+        // rollback from t1 to t0 > 0
         RandomVariable value(2 * mx_ + 1, 0.0);
         value.expand();
-        // rollback from t1 to t0 > 0
-        Real std = std::sqrt(model_->parametrization()->zeta(t1) - model_->parametrization()->zeta(t0));
-        Real dx2 = std::sqrt(model_->parametrization()->zeta(t0)) / static_cast<Real>(nx_);
-        for (int k = 0; k <= 2 * mx_; k++) {
-            for (int i = 0; i <= 2 * my_; i++) {
-                // Map y index to x index, not integer in generalTo
-                Real kp = (dx2 * (k - mx_) + y_[i] * std) / dx + mx_;
-                // Adjacent integer x index <= k
-                int kk = int(floor(kp));
-                // Get value at kp by linear interpolation on
-                // kk <= kp <= kk + 1 with flat extrapolation
-                value.set(k, value[k] + w_[i] * (kk < 0 ? v[0]
-                                                        : (kk + 1 > 2 * mx_
-                                                               ? v[2 * mx_]
-                                                               : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk])));
-            }
-        }
+        applyKernel(kernel, v.data(), value.data());
         return value;
     }
 }
 
+void LgmConvolutionSolver2::rollbackMultiple(const std::vector<RandomVariable*>& v, const Real t1, const Real t0,
+                                             Size) const {
+    if (QuantLib::close_enough(t0, t1))
+        return;
+    QL_REQUIRE(t0 < t1, "LgmConvolutionSolver2::rollbackMultiple(): t0 (" << t0 << ") < t1 (" << t1
+                                                                           << ") required.");
+
+    // the kernel and the result arrays are set up on the calling thread, the workers only apply the kernel
+
+    const RollbackKernel& kernel = rollbackKernel(t1, t0);
+    bool toZero = QuantLib::close_enough(t0, 0.0);
+    std::vector<RandomVariable> result(v.size());
+    std::vector<Real> resultToZero(v.size());
+    for (Size i = 0; i < v.size(); ++i) {
+        if (v[i]->deterministic() || toZero)
+            continue;
+        result[i] = RandomVariable(2 * mx_ + 1, 0.0);
+        result[i].expand();
+    }
+
+    workers_.run(v.size(), [&v, &kernel, &result, &resultToZero, toZero](const std::size_t i) {
+        if (v[i]->deterministic())
+            return;
+        applyKernel(kernel, v[i]->data(), toZero ? &resultToZero[i] : result[i].data());
+    });
+
+    for (Size i = 0; i < v.size(); ++i) {
+        if (v[i]->deterministic())
+            continue;
+        *v[i] = toZero ? RandomVariable(2 * mx_ + 1, resultToZero[i]) : std::move(result[i]);
+    }
+}
+
 } // namespace QuantExt
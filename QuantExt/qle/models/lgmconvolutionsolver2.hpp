@@ -24,32 +24,56 @@
 
 #pragma once
 
+#include <qle/math/chunkworkers.hpp>
 #include <qle/math/randomvariable.hpp>
 #include <qle/models/lgmbackwardsolver.hpp>
 
+#include <map>
+
 namespace QuantExt {
 
 //! Numerical convolution solver for the LGM model
 /*! Reference: Hagan, Methodology for callable swaps and Bermudan
                exercise into swaptions
+
+    The rollback from t1 to t0 is a banded matrix-vector product. The matrix weights depend on t1, t0 and the model
+    parameters only, they are computed on the first rollback for a pair of times and cached, so that later rollbacks
+    with the same times (e.g. for other value arrays or other trades priced with the same solver) only apply the
+    cached weights. The cache entries are rebuilt if the model's zeta changes. If nThreads > 1, rollbackMultiple()
+    distributes the arrays over this number of threads.
 */
 
 class LgmConvolutionSolver2 : public LgmBackwardSolver {
 public:
     LgmConvolutionSolver2(const QuantLib::ext::shared_ptr<LinearGaussMarkovModel>& model, const Real sy, const Size ny,
-                          const Real sx, const Size nx);
+                          const Real sx, const Size nx, const Size nThreads = 1);
     Size gridSize() const override { return 2 * mx_ + 1; }
     RandomVariable stateGrid(const Real t) const override;
     // steps are always ignored, since we can take large steps
     RandomVariable rollback(const RandomVariable& v, const Real t1, const Real t0,
                             Size steps = Null<Size>()) const override;
+    void rollbackMultiple(const std::vector<RandomVariable*>& v, const Real t1, const Real t0,
+                          Size steps = Null<Size>()) const override;
     const QuantLib::ext::shared_ptr<LinearGaussMarkovModel>& model() const override { return model_; }
 
 private:
+    /* row k of the rollback matrix has nonzero entries in the columns first[k], ..., first[k] + size[k] - 1, the
+       entries are stored contiguously in weights starting at offset[k] */
+    struct RollbackKernel {
+        Real zeta0, zeta1;
+        std::vector<int> first, size, offset;
+        std::vector<Real> weights;
+    };
+    const RollbackKernel& rollbackKernel(const Real t1, const Real t0) const;
+    // value[k] = sum_j A(k, j) v[j] for all rows k of the kernel matrix A
+    static void applyKernel(const RollbackKernel& kernel, const double* v, double* value);
+
     QuantLib::ext::shared_ptr<LinearGaussMarkovModel> model_;
     int mx_, my_, nx_;
     Real h_;
     std::vector<Real> y_, w_;
+    mutable std::map<std::pair<Real, Real>, RollbackKernel> kernelCache_;
+    mutable ChunkWorkers workers_;
 };
 
 } // namespace QuantExt
@@ -80,6 +80,168 @@ RandomVariable LgmVectorised::discountBondOption(Option::Type type, const Real K
     return w * (pT * normalCdf(w * dp) - pS * RandomVariable(x.size(), K) * normalCdf(w * dm));
 }
 
+namespace {
+
+// sum_i c[i] * exp(-a[i] * x), evaluated in one pass over the paths
+RandomVariable sumOfExponentials(const std::vector<Real>& c, const std::vector<Real>& a, const RandomVariable& x) {
+    if (x.deterministic()) {
+        Real sum = 0.0;
+        for (Size i = 0; i < c.size(); ++i)
+            sum += c[i] * std::exp(-a[i] * x[0]);
+        return RandomVariable(x.size(), sum, x.time());
+    }
+    RandomVariable result(x.size(), 0.0, x.time());
+    result.expand();
+    double* r = result.data();
+    const double* xd = x.data();
+    for (Size i = 0; i < c.size(); ++i) {
+        for (Size k = 0; k < x.size(); ++k)
+            r[k] += c[i] * std::exp(-a[i] * xd[k]);
+    }
+    return result;
+}
+
+} // namespace
+
+RandomVariable LgmVectorised::annuity(const Time t, const std::vector<Time>& payTimes,
+                                      const std::vector<Real>& accruals, const RandomVariable& x,
+                                      const Handle<YieldTermStructure>& discountCurve) const {
+    QL_REQUIRE(payTimes.size() == accruals.size(), "LgmVectorised::annuity(): pay times ("
+                                                       << payTimes.size() << ") and accruals (" << accruals.size()
+                                                       << ") must have the same size");
+    QL_REQUIRE(t >= 0.0, "t (" << t << ") >= 0 required in LGMVectorised::annuity");
+    Handle<YieldTermStructure> curve = discountCurve.empty() ? p_->termStructure() : discountCurve;
+    Real Ht = p_->H(t), zetat = p_->zeta(t), discountt = curve->discount(t);
+    std::vector<Real> c(payTimes.size()), a(payTimes.size());
+    for (Size i = 0; i < payTimes.size(); ++i) {
+        if (QuantLib::close_enough(t, payTimes[i])) {
+            c[i] = accruals[i];
+            a[i] = 0.0;
+            continue;
+        }
+        QL_REQUIRE(payTimes[i] >= t,
+                   "T(" << payTimes[i] << ") >= t(" << t << ") required in LGMVectorised::annuity");
+        Real HT = p_->H(payTimes[i]);
+        c[i] = accruals[i] * curve->discount(payTimes[i]) / discountt * std::exp(-0.5 * zetat * (HT * HT - Ht * Ht));
+        a[i] = HT - Ht;
+    }
+    return sumOfExponentials(c, a, x);
+}
+
+LgmVectorised::SwapRateSchedule LgmVectorised::swapRateSchedule(const QuantLib::ext::shared_ptr<SwapIndex>& swap,
+                                                                const Date& fixingDate) const {
+    SwapRateSchedule s;
+    s.forwardingCurve = swap->forwardingTermStructure();
+    s.discountCurve = swap->exogenousDiscount() ? swap->discountingTermStructure() : swap->forwardingTermStructure();
+    Leg floatingLeg, fixedLeg;
+    if (auto ois = QuantLib::ext::dynamic_pointer_cast<OvernightIndexedSwapIndex>(swap)) {
+        auto underlying = ois->underlyingSwap(fixingDate);
+        floatingLeg = underlying->overnightLeg();
+        fixedLeg = underlying->fixedLeg();
+    } else {
+        auto underlying = swap->underlyingSwap(fixingDate);
+        floatingLeg = underlying->floatingLeg();
+        fixedLeg = underlying->fixedLeg();
+    }
+    for (auto const& c : floatingLeg) {
+        Date start, end;
+        bool simpleAveraging = false;
+        if (auto cpn = QuantLib::ext::dynamic_pointer_cast<IborCoupon>(c)) {
+            start = swap->iborIndex()->fixingCalendar().advance(cpn->fixingDate(), swap->iborIndex()->fixingDays(),
+                                                                Days);
+            end = cpn->fixingEndDate(); // accounts for QL_INDEXED_COUPON
+        } else if (auto cpn = QuantLib::ext::dynamic_pointer_cast<OvernightIndexedCoupon>(c)) {
+            start = cpn->valueDates().front();
+            end = cpn->valueDates().back();
+            if (cpn->averagingMethod() == RateAveraging::Simple) {
+                simpleAveraging = true;
+            } else {
+                QL_REQUIRE(cpn->averagingMethod() == RateAveraging::Compound,
+                           "LgmVectorised::swapRateSchedule(): RateAveraging '"
+                               << static_cast<int>(cpn->averagingMethod())
+                               << "' not handled - internal error, contact dev.");
+            }
+        } else {
+            QL_FAIL("LgmVectorised::swapRateSchedule(): expected ibor coupon");
+        }
+        auto cpn = QuantLib::ext::dynamic_pointer_cast<Coupon>(c);
+        s.floatStartTimes.push_back(p_->termStructure()->timeFromReference(start));
+        s.floatEndTimes.push_back(p_->termStructure()->timeFromReference(end));
+        s.floatPayTimes.push_back(p_->termStructure()->timeFromReference(cpn->date()));
+        s.floatAdjFactors.push_back(cpn->dayCounter().yearFraction(cpn->accrualStartDate(), cpn->accrualEndDate(),
+                                                                   cpn->referencePeriodStart(),
+                                                                   cpn->referencePeriodEnd()) /
+                                    swap->iborIndex()->dayCounter().yearFraction(start, end));
+        s.floatSimpleAveraging.push_back(simpleAveraging);
+    }
+    for (auto const& c : fixedLeg) {
+        auto cpn = QuantLib::ext::dynamic_pointer_cast<FixedRateCoupon>(c);
+        QL_REQUIRE(cpn, "LgmVectorised::swapRateSchedule(): expected fixed coupon");
+        s.fixedPayTimes.push_back(p_->termStructure()->timeFromReference(cpn->date()));
+        s.fixedAccruals.push_back(cpn->accrualPeriod());
+    }
+    return s;
+}
+
+RandomVariable LgmVectorised::swapRate(const SwapRateSchedule& s, const Time t, const RandomVariable& x) const {
+
+    QL_REQUIRE(t >= 0.0, "t (" << t << ") >= 0 required in LGMVectorised::swapRate");
+
+    /* We use reduced discount bonds P(0,T) exp(-H(T) x - 0.5 zeta(t) H(T)^2) throughout, the numeraire cancels
+       out in the ratio of the float and fixed leg npvs. A floating coupon's forward is then given by
+       exp(g - (H(T1) - H(T2)) x) - 1 (compounded) resp. g - (H(T1) - H(T2)) x (simple averaging) with a state
+       independent g, so all deterministic factors are computed once per coupon. */
+
+    Real zetat = p_->zeta(t);
+
+    std::vector<Real> g(s.floatPayTimes.size()), dH(s.floatPayTimes.size()), c3(s.floatPayTimes.size()),
+        H3(s.floatPayTimes.size());
+    for (Size j = 0; j < s.floatPayTimes.size(); ++j) {
+        Time T1 = std::max(t, s.floatStartTimes[j]);
+        Time T2 = std::max(T1, s.floatEndTimes[j]);
+        Time T3 = std::max(T2, s.floatPayTimes[j]);
+        Real H1 = p_->H(T1), H2 = p_->H(T2);
+        H3[j] = p_->H(T3);
+        g[j] = std::log(s.forwardingCurve->discount(T1) / s.forwardingCurve->discount(T2)) -
+               0.5 * zetat * (H1 * H1 - H2 * H2);
+        dH[j] = H1 - H2;
+        c3[j] = s.floatAdjFactors[j] * s.discountCurve->discount(T3) * std::exp(-0.5 * zetat * H3[j] * H3[j]);
+    }
+
+    std::vector<Real> c(s.fixedPayTimes.size()), H(s.fixedPayTimes.size());
+    for (Size i = 0; i < s.fixedPayTimes.size(); ++i) {
+        Time T = std::max(t, s.fixedPayTimes[i]);
+        H[i] = p_->H(T);
+        c[i] = s.fixedAccruals[i] * s.discountCurve->discount(T) * std::exp(-0.5 * zetat * H[i] * H[i]);
+    }
+
+    RandomVariable denominator = sumOfExponentials(c, H, x);
+
+    Size n = x.deterministic() ? 1 : x.size();
+    Real x0 = x.deterministic() ? x[0] : 0.0;
+    const double* xd = x.deterministic() ? &x0 : x.data();
+    RandomVariable numerator(x.size(), 0.0, x.time());
+    Real numerator0 = 0.0;
+    if (!x.deterministic())
+        numerator.expand();
+    double* num = x.deterministic() ? &numerator0 : numerator.data();
+
+    for (Size j = 0; j < s.floatPayTimes.size(); ++j) {
+        if (s.floatSimpleAveraging[j]) {
+            for (Size k = 0; k < n; ++k)
+                num[k] += (g[j] - dH[j] * xd[k]) * c3[j] * std::exp(-H3[j] * xd[k]);
+        } else {
+            for (Size k = 0; k < n; ++k)
+                num[k] += (std::exp(g[j] - dH[j] * xd[k]) - 1.0) * c3[j] * std::exp(-H3[j] * xd[k]);
+        }
+    }
+
+    if (x.deterministic())
+        numerator.setAll(numerator0);
+
+    return numerator / denominator;
+}
+
 RandomVariable LgmVectorised::fixing(const QuantLib::ext::shared_ptr<InterestRateIndex>& index, const Date& fixingDate,
                                      const Time t, const RandomVariable& x) const {
 
@@ -108,78 +270,7 @@ RandomVariable LgmVectorised::fixing(const QuantLib::ext::shared_ptr<InterestRat
 
         // Swap Index
 
-        auto swapDiscountCurve =
-            swap->exogenousDiscount() ? swap->discountingTermStructure() : swap->forwardingTermStructure();
-        Leg floatingLeg, fixedLeg;
-        if (auto ois = QuantLib::ext::dynamic_pointer_cast<OvernightIndexedSwapIndex>(index)) {
-            auto underlying = ois->underlyingSwap(fixingDate);
-            floatingLeg = underlying->overnightLeg();
-            fixedLeg = underlying->fixedLeg();
-        } else {
-            auto underlying = swap->underlyingSwap(fixingDate);
-            floatingLeg = underlying->floatingLeg();
-            fixedLeg = underlying->fixedLeg();
-        }
-        RandomVariable numerator(x.size(), 0.0), denominator(x.size(), 0.0);
-        for (auto const& c : floatingLeg) {
-            if (auto cpn = QuantLib::ext::dynamic_pointer_cast<IborCoupon>(c)) {
-                Date fixingValueDate = swap->iborIndex()->fixingCalendar().advance(
-                    cpn->fixingDate(), swap->iborIndex()->fixingDays(), Days);
-                Date fixingEndDate = cpn->fixingEndDate();
-                Time T1 = std::max(t, p_->termStructure()->timeFromReference(fixingValueDate));
-                Time T2 = std::max(
-                    T1, p_->termStructure()->timeFromReference(fixingEndDate)); // accounts for QL_INDEXED_COUPON
-                Time T3 = std::max(T2, p_->termStructure()->timeFromReference(cpn->date()));
-                RandomVariable disc1 = reducedDiscountBond(t, T1, x, swap->forwardingTermStructure());
-                RandomVariable disc2 = reducedDiscountBond(t, T2, x, swap->forwardingTermStructure());
-                Real adjFactor =
-                    cpn->dayCounter().yearFraction(cpn->accrualStartDate(), cpn->accrualEndDate(),
-                                                   cpn->referencePeriodStart(), cpn->referencePeriodEnd()) /
-                    swap->iborIndex()->dayCounter().yearFraction(fixingValueDate, fixingEndDate);
-                RandomVariable tmp = disc1 / disc2 - RandomVariable(x.size(), 1.0);
-                if (!QuantLib::close_enough(adjFactor, 1.0)) {
-                    tmp *= RandomVariable(x.size(), adjFactor);
-                }
-                numerator += tmp * reducedDiscountBond(t, T3, x, swapDiscountCurve);
-            } else if (auto cpn = QuantLib::ext::dynamic_pointer_cast<OvernightIndexedCoupon>(c)) {
-                Date start = cpn->valueDates().front();
-                Date end = cpn->valueDates().back();
-                Time T1 = std::max(t, p_->termStructure()->timeFromReference(start));
-                Time T2 = std::max(T1, p_->termStructure()->timeFromReference(end));
-                Time T3 = std::max(T2, p_->termStructure()->timeFromReference(cpn->date()));
-                RandomVariable disc1 = reducedDiscountBond(t, T1, x, swap->forwardingTermStructure());
-                RandomVariable disc2 = reducedDiscountBond(t, T2, x, swap->forwardingTermStructure());
-                Real adjFactor =
-                    cpn->dayCounter().yearFraction(cpn->accrualStartDate(), cpn->accrualEndDate(),
-                                                   cpn->referencePeriodStart(), cpn->referencePeriodEnd()) /
-                    swap->iborIndex()->dayCounter().yearFraction(start, end);
-                RandomVariable tmp;
-                if (cpn->averagingMethod() == RateAveraging::Compound) {
-                    tmp = disc1 / disc2 - RandomVariable(x.size(), 1.0);
-                } else if (cpn->averagingMethod() == RateAveraging::Simple) {
-                    tmp = QuantExt::log(disc1 / disc2);
-                } else {
-                    QL_FAIL("LgmVectorised::fixing(): RateAveraging '"
-                            << static_cast<int>(cpn->averagingMethod())
-                            << "' not handled - internal error, contact dev.");
-                }
-                if (!QuantLib::close_enough(adjFactor, 1.0)) {
-                    tmp *= RandomVariable(x.size(), adjFactor);
-                }
-                numerator += tmp * reducedDiscountBond(t, T3, x, swapDiscountCurve);
-            } else {
-                QL_FAIL("LgmVectorised::fixing(): expected ibor coupon");
-            }
-        }
-        for (auto const& c : fixedLeg) {
-            auto cpn = QuantLib::ext::dynamic_pointer_cast<FixedRateCoupon>(c);
-            QL_REQUIRE(cpn, "LgmVectorised::fixing(): expected fixed coupon");
-            Date d = cpn->date();
-            Time T = std::max(t, p_->termStructure()->timeFromReference(d));
-            denominator +=
-                reducedDiscountBond(t, T, x, swapDiscountCurve) * RandomVariable(x.size(), cpn->accrualPeriod());
-        }
-        return numerator / denominator;
+        return swapRate(swapRateSchedule(swap, fixingDate), t, x);
 
     } else {
         QL_FAIL("LgmVectorised::fixing(): index ('" << index->name() << "') must be ibor or swap index");
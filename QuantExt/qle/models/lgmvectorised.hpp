@@ -28,6 +28,7 @@
 
 #include <ql/indexes/bmaindex.hpp>
 #include <ql/indexes/iborindex.hpp>
+#include <ql/indexes/swapindex.hpp>
 #include <ql/option.hpp>
 
 namespace QuantExt {
@@ -36,6 +37,20 @@ using namespace QuantLib;
 
 class LgmVectorised {
 public:
+    /* State independent data of a swap index fixing, i.e. the model times and accrual factors of the underlying
+       swap's legs. This can be built once per fixing date and reused for all observation times and states. */
+    struct SwapRateSchedule {
+        Handle<YieldTermStructure> forwardingCurve, discountCurve;
+        // floating leg: start / end time of the forward rate estimation, pay time, accrual adjustment factor
+        std::vector<Time> floatStartTimes, floatEndTimes, floatPayTimes;
+        std::vector<Real> floatAdjFactors;
+        // true for on coupons with simple averaging, false for compounded on or ibor coupons
+        std::vector<bool> floatSimpleAveraging;
+        // fixed leg: pay time and accrual period
+        std::vector<Time> fixedPayTimes;
+        std::vector<Real> fixedAccruals;
+    };
+
     LgmVectorised() = default;
     LgmVectorised(const QuantLib::ext::shared_ptr<IrLgm1fParametrization>& p) : p_(p) {}
 
@@ -54,6 +69,19 @@ public:
     RandomVariable discountBondOption(Option::Type type, const Real K, const Time t, const Time S, const Time T,
                                       const RandomVariable& x, const Handle<YieldTermStructure>& discountCurve) const;
 
+    /* sum_i accruals[i] * P(t, payTimes[i]), computed in one pass over the paths without intermediate random
+       variables per pay time. Requires t <= payTimes[i] for all i. */
+    RandomVariable annuity(const Time t, const std::vector<Time>& payTimes, const std::vector<Real>& accruals,
+                           const RandomVariable& x,
+                           const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>()) const;
+
+    /* Precompute the schedule factors of a swap index fixing for use in swapRate() below */
+    SwapRateSchedule swapRateSchedule(const QuantLib::ext::shared_ptr<SwapIndex>& index, const Date& fixingDate) const;
+
+    /* The swap rate for the given schedule, computed in one pass over the paths for each leg. Requires that the
+       fixing date of the schedule is in the future. The same as fixing() for a swap index. */
+    RandomVariable swapRate(const SwapRateSchedule& schedule, const Time t, const RandomVariable& x) const;
+
     /* Handles IborIndex and SwapIndex. Requires observation time t <= fixingDate */
     RandomVariable fixing(const QuantLib::ext::shared_ptr<InterestRateIndex>& index, const Date& fixingDate, const Time t,
                           const RandomVariable& x) const;
@@ -20,8 +20,13 @@
 #include <ql/math/optimization/projectedconstraint.hpp>
 #include <ql/math/optimization/projection.hpp>
 #include <ql/utilities/null_deleter.hpp>
+#include <qle/math/chunkworkers.hpp>
 #include <qle/models/linkablecalibratedmodel.hpp>
 
+#include <ql/settings.hpp>
+
+#include <map>
+
 using QuantLib::ext::shared_ptr;
 using std::vector;
 
@@ -33,12 +38,24 @@ LinkableCalibratedModel::LinkableCalibratedModel()
 class LinkableCalibratedModel::CalibrationFunction : public CostFunction {
 public:
     CalibrationFunction(LinkableCalibratedModel* model, const vector<shared_ptr<CalibrationHelper> >& h,
-                        const vector<Real>& weights, const Projection& projection)
-        : model_(model, null_deleter()), instruments_(h), weights_(weights), projection_(projection) {}
+                        const vector<Real>& weights, const Projection& projection,
+                        const vector<shared_ptr<LinkableCalibratedModel> >& replicaModels =
+                            vector<shared_ptr<LinkableCalibratedModel> >(),
+                        const vector<vector<shared_ptr<CalibrationHelper> > >& replicaInstruments =
+                            vector<vector<shared_ptr<CalibrationHelper> > >())
+        : model_(model, null_deleter()), instruments_(h), weights_(weights), projection_(projection),
+          replicaModels_(replicaModels), replicaInstruments_(replicaInstruments) {
+        if (!replicaModels_.empty())
+            workers_ = QuantLib::ext::make_shared<ChunkWorkers>(replicaModels_.size() + 1);
+    }
 
     virtual ~CalibrationFunction() {}
 
     virtual Real value(const Array& params) const override {
+        if (workers_ != nullptr) {
+            Array v = values(params);
+            return std::sqrt(DotProduct(v, v));
+        }
         model_->setParams(projection_.include(params));
         Real value = 0.0;
         for (Size i = 0; i < instruments_.size(); i++) {
@@ -49,11 +66,39 @@ public:
     }
 
     virtual Array values(const Array& params) const override {
-        model_->setParams(projection_.include(params));
+        Array p = projection_.include(params);
+        model_->setParams(p);
         Array values(instruments_.size());
-        for (Size i = 0; i < instruments_.size(); i++) {
-            values[i] = instruments_[i]->calibrationError() * std::sqrt(weights_[i]);
+        if (workers_ == nullptr) {
+            for (Size i = 0; i < instruments_.size(); i++) {
+                values[i] = instruments_[i]->calibrationError() * std::sqrt(weights_[i]);
+            }
+            return values;
         }
+        // the parameters are set on the calling thread, since this notifies the observers of the replicas
+        for (auto const& m : replicaModels_)
+            m->setParams(p);
+        // the settings are thread local if QuantLib is built with sessions enabled, we only write them if necessary
+        Date asof = Settings::instance().evaluationDate();
+        bool includeReferenceDateEvents = Settings::instance().includeReferenceDateEvents();
+        auto includeTodaysCashFlows = Settings::instance().includeTodaysCashFlows();
+        bool enforcesTodaysHistoricFixings = Settings::instance().enforcesTodaysHistoricFixings();
+        Size nChunks = replicaModels_.size() + 1;
+        workers_->run(nChunks, [this, &values, nChunks, asof, includeReferenceDateEvents, includeTodaysCashFlows,
+                                enforcesTodaysHistoricFixings](const std::size_t c) {
+            if (Settings::instance().evaluationDate() != asof)
+                Settings::instance().evaluationDate() = asof;
+            if (Settings::instance().includeReferenceDateEvents() != includeReferenceDateEvents)
+                Settings::instance().includeReferenceDateEvents() = includeReferenceDateEvents;
+            if (Settings::instance().includeTodaysCashFlows() != includeTodaysCashFlows)
+                Settings::instance().includeTodaysCashFlows() = includeTodaysCashFlows;
+            if (Settings::instance().enforcesTodaysHistoricFixings() != enforcesTodaysHistoricFixings)
+                Settings::instance().enforcesTodaysHistoricFixings() = enforcesTodaysHistoricFixings;
+            const vector<shared_ptr<CalibrationHelper> >& h = c == 0 ? instruments_ : replicaInstruments_[c - 1];
+            for (Size i = instruments_.size() * c / nChunks; i < instruments_.size() * (c + 1) / nChunks; ++i) {
+                values[i] = h[i]->calibrationError() * std::sqrt(weights_[i]);
+            }
+        });
         return values;
     }
 
@@ -64,6 +109,9 @@ private:
     const vector<shared_ptr<CalibrationHelper> >& instruments_;
     vector<Real> weights_;
     const Projection projection_;
+    vector<shared_ptr<LinkableCalibratedModel> > replicaModels_;
+    vector<vector<shared_ptr<CalibrationHelper> > > replicaInstruments_;
+    shared_ptr<ChunkWorkers> workers_;
 };
 
 void LinkableCalibratedModel::calibrate(const vector<ext::shared_ptr<BlackCalibrationHelper> >& instruments,
@@ -95,7 +143,30 @@ void LinkableCalibratedModel::calibrate(const vector<shared_ptr<CalibrationHelpe
     Array prms = params();
     vector<bool> all(prms.size(), false);
     Projection proj(prms, fixParameters.size() > 0 ? fixParameters : all);
-    CalibrationFunction f(this, instruments, w, proj);
+
+    // map the instruments to the helpers of the replicas, if all of them are replicated
+    vector<shared_ptr<LinkableCalibratedModel> > replicaModels;
+    vector<vector<shared_ptr<CalibrationHelper> > > replicaInstruments;
+    if (!calibrationReplicas_.empty() && instruments.size() > 1) {
+        std::map<const CalibrationHelper*, Size> index;
+        for (Size i = 0; i < replicatedHelpers_.size(); ++i)
+            index[replicatedHelpers_[i].get()] = i;
+        vector<Size> pos;
+        for (auto const& h : instruments) {
+            if (auto p = index.find(h.get()); p != index.end())
+                pos.push_back(p->second);
+        }
+        if (pos.size() == instruments.size()) {
+            for (auto const& r : calibrationReplicas_) {
+                replicaModels.push_back(r.model);
+                replicaInstruments.push_back(vector<shared_ptr<CalibrationHelper> >());
+                for (auto const& p : pos)
+                    replicaInstruments.back().push_back(r.helpers[p]);
+            }
+        }
+    }
+
+    CalibrationFunction f(this, instruments, w, proj, replicaModels, replicaInstruments);
     ProjectedConstraint pc(c, proj);
     Problem prob(f, pc, proj.project(prms));
     endCriteria_ = method.minimize(prob, endCriteria);
@@ -106,6 +177,21 @@ void LinkableCalibratedModel::calibrate(const vector<shared_ptr<CalibrationHelpe
     notifyObservers();
 }
 
+void LinkableCalibratedModel::setCalibrationReplicas(const vector<shared_ptr<CalibrationHelper> >& helpers,
+                                                     const vector<CalibrationReplica>& replicas) {
+    for (auto const& r : replicas) {
+        QL_REQUIRE(r.model != nullptr, "LinkableCalibratedModel::setCalibrationReplicas(): replica model is null");
+        QL_REQUIRE(r.helpers.size() == helpers.size(), "LinkableCalibratedModel::setCalibrationReplicas(): replica has "
+                                                           << r.helpers.size() << " helpers, expected "
+                                                           << helpers.size());
+        QL_REQUIRE(r.model->params().size() == params().size(),
+                   "LinkableCalibratedModel::setCalibrationReplicas(): replica model has "
+                       << r.model->params().size() << " parameters, expected " << params().size());
+    }
+    replicatedHelpers_ = replicas.empty() ? vector<shared_ptr<CalibrationHelper> >() : helpers;
+    calibrationReplicas_ = replicas;
+}
+
 Real LinkableCalibratedModel::value(const Array& params,
                                     const vector<QuantLib::ext::shared_ptr<BlackCalibrationHelper> >& instruments) {
     vector<ext::shared_ptr<CalibrationHelper> > tmp(instruments.size());
@@ -39,6 +39,12 @@ using namespace QuantLib;
  */
 class LinkableCalibratedModel : public virtual Observer, public virtual Observable {
 public:
+    //! an independent copy of a model together with copies of its calibration helpers priced with it
+    struct CalibrationReplica {
+        QuantLib::ext::shared_ptr<LinkableCalibratedModel> model;
+        std::vector<QuantLib::ext::shared_ptr<CalibrationHelper> > helpers;
+    };
+
     LinkableCalibratedModel();
 
     void update() override {
@@ -61,6 +67,15 @@ public:
                            const std::vector<Real>& weights = std::vector<Real>(),
                            const std::vector<bool>& fixParameters = std::vector<bool>());
 
+    /*! Set replicas of this model for a parallel evaluation of the calibration errors. The model of a replica must
+        have the same parameter layout as this model, the helpers of a replica correspond one by one to \p helpers
+        and must not share pricing engines or other lazily calculated objects with this model or other replicas.
+        A subsequent calibration to at least two of \p helpers evaluates them in chunks on replicas.size() + 1
+        threads, the first chunk on this model, each further chunk on one replica, the parameters are set on all
+        replicas on the calling thread. An empty vector of replicas restores the sequential evaluation. */
+    void setCalibrationReplicas(const std::vector<QuantLib::ext::shared_ptr<CalibrationHelper> >& helpers,
+                                const std::vector<CalibrationReplica>& replicas);
+
     Real value(const Array& params, const std::vector<QuantLib::ext::shared_ptr<CalibrationHelper> >&);
 
     //! for backward compatibility
@@ -88,6 +103,9 @@ protected:
     Array problemValues_;
 
 private:
+    std::vector<QuantLib::ext::shared_ptr<CalibrationHelper> > replicatedHelpers_;
+    std::vector<CalibrationReplica> calibrationReplicas_;
+
     //! Constraint imposed on arguments
     class PrivateConstraint;
     //! Calibration cost function class
@@ -32,6 +32,10 @@ namespace QuantExt {
 
 /*! Default loss distribution convolution for finite homogeneous or non-homogeneous pool
 
+    For the segment integration scheme the common factor grid and its density are set up once, the conditional
+    default probabilities on this grid are kept by date and entity and only recomputed if the entity's default
+    threshold or factor weight changed, e.g. when only some of the underlying credit curves are bumped.
+
     \todo Extend to the multifactor case for a generic LM
 */
 template <class CopulaPolicy>
@@ -86,6 +90,17 @@ private:
     mutable std::vector<std::vector<QuantLib::Real>> lgdVV_;
     // conditional probability of default with recovery rate, same dimension as lgdVV_
     mutable std::vector<std::vector<QuantLib::Real>> cprVV_;
+    // common factor grid and density times step size for the segment integration scheme
+    std::vector<QuantLib::Real> factors_;
+    std::vector<QuantLib::Real> factorDensities_;
+    // conditional default probabilities on the factor grid for an entity with given threshold and factor weight
+    struct ConditionalProbabilities {
+        QuantLib::Real threshold = QuantLib::Null<QuantLib::Real>();
+        QuantLib::Real weight = QuantLib::Null<QuantLib::Real>();
+        std::vector<QuantLib::Real> p;
+    };
+    // by date and entity, deterministic recovery only
+    mutable std::map<QuantLib::Date, std::vector<ConditionalProbabilities>> conditionalProbabilities_;
     
     QuantLib::Distribution lossDistrib(const QuantLib::Date& d, Real recoveryRate = Null<Real>()) const;
     // update lgdVV_
@@ -93,7 +108,9 @@ private:
     // update q_and c_
     void updateThresholds(QuantLib::Date d, Real recoveryRate = Null<Real>()) const;
     // update cprVV_
-    std::vector<Real> updateCPRs(std::vector<QuantLib::Real> factor, Real recoveryRate = Null<Real>()) const;
+    std::vector<Real> updateCPRs(const std::vector<QuantLib::Real>& factor, Real recoveryRate = Null<Real>()) const;
+    // conditional default probabilities on the factor grid by entity, requires up to date thresholds c_
+    const std::vector<ConditionalProbabilities>& conditionalProbabilities(const QuantLib::Date& d) const;
 
     void resetModel() override;
 
@@ -161,6 +178,13 @@ PoolLossModel<CopulaPolicy>::PoolLossModel(
       detachAmount_(0.0) {
 
     QL_REQUIRE(copula->numFactors() == 1, "Multifactor PoolLossModel not yet implemented.");
+
+    std::vector<QuantLib::Real> factor{ min_ + delta_ / 2.0 };
+    for (QuantLib::Size k = 0; k < nSteps_; k++) {
+        factors_.push_back(factor[0]);
+        factorDensities_.push_back(delta_ * copula_->density(factor));
+        factor[0] += delta_;
+    }
 }
 
 template <class CopulaPolicy>
@@ -354,9 +378,13 @@ std::vector<std::vector<Real>> PoolLossModel<CopulaPolicy>::marginalProbabilitie
 }
 
 template <class CopulaPolicy>
-std::vector<Real> PoolLossModel<CopulaPolicy>::updateCPRs(std::vector<QuantLib::Real> factor, Real recoveryRate) const {
+std::vector<Real> PoolLossModel<CopulaPolicy>::updateCPRs(const std::vector<QuantLib::Real>& factor,
+                                                          Real recoveryRate) const {
     cprVV_.clear();
 
+    // Vector of default probabilities conditional on the common market factor M: P(\tau_i < t | M = m).
+    std::vector<Real> probs(c_.size());
+
     Real tiny = 1.0e-10;
     if (useStochasticRecovery_ && recoveryRate == Null<Real>()) {
         cprVV_.resize(notionals_.size(), std::vector<Real>());
@@ -364,30 +392,50 @@ std::vector<Real> PoolLossModel<CopulaPolicy>::updateCPRs(std::vector<QuantLib::
             cprVV_[i].resize(c_[i].size() - 1, 0.0);
             Real pd = copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor);
             Real sum = 0.0;
+            Real previous = pd;
             for (Size j = 1; j < c_[i].size(); ++j) {
                 // probability of recovery j conditional on default of i
-                cprVV_[i][j-1] = copula_->conditionalDefaultProbabilityInvP(c_[i][j-1], i, factor)
-                    - copula_->conditionalDefaultProbabilityInvP(c_[i][j], i, factor);
+                Real current = copula_->conditionalDefaultProbabilityInvP(c_[i][j], i, factor);
+                cprVV_[i][j-1] = previous - current;
+                previous = current;
                 sum += cprVV_[i][j-1];
             }
             QL_REQUIRE(fabs(sum - pd) < tiny, "probability check failed for factor0 " << factor[0]);
+            probs[i] = pd;
         }
     }
     else {
         cprVV_.resize(notionals_.size(), std::vector<Real>(1, 0));
         for (Size i = 0; i < c_.size(); ++i) {
-            cprVV_[i][0] = copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor);
+            cprVV_[i][0] = probs[i] = copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor);
         }
     }
-    
-    // Vector of default probabilities conditional on the common market factor M: P(\tau_i < t | M = m).
-    std::vector<Real> probs;
-    for (Size i = 0; i < c_.size(); i++)
-        probs.push_back(copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor));
 
     return probs;
 }
 
+template <class CopulaPolicy>
+const std::vector<typename PoolLossModel<CopulaPolicy>::ConditionalProbabilities>&
+PoolLossModel<CopulaPolicy>::conditionalProbabilities(const QuantLib::Date& d) const {
+    std::vector<ConditionalProbabilities>& cp = conditionalProbabilities_[d];
+    cp.resize(c_.size());
+    const std::vector<std::vector<QuantLib::Real>>& weights = copula_->factorWeights();
+    std::vector<QuantLib::Real> factor(1);
+    for (Size i = 0; i < c_.size(); ++i) {
+        QuantLib::Real w = weights[i][0];
+        if (cp[i].threshold == c_[i][0] && cp[i].weight == w && cp[i].p.size() == nSteps_)
+            continue;
+        cp[i].threshold = c_[i][0];
+        cp[i].weight = w;
+        cp[i].p.resize(nSteps_);
+        for (Size k = 0; k < nSteps_; ++k) {
+            factor[0] = factors_[k];
+            cp[i].p[k] = copula_->conditionalDefaultProbabilityInvP(c_[i][0], i, factor);
+        }
+    }
+    return cp;
+}
+
 template <class CopulaPolicy>
 void PoolLossModel<CopulaPolicy>::resetModel() {
     // need to be capped now since the limit amounts might be over the remaining notional (think amortizing)
@@ -398,6 +446,7 @@ void PoolLossModel<CopulaPolicy>::resetModel() {
     attachAmount_ = basket_->remainingAttachmentAmount();
     detachAmount_ = basket_->remainingDetachmentAmount();
     copula_->resetBasket(basket_.currentLink());
+    conditionalProbabilities_.clear();
 }
     
 template <class CopulaPolicy>
@@ -454,11 +503,22 @@ QuantLib::Distribution PoolLossModel<CopulaPolicy>::lossDistrib(const QuantLib::
 
     } else {
 
-        std::vector<QuantLib::Real> factor{ min_ + delta_ / 2.0 };      
+        // with deterministic recovery the conditional default probabilities on the factor grid are cached
+        bool deterministicRecovery = !useStochasticRecovery_ || recoveryRate != Null<Real>();
+        const std::vector<ConditionalProbabilities>* cp =
+            deterministicRecovery ? &conditionalProbabilities(d) : nullptr;
+        std::vector<Real> cpr(c_.size());
+        if (deterministicRecovery)
+            cprVV_.assign(notionals_.size(), std::vector<Real>(1, 0.0));
 
         for (QuantLib::Size k = 0; k < nSteps_; k++) {
-            
-            std::vector<Real> cpr = updateCPRs(factor, recoveryRate);
+
+            if (deterministicRecovery) {
+                for (Size i = 0; i < cpr.size(); ++i)
+                    cprVV_[i][0] = cpr[i] = (*cp)[i].p[k];
+            } else {
+                cpr = updateCPRs({ factors_[k] }, recoveryRate);
+            }
 
             // Loss distribution up to date d conditional on common factor M = m.
             Distribution conditionalDist;
@@ -485,7 +545,7 @@ QuantLib::Distribution PoolLossModel<CopulaPolicy>::lossDistrib(const QuantLib::
             }
 
             // Update final distribution with contribution from common factor M = m.
-            Real densitydm = delta_ * copula_->density(factor);
+            Real densitydm = factorDensities_[k];
 
             if (useQlBucketing) {
                 for (Size j = 0; j < nBuckets_; j++) {
@@ -510,9 +570,6 @@ QuantLib::Distribution PoolLossModel<CopulaPolicy>::lossDistrib(const QuantLib::
                     A[j-1] += hwb.averageLoss()[j] * densitydm;
                 }
             }
-            
-            // Move to next value of common factor in [min,max] region.
-            factor[0] += delta_;
         }
 
         if (!useQlBucketing) {
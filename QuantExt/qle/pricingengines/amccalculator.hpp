@@ -46,9 +46,13 @@ public:
      */
     virtual std::vector<QuantExt::RandomVariable>
     simulatePath(const std::vector<QuantLib::Real>& pathTimes,
-                 std::vector<std::vector<QuantExt::RandomVariable>>& paths, 
+                 const std::vector<std::vector<QuantExt::RandomVariable>>& paths,
                  const std::vector<size_t>& relevantPathIndex,
                  const std::vector<size_t>& relevantTimeIndex) = 0;
+
+    /*! indices of the state process components in the paths passed to simulatePath() which are read by this
+        calculator, an empty vector means that the calculator might read all components */
+    virtual std::vector<QuantLib::Size> requiredStateIndices() const { return {}; }
 };
 
 } // namespace QuantExt
@@ -18,6 +18,7 @@
 
 #include <qle/pricingengines/cbomcengine.hpp>
 #include <qle/math/bucketeddistribution.hpp>
+#include <qle/math/chunkworkers.hpp>
 #include <ql/experimental/credit/loss.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
@@ -27,135 +28,117 @@ using namespace QuantLib;
 namespace QuantExt {
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    void MonteCarloCBOEngine::interestWaterfall(Size i, // sample index
-                                    Size j, // date index
-                                    const vector<Date>& dates,
-                                    map<Currency,vector<Cash> >& iFlows, 
-                                    map<Currency,Cash>& tranche,
-                                    map<Currency,vector<vector<Real> > >& balance,
-                                    map<Currency,Real>& interest,
-                                    map<Currency,Real>& interestAcc,
-                                    Real cureAmount) const {
-        Currency ccy = arguments_.ccy;
-
+    void MonteCarloCBOEngine::interestWaterfall(Cash& iFlow,
+                                                Cash& tranche,
+                                                Real& balance,
+                                                Real& interest,
+                                                Real interestAcc) const {
         Real tiny = 1e-9;
-        if (balance[ccy][j][i] < tiny) {
-            tranche[ccy].flow_ = 0.0;
-            tranche[ccy].discountedFlow_ = 0.0;
+        if (balance < tiny) {
+            tranche.flow_ = 0.0;
+            tranche.discountedFlow_ = 0.0;
             return;
         }
 
-        Real ccyDis = (iFlows[ccy][j].flow_ > 0 ?
-                       iFlows[ccy][j].discountedFlow_ / iFlows[ccy][j].flow_:
+        Real ccyDis = (iFlow.flow_ > 0 ?
+                       iFlow.discountedFlow_ / iFlow.flow_:
                        0.0);
 
         // Accrued Interest
 
-        Real amount = std::min(iFlows[ccy][j].flow_, interestAcc[ccy]);
+        Real amount = std::min(iFlow.flow_, interestAcc);
 
-        tranche[ccy].flow_ += amount;
-        tranche[ccy].discountedFlow_ += amount * ccyDis;
+        tranche.flow_ += amount;
+        tranche.discountedFlow_ += amount * ccyDis;
 
-        iFlows[ccy][j].flow_  -= amount;
-        iFlows[ccy][j].discountedFlow_ -= amount * ccyDis;
+        iFlow.flow_  -= amount;
+        iFlow.discountedFlow_ -= amount * ccyDis;
 
-        interest[ccy] -= amount;
+        interest -= amount;
 
         // Truncate rounding errors
-        balance[ccy][j][i] = std::max(balance[ccy][j][i], 0.0);
-        iFlows[ccy][j].flow_ = std::max(iFlows[ccy][j].flow_, 0.0);
-        iFlows[ccy][j].discountedFlow_ = std::max(iFlows[ccy][j].discountedFlow_, 0.0);
-        tranche[ccy].discountedFlow_ = std::max(tranche[ccy].discountedFlow_, 0.0);
+        balance = std::max(balance, 0.0);
+        iFlow.flow_ = std::max(iFlow.flow_, 0.0);
+        iFlow.discountedFlow_ = std::max(iFlow.discountedFlow_, 0.0);
+        tranche.discountedFlow_ = std::max(tranche.discountedFlow_, 0.0);
     }
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    void MonteCarloCBOEngine::icocInterestWaterfall(Size i, // sample index
-                                                    Size j, // date index
+    void MonteCarloCBOEngine::icocInterestWaterfall(Size j, // date index
                                                     Size l, //tranche
-                                                    const vector<Date>& dates,
-                                                    map<Currency,vector<Cash> >& iFlows,
-                                                    vector<map<Currency,Cash> >& tranches,
-                                                    vector<map<Currency,vector<vector<Real> > > >& balances,
+                                                    Cash& iFlow,
+                                                    vector<Cash>& tranches,
+                                                    vector<vector<Real> >& balances,
                                                     Real cureAmount) const {
-        Currency ccy = arguments_.ccy;
-
-        Real ccyDis = (iFlows[ccy][j].flow_ > 0 ?
-                       iFlows[ccy][j].discountedFlow_ / iFlows[ccy][j].flow_:
+        Real ccyDis = (iFlow.flow_ > 0 ?
+                       iFlow.discountedFlow_ / iFlow.flow_:
                        0.0);
 
         //IC and OC
 
-        Real cureAvailable = min(iFlows[ccy][j].flow_, cureAmount);
+        Real cureAvailable = min(iFlow.flow_, cureAmount);
 
         for(Size k = 0; k <= l; k++){
 
-            Real amount = std::min(balances[k][ccy][j][i], cureAvailable);
+            Real amount = std::min(balances[k][j], cureAvailable);
 
-            tranches[k][ccy].flow_ += amount;
-            tranches[k][ccy].discountedFlow_ += amount * ccyDis;
+            tranches[k].flow_ += amount;
+            tranches[k].discountedFlow_ += amount * ccyDis;
 
-            iFlows[ccy][j].flow_           -= amount;
-            iFlows[ccy][j].discountedFlow_ -= amount * ccyDis;
+            iFlow.flow_           -= amount;
+            iFlow.discountedFlow_ -= amount * ccyDis;
 
-            balances[k][ccy][j][i] -= amount;
+            balances[k][j] -= amount;
 
             cureAvailable -= amount;
 
             // truncate rounding errors
-            balances[k][ccy][j][i] = std::max(balances[k][ccy][j][i], 0.0);
-            iFlows[ccy][j].flow_ = std::max(iFlows[ccy][j].flow_, 0.0);
-            iFlows[ccy][j].discountedFlow_ = std::max(iFlows[ccy][j].discountedFlow_, 0.0);
-            tranches[k][ccy].discountedFlow_ = std::max(tranches[k][ccy].discountedFlow_, 0.0);
+            balances[k][j] = std::max(balances[k][j], 0.0);
+            iFlow.flow_ = std::max(iFlow.flow_, 0.0);
+            iFlow.discountedFlow_ = std::max(iFlow.discountedFlow_, 0.0);
+            tranches[k].discountedFlow_ = std::max(tranches[k].discountedFlow_, 0.0);
         }
     }
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    void MonteCarloCBOEngine::principalWaterfall(Size i, // sample index
-                                                Size j, // date index
-                                                const vector<Date>& dates,
-                                                map<Currency,vector<Cash> >& pFlows, 
-                                                map<Currency,Cash>& tranche,
-                                                map<Currency,vector<vector<Real> > >& balance,
-                                                map<Currency,Real>& interest) const {
-        Currency ccy = arguments_.ccy;
-
-        Real ccyDis = (pFlows[ccy][j].flow_ > 0 ?
-                       pFlows[ccy][j].discountedFlow_ / pFlows[ccy][j].flow_:
+    void MonteCarloCBOEngine::principalWaterfall(Cash& pFlow,
+                                                Cash& tranche,
+                                                Real& balance,
+                                                Real& interest) const {
+        Real ccyDis = (pFlow.flow_ > 0 ?
+                       pFlow.discountedFlow_ / pFlow.flow_:
                        0.0);
 
         //Principal Waterfall
 
-        Real amount = std::min(pFlows[ccy][j].flow_, balance[ccy][j][i]);
+        Real amount = std::min(pFlow.flow_, balance);
 
-        tranche[ccy].flow_ += amount;
-        tranche[ccy].discountedFlow_ += amount * ccyDis;
+        tranche.flow_ += amount;
+        tranche.discountedFlow_ += amount * ccyDis;
 
-        pFlows[ccy][j].flow_           -= amount;
-        pFlows[ccy][j].discountedFlow_ -= amount * ccyDis;
+        pFlow.flow_           -= amount;
+        pFlow.discountedFlow_ -= amount * ccyDis;
 
-        balance[ccy][j][i] -= amount;
+        balance -= amount;
 
         // truncate rounding errors
-        balance[ccy][j][i] = std::max(balance[ccy][j][i], 0.0);
-        pFlows[ccy][j].flow_ = std::max(pFlows[ccy][j].flow_, 0.0);
-        pFlows[ccy][j].discountedFlow_ = std::max(pFlows[ccy][j].discountedFlow_, 0.0);
-        tranche[ccy].discountedFlow_ = std::max(tranche[ccy].discountedFlow_, 0.0);
+        balance = std::max(balance, 0.0);
+        pFlow.flow_ = std::max(pFlow.flow_, 0.0);
+        pFlow.discountedFlow_ = std::max(pFlow.discountedFlow_, 0.0);
+        tranche.discountedFlow_ = std::max(tranche.discountedFlow_, 0.0);
 
-        interest[ccy] -= std::min(interest[ccy], amount);
+        interest -= std::min(interest, amount);
     }
 
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    Real MonteCarloCBOEngine::icocCureAmount(Size i,
-                        Size j,
+    Real MonteCarloCBOEngine::icocCureAmount(Size j,
                         Size k,
                         Real basketNotional,
                         Real basketInterest,
-                        vector<map<Currency ,vector<vector<Real> > > >& trancheBalances,
-                        vector<Real> trancheInterestRates,
+                        const vector<vector<Real> >& trancheBalances,
+                        const vector<Real>& trancheInterestRates,
                         Real icRatio,
                         Real ocRatio) const {
-        Currency ccy = arguments_.ccy;
-
         Real cureAmount;
 
         if((icRatio < 0.) && (ocRatio < 0.)){
@@ -166,8 +149,8 @@ namespace QuantExt {
             Real piC = 0.;
 
             for(Size l = 0; l < k; l++){
-                poC-= trancheBalances[l][ccy][j][i];
-                piC-= trancheBalances[l][ccy][j][i]*trancheInterestRates[l];
+                poC-= trancheBalances[l][j];
+                piC-= trancheBalances[l][j]*trancheInterestRates[l];
             }
 
             poC+= basketNotional/ocRatio;
@@ -182,11 +165,214 @@ namespace QuantExt {
             poC = std::max(poC, 0.);
             Real pTarget = std::min(poC, piC);
 
-            cureAmount = max(trancheBalances[k][ccy][j][i] - pTarget, 0.) ;
+            cureAmount = max(trancheBalances[k][j] - pTarget, 0.) ;
         }
         return cureAmount;
     }
 
+    //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    void MonteCarloCBOEngine::waterfall(Size i, // sample index
+                                        const vector<Date>& dates,
+                                        SampleFlows& flows,
+                                        const vector<vector<Real> >& trancheInterestRates,
+                                        const vector<Real>& feeYearFractions,
+                                        vector<vector<Real> >& trancheBalance,
+                                        SampleValues& values) const {
+        const vector<Tranche>& tranches = arguments_.tranches;
+        vector<Cash>& cf = flows.cf;
+        vector<Cash>& iFlows = flows.iFlows;
+        vector<Cash>& pFlows = flows.pFlows;
+        const vector<Real>& basketNotional = flows.notional;
+
+        for( Size k = 0 ; k < tranches.size() ; k++){
+            trancheBalance[k][0] = tranches[k].faceAmount;
+        }
+
+        vector<Real> trancheInterest(tranches.size(), 0.0);
+        vector<Real> trancheIntAcc(tranches.size());
+        vector<Cash> tranche(tranches.size());
+
+        for (Size j = 1; j < dates.size(); j++) {
+
+            //Back out discountfactors 
+
+            Real intCcyDis = (iFlows[j].flow_ > 0 ?
+                           iFlows[j].discountedFlow_ / iFlows[j].flow_ :
+                           0.0);
+
+            /**************************************************************
+             * check flows add up
+             */
+            Real tiny = 1.0e-6;
+            Real flowsCheck = fabs(cf[j].flow_
+                                   -iFlows[j].flow_
+                                   -pFlows[j].flow_);
+            QL_REQUIRE( flowsCheck < tiny,
+                       "Interest and Principal Flows don't sum to Total: "
+                       << flowsCheck);
+
+            Real dfFlowsCheck = fabs(cf[j].discountedFlow_
+                                   -iFlows[j].discountedFlow_
+                                   -pFlows[j].discountedFlow_);
+
+            QL_REQUIRE( dfFlowsCheck < tiny,
+                       "discounted Interest and Principal Flows don't sum to Total: "
+                       << dfFlowsCheck);
+
+            /**************************************************************
+             * tranche interest claim
+             */
+            for (Size k = 0 ; k< tranches.size(); k++){
+                trancheIntAcc[k] = trancheBalance[k][j-1]
+                    * (trancheInterestRates[j][k]);
+                trancheInterest[k] += trancheIntAcc[k];
+                trancheBalance[k][j]
+                    = trancheBalance[k][j-1];
+            }
+            /**************************************************************
+             * Collections
+             */
+            Real ccyDFlow = cf[j].discountedFlow_;
+            Real basketInterest = iFlows[j].flow_; //for cure amount calc
+
+            /**************************************************************
+             * Senior fees
+             */
+            Real ccyFeeClaim = basketNotional[j] * arguments_.seniorFee
+                * feeYearFractions[j];
+
+            Real ccyFeeFlow = std::min(ccyFeeClaim, iFlows[j].flow_);
+
+            iFlows[j].flow_ -= ccyFeeFlow;
+            iFlows[j].discountedFlow_ -= ccyFeeFlow * intCcyDis;
+
+            cf[j].flow_ -= ccyFeeFlow;
+            cf[j].discountedFlow_ -= ccyFeeFlow * intCcyDis;
+
+            values.fee += ccyFeeFlow * intCcyDis;
+
+            QL_REQUIRE(cf[j].flow_ >= 0.0, "ccy flows < 0");
+
+
+            /**************************************************************
+             * tranche waterfall
+             */
+
+            //Interest Waterfall incl. ICOC
+            for (Size k = 0 ; k < tranches.size() ; k++){
+
+                tranche[k].flow_ = 0.;
+                tranche[k].discountedFlow_ = 0.;
+
+                Real icRatio = tranches[k].icRatio;
+                Real ocRatio = tranches[k].ocRatio;
+
+                //IC and OC Target Balances
+                Real cureAmount = icocCureAmount(j,k,
+                                       basketNotional[j],
+                                       basketInterest,
+                                       trancheBalance,
+                                       trancheInterestRates[j],
+                                       icRatio,
+                                       ocRatio);
+
+                interestWaterfall(iFlows[j], tranche[k],
+                      trancheBalance[k][j],
+                      trancheInterest[k],
+                      trancheIntAcc[k]);
+
+                icocInterestWaterfall(j, k, iFlows[j],
+                                  tranche, trancheBalance,
+                                    cureAmount);
+
+            }
+
+            //Principal Waterfall
+            for (Size k = 0 ; k < tranches.size() ; k++){
+
+                principalWaterfall(pFlows[j], tranche[k],
+                                   trancheBalance[k][j],
+                                   trancheInterest[k]);
+
+                cf[j].flow_ -= tranche[k].flow_;
+                cf[j].discountedFlow_ -= tranche[k].discountedFlow_;
+
+            }
+
+            /**************************************************************
+             * Subordinated Fee
+             */
+
+            Real ccysubFeeClaim = basketNotional[j] * arguments_.subordinatedFee
+                                * feeYearFractions[j];
+
+            Real ccysubFeeFlow = std::min(ccysubFeeClaim, iFlows[j].flow_);
+
+            iFlows[j].flow_ -= ccysubFeeFlow;
+            iFlows[j].discountedFlow_ -= ccysubFeeFlow * intCcyDis;
+
+            cf[j].flow_ -= ccysubFeeFlow;
+            cf[j].discountedFlow_ -= ccysubFeeFlow * intCcyDis;
+
+            values.subfee += ccysubFeeFlow * intCcyDis;
+            QL_REQUIRE(cf[j].flow_ >= -1.0E-5, "ccy flows < 0");
+
+            /**************************************************************
+             * Kicker:
+             * Split excess flows between equity tranche (1-x) and senior fee (x)
+             */
+            Real x = arguments_.equityKicker;
+
+            Cash residual(0.0, 0.0);
+            residual.discountedFlow_ = pFlows[j].discountedFlow_ + iFlows[j].discountedFlow_;
+            residual.flow_ = pFlows[j].flow_ + iFlows[j].flow_;
+
+            tranche.back().flow_ += residual.flow_ * (1 - x);
+            tranche.back().discountedFlow_ +=  residual.discountedFlow_ * (1 - x);
+
+            values.fee += residual.discountedFlow_ * x;
+
+            cf[j].flow_ -= residual.flow_;
+            cf[j].discountedFlow_ -= residual.discountedFlow_;
+
+
+            /**************************************************************
+             * Consistency checks
+             */
+            QL_REQUIRE(cf[j].flow_ >= -1.e-5, "residual ccy flow < 0: "<<
+                       cf[j].flow_);
+
+            QL_REQUIRE(ccyFeeFlow  >= -1.e-5, "ccy fee flow < 0");
+
+            for(Size k = 0; k < tranches.size() ; k++){
+                QL_REQUIRE(tranche[k].flow_ >= -1.e-5, "ccy "<<
+                       tranches[k].name <<" flow < 0: "
+                           <<tranche[k].flow_);
+            }
+
+
+            values.basket += ccyDFlow;
+            for(Size k = 0 ; k < tranches.size() ; k ++){
+                values.tranche[k] += tranche[k].discountedFlow_;
+            }
+            Real tranchenpvError(0.);
+            for(Size k = 0 ; k < tranches.size() ; k ++){
+               tranchenpvError +=values.tranche[k];
+            }
+            Real  npvError(0.);
+            if(values.basket > 0.){
+               npvError = (values.fee + values.subfee + tranchenpvError) / values.basket - 1.0;
+               if(fabs(npvError) > errorTolerance_)
+                    //ALOG("NPVs do not add up, rel. error " << npvError);
+                    QL_FAIL("NPVs do not add up, rel. error " << npvError << " (sample " << i << ")");
+            }
+
+            QL_REQUIRE(values.basket >= 0.0,
+                           "negative basket value " << values.basket);
+
+        } // end dates
+    }
+
     //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // copied from AmortizingCboLbEngine
     map<Date, string> MonteCarloCBOEngine::getLossDistributionDates(const Date& valuationDate) const {
@@ -276,351 +462,131 @@ namespace QuantExt {
         DayCounter feeDayCount = arguments_.feeDayCounter;
         Currency ccy = arguments_.ccy;
 
-        //asset flows 
-        map<Currency, vector<Cash> > cf;
-        map<Currency, vector<Cash> > iFlows;
-        map<Currency, vector<Cash> > pFlows;
-        map<Currency, vector<Real> > basketNotional;
-
-        //liability flows 
-        vector<Real> basketValue(samples_, 0.0);
-        vector<vector<Real> > trancheValue;
+        //tranche interest rates and fee year fractions, these do not depend on the sample
         vector<Tranche> tranches = arguments_.tranches;
-        for (Size i = 0 ; i < tranches.size() ; i ++){
-            vector<Real> tempTrancheValue(samples_, 0.0);
-            trancheValue.push_back(tempTrancheValue);
-        }
-
-        vector <map<Currency, vector<vector<Real> > > > trancheBalance; 
-        trancheBalance.resize(tranches.size());
-        for (Size i = 0 ; i < tranches.size() ; i ++){
-            trancheBalance[i][ccy].resize(
-                                dates.size(), vector<Real>(samples_, 0.0));
+        vector<vector<Real> > trancheInterestRates(dates.size(), vector<Real>(tranches.size(), 0.0));
+        vector<Real> feeYearFractions(dates.size(), 0.0);
+        for (Size j = 1; j < dates.size(); j++) {
+            for (Size k = 0; k < tranches.size(); k++)
+                trancheInterestRates[j][k] = tranches[k].leg[j - 1]->amount() / tranches[k].faceAmount;
+            feeYearFractions[j] = feeDayCount.yearFraction(dates[j - 1], dates[j]);
         }
 
+        //liability flows 
+        vector<Real> basketValue(samples_, 0.0);
+        vector<vector<Real> > trancheValue(tranches.size(), vector<Real>(samples_, 0.0));
         vector<Real> feeValue(samples_, 0.0);
         vector<Real> subfeeValue(samples_, 0.0);
 
-        /*
-        //prepare for convergence analysis
-        bool convergenceFlag = false;
-        std::vector<double> runningMean(tranches.size(),0.0);
-        std::vector<double> runningStdev(tranches.size(),0.0);
-        if(ore::data::Log::instance().filter(ORE_DATA)){
-            TLOG("convergence analysis - check first two moments");
-            std::ostringstream labels;
-            labels << "sample";
-            for(Size k = 0 ; k < tranches.size(); k++)
-                labels << "," << tranches[k].name << "-mean,"<< tranches[k].name << "-stdev";
-            TLOG(labels.str());
-            convergenceFlag = true;
-        }
-        */
-
-        for (Size i = 0; i < samples_; i++) { 
-            rdm_->nextSequence(tmax);
-
-            for( Size k = 0 ; k < tranches.size() ; k++){
-                trancheBalance[k][ccy][0][i] = arguments_.tranches[k].faceAmount;
-            }
-
-            vector< map<Currency, Real> >trancheInterest;
-            trancheInterest.resize(tranches.size());
-            for( Size k = 0 ; k < tranches.size() ; k++){
-                trancheInterest[k][ccy] = 0.0;
-            }
-
-            //Get Collection from bondbasket and exchange into base currency...
-            cf.clear();
-            iFlows.clear();
-            pFlows.clear();
-            basketNotional.clear();
-
-            map<Currency, vector<Cash> > cf_full = arguments_.basket->scenarioCashflow(dates);
-            map<Currency, vector<Cash> > iFlows_full = arguments_.basket->scenarioInterestflow(dates);
-            map<Currency, vector<Cash> > pFlows_full = arguments_.basket->scenarioPrincipalflow(dates);
-            map<Currency, vector<Real> > basketNotional_full = arguments_.basket->scenarioRemainingNotional(dates);
-
-            set<Currency> basketCurrency = arguments_.basket->unique_currencies();
-
-            if(basketCurrency.size() > 1){
-
-                vector<Cash> cf_single;
-                vector<Cash> iFlows_single;
-                vector<Cash> pFlows_single;
-                vector<Real> basketNotional_single;
-
-                for(size_t d = 0; d < dates.size(); d++){
-
-                    double cf1 = 0.0;
-                    double cf2 = 0.0;
-                    double if1 = 0.0;
-                    double if2 = 0.0;
-                    double pf1 = 0.0;
-                    double pf2 = 0.0;
-                    //Cash pf(0.0, 0.0);
-                    double bn = 0.0;
-
-                    for(auto& basketCcy : basketCurrency){
-                        cf1 += arguments_.basket->convert(cf_full[basketCcy][d].flow_, basketCcy, dates[d]);
-                        cf2 += arguments_.basket->convert(cf_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
-
-                        if1 += arguments_.basket->convert(iFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
-                        if2 += arguments_.basket->convert(iFlows_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
-
-                        pf1 += arguments_.basket->convert(pFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
-                        pf2 += arguments_.basket->convert(pFlows_full[basketCcy][d].discountedFlow_, basketCcy, dates[d]);
-
-                        bn += arguments_.basket->convert(basketNotional_full[basketCcy][d], basketCcy, dates[d]);
+        set<Currency> basketCurrency = arguments_.basket->unique_currencies();
+
+        /* The samples are processed in batches: the default times are drawn and the basket flows are collected
+           sequentially for all samples of a batch, since the random default model and the basket hold the state of
+           the current sample, then the waterfalls of the batch are run in parallel. The random numbers are consumed
+           in the same order as in a sequential run, so the results do not depend on the number of threads. */
+        QuantExt::ChunkWorkers workers(nThreads_);
+        Size batchSize = std::min<Size>(samples_, std::max<Size>(1024, 64 * workers.nThreads()));
+        vector<SampleFlows> batch(batchSize);
+        Size nChunks = std::min<Size>(batchSize, 4 * workers.nThreads());
+        vector<vector<vector<Real> > > trancheBalance(
+            nChunks, vector<vector<Real> >(tranches.size(), vector<Real>(dates.size(), 0.0)));
+
+        for (Size batchStart = 0; batchStart < samples_; batchStart += batchSize) {
+            Size n = std::min(batchSize, samples_ - batchStart);
+
+            for (Size b = 0; b < n; b++) {
+                rdm_->nextSequence(tmax);
+
+                //Get Collection from bondbasket and exchange into base currency...
+                map<Currency, vector<Cash> > cf_full = arguments_.basket->scenarioCashflow(dates);
+                map<Currency, vector<Cash> > iFlows_full = arguments_.basket->scenarioInterestflow(dates);
+                map<Currency, vector<Cash> > pFlows_full = arguments_.basket->scenarioPrincipalflow(dates);
+                map<Currency, vector<Real> > basketNotional_full = arguments_.basket->scenarioRemainingNotional(dates);
+
+                SampleFlows& flows = batch[b];
+                if(basketCurrency.size() > 1){
+
+                    flows.cf.clear();
+                    flows.iFlows.clear();
+                    flows.pFlows.clear();
+                    flows.notional.clear();
+
+                    for(size_t d = 0; d < dates.size(); d++){
+
+                        double cf1 = 0.0;
+                        double cf2 = 0.0;
+                        double if1 = 0.0;
+                        double if2 = 0.0;
+                        double pf1 = 0.0;
+                        double pf2 = 0.0;
+                        double bn = 0.0;
+
+                        for(auto& basketCcy : basketCurrency){
+                            cf1 += arguments_.basket->convert(cf_full[basketCcy][d].flow_, basketCcy, dates[d]);
+                            cf2 += arguments_.basket->convert(cf_full[basketCcy][d].discountedFlow_, basketCcy,
+                                                              dates[d]);
+
+                            if1 += arguments_.basket->convert(iFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
+                            if2 += arguments_.basket->convert(iFlows_full[basketCcy][d].discountedFlow_, basketCcy,
+                                                              dates[d]);
+
+                            pf1 += arguments_.basket->convert(pFlows_full[basketCcy][d].flow_, basketCcy, dates[d]);
+                            pf2 += arguments_.basket->convert(pFlows_full[basketCcy][d].discountedFlow_, basketCcy,
+                                                              dates[d]);
+
+                            bn += arguments_.basket->convert(basketNotional_full[basketCcy][d], basketCcy, dates[d]);
+                        }
+                        flows.cf.push_back(Cash(cf1, cf2));
+                        flows.iFlows.push_back(Cash(if1,if2));
+                        flows.pFlows.push_back(Cash(pf1,pf2));
+                        flows.notional.push_back(bn);
                     }
-                    cf_single.push_back(Cash(cf1, cf2));
-                    iFlows_single.push_back(Cash(if1,if2));
-                    pFlows_single.push_back(Cash(pf1,pf2));
-                    basketNotional_single.push_back(bn);
-                }
-                cf[ccy] = cf_single;
-                iFlows[ccy] = iFlows_single;
-                pFlows[ccy] = pFlows_single;
-                basketNotional[ccy] = basketNotional_single;
-
-            }
-            else{
-                cf = cf_full;
-                iFlows = iFlows_full;
-                pFlows = pFlows_full;
-                basketNotional = basketNotional_full;
-            }
-
-            for (Size j = 1; j < dates.size(); j++) {
-
-                //Back out discountfactors 
-
-                Real intCcyDis = (iFlows[ccy][j].flow_ > 0 ?
-                               iFlows[ccy][j].discountedFlow_ / iFlows[ccy][j].flow_ :
-                               0.0);
-
-                /**************************************************************
-                 * check flows add up
-                 */
-                Real tiny = 1.0e-6;
-                Real flowsCheck = fabs(cf[ccy][j].flow_
-                                       -iFlows[ccy][j].flow_
-                                       -pFlows[ccy][j].flow_);
-                QL_REQUIRE( flowsCheck < tiny,
-                           "Interest and Principal Flows don't sum to Total: "
-                           << flowsCheck);
-
-                Real dfFlowsCheck = fabs(cf[ccy][j].discountedFlow_
-                                       -iFlows[ccy][j].discountedFlow_
-                                       -pFlows[ccy][j].discountedFlow_);
-
-                QL_REQUIRE( dfFlowsCheck < tiny,
-                           "discounted Interest and Principal Flows don't sum to Total: "
-                           << dfFlowsCheck);
-
-                /**************************************************************
-                 * tranche interest claim
-                 */
-                vector<map<Currency, Real> >trancheIntAcc;
-                trancheIntAcc.resize(tranches.size());
-                vector<Real> trancheInterestRates;
-                // ccy
-                for (Size k = 0 ; k< tranches.size(); k++){
-                    Real trancheInterestRate =
-                        tranches[k].leg[j-1]->amount()/
-                        tranches[k].faceAmount;
-                    trancheInterestRates.push_back(trancheInterestRate);
-                    //ccy
-                    trancheIntAcc[k][ccy] = trancheBalance[k][ccy][j-1][i]
-                        * (trancheInterestRate);
-                    trancheInterest[k][ccy] += trancheIntAcc[k][ccy];
-                    trancheBalance[k][ccy][j][i]
-                        = trancheBalance[k][ccy][j-1][i];
-                }
-                /**************************************************************
-                 * Collections
-                 */
-                Real ccyDFlow = cf[ccy][j].discountedFlow_;
-                Real basketInterest = iFlows[ccy][j].flow_; //for cure amount calc
-
-                /**************************************************************
-                 * Senior fees
-                 */
-                Real ccyFeeClaim = basketNotional[ccy][j] * arguments_.seniorFee
-                    * feeDayCount.yearFraction(dates[j-1], dates[j]);
-
-                Real ccyFeeFlow = std::min(ccyFeeClaim, iFlows[ccy][j].flow_);
-
-                iFlows[ccy][j].flow_ -= ccyFeeFlow;
-                iFlows[ccy][j].discountedFlow_ -= ccyFeeFlow * intCcyDis;
-
-                cf[ccy][j].flow_ -= ccyFeeFlow;
-                cf[ccy][j].discountedFlow_ -= ccyFeeFlow * intCcyDis;
-
-                feeValue[i] += ccyFeeFlow * intCcyDis;
-
-                QL_REQUIRE(cf[ccy][j].flow_ >= 0.0, "ccy flows < 0");
-
-
-                /**************************************************************
-                 * tranche waterfall
-                 */
-                vector<map<Currency, Real> > trancheAmortization;
-                vector<map<Currency, Cash> > tranche;
-                trancheAmortization.resize(tranches.size());
-                tranche.resize(tranches.size());
-
-                //Interest Waterfall incl. ICOC
-                for (Size k = 0 ; k < tranches.size() ; k++){
-
-                    tranche[k][ccy].flow_ = 0.;
-                    tranche[k][ccy].discountedFlow_ = 0.;
-
-                    Real icRatio = arguments_.tranches[k].icRatio;
-                    Real ocRatio = arguments_.tranches[k].ocRatio;
-
-                    //IC and OC Target Balances
-                    Real cureAmount = icocCureAmount(i,j,k,
-                                           basketNotional[ccy][j],
-                                           basketInterest,
-                                           trancheBalance,
-                                           trancheInterestRates,
-                                           icRatio,
-                                           ocRatio);
-
-                    interestWaterfall(i, j, dates, iFlows,
-                          tranche[k], trancheBalance[k], 
-                          trancheInterest[k],
-                          trancheIntAcc[k], cureAmount); 
-
-                    icocInterestWaterfall(i, j, k, dates, iFlows,
-                                      tranche, trancheBalance, 
-                                        cureAmount); 
-
                 }
-
-                //Principal Waterfall
-                for (Size k = 0 ; k < tranches.size() ; k++){
-
-                    principalWaterfall(i, j, dates, pFlows,
-                                       tranche[k], trancheBalance[k],
-                                       trancheInterest[k]);
-
-                    cf[ccy][j].flow_ -= tranche[k][ccy].flow_;
-                    cf[ccy][j].discountedFlow_ -= tranche[k][ccy].discountedFlow_;
-
+                else{
+                    flows.cf = std::move(cf_full[ccy]);
+                    flows.iFlows = std::move(iFlows_full[ccy]);
+                    flows.pFlows = std::move(pFlows_full[ccy]);
+                    flows.notional = std::move(basketNotional_full[ccy]);
                 }
 
                 /**************************************************************
-                 * Subordinated Fee
-                 */
-
-                Real ccysubFeeClaim = basketNotional[ccy][j] * arguments_.subordinatedFee
-                                    * feeDayCount.yearFraction(dates[j-1], dates[j]);
-
-                Real ccysubFeeFlow = std::min(ccysubFeeClaim, iFlows[ccy][j].flow_);
-
-                iFlows[ccy][j].flow_ -= ccysubFeeFlow;
-                iFlows[ccy][j].discountedFlow_ -= ccysubFeeFlow * intCcyDis;
-
-                cf[ccy][j].flow_ -= ccysubFeeFlow;
-                cf[ccy][j].discountedFlow_ -= ccysubFeeFlow * intCcyDis;
-
-                subfeeValue[i] += ccysubFeeFlow * intCcyDis;
-                QL_REQUIRE(cf[ccy][j].flow_ >= -1.0E-5, "ccy flows < 0");
-
-                /**************************************************************
-                 * Kicker:
-                 * Split excess flows between equity tranche (1-x) and senior fee (x)
-                 */
-                Real x = arguments_.equityKicker;
-
-                Cash residual(0.0, 0.0);
-                residual.discountedFlow_ = pFlows[ccy][j].discountedFlow_ + iFlows[ccy][j].discountedFlow_;
-                residual.flow_ = pFlows[ccy][j].flow_ + iFlows[ccy][j].flow_;
-
-                tranche.back()[ccy].flow_ += residual.flow_ * (1 - x);
-                tranche.back()[ccy].discountedFlow_ +=  residual.discountedFlow_ * (1 - x);
-
-                feeValue[i] += residual.discountedFlow_ * x;
-
-                cf[ccy][j].flow_ -= residual.flow_;
-                cf[ccy][j].discountedFlow_ -= residual.discountedFlow_;
-
-
-                /**************************************************************
-                 * Consistency checks
+                 * Loss Distribution
                  */
-                QL_REQUIRE(cf[ccy][j].flow_ >= -1.e-5, "residual ccy flow < 0: "<<
-                           cf[ccy][j].flow_);
-
-                QL_REQUIRE(ccyFeeFlow  >= -1.e-5, "ccy fee flow < 0");
-
-                for(Size k = 0; k < tranches.size() ; k++){
-                    QL_REQUIRE(tranche[k][ccy].flow_ >= -1.e-5, "ccy "<<
-                           tranches[k].name <<" flow < 0: "
-                               <<tranche[k][ccy].flow_);
-                }
-
-
-                basketValue[i] += ccyDFlow;
-                for(Size k = 0 ; k < tranches.size() ; k ++){
-                    trancheValue[k][i] += tranche[k][ccy].discountedFlow_;
-                }
-                Real tranchenpvError(0.);
-                for(Size k = 0 ; k < tranches.size() ; k ++){
-                   tranchenpvError +=trancheValue[k][i];
-                }
-                Real  npvError(0.);
-                if(basketValue[i] > 0.){
-                   npvError = (feeValue[i] + subfeeValue[i] + tranchenpvError) / basketValue[i] - 1.0;
-                   if(fabs(npvError) > errorTolerance_)
-                        //ALOG("NPVs do not add up, rel. error " << npvError);
-                        QL_FAIL("NPVs do not add up, rel. error " << npvError);
-                }
-
-                QL_REQUIRE(basketValue[i] >= 0.0,
-                               "negative basket value " << basketValue[i]);
-
-            } // end dates
-
-            /**************************************************************
-             * Loss Distribution
-             */
-            if (!lossDistributionDates.empty()) {
-                // get the losses on this sample for each date
-                map<Currency, vector<Cash> >
-                    lossDist = arguments_.basket->scenarioLossflow(lossDistributionDatesVector);
-
-                // foreach date, we see what bucket our loss falls into and we increase the probability for
-                // that bucket by 1/samples
-                for (Size k = 0; k < lossDistributionDatesVector.size(); k++) {
-                    Real loss = lossDist[ccy][k].flow_;
-                    Date d = lossDistributionDatesVector[k];
-                    string dateString = lossDistributionDates[d];
-
-                    QuantLib::ext::shared_ptr<BucketedDistribution> bd = lossDistributionMap[dateString];
-                    Size index = bd->bucket(loss); // find the bucket we need to update
-                    bd->probabilities()[index] += 1.0 / samples_;
+                if (!lossDistributionDates.empty()) {
+                    // get the losses on this sample for each date
+                    map<Currency, vector<Cash> >
+                        lossDist = arguments_.basket->scenarioLossflow(lossDistributionDatesVector);
+
+                    // foreach date, we see what bucket our loss falls into and we increase the probability for
+                    // that bucket by 1/samples
+                    for (Size k = 0; k < lossDistributionDatesVector.size(); k++) {
+                        Real loss = lossDist[ccy][k].flow_;
+                        Date d = lossDistributionDatesVector[k];
+                        string dateString = lossDistributionDates[d];
+
+                        QuantLib::ext::shared_ptr<BucketedDistribution> bd = lossDistributionMap[dateString];
+                        Size index = bd->bucket(loss); // find the bucket we need to update
+                        bd->probabilities()[index] += 1.0 / samples_;
+                    }
                 }
             }
 
-            /*
-            //convergence
-            if(convergenceFlag){
-                std::ostringstream meanStev;
-                meanStev << i << fixed << setprecision(2);
-                for(Size k = 0 ; k < tranches.size(); k++){
-                    runningMean[k] += trancheValue[k][i];
-                    double mean = runningMean[k] / (i + 1);
-                    meanStev << "," << mean;
-                    runningStdev[k] += trancheValue[k][i]*trancheValue[k][i];
-                    double stdev = sqrt(runningStdev[k] / (i + 1)  - mean * mean);
-                    meanStev << "," << stdev;
+            // run the waterfalls of the batch, each chunk owns a contiguous range of samples
+            Size chunks = std::min(nChunks, n);
+            workers.run(chunks, [&](const Size c) {
+                SampleValues values;
+                for (Size b = c * n / chunks; b < (c + 1) * n / chunks; b++) {
+                    Size i = batchStart + b;
+                    values.basket = values.fee = values.subfee = 0.0;
+                    values.tranche.assign(tranches.size(), 0.0);
+                    waterfall(i, dates, batch[b], trancheInterestRates, feeYearFractions, trancheBalance[c], values);
+                    basketValue[i] = values.basket;
+                    feeValue[i] = values.fee;
+                    subfeeValue[i] = values.subfee;
+                    for (Size k = 0; k < tranches.size(); k++)
+                        trancheValue[k][i] = values.tranche[k];
                 }
-                TLOG(meanStev.str());
-            }
-            */
+            });
         } // end samples
 
         //handle results...
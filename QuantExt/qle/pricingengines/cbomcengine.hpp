@@ -60,32 +60,42 @@ public:
         //! npvError tolerance
         double errorTolerance = 1.0e-6,
         //! Periods from valuation date for which to return loss distributions
-        std::vector<QuantLib::Period> lossDistributionPeriods = std::vector<QuantLib::Period>())
+        std::vector<QuantLib::Period> lossDistributionPeriods = std::vector<QuantLib::Period>(),
+        //! Number of threads running the sample waterfalls, the results do not depend on this
+        Size nThreads = 1)
         : rdm_(rdm), samples_(samples), bins_(bins), errorTolerance_(errorTolerance),
-        lossDistributionPeriods_(lossDistributionPeriods) {}
+        lossDistributionPeriods_(lossDistributionPeriods), nThreads_(nThreads) {}
     void calculate() const override;
 
 private:
+    //! basket flows of one sample in the CBO currency, indexed by date
+    struct SampleFlows {
+        vector<Cash> cf, iFlows, pFlows;
+        vector<Real> notional;
+    };
+    //! discounted values of one sample
+    struct SampleValues {
+        Real basket = 0.0, fee = 0.0, subfee = 0.0;
+        vector<Real> tranche;
+    };
+
+    //! waterfall for one sample, trancheBalance is a workspace indexed by tranche and date
+    void waterfall(Size sampleIndex, const vector<Date>& dates, SampleFlows& flows,
+                   const vector<vector<Real>>& trancheInterestRates, const vector<Real>& feeYearFractions,
+                   vector<vector<Real>>& trancheBalance, SampleValues& values) const;
     //! interest waterfall
-    void interestWaterfall(Size sampleIndex, Size dateIndex, const vector<Date>& dates,
-                           map<Currency, vector<Cash>>& basketFlow, map<Currency, Cash>& trancheFlow,
-                           map<Currency, vector<vector<Real>>>& balance, map<Currency, Real>& interest,
-                           map<Currency, Real>& interestAcc, Real cureAmount) const;
+    void interestWaterfall(Cash& iFlow, Cash& tranche, Real& balance, Real& interest, Real interestAcc) const;
     //! icoc interest waterfall
-    void icocInterestWaterfall(Size i, // sample index
-                               Size j, // date index
+    void icocInterestWaterfall(Size j, // date index
                                Size k, // tranche index
-                               const vector<Date>& dates, map<Currency, vector<Cash>>& iFlows,
-                               vector<map<Currency, Cash>>& tranches,
-                               vector<map<Currency, vector<vector<Real>>>>& balances, Real cureAmount) const;
+                               Cash& iFlow, vector<Cash>& tranches, vector<vector<Real>>& balances,
+                               Real cureAmount) const;
 
     //! pricipal waterfall
-    void principalWaterfall(Size sampleIndex, Size dateIndex, const vector<Date>& dates,
-                            map<Currency, vector<Cash>>& basketFlow, map<Currency, Cash>& trancheFlow,
-                            map<Currency, vector<vector<Real>>>& balance, map<Currency, Real>& interest) const;
+    void principalWaterfall(Cash& pFlow, Cash& tranche, Real& balance, Real& interest) const;
     //! icoc cure amount
-    Real icocCureAmount(Size sampleIndex, Size dateIndex, Size trancheNo, Real basketNotional, Real basketInterest,
-                        vector<map<Currency, vector<vector<Real>>>>& trancheBalances, vector<Real> trancheInterestRates,
+    Real icocCureAmount(Size dateIndex, Size trancheNo, Real basketNotional, Real basketInterest,
+                        const vector<vector<Real>>& trancheBalances, const vector<Real>& trancheInterestRates,
                         Real icRatios, Real ocRatios) const;
 
     //! Return dates on the CBO schedule that are closest to the requested \p lossDistributionPeriods
@@ -98,6 +108,8 @@ private:
 
     //! Periods from valuation date for which to return loss distributions
     std::vector<QuantLib::Period> lossDistributionPeriods_;
+
+    Size nThreads_;
 };
 
 } // namespace QuantExt
@@ -32,7 +32,9 @@ using namespace QuantLib;
     main result state it will produce the same results as the MidPointCdsEngine.
     In addition a result with label "stateNPV" is produced containing the NPV
     for each given default curve / recovery rate and an additional entry with
-    a default value w.r.t. the last given recovery rate in the vector. */
+    a default value w.r.t. the last given recovery rate in the vector.
+
+    States sharing the same default curve and recovery rate are only priced once. */
 class DiscountingRiskyBondEngineMultiState : public QuantExt::DiscountingRiskyBondEngine {
 public:
     DiscountingRiskyBondEngineMultiState(const Handle<YieldTermStructure>& discountCurve,
@@ -0,0 +1,365 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/indexes/fallbackiborindex.hpp>
+#include <qle/indexes/fallbackovernightindex.hpp>
+#include <qle/pricingengines/discountingswapbatchengine.hpp>
+#include <qle/termstructures/batchdiscount.hpp>
+
+#include <ql/cashflows/cashflows.hpp>
+#include <ql/cashflows/couponpricer.hpp>
+#include <ql/cashflows/fixedratecoupon.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/cashflows/simplecashflow.hpp>
+#include <ql/settings.hpp>
+
+#include <map>
+#include <typeinfo>
+
+namespace QuantExt {
+
+namespace {
+
+const Spread basisPoint = 1.0e-4;
+
+// ibor coupons whose amount is (gearing * forecast fixing + spread) * accrual * nominal for future fixings
+bool isPlainIborCoupon(const QuantLib::ext::shared_ptr<IborCoupon>& c) {
+    if (c == nullptr || typeid(*c) != typeid(IborCoupon) || c->isInArrears() || c->exCouponDate() != Date())
+        return false;
+    if (c->iborIndex()->forwardingTermStructure().empty() ||
+        QuantLib::ext::dynamic_pointer_cast<FallbackIborIndex>(c->iborIndex()) != nullptr ||
+        QuantLib::ext::dynamic_pointer_cast<FallbackOvernightIndex>(c->iborIndex()) != nullptr)
+        return false;
+    auto p = QuantLib::ext::dynamic_pointer_cast<BlackIborCouponPricer>(c->pricer());
+    return p != nullptr && typeid(*p) == typeid(BlackIborCouponPricer) && p->capletVolatility().empty();
+}
+
+// cashflows with a market independent amount
+bool isFixedAmountCashFlow(const CashFlow& c) {
+    return typeid(c) == typeid(SimpleCashFlow) || typeid(c) == typeid(Redemption) ||
+           typeid(c) == typeid(AmortizingPayment);
+}
+
+// append the discount factors for dates[k], k >= from to result, dates before the reference date get a zero discount
+void appendDiscounts(const YieldTermStructure& ts, const std::vector<Date>& dates, const Size from,
+                     std::vector<DiscountFactor>& result) {
+    const Date& refDate = ts.referenceDate();
+    std::vector<Time> times;
+    std::vector<Size> pos;
+    for (Size k = from; k < dates.size(); ++k) {
+        result.push_back(0.0);
+        if (dates[k] >= refDate) {
+            times.push_back(ts.timeFromReference(dates[k]));
+            pos.push_back(result.size() - 1);
+        }
+    }
+    std::vector<DiscountFactor> tmp(times.size());
+    QuantExt::discounts(ts, times.data(), tmp.data(), times.size());
+    for (Size k = 0; k < pos.size(); ++k)
+        result[pos[k]] = tmp[k];
+}
+
+} // namespace
+
+// flattened cashflows of all swaps priced by the engine, the flows of each swap are stored contiguously
+class DiscountingSwapBatchEngine::Batch {
+public:
+    // marks the batch as outdated without notifying the swaps
+    class Invalidator : public Observer {
+    public:
+        explicit Invalidator(Batch* batch) : batch_(batch) {}
+        void update() override { batch_->valid = false; }
+
+    private:
+        Batch* batch_;
+    };
+
+    Batch() : invalidator(QuantLib::ext::make_shared<Invalidator>(this)) {}
+
+    // add a swap, returns its index
+    Size add(const Swap::arguments& arguments);
+    // compute the leg npvs and bps of the swaps [s0, s1)
+    void compute(const Handle<YieldTermStructure>& discountCurve, bool includeRefDateFlows, Size s0, Size s1);
+
+    bool valid = false;
+    Size generation = 0, batchCalculations = 0;
+    QuantLib::ext::shared_ptr<Invalidator> invalidator;
+    Date valuationDate;
+    DiscountFactor npvDateDiscount = 0.0;
+
+    // swaps, identified by the first cashflows and payer flags of their legs
+    std::map<std::vector<std::pair<const CashFlow*, Real>>, Size> swapIndex;
+    std::vector<Size> consumed;
+    std::vector<Size> legBegin{0}, fixedBegin{0}, iborBegin{0}, otherBegin{0};
+
+    // legs
+    std::vector<Real> legPayer, legNpv, legBps;
+
+    // unique payment dates and their discount factors
+    std::map<Date, Size> payDateIndex;
+    std::vector<Date> payDates;
+    std::vector<DiscountFactor> discounts;
+    Size discountsComputed = 0;
+
+    // ibor indices, their unique value and end dates and forwarding discount factors
+    std::map<const IborIndex*, Size> indexIndex;
+    std::vector<Handle<YieldTermStructure>> forwardingCurves;
+    std::vector<std::map<Date, Size>> indexDateIndex;
+    std::vector<std::vector<Date>> indexDates;
+    std::vector<std::vector<DiscountFactor>> indexDiscounts;
+    std::vector<Size> indexDiscountsComputed;
+
+    // fixed amount flows
+    std::vector<QuantLib::ext::shared_ptr<CashFlow>> fixedCashflow;
+    std::vector<Size> fixedLeg, fixedPayDate;
+    std::vector<Real> fixedAmount, fixedBpsFactor;
+
+    // ibor coupons
+    std::vector<QuantLib::ext::shared_ptr<CashFlow>> iborCashflow;
+    std::vector<Size> iborLeg, iborPayDate, iborIndex, iborStart, iborEnd;
+    std::vector<Date> iborFixingDate;
+    std::vector<Time> iborSpanningTime;
+    std::vector<Real> iborGearingFactor, iborSpreadAmount, iborBpsFactor;
+
+    // other flows
+    std::vector<QuantLib::ext::shared_ptr<CashFlow>> otherCashflow;
+    std::vector<Size> otherLeg, otherPayDate;
+
+private:
+    Size payDate(const Date& d);
+    Size indexDate(Size index, const Date& d);
+};
+
+Size DiscountingSwapBatchEngine::Batch::payDate(const Date& d) {
+    auto p = payDateIndex.emplace(d, payDates.size());
+    if (p.second)
+        payDates.push_back(d);
+    return p.first->second;
+}
+
+Size DiscountingSwapBatchEngine::Batch::indexDate(Size index, const Date& d) {
+    auto p = indexDateIndex[index].emplace(d, indexDates[index].size());
+    if (p.second)
+        indexDates[index].push_back(d);
+    return p.first->second;
+}
+
+Size DiscountingSwapBatchEngine::Batch::add(const Swap::arguments& arguments) {
+    Size s = consumed.size();
+    for (Size l = 0; l < arguments.legs.size(); ++l) {
+        Size leg = legPayer.size();
+        legPayer.push_back(arguments.payer[l]);
+        for (auto const& cf : arguments.legs[l]) {
+            Size d = payDate(cf->date());
+            if (auto ibor = QuantLib::ext::dynamic_pointer_cast<IborCoupon>(cf); isPlainIborCoupon(ibor)) {
+                auto index = ibor->iborIndex();
+                auto p = indexIndex.emplace(index.get(), forwardingCurves.size());
+                if (p.second) {
+                    forwardingCurves.push_back(index->forwardingTermStructure());
+                    indexDateIndex.emplace_back();
+                    indexDates.emplace_back();
+                    indexDiscounts.emplace_back();
+                    indexDiscountsComputed.push_back(0);
+                    invalidator->registerWith(index);
+                }
+                Size i = p.first->second;
+                iborCashflow.push_back(cf);
+                iborLeg.push_back(leg);
+                iborPayDate.push_back(d);
+                iborIndex.push_back(i);
+                iborStart.push_back(indexDate(i, ibor->fixingValueDate()));
+                iborEnd.push_back(indexDate(i, ibor->fixingEndDate()));
+                iborFixingDate.push_back(ibor->fixingDate());
+                iborSpanningTime.push_back(ibor->spanningTime());
+                iborGearingFactor.push_back(ibor->gearing() * ibor->accrualPeriod() * ibor->nominal());
+                iborSpreadAmount.push_back(ibor->spread() * ibor->accrualPeriod() * ibor->nominal());
+                iborBpsFactor.push_back(ibor->accrualPeriod() * ibor->nominal());
+            } else if (auto fixed = QuantLib::ext::dynamic_pointer_cast<FixedRateCoupon>(cf);
+                       fixed != nullptr && typeid(*fixed) == typeid(FixedRateCoupon) &&
+                       fixed->exCouponDate() == Date()) {
+                fixedCashflow.push_back(cf);
+                fixedLeg.push_back(leg);
+                fixedPayDate.push_back(d);
+                fixedAmount.push_back(fixed->amount());
+                fixedBpsFactor.push_back(fixed->accrualPeriod() * fixed->nominal());
+            } else if (isFixedAmountCashFlow(*cf) && cf->exCouponDate() == Date()) {
+                fixedCashflow.push_back(cf);
+                fixedLeg.push_back(leg);
+                fixedPayDate.push_back(d);
+                fixedAmount.push_back(cf->amount());
+                fixedBpsFactor.push_back(0.0);
+            } else {
+                otherCashflow.push_back(cf);
+                otherLeg.push_back(leg);
+                otherPayDate.push_back(d);
+            }
+        }
+    }
+    legNpv.resize(legPayer.size(), 0.0);
+    legBps.resize(legPayer.size(), 0.0);
+    legBegin.push_back(legPayer.size());
+    fixedBegin.push_back(fixedCashflow.size());
+    iborBegin.push_back(iborCashflow.size());
+    otherBegin.push_back(otherCashflow.size());
+    consumed.push_back(0);
+    return s;
+}
+
+void DiscountingSwapBatchEngine::Batch::compute(const Handle<YieldTermStructure>& discountCurve,
+                                                bool includeRefDateFlows, Size s0, Size s1) {
+
+    // discount factors for the payment dates that were not computed yet in this generation
+
+    Date settlementDate = discountCurve->referenceDate();
+    appendDiscounts(**discountCurve, payDates, discountsComputed, discounts);
+    discountsComputed = payDates.size();
+
+    for (Size i = 0; i < forwardingCurves.size(); ++i) {
+        appendDiscounts(**forwardingCurves[i], indexDates[i], indexDiscountsComputed[i], indexDiscounts[i]);
+        indexDiscountsComputed[i] = indexDates[i].size();
+    }
+
+    // flows paid on the settlement date are checked individually
+
+    auto occurred = [&settlementDate, includeRefDateFlows](const Date& d, const CashFlow& cf) {
+        return d < settlementDate || (d == settlementDate && cf.hasOccurred(settlementDate, includeRefDateFlows));
+    };
+
+    for (Size l = legBegin[s0]; l < legBegin[s1]; ++l) {
+        legNpv[l] = 0.0;
+        legBps[l] = 0.0;
+    }
+
+    for (Size f = fixedBegin[s0]; f < fixedBegin[s1]; ++f) {
+        const Date& d = payDates[fixedPayDate[f]];
+        if (occurred(d, *fixedCashflow[f]))
+            continue;
+        DiscountFactor df = discounts[fixedPayDate[f]];
+        legNpv[fixedLeg[f]] += fixedAmount[f] * df;
+        legBps[fixedLeg[f]] += fixedBpsFactor[f] * df;
+    }
+
+    Date today = Settings::instance().evaluationDate();
+    for (Size f = iborBegin[s0]; f < iborBegin[s1]; ++f) {
+        const Date& d = payDates[iborPayDate[f]];
+        if (occurred(d, *iborCashflow[f]))
+            continue;
+        Real amount;
+        if (iborFixingDate[f] > today) {
+            const std::vector<DiscountFactor>& fwd = indexDiscounts[iborIndex[f]];
+            Rate fixing = (fwd[iborStart[f]] / fwd[iborEnd[f]] - 1.0) / iborSpanningTime[f];
+            amount = iborGearingFactor[f] * fixing + iborSpreadAmount[f];
+        } else {
+            amount = iborCashflow[f]->amount();
+        }
+        DiscountFactor df = discounts[iborPayDate[f]];
+        legNpv[iborLeg[f]] += amount * df;
+        legBps[iborLeg[f]] += iborBpsFactor[f] * df;
+    }
+
+    for (Size f = otherBegin[s0]; f < otherBegin[s1]; ++f) {
+        const CashFlow& cf = *otherCashflow[f];
+        const Date& d = payDates[otherPayDate[f]];
+        if (occurred(d, cf) || cf.tradingExCoupon(settlementDate))
+            continue;
+        DiscountFactor df = discounts[otherPayDate[f]];
+        legNpv[otherLeg[f]] += cf.amount() * df;
+        if (auto cp = dynamic_cast<const Coupon*>(&cf))
+            legBps[otherLeg[f]] += cp->nominal() * cp->accrualPeriod() * df;
+    }
+
+    for (Size l = legBegin[s0]; l < legBegin[s1]; ++l) {
+        legNpv[l] *= legPayer[l] / npvDateDiscount;
+        legBps[l] *= legPayer[l] * basisPoint / npvDateDiscount;
+    }
+}
+
+DiscountingSwapBatchEngine::DiscountingSwapBatchEngine(const Handle<YieldTermStructure>& discountCurve,
+                                                       boost::optional<bool> includeSettlementDateFlows)
+    : discountCurve_(discountCurve), includeSettlementDateFlows_(includeSettlementDateFlows),
+      batch_(QuantLib::ext::make_shared<Batch>()) {
+    registerWith(discountCurve_);
+    batch_->invalidator->registerWith(Settings::instance().evaluationDate());
+}
+
+void DiscountingSwapBatchEngine::update() {
+    batch_->valid = false;
+    Swap::engine::update();
+}
+
+Size DiscountingSwapBatchEngine::size() const { return batch_->consumed.size(); }
+
+Size DiscountingSwapBatchEngine::batchCalculations() const { return batch_->batchCalculations; }
+
+void DiscountingSwapBatchEngine::calculate() const {
+    QL_REQUIRE(!discountCurve_.empty(), "DiscountingSwapBatchEngine: discounting term structure handle is empty.");
+
+    Batch& b = *batch_;
+    bool includeRefDateFlows =
+        includeSettlementDateFlows_ ? *includeSettlementDateFlows_ : Settings::instance().includeReferenceDateEvents();
+
+    std::vector<std::pair<const CashFlow*, Real>> key;
+    for (Size i = 0; i < arguments_.legs.size(); ++i)
+        key.emplace_back(arguments_.legs[i].empty() ? nullptr : arguments_.legs[i].front().get(), arguments_.payer[i]);
+    auto it = b.swapIndex.find(key);
+    bool isNew = it == b.swapIndex.end();
+    Size s = isNew ? b.swapIndex.emplace(key, b.add(arguments_)).first->second : it->second;
+
+    /* A swap asking for its results a second time in the same generation has seen a change that the batch was not
+       notified about (or the notifications are disabled), so we recompute the batch. A new swap added to a valid batch
+       is computed on its own, so that building a portfolio does not recompute the batch for each swap. */
+    if (b.valid && b.consumed[s] == b.generation) {
+        b.valid = false;
+    }
+
+    if (!b.valid) {
+        b.discounts.clear();
+        b.discountsComputed = 0;
+        for (Size i = 0; i < b.forwardingCurves.size(); ++i) {
+            b.indexDiscounts[i].clear();
+            b.indexDiscountsComputed[i] = 0;
+        }
+        b.valuationDate = discountCurve_->referenceDate();
+        b.npvDateDiscount = discountCurve_->discount(b.valuationDate);
+        b.compute(discountCurve_, includeRefDateFlows, 0, b.consumed.size());
+        b.valid = true;
+        ++b.generation;
+        ++b.batchCalculations;
+    } else if (isNew) {
+        b.compute(discountCurve_, includeRefDateFlows, s, s + 1);
+    }
+    b.consumed[s] = b.generation;
+
+    Size n = arguments_.legs.size();
+    results_.value = 0.0;
+    results_.errorEstimate = Null<Real>();
+    results_.legNPV.resize(n);
+    results_.legBPS.resize(n);
+    results_.startDiscounts.assign(n, Null<DiscountFactor>());
+    results_.endDiscounts.assign(n, Null<DiscountFactor>());
+    for (Size i = 0; i < n; ++i) {
+        Size l = b.legBegin[s] + i;
+        results_.legNPV[i] = b.legNpv[l];
+        results_.legBPS[i] = b.legBps[l];
+        results_.value += b.legNpv[l];
+    }
+    results_.valuationDate = b.valuationDate;
+    results_.npvDateDiscount = b.npvDateDiscount;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/pricingengines/discountingswapbatchengine.hpp
+    \brief swap engine pricing all swaps sharing a discount curve in one batch
+
+        \ingroup engines
+*/
+
+#ifndef quantext_discounting_swap_batch_engine_hpp
+#define quantext_discounting_swap_batch_engine_hpp
+
+#include <ql/instruments/swap.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Discounting Swap Engine - Batch
+/*! This engine is meant to be shared by many swaps on the same discount curve. The cashflows of each swap are
+    flattened into arrays owned by the engine when the swap is priced for the first time:
+
+    - fixed rate coupons and simple cashflows contribute their (market independent) amounts
+    - ibor coupons fixing in advance and priced with a BlackIborCouponPricer contribute their gearing, spread, nominal,
+      accrual period and the index value and end dates and spanning time used in IborCoupon::indexFixing()
+    - all other cashflows are kept as they are and their amount() is called on each calculation
+
+    When the first swap is priced after a change of the discount curve, a forwarding curve or the evaluation date, the
+    discount factors for the union of the payment dates and the forwarding discount factors for the union of the index
+    value and end dates are computed once, and the NPVs of all swaps in the batch are computed in one pass over the
+    flattened arrays. The other swaps pick up their results from the batch. Ibor coupons that are already fixed are
+    priced by their amount() as well. The results agree with the DiscountingSwapEngine.
+
+    Swap::results are populated except the start and end discounts.
+
+    \warning Changes of the market data are detected via the observer pattern. If notifications are disabled, a batch
+             is recomputed when one of its swaps is priced a second time, which is sufficient if all swaps are priced
+             after each market change, as in the classic valuation engine. Pricing only a subset of the swaps after
+             market changes without notifications can give outdated results.
+
+    \ingroup engines
+*/
+class DiscountingSwapBatchEngine : public QuantLib::Swap::engine {
+public:
+    explicit DiscountingSwapBatchEngine(
+        const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
+        boost::optional<bool> includeSettlementDateFlows = boost::none);
+    void calculate() const override;
+    void update() override;
+    Handle<YieldTermStructure> discountCurve() const { return discountCurve_; }
+
+    //! number of swaps in the batch
+    Size size() const;
+    //! number of times the batch was computed for all swaps
+    Size batchCalculations() const;
+
+private:
+    Handle<YieldTermStructure> discountCurve_;
+    boost::optional<bool> includeSettlementDateFlows_;
+
+    class Batch;
+    QuantLib::ext::shared_ptr<Batch> batch_;
+};
+
+} // namespace QuantExt
+
+#endif
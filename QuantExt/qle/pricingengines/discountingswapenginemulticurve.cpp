@@ -25,6 +25,7 @@
 #include <ql/utilities/dataformatters.hpp>
 
 #include <qle/pricingengines/discountingswapenginemulticurve.hpp>
+#include <qle/termstructures/batchdiscount.hpp>
 
 namespace QuantExt {
 
@@ -174,6 +175,10 @@ void DiscountingSwapEngineMultiCurve::calculate() const {
 
     const Spread bp = 1.0e-4;
 
+    std::vector<Size> alive;
+    std::vector<Time> times;
+    std::vector<DiscountFactor> discounts;
+
     for (Size i = 0; i < numLegs; i++) {
 
         Leg leg = arguments_.legs[i];
@@ -183,15 +188,25 @@ void DiscountingSwapEngineMultiCurve::calculate() const {
         // Call amount() method of underlying coupon for first coupon.
         impl_->amountGetter_->setCallAmount(true);
 
+        /* Exclude cashflows that have occurred taking into account the
+        settlement date and includeSettlementDateFlows flag */
+        alive.clear();
+        times.clear();
         for (Size j = 0; j < leg.size(); j++) {
-
-            /* Exclude cashflows that have occurred taking into account the
-            settlement date and includeSettlementDateFlows flag */
-            if (leg[j]->hasOccurred(settlementDate, includeRefDateFlows)) {
-                continue;
+            if (!leg[j]->hasOccurred(settlementDate, includeRefDateFlows)) {
+                alive.push_back(j);
+                times.push_back(discountCurve_->timeFromReference(leg[j]->date()));
             }
+        }
+
+        // Discount factors of the remaining cashflows in one batch
+        discounts.resize(times.size());
+        QuantExt::discounts(**discountCurve_, times.data(), discounts.data(), times.size());
+
+        for (Size k = 0; k < alive.size(); k++) {
 
-            DiscountFactor discount = discountCurve_->discount(leg[j]->date());
+            Size j = alive[k];
+            DiscountFactor discount = discounts[k];
             leg[j]->accept(*(impl_->amountGetter_));
             results_.legNPV[i] += impl_->amountGetter_->amount() * discount;
             results_.legBPS[i] += impl_->amountGetter_->bpsFactor() * discount;
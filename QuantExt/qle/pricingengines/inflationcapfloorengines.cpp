@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <qle/math/vectorisedblackformula.hpp>
 #include <qle/pricingengines/inflationcapfloorengines.hpp>
 
 #include <ql/pricingengines/blackformula.hpp>
@@ -40,6 +41,18 @@ void YoYInflationCapFloorEngine::setVolatility(const Handle<QuantLib::YoYOptionl
     update();
 }
 
+void YoYInflationCapFloorEngine::optionletsImpl(Option::Type type, const std::vector<Real>& strikes,
+                                                const std::vector<Real>& forwards, const std::vector<Real>& stdDevs,
+                                                const std::vector<Real>& sqrtTimes, const std::vector<Real>& d,
+                                                std::vector<Real>& values, std::vector<Real>& vegas) const {
+    values.resize(strikes.size());
+    vegas.resize(strikes.size());
+    for (Size i = 0; i < strikes.size(); ++i) {
+        values[i] = optionletImpl(type, strikes[i], forwards[i], stdDevs[i], d[i]);
+        vegas[i] = optionletVegaImpl(Option::Call, strikes[i], forwards[i], stdDevs[i], sqrtTimes[i], d[i]);
+    }
+}
+
 void YoYInflationCapFloorEngine::calculate() const {
 
     // copy black version then adapt to others
@@ -50,12 +63,18 @@ void YoYInflationCapFloorEngine::calculate() const {
     std::vector<Real> stdDevs(optionlets, 0.0);
     std::vector<Real> forwards(optionlets, 0.0);
     YoYInflationCapFloor::Type type = arguments_.type;
+    bool hasCaplets = type == YoYInflationCapFloor::Cap || type == YoYInflationCapFloor::Collar;
+    bool hasFloorlets = type == YoYInflationCapFloor::Floor || type == YoYInflationCapFloor::Collar;
 
     Handle<YoYInflationTermStructure> yoyTS = index()->yoyInflationTermStructure();
     Handle<YieldTermStructure> discountTS = discountCurve_;
     QL_REQUIRE(!discountTS.empty(), "YoYInflationCapFloorEngine: No discount curve given.");
     Date settlement = discountTS->referenceDate();
 
+    // collect the data of the alive optionlets, the caplets and floorlets are then priced in one call each
+
+    std::vector<Size> alive;
+    std::vector<Real> aliveForwards, sqrtTimes, ds, capStrikes, capStdDevs, floorStrikes, floorStdDevs;
     for (Size i = 0; i < optionlets; ++i) {
         Date paymentDate = arguments_.payDates[i];
         if (paymentDate > settlement) { // discard expired caplets
@@ -70,7 +89,6 @@ void YoYInflationCapFloorEngine::calculate() const {
             // a pricing engine to return the swaplet rate and then
             // the adjusted fixing in the instrument.
             forwards[i] = yoyTS->yoyRate(arguments_.fixingDates[i], Period(0, Days));
-            Rate forward = forwards[i];
 
             Date fixingDate = arguments_.fixingDates[i];
             Time sqrtTime = 0.0;
@@ -78,34 +96,54 @@ void YoYInflationCapFloorEngine::calculate() const {
                 sqrtTime = std::sqrt(volatility_->timeFromBase(fixingDate));
             }
 
-            if (type == YoYInflationCapFloor::Cap || type == YoYInflationCapFloor::Collar) {
+            alive.push_back(i);
+            aliveForwards.push_back(forwards[i]);
+            sqrtTimes.push_back(sqrtTime);
+            ds.push_back(d);
+
+            // sttDev=0 for already-fixed dates so everything on forward
+            if (hasCaplets) {
                 Rate strike = arguments_.capRates[i];
                 if (sqrtTime > 0.0) {
                     stdDevs[i] = std::sqrt(volatility_->totalVariance(fixingDate, strike, Period(0, Days)));
                 }
-
-                // sttDev=0 for already-fixed dates so everything on forward
-                values[i] = optionletImpl(Option::Call, strike, forward, stdDevs[i], d);
-                vega += optionletVegaImpl(Option::Call, strike, forward, stdDevs[i], sqrtTime, d);
+                capStrikes.push_back(strike);
+                capStdDevs.push_back(stdDevs[i]);
             }
-            if (type == YoYInflationCapFloor::Floor || type == YoYInflationCapFloor::Collar) {
+            if (hasFloorlets) {
                 Rate strike = arguments_.floorRates[i];
                 if (sqrtTime > 0.0) {
                     stdDevs[i] = std::sqrt(volatility_->totalVariance(fixingDate, strike, Period(0, Days)));
                 }
-                Real floorlet = optionletImpl(Option::Put, strike, forward, stdDevs[i], d);
-                Real floorletVega = optionletVegaImpl(Option::Call, strike, forward, stdDevs[i], sqrtTime, d);
-                if (type == YoYInflationCapFloor::Floor) {
-                    values[i] = floorlet;
-                    vega -= floorletVega;
-                } else {
-                    // a collar is long a cap and short a floor
-                    values[i] -= floorlet;
-                    vega -= optionletVegaImpl(Option::Call, strike, forward, stdDevs[i], sqrtTime, d);
-                }
+                floorStrikes.push_back(strike);
+                floorStdDevs.push_back(stdDevs[i]);
+            }
+        }
+    }
+
+    std::vector<Real> capletValues, capletVegas, floorletValues, floorletVegas;
+    if (hasCaplets)
+        optionletsImpl(Option::Call, capStrikes, aliveForwards, capStdDevs, sqrtTimes, ds, capletValues, capletVegas);
+    if (hasFloorlets)
+        optionletsImpl(Option::Put, floorStrikes, aliveForwards, floorStdDevs, sqrtTimes, ds, floorletValues,
+                       floorletVegas);
+
+    for (Size j = 0; j < alive.size(); ++j) {
+        Size i = alive[j];
+        if (hasCaplets) {
+            values[i] = capletValues[j];
+            vega += capletVegas[j];
+        }
+        if (hasFloorlets) {
+            if (type == YoYInflationCapFloor::Floor) {
+                values[i] = floorletValues[j];
+            } else {
+                // a collar is long a cap and short a floor
+                values[i] -= floorletValues[j];
             }
-            value += values[i];
+            vega -= floorletVegas[j];
         }
+        value += values[i];
     }
     results_.value = value;
 
@@ -134,6 +172,19 @@ Real YoYInflationBlackCapFloorEngine::optionletVegaImpl(Option::Type type, Rate
     return blackFormulaStdDevDerivative(type, strike, forward, stdDev, d) * sqrtTime;
 }
 
+void YoYInflationBlackCapFloorEngine::optionletsImpl(Option::Type type, const std::vector<Real>& strikes,
+                                                     const std::vector<Real>& forwards,
+                                                     const std::vector<Real>& stdDevs,
+                                                     const std::vector<Real>& sqrtTimes, const std::vector<Real>& d,
+                                                     std::vector<Real>& values, std::vector<Real>& vegas) const {
+    values.resize(strikes.size());
+    vegas.resize(strikes.size());
+    vectorisedBlackFormula(type, strikes.data(), forwards.data(), stdDevs.data(), d.data(), strikes.size(),
+                           values.data(), vegas.data());
+    for (Size i = 0; i < vegas.size(); ++i)
+        vegas[i] *= sqrtTimes[i];
+}
+
 YoYInflationUnitDisplacedBlackCapFloorEngine ::YoYInflationUnitDisplacedBlackCapFloorEngine(
     const ext::shared_ptr<QuantLib::YoYInflationIndex>& index,
     const Handle<QuantLib::YoYOptionletVolatilitySurface>& volatility, const Handle<YieldTermStructure>& discountCurve)
@@ -150,6 +201,18 @@ Real YoYInflationUnitDisplacedBlackCapFloorEngine::optionletVegaImpl(Option::Typ
     return blackFormulaStdDevDerivative(type, strike + 1.0, forward + 1.0, stdDev, d) * sqrtTime;
 }
 
+void YoYInflationUnitDisplacedBlackCapFloorEngine::optionletsImpl(
+    Option::Type type, const std::vector<Real>& strikes, const std::vector<Real>& forwards,
+    const std::vector<Real>& stdDevs, const std::vector<Real>& sqrtTimes, const std::vector<Real>& d,
+    std::vector<Real>& values, std::vector<Real>& vegas) const {
+    values.resize(strikes.size());
+    vegas.resize(strikes.size());
+    vectorisedBlackFormula(type, strikes.data(), forwards.data(), stdDevs.data(), d.data(), strikes.size(),
+                           values.data(), vegas.data(), nullptr, 1.0);
+    for (Size i = 0; i < vegas.size(); ++i)
+        vegas[i] *= sqrtTimes[i];
+}
+
 YoYInflationBachelierCapFloorEngine::YoYInflationBachelierCapFloorEngine(
     const ext::shared_ptr<QuantLib::YoYInflationIndex>& index,
     const Handle<QuantLib::YoYOptionletVolatilitySurface>& volatility, const Handle<YieldTermStructure>& discountCurve)
@@ -165,4 +228,18 @@ Real YoYInflationBachelierCapFloorEngine::optionletVegaImpl(Option::Type type, R
     return bachelierBlackFormulaStdDevDerivative(strike, forward, stdDev, d) * sqrtTime;
 }
 
+void YoYInflationBachelierCapFloorEngine::optionletsImpl(Option::Type type, const std::vector<Real>& strikes,
+                                                         const std::vector<Real>& forwards,
+                                                         const std::vector<Real>& stdDevs,
+                                                         const std::vector<Real>& sqrtTimes,
+                                                         const std::vector<Real>& d, std::vector<Real>& values,
+                                                         std::vector<Real>& vegas) const {
+    values.resize(strikes.size());
+    vegas.resize(strikes.size());
+    vectorisedBachelierBlackFormula(type, strikes.data(), forwards.data(), stdDevs.data(), d.data(), strikes.size(),
+                                    values.data(), vegas.data());
+    for (Size i = 0; i < vegas.size(); ++i)
+        vegas[i] *= sqrtTimes[i];
+}
+
 } // namespace QuantExt
@@ -62,6 +62,12 @@ protected:
     virtual Real optionletImpl(Option::Type type, Rate strike, Rate forward, Real stdDev, Real d) const = 0;
     virtual Real optionletVegaImpl(Option::Type type, Rate strike, Rate forward, Real stdDev, Real sqrtTime,
                                    Real d) const = 0;
+    /*! values and vegas of all optionlets of one type in one call, the default implementation calls optionletImpl()
+        and optionletVegaImpl() for each optionlet */
+    virtual void optionletsImpl(Option::Type type, const std::vector<Real>& strikes, const std::vector<Real>& forwards,
+                                const std::vector<Real>& stdDevs, const std::vector<Real>& sqrtTimes,
+                                const std::vector<Real>& d, std::vector<Real>& values,
+                                std::vector<Real>& vegas) const;
 
     ext::shared_ptr<QuantLib::YoYInflationIndex> index_;
     Handle<QuantLib::YoYOptionletVolatilitySurface> volatility_;
@@ -79,6 +85,10 @@ protected:
     virtual Real optionletImpl(Option::Type, Real strike, Real forward, Real stdDev, Real d) const override;
     virtual Real optionletVegaImpl(Option::Type type, Rate strike, Rate forward, Real stdDev, Real sqrtTime,
                                    Real d) const override;
+    void optionletsImpl(Option::Type type, const std::vector<Real>& strikes, const std::vector<Real>& forwards,
+                        const std::vector<Real>& stdDevs, const std::vector<Real>& sqrtTimes,
+                        const std::vector<Real>& d, std::vector<Real>& values,
+                        std::vector<Real>& vegas) const override;
 };
 
 //! Unit Displaced Black-formula inflation cap/floor engine (standalone, i.e. no coupon pricer)
@@ -92,6 +102,10 @@ protected:
     virtual Real optionletImpl(Option::Type, Real strike, Real forward, Real stdDev, Real d) const override;
     virtual Real optionletVegaImpl(Option::Type type, Rate strike, Rate forward, Real stdDev, Real sqrtTime,
                                    Real d) const override;
+    void optionletsImpl(Option::Type type, const std::vector<Real>& strikes, const std::vector<Real>& forwards,
+                        const std::vector<Real>& stdDevs, const std::vector<Real>& sqrtTimes,
+                        const std::vector<Real>& d, std::vector<Real>& values,
+                        std::vector<Real>& vegas) const override;
 };
 
 //! Unit Displaced Black-formula inflation cap/floor engine (standalone, i.e. no coupon pricer)
@@ -105,6 +119,10 @@ protected:
     virtual Real optionletImpl(Option::Type, Real strike, Real forward, Real stdDev, Real d) const override;
     virtual Real optionletVegaImpl(Option::Type type, Rate strike, Rate forward, Real stdDev, Real sqrtTime,
                                    Real d) const override;
+    void optionletsImpl(Option::Type type, const std::vector<Real>& strikes, const std::vector<Real>& forwards,
+                        const std::vector<Real>& stdDevs, const std::vector<Real>& sqrtTimes,
+                        const std::vector<Real>& d, std::vector<Real>& values,
+                        std::vector<Real>& vegas) const override;
 };
 
 } // namespace QuantExt
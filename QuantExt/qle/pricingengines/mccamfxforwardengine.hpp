@@ -43,7 +43,8 @@ public:
         const std::vector<Date>& simulationDates = std::vector<Date>(),
         const std::vector<Size>& externalModelIndices = std::vector<Size>(), const bool minimalObsDate = true,
         const RegressorModel regressorModel = RegressorModel::Simple,
-        const Real regressionVarianceCutoff = Null<Real>());
+        const Real regressionVarianceCutoff = Null<Real>(), const bool shareRegressionFactorisations = false,
+        const bool usePathStore = false, const bool singlePrecisionPaths = false);
 
     void calculate() const override;
     const Handle<CrossAssetModel>& model() const { return model_; }
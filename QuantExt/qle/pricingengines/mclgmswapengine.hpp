@@ -42,7 +42,9 @@ public:
                     const std::vector<Date> simulationDates = std::vector<Date>(),
                     const std::vector<Size> externalModelIndices = std::vector<Size>(),
                     const bool minimalObsDate = true, const RegressorModel regressorModel = RegressorModel::Simple,
-                    const Real regressionVarianceCutoff = Null<Real>())
+                    const Real regressionVarianceCutoff = Null<Real>(),
+                    const bool shareRegressionFactorisations = false,
+                    const bool usePathStore = false, const bool singlePrecisionPaths = false)
         : GenericEngine<QuantLib::Swap::arguments, QuantLib::Swap::results>(),
           McMultiLegBaseEngine(Handle<CrossAssetModel>(QuantLib::ext::make_shared<CrossAssetModel>(
                                    std::vector<QuantLib::ext::shared_ptr<IrModel>>(1, model),
@@ -50,7 +52,8 @@ public:
                                calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                                calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                                {discountCurve}, simulationDates, externalModelIndices, minimalObsDate, regressorModel,
-                               regressionVarianceCutoff) {
+                               regressionVarianceCutoff, shareRegressionFactorisations, usePathStore,
+                               singlePrecisionPaths) {
         registerWith(model);
     }
 
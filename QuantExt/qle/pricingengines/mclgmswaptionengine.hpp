@@ -44,14 +44,18 @@ public:
                         const std::vector<Date> simulationDates = std::vector<Date>(),
                         const std::vector<Size> externalModelIndices = std::vector<Size>(),
                         const bool minimalObsDate = true, const RegressorModel regressorModel = RegressorModel::Simple,
-                        const Real regressionVarianceCutoff = Null<Real>())
+                        const Real regressionVarianceCutoff = Null<Real>(),
+                        const bool shareRegressionFactorisations = false,
+                        const bool usePathStore = false, const bool singlePrecisionPaths = false)
         : GenericEngine<QuantLib::Swaption::arguments, QuantLib::Swaption::results>(),
           McMultiLegBaseEngine(Handle<CrossAssetModel>(QuantLib::ext::make_shared<CrossAssetModel>(
                                    std::vector<QuantLib::ext::shared_ptr<IrModel>>(1, model),
                                    std::vector<QuantLib::ext::shared_ptr<FxBsParametrization>>())),
                                calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                                calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
-                               {discountCurve}, simulationDates, externalModelIndices, minimalObsDate, regressorModel) {
+                               {discountCurve}, simulationDates, externalModelIndices, minimalObsDate, regressorModel,
+                               regressionVarianceCutoff, shareRegressionFactorisations, usePathStore,
+                               singlePrecisionPaths) {
         registerWith(model);
     }
 
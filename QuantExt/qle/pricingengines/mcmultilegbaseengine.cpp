@@ -25,6 +25,8 @@
 #include <qle/cashflows/overnightindexedcoupon.hpp>
 #include <qle/cashflows/subperiodscoupon.hpp>
 #include <qle/math/randomvariablelsmbasissystem.hpp>
+#include <qle/math/regressionfactorisationcache.hpp>
+#include <qle/methods/mcpathstore.hpp>
 #include <qle/pricingengines/mcmultilegbaseengine.hpp>
 #include <qle/processes/irlgm1fstateprocess.hpp>
 
@@ -47,13 +49,19 @@ McMultiLegBaseEngine::McMultiLegBaseEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     SobolRsg::DirectionIntegers directionIntegers, const std::vector<Handle<YieldTermStructure>>& discountCurves,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const RegressorModel regressorModel, const Real regressionVarianceCutoff)
+    const RegressorModel regressorModel, const Real regressionVarianceCutoff, const bool shareRegressionFactorisations,
+    const bool usePathStore, const bool singlePrecisionPaths)
     : model_(model), calibrationPathGenerator_(calibrationPathGenerator), pricingPathGenerator_(pricingPathGenerator),
       calibrationSamples_(calibrationSamples), pricingSamples_(pricingSamples), calibrationSeed_(calibrationSeed),
       pricingSeed_(pricingSeed), polynomOrder_(polynomOrder), polynomType_(polynomType), ordering_(ordering),
       directionIntegers_(directionIntegers), discountCurves_(discountCurves), simulationDates_(simulationDates),
       externalModelIndices_(externalModelIndices), minimalObsDate_(minimalObsDate), regressorModel_(regressorModel),
-      regressionVarianceCutoff_(regressionVarianceCutoff) {
+      regressionVarianceCutoff_(regressionVarianceCutoff),
+      shareRegressionFactorisations_(shareRegressionFactorisations), usePathStore_(usePathStore),
+      singlePrecisionPaths_(singlePrecisionPaths) {
+
+    QL_REQUIRE(!(usePathStore_ && singlePrecisionPaths_),
+               "McMultiLegBaseEngine: usePathStore and singlePrecisionPaths can not be combined.");
 
     if (discountCurves_.empty())
         discountCurves_.resize(model_->components(CrossAssetModel::AssetType::IR));
@@ -644,11 +652,12 @@ Size McMultiLegBaseEngine::timeIndex(const Time t, const std::set<Real>& times)
     return std::distance(times.begin(), it);
 }
 
-RandomVariable McMultiLegBaseEngine::cashflowPathValue(const CashflowInfo& cf,
-                                                       const std::vector<std::vector<RandomVariable>>& pathValues,
-                                                       const std::set<Real>& simulationTimes) const {
+RandomVariable
+McMultiLegBaseEngine::cashflowPathValue(const CashflowInfo& cf,
+                                        const std::vector<std::vector<const RandomVariable*>>& pathValues,
+                                        const std::set<Real>& simulationTimes) const {
 
-    Size n = pathValues[0][0].size();
+    Size n = pathValues[0][0]->size();
     auto simTimesPayIdx = timeIndex(cf.payTime, simulationTimes);
 
     std::vector<RandomVariable> initialValues(model_->stateProcess()->initialValues().size());
@@ -665,7 +674,7 @@ RandomVariable McMultiLegBaseEngine::cashflowPathValue(const CashflowInfo& cf,
         } else {
             auto simTimesIdx = timeIndex(cf.simulationTimes[i], simulationTimes);
             for (Size j = 0; j < cf.modelIndices[i].size(); ++j) {
-                tmp[j] = &pathValues[simTimesIdx][cf.modelIndices[i][j]];
+                tmp[j] = pathValues[simTimesIdx][cf.modelIndices[i][j]];
             }
         }
         states[i] = tmp;
@@ -673,16 +682,63 @@ RandomVariable McMultiLegBaseEngine::cashflowPathValue(const CashflowInfo& cf,
 
     auto amount = cf.amountCalculator(n, states) /
                   lgmVectorised_[0].numeraire(
-                      cf.payTime, pathValues[simTimesPayIdx][model_->pIdx(CrossAssetModel::AssetType::IR, 0)],
+                      cf.payTime, *pathValues[simTimesPayIdx][model_->pIdx(CrossAssetModel::AssetType::IR, 0)],
                       discountCurves_[0]);
 
     if (cf.payCcyIndex > 0) {
-        amount *= exp(pathValues[simTimesPayIdx][model_->pIdx(CrossAssetModel::AssetType::FX, cf.payCcyIndex - 1)]);
+        amount *= exp(*pathValues[simTimesPayIdx][model_->pIdx(CrossAssetModel::AssetType::FX, cf.payCcyIndex - 1)]);
     }
 
     return amount * RandomVariable(n, cf.payer ? -1.0 : 1.0);
 }
 
+void McMultiLegBaseEngine::generateCalibrationPaths(
+    const std::set<Real>& simulationTimes, const std::function<void(const Size, const MultiPath&)>& storePath) const {
+
+    TimeGrid timeGrid(simulationTimes.begin(), simulationTimes.end());
+
+    QuantLib::ext::shared_ptr<StochasticProcess> process = model_->stateProcess();
+    if (model_->dimension() == 1) {
+        // use lgm process if possible for better performance
+        auto tmp = QuantLib::ext::make_shared<IrLgm1fStateProcess>(model_->irlgm1f(0));
+        tmp->resetCache(timeGrid.size() - 1);
+        process = tmp;
+    } else if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
+        // enable cache
+        tmp->resetCache(timeGrid.size() - 1);
+    }
+
+    auto pathGenerator = makeMultiPathGenerator(calibrationPathGenerator_, process, timeGrid, calibrationSeed_,
+                                                ordering_, directionIntegers_);
+
+    for (Size i = 0; i < calibrationSamples_; ++i)
+        storePath(i, pathGenerator->next().value);
+}
+
+std::vector<std::vector<RandomVariable>>
+McMultiLegBaseEngine::simulateCalibrationPaths(const std::set<Real>& simulationTimes) const {
+
+    std::vector<std::vector<RandomVariable>> pathValues(
+        simulationTimes.size(),
+        std::vector<RandomVariable>(model_->stateProcess()->size(), RandomVariable(calibrationSamples_)));
+
+    for (Size i = 0; i < pathValues.size(); ++i) {
+        for (Size j = 0; j < pathValues[i].size(); ++j) {
+            pathValues[i][j].expand();
+        }
+    }
+
+    generateCalibrationPaths(simulationTimes, [&pathValues](const Size i, const MultiPath& path) {
+        for (Size j = 0; j < pathValues.size(); ++j) {
+            for (Size k = 0; k < pathValues[j].size(); ++k) {
+                pathValues[j][k].data()[i] = path[k][j + 1];
+            }
+        }
+    });
+
+    return pathValues;
+}
+
 void McMultiLegBaseEngine::calculate() const {
 
     McEngineStats::instance().other_timer.resume();
@@ -781,43 +837,96 @@ void McMultiLegBaseEngine::calculate() const {
 
     QL_REQUIRE(!simulationTimes.empty(),
                "McMultiLegBaseEngine::calculate(): no simulation times, this is not expected.");
-    std::vector<std::vector<RandomVariable>> pathValues(
-        simulationTimes.size(),
-        std::vector<RandomVariable>(model_->stateProcess()->size(), RandomVariable(calibrationSamples_)));
+
+    /* the paths are either simulated for this engine or taken from the path store, in the latter case the path store
+       paths may contain more times than we need, we only refer to the paths on our simulation times. If single
+       precision paths are used, the paths are stored as floats and converted to double precision only for the times
+       needed in a step of the backward induction below, see requirePaths() and releasePaths(). The first time is
+       always kept in double precision, since the sample size is read from it. */
+
+    std::vector<std::vector<RandomVariable>> pathValues;
+    std::vector<std::vector<std::vector<float>>> pathValuesSinglePrecision;
+    QuantLib::ext::shared_ptr<const McPathStore::Paths> storedPaths;
     std::vector<std::vector<const RandomVariable*>> pathValuesRef(
         simulationTimes.size(), std::vector<const RandomVariable*>(model_->stateProcess()->size()));
 
-    for (Size i = 0; i < pathValues.size(); ++i) {
+    if (usePathStore_) {
+        std::ostringstream key;
+        key << static_cast<int>(calibrationPathGenerator_) << "," << calibrationSeed_ << "," << calibrationSamples_
+            << "," << static_cast<int>(ordering_) << "," << static_cast<int>(directionIntegers_) << ","
+            << today_.serialNumber();
+        storedPaths = McPathStore::instance().paths(
+            model_.currentLink(), key.str(), simulationTimes,
+            [this](const std::set<Real>& times) { return simulateCalibrationPaths(times); });
+        Size storedTimeIndex = 0;
+        Size i = 0;
+        for (auto const t : simulationTimes) {
+            while (storedPaths->times[storedTimeIndex] != t)
+                ++storedTimeIndex;
+            for (Size j = 0; j < pathValuesRef[i].size(); ++j)
+                pathValuesRef[i][j] = &storedPaths->values[storedTimeIndex][j];
+            ++i;
+        }
+    } else if (singlePrecisionPaths_) {
+        pathValuesSinglePrecision = std::vector<std::vector<std::vector<float>>>(
+            simulationTimes.size(),
+            std::vector<std::vector<float>>(model_->stateProcess()->size(), std::vector<float>(calibrationSamples_)));
+        generateCalibrationPaths(simulationTimes, [&pathValuesSinglePrecision](const Size i, const MultiPath& path) {
+            for (Size j = 0; j < pathValuesSinglePrecision.size(); ++j) {
+                for (Size k = 0; k < pathValuesSinglePrecision[j].size(); ++k) {
+                    pathValuesSinglePrecision[j][k][i] = static_cast<float>(path[k][j + 1]);
+                }
+            }
+        });
+        pathValues.resize(simulationTimes.size());
+    } else {
+        pathValues = simulateCalibrationPaths(simulationTimes);
+        for (Size i = 0; i < pathValues.size(); ++i) {
+            for (Size j = 0; j < pathValues[i].size(); ++j) {
+                pathValuesRef[i][j] = &pathValues[i][j];
+            }
+        }
+    }
+
+    auto materialisePaths = [this, &pathValuesSinglePrecision, &pathValues, &pathValuesRef](const Size i) {
+        if (!pathValues[i].empty())
+            return;
+        pathValues[i].resize(pathValuesSinglePrecision[i].size(), RandomVariable(calibrationSamples_));
         for (Size j = 0; j < pathValues[i].size(); ++j) {
             pathValues[i][j].expand();
+            std::copy(pathValuesSinglePrecision[i][j].begin(), pathValuesSinglePrecision[i][j].end(),
+                      pathValues[i][j].data());
             pathValuesRef[i][j] = &pathValues[i][j];
         }
-    }
-
-    TimeGrid timeGrid(simulationTimes.begin(), simulationTimes.end());
-
-    QuantLib::ext::shared_ptr<StochasticProcess> process = model_->stateProcess();
-    if (model_->dimension() == 1) {
-        // use lgm process if possible for better performance
-        auto tmp = QuantLib::ext::make_shared<IrLgm1fStateProcess>(model_->irlgm1f(0));
-        tmp->resetCache(timeGrid.size() - 1);
-        process = tmp;
-    } else if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
-        // enable cache
-        tmp->resetCache(timeGrid.size() - 1);
-    }
+    };
+
+    auto requirePaths = [this, &simulationTimes, &materialisePaths](const std::set<Real>& times) {
+        if (!singlePrecisionPaths_)
+            return;
+        for (auto const t : times) {
+            if (t != 0.0)
+                materialisePaths(timeIndex(t, simulationTimes));
+        }
+    };
+
+    auto releasePaths = [this, &pathValues, &pathValuesRef]() {
+        if (!singlePrecisionPaths_)
+            return;
+        for (Size i = 1; i < pathValues.size(); ++i) {
+            pathValues[i].clear();
+            std::fill(pathValuesRef[i].begin(), pathValuesRef[i].end(), nullptr);
+        }
+    };
 
-    auto pathGenerator = makeMultiPathGenerator(calibrationPathGenerator_, process, timeGrid, calibrationSeed_,
-                                                ordering_, directionIntegers_);
+    if (singlePrecisionPaths_)
+        materialisePaths(0);
 
-    for (Size i = 0; i < calibrationSamples_; ++i) {
-        const MultiPath& path = pathGenerator->next().value;
-        for (Size j = 0; j < simulationTimes.size(); ++j) {
-            for (Size k = 0; k < model_->stateProcess()->size(); ++k) {
-                pathValues[j][k].data()[i] = path[k][j + 1];
-            }
-        }
-    }
+    auto cashflowValue = [this, &cashflowInfo, &pathValuesRef, &simulationTimes, &requirePaths](const Size i) {
+        std::set<Real> times(cashflowInfo[i].simulationTimes.begin(), cashflowInfo[i].simulationTimes.end());
+        times.insert(cashflowInfo[i].payTime);
+        requirePaths(times);
+        return cashflowPathValue(cashflowInfo[i], pathValuesRef, simulationTimes);
+    };
 
     McEngineStats::instance().path_timer.stop();
 
@@ -853,12 +962,12 @@ void McMultiLegBaseEngine::calculate() const {
 
             if (cfStatus[i] == CfStatus::open) {
                 if (cashflowInfo[i].exIntoCriterionTime > *t) {
-                    auto tmp = cashflowPathValue(cashflowInfo[i], pathValues, simulationTimes);
+                    auto tmp = cashflowValue(i);
                     pathValueUndDirty += tmp;
                     pathValueUndExInto += tmp;
                     cfStatus[i] = CfStatus::done;
                 } else if (cashflowInfo[i].payTime > *t - (includeSettlementDateFlows_ ? tinyTime : 0.0)) {
-                    auto tmp = cashflowPathValue(cashflowInfo[i], pathValues, simulationTimes);
+                    auto tmp = cashflowValue(i);
                     pathValueUndDirty += tmp;
                     amountCache[i] = tmp;
                     cfStatus[i] = CfStatus::cached;
@@ -875,7 +984,8 @@ void McMultiLegBaseEngine::calculate() const {
         if (exercise_ != nullptr) {
             regModelUndExInto[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, shareRegressionFactorisations_);
+            requirePaths(regModelUndExInto[counter].regressorTimes());
             regModelUndExInto[counter].train(polynomOrder_, polynomType_, pathValueUndExInto, pathValuesRef,
                                              simulationTimes);
         }
@@ -885,7 +995,8 @@ void McMultiLegBaseEngine::calculate() const {
                                                                   pathValuesRef, simulationTimes);
             regModelContinuationValue[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, shareRegressionFactorisations_);
+            requirePaths(regModelContinuationValue[counter].regressorTimes());
             regModelContinuationValue[counter].train(polynomOrder_, polynomType_, pathValueOption, pathValuesRef,
                                                      simulationTimes,
                                                      exerciseValue > RandomVariable(calibrationSamples_, 0.0));
@@ -896,14 +1007,16 @@ void McMultiLegBaseEngine::calculate() const {
                                                 pathValueUndExInto, pathValueOption);
             regModelOption[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, shareRegressionFactorisations_);
+            requirePaths(regModelOption[counter].regressorTimes());
             regModelOption[counter].train(polynomOrder_, polynomType_, pathValueOption, pathValuesRef, simulationTimes);
         }
 
         if (isXvaTime) {
             regModelUndDirty[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] != CfStatus::open; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, shareRegressionFactorisations_);
+            requirePaths(regModelUndDirty[counter].regressorTimes());
             regModelUndDirty[counter].train(polynomOrder_, polynomType_, pathValueUndDirty, pathValuesRef,
                                             simulationTimes);
         }
@@ -911,10 +1024,12 @@ void McMultiLegBaseEngine::calculate() const {
         if (exercise_ != nullptr) {
             regModelOption[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, shareRegressionFactorisations_);
+            requirePaths(regModelOption[counter].regressorTimes());
             regModelOption[counter].train(polynomOrder_, polynomType_, pathValueOption, pathValuesRef, simulationTimes);
         }
 
+        releasePaths();
         --counter;
     }
 
@@ -922,7 +1037,7 @@ void McMultiLegBaseEngine::calculate() const {
 
     for (Size i = 0; i < cashflowInfo.size(); ++i) {
         if (cfStatus[i] == CfStatus::open)
-            pathValueUndDirty += cashflowPathValue(cashflowInfo[i], pathValues, simulationTimes);
+            pathValueUndDirty += cashflowValue(i);
     }
 
     // set the result value (= underlying value if no exercise is given, otherwise option value)
@@ -959,7 +1074,7 @@ McMultiLegBaseEngine::MultiLegBaseAmcCalculator::MultiLegBaseAmcCalculator(
       baseCurrency_(baseCurrency) {}
 
 std::vector<QuantExt::RandomVariable> McMultiLegBaseEngine::MultiLegBaseAmcCalculator::simulatePath(
-    const std::vector<QuantLib::Real>& pathTimes, std::vector<std::vector<QuantExt::RandomVariable>>& paths,
+    const std::vector<QuantLib::Real>& pathTimes, const std::vector<std::vector<QuantExt::RandomVariable>>& paths,
     const std::vector<size_t>& relevantPathIndex, const std::vector<size_t>& relevantTimeIndex) {
 
         // check input path consistency
@@ -1106,8 +1221,10 @@ McMultiLegBaseEngine::RegressionModel::RegressionModel(const Real observationTim
                                                        const std::function<bool(std::size_t)>& cashflowRelevant,
                                                        const CrossAssetModel& model,
                                                        const McMultiLegBaseEngine::RegressorModel regressorModel,
-                                                       const Real regressionVarianceCutoff)
-    : observationTime_(observationTime), regressionVarianceCutoff_(regressionVarianceCutoff) {
+                                                       const Real regressionVarianceCutoff,
+                                                       const bool shareRegressionFactorisations)
+    : observationTime_(observationTime), regressionVarianceCutoff_(regressionVarianceCutoff),
+      shareRegressionFactorisations_(shareRegressionFactorisations) {
 
     // we always include the full model state as of the observation time
 
@@ -1179,14 +1296,21 @@ void McMultiLegBaseEngine::RegressionModel::train(const Size polynomOrder,
 
     if (!regressor.empty()) {
 
-        // get the basis functions
+        // get the basis functions, they are needed to evaluate the model in apply()
 
         basisFns_ = multiPathBasisSystem(regressor.size(), polynomOrder, polynomType, Null<Size>());
 
-        // compute the regression coefficients
+        // compute the regression coefficients, the basis function values on the training paths are computed in one go
 
-        regressionCoeffs_ =
-            regressionCoefficients(regressand, regressor, basisFns_, filter, RandomVariableRegressionMethod::QR);
+        if (shareRegressionFactorisations_) {
+            auto qr = RegressionFactorisationCache::instance().factorisation(regressor, polynomOrder, polynomType,
+                                                                             filter);
+            regressionCoeffs_ = regressionCoefficients(regressand, *qr, filter);
+        } else {
+            regressionCoeffs_ =
+                regressionCoefficients(regressand, multiPathBasisSystemValues(regressor, polynomOrder, polynomType),
+                                       filter, RandomVariableRegressionMethod::QR);
+        }
 
     } else {
 
@@ -1202,6 +1326,13 @@ void McMultiLegBaseEngine::RegressionModel::train(const Size polynomOrder,
     isTrained_ = true;
 }
 
+std::set<Real> McMultiLegBaseEngine::RegressionModel::regressorTimes() const {
+    std::set<Real> result;
+    for (auto const& [t, modelIdx] : regressorTimesModelIndices_)
+        result.insert(t);
+    return result;
+}
+
 RandomVariable
 McMultiLegBaseEngine::RegressionModel::apply(const Array& initialState,
                                              const std::vector<std::vector<const RandomVariable*>>& paths,
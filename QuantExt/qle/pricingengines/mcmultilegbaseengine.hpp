@@ -70,6 +70,21 @@ protected:
         Current limitations:
         - the parameter minimalObsDate is ignored, the corresponding optimization is not implemented yet
         - pricingSamples are ignored, the npv from the training phase is used alway
+
+        If shareRegressionFactorisations is true, the QR factorisations of the regression design matrices are taken
+        from the RegressionFactorisationCache, so that regressions with the same regressor values and filter (this
+        includes regressions of other trades with the same observation times and calibration paths) are solved with
+        one factorisation.
+
+        If usePathStore is true, the calibration paths are taken from the McPathStore, so that engines on the same
+        model with the same calibration settings share one simulation of the model on the union of their simulation
+        times.
+
+        If singlePrecisionPaths is true, the calibration paths are stored in single precision and only converted to
+        double precision for the times needed in the current step of the backward induction, the regressions and the
+        accumulation of the cashflow values are still done in double precision. This reduces the memory footprint of
+        the paths by roughly a factor of two, in exchange for a loss of precision in the stored model states of the
+        order of 1E-7 relative. This option can not be combined with usePathStore.
     */
     McMultiLegBaseEngine(
         const Handle<CrossAssetModel>& model, const SequenceType calibrationPathGenerator,
@@ -81,7 +96,8 @@ protected:
         const std::vector<Date>& simulationDates = std::vector<Date>(),
         const std::vector<Size>& externalModelIndices = std::vector<Size>(), const bool minimalObsDate = true,
         const RegressorModel regressorModel = RegressorModel::Simple,
-        const Real regressionVarianceCutoff = Null<Real>());
+        const Real regressionVarianceCutoff = Null<Real>(), const bool shareRegressionFactorisations = false,
+        const bool usePathStore = false, const bool singlePrecisionPaths = false);
 
     // run calibration and pricing (called from derived engines)
     void calculate() const;
@@ -111,6 +127,9 @@ protected:
     bool minimalObsDate_;
     RegressorModel regressorModel_;
     Real regressionVarianceCutoff_;
+    bool shareRegressionFactorisations_;
+    bool usePathStore_;
+    bool singlePrecisionPaths_;
 
     // the generated amc calculator
     mutable QuantLib::ext::shared_ptr<AmcCalculator> amcCalculator_;
@@ -140,7 +159,8 @@ private:
         RegressionModel() = default;
         RegressionModel(const Real observationTime, const std::vector<CashflowInfo>& cashflowInfo,
                         const std::function<bool(std::size_t)>& cashflowRelevant, const CrossAssetModel& model,
-                        const RegressorModel regressorModel, const Real regressionVarianceCutoff = Null<Real>());
+                        const RegressorModel regressorModel, const Real regressionVarianceCutoff = Null<Real>(),
+                        const bool shareRegressionFactorisations = false);
         // pathTimes must contain the observation time and the relevant cashflow simulation times
         void train(const Size polynomOrder, const LsmBasisSystem::PolynomialType polynomType,
                    const RandomVariable& regressand, const std::vector<std::vector<const RandomVariable*>>& paths,
@@ -148,10 +168,13 @@ private:
         // pathTimes do not need to contain the observation time or the relevant cashflow simulation times
         RandomVariable apply(const Array& initialState, const std::vector<std::vector<const RandomVariable*>>& paths,
                              const std::set<Real>& pathTimes) const;
+        // the path times on which the regressor is built
+        std::set<Real> regressorTimes() const;
 
     private:
         Real observationTime_ = Null<Real>();
         Real regressionVarianceCutoff_ = Null<Real>();
+        bool shareRegressionFactorisations_ = false;
         bool isTrained_ = false;
         std::set<std::pair<Real, Size>> regressorTimesModelIndices_;
         Matrix coordinateTransform_;
@@ -172,10 +195,12 @@ private:
                                   const Real resultValue, const Array& initialState, const Currency& baseCurrency);
 
         Currency npvCurrency() override { return baseCurrency_; }
-        std::vector<QuantExt::RandomVariable> simulatePath(const std::vector<QuantLib::Real>& pathTimes,
-                                                           std::vector<std::vector<QuantExt::RandomVariable>>& paths,
-                                                           const std::vector<size_t>& relevantPathIndex,
-                                                           const std::vector<size_t>& relevantTimeIndex) override;
+        std::vector<QuantExt::RandomVariable>
+        simulatePath(const std::vector<QuantLib::Real>& pathTimes,
+                     const std::vector<std::vector<QuantExt::RandomVariable>>& paths,
+                     const std::vector<size_t>& relevantPathIndex,
+                     const std::vector<size_t>& relevantTimeIndex) override;
+        std::vector<Size> requiredStateIndices() const override { return externalModelIndices_; }
 
     private:
         std::vector<Size> externalModelIndices_;
@@ -205,9 +230,16 @@ private:
     Size timeIndex(const Time t, const std::set<Real>& simulationTimes) const;
 
     // compute a cashflow path value (in model base ccy)
-    RandomVariable cashflowPathValue(const CashflowInfo& cf, const std::vector<std::vector<RandomVariable>>& pathValues,
+    RandomVariable cashflowPathValue(const CashflowInfo& cf,
+                                     const std::vector<std::vector<const RandomVariable*>>& pathValues,
                                      const std::set<Real>& simulationTimes) const;
 
+    // simulate the calibration paths on the given times, the result is indexed by time first and state second
+    std::vector<std::vector<RandomVariable>> simulateCalibrationPaths(const std::set<Real>& times) const;
+    // generate the calibration paths on the given times and pass each sample to storePath
+    void generateCalibrationPaths(const std::set<Real>& times,
+                                  const std::function<void(const Size, const MultiPath&)>& storePath) const;
+
     // valuation date
     mutable Date today_;
 
@@ -55,12 +55,35 @@ void MidPointCdsEngineMultiState::linkCurves(Size i) const {
 
 void MidPointCdsEngineMultiState::calculate() const {
 
-    // calculate all states except the main states
+    // states with the same curve and recovery rate as the main state or a previous state share its npv
 
-    std::vector<Real> values(defaultCurves_.size() + 1);
+    auto sameState = [this](const Size i, const Size k) {
+        return defaultCurves_[i].currentLink() == defaultCurves_[k].currentLink() &&
+               recoveryRates_[i]->value() == recoveryRates_[k]->value();
+    };
+    std::vector<Size> source(defaultCurves_.size());
     for (Size i = 0; i < defaultCurves_.size(); ++i) {
+        source[i] = i;
         if (i == mainResultState_)
             continue;
+        if (sameState(i, mainResultState_)) {
+            source[i] = mainResultState_;
+            continue;
+        }
+        for (Size k = 0; k < i; ++k) {
+            if (source[k] == k && k != mainResultState_ && sameState(i, k)) {
+                source[i] = k;
+                break;
+            }
+        }
+    }
+
+    // calculate all states except the main state and the shared ones
+
+    std::vector<Real> values(defaultCurves_.size() + 1);
+    for (Size i = 0; i < defaultCurves_.size(); ++i) {
+        if (i == mainResultState_ || source[i] != i)
+            continue;
         linkCurves(i);
         MidPointCdsEngine::calculate();
         values[i] = results_.value;
@@ -72,6 +95,11 @@ void MidPointCdsEngineMultiState::calculate() const {
     MidPointCdsEngine::calculate();
     values[mainResultState_] = results_.value;
 
+    // copy the shared states
+
+    for (Size i = 0; i < defaultCurves_.size(); ++i)
+        values[i] = values[source[i]];
+
     // calculate the default state
 
     values.back() = calculateDefaultValue();
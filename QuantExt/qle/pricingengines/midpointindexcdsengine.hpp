@@ -43,7 +43,7 @@ public:
                            boost::optional<bool> includeSettlementDateFlows = boost::none);
     void calculate() const override;
 
-private:
+protected:
     Real survivalProbability(const Date& d) const override;
     Real defaultProbability(const Date& d1, const Date& d2) const override;
     Real expectedLoss(const Date& defaultDate, const Date& d1, const Date& d2, const Real notional) const override;
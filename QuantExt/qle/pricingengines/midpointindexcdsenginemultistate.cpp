@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/pricingengines/midpointindexcdsenginemultistate.hpp>
+
+#include <ql/instruments/claim.hpp>
+
+namespace QuantExt {
+
+MidPointIndexCdsEngineMultiState::MidPointIndexCdsEngineMultiState(
+    const std::vector<Handle<DefaultProbabilityTermStructure>>& defaultCurves,
+    const std::vector<Handle<Quote>>& recoveryRates, const Handle<YieldTermStructure>& discountCurve,
+    const Size mainResultState, const boost::optional<bool> includeSettlementDateFlows)
+    : MidPointIndexCdsEngine(Handle<DefaultProbabilityTermStructure>(), 0.0, discountCurve,
+                             includeSettlementDateFlows),
+      defaultCurves_(defaultCurves), recoveryRates_(recoveryRates), mainResultState_(mainResultState) {
+    QL_REQUIRE(defaultCurves.size() == recoveryRates.size(),
+               "MidPointIndexCdsEngineMultiState: number of default curves ("
+                   << defaultCurves_.size() << ") must match number of recovery rates (" << recoveryRates_.size()
+                   << ")");
+    QL_REQUIRE(!defaultCurves.empty(), "MidPointIndexCdsEngineMultiState: no default curves / recovery rates given");
+    for (auto const& h : defaultCurves_) {
+        registerWith(h);
+    }
+    for (auto const& r : recoveryRates_) {
+        registerWith(r);
+    }
+    QL_REQUIRE(mainResultState < defaultCurves.size(), "MidPointIndexCdsEngineMultiState: mainResultState ("
+                                                           << mainResultState << ") out of range 0..."
+                                                           << defaultCurves.size() - 1);
+}
+
+void MidPointIndexCdsEngineMultiState::linkCurves(Size i) const {
+    probability_ = defaultCurves_[i];
+    recoveryRate_ = recoveryRates_[i]->value();
+}
+
+void MidPointIndexCdsEngineMultiState::calculate() const {
+
+    // states with the same curve and recovery rate as the main state or a previous state share its npv
+
+    auto sameState = [this](const Size i, const Size k) {
+        return defaultCurves_[i].currentLink() == defaultCurves_[k].currentLink() &&
+               recoveryRates_[i]->value() == recoveryRates_[k]->value();
+    };
+    std::vector<Size> source(defaultCurves_.size());
+    for (Size i = 0; i < defaultCurves_.size(); ++i) {
+        source[i] = i;
+        if (i == mainResultState_)
+            continue;
+        if (sameState(i, mainResultState_)) {
+            source[i] = mainResultState_;
+            continue;
+        }
+        for (Size k = 0; k < i; ++k) {
+            if (source[k] == k && k != mainResultState_ && sameState(i, k)) {
+                source[i] = k;
+                break;
+            }
+        }
+    }
+
+    // calculate all states except the main state and the shared ones
+
+    std::vector<Real> values(defaultCurves_.size() + 1);
+    for (Size i = 0; i < defaultCurves_.size(); ++i) {
+        if (i == mainResultState_ || source[i] != i)
+            continue;
+        linkCurves(i);
+        MidPointIndexCdsEngine::calculate();
+        values[i] = results_.value;
+    }
+
+    // calculate the main state last to keep the results from this calculation
+
+    linkCurves(mainResultState_);
+    MidPointIndexCdsEngine::calculate();
+    values[mainResultState_] = results_.value;
+
+    // copy the shared states
+
+    for (Size i = 0; i < defaultCurves_.size(); ++i)
+        values[i] = values[source[i]];
+
+    // calculate the default state
+
+    values.back() = calculateDefaultValue();
+
+    // set additional result
+
+    results_.additionalResults["stateNpv"] = values;
+}
+
+Real MidPointIndexCdsEngineMultiState::calculateDefaultValue() const {
+    Date defaultDate = discountCurve_->referenceDate();
+    Real phi = arguments_.side == Protection::Seller ? -1.0 : 1.0;
+    return phi * arguments_.claim->amount(defaultDate, arguments_.notional, recoveryRates_.back()->value());
+}
+
+} // namespace QuantExt
@@ -485,16 +485,16 @@ void NumericLgmMultiLegOptionEngineBase::calculate() const {
         // roll back
 
         if (t_from != t_to) {
-            underlyingNpv = solver_->rollback(underlyingNpv, t_from, t_to);
-            optionNpv = solver_->rollback(optionNpv, t_from, t_to);
+            std::vector<RandomVariable*> values{&underlyingNpv, &optionNpv};
             for (auto& c : cache) {
                 if (!c.initialised())
                     continue;
-                c = solver_->rollback(c, t_from, t_to);
+                values.push_back(&c);
             }
             // need to roll back provisionalNpv only for the last step t_1 -> t_0 = 0
             if (it == std::next(timeGrid.rend(), -1))
-                provisionalNpv = solver_->rollback(provisionalNpv, t_from, t_to);
+                values.push_back(&provisionalNpv);
+            solver_->rollbackMultiple(values, t_from, t_to);
         }
     }
 
@@ -574,6 +574,35 @@ Array CrossAssetStateProcess::evolve(Time t0, const Array& x0, Time dt, const Ar
     return res;
 }
 
+bool CrossAssetStateProcess::hasAffineStep() const {
+    return model_->modelType(CrossAssetModel::AssetType::IR, 0) == CrossAssetModel::ModelType::LGM1F &&
+           cirppCount_ == 0;
+}
+
+void CrossAssetStateProcess::affineStep(Time t0, Time dt, Array& a, Matrix& b, Matrix& c) const {
+    QL_REQUIRE(hasAffineStep(),
+               "CrossAssetStateProcess::affineStep(): requires a LGM1F based model without CIR++ components");
+    resetCache(0);
+    Size n = model_->dimension();
+    Array x0(n, 0.0);
+    if (auto disc = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess::ExactDiscretization>(discretization_)) {
+        disc->affineExpectation(*this, t0, dt, a, b);
+    } else {
+        // euler: x0 + drift(t0, x0) * dt, the drift is affine in x0
+        a = expectation(t0, x0, dt);
+        b = Matrix(n, n);
+        for (Size j = 0; j < n; ++j) {
+            x0[j] = 1.0;
+            Array m = expectation(t0, x0, dt);
+            x0[j] = 0.0;
+            for (Size i = 0; i < n; ++i)
+                b[i][j] = m[i] - a[i];
+        }
+    }
+    // the diffusion does not depend on x0, for euler it is diffusionOnCorrelatedBrownians() * sqrtCorrelation_
+    c = stdDeviation(t0, x0, dt);
+}
+
 CrossAssetStateProcess::ExactDiscretization::ExactDiscretization(QuantLib::ext::shared_ptr<const CrossAssetModel> model,
                                                                  SalvagingAlgorithm::Type salvaging)
     : model_(std::move(model)), salvaging_(salvaging) {
@@ -979,6 +1008,23 @@ Matrix CrossAssetStateProcess::ExactDiscretization::covarianceImpl(const Stochas
     return res;
 }
 
+void CrossAssetStateProcess::ExactDiscretization::affineExpectation(const StochasticProcess& p, Time t0, Time dt,
+                                                                    Array& a, Matrix& b) const {
+    Size n = model_->dimension();
+    Array x0(n, 0.0);
+    Array a1 = driftImpl1(p, t0, x0, dt);
+    Array a2 = driftImpl2(p, t0, x0, dt);
+    a = a1 + a2;
+    b = Matrix(n, n);
+    for (Size j = 0; j < n; ++j) {
+        x0[j] = 1.0;
+        Array m = driftImpl2(p, t0, x0, dt);
+        x0[j] = 0.0;
+        for (Size i = 0; i < n; ++i)
+            b[i][j] = m[i] - a2[i];
+    }
+}
+
 void CrossAssetStateProcess::ExactDiscretization::resetCache(const Size timeSteps) const {
     cacheNotReady_m_ = cacheNotReady_d_ = cacheNotReady_v_ = true;
     timeStepsToCache_m_ = timeStepsToCache_d_ = timeStepsToCache_v_ = timeSteps;
@@ -54,6 +54,14 @@ public:
     // enables and resets the cache, once enabled the simulated times must stay the stame
     void resetCache(const Size timeSteps) const;
 
+    /*! true if the evolve() step is affine in the state and the variates, which is the case for LGM1F based models
+        without CIR++ credit components */
+    bool hasAffineStep() const;
+
+    /*! coefficients of the affine step evolve(t0, x0, dt, dw) = a + b * x0 + c * dw, requires hasAffineStep(); the
+        drift and diffusion are evaluated several times per step, therefore the cache is disabled by this method */
+    void affineStep(Time t0, Time dt, Array& a, Matrix& b, Matrix& c) const;
+
 protected:
     virtual Matrix diffusionOnCorrelatedBrownians(Time t, const Array& x) const;
     virtual Matrix diffusionOnCorrelatedBrowniansImpl(Time t, const Array& x) const;
@@ -74,6 +82,8 @@ protected:
         virtual Matrix diffusion(const StochasticProcess&, Time t0, const Array& x0, Time dt) const override;
         virtual Matrix covariance(const StochasticProcess&, Time t0, const Array& x0, Time dt) const override;
         void resetCache(const Size timeSteps) const;
+        // conditional expectation a + b * x0, driftImpl1() is evaluated only once
+        void affineExpectation(const StochasticProcess&, Time t0, Time dt, Array& a, Matrix& b) const;
 
     protected:
         virtual Array driftImpl1(const StochasticProcess&, Time t0, const Array& x0, Time dt) const;
@@ -10,10 +10,14 @@
 #include <qle/ad/external_randomvariable_ops.hpp>
 #include <qle/ad/forwardderivatives.hpp>
 #include <qle/ad/forwardevaluation.hpp>
+#include <qle/ad/memoryplan.hpp>
+#include <qle/ad/optimisecomputationgraph.hpp>
+#include <qle/ad/parallelforwardevaluation.hpp>
 #include <qle/ad/ssaform.hpp>
 #include <qle/calendars/amendedcalendar.hpp>
 #include <qle/calendars/austria.hpp>
 #include <qle/calendars/belgium.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/calendars/cme.hpp>
 #include <qle/calendars/colombia.hpp>
 #include <qle/calendars/cyprus.hpp>
@@ -70,6 +74,7 @@
 #include <qle/cashflows/nonstandardcapflooredyoyinflationcoupon.hpp>
 #include <qle/cashflows/nonstandardinflationcouponpricer.hpp>
 #include <qle/cashflows/nonstandardyoyinflationcoupon.hpp>
+#include <qle/cashflows/overnightcompoundingcache.hpp>
 #include <qle/cashflows/overnightindexedcoupon.hpp>
 #include <qle/cashflows/quantocouponpricer.hpp>
 #include <qle/cashflows/scaledcoupon.hpp>
@@ -223,10 +228,12 @@
 #include <qle/math/basiccpuenvironment.hpp>
 #include <qle/math/blockmatrixinverse.hpp>
 #include <qle/math/bucketeddistribution.hpp>
+#include <qle/math/chunkworkers.hpp>
 #include <qle/math/compiledformula.hpp>
 #include <qle/math/computeenvironment.hpp>
 #include <qle/math/constantinterpolation.hpp>
 #include <qle/math/covariancesalvage.hpp>
+#include <qle/math/cudaenvironment.hpp>
 #include <qle/math/deltagammavar.hpp>
 #include <qle/math/differentialevolution_mt.hpp>
 #include <qle/math/discretedistribution.hpp>
@@ -243,12 +250,21 @@
 #include <qle/math/quadraticinterpolation.hpp>
 #include <qle/math/randomvariable.hpp>
 #include <qle/math/randomvariable_io.hpp>
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/randomvariable_kernels_impl.hpp>
+#include <qle/math/randomvariable_kerneltable.hpp>
 #include <qle/math/randomvariable_opcodes.hpp>
 #include <qle/math/randomvariable_ops.hpp>
+#include <qle/math/randomvariable_pool.hpp>
 #include <qle/math/randomvariablelsmbasissystem.hpp>
+#include <qle/math/regressionfactorisationcache.hpp>
+#include <qle/math/shardedcomputeenvironment.hpp>
+#include <qle/math/skipaheadmersennetwister.hpp>
 #include <qle/math/stabilisedglls.hpp>
 #include <qle/math/stoplightbounds.hpp>
+#include <qle/math/tdigest.hpp>
 #include <qle/math/trace.hpp>
+#include <qle/math/vectorisedblackformula.hpp>
 #include <qle/methods/brownianbridgepathinterpolator.hpp>
 #include <qle/methods/fdmblackscholesmesher.hpp>
 #include <qle/methods/fdmblackscholesop.hpp>
@@ -256,7 +272,10 @@
 #include <qle/methods/fdmdefaultableequityjumpdiffusionop.hpp>
 #include <qle/methods/fdmlgmop.hpp>
 #include <qle/methods/fdmquantohelper.hpp>
+#include <qle/methods/mcpathstore.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
+#include <qle/methods/multipathgeneratorbatched.hpp>
+#include <qle/methods/multipathgeneratorblockparallel.hpp>
 #include <qle/methods/multipathvariategenerator.hpp>
 #include <qle/methods/pathgeneratorfactory.hpp>
 #include <qle/methods/projectedbufferedmultipathgenerator.hpp>
@@ -295,6 +314,7 @@
 #include <qle/models/eqbsparametrization.hpp>
 #include <qle/models/eqbspiecewiseconstantparametrization.hpp>
 #include <qle/models/exactbachelierimpliedvolatility.hpp>
+#include <qle/models/exactblackimpliedvolatility.hpp>
 #include <qle/models/extendedconstantlosslatentmodel.hpp>
 #include <qle/models/futureoptionhelper.hpp>
 #include <qle/models/fxbsconstantparametrization.hpp>
@@ -310,9 +330,11 @@
 #include <qle/models/hwconstantparametrization.hpp>
 #include <qle/models/hwmodel.hpp>
 #include <qle/models/hwparametrization.hpp>
+#include <qle/models/hwvectorised.hpp>
 #include <qle/models/infdkparametrization.hpp>
 #include <qle/models/infdkvectorised.hpp>
 #include <qle/models/infjyparameterization.hpp>
+#include <qle/models/infjyvectorised.hpp>
 #include <qle/models/inhomogeneouspooldef.hpp>
 #include <qle/models/irlgm1fconstantparametrization.hpp>
 #include <qle/models/irlgm1fparametrization.hpp>
@@ -400,6 +422,7 @@
 #include <qle/pricingengines/discountingfxforwardenginedeltagamma.hpp>
 #include <qle/pricingengines/discountingriskybondengine.hpp>
 #include <qle/pricingengines/discountingriskybondenginemultistate.hpp>
+#include <qle/pricingengines/discountingswapbatchengine.hpp>
 #include <qle/pricingengines/discountingswapenginedeltagamma.hpp>
 #include <qle/pricingengines/discountingswapenginemulticurve.hpp>
 #include <qle/pricingengines/discretizedconvertible.hpp>
@@ -420,6 +443,7 @@
 #include <qle/pricingengines/midpointcdoengine.hpp>
 #include <qle/pricingengines/midpointcdsenginemultistate.hpp>
 #include <qle/pricingengines/midpointindexcdsengine.hpp>
+#include <qle/pricingengines/midpointindexcdsenginemultistate.hpp>
 #include <qle/pricingengines/numericalintegrationindexcdsoptionengine.hpp>
 #include <qle/pricingengines/numericlgmbgsflexiswapengine.hpp>
 #include <qle/pricingengines/numericlgmflexiswapengine.hpp>
@@ -447,6 +471,7 @@
 #include <qle/termstructures/averageoisratehelper.hpp>
 #include <qle/termstructures/averagespotpricehelper.hpp>
 #include <qle/termstructures/basistwoswaphelper.hpp>
+#include <qle/termstructures/batchdiscount.hpp>
 #include <qle/termstructures/blackdeltautilities.hpp>
 #include <qle/termstructures/blackinvertedvoltermstructure.hpp>
 #include <qle/termstructures/blackmonotonevarvoltermstructure.hpp>
@@ -500,6 +525,7 @@
 #include <qle/termstructures/fxsmilesection.hpp>
 #include <qle/termstructures/fxvannavolgasmilesection.hpp>
 #include <qle/termstructures/generatordefaulttermstructure.hpp>
+#include <qle/termstructures/gridlocalvolsurface.hpp>
 #include <qle/termstructures/hazardspreadeddefaulttermstructure.hpp>
 #include <qle/termstructures/iborfallbackcurve.hpp>
 #include <qle/termstructures/immfraratehelper.hpp>
@@ -517,7 +543,9 @@
 #include <qle/termstructures/interpolatedsurvivalprobabilitycurve.hpp>
 #include <qle/termstructures/interpolatedyoycapfloortermpricesurface.hpp>
 #include <qle/termstructures/iterativebootstrap.hpp>
+#include <qle/termstructures/iterativebootstrapwarmstart.hpp>
 #include <qle/termstructures/kinterpolatedyoyoptionletvolatilitysurface.hpp>
+#include <qle/termstructures/memoiseddiscountcurve.hpp>
 #include <qle/termstructures/multisectiondefaultcurve.hpp>
 #include <qle/termstructures/oiccbasisswaphelper.hpp>
 #include <qle/termstructures/oiscapfloorhelper.hpp>
@@ -583,8 +611,10 @@
 #include <qle/time/yearcounter.hpp>
 #include <qle/utilities/cashflows.hpp>
 #include <qle/utilities/commodity.hpp>
+#include <qle/utilities/freeze.hpp>
 #include <qle/utilities/inflation.hpp>
 #include <qle/utilities/interpolation.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
 #include <qle/utilities/savedobservablesettings.hpp>
 #include <qle/utilities/time.hpp>
 #include <qle/version.hpp>
@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/termstructures/batchdiscount.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace QuantExt {
+
+void discounts(const YieldTermStructure& ts, const Time* times, DiscountFactor* out, Size n) {
+    if (auto b = dynamic_cast<const BatchDiscount*>(&ts)) {
+        b->discounts(times, out, n);
+        return;
+    }
+    for (Size i = 0; i < n; ++i)
+        out[i] = ts.discount(times[i]);
+}
+
+void interpolatedDiscounts(const std::vector<Time>& gridTimes, const std::vector<Real>& y, const bool logLinear,
+                           const bool flatFwd, const Real instFwdMax, const Time* times, DiscountFactor* out,
+                           const Size n) {
+    const Size m = gridTimes.size();
+    const Time tMax = gridTimes.back();
+    const Real logDMax = logLinear ? y.back() : -y.back() * tMax;
+
+    // first pass: the log discount factors, the grid segment is only searched for decreasing times
+
+    std::vector<Real> logDiscounts(n);
+    Size j = 0;
+    for (Size i = 0; i < n; ++i) {
+        const Time t = times[i];
+        if (t > tMax) {
+            logDiscounts[i] = flatFwd ? logDMax - instFwdMax * (t - tMax) : logDMax * t / tMax;
+            continue;
+        }
+        if (t < gridTimes[j]) {
+            j = std::upper_bound(gridTimes.begin(), gridTimes.end(), t) - gridTimes.begin();
+            j = std::min<Size>(std::max<Size>(j, 1) - 1, m - 2);
+        }
+        while (j + 2 < m && t >= gridTimes[j + 1])
+            ++j;
+        // same arithmetic as QuantLib's linear interpolation
+        Real s = (y[j + 1] - y[j]) / (gridTimes[j + 1] - gridTimes[j]);
+        Real v = y[j] + (t - gridTimes[j]) * s;
+        logDiscounts[i] = logLinear ? v : -v * t;
+    }
+
+    // second pass: exponentials, this loop is vectorised by the compiler where a vector exp is available
+
+    for (Size i = 0; i < n; ++i)
+        out[i] *= std::exp(logDiscounts[i]);
+}
+
+} // namespace QuantExt
@@ -0,0 +1,58 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/termstructures/batchdiscount.hpp
+    \brief evaluation of discount factors for many times at once
+    \ingroup termstructures
+*/
+
+#pragma once
+
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Interface for yield term structures that evaluate discount factors for many times at once
+/*! Implementations must return the same values as YieldTermStructure::discount(times[i]) up to rounding and apply
+    the same range checks. Increasing times are evaluated in one pass over the interpolation grid, but the times need
+    not be sorted.
+
+    \ingroup termstructures
+*/
+class BatchDiscount {
+public:
+    virtual ~BatchDiscount() {}
+    virtual void discounts(const Time* times, DiscountFactor* out, Size n) const = 0;
+};
+
+/*! Discount factors of ts for n times, uses the BatchDiscount interface if ts implements it and calls
+    ts.discount(times[i]) for each time otherwise. */
+void discounts(const YieldTermStructure& ts, const Time* times, DiscountFactor* out, Size n);
+
+/*! Discount factors from a curve interpolated on gridTimes (the first time being zero), where y are the log discount
+    factors (logLinear = true) or the zero rates (logLinear = false) on the grid times. Beyond the last grid time the
+    curve is extrapolated with the instantaneous forward rate instFwdMax (flatFwd = true) or flat zero rates. The
+    result is multiplied into out, i.e. out must be initialised by the caller. No range checks are performed. */
+void interpolatedDiscounts(const std::vector<Time>& gridTimes, const std::vector<Real>& y, const bool logLinear,
+                           const bool flatFwd, const Real instFwdMax, const Time* times, DiscountFactor* out,
+                           const Size n);
+
+} // namespace QuantExt
@@ -252,9 +252,10 @@ Real CreditVolCurve::atmStrike(const Date& expiry, const Real underlyingLength)
         }
     }
 
-    // add the result to the cache and return it
+    // add the result to the cache and return it, unless the curve is frozen and must not modify its state
 
-    atmStrikeCache_[std::make_pair(expiry, underlyingLength)] = atmStrike;
+    if (!frozen_)
+        atmStrikeCache_[std::make_pair(expiry, underlyingLength)] = atmStrike;
     return atmStrike;
 }
 
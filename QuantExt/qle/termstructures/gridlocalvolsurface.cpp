@@ -0,0 +1,128 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/termstructures/gridlocalvolsurface.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace QuantExt {
+
+GridLocalVolSurface::GridLocalVolSurface(const Handle<LocalVolTermStructure>& source, const std::vector<Time>& times,
+                                         const Real minLogStrike, const Real maxLogStrike, const Size strikes)
+    : LocalVolTermStructure(source->referenceDate(), source->calendar(), source->businessDayConvention(),
+                            source->dayCounter()),
+      source_(source), maxDate_(source->maxDate()), times_(times), minLogStrike_(minLogStrike) {
+
+    if (source->allowsExtrapolation())
+        enableExtrapolation();
+
+    QL_REQUIRE(!times_.empty(), "GridLocalVolSurface: no times given");
+    for (Size i = 1; i < times_.size(); ++i) {
+        QL_REQUIRE(times_[i] > times_[i - 1], "GridLocalVolSurface: times must be strictly increasing, got "
+                                                  << times_[i - 1] << ", " << times_[i] << " at index " << i);
+    }
+    QL_REQUIRE(strikes >= 2, "GridLocalVolSurface: at least two strikes required, got " << strikes);
+    QL_REQUIRE(maxLogStrike > minLogStrike, "GridLocalVolSurface: maxLogStrike ("
+                                                << maxLogStrike << ") must be greater than minLogStrike ("
+                                                << minLogStrike << ")");
+
+    dx_ = (maxLogStrike - minLogStrike) / static_cast<Real>(strikes - 1);
+    logStrikes_.resize(strikes);
+    for (Size j = 0; j < strikes; ++j)
+        logStrikes_[j] = minLogStrike_ + static_cast<Real>(j) * dx_;
+
+    values_ = Matrix(times_.size(), strikes);
+    for (Size i = 0; i < times_.size(); ++i) {
+        for (Size j = 0; j < strikes; ++j)
+            values_[i][j] = sourceLocalVol(**source_, times_[i], logStrikes_[j]);
+    }
+}
+
+Real GridLocalVolSurface::sourceLocalVol(const LocalVolTermStructure& source, const Time t, const Real logStrike) {
+    Real v = 0.0;
+    try {
+        v = source.localVol(t, std::exp(logStrike));
+    } catch (...) {
+    }
+    return std::isfinite(v) ? v : 0.0;
+}
+
+Volatility GridLocalVolSurface::localVolImpl(Time t, Real strike) const {
+
+    // time interpolation weight, flat outside the grid
+
+    Size i = 0;
+    Real wt = 0.0;
+    if (t > times_.front()) {
+        if (t >= times_.back()) {
+            i = times_.size() - 1;
+        } else {
+            i = std::upper_bound(times_.begin(), times_.end(), t) - times_.begin() - 1;
+            wt = (t - times_[i]) / (times_[i + 1] - times_[i]);
+        }
+    }
+
+    // log-strike interpolation weight on the uniform grid, flat outside the grid
+
+    Real u = (std::log(strike) - minLogStrike_) / dx_;
+    Size n = logStrikes_.size();
+    Size j = 0;
+    Real wx = 0.0;
+    if (u > 0.0) {
+        if (u >= static_cast<Real>(n - 1)) {
+            j = n - 2;
+            wx = 1.0;
+        } else {
+            j = static_cast<Size>(u);
+            wx = u - static_cast<Real>(j);
+        }
+    }
+
+    Real v0 = values_[i][j] + wx * (values_[i][j + 1] - values_[i][j]);
+    if (wt == 0.0)
+        return v0;
+    Real v1 = values_[i + 1][j] + wx * (values_[i + 1][j + 1] - values_[i + 1][j]);
+    return v0 + wt * (v1 - v0);
+}
+
+Real GridLocalVolSurface::maxMidpointError() const {
+    Real maxError = 0.0;
+    std::vector<Time> midTimes;
+    if (times_.size() == 1)
+        midTimes.push_back(times_.front());
+    for (Size i = 0; i + 1 < times_.size(); ++i)
+        midTimes.push_back(0.5 * (times_[i] + times_[i + 1]));
+    for (auto const t : midTimes) {
+        for (Size j = 0; j + 1 < logStrikes_.size(); ++j) {
+            Real x = 0.5 * (logStrikes_[j] + logStrikes_[j + 1]);
+            Real v = 0.0;
+            try {
+                v = source_->localVol(t, std::exp(x));
+            } catch (...) {
+                continue;
+            }
+            if (!std::isfinite(v))
+                continue;
+            maxError = std::max(maxError, std::abs(localVolImpl(t, std::exp(x)) - v));
+        }
+    }
+    return maxError;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/termstructures/gridlocalvolsurface.hpp
+    \brief local vol surface precomputed on a (time, log-strike) grid
+    \ingroup termstructures
+*/
+
+#pragma once
+
+#include <ql/math/matrix.hpp>
+#include <ql/termstructures/volatility/equityfx/localvoltermstructure.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Local vol surface precomputed on a (time, log-strike) grid
+/*! The local vol of the source surface is evaluated once on construction on the given times and on a uniform grid
+    of log-strikes between minLogStrike and maxLogStrike. localVol(t, S) then interpolates bilinearly in t and log S
+    and is flat outside the grid. This avoids the repeated evaluation of e.g. a Dupire local vol surface, which
+    differentiates the implied vol surface numerically on each call.
+
+    Source evaluations that throw or are not finite are set to zero on the grid. Extrapolation is enabled if it is
+    enabled on the source surface.
+
+    The surface is a snapshot of the source surface, it is not updated when the source surface changes.
+
+    \ingroup termstructures
+*/
+class GridLocalVolSurface : public LocalVolTermStructure {
+public:
+    GridLocalVolSurface(const Handle<LocalVolTermStructure>& source, const std::vector<Time>& times,
+                        const Real minLogStrike, const Real maxLogStrike, const Size strikes);
+
+    //! \name TermStructure interface
+    //@{
+    Date maxDate() const override { return maxDate_; }
+    //@}
+    //! \name VolatilityTermStructure interface
+    //@{
+    Real minStrike() const override { return 0.0; }
+    Real maxStrike() const override { return QL_MAX_REAL; }
+    //@}
+
+    //! \name Inspectors
+    //@{
+    const std::vector<Time>& times() const { return times_; }
+    const std::vector<Real>& logStrikes() const { return logStrikes_; }
+    //! local vols on the grid, rows correspond to times, columns to log-strikes
+    const Matrix& values() const { return values_; }
+    //@}
+
+    /*! Maximum absolute difference between the interpolated and the directly evaluated source local vol on the
+        midpoints of the grid cells, where the latter is available. */
+    Real maxMidpointError() const;
+
+protected:
+    Volatility localVolImpl(Time t, Real strike) const override;
+
+private:
+    static Real sourceLocalVol(const LocalVolTermStructure& source, const Time t, const Real logStrike);
+
+    Handle<LocalVolTermStructure> source_;
+    Date maxDate_;
+    std::vector<Time> times_;
+    std::vector<Real> logStrikes_;
+    Real minLogStrike_, dx_;
+    Matrix values_;
+};
+
+} // namespace QuantExt
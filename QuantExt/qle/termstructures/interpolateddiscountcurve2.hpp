@@ -24,6 +24,8 @@
 #ifndef quantext_interpolated_discount_curve_2_hpp
 #define quantext_interpolated_discount_curve_2_hpp
 
+#include <qle/termstructures/batchdiscount.hpp>
+
 #include <ql/math/interpolations/loginterpolation.hpp>
 #include <ql/patterns/lazyobject.hpp>
 #include <ql/termstructures/yieldtermstructure.hpp>
@@ -39,9 +41,11 @@ using namespace QuantLib;
     reference date is always the global evaluation date,
     i.e. settlement days are zero and calendar is NullCalendar()
 
+    Discount factors for many times can be retrieved at once via the BatchDiscount interface.
+
         \ingroup termstructures
 */
-class InterpolatedDiscountCurve2 : public YieldTermStructure, public LazyObject {
+class InterpolatedDiscountCurve2 : public YieldTermStructure, public LazyObject, public BatchDiscount {
 public:
     enum class Interpolation { logLinear, linearZero };
     enum class Extrapolation { flatFwd, flatZero };
@@ -106,6 +110,17 @@ public:
     Calendar calendar() const override { return NullCalendar(); }
     Natural settlementDays() const override { return 0; }
 
+    //! BatchDiscount interface
+    void discounts(const Time* times, DiscountFactor* out, Size n) const override {
+        calculate();
+        for (Size i = 0; i < n; ++i) {
+            checkRange(times[i], false);
+            out[i] = 1.0;
+        }
+        interpolatedDiscounts(times_, batchData_, interpolation_ == Interpolation::logLinear,
+                              extrapolation_ == Extrapolation::flatFwd, instFwdMax_, times, out, n);
+    }
+
 protected:
     void performCalculations() const override {
         today_ = Settings::instance().evaluationDate();
@@ -119,6 +134,13 @@ protected:
             }
         }
         dataInterpolation_->update();
+        batchData_.resize(times_.size());
+        for (Size i = 0; i < times_.size(); ++i)
+            batchData_[i] = interpolation_ == Interpolation::logLinear ? std::log(data_[i]) : data_[i];
+        Time tMax = times_.back();
+        DiscountFactor dMax =
+            interpolation_ == Interpolation::logLinear ? data_.back() : std::exp(-data_.back() * tMax);
+        instFwdMax_ = -dataInterpolation_->derivative(tMax) / dMax;
     }
 
     DiscountFactor discountImpl(Time t) const override {
@@ -149,6 +171,9 @@ private:
     mutable std::vector<Real> data_;
     mutable Date today_;
     QuantLib::ext::shared_ptr<QuantLib::Interpolation> dataInterpolation_;
+    // log discounts resp. zero rates and extrapolation forward used by discounts()
+    mutable std::vector<Real> batchData_;
+    mutable Rate instFwdMax_ = 0.0;
 };
 
 } // namespace QuantExt
@@ -30,6 +30,8 @@
 #include <ql/termstructures/bootstraphelper.hpp>
 #include <ql/utilities/dataformatters.hpp>
 
+#include <qle/termstructures/iterativebootstrapwarmstart.hpp>
+
 namespace QuantExt {
 
 namespace detail {
@@ -73,6 +75,10 @@ QuantLib::Real dontThrowFallback(const QuantLib::BootstrapError<Curve>& error, Q
       \c accuracy specified in the \c Curve which is useful in some situations e.g. cubic spline and optionlet
       stripping. If the \c globalAccuracy is set less than the \c accuracy in the \c Curve, the \c accuracy in the
       \c Curve is used instead.
+    - addition of an optional \c warmStart parameter. If given, a new curve is bootstrapped starting from the solution
+      of the last successful bootstrap stored in it, provided the pillar dates coincide. If the bootstrap fails from
+      there, it is restarted from the generic initial guess. The number of iterations and helper error evaluations
+      are recorded in the \c warmStart statistics.
 */
 template <class Curve> class IterativeBootstrap {
     typedef typename Curve::traits_type Traits;
@@ -91,11 +97,13 @@ public:
         \param minFactor      Factor for min value retry on each iteration if there is a failure.
         \param dontThrowSteps If \p dontThrow is \c true, this gives the number of steps to use when searching
                               for a fallback curve pillar value that gives the minimum bootstrap helper error.
+        \param warmStart      Optional warm start data shared between bootstraps of the same curve.
     */
     IterativeBootstrap(QuantLib::Real accuracy = QuantLib::Null<QuantLib::Real>(),
                        QuantLib::Real globalAccuracy = QuantLib::Null<QuantLib::Real>(), bool dontThrow = false,
                        QuantLib::Size maxAttempts = 1, QuantLib::Real maxFactor = 2.0, QuantLib::Real minFactor = 2.0,
-                       QuantLib::Size dontThrowSteps = 10);
+                       QuantLib::Size dontThrowSteps = 10,
+                       const QuantLib::ext::shared_ptr<IterativeBootstrapWarmStart>& warmStart = nullptr);
 
     void setup(Curve* ts);
     void calculate() const;
@@ -117,15 +125,20 @@ private:
     QuantLib::Real maxFactor_;
     QuantLib::Real minFactor_;
     QuantLib::Size dontThrowSteps_;
+    QuantLib::ext::shared_ptr<IterativeBootstrapWarmStart> warmStart_;
+    mutable bool warmStarted_, warmStartRejected_;
+    mutable QuantLib::Size evaluations_;
 };
 
 template <class Curve>
 IterativeBootstrap<Curve>::IterativeBootstrap(QuantLib::Real accuracy, QuantLib::Real globalAccuracy, bool dontThrow,
                                               QuantLib::Size maxAttempts, QuantLib::Real maxFactor,
-                                              QuantLib::Real minFactor, QuantLib::Size dontThrowSteps)
+                                              QuantLib::Real minFactor, QuantLib::Size dontThrowSteps,
+                                              const QuantLib::ext::shared_ptr<IterativeBootstrapWarmStart>& warmStart)
     : ts_(0), n_(0), initialized_(false), validCurve_(false), loopRequired_(Interpolator::global),
       firstAliveHelper_(0), alive_(0), accuracy_(accuracy), globalAccuracy_(globalAccuracy), dontThrow_(dontThrow),
-      maxAttempts_(maxAttempts), maxFactor_(maxFactor), minFactor_(minFactor), dontThrowSteps_(dontThrowSteps) {}
+      maxAttempts_(maxAttempts), maxFactor_(maxFactor), minFactor_(minFactor), dontThrowSteps_(dontThrowSteps),
+      warmStart_(warmStart), warmStarted_(false), warmStartRejected_(false), evaluations_(0) {}
 
 template <class Curve> void IterativeBootstrap<Curve>::setup(Curve* ts) {
     ts_ = ts;
@@ -200,6 +213,17 @@ template <class Curve> void IterativeBootstrap<Curve>::initialize() const {
         // because, e.g., of interpolation's early checks
         ts_->data_ = std::vector<QuantLib::Real>(alive_ + 1, Traits::initialValue(ts_));
         previousData_.resize(alive_ + 1);
+        // use the stored solution of a previous bootstrap as guess if available, unless it was rejected already
+        warmStarted_ = false;
+        if (warmStart_ && !warmStartRejected_ && warmStart_->guess(dates, ts_->data_)) {
+            try {
+                ts_->interpolation_ = ts_->interpolator_.interpolate(times.begin(), times.end(), ts_->data_.begin());
+                ts_->interpolation_.update();
+                validCurve_ = warmStarted_ = true;
+            } catch (...) {
+                ts_->data_ = std::vector<QuantLib::Real>(alive_ + 1, Traits::initialValue(ts_));
+            }
+        }
     }
     initialized_ = true;
 }
@@ -239,7 +263,9 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
     // there might be a valid curve state to use as guess
     bool validData = validCurve_;
 
+    QuantLib::Size iterations = 0;
     for (QuantLib::Size iteration = 0;; ++iteration) {
+        iterations = iteration + 1;
         previousData_ = ts_->data_;
 
         std::vector<QuantLib::Real> minValues(alive_, QuantLib::Null<QuantLib::Real>());
@@ -287,13 +313,20 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
                 ts_->interpolation_.update();
             }
 
+            auto error = [this, i](const QuantLib::Real x) {
+                ++evaluations_;
+                return (*errors_[i])(x);
+            };
+
             try {
                 if (validData)
-                    solver_.solve(*errors_[i], accuracy, guess, minValues[i - 1], maxValues[i - 1]);
+                    solver_.solve(error, accuracy, guess, minValues[i - 1], maxValues[i - 1]);
                 else
-                    firstSolver_.solve(*errors_[i], accuracy, guess, minValues[i - 1], maxValues[i - 1]);
+                    firstSolver_.solve(error, accuracy, guess, minValues[i - 1], maxValues[i - 1]);
             } catch (std::exception& e) {
                 if (validCurve_) {
+                    if (warmStarted_)
+                        warmStartRejected_ = true;
                     // the previous curve state might have been a
                     // bad guess, so we retry without using it.
                     // This would be tricky to do here (we're
@@ -361,6 +394,13 @@ template <class Curve> void IterativeBootstrap<Curve>::calculate() const {
     }
 
     validCurve_ = true;
+
+    if (warmStart_) {
+        warmStart_->update(ts_->dates_, ts_->data_);
+        warmStart_->addStatistics(warmStarted_, warmStartRejected_, iterations, evaluations_);
+    }
+    warmStarted_ = warmStartRejected_ = false;
+    evaluations_ = 0;
 }
 
 } // namespace QuantExt
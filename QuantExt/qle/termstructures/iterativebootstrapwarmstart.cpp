@@ -0,0 +1,63 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/termstructures/iterativebootstrapwarmstart.hpp>
+
+namespace QuantExt {
+
+bool IterativeBootstrapWarmStart::guess(const std::vector<QuantLib::Date>& dates,
+                                        std::vector<QuantLib::Real>& data) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dates_.empty() || dates != dates_)
+        return false;
+    data = data_;
+    return true;
+}
+
+void IterativeBootstrapWarmStart::update(const std::vector<QuantLib::Date>& dates,
+                                         const std::vector<QuantLib::Real>& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dates_ = dates;
+    data_ = data;
+}
+
+void IterativeBootstrapWarmStart::addStatistics(const bool hit, const bool rejected, const QuantLib::Size iterations,
+                                                const QuantLib::Size evaluations) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++statistics_.calculations;
+    if (hit)
+        ++statistics_.hits;
+    if (rejected)
+        ++statistics_.rejections;
+    statistics_.iterations += iterations;
+    statistics_.evaluations += evaluations;
+}
+
+IterativeBootstrapWarmStart::Statistics IterativeBootstrapWarmStart::statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+}
+
+void IterativeBootstrapWarmStart::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dates_.clear();
+    data_.clear();
+    statistics_ = Statistics();
+}
+
+} // namespace QuantExt
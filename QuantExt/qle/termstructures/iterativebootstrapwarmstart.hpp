@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/termstructures/iterativebootstrapwarmstart.hpp
+    \brief warm start data and statistics shared between bootstraps of a curve
+*/
+
+#pragma once
+
+#include <ql/time/date.hpp>
+#include <ql/types.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace QuantExt {
+
+/*! Holds the solution of the last successful bootstrap of a curve, so that a later bootstrap of the same curve, e.g.
+    after a market rebuild with slightly changed quotes, can start from it instead of the generic initial guess. The
+    solution is only used if the pillar dates of the new bootstrap coincide with the stored ones. In addition the
+    class collects statistics over all bootstraps it is attached to, which allows to measure the effect of the warm
+    start. The class is thread safe, so that it can be shared between curves built in parallel. */
+class IterativeBootstrapWarmStart {
+public:
+    struct Statistics {
+        //! number of successful bootstraps
+        QuantLib::Size calculations = 0;
+        //! number of bootstraps that were started from the stored solution and succeeded from there
+        QuantLib::Size hits = 0;
+        //! number of bootstraps started from the stored solution that had to be restarted from the generic guess
+        QuantLib::Size rejections = 0;
+        //! total number of passes over the pillars
+        QuantLib::Size iterations = 0;
+        //! total number of evaluations of the bootstrap helper errors in the root searches
+        QuantLib::Size evaluations = 0;
+    };
+
+    /*! If a solution for the given dates is stored, it is written to data and true is returned, otherwise data is
+        not changed and false is returned. */
+    bool guess(const std::vector<QuantLib::Date>& dates, std::vector<QuantLib::Real>& data) const;
+    //! stores the solution of a successful bootstrap
+    void update(const std::vector<QuantLib::Date>& dates, const std::vector<QuantLib::Real>& data);
+    //! adds the figures of one successful bootstrap to the statistics
+    void addStatistics(const bool hit, const bool rejected, const QuantLib::Size iterations,
+                       const QuantLib::Size evaluations);
+    //! statistics over all bootstraps so far
+    Statistics statistics() const;
+    //! removes the stored solution and resets the statistics
+    void reset();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<QuantLib::Date> dates_;
+    std::vector<QuantLib::Real> data_;
+    Statistics statistics_;
+};
+
+} // namespace QuantExt
@@ -0,0 +1,63 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/termstructures/memoiseddiscountcurve.hpp>
+
+using QuantLib::Calendar;
+using QuantLib::Date;
+using QuantLib::DayCounter;
+using QuantLib::DiscountFactor;
+using QuantLib::Handle;
+using QuantLib::Natural;
+using QuantLib::Time;
+using QuantLib::YieldTermStructure;
+
+namespace QuantExt {
+
+MemoisedDiscountCurve::MemoisedDiscountCurve(const Handle<YieldTermStructure>& underlying) : underlying_(underlying) {
+    QL_REQUIRE(!underlying_.empty(), "MemoisedDiscountCurve: underlying curve should not be empty");
+    // all range checks will happen in the underlying curve
+    enableExtrapolation(true);
+    registerWith(underlying_);
+}
+
+DayCounter MemoisedDiscountCurve::dayCounter() const { return underlying_->dayCounter(); }
+
+Calendar MemoisedDiscountCurve::calendar() const { return underlying_->calendar(); }
+
+Natural MemoisedDiscountCurve::settlementDays() const { return underlying_->settlementDays(); }
+
+const Date& MemoisedDiscountCurve::referenceDate() const { return underlying_->referenceDate(); }
+
+Date MemoisedDiscountCurve::maxDate() const { return underlying_->maxDate(); }
+
+void MemoisedDiscountCurve::update() {
+    cache_.clear();
+    YieldTermStructure::update();
+}
+
+DiscountFactor MemoisedDiscountCurve::discountImpl(Time t) const {
+    auto c = cache_.find(t);
+    if (c != cache_.end())
+        return c->second;
+    DiscountFactor d = underlying_->discount(t);
+    cache_.emplace(t, d);
+    return d;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/termstructures/memoiseddiscountcurve.hpp
+    \brief yield term structure memoising the discount factors of an underlying curve
+    \ingroup termstructures
+*/
+
+#pragma once
+
+#include <ql/handle.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <unordered_map>
+
+namespace QuantExt {
+
+/*! Yield term structure returning the discount factors of an underlying curve, the discount factors are memoised
+    by time. This is useful when the same discount factors are requested many times, e.g. by the instruments of
+    bootstrap helpers that are repriced in each iteration of a bootstrap. The memoised values are cleared when the
+    underlying curve changes. The class is not thread safe. */
+class MemoisedDiscountCurve : public QuantLib::YieldTermStructure {
+public:
+    explicit MemoisedDiscountCurve(const QuantLib::Handle<QuantLib::YieldTermStructure>& underlying);
+
+    //! \name TermStructure interface
+    //@{
+    QuantLib::DayCounter dayCounter() const override;
+    QuantLib::Calendar calendar() const override;
+    QuantLib::Natural settlementDays() const override;
+    const QuantLib::Date& referenceDate() const override;
+    QuantLib::Date maxDate() const override;
+    //@}
+
+    //! \name Observer interface
+    //@{
+    void update() override;
+    //@}
+
+    //! number of memoised discount factors
+    QuantLib::Size size() const { return cache_.size(); }
+
+protected:
+    QuantLib::DiscountFactor discountImpl(QuantLib::Time t) const override;
+
+private:
+    QuantLib::Handle<QuantLib::YieldTermStructure> underlying_;
+    mutable std::unordered_map<QuantLib::Time, QuantLib::DiscountFactor> cache_;
+};
+
+} // namespace QuantExt
@@ -21,7 +21,9 @@
 #include <ql/pricingengines/blackformula.hpp>
 #include <ql/pricingengines/capfloor/bacheliercapfloorengine.hpp>
 #include <ql/pricingengines/capfloor/blackcapfloorengine.hpp>
+#include <ql/settings.hpp>
 #include <ql/utilities/dataformatters.hpp>
+#include <qle/models/exactblackimpliedvolatility.hpp>
 #include <qle/termstructures/optionletstripper1.hpp>
 
 #include <boost/make_shared.hpp>
@@ -52,6 +54,8 @@ OptionletStripper1::OptionletStripper1(const shared_ptr<QuantExt::CapFloorTermVo
     optionletStDevs_ = Matrix(nOptionletTenors_, nStrikes_, firstGuess);
 
     capFloors_ = CapFloorMatrix(nOptionletTenors_);
+    strippingInputs_ =
+        std::vector<std::vector<StrippingInput> >(nOptionletTenors_, std::vector<StrippingInput>(nStrikes_));
     capFloorEngines_ = std::vector<std::vector<QuantLib::ext::shared_ptr<PricingEngine> > >(nOptionletTenors_);
 }
 
@@ -97,6 +101,12 @@ void OptionletStripper1::performCalculations() const {
         capFlooMatrixNotInitialized_ = false;
     }
 
+    // the cap floor schedules depend on the evaluation date, if it is unchanged we keep the cap floors, they are
+    // then only repriced if one of their observables (vol quote, curves) has changed
+    Date today = Settings::instance().evaluationDate();
+    bool rebuildCapFloors = today != capFloorsDate_;
+    capFloorsDate_ = today;
+
     for (Size j = 0; j < nStrikes_; ++j) {
         // using out-of-the-money options - but these are not always out of the money, for different tenors we may need
         // to switch
@@ -109,33 +119,44 @@ void OptionletStripper1::performCalculations() const {
 
             capFloorVols_[i][j] = termVolSurface_->volatility(capFloorLengths_[i], strikes[j], true);
             volQuotes_[i][j]->setValue(capFloorVols_[i][j]);
-            capFloors_[i][j] = MakeCapFloor(capFloorType, capFloorLengths_[i], index_, strikes[j], -0 * Days)
-                                   .withPricingEngine(capFloorEngines_[i][j]);
+            if (rebuildCapFloors || capFloors_[i][j] == nullptr || capFloors_[i][j]->type() != capFloorType)
+                capFloors_[i][j] = MakeCapFloor(capFloorType, capFloorLengths_[i], index_, strikes[j], -0 * Days)
+                                       .withPricingEngine(capFloorEngines_[i][j]);
             capFloorPrices_[i][j] = capFloors_[i][j]->NPV();
             optionletPrices_[i][j] = capFloorPrices_[i][j] - previousCapFloorPrice;
             previousCapFloorPrice = capFloorPrices_[i][j];
         }
 
         // now try to strip
-        std::vector<Real> optionletStrip(nOptionletTenors_);
-        Real firstGuess = optionletStDevs_[0][j]; // assumes we have a constant first guess here (as we do)
-        bool ok = stripOptionlets(optionletStrip, capFloorType, j, discountCurve, firstGuess);
+        std::vector<Real> optionletStrip(nOptionletTenors_), prices(nOptionletTenors_);
+        std::vector<StrippingInput> inputs(nOptionletTenors_);
+        for (Size i = 0; i < nOptionletTenors_; ++i)
+            prices[i] = capFloorPrices_[i][j];
+        bool ok = stripOptionlets(optionletStrip, inputs, capFloorType, j, discountCurve, prices);
         if (!ok) {
-            // try the reverse
+            // try the reverse, the cap floors are not kept for this, since it is rarely needed
             capFloorType = capFloorType == CapFloor::Cap ? CapFloor::Floor : CapFloor::Cap;
-            ok = stripOptionlets(optionletStrip, capFloorType, j, discountCurve, firstGuess);
+            for (Size i = 0; i < nOptionletTenors_; ++i) {
+                CapFloor capFloor = MakeCapFloor(capFloorType, capFloorLengths_[i], index_, strikes[j], -0 * Days)
+                                        .withPricingEngine(capFloorEngines_[i][j]);
+                prices[i] = capFloor.NPV();
+            }
+            ok = stripOptionlets(optionletStrip, inputs, capFloorType, j, discountCurve, prices);
             QL_REQUIRE(ok, "Failed to strip Caplet vols");
         }
         // now copy
         for (Size i = 0; i < nOptionletTenors_; ++i) {
             optionletStDevs_[i][j] = optionletStrip[i];
+            strippingInputs_[i][j] = inputs[i];
             optionletVolatilities_[i][j] = optionletStDevs_[i][j] / std::sqrt(optionletTimes_[i]);
         }
     }
 }
 
-bool OptionletStripper1::stripOptionlets(std::vector<Real>& out, CapFloor::Type capFloorType, Size j,
-                                         const Handle<YieldTermStructure>& discountCurve, Real firstGuess) const {
+bool OptionletStripper1::stripOptionlets(std::vector<Real>& out, std::vector<StrippingInput>& inputs,
+                                         CapFloor::Type capFloorType, Size j,
+                                         const Handle<YieldTermStructure>& discountCurve,
+                                         const std::vector<Real>& capFloorPrices) const {
 
     Real strike = termVolSurface_->strikes()[j];
 
@@ -145,19 +166,27 @@ bool OptionletStripper1::stripOptionlets(std::vector<Real>& out, CapFloor::Type
     Real previousCapFloorPrice = 0.0;
     for (Size i = 0; i < nOptionletTenors_; ++i) {
 
-        // we have capFloorVols_[i][j] & volQuotes_[i][j]
-        CapFloor capFloor = MakeCapFloor(capFloorType, capFloorLengths_[i], index_, strike, -0 * Days)
-                                .withPricingEngine(capFloorEngines_[i][j]);
-        Real capFloorPrice = capFloor.NPV();
-        Real optionletPrice = std::max(0.0, capFloorPrice - previousCapFloorPrice);
-        previousCapFloorPrice = capFloorPrice;
+        Real optionletPrice = std::max(0.0, capFloorPrices[i] - previousCapFloorPrice);
+        previousCapFloorPrice = capFloorPrices[i];
 
         DiscountFactor d = discountCurve->discount(optionletPaymentDates_[i]);
         DiscountFactor optionletAnnuity = optionletAccrualPeriods_[i] * d;
+
+        // if the inputs are the same as in the last successful stripping, we keep the result
+        inputs[i].type = optionletType;
+        inputs[i].price = optionletPrice;
+        inputs[i].forward = atmOptionletRate_[i];
+        inputs[i].annuity = optionletAnnuity;
+        inputs[i].time = optionletTimes_[i];
+        if (inputs[i] == strippingInputs_[i][j]) {
+            out[i] = optionletStDevs_[i][j];
+            continue;
+        }
+
         try {
             if (volatilityType_ == ShiftedLognormal) {
-                out[i] = blackFormulaImpliedStdDev(optionletType, strike, atmOptionletRate_[i], optionletPrice,
-                                                   optionletAnnuity, displacement_, firstGuess, accuracy_, maxIter_);
+                out[i] = exactBlackImpliedStdDev(optionletType, strike, atmOptionletRate_[i], optionletPrice,
+                                                 optionletAnnuity, displacement_);
             } else if (volatilityType_ == Normal) {
                 out[i] = std::sqrt(optionletTimes_[i]) *
                          bachelierBlackFormulaImpliedVol(optionletType, strike, atmOptionletRate_[i],
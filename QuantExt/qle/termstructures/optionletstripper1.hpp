@@ -25,6 +25,7 @@
 #define quantext_optionletstripper1_hpp
 
 #include <ql/instruments/capfloor.hpp>
+#include <ql/option.hpp>
 #include <ql/quotes/simplequote.hpp>
 #include <qle/termstructures/optionletstripper.hpp>
 
@@ -39,6 +40,17 @@ typedef std::vector<std::vector<QuantLib::ext::shared_ptr<QuantLib::CapFloor> >
 /*! Helper class to strip optionlet (i.e. caplet/floorlet) volatilities
     (a.k.a. forward-forward volatilities) from the (cap/floor) term
     volatilities of a CapFloorTermVolSurface.
+
+    The optionlet volatilities are implied from the optionlet prices
+    without a root search (see exactBlackImpliedStdDev()), the accuracy
+    and maxIter parameters are not used for this.
+
+    The cap floors used for the stripping are kept between calculations
+    (as long as the evaluation date does not change), so that after an
+    update only the cap floors affected by the change are repriced (e.g.
+    those with a modified term vol, while a change in the curves affects
+    all of them). Likewise an optionlet volatility is only implied again
+    if the inputs to its inversion have changed.
     \ingroup termstructures
 */
 class OptionletStripper1 : public QuantExt::OptionletStripper {
@@ -64,13 +76,25 @@ public:
     void performCalculations() const override;
     //@}
 private:
-    bool stripOptionlets(std::vector<Real>&, CapFloor::Type, Size, const Handle<YieldTermStructure>&, Real) const;
+    // the inputs to the inversion of an optionlet price
+    struct StrippingInput {
+        Option::Type type = Option::Call;
+        Real price = Null<Real>(), forward = Null<Real>(), annuity = Null<Real>(), time = Null<Real>();
+        bool operator==(const StrippingInput& o) const {
+            return type == o.type && price == o.price && forward == o.forward && annuity == o.annuity &&
+                   time == o.time;
+        }
+    };
+    bool stripOptionlets(std::vector<Real>&, std::vector<StrippingInput>&, CapFloor::Type, Size,
+                         const Handle<YieldTermStructure>&, const std::vector<Real>&) const;
 
     mutable Matrix capFloorPrices_, optionletPrices_;
     mutable Matrix capFloorVols_;
     mutable Matrix optionletStDevs_, capletVols_;
 
     mutable CapFloorMatrix capFloors_;
+    mutable Date capFloorsDate_;
+    mutable std::vector<std::vector<StrippingInput> > strippingInputs_;
     mutable std::vector<std::vector<QuantLib::ext::shared_ptr<SimpleQuote> > > volQuotes_;
     mutable std::vector<std::vector<QuantLib::ext::shared_ptr<PricingEngine> > > capFloorEngines_;
     bool floatingSwitchStrike_;
@@ -17,6 +17,7 @@
 */
 
 #include <qle/models/exactbachelierimpliedvolatility.hpp>
+#include <qle/models/exactblackimpliedvolatility.hpp>
 #include <qle/termstructures/parametricvolatility.hpp>
 
 #include <ql/math/comparison.hpp>
@@ -89,8 +90,8 @@ Real ParametricVolatility::convert(const Real inputQuote, const MarketQuoteType
             return exactBachelierImpliedVolatility(outputOptionType, strike, forward, timeToExpiry, forwardPremium);
         } else if (outputMarketQuoteType == MarketQuoteType::ShiftedLognormalVolatility) {
             if (strike > -outputLognormalShift)
-                return blackFormulaImpliedStdDev(outputOptionType, strike, forward, forwardPremium, 1.0,
-                                                 outputLognormalShift);
+                return exactBlackImpliedStdDev(outputOptionType, strike, forward, forwardPremium, 1.0,
+                                               outputLognormalShift);
             else
                 return 0.0;
         } else {
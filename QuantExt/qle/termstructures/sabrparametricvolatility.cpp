@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <qle/math/chunkworkers.hpp>
 #include <qle/models/kienitzlawsonswaynesabrpdedensity.hpp>
 #include <qle/models/normalsabr.hpp>
 #include <qle/termstructures/sabrparametricvolatility.hpp>
@@ -37,11 +38,14 @@ SabrParametricVolatility::SabrParametricVolatility(
     const ModelVariant modelVariant, const std::vector<MarketSmile> marketSmiles, const MarketModelType marketModelType,
     const MarketQuoteType inputMarketQuoteType, const Handle<YieldTermStructure> discountCurve,
     const std::map<std::pair<QuantLib::Real, QuantLib::Real>, std::vector<std::pair<Real, bool>>> modelParameters,
-    const Size maxCalibrationAttempts, const Real exitEarlyErrorThreshold, const Real maxAcceptableError)
+    const Size maxCalibrationAttempts, const Real exitEarlyErrorThreshold, const Real maxAcceptableError,
+    const Real pdeDensityReuseTolerance)
     : ParametricVolatility(marketSmiles, marketModelType, inputMarketQuoteType, discountCurve),
       modelVariant_(modelVariant), modelParameters_(std::move(modelParameters)),
       maxCalibrationAttempts_(maxCalibrationAttempts), exitEarlyErrorThreshold_(exitEarlyErrorThreshold),
-      maxAcceptableError_(maxAcceptableError) {
+      maxAcceptableError_(maxAcceptableError), pdeDensityReuseTolerance_(pdeDensityReuseTolerance) {
+    QL_REQUIRE(pdeDensityReuseTolerance_ >= 0.0, "SabrParametricVolatility: pdeDensityReuseTolerance ("
+                                                     << pdeDensityReuseTolerance_ << ") must be non-negative");
     calculate();
 }
 
@@ -142,9 +146,80 @@ std::vector<Real> SabrParametricVolatility::inverse(const std::vector<Real>& y,
     return x;
 }
 
+QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>
+SabrParametricVolatility::buildPdeDensity(const std::vector<Real>& params, const Real forward,
+                                          const Real timeToExpiry, const Real lognormalShift) const {
+    return QuantLib::ext::make_shared<KienitzLawsonSwayneSabrPdeDensity>(
+        params[0], params[1], params[2], params[3], forward, timeToExpiry, lognormalShift, 50,
+        std::max<Size>(5, std::lround(24.0 * timeToExpiry + 0.5)), 5.0);
+}
+
+QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>
+SabrParametricVolatility::cachedPdeDensity(const std::vector<Real>& params, const Real forward,
+                                           const Real timeToExpiry, const Real lognormalShift) const {
+    auto d = pdeDensities_.find(timeToExpiry);
+    if (d == pdeDensities_.end())
+        return nullptr;
+    auto matches = [this](const Real x, const Real y) {
+        return x == y || std::abs(x - y) <= pdeDensityReuseTolerance_ * std::max(std::abs(x), std::abs(y));
+    };
+    for (auto const& p : d->second) {
+        if (matches(p->alpha(), params[0]) && matches(p->beta(), params[1]) && matches(p->nu(), params[2]) &&
+            matches(p->rho(), params[3]) && matches(p->forward(), forward) &&
+            matches(p->displacement(), lognormalShift))
+            return p;
+    }
+    return nullptr;
+}
+
+void SabrParametricVolatility::addPdeDensity(
+    const QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>& density) const {
+    auto& d = pdeDensities_[density->expiryTime()];
+    if (d.size() >= maxPdeDensitiesPerExpiry)
+        d.erase(d.begin());
+    d.push_back(density);
+}
+
+void SabrParametricVolatility::precomputePdeDensities(const std::vector<std::tuple<Real, Real, Real>>& points,
+                                                      const Size nThreads) const {
+    if (modelVariant_ != ModelVariant::KienitzLawsonSwaynePde || points.empty())
+        return;
+
+    // the parameter interpolation is done sequentially, only the PDE solves are distributed to the threads
+    std::vector<std::vector<Real>> params;
+    std::vector<Real> lognormalShifts;
+    for (auto const& [t, u, f] : points) {
+        params.push_back({alphaInterpolation_(t, u), betaInterpolation_(t, u), nuInterpolation_(t, u),
+                          rhoInterpolation_(t, u)});
+        lognormalShifts.push_back(lognormalShiftInterpolation_(t, u));
+    }
+
+    std::vector<QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>> densities(points.size());
+    ChunkWorkers workers(nThreads);
+    workers.run(points.size(), [this, &points, &params, &lognormalShifts, &densities](const Size i) {
+        try {
+            densities[i] =
+                buildPdeDensity(params[i], std::get<2>(points[i]), std::get<0>(points[i]), lognormalShifts[i]);
+        } catch (...) {
+            // leave the density null, evaluate() handles the failure when the point is requested
+        }
+    });
+
+    std::lock_guard<std::mutex> lock(pdeDensityMutex_);
+    for (Size i = 0; i < points.size(); ++i) {
+        if (densities[i] != nullptr &&
+            cachedPdeDensity(params[i], std::get<2>(points[i]), std::get<0>(points[i]), lognormalShifts[i]) ==
+                nullptr) {
+            addPdeDensity(densities[i]);
+            ++pdeDensityCacheMisses_;
+        }
+    }
+}
+
 std::vector<Real> SabrParametricVolatility::evaluateSabr(const std::vector<Real>& params, const Real forward,
                                                          const Real timeToExpiry, const Real lognormalShift,
-                                                         const std::vector<Real>& strikes) const {
+                                                         const std::vector<Real>& strikes,
+                                                         const bool useDensityCache) const {
     std::vector<Real> result;
     switch (modelVariant_) {
     case ModelVariant::Hagan2002Lognormal: {
@@ -206,10 +281,21 @@ std::vector<Real> SabrParametricVolatility::evaluateSabr(const std::vector<Real>
     }
     case ModelVariant::KienitzLawsonSwaynePde: {
         try {
-            KienitzLawsonSwayneSabrPdeDensity pde(params[0], params[1], params[2], params[3], forward, timeToExpiry,
-                                                  lognormalShift, 50,
-                                                  std::max<Size>(5, std::lround(24.0 * timeToExpiry + 0.5)), 5.0);
-            result = pde.callPrices(strikes);
+            QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity> pde;
+            if (useDensityCache) {
+                std::lock_guard<std::mutex> lock(pdeDensityMutex_);
+                if ((pde = cachedPdeDensity(params, forward, timeToExpiry, lognormalShift)) != nullptr)
+                    ++pdeDensityCacheHits_;
+            }
+            if (pde == nullptr) {
+                pde = buildPdeDensity(params, forward, timeToExpiry, lognormalShift);
+                if (useDensityCache) {
+                    std::lock_guard<std::mutex> lock(pdeDensityMutex_);
+                    addPdeDensity(pde);
+                    ++pdeDensityCacheMisses_;
+                }
+            }
+            result = pde->callPrices(strikes);
             for (Size i = 0; i < strikes.size(); ++i) {
                 if (strikes[i] < forward)
                     result[i] = result[i] - forward + strikes[i];
@@ -436,6 +522,7 @@ void SabrParametricVolatility::calculate() {
     // clear stored data
 
     calibratedSabrParams_.clear();
+    pdeDensities_.clear();
     lognormalShifts_.clear();
     calibrationErrors_.clear();
 
@@ -610,7 +697,7 @@ Real SabrParametricVolatility::evaluate(const Real timeToExpiry, const Real unde
     Real rho = rhoInterpolation_(timeToExpiry, underlyingLength);
     Real lognormalShift = lognormalShiftInterpolation_(timeToExpiry, underlyingLength);
 
-    Real result = evaluateSabr({alpha, beta, nu, rho}, forward, timeToExpiry, lognormalShift, {strike}).front();
+    Real result = evaluateSabr({alpha, beta, nu, rho}, forward, timeToExpiry, lognormalShift, {strike}, true).front();
     return convert(result, preferredOutputQuoteType(), lognormalShift, boost::none, timeToExpiry, strike, forward,
                    outputMarketQuoteType, outputLognormalShift == Null<Real>() ? lognormalShift : outputLognormalShift,
                    outputOptionType);
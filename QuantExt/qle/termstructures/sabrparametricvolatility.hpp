@@ -26,8 +26,13 @@
 
 #include <ql/math/interpolations/interpolation2d.hpp>
 
+#include <mutex>
+#include <tuple>
+
 namespace QuantExt {
 
+class KienitzLawsonSwayneSabrPdeDensity;
+
 class SabrParametricVolatility final : public ParametricVolatility {
 public:
     enum class ModelVariant {
@@ -40,7 +45,11 @@ public:
     };
 
     /*! modelParameters are given by (tte, underlyingLen) as a vector of parameter values and
-        whether the values are fixed */
+        whether the values are fixed
+
+        For the KienitzLawsonSwaynePde variant, the densities built in evaluate() are cached per expiry. A cached
+        density is reused if all of its inputs (SABR parameters, forward, shift) match the requested ones up to the
+        relative pdeDensityReuseTolerance, the default 0 requires an exact match. */
     SabrParametricVolatility(
         const ModelVariant modelVariant, const std::vector<MarketSmile> marketSmiles,
         const MarketModelType marketModelType, const MarketQuoteType inputMarketQuoteType,
@@ -48,7 +57,7 @@ public:
         const std::map<std::pair<QuantLib::Real, QuantLib::Real>, std::vector<std::pair<Real, bool>>> modelParameters =
             {},
         const QuantLib::Size maxCalibrationAttempts = 10, const QuantLib::Real exitEarlyErrorThreshold = 0.005,
-        const QuantLib::Real maxAcceptableError = 0.05);
+        const QuantLib::Real maxAcceptableError = 0.05, const QuantLib::Real pdeDensityReuseTolerance = 0.0);
 
     QuantLib::Real
     evaluate(const QuantLib::Real timeToExpiry, const QuantLib::Real underlyingLength, const QuantLib::Real strike,
@@ -71,6 +80,15 @@ public:
     // indicator whether smile params were interpolated (1) or calibrated (0)
     const QuantLib::Matrix& isInterpolated() const { return isInterpolated_; }
 
+    /*! For the KienitzLawsonSwaynePde variant, build the densities for the given (timeToExpiry, underlyingLength,
+        forward) points using nThreads threads and add them to the density cache, so that the subsequent calls to
+        evaluate() for these points do not solve the PDE. For the other variants this is a no-op. */
+    void precomputePdeDensities(const std::vector<std::tuple<Real, Real, Real>>& points,
+                                const QuantLib::Size nThreads) const;
+    //! number of PDE densities served from / added to the density cache
+    QuantLib::Size pdeDensityCacheHits() const { return pdeDensityCacheHits_; }
+    QuantLib::Size pdeDensityCacheMisses() const { return pdeDensityCacheMisses_; }
+
 private:
     static constexpr double eps1 = .0000001;
     static constexpr double eps2 = .9999;
@@ -86,7 +104,17 @@ private:
     std::vector<Real> direct(const std::vector<Real>& x, const Real forward, const Real lognormalShift) const;
     std::vector<Real> inverse(const std::vector<Real>& y, const Real forward, const Real lognormalShift) const;
     std::vector<Real> evaluateSabr(const std::vector<Real>& params, const Real forward, const Real timeToExpiry,
-                                   const Real lognormalShift, const std::vector<Real>& strikes) const;
+                                   const Real lognormalShift, const std::vector<Real>& strikes,
+                                   const bool useDensityCache = false) const;
+    QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>
+    buildPdeDensity(const std::vector<Real>& params, const Real forward, const Real timeToExpiry,
+                    const Real lognormalShift) const;
+    // returns null if no matching density is cached, caller must hold pdeDensityMutex_
+    QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>
+    cachedPdeDensity(const std::vector<Real>& params, const Real forward, const Real timeToExpiry,
+                     const Real lognormalShift) const;
+    // caller must hold pdeDensityMutex_
+    void addPdeDensity(const QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>& density) const;
     std::tuple<std::vector<Real>, Real, QuantLib::Size>
     calibrateModelParameters(const MarketSmile& marketSmile, const std::vector<std::pair<Real, bool>>& params) const;
 
@@ -95,6 +123,13 @@ private:
     QuantLib::Size maxCalibrationAttempts_;
     QuantLib::Real exitEarlyErrorThreshold_;
     QuantLib::Real maxAcceptableError_;
+    QuantLib::Real pdeDensityReuseTolerance_;
+
+    // cached PDE densities by expiry time, holding at most maxPdeDensitiesPerExpiry entries each
+    static constexpr QuantLib::Size maxPdeDensitiesPerExpiry = 8;
+    mutable std::mutex pdeDensityMutex_;
+    mutable std::map<Real, std::vector<QuantLib::ext::shared_ptr<KienitzLawsonSwayneSabrPdeDensity>>> pdeDensities_;
+    mutable QuantLib::Size pdeDensityCacheHits_ = 0, pdeDensityCacheMisses_ = 0;
 
     mutable std::map<std::pair<Real, Real>, std::vector<Real>> calibratedSabrParams_;
     mutable std::map<std::pair<Real, Real>, Real> lognormalShifts_;
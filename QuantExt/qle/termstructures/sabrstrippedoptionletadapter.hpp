@@ -258,7 +258,9 @@ SabrStrippedOptionletAdapter<TimeInterpolator>::smileSectionImpl(QuantLib::Time
         optionTime, Null<Real>(), forward, parametricVolatility_,
         outVolType == QuantLib::Normal ? ParametricVolatility::MarketQuoteType::NormalVolatility
                                        : ParametricVolatility::MarketQuoteType::ShiftedLognormalVolatility);
-    cache_[optionTime] = tmp;
+    // a frozen adapter does not modify its state, so that it can be read concurrently
+    if (!frozen_)
+        cache_[optionTime] = tmp;
     return tmp;
 }
 
@@ -67,6 +67,21 @@ void SpreadedDiscountCurve::performCalculations() const {
         }
     }
     dataInterpolation_->update();
+    batchData_.resize(times_.size());
+    for (Size i = 0; i < times_.size(); ++i)
+        batchData_[i] = interpolation_ == Interpolation::logLinear ? std::log(data_[i]) : data_[i];
+    Time tMax = times_.back();
+    DiscountFactor dMax = interpolation_ == Interpolation::logLinear ? data_.back() : std::exp(-data_.back() * tMax);
+    instFwdMax_ = -dataInterpolation_->derivative(tMax) / dMax;
+}
+
+void SpreadedDiscountCurve::discounts(const Time* times, DiscountFactor* out, Size n) const {
+    calculate();
+    for (Size i = 0; i < n; ++i)
+        checkRange(times[i], false);
+    QuantExt::discounts(**referenceCurve_, times, out, n);
+    interpolatedDiscounts(times_, batchData_, interpolation_ == Interpolation::logLinear,
+                          extrapolation_ == Extrapolation::flatFwd, instFwdMax_, times, out, n);
 }
 
 DiscountFactor SpreadedDiscountCurve::discountImpl(Time t) const {
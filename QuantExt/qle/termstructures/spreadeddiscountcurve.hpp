@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <qle/termstructures/batchdiscount.hpp>
+
 #include <ql/math/interpolation.hpp>
 #include <ql/patterns/lazyobject.hpp>
 #include <ql/termstructures/yieldtermstructure.hpp>
@@ -35,8 +37,9 @@ using namespace QuantLib;
 /*! Curve taking a reference curve and discount factor quotes, that are used to overlay the reference
   curve with a spread. The quotes are interpolated loglinearly. The spread curve is given in terms of
   times relative to the reference date, which means that the spread will float with a changing reference
-  date in the reference curve. */
-class SpreadedDiscountCurve : public YieldTermStructure, public LazyObject {
+  date in the reference curve. Discount factors for many times can be retrieved at once via the BatchDiscount
+  interface, which uses the batch evaluation of the reference curve if available. */
+class SpreadedDiscountCurve : public YieldTermStructure, public LazyObject, public BatchDiscount {
 public:
     enum class Interpolation { logLinear, linearZero };
     enum class Extrapolation { flatFwd, flatZero };
@@ -53,6 +56,9 @@ public:
     Calendar calendar() const override;
     Natural settlementDays() const override;
 
+    //! BatchDiscount interface
+    void discounts(const Time* times, DiscountFactor* out, Size n) const override;
+
 protected:
     void performCalculations() const override;
     DiscountFactor discountImpl(Time t) const override;
@@ -65,6 +71,9 @@ private:
     Extrapolation extrapolation_;
     mutable std::vector<Real> data_;
     QuantLib::ext::shared_ptr<QuantLib::Interpolation> dataInterpolation_;
+    // log discounts resp. zero rates and extrapolation forward used by discounts()
+    mutable std::vector<Real> batchData_;
+    mutable Rate instFwdMax_ = 0.0;
 };
 
 } // namespace QuantExt
@@ -109,6 +109,13 @@ Real SpreadedSwaptionVolatility::getAtmLevel(const Real optionTime, const Real s
 
 QuantLib::ext::shared_ptr<SmileSection> SpreadedSwaptionVolatility::smileSectionImpl(Time optionTime, Time swapLength) const {
     calculate();
+    if (auto c = cache_.find(std::make_pair(optionTime, swapLength)); c != cache_.end()) {
+        if (!frozen_)
+            ++cacheHits_;
+        return c->second;
+    }
+    if (!frozen_)
+        ++cacheMisses_;
     auto baseSection = base_->smileSection(optionTime, swapLength);
     Real baseAtmLevel = Null<Real>();
     Real simulatedAtmLevel = Null<Real>();
@@ -128,10 +135,12 @@ QuantLib::ext::shared_ptr<SmileSection> SpreadedSwaptionVolatility::smileSection
     for (Size k = 0; k < volSpreads.size(); ++k) {
         volSpreads[k] = volSpreadInterpolation_[k](swapLength, optionTime);
     }
-    // create smile section
-    return QuantLib::ext::make_shared<SpreadedSmileSection2>(base_->smileSection(optionTime, swapLength), volSpreads,
-                                                     strikeSpreads_, true, baseAtmLevel, simulatedAtmLevel,
-                                                     stickyAbsMoney_);
+    // create smile section and add it to the cache, unless the surface is frozen and must not modify its state
+    auto section = QuantLib::ext::make_shared<SpreadedSmileSection2>(baseSection, volSpreads, strikeSpreads_, true,
+                                                                     baseAtmLevel, simulatedAtmLevel, stickyAbsMoney_);
+    if (!frozen_)
+        cache_[std::make_pair(optionTime, swapLength)] = section;
+    return section;
 }
 
 Volatility SpreadedSwaptionVolatility::volatilityImpl(Time optionTime, Time swapLength, Rate strike) const {
@@ -167,6 +176,7 @@ Real SpreadedSwaptionVolatility::shiftImpl(Time optionTime, Time swapLength) con
 
 void SpreadedSwaptionVolatility::performCalculations() const {
     SwaptionVolatilityDiscrete::performCalculations();
+    cache_.clear();
     for (Size k = 0; k < strikeSpreads_.size(); ++k) {
         for (Size i = 0; i < optionTenors_.size(); ++i) {
             for (Size j = 0; j < swapTenors_.size(); ++j) {
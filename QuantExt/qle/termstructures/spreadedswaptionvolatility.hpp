@@ -75,6 +75,11 @@ public:
     //@}
     const Handle<SwaptionVolatilityStructure>& baseVol();
 
+    /*! number of smile section requests served from / not found in the smile section cache since construction, the
+        requests while the surface is frozen are not counted */
+    Size cacheHits() const { return cacheHits_; }
+    Size cacheMisses() const { return cacheMisses_; }
+
 private:
     QuantLib::ext::shared_ptr<SmileSection> smileSectionImpl(Time optionTime, Time swapLength) const override;
     Volatility volatilityImpl(Time optionTime, Time swapLength, Rate strike) const override;
@@ -92,6 +97,9 @@ private:
     bool stickyAbsMoney_;
     mutable std::vector<Matrix> volSpreadValues_;
     mutable std::vector<Interpolation2D> volSpreadInterpolation_;
+    // smile sections by (option time, swap length), cleared on recalculation
+    mutable std::map<std::pair<Real, Real>, QuantLib::ext::shared_ptr<SmileSection>> cache_;
+    mutable Size cacheHits_ = 0, cacheMisses_ = 0;
 };
 
 } // namespace QuantExt
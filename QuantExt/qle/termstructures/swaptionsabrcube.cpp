@@ -32,13 +32,15 @@ SwaptionSabrCube::SwaptionSabrCube(
     const boost::optional<QuantLib::VolatilityType> outputVolatilityType,
     const std::map<std::pair<Period, Period>, std::vector<std::pair<Real, bool>>>& initialModelParameters,
     const QuantLib::Size maxCalibrationAttempts, const QuantLib::Real exitEarlyErrorThreshold,
-    const QuantLib::Real maxAcceptableError)
+    const QuantLib::Real maxAcceptableError, const QuantLib::Real pdeDensityReuseTolerance,
+    const QuantLib::Size pdeDensityThreads)
     : SwaptionVolatilityCube(atmVolStructure, optionTenors, swapTenors, strikeSpreads, volSpreads, swapIndexBase,
                              shortSwapIndexBase, false),
       atmOptionTenors_(atmOptionTenors), atmSwapTenors_(atmSwapTenors), modelVariant_(modelVariant),
       outputVolatilityType_(outputVolatilityType), initialModelParameters_(initialModelParameters),
       maxCalibrationAttempts_(maxCalibrationAttempts), exitEarlyErrorThreshold_(exitEarlyErrorThreshold),
-      maxAcceptableError_(maxAcceptableError) {
+      maxAcceptableError_(maxAcceptableError), pdeDensityReuseTolerance_(pdeDensityReuseTolerance),
+      pdeDensityThreads_(pdeDensityThreads) {
 
     registerWith(atmVolStructure);
 
@@ -124,27 +126,48 @@ void SwaptionSabrCube::performCalculations() const {
         }
     }
 
-    parametricVolatility_ = boost::make_shared<SabrParametricVolatility>(
+    auto sabr = boost::make_shared<SabrParametricVolatility>(
         modelVariant_, marketSmiles, ParametricVolatility::MarketModelType::Black76,
         volatilityType() == QuantLib::Normal ? ParametricVolatility::MarketQuoteType::NormalVolatility
                                              : ParametricVolatility::MarketQuoteType::ShiftedLognormalVolatility,
         Handle<YieldTermStructure>(), modelParameters, maxCalibrationAttempts_, exitEarlyErrorThreshold_,
-        maxAcceptableError_);
+        maxAcceptableError_, pdeDensityReuseTolerance_);
+    parametricVolatility_ = sabr;
+
+    // build the PDE densities for all grid points in one batch
+
+    if (pdeDensityThreads_ > 0 && modelVariant_ == SabrParametricVolatility::ModelVariant::KienitzLawsonSwaynePde) {
+        std::vector<std::tuple<Real, Real, Real>> points;
+        for (auto const& t : allOptionTimes)
+            for (auto const& l : allSwapLengths)
+                points.push_back(std::make_tuple(t, l, smileSectionForward(t, l)));
+        sabr->precomputePdeDensities(points, pdeDensityThreads_);
+    }
+}
+
+Real SwaptionSabrCube::smileSectionForward(Time optionTime, Time swapLength) const {
+    return atmStrike(optionDateFromTime(optionTime),
+                     std::max<int>(1, static_cast<int>(swapLength * 12.0 + 0.5)) * Months);
 }
 
 boost::shared_ptr<SmileSection> SwaptionSabrCube::smileSectionImpl(Time optionTime, Time swapLength) const {
     calculate();
     if (auto c = cache_.find(std::make_pair(optionTime, swapLength)); c != cache_.end()) {
+        if (!frozen_)
+            ++cacheHits_;
         return c->second;
     }
-    Real forward =
-        atmStrike(optionDateFromTime(optionTime), std::max<int>(1, static_cast<int>(swapLength * 12.0 + 0.5)) * Months);
+    if (!frozen_)
+        ++cacheMisses_;
+    Real forward = smileSectionForward(optionTime, swapLength);
     QuantLib::VolatilityType outVolType = outputVolatilityType_ ? *outputVolatilityType_ : volatilityType();
     auto tmp = boost::make_shared<ParametricVolatilitySmileSection>(
         optionTime, swapLength, forward, parametricVolatility_,
         outVolType == QuantLib::Normal ? ParametricVolatility::MarketQuoteType::NormalVolatility
                                        : ParametricVolatility::MarketQuoteType::ShiftedLognormalVolatility);
-    cache_[std::make_pair(optionTime, swapLength)] = tmp;
+    // a frozen cube does not modify its state, so that it can be read concurrently
+    if (!frozen_)
+        cache_[std::make_pair(optionTime, swapLength)] = tmp;
     return tmp;
 }
 
@@ -32,6 +32,9 @@
 namespace QuantExt {
 using namespace QuantLib;
 
+/*! For the KienitzLawsonSwaynePde variant, pdeDensityReuseTolerance is passed to the SabrParametricVolatility, and if
+    pdeDensityThreads is positive, the densities for all smile grid points are built in a batch after the calibration
+    using pdeDensityThreads threads. */
 class SwaptionSabrCube : public SwaptionVolatilityCube {
 public:
     SwaptionSabrCube(
@@ -45,14 +48,24 @@ public:
         const boost::optional<QuantLib::VolatilityType> outputVolatilityType = boost::none,
         const std::map<std::pair<Period, Period>, std::vector<std::pair<Real, bool>>>& initialModelParameters = {},
         const QuantLib::Size maxCalibrationAttempts = 10, const QuantLib::Real exitEarlyErrorThreshold = 0.005,
-        const QuantLib::Real maxAcceptableError = 0.05);
+        const QuantLib::Real maxAcceptableError = 0.05, const QuantLib::Real pdeDensityReuseTolerance = 0.0,
+        const QuantLib::Size pdeDensityThreads = 0);
     void performCalculations() const override;
     QuantLib::ext::shared_ptr<SmileSection> smileSectionImpl(Time optionTime, Time swapLength) const override;
 
     QuantLib::ext::shared_ptr<ParametricVolatility> parametricVolatility() const { return parametricVolatility_; }
 
+    /*! number of smile section requests served from / not found in the smile section cache since construction, the
+        requests while the cube is frozen are not counted */
+    Size cacheHits() const { return cacheHits_; }
+    Size cacheMisses() const { return cacheMisses_; }
+
 private:
+    // the forward used for the smile section at (optionTime, swapLength)
+    Real smileSectionForward(Time optionTime, Time swapLength) const;
+
     mutable std::map<std::pair<Real, Real>, QuantLib::ext::shared_ptr<ParametricVolatilitySmileSection>> cache_;
+    mutable Size cacheHits_ = 0, cacheMisses_ = 0;
     mutable QuantLib::ext::shared_ptr<ParametricVolatility> parametricVolatility_;
     std::vector<Period> atmOptionTenors_, atmSwapTenors_;
     QuantExt::SabrParametricVolatility::ModelVariant modelVariant_;
@@ -61,6 +74,8 @@ private:
     QuantLib::Size maxCalibrationAttempts_;
     QuantLib::Real exitEarlyErrorThreshold_;
     QuantLib::Real maxAcceptableError_;
+    QuantLib::Real pdeDensityReuseTolerance_;
+    QuantLib::Size pdeDensityThreads_;
 };
 
 } // namespace QuantExt
@@ -0,0 +1,50 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/utilities/freeze.hpp>
+
+#include <ql/patterns/lazyobject.hpp>
+#include <ql/termstructures/defaulttermstructure.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+namespace QuantExt {
+
+using namespace QuantLib;
+
+void freeze(const QuantLib::ext::shared_ptr<TermStructure>& ts) {
+    if (ts == nullptr)
+        return;
+    if (auto l = QuantLib::ext::dynamic_pointer_cast<LazyObject>(ts)) {
+        l->recalculate();
+        l->freeze();
+    }
+    // moving term structures determine their reference date on the first read
+    ts->referenceDate();
+    // a first evaluation triggers the calculation of nested (lazy) term structures
+    if (auto y = QuantLib::ext::dynamic_pointer_cast<YieldTermStructure>(ts))
+        y->discount(1.0, true);
+    else if (auto d = QuantLib::ext::dynamic_pointer_cast<DefaultProbabilityTermStructure>(ts))
+        d->survivalProbability(1.0, true);
+}
+
+void unfreeze(const QuantLib::ext::shared_ptr<TermStructure>& ts) {
+    if (auto l = QuantLib::ext::dynamic_pointer_cast<LazyObject>(ts))
+        l->unfreeze();
+}
+
+} // namespace QuantExt
@@ -0,0 +1,43 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/utilities/freeze.hpp
+    \brief freeze term structures for concurrent reads
+*/
+
+#pragma once
+
+#include <ql/termstructure.hpp>
+
+namespace QuantExt {
+
+/*! Computes the lazily calculated state of a term structure and freezes it (see QuantLib::LazyObject::freeze()), so
+    that subsequent reads do not modify it and the term structure can be read from several threads without locks.
+    Term structures that cache results on read (SwaptionSabrCube, SabrStrippedOptionletAdapter, CreditVolCurve) do
+    not add to their caches while frozen. Term structures that are no lazy objects are only evaluated once.
+
+    \warning A frozen term structure keeps its results until it is unfrozen, i.e. it must not be notified of market
+             data or evaluation date changes while it is frozen. Other term structures with caches filled on read,
+             e.g. BlackVolatilitySurfaceBFRR, are not safe for concurrent reads even if frozen.
+*/
+void freeze(const QuantLib::ext::shared_ptr<QuantLib::TermStructure>& ts);
+
+//! Unfreezes a term structure, it recalculates on the next read if it was notified while frozen
+void unfreeze(const QuantLib::ext::shared_ptr<QuantLib::TermStructure>& ts);
+
+} // namespace QuantExt
@@ -0,0 +1,160 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/utilities/memoryaccounting.hpp>
+
+#include <ql/errors.hpp>
+
+#include <ostream>
+
+namespace QuantExt {
+
+namespace {
+void updateMax(std::atomic<std::size_t>& m, const std::size_t value) {
+    std::size_t current = m.load(std::memory_order_relaxed);
+    while (value > current && !m.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        ;
+}
+} // namespace
+
+void MemoryAccounting::allocate(const Category c, const std::size_t bytes) {
+    std::size_t i = static_cast<std::size_t>(c);
+    updateMax(peak_[i], current_[i].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    updateMax(totalPeak_, total_.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void MemoryAccounting::release(const Category c, const std::size_t bytes) {
+    current_[static_cast<std::size_t>(c)].fetch_sub(bytes, std::memory_order_relaxed);
+    total_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+std::size_t MemoryAccounting::current(const Category c) const {
+    return current_[static_cast<std::size_t>(c)].load(std::memory_order_relaxed);
+}
+
+std::size_t MemoryAccounting::peak(const Category c) const {
+    return peak_[static_cast<std::size_t>(c)].load(std::memory_order_relaxed);
+}
+
+void MemoryAccounting::saveAndResetPeaks(StageStats& s) {
+    for (std::size_t i = 0; i < numberOfCategories; ++i) {
+        s.current[i] = current_[i].load(std::memory_order_relaxed);
+        s.peak[i] = peak_[i].exchange(s.current[i], std::memory_order_relaxed);
+    }
+    s.totalPeak = totalPeak_.exchange(total_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void MemoryAccounting::beginStage(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StageStats s;
+    s.name = name;
+    saveAndResetPeaks(s);
+    open_.push_back(s);
+}
+
+void MemoryAccounting::endStage() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // called from the destructor of MemoryStage, so we do not throw
+    if (open_.empty())
+        return;
+    StageStats enclosing = open_.back();
+    open_.pop_back();
+    StageStats s;
+    s.name = enclosing.name;
+    for (std::size_t i = 0; i < numberOfCategories; ++i) {
+        s.current[i] = current_[i].load(std::memory_order_relaxed);
+        s.peak[i] = peak_[i].load(std::memory_order_relaxed);
+        // the peak of the enclosing stage includes the peak of this stage
+        updateMax(peak_[i], enclosing.peak[i]);
+    }
+    s.totalPeak = totalPeak_.load(std::memory_order_relaxed);
+    updateMax(totalPeak_, enclosing.totalPeak);
+    stages_.push_back(s);
+}
+
+std::vector<MemoryAccounting::StageStats> MemoryAccounting::stages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stages_;
+}
+
+void MemoryAccounting::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_.clear();
+    for (std::size_t i = 0; i < numberOfCategories; ++i)
+        peak_[i].store(current_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    totalPeak_.store(total_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+std::ostream& operator<<(std::ostream& out, const MemoryAccounting::Category c) {
+    switch (c) {
+    case MemoryAccounting::Category::Cube:
+        return out << "Cube";
+    case MemoryAccounting::Category::ScenarioData:
+        return out << "ScenarioData";
+    case MemoryAccounting::Category::RandomVariable:
+        return out << "RandomVariable";
+    case MemoryAccounting::Category::Report:
+        return out << "Report";
+    default:
+        QL_FAIL("MemoryAccounting::Category (" << static_cast<int>(c) << ") not covered.");
+    }
+}
+
+AccountedMemory::AccountedMemory(const MemoryAccounting::Category c, const std::size_t bytes)
+    : category_(c), bytes_(bytes) {
+    if (bytes_ > 0)
+        MemoryAccounting::instance().allocate(category_, bytes_);
+}
+
+AccountedMemory::~AccountedMemory() {
+    if (bytes_ > 0)
+        MemoryAccounting::instance().release(category_, bytes_);
+}
+
+AccountedMemory::AccountedMemory(const AccountedMemory& m) : AccountedMemory(m.category_, m.bytes_) {}
+
+AccountedMemory::AccountedMemory(AccountedMemory&& m) : category_(m.category_), bytes_(m.bytes_) { m.bytes_ = 0; }
+
+AccountedMemory& AccountedMemory::operator=(const AccountedMemory& m) {
+    if (this != &m) {
+        resize(0);
+        category_ = m.category_;
+        resize(m.bytes_);
+    }
+    return *this;
+}
+
+AccountedMemory& AccountedMemory::operator=(AccountedMemory&& m) {
+    if (this != &m) {
+        resize(0);
+        category_ = m.category_;
+        bytes_ = m.bytes_;
+        m.bytes_ = 0;
+    }
+    return *this;
+}
+
+void AccountedMemory::resize(const std::size_t bytes) {
+    if (bytes > bytes_)
+        MemoryAccounting::instance().allocate(category_, bytes - bytes_);
+    else if (bytes < bytes_)
+        MemoryAccounting::instance().release(category_, bytes_ - bytes);
+    bytes_ = bytes;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,122 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/utilities/memoryaccounting.hpp
+    \brief attribution of memory usage to subsystems
+*/
+
+#pragma once
+
+#include <ql/patterns/singleton.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace QuantExt {
+
+//! Accounts the memory allocated by the large data structures of a run per subsystem
+/*! The registered data structures report the memory they hold (see AccountedMemory), the class keeps track of the
+    current usage and its high water mark per category.
+
+    The high water marks can be collected per stage of a run, e.g. per analytic, see MemoryStage. Stages nest, the
+    peak of a stage is included in the peak of its enclosing stage. Stages should be opened and closed by the thread
+    driving the run, allocations on other threads during the lifetime of a stage are attributed to that stage. */
+class MemoryAccounting : public QuantLib::Singleton<MemoryAccounting, std::integral_constant<bool, true>> {
+    friend class QuantLib::Singleton<MemoryAccounting, std::integral_constant<bool, true>>;
+
+public:
+    enum class Category { Cube, ScenarioData, RandomVariable, Report };
+    static constexpr std::size_t numberOfCategories = 4;
+
+    struct StageStats {
+        std::string name;
+        // usage at the end and high water mark during the stage per category
+        std::array<std::size_t, numberOfCategories> current, peak;
+        // high water mark of the sum over all categories
+        std::size_t totalPeak;
+    };
+
+    void allocate(const Category c, const std::size_t bytes);
+    void release(const Category c, const std::size_t bytes);
+
+    std::size_t current(const Category c) const;
+    std::size_t peak(const Category c) const;
+    std::size_t total() const { return total_.load(std::memory_order_relaxed); }
+    std::size_t totalPeak() const { return totalPeak_.load(std::memory_order_relaxed); }
+
+    //! start a new stage, nested in the current stage if there is one
+    void beginStage(const std::string& name);
+    //! end the innermost stage, its stats are appended to stages(), does nothing if there is no open stage
+    void endStage();
+
+    //! the completed stages in the order in which they were completed
+    std::vector<StageStats> stages() const;
+    //! clear the completed stages and set the high water marks to the current usage
+    void reset();
+
+private:
+    MemoryAccounting() = default;
+    void saveAndResetPeaks(StageStats& s);
+
+    std::array<std::atomic<std::size_t>, numberOfCategories> current_{}, peak_{};
+    std::atomic<std::size_t> total_{0}, totalPeak_{0};
+
+    mutable std::mutex mutex_;
+    // for each open stage the peaks of the enclosing stage at the start of the stage
+    std::vector<StageStats> open_;
+    std::vector<StageStats> stages_;
+};
+
+std::ostream& operator<<(std::ostream& out, const MemoryAccounting::Category c);
+
+//! Memory of size bytes() accounted to a category for the lifetime of this object
+/*! A data structure holds an instance of this class as a member and updates it if its memory usage changes.
+    Copies account their memory separately. */
+class AccountedMemory {
+public:
+    explicit AccountedMemory(const MemoryAccounting::Category c, const std::size_t bytes = 0);
+    ~AccountedMemory();
+    AccountedMemory(const AccountedMemory& m);
+    AccountedMemory(AccountedMemory&& m);
+    AccountedMemory& operator=(const AccountedMemory& m);
+    AccountedMemory& operator=(AccountedMemory&& m);
+
+    void resize(const std::size_t bytes);
+    std::size_t bytes() const { return bytes_; }
+
+private:
+    MemoryAccounting::Category category_;
+    std::size_t bytes_;
+};
+
+//! Stage of the memory accounting for the lifetime of this object
+class MemoryStage {
+public:
+    explicit MemoryStage(const std::string& name) { MemoryAccounting::instance().beginStage(name); }
+    ~MemoryStage() { MemoryAccounting::instance().endStage(); }
+    MemoryStage(const MemoryStage&) = delete;
+    MemoryStage& operator=(const MemoryStage&) = delete;
+};
+
+} // namespace QuantExt
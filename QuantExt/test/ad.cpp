@@ -21,6 +21,9 @@
 #include <qle/ad/backwardderivatives.hpp>
 #include <qle/ad/forwardderivatives.hpp>
 #include <qle/ad/forwardevaluation.hpp>
+#include <qle/ad/memoryplan.hpp>
+#include <qle/ad/optimisecomputationgraph.hpp>
+#include <qle/ad/parallelforwardevaluation.hpp>
 #include <qle/ad/ssaform.hpp>
 #include <qle/math/randomvariable_ops.hpp>
 
@@ -28,6 +31,7 @@
 #include <ql/math/randomnumbers/inversecumulativerng.hpp>
 #include <ql/math/randomnumbers/mt19937uniformrng.hpp>
 
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 
 using namespace QuantExt;
@@ -190,6 +194,282 @@ BOOST_AUTO_TEST_CASE(testIndicatorDerivative) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testOptimiseComputationGraph) {
+    BOOST_TEST_MESSAGE("Testing computation graph optimisation...");
+
+    constexpr Real tol = 1E-14;
+
+    ComputationGraph g;
+    auto x = cg_var(g, "x", ComputationGraph::VarDoesntExist::Create);
+    auto y = cg_var(g, "y", ComputationGraph::VarDoesntExist::Create);
+    auto u1 = cg_exp(g, x);
+    auto u2 = cg_exp(g, x);                     // cse: u2 = u1
+    auto s = cg_add(g, u1, y);
+    auto t = cg_add(g, y, u2);                  // cse: t = s
+    auto n = cg_negative(g, cg_negative(g, s)); // simplification: n = s
+    auto c = g.insert({cg_const(g, 2.0), cg_const(g, 3.0)}, RandomVariableOpCode::Mult); // folding: c = 6
+    auto d = cg_log(g, y);                      // dead node
+    auto z = cg_mult(g, cg_add(g, n, t), c);    // z = 12 (exp(x) + y)
+    g.startRedBlock();
+    auto r = cg_exp(g, x); // no cse with u1, since it is in a red block
+    g.endRedBlock();
+    auto w = cg_add(g, z, r);
+
+    ComputationGraph og;
+    std::vector<std::size_t> nodeMap;
+    auto stats = optimiseComputationGraph(g, og, nodeMap, {w});
+    BOOST_TEST_MESSAGE("SSA Form original:\n" + ssaForm(g, getRandomVariableOpLabels()));
+    BOOST_TEST_MESSAGE("SSA Form optimised:\n" + ssaForm(og, getRandomVariableOpLabels()));
+    BOOST_TEST_MESSAGE("Stats: " << stats);
+
+    BOOST_CHECK_EQUAL(stats.nodesBefore, g.size());
+    BOOST_CHECK_EQUAL(stats.nodesAfter, og.size());
+    BOOST_CHECK_LT(og.size(), g.size());
+    BOOST_CHECK_EQUAL(stats.commonSubexpressions, 2);
+    BOOST_CHECK_EQUAL(stats.simplifications, 1);
+    BOOST_CHECK_EQUAL(stats.foldedConstants, 1);
+    BOOST_CHECK_GE(stats.deadNodes, 1);
+
+    BOOST_CHECK_EQUAL(nodeMap[u1], nodeMap[u2]);
+    BOOST_CHECK_EQUAL(nodeMap[s], nodeMap[t]);
+    BOOST_CHECK_EQUAL(nodeMap[n], nodeMap[s]);
+    BOOST_CHECK(og.isConstant(nodeMap[c]));
+    BOOST_CHECK_EQUAL(nodeMap[d], ComputationGraph::nan);
+    BOOST_CHECK_NE(nodeMap[r], nodeMap[u1]);
+    BOOST_CHECK_EQUAL(og.redBlockRanges().size(), 1);
+    BOOST_CHECK_NE(og.redBlockId(nodeMap[r]), 0);
+    BOOST_CHECK_EQUAL(og.variable("x"), nodeMap[x]);
+    BOOST_CHECK_EQUAL(og.variable("y"), nodeMap[y]);
+
+    // check that the optimised graph produces the same value and derivatives as the original graph
+
+    auto evaluate = [](const ComputationGraph& g, const std::size_t x, const std::size_t y, const std::size_t w) {
+        std::vector<RandomVariable> values(g.size(), RandomVariable(1, 0.0));
+        std::vector<RandomVariable> derivatives(g.size(), RandomVariable(1, 0.0));
+        for (auto const& [v, n] : g.constants())
+            values[n] = RandomVariable(1, v);
+        values[x] = RandomVariable(1, 0.5);
+        values[y] = RandomVariable(1, 3.0);
+        forwardEvaluation(g, values, getRandomVariableOps(1));
+        derivatives[w] = RandomVariable(1, 1.0);
+        backwardDerivatives(g, values, derivatives, getRandomVariableGradients(1), {}, {},
+                            getRandomVariableOps(1), getRandomVariableOpNodeRequirements(),
+                            std::vector<bool>(g.size(), true));
+        return std::vector<Real>{values[w][0], derivatives[x][0], derivatives[y][0]};
+    };
+
+    auto ref = evaluate(g, x, y, w);
+    auto res = evaluate(og, nodeMap[x], nodeMap[y], nodeMap[w]);
+    BOOST_CHECK_CLOSE(ref[0], 12.0 * (std::exp(0.5) + 3.0) + std::exp(0.5), tol);
+    for (Size i = 0; i < ref.size(); ++i)
+        BOOST_CHECK_CLOSE(res[i], ref[i], tol);
+}
+
+BOOST_AUTO_TEST_CASE(testCommonSubexpressionEliminationOnInsert) {
+    BOOST_TEST_MESSAGE("Testing common subexpression elimination on insertion into computation graph...");
+
+    ComputationGraph g;
+    auto x = cg_var(g, "x", ComputationGraph::VarDoesntExist::Create);
+    auto y = cg_var(g, "y", ComputationGraph::VarDoesntExist::Create);
+    auto u1 = cg_exp(g, x);
+    auto u2 = cg_exp(g, x);
+    BOOST_CHECK_NE(u1, u2);
+
+    g.enableCommonSubexpressionElimination();
+    BOOST_CHECK(g.commonSubexpressionElimination());
+    auto v1 = cg_add(g, x, y);
+    Size size = g.size();
+    auto v2 = cg_add(g, x, y);
+    BOOST_CHECK_EQUAL(v1, v2);
+    BOOST_CHECK_EQUAL(g.size(), size);
+    BOOST_CHECK_NE(cg_add(g, y, x), v1);
+    BOOST_CHECK_NE(cg_mult(g, x, y), v1);
+    g.startRedBlock();
+    BOOST_CHECK_NE(cg_add(g, x, y), v1);
+    g.endRedBlock();
+
+    g.enableCommonSubexpressionElimination(false);
+    BOOST_CHECK_NE(cg_add(g, x, y), v1);
+
+    g.clear();
+    g.enableCommonSubexpressionElimination();
+    x = cg_var(g, "x", ComputationGraph::VarDoesntExist::Create);
+    BOOST_CHECK_EQUAL(cg_exp(g, x), cg_exp(g, x));
+    BOOST_CHECK_EQUAL(g.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(testMemoryPlanAndCheckpointing) {
+    BOOST_TEST_MESSAGE("Testing memory plan and checkpointed backward derivatives...");
+
+    constexpr Real tol = 1E-12;
+
+    // z = sum_i exp(x_i * y) * x_{i-1}, with many intermediate nodes that are only short lived
+    ComputationGraph g;
+    std::vector<std::size_t> x;
+    auto y = cg_var(g, "y", ComputationGraph::VarDoesntExist::Create);
+    for (Size i = 0; i < 50; ++i)
+        x.push_back(cg_var(g, "x" + std::to_string(i), ComputationGraph::VarDoesntExist::Create));
+    auto z = cg_const(g, 0.0);
+    for (Size i = 1; i < x.size(); ++i)
+        z = cg_add(g, z, cg_mult(g, cg_exp(g, cg_mult(g, x[i], y)), x[i - 1]));
+
+    std::vector<bool> keepNodes(g.size(), false);
+    keepNodes[z] = true;
+
+    // planned forward evaluation
+
+    ComputationGraphMemoryPlan plan(g, keepNodes);
+    BOOST_TEST_MESSAGE("graph size " << g.size() << ", planned slots " << plan.numberOfSlots());
+    BOOST_CHECK_LT(plan.numberOfSlots(), x.size() + 10);
+
+    std::vector<RandomVariable> values(g.size(), RandomVariable(1, 0.0));
+    std::vector<RandomVariable> arena(plan.numberOfSlots(), RandomVariable(1, 0.0));
+    values[y] = arena[plan.slot(y)] = RandomVariable(1, 0.1);
+    for (Size i = 0; i < x.size(); ++i)
+        values[x[i]] = arena[plan.slot(x[i])] = RandomVariable(1, 1.0 + 0.01 * i);
+    for (auto const& [v, n] : g.constants())
+        values[n] = arena[plan.slot(n)] = RandomVariable(1, v);
+    auto inputValues = values;
+
+    forwardEvaluation(g, plan, arena, getRandomVariableOps(1), RandomVariable::deleter);
+    forwardEvaluation(g, values, getRandomVariableOps(1), RandomVariable::deleter, true,
+                      getRandomVariableOpNodeRequirements());
+    BOOST_CHECK_CLOSE(arena[plan.slot(z)][0], values[z][0], tol);
+
+    std::vector<bool> keepNodesDerivatives(g.size(), false);
+    keepNodesDerivatives[y] = true;
+    for (auto const n : x)
+        keepNodesDerivatives[n] = true;
+
+    std::vector<RandomVariable> derivatives(g.size(), RandomVariable(1, 0.0));
+    derivatives[z] = RandomVariable(1, 1.0);
+    backwardDerivatives(g, values, derivatives, getRandomVariableGradients(1), RandomVariable::deleter,
+                        keepNodesDerivatives);
+
+    // checkpointed backward derivatives for several checkpoint intervals
+
+    for (Size checkpointInterval : {1, 10, 1000}) {
+        std::vector<RandomVariable> values2(inputValues);
+        forwardEvaluation(g, values2, getRandomVariableOps(1), RandomVariable::deleter, false, {},
+                          checkpointKeepNodes(g, checkpointInterval, keepNodes));
+        BOOST_CHECK_CLOSE(values2[z][0], values[z][0], tol);
+        std::vector<RandomVariable> derivatives2(g.size(), RandomVariable(1, 0.0));
+        derivatives2[z] = RandomVariable(1, 1.0);
+        backwardDerivativesCheckpointed(g, values2, derivatives2, getRandomVariableGradients(1),
+                                        RandomVariable::deleter, keepNodesDerivatives, getRandomVariableOps(1),
+                                        keepNodes, checkpointInterval);
+        BOOST_CHECK_CLOSE(derivatives2[y][0], derivatives[y][0], tol);
+        for (auto const n : x)
+            BOOST_CHECK_CLOSE(derivatives2[n][0], derivatives[n][0], tol);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testParallelForwardEvaluation) {
+    BOOST_TEST_MESSAGE("Testing parallel forward evaluation...");
+
+    constexpr Size n = 1000;
+
+    // two independent red blocks each computing a chain of ops on x, and a sum of the results
+
+    ComputationGraph g;
+    auto x = cg_var(g, "x", ComputationGraph::VarDoesntExist::Create);
+    std::vector<std::size_t> results;
+    for (Size b = 0; b < 2; ++b) {
+        g.startRedBlock();
+        auto y = x;
+        for (Size i = 0; i < 20; ++i)
+            y = cg_add(g, cg_mult(g, y, cg_const(g, 0.5 + 0.1 * b)), cg_exp(g, cg_mult(g, x, cg_const(g, 0.01 * i))));
+        results.push_back(y);
+        g.endRedBlock();
+    }
+    auto z = cg_add(g, results[0], results[1]);
+
+    auto wavefronts = computationGraphWavefronts(g);
+    Size nOpNodes = 0;
+    bool mixedBlocks = false;
+    for (auto const& w : wavefronts) {
+        nOpNodes += w.size();
+        for (auto const node : w)
+            mixedBlocks = mixedBlocks || g.redBlockId(node) != g.redBlockId(w.front());
+    }
+    BOOST_TEST_MESSAGE("graph size " << g.size() << ", wavefronts " << wavefronts.size());
+    BOOST_CHECK_LT(wavefronts.size(), nOpNodes);
+    BOOST_CHECK(mixedBlocks);
+
+    MersenneTwisterUniformRng mt(42);
+    std::vector<RandomVariable> values(g.size(), RandomVariable(n, 0.0));
+    for (Size i = 0; i < n; ++i)
+        values[x].set(i, mt.nextReal());
+    for (auto const& [v, node] : g.constants())
+        values[node] = RandomVariable(n, v);
+    auto values2 = values;
+
+    std::vector<bool> keepNodes(g.size(), false);
+    keepNodes[z] = true;
+
+    forwardEvaluation(g, values, getRandomVariableOps(n), RandomVariable::deleter, true,
+                      getRandomVariableOpNodeRequirements(), keepNodes);
+
+    ChunkWorkers workers(4);
+    parallelForwardEvaluation(g, values2, getRandomVariableOps(n), workers, RandomVariable::deleter, true,
+                              getRandomVariableOpNodeRequirements(), keepNodes, wavefronts);
+
+    for (Size node = 0; node < g.size(); ++node) {
+        BOOST_REQUIRE_EQUAL(values[node].initialised(), values2[node].initialised());
+        if (values[node].initialised())
+            BOOST_CHECK(values[node] == values2[node]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testComputationGraphSerialisation) {
+    BOOST_TEST_MESSAGE("Testing computation graph serialisation...");
+
+    ComputationGraph g;
+    g.enableLabels();
+    auto x = cg_var(g, "x", ComputationGraph::VarDoesntExist::Create);
+    auto p = cg_var(g, "__param", ComputationGraph::VarDoesntExist::Create);
+    g.startRedBlock();
+    auto y = cg_mult(g, cg_exp(g, cg_mult(g, x, p)), cg_const(g, 2.0), "y");
+    g.endRedBlock();
+    auto z = cg_add(g, y, cg_max(g, x, cg_const(g, 0.5)), "z");
+    g.setVariable("z", z);
+
+    boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    saveComputationGraph(g, file.string());
+
+    ComputationGraph h;
+    cg_insert(h, "content to be replaced");
+    loadComputationGraph(h, file.string());
+    boost::filesystem::remove(file);
+
+    BOOST_REQUIRE_EQUAL(h.size(), g.size());
+    for (Size node = 0; node < g.size(); ++node) {
+        BOOST_CHECK(h.predecessors(node) == g.predecessors(node));
+        BOOST_CHECK_EQUAL(h.opId(node), g.opId(node));
+        BOOST_CHECK_EQUAL(h.maxNodeRequiringArg(node), g.maxNodeRequiringArg(node));
+        BOOST_CHECK_EQUAL(h.redBlockId(node), g.redBlockId(node));
+        BOOST_CHECK_EQUAL(h.isConstant(node), g.isConstant(node));
+        BOOST_CHECK_EQUAL(h.constantValue(node), g.constantValue(node));
+    }
+    BOOST_CHECK(h.constants() == g.constants());
+    BOOST_CHECK(h.variables() == g.variables());
+    BOOST_CHECK(h.labels() == g.labels());
+    BOOST_CHECK(h.redBlockRanges() == g.redBlockRanges());
+    BOOST_CHECK(h.redBlockDependencies() == g.redBlockDependencies());
+
+    // populate the inputs of the loaded graph via its variables and evaluate it
+
+    std::vector<RandomVariable> values(h.size(), RandomVariable(1, 0.0));
+    for (auto const& [v, node] : h.constants())
+        values[node] = RandomVariable(1, v);
+    values[h.variable("x")] = RandomVariable(1, 0.3);
+    values[h.variable("__param")] = RandomVariable(1, 1.5);
+    forwardEvaluation(h, values, getRandomVariableOps(1));
+    BOOST_CHECK_CLOSE(values[h.variable("z")].at(0), 2.0 * std::exp(0.3 * 1.5) + 0.5, 1E-12);
+
+    BOOST_CHECK_THROW(loadComputationGraph(h, file.string()), std::exception);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
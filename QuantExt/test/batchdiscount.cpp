@@ -0,0 +1,108 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <qle/termstructures/batchdiscount.hpp>
+#include <qle/termstructures/interpolateddiscountcurve2.hpp>
+#include <qle/termstructures/spreadeddiscountcurve.hpp>
+
+#include <ql/quotes/simplequote.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+using namespace boost::unit_test_framework;
+using std::vector;
+
+namespace {
+
+vector<Handle<Quote>> quotes(const vector<Real>& values) {
+    vector<Handle<Quote>> result;
+    for (auto v : values)
+        result.push_back(Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(v)));
+    return result;
+}
+
+// increasing times, followed by decreasing times and times beyond the last grid time
+vector<Time> testTimes() {
+    vector<Time> times;
+    for (Size i = 0; i <= 60; ++i)
+        times.push_back(0.25 * i);
+    for (Size i = 0; i <= 30; ++i)
+        times.push_back(12.0 - 0.4 * i);
+    return times;
+}
+
+void check(const YieldTermStructure& ts, const std::string& label) {
+    vector<Time> times = testTimes();
+    vector<DiscountFactor> result(times.size());
+    discounts(ts, times.data(), result.data(), times.size());
+    for (Size i = 0; i < times.size(); ++i) {
+        DiscountFactor expected = ts.discount(times[i]);
+        BOOST_CHECK_MESSAGE(std::abs(result[i] - expected) < 1E-14,
+                            label << ": batch discount " << result[i] << " at t = " << times[i]
+                                  << " does not match discount " << expected);
+    }
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(BatchDiscountTest)
+
+BOOST_AUTO_TEST_CASE(testBatchDiscounts) {
+
+    BOOST_TEST_MESSAGE("Testing batch discounts of InterpolatedDiscountCurve2 and SpreadedDiscountCurve...");
+
+    Settings::instance().evaluationDate() = Date(10, Jan, 2024);
+    vector<Time> times = {0.0, 0.5, 1.0, 2.0, 5.0, 10.0};
+    vector<Real> dfs = {1.0, 0.99, 0.975, 0.95, 0.87, 0.74};
+    vector<Real> spreadDfs = {1.0, 0.999, 0.997, 0.995, 0.99, 0.98};
+    Handle<YieldTermStructure> flat(QuantLib::ext::make_shared<FlatForward>(0, NullCalendar(), 0.02, Actual365Fixed()));
+
+    for (auto interpolation : {InterpolatedDiscountCurve2::Interpolation::logLinear,
+                               InterpolatedDiscountCurve2::Interpolation::linearZero}) {
+        for (auto extrapolation : {InterpolatedDiscountCurve2::Extrapolation::flatFwd,
+                                   InterpolatedDiscountCurve2::Extrapolation::flatZero}) {
+            auto curve = QuantLib::ext::make_shared<InterpolatedDiscountCurve2>(times, quotes(dfs), Actual365Fixed(),
+                                                                                interpolation, extrapolation);
+            check(*curve, "InterpolatedDiscountCurve2");
+            auto sInterpolation = interpolation == InterpolatedDiscountCurve2::Interpolation::logLinear
+                                      ? SpreadedDiscountCurve::Interpolation::logLinear
+                                      : SpreadedDiscountCurve::Interpolation::linearZero;
+            auto sExtrapolation = extrapolation == InterpolatedDiscountCurve2::Extrapolation::flatFwd
+                                      ? SpreadedDiscountCurve::Extrapolation::flatFwd
+                                      : SpreadedDiscountCurve::Extrapolation::flatZero;
+            // batch reference curve and a reference curve without batch evaluation
+            check(SpreadedDiscountCurve(Handle<YieldTermStructure>(curve), times, quotes(spreadDfs), sInterpolation,
+                                        sExtrapolation),
+                  "SpreadedDiscountCurve on InterpolatedDiscountCurve2");
+            check(SpreadedDiscountCurve(flat, times, quotes(spreadDfs), sInterpolation, sExtrapolation),
+                  "SpreadedDiscountCurve on FlatForward");
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
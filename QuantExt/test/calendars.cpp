@@ -18,9 +18,14 @@
 
 #include "toplevelfixture.hpp"
 #include <boost/test/unit_test.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/calendars/russia.hpp>
 #include <qle/calendars/unitedarabemirates.hpp>
 #include <ql/settings.hpp>
+#include <ql/time/calendars/jointcalendar.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/calendars/unitedkingdom.hpp>
+#include <ql/time/calendars/unitedstates.hpp>
 
 using namespace std;
 using namespace boost::unit_test_framework;
@@ -115,6 +120,30 @@ BOOST_AUTO_TEST_CASE(updatedArabEmirates){
 
 }
 
+BOOST_AUTO_TEST_CASE(testCachedCalendar) {
+
+    BOOST_TEST_MESSAGE("Testing cached calendar against its underlying calendar...");
+
+    Calendar base = JointCalendar(TARGET(), UnitedStates(UnitedStates::Settlement), UnitedKingdom());
+    Date start(1, January, 2020), end(31, December, 2030);
+    Calendar cached = CachedCalendar(base, start, end);
+
+    BOOST_CHECK_EQUAL(cached.name(), base.name());
+    for (Date d = start - 30; d <= end + 30; ++d)
+        BOOST_CHECK_EQUAL(cached.isBusinessDay(d), base.isBusinessDay(d));
+    BOOST_CHECK_EQUAL(cached.advance(Date(20, December, 2024), 10, Days),
+                      base.advance(Date(20, December, 2024), 10, Days));
+
+    // holidays added to the cached calendar itself are taken into account
+    Date d(15, May, 2025);
+    BOOST_REQUIRE(cached.isBusinessDay(d));
+    cached.addHoliday(d);
+    BOOST_CHECK(!cached.isBusinessDay(d));
+    BOOST_CHECK(base.isBusinessDay(d));
+    cached.removeHoliday(d);
+    BOOST_CHECK(cached.isBusinessDay(d));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,7 @@
 
 #include <qle/math/basiccpuenvironment.hpp>
 #include <qle/math/computeenvironment.hpp>
+#include <qle/math/cudaenvironment.hpp>
 #include <qle/math/openclenvironment.hpp>
 #include <qle/math/randomvariable.hpp>
 #include <qle/math/randomvariable_io.hpp>
@@ -27,9 +28,13 @@
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/variance.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <tuple>
+
 #include "toplevelfixture.hpp"
 
 using namespace QuantExt;
@@ -42,6 +47,8 @@ struct ComputeEnvironmentFixture {
     ComputeEnvironmentFixture() {
         QuantExt::ComputeFrameworkRegistry::instance().add(
             "OpenCL", &QuantExt::createComputeFrameworkCreator<QuantExt::OpenClFramework>, true);
+        QuantExt::ComputeFrameworkRegistry::instance().add(
+            "CUDA", &QuantExt::createComputeFrameworkCreator<QuantExt::CudaFramework>, true);
         QuantExt::ComputeFrameworkRegistry::instance().add(
             "BasicCpu", &QuantExt::createComputeFrameworkCreator<QuantExt::BasicCpuFramework>, true);
     }
@@ -332,6 +339,23 @@ BOOST_AUTO_TEST_CASE(testRngGenerationMt19937) {
         std::vector<std::vector<double>> output(2, std::vector<double>(n));
         c.finalizeCalculation(output);
 
+        // curand uses its own mt19937 variant and a different transform to normal variates, so we can only check the
+        // moments for cuda devices
+
+        if (boost::starts_with(d, "CUDA/")) {
+            boost::accumulators::accumulator_set<
+                double, boost::accumulators::stats<boost::accumulators::tag::mean, boost::accumulators::tag::variance>>
+                acc;
+            for (auto const& o : output)
+                for (auto const& v : o)
+                    acc(v);
+            BOOST_TEST_MESSAGE("mean = " << boost::accumulators::mean(acc)
+                                         << ", variance = " << boost::accumulators::variance(acc));
+            BOOST_CHECK_SMALL(boost::accumulators::mean(acc), 0.1);
+            BOOST_CHECK_CLOSE(boost::accumulators::variance(acc), 1.0, 10.0);
+            continue;
+        }
+
         auto sg = GenericPseudoRandom<MersenneTwisterUniformRng, InverseCumulativeNormal>::make_sequence_generator(
             1, settings.rngSeed);
         MersenneTwisterUniformRng mt(settings.rngSeed);
@@ -406,6 +430,272 @@ BOOST_AUTO_TEST_CASE(testConditionalExpectation) {
     BOOST_CHECK(true);
 }
 
+BOOST_AUTO_TEST_CASE(testOpenClRegressionOnDevice) {
+    ComputeEnvironmentFixture fixture;
+    const std::size_t n = 10000;
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        if (!boost::starts_with(d, "OpenCL/"))
+            continue;
+        BOOST_TEST_MESSAGE("testing conditional expectation calculated on device '" << d << "'.");
+        ComputeEnvironment::instance().selectContext(d);
+        auto& c = ComputeEnvironment::instance().context();
+        ComputeContext::Settings settings;
+        settings.useDoublePrecision = c.supportsDoublePrecision();
+        settings.regressionOnDevice = true;
+        BOOST_TEST_MESSAGE("using double precision = " << std::boolalpha << settings.useDoublePrecision);
+
+        c.initiateCalculation(n, 0, 0, settings);
+
+        auto one = c.createInputVariable(1.0);
+        auto vs = c.createInputVariates(1, 3);
+        auto ce = c.applyOperation(RandomVariableOpCode::ConditionalExpectation, {vs[0][0], one, vs[0][1], vs[0][2]});
+        auto e = c.applyOperation(RandomVariableOpCode::ConditionalExpectation, {vs[0][0], one});
+
+        for (auto const& r : vs[0])
+            c.declareOutputVariable(r);
+        c.declareOutputVariable(ce);
+        c.declareOutputVariable(e);
+
+        std::vector<std::vector<double>> output(5, std::vector<double>(n));
+        c.finalizeCalculation(output);
+
+        RandomVariable y(output[0]);
+        RandomVariable x1(output[1]);
+        RandomVariable x2(output[2]);
+        RandomVariable z = conditionalExpectation(
+            y, {&x1, &x2},
+            multiPathBasisSystem(2, settings.regressionOrder, QuantLib::LsmBasisSystem::Monomial, x1.size()));
+        Real ey = expectation(y).at(0);
+
+        // the device solves the normal equations in the device precision
+        double tol = settings.useDoublePrecision ? 1E-8 : 1E-2;
+        Size noErrors = 0, errorThreshold = 10;
+
+        for (Size i = 0; i < n; ++i) {
+            Real err = std::abs(output[3][i] - z[i]) / std::max(1.0, std::abs(z[i]));
+            if (err > tol && noErrors < errorThreshold) {
+                BOOST_ERROR("device value (" << output[3][i] << ") at i=" << i
+                                             << " does not match reference cpu value ("
+                                             << z[i] << "), error " << err << ", tol " << tol);
+                noErrors++;
+            }
+            BOOST_CHECK_SMALL(output[4][i] - ey, tol);
+        }
+    }
+    BOOST_CHECK(true);
+}
+
+BOOST_AUTO_TEST_CASE(testOpenClProgramCache) {
+    ComputeEnvironmentFixture fixture;
+    const std::size_t n = 1024;
+
+    boost::filesystem::path cacheDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(cacheDir);
+    OpenClFramework::setProgramCacheDirectory(cacheDir.string());
+
+    auto calc = [n](ComputeContext& c, const double x0) {
+        c.initiateCalculation(n);
+        std::vector<double> rx(n, x0);
+        auto x = c.createInputVariable(&rx[0]);
+        auto y = c.createInputVariable(3.0);
+        auto z = c.applyOperation(RandomVariableOpCode::Add, {x, y});
+        auto w = c.applyOperation(RandomVariableOpCode::Mult, {z, z});
+        c.declareOutputVariable(w);
+        std::vector<std::vector<double>> output(1, std::vector<double>(n));
+        c.finalizeCalculation(output);
+        return output.front();
+    };
+
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        if (!boost::starts_with(d, "OpenCL/"))
+            continue;
+        BOOST_TEST_MESSAGE("testing program cache on device '" << d << "'.");
+
+        // structurally identical calculations with different ids share the program built by the first one
+
+        ComputeEnvironment::instance().selectContext(d);
+        for (auto const x0 : {4.0, 5.0}) {
+            for (auto const& v : calc(ComputeEnvironment::instance().context(), x0)) {
+                BOOST_CHECK_CLOSE(v, (x0 + 3.0) * (x0 + 3.0), 1.0E-8);
+            }
+        }
+
+        // a new context reuses the program binary persisted by the first one
+
+        BOOST_CHECK(!boost::filesystem::is_empty(cacheDir));
+        ComputeEnvironment::instance().reset();
+        ComputeEnvironment::instance().selectContext(d);
+        for (auto const& v : calc(ComputeEnvironment::instance().context(), 6.0)) {
+            BOOST_CHECK_CLOSE(v, 81.0, 1.0E-8);
+        }
+    }
+
+    OpenClFramework::setProgramCacheDirectory(std::string());
+    boost::filesystem::remove_all(cacheDir);
+}
+
+BOOST_AUTO_TEST_CASE(testOpenClFusionDebugInfo) {
+    ComputeEnvironmentFixture fixture;
+    const std::size_t n = 1024;
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        if (!boost::starts_with(d, "OpenCL/"))
+            continue;
+        BOOST_TEST_MESSAGE("testing fusion debug info on device '" << d << "'.");
+        ComputeEnvironment::instance().selectContext(d);
+        auto& c = ComputeEnvironment::instance().context();
+        unsigned long fusedOpsBefore = c.debugInfo().numberOfFusedOperations;
+        unsigned long bytesSavedBefore = c.debugInfo().bytesMemoryTrafficSaved;
+
+        // exp(-r * t) * max(S - K, 0), all ops are fused into one kernel with each result used once
+
+        ComputeContext::Settings settings;
+        settings.debug = true;
+        c.initiateCalculation(n, 0, 0, settings);
+        std::vector<double> rs(n);
+        for (std::size_t i = 0; i < n; ++i)
+            rs[i] = 80.0 + 40.0 * static_cast<double>(i) / static_cast<double>(n);
+        auto s = c.createInputVariable(&rs[0]);
+        auto k = c.createInputVariable(100.0);
+        auto zero = c.createInputVariable(0.0);
+        auto r = c.createInputVariable(0.02);
+        auto t = c.createInputVariable(2.0);
+        auto payoff = c.applyOperation(RandomVariableOpCode::Max,
+                                       {c.applyOperation(RandomVariableOpCode::Subtract, {s, k}), zero});
+        auto discount = c.applyOperation(
+            RandomVariableOpCode::Exp,
+            {c.applyOperation(RandomVariableOpCode::Negative, {c.applyOperation(RandomVariableOpCode::Mult, {r, t})})});
+        auto pv = c.applyOperation(RandomVariableOpCode::Mult, {discount, payoff});
+        c.declareOutputVariable(pv);
+        std::vector<std::vector<double>> output(1, std::vector<double>(n));
+        c.finalizeCalculation(output);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_CLOSE(output[0][i], std::exp(-0.04) * std::max(rs[i] - 100.0, 0.0), 1.0E-3);
+        }
+        BOOST_CHECK_EQUAL(c.debugInfo().numberOfFusedOperations - fusedOpsBefore, 6 * n);
+        BOOST_CHECK_EQUAL(c.debugInfo().bytesMemoryTrafficSaved - bytesSavedBefore, 6 * 2 * sizeof(float) * n);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testBasicCpuMultiThreaded) {
+    ComputeEnvironmentFixture fixture;
+    BOOST_TEST_MESSAGE("testing multi-threaded and blocked basic cpu contexts against single-threaded context");
+
+    // the size is not a multiple of the chunk size
+    const std::size_t n = 10007;
+    std::vector<double> data(n);
+    for (std::size_t i = 0; i < n; ++i)
+        data[i] = 0.5 + static_cast<double>(i) / static_cast<double>(n);
+
+    std::vector<std::vector<std::vector<double>>> results;
+    const std::vector<std::string> devices = {"BasicCpu/Default/Default", "BasicCpu/Default/MultiThreaded",
+                                              "BasicCpu/Default/Blocked"};
+    for (auto const& d : devices) {
+        ComputeEnvironment::instance().selectContext(d);
+        auto& c = ComputeEnvironment::instance().context();
+        ComputeContext::Settings settings;
+        settings.useDoublePrecision = true;
+        c.initiateCalculation(n, 0, 0, settings);
+        auto one = c.createInputVariable(1.0);
+        auto x = c.createInputVariable(&data[0]);
+        auto vs = c.createInputVariates(1, 2);
+        auto a = c.applyOperation(RandomVariableOpCode::Mult, {x, vs[0][0]});
+        auto b = c.applyOperation(RandomVariableOpCode::Exp, {a});
+        auto e = c.applyOperation(RandomVariableOpCode::Max, {b, one});
+        auto ce = c.applyOperation(RandomVariableOpCode::ConditionalExpectation, {e, one, vs[0][1]});
+        auto f = c.applyOperation(RandomVariableOpCode::Add, {ce, x, one});
+        auto g = c.applyOperation(RandomVariableOpCode::IndicatorGt, {f, one});
+        c.declareOutputVariable(vs[0][1]);
+        c.declareOutputVariable(e);
+        c.declareOutputVariable(ce);
+        c.declareOutputVariable(f);
+        c.declareOutputVariable(g);
+        c.declareOutputVariable(one);
+        results.push_back(std::vector<std::vector<double>>(6, std::vector<double>(n)));
+        c.finalizeCalculation(results.back());
+    }
+
+    for (std::size_t r = 1; r < results.size(); ++r) {
+        for (std::size_t k = 0; k < results[0].size(); ++k) {
+            Size noErrors = 0, errorThreshold = 10;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (results[0][k][i] != results[r][k][i] && noErrors < errorThreshold) {
+                    BOOST_ERROR(devices[r] << " result #" << k << " at i=" << i << " (" << results[r][k][i]
+                                           << ") does not match single-threaded result (" << results[0][k][i]
+                                           << ")");
+                    noErrors++;
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testShardedContext) {
+    ComputeEnvironmentFixture fixture;
+    BOOST_TEST_MESSAGE("testing sharded contexts against single basic cpu context");
+
+    const std::size_t n = 10007;
+    std::vector<std::vector<double>> data(2, std::vector<double>(n));
+    for (std::size_t i = 0; i < n; ++i) {
+        data[0][i] = 0.5 + static_cast<double>(i) / static_cast<double>(n);
+        data[1][i] = 1.1 * data[0][i];
+    }
+
+    // the second run replays the calculation with modified input data
+    std::vector<std::vector<std::vector<double>>> results;
+    const std::vector<std::string> devices = {
+        "BasicCpu/Default/Default", "BasicCpu/Default/Default+BasicCpu/Default/MultiThreaded",
+        "BasicCpu/Default/MultiThreaded + BasicCpu/Default/Blocked + BasicCpu/Default/Default"};
+    for (auto const& d : devices) {
+        ComputeEnvironment::instance().selectContext(d);
+        auto& c = ComputeEnvironment::instance().context();
+        ComputeContext::Settings settings;
+        settings.useDoublePrecision = true;
+        std::size_t id = 0;
+        for (std::size_t run = 0; run < 2; ++run) {
+            bool newCalc;
+            std::tie(id, newCalc) = c.initiateCalculation(n, id, 0, settings);
+            BOOST_CHECK_EQUAL(newCalc, run == 0);
+            auto one = c.createInputVariable(1.0);
+            auto x = c.createInputVariable(&data[run][0]);
+            if (newCalc) {
+                auto vs = c.createInputVariates(1, 2);
+                auto a = c.applyOperation(RandomVariableOpCode::Mult, {x, vs[0][0]});
+                auto b = c.applyOperation(RandomVariableOpCode::Exp, {a});
+                c.freeVariable(a);
+                auto e = c.applyOperation(RandomVariableOpCode::Max, {b, one});
+                auto ce = c.applyOperation(RandomVariableOpCode::ConditionalExpectation, {e, one, vs[0][1]});
+                auto f = c.applyOperation(RandomVariableOpCode::Add, {ce, x, one});
+                auto g = c.applyOperation(RandomVariableOpCode::IndicatorGt, {f, one});
+                auto ce2 = c.applyOperation(RandomVariableOpCode::ConditionalExpectation, {f, g, vs[0][0]});
+                auto h = c.applyOperation(RandomVariableOpCode::Mult, {ce2, b});
+                c.declareOutputVariable(vs[0][1]);
+                c.declareOutputVariable(e);
+                c.declareOutputVariable(ce);
+                c.declareOutputVariable(g);
+                c.declareOutputVariable(h);
+                c.declareOutputVariable(one);
+            }
+            results.push_back(std::vector<std::vector<double>>(6, std::vector<double>(n)));
+            c.finalizeCalculation(results.back());
+        }
+    }
+
+    for (std::size_t r = 2; r < results.size(); ++r) {
+        for (std::size_t k = 0; k < results[0].size(); ++k) {
+            Size noErrors = 0, errorThreshold = 10;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (results[r % 2][k][i] != results[r][k][i] && noErrors < errorThreshold) {
+                    BOOST_ERROR(devices[r / 2] << " run #" << r % 2 << " result #" << k << " at i=" << i << " ("
+                                               << results[r][k][i] << ") does not match single context result ("
+                                               << results[r % 2][k][i] << ")");
+                    noErrors++;
+                }
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -22,7 +22,10 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/data/test_case.hpp>
 // clang-format on
+#include <qle/math/skipaheadmersennetwister.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
+#include <qle/methods/multipathgeneratorbatched.hpp>
+#include <qle/methods/multipathgeneratorblockparallel.hpp>
 #include <qle/models/cdsoptionhelper.hpp>
 #include <qle/models/cirppconstantfellerparametrization.hpp>
 #include <qle/models/commodityschwartzmodel.hpp>
@@ -117,6 +120,7 @@
 #include <boost/accumulators/statistics/error_of_mean.hpp>
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
+#include <boost/accumulators/statistics/variance.hpp>
 #include <boost/accumulators/statistics/variates/covariate.hpp>
 #include <boost/make_shared.hpp>
 
@@ -453,6 +457,72 @@ BOOST_AUTO_TEST_CASE(testLgm1fCalibration) {
 
 } // testLgm1fCalibration
 
+BOOST_AUTO_TEST_CASE(testLgm1fParallelCalibration) {
+
+    BOOST_TEST_MESSAGE("Testing global calibration of LGM 1F model with helpers repriced on model replicas...");
+
+    SavedSettings backup;
+
+    Date evalDate(12, January, 2015);
+    Settings::instance().evaluationDate() = evalDate;
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(evalDate, 0.02, Actual365Fixed()));
+    QuantLib::ext::shared_ptr<IborIndex> euribor6m = QuantLib::ext::make_shared<Euribor>(6 * Months, yts);
+    Real impliedVols[] = {0.4, 0.39, 0.38, 0.35, 0.35, 0.34, 0.33, 0.32, 0.31};
+    Array stepTimes_a(3);
+    for (Size i = 0; i < stepTimes_a.size(); ++i)
+        stepTimes_a[i] = 2.0 * (i + 1);
+
+    // independent model and coterminal basket with its own engine
+    auto replica = [&]() {
+        QuantLib::ext::shared_ptr<IrLgm1fParametrization> p =
+            QuantLib::ext::make_shared<IrLgm1fPiecewiseConstantHullWhiteAdaptor>(
+                EURCurrency(), yts, stepTimes_a, Array(stepTimes_a.size() + 1, 0.0050), stepTimes_a,
+                Array(stepTimes_a.size() + 1, 0.05));
+        LinkableCalibratedModel::CalibrationReplica r;
+        auto lgm = QuantLib::ext::make_shared<LinearGaussMarkovModel>(p);
+        auto engine = QuantLib::ext::make_shared<AnalyticLgmSwaptionEngine>(lgm);
+        r.model = lgm;
+        for (Size i = 0; i < 9; ++i) {
+            Handle<Quote> vol(QuantLib::ext::make_shared<SimpleQuote>(impliedVols[i]));
+            auto helper = QuantLib::ext::make_shared<SwaptionHelper>((i + 1) * Years, (9 - i) * Years, vol, euribor6m,
+                                                                     1 * Years, Thirty360(Thirty360::BondBasis),
+                                                                     Actual360(), yts);
+            helper->setPricingEngine(engine);
+            helper->marketValue();
+            r.helpers.push_back(helper);
+        }
+        return r;
+    };
+
+    LevenbergMarquardt lm(1E-8, 1E-8, 1E-8);
+    EndCriteria ec(1000, 500, 1E-8, 1E-8, 1E-8);
+
+    auto sequential = replica();
+    auto seqModel = QuantLib::ext::static_pointer_cast<LinearGaussMarkovModel>(sequential.model);
+    std::vector<QuantLib::ext::shared_ptr<BlackCalibrationHelper>> seqBasket;
+    for (auto const& h : sequential.helpers)
+        seqBasket.push_back(QuantLib::ext::static_pointer_cast<BlackCalibrationHelper>(h));
+    seqModel->calibrateVolatilities(seqBasket, lm, ec);
+
+    auto parallel = replica();
+    auto parModel = QuantLib::ext::static_pointer_cast<LinearGaussMarkovModel>(parallel.model);
+    std::vector<QuantLib::ext::shared_ptr<BlackCalibrationHelper>> parBasket;
+    for (auto const& h : parallel.helpers)
+        parBasket.push_back(QuantLib::ext::static_pointer_cast<BlackCalibrationHelper>(h));
+    std::vector<LinkableCalibratedModel::CalibrationReplica> replicas = {replica(), replica()};
+    // the helper pointers must be the ones passed to the calibration
+    std::vector<QuantLib::ext::shared_ptr<CalibrationHelper>> parHelpers(parBasket.begin(), parBasket.end());
+    parModel->setCalibrationReplicas(parHelpers, replicas);
+    parModel->calibrateVolatilities(parBasket, lm, ec);
+
+    Array seqParams = seqModel->params(), parParams = parModel->params();
+    BOOST_REQUIRE_EQUAL(seqParams.size(), parParams.size());
+    for (Size i = 0; i < seqParams.size(); ++i)
+        BOOST_CHECK_CLOSE(seqParams[i], parParams[i], 1E-8);
+    for (Size i = 0; i < seqBasket.size(); ++i)
+        BOOST_CHECK_CLOSE(seqBasket[i]->modelValue(), parBasket[i]->modelValue(), 1E-8);
+} // testLgm1fParallelCalibration
+
 BOOST_AUTO_TEST_CASE(testCcyLgm3fForeignPayouts) {
 
     BOOST_TEST_MESSAGE("Testing pricing of foreign payouts under domestic "
@@ -1474,6 +1544,231 @@ BOOST_AUTO_TEST_CASE(testLgmMcWithShift) {
 
 } // testLgmMcWithShift
 
+BOOST_AUTO_TEST_CASE(testBlockParallelPathGeneration) {
+    BOOST_TEST_MESSAGE("Testing block parallel multi path generation...");
+
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(0, NullCalendar(), 0.02, Actual365Fixed()));
+    QuantLib::ext::shared_ptr<IrLgm1fParametrization> lgm =
+        QuantLib::ext::make_shared<IrLgm1fConstantParametrization>(EURCurrency(), yts, 0.01, 0.01);
+
+    TimeGrid grid(10.0, 10);
+    Size seed = 42, blockSize = 7, paths = 100;
+
+    auto blockGenerator = [&lgm, &grid, seed](const Size block) {
+        return QuantLib::ext::make_shared<MultiPathGeneratorMersenneTwister>(
+            QuantLib::ext::make_shared<IrLgm1fStateProcess>(lgm), grid,
+            MultiPathGeneratorBlockParallel::blockSeed(seed, block), false);
+    };
+
+    MultiPathGeneratorBlockParallel pg1(blockGenerator, blockSize, 1);
+    MultiPathGeneratorBlockParallel pg4(blockGenerator, blockSize, 4);
+
+    for (Size pass = 0; pass < 2; ++pass) {
+        QuantLib::ext::shared_ptr<MultiPathGeneratorBase> ref;
+        for (Size i = 0; i < paths; ++i) {
+            if (i % blockSize == 0)
+                ref = blockGenerator(i / blockSize);
+            Sample<MultiPath> r = ref->next();
+            Sample<MultiPath> p1 = pg1.next();
+            Sample<MultiPath> p4 = pg4.next();
+            for (Size j = 0; j < grid.size(); ++j) {
+                BOOST_CHECK_EQUAL(p1.value[0][j], r.value[0][j]);
+                BOOST_CHECK_EQUAL(p4.value[0][j], r.value[0][j]);
+            }
+        }
+        pg1.reset();
+        pg4.reset();
+    }
+
+} // testBlockParallelPathGeneration
+
+BOOST_AUTO_TEST_CASE(testBatchedPathGeneration) {
+    BOOST_TEST_MESSAGE("Testing batched multi path generation in Ccy LGM 5F model...");
+
+    Lgm5fTestData d;
+
+    TimeGrid grid(5.0, 20);
+    Size paths = 50, batchSize = 16;
+
+    for (auto const& model : {d.ccLgmExact, d.ccLgmEuler}) {
+        auto process = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(model->stateProcess());
+        BOOST_REQUIRE(process);
+        BOOST_REQUIRE(process->hasAffineStep());
+        CrossAssetStateBatchEvolver evolver(process, grid);
+        for (auto s : {MersenneTwister, MersenneTwisterAntithetic, SobolBrownianBridge}) {
+            MultiPathGeneratorBatched pg(evolver, s, 42, SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7, batchSize);
+            auto ref = makeMultiPathGenerator(s, process, grid, 42, SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7);
+            for (Size i = 0; i < paths; ++i) {
+                Sample<MultiPath> p = pg.next();
+                Sample<MultiPath> r = ref->next();
+                for (Size k = 0; k < process->size(); ++k) {
+                    for (Size j = 0; j < grid.size(); ++j) {
+                        BOOST_CHECK_SMALL(p.value[k][j] - r.value[k][j], 1E-12);
+                    }
+                }
+            }
+        }
+    }
+
+} // testBatchedPathGeneration
+
+BOOST_AUTO_TEST_CASE(testBatchedPathGenerationWithBrownianBridgeRefinement) {
+    BOOST_TEST_MESSAGE("Testing batched multi path generation with Brownian bridge refinement in Ccy LGM 5F model...");
+
+    Lgm5fTestData d;
+
+    TimeGrid grid(5.0, 20);
+    Size paths = 10000, batchSize = 1000;
+
+    auto process = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(d.ccLgmExact->stateProcess());
+    BOOST_REQUIRE(process);
+    CrossAssetStateBatchEvolver evolver(process, grid);
+
+    // if all steps are coarse, the paths coincide with the unrefined ones
+    {
+        MultiPathGeneratorBatched pg(evolver, SobolBrownianBridge, 42, SobolBrownianGenerator::Steps,
+                                     SobolRsg::JoeKuoD7, 16, std::vector<bool>(grid.size() - 1, true));
+        MultiPathGeneratorBatched ref(evolver, SobolBrownianBridge, 42, SobolBrownianGenerator::Steps,
+                                      SobolRsg::JoeKuoD7, 16);
+        for (Size i = 0; i < 50; ++i) {
+            Sample<MultiPath> p = pg.next();
+            Sample<MultiPath> r = ref.next();
+            for (Size k = 0; k < process->size(); ++k) {
+                for (Size j = 0; j < grid.size(); ++j) {
+                    BOOST_CHECK_SMALL(p.value[k][j] - r.value[k][j], 1E-12);
+                }
+            }
+        }
+    }
+
+    // refine every second step, the moments of the states must match the unrefined ones within the mc error
+    std::vector<bool> coarseSteps(grid.size() - 1);
+    for (Size i = 0; i < coarseSteps.size(); ++i)
+        coarseSteps[i] = i % 2 == 1;
+    MultiPathGeneratorBatched pg(evolver, MersenneTwister, 42, SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7,
+                                 batchSize, coarseSteps);
+    MultiPathGeneratorBatched ref(evolver, MersenneTwister, 43, SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7,
+                                  batchSize);
+    std::vector<std::vector<accumulator_set<double, stats<tag::mean, tag::variance>>>> acc(
+        process->size(), std::vector<accumulator_set<double, stats<tag::mean, tag::variance>>>(grid.size())),
+        accRef = acc;
+    for (Size i = 0; i < paths; ++i) {
+        Sample<MultiPath> p = pg.next();
+        Sample<MultiPath> r = ref.next();
+        for (Size k = 0; k < process->size(); ++k) {
+            for (Size j = 0; j < grid.size(); ++j) {
+                acc[k][j](p.value[k][j]);
+                accRef[k][j](r.value[k][j]);
+            }
+        }
+    }
+    for (Size k = 0; k < process->size(); ++k) {
+        for (Size j = 1; j < grid.size(); ++j) {
+            Real var = boost::accumulators::variance(accRef[k][j]);
+            Real meanTol = 5.0 * std::sqrt(2.0 * var / paths);
+            BOOST_CHECK_MESSAGE(std::abs(mean(acc[k][j]) - mean(accRef[k][j])) < meanTol,
+                                "mean of component " << k << " at t=" << grid[j] << " is " << mean(acc[k][j])
+                                                     << ", expected " << mean(accRef[k][j]) << ", tolerance "
+                                                     << meanTol);
+            BOOST_CHECK_MESSAGE(std::abs(boost::accumulators::variance(acc[k][j]) - var) < 0.1 * var,
+                                "variance of component " << k << " at t=" << grid[j] << " is "
+                                                         << boost::accumulators::variance(acc[k][j])
+                                                         << ", expected " << var);
+        }
+    }
+
+} // testBatchedPathGenerationWithBrownianBridgeRefinement
+
+BOOST_AUTO_TEST_CASE(testSkipAheadMersenneTwister) {
+    BOOST_TEST_MESSAGE("Testing skip ahead mersenne twister...");
+
+    // the sequence coincides with the QuantLib one
+    MersenneTwisterUniformRng ref(42);
+    SkipAheadMersenneTwisterUniformRng rng(42);
+    for (Size i = 0; i < 10000; ++i) {
+        BOOST_REQUIRE_EQUAL(rng.nextInt32(), ref.nextInt32());
+    }
+
+    // skip below and above the threshold for the jump polynomial
+    for (unsigned long long n : {0ULL, 1ULL, 623ULL, 624ULL, 100000ULL, 40000000ULL}) {
+        MersenneTwisterUniformRng ref2(42);
+        SkipAheadMersenneTwisterUniformRng rng2(42);
+        for (Size i = 0; i < 17; ++i) {
+            ref2.nextInt32();
+            rng2.nextInt32();
+        }
+        for (unsigned long long i = 0; i < n; ++i)
+            ref2.nextInt32();
+        rng2.skip(n);
+        for (Size i = 0; i < 1000; ++i) {
+            BOOST_REQUIRE_EQUAL(rng2.nextInt32(), ref2.nextInt32());
+        }
+        BOOST_CHECK_EQUAL(rng2.nextReal(), ref2.nextReal());
+    }
+
+} // testSkipAheadMersenneTwister
+
+BOOST_AUTO_TEST_CASE(testPathGeneratorSkipAhead) {
+    BOOST_TEST_MESSAGE("Testing skip ahead of multi path generators...");
+
+    Lgm5fTestData d;
+
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(0, NullCalendar(), 0.02, Actual365Fixed()));
+    QuantLib::ext::shared_ptr<IrLgm1fParametrization> lgm =
+        QuantLib::ext::make_shared<IrLgm1fConstantParametrization>(EURCurrency(), yts, 0.01, 0.01);
+
+    TimeGrid grid(5.0, 10);
+
+    std::vector<QuantLib::ext::shared_ptr<StochasticProcess>> processes = {
+        QuantLib::ext::make_shared<IrLgm1fStateProcess>(lgm), d.ccLgmExact->stateProcess()};
+
+    for (auto const& process : processes) {
+        for (auto s : {MersenneTwister, MersenneTwisterAntithetic, Sobol, Burley2020Sobol, SobolBrownianBridge,
+                       Burley2020SobolBrownianBridge}) {
+            for (Size n : {0, 1, 2, 7, 32, 33}) {
+                auto ref = makeMultiPathGenerator(s, process, grid, 42);
+                auto pg = makeMultiPathGenerator(s, process, grid, 42);
+                // consume some paths to check that skipTo() does not depend on the current state
+                pg->next();
+                pg->skipTo(n);
+                for (Size i = 0; i < n; ++i)
+                    ref->next();
+                for (Size i = 0; i < 5; ++i) {
+                    Sample<MultiPath> p = pg->next();
+                    Sample<MultiPath> r = ref->next();
+                    BOOST_CHECK_EQUAL(p.weight, r.weight);
+                    for (Size k = 0; k < process->size(); ++k) {
+                        for (Size j = 0; j < grid.size(); ++j) {
+                            BOOST_CHECK_EQUAL(p.value[k][j], r.value[k][j]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // block parallel generator
+    Size seed = 42, blockSize = 7;
+    auto blockGenerator = [&lgm, &grid, seed](const Size block) {
+        return QuantLib::ext::make_shared<MultiPathGeneratorMersenneTwister>(
+            QuantLib::ext::make_shared<IrLgm1fStateProcess>(lgm), grid,
+            MultiPathGeneratorBlockParallel::blockSeed(seed, block), false);
+    };
+    MultiPathGeneratorBlockParallel ref(blockGenerator, blockSize, 2);
+    MultiPathGeneratorBlockParallel pg(blockGenerator, blockSize, 2);
+    pg.skipTo(17);
+    for (Size i = 0; i < 17; ++i)
+        ref.next();
+    for (Size i = 0; i < 30; ++i) {
+        Sample<MultiPath> p = pg.next();
+        Sample<MultiPath> r = ref.next();
+        for (Size j = 0; j < grid.size(); ++j) {
+            BOOST_CHECK_EQUAL(p.value[0][j], r.value[0][j]);
+        }
+    }
+
+} // testPathGeneratorSkipAhead
+
 BOOST_AUTO_TEST_CASE(testIrFxCrCirppMartingaleProperty) {
 
     BOOST_TEST_MESSAGE("Testing martingale property in ir-fx-cr(lgm)-cf(cir++) model for "
@@ -317,6 +317,87 @@ BOOST_AUTO_TEST_CASE(testCase003) {
     BOOST_CHECK_CLOSE(sdvar, mcvar, 1.0);
 }
 
+BOOST_AUTO_TEST_CASE(testCachedCovarianceSalvage) {
+    BOOST_TEST_MESSAGE("Testing cached covariance salvage...");
+
+    // a matrix that is not positive semidefinite, so that the salvage changes it
+    Matrix omega(3, 3, 1.0);
+    omega[0][1] = omega[1][0] = 0.9;
+    omega[0][2] = omega[2][0] = -0.9;
+    omega[1][2] = omega[2][1] = 0.9;
+    Array delta(3, 1.0);
+    delta[1] = -2.0;
+    Matrix gamma(3, 3, 0.0);
+    gamma[0][0] = 0.5;
+
+    auto spectral = QuantLib::ext::make_shared<SpectralCovarianceSalvage>();
+    CachedCovarianceSalvage cached(spectral);
+
+    for (Size i = 0; i < 2; ++i) {
+        BOOST_CHECK_EQUAL(deltaVar(omega, delta, 0.99, cached), deltaVar(omega, delta, 0.99, *spectral));
+        BOOST_CHECK_EQUAL(deltaGammaVarNormal(omega, delta, gamma, 0.99, cached),
+                          deltaGammaVarNormal(omega, delta, gamma, 0.99, *spectral));
+        BOOST_CHECK_EQUAL(deltaGammaVarMc<PseudoRandom>(omega, delta, gamma, 0.99, 10000, 42, cached),
+                          deltaGammaVarMc<PseudoRandom>(omega, delta, gamma, 0.99, 10000, 42, *spectral));
+    }
+
+    // a different matrix must not be served from the cache
+    Matrix omega2 = 2.0 * omega;
+    BOOST_CHECK_EQUAL(deltaVar(omega2, delta, 0.99, cached), deltaVar(omega2, delta, 0.99, *spectral));
+
+    // the vector version of the mc var gives the same results as the single quantile version
+    std::vector<Real> p{0.9, 0.99, 0.95};
+    std::vector<Real> v = deltaGammaVarMc<PseudoRandom>(omega, delta, gamma, p, 10000, 42, cached);
+    for (Size i = 0; i < p.size(); ++i)
+        BOOST_CHECK_EQUAL(v[i], deltaGammaVarMc<PseudoRandom>(omega, delta, gamma, p[i], 10000, 42, cached));
+}
+
+BOOST_AUTO_TEST_CASE(testGammaSupportMoments) {
+    BOOST_TEST_MESSAGE("Testing delta gamma moments computed on the gamma support against dense computation...");
+
+    const Size dim = 30;
+    MersenneTwisterUniformRng mt(42);
+    Matrix L(dim, dim);
+    for (Size i = 0; i < dim; ++i)
+        for (Size j = 0; j < dim; ++j)
+            L[i][j] = mt.nextReal();
+    Matrix omega = transpose(L) * L;
+    omega /= QuantExt::detail::absMax(omega) * 10.0;
+
+    Array delta(dim);
+    for (Size i = 0; i < dim; ++i)
+        delta[i] = mt.nextReal() * 1000.0 - 500.0;
+
+    // sparse gamma (diagonal plus a few cross gammas), dense gamma and zero gamma
+    std::vector<Matrix> gammas(3, Matrix(dim, dim, 0.0));
+    for (Size i : {2, 7, 8, 19})
+        gammas[0][i][i] = mt.nextReal() * 2000.0 - 1000.0;
+    gammas[0][7][8] = gammas[0][8][7] = 300.0;
+    gammas[0][2][19] = gammas[0][19][2] = -200.0;
+    for (Size i = 0; i < dim; ++i)
+        for (Size j = 0; j <= i; ++j)
+            gammas[1][i][j] = gammas[1][j][i] = mt.nextReal() * 2000.0 - 1000.0;
+
+    std::vector<Size> expectedSupport{2, 7, 8, 19};
+    std::vector<Size> support = QuantExt::detail::gammaSupport(gammas[0]);
+    BOOST_CHECK_EQUAL_COLLECTIONS(support.begin(), support.end(), expectedSupport.begin(), expectedSupport.end());
+    BOOST_CHECK_EQUAL(QuantExt::detail::gammaSupport(gammas[1]).size(), dim);
+    BOOST_CHECK(QuantExt::detail::gammaSupport(gammas[2]).empty());
+
+    for (Size k = 0; k < gammas.size(); ++k) {
+        Real num1, mu1, var1, tau1, kappa1, num2, mu2, var2, tau2, kappa2;
+        QuantExt::detail::deltaGammaMoments(omega, delta, gammas[k], num1, mu1, var1, &tau1, &kappa1, false);
+        QuantExt::detail::deltaGammaMoments(omega, delta, gammas[k], num2, mu2, var2, &tau2, &kappa2, true);
+        BOOST_TEST_MESSAGE("gamma #" << k << ": mu " << mu1 << " " << mu2 << " variance " << var1 << " " << var2
+                                     << " tau " << tau1 << " " << tau2 << " kappa " << kappa1 << " " << kappa2);
+        BOOST_CHECK_EQUAL(num1, num2);
+        BOOST_CHECK_SMALL(mu1 - mu2, 1E-12);
+        BOOST_CHECK_CLOSE(var1, var2, 1E-10);
+        BOOST_CHECK_SMALL(tau1 - tau2, 1E-10);
+        BOOST_CHECK_SMALL(kappa1 - kappa2, 1E-10);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,126 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <qle/pricingengines/discountingswapbatchengine.hpp>
+
+#include <ql/indexes/ibor/euribor.hpp>
+#include <ql/instruments/makevanillaswap.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+#include <ql/quotes/simplequote.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+using namespace boost::unit_test_framework;
+using std::vector;
+
+namespace {
+
+struct TestData {
+    TestData() : refDate(Date(22, Aug, 2016)) {
+        Settings::instance().evaluationDate() = refDate;
+        discountQuote = QuantLib::ext::make_shared<SimpleQuote>(0.02);
+        forwardQuote = QuantLib::ext::make_shared<SimpleQuote>(0.03);
+        discountCurve = Handle<YieldTermStructure>(
+            QuantLib::ext::make_shared<FlatForward>(refDate, Handle<Quote>(discountQuote), Actual365Fixed()));
+        forwardCurve = Handle<YieldTermStructure>(
+            QuantLib::ext::make_shared<FlatForward>(refDate, Handle<Quote>(forwardQuote), Actual365Fixed()));
+        forwardIndex = QuantLib::ext::make_shared<Euribor>(6 * Months, forwardCurve);
+        // seasoned swaps require the fixing of their current coupon
+        Date seasonedStart = forwardIndex->fixingCalendar().adjust(refDate - 3 * Months);
+        forwardIndex->addFixing(forwardIndex->fixingDate(seasonedStart), 0.025);
+        swaps.push_back(QuantLib::ext::shared_ptr<VanillaSwap>(
+            MakeVanillaSwap(10 * Years, forwardIndex, 0.04).receiveFixed(true).withNominal(100.0)));
+        swaps.push_back(QuantLib::ext::shared_ptr<VanillaSwap>(MakeVanillaSwap(5 * Years, forwardIndex, 0.025)
+                                                                   .receiveFixed(false)
+                                                                   .withNominal(50.0)
+                                                                   .withFloatingLegSpread(0.001)));
+        swaps.push_back(QuantLib::ext::shared_ptr<VanillaSwap>(
+            MakeVanillaSwap(7 * Years, forwardIndex, 0.03, 1 * Years).receiveFixed(true).withNominal(80.0)));
+        swaps.push_back(QuantLib::ext::shared_ptr<VanillaSwap>(
+            MakeVanillaSwap(2 * Years, forwardIndex, 0.035).withEffectiveDate(seasonedStart).withNominal(120.0)));
+    }
+    Date refDate;
+    QuantLib::ext::shared_ptr<SimpleQuote> discountQuote, forwardQuote;
+    Handle<YieldTermStructure> discountCurve, forwardCurve;
+    QuantLib::ext::shared_ptr<IborIndex> forwardIndex;
+    vector<QuantLib::ext::shared_ptr<VanillaSwap>> swaps;
+};
+
+void checkAgainstDiscountingSwapEngine(const TestData& d, const QuantLib::ext::shared_ptr<PricingEngine>& engine) {
+    vector<Real> npv, bps0, bps1;
+    for (auto const& s : d.swaps) {
+        npv.push_back(s->NPV());
+        bps0.push_back(s->legBPS(0));
+        bps1.push_back(s->legBPS(1));
+    }
+    auto refEngine = QuantLib::ext::make_shared<DiscountingSwapEngine>(d.discountCurve);
+    const Real tol = 1E-10;
+    for (Size i = 0; i < d.swaps.size(); ++i) {
+        d.swaps[i]->setPricingEngine(refEngine);
+        BOOST_TEST_MESSAGE("swap #" << i << ": npv " << npv[i] << " expected " << d.swaps[i]->NPV());
+        BOOST_CHECK_SMALL(npv[i] - d.swaps[i]->NPV(), tol);
+        BOOST_CHECK_SMALL(bps0[i] - d.swaps[i]->legBPS(0), tol);
+        BOOST_CHECK_SMALL(bps1[i] - d.swaps[i]->legBPS(1), tol);
+        d.swaps[i]->setPricingEngine(engine);
+    }
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(DiscountingSwapBatchEngineTest)
+
+BOOST_AUTO_TEST_CASE(testAgainstDiscountingSwapEngine) {
+
+    BOOST_TEST_MESSAGE("Testing DiscountingSwapBatchEngine against DiscountingSwapEngine...");
+
+    TestData d;
+    auto engine = QuantLib::ext::make_shared<DiscountingSwapBatchEngine>(d.discountCurve);
+    for (auto const& s : d.swaps)
+        s->setPricingEngine(engine);
+
+    // the first swap computes the batch, the others are added to the valid batch
+    checkAgainstDiscountingSwapEngine(d, engine);
+    BOOST_CHECK_EQUAL(engine->size(), d.swaps.size());
+    BOOST_CHECK_EQUAL(engine->batchCalculations(), 1);
+
+    // a change of the discount curve triggers one batch calculation for all swaps
+    d.discountQuote->setValue(0.025);
+    checkAgainstDiscountingSwapEngine(d, engine);
+    BOOST_CHECK_EQUAL(engine->batchCalculations(), 2);
+
+    // the same holds for a change of the forwarding curve
+    d.forwardQuote->setValue(0.02);
+    checkAgainstDiscountingSwapEngine(d, engine);
+    BOOST_CHECK_EQUAL(engine->batchCalculations(), 3);
+
+    // and for a change of the evaluation date
+    Settings::instance().evaluationDate() = d.refDate + 1;
+    checkAgainstDiscountingSwapEngine(d, engine);
+    BOOST_CHECK_EQUAL(engine->size(), d.swaps.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
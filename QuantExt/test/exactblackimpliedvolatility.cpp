@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+
+#include <qle/models/exactblackimpliedvolatility.hpp>
+
+#include <ql/pricingengines/blackformula.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ExactBlackImpliedVolatilityTest)
+
+BOOST_AUTO_TEST_CASE(testExactBlackImpliedStdDev) {
+
+    BOOST_TEST_MESSAGE("Testing exact Black implied std dev...");
+
+    Real forward = 0.03, displacement = 0.01, discount = 0.9;
+
+    for (Real strike = -0.005; strike < 0.10 + 1E-5; strike += 0.0025) {
+        for (Real stdDev = 0.01; stdDev < 3.0; stdDev *= 1.2) {
+            for (auto type : {Option::Call, Option::Put}) {
+                Real price = blackFormula(type, strike, forward, stdDev, discount, displacement);
+                Real intrinsic =
+                    discount * std::max((type == Option::Call ? 1.0 : -1.0) * (forward - strike), 0.0);
+                // skip prices that do not carry enough information on the std dev
+                if (price - intrinsic < 1E-6 * std::max(intrinsic, 1E-6))
+                    continue;
+                Real implied = exactBlackImpliedStdDev(type, strike, forward, price, discount, displacement);
+                BOOST_CHECK_CLOSE(stdDev, implied, 1E-6);
+            }
+        }
+    }
+
+    // intrinsic value, zero std dev
+    BOOST_CHECK_EQUAL(exactBlackImpliedStdDev(Option::Call, 0.02, 0.03, 0.01), 0.0);
+    BOOST_CHECK_EQUAL(exactBlackImpliedStdDev(Option::Put, 0.02, 0.03, 0.0), 0.0);
+
+    // arbitrage violating prices
+    BOOST_CHECK_THROW(exactBlackImpliedStdDev(Option::Call, 0.02, 0.03, 0.005), QuantLib::Error);
+    BOOST_CHECK_THROW(exactBlackImpliedStdDev(Option::Call, 0.02, 0.03, 0.03), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testExactBlackImpliedStdDevBatch) {
+
+    BOOST_TEST_MESSAGE("Testing exact Black implied std devs for arrays of options...");
+
+    std::vector<Real> strikes{0.01, 0.02, 0.03, 0.04}, forwards(4, 0.025), discounts(4, 0.95), prices, stdDevs(4);
+    std::vector<Real> expected{0.1, 0.25, 0.4, 0.6};
+    for (Size i = 0; i < strikes.size(); ++i)
+        prices.push_back(blackFormula(Option::Put, strikes[i], forwards[i], expected[i], discounts[i]));
+    exactBlackImpliedStdDevs(Option::Put, strikes.data(), forwards.data(), prices.data(), discounts.data(),
+                             strikes.size(), stdDevs.data());
+    for (Size i = 0; i < strikes.size(); ++i)
+        BOOST_CHECK_CLOSE(stdDevs[i], expected[i], 1E-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
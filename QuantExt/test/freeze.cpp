@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <qle/termstructures/spreadeddiscountcurve.hpp>
+#include <qle/utilities/freeze.hpp>
+
+#include <ql/quotes/simplequote.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/nullcalendar.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+using namespace boost::unit_test_framework;
+using std::vector;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(FreezeTest)
+
+BOOST_AUTO_TEST_CASE(testFrozenTermStructureKeepsValues) {
+
+    BOOST_TEST_MESSAGE("Testing freeze and unfreeze of a term structure...");
+
+    Settings::instance().evaluationDate() = Date(15, May, 2024);
+
+    auto rate = QuantLib::ext::make_shared<SimpleQuote>(0.02);
+    auto spread = QuantLib::ext::make_shared<SimpleQuote>(0.99);
+    Handle<YieldTermStructure> reference(
+        QuantLib::ext::make_shared<FlatForward>(0, NullCalendar(), Handle<Quote>(rate), Actual365Fixed()));
+    vector<Handle<Quote>> spreads{Handle<Quote>(QuantLib::ext::make_shared<SimpleQuote>(1.0)), Handle<Quote>(spread)};
+    auto curve = QuantLib::ext::make_shared<SpreadedDiscountCurve>(reference, vector<Time>{0.0, 5.0}, spreads);
+
+    Real before = curve->discount(3.0);
+    freeze(curve);
+
+    // neither the spread nor the reference curve changes affect the frozen curve
+    spread->setValue(0.98);
+    rate->setValue(0.03);
+    BOOST_CHECK_EQUAL(curve->discount(3.0), before);
+
+    // after unfreezing, the curve reflects the changes
+    unfreeze(curve);
+    Real after = curve->discount(3.0);
+    BOOST_CHECK(std::abs(after - before) > 1.0E-4);
+    Real expected = std::exp(-0.03 * 3.0) * std::pow(0.98, 3.0 / 5.0);
+    BOOST_CHECK_CLOSE(after, expected, 1.0E-8);
+
+    // freezing a null pointer is a no-op
+    BOOST_CHECK_NO_THROW(freeze(nullptr));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
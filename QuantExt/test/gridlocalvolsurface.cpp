@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <qle/termstructures/gridlocalvolsurface.hpp>
+
+#include <ql/time/calendars/nullcalendar.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include <cmath>
+
+using namespace QuantExt;
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+
+namespace {
+
+// local vol which is linear in t and log S, throws for strikes above 250
+class TestLocalVol : public LocalVolTermStructure {
+public:
+    explicit TestLocalVol(const Date& referenceDate)
+        : LocalVolTermStructure(referenceDate, NullCalendar(), Following, Actual365Fixed()) {}
+    Date maxDate() const override { return Date::maxDate(); }
+    Real minStrike() const override { return 0.0; }
+    Real maxStrike() const override { return QL_MAX_REAL; }
+    static Real value(const Time t, const Real strike) { return 0.20 + 0.05 * t + 0.02 * std::log(strike); }
+
+protected:
+    Volatility localVolImpl(Time t, Real strike) const override {
+        QL_REQUIRE(strike <= 250.0, "TestLocalVol: strike " << strike << " not supported");
+        return value(t, strike);
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(GridLocalVolSurfaceTest)
+
+BOOST_AUTO_TEST_CASE(testInterpolation) {
+
+    BOOST_TEST_MESSAGE("Testing GridLocalVolSurface interpolation...");
+
+    Date refDate(20, Jan, 2024);
+    Settings::instance().evaluationDate() = refDate;
+
+    Handle<LocalVolTermStructure> source(QuantLib::ext::make_shared<TestLocalVol>(refDate));
+    std::vector<Time> times = {0.0, 0.25, 1.0, 3.0};
+    Real minLogStrike = std::log(50.0), maxLogStrike = std::log(150.0);
+    GridLocalVolSurface grid(source, times, minLogStrike, maxLogStrike, 11);
+
+    BOOST_REQUIRE_EQUAL(grid.values().rows(), times.size());
+    BOOST_REQUIRE_EQUAL(grid.values().columns(), Size(11));
+    BOOST_CHECK_CLOSE(grid.logStrikes().front(), minLogStrike, 1E-12);
+    BOOST_CHECK_CLOSE(grid.logStrikes().back(), maxLogStrike, 1E-12);
+
+    // the source is linear in t and log S, so the bilinear interpolation is exact inside the grid
+
+    Real tol = 1E-12;
+    for (auto const t : {0.0, 0.1, 0.25, 0.7, 1.0, 2.2, 3.0}) {
+        for (auto const s : {50.0, 63.0, 80.0, 100.0, 121.0, 150.0}) {
+            BOOST_CHECK_SMALL(grid.localVol(t, s) - TestLocalVol::value(t, s), tol);
+        }
+    }
+    BOOST_CHECK_SMALL(grid.maxMidpointError(), tol);
+
+    // flat extrapolation in t and log S outside the grid
+
+    BOOST_CHECK_SMALL(grid.localVol(5.0, 100.0) - TestLocalVol::value(3.0, 100.0), tol);
+    BOOST_CHECK_SMALL(grid.localVol(1.0, 20.0) - TestLocalVol::value(1.0, 50.0), tol);
+    BOOST_CHECK_SMALL(grid.localVol(1.0, 180.0) - TestLocalVol::value(1.0, 150.0), tol);
+    BOOST_CHECK_SMALL(grid.localVol(5.0, 180.0) - TestLocalVol::value(3.0, 150.0), tol);
+}
+
+BOOST_AUTO_TEST_CASE(testFailingSource) {
+
+    BOOST_TEST_MESSAGE("Testing GridLocalVolSurface with failing source evaluations...");
+
+    Date refDate(20, Jan, 2024);
+    Settings::instance().evaluationDate() = refDate;
+
+    Handle<LocalVolTermStructure> source(QuantLib::ext::make_shared<TestLocalVol>(refDate));
+    std::vector<Time> times = {0.0, 1.0};
+    GridLocalVolSurface grid(source, times, std::log(100.0), std::log(400.0), 3);
+
+    // the source throws for strikes above 250, these grid points are set to zero
+
+    BOOST_CHECK_SMALL(grid.values()[0][0] - TestLocalVol::value(0.0, 100.0), 1E-12);
+    BOOST_CHECK_SMALL(grid.values()[0][1] - TestLocalVol::value(0.0, 200.0), 1E-12);
+    BOOST_CHECK_EQUAL(grid.values()[0][2], 0.0);
+    BOOST_CHECK_EQUAL(grid.values()[1][2], 0.0);
+
+    std::vector<Time> badTimes = {1.0, 1.0};
+    BOOST_CHECK_THROW(GridLocalVolSurface(source, badTimes, std::log(50.0), std::log(150.0), 3), QuantLib::Error);
+    BOOST_CHECK_THROW(GridLocalVolSurface(source, times, std::log(50.0), std::log(150.0), 1), QuantLib::Error);
+    BOOST_CHECK_THROW(GridLocalVolSurface(source, times, std::log(150.0), std::log(50.0), 3), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,149 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+
+#include <qle/models/hwconstantparametrization.hpp>
+#include <qle/models/hwmodel.hpp>
+#include <qle/models/hwvectorised.hpp>
+
+#include <ql/currencies/europe.hpp>
+#include <ql/indexes/ibor/eonia.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(HwVectorisedTest)
+
+namespace {
+struct TestData {
+    TestData() {
+        Settings::instance().evaluationDate() = Date(5, February, 2016);
+        yts = Handle<YieldTermStructure>(QuantLib::ext::make_shared<FlatForward>(0, TARGET(), 0.02, Actual365Fixed()));
+        fwd = Handle<YieldTermStructure>(QuantLib::ext::make_shared<FlatForward>(0, TARGET(), 0.025, Actual365Fixed()));
+        Matrix sigma(2, 2);
+        sigma[0][0] = 0.008;
+        sigma[0][1] = 0.002;
+        sigma[1][0] = -0.001;
+        sigma[1][1] = 0.006;
+        Array kappa(2);
+        kappa[0] = 0.01;
+        kappa[1] = 0.3;
+        p = QuantLib::ext::make_shared<IrHwConstantParametrization>(EURCurrency(), yts, sigma, kappa);
+        x = {RandomVariable(std::vector<double>{-0.05, -0.01, 0.0, 0.02, 0.04}),
+             RandomVariable(std::vector<double>{0.01, -0.02, 0.0, 0.03, -0.01})};
+        aux = {RandomVariable(std::vector<double>{0.02, 0.01, 0.0, -0.01, 0.05}),
+               RandomVariable(std::vector<double>{-0.01, 0.0, 0.0, 0.02, 0.01})};
+    }
+    Handle<YieldTermStructure> yts, fwd;
+    QuantLib::ext::shared_ptr<IrHwParametrization> p;
+    std::vector<RandomVariable> x, aux;
+};
+
+Array state(const std::vector<RandomVariable>& x, const Size k) {
+    Array result(x.size());
+    for (Size i = 0; i < x.size(); ++i)
+        result[i] = x[i][k];
+    return result;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testDiscountBondAndNumeraire) {
+
+    BOOST_TEST_MESSAGE("Testing HwVectorised discount bonds and numeraire against HwModel...");
+
+    TestData d;
+    HwModel model(d.p);
+    HwVectorised hw(d.p);
+
+    for (auto const& curve : {Handle<YieldTermStructure>(), d.fwd}) {
+        for (Time t : {0.0, 0.5, 2.0}) {
+            RandomVariable numeraire = hw.numeraire(t, d.aux, curve);
+            for (Size k = 0; k < d.x[0].size(); ++k) {
+                BOOST_CHECK_CLOSE(numeraire[k], model.numeraire(t, state(d.x, k), curve, state(d.aux, k)), 1E-10);
+            }
+            for (Time T : {t, t + 0.25, t + 5.0, t + 30.0}) {
+                RandomVariable bond = hw.discountBond(t, T, d.x, curve);
+                auto factors = hw.discountBondFactors(t, T, curve);
+                RandomVariable bondFromFactors = hw.discountBond(factors, d.x);
+                RandomVariable reducedBond = hw.reducedDiscountBond(t, T, d.x, d.aux, curve);
+                for (Size k = 0; k < d.x[0].size(); ++k) {
+                    Real expected = model.discountBond(t, T, state(d.x, k), curve);
+                    BOOST_CHECK_CLOSE(bond[k], expected, 1E-10);
+                    BOOST_CHECK_CLOSE(bondFromFactors[k], expected, 1E-10);
+                    BOOST_CHECK_CLOSE(hw.discountBond(factors, state(d.x, k)), expected, 1E-10);
+                    BOOST_CHECK_CLOSE(reducedBond[k],
+                                      expected / model.numeraire(t, state(d.x, k), curve, state(d.aux, k)), 1E-10);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testCompoundedOnRate) {
+
+    BOOST_TEST_MESSAGE("Testing HwVectorised compounded on rate...");
+
+    TestData d;
+    HwVectorised hw(d.p);
+
+    auto index = QuantLib::ext::make_shared<Eonia>(d.fwd);
+    Date start = TARGET().advance(Settings::instance().evaluationDate(), 1 * Years);
+    Date end = TARGET().advance(start, 3 * Months);
+    std::vector<Date> valueDates, fixingDates;
+    std::vector<Real> dt;
+    for (Date v = start; v <= end; v = TARGET().advance(v, 1 * Days)) {
+        valueDates.push_back(v);
+        fixingDates.push_back(v);
+    }
+    fixingDates.pop_back();
+    for (Size i = 0; i + 1 < valueDates.size(); ++i)
+        dt.push_back(index->dayCounter().yearFraction(valueDates[i], valueDates[i + 1]));
+
+    // on the initial state the rate is the forward compounded rate on the forwarding curve
+
+    Real tau = index->dayCounter().yearFraction(start, end);
+    Real expected = (d.fwd->discount(start) / d.fwd->discount(end) - 1.0) / tau;
+    RandomVariable rate = hw.compoundedOnRate(index, fixingDates, valueDates, dt, 0, false, 0.0, 1.0, 0.0, d.x);
+    for (Size k = 0; k < d.x[0].size(); ++k)
+        BOOST_CHECK_CLOSE(rate[k], expected, 1E-10);
+
+    // for a future observation time the compound factor is P(t, start) / P(t, end) in the model
+
+    Time t = 0.5;
+    Time T1 = d.p->termStructure()->timeFromReference(start);
+    Time T2 = d.p->termStructure()->timeFromReference(end);
+    rate = hw.compoundedOnRate(index, fixingDates, valueDates, dt, 0, false, 0.001, 1.0, t, d.x);
+    RandomVariable expectedRate =
+        (hw.discountBond(t, T1, d.x, d.fwd) / hw.discountBond(t, T2, d.x, d.fwd) - RandomVariable(5, 1.0)) /
+            RandomVariable(5, tau) +
+        RandomVariable(5, 0.001);
+    for (Size k = 0; k < d.x[0].size(); ++k)
+        BOOST_CHECK_CLOSE(rate[k], expectedRate[k], 1E-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
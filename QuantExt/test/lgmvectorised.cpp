@@ -0,0 +1,141 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+
+#include <qle/models/irlgm1fconstantparametrization.hpp>
+#include <qle/models/lgmvectorised.hpp>
+
+#include <ql/cashflows/coupon.hpp>
+#include <ql/currencies/europe.hpp>
+#include <ql/indexes/ibor/euribor.hpp>
+#include <ql/indexes/swap/euriborswap.hpp>
+#include <ql/instruments/vanillaswap.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(LgmVectorisedTest)
+
+namespace {
+struct TestData {
+    TestData() {
+        Settings::instance().evaluationDate() = Date(5, February, 2016);
+        yts = Handle<YieldTermStructure>(QuantLib::ext::make_shared<FlatForward>(0, TARGET(), 0.02, Actual365Fixed()));
+        fwd = Handle<YieldTermStructure>(QuantLib::ext::make_shared<FlatForward>(0, TARGET(), 0.025, Actual365Fixed()));
+        p = QuantLib::ext::make_shared<IrLgm1fConstantParametrization>(EURCurrency(), yts, 0.01, 0.03);
+        x = RandomVariable(std::vector<double>{-0.05, -0.01, 0.0, 0.02, 0.04});
+    }
+    Handle<YieldTermStructure> yts, fwd;
+    QuantLib::ext::shared_ptr<IrLgm1fParametrization> p;
+    RandomVariable x;
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testAnnuity) {
+
+    BOOST_TEST_MESSAGE("Testing LgmVectorised annuity against sum of discount bonds...");
+
+    TestData d;
+    LgmVectorised lgm(d.p);
+
+    Time t = 1.5;
+    std::vector<Time> payTimes{1.5, 2.0, 3.0, 4.0, 5.0};
+    std::vector<Real> accruals{0.0, 0.5, 1.01, 0.99, 1.0};
+
+    for (auto const& curve : {Handle<YieldTermStructure>(), d.fwd}) {
+        RandomVariable expected(d.x.size(), 0.0);
+        for (Size i = 0; i < payTimes.size(); ++i)
+            expected += RandomVariable(d.x.size(), accruals[i]) * lgm.discountBond(t, payTimes[i], d.x, curve);
+        RandomVariable result = lgm.annuity(t, payTimes, accruals, d.x, curve);
+        for (Size k = 0; k < d.x.size(); ++k)
+            BOOST_CHECK_CLOSE(result[k], expected[k], 1E-10);
+        // deterministic state
+        RandomVariable x0(d.x.size(), 0.01);
+        BOOST_CHECK(lgm.annuity(t, payTimes, accruals, x0, curve).deterministic());
+        BOOST_CHECK_CLOSE(lgm.annuity(t, payTimes, accruals, x0, curve)[0],
+                          lgm.annuity(t, payTimes, accruals, RandomVariable(std::vector<double>{0.01}), curve)[0],
+                          1E-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSwapRate) {
+
+    BOOST_TEST_MESSAGE("Testing LgmVectorised swap rate against explicit leg valuation...");
+
+    TestData d;
+    LgmVectorised lgm(d.p);
+
+    auto index = QuantLib::ext::make_shared<EuriborSwapIsdaFixA>(10 * Years, d.fwd, d.yts);
+    Date fixingDate = TARGET().advance(Settings::instance().evaluationDate(), 2 * Years);
+
+    for (Time t : {0.5, lgm.parametrization()->termStructure()->timeFromReference(fixingDate)}) {
+
+        // the swap rate computed from the underlying swap's legs, using reduced discount bonds
+
+        auto swap = index->underlyingSwap(fixingDate);
+        RandomVariable flt(d.x.size(), 0.0), ann(d.x.size(), 0.0);
+        for (auto const& c : swap->floatingLeg()) {
+            auto cpn = QuantLib::ext::dynamic_pointer_cast<IborCoupon>(c);
+            Date start = index->iborIndex()->valueDate(cpn->fixingDate());
+            Time T1 = std::max(t, d.p->termStructure()->timeFromReference(start));
+            Time T2 = std::max(T1, d.p->termStructure()->timeFromReference(cpn->fixingEndDate()));
+            Time T3 = std::max(T2, d.p->termStructure()->timeFromReference(cpn->date()));
+            Real adj =
+                cpn->accrualPeriod() / index->iborIndex()->dayCounter().yearFraction(start, cpn->fixingEndDate());
+            flt += RandomVariable(d.x.size(), adj) *
+                   (lgm.reducedDiscountBond(t, T1, d.x, d.fwd) / lgm.reducedDiscountBond(t, T2, d.x, d.fwd) -
+                    RandomVariable(d.x.size(), 1.0)) *
+                   lgm.reducedDiscountBond(t, T3, d.x, d.yts);
+        }
+        for (auto const& c : swap->fixedLeg()) {
+            auto cpn = QuantLib::ext::dynamic_pointer_cast<Coupon>(c);
+            Time T = std::max(t, d.p->termStructure()->timeFromReference(cpn->date()));
+            ann += RandomVariable(d.x.size(), cpn->accrualPeriod()) * lgm.reducedDiscountBond(t, T, d.x, d.yts);
+        }
+        RandomVariable expected = flt / ann;
+
+        auto schedule = lgm.swapRateSchedule(index, fixingDate);
+        BOOST_CHECK_EQUAL(schedule.floatPayTimes.size(), swap->floatingLeg().size());
+        BOOST_CHECK_EQUAL(schedule.fixedPayTimes.size(), swap->fixedLeg().size());
+
+        RandomVariable result = lgm.swapRate(schedule, t, d.x);
+        RandomVariable fixing = lgm.fixing(index, fixingDate, t, d.x);
+        for (Size k = 0; k < d.x.size(); ++k) {
+            BOOST_CHECK_CLOSE(result[k], expected[k], 1E-10);
+            BOOST_CHECK_CLOSE(fixing[k], expected[k], 1E-10);
+        }
+
+        // deterministic state
+        RandomVariable x0(d.x.size(), 0.02);
+        RandomVariable result0 = lgm.swapRate(schedule, t, x0);
+        BOOST_CHECK(result0.deterministic());
+        BOOST_CHECK_CLOSE(result0[0], result[3], 1E-12);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,8 @@
 #include <qle/models/lgm.hpp>
 #include <qle/pricingengines/numericlgmmultilegoptionengine.hpp>
 
+#include <qle/math/regressionfactorisationcache.hpp>
+#include <qle/methods/mcpathstore.hpp>
 #include <qle/pricingengines/mclgmswaptionengine.hpp>
 
 #include <ql/currencies/europe.hpp>
@@ -164,6 +166,159 @@ BOOST_AUTO_TEST_CASE(testAgainstSwaptionEngines) {
     BOOST_CHECK_SMALL(std::fabs(npvGsr - npvLgmMc), tol);
 } // testAgainstSwaptionEngines
 
+BOOST_AUTO_TEST_CASE(testSharedRegressionFactorisations) {
+
+    BOOST_TEST_MESSAGE("Testing MC LGM Bermudan swaption engine with shared regression factorisations...");
+
+    Calendar cal = TARGET();
+    Date evalDate(5, February, 2016);
+    Date startDate(cal.advance(cal.advance(evalDate, 2 * Days), 1 * Years));
+    Date maturityDate(cal.advance(startDate, 9 * Years));
+
+    Settings::instance().evaluationDate() = evalDate;
+
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(evalDate, 0.02, Actual365Fixed()));
+    QuantLib::ext::shared_ptr<IborIndex> euribor6m(QuantLib::ext::make_shared<Euribor>(6 * Months, yts));
+    Schedule fixedSchedule(startDate, maturityDate, 1 * Years, cal, ModifiedFollowing, ModifiedFollowing,
+                           DateGeneration::Forward, false);
+    Schedule floatingSchedule(startDate, maturityDate, 6 * Months, cal, ModifiedFollowing, ModifiedFollowing,
+                              DateGeneration::Forward, false);
+
+    std::vector<Date> exerciseDates;
+    for (Size i = 0; i < 9; ++i) {
+        exerciseDates.push_back(cal.advance(fixedSchedule[i], -2 * Days));
+    }
+    QuantLib::ext::shared_ptr<Exercise> exercise = QuantLib::ext::make_shared<BermudanExercise>(exerciseDates, false);
+
+    // two bermudan swaptions with the same exercise structure, but different strikes
+    std::vector<QuantLib::ext::shared_ptr<Swaption>> swaptions;
+    for (Real fixedRate : {0.02, 0.03}) {
+        auto undlSwap = QuantLib::ext::make_shared<VanillaSwap>(VanillaSwap::Payer, 1.0, fixedSchedule, fixedRate,
+                                                                Thirty360(Thirty360::BondBasis), floatingSchedule,
+                                                                euribor6m, 0.0, Actual360());
+        swaptions.push_back(QuantLib::ext::make_shared<Swaption>(undlSwap, exercise));
+    }
+
+    auto lgmParam = QuantLib::ext::make_shared<IrLgm1fPiecewiseConstantHullWhiteAdaptor>(
+        EURCurrency(), yts, Array(1, 1.0), Array(2, 0.0070), Array(1, 1.0), Array(2, 0.03));
+    auto lgm = QuantLib::ext::make_shared<LinearGaussMarkovModel>(lgmParam);
+
+    auto engine = [&lgm](const bool share) {
+        return QuantLib::ext::make_shared<McLgmSwaptionEngine>(
+            lgm, MersenneTwisterAntithetic, SobolBrownianBridge, 5000, 0, 42, 43, 4, LsmBasisSystem::Monomial,
+            SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7, Handle<YieldTermStructure>(), std::vector<Date>(),
+            std::vector<Size>(), true, McMultiLegBaseEngine::Simple, Null<Real>(), share);
+    };
+
+    RegressionFactorisationCache::instance().clear();
+
+    std::vector<Real> npvs, npvsShared;
+    std::vector<Size> hits;
+    for (auto const& s : swaptions) {
+        s->setPricingEngine(engine(false));
+        npvs.push_back(s->NPV());
+    }
+    BOOST_CHECK(RegressionFactorisationCache::instance().size() == 0);
+
+    for (auto const& s : swaptions) {
+        s->setPricingEngine(engine(true));
+        npvsShared.push_back(s->NPV());
+        hits.push_back(RegressionFactorisationCache::instance().hits());
+    }
+
+    for (Size i = 0; i < swaptions.size(); ++i) {
+        BOOST_TEST_MESSAGE("swaption #" << i << ": npv = " << npvs[i] << ", npv (shared) = " << npvsShared[i]
+                                        << ", cache hits = " << hits[i]);
+        BOOST_CHECK_CLOSE(npvs[i], npvsShared[i], 1E-8);
+    }
+
+    // the second swaption reuses the factorisations of the first one on each exercise date
+    BOOST_CHECK_GE(hits[1] - hits[0], exerciseDates.size());
+
+    RegressionFactorisationCache::instance().clear();
+} // testSharedRegressionFactorisations
+
+BOOST_AUTO_TEST_CASE(testPathStore) {
+
+    BOOST_TEST_MESSAGE("Testing MC LGM Bermudan swaption engine with shared calibration paths...");
+
+    Calendar cal = TARGET();
+    Date evalDate(5, February, 2016);
+    Date startDate(cal.advance(cal.advance(evalDate, 2 * Days), 1 * Years));
+
+    Settings::instance().evaluationDate() = evalDate;
+
+    Handle<YieldTermStructure> yts(QuantLib::ext::make_shared<FlatForward>(evalDate, 0.02, Actual365Fixed()));
+    QuantLib::ext::shared_ptr<IborIndex> euribor6m(QuantLib::ext::make_shared<Euribor>(6 * Months, yts));
+
+    // a 10y bermudan, a second one with a different strike and a 5y bermudan with the same start date
+    auto makeSwaption = [&](const Size years, const Real fixedRate) {
+        Date maturityDate(cal.advance(startDate, years * Years));
+        Schedule fixedSchedule(startDate, maturityDate, 1 * Years, cal, ModifiedFollowing, ModifiedFollowing,
+                               DateGeneration::Forward, false);
+        Schedule floatingSchedule(startDate, maturityDate, 6 * Months, cal, ModifiedFollowing, ModifiedFollowing,
+                                  DateGeneration::Forward, false);
+        std::vector<Date> exerciseDates;
+        for (Size i = 0; i < years; ++i)
+            exerciseDates.push_back(cal.advance(fixedSchedule[i], -2 * Days));
+        auto undlSwap = QuantLib::ext::make_shared<VanillaSwap>(VanillaSwap::Payer, 1.0, fixedSchedule, fixedRate,
+                                                                Thirty360(Thirty360::BondBasis), floatingSchedule,
+                                                                euribor6m, 0.0, Actual360());
+        return QuantLib::ext::make_shared<Swaption>(undlSwap,
+                                                    QuantLib::ext::make_shared<BermudanExercise>(exerciseDates, false));
+    };
+    std::vector<QuantLib::ext::shared_ptr<Swaption>> swaptions = {makeSwaption(10, 0.02), makeSwaption(10, 0.03),
+                                                                  makeSwaption(5, 0.02)};
+
+    auto lgmParam = QuantLib::ext::make_shared<IrLgm1fPiecewiseConstantHullWhiteAdaptor>(
+        EURCurrency(), yts, Array(1, 1.0), Array(2, 0.0070), Array(1, 1.0), Array(2, 0.03));
+    auto lgm = QuantLib::ext::make_shared<LinearGaussMarkovModel>(lgmParam);
+
+    auto engine = [&lgm](const bool usePathStore) {
+        return QuantLib::ext::make_shared<McLgmSwaptionEngine>(
+            lgm, MersenneTwisterAntithetic, SobolBrownianBridge, 5000, 0, 42, 43, 4, LsmBasisSystem::Monomial,
+            SobolBrownianGenerator::Steps, SobolRsg::JoeKuoD7, Handle<YieldTermStructure>(), std::vector<Date>(),
+            std::vector<Size>(), true, McMultiLegBaseEngine::Simple, Null<Real>(), false, usePathStore);
+    };
+
+    McPathStore::instance().clear();
+
+    std::vector<Real> npvs, npvsStored;
+    auto engineNoStore = engine(false);
+    for (auto const& s : swaptions) {
+        s->setPricingEngine(engineNoStore);
+        npvs.push_back(s->NPV());
+    }
+    BOOST_CHECK(McPathStore::instance().size() == 0);
+
+    // all swaptions are priced by the same engine and therefore on the same model instance
+    auto engineStore = engine(true);
+    std::vector<Size> hits;
+    for (auto const& s : swaptions) {
+        s->setPricingEngine(engineStore);
+        npvsStored.push_back(s->NPV());
+        hits.push_back(McPathStore::instance().hits());
+    }
+
+    for (Size i = 0; i < swaptions.size(); ++i) {
+        BOOST_TEST_MESSAGE("swaption #" << i << ": npv = " << npvs[i] << ", npv (path store) = " << npvsStored[i]
+                                        << ", path store hits = " << hits[i]);
+    }
+
+    // the first swaption simulates the paths on its own times, the others reuse them
+    BOOST_CHECK_EQUAL(McPathStore::instance().size(), 1u);
+    BOOST_CHECK_EQUAL(hits[0], 0u);
+    BOOST_CHECK_EQUAL(hits[1], 1u);
+    BOOST_CHECK_EQUAL(hits[2], 2u);
+    BOOST_CHECK_CLOSE(npvs[0], npvsStored[0], 1E-8);
+    BOOST_CHECK_CLOSE(npvs[1], npvsStored[1], 1E-8);
+
+    // the 5y swaption uses other paths on its simulation times, so the result is only close within the mc error
+    BOOST_CHECK_SMALL(npvs[2] - npvsStored[2], 5E-4);
+
+    McPathStore::instance().clear();
+} // testPathStore
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
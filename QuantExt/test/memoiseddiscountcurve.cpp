@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+#include <ql/quotes/simplequote.hpp>
+#include <ql/settings.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/nullcalendar.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+#include <qle/termstructures/memoiseddiscountcurve.hpp>
+
+using QuantExt::MemoisedDiscountCurve;
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(MemoisedDiscountCurveTest)
+
+BOOST_AUTO_TEST_CASE(testMemoisedDiscounts) {
+
+    BOOST_TEST_MESSAGE("Testing memoised discount curve against underlying curve");
+
+    SavedSettings backup;
+
+    Date today(15, Aug, 2018);
+    Settings::instance().evaluationDate() = today;
+
+    auto rate = QuantLib::ext::make_shared<SimpleQuote>(0.02);
+    Handle<YieldTermStructure> underlying(
+        QuantLib::ext::make_shared<FlatForward>(0, NullCalendar(), Handle<Quote>(rate), Actual365Fixed()));
+
+    MemoisedDiscountCurve curve(underlying);
+    BOOST_CHECK_EQUAL(curve.referenceDate(), underlying->referenceDate());
+
+    // repeated requests are served from the memoised values
+    for (Size k = 0; k < 2; ++k) {
+        for (Size i = 1; i <= 10; ++i) {
+            Date d = today + i * Years;
+            BOOST_CHECK_EQUAL(curve.discount(d), underlying->discount(d));
+        }
+    }
+    BOOST_CHECK_EQUAL(curve.size(), Size(10));
+
+    // a change of the underlying curve clears the memoised values
+    rate->setValue(0.03);
+    BOOST_CHECK_EQUAL(curve.size(), Size(0));
+    for (Size i = 1; i <= 10; ++i) {
+        Date d = today + i * Years;
+        BOOST_CHECK_EQUAL(curve.discount(d), underlying->discount(d));
+    }
+
+    // a change of the evaluation date moves the reference date of the underlying curve
+    Settings::instance().evaluationDate() = today + 1;
+    BOOST_CHECK_EQUAL(curve.referenceDate(), underlying->referenceDate());
+    BOOST_CHECK_EQUAL(curve.discount(today + 5 * Years), underlying->discount(today + 5 * Years));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
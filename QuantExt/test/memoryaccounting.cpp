@@ -0,0 +1,102 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_pool.hpp>
+#include <qle/utilities/memoryaccounting.hpp>
+
+#include <thread>
+
+using namespace QuantExt;
+
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(MemoryAccountingTest)
+
+BOOST_AUTO_TEST_CASE(testStages) {
+
+    BOOST_TEST_MESSAGE("Testing memory accounting stages...");
+
+    using C = MemoryAccounting::Category;
+    auto& m = MemoryAccounting::instance();
+    std::size_t cube0 = m.current(C::Cube), report0 = m.current(C::Report), total0 = m.total();
+    m.reset();
+
+    {
+        MemoryStage outer("outer");
+        AccountedMemory a(C::Cube, 100);
+        {
+            MemoryStage inner("inner");
+            AccountedMemory b(C::Report, 50);
+            AccountedMemory c = b;
+            std::thread t([]() { AccountedMemory d(C::Cube, 7); });
+            t.join();
+        }
+        AccountedMemory e(C::Report, 10);
+        AccountedMemory f(std::move(e));
+        f.resize(20);
+        BOOST_CHECK_EQUAL(m.current(C::Report), report0 + 20);
+    }
+
+    BOOST_CHECK_EQUAL(m.total(), total0);
+    auto stages = m.stages();
+    BOOST_REQUIRE_EQUAL(stages.size(), 2u);
+
+    auto cube = static_cast<std::size_t>(C::Cube), report = static_cast<std::size_t>(C::Report);
+    BOOST_CHECK_EQUAL(stages[0].name, "inner");
+    BOOST_CHECK_EQUAL(stages[0].peak[cube], cube0 + 107);
+    BOOST_CHECK_EQUAL(stages[0].peak[report], report0 + 100);
+    BOOST_CHECK_EQUAL(stages[0].current[cube], cube0 + 100);
+    BOOST_CHECK_EQUAL(stages[0].current[report], report0);
+    BOOST_CHECK_EQUAL(stages[0].totalPeak, total0 + 207);
+
+    BOOST_CHECK_EQUAL(stages[1].name, "outer");
+    BOOST_CHECK_EQUAL(stages[1].peak[cube], cube0 + 107);
+    BOOST_CHECK_EQUAL(stages[1].peak[report], report0 + 100);
+    BOOST_CHECK_EQUAL(stages[1].current[cube], cube0);
+    BOOST_CHECK_EQUAL(stages[1].totalPeak, total0 + 207);
+
+    m.reset();
+    BOOST_CHECK(m.stages().empty());
+    BOOST_CHECK_EQUAL(m.totalPeak(), m.total());
+}
+
+BOOST_AUTO_TEST_CASE(testRandomVariableMemory) {
+
+    BOOST_TEST_MESSAGE("Testing memory accounting of random variables...");
+
+    auto& m = MemoryAccounting::instance();
+    std::size_t before = m.current(MemoryAccounting::Category::RandomVariable);
+    {
+        RandomVariable x(1000, 1.0);
+        x.expand();
+        BOOST_CHECK_GE(m.current(MemoryAccounting::Category::RandomVariable), before + 1000 * sizeof(double));
+    }
+    // the buffer is pooled or freed, in both cases it is still accounted resp. released
+    RandomVariablePool::instance().clear();
+    BOOST_CHECK_LE(m.current(MemoryAccounting::Category::RandomVariable), before);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -881,6 +881,67 @@ BOOST_AUTO_TEST_CASE(testNormalToLognormalWithPositiveForwards) {
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(testRestrippingAfterMarketChange) {
+    BOOST_TEST_MESSAGE("Testing that re-stripping after a market change matches a fresh stripping...");
+
+    CommonVars vars;
+
+    // EUR cap floor shifted lognormal volatility surface on quotes
+    vector<vector<QuantLib::ext::shared_ptr<SimpleQuote> > > volQuotes(vars.vols.tenors.size());
+    vector<vector<Handle<Quote> > > volHandles(vars.vols.tenors.size());
+    for (Size i = 0; i < vars.vols.tenors.size(); ++i) {
+        for (Size j = 0; j < vars.vols.strikes.size(); ++j) {
+            volQuotes[i].push_back(QuantLib::ext::make_shared<SimpleQuote>(vars.vols.slnVols_1[i][j]));
+            volHandles[i].push_back(Handle<Quote>(volQuotes[i].back()));
+        }
+    }
+    QuantLib::ext::shared_ptr<QuantExt::CapFloorTermVolSurface> volSurface =
+        QuantLib::ext::make_shared<QuantExt::CapFloorTermVolSurfaceExact>(
+            vars.settlementDays, vars.calendar, vars.bdc, vars.vols.tenors, vars.vols.strikes, volHandles,
+            vars.dayCounter);
+
+    // Link ibor index to spreaded forward curve
+    QuantLib::ext::shared_ptr<SimpleQuote> spread = QuantLib::ext::make_shared<SimpleQuote>(0.0);
+    Handle<YieldTermStructure> spreadedForward(
+        QuantLib::ext::make_shared<ZeroSpreadedTermStructure>(vars.yieldCurves.forward6M, Handle<Quote>(spread)));
+    QuantLib::ext::shared_ptr<IborIndex> iborIndex = vars.iborIndex->clone(spreadedForward);
+
+    auto makeStripper = [&]() {
+        return QuantLib::ext::make_shared<OptionletStripper1>(volSurface, iborIndex, Null<Rate>(), vars.accuracy,
+                                                              vars.maxIter, vars.yieldCurves.discountEonia,
+                                                              ShiftedLognormal, vars.vols.shift_1);
+    };
+    QuantLib::ext::shared_ptr<OptionletStripper1> stripper = makeStripper();
+
+    auto check = [&](const std::string& label) {
+        QuantLib::ext::shared_ptr<OptionletStripper1> fresh = makeStripper();
+        for (Size i = 0; i < stripper->optionletFixingTimes().size(); ++i) {
+            for (Size j = 0; j < vars.vols.strikes.size(); ++j) {
+                Real v = stripper->optionletVolatilities(i)[j];
+                Real expected = fresh->optionletVolatilities(i)[j];
+                BOOST_CHECK_MESSAGE(std::fabs(v - expected) < 1.0E-12, label << ": optionlet vol (" << i << "," << j
+                                                                             << ") is " << v << ", expected "
+                                                                             << expected);
+            }
+        }
+    };
+
+    check("initial");
+
+    // change a single term vol
+    volQuotes[2][3]->setValue(volQuotes[2][3]->value() + 0.01);
+    check("term vol change");
+
+    // change the forward curve
+    spread->setValue(0.001);
+    check("curve change");
+
+    // change the evaluation date
+    Settings::instance().evaluationDate() = vars.referenceDate + 3;
+    check("evaluation date change");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
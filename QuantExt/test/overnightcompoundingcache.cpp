@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <qle/cashflows/averageonindexedcoupon.hpp>
+#include <qle/cashflows/averageonindexedcouponpricer.hpp>
+#include <qle/cashflows/overnightcompoundingcache.hpp>
+#include <qle/cashflows/overnightindexedcoupon.hpp>
+
+#include <ql/indexes/ibor/estr.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+using namespace boost::unit_test_framework;
+
+namespace {
+
+struct TestData {
+    TestData() : today(15, May, 2024) {
+        Settings::instance().evaluationDate() = today;
+        curve = Handle<YieldTermStructure>(QuantLib::ext::make_shared<FlatForward>(today, 0.03, Actual365Fixed()));
+        index = QuantLib::ext::make_shared<Estr>(curve);
+        Size k = 0;
+        for (Date d = today - 2 * Years; d < today; ++d) {
+            if (index->isValidFixingDate(d))
+                index->addFixing(d, 0.03 + 0.0001 * std::sin(0.1 * static_cast<Real>(k++)));
+        }
+    }
+
+    // rates of freshly built coupons, since the coupons cache their rates
+    Real overnightRate(const Period& lookback, const Natural rateCutoff) const {
+        OvernightIndexedCoupon cpn(today + 6 * Months, 1.0, today - 9 * Months, today + 3 * Months, index, 1.0, 0.001,
+                                   Date(), Date(), Actual360(), false, false, lookback, rateCutoff);
+        return cpn.rate();
+    }
+    Real averageRate(const Period& lookback, const Natural rateCutoff) const {
+        AverageONIndexedCoupon cpn(today + 6 * Months, 1.0, today - 9 * Months, today + 3 * Months, index, 1.0, 0.001,
+                                   rateCutoff, Actual360(), lookback);
+        cpn.setPricer(QuantLib::ext::make_shared<AverageONIndexedCouponPricer>());
+        return cpn.rate();
+    }
+
+    Date today;
+    Handle<YieldTermStructure> curve;
+    QuantLib::ext::shared_ptr<OvernightIndex> index;
+};
+
+void checkRates(const TestData& d) {
+    for (auto const& lookback : {0 * Days, 2 * Days}) {
+        for (Natural rateCutoff : {0, 2}) {
+            OvernightCompoundingCache::instance().enable(false);
+            Real expectedOn = d.overnightRate(lookback, rateCutoff);
+            Real expectedAvg = d.averageRate(lookback, rateCutoff);
+            OvernightCompoundingCache::instance().enable(true);
+            // the second evaluation reads the cached values
+            for (Size i = 0; i < 2; ++i) {
+                BOOST_CHECK_SMALL(d.overnightRate(lookback, rateCutoff) - expectedOn, 1E-14);
+                BOOST_CHECK_SMALL(d.averageRate(lookback, rateCutoff) - expectedAvg, 1E-14);
+            }
+        }
+    }
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(OvernightCompoundingCacheTest)
+
+BOOST_AUTO_TEST_CASE(testCachedCompounding) {
+
+    BOOST_TEST_MESSAGE("Testing compounding of past overnight fixings via the OvernightCompoundingCache...");
+
+    TestData d;
+    checkRates(d);
+
+    // a changed fixing is picked up by the cache
+    BOOST_TEST_MESSAGE("Testing OvernightCompoundingCache after a change of a past fixing...");
+    Date fixingDate = d.index->fixingCalendar().adjust(d.today - 3 * Months);
+    Real before = d.overnightRate(0 * Days, 0);
+    d.index->addFixing(fixingDate, 0.05, true);
+    BOOST_CHECK(std::abs(d.overnightRate(0 * Days, 0) - before) > 1E-6);
+    checkRates(d);
+
+    // a missing fixing gives the same error as without the cache
+    IndexManager::instance().clearHistory(d.index->name());
+    BOOST_CHECK_THROW(d.overnightRate(0 * Days, 0), QuantLib::Error);
+    OvernightCompoundingCache::instance().clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -24,12 +24,17 @@
 // clang-format on
 
 #include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/randomvariable_pool.hpp>
+#include <qle/math/randomvariablelsmbasissystem.hpp>
 
 #include <ql/time/date.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
 #include <ql/pricingengines/blackformula.hpp>
 
 #include <boost/math/distributions/normal.hpp>
 
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 
@@ -192,6 +197,201 @@ BOOST_AUTO_TEST_CASE(testBlack) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testPool) {
+    BOOST_TEST_MESSAGE("Testing random variable data pool...");
+
+    auto& pool = RandomVariablePool::instance();
+    pool.clear();
+    pool.resetStats();
+
+    constexpr Size n = 1000;
+    RandomVariable x(n, 1.0), y(n, 2.0);
+
+    // the first expansion allocates a fresh buffer
+    x.expand();
+    BOOST_CHECK_EQUAL(pool.stats().freshAllocations, 1);
+    BOOST_CHECK_EQUAL(pool.stats().poolAllocations, 0);
+
+    // releasing it returns the buffer to the pool, the next allocation of the same size is served from the pool
+    double* p = x.data();
+    x.setAll(1.0);
+    BOOST_CHECK_EQUAL(pool.stats().pooledReleases, 1);
+    BOOST_CHECK_EQUAL(pool.stats().pooledBytes, n * sizeof(double));
+    y.expand();
+    BOOST_CHECK_EQUAL(y.data(), p);
+    BOOST_CHECK_EQUAL(pool.stats().poolAllocations, 1);
+    BOOST_CHECK_EQUAL(pool.stats().pooledBytes, 0);
+    BOOST_CHECK_EQUAL(y.at(0), 2.0);
+
+    // a different size is a different size class
+    RandomVariable z(n + 1, 3.0);
+    y.clear();
+    z.expand();
+    BOOST_CHECK_EQUAL(pool.stats().freshAllocations, 2);
+    BOOST_CHECK(z.data() != p);
+    BOOST_CHECK_EQUAL(z.at(n), 3.0);
+
+    // the deleter returns the buffer to the pool as well
+    RandomVariable::deleter(z);
+    BOOST_CHECK_EQUAL(pool.stats().pooledReleases, 3);
+    BOOST_CHECK_EQUAL(pool.stats().pooledBytes, (2 * n + 1) * sizeof(double));
+    BOOST_CHECK_EQUAL(pool.stats().peakPooledBytes, (2 * n + 1) * sizeof(double));
+
+    // a pool bound of zero frees all buffers and disables the pooling
+    std::size_t maxPooledBytes = pool.maxPooledBytes();
+    pool.setMaxPooledBytes(0);
+    BOOST_CHECK_EQUAL(pool.stats().pooledBytes, 0);
+    RandomVariable w(n, 4.0);
+    w.expand();
+    w.clear();
+    BOOST_CHECK_EQUAL(pool.stats().freshAllocations, 3);
+    BOOST_CHECK_EQUAL(pool.stats().freedReleases, 1);
+    BOOST_CHECK_EQUAL(pool.stats().pooledBytes, 0);
+
+    pool.setMaxPooledBytes(maxPooledBytes);
+    pool.resetStats();
+}
+
+BOOST_AUTO_TEST_CASE(testRegressionMethods) {
+
+    BOOST_TEST_MESSAGE("Testing regression methods and batched regression...");
+
+    // the sample size is not a multiple of the block size used for the normal equations
+    Size n = 5000;
+    MersenneTwisterUniformRng mt(42);
+    RandomVariable x1(n), x2(n), y1(n), y2(n);
+    Filter f(n);
+    for (Size i = 0; i < n; ++i) {
+        x1.set(i, 2.0 * mt.nextReal() - 1.0);
+        x2.set(i, 2.0 * mt.nextReal() - 1.0);
+        y1.set(i, std::exp(x1[i]) + x1[i] * x2[i] + 0.1 * mt.nextReal());
+        y2.set(i, x2[i] * x2[i] - x1[i] + 0.1 * mt.nextReal());
+        f.set(i, x1[i] > -0.8);
+    }
+    RandomVariable y3(n, 2.0);
+
+    auto basisFn = RandomVariableLsmBasisSystem::multiPathBasisSystem(2, 3, QuantLib::LsmBasisSystem::Monomial);
+    std::vector<const RandomVariable*> regressor = {&x1, &x2};
+    std::vector<RandomVariable> regressand = {y1, y2, y3};
+
+    for (auto const& filter : {Filter(), f}) {
+        std::vector<Array> refCoeff;
+        for (auto const& y : regressand)
+            refCoeff.push_back(
+                regressionCoefficients(y, regressor, basisFn, filter, RandomVariableRegressionMethod::QR));
+        for (auto method : {RandomVariableRegressionMethod::QR, RandomVariableRegressionMethod::SVD,
+                            RandomVariableRegressionMethod::NormalEquations}) {
+            auto coeff = regressionCoefficients(regressand, regressor, basisFn, filter, method);
+            BOOST_REQUIRE_EQUAL(coeff.size(), regressand.size());
+            for (Size k = 0; k < regressand.size(); ++k) {
+                BOOST_REQUIRE_EQUAL(coeff[k].size(), basisFn.size());
+                auto single = regressionCoefficients(regressand[k], regressor, basisFn, filter, method);
+                for (Size j = 0; j < basisFn.size(); ++j) {
+                    BOOST_CHECK_SMALL(coeff[k][j] - single[j], 1E-12);
+                    BOOST_CHECK_SMALL(coeff[k][j] - refCoeff[k][j], 1E-8);
+                }
+            }
+        }
+    }
+
+    auto basisValues =
+        RandomVariableLsmBasisSystem::multiPathBasisSystemValues(regressor, 3, QuantLib::LsmBasisSystem::Monomial);
+    for (auto const& filter : {Filter(), f}) {
+        auto coeff = regressionCoefficients(y1, regressor, basisFn, filter);
+        auto coeffFromValues = regressionCoefficients(y1, basisValues, filter);
+        BOOST_REQUIRE_EQUAL(coeffFromValues.size(), coeff.size());
+        for (Size j = 0; j < coeff.size(); ++j)
+            BOOST_CHECK_SMALL(coeffFromValues[j] - coeff[j], 1E-12);
+        auto ce = conditionalExpectation(regressor, basisFn, coeff);
+        auto ceFromValues = conditionalExpectation(basisValues, coeff);
+        for (Size i = 0; i < n; ++i)
+            BOOST_CHECK_SMALL(ceFromValues[i] - ce[i], 1E-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testKernels) {
+    BOOST_TEST_MESSAGE("Testing random variable kernels...");
+
+    BOOST_CHECK_EQUAL(RandomVariableKernels::instance().selectedKernels(), "Scalar");
+    BOOST_CHECK_THROW(RandomVariableKernels::instance().selectKernels("Foo"), QuantLib::Error);
+
+    // the size is not a multiple of the vector width to cover the tail handling
+    constexpr Size n = 1003;
+    RandomVariable x(n), y(n), c(n);
+    Filter f(n, false);
+    for (Size i = 0; i < n; ++i) {
+        x.set(i, -40.0 + 80.0 * static_cast<Real>(i) / static_cast<Real>(n - 1));
+        y.set(i, 0.5 + std::sin(static_cast<Real>(i)));
+        c.set(i, 1E-5 + 1E4 * static_cast<Real>(i) / static_cast<Real>(n - 1));
+        f.set(i, i % 3 == 0);
+    }
+
+    auto arithmetic = [&x, &y, &f]() {
+        RandomVariable two(n, 2.0);
+        return std::vector<RandomVariable>{x + y,
+                                           x - y,
+                                           x * y,
+                                           x / y,
+                                           x + two,
+                                           x - two,
+                                           x * two,
+                                           x / two,
+                                           max(x, y),
+                                           min(x, y),
+                                           max(x, two),
+                                           min(x, two),
+                                           -x,
+                                           abs(x),
+                                           sqrt(abs(x)),
+                                           conditionalResult(f, x, y),
+                                           conditionalResult(f, x, two)};
+    };
+
+    auto functions = [&x, &c]() {
+        return std::vector<RandomVariable>{exp(x * RandomVariable(n, 20.0)), log(c), normalCdf(x), normalPdf(x)};
+    };
+
+    std::vector<RandomVariable> refArithmetic = arithmetic(), refFunctions = functions();
+
+    // documented accuracy of exp, log, normalCdf, normalPdf
+    std::vector<Real> relTol = {3E-16, 5E-16, 2E-14, 5E-16};
+
+    for (auto const& k : RandomVariableKernels::instance().getAvailableKernels()) {
+        BOOST_TEST_MESSAGE("checking kernels " << k);
+        RandomVariableKernels::instance().selectKernels(k);
+        BOOST_CHECK_EQUAL(RandomVariableKernels::instance().selectedKernels(), k);
+        auto resArithmetic = arithmetic();
+        for (Size j = 0; j < resArithmetic.size(); ++j) {
+            for (Size i = 0; i < n; ++i) {
+                BOOST_CHECK_MESSAGE(resArithmetic[j][i] == refArithmetic[j][i],
+                                    "kernels '" << k << "', arithmetic op #" << j << ", element #" << i << ": "
+                                                << resArithmetic[j][i] << " vs. scalar " << refArithmetic[j][i]);
+            }
+        }
+        auto resFunctions = functions();
+        for (Size j = 0; j < resFunctions.size(); ++j) {
+            for (Size i = 0; i < n; ++i) {
+                Real ref = refFunctions[j][i], res = resFunctions[j][i];
+                // values at risk of underflow are only checked in absolute terms
+                Real err = 0.0;
+                if (res != ref)
+                    err = std::abs(ref) > 1E-300 ? std::abs(res / ref - 1.0) : std::abs(res - ref);
+                BOOST_CHECK_MESSAGE(err < relTol[j], "kernels '" << k << "', function #" << j << ", element #" << i
+                                                                 << ": " << std::setprecision(17) << res
+                                                                 << " vs. scalar " << ref << ", error " << err);
+            }
+        }
+    }
+
+    RandomVariableKernels::instance().selectKernels("Auto");
+    BOOST_CHECK_EQUAL(RandomVariableKernels::instance().getAvailableKernels().count(
+                          RandomVariableKernels::instance().selectedKernels()),
+                      1);
+
+    RandomVariableKernels::instance().reset();
+    BOOST_CHECK_EQUAL(RandomVariableKernels::instance().selectedKernels(), "Scalar");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -43,6 +43,34 @@ BOOST_AUTO_TEST_CASE(testBasisSystem1d) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testBasisSystemValues) {
+
+    BOOST_TEST_MESSAGE("Testing incremental evaluation of multi path lsm basis systems...");
+
+    constexpr Size n = 10;
+    for (auto type : {QuantLib::LsmBasisSystem::PolynomialType::Monomial,
+                      QuantLib::LsmBasisSystem::PolynomialType::Legendre}) {
+        for (Size dim = 1; dim <= 4; ++dim) {
+            std::vector<RandomVariable> x(dim, RandomVariable(n));
+            for (Size k = 0; k < dim; ++k)
+                for (Size i = 0; i < n; ++i)
+                    x[k].set(i, std::sin(static_cast<double>(7 * k + i + 1)));
+            auto regressor = vec2vecptr(x);
+            for (Size order = 1; order <= 4; ++order) {
+                auto basisFn = RandomVariableLsmBasisSystem::multiPathBasisSystem(dim, order, type);
+                auto values = RandomVariableLsmBasisSystem::multiPathBasisSystemValues(regressor, order, type);
+                BOOST_REQUIRE_EQUAL(values.size(), basisFn.size());
+                for (Size j = 0; j < basisFn.size(); ++j) {
+                    auto ref = basisFn[j](regressor);
+                    for (Size i = 0; i < n; ++i) {
+                        BOOST_CHECK_SMALL(values[j][i] - ref[i], 1E-14);
+                    }
+                }
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
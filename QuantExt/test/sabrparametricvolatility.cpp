@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+
+#include <qle/models/kienitzlawsonswaynesabrpdedensity.hpp>
+#include <qle/termstructures/sabrparametricvolatility.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace QuantExt;
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(SabrParametricVolatilityTest)
+
+namespace {
+QuantLib::ext::shared_ptr<SabrParametricVolatility> pdeSabr(const Real tolerance) {
+    // fixed parameters, so that no calibration is run
+    std::vector<ParametricVolatility::MarketSmile> smiles;
+    std::map<std::pair<Real, Real>, std::vector<std::pair<Real, bool>>> params;
+    for (Real t : {1.0, 5.0}) {
+        smiles.push_back({t, 10.0, 0.03, 0.01, {}, {0.02, 0.03, 0.04}, {0.005, 0.005, 0.005}});
+        params[std::make_pair(t, 10.0)] = {{0.05, true}, {0.5, true}, {0.3, true}, {-0.2, true}};
+    }
+    return QuantLib::ext::make_shared<SabrParametricVolatility>(
+        SabrParametricVolatility::ModelVariant::KienitzLawsonSwaynePde, smiles,
+        ParametricVolatility::MarketModelType::Black76, ParametricVolatility::MarketQuoteType::NormalVolatility,
+        Handle<YieldTermStructure>(), params, 10, 0.005, 0.05, tolerance);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testPdeDensityCache) {
+
+    BOOST_TEST_MESSAGE("Testing PDE density cache in SabrParametricVolatility...");
+
+    auto sabr = pdeSabr(0.0);
+    std::vector<Real> strikes = {0.03, 0.035, 0.04, 0.05};
+
+    // the density is built once per expiry and forward and then reused for all (otm call) strikes
+    std::vector<Real> prices;
+    for (auto k : strikes)
+        prices.push_back(
+            sabr->evaluate(5.0, 10.0, k, 0.03, ParametricVolatility::MarketQuoteType::Price, 0.01, Option::Call));
+    BOOST_CHECK_EQUAL(sabr->pdeDensityCacheMisses(), 1U);
+    BOOST_CHECK_EQUAL(sabr->pdeDensityCacheHits(), strikes.size() - 1);
+
+    KienitzLawsonSwayneSabrPdeDensity pde(0.05, 0.5, 0.3, -0.2, 0.03, 5.0, 0.01, 50, 121, 5.0);
+    std::vector<Real> expected = pde.callPrices(strikes);
+    for (Size i = 0; i < strikes.size(); ++i)
+        BOOST_CHECK_CLOSE(prices[i], expected[i], 1E-10);
+
+    // a different forward requires a new density
+    sabr->evaluate(5.0, 10.0, 0.03, 0.0301, ParametricVolatility::MarketQuoteType::Price, 0.01, Option::Call);
+    BOOST_CHECK_EQUAL(sabr->pdeDensityCacheMisses(), 2U);
+
+    // ... unless it is within the reuse tolerance
+    auto sabrTol = pdeSabr(1E-2);
+    sabrTol->evaluate(5.0, 10.0, 0.03, 0.03, ParametricVolatility::MarketQuoteType::Price, 0.01, Option::Call);
+    sabrTol->evaluate(5.0, 10.0, 0.03, 0.0301, ParametricVolatility::MarketQuoteType::Price, 0.01, Option::Call);
+    BOOST_CHECK_EQUAL(sabrTol->pdeDensityCacheMisses(), 1U);
+    BOOST_CHECK_EQUAL(sabrTol->pdeDensityCacheHits(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(testPdeDensityPrecomputation) {
+
+    BOOST_TEST_MESSAGE("Testing batched PDE density precomputation in SabrParametricVolatility...");
+
+    auto sabr = pdeSabr(0.0);
+    auto reference = pdeSabr(0.0);
+    sabr->precomputePdeDensities({{1.0, 10.0, 0.03}, {5.0, 10.0, 0.03}}, 2);
+    BOOST_CHECK_EQUAL(sabr->pdeDensityCacheMisses(), 2U);
+
+    for (Real t : {1.0, 5.0}) {
+        for (Real k : {0.02, 0.03, 0.04}) {
+            BOOST_CHECK_CLOSE(
+                sabr->evaluate(t, 10.0, k, 0.03, ParametricVolatility::MarketQuoteType::NormalVolatility),
+                reference->evaluate(t, 10.0, k, 0.03, ParametricVolatility::MarketQuoteType::NormalVolatility),
+                1E-10);
+        }
+    }
+    BOOST_CHECK_EQUAL(sabr->pdeDensityCacheMisses(), 2U);
+    BOOST_CHECK_EQUAL(sabr->pdeDensityCacheHits(), 6U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
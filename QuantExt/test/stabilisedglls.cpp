@@ -1161,6 +1161,47 @@ BOOST_AUTO_TEST_CASE(test2DRegression) {
     BOOST_CHECK(true);
 }
 
+BOOST_AUTO_TEST_CASE(testMultipleRightHandSides) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::StabilisedMultiGLLS against QuantExt::StabilisedGLLS");
+
+    std::vector<Array> x;
+    std::vector<std::vector<Real> > y(3);
+
+    MersenneTwisterUniformRng mt(42);
+    for (Size n = 0; n < 1000; ++n) {
+        Array xa(2);
+        xa[0] = mt.nextReal() * 1000.0;
+        xa[1] = mt.nextReal() * 2000.0;
+        x.push_back(xa);
+        y[0].push_back(-4982.0 + xa[0] * 43.0 + xa[1] * 142.0 + xa[0] * xa[1] * 0.8 + mt.nextReal() * 1E4);
+        y[1].push_back(xa[0] * xa[0] * 0.02948 - xa[1] * xa[1] * 1533.0 + mt.nextReal() * 1E6);
+        y[2].push_back(std::sqrt(xa[0] + xa[1]));
+    }
+
+    std::vector<ext::function<Real(Array)> > basis =
+        LsmBasisSystem::multiPathBasisSystem(2, 2, LsmBasisSystem::Monomial);
+
+    Real tol = 1E-8;
+
+    for (auto method : {StabilisedGLLS::None, StabilisedGLLS::MaxAbs, StabilisedGLLS::MeanStdDev}) {
+        StabilisedMultiGLLS mm(x, y, basis, method);
+        BOOST_REQUIRE_EQUAL(mm.size(), y.size());
+        for (Size l = 0; l < y.size(); ++l) {
+            StabilisedGLLS m(x, y[l], basis, method);
+            BOOST_CHECK_CLOSE(mm.yMultiplier(l), m.yMultiplier(), tol);
+            BOOST_CHECK_CLOSE(mm.yShift(l), m.yShift(), tol);
+            for (Size k = 0; k < x.size(); k += 50) {
+                Real expected = m.eval(x[k], basis);
+                Real actual = mm.eval(l, x[k], basis);
+                if (std::abs(actual - expected) > tol * std::max(1.0, std::abs(expected)))
+                    BOOST_ERROR("could not verify eval(" << x[k] << ") for y data set #" << l << ", method " << method
+                                                         << ", got " << actual << ", expected " << expected);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <qle/math/tdigest.hpp>
+
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+#include <algorithm>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+using namespace boost::unit_test_framework;
+using std::vector;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(TDigestTest)
+
+namespace {
+// empirical rank of x in the sorted sample
+Real rank(const vector<Real>& sorted, const Real x) {
+    return static_cast<Real>(std::lower_bound(sorted.begin(), sorted.end(), x) - sorted.begin()) / sorted.size();
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testQuantilesAgainstSortedSample) {
+    BOOST_TEST_MESSAGE("Testing t-digest quantiles against the sorted sample");
+
+    MersenneTwisterUniformRng rng(42);
+    InverseCumulativeNormal icn;
+    Size n = 100000;
+    vector<Real> sample(n);
+    TDigest digest(100.0);
+    for (Size i = 0; i < n; ++i) {
+        sample[i] = std::exp(icn(rng.nextReal())) - 1.0;
+        digest.add(sample[i]);
+    }
+    std::sort(sample.begin(), sample.end());
+
+    BOOST_CHECK_EQUAL(digest.totalWeight(), static_cast<Real>(n));
+    BOOST_CHECK_EQUAL(digest.quantile(0.0), sample.front());
+    BOOST_CHECK_EQUAL(digest.quantile(1.0), sample.back());
+    BOOST_CHECK(digest.size() <= 200);
+
+    for (Real q : {0.001, 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99, 0.999}) {
+        Real r = rank(sample, digest.quantile(q));
+        BOOST_TEST_MESSAGE("q = " << q << ", rank of estimate = " << r);
+        BOOST_CHECK_SMALL(r - q, 0.005);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMerge) {
+    BOOST_TEST_MESSAGE("Testing merge of t-digests");
+
+    MersenneTwisterUniformRng rng(42);
+    Size n = 50000;
+    vector<Real> sample(2 * n);
+    TDigest digest1(200.0), digest2(200.0);
+    for (Size i = 0; i < 2 * n; ++i) {
+        sample[i] = rng.nextReal() * (i < n ? 1.0 : 3.0);
+        (i < n ? digest1 : digest2).add(sample[i]);
+    }
+    digest1.merge(digest2);
+    std::sort(sample.begin(), sample.end());
+
+    BOOST_CHECK_EQUAL(digest1.totalWeight(), static_cast<Real>(2 * n));
+    BOOST_CHECK_EQUAL(digest1.quantile(0.0), sample.front());
+    BOOST_CHECK_EQUAL(digest1.quantile(1.0), sample.back());
+    for (Real q : {0.01, 0.1, 0.5, 0.7, 0.9, 0.99}) {
+        Real r = rank(sample, digest1.quantile(q));
+        BOOST_TEST_MESSAGE("q = " << q << ", rank of estimate = " << r);
+        BOOST_CHECK_SMALL(r - q, 0.005);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSmallSamples) {
+    BOOST_TEST_MESSAGE("Testing t-digest with few values");
+
+    TDigest digest;
+    BOOST_CHECK_THROW(digest.quantile(0.5), QuantLib::Error);
+    digest.add(3.0);
+    BOOST_CHECK_EQUAL(digest.quantile(0.95), 3.0);
+    digest.add(1.0);
+    digest.add(2.0);
+    BOOST_CHECK_EQUAL(digest.quantile(0.0), 1.0);
+    BOOST_CHECK_EQUAL(digest.quantile(1.0), 3.0);
+    BOOST_CHECK_CLOSE(digest.quantile(0.5), 2.0, 1E-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <qle/math/randomvariable_kernels.hpp>
+#include <qle/math/vectorisedblackformula.hpp>
+
+#include <ql/pricingengines/blackformula.hpp>
+
+#include <vector>
+
+using namespace QuantLib;
+using namespace QuantExt;
+
+using namespace boost::unit_test_framework;
+using std::vector;
+
+namespace {
+
+struct Inputs {
+    vector<Real> strikes, forwards, stdDevs, discounts;
+};
+
+// a grid of strikes and std devs including zero std devs and, for the Black formula, a zero displaced strike
+Inputs inputs(const Real displacement) {
+    Inputs r;
+    for (Real k : {0.0, 0.005, 0.02, 0.03, 0.04, 0.08}) {
+        for (Real s : {0.0, 0.001, 0.05, 0.2, 1.5}) {
+            r.strikes.push_back(k - displacement);
+            r.forwards.push_back(0.03);
+            r.stdDevs.push_back(s);
+            r.discounts.push_back(0.95);
+        }
+    }
+    return r;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(VectorisedBlackFormulaTest)
+
+BOOST_AUTO_TEST_CASE(testAgainstScalarFormulas) {
+
+    BOOST_TEST_MESSAGE("Testing vectorised Black and Bachelier formulas against the scalar formulas...");
+
+    const Real tol = 1E-12, h = 1E-7;
+
+    for (auto const& k : RandomVariableKernels::instance().getAvailableKernels()) {
+        BOOST_TEST_MESSAGE("checking kernels " << k);
+        RandomVariableKernels::instance().selectKernels(k);
+        for (auto type : {Option::Call, Option::Put}) {
+            for (Real displacement : {0.0, 0.01}) {
+                Inputs in = inputs(displacement);
+                Size n = in.strikes.size();
+                vector<Real> prices(n), vegas(n), deltas(n), up(n), down(n);
+                vectorisedBlackFormula(type, in.strikes.data(), in.forwards.data(), in.stdDevs.data(),
+                                       in.discounts.data(), n, prices.data(), vegas.data(), deltas.data(),
+                                       displacement);
+                for (Size i = 0; i < n; ++i) {
+                    Real price = blackFormula(type, in.strikes[i], in.forwards[i], in.stdDevs[i], in.discounts[i],
+                                              displacement);
+                    Real vega = blackFormulaStdDevDerivative(in.strikes[i], in.forwards[i], in.stdDevs[i],
+                                                             in.discounts[i], displacement);
+                    BOOST_CHECK_SMALL(prices[i] - price, tol);
+                    BOOST_CHECK_SMALL(vegas[i] - vega, tol);
+                    if (in.stdDevs[i] > 0.01) {
+                        Real delta = (blackFormula(type, in.strikes[i], in.forwards[i] + h, in.stdDevs[i],
+                                                   in.discounts[i], displacement) -
+                                      blackFormula(type, in.strikes[i], in.forwards[i] - h, in.stdDevs[i],
+                                                   in.discounts[i], displacement)) /
+                                     (2.0 * h);
+                        BOOST_CHECK_SMALL(deltas[i] - delta, 1E-6);
+                    }
+                }
+                if (displacement != 0.0)
+                    continue;
+                vectorisedBachelierBlackFormula(type, in.strikes.data(), in.forwards.data(), in.stdDevs.data(),
+                                                in.discounts.data(), n, prices.data(), vegas.data(), deltas.data());
+                for (Size i = 0; i < n; ++i) {
+                    Real price =
+                        bachelierBlackFormula(type, in.strikes[i], in.forwards[i], in.stdDevs[i], in.discounts[i]);
+                    Real vega = in.stdDevs[i] == 0.0
+                                    ? 0.0
+                                    : bachelierBlackFormulaStdDevDerivative(in.strikes[i], in.forwards[i],
+                                                                            in.stdDevs[i], in.discounts[i]);
+                    BOOST_CHECK_SMALL(prices[i] - price, tol);
+                    BOOST_CHECK_SMALL(vegas[i] - vega, tol);
+                    if (in.stdDevs[i] > 0.01) {
+                        Real delta = (bachelierBlackFormula(type, in.strikes[i], in.forwards[i] + h, in.stdDevs[i],
+                                                            in.discounts[i]) -
+                                      bachelierBlackFormula(type, in.strikes[i], in.forwards[i] - h, in.stdDevs[i],
+                                                            in.discounts[i])) /
+                                     (2.0 * h);
+                        BOOST_CHECK_SMALL(deltas[i] - delta, 1E-6);
+                    }
+                }
+            }
+        }
+    }
+
+    RandomVariableKernels::instance().reset();
+}
+
+BOOST_AUTO_TEST_CASE(testInvalidInputs) {
+
+    BOOST_TEST_MESSAGE("Testing vectorised Black formula with invalid inputs...");
+
+    vector<Real> strikes{0.02, -0.01}, forwards{0.03, 0.03}, stdDevs{0.1, 0.1}, discounts{1.0, 1.0}, prices(2);
+    BOOST_CHECK_THROW(vectorisedBlackFormula(Option::Call, strikes.data(), forwards.data(), stdDevs.data(),
+                                             discounts.data(), 2, prices.data()),
+                      QuantLib::Error);
+    BOOST_CHECK_NO_THROW(vectorisedBlackFormula(Option::Call, strikes.data(), forwards.data(), stdDevs.data(),
+                                                discounts.data(), 2, prices.data(), nullptr, nullptr, 0.01));
+    BOOST_CHECK_NO_THROW(vectorisedBlackFormula(Option::Call, nullptr, nullptr, nullptr, nullptr, 0, nullptr));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,309 @@
+"""
+Benchmark driver for ORE.
+
+Runs the ore executable on synthetic portfolios of configurable size that are generated from the example inputs, and
+writes the wall clock times together with the phase timings reported in the ORE log to a json file. See Readme.md.
+"""
+
+import argparse
+import copy
+import csv
+import datetime
+import json
+import os
+import platform
+import random
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import time
+import xml.etree.ElementTree as ET
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+ORE_ROOT = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+EXAMPLES_DIR = os.path.join(ORE_ROOT, "Examples")
+
+# Benchmark cases: example and ore.xml used as a base, the analytics to keep active, overrides for the setup and the
+# analytic parameters, how the portfolio is scaled ("trades" or "crif") and whether the case is multi-threaded.
+CASES = {
+    "npv": {
+        "example": "Example_39", "ore": "ore_classic.xml", "analytics": ["npv"],
+    },
+    "exposure_classic": {
+        "example": "Example_39", "ore": "ore_classic.xml", "analytics": ["npv", "simulation"],
+    },
+    "exposure_classic_grouped": {
+        "example": "Example_39", "ore": "ore_classic.xml", "analytics": ["npv", "simulation"],
+        "params": {"simulation": {"groupTradesByPricingEngine": "true"}},
+    },
+    "exposure_mt": {
+        "example": "Example_39", "ore": "ore_classic.xml", "analytics": ["npv", "simulation"], "threaded": True,
+    },
+    "exposure_amc": {
+        "example": "Example_39", "ore": "ore_amc.xml", "analytics": ["npv", "simulation"], "threaded": True,
+    },
+    "exposure_cg": {
+        "example": "Example_56", "ore": "ore.xml", "analytics": ["npv", "simulation"],
+        "params": {"simulation": {"xvaCgSensitivityConfigFile": ""}},
+    },
+    "exposure_cg_sensi": {
+        "example": "Example_56", "ore": "ore.xml", "analytics": ["npv", "simulation"],
+    },
+    "xva": {
+        "example": "Example_39", "ore": "ore_classic.xml", "analytics": ["npv", "simulation", "xva"],
+    },
+    "sensitivity": {
+        "example": "Example_15", "ore": "ore.xml", "analytics": ["npv", "sensitivity"],
+    },
+    "simm": {
+        "example": "Example_44", "ore": "ore_SIMM2.6_10D.xml", "analytics": ["simm"], "scale": "crif",
+    },
+    "historical_var": {
+        "example": "Example_58", "ore": "ore.xml", "analytics": ["historicalSimulationVar"],
+    },
+}
+
+# Phase timings reported in the ORE log (log mask 31 or higher), as (name, pattern); several matches are summed up.
+PHASES = [
+    ("market_build", re.compile(r"Market Build time ([0-9.eE+-]+) sec")),
+    ("portfolio_build", re.compile(r"Build time for trade type \S+: ([0-9.eE+-]+) sec")),
+    ("valuation_loop", re.compile(r"ValuationEngine completed: loop ([0-9.eE+-]+) sec")),
+    ("valuation_pricing", re.compile(r"ValuationEngine completed: .*pricing ([0-9.eE+-]+) sec")),
+    ("amc_calibration", re.compile(r"calibration time\s+: ([0-9.eE+-]+) sec")),
+    ("amc_valuation", re.compile(r"valuation time\s+: ([0-9.eE+-]+) sec")),
+    ("amc_total", re.compile(r"total time\s+: ([0-9.eE+-]+) sec")),
+]
+RUN_TIME = re.compile(r"run time: ([0-9.eE+-]+) sec")
+
+def find_ore():
+    candidates = [os.path.join(ORE_ROOT, "build", "App", "ore"),
+                  os.path.join(ORE_ROOT, "App", "build", "ore"),
+                  os.path.join(ORE_ROOT, "..", "build", "ore", "App", "ore"),
+                  os.path.join(ORE_ROOT, "build", "App", "Release", "ore.exe"),
+                  os.path.join(ORE_ROOT, "App", "bin", "x64", "Release", "ore.exe")]
+    for c in candidates:
+        if os.path.isfile(c):
+            return os.path.abspath(c)
+    return shutil.which("ore")
+
+
+def git_commit():
+    try:
+        return subprocess.check_output(["git", "rev-parse", "HEAD"], cwd=ORE_ROOT,
+                                       stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return ""
+
+
+def scale_portfolio(src, dst, size, rng):
+    """Write a portfolio with size trades to dst, built by cycling through the trades in src. The copies get a
+    suffixed trade id and their notionals are scaled by a random factor in [0.5, 1.5]."""
+    tree = ET.parse(src)
+    root = tree.getroot()
+    trades = root.findall("Trade")
+    if not trades:
+        raise RuntimeError("no trades found in " + src)
+    for t in trades:
+        root.remove(t)
+    for i in range(size):
+        t = copy.deepcopy(trades[i % len(trades)])
+        t.set("id", "%s_%d" % (t.get("id"), i))
+        factor = rng.uniform(0.5, 1.5)
+        for n in t.iter("Notional"):
+            try:
+                n.text = "%.2f" % (float(n.text) * factor)
+            except (TypeError, ValueError):
+                pass
+        root.append(t)
+    tree.write(dst)
+
+
+def scale_crif(src, dst, size, rng):
+    """Write a crif with the records of size trades to dst, built by cycling through the trades in src. The copies
+    get a suffixed trade id and their amounts are scaled by a random factor per trade in [0.5, 1.5]."""
+    with open(src, newline="") as f:
+        reader = csv.reader(f)
+        header = next(reader)
+        rows = list(reader)
+    tid, amount = header.index("TradeID"), header.index("Amount")
+    trade_ids = list(dict.fromkeys(r[tid] for r in rows))
+    with open(dst, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(header)
+        for i in range(size):
+            trade_id = trade_ids[i % len(trade_ids)]
+            factor = rng.uniform(0.5, 1.5)
+            for r in rows:
+                if r[tid] == trade_id:
+                    r2 = list(r)
+                    r2[tid] = "%s_%d" % (trade_id, i)
+                    r2[amount] = "%.6g" % (float(r[amount]) * factor)
+                    writer.writerow(r2)
+
+
+def prepare_case(name, case, size, threads, samples, seed, work_dir, numa_nodes=None):
+    """Set up the input of a benchmark case in work_dir/name_size and return the path to its ore.xml. If numa_nodes
+    is given, a multi-threaded case runs NUMA-aware on the first numa_nodes nodes."""
+    example_input = os.path.join(EXAMPLES_DIR, case["example"], "Input")
+    case_dir = os.path.abspath(os.path.join(work_dir, "%s_%d" % (name, size)))
+    input_dir = os.path.join(case_dir, "Input")
+    output_dir = os.path.join(case_dir, "Output")
+    if os.path.exists(case_dir):
+        shutil.rmtree(case_dir)
+    shutil.copytree(example_input, input_dir)
+    os.makedirs(output_dir)
+
+    tree = ET.parse(os.path.join(example_input, case["ore"]))
+    root = tree.getroot()
+    setup = root.find("Setup")
+    params = {p.get("name"): p for p in setup.findall("Parameter")}
+
+    def set_param(parent, key, value):
+        p = parent.find("Parameter[@name='%s']" % key)
+        if p is None:
+            p = ET.SubElement(parent, "Parameter", {"name": key})
+        p.text = value
+
+    # files outside the example's input directory (e.g. ../../Input/conventions.xml) are referred to by absolute
+    # paths, all other files are read from the copied input directory
+    for p in root.iter("Parameter"):
+        if p.text and p.text.strip().startswith(".."):
+            path = os.path.join(example_input, p.text.strip())
+            if os.path.exists(path):
+                p.text = os.path.abspath(path)
+    set_param(setup, "inputPath", input_dir)
+    set_param(setup, "outputPath", output_dir)
+    set_param(setup, "logFile", "log.txt")
+    set_param(setup, "logMask", "31")
+    set_param(setup, "nThreads", str(threads) if case.get("threaded", False) else "1")
+    if numa_nodes is not None and case.get("threaded", False):
+        set_param(setup, "mtNumaAware", "true")
+        set_param(setup, "mtNumaNodes", str(numa_nodes))
+
+    rng = random.Random(seed)
+    if case.get("scale", "trades") == "trades":
+        scale_portfolio(os.path.join(example_input, params["portfolioFile"].text.strip()),
+                        os.path.join(input_dir, "benchmark_portfolio.xml"), size, rng)
+        set_param(setup, "portfolioFile", "benchmark_portfolio.xml")
+
+    for analytic in root.find("Analytics").findall("Analytic"):
+        kind = analytic.get("type")
+        set_param(analytic, "active", "Y" if kind in case["analytics"] else "N")
+        for key, value in case.get("params", {}).get(kind, {}).items():
+            set_param(analytic, key, value)
+        if kind == "simm" and case.get("scale") == "crif":
+            scale_crif(os.path.join(example_input, analytic.find("Parameter[@name='crif']").text.strip()),
+                       os.path.join(input_dir, "benchmark_crif.csv"), size, rng)
+            set_param(analytic, "crif", "benchmark_crif.csv")
+        # the number of monte carlo samples is set in the simulation config of the copied input
+        sim = analytic.find("Parameter[@name='simulationConfigFile']")
+        if samples is not None and kind == "simulation" and sim is not None:
+            sim_file = os.path.join(input_dir, sim.text.strip())
+            sim_tree = ET.parse(sim_file)
+            for s in sim_tree.getroot().iter("Samples"):
+                s.text = str(samples)
+            sim_tree.write(sim_file)
+
+    ore_xml = os.path.join(input_dir, "benchmark_ore.xml")
+    tree.write(ore_xml)
+    return ore_xml, output_dir
+
+
+def parse_log(log_file):
+    phases = {}
+    if not os.path.isfile(log_file):
+        return phases
+    with open(log_file, errors="replace") as f:
+        for line in f:
+            for name, pattern in PHASES:
+                m = pattern.search(line)
+                if m:
+                    phases[name] = phases.get(name, 0.0) + float(m.group(1))
+    return phases
+
+
+def run_case(ore, name, case, size, args, numa_nodes=None):
+    runs = []
+    for r in range(args.repeats):
+        ore_xml, output_dir = prepare_case(name, case, size, args.threads, args.samples, args.seed, args.work_dir,
+                                           numa_nodes)
+        start = time.perf_counter()
+        proc = subprocess.run([ore, ore_xml], cwd=os.path.dirname(os.path.dirname(ore_xml)),
+                              stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        wall = time.perf_counter() - start
+        out = proc.stdout.decode(errors="replace")
+        m = RUN_TIME.search(out)
+        runs.append({"wall_time": wall, "ore_run_time": float(m.group(1)) if m else None,
+                     "return_code": proc.returncode, "phases": parse_log(os.path.join(output_dir, "log.txt"))})
+        if proc.returncode != 0:
+            print("  %s size %d failed with return code %d, see %s" % (name, size, proc.returncode, output_dir))
+            break
+    walls = [r["wall_time"] for r in runs]
+    phase_names = sorted(set(k for r in runs for k in r["phases"]))
+    return {"case": name, "example": case["example"], "size": size, "repeats": len(runs),
+            "threads": args.threads if case.get("threaded", False) else 1, "samples": args.samples,
+            "numa_nodes": numa_nodes,
+            "success": all(r["return_code"] == 0 for r in runs), "wall_time_min": min(walls),
+            "wall_time_median": statistics.median(walls),
+            "phases_median": {k: statistics.median(r["phases"][k] for r in runs if k in r["phases"])
+                              for k in phase_names},
+            "runs": runs}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run ORE on scaled example portfolios and record timings.")
+    parser.add_argument("--ore", help="path to the ore executable (default: search the usual build directories)")
+    parser.add_argument("--cases", default=",".join(CASES.keys()),
+                        help="comma separated list of cases, available: " + ", ".join(CASES.keys()))
+    parser.add_argument("--sizes", default="10,100", help="comma separated list of portfolio sizes")
+    parser.add_argument("--repeats", type=int, default=3, help="number of runs per case and size")
+    parser.add_argument("--threads", type=int, default=os.cpu_count() or 1,
+                        help="number of threads for the multi-threaded cases")
+    parser.add_argument("--samples", type=int, help="override the number of monte carlo samples")
+    parser.add_argument("--numa-nodes",
+                        help="comma separated list of NUMA node counts, the multi-threaded cases are run NUMA-aware "
+                             "once for each count, e.g. 1,2 to compare one and two sockets")
+    parser.add_argument("--seed", type=int, default=42, help="seed for the portfolio generation")
+    parser.add_argument("--work-dir", default="benchmark_work", help="directory for the case inputs and outputs")
+    parser.add_argument("--output", default="benchmark_results.json", help="json result file")
+    args = parser.parse_args()
+
+    ore = args.ore or find_ore()
+    if ore is None or not os.path.isfile(ore):
+        sys.exit("ore executable not found, use --ore")
+    cases = [c.strip() for c in args.cases.split(",") if c.strip()]
+    for c in cases:
+        if c not in CASES:
+            sys.exit("unknown case '%s', available: %s" % (c, ", ".join(CASES.keys())))
+    sizes = [int(s) for s in args.sizes.split(",") if s.strip()]
+    numa_nodes = [int(n) for n in args.numa_nodes.split(",") if n.strip()] if args.numa_nodes else [None]
+
+    results = []
+    for c in cases:
+        for s in sizes:
+            base = None
+            for n in (numa_nodes if CASES[c].get("threaded", False) else [None]):
+                print("running %s, size %d%s" % (c, s, "" if n is None else ", %d NUMA node(s)" % n))
+                res = run_case(ore, c, CASES[c], s, args, n)
+                print("  wall time median %.3f sec, min %.3f sec" % (res["wall_time_median"], res["wall_time_min"]))
+                # scaling relative to the first node count
+                if n is not None:
+                    if base is None:
+                        base = res["wall_time_median"]
+                    res["numa_speedup"] = base / res["wall_time_median"] if res["wall_time_median"] > 0 else None
+                    if res["numa_speedup"] is not None:
+                        print("  speedup vs %d NUMA node(s): %.2f" % (numa_nodes[0], res["numa_speedup"]))
+                results.append(res)
+
+    with open(args.output, "w") as f:
+        json.dump({"timestamp": datetime.datetime.now().isoformat(timespec="seconds"), "commit": git_commit(),
+                   "host": platform.node(), "platform": platform.platform(), "cpu_count": os.cpu_count(),
+                   "ore": os.path.abspath(ore), "seed": args.seed, "results": results}, f, indent=2)
+    print("results written to " + args.output)
+    return 0 if all(r["success"] for r in results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())